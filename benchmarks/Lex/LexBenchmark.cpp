@@ -0,0 +1,248 @@
+//===- benchmarks/Lex/LexBenchmark.cpp - Lexer benchmarks -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Benchmarks of the hot paths of the lexer, the preprocessor, header search
+// and the dependency directives source minimizer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <string>
+
+using namespace clang;
+using llvm::utostr;
+
+namespace {
+
+/// \returns roughly \p Size bytes of typical C++ code.
+std::string makeCode(size_t Size) {
+  std::string Code;
+  llvm::raw_string_ostream OS(Code);
+  for (unsigned I = 0; OS.tell() < Size; ++I)
+    OS << "// Returns the value of the element " << I << ".\n"
+       << "static inline unsigned long get" << I
+       << "(const struct Element *E, int Index) {\n"
+       << "  if (E->Values[Index] >= 0x" << llvm::utohexstr(I) << "u)\n"
+       << "    return E->Values[Index] * 3.5e2 + 'a';\n"
+       << "  return sizeof(\"element " << I << "\") - Index;\n"
+       << "}\n\n";
+  return OS.str();
+}
+
+/// \returns roughly \p Size bytes of block and line comments.
+std::string makeComments(size_t Size) {
+  std::string Code;
+  llvm::raw_string_ostream OS(Code);
+  while (OS.tell() < Size)
+    OS << "/* A block comment, which spans\n"
+       << " * a few lines. */\n"
+       << "// A line comment, followed by a blank line.\n\n";
+  return OS.str();
+}
+
+/// The objects the preprocessor and header search need.
+struct LexEnvironment {
+  LexEnvironment(IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS =
+                     new llvm::vfs::InMemoryFileSystem)
+      : FileMgr(FileMgrOpts, std::move(FS)), DiagID(new DiagnosticIDs()),
+        Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+        SourceMgr(Diags, FileMgr), TargetOpts(new TargetOptions) {
+    LangOpts.CPlusPlus = LangOpts.CPlusPlus11 = true;
+    TargetOpts->Triple = "x86_64-unknown-linux-gnu";
+    Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+};
+
+//===----------------------------------------------------------------------===//
+// Lexer
+//===----------------------------------------------------------------------===//
+
+void rawLex(benchmark::State &State, std::string (*MakeInput)(size_t)) {
+  std::string Input = MakeInput(State.range(0));
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = LangOpts.CPlusPlus11 = true;
+  for (auto _ : State) {
+    Lexer L(SourceLocation(), LangOpts, Input.data(), Input.data(),
+            Input.data() + Input.size());
+    L.SetCommentRetentionState(true);
+    Token Tok;
+    unsigned NumTokens = 0;
+    while (!L.LexFromRawLexer(Tok))
+      ++NumTokens;
+    benchmark::DoNotOptimize(NumTokens);
+  }
+  State.SetBytesProcessed(int64_t(State.iterations()) * Input.size());
+}
+BENCHMARK_CAPTURE(rawLex, Code, makeCode)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK_CAPTURE(rawLex, Comments, makeComments)->Arg(1 << 20);
+
+//===----------------------------------------------------------------------===//
+// Preprocessor
+//===----------------------------------------------------------------------===//
+
+/// Preprocess \p Input, which is entered as the main file.
+void preprocess(benchmark::State &State, const std::string &Input) {
+  for (auto _ : State) {
+    State.PauseTiming();
+    LexEnvironment Env;
+    Env.SourceMgr.setMainFileID(Env.SourceMgr.createFileID(
+        llvm::MemoryBuffer::getMemBuffer(Input, "<main>")));
+    TrivialModuleLoader ModLoader;
+    HeaderSearch HeaderInfo(std::make_shared<HeaderSearchOptions>(),
+                            Env.SourceMgr, Env.Diags, Env.LangOpts,
+                            Env.Target.get());
+    Preprocessor PP(std::make_shared<PreprocessorOptions>(), Env.Diags,
+                    Env.LangOpts, Env.SourceMgr, HeaderInfo, ModLoader);
+    PP.Initialize(*Env.Target);
+    PP.EnterMainSourceFile();
+    State.ResumeTiming();
+
+    Token Tok;
+    unsigned NumTokens = 0;
+    do {
+      PP.Lex(Tok);
+      ++NumTokens;
+    } while (Tok.isNot(tok::eof));
+    benchmark::DoNotOptimize(NumTokens);
+  }
+  State.SetBytesProcessed(int64_t(State.iterations()) * Input.size());
+}
+
+/// \returns \p Definition followed by \p Count lines holding \p Use.
+std::string makeMacroUses(StringRef Definition, StringRef Use,
+                          unsigned Count) {
+  std::string Input;
+  llvm::raw_string_ostream OS(Input);
+  OS << Definition << '\n';
+  for (unsigned I = 0; I != Count; ++I)
+    OS << "int v" << I << " = " << Use << ";\n";
+  return OS.str();
+}
+
+void expandObjectLikeMacro(benchmark::State &State) {
+  preprocess(State, makeMacroUses("#define VALUE (1 + 2 * 3)", "VALUE",
+                                  State.range(0)));
+}
+BENCHMARK(expandObjectLikeMacro)->Arg(1 << 14);
+
+void expandFunctionLikeMacro(benchmark::State &State) {
+  preprocess(State,
+             makeMacroUses("#define MAX(A, B) ((A) > (B) ? (A) : (B))\n"
+                           "#define CLAMP(X, L, H) MAX(L, MAX(X, H))",
+                           "CLAMP(v, 1, 2)", State.range(0)));
+}
+BENCHMARK(expandFunctionLikeMacro)->Arg(1 << 14);
+
+void expandVariadicMacro(benchmark::State &State) {
+  preprocess(State, makeMacroUses("#define CALL(F, ...) F(0, ##__VA_ARGS__)",
+                                  "CALL(f, 1, \"two\", 3.0, g(4, 5))",
+                                  State.range(0)));
+}
+BENCHMARK(expandVariadicMacro)->Arg(1 << 14);
+
+//===----------------------------------------------------------------------===//
+// HeaderSearch
+//===----------------------------------------------------------------------===//
+
+/// Look up a header of the last of State.range(0) search directories, each
+/// of which holds a few headers, as a quoted include without includer would.
+void lookupFile(benchmark::State &State) {
+  unsigned NumDirs = State.range(0);
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> FS(
+      new llvm::vfs::InMemoryFileSystem);
+  for (unsigned I = 0; I != NumDirs; ++I)
+    for (unsigned J = 0; J != 4; ++J)
+      FS->addFile("/include/" + Twine(I) + "/header" + Twine(J) + ".h", 0,
+                  llvm::MemoryBuffer::getMemBuffer(""));
+  FS->addFile("/include/" + Twine(NumDirs - 1) + "/target.h", 0,
+              llvm::MemoryBuffer::getMemBuffer(""));
+
+  LexEnvironment Env(FS);
+  HeaderSearch Search(std::make_shared<HeaderSearchOptions>(), Env.SourceMgr,
+                      Env.Diags, Env.LangOpts, Env.Target.get());
+  for (unsigned I = 0; I != NumDirs; ++I) {
+    auto Dir = Env.FileMgr.getOptionalDirectoryRef("/include/" + utostr(I));
+    Search.AddSearchPath(DirectoryLookup(*Dir, SrcMgr::C_User,
+                                         /*isFramework=*/false),
+                         /*isAngled=*/false);
+  }
+
+  for (auto _ : State) {
+    const DirectoryLookup *CurDir = nullptr;
+    Optional<FileEntryRef> File = Search.LookupFile(
+        "target.h", SourceLocation(), /*isAngled=*/false, /*FromDir=*/nullptr,
+        CurDir, /*Includers=*/None, /*SearchPath=*/nullptr,
+        /*RelativePath=*/nullptr, /*RequestingModule=*/nullptr,
+        /*SuggestedModule=*/nullptr, /*IsMapped=*/nullptr,
+        /*IsFrameworkFound=*/nullptr, /*SkipCache=*/true);
+    benchmark::DoNotOptimize(File);
+  }
+}
+BENCHMARK(lookupFile)->Arg(8)->Arg(64)->Arg(512);
+
+//===----------------------------------------------------------------------===//
+// Dependency directives source minimizer
+//===----------------------------------------------------------------------===//
+
+void minimizeSource(benchmark::State &State) {
+  std::string Input;
+  llvm::raw_string_ostream OS(Input);
+  for (unsigned I = 0; OS.tell() < size_t(State.range(0)); ++I)
+    OS << "#include <system" << I << ".h>\n"
+       << "#include \"local" << I << ".h\"\n"
+       << "#ifndef GUARD_" << I << "\n"
+       << "#define GUARD_" << I << " \\\n  (" << I << " + 1)\n"
+       << "#endif\n"
+       << makeCode(256);
+  OS.flush();
+
+  llvm::SmallString<1024> Output;
+  llvm::SmallVector<minimize_source_to_dependency_directives::Token, 64>
+      Tokens;
+  for (auto _ : State) {
+    Output.clear();
+    Tokens.clear();
+    bool Failed = minimizeSourceToDependencyDirectives(Input, Output, Tokens);
+    benchmark::DoNotOptimize(Failed);
+  }
+  State.SetBytesProcessed(int64_t(State.iterations()) * Input.size());
+}
+BENCHMARK(minimizeSource)->Arg(1 << 20);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -1852,6 +1852,27 @@ class Cursor(Structure):
             for descendant in child.walk_preorder():
                 yield descendant
 
+    def get_subtree(self):
+        """Return the descendants of this cursor in depth-first preorder.
+
+        Returns a list of CursorRecord. Unlike walk_preorder(), the
+        descendants are collected by libclang in a single call, rather than
+        by a call into Python for each cursor.
+        """
+        capacity = 256
+        while True:
+            records = (CursorRecord * capacity)()
+            count = conf.lib.clang_getCursorSubtree(self, records, capacity)
+            if count <= capacity:
+                break
+            capacity = count
+
+        result = list(records[:count])
+        for record in result:
+            # Create reference to TU so it isn't GC'd before the cursors.
+            record._tu = self._tu
+        return result
+
     def get_tokens(self):
         """Obtain Token instances formulating that compose this Cursor.
 
@@ -1917,6 +1938,33 @@ class Cursor(Structure):
         res._tu = args[0]._tu
         return res
 
+class CursorRecord(Structure):
+    """
+    A descendant of a cursor, as returned by Cursor.get_subtree().
+    """
+    _fields_ = [("_kind_id", c_int), ("_parent", c_uint),
+                ("extent", SourceRange), ("_cursor", Cursor)]
+
+    @property
+    def kind(self):
+        """Return the kind of the cursor."""
+        return CursorKind.from_id(self._kind_id)
+
+    @property
+    def parent(self):
+        """Return the index of the record of the parent of the cursor, or
+        None if the parent is the cursor whose subtree was requested."""
+        if self._parent == 0xffffffff:
+            return None
+        return self._parent
+
+    @property
+    def cursor(self):
+        """Return the cursor."""
+        cursor = self._cursor
+        cursor._tu = self._tu
+        return cursor
+
 class StorageClass(object):
     """
     Describes the storage class of a declaration
@@ -3607,6 +3655,10 @@ functionList = [
    Cursor,
    Cursor.from_cursor_result),
 
+  ("clang_getCursorSubtree",
+   [Cursor, POINTER(CursorRecord), c_uint],
+   c_uint),
+
   ("clang_getCursorSpelling",
    [Cursor],
    _CXString,
@@ -4202,6 +4254,7 @@ __all__ = [
     'CompileCommand',
     'CursorKind',
     'Cursor',
+    'CursorRecord',
     'Diagnostic',
     'File',
     'FixIt',
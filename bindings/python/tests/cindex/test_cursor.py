@@ -93,6 +93,27 @@ class TestCursor(unittest.TestCase):
         self.assertEqual(tu_nodes[2].displayname, 'f0(int, int)')
         self.assertEqual(tu_nodes[2].is_definition(), True)
 
+    def test_get_subtree(self):
+        tu = get_tu(kInput)
+
+        records = tu.cursor.get_subtree()
+        cursors = list(tu.cursor.walk_preorder())[1:]
+        self.assertEqual(len(records), len(cursors))
+        for record, cursor in zip(records, cursors):
+            self.assertEqual(record.cursor, cursor)
+            self.assertEqual(record.kind, cursor.kind)
+            self.assertEqual(record.extent, cursor.extent)
+            self.assertIsNotNone(record.cursor.translation_unit)
+
+        self.assertEqual(records[0].kind, CursorKind.STRUCT_DECL)
+        self.assertIsNone(records[0].parent)
+        self.assertEqual(records[1].kind, CursorKind.FIELD_DECL)
+        self.assertEqual(records[1].parent, 0)
+        for record in records:
+            if record.parent is not None:
+                parent = records[record.parent].cursor
+                self.assertIn(record.cursor, list(parent.get_children()))
+
     def test_references(self):
         """Ensure that references to TranslationUnit are kept."""
         tu = get_tu('int x;')
@@ -54,7 +54,12 @@ enum CXErrorCode {
   /**
    * An AST deserialization error has occurred.
    */
-  CXError_ASTReadError = 4
+  CXError_ASTReadError = 4,
+
+  /**
+   * The operation was cancelled via its CXCancellationToken.
+   */
+  CXError_Cancelled = 5
 };
 
 #ifdef __cplusplus
@@ -22,6 +22,7 @@
 #include "clang-c/CXErrorCode.h"
 #include "clang-c/CXString.h"
 #include "clang-c/BuildSystem.h"
+#include "clang-c/CXCompilationDatabase.h"
 
 /**
  * The version constants for the libclang API.
@@ -32,7 +33,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 59
+#define CINDEX_VERSION_MINOR 63
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -854,6 +855,54 @@ CINDEX_LINKAGE CXDiagnosticSet clang_loadDiagnostics(const char *file,
                                                   enum CXLoadDiag_Error *error,
                                                   CXString *errorString);
 
+/**
+ * Decides whether a top-level diagnostic of a serialized diagnostics file,
+ * and its notes, are loaded by \c clang_loadDiagnosticsFiltered.
+ *
+ * \param severity The severity of the diagnostic.
+ * \param category The category number of the diagnostic.
+ * \param category_text The name of the category, or an empty string.
+ * \param option The name of the warning flag of the diagnostic, without the
+ *        "-W" prefix, or an empty string.
+ * \param client_data The client data given to
+ *        \c clang_loadDiagnosticsFiltered.
+ *
+ * \returns non-zero to load the diagnostic.
+ */
+typedef int (*CXLoadedDiagnosticFilter)(enum CXDiagnosticSeverity severity,
+                                        unsigned category,
+                                        const char *category_text,
+                                        const char *option,
+                                        CXClientData client_data);
+
+/**
+ * Deserialize a set of diagnostics from a Clang diagnostics bitcode
+ * file, like \c clang_loadDiagnostics, but only decode each top-level
+ * diagnostic when it is first retrieved from the set.
+ *
+ * The file is only indexed when it is loaded, and is kept memory mapped by
+ * the set. Since the diagnostics are decoded later,
+ * \c clang_getDiagnosticInSet returns NULL for a diagnostic which is
+ * malformed.
+ *
+ * \param file The name of the file to deserialize.
+ * \param filter If non-NULL, only the top-level diagnostics for which it
+ *        returns non-zero are in the set. It is called while indexing, before
+ *        the diagnostics are decoded.
+ * \param client_data The client data passed to \p filter.
+ * \param error A pointer to a enum value recording if there was a problem
+ *        deserializing the diagnostics.
+ * \param errorString A pointer to a CXString for recording the error string
+ *        if the file was not successfully loaded.
+ *
+ * \returns A loaded CXDiagnosticSet if successful, and NULL otherwise. These
+ * diagnostics should be released using clang_disposeDiagnosticSet().
+ */
+CINDEX_LINKAGE CXDiagnosticSet clang_loadDiagnosticsFiltered(
+    const char *file, CXLoadedDiagnosticFilter filter,
+    CXClientData client_data, enum CXLoadDiag_Error *error,
+    CXString *errorString);
+
 /**
  * Release a CXDiagnosticSet and all of its contained diagnostics.
  */
@@ -1458,6 +1507,45 @@ CINDEX_LINKAGE enum CXErrorCode clang_parseTranslationUnit2FullArgv(
     struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
     unsigned options, CXTranslationUnit *out_TU);
 
+/**
+ * A token which cancels the parses and code completions it is passed to,
+ * e.g. because the source file was edited while they run on another thread.
+ */
+typedef struct CXCancellationTokenImpl *CXCancellationToken;
+
+/**
+ * Creates a cancellation token, which should be freed with
+ * \c clang_disposeCancellationToken().
+ */
+CINDEX_LINKAGE CXCancellationToken clang_createCancellationToken(void);
+
+/**
+ * Cancels the operations which are passed \p Token, including the ones which
+ * are running. This function can be called from any thread.
+ *
+ * The operations stop once they have parsed the current top-level
+ * declaration.
+ */
+CINDEX_LINKAGE void clang_cancel(CXCancellationToken Token);
+
+/**
+ * Frees \p Token, which must not be used by a running operation.
+ */
+CINDEX_LINKAGE void clang_disposeCancellationToken(CXCancellationToken Token);
+
+/**
+ * Same as clang_parseTranslationUnit2FullArgv, but stops parsing once
+ * \p Token is cancelled.
+ *
+ * \returns CXError_Cancelled if \p Token was cancelled before the
+ * translation unit was parsed, in which case \p out_TU is NULL.
+ */
+CINDEX_LINKAGE enum CXErrorCode clang_parseTranslationUnitCancellable(
+    CXIndex CIdx, const char *source_filename,
+    const char *const *command_line_args, int num_command_line_args,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, CXCancellationToken Token, CXTranslationUnit *out_TU);
+
 /**
  * Flags that control how translation units are saved.
  *
@@ -1629,6 +1717,19 @@ CINDEX_LINKAGE int clang_reparseTranslationUnit(CXTranslationUnit TU,
                                           struct CXUnsavedFile *unsaved_files,
                                                 unsigned options);
 
+/**
+ * Same as clang_reparseTranslationUnit, but stops reparsing once \p Token
+ * is cancelled.
+ *
+ * \returns CXError_Cancelled if \p Token was cancelled before the
+ * translation unit was reparsed. As for the other errors, the only valid
+ * call for \c TU is then \c clang_disposeTranslationUnit(TU).
+ */
+CINDEX_LINKAGE int clang_reparseTranslationUnitCancellable(
+    CXTranslationUnit TU, unsigned num_unsaved_files,
+    struct CXUnsavedFile *unsaved_files, unsigned options,
+    CXCancellationToken Token);
+
 /**
   * Categorizes how memory is being used by a translation unit.
   */
@@ -4209,6 +4310,55 @@ CINDEX_LINKAGE unsigned clang_visitChildrenWithBlock(CXCursor parent,
 #  endif
 #endif
 
+/**
+ * A cursor of a subtree, as recorded by \c clang_getCursorSubtree().
+ */
+typedef struct {
+  /**
+   * The kind of the cursor.
+   */
+  enum CXCursorKind kind;
+
+  /**
+   * The index of the record of the parent of the cursor, or UINT_MAX if the
+   * parent is the root of the subtree.
+   */
+  unsigned parent;
+
+  /**
+   * The extent of the cursor, as returned by \c clang_getCursorExtent().
+   */
+  CXSourceRange extent;
+
+  /**
+   * The cursor itself, which can be passed to the other functions, e.g.
+   * \c clang_getCursorUSR(), for the cursors which need more information.
+   */
+  CXCursor cursor;
+} CXCursorRecord;
+
+/**
+ * Records the descendants of a cursor in depth-first preorder, in a single
+ * call instead of a call to a visitor for each cursor.
+ *
+ * The cursors are the ones which \c clang_visitChildren() visits when its
+ * visitor returns \c CXChildVisit_Recurse for every cursor.
+ *
+ * \param root the cursor whose descendants are recorded. The root itself is
+ * not recorded.
+ *
+ * \param records the array the records are written to.
+ *
+ * \param num_records the size of \p records.
+ *
+ * \returns the number of descendants of \p root. If it is greater than
+ * \p num_records, only the first \p num_records descendants were recorded,
+ * and the call can be repeated with a larger array.
+ */
+CINDEX_LINKAGE unsigned clang_getCursorSubtree(CXCursor root,
+                                               CXCursorRecord *records,
+                                               unsigned num_records);
+
 /**
  * @}
  */
@@ -5773,6 +5923,38 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             unsigned num_unsaved_files,
                                             unsigned options);
 
+/**
+ * Same as clang_codeCompleteAt, but stops once \p Token is cancelled.
+ *
+ * \returns NULL if \p Token was cancelled before the code-completion results
+ * were computed. The translation unit remains usable.
+ */
+CINDEX_LINKAGE
+CXCodeCompleteResults *clang_codeCompleteAtCancellable(
+    CXTranslationUnit TU, const char *complete_filename,
+    unsigned complete_line, unsigned complete_column,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, CXCancellationToken Token);
+
+/**
+ * Same as clang_codeCompleteAt, but only returns the results which match
+ * \p filter, before their completion strings are built.
+ *
+ * \param filter If non-NULL, the text typed so far. A result matches when its
+ * typed text starts with the first character of \p filter and contains its
+ * other characters in order, ignoring case.
+ *
+ * \param max_results If non-zero, the maximum number of results. The results
+ * whose typed text starts with \p filter are kept first, and then the results
+ * with the best priority.
+ */
+CINDEX_LINKAGE
+CXCodeCompleteResults *clang_codeCompleteAtFiltered(
+    CXTranslationUnit TU, const char *complete_filename,
+    unsigned complete_line, unsigned complete_column,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, const char *filter, unsigned max_results);
+
 /**
  * Sort the code-completion results in case-insensitive alphabetical
  * order.
@@ -6682,6 +6864,34 @@ CINDEX_LINKAGE int clang_indexSourceFileFullArgv(
     int num_command_line_args, struct CXUnsavedFile *unsaved_files,
     unsigned num_unsaved_files, CXTranslationUnit *out_TU, unsigned TU_options);
 
+/**
+ * Index all the translation units of a compilation database via callbacks
+ * implemented through #IndexerCallbacks, with several translation units
+ * indexed in parallel.
+ *
+ * The translation units are indexed in the session of the index action, as
+ * with #CXIndexOpt_SkipParsedBodiesInSession, so that the bodies which one
+ * of them parsed are skipped by the others. The declarations and the
+ * references are only reported by the first translation unit which indexes
+ * them, so that those of the headers are not reported again by each
+ * translation unit which includes them.
+ *
+ * The callbacks are invoked from several threads, but never concurrently.
+ *
+ * \param num_threads The number of translation units indexed in parallel, or
+ * 0 for as many as there are cores.
+ *
+ * \returns 0 on success or if there were errors from which the compiler
+ * could recover. If one of the translation units could not be indexed, the
+ * others are still indexed, and a non-zero \c CXErrorCode is returned.
+ *
+ * The other parameters are the same as #clang_indexSourceFile.
+ */
+CINDEX_LINKAGE int clang_indexCompilationDatabase(
+    CXIndexAction, CXClientData client_data, IndexerCallbacks *index_callbacks,
+    unsigned index_callbacks_size, unsigned index_options,
+    CXCompilationDatabase database, unsigned TU_options, unsigned num_threads);
+
 /**
  * Index the given translation unit via callbacks implemented through
  * #IndexerCallbacks.
@@ -251,6 +251,12 @@ private:
   struct Arr {
     APValue *Elts;
     unsigned NumElts, ArrSize;
+    /// The initialized elements, if packArrays() packed them, in which case
+    /// Elts only holds the filler.
+    char *PackedElts = nullptr;
+    /// The width and the signedness of the packed integers.
+    unsigned PackedBitWidth = 0;
+    bool PackedIsUnsigned = false;
     Arr(unsigned NumElts, unsigned ArrSize);
     ~Arr();
   };
@@ -467,7 +473,10 @@ public:
   APValue &getArrayInitializedElt(unsigned I) {
     assert(isArray() && "Invalid accessor");
     assert(I < getArrayInitializedElts() && "Index out of range");
-    return ((Arr*)(char*)Data.buffer)->Elts[I];
+    Arr *A = (Arr*)(char*)Data.buffer;
+    if (LLVM_UNLIKELY(A->PackedElts))
+      unpackArray();
+    return A->Elts[I];
   }
   const APValue &getArrayInitializedElt(unsigned I) const {
     return const_cast<APValue*>(this)->getArrayInitializedElt(I);
@@ -478,7 +487,8 @@ public:
   APValue &getArrayFiller() {
     assert(isArray() && "Invalid accessor");
     assert(hasArrayFiller() && "No array filler");
-    return ((Arr*)(char*)Data.buffer)->Elts[getArrayInitializedElts()];
+    Arr *A = (Arr*)(char*)Data.buffer;
+    return A->Elts[A->PackedElts ? 0 : A->NumElts];
   }
   const APValue &getArrayFiller() const {
     return const_cast<APValue*>(this)->getArrayFiller();
@@ -492,6 +502,29 @@ public:
     return ((const Arr*)(const void *)Data.buffer)->ArrSize;
   }
 
+  /// Pack the initialized elements of the arrays within this value whose
+  /// elements are integers of the same width and signedness, of at most 64
+  /// bits, so that each takes the size of its type rather than that of an
+  /// APValue. This is meant for the values which are kept, such as those of
+  /// large constexpr arrays.
+  ///
+  /// Getting an initialized element of a packed array unpacks it, except
+  /// through getPackedArrayElt() and getPackedArrayBits().
+  void packArrays();
+
+  bool isPackedArray() const {
+    return isArray() && ((const Arr*)(const void *)Data.buffer)->PackedElts;
+  }
+  unsigned getPackedArrayBitWidth() const {
+    assert(isPackedArray() && "Invalid accessor");
+    return ((const Arr*)(const void *)Data.buffer)->PackedBitWidth;
+  }
+  /// \returns the bits of the initialized element \p I of a packed array,
+  /// zero-extended.
+  uint64_t getPackedArrayBits(unsigned I) const;
+  /// \returns the initialized element \p I of a packed array.
+  APSInt getPackedArrayElt(unsigned I) const;
+
   unsigned getStructNumBases() const {
     assert(isStruct() && "Invalid accessor");
     return ((const StructData*)(const char*)Data.buffer)->NumBases;
@@ -629,6 +662,7 @@ private:
   }
   void MakeLValue();
   void MakeArray(unsigned InitElts, unsigned Size);
+  void unpackArray();
   void MakeStruct(unsigned B, unsigned M) {
     assert(isAbsent() && "Bad state change");
     new ((void*)(char*)Data.buffer) StructData(B, M);
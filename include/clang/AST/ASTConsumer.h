@@ -138,6 +138,13 @@ public:
   /// body may be parsed anyway if it is needed (for instance, if it contains
   /// the code completion point or is constexpr).
   virtual bool shouldSkipFunctionBody(Decl *D) { return true; }
+
+  /// This callback is called for each function whose body is skipped.
+  ///
+  /// \return \c true if the tokens of the function's body should be kept, so
+  /// that the body can be parsed later, if the consumer asks for it with
+  /// \c Sema::ParseDeferredFunctionBody.
+  virtual bool shouldDeferFunctionBody(Decl *D) { return false; }
 };
 
 } // end namespace clang.
@@ -278,6 +278,14 @@ private:
   llvm::DenseMap<const MaterializeTemporaryExpr *, APValue *>
     MaterializedTemporaryValues;
 
+  /// The memoized results of constant-evaluated function calls, keyed by an
+  /// encoding of the callee, the kind of evaluation and the argument values.
+  /// See -fconstexpr-call-cache-size.
+  llvm::StringMap<APValue *> ConstexprCallResults;
+
+  /// The approximate memory used by ConstexprCallResults, in bytes.
+  uint64_t ConstexprCallResultsSize = 0;
+
   /// Used to cleanups APValues stored in the AST.
   mutable llvm::SmallVector<APValue *, 0> APValueCleanups;
 
@@ -556,6 +564,12 @@ private:
   /// AST objects will be released when the ASTContext itself is destroyed.
   mutable llvm::BumpPtrAllocator BumpAlloc;
 
+  /// Whether the size of the most recent allocation of any ASTContext is
+  /// recorded, for the statistics of the AST nodes.
+  static bool TrackNodeAllocations;
+  static char *LastNodeAllocation;
+  static size_t LastNodeAllocationSize;
+
   /// Allocator for partial diagnostics.
   PartialDiagnostic::StorageAllocator DiagAllocator;
 
@@ -683,7 +697,12 @@ public:
   }
 
   void *Allocate(size_t Size, unsigned Align = 8) const {
-    return BumpAlloc.Allocate(Size, Align);
+    void *Mem = BumpAlloc.Allocate(Size, Align);
+    if (LLVM_UNLIKELY(TrackNodeAllocations)) {
+      LastNodeAllocation = static_cast<char *>(Mem);
+      LastNodeAllocationSize = Size;
+    }
+    return Mem;
   }
   template <typename T> T *Allocate(size_t Num = 1) const {
     return static_cast<T *>(Allocate(Num * sizeof(T), alignof(T)));
@@ -696,6 +715,19 @@ public:
     return BumpAlloc.getTotalMemory();
   }
 
+  /// Start recording the size of the most recent allocation, so that the
+  /// statistics of the AST nodes that are collected with -print-stats can
+  /// include the trailing objects of each node.
+  static void EnableNodeAllocationTracking() { TrackNodeAllocations = true; }
+
+  /// Get the number of bytes from \p Node, an AST node that is being
+  /// constructed, to the end of the allocation it was placed in, including
+  /// its trailing objects. This is only known if the node was placed in the
+  /// most recent allocation, and only once for each allocation.
+  ///
+  /// \returns the size, or 0 if it is not known.
+  static size_t takeNodeAllocationSize(const void *Node);
+
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
 
@@ -1073,6 +1105,13 @@ public:
   ASTContext &operator=(const ASTContext &) = delete;
   ~ASTContext();
 
+  /// Destroy the objects owned by the AST that hold memory outside of the
+  /// AST allocator. This is done by the destructor; it can be called earlier
+  /// when the AST is about to be discarded by resetting the allocator, after
+  /// which only the non-AST state of the context, e.g. the source manager,
+  /// can be used.
+  void cleanup();
+
   /// Attach an external AST source to the AST context.
   ///
   /// The external AST source provides the ability to load parts of
@@ -1100,6 +1139,11 @@ public:
   ASTMutationListener *getASTMutationListener() const { return Listener; }
 
   void PrintStats() const;
+
+  /// Call \p Visit with the name of each class of type which this context
+  /// created, the number of types of that class and their size.
+  void visitTypeStats(llvm::function_ref<void(StringRef Class, unsigned Count,
+                                              uint64_t Bytes)> Visit) const;
   const SmallVectorImpl<Type *>& getTypes() const { return Types; }
 
   BuiltinTemplateDecl *buildBuiltinTemplateDecl(BuiltinTemplateKind BTK,
@@ -2832,6 +2876,15 @@ public:
   APValue *getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
                                          bool MayCreate);
 
+  /// Get the memoized result of the constant-evaluated function call
+  /// described by \p Key, or null if the call wasn't memoized.
+  const APValue *getMemoizedConstexprCall(StringRef Key);
+
+  /// Memoize \p Result as the result of the constant-evaluated function call
+  /// described by \p Key, unless that would exceed the memory allowed by
+  /// -fconstexpr-call-cache-size.
+  void memoizeConstexprCall(StringRef Key, const APValue &Result);
+
   /// Return a string representing the human readable name for the specified
   /// function declaration or file name. Used by SourceLocExpr and
   /// PredefinedExpr to cache evaluated results.
@@ -2883,6 +2936,20 @@ public:
   /// declarations were built.
   unsigned NumImplicitDestructorsDeclared = 0;
 
+  /// The number of constant-evaluated function calls whose result was taken
+  /// from ConstexprCallResults.
+  unsigned NumMemoizedConstexprCallHits = 0;
+
+  /// The number of constant-evaluated function call results that weren't
+  /// memoized because ConstexprCallResults was full.
+  unsigned NumConstexprCallsNotMemoized = 0;
+
+  /// The number of uniqued template specialization types which were compared
+  /// with a looked up type, and the number of those which had the same hash
+  /// but a different profile.
+  unsigned NumUniquedTypeComparisons = 0;
+  unsigned NumUniquedTypeHashCollisions = 0;
+
 public:
   /// Initialize built-in types.
   ///
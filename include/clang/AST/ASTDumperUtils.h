@@ -20,7 +20,9 @@ namespace clang {
 /// Used to specify the format for printing AST dump information.
 enum ASTDumpOutputFormat {
   ADOF_Default,
-  ADOF_JSON
+  ADOF_JSON,
+  /// JSON without any whitespace.
+  ADOF_JSONCompact
 };
 
 // Colors used for various parts of the AST dump
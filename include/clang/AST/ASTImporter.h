@@ -85,6 +85,7 @@ class TypeSourceInfo;
     friend class ASTNodeImporter;
   public:
     using NonEquivalentDeclSet = llvm::DenseSet<std::pair<Decl *, Decl *>>;
+    using EquivalentDeclSet = llvm::DenseSet<std::pair<Decl *, Decl *>>;
     using ImportedCXXBaseSpecifierMap =
         llvm::DenseMap<const CXXBaseSpecifier *, CXXBaseSpecifier *>;
     using FileIDImportHandlerType =
@@ -550,6 +551,10 @@ class TypeSourceInfo;
     /// Return the set of declarations that we know are not equivalent.
     NonEquivalentDeclSet &getNonEquivalentDecls() { return NonEquivalentDecls; }
 
+    /// Return the set of declarations that we know are equivalent, which is
+    /// part of the shared state.
+    EquivalentDeclSet &getEquivalentDecls();
+
     /// Called for ObjCInterfaceDecl, ObjCProtocolDecl, and TagDecl.
     /// Mark the Decl as complete, filling it in as much as possible.
     ///
@@ -40,6 +40,12 @@ class ASTImporterSharedState {
   /// never cleared (like ImportedFromDecls).
   llvm::DenseMap<Decl *, ImportError> ImportErrors;
 
+  /// Declaration (from, to) pairs that are known to be structurally
+  /// equivalent. The pairs of different "from" contexts never overlap, so the
+  /// importers sharing this state share this set too. It must not outlive
+  /// the "from" contexts of these importers.
+  ASTImporter::EquivalentDeclSet EquivalentDecls;
+
   // FIXME put ImportedFromDecls here!
   // And from that point we can better encapsulate the lookup table.
 
@@ -75,6 +81,10 @@ public:
   void setImportDeclError(Decl *To, ImportError Error) {
     ImportErrors[To] = Error;
   }
+
+  ASTImporter::EquivalentDeclSet &getEquivalentDecls() {
+    return EquivalentDecls;
+  }
 };
 
 } // namespace clang
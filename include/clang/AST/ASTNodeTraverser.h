@@ -65,6 +65,10 @@ class ASTNodeTraverser
   /// not already been loaded.
   bool Deserialize = false;
 
+  /// Indicates whether the implicit declarations of the declaration contexts
+  /// are skipped.
+  bool SkipImplicitDecls = false;
+
   NodeDelegateType &getNodeDelegate() {
     return getDerived().doGetNodeDelegate();
   }
@@ -74,6 +78,9 @@ public:
   void setDeserialize(bool D) { Deserialize = D; }
   bool getDeserialize() const { return Deserialize; }
 
+  void setSkipImplicitDecls(bool S) { SkipImplicitDecls = S; }
+  bool getSkipImplicitDecls() const { return SkipImplicitDecls; }
+
   void Visit(const Decl *D) {
     getNodeDelegate().AddChild([=] {
       getNodeDelegate().Visit(D);
@@ -228,7 +235,8 @@ public:
       return;
 
     for (const auto *D : (Deserialize ? DC->decls() : DC->noload_decls()))
-      Visit(D);
+      if (!SkipImplicitDecls || !D->isImplicit())
+        Visit(D);
   }
 
   void dumpTemplateParameters(const TemplateParameterList *TPL) {
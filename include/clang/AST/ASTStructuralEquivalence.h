@@ -54,6 +54,12 @@ struct StructuralEquivalenceContext {
   /// (which we have already complained about).
   llvm::DenseSet<std::pair<Decl *, Decl *>> &NonEquivalentDecls;
 
+  /// Declaration (from, to) pairs that are known to be equivalent, if not
+  /// null. The pairs visited by a successful check are added to it, unless
+  /// the outcome may change later, e.g. when a class isn't defined yet. It
+  /// must only be shared by contexts with the same kind and strictness.
+  llvm::DenseSet<std::pair<Decl *, Decl *>> *EquivalentDecls = nullptr;
+
   StructuralEquivalenceKind EqKind;
 
   /// Whether we're being strict about the spelling of types when
@@ -121,6 +127,9 @@ private:
   /// false if equivalence was detected.
   bool Finish();
 
+  /// Add the pairs visited by a successful check to \c EquivalentDecls.
+  void cacheEquivalentDecls();
+
   /// Check for common properties at Finish.
   /// \returns true if D1 and D2 may be equivalent,
   /// false if they are for sure not.
@@ -23,6 +23,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/PointerUnion.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Support/Casting.h"
@@ -383,7 +384,7 @@ protected:
         TopLevelDeclInObjCContainer(false), Access(AS_none), FromASTFile(0),
         IdentifierNamespace(getIdentifierNamespaceForKind(DK)),
         CacheValidAndLinkage(0) {
-    if (StatisticsEnabled) add(DK);
+    if (StatisticsEnabled) add(DK, this);
   }
 
   Decl(Kind DK, EmptyShell Empty)
@@ -392,7 +393,7 @@ protected:
         Access(AS_none), FromASTFile(0),
         IdentifierNamespace(getIdentifierNamespaceForKind(DK)),
         CacheValidAndLinkage(0) {
-    if (StatisticsEnabled) add(DK);
+    if (StatisticsEnabled) add(DK, this);
   }
 
   virtual ~Decl();
@@ -996,10 +997,17 @@ public:
   SourceLocation getBodyRBrace() const;
 
   // global temp stats (until we have a per-module visitor)
-  static void add(Kind k);
+  static void add(Kind k, const Decl *D);
   static void EnableStatistics();
   static void PrintStats();
 
+  /// Call \p Visit with the name of each kind of declaration that was
+  /// created while the statistics were enabled, the number of declarations
+  /// of that kind and the bytes allocated for them.
+  static void
+  visitStats(llvm::function_ref<void(StringRef Kind, unsigned Count,
+                                     uint64_t Bytes)> Visit);
+
   /// isTemplateParameter - Determines whether this declaration is a
   /// template parameter.
   bool isTemplateParameter() const;
@@ -2445,6 +2453,7 @@ private:
 
   void loadLazyLocalLexicalLookups();
   void buildLookupImpl(DeclContext *DCtx, bool Internal);
+  void setLookupBuildPosition(const Decl *From, Decl *To) const;
   void makeDeclVisibleInContextWithFlags(NamedDecl *D, bool Internal,
                                          bool Rediscoverable);
   void makeDeclVisibleInContextImpl(NamedDecl *D, bool Internal);
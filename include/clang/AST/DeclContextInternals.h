@@ -245,6 +245,12 @@ private:
   friend class DeclContext;
 
   llvm::PointerIntPair<StoredDeclsMap*, 1> Previous;
+
+  /// For each lexical context whose declarations were added to this map by
+  /// DeclContext::buildLookupImpl, the last declaration that was added. The
+  /// next build starts after it, so that a context with many declarations
+  /// isn't walked again whenever its lookup table needs to be updated.
+  llvm::SmallDenseMap<const DeclContext *, Decl *, 1> LastBuiltDecls;
 };
 
 class DependentStoredDeclsMap : public StoredDeclsMap {
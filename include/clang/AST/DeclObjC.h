@@ -637,8 +637,8 @@ class ObjCTypeParamList final
     : private llvm::TrailingObjects<ObjCTypeParamList, ObjCTypeParamDecl *> {
   /// Stores the components of a SourceRange as a POD.
   struct PODSourceRange {
-    unsigned Begin;
-    unsigned End;
+    SourceLocation::UIntTy Begin;
+    SourceLocation::UIntTy End;
   };
 
   union {
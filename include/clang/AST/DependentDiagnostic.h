@@ -112,7 +112,7 @@ private:
   PartialDiagnostic Diag;
 
   struct {
-    unsigned Loc;
+    SourceLocation::UIntTy Loc;
     unsigned Access : 2;
     unsigned IsMember : 1;
     NamedDecl *TargetDecl;
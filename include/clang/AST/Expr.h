@@ -2810,7 +2810,8 @@ struct MemberExprNameQualifier {
 ///
 class MemberExpr final
     : public Expr,
-      private llvm::TrailingObjects<MemberExpr, MemberExprNameQualifier,
+      private llvm::TrailingObjects<MemberExpr, DeclarationNameLoc,
+                                    MemberExprNameQualifier,
                                     ASTTemplateKWAndArgsInfo,
                                     TemplateArgumentLoc> {
   friend class ASTReader;
@@ -2826,13 +2827,18 @@ class MemberExpr final
   /// In X.F, this is the decl referenced by F.
   ValueDecl *MemberDecl;
 
-  /// MemberDNLoc - Provides source/type location info for the
-  /// declaration name embedded in MemberDecl.
-  DeclarationNameLoc MemberDNLoc;
-
   /// MemberLoc - This is the location of the member name.
   SourceLocation MemberLoc;
 
+  // The source/type location info for the declaration name embedded in
+  // MemberDecl is only stored as a trailing object when the name is not an
+  // identifier, since it is empty for the identifiers that name almost all
+  // of the members.
+
+  size_t numTrailingObjects(OverloadToken<DeclarationNameLoc>) const {
+    return hasMemberDNLoc();
+  }
+
   size_t numTrailingObjects(OverloadToken<MemberExprNameQualifier>) const {
     return hasQualifierOrFoundDecl();
   }
@@ -2849,6 +2855,14 @@ class MemberExpr final
     return MemberExprBits.HasTemplateKWAndArgsInfo;
   }
 
+  bool hasMemberDNLoc() const { return MemberExprBits.HasMemberDNLoc; }
+
+  /// Whether the source/type location info of a member name needs to be
+  /// stored.
+  static bool needsMemberDNLoc(DeclarationName Name) {
+    return Name.getNameKind() != DeclarationName::Identifier;
+  }
+
   MemberExpr(Expr *Base, bool IsArrow, SourceLocation OperatorLoc,
              ValueDecl *MemberDecl, const DeclarationNameInfo &NameInfo,
              QualType T, ExprValueKind VK, ExprObjectKind OK,
@@ -2882,7 +2896,8 @@ public:
   static MemberExpr *CreateEmpty(const ASTContext &Context, bool HasQualifier,
                                  bool HasFoundDecl,
                                  bool HasTemplateKWAndArgsInfo,
-                                 unsigned NumTemplateArgs);
+                                 unsigned NumTemplateArgs,
+                                 bool HasMemberDNLoc);
 
   void setBase(Expr *E) { Base = E; }
   Expr *getBase() const { return cast<Expr>(Base); }
@@ -2986,8 +3001,10 @@ public:
 
   /// Retrieve the member declaration name info.
   DeclarationNameInfo getMemberNameInfo() const {
-    return DeclarationNameInfo(MemberDecl->getDeclName(),
-                               MemberLoc, MemberDNLoc);
+    return DeclarationNameInfo(MemberDecl->getDeclName(), MemberLoc,
+                               hasMemberDNLoc()
+                                   ? *getTrailingObjects<DeclarationNameLoc>()
+                                   : DeclarationNameLoc());
   }
 
   SourceLocation getOperatorLoc() const { return MemberExprBits.OperatorLoc; }
@@ -4657,10 +4674,10 @@ public:
     uintptr_t NameOrField;
 
     /// The location of the '.' in the designated initializer.
-    unsigned DotLoc;
+    SourceLocation::UIntTy DotLoc;
 
     /// The location of the field name in the designated initializer.
-    unsigned FieldLoc;
+    SourceLocation::UIntTy FieldLoc;
   };
 
   /// An array or GNU array-range designator, e.g., "[9]" or "[10..15]".
@@ -4669,12 +4686,12 @@ public:
     /// initializer expression's list of subexpressions.
     unsigned Index;
     /// The location of the '[' starting the array range designator.
-    unsigned LBracketLoc;
+    SourceLocation::UIntTy LBracketLoc;
     /// The location of the ellipsis separating the start and end
     /// indices. Only valid for GNU array-range designators.
-    unsigned EllipsisLoc;
+    SourceLocation::UIntTy EllipsisLoc;
     /// The location of the ']' terminating the array range designator.
-    unsigned RBracketLoc;
+    SourceLocation::UIntTy RBracketLoc;
   };
 
   /// Represents a single C99 designator.
@@ -39,6 +39,7 @@ namespace clang {
 
 class ASTConsumer;
 class ASTContext;
+class ASTRecordLayout;
 class CXXBaseSpecifier;
 class CXXCtorInitializer;
 class CXXRecordDecl;
@@ -243,8 +244,15 @@ public:
   virtual void CompleteType(ObjCInterfaceDecl *Class);
 
   /// Loads comment ranges.
+  ///
+  /// The source may defer loading the comments of each file until
+  /// ReadCommentsInFile() is invoked for it.
   virtual void ReadComments();
 
+  /// Loads the comment ranges of \p File which ReadComments() deferred, if
+  /// any.
+  virtual void ReadCommentsInFile(FileID File);
+
   /// Notify ExternalASTSource that we started deserialization of
   /// a decl or type so until FinishedDeserializing is called there may be
   /// decls that are initializing. Must be paired with FinishedDeserializing.
@@ -303,6 +311,17 @@ public:
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets);
 
+  /// Get the layout of the given record definition that was computed when
+  /// the external source was built, such as a layout stored in an AST file.
+  ///
+  /// Unlike \c layoutRecordType(), the layout is complete, and is used as is
+  /// instead of running the record layout builder.
+  ///
+  /// 
+eturns the layout, allocated in the ASTContext, or null if the record
+  /// wasn't laid out.
+  virtual const ASTRecordLayout *getRecordLayout(const RecordDecl *Record);
+
   //===--------------------------------------------------------------------===//
   // Queries for performance analysis.
   //===--------------------------------------------------------------------===//
@@ -101,7 +101,8 @@ public:
     FirstChild = false;
   }
 
-  NodeStreamer(raw_ostream &OS) : JOS(OS, 2) {}
+  NodeStreamer(raw_ostream &OS, unsigned IndentSize = 2)
+      : JOS(OS, IndentSize) {}
 };
 
 // Dumps AST nodes in JSON format. There is no implied stability for the
@@ -127,6 +128,9 @@ class JSONNodeDumper
   StringRef LastLocFilename;
   unsigned LastLocLine, LastLocPresumedLine;
 
+  /// Whether the locations and ranges of the nodes are dumped.
+  bool DumpLocations = true;
+
   using InnerAttrVisitor = ConstAttrVisitor<JSONNodeDumper>;
   using InnerCommentVisitor =
       comments::ConstCommentVisitor<JSONNodeDumper, void,
@@ -181,9 +185,13 @@ class JSONNodeDumper
 public:
   JSONNodeDumper(raw_ostream &OS, const SourceManager &SrcMgr, ASTContext &Ctx,
                  const PrintingPolicy &PrintPolicy,
-                 const comments::CommandTraits *Traits)
-      : NodeStreamer(OS), SM(SrcMgr), Ctx(Ctx), PrintPolicy(PrintPolicy),
-        Traits(Traits), LastLocLine(0), LastLocPresumedLine(0) {}
+                 const comments::CommandTraits *Traits,
+                 unsigned IndentSize = 2)
+      : NodeStreamer(OS, IndentSize), SM(SrcMgr), Ctx(Ctx),
+        PrintPolicy(PrintPolicy), Traits(Traits), LastLocLine(0),
+        LastLocPresumedLine(0) {}
+
+  void setDumpLocations(bool D) { DumpLocations = D; }
 
   void Visit(const Attr *A);
   void Visit(const Stmt *Node);
@@ -406,8 +414,8 @@ class JSONDumper : public ASTNodeTraverser<JSONDumper, JSONNodeDumper> {
 public:
   JSONDumper(raw_ostream &OS, const SourceManager &SrcMgr, ASTContext &Ctx,
              const PrintingPolicy &PrintPolicy,
-             const comments::CommandTraits *Traits)
-      : NodeDumper(OS, SrcMgr, Ctx, PrintPolicy, Traits) {}
+             const comments::CommandTraits *Traits, unsigned IndentSize = 2)
+      : NodeDumper(OS, SrcMgr, Ctx, PrintPolicy, Traits, IndentSize) {}
 
   JSONNodeDumper &doGetNodeDelegate() { return NodeDumper; }
 
@@ -21,6 +21,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
@@ -494,6 +495,11 @@ protected:
     /// TemplateArguments (if any) are present.
     unsigned HasTemplateKWAndArgsInfo : 1;
 
+    /// True if the name of the member is not a simple identifier, e.g.
+    /// x->operator int or x->~T. When true, a DeclarationNameLoc for the
+    /// name is allocated immediately after the MemberExpr.
+    unsigned HasMemberDNLoc : 1;
+
     /// True if this member expression refers to a method that
     /// was resolved from an overloaded set having size greater than 1.
     unsigned HadMultipleCandidates : 1;
@@ -1085,13 +1091,14 @@ public:
   Stmt &operator=(Stmt &&) = delete;
 
   Stmt(StmtClass SC) {
-    static_assert(sizeof(*this) <= 8,
+    // The bitfields which hold a source location grow with it.
+    static_assert(sizeof(*this) <= 2 * sizeof(SourceLocation),
                   "changing bitfields changed sizeof(Stmt)");
     static_assert(sizeof(*this) % alignof(void *) == 0,
                   "Insufficient alignment!");
     StmtBits.sClass = SC;
     StmtBits.IsOMPStructuredBlock = false;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    if (StatisticsEnabled) Stmt::addStmtClass(SC, this);
   }
 
   StmtClass getStmtClass() const {
@@ -1113,10 +1120,17 @@ public:
   SourceLocation getEndLoc() const LLVM_READONLY;
 
   // global temp stats (until we have a per-module visitor)
-  static void addStmtClass(const StmtClass s);
+  static void addStmtClass(const StmtClass s, const Stmt *S);
   static void EnableStatistics();
   static void PrintStats();
 
+  /// Call \p Visit with the name of each class of statement that was
+  /// created while the statistics were enabled, the number of statements of
+  /// that class and the bytes allocated for them.
+  static void
+  visitStats(llvm::function_ref<void(StringRef Class, unsigned Count,
+                                     uint64_t Bytes)> Visit);
+
   /// Dumps the specified AST fragment and all subtrees to
   /// \c llvm::errs().
   void dump() const;
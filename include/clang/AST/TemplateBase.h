@@ -396,8 +396,8 @@ private:
     // but template arguments get canonicalized too quickly.
     NestedNameSpecifier *Qualifier;
     void *QualifierLocData;
-    unsigned TemplateNameLoc;
-    unsigned EllipsisLoc;
+    SourceLocation::UIntTy TemplateNameLoc;
+    SourceLocation::UIntTy EllipsisLoc;
   };
 
   union {
@@ -4918,6 +4918,8 @@ class alignas(8) TemplateSpecializationType
     : public Type,
       public llvm::FoldingSetNode {
   friend class ASTContext; // ASTContext creates these
+  friend struct llvm::ContextualFoldingSetTrait<TemplateSpecializationType,
+                                                ASTContext &>;
 
   /// The name of the template being specialized.  This is
   /// either a TemplateName::Template (in which case it is a
@@ -4928,6 +4930,12 @@ class alignas(8) TemplateSpecializationType
   /// replacement must, recursively, be one of these).
   TemplateName Template;
 
+  /// The hash of the profile of a canonical specialization, computed when it
+  /// is uniqued, so that the arguments of the uniqued specializations are
+  /// neither profiled again when the set grows nor when one of them is
+  /// compared with a different specialization.
+  unsigned ProfileHash = 0;
+
   TemplateSpecializationType(TemplateName T,
                              ArrayRef<TemplateArgument> Args,
                              QualType Canon,
@@ -5341,6 +5349,8 @@ class alignas(8) DependentTemplateSpecializationType
     : public TypeWithKeyword,
       public llvm::FoldingSetNode {
   friend class ASTContext; // ASTContext creates these
+  friend struct llvm::ContextualFoldingSetTrait<
+      DependentTemplateSpecializationType, ASTContext &>;
 
   /// The nested name specifier containing the qualifier.
   NestedNameSpecifier *NNS;
@@ -5348,6 +5358,10 @@ class alignas(8) DependentTemplateSpecializationType
   /// The identifier of the template.
   const IdentifierInfo *Name;
 
+  /// The hash of the profile, computed when the type is uniqued, as for
+  /// TemplateSpecializationType.
+  unsigned ProfileHash = 0;
+
   DependentTemplateSpecializationType(ElaboratedTypeKeyword Keyword,
                                       NestedNameSpecifier *NNS,
                                       const IdentifierInfo *Name,
@@ -5406,6 +5420,49 @@ public:
   }
 };
 
+} // namespace clang
+
+namespace llvm {
+
+/// The uniqued template specialization types are bucketed by the hash of
+/// their profile, which they keep, and are only profiled again to be compared
+/// with a specialization with the same hash.
+template <>
+struct ContextualFoldingSetTrait<clang::TemplateSpecializationType,
+                                 clang::ASTContext &>
+    : DefaultContextualFoldingSetTrait<clang::TemplateSpecializationType,
+                                       clang::ASTContext &> {
+  static bool Equals(clang::TemplateSpecializationType &X,
+                     const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID, clang::ASTContext &Context);
+
+  static unsigned ComputeHash(clang::TemplateSpecializationType &X,
+                              FoldingSetNodeID &TempID,
+                              clang::ASTContext &Context) {
+    return X.ProfileHash;
+  }
+};
+
+template <>
+struct ContextualFoldingSetTrait<clang::DependentTemplateSpecializationType,
+                                 clang::ASTContext &>
+    : DefaultContextualFoldingSetTrait<
+          clang::DependentTemplateSpecializationType, clang::ASTContext &> {
+  static bool Equals(clang::DependentTemplateSpecializationType &X,
+                     const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID, clang::ASTContext &Context);
+
+  static unsigned ComputeHash(clang::DependentTemplateSpecializationType &X,
+                              FoldingSetNodeID &TempID,
+                              clang::ASTContext &Context) {
+    return X.ProfileHash;
+  }
+};
+
+} // namespace llvm
+
+namespace clang {
+
 /// Represents a pack expansion of types.
 ///
 /// Pack expansions are part of C++11 variadic templates. A pack
@@ -391,6 +391,10 @@ public:
   /// function pointer for the given virtual function is stored.
   uint64_t getMethodVTableIndex(GlobalDecl GD);
 
+  /// Get the thunks of a method, computing the vtable layout of its class
+  /// only if the method may have thunks.
+  const ThunkInfoVectorTy *getThunkInfo(GlobalDecl GD) override;
+
   /// Return the offset in chars (relative to the vtable address point) where
   /// the offset of the virtual base that contains the given base is stored,
   /// otherwise, if no virtual base contains the given class, return 0.
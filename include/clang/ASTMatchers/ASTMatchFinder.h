@@ -64,6 +64,11 @@ namespace ast_matchers {
 ///
 /// See ASTMatchers.h for more information about how to create matchers.
 ///
+/// The matchers are not modified by matching, so a MatchFinder can be set up
+/// once and shared by the actions of several translation units, including
+/// the actions an \c AllTUsToolExecutor runs concurrently, as long as its
+/// callbacks are thread-safe and check profiling is not enabled.
+///
 /// Not intended to be subclassed.
 class MatchFinder {
 public:
@@ -172,6 +177,15 @@ public:
   bool addDynamicMatcher(const internal::DynTypedMatcher &NodeMatch,
                          MatchCallback *Action);
 
+  /// Adds all of the matchers of \p Other, with their callbacks.
+  ///
+  /// This lets independent clients, which each set up a MatchFinder, find
+  /// their matches in a single traversal of the AST. The callbacks of each
+  /// client are only called on the matches of its own matchers.
+  ///
+  /// The matchers of \p Other run after the matchers already added.
+  void addMatchers(const MatchFinder &Other);
+
   /// Creates a clang ASTConsumer that finds all matches.
   std::unique_ptr<clang::ASTConsumer> newASTConsumer();
 
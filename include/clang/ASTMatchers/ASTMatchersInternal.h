@@ -283,6 +283,15 @@ public:
   virtual bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const = 0;
+
+  /// Adds to \p Names the unqualified names of which a node must have one
+  /// to be matched.
+  ///
+  /// \returns false, leaving \p Names unchanged, if the matcher doesn't
+  /// restrict the names of the nodes it matches.
+  virtual bool getRequiredNames(std::vector<StringRef> &Names) const {
+    return false;
+  }
 };
 
 /// Generic interface for matchers on an AST node of type T.
@@ -404,6 +413,12 @@ public:
   ///   binding. Otherwise, returns an empty \c Optional<>.
   llvm::Optional<DynTypedMatcher> tryBind(StringRef ID) const;
 
+  /// Adds to \p Names the unqualified names of which a node must have one
+  /// to be matched. See \c DynMatcherInterface::getRequiredNames().
+  bool getRequiredNames(std::vector<StringRef> &Names) const {
+    return Implementation->getRequiredNames(Names);
+  }
+
   /// Returns a unique \p ID for the matcher.
   ///
   /// Casting a Matcher<T> to Matcher<U> creates a matcher that has the
@@ -708,6 +723,10 @@ class HasNameMatcher : public SingleNodeMatcherInterface<NamedDecl> {
 
   bool matchesNode(const NamedDecl &Node) const override;
 
+  /// Adds the last components of the patterns, if they are plain
+  /// identifiers.
+  bool getRequiredNames(std::vector<StringRef> &Names) const override;
+
  private:
   /// Unqualified match routine.
   ///
@@ -13,6 +13,8 @@
 #include "clang/AST/AST.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Optional.h"
 
 namespace clang {
 
@@ -20,6 +22,11 @@ class FunctionParmMutationAnalyzer;
 
 /// Analyzes whether any mutative operations are applied to an expression within
 /// a given statement.
+///
+/// Each kind of mutation is matched once over the whole statement, the first
+/// time it is looked for, and indexed by the mutated expression, so that the
+/// queries about many expressions or declarations of the same statement do
+/// not match the statement again.
 class ExprMutationAnalyzer {
 public:
   ExprMutationAnalyzer(const Stmt &Stm, ASTContext &Context)
@@ -42,6 +49,13 @@ public:
 private:
   using MutationFinder = const Stmt *(ExprMutationAnalyzer::*)(const Expr *);
   using ResultMap = llvm::DenseMap<const Expr *, const Stmt *>;
+  /// The matches of a statement, by the expression bound as "base".
+  using MatchIndex =
+      llvm::DenseMap<const Expr *, SmallVector<ast_matchers::BoundNodes, 1>>;
+
+  ArrayRef<ast_matchers::BoundNodes> getIndexedMatches(
+      llvm::Optional<MatchIndex> &Index, const Expr *Exp,
+      llvm::function_ref<SmallVector<ast_matchers::BoundNodes, 1>()> Match);
 
   const Stmt *findMutationMemoized(const Expr *Exp,
                                    llvm::ArrayRef<MutationFinder> Finders,
@@ -72,6 +86,20 @@ private:
       FuncParmAnalyzer;
   ResultMap Results;
   ResultMap PointeeResults;
+
+  /// The references to each declaration in the statement, in traversal order.
+  llvm::Optional<llvm::DenseMap<const Decl *, SmallVector<const Expr *, 1>>>
+      DeclRefs;
+  llvm::Optional<llvm::DenseSet<const Expr *>> UnevaluatedExprs;
+  llvm::Optional<MatchIndex> DirectMutations;
+  llvm::Optional<MatchIndex> MemberExprs;
+  llvm::Optional<MatchIndex> SubscriptExprs;
+  llvm::Optional<MatchIndex> ReferenceCasts;
+  llvm::Optional<MatchIndex> MoveCalls;
+  llvm::Optional<MatchIndex> RangeLoopVars;
+  llvm::Optional<MatchIndex> DerefCalls;
+  llvm::Optional<MatchIndex> ReferenceVars;
+  llvm::Optional<MatchIndex> RefArgCalls;
 };
 
 // A convenient wrapper around ExprMutationAnalyzer for analyzing function
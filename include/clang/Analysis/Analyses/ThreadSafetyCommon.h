@@ -285,12 +285,16 @@ public:
     return CapabilityExpr(CapExpr, !Negated);
   }
 
+  // The translations of the same expressions are reused, so the comparisons
+  // first check whether the expressions are the same ones.
   bool equals(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::equals(CapExpr, other.CapExpr);
+    return (Negated == other.Negated) &&
+           (CapExpr == other.CapExpr || sx::equals(CapExpr, other.CapExpr));
   }
 
   bool matches(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::matches(CapExpr, other.CapExpr);
+    return (Negated == other.Negated) &&
+           (CapExpr == other.CapExpr || sx::matches(CapExpr, other.CapExpr));
   }
 
   bool matchesUniv(const CapabilityExpr &CapE) const {
@@ -1093,6 +1093,12 @@ public:
   /// Adds a (potentially unreachable) successor block to the current block.
   void addSuccessor(AdjacentBlock Succ, BumpVectorContext &C);
 
+  /// Makes room for \p N successors, so that adding many successors, e.g. to
+  /// the block of a large switch statement, does not reallocate them.
+  void reserveSuccessors(unsigned N, BumpVectorContext &C) {
+    Succs.reserve(C, N);
+  }
+
   void appendStmt(Stmt *statement, BumpVectorContext &C) {
     Elements.push_back(CFGStmt(statement), C);
   }
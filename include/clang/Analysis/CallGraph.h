@@ -21,10 +21,16 @@
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/GraphTraits.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Error.h"
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace clang {
 
@@ -50,6 +56,10 @@ class CallGraph : public RecursiveASTVisitor<CallGraph> {
   /// This is a virtual root node that has edges to all the functions.
   CallGraphNode *Root;
 
+  /// If non-null, the declarations whose calls are visited later, in the
+  /// order in which they would have been visited.
+  std::vector<Decl *> *DeferredDecls = nullptr;
+
 public:
   CallGraph();
   ~CallGraph();
@@ -62,6 +72,32 @@ public:
     TraverseDecl(D);
   }
 
+  /// Populate the call graph with the functions in the given declarations,
+  /// visiting the bodies of the functions on \p NumThreads threads.
+  ///
+  /// The declarations are walked and the graph is built on this thread, in
+  /// the same order as by addToCallGraph(), so the graph is the same. If the
+  /// AST has an external source, the bodies are visited on this thread, as
+  /// visiting them could deserialize declarations.
+  void addToCallGraph(ArrayRef<Decl *> Decls, unsigned NumThreads);
+
+  /// The callees of the functions, by the names of the functions.
+  using EdgesByName = std::map<std::string, std::set<std::string>>;
+
+  /// Add the edges of the graph to \p Edges, naming the functions with
+  /// \p GetName, e.g. by their USRs, so that the graphs of several translation
+  /// units can be merged. The functions without a name are skipped.
+  void getEdgesByName(
+      llvm::function_ref<llvm::Optional<std::string>(const Decl *)> GetName,
+      EdgesByName &Edges) const;
+
+  /// Write \p Edges as a JSON object, from the name of each function to the
+  /// array of the names of its callees.
+  static void writeEdges(const EdgesByName &Edges, raw_ostream &OS);
+
+  /// Add the edges written by writeEdges() in \p JSON to \p Edges.
+  static llvm::Error readEdges(StringRef JSON, EdgesByName &Edges);
+
   /// Determine if a declaration should be included in the graph.
   static bool includeInGraph(const Decl *D);
 
@@ -262,6 +262,12 @@ public:
 class RecursiveCloneTypeIIHashConstraint {
 public:
   void constrain(std::vector<CloneDetector::CloneGroup> &Sequences);
+
+  /// Computes the hash by which this constraint groups \p S.
+  ///
+  /// The hash only depends on the structure and the types of the statements,
+  /// so it can be compared between translation units.
+  static size_t getHash(const StmtSequence &S);
 };
 
 /// This constraint moves clones into clone groups of type II by comparing them.
@@ -15,7 +15,9 @@
 #ifndef LLVM_CLANG_BASIC_BUILTINS_H
 #define LLVM_CLANG_BASIC_BUILTINS_H
 
+#include "clang/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include <cstring>
 
 // VC++ defines 'alloca' as an object-like macro, which interferes with our
@@ -58,6 +60,8 @@ struct Info {
   const char *Features;
 };
 
+class NameTable;
+
 /// Holds information about both target-independent and
 /// target-specific builtins, allowing easy queries by clients.
 ///
@@ -68,6 +72,13 @@ class Context {
   llvm::ArrayRef<Info> TSRecords;
   llvm::ArrayRef<Info> AuxTSRecords;
 
+  /// The language options the builtins were initialized with, and the
+  /// tables of the names of the builtins, which are null until then.
+  const LangOptions *LangOpts = nullptr;
+  const NameTable *Names = nullptr;
+  const NameTable *TSNames = nullptr;
+  const NameTable *AuxTSNames = nullptr;
+
 public:
   Context() {}
 
@@ -75,11 +86,21 @@ public:
   /// \param AuxTarget Target info to incorporate builtins from. May be nullptr.
   void InitializeTarget(const TargetInfo &Target, const TargetInfo *AuxTarget);
 
-  /// Mark the identifiers for all the builtins with their
-  /// appropriate builtin ID # and mark any non-portable builtin identifiers as
-  /// such.
+  /// Mark the identifiers of \p Table for the builtins with their builtin ID,
+  /// and let \p Table mark the identifiers it creates from now on.
+  ///
+  /// The identifiers of the builtins aren't created, so that the translation
+  /// units mentioning few of the thousands of builtins don't pay for them.
   void initializeBuiltins(IdentifierTable &Table, const LangOptions& LangOpts);
 
+  /// \returns the ID of the builtin named \p Name which is supported by the
+  /// language options the builtins were initialized with, or 0.
+  unsigned lookupBuiltinID(StringRef Name) const;
+
+  /// Create the identifiers of all the supported builtins in \p Table, for
+  /// the clients which walk all the identifiers of the table.
+  void materializeBuiltins(IdentifierTable &Table) const;
+
   /// Return the identifier name for the specified builtin,
   /// e.g. "__builtin_abs".
   const char *getName(unsigned ID) const {
@@ -235,7 +256,7 @@ private:
 
   /// Is this builtin supported according to the given language options?
   bool builtinIsSupported(const Builtin::Info &BuiltinInfo,
-                          const LangOptions &LangOpts);
+                          const LangOptions &LangOpts) const;
 
   /// Helper function for isPrintfLike and isScanfLike.
   bool isLike(unsigned ID, unsigned &FormatIdx, bool &HasVAListArg,
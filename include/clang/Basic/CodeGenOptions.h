@@ -226,6 +226,14 @@ public:
   /// by -fprofile-sample-use or -fprofile-instr-use.
   std::string ProfileRemappingFile;
 
+  /// Name of the object file whose partitions are generated concurrently with
+  /// -fparallel-codegen=, see getParallelCodeGenPartitionName().
+  std::string ParallelCodeGenOutput;
+
+  /// Name of the file listing the mangled names of the discardable functions
+  /// which are provided by a home object file, one per line.
+  std::string HomedFunctionsFile;
+
   /// Name of the function summary index file to use for ThinLTO function
   /// importing.
   std::string ThinLTOIndexFile;
@@ -324,6 +332,12 @@ public:
   /// builtin because a -fno-builtin-* option has been specified?
   bool isNoBuiltinFunc(const char *Name) const;
 
+  /// Get the name of the object file holding the partition \p Partition of
+  /// the object file \p Output generated with -fparallel-codegen=. The first
+  /// partition is \p Output itself.
+  static std::string getParallelCodeGenPartitionName(StringRef Output,
+                                                     unsigned Partition);
+
   const std::vector<std::string> &getNoBuiltinFuncs() const {
     return NoBuiltinFuncs;
   }
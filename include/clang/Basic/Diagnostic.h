@@ -323,6 +323,7 @@ private:
     /// Clear out this map.
     void clear() {
       Files.clear();
+      LastLookupFile = nullptr;
       FirstDiagState = CurDiagState = nullptr;
       CurDiagStateLoc = SourceLocation();
     }
@@ -379,6 +380,11 @@ private:
     /// The diagnostic states for each file.
     mutable std::map<FileID, File> Files;
 
+    /// The file of the last lookup, as the diagnostics reported one after the
+    /// other tend to be in the same file.
+    mutable FileID LastLookupID;
+    mutable File *LastLookupFile = nullptr;
+
     /// The initial diagnostic state.
     DiagState *FirstDiagState;
 
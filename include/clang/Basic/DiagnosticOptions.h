@@ -72,6 +72,7 @@ public:
     DefaultTemplateBacktraceLimit = 10,
     DefaultConstexprBacktraceLimit = 10,
     DefaultSpellCheckingLimit = 50,
+    DefaultSpellCheckingWorkLimit = 10000000,
     DefaultSnippetLineLimit = 1,
   };
 
@@ -15,6 +15,7 @@
 #define LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
@@ -23,6 +24,7 @@
 #include <cstdint>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -83,6 +85,47 @@ public:
                           llvm::vfs::FileSystem &FS) override;
 };
 
+/// A cache of the results of stat() calls that can be shared by the
+/// FileManagers of compiler invocations that run concurrently, e.g. the
+/// workers of a tool that processes many translation units.
+///
+/// Unlike \c MemorizeStatCalls, failed lookups are cached too, which is
+/// where most of the time goes when searching headers in many directories.
+/// Only absolute paths are cached since the others depend on the working
+/// directory. The cache assumes that the file system doesn't change while it
+/// is in use, and that all the FileManagers sharing it see the same files at
+/// those paths.
+class SharedFileSystemStatCache {
+public:
+  SharedFileSystemStatCache();
+
+  /// Create a stat cache backed by this shared cache, to give to a single
+  /// FileManager. It must not outlive this object.
+  std::unique_ptr<FileSystemStatCache> createStatCache();
+
+  /// \returns The cached result for \p Path, or None if there is none.
+  Optional<llvm::ErrorOr<llvm::vfs::Status>> lookup(StringRef Path);
+
+  /// Cache the \p Result of the stat of \p Path, unless it is cached already.
+  void insert(StringRef Path, const llvm::ErrorOr<llvm::vfs::Status> &Result);
+
+  /// Forget the cached results, e.g. because the file system changed.
+  void clear();
+
+private:
+  struct CacheShard {
+    std::mutex Lock;
+    llvm::StringMap<llvm::ErrorOr<llvm::vfs::Status>, llvm::BumpPtrAllocator>
+        Cache;
+  };
+
+  CacheShard &getShard(StringRef Path);
+
+  /// The cache is sharded by path to limit the contention between threads.
+  static const unsigned NumShards = 32;
+  std::unique_ptr<CacheShard[]> Shards;
+};
+
 } // namespace clang
 
 #endif // LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
@@ -40,6 +40,10 @@ class LangOptions;
 class MultiKeywordSelector;
 class SourceLocation;
 
+namespace Builtin {
+class Context;
+} // end namespace Builtin
+
 /// A simple pair of identifier info and location.
 using IdentifierLocPair = std::pair<IdentifierInfo *, SourceLocation>;
 
@@ -490,6 +494,11 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// The builtins which mark the identifiers as they are created, if any.
+  const Builtin::Context *Builtins = nullptr;
+
+  void markBuiltin(IdentifierInfo &II);
+
 public:
   /// Create the identifier table.
   explicit IdentifierTable(IdentifierInfoLookup *ExternalLookup = nullptr);
@@ -509,6 +518,12 @@ public:
     return ExternalLookup;
   }
 
+  /// Mark the identifiers created from now on with the ID of the builtin of
+  /// \p BuiltinInfo they name, if any.
+  void setBuiltinInfo(const Builtin::Context *BuiltinInfo) {
+    Builtins = BuiltinInfo;
+  }
+
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
   }
@@ -536,6 +551,9 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (Builtins)
+      markBuiltin(*II);
+
     return *II;
   }
 
@@ -567,6 +585,9 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (Builtins)
+      markBuiltin(*II);
+
     // If this is the 'import' contextual keyword, mark it as such.
     if (Name.equals("import"))
       II->setModulesImport(true);
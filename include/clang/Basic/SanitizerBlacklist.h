@@ -18,8 +18,12 @@
 #include "clang/Basic/Sanitizers.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <memory>
+#include <string>
 
 namespace clang {
 
@@ -27,6 +31,28 @@ class SanitizerBlacklist {
   std::unique_ptr<SanitizerSpecialCaseList> SSCL;
   SourceManager &SM;
 
+  /// The result of a query of the list, for a mask and a category.
+  struct CachedResult {
+    SanitizerMask Mask;
+    std::string Category;
+    bool Blacklisted;
+  };
+  using CachedResults = SmallVector<CachedResult, 1>;
+
+  /// The results of isBlacklistedLocation() for the locations in each file,
+  /// since all of the functions and globals of a file are queried.
+  mutable llvm::DenseMap<FileID, CachedResults> LocationResults;
+
+  /// The results of isBlacklistedType() for each type name, since the same
+  /// types are queried for every check of a dynamic type.
+  mutable llvm::StringMap<CachedResults> TypeResults;
+
+  /// Return the result in \p Results for \p Mask and \p Category, calling
+  /// \p Compute and caching its result if there is none.
+  template <typename ComputeFn>
+  static bool getCachedResult(CachedResults &Results, SanitizerMask Mask,
+                              StringRef Category, ComputeFn Compute);
+
 public:
   SanitizerBlacklist(const std::vector<std::string> &BlacklistPaths,
                      SourceManager &SM);
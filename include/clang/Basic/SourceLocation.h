@@ -15,6 +15,7 @@
 #define LLVM_CLANG_BASIC_SOURCELOCATION_H
 
 #include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocationConfig.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/PointerLikeTypeTraits.h"
 #include <cassert>
@@ -82,16 +83,30 @@ private:
 /// In addition, one bit of SourceLocation is used for quick access to the
 /// information whether the location is in a file or a macro expansion.
 ///
-/// It is important that this type remains small. It is currently 32 bits wide.
+/// It is important that this type remains small. It is 32 bits wide, unless
+/// clang is configured with CLANG_ENABLE_64BIT_SOURCE_LOCATIONS, which makes
+/// it 64 bits wide so that the buffers can take more than 2 GB.
 class SourceLocation {
   friend class ASTReader;
   friend class ASTWriter;
   friend class SourceManager;
 
-  unsigned ID = 0;
+public:
+  /// The types of the offsets into the manager's global input view, and of
+  /// the differences between them.
+#if CLANG_ENABLE_64BIT_SOURCE_LOCATIONS
+  using UIntTy = uint64_t;
+  using IntTy = int64_t;
+#else
+  using UIntTy = uint32_t;
+  using IntTy = int32_t;
+#endif
+
+private:
+  UIntTy ID = 0;
 
-  enum : unsigned {
-    MacroIDBit = 1U << 31
+  enum : UIntTy {
+    MacroIDBit = UIntTy(1) << (8 * sizeof(UIntTy) - 1)
   };
 
 public:
@@ -108,18 +123,18 @@ public:
 
 private:
   /// Return the offset into the manager's global input view.
-  unsigned getOffset() const {
+  UIntTy getOffset() const {
     return ID & ~MacroIDBit;
   }
 
-  static SourceLocation getFileLoc(unsigned ID) {
+  static SourceLocation getFileLoc(UIntTy ID) {
     assert((ID & MacroIDBit) == 0 && "Ran out of source locations!");
     SourceLocation L;
     L.ID = ID;
     return L;
   }
 
-  static SourceLocation getMacroLoc(unsigned ID) {
+  static SourceLocation getMacroLoc(UIntTy ID) {
     assert((ID & MacroIDBit) == 0 && "Ran out of source locations!");
     SourceLocation L;
     L.ID = MacroIDBit | ID;
@@ -129,7 +144,7 @@ private:
 public:
   /// Return a source location with the specified offset from this
   /// SourceLocation.
-  SourceLocation getLocWithOffset(int Offset) const {
+  SourceLocation getLocWithOffset(IntTy Offset) const {
     assert(((getOffset()+Offset) & MacroIDBit) == 0 && "offset overflow");
     SourceLocation L;
     L.ID = ID+Offset;
@@ -137,17 +152,17 @@ public:
   }
 
   /// When a SourceLocation itself cannot be used, this returns
-  /// an (opaque) 32-bit integer encoding for it.
+  /// an (opaque) integer encoding for it, which is a UIntTy.
   ///
   /// This should only be passed to SourceLocation::getFromRawEncoding, it
   /// should not be inspected directly.
-  unsigned getRawEncoding() const { return ID; }
+  UIntTy getRawEncoding() const { return ID; }
 
   /// Turn a raw encoding of a SourceLocation object into
   /// a real SourceLocation.
   ///
   /// \see getRawEncoding.
-  static SourceLocation getFromRawEncoding(unsigned Encoding) {
+  static SourceLocation getFromRawEncoding(UIntTy Encoding) {
     SourceLocation X;
     X.ID = Encoding;
     return X;
@@ -159,6 +174,8 @@ public:
   /// This should only be passed to SourceLocation::getFromPtrEncoding, it
   /// should not be inspected directly.
   void* getPtrEncoding() const {
+    static_assert(sizeof(UIntTy) <= sizeof(void *),
+                  "64-bit source locations need a 64-bit host");
     // Double cast to avoid a warning "cast to pointer from integer of different
     // size".
     return (void*)(uintptr_t)getRawEncoding();
@@ -167,7 +184,7 @@ public:
   /// Turn a pointer encoding of a SourceLocation object back
   /// into a real SourceLocation.
   static SourceLocation getFromPtrEncoding(const void *Encoding) {
-    return getFromRawEncoding((unsigned)(uintptr_t)Encoding);
+    return getFromRawEncoding((UIntTy)(uintptr_t)Encoding);
   }
 
   static bool isPairOfFileLocations(SourceLocation Start, SourceLocation End) {
@@ -473,7 +490,7 @@ namespace llvm {
     }
 
     static clang::SourceLocation getFromVoidPointer(void *P) {
-      return clang::SourceLocation::getFromRawEncoding((unsigned)(uintptr_t)P);
+      return clang::SourceLocation::getFromPtrEncoding(P);
     }
   };
 
@@ -0,0 +1,9 @@
+/* This generated file is included by clang/Basic/SourceLocation.h. */
+
+#ifndef LLVM_CLANG_BASIC_SOURCELOCATIONCONFIG_H
+#define LLVM_CLANG_BASIC_SOURCELOCATIONCONFIG_H
+
+/* Use 64-bit offsets in SourceLocation */
+#cmakedefine01 CLANG_ENABLE_64BIT_SOURCE_LOCATIONS
+
+#endif
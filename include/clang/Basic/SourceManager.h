@@ -217,6 +217,21 @@ namespace SrcMgr {
     /// with the given buffer.
     void replaceBuffer(const llvm::MemoryBuffer *B, bool DoNotFree = false);
 
+    /// Determine whether the buffer was read from a file by getBuffer(), and
+    /// can therefore be freed and read again.
+    bool canEvictBuffer() const {
+      return Buffer.getPointer() && OrigEntry && ContentsEntry &&
+             !BufferOverridden && !IsTransient && shouldFreeBuffer() &&
+             !isBufferInvalid();
+    }
+
+    /// Free the buffer of a file, so that the next call to getBuffer() reads
+    /// it again from the file manager.
+    ///
+    /// \returns the size of the freed buffer, or 0 if canEvictBuffer() is
+    /// false.
+    unsigned evictBuffer();
+
     /// Determine whether the buffer itself is invalid.
     bool isBufferInvalid() const {
       return Buffer.getInt() & InvalidFlag;
@@ -250,7 +265,7 @@ namespace SrcMgr {
     /// The location of the \#include that brought in this file.
     ///
     /// This is an invalid SLOC for the main file (top of the \#include chain).
-    unsigned IncludeLoc;  // Really a SourceLocation
+    SourceLocation::UIntTy IncludeLoc;
 
     /// Number of FileIDs (files and macros) that were created during
     /// preprocessing of this \#include, including this SLocEntry.
@@ -317,7 +332,7 @@ namespace SrcMgr {
     // Really these are all SourceLocations.
 
     /// Where the spelling for the token can be found.
-    unsigned SpellingLoc;
+    SourceLocation::UIntTy SpellingLoc;
 
     /// In a macro expansion, ExpansionLocStart and ExpansionLocEnd
     /// indicate the start and end of the expansion. In object-like macros,
@@ -325,7 +340,7 @@ namespace SrcMgr {
     /// will be the identifier and the end will be the ')'. Finally, in
     /// macro-argument instantiations, the end will be 'SourceLocation()', an
     /// invalid location.
-    unsigned ExpansionLocStart, ExpansionLocEnd;
+    SourceLocation::UIntTy ExpansionLocStart, ExpansionLocEnd;
 
     /// Whether the expansion range is a token range.
     bool ExpansionIsTokenRange;
@@ -433,8 +448,9 @@ namespace SrcMgr {
   /// SourceManager keeps an array of these objects, and they are uniquely
   /// identified by the FileID datatype.
   class SLocEntry {
-    unsigned Offset : 31;
-    unsigned IsExpansion : 1;
+    static constexpr int OffsetBits = 8 * sizeof(SourceLocation::UIntTy) - 1;
+    SourceLocation::UIntTy Offset : OffsetBits;
+    SourceLocation::UIntTy IsExpansion : 1;
     union {
       FileInfo File;
       ExpansionInfo Expansion;
@@ -443,7 +459,7 @@ namespace SrcMgr {
   public:
     SLocEntry() : Offset(), IsExpansion(), File() {}
 
-    unsigned getOffset() const { return Offset; }
+    SourceLocation::UIntTy getOffset() const { return Offset; }
 
     bool isExpansion() const { return IsExpansion; }
     bool isFile() const { return !isExpansion(); }
@@ -458,8 +474,8 @@ namespace SrcMgr {
       return Expansion;
     }
 
-    static SLocEntry get(unsigned Offset, const FileInfo &FI) {
-      assert(!(Offset & (1u << 31)) && "Offset is too large");
+    static SLocEntry get(SourceLocation::UIntTy Offset, const FileInfo &FI) {
+      assert(!(Offset >> OffsetBits) && "Offset is too large");
       SLocEntry E;
       E.Offset = Offset;
       E.IsExpansion = false;
@@ -467,8 +483,9 @@ namespace SrcMgr {
       return E;
     }
 
-    static SLocEntry get(unsigned Offset, const ExpansionInfo &Expansion) {
-      assert(!(Offset & (1u << 31)) && "Offset is too large");
+    static SLocEntry get(SourceLocation::UIntTy Offset,
+                         const ExpansionInfo &Expansion) {
+      assert(!(Offset >> OffsetBits) && "Offset is too large");
       SLocEntry E;
       E.Offset = Offset;
       E.IsExpansion = true;
@@ -618,6 +635,10 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// file created from this compilation). Defaults to false.
   bool FilesAreTransient = false;
 
+  /// The number of bytes of file contents which evictFileBuffers() keeps in
+  /// memory, or 0 to keep all of them.
+  size_t FileBufferBudget = 0;
+
   struct OverriddenFilesInfoTy {
     /// Files that have been overridden with the contents from another
     /// file.
@@ -658,17 +679,18 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// The starting offset of the next local SLocEntry.
   ///
   /// This is LocalSLocEntryTable.back().Offset + the size of that entry.
-  unsigned NextLocalOffset;
+  SourceLocation::UIntTy NextLocalOffset;
 
   /// The starting offset of the latest batch of loaded SLocEntries.
   ///
   /// This is LoadedSLocEntryTable.back().Offset, except that that entry might
   /// not have been loaded, so that value would be unknown.
-  unsigned CurrentLoadedOffset;
+  SourceLocation::UIntTy CurrentLoadedOffset;
 
-  /// The highest possible offset is 2^31-1, so CurrentLoadedOffset
-  /// starts at 2^31.
-  static const unsigned MaxLoadedOffset = 1U << 31U;
+  /// The highest possible offset is 2^31-1 (or 2^63-1 with 64-bit source
+  /// locations), so CurrentLoadedOffset starts at 2^31 (or 2^63).
+  static const SourceLocation::UIntTy MaxLoadedOffset =
+      SourceLocation::UIntTy(1) << (8 * sizeof(SourceLocation::UIntTy) - 1);
 
   /// A bitmap that indicates whether the entries of LoadedSLocEntryTable
   /// have already been loaded from the external source.
@@ -685,6 +707,23 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// is very common to look up many tokens from the same file.
   mutable FileID LastFileIDLookup;
 
+  /// A small cache of the offset ranges of recently looked up files, for the
+  /// lookups that miss LastFileIDLookup because the queried locations keep
+  /// alternating between a few files (e.g. a header and the main file).
+  struct FileIDLookupRange {
+    SourceLocation::UIntTy Begin = 0;
+    SourceLocation::UIntTy End = 0;
+    FileID FID;
+  };
+  static const unsigned NumFileIDLookupRanges = 8;
+  mutable FileIDLookupRange FileIDLookupRanges[NumFileIDLookupRanges];
+  mutable unsigned NextFileIDLookupRange = 0;
+
+  /// The offsets of the entries of LocalSLocEntryTable, in a dense array so
+  /// that the binary search in getFileIDLocal touches a lot fewer cache lines
+  /// than it would with the entries themselves.
+  SmallVector<SourceLocation::UIntTy, 0> LocalSLocEntryOffsets;
+
   /// Holds information for \#line directives.
   ///
   /// This is referenced by indices from SLocEntryTable.
@@ -706,6 +745,12 @@ class SourceManager : public RefCountedBase<SourceManager> {
   // Statistics for -print-stats.
   mutable unsigned NumLinearScans = 0;
   mutable unsigned NumBinaryProbes = 0;
+  mutable unsigned NumRangeCacheHits = 0;
+  unsigned NumEvictedBuffers = 0;
+
+  /// Statistics for -print-stats: the number of files whose line offsets
+  /// were provided by \c setLineOffsets.
+  unsigned NumLineOffsetsProvided = 0;
 
   /// Associates a FileID with its "included/expanded in" decomposed
   /// location.
@@ -779,6 +824,22 @@ public:
   /// (likely to change while trying to use them).
   bool userFilesAreVolatile() const { return UserFilesAreVolatile; }
 
+  /// Set the number of bytes of file contents which evictFileBuffers() keeps
+  /// in memory. 0, the default, keeps all of them.
+  void setFileBufferBudget(size_t Bytes) { FileBufferBudget = Bytes; }
+  size_t getFileBufferBudget() const { return FileBufferBudget; }
+
+  /// Free the contents of the largest files until the contents of the files
+  /// which remain in memory fit in the budget. The freed contents are read
+  /// again from the file manager when they are needed.
+  ///
+  /// This must only be called between translation units: the lexers and the
+  /// tokens, including those of the macro definitions, point into the
+  /// contents of the files.
+  ///
+  /// \returns the number of files whose contents were freed.
+  unsigned evictFileBuffers();
+
   /// Retrieve the module build stack.
   ModuleBuildStack getModuleBuildStack() const {
     return StoredModuleBuildStack;
@@ -826,7 +887,8 @@ public:
   /// This translates NULL into standard input.
   FileID createFileID(const FileEntry *SourceFile, SourceLocation IncludePos,
                       SrcMgr::CharacteristicKind FileCharacter,
-                      int LoadedID = 0, unsigned LoadedOffset = 0) {
+                      int LoadedID = 0,
+                      SourceLocation::UIntTy LoadedOffset = 0) {
     const SrcMgr::ContentCache *IR =
         getOrCreateContentCache(SourceFile, isSystem(FileCharacter));
     assert(IR && "getOrCreateContentCache() cannot return NULL");
@@ -836,7 +898,8 @@ public:
 
   FileID createFileID(FileEntryRef SourceFile, SourceLocation IncludePos,
                       SrcMgr::CharacteristicKind FileCharacter,
-                      int LoadedID = 0, unsigned LoadedOffset = 0) {
+                      int LoadedID = 0,
+                      SourceLocation::UIntTy LoadedOffset = 0) {
     const SrcMgr::ContentCache *IR = getOrCreateContentCache(
         &SourceFile.getFileEntry(), isSystem(FileCharacter));
     assert(IR && "getOrCreateContentCache() cannot return NULL");
@@ -850,7 +913,7 @@ public:
   /// MemoryBuffer, so only pass a MemoryBuffer to this once.
   FileID createFileID(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                       SrcMgr::CharacteristicKind FileCharacter = SrcMgr::C_User,
-                      int LoadedID = 0, unsigned LoadedOffset = 0,
+                      int LoadedID = 0, SourceLocation::UIntTy LoadedOffset = 0,
                       SourceLocation IncludeLoc = SourceLocation()) {
     StringRef Name = Buffer->getBufferIdentifier();
     return createFileID(
@@ -866,7 +929,7 @@ public:
   /// outlive the SourceManager.
   FileID createFileID(UnownedTag, const llvm::MemoryBuffer *Buffer,
                       SrcMgr::CharacteristicKind FileCharacter = SrcMgr::C_User,
-                      int LoadedID = 0, unsigned LoadedOffset = 0,
+                      int LoadedID = 0, SourceLocation::UIntTy LoadedOffset = 0,
                       SourceLocation IncludeLoc = SourceLocation()) {
     return createFileID(createMemBufferContentCache(Buffer, /*DoNotFree*/ true),
                         Buffer->getBufferIdentifier(), IncludeLoc,
@@ -899,7 +962,7 @@ public:
                                     unsigned TokLength,
                                     bool ExpansionIsTokenRange = true,
                                     int LoadedID = 0,
-                                    unsigned LoadedOffset = 0);
+                                    SourceLocation::UIntTy LoadedOffset = 0);
 
   /// Return a new SourceLocation that encodes that the token starting
   /// at \p TokenStart ends prematurely at \p TokenEnd.
@@ -1083,7 +1146,7 @@ public:
   /// the entry in SLocEntryTable which contains the specified location.
   ///
   FileID getFileID(SourceLocation SpellingLoc) const {
-    unsigned SLocOffset = SpellingLoc.getOffset();
+    SourceLocation::UIntTy SLocOffset = SpellingLoc.getOffset();
 
     // If our one-entry cache covers this offset, just return it.
     if (isOffsetInFileID(LastFileIDLookup, SLocOffset))
@@ -1107,7 +1170,7 @@ public:
     if (Invalid || !Entry.isFile())
       return SourceLocation();
 
-    unsigned FileOffset = Entry.getOffset();
+    SourceLocation::UIntTy FileOffset = Entry.getOffset();
     return SourceLocation::getFileLoc(FileOffset);
   }
 
@@ -1119,7 +1182,7 @@ public:
     if (Invalid || !Entry.isFile())
       return SourceLocation();
 
-    unsigned FileOffset = Entry.getOffset();
+    SourceLocation::UIntTy FileOffset = Entry.getOffset();
     return SourceLocation::getFileLoc(FileOffset + getFileIDSize(FID));
   }
 
@@ -1221,7 +1284,7 @@ public:
     if (Invalid)
       return SourceLocation();
 
-    unsigned GlobalOffset = Entry.getOffset() + Offset;
+    SourceLocation::UIntTy GlobalOffset = Entry.getOffset() + Offset;
     return Entry.isFile() ? SourceLocation::getFileLoc(GlobalOffset)
                           : SourceLocation::getMacroLoc(GlobalOffset);
   }
@@ -1337,8 +1400,8 @@ public:
             (Start.getOffset() >= CurrentLoadedOffset &&
                 Start.getOffset()+Length < MaxLoadedOffset)) &&
            "Chunk is not valid SLoc address space");
-    unsigned LocOffs = Loc.getOffset();
-    unsigned BeginOffs = Start.getOffset();
+    SourceLocation::UIntTy LocOffs = Loc.getOffset();
+    SourceLocation::UIntTy BeginOffs = Start.getOffset();
     unsigned EndOffs = BeginOffs + Length;
     if (LocOffs >= BeginOffs && LocOffs < EndOffs) {
       if (RelativeOffset)
@@ -1355,8 +1418,9 @@ public:
   /// If it's true and \p RelativeOffset is non-null, it will be set to the
   /// offset of \p RHS relative to \p LHS.
   bool isInSameSLocAddrSpace(SourceLocation LHS, SourceLocation RHS,
-                             int *RelativeOffset) const {
-    unsigned LHSOffs = LHS.getOffset(), RHSOffs = RHS.getOffset();
+                             SourceLocation::IntTy *RelativeOffset) const {
+    SourceLocation::UIntTy LHSOffs = LHS.getOffset(),
+                           RHSOffs = RHS.getOffset();
     bool LHSLoaded = LHSOffs >= CurrentLoadedOffset;
     bool RHSLoaded = RHSOffs >= CurrentLoadedOffset;
 
@@ -1406,6 +1470,20 @@ public:
   unsigned getExpansionLineNumber(SourceLocation Loc, bool *Invalid = nullptr) const;
   unsigned getPresumedLineNumber(SourceLocation Loc, bool *Invalid = nullptr) const;
 
+  /// Return the offsets of the start of each line of the file \p FID,
+  /// computing them from the contents of the file if needed.
+  ///
+  /// \returns An empty array if the contents of the file are unavailable.
+  ArrayRef<unsigned> getLineOffsets(FileID FID) const;
+
+  /// Provide the offsets of the start of each line of the file \p FID, as
+  /// returned by \c getLineOffsets for the same contents (e.g. when they were
+  /// stored in an AST file). This avoids scanning the contents of the file
+  /// the first time a line number is needed.
+  ///
+  /// Does nothing if the line offsets of the file are already known.
+  void setLineOffsets(FileID FID, ArrayRef<unsigned> LineOffsets);
+
   /// Return the filename or buffer identifier of the buffer the
   /// location is in.
   ///
@@ -1520,7 +1598,7 @@ public:
   /// of FileID) to \p relativeOffset.
   bool isInFileID(SourceLocation Loc, FileID FID,
                   unsigned *RelativeOffset = nullptr) const {
-    unsigned Offs = Loc.getOffset();
+    SourceLocation::UIntTy Offs = Loc.getOffset();
     if (isOffsetInFileID(FID, Offs)) {
       if (RelativeOffset)
         *RelativeOffset = Offs - getSLocEntry(FID).getOffset();
@@ -1636,8 +1714,9 @@ public:
   /// offset in the "source location address space".
   ///
   /// Note that we always consider source locations loaded from
-  bool isBeforeInSLocAddrSpace(SourceLocation LHS, unsigned RHS) const {
-    unsigned LHSOffset = LHS.getOffset();
+  bool isBeforeInSLocAddrSpace(SourceLocation LHS,
+                               SourceLocation::UIntTy RHS) const {
+    SourceLocation::UIntTy LHSOffset = LHS.getOffset();
     bool LHSLoaded = LHSOffset >= CurrentLoadedOffset;
     bool RHSLoaded = RHS >= CurrentLoadedOffset;
     if (LHSLoaded == RHSLoaded)
@@ -1700,7 +1779,7 @@ public:
     return getSLocEntryByID(FID.ID, Invalid);
   }
 
-  unsigned getNextLocalOffset() const { return NextLocalOffset; }
+  SourceLocation::UIntTy getNextLocalOffset() const { return NextLocalOffset; }
 
   void setExternalSLocEntrySource(ExternalSLocEntrySource *Source) {
     assert(LoadedSLocEntryTable.empty() &&
@@ -1714,8 +1793,9 @@ public:
   /// NumSLocEntries will be allocated, which occupy a total of TotalSize space
   /// in the global source view. The lowest ID and the base offset of the
   /// entries will be returned.
-  std::pair<int, unsigned>
-  AllocateLoadedSLocEntries(unsigned NumSLocEntries, unsigned TotalSize);
+  std::pair<int, SourceLocation::UIntTy>
+  AllocateLoadedSLocEntries(unsigned NumSLocEntries,
+                            SourceLocation::UIntTy TotalSize);
 
   /// Returns true if \p Loc came from a PCH/Module.
   bool isLoadedSourceLocation(SourceLocation Loc) const {
@@ -1782,14 +1862,15 @@ private:
 
   /// Implements the common elements of storing an expansion info struct into
   /// the SLocEntry table and producing a source location that refers to it.
-  SourceLocation createExpansionLocImpl(const SrcMgr::ExpansionInfo &Expansion,
-                                        unsigned TokLength,
-                                        int LoadedID = 0,
-                                        unsigned LoadedOffset = 0);
+  SourceLocation
+  createExpansionLocImpl(const SrcMgr::ExpansionInfo &Expansion,
+                         unsigned TokLength, int LoadedID = 0,
+                         SourceLocation::UIntTy LoadedOffset = 0);
 
   /// Return true if the specified FileID contains the
   /// specified SourceLocation offset.  This is a very hot method.
-  inline bool isOffsetInFileID(FileID FID, unsigned SLocOffset) const {
+  inline bool isOffsetInFileID(FileID FID,
+                               SourceLocation::UIntTy SLocOffset) const {
     const SrcMgr::SLocEntry &Entry = getSLocEntry(FID);
     // If the entry is after the offset, it can't contain it.
     if (SLocOffset < Entry.getOffset()) return false;
@@ -1823,7 +1904,7 @@ private:
   FileID createFileID(const SrcMgr::ContentCache *File, StringRef Filename,
                       SourceLocation IncludePos,
                       SrcMgr::CharacteristicKind DirCharacter, int LoadedID,
-                      unsigned LoadedOffset);
+                      SourceLocation::UIntTy LoadedOffset);
 
   const SrcMgr::ContentCache *
     getOrCreateContentCache(const FileEntry *SourceFile,
@@ -1833,9 +1914,10 @@ private:
   const SrcMgr::ContentCache *
   createMemBufferContentCache(const llvm::MemoryBuffer *Buf, bool DoNotFree);
 
-  FileID getFileIDSlow(unsigned SLocOffset) const;
-  FileID getFileIDLocal(unsigned SLocOffset) const;
-  FileID getFileIDLoaded(unsigned SLocOffset) const;
+  FileID getFileIDSlow(SourceLocation::UIntTy SLocOffset) const;
+  void rememberFileIDLookup(FileID FID) const;
+  FileID getFileIDLocal(SourceLocation::UIntTy SLocOffset) const;
+  FileID getFileIDLoaded(SourceLocation::UIntTy SLocOffset) const;
 
   SourceLocation getExpansionLocSlowCase(SourceLocation Loc) const;
   SourceLocation getSpellingLocSlowCase(SourceLocation Loc) const;
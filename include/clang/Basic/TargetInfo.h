@@ -212,6 +212,18 @@ public:
   CreateTargetInfo(DiagnosticsEngine &Diags,
                    const std::shared_ptr<TargetOptions> &Opts);
 
+  /// Set the function which registers the LLVM targets, which is then called
+  /// once, by the first CreateTargetInfo, rather than when the tool starts.
+  ///
+  /// The tools which don't always compile anything use this to skip the
+  /// registration of every target when they don't.
+  static void setLazyTargetRegistration(void (*Register)());
+
+  /// Register the LLVM targets with the function set by
+  /// setLazyTargetRegistration, if it wasn't called yet. The code which
+  /// looks up the LLVM targets before creating a TargetInfo calls this first.
+  static void registerLazyTargets();
+
   virtual ~TargetInfo();
 
   /// Retrieve the target options.
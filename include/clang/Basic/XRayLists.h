@@ -16,9 +16,13 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/SpecialCaseList.h"
 #include <memory>
+#include <string>
+#include <utility>
 
 namespace clang {
 
@@ -48,6 +52,13 @@ public:
 
   ImbueAttribute shouldImbueLocation(SourceLocation Loc,
                                      StringRef Category = StringRef()) const;
+
+private:
+  /// The results of shouldImbueLocation() for the locations in each file, by
+  /// category, since all of the functions of a file are queried.
+  mutable llvm::DenseMap<FileID,
+                         SmallVector<std::pair<std::string, ImbueAttribute>, 1>>
+      LocationResults;
 };
 
 } // namespace clang
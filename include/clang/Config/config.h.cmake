@@ -75,6 +75,9 @@
 /* Enable the experimental new pass manager by default */
 #cmakedefine01 ENABLE_EXPERIMENTAL_NEW_PASS_MANAGER
 
+/* Spawn a new process clang.exe for the CC1 tool invocation, when necessary */
+#cmakedefine01 CLANG_SPAWN_CC1
+
 /* Enable each functionality of modules */
 #cmakedefine01 CLANG_ENABLE_ARCMT
 #cmakedefine01 CLANG_ENABLE_OBJC_REWRITER
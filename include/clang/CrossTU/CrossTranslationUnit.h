@@ -21,6 +21,14 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+template <typename Info> class OnDiskChainedHashTable;
+} // namespace llvm
 
 namespace clang {
 class CompilerInstance;
@@ -47,7 +55,11 @@ enum class index_error_code {
   triple_mismatch,
   lang_mismatch,
   lang_dialect_mismatch,
-  load_threshold_reached
+  load_threshold_reached,
+  missing_compilation_database,
+  invalid_compilation_database,
+  missing_compile_command,
+  invalid_binary_index_format
 };
 
 class IndexError : public llvm::ErrorInfo<IndexError> {
@@ -90,6 +102,58 @@ parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir);
 
 std::string createCrossTUIndexString(const llvm::StringMap<std::string> &Index);
 
+/// An index in a binary format, which maps the lookup names to the files with
+///        an on-disk hash table.
+///
+/// Unlike the textual index, it is not parsed when it is loaded: the lookup
+/// names are looked up in the memory mapped file, and only the table of the
+/// file names is read. This makes the startup of the analysis independent of
+/// the number of definitions. The indexes of this format are written by
+/// clang-extdef-mapping with the '-binary-index' option.
+class CrossTUBinaryIndex {
+public:
+  ~CrossTUBinaryIndex();
+
+  /// Write the entries of a textual \p Index in the binary format. The
+  /// stream must be at the start of the file.
+  static void write(const llvm::StringMap<std::string> &Index,
+                    raw_ostream &OS);
+
+  /// Whether \p Contents is the contents of a binary index.
+  static bool isBinaryIndex(StringRef Contents);
+
+  /// Create an index from the contents of a binary index file. The file names
+  /// are relative to \p CrossTUDir, like for the textual index.
+  static llvm::Expected<std::unique_ptr<CrossTUBinaryIndex>>
+  create(std::unique_ptr<llvm::MemoryBuffer> Buffer, StringRef CrossTUDir);
+
+  /// \return The path of the file with the definition of \p LookupName, or
+  /// None if the index has no entry for it.
+  llvm::Optional<StringRef> lookup(StringRef LookupName) const;
+
+private:
+  class Trait;
+
+  CrossTUBinaryIndex() = default;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<llvm::OnDiskChainedHashTable<Trait>> Table;
+  /// The file names of the table, prefixed with the CTU directory.
+  std::vector<std::string> FilePaths;
+};
+
+/// This function parses a JSON compilation database, which describes how to
+///        parse the translation units of the index on demand.
+///
+/// Each command of the database is an object with a "directory", a "file",
+/// and either an "arguments" list or a "command" string.
+///
+/// \return Returns a map where the absolute path of a source file is the key
+///         and the driver command line that parses it is the value or an
+///         error.
+llvm::Expected<llvm::StringMap<std::vector<std::string>>>
+parseCrossTUCompilationDatabase(StringRef DatabasePath);
+
 // Returns true if the variable or any field of a record variable is const.
 bool containsConst(const VarDecl *VD, const ASTContext &ACtx);
 
@@ -136,8 +200,10 @@ public:
   /// A definition with the same declaration will be looked up in the
   /// index file which should be in the \p CrossTUDir directory, called
   /// \p IndexName. In case the declaration is found in the index the
-  /// corresponding AST file will be loaded. If the number of TUs imported
-  /// reaches \p CTULoadTreshold, no loading is performed.
+  /// corresponding AST file will be loaded, or the source file will be parsed
+  /// if the 'ctu-compilation-database' option is set. If the number of TUs
+  /// imported reaches \p CTULoadTreshold, no loading is performed, unless
+  /// the 'ctu-max-memory' option bounds the memory of the loaded TUs instead.
   ///
   /// \return Returns a pointer to the ASTUnit that contains the definition of
   /// the looked up name or an Error.
@@ -181,6 +247,9 @@ private:
       llvm::DenseMap<FileID, std::pair<FileID, ASTUnit *>>;
 
   void lazyInitImporterSharedSt(TranslationUnitDecl *ToTU);
+  /// Forget the importer and the imported source locations of a unit that is
+  /// about to be unloaded.
+  void forgetASTUnit(ASTUnit &Unit);
   ASTImporter &getOrCreateASTImporter(ASTUnit *Unit);
   template <typename T>
   llvm::Expected<const T *> getCrossTUDefinitionImpl(const T *D,
@@ -209,14 +278,27 @@ private:
   /// imported the FileID.
   ImportedFileIDMap ImportedFileIDs;
 
-  /// Functor for loading ASTUnits from AST-dump files.
+  /// Functor for loading ASTUnits from AST-dump files, or for parsing them
+  /// from source files with the commands of a compilation database.
   class ASTFileLoader {
   public:
     ASTFileLoader(const CompilerInstance &CI);
-    std::unique_ptr<ASTUnit> operator()(StringRef ASTFilePath);
+    /// \return The loaded unit, which is a nullptr if loading or parsing it
+    /// failed, or an error if the compilation database can not be used.
+    llvm::Expected<std::unique_ptr<ASTUnit>> operator()(StringRef FilePath);
 
   private:
+    std::unique_ptr<ASTUnit> loadFromDump(StringRef ASTFilePath);
+    llvm::Expected<std::unique_ptr<ASTUnit>>
+    loadFromSource(StringRef SourceFilePath);
+
     const CompilerInstance &CI;
+    /// The compilation database of the source files, or empty if the index
+    /// refers to AST-dump files.
+    const std::string CompilationDatabasePath;
+    /// The driver command lines by absolute source file path, read from the
+    /// compilation database when the first source file is parsed.
+    llvm::StringMap<std::vector<std::string>> CompileCommands;
   };
 
   /// Maintain number of AST loads and check for reaching the load limit.
@@ -242,7 +324,10 @@ private:
   /// are the concerns of ASTUnitStorage class.
   class ASTUnitStorage {
   public:
-    ASTUnitStorage(const CompilerInstance &CI);
+    /// \param OnUnitEvicted Called before a unit is unloaded to stay within
+    /// the 'ctu-max-memory' limit.
+    ASTUnitStorage(const CompilerInstance &CI,
+                   std::function<void(ASTUnit &)> OnUnitEvicted);
     /// Loads an ASTUnit for a function.
     ///
     /// \param FunctionName USR name of the function.
@@ -274,11 +359,23 @@ private:
 
   private:
     llvm::Error ensureCTUIndexLoaded(StringRef CrossTUDir, StringRef IndexName);
+    /// Look up the file of a function in the loaded index.
+    llvm::Optional<StringRef> lookupFileForFunction(StringRef FunctionName);
     llvm::Expected<ASTUnit *> getASTUnitForFile(StringRef FileName,
                                                 bool DisplayCTUProgress);
+    /// Unload the least recently used units, other than \p Keep, until the
+    /// memory of the loaded units is within the limit.
+    void evictUnitsOverMemoryLimit(const ASTUnit *Keep);
+
+    /// A loaded unit, which is a nullptr if the loading failed.
+    struct CachedUnit {
+      std::unique_ptr<clang::ASTUnit> Unit;
+      /// The value of UseCounter when the unit was last used.
+      uint64_t LastUse = 0;
+    };
 
     template <typename... T> using BaseMapTy = llvm::StringMap<T...>;
-    using OwningMapTy = BaseMapTy<std::unique_ptr<clang::ASTUnit>>;
+    using OwningMapTy = BaseMapTy<CachedUnit>;
     using NonOwningMapTy = BaseMapTy<clang::ASTUnit *>;
 
     OwningMapTy FileASTUnitMap;
@@ -286,6 +383,9 @@ private:
 
     using IndexMapTy = BaseMapTy<std::string>;
     IndexMapTy NameFileMap;
+    /// The loaded index if it is in the binary format, in which case
+    /// NameFileMap is not used.
+    std::unique_ptr<CrossTUBinaryIndex> BinaryIndex;
 
     ASTFileLoader FileAccessor;
 
@@ -295,6 +395,12 @@ private:
     /// actually loaded or returned from cache. This information is needed to
     /// maintain the counter.
     ASTLoadGuard LoadGuard;
+
+    /// The limit, in bytes, of the memory of the loaded units, or 0 if their
+    /// number is limited by LoadGuard instead.
+    const size_t MemoryLimit;
+    uint64_t UseCounter = 0;
+    std::function<void(ASTUnit &)> OnUnitEvicted;
   };
 
   ASTUnitStorage ASTStorage;
@@ -26,10 +26,22 @@ namespace clang {
 /// This is not a general purpose directory monitoring tool - list of
 /// limitations follows.
 ///
-/// Only flat directories with no subdirectories are supported. In case
-/// subdirectories are present the behavior is unspecified - events *might* be
-/// passed to Receiver on macOS (due to FSEvents being used) while they
-/// *probably* won't be passed on Linux (due to inotify being used).
+/// Unless the watcher is recursive, only flat directories with no
+/// subdirectories are supported. In case subdirectories are present the
+/// behavior is unspecified - events *might* be passed to Receiver on macOS (due
+/// to FSEvents being used) while they *probably* won't be passed on Linux (due
+/// to inotify being used).
+///
+/// A recursive watcher reports the files of the whole tree of the watched
+/// directory, by their path relative to it, and no events for the directories
+/// themselves except that a directory moved out of the tree is reported as
+/// Removed. On Linux every directory of the tree takes an inotify watch, so a
+/// recursive watcher fails to start, or gets invalidated, once the tree has
+/// more directories than a watcher is allowed to watch.
+///
+/// Events are passed to Receiver in batches, and a batch reports only the last
+/// event of a file, e.g. a file created and then deleted before the batch
+/// was passed is only reported as Removed.
 ///
 /// Known potential inconsistencies
 /// - For files that are deleted befor the initial scan processed them, clients
@@ -103,12 +115,16 @@ public:
   /// Returns llvm::Expected Error if OS kernel API told us we can't start
   /// watching. In such case it's unclear whether just retrying has any chance
   /// to succeed.
+  ///
+  /// If \param Recursive, the subdirectories of \param Path are watched too.
+  /// On Linux they are then watched before create() returns, whatever
+  /// \param WaitForInitialSync.
   static llvm::Expected<std::unique_ptr<DirectoryWatcher>>
   create(llvm::StringRef Path,
          std::function<void(llvm::ArrayRef<DirectoryWatcher::Event> Events,
                             bool IsInitial)>
              Receiver,
-         bool WaitForInitialSync);
+         bool WaitForInitialSync, bool Recursive = false);
 
   virtual ~DirectoryWatcher() = default;
   DirectoryWatcher(const DirectoryWatcher &) = delete;
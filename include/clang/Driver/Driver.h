@@ -15,6 +15,7 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/Phases.h"
 #include "clang/Driver/ToolChain.h"
+#include "clang/Driver/ToolChainCache.h"
 #include "clang/Driver/Types.h"
 #include "clang/Driver/Util.h"
 #include "llvm/ADT/StringMap.h"
@@ -199,6 +200,13 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Pointer to the ExecuteCC1Tool function, if available.
+  /// When the clangDriver lib is used through clang.exe, this provides a
+  /// shortcut for executing the -cc1 command-line directly, in the same
+  /// process.
+  typedef int (*CC1ToolFunc)(SmallVectorImpl<const char *> &ArgV);
+  CC1ToolFunc CC1Main = nullptr;
+
 private:
   /// Raw target triple.
   std::string TargetTriple;
@@ -235,6 +243,10 @@ private:
   /// Certain options suppress the 'no input files' warning.
   unsigned SuppressMissingInputWarning : 1;
 
+  /// The number of independent jobs of a compilation which may be executed
+  /// concurrently, as set by -fdriver-jobs=.
+  unsigned ParallelJobs = 1;
+
   /// Cache of all the ToolChains in use by the driver.
   ///
   /// This maps from the string representation of a triple to a ToolChain
@@ -242,6 +254,10 @@ private:
   /// stored in it, and will clean them up when torn down.
   mutable llvm::StringMap<std::unique_ptr<ToolChain>> ToolChains;
 
+  /// The cache of the toolchain discovery, which is enabled by setting
+  /// CLANG_TOOLCHAIN_CACHE_FILE to the path of the cache file.
+  std::unique_ptr<ToolChainCache> DiscoveryCache;
+
 private:
   /// TranslateInputArgs - Create a new derived argument list from the input
   /// arguments, after applying the standard argument translations.
@@ -306,6 +322,9 @@ public:
 
   llvm::vfs::FileSystem &getVFS() const { return *VFS; }
 
+  /// The cache of the toolchain discovery, or null if it isn't enabled.
+  ToolChainCache *getToolChainCache() const { return DiscoveryCache.get(); }
+
   bool getCheckInputsExist() const { return CheckInputsExist; }
 
   void setCheckInputsExist(bool Value) { CheckInputsExist = Value; }
@@ -333,6 +352,8 @@ public:
   }
 
   bool isSaveTempsEnabled() const { return SaveTemps != SaveTempsNone; }
+
+  unsigned getParallelJobs() const { return ParallelJobs; }
   bool isSaveTempsObj() const { return SaveTemps == SaveTempsObj; }
 
   bool embedBitcodeEnabled() const { return BitcodeEmbed != EmbedNone; }
@@ -73,6 +73,16 @@ class Command {
   /// See Command::setEnvironment
   std::vector<const char *> Environment;
 
+protected:
+  /// Whether this command runs in the current process instead of spawning a
+  /// new one; see CC1Command.
+  bool InProcess = false;
+
+  /// Print the input filenames if PrintInputFilenames is set.
+  void PrintFileNames() const;
+
+private:
+
   /// When a response file is needed, we try to put most arguments in an
   /// exclusive file, while others remains as regular command line arguments.
   /// This functions fills a vector with the regular command line arguments,
@@ -119,7 +129,7 @@ public:
   /// \param NewEnvironment An array of environment variables.
   /// \remark If the environment remains unset, then the environment
   ///         from the parent process will be used.
-  void setEnvironment(llvm::ArrayRef<const char *> NewEnvironment);
+  virtual void setEnvironment(llvm::ArrayRef<const char *> NewEnvironment);
 
   const char *getExecutable() const { return Executable; }
 
@@ -130,6 +140,28 @@ public:
 
   /// Set whether to print the input filenames when executing.
   void setPrintInputFilenames(bool P) { PrintInputFilenames = P; }
+
+  /// Whether the command will be executed in this process or not.
+  bool isInProcess() const { return InProcess; }
+
+  /// Force the command to be executed in a new process.
+  void disableInProcess() { InProcess = false; }
+};
+
+/// Use the CC1 tool callback when available, to avoid creating a new process
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source, const Tool &Creator,
+             const char *Executable, const llvm::opt::ArgStringList &Arguments,
+             ArrayRef<InputInfo> Inputs);
+
+  void Print(llvm::raw_ostream &OS, const char *Terminator, bool Quote,
+             CrashReportInfo *CrashInfo = nullptr) const override;
+
+  int Execute(ArrayRef<Optional<StringRef>> Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+
+  void setEnvironment(llvm::ArrayRef<const char *> NewEnvironment) override;
 };
 
 /// Like Command, but with a fallback which is executed in case
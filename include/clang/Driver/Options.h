@@ -9,10 +9,12 @@
 #ifndef LLVM_CLANG_DRIVER_OPTIONS_H
 #define LLVM_CLANG_DRIVER_OPTIONS_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include <memory>
 
 namespace llvm {
 namespace opt {
+class InputArgList;
 class OptTable;
 }
 }
@@ -48,6 +50,15 @@ enum ID {
 }
 
 const llvm::opt::OptTable &getDriverOptTable();
+
+/// Parses \p Args with the driver option table, like OptTable::ParseArgs().
+/// The -D, -I and -U options, which make up most of the long command lines
+/// written by build systems, are recognized without searching the table.
+llvm::opt::InputArgList parseDriverArgs(llvm::ArrayRef<const char *> Args,
+                                        unsigned &MissingArgIndex,
+                                        unsigned &MissingArgCount,
+                                        unsigned FlagsToInclude = 0,
+                                        unsigned FlagsToExclude = 0);
 }
 }
 
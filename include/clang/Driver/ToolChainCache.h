@@ -0,0 +1,104 @@
+//===--- ToolChainCache.h - Cache of the toolchain discovery ----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_DRIVER_TOOLCHAINCACHE_H
+#define LLVM_CLANG_DRIVER_TOOLCHAINCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/JSON.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace llvm {
+namespace vfs {
+class FileSystem;
+} // namespace vfs
+} // namespace llvm
+
+namespace clang {
+namespace driver {
+
+/// A cache of the results of the toolchain discovery (e.g. of the GCC and CUDA
+/// installations), shared by the driver invocations through a file.
+///
+/// The discovery probes many paths which usually don't exist, which is slow
+/// on network file systems. An entry of the cache remembers the directories
+/// whose contents the discovery depended on, with their modification times,
+/// and is only reused while they are unchanged. Since creating or removing a
+/// file changes the modification time of its directory, recording the
+/// deepest existing directory of a probed path is enough to notice when the
+/// path appears.
+///
+/// The entries are only reused by the same release of clang.
+class ToolChainCache {
+public:
+  /// The files and directories which a discovery depended on.
+  class Roots {
+  public:
+    explicit Roots(llvm::vfs::FileSystem &VFS) : VFS(VFS) {}
+
+    /// Adds \p Path, whether or not it exists.
+    void add(StringRef Path);
+
+    /// Adds the path \p Path, which was looked for in the existing directory
+    /// \p Base: the path itself if it exists, or else its deepest existing
+    /// parent directory under \p Base.
+    void addProbe(StringRef Base, StringRef Path);
+
+  private:
+    friend class ToolChainCache;
+
+    /// Adds \p Path and returns whether it exists.
+    bool addPath(StringRef Path);
+
+    llvm::vfs::FileSystem &VFS;
+    /// The modification times of the roots, in nanoseconds since the epoch,
+    /// or None for the ones which don't exist.
+    llvm::StringMap<Optional<int64_t>> ModTimes;
+  };
+
+  /// Loads the cache from the file \p Path, if it exists. The roots of the
+  /// entries are checked in \p VFS.
+  ToolChainCache(StringRef Path, llvm::vfs::FileSystem &VFS);
+
+  /// Writes the cache if entries were added.
+  ~ToolChainCache();
+
+  /// \returns the values of the entry \p Key, or null if there is no such
+  /// entry or if its roots changed.
+  const llvm::json::Object *lookup(StringRef Key);
+
+  /// Adds the entry \p Key, with the values \p Values found by a discovery
+  /// which depended on \p R.
+  void insert(StringRef Key, llvm::json::Object Values, Roots R);
+
+private:
+  struct Entry {
+    llvm::json::Object Values;
+    llvm::StringMap<Optional<int64_t>> ModTimes;
+    /// Whether the roots were checked to be unchanged.
+    bool IsChecked = false;
+  };
+
+  /// Writes the cache with a temporary file, which is renamed so that the
+  /// concurrent invocations never read a partial cache.
+  void save();
+
+  std::string Path;
+  llvm::vfs::FileSystem &VFS;
+  llvm::StringMap<Entry> Entries;
+  bool IsDirty = false;
+};
+
+} // end namespace driver
+} // end namespace clang
+
+#endif // LLVM_CLANG_DRIVER_TOOLCHAINCACHE_H
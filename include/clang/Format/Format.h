@@ -18,8 +18,12 @@
 #include "clang/Tooling/Core/Replacement.h"
 #include "clang/Tooling/Inclusions/IncludeStyle.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Regex.h"
+#include <map>
+#include <mutex>
 #include <system_error>
+#include <vector>
 
 namespace llvm {
 namespace vfs {
@@ -2283,6 +2287,46 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                StringRef FileName,
                                bool *IncompleteFormat);
 
+/// Formats the successive versions of a file being edited, e.g. the buffer of
+/// an editor that formats as the user types.
+///
+/// The session remembers where the formatted file can be split into
+/// fragments that are formatted independently of each other: the top-level
+/// declarations that follow an empty line. Each call to \c reformat() then
+/// only lexes and parses the fragments that changed since the previous call
+/// or that contain one of the ranges. When the edits leave a fragment that
+/// cannot be formatted on its own, e.g. because they opened a brace or a
+/// comment, the whole file is formatted. So is a file formatted with a style
+/// which derives properties from the whole file, or which has "#else"
+/// branches, which are formatted in passes of their own.
+///
+/// The result is the one of the free function \c reformat() on a file whose
+/// other fragments are already formatted with \p Style.
+class FormattingSession {
+public:
+  FormattingSession(const FormatStyle &Style, StringRef FileName = "<stdin>");
+
+  /// Returns the ``Replacements`` necessary to make all \p Ranges of the
+  /// current version \p Code of the file comply with the style.
+  tooling::Replacements reformat(StringRef Code,
+                                 ArrayRef<tooling::Range> Ranges,
+                                 FormattingAttemptStatus *Status = nullptr);
+
+private:
+  tooling::Replacements reformatAll(StringRef Code,
+                                    ArrayRef<tooling::Range> Ranges,
+                                    FormattingAttemptStatus *Status);
+  void setCode(StringRef NewCode, const tooling::Replacements &Replaces);
+
+  FormatStyle Style;
+  std::string FileName;
+  /// The previous version of the file, after the replacements returned for it.
+  std::string Code;
+  bool HasCode = false;
+  /// The sorted offsets in \c Code at which fragments start, excluding 0.
+  std::vector<unsigned> Boundaries;
+};
+
 /// Clean up any erroneous/redundant code in the given \p Ranges in \p
 /// Code.
 ///
@@ -2329,6 +2373,32 @@ extern const char *DefaultFormatStyle;
 /// Different builds can modify the value to the preferred styles.
 extern const char *DefaultFallbackStyle;
 
+/// A cache of the configuration files found and parsed by ``getStyle()``, so
+/// that each is parsed once when formatting many files. It can be shared by
+/// several threads. The files are assumed not to change while it is used.
+class FormatStyleCache {
+public:
+  /// Sets \p ConfigFile to the configuration file found in \p Directory, or
+  /// to an empty string if there is none. Returns false if it is not cached.
+  bool lookupConfigFile(StringRef Directory, std::string &ConfigFile);
+  void addConfigFile(StringRef Directory, StringRef ConfigFile);
+
+  /// Sets \p Style to the configuration of \p ConfigFile for the language of
+  /// \p Style, and \p EC to the error of parsing it. Returns false if it is
+  /// not cached.
+  bool lookupConfiguration(StringRef ConfigFile, FormatStyle &Style,
+                           std::error_code &EC);
+  void addConfiguration(StringRef ConfigFile, const FormatStyle &Style,
+                        std::error_code EC);
+
+private:
+  std::mutex Mutex;
+  llvm::StringMap<std::string> ConfigFiles;
+  std::map<std::pair<std::string, FormatStyle::LanguageKind>,
+           std::pair<FormatStyle, std::error_code>>
+      Configurations;
+};
+
 /// Construct a FormatStyle based on ``StyleName``.
 ///
 /// ``StyleName`` can take several forms:
@@ -2349,6 +2419,8 @@ extern const char *DefaultFallbackStyle;
 /// language if the filename isn't sufficient.
 /// \param[in] FS The underlying file system, in which the file resides. By
 /// default, the file system is the real file system.
+/// \param[in] Cache If not null, the cache of the configuration files to use
+/// and to add the configuration files read to.
 ///
 /// \returns FormatStyle as specified by ``StyleName``. If ``StyleName`` is
 /// "file" and no file is found, returns ``FallbackStyle``. If no style could be
@@ -2356,7 +2428,8 @@ extern const char *DefaultFallbackStyle;
 llvm::Expected<FormatStyle> getStyle(StringRef StyleName, StringRef FileName,
                                      StringRef FallbackStyle,
                                      StringRef Code = "",
-                                     llvm::vfs::FileSystem *FS = nullptr);
+                                     llvm::vfs::FileSystem *FS = nullptr,
+                                     FormatStyleCache *Cache = nullptr);
 
 // Guesses the language from the ``FileName`` and ``Code`` to be formatted.
 // Defaults to FormatStyle::LK_Cpp.
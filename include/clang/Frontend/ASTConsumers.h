@@ -35,11 +35,13 @@ std::unique_ptr<ASTConsumer> CreateASTPrinter(std::unique_ptr<raw_ostream> OS,
                                               StringRef FilterString);
 
 // AST dumper: dumps the raw AST in human-readable form to the given output
-// stream, or stdout if OS is nullptr.
+// stream, or stdout if OS is nullptr. JSON dumps may omit the source locations
+// and the implicit declarations.
 std::unique_ptr<ASTConsumer>
 CreateASTDumper(std::unique_ptr<raw_ostream> OS, StringRef FilterString,
                 bool DumpDecls, bool Deserialize, bool DumpLookups,
-                ASTDumpOutputFormat Format);
+                ASTDumpOutputFormat Format, bool NoLocations = false,
+                bool NoImplicit = false);
 
 // AST Decl node lister: prints qualified names of all filterable AST Decl
 // nodes.
@@ -38,6 +38,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -66,14 +67,17 @@ class ASTReader;
 class CompilerInstance;
 class CompilerInvocation;
 class Decl;
+class DirectoryListingCache;
 class FileEntry;
 class FileManager;
 class FrontendAction;
 class HeaderSearch;
+class IncludeGuardCache;
 class InputKind;
 class InMemoryModuleCache;
 class PCHContainerOperations;
 class PCHContainerReader;
+class PreambleCache;
 class Preprocessor;
 class PreprocessorOptions;
 class Sema;
@@ -119,6 +123,12 @@ private:
   std::shared_ptr<HeaderSearchOptions>    HSOpts;
   std::shared_ptr<PreprocessorOptions>    PPOpts;
   IntrusiveRefCntPtr<ASTReader> Reader;
+  /// The contents of the header search directories, which are read again only
+  /// when they change between reparses.
+  std::unique_ptr<DirectoryListingCache> DirListingCache;
+  /// The controlling macros of the headers, which let a reparse skip the
+  /// guarded headers that didn't change without reading them.
+  std::unique_ptr<IncludeGuardCache> IncludeGuards;
   bool HadModuleLoaderFatalFailure = false;
 
   struct ASTWriterData;
@@ -221,8 +231,13 @@ private:
   /// of that loading. It must be cleared when preamble is recreated.
   llvm::StringMap<SourceLocation> PreambleSrcLocCache;
 
-  /// The contents of the preamble.
-  llvm::Optional<PrecompiledPreamble> Preamble;
+  /// The contents of the preamble, which may be shared with the other units
+  /// of SharedPreambles.
+  std::shared_ptr<const PrecompiledPreamble> Preamble;
+
+  /// If non-null, the cache through which this unit shares its preamble with
+  /// the other units whose files start with the same includes.
+  std::shared_ptr<PreambleCache> SharedPreambles;
 
   /// When non-NULL, this is the buffer used to store the contents of
   /// the main file when it has been padded for use with the precompiled
@@ -426,6 +441,12 @@ public:
   bool isUnsafeToFree() const { return UnsafeToFree; }
   void setUnsafeToFree(bool Value) { UnsafeToFree = Value; }
 
+  /// Sets the flag which cancels the following reparses and code completions
+  /// once it is set, or clears it if \p Flag is null. A cancelled reparse
+  /// fails, leaving the ASTUnit without translation-unit information. The
+  /// ASTUnit does not own the flag.
+  void setCancellationFlag(const std::atomic<bool> *Flag);
+
   const DiagnosticsEngine &getDiagnostics() const { return *Diagnostics; }
   DiagnosticsEngine &getDiagnostics() { return *Diagnostics; }
 
@@ -784,7 +805,8 @@ public:
       TranslationUnitKind TUKind = TU_Complete,
       bool CacheCodeCompletionResults = false,
       bool IncludeBriefCommentsInCodeCompletion = false,
-      bool UserFilesAreVolatile = false);
+      bool UserFilesAreVolatile = false,
+      std::shared_ptr<PreambleCache> SharedPreambles = nullptr);
 
   /// LoadFromCommandLine - Create an ASTUnit from a vector of command line
   /// arguments, which must specify exactly one source file.
@@ -813,6 +835,12 @@ public:
   /// it(i.e., be an overlay over RealFileSystem). RealFileSystem will be used
   /// if \p VFS is nullptr.
   ///
+  /// \param CancellationFlag - If non-null, parsing stops once the flag is
+  /// set, and the load fails.
+  ///
+  /// \param SharedPreambles - If non-null, the precompiled preamble is taken
+  /// from, and shared through, this cache.
+  ///
   // FIXME: Move OnlyLocalDecls, UseBumpAllocator to setters on the ASTUnit, we
   // shouldn't need to specify them at construction time.
   static ASTUnit *LoadFromCommandLine(
@@ -835,7 +863,9 @@ public:
       bool RetainExcludedConditionalBlocks = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
       std::unique_ptr<ASTUnit> *ErrAST = nullptr,
-      IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS = nullptr);
+      IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS = nullptr,
+      const std::atomic<bool> *CancellationFlag = nullptr,
+      std::shared_ptr<PreambleCache> SharedPreambles = nullptr);
 
   /// Reparse the source files using the same command-line options that
   /// were originally used to produce this translation unit.
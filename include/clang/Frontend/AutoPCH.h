@@ -0,0 +1,40 @@
+//===--- AutoPCH.h - Preambles shared between compilations ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The automatic PCH precompiles the preamble of the main file, i.e. its
+// leading block of includes and other directives, into a directory which is
+// given with -fauto-pch-path=, and loads it in the compilations of the files
+// which start with the same preamble and use the same options.
+//
+// A preamble is built once by the first compilation which needs it, while
+// the others wait on its lock. It is identified by the hash of the options,
+// of the working directory and of the preamble itself, and is rebuilt when
+// the size or the modification time of one of its headers, or of one of the
+// directories of the header search path, changes. The preambles which emit
+// diagnostics aren't reused, so that the compilations print them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_AUTOPCH_H
+#define LLVM_CLANG_FRONTEND_AUTOPCH_H
+
+namespace clang {
+class CompilerInstance;
+
+/// Builds the precompiled preamble of the main file of \p Clang into the
+/// directory given by FrontendOptions::AutoPCHPath, unless it is already
+/// there, and changes the options of \p Clang to load it.
+///
+/// \returns true if the preamble is used. The compilation runs without a
+/// preamble otherwise, e.g. because its options aren't supported or because
+/// its file starts without includes.
+bool useAutoPCH(CompilerInstance &Clang);
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_FRONTEND_AUTOPCH_H
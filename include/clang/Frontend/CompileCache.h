@@ -0,0 +1,99 @@
+//===--- CompileCache.h - Cache of the compilation results ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The compilation cache stores the outputs of the compilations into a
+// directory, which is given with -fcompile-cache-path=.
+//
+// A compilation is identified by the hash of its arguments, without the
+// paths of its outputs, and of the working directory. The manifest of a
+// compilation lists the results of its earlier runs, each with the files
+// which were read by the run and their content hashes, along with the files
+// which were only found and the ones which were looked for and missing. A
+// result is reused while all of them are unchanged, which doesn't require
+// preprocessing the input again.
+//
+// A result holds the object, the diagnostics which were printed and the
+// dependency file.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_COMPILECACHE_H
+#define LLVM_CLANG_FRONTEND_COMPILECACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include <memory>
+#include <string>
+
+namespace llvm {
+namespace vfs {
+class FileSystem;
+} // namespace vfs
+} // namespace llvm
+
+namespace clang {
+class CompilerInstance;
+
+namespace compile_cache {
+class DiagnosticRecorder;
+class TrackingFileSystem;
+class UncacheableMacroCollector;
+} // namespace compile_cache
+
+/// The cache of the result of one compilation.
+class CompileCache {
+public:
+  /// \returns the cache of the compilation of \p Clang, whose cc1 arguments
+  /// are \p Argv, or null if its results can't be cached, e.g. because it
+  /// writes outputs which aren't stored in the cache.
+  static std::unique_ptr<CompileCache> create(CompilerInstance &Clang,
+                                              ArrayRef<const char *> Argv);
+
+  ~CompileCache();
+
+  /// Restores the outputs and prints the diagnostics of an earlier run whose
+  /// inputs are unchanged.
+  ///
+  /// \returns true if there was such a run, in which case the compilation
+  /// must not be executed.
+  bool replay();
+
+  /// Records the files read by the compilation and the diagnostics. This
+  /// must be called before the compilation is executed.
+  void attach();
+
+  /// Stores the outputs and the diagnostics of the compilation after it
+  /// succeeded. Failing to write the cache isn't an error.
+  void store();
+
+private:
+  CompileCache(CompilerInstance &Clang, std::string Key,
+               IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS);
+
+  /// \returns the path of the file \p Name in the cache directory.
+  std::string getCachePath(StringRef Name) const;
+
+  /// Restores the outputs of the result \p Result and prints its
+  /// diagnostics. \returns false if the result is missing.
+  bool restore(StringRef Result);
+
+  CompilerInstance &Clang;
+  std::string Key;
+  /// The file system in which the inputs are read.
+  IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS;
+  IntrusiveRefCntPtr<compile_cache::TrackingFileSystem> TrackingFS;
+  std::shared_ptr<compile_cache::UncacheableMacroCollector> MacroCollector;
+  /// Records the diagnostics of the compilation. It is owned by the
+  /// diagnostics engine.
+  compile_cache::DiagnosticRecorder *Diagnostics = nullptr;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_FRONTEND_COMPILECACHE_H
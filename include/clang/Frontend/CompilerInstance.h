@@ -45,6 +45,7 @@ class FileEntry;
 class FileManager;
 class FrontendAction;
 class InMemoryModuleCache;
+class MemoryReport;
 class Module;
 class Preprocessor;
 class Sema;
@@ -115,6 +116,9 @@ class CompilerInstance : public ModuleLoader {
   /// The frontend timer.
   std::unique_ptr<llvm::Timer> FrontendTimer;
 
+  /// The memory report of -fmemory-report, while executing an action.
+  std::unique_ptr<MemoryReport> MemReport;
+
   /// The ASTReader, if one exists.
   IntrusiveRefCntPtr<ASTReader> ModuleManager;
 
@@ -584,6 +588,14 @@ public:
     return *FrontendTimer;
   }
 
+  /// }
+  /// @name Memory report
+  /// {
+
+  /// \returns the memory report of -fmemory-report, if it is enabled and an
+  /// action is being executed.
+  MemoryReport *getMemoryReport() const { return MemReport.get(); }
+
   /// }
   /// @name Output Files
   /// {
@@ -705,10 +717,14 @@ public:
   /// their result (that is, the data is written to a temporary file which will
   /// atomically replace the target output on success).
   ///
+  /// If \p NeedsSeeking is false, the stream is written sequentially by its
+  /// user, and a binary output that doesn't support seeking (e.g. a pipe) is
+  /// not buffered in memory until the stream is destroyed.
+  ///
   /// \return - Null on error.
   std::unique_ptr<raw_pwrite_stream>
   createDefaultOutputFile(bool Binary = true, StringRef BaseInput = "",
-                          StringRef Extension = "");
+                          StringRef Extension = "", bool NeedsSeeking = true);
 
   /// Create a new output file and add it to the list of tracked output files,
   /// optionally deriving the output path name.
@@ -717,7 +733,8 @@ public:
   std::unique_ptr<raw_pwrite_stream>
   createOutputFile(StringRef OutputPath, bool Binary, bool RemoveFileOnSignal,
                    StringRef BaseInput, StringRef Extension, bool UseTemporary,
-                   bool CreateMissingDirectories = false);
+                   bool CreateMissingDirectories = false,
+                   bool NeedsSeeking = true);
 
   /// Create a new output file, optionally deriving the output path name.
   ///
@@ -744,12 +761,15 @@ public:
   /// stored here on success.
   /// \param TempPathName [out] - If given, the temporary file path name
   /// will be stored here on success.
+  /// \param NeedsSeeking - Whether the user of the stream may seek in it. If
+  /// so, a binary output that doesn't support seeking is written through a
+  /// buffer_ostream.
   std::unique_ptr<raw_pwrite_stream>
   createOutputFile(StringRef OutputPath, std::error_code &Error, bool Binary,
                    bool RemoveFileOnSignal, StringRef BaseInput,
                    StringRef Extension, bool UseTemporary,
                    bool CreateMissingDirectories, std::string *ResultPathName,
-                   std::string *TempPathName);
+                   std::string *TempPathName, bool NeedsSeeking = true);
 
   std::unique_ptr<raw_pwrite_stream> createNullOutputFile();
 
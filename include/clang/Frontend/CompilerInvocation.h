@@ -142,6 +142,10 @@ class CompilerInvocation : public CompilerInvocationBase {
 public:
   CompilerInvocation() : AnalyzerOpts(new AnalyzerOptions()) {}
 
+  /// Copies all the options, including the analyzer options, so that the
+  /// copy can be changed, or copied again, independently of \p X.
+  CompilerInvocation(const CompilerInvocation &X);
+
   /// @name Utility Methods
   /// @{
 
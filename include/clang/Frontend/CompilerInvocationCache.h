@@ -0,0 +1,67 @@
+//===- CompilerInvocationCache.h - Invocations shared by tools --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the CompilerInvocationCache, which lets the tools that run many
+/// translation units with mostly the same flags parse the flags once.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_COMPILERINVOCATIONCACHE_H
+#define LLVM_CLANG_FRONTEND_COMPILERINVOCATIONCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+#include <mutex>
+
+namespace clang {
+
+class CompilerInvocation;
+class DiagnosticsEngine;
+
+/// A thread-safe cache of the invocations created from cc1 command lines.
+///
+/// The invocations are keyed by their arguments without the ones which are
+/// specific to a translation unit: the input file, the -o, -main-file-name,
+/// -MT and -dependency-file values, and the -D and -U macros. A command line
+/// whose other arguments were already parsed gets a copy of the cached
+/// invocation with these options set again, instead of being parsed.
+///
+/// Only the command lines which were parsed without diagnostics are cached,
+/// so that a copy never misses one.
+class CompilerInvocationCache {
+public:
+  /// Create an invocation from \p CommandLineArgs, as
+  /// CompilerInvocation::CreateFromArgs() would.
+  ///
+  /// \returns the invocation, which is in a valid but arbitrary state if
+  /// \p Diags reported an error.
+  std::unique_ptr<CompilerInvocation>
+  createInvocation(ArrayRef<const char *> CommandLineArgs,
+                   DiagnosticsEngine &Diags);
+
+  /// Forget all the invocations.
+  void clear();
+
+private:
+  struct Entry {
+    std::shared_ptr<const CompilerInvocation> Invocation;
+    /// The number of macros of the invocation which don't come from -D and
+    /// -U, e.g. __CET__. They precede the ones from the command line.
+    size_t NumImplicitMacros = 0;
+  };
+
+  std::mutex Lock;
+  llvm::StringMap<Entry> Invocations;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_FRONTEND_COMPILERINVOCATIONCACHE_H
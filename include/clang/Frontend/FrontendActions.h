@@ -101,6 +101,13 @@ public:
   CreateOutputFile(CompilerInstance &CI, StringRef InFile,
                    std::string &OutputFile);
 
+  /// Creates the consumer which serializes the AST of the translation unit
+  /// into \p OS, which writes the file \p OutputFile.
+  static std::unique_ptr<ASTConsumer>
+  CreatePCHWriter(CompilerInstance &CI, StringRef InFile,
+                  StringRef OutputFile, std::unique_ptr<raw_pwrite_stream> OS,
+                  std::string Sysroot);
+
   bool BeginSourceFileAction(CompilerInstance &CI) override;
 };
 
@@ -130,6 +137,14 @@ class GenerateInterfaceIfsExpV1Action : public GenerateInterfaceStubAction {
 protected:
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override;
+
+public:
+  /// Creates the consumer which writes the interface stubs of the
+  /// translation unit into \p OutputFile, or into the default output file if
+  /// it is empty.
+  static std::unique_ptr<ASTConsumer>
+  CreateStubsWriter(CompilerInstance &CI, StringRef InFile,
+                    StringRef OutputFile);
 };
 
 class GenerateModuleFromModuleMapAction : public GenerateModuleAction {
@@ -15,6 +15,7 @@
 #include "clang/Sema/CodeCompleteOptions.h"
 #include "clang/Serialization/ModuleFileExtension.h"
 #include "llvm/ADT/StringRef.h"
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <string>
@@ -285,6 +286,12 @@ public:
   /// Whether we include lookup table dumps in AST dumps.
   unsigned ASTDumpLookups : 1;
 
+  /// Whether we omit the source locations from JSON AST dumps.
+  unsigned ASTDumpNoLocations : 1;
+
+  /// Whether we omit the implicit declarations from JSON AST dumps.
+  unsigned ASTDumpNoImplicit : 1;
+
   /// Whether we are performing an implicit module build.
   unsigned BuildingImplicitModule : 1;
 
@@ -415,6 +422,18 @@ public:
   /// The list of AST files to merge.
   std::vector<std::string> ASTMergeFiles;
 
+  /// The secondary outputs, which are written along with the output of the
+  /// action from the same parse of the translation unit.
+  ///
+  /// The file into which the serialized AST is written, if any.
+  std::string ASTOutputFile;
+
+  /// The directory into which the index records are written, if any.
+  std::string IndexRecordPath;
+
+  /// The file into which the interface stubs are written, if any.
+  std::string InterfaceStubsOutputFile;
+
   /// A list of arguments to forward to LLVM's option processing; this
   /// should only be used for debugging and experimental features.
   std::vector<std::string> LLVMArgs;
@@ -429,9 +448,35 @@ public:
   /// Filename to write statistics to.
   std::string StatsFile;
 
+  /// Filename to write the aggregated costs of the template instantiations
+  /// to.
+  std::string TemplateProfileFile;
+
+  /// Filename to write the aggregated costs of the included headers to.
+  std::string HeaderCostReportFile;
+
+  /// Filename to write the memory held by each domain of the compiler at
+  /// the end of each phase to.
+  std::string MemoryReportFile;
+
+  /// The directory of the cache of the compilation results, if any.
+  std::string CompileCachePath;
+
+  /// The directory of the precompiled preambles shared between the
+  /// compilations, if any.
+  std::string AutoPCHPath;
+
+  /// If given, parsing stops at the next top-level declaration once the flag
+  /// is set, e.g. by another thread. This object does not own the flag.
+  const std::atomic<bool> *CancellationFlag = nullptr;
+
   /// Minimum time granularity (in microseconds) traced by time profiler.
   unsigned TimeTraceGranularity;
 
+  /// The number of bytes of source file contents which are kept in memory
+  /// after an input file was processed, or 0 to keep all of them.
+  unsigned SourceBufferBudget = 0;
+
 public:
   FrontendOptions()
       : DisableFree(false), RelocatablePCH(false), ShowHelp(false),
@@ -440,7 +485,8 @@ public:
         FixAndRecompile(false), FixToTemporaries(false),
         ARCMTMigrateEmitARCErrors(false), SkipFunctionBodies(false),
         UseGlobalModuleIndex(true), GenerateGlobalModuleIndex(true),
-        ASTDumpDecls(false), ASTDumpLookups(false),
+        ASTDumpDecls(false), ASTDumpLookups(false), ASTDumpNoLocations(false),
+        ASTDumpNoImplicit(false),
         BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
         IncludeTimestamps(true), TimeTraceGranularity(500) {}
 
@@ -0,0 +1,65 @@
+//===- MemoryReport.h - Memory of the compiler per domain -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the MemoryReport, which records the memory held by each domain of
+/// the compiler, e.g. the AST or the source manager, at the boundaries of the
+/// phases of a compilation, for -fmemory-report.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_MEMORYREPORT_H
+#define LLVM_CLANG_FRONTEND_MEMORYREPORT_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/JSON.h"
+#include <cstdint>
+#include <vector>
+
+namespace clang {
+
+class CompilerInstance;
+
+/// The memory held by each domain of a compiler instance at the end of each
+/// phase of the compilation.
+///
+/// The memory of some domains, e.g. the exploded graph of the function being
+/// analyzed, is released before the end of the phase. They note their peak
+/// instead, which goes into the next snapshot.
+class MemoryReport {
+public:
+  /// Record the memory held by the domains of \p CI at the end of \p Phase.
+  void addSnapshot(StringRef Phase, const CompilerInstance &CI);
+
+  /// Record an "end-of-main-file" snapshot when the preprocessor of \p CI
+  /// reaches the end of the main file, i.e. once it has been parsed.
+  void attachToPreprocessor(CompilerInstance &CI);
+
+  /// Note that the memory of \p Field of \p Domain reached \p Value.
+  void notePeak(StringRef Domain, StringRef Field, uint64_t Value);
+
+  /// Write the snapshots as JSON.
+  void write(raw_ostream &OS) const;
+
+  /// Write the snapshots as JSON to \p OutputFile.
+  ///
+  /// \returns true on failure, which is reported to the diagnostics of
+  /// \p CI.
+  bool write(StringRef OutputFile, CompilerInstance &CI) const;
+
+private:
+  std::vector<llvm::json::Value> Snapshots;
+
+  /// The peaks noted since the last snapshot, keyed by domain and field.
+  llvm::StringMap<llvm::StringMap<uint64_t>> Peaks;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_FRONTEND_MEMORYREPORT_H
@@ -71,6 +71,7 @@ public:
   ASTDeserializationListener *GetASTDeserializationListener() override;
   void PrintStats() override;
   bool shouldSkipFunctionBody(Decl *D) override;
+  bool shouldDeferFunctionBody(Decl *D) override;
 
   // SemaConsumer
   void InitializeSema(Sema &S) override;
@@ -0,0 +1,91 @@
+//===- PreambleCache.h - Preambles shared between ASTUnits ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the PreambleCache, which shares the precompiled preambles between
+/// the ASTUnits of files which start with the same includes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_PREAMBLECACHE_H
+#define LLVM_CLANG_FRONTEND_PREAMBLECACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/PrecompiledPreamble.h"
+#include "clang/Serialization/ASTBitCodes.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+namespace vfs {
+class FileSystem;
+} // namespace vfs
+} // namespace llvm
+
+namespace clang {
+
+class CompilerInvocation;
+
+/// A thread-safe cache of the precompiled preambles of several ASTUnits,
+/// which lets the files of a project that start with the same includes, and
+/// are parsed with the same options, share a single preamble instead of each
+/// building and keeping its own.
+///
+/// The cache only keeps weak references to the preambles, so a preamble is
+/// freed with the last unit which uses it.
+class PreambleCache {
+public:
+  /// A preamble, with the results of the build that the units which reuse
+  /// it would otherwise get from building it themselves.
+  struct Entry {
+    std::shared_ptr<const PrecompiledPreamble> Preamble;
+    /// The main file of the unit which built the preamble.
+    std::string MainFilePath;
+    std::vector<serialization::DeclID> TopLevelDecls;
+    unsigned TopLevelHashValue = 0;
+    unsigned NumWarnings = 0;
+    SmallVector<ASTUnit::StandaloneDiagnostic, 4> Diagnostics;
+  };
+
+  /// \returns the key of the preambles which can be shared with the main file
+  /// \p MainFilePath, parsed with \p Invocation. The preambles of the files in
+  /// other directories aren't shared, since their includes may find other
+  /// headers.
+  static std::string getKey(const CompilerInvocation &Invocation,
+                            StringRef MainFilePath, bool SkipFunctionBodies);
+
+  /// \returns a preamble with the key \p Key which can be used for
+  /// \p MainFileBuffer, as checked by PrecompiledPreamble::CanReuse().
+  Optional<Entry> lookup(StringRef Key, const CompilerInvocation &Invocation,
+                         const llvm::MemoryBuffer *MainFileBuffer,
+                         PreambleBounds Bounds, llvm::vfs::FileSystem *VFS);
+
+  /// Remember the preamble \p E with the key \p Key.
+  void insert(StringRef Key, Entry E);
+
+private:
+  struct CachedEntry {
+    std::weak_ptr<const PrecompiledPreamble> Preamble;
+    /// The results of the build, without the preamble.
+    Entry Results;
+  };
+
+  std::mutex Lock;
+  llvm::StringMap<std::vector<CachedEntry>> Preambles;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_FRONTEND_PREAMBLECACHE_H
@@ -94,6 +94,11 @@ public:
   /// be used for logging and debugging purposes only.
   std::size_t getSize() const;
 
+  /// Writes the PCH of the preamble to \p OS, e.g. to keep it after the
+  /// PrecompiledPreamble is destroyed. \returns false if the PCH of an
+  /// on-disk preamble can't be read.
+  bool writePCH(raw_ostream &OS) const;
+
   /// Check whether PrecompiledPreamble can be reused for the new contents(\p
   /// MainFileBuffer) of the main file.
   bool CanReuse(const CompilerInvocation &Invocation,
@@ -209,15 +214,30 @@ private:
     /// buffers it is zero.
     time_t ModTime = 0;
 
-    /// Memory buffers have MD5 instead of modification time.  We don't
-    /// compute MD5 for on-disk files because we hope that modification time is
-    /// enough to tell if the file was changed.
+    /// Memory buffers have MD5 instead of modification time. On-disk files
+    /// have it too when their contents are known, so that an on-disk file
+    /// whose modification time changed is only considered changed if its
+    /// contents are.
     llvm::MD5::MD5Result MD5 = {};
 
-    static PreambleFileHash createForFile(off_t Size, time_t ModTime);
+    static PreambleFileHash
+    createForFile(off_t Size, time_t ModTime,
+                  const llvm::MemoryBuffer *Contents = nullptr);
     static PreambleFileHash
     createForMemoryBuffer(const llvm::MemoryBuffer *Buffer);
 
+    bool hasMD5() const { return MD5 != llvm::MD5::MD5Result(); }
+
+    /// Whether \p Other describes the same contents: either the same file
+    /// with the same modification time, or the same MD5.
+    bool hasSameContents(const PreambleFileHash &Other) const {
+      if (Size != Other.Size)
+        return false;
+      if (ModTime == Other.ModTime && MD5 == Other.MD5)
+        return true;
+      return hasMD5() && Other.hasMD5() && MD5 == Other.MD5;
+    }
+
     friend bool operator==(const PreambleFileHash &LHS,
                            const PreambleFileHash &RHS) {
       return LHS.Size == RHS.Size && LHS.ModTime == RHS.ModTime &&
@@ -24,6 +24,7 @@ public:
   unsigned ShowIncludeDirectives : 1;  ///< Print includes, imports etc. within preprocessed output.
   unsigned RewriteIncludes : 1;    ///< Preprocess include directives only.
   unsigned RewriteImports  : 1;    ///< Include contents of transitively-imported modules.
+  unsigned CopySourceSpans : 1;    ///< Copy unexpanded source text between tokens.
 
 public:
   PreprocessorOutputOptions() {
@@ -36,6 +37,7 @@ public:
     ShowIncludeDirectives = 0;
     RewriteIncludes = 0;
     RewriteImports = 0;
+    CopySourceSpans = 0;
   }
 };
 
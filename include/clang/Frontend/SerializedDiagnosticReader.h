@@ -11,8 +11,10 @@
 
 #include "clang/Basic/LLVM.h"
 #include "llvm/Bitstream/BitstreamReader.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <system_error>
 
 namespace clang {
@@ -65,9 +67,32 @@ public:
   /// Read the diagnostics in \c File
   std::error_code readDiagnostics(StringRef File);
 
+  /// Read the diagnostics in \p Buffer.
+  std::error_code readDiagnostics(llvm::MemoryBufferRef Buffer);
+
+  /// Index the diagnostics in \p Buffer without decoding them: only the
+  /// records which define the categories, flags and files, which the later
+  /// diagnostics refer to, and the diagnostic record of each top-level
+  /// diagnostic, with visitIndexedDiagnostic(), are visited.
+  std::error_code indexDiagnostics(llvm::MemoryBufferRef Buffer);
+
+  /// Read the top-level diagnostic at \p BitOffset of \p Buffer, as given to
+  /// visitIndexedDiagnostic() by indexDiagnostics(Buffer).
+  std::error_code readDiagnosticAt(llvm::MemoryBufferRef Buffer,
+                                   uint64_t BitOffset);
+
 private:
   enum class Cursor;
 
+  /// The block info of the diagnostics which were read last.
+  Optional<llvm::BitstreamBlockInfo> BlockInfo;
+
+  /// Whether the diagnostics are only indexed.
+  bool IndexOnly = false;
+
+  std::error_code readDiagnostics(llvm::MemoryBufferRef Buffer,
+                                  bool OnlyIndex);
+
   /// Read to the next record or block to process.
   llvm::ErrorOr<Cursor> skipUntilRecordOrBlock(llvm::BitstreamCursor &Stream,
                                                unsigned &BlockOrRecordId);
@@ -75,8 +100,10 @@ private:
   /// Read a metadata block from \c Stream.
   std::error_code readMetaBlock(llvm::BitstreamCursor &Stream);
 
-  /// Read a diagnostic block from \c Stream.
-  std::error_code readDiagnosticBlock(llvm::BitstreamCursor &Stream);
+  /// Read a diagnostic block from \c Stream. \p IndexedOffset is the offset
+  /// of a top-level block which is indexed.
+  std::error_code readDiagnosticBlock(llvm::BitstreamCursor &Stream,
+                                      Optional<uint64_t> IndexedOffset = None);
 
 protected:
   /// Visit the start of a diagnostic block.
@@ -102,6 +129,15 @@ protected:
     return {};
   }
 
+  /// Visit the diagnostic record of a top-level diagnostic which is indexed,
+  /// which starts at \c BitOffset.
+  virtual std::error_code
+  visitIndexedDiagnostic(uint64_t BitOffset, unsigned Severity,
+                         const Location &Location, unsigned Category,
+                         unsigned Flag, StringRef Message) {
+    return {};
+  }
+
   /// Visit a filename. This associates the file's \c ID to a \c Name.
   virtual std::error_code visitFilenameRecord(unsigned ID, unsigned Size,
                                               unsigned Timestamp,
@@ -57,6 +57,7 @@ class PCHContainerReader;
 class Preprocessor;
 class PreprocessorOptions;
 class PreprocessorOutputOptions;
+class TemplateInstantiationCallback;
 
 /// Apply the header search options to get given HeaderSearch object.
 void ApplyHeaderSearchOptions(HeaderSearch &HS,
@@ -210,6 +211,22 @@ IntrusiveRefCntPtr<ExternalSemaSource>
 createChainedIncludesSource(CompilerInstance &CI,
                             IntrusiveRefCntPtr<ExternalSemaSource> &Reader);
 
+/// Create a template instantiation callback that attributes the time and the
+/// AST memory spent instantiating templates to the instantiated templates, and
+/// writes the aggregated report to \p OutputFile once parsing is done.
+std::unique_ptr<TemplateInstantiationCallback>
+createTemplateProfileCallback(StringRef OutputFile);
+
+/// Attach to the preprocessor of \p CI a callback that attributes the time and
+/// the AST memory spent while each header is being lexed to that header, and
+/// writes the aggregated report to \p OutputFile at the end of the main file.
+void AttachHeaderCostReportGen(CompilerInstance &CI, StringRef OutputFile);
+
+/// Attach to the preprocessor and the Sema of \p CI the callbacks that find
+/// the includes of the main file whose declarations and macros the translation
+/// unit never uses, and diagnose them with -Wunused-include at its end.
+void AttachUnusedIncludeFinder(CompilerInstance &CI);
+
 /// createInvocationFromCommandLine - Construct a compiler invocation object for
 /// a command line argument vector.
 ///
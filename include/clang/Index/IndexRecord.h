@@ -0,0 +1,187 @@
+//===--- IndexRecord.h - On-disk index records ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An index record holds the declaration occurrences of one file of a
+// translation unit. A record starts with a header, followed by the table of
+// the symbols sorted by USR, the occurrences grouped by symbol and sorted by
+// offset, the positions of the occurrences sorted by offset, and the strings.
+// All of the fields are little-endian, so a record is read directly in the
+// memory mapped file.
+//
+// Records are named after the hash of their contents, so a header which is
+// indexed the same way by several translation units is only written once.
+//
+// A unit lists the records of the files of one translation unit. It is a text
+// file with the path of the main file on the first line, followed by the
+// names of the records in the same directory, one per line.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_INDEX_INDEXRECORD_H
+#define LLVM_CLANG_INDEX_INDEXRECORD_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexSymbol.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+class ASTContext;
+
+namespace index {
+class FileIndexRecord;
+
+namespace record {
+using llvm::support::ulittle32_t;
+
+/// The header at the start of a record.
+struct Header {
+  char Magic[8];
+  ulittle32_t NumSymbols;
+  ulittle32_t NumOccurrences;
+  ulittle32_t StringTableSize;
+  /// The path of the indexed file, in the string table.
+  ulittle32_t PathOffset;
+  ulittle32_t PathLength;
+  ulittle32_t Reserved;
+};
+
+struct Symbol {
+  /// The USR and the qualified name, in the string table.
+  ulittle32_t USROffset;
+  ulittle32_t USRLength;
+  ulittle32_t NameOffset;
+  ulittle32_t NameLength;
+  /// The SymbolKind, SymbolSubKind and SymbolLanguage of the symbol.
+  uint8_t Kind;
+  uint8_t SubKind;
+  uint8_t Lang;
+  uint8_t Reserved;
+  ulittle32_t Properties;
+  /// The occurrences of the symbol, [FirstOccurrence, FirstOccurrence +
+  /// NumOccurrences) in the occurrence table.
+  ulittle32_t FirstOccurrence;
+  ulittle32_t NumOccurrences;
+};
+
+struct Occurrence {
+  ulittle32_t Symbol;
+  ulittle32_t Roles;
+  ulittle32_t Offset;
+  ulittle32_t Line;
+  ulittle32_t Column;
+};
+} // namespace record
+
+/// The records of the files of a translation unit.
+struct IndexUnit {
+  /// The real path of the main file.
+  std::string MainFilePath;
+  /// The paths of the records, in the directory of the unit.
+  std::vector<std::string> RecordPaths;
+
+  /// The path of the unit of the main file \p MainFilePath, which is a real
+  /// path, in \p RecordDir.
+  static std::string getPath(StringRef RecordDir, StringRef MainFilePath);
+
+  static llvm::Expected<IndexUnit> read(StringRef Path);
+};
+
+/// An IndexDataConsumer which writes a record of the declaration occurrences
+/// of each file of the translation unit into a directory. Macros and the
+/// relations of the occurrences are not recorded.
+class IndexRecordWriter : public IndexDataConsumer {
+public:
+  /// \param WriteUnit Whether to also write the unit of the translation unit,
+  /// which lists its records.
+  explicit IndexRecordWriter(StringRef RecordDir, bool WriteUnit = false);
+  ~IndexRecordWriter() override;
+
+  void initialize(ASTContext &Ctx) override;
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           SourceLocation Loc, ASTNodeInfo ASTNode) override;
+
+  /// Writes the records which are not in the directory yet. Errors are
+  /// reported to the diagnostics of the ASTContext.
+  void finish() override;
+
+  /// The paths of the records of the files of the translation unit, whether
+  /// they were written by this translation unit or by an earlier one.
+  ArrayRef<std::string> getRecordPaths() const { return RecordPaths; }
+
+private:
+  void writeUnit();
+
+  std::string RecordDir;
+  bool ShouldWriteUnit;
+  ASTContext *Ctx = nullptr;
+  llvm::DenseMap<FileID, std::unique_ptr<FileIndexRecord>> Records;
+  std::vector<std::string> RecordPaths;
+  /// The USRs of the declarations, which occur in the records of several
+  /// files.
+  USRCache USRs;
+};
+
+/// A record read from its memory mapped file.
+class IndexRecordReader {
+public:
+  static llvm::Expected<std::unique_ptr<IndexRecordReader>>
+  create(std::unique_ptr<llvm::MemoryBuffer> Buffer);
+  static llvm::Expected<std::unique_ptr<IndexRecordReader>>
+  create(StringRef Path);
+
+  /// The path of the indexed file.
+  StringRef getFilePath() const;
+
+  ArrayRef<record::Symbol> getSymbols() const { return Symbols; }
+  StringRef getUSR(const record::Symbol &S) const;
+  StringRef getName(const record::Symbol &S) const;
+  SymbolInfo getSymbolInfo(const record::Symbol &S) const;
+
+  /// Finds the symbol with the given USR.
+  const record::Symbol *findSymbol(StringRef USR) const;
+
+  /// The occurrences of \p S, sorted by offset.
+  ArrayRef<record::Occurrence> getOccurrences(const record::Symbol &S) const;
+
+  /// Calls \p Receiver with the occurrences of the file in the order of their
+  /// offsets, until it returns false.
+  void forEachOccurrence(
+      llvm::function_ref<bool(const record::Occurrence &)> Receiver) const;
+
+  /// Finds the occurrence which starts at \p Offset.
+  const record::Occurrence *findOccurrenceAt(unsigned Offset) const;
+
+private:
+  IndexRecordReader() = default;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  const record::Header *Hdr = nullptr;
+  ArrayRef<record::Symbol> Symbols;
+  ArrayRef<record::Occurrence> Occurrences;
+  /// The positions of the occurrences in Occurrences, sorted by offset.
+  ArrayRef<record::ulittle32_t> OccurrencesByOffset;
+  StringRef Strings;
+};
+
+} // namespace index
+} // namespace clang
+
+#endif // LLVM_CLANG_INDEX_INDEXRECORD_H
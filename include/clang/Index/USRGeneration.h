@@ -10,7 +10,9 @@
 #define LLVM_CLANG_INDEX_USRGENERATION_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 class ASTContext;
@@ -31,6 +33,43 @@ static inline StringRef getUSRSpacePrefix() {
 /// \returns true if the results should be ignored, false otherwise.
 bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
 
+/// Caches the USRs of the declarations of one ASTContext, for the clients
+/// which need the USRs of the same declarations many times, like indexers.
+/// The USR of a declaration is built on the cached USR of its context,
+/// unless the USR of the context encodes types or a location, which depend
+/// on the rest of the USR.
+class USRCache {
+public:
+  struct Entry {
+    StringRef USR;
+    bool IgnoreResults;
+    /// Whether the USR includes a location; only the first location of a USR
+    /// is included.
+    bool GeneratedLoc;
+    /// Whether the USR encodes types, which can be substituted by the types
+    /// encoded before them in the USR.
+    bool UsesTypeSubstitutions;
+  };
+
+  /// Generate a USR for a Decl, including the USR prefix, like
+  /// generateUSRForDecl.
+  /// \returns true if the results should be ignored, false otherwise.
+  bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
+
+  /// Returns the entry of \p D, generating it if it is not cached. The entry
+  /// is invalidated by the generation of another one.
+  const Entry &getEntry(const Decl *D);
+
+  void clear() {
+    Entries.clear();
+    Alloc.Reset();
+  }
+
+private:
+  llvm::DenseMap<const Decl *, Entry> Entries;
+  llvm::BumpPtrAllocator Alloc;
+};
+
 /// Generate a USR fragment for an Objective-C class.
 void generateUSRForObjCClass(StringRef Cls, raw_ostream &OS,
                              StringRef ExtSymbolDefinedIn = "",
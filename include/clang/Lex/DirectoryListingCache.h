@@ -0,0 +1,72 @@
+//===- DirectoryListingCache.h - Cache of directory contents ----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the DirectoryListingCache, which lets header search answer lookups
+/// of files that don't exist without a stat per search directory.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+#define LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Chrono.h"
+#include <memory>
+#include <mutex>
+
+namespace llvm {
+namespace vfs {
+class FileSystem;
+} // end namespace vfs
+} // end namespace llvm
+
+namespace clang {
+
+/// A thread-safe cache of the names of the entries of the header search
+/// directories, which can be shared by the preprocessors of many translation
+/// units.
+///
+/// A listing is read again when the modification time of its directory
+/// changes, i.e. when an entry is added to or removed from the directory.
+class DirectoryListingCache {
+public:
+  /// The entries of a directory at the time it was read.
+  struct Listing {
+    llvm::sys::TimePoint<> ModTime;
+
+    /// The lower-cased names of the entries, so that the listing can be used
+    /// on case-insensitive file systems too.
+    llvm::StringSet<> Entries;
+
+    /// \returns false if \p Name is definitely not an entry of the directory.
+    bool mayContain(StringRef Name) const;
+  };
+
+  /// Get the up to date listing of the directory \p Dir in \p FS, reading the
+  /// directory if it isn't cached or if it changed since it was read.
+  ///
+  /// \returns nullptr if the directory can't be read.
+  std::shared_ptr<const Listing> getListing(StringRef Dir,
+                                            llvm::vfs::FileSystem &FS);
+
+  /// Forget all the cached listings.
+  void clear();
+
+private:
+  std::mutex Lock;
+
+  /// The listings, keyed by the absolute path of their directory.
+  llvm::StringMap<std::shared_ptr<const Listing>> Listings;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
@@ -15,8 +15,10 @@
 
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Lex/DirectoryListingCache.h"
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/HeaderMap.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/ModuleMap.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
@@ -186,6 +188,11 @@ class HeaderSearch {
   /// The path to the module cache.
   std::string ModuleCachePath;
 
+  /// The macros defined on the command line, as returned by
+  /// PreprocessorOptions::getMacroDefinitions(), when modules are keyed by
+  /// the macros they observe.
+  llvm::StringMap<std::string> CommandLineMacros;
+
   /// All of the preprocessor-specific data about files that are
   /// included, indexed by the FileEntry's UID.
   mutable std::vector<HeaderFileInfo> FileInfo;
@@ -250,6 +257,25 @@ class HeaderSearch {
   /// Entity used to look up stored header file information.
   ExternalHeaderFileInfoSource *ExternalSource = nullptr;
 
+  /// The cache of the contents of the search directories, which is shared
+  /// with other header searches, or null if lookups should not use it.
+  DirectoryListingCache *DirListingCache = nullptr;
+
+  /// The listings of the search directories used by this header search. They
+  /// are checked against the file system once, when first used.
+  llvm::DenseMap<const DirectoryEntry *,
+                 std::shared_ptr<const DirectoryListingCache::Listing>>
+      DirListings;
+
+  /// The directories of the virtual files and their ancestors, which contain
+  /// entries that the file system doesn't know about.
+  llvm::StringSet<> VirtualFileDirs;
+  unsigned NumVirtualFilesSeen = 0;
+
+  /// The controlling macros of the headers, which are shared with other
+  /// header searches, or null.
+  IncludeGuardCache *IncludeGuards = nullptr;
+
 public:
   HeaderSearch(std::shared_ptr<HeaderSearchOptions> HSOpts,
                SourceManager &SourceMgr, DiagnosticsEngine &Diags,
@@ -287,6 +313,22 @@ public:
     SystemDirIdx++;
   }
 
+  /// Use the given cache of directory listings to avoid looking for files in
+  /// directories that don't contain them. The cache must outlive this object.
+  void setDirectoryListingCache(DirectoryListingCache *Cache) {
+    DirListingCache = Cache;
+    DirListings.clear();
+  }
+
+  /// Use the given controlling macros of headers found by other header
+  /// searches, and share the ones found by this one. The cache must outlive
+  /// this object.
+  void setIncludeGuardCache(IncludeGuardCache *Cache) {
+    IncludeGuards = Cache;
+  }
+
+  IncludeGuardCache *getIncludeGuardCache() const { return IncludeGuards; }
+
   /// Set the list of system header prefixes.
   void SetSystemHeaderPrefixes(ArrayRef<std::pair<std::string, bool>> P) {
     SystemHeaderPrefixes.assign(P.begin(), P.end());
@@ -327,6 +369,17 @@ public:
   /// Retrieve the path to the module cache.
   StringRef getModuleCachePath() const { return ModuleCachePath; }
 
+  /// Set the macros defined on the command line, which select the cached
+  /// module files when HeaderSearchOptions::ModulesHashObservedMacros is set.
+  void setCommandLineMacros(llvm::StringMap<std::string> Macros) {
+    CommandLineMacros = std::move(Macros);
+  }
+
+  /// Retrieve the macros defined on the command line.
+  const llvm::StringMap<std::string> &getCommandLineMacros() const {
+    return CommandLineMacros;
+  }
+
   /// Consider modules when including files from this directory.
   void setDirectoryHasModuleMap(const DirectoryEntry* Dir) {
     DirectoryHasModuleMap[Dir] = true;
@@ -518,6 +571,17 @@ public:
   std::string getCachedModuleFileName(StringRef ModuleName,
                                       StringRef ModuleMapPath);
 
+  /// Record that the cached module file of \p Module observed the
+  /// command-line macros \p MacroNames.
+  ///
+  /// When HeaderSearchOptions::ModulesHashObservedMacros is set, the cached
+  /// module file name of a module includes a hash of the command-line
+  /// definitions of every macro that any build of the module observed, so
+  /// that configurations that only differ in other macros share a module
+  /// file.
+  void addObservedCommandLineMacros(Module *Module,
+                                    ArrayRef<std::string> MacroNames);
+
   /// Lookup a module Search for a module with the given name.
   ///
   /// \param ModuleName The name of the module we're looking for.
@@ -639,6 +703,11 @@ private:
       const FileEntry *File, StringRef FrameworkName, Module *RequestingModule,
       ModuleMap::KnownHeader *SuggestedModule, bool IsSystemFramework);
 
+  /// Determine from the directory listing cache whether \p Filename, which is
+  /// relative to the search directory \p Dir, definitely doesn't exist.
+  bool isKnownMissingFromDirectory(const DirectoryEntry *Dir,
+                                   StringRef Filename);
+
   /// Look up the file with the specified name and determine its owning
   /// module.
   Optional<FileEntryRef>
@@ -747,6 +816,11 @@ private:
     LMM_InvalidModuleMap
   };
 
+  /// Get the name of the cached module file for a module, without the
+  /// ".pcm" extension and the hash of the observed command-line macros.
+  std::string getCachedModuleFileBaseName(StringRef ModuleName,
+                                          StringRef ModuleMapPath);
+
   LoadModuleMapResult loadModuleMapFileImpl(const FileEntry *File,
                                             bool IsSystem,
                                             const DirectoryEntry *Dir,
@@ -114,6 +114,9 @@ public:
   /// The directory used for a user build.
   std::string ModuleUserBuildPath;
 
+  /// The file caching the tokens of the module map files, if any.
+  std::string ModuleMapCachePath;
+
   /// The mapping of module names to prebuilt module files.
   std::map<std::string, std::string> PrebuiltModuleFiles;
 
@@ -173,6 +176,10 @@ public:
   /// The set of user-provided virtual filesystem overlay files.
   std::vector<std::string> VFSOverlayFiles;
 
+  /// The prefixes replaced in the paths written into the AST files, and
+  /// their replacements. The last matching prefix is replaced.
+  std::vector<std::pair<std::string, std::string>> ModuleFilePrefixMap;
+
   /// Include the compiler builtin includes.
   unsigned UseBuiltinIncludes : 1;
 
@@ -214,6 +221,19 @@ public:
   /// diagnostics.
   unsigned ModulesStrictContextHash : 1;
 
+  /// Whether the identifiers of C++ modules should be read when they're first
+  /// used instead of when the modules are loaded.
+  unsigned ModulesLazyIdentifiers : 1;
+
+  /// Whether implicitly built modules should be keyed by the command-line
+  /// macros they observe rather than by all of the command-line macros.
+  unsigned ModulesHashObservedMacros : 1;
+
+  /// Whether the modules that are built implicitly should be read from a
+  /// mapping of their module files, which is shared with the other processes
+  /// that read them, instead of from the private copy that was written.
+  unsigned ModulesMapBuiltFiles : 1;
+
   HeaderSearchOptions(StringRef _Sysroot = "/")
       : Sysroot(_Sysroot), ModuleFormat("raw"), DisableModuleHash(false),
         ImplicitModuleMaps(false), ModuleMapFileHomeIsCwd(false),
@@ -223,7 +243,8 @@ public:
         ModulesValidateSystemHeaders(false),
         ValidateASTInputFilesContent(false), UseDebugInfo(false),
         ModulesValidateDiagnosticOptions(true), ModulesHashContent(false),
-        ModulesStrictContextHash(false) {}
+        ModulesStrictContextHash(false), ModulesLazyIdentifiers(false),
+        ModulesHashObservedMacros(false), ModulesMapBuiltFiles(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
@@ -0,0 +1,61 @@
+//===- IncludeGuardCache.h - Controlling macros of headers ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the IncludeGuardCache, which shares the controlling macros of the
+/// headers between the preprocessors of several translation units.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+#define LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/Support/FileSystem.h"
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace clang {
+
+class FileEntry;
+
+/// A thread-safe map from headers to the macros that guard them against
+/// multiple inclusion, which lets a preprocessor skip a header that another
+/// translation unit found to be guarded as soon as the guard is defined,
+/// without reading or lexing it.
+///
+/// The entries are keyed by the unique ID of the file, and are discarded when
+/// the size or the modification time of the file changes.
+class IncludeGuardCache {
+public:
+  /// \returns the name of the controlling macro of \p File, or an empty
+  /// string if it isn't known.
+  std::string lookup(const FileEntry &File);
+
+  /// Remember that \p File is guarded by the macro \p MacroName.
+  void insert(const FileEntry &File, StringRef MacroName);
+
+  /// Forget all the controlling macros.
+  void clear();
+
+private:
+  struct Entry {
+    time_t ModTime;
+    off_t Size;
+    std::string MacroName;
+  };
+
+  std::mutex Lock;
+  std::map<llvm::sys::fs::UniqueID, Entry> Guards;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
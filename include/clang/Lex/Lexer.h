@@ -16,6 +16,7 @@
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/TokenKinds.h"
+#include "clang/Lex/PreLexedBuffer.h"
 #include "clang/Lex/PreprocessorLexer.h"
 #include "clang/Lex/Token.h"
 #include "llvm/ADT/Optional.h"
@@ -131,6 +132,11 @@ class Lexer : public PreprocessorLexer {
   // CurrentConflictMarkerState - The kind of conflict marker we are handling.
   ConflictMarkerKind CurrentConflictMarkerState;
 
+  // PreLexed - The tokens of the buffer lexed ahead of time, if any, and the
+  // index of the first of them that may not have been lexed yet.
+  const PreLexedBuffer *PreLexed = nullptr;
+  unsigned NextPreLexedToken = 0;
+
   void InitLexer(const char *BufStart, const char *BufPtr, const char *BufEnd);
 
 public:
@@ -265,6 +271,13 @@ public:
   /// Return the current location in the buffer.
   const char *getBufferLocation() const { return BufferPtr; }
 
+  /// Use the tokens of \p Buffer, which was lexed from the buffer of this
+  /// lexer, instead of lexing them again when possible.
+  void setPreLexedBuffer(const PreLexedBuffer *Buffer) {
+    PreLexed = Buffer;
+    NextPreLexedToken = 0;
+  }
+
   /// Returns the current lexing offset.
   unsigned getCurrentBufferOffset() {
     assert(BufferPtr >= BufferStart && "Invalid buffer state");
@@ -567,6 +580,13 @@ private:
   ///
   bool LexTokenInternal(Token &Result, bool TokAtPhysicalStartOfLine);
 
+  /// If the next token is one of the pre-lexed tokens and can be used as is,
+  /// set the whitespace flags of \p Result for it and return it.
+  const PreLexedBuffer::Token *getNextPreLexedToken(Token &Result);
+
+  /// Form \p Result from the pre-lexed token \p Tok. Called by Lex.
+  bool LexPreLexedToken(Token &Result, const PreLexedBuffer::Token &Tok);
+
   bool CheckUnicodeWhitespace(Token &Result, uint32_t C, const char *CurPtr);
 
   /// Given that a token begins with the Unicode character \p C, figure out
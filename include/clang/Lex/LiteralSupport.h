@@ -19,6 +19,7 @@
 #include "clang/Basic/TokenKinds.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataTypes.h"
@@ -214,6 +215,10 @@ class StringLiteralParser {
   tok::TokenKind Kind;
   SmallString<512> ResultBuf;
   char *ResultPtr; // cursor
+  /// The string, if it is the contents of a single token which needs no
+  /// processing, in the source buffer rather than in ResultBuf. It then
+  /// points into the spelling of the token.
+  Optional<StringRef> SourceString;
   SmallString<32> UDSuffixBuf;
   unsigned UDSuffixToken;
   unsigned UDSuffixOffset;
@@ -235,9 +240,15 @@ public:
   bool Pascal;
 
   StringRef GetString() const {
+    if (SourceString)
+      return *SourceString;
     return StringRef(ResultBuf.data(), GetStringLength());
   }
-  unsigned GetStringLength() const { return ResultPtr-ResultBuf.data(); }
+  unsigned GetStringLength() const {
+    if (SourceString)
+      return SourceString->size();
+    return ResultPtr-ResultBuf.data();
+  }
 
   unsigned GetNumStringChars() const {
     return GetStringLength() / CharByteWidth;
@@ -274,9 +285,11 @@ public:
 
 private:
   void init(ArrayRef<Token> StringToks);
+  Optional<StringRef> getUnprocessedString(const Token &Tok) const;
   bool CopyStringFragment(const Token &Tok, const char *TokBegin,
                           StringRef Fragment);
   void DiagnoseLexingError(SourceLocation Loc);
+  void DiagnoseTooManyChars(ArrayRef<Token> StringToks);
 };
 
 }  // end namespace clang
@@ -17,6 +17,7 @@
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/Module.h"
 #include "clang/Basic/SourceLocation.h"
+#include "clang/Lex/ModuleMapCache.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
@@ -264,6 +265,20 @@ private:
   /// framework modules from within those directories.
   llvm::DenseMap<const DirectoryEntry *, InferredDirectory> InferredDirectories;
 
+  /// An inferred framework module whose subframeworks weren't inferred yet.
+  struct UninferredSubframeworks {
+    Module *Framework;
+
+    /// The attributes to use for the inferred subframeworks.
+    Attributes Attrs;
+  };
+
+  /// The inferred framework modules whose subframeworks are inferred when
+  /// one of them, or one of their headers, is looked up, keyed by their
+  /// framework directory.
+  mutable llvm::DenseMap<const DirectoryEntry *, UninferredSubframeworks>
+      LazySubframeworks;
+
   /// A mapping from an inferred module to the module map that allowed the
   /// inference.
   llvm::DenseMap<const Module *, const FileEntry *> InferredModuleAllowedBy;
@@ -274,6 +289,15 @@ private:
   /// map.
   llvm::DenseMap<const FileEntry *, bool> ParsedModuleMap;
 
+  /// The tokens of the module map files cached between compilations, if
+  /// HeaderSearchOptions::ModuleMapCachePath is set. It is loaded when the
+  /// first module map file is parsed.
+  std::unique_ptr<ModuleMapCache> TokenCache;
+  bool TokenCacheLoaded = false;
+
+  /// Get the module map cache, or null if there is none.
+  ModuleMapCache *getTokenCache();
+
   /// Resolve the given export declaration into an actual export
   /// declaration.
   ///
@@ -373,6 +397,15 @@ private:
   Module *inferFrameworkModule(const DirectoryEntry *FrameworkDir,
                                Attributes Attrs, Module *Parent);
 
+  /// Infer the subframeworks of the inferred framework module \p Framework
+  /// from its Frameworks directory.
+  void inferSubframeworks(Module *Framework, Attributes Attrs);
+
+  /// Infer the subframeworks of \p Framework, if they weren't inferred yet.
+  ///
+  /// \returns true if any subframework could have been inferred.
+  bool inferLazySubframeworks(const Module *Framework) const;
+
 public:
   /// Construct a new module map.
   ///
@@ -549,6 +582,13 @@ public:
   Module *inferFrameworkModule(const DirectoryEntry *FrameworkDir,
                                bool IsSystem, Module *Parent);
 
+  /// Infer the subframeworks of \p Mod and of its submodules which weren't
+  /// inferred yet, e.g. before building \p Mod.
+  ///
+  /// The subframeworks of an inferred framework module are otherwise only
+  /// inferred once one of them, or one of their headers, is looked up.
+  void inferAllSubframeworks(Module *Mod);
+
   /// Create a new top-level module that is shadowed by
   /// \p ShadowingModule.
   Module *createShadowedModule(StringRef Name, bool IsFramework,
@@ -677,6 +717,10 @@ public:
                           FileID ID = FileID(), unsigned *Offset = nullptr,
                           SourceLocation ExternModuleLoc = SourceLocation());
 
+  /// Write the tokens of the module map files lexed so far into the module
+  /// map cache, if there is one.
+  void writeModuleMapCache();
+
   /// Dump the contents of the module map, for debugging purposes.
   void dump();
 
@@ -0,0 +1,98 @@
+//===- ModuleMapCache.h - Tokens of module map files ------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the ModuleMapCache, a file holding the tokens of module map files
+/// so that the compilations sharing it don't read and lex them again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_MODULEMAPCACHE_H
+#define LLVM_CLANG_LEX_MODULEMAPCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class FileEntry;
+
+/// The tokens of the module map files, keyed by the name of the file.
+///
+/// The tokens of a file are used only while its size and modification time
+/// are the ones it had when it was lexed, which the FileEntry already knows,
+/// so looking them up costs no file system access.
+class ModuleMapCache {
+public:
+  struct Token {
+    /// The kind of the token, as understood by the module map parser.
+    unsigned Kind;
+
+    /// The offset of the token in the file.
+    unsigned Offset;
+
+    /// The spelling of an identifier or keyword, or the value of a string
+    /// literal.
+    StringRef String;
+
+    /// The value of an integer literal.
+    uint64_t Integer = 0;
+  };
+
+  /// Load the cache at \p Path. The cache is empty if the file is missing or
+  /// isn't a valid cache.
+  static std::unique_ptr<ModuleMapCache> load(StringRef Path);
+
+  /// \returns the tokens of \p File, if the cache has them for its current
+  /// size and modification time.
+  Optional<ArrayRef<Token>> lookup(const FileEntry &File) const;
+
+  /// Cache the tokens of \p File, replacing any tokens cached for it before.
+  void add(const FileEntry &File, ArrayRef<Token> Tokens);
+
+  /// Write the cache back to its file, if any tokens were added to it.
+  ///
+  /// The cache is written into a temporary file which is then renamed, so
+  /// that the compilations running concurrently never read a partial cache.
+  void write();
+
+private:
+  struct Entry {
+    uint64_t Size;
+    uint64_t ModificationTime;
+    std::vector<Token> Tokens;
+  };
+
+  explicit ModuleMapCache(StringRef Path) : Path(Path) {}
+
+  bool read();
+
+  std::string Path;
+
+  /// The mapped cache file, which the strings of the loaded tokens point
+  /// into.
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+
+  /// The strings of the added tokens.
+  llvm::BumpPtrAllocator Allocator;
+
+  llvm::StringMap<Entry> Entries;
+
+  bool Modified = false;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_MODULEMAPCACHE_H
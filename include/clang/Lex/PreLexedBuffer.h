@@ -0,0 +1,72 @@
+//===- PreLexedBuffer.h - Tokens of a buffer lexed in parallel --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the PreLexedBuffer, which holds the raw tokens of a large buffer
+/// lexed by several threads before the preprocessor reaches them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_PRELEXEDBUFFER_H
+#define LLVM_CLANG_LEX_PRELEXEDBUFFER_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/TokenKinds.h"
+#include "llvm/ADT/ArrayRef.h"
+#include <memory>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+} // end namespace llvm
+
+namespace clang {
+
+class LangOptions;
+
+/// The raw tokens of a buffer, which the Lexer reading the buffer can use
+/// instead of lexing them again.
+///
+/// The buffer is split at line boundaries into chunks that are raw lexed in
+/// parallel. A chunk can start in the middle of a block comment or a raw
+/// string literal, in which case some of its tokens aren't tokens of the
+/// buffer. That is harmless: the token lexed from a position only depends on
+/// the characters from that position, so a token is used only when the Lexer
+/// reaches its start through whitespace, and the Lexer never reaches the
+/// start of such tokens.
+class PreLexedBuffer {
+public:
+  struct Token {
+    /// The offset of the token in the buffer.
+    unsigned Offset;
+    unsigned Length;
+    tok::TokenKind Kind;
+
+    /// Whether the Lexer would produce the same token from the same
+    /// position, without diagnostics and regardless of its state, so that it
+    /// can use this token instead of lexing it. This is false e.g. for string
+    /// literals, tokens that need cleaning and '#'.
+    bool Reusable;
+  };
+
+  /// Raw lex \p Buffer in chunks of at least \p MinChunkSize bytes, using up
+  /// to one thread per chunk.
+  static std::unique_ptr<PreLexedBuffer> lex(const llvm::MemoryBuffer &Buffer,
+                                             const LangOptions &LangOpts,
+                                             unsigned MinChunkSize = 1 << 20);
+
+  /// The tokens, sorted by offset.
+  ArrayRef<Token> tokens() const { return Tokens; }
+
+private:
+  std::vector<Token> Tokens;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_PRELEXEDBUFFER_H
@@ -311,9 +311,35 @@ class Token;
     /// Allocator used to store preprocessing objects.
     llvm::BumpPtrAllocator BumpAlloc;
 
-    /// The set of preprocessed entities in this record, in order they
-    /// were seen.
-    std::vector<PreprocessedEntity *> PreprocessedEntities;
+    /// The source ranges of the local preprocessed entities, in the order
+    /// of the locations they begin at.
+    ///
+    /// The local entities are kept as parallel arrays rather than as objects,
+    /// since most of them are macro expansions, which are only created when
+    /// a client asks for them.
+    std::vector<SourceRange> LocalEntityRanges;
+
+    /// What each local preprocessed entity is, parallel to
+    /// \c LocalEntityRanges.
+    ///
+    /// An odd value is a macro expansion, whose target is at index (Value >>
+    /// 1) in \c MacroExpansionTargets. An even value is an entity at index
+    /// (Value >> 1) in \c LocalEntityObjects.
+    std::vector<uint32_t> LocalEntityData;
+
+    /// The local preprocessed entities which exist as objects: the
+    /// preprocessing directives and the macro expansions that were asked for.
+    std::vector<PreprocessedEntity *> LocalEntityObjects;
+
+    /// The builtin macro name or the definition of an expanded macro.
+    using MacroExpansionTarget =
+        llvm::PointerUnion<IdentifierInfo *, MacroDefinitionRecord *>;
+
+    /// The distinct targets of the local macro expansions.
+    std::vector<MacroExpansionTarget> MacroExpansionTargets;
+
+    /// The indices of the targets in \c MacroExpansionTargets.
+    llvm::DenseMap<void *, uint32_t> MacroExpansionTargetIDs;
 
     /// The set of preprocessed entities in this record that have been
     /// loaded from external sources.
@@ -363,6 +389,14 @@ class Token;
     /// Retrieve the loaded preprocessed entity at the given index.
     PreprocessedEntity *getLoadedPreprocessedEntity(unsigned Index);
 
+    /// Retrieve the local preprocessed entity at the given index, creating
+    /// it if it is a macro expansion nobody asked for yet.
+    PreprocessedEntity *getLocalPreprocessedEntity(unsigned Index);
+
+    /// Insert a local preprocessed entity with the given range and
+    /// \c LocalEntityData value, keeping the entities ordered.
+    PPEntityID addLocalEntity(SourceRange Range, uint32_t Data);
+
     /// Determine the number of preprocessed entities that were
     /// loaded (or can be loaded) from an external source.
     unsigned getNumLoadedPreprocessedEntities() const {
@@ -458,7 +492,7 @@ class Token;
 
     /// End iterator for all preprocessed entities.
     iterator end() {
-      return iterator(this, PreprocessedEntities.size());
+      return iterator(this, LocalEntityRanges.size());
     }
 
     /// Begin iterator for local, non-loaded, preprocessed entities.
@@ -468,7 +502,7 @@ class Token;
 
     /// End iterator for local, non-loaded, preprocessed entities.
     iterator local_end() {
-      return iterator(this, PreprocessedEntities.size());
+      return iterator(this, LocalEntityRanges.size());
     }
 
     /// iterator range for the given range of loaded
@@ -793,6 +793,11 @@ private:
   unsigned NumTokenPaste = 0;
   unsigned NumFastTokenPaste = 0;
   unsigned NumSkipped = 0;
+  unsigned NumTokenLexersAllocated = 0;
+  unsigned NumMacroArgsAllocated = 0;
+  unsigned NumTokenBuffersAllocated = 0;
+  unsigned NumBacktracks = 0;
+  unsigned MaxBacktrackDepth = 0;
 
   /// The predefined macros that preprocessor should use from the
   /// command line etc.
@@ -812,11 +817,45 @@ private:
 
   /// \{
   /// Cache of macro expanders to reduce malloc traffic.
-  enum { TokenLexerCacheSize = 8 };
+  enum { TokenLexerCacheSize = 16 };
   unsigned NumCachedTokenLexers;
   std::unique_ptr<TokenLexer> TokenLexerCache[TokenLexerCacheSize];
   /// \}
 
+  /// \{
+  /// Pool of the token buffers used while expanding function-like macros,
+  /// which keep their capacity from one expansion to the next.
+  enum { TokenBufferPoolSize = 16 };
+  SmallVector<SmallVector<Token, 0>, TokenBufferPoolSize> TokenBufferPool;
+
+  /// A token buffer taken from the pool, which is given back to the pool
+  /// when it goes out of scope.
+  class PooledTokenBuffer {
+    Preprocessor &PP;
+    SmallVector<Token, 0> Tokens;
+
+  public:
+    PooledTokenBuffer(Preprocessor &PP) : PP(PP) {
+      if (PP.TokenBufferPool.empty()) {
+        ++PP.NumTokenBuffersAllocated;
+        return;
+      }
+      Tokens = std::move(PP.TokenBufferPool.back());
+      PP.TokenBufferPool.pop_back();
+    }
+    PooledTokenBuffer(const PooledTokenBuffer &) = delete;
+    PooledTokenBuffer &operator=(const PooledTokenBuffer &) = delete;
+    ~PooledTokenBuffer() {
+      if (PP.TokenBufferPool.size() == TokenBufferPoolSize)
+        return;
+      Tokens.clear();
+      PP.TokenBufferPool.push_back(std::move(Tokens));
+    }
+
+    SmallVectorImpl<Token> &operator*() { return Tokens; }
+  };
+  /// \}
+
   /// Keeps macro expanded tokens for TokenLexers.
   //
   /// Works like a stack; a TokenLexer adds the macro expanded tokens that is
@@ -2332,6 +2371,11 @@ private:
   /// conditional directives.
   ExcludedPreprocessorDirectiveSkipMapping
       *ExcludedConditionalDirectiveSkipMappings;
+
+  /// The tokens of the large files lexed ahead of time, keyed by the start of
+  /// their buffer.
+  llvm::DenseMap<const char *, std::unique_ptr<PreLexedBuffer>>
+      PreLexedBuffers;
 };
 
 /// Abstract base class that describes a handler that will receive
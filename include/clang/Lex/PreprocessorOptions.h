@@ -27,6 +27,9 @@ class MemoryBuffer;
 
 namespace clang {
 
+class DirectoryListingCache;
+class IncludeGuardCache;
+
 /// Enumerate the kinds of standard library that
 enum ObjCXXARCStandardLibraryKind {
   ARCXX_nolib,
@@ -110,6 +113,11 @@ public:
   /// clients don't use them.
   bool WriteCommentListToPCH = true;
 
+  /// Whether the PCH or module file may be written using several threads for
+  /// the work that doesn't depend on the order of serialization. The output
+  /// is the same.
+  bool ParallelASTWriting = false;
+
   /// When enabled, preprocessor is in a mode for parsing a single file only.
   ///
   /// Disables #includes of other files and if there are unresolved identifiers
@@ -181,6 +189,27 @@ public:
   ExcludedPreprocessorDirectiveSkipMapping
       *ExcludedConditionalDirectiveSkipMappings = nullptr;
 
+  /// The cache of the contents of the header search directories, which is
+  /// shared by the preprocessors of several translation units.
+  ///
+  /// The pointer is passed to the HeaderSearch when the Preprocessor is
+  /// constructed. The pointer is unowned, the client is responsible for its
+  /// lifetime.
+  DirectoryListingCache *HeaderSearchDirectoryListingCache = nullptr;
+
+  /// The controlling macros of the headers, which are shared by the
+  /// preprocessors of several translation units.
+  ///
+  /// The pointer is passed to the HeaderSearch when the Preprocessor is
+  /// constructed. The pointer is unowned, the client is responsible for its
+  /// lifetime.
+  IncludeGuardCache *SharedIncludeGuards = nullptr;
+
+  /// The size in bytes from which source files are raw lexed by several
+  /// threads before the preprocessor reads them, or 0 to always lex files on
+  /// demand.
+  unsigned ParallelLexThreshold = 0;
+
   /// Set up preprocessor for RunAnalysis action.
   bool SetUpStaticAnalyzer = false;
 
@@ -190,6 +219,26 @@ public:
   void addMacroDef(StringRef Name) { Macros.emplace_back(Name, false); }
   void addMacroUndef(StringRef Name) { Macros.emplace_back(Name, true); }
 
+  /// Get the macros that are defined once all of \c Macros are processed,
+  /// keyed by name. Each definition is the text following the macro name,
+  /// e.g. "=1" or "(x)=x", and is never empty.
+  llvm::StringMap<std::string> getMacroDefinitions() const {
+    llvm::StringMap<std::string> Definitions;
+    for (const auto &Macro : Macros) {
+      StringRef Name = StringRef(Macro.first).split('=').first;
+      Name = Name.split('(').first;
+      if (Macro.second) {
+        Definitions.erase(Name);
+        continue;
+      }
+      StringRef Definition = StringRef(Macro.first).substr(Name.size());
+      // Note: GCC drops anything following an end-of-line character.
+      Definition = Definition.substr(0, Definition.find_first_of("\n\r"));
+      Definitions[Name] = Definition.empty() ? "=1" : Definition.str();
+    }
+    return Definitions;
+  }
+
   void addRemappedFile(StringRef From, StringRef To) {
     RemappedFiles.emplace_back(From, To);
   }
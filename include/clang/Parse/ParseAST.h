@@ -14,6 +14,7 @@
 #define LLVM_CLANG_PARSE_PARSEAST_H
 
 #include "clang/Basic/LangOptions.h"
+#include <atomic>
 
 namespace clang {
   class Preprocessor;
@@ -43,8 +44,13 @@ namespace clang {
 
   /// Parse the main file known to the preprocessor, producing an
   /// abstract syntax tree.
+  ///
+  /// \param CancellationFlag If given, parsing stops after the current
+  /// top-level declaration once the flag is set, without notifying the
+  /// ASTConsumer of the end of the translation unit.
   void ParseAST(Sema &S, bool PrintStats = false,
-                bool SkipFunctionBodies = false);
+                bool SkipFunctionBodies = false,
+                const std::atomic<bool> *CancellationFlag = nullptr);
 
 }  // end namespace clang
 
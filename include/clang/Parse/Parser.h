@@ -909,6 +909,8 @@ private:
       P.TentativelyDeclaredIdentifiers.resize(
           PrevTentativelyDeclaredIdentifierCount);
       P.PP.CommitBacktrackedTokens();
+      if (!P.PP.isBacktrackEnabled())
+        P.FunctionDeclaratorResults.clear();
       isActive = false;
     }
     void Revert() {
@@ -921,6 +923,8 @@ private:
       P.ParenCount = PrevParenCount;
       P.BracketCount = PrevBracketCount;
       P.BraceCount = PrevBraceCount;
+      if (!P.PP.isBacktrackEnabled())
+        P.FunctionDeclaratorResults.clear();
       isActive = false;
     }
     ~TentativeParsingAction() {
@@ -2149,6 +2153,12 @@ private:
   /// \returns true if the function body was skipped.
   bool trySkippingFunctionBody();
 
+  /// When skipping function bodies, consume and store the tokens of the
+  /// body of \p D if the AST consumer wants to parse it on demand.
+  ///
+  /// \returns true if the function body was deferred.
+  bool tryDeferringFunctionBody(Decl *D);
+
   bool ParseImplicitInt(DeclSpec &DS, CXXScopeSpec *SS,
                         const ParsedTemplateInfo &TemplateInfo,
                         AccessSpecifier AS, DeclSpecContext DSC,
@@ -2314,6 +2324,13 @@ private:
     True, False, Ambiguous, Error
   };
 
+  /// The results of isCXXFunctionDeclarator() within the current outermost
+  /// tentative parse, by the location of the '(' and the number of
+  /// identifiers tentatively declared before it. They are forgotten when the
+  /// outermost tentative parse ends.
+  llvm::DenseMap<std::pair<unsigned, unsigned>, TPResult>
+      FunctionDeclaratorResults;
+
   /// Based only on the given token kind, determine whether we know that
   /// we're at the start of an expression or a type-specifier-seq (which may
   /// be an expression, in C++).
@@ -15,7 +15,10 @@
 #define LLVM_CLANG_REWRITE_CORE_HTMLREWRITE_H
 
 #include "clang/Basic/SourceLocation.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 #include <string>
+#include <vector>
 
 namespace clang {
 
@@ -65,16 +68,48 @@ namespace html {
   void AddHeaderFooterInternalBuiltinCSS(Rewriter &R, FileID FID,
                                          StringRef title);
 
+  /// The highlighted ranges of a file, which SyntaxHighlight and
+  /// HighlightMacros find by relexing it. A file can be relexed once, and its
+  /// highlights applied to every rewrite of it.
+  class FileHighlights {
+  public:
+    /// Add a range to highlight with HighlightRange.
+    void add(unsigned B, unsigned E, StringRef StartTag, StringRef EndTag);
+
+    /// Highlight the ranges in the rewrite of \p FID by \p R, in the order
+    /// in which they were added.
+    void apply(Rewriter &R, FileID FID) const;
+
+  private:
+    struct Range {
+      unsigned B, E;
+      const char *StartTag, *EndTag;
+    };
+    std::vector<Range> Ranges;
+    llvm::BumpPtrAllocator Allocator;
+    llvm::UniqueStringSaver Tags{Allocator};
+  };
+
   /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
   /// information about keywords, comments, etc.
   void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP);
 
+  /// SyntaxHighlight - This is the same as the above method, but adds the
+  /// highlights to \p Highlights instead.
+  void SyntaxHighlight(FileHighlights &Highlights, FileID FID,
+                       const Preprocessor &PP);
+
   /// HighlightMacros - This uses the macro table state from the end of the
   /// file, to reexpand macros and insert (into the HTML) information about the
   /// macro expansions.  This won't be perfectly perfect, but it will be
   /// reasonably close.
   void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP);
 
+  /// HighlightMacros - This is the same as the above method, but adds the
+  /// highlights to \p Highlights instead.
+  void HighlightMacros(FileHighlights &Highlights, FileID FID,
+                       const Preprocessor &PP);
+
 } // end html namespace
 } // end clang namespace
 
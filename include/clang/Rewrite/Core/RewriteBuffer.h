@@ -12,6 +12,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -56,6 +57,10 @@ public:
   /// The original buffer is not actually changed.
   raw_ostream &write(raw_ostream &Stream) const;
 
+  /// Write to \p Stream the characters in [\p Begin, \p End) of the
+  /// rewritten buffer, a piece of the rope at a time.
+  raw_ostream &write(raw_ostream &Stream, unsigned Begin, unsigned End) const;
+
   /// RemoveText - Remove the specified text.
   void RemoveText(unsigned OrigOffset, unsigned Size,
                   bool removeLineIfEmpty = false);
@@ -88,6 +93,21 @@ public:
   void ReplaceText(unsigned OrigOffset, unsigned OrigLength,
                    StringRef NewStr);
 
+  /// An edit for ApplyEdits(), which replaces \p OrigLength characters at
+  /// \p OrigOffset in the original buffer with \p NewText. An edit without
+  /// length is an insertion, as made by InsertTextAfter().
+  struct Edit {
+    unsigned OrigOffset;
+    unsigned OrigLength;
+    StringRef NewText;
+  };
+
+  /// ApplyEdits - Apply all of \p Edits, which mustn't overlap. This has the
+  /// result of calling InsertTextAfter() or ReplaceText() for each of them in
+  /// order, but sorts them and builds the new buffer in a single pass instead
+  /// of editing the rope once per edit.
+  void ApplyEdits(MutableArrayRef<Edit> Edits);
+
 private:
   /// getMappedOffset - Given an offset into the original SourceBuffer that this
   /// RewriteBuffer is based on, map it into the offset space of the
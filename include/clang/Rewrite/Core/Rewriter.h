@@ -93,19 +93,22 @@ public:
   /// getRewrittenText - Return the rewritten form of the text in the specified
   /// range.  If the start or end of the range was unrewritable or if they are
   /// in different buffers, this returns an empty string.
-  ///
-  /// Note that this method is not particularly efficient.
   std::string getRewrittenText(CharSourceRange Range) const;
 
   /// getRewrittenText - Return the rewritten form of the text in the specified
   /// range.  If the start or end of the range was unrewritable or if they are
   /// in different buffers, this returns an empty string.
-  ///
-  /// Note that this method is not particularly efficient.
   std::string getRewrittenText(SourceRange Range) const {
     return getRewrittenText(CharSourceRange::getTokenRange(Range));
   }
 
+  /// writeRewrittenText - Write the rewritten form of the text in the
+  /// specified range to \p OS, without building it as a string.
+  ///
+  /// \returns true if the start or end of the range was unrewritable or if
+  /// they are in different buffers, in which case nothing is written.
+  bool writeRewrittenText(CharSourceRange Range, raw_ostream &OS) const;
+
   /// InsertText - Insert the specified string at the specified location in the
   /// original buffer.  This method returns true (and does nothing) if the input
   /// location was not rewritable, false otherwise.
@@ -177,6 +180,21 @@ public:
   /// operation.
   bool ReplaceText(SourceRange range, SourceRange replacementRange);
 
+  /// An edit for ApplyEdits(), which replaces the text in \p Range with
+  /// \p NewText. An edit of an empty range is an insertion.
+  struct Edit {
+    CharSourceRange Range;
+    StringRef NewText;
+  };
+
+  /// ApplyEdits - Apply all of \p Edits, whose ranges are in terms of the
+  /// original text and mustn't overlap. The edits of each buffer are sorted
+  /// and applied in a single pass, see RewriteBuffer::ApplyEdits().
+  ///
+  /// \returns true if an edit was unrewritable, in which case the other edits
+  /// are still applied.
+  bool ApplyEdits(ArrayRef<Edit> Edits);
+
   /// Increase indentation for the lines between the given source range.
   /// To determine what the indentation should be, 'parentIndent' is used
   /// that should be at a source location with an indentation one degree
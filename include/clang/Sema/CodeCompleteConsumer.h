@@ -1101,6 +1101,22 @@ public:
     return CodeCompleteOpts.LoadExternal;
   }
 
+  /// The filter which the typed text of the results must fuzzy-match.
+  StringRef getResultFilter() const { return CodeCompleteOpts.ResultFilter; }
+
+  /// The maximum number of results, or 0 if there is no limit.
+  unsigned getResultLimit() const { return CodeCompleteOpts.ResultLimit; }
+
+  /// Removes the results which do not match the result filter, and keeps the
+  /// best ranked ones up to the result limit, before their code-completion
+  /// strings are created. The results which start with the filter rank
+  /// before the other matches, and then the results are ranked by priority.
+  ///
+  /// \returns the number of results kept, which are moved to the start of
+  /// \p Results in their original order.
+  unsigned filterResults(CodeCompletionResult *Results,
+                         unsigned NumResults) const;
+
   /// Deregisters and destroys this code-completion consumer.
   virtual ~CodeCompleteConsumer();
 
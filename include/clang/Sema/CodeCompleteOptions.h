@@ -9,6 +9,8 @@
 #ifndef LLVM_CLANG_SEMA_CODECOMPLETEOPTIONS_H
 #define LLVM_CLANG_SEMA_CODECOMPLETEOPTIONS_H
 
+#include <string>
+
 namespace clang {
 
 /// Options controlling the behavior of code completion.
@@ -43,6 +45,15 @@ public:
   /// on member access, etc.
   unsigned IncludeFixIts : 1;
 
+  /// If non-empty, only the results whose typed text fuzzy-matches this
+  /// filter are passed to the consumer, e.g. the part of the identifier that
+  /// was typed before the completion point.
+  std::string ResultFilter;
+
+  /// If non-zero, only this many results, the best ranked first, are passed
+  /// to the consumer.
+  unsigned ResultLimit = 0;
+
   CodeCompleteOptions()
       : IncludeMacros(0), IncludeCodePatterns(0), IncludeGlobals(1),
         IncludeNamespaceLevelDecls(1), IncludeBriefComments(0),
@@ -0,0 +1,41 @@
+//===- DeclReferenceCallback.h - Declaration Reference Callback -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the DeclReferenceCallback class, which is the base class
+// for callbacks that will be notified of the references to declarations.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_DECLREFERENCECALLBACK_H
+#define LLVM_CLANG_SEMA_DECLREFERENCECALLBACK_H
+
+#include "clang/Basic/SourceLocation.h"
+
+namespace clang {
+
+class Decl;
+class Sema;
+
+/// This is a base class for callbacks that will be notified whenever Sema
+/// marks a declaration as used or referenced, including the implicit
+/// references, e.g. to the constructors and the conversion functions.
+class DeclReferenceCallback {
+public:
+  virtual ~DeclReferenceCallback() = default;
+
+  /// Called when \p D is referenced at \p Loc.
+  virtual void referenced(const Sema &TheSema, SourceLocation Loc,
+                          const Decl *D) = 0;
+
+  /// Called after AST-parsing is completed.
+  virtual void finalize(const Sema &TheSema) = 0;
+};
+
+} // namespace clang
+
+#endif
@@ -13,6 +13,7 @@
 #define LLVM_CLANG_SEMA_EXTERNALSEMASOURCE_H
 
 #include "clang/AST/ExternalASTSource.h"
+#include "clang/AST/TemplateBase.h"
 #include "clang/AST/Type.h"
 #include "clang/Sema/TypoCorrection.h"
 #include "clang/Sema/Weak.h"
@@ -25,6 +26,7 @@ template <class T, unsigned n> class SmallSetVector;
 
 namespace clang {
 
+class ConceptDecl;
 class CXXConstructorDecl;
 class CXXDeleteExpr;
 class CXXRecordDecl;
@@ -46,6 +48,15 @@ struct ExternalVTableUse {
   bool DefinitionRequired;
 };
 
+/// The result of a check of the satisfaction of a concept, which the
+/// \c ExternalSemaSource recorded so that it doesn't need to be checked again.
+struct ExternalConceptSatisfaction {
+  ConceptDecl *Concept;
+  /// The canonical template arguments the concept was checked for.
+  SmallVector<TemplateArgument, 4> TemplateArgs;
+  bool IsSatisfied;
+};
+
 /// An abstract interface that should be implemented by
 /// external AST sources that also provide information for semantic
 /// analysis.
@@ -144,6 +155,15 @@ public:
   virtual void ReadUnusedLocalTypedefNameCandidates(
       llvm::SmallSetVector<const TypedefNameDecl *, 4> &Decls) {}
 
+  /// Read the results of the concept satisfaction checks known to the source.
+  ///
+  /// The external source should append the results it recorded to the given
+  /// vector. Note that this routine may be invoked multiple times; the
+  /// external source should take care not to introduce the same results
+  /// repeatedly.
+  virtual void ReadConceptSatisfactions(
+      SmallVectorImpl<ExternalConceptSatisfaction> &Satisfactions) {}
+
   /// Read the set of referenced selectors known to the
   /// external Sema source.
   ///
@@ -192,6 +212,18 @@ public:
       llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
           &LPTMap) {}
 
+  /// Read the late parsed template function \p FD of this source, if it has
+  /// it, into the map.
+  ///
+  /// The default implementation reads all of them, with
+  /// ReadLateParsedTemplates().
+  virtual void ReadLateParsedTemplate(
+      const FunctionDecl *FD,
+      llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+          &LPTMap) {
+    ReadLateParsedTemplates(LPTMap);
+  }
+
   /// \copydoc Sema::CorrectTypo
   /// \note LookupKind must correspond to a valid Sema::LookupNameKind
   ///
@@ -131,6 +131,9 @@ public:
   /// Loads comment ranges.
   void ReadComments() override;
 
+  /// Loads the comment ranges of \p File which ReadComments() deferred.
+  void ReadCommentsInFile(FileID File) override;
+
   /// Notify ExternalASTSource that we started deserialization of
   /// a decl or type so until FinishedDeserializing is called there may be
   /// decls that are initializing. Must be paired with FinishedDeserializing.
@@ -188,6 +191,8 @@ public:
                  llvm::DenseMap<const CXXRecordDecl *,
                                 CharUnits> &VirtualBaseOffsets) override;
 
+  const ASTRecordLayout *getRecordLayout(const RecordDecl *Record) override;
+
   /// Return the amount of memory used by memory buffers, breaking down
   /// by heap-backed versus mmap'ed memory.
   void getMemoryBufferSizes(MemoryBufferSizes &sizes) const override;
@@ -283,6 +288,15 @@ public:
   void ReadUnusedLocalTypedefNameCandidates(
       llvm::SmallSetVector<const TypedefNameDecl *, 4> &Decls) override;
 
+  /// Read the results of the concept satisfaction checks known to the source.
+  ///
+  /// The external source should append the results it recorded to the given
+  /// vector. Note that this routine may be invoked multiple times; the
+  /// external source should take care not to introduce the same results
+  /// repeatedly.
+  void ReadConceptSatisfactions(
+      SmallVectorImpl<ExternalConceptSatisfaction> &Satisfactions) override;
+
   /// Read the set of referenced selectors known to the
   /// external Sema source.
   ///
@@ -330,6 +344,11 @@ public:
       llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
           &LPTMap) override;
 
+  void ReadLateParsedTemplate(
+      const FunctionDecl *FD,
+      llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+          &LPTMap) override;
+
   /// \copydoc ExternalSemaSource::CorrectTypo
   /// \note Returns the first nonempty correction.
   TypoCorrection CorrectTypo(const DeclarationNameInfo &Typo,
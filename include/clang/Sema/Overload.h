@@ -26,6 +26,7 @@
 #include "clang/Sema/SemaFixItUtils.h"
 #include "clang/Sema/TemplateDeduction.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -1090,6 +1091,21 @@ class Sema;
                                  SourceLocation Loc,
                                  OverloadCandidateSet::CandidateSetKind Kind);
 
+  /// The standard conversion sequences that convert arguments to parameter
+  /// types during overload resolution, for the arguments whose conversion only
+  /// depends on their type and value kind.
+  ///
+  /// Entries are keyed by the types as written rather than by the canonical
+  /// types, so that a cached sequence carries the same type sugar as one that
+  /// would have been computed.
+  struct StandardConversionCache {
+    /// The argument type and parameter type, and the value kind of the
+    /// argument together with the flags of the copy-initialization.
+    using KeyType = std::pair<std::pair<void *, void *>, unsigned>;
+
+    llvm::DenseMap<KeyType, StandardConversionSequence> Conversions;
+  };
+
   struct ConstructorInfo {
     DeclAccessPair FoundDecl;
     CXXConstructorDecl *Constructor;
@@ -107,6 +107,7 @@ namespace clang {
   class Decl;
   class DeclAccessPair;
   class DeclContext;
+  class DeclReferenceCallback;
   class DeclRefExpr;
   class DeclaratorDecl;
   class DeducedTemplateArgument;
@@ -117,6 +118,7 @@ namespace clang {
   class EnumConstantDecl;
   class Expr;
   class ExtVectorType;
+  class ExternalIdentifierIndex;
   class FormatAttr;
   class FriendDecl;
   class FunctionDecl;
@@ -170,6 +172,7 @@ namespace clang {
   class PseudoObjectExpr;
   class QualType;
   class StandardConversionSequence;
+  struct StandardConversionCache;
   class Stmt;
   class StringLiteral;
   class SwitchStmt;
@@ -713,6 +716,21 @@ public:
     OpaqueParser = P;
   }
 
+  /// The bodies of the functions that were skipped because the AST consumer
+  /// asked for them to be parsed on demand, keyed by the function that was
+  /// defined.
+  llvm::DenseMap<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+      DeferredFunctionBodies;
+
+  /// Callback to the parser to parse deferred function bodies on demand.
+  LateTemplateParserCB *DeferredFunctionBodyParser = nullptr;
+  void *OpaqueDeferredFunctionBodyParser = nullptr;
+
+  void SetDeferredFunctionBodyParser(LateTemplateParserCB *DFBP, void *P) {
+    DeferredFunctionBodyParser = DFBP;
+    OpaqueDeferredFunctionBodyParser = P;
+  }
+
   class DelayedDiagnostics;
 
   class DelayedDiagnosticsState {
@@ -1146,6 +1164,43 @@ public:
   /// for C++ records.
   llvm::FoldingSet<SpecialMemberOverloadResultEntry> SpecialMemberCache;
 
+  /// The result of checking whether a concept is satisfied by a list of
+  /// non-dependent template arguments.
+  class ConceptSatisfactionEntry : public llvm::FastFoldingSetNode {
+    ConceptDecl *Concept;
+    ArrayRef<TemplateArgument> TemplateArgs;
+    bool IsSatisfied;
+    bool FromASTFile;
+
+  public:
+    ConceptSatisfactionEntry(const llvm::FoldingSetNodeID &ID,
+                             ConceptDecl *Concept,
+                             ArrayRef<TemplateArgument> TemplateArgs,
+                             bool IsSatisfied, bool FromASTFile)
+        : FastFoldingSetNode(ID), Concept(Concept),
+          TemplateArgs(TemplateArgs), IsSatisfied(IsSatisfied),
+          FromASTFile(FromASTFile) {}
+
+    ConceptDecl *getConcept() const { return Concept; }
+
+    /// The canonical template arguments the concept was checked for.
+    ArrayRef<TemplateArgument> getTemplateArgs() const { return TemplateArgs; }
+
+    bool isSatisfied() const { return IsSatisfied; }
+
+    /// Whether the result was read from an AST file rather than checked in
+    /// this translation unit.
+    bool isFromASTFile() const { return FromASTFile; }
+  };
+
+  /// A cache of the results of concept satisfaction checks, keyed by the
+  /// concept and its canonical template arguments.
+  llvm::FoldingSet<ConceptSatisfactionEntry> ConceptSatisfactionCache;
+
+  /// The entries of \c ConceptSatisfactionCache in the order they were
+  /// added, so that they are written to AST files deterministically.
+  SmallVector<ConceptSatisfactionEntry *, 16> ConceptSatisfactions;
+
   /// A cache of the flags available in enumerations with the flag_bits
   /// attribute.
   mutable llvm::DenseMap<const EnumDecl*, llvm::APInt> FlagBitsCache;
@@ -1705,6 +1760,12 @@ public:
 
   bool isModuleVisible(const Module *M, bool ModulePrivate = false);
 
+  /// Get the generation of the visible modules, which changes whenever a
+  /// module is made visible.
+  unsigned getVisibleModulesGeneration() const {
+    return VisibleModules.getGeneration();
+  }
+
   /// Determine whether a declaration is visible to name lookup.
   bool isVisible(const NamedDecl *D) {
     return !D->isHidden() || isVisibleSlow(D);
@@ -1722,6 +1783,10 @@ public:
   bool hasVisibleMergedDefinition(NamedDecl *Def);
   bool hasMergedDefinitionInCurrentModule(NamedDecl *Def);
 
+  /// The declaration pairs which hasStructuralCompatLayout() found to be
+  /// equivalent, as the same definitions are merged from many modules.
+  llvm::DenseSet<std::pair<Decl *, Decl *>> StructurallyEquivalentDecls;
+
   /// Determine if \p D and \p Suggested have a structurally compatible
   /// layout as described in C11 6.2.7/1.
   bool hasStructuralCompatLayout(Decl *D, Decl *Suggested);
@@ -2297,6 +2362,21 @@ public:
   /// \c constexpr in C++11 or has an 'auto' return type in C++14).
   bool canSkipFunctionBody(Decl *D);
 
+  /// Determine whether the tokens of the body of a function definition that
+  /// is being skipped should be kept, so that the body can be parsed if the
+  /// AST consumer asks for it with \c ParseDeferredFunctionBody.
+  bool shouldDeferFunctionBody(Decl *D);
+
+  void MarkAsDeferredFunctionBody(FunctionDecl *FD, Decl *FnD,
+                                  CachedTokens &Toks);
+
+  /// Parse and analyze the body of the definition of \p FD, if its parsing
+  /// was deferred.
+  ///
+  /// \returns true if the body was parsed, false if there was no deferred
+  /// body or the parser that deferred it is gone.
+  bool ParseDeferredFunctionBody(FunctionDecl *FD);
+
   void computeNRVO(Stmt *Body, sema::FunctionScopeInfo *Scope);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body, bool IsInstantiation);
@@ -2791,6 +2871,10 @@ public:
     AA_Passing_CFAudited
   };
 
+  /// The conversion sequences of overload candidate arguments that only
+  /// depend on the types involved, which are reused by later calls.
+  std::unique_ptr<StandardConversionCache> OverloadConversionCache;
+
   /// C++ Overloading.
   enum OverloadKind {
     /// This is a legitimate overload: the existing declarations are
@@ -3420,6 +3504,44 @@ public:
 private:
   bool CppLookupName(LookupResult &R, Scope *S);
 
+public:
+  /// The using directives found by the last C++ unqualified lookup that
+  /// considered them, which the next lookup from the same scopes reuses
+  /// rather than collecting them again.
+  struct UnqualUsingDirectiveCache {
+    /// The scopes the directives were collected from, from the innermost
+    /// one, with their entities.
+    SmallVector<std::pair<Scope *, DeclContext *>, 8> Scopes;
+
+    /// The file context whose enclosing contexts were visited first, if any.
+    DeclContext *OuterContext = nullptr;
+
+    /// The generations of the using directives, of the visible modules and
+    /// of the external AST source, which invalidate the cache when changed.
+    unsigned UsingDirectiveGeneration = 0;
+    unsigned VisibleModulesGeneration = 0;
+    uint32_t ExternalGeneration = 0;
+
+    /// The nominated namespaces, each with the context it appears to be
+    /// declared in, sorted by that context.
+    SmallVector<std::pair<const DeclContext *, const DeclContext *>, 8>
+        Directives;
+
+    bool Valid = false;
+
+    /// The number of lookups which used the cache, and which collected the
+    /// using directives again.
+    unsigned NumHits = 0;
+    unsigned NumMisses = 0;
+  };
+  UnqualUsingDirectiveCache UnqualUsingDirectives;
+
+  /// Incremented when a using directive is added to a context or a scope, or
+  /// a scope which had using directives is popped.
+  unsigned UsingDirectiveGeneration = 0;
+
+private:
+
   struct TypoExprState {
     std::unique_ptr<TypoCorrectionConsumer> Consumer;
     TypoDiagnosticGenerator DiagHandler;
@@ -4339,6 +4461,8 @@ public:
   // because the name denotes a virtual function and was written without an
   // explicit nested-name-specifier).
   void MarkAnyDeclReferenced(SourceLocation Loc, Decl *D, bool MightBeOdrUse);
+  /// Notify the DeclReferenceCallbacks that \p D is referenced at \p Loc.
+  void NotifyDeclReferenced(SourceLocation Loc, const Decl *D);
   void MarkFunctionReferenced(SourceLocation Loc, FunctionDecl *Func,
                               bool MightBeOdrUse = true);
   void MarkVariableReferenced(SourceLocation Loc, VarDecl *Var);
@@ -6073,6 +6197,27 @@ public:
                                        Expr *ConstraintExpr,
                                        bool &IsSatisfied);
 
+  /// Check whether the concept \p NamedConcept is satisfied by the
+  /// non-dependent template arguments \p TemplateArgs, reusing the result of
+  /// an earlier check for the same arguments if there is one.
+  ///
+  /// \returns true if an error occurred and satisfaction could not be checked.
+  bool CheckConceptSatisfaction(ConceptDecl *NamedConcept,
+                                ArrayRef<TemplateArgument> TemplateArgs,
+                                SourceLocation ConceptNameLoc,
+                                SourceRange InstantiationRange,
+                                bool &IsSatisfied);
+
+private:
+  ConceptSatisfactionEntry *
+  addConceptSatisfaction(const llvm::FoldingSetNodeID &ID,
+                         ConceptDecl *NamedConcept,
+                         ArrayRef<TemplateArgument> CanonicalArgs,
+                         bool IsSatisfied, bool FromASTFile);
+  bool loadExternalConceptSatisfactions();
+
+public:
+
   /// Check that the associated constraints of a template declaration match the
   /// associated constraints of an older declaration of which it is a
   /// redeclaration.
@@ -7806,6 +7951,10 @@ public:
   std::vector<std::unique_ptr<TemplateInstantiationCallback>>
       TemplateInstCallbacks;
 
+  /// The callbacks to notify of the references to declarations, e.g. to
+  /// find the included headers whose declarations are never used.
+  std::vector<std::unique_ptr<DeclReferenceCallback>> DeclReferenceCallbacks;
+
   /// The current index into pack expansion arguments that will be
   /// used for substitution of parameter packs.
   ///
@@ -8103,6 +8252,14 @@ public:
   /// The number of typos corrected by CorrectTypo.
   unsigned TyposCorrected;
 
+  /// The number of names compared with the typos, and of lookups of the
+  /// candidates, by CorrectTypo.
+  unsigned TypoCorrectionWork = 0;
+
+  /// The names of the external identifier source which typo correction
+  /// compares with the typos, loaded on the first correction.
+  std::unique_ptr<ExternalIdentifierIndex> TypoCorrectionIndex;
+
   typedef llvm::SmallSet<SourceLocation, 2> SrcLocSet;
   typedef llvm::DenseMap<IdentifierInfo *, SrcLocSet> IdentifierSourceLocations;
 
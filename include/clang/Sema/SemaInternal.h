@@ -18,6 +18,9 @@
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Sema/SemaDiagnostic.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Allocator.h"
+#include <vector>
 
 namespace clang {
 
@@ -82,6 +85,37 @@ getDepthAndIndex(UnexpandedParameterPack UPP) {
   return getDepthAndIndex(UPP.first.get<NamedDecl *>());
 }
 
+/// The names of an external identifier source, e.g. of the loaded modules,
+/// grouped by length, so that typo correction only compares a typo with the
+/// names which may be close enough, without walking all the identifier
+/// tables of the external source for each typo.
+class ExternalIdentifierIndex {
+public:
+  /// Load the names of \p External, whose AST source is at the generation
+  /// \p Generation.
+  ExternalIdentifierIndex(IdentifierInfoLookup &External, uint32_t Generation);
+
+  /// The generation of the external AST source the names were loaded at.
+  /// The index must be loaded again once new AST files were read.
+  uint32_t getGeneration() const { return Generation; }
+
+  /// Call \p Callback with each name whose edit distance to \p Typo may be
+  /// small enough to make it a correction.
+  void forEachCandidate(StringRef Typo,
+                        llvm::function_ref<void(StringRef)> Callback) const;
+
+private:
+  struct Name {
+    StringRef Spelling;
+    /// The set of characters of the name, as a bit per character class.
+    uint64_t Characters;
+  };
+
+  uint32_t Generation;
+  llvm::BumpPtrAllocator Alloc;
+  std::vector<std::vector<Name>> NamesByLength;
+};
+
 class TypoCorrectionConsumer : public VisibleDeclConsumer {
   typedef SmallVector<TypoCorrection, 1> TypoResultList;
   typedef llvm::StringMap<TypoResultList> TypoResultsMap;
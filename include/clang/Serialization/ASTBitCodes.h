@@ -51,7 +51,7 @@ namespace serialization {
     /// for the previous version could still support reading the new
     /// version by ignoring new kinds of subblocks), this number
     /// should be increased.
-    const unsigned VERSION_MINOR = 0;
+    const unsigned VERSION_MINOR = 4;
 
     /// An ID number that refers to an identifier in an AST file.
     ///
@@ -173,68 +173,84 @@ namespace serialization {
     /// The number of predefined submodule IDs.
     const unsigned int NUM_PREDEF_SUBMODULE_IDS = 1;
 
+    /// The raw encoding of a source location in the arrays of an AST file.
+    ///
+    /// The arrays are read in place from blobs which are only 4-byte aligned,
+    /// so the 64-bit encodings are stored as two 32-bit halves.
+    class RawSourceLocation {
+      uint32_t Low = 0;
+#if CLANG_ENABLE_64BIT_SOURCE_LOCATIONS
+      uint32_t High = 0;
+#endif
+
+    public:
+      RawSourceLocation() = default;
+      RawSourceLocation(SourceLocation Loc) { set(Loc); }
+
+      void set(SourceLocation Loc) {
+        SourceLocation::UIntTy Raw = Loc.getRawEncoding();
+        Low = uint32_t(Raw);
+#if CLANG_ENABLE_64BIT_SOURCE_LOCATIONS
+        High = uint32_t(Raw >> 32);
+#endif
+      }
+
+      SourceLocation get() const {
+        SourceLocation::UIntTy Raw = Low;
+#if CLANG_ENABLE_64BIT_SOURCE_LOCATIONS
+        Raw |= SourceLocation::UIntTy(High) << 32;
+#endif
+        return SourceLocation::getFromRawEncoding(Raw);
+      }
+    };
+
     /// Source range/offset of a preprocessed entity.
     struct PPEntityOffset {
       /// Raw source location of beginning of range.
-      unsigned Begin;
+      RawSourceLocation Begin;
 
       /// Raw source location of end of range.
-      unsigned End;
+      RawSourceLocation End;
 
       /// Offset in the AST file.
       uint32_t BitOffset;
 
       PPEntityOffset(SourceRange R, uint32_t BitOffset)
-        : Begin(R.getBegin().getRawEncoding()),
-          End(R.getEnd().getRawEncoding()), BitOffset(BitOffset) {}
+        : Begin(R.getBegin()), End(R.getEnd()), BitOffset(BitOffset) {}
 
-      SourceLocation getBegin() const {
-        return SourceLocation::getFromRawEncoding(Begin);
-      }
+      SourceLocation getBegin() const { return Begin.get(); }
 
-      SourceLocation getEnd() const {
-        return SourceLocation::getFromRawEncoding(End);
-      }
+      SourceLocation getEnd() const { return End.get(); }
     };
 
     /// Source range of a skipped preprocessor region
     struct PPSkippedRange {
       /// Raw source location of beginning of range.
-      unsigned Begin;
+      RawSourceLocation Begin;
       /// Raw source location of end of range.
-      unsigned End;
+      RawSourceLocation End;
 
-      PPSkippedRange(SourceRange R)
-        : Begin(R.getBegin().getRawEncoding()),
-          End(R.getEnd().getRawEncoding()) { }
+      PPSkippedRange(SourceRange R) : Begin(R.getBegin()), End(R.getEnd()) { }
 
-      SourceLocation getBegin() const {
-        return SourceLocation::getFromRawEncoding(Begin);
-      }
-      SourceLocation getEnd() const {
-        return SourceLocation::getFromRawEncoding(End);
-      }
+      SourceLocation getBegin() const { return Begin.get(); }
+      SourceLocation getEnd() const { return End.get(); }
     };
 
     /// Source range/offset of a preprocessed entity.
     struct DeclOffset {
       /// Raw source location.
-      unsigned Loc = 0;
+      RawSourceLocation Loc;
 
       /// Offset in the AST file.
       uint32_t BitOffset = 0;
 
       DeclOffset() = default;
       DeclOffset(SourceLocation Loc, uint32_t BitOffset)
-        : Loc(Loc.getRawEncoding()), BitOffset(BitOffset) {}
+        : Loc(Loc), BitOffset(BitOffset) {}
 
-      void setLocation(SourceLocation L) {
-        Loc = L.getRawEncoding();
-      }
+      void setLocation(SourceLocation L) { Loc.set(L); }
 
-      SourceLocation getLocation() const {
-        return SourceLocation::getFromRawEncoding(Loc);
-      }
+      SourceLocation getLocation() const { return Loc.get(); }
     };
 
     /// The number of predefined preprocessed entity IDs.
@@ -331,6 +347,10 @@ namespace serialization {
 
       /// Record code for the module build directory.
       MODULE_DIRECTORY,
+
+      /// Record code for the command-line macros a module observed, with
+      /// their definitions, followed by the ones it did not observe.
+      OBSERVED_MACROS,
     };
 
     /// Record types that occur within the options block inside
@@ -650,7 +670,17 @@ namespace serialization {
       PP_CONDITIONAL_STACK = 62,
 
       /// A table of skipped ranges within the preprocessing record.
-      PPD_SKIPPED_RANGES = 63
+      PPD_SKIPPED_RANGES = 63,
+
+      /// Record code for the results of the concept satisfaction checks.
+      CONCEPT_SATISFACTIONS = 64,
+
+      /// Record code for the layouts of the records that were laid out.
+      RECORD_LAYOUTS = 65,
+
+      /// Record code for the names of the selectors in the method pool, each
+      /// followed by a null character, for the global module index.
+      METHOD_POOL_SELECTORS = 66
     };
 
     /// Record types used within a source manager block.
@@ -675,7 +705,12 @@ namespace serialization {
 
       /// Describes a source location entry (SLocEntry) for a
       /// macro expansion.
-      SM_SLOC_EXPANSION_ENTRY = 5
+      SM_SLOC_EXPANSION_ENTRY = 5,
+
+      /// Describes the offsets of the start of each line of a file. This
+      /// kind of record optionally follows a SM_SLOC_FILE_ENTRY record and
+      /// the blob with its contents, if any.
+      SM_SLOC_LINE_OFFSETS = 6
     };
 
     /// Record types used within a preprocessor block.
@@ -785,7 +820,11 @@ namespace serialization {
 
     /// Record types used within a comments block.
     enum CommentRecordTypes {
-      COMMENTS_RAW_COMMENT = 0
+      COMMENTS_RAW_COMMENT = 0,
+
+      /// All the comments of a file: the start of the file, and a blob with
+      /// the offset, length, kind and flags of each comment.
+      COMMENTS_FILE = 1
     };
 
     /// \defgroup ASTAST AST file AST constants
@@ -63,6 +63,7 @@
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <ctime>
@@ -466,7 +467,7 @@ private:
   ContinuousRangeMap<unsigned, ModuleFile*, 64> GlobalSLocEntryMap;
 
   using GlobalSLocOffsetMapType =
-      ContinuousRangeMap<unsigned, ModuleFile *, 64>;
+      ContinuousRangeMap<SourceLocation::UIntTy, ModuleFile *, 64>;
 
   /// A map of reversed (SourceManager::MaxLoadedOffset - SLocOffset)
   /// SourceLocation offsets to the modules containing them.
@@ -830,6 +831,23 @@ private:
   /// Sema tracks these to emit warnings.
   SmallVector<uint64_t, 16> UnusedLocalTypedefNameCandidates;
 
+  /// The records of the concept satisfaction results in the chain that Sema
+  /// hasn't read yet, with the module files they come from.
+  ///
+  /// The records are decoded only when Sema asks for the results, since
+  /// that deserializes the concepts and the types of their arguments.
+  SmallVector<std::pair<ModuleFile *, RecordData>, 2> ConceptSatisfactions;
+
+  /// The records of the record layouts in the chain, with the module files
+  /// they come from.
+  SmallVector<std::pair<ModuleFile *, RecordData>, 2> RecordLayouts;
+
+  /// The record layouts that haven't been read yet, keyed by the global ID of
+  /// the record declaration. Each is given by the index of its record in
+  /// \c RecordLayouts and its position in that record.
+  llvm::DenseMap<serialization::DeclID, std::pair<unsigned, unsigned>>
+      RecordLayoutPositions;
+
   /// Our current depth in #pragma cuda force_host_device begin/end
   /// macros.
   unsigned ForceCUDAHostDeviceDepth = 0;
@@ -894,8 +912,30 @@ private:
   /// Delete expressions to analyze at the end of translation unit.
   SmallVector<uint64_t, 8> DelayedDeleteExprs;
 
-  // A list of late parsed template function data.
-  SmallVector<uint64_t, 1> LateParsedTemplates;
+  // A list of late parsed template function data, with the module file each
+  // of them was read from.
+  SmallVector<std::pair<ModuleFile *, RecordData>, 1> LateParsedTemplates;
+
+  /// The number of records of LateParsedTemplates which were indexed in
+  /// LateParsedTemplateOffsets.
+  unsigned NumIndexedLateParsedTemplates = 0;
+
+  /// The late parsed templates which weren't read yet, by the global ID of
+  /// their function: the index of their record in LateParsedTemplates and
+  /// their offset in it.
+  llvm::DenseMap<serialization::DeclID, std::pair<unsigned, unsigned>>
+      LateParsedTemplateOffsets;
+
+  /// Index the late parsed templates of the module files loaded since the
+  /// last call.
+  void indexLateParsedTemplates();
+
+  /// Read the late parsed template at offset \p Idx in the record
+  /// \p RecordIdx of LateParsedTemplates into \p LPTMap.
+  void readLateParsedTemplate(
+      unsigned RecordIdx, unsigned Idx,
+      llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+          &LPTMap);
 
 public:
   struct ImportedSubmodule {
@@ -970,6 +1010,9 @@ private:
   /// The number of macros de-serialized from the chain.
   unsigned NumMacrosRead = 0;
 
+  /// The number of record layouts de-serialized from the chain.
+  unsigned NumRecordLayoutsRead = 0;
+
   /// The total number of macros stored in the chain.
   unsigned TotalNumMacros = 0;
 
@@ -1035,9 +1078,21 @@ private:
   llvm::SmallMapVector<IdentifierInfo *, SmallVector<NamedDecl*, 2>, 16>
     PendingFakeLookupResults;
 
-  /// The generation number of each identifier, which keeps track of
-  /// the last time we loaded information about this identifier.
-  llvm::DenseMap<IdentifierInfo *, unsigned> IdentifierGeneration;
+  /// The lookups of an identifier in the AST files.
+  struct IdentifierLookupState {
+    /// The generation number of the identifier, which keeps track of the
+    /// last time we loaded information about this identifier.
+    unsigned Generation = 0;
+
+    /// The hash of the name of the identifier in the on-disk tables of the
+    /// AST files and of the global module index, once it has been looked up,
+    /// so that the lookups of an out-of-date identifier don't compute it
+    /// again.
+    Optional<unsigned> NameHash;
+  };
+
+  /// The lookups of each identifier, which are tracked with modules.
+  llvm::DenseMap<IdentifierInfo *, IdentifierLookupState> IdentifierLookups;
 
   class InterestingDecl {
     Decl *D;
@@ -1172,6 +1227,55 @@ private:
     ~ReadingKindTracker() { Reader.ReadingKind = PrevKind; }
   };
 
+  /// Why the declarations being read are read.
+  serialization::DeserializationReason CurrentDeserializationReason =
+      serialization::DR_Other;
+
+  /// RAII object to set the reason of the declarations read in its scope,
+  /// unless they are already read for another reason.
+  class DeserializationReasonRAII {
+    ASTReader &Reader;
+    serialization::DeserializationReason PrevReason;
+
+  public:
+    DeserializationReasonRAII(ASTReader &Reader,
+                              serialization::DeserializationReason Reason)
+        : Reader(Reader), PrevReason(Reader.CurrentDeserializationReason) {
+      if (PrevReason == serialization::DR_Other)
+        Reader.CurrentDeserializationReason = Reason;
+    }
+
+    DeserializationReasonRAII(const DeserializationReasonRAII &) = delete;
+    DeserializationReasonRAII &
+    operator=(const DeserializationReasonRAII &) = delete;
+    ~DeserializationReasonRAII() {
+      Reader.CurrentDeserializationReason = PrevReason;
+    }
+  };
+
+  /// RAII object which adds the time spent in its scope to the ReadTime of a
+  /// module file, without the time of the nested ModuleReadTimers, while the
+  /// statistics are enabled.
+  class ModuleReadTimer {
+    using Clock = std::chrono::steady_clock;
+
+    ASTReader &Reader;
+    ModuleFile &F;
+    ModuleReadTimer *Parent;
+    bool Enabled;
+    Clock::time_point Start;
+    Clock::duration NestedTime{};
+
+  public:
+    ModuleReadTimer(ASTReader &Reader, ModuleFile &F);
+    ModuleReadTimer(const ModuleReadTimer &) = delete;
+    ModuleReadTimer &operator=(const ModuleReadTimer &) = delete;
+    ~ModuleReadTimer();
+  };
+
+  /// The innermost ModuleReadTimer.
+  ModuleReadTimer *CurrentModuleReadTimer = nullptr;
+
   /// RAII object to mark the start of processing updates.
   class ProcessingUpdatesRAIIObj {
     ASTReader &Reader;
@@ -1282,6 +1386,9 @@ private:
                                  SmallVectorImpl<ImportedModule> &Loaded,
                                  const ModuleFile *ImportedBy,
                                  unsigned ClientLoadCapabilities);
+  ASTReadResult checkObservedMacros(ModuleFile &F,
+                                    ArrayRef<uint64_t> IdentifierFilter,
+                                    unsigned ClientLoadCapabilities);
   static ASTReadResult ReadOptionsBlock(
       llvm::BitstreamCursor &Stream, unsigned ClientLoadCapabilities,
       bool AllowCompatibleConfigurationMismatch, ASTReaderListener &Listener,
@@ -1639,6 +1746,11 @@ public:
   /// \returns true if loading the global index has failed for any reason.
   bool loadGlobalIndex();
 
+  /// Whether the identifiers of the loaded modules are only read when they're
+  /// first used, rather than preloading the interesting identifiers of C++
+  /// modules when the modules are loaded.
+  bool loadsIdentifiersLazily() const;
+
   /// Determine whether we tried to load the global index, but failed,
   /// e.g., because it is out-of-date or does not exist.
   bool isGlobalIndexUnavailable() const;
@@ -1953,9 +2065,17 @@ public:
   /// the ASTConsumer.
   void StartTranslationUnit(ASTConsumer *Consumer) override;
 
+  /// Read the layout of a record that was laid out when building the AST
+  /// file it comes from.
+  const ASTRecordLayout *getRecordLayout(const RecordDecl *Record) override;
+
   /// Print some statistics about AST usage.
   void PrintStats() override;
 
+  /// Print what was read from each AST file, the files which took the
+  /// longest to read first.
+  void printModuleFileStats();
+
   /// Dump information about the AST reader to standard error.
   void dump();
 
@@ -2017,6 +2137,9 @@ public:
   void ReadUnusedLocalTypedefNameCandidates(
       llvm::SmallSetVector<const TypedefNameDecl *, 4> &Decls) override;
 
+  void ReadConceptSatisfactions(
+      SmallVectorImpl<ExternalConceptSatisfaction> &Satisfactions) override;
+
   void ReadReferencedSelectors(
            SmallVectorImpl<std::pair<Selector, SourceLocation>> &Sels) override;
 
@@ -2033,6 +2156,11 @@ public:
       llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
           &LPTMap) override;
 
+  void ReadLateParsedTemplate(
+      const FunctionDecl *FD,
+      llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+          &LPTMap) override;
+
   /// Load a selector from disk, registering its ID if it exists.
   void LoadSelector(Selector Sel);
 
@@ -2185,12 +2313,18 @@ public:
 
   /// Read a source location from raw form and return it in its
   /// originating module file's source location space.
-  SourceLocation ReadUntranslatedSourceLocation(uint32_t Raw) const {
-    return SourceLocation::getFromRawEncoding((Raw >> 1) | (Raw << 31));
+  ///
+  /// The macro bit is stored in the lowest bit, so that the locations of
+  /// files, the most common ones, have short VBR encodings.
+  SourceLocation
+  ReadUntranslatedSourceLocation(SourceLocation::UIntTy Raw) const {
+    constexpr unsigned Bits = 8 * sizeof(SourceLocation::UIntTy);
+    return SourceLocation::getFromRawEncoding((Raw >> 1) | (Raw << (Bits - 1)));
   }
 
   /// Read a source location from raw form.
-  SourceLocation ReadSourceLocation(ModuleFile &ModuleFile, uint32_t Raw) const {
+  SourceLocation ReadSourceLocation(ModuleFile &ModuleFile,
+                                    SourceLocation::UIntTy Raw) const {
     SourceLocation Loc = ReadUntranslatedSourceLocation(Raw);
     return TranslateSourceLocation(ModuleFile, Loc);
   }
@@ -2204,7 +2338,8 @@ public:
     assert(ModuleFile.SLocRemap.find(Loc.getOffset()) !=
                ModuleFile.SLocRemap.end() &&
            "Cannot find offset to remap.");
-    int Remap = ModuleFile.SLocRemap.find(Loc.getOffset())->second;
+    SourceLocation::IntTy Remap =
+        ModuleFile.SLocRemap.find(Loc.getOffset())->second;
     return Loc.getLocWithOffset(Remap);
   }
 
@@ -2310,7 +2445,11 @@ public:
   void updateOutOfDateIdentifier(IdentifierInfo &II) override;
 
   /// Note that this identifier is up-to-date.
-  void markIdentifierUpToDate(IdentifierInfo *II);
+  ///
+  /// \param NameHash The hash of the name of the identifier in the on-disk
+  /// tables, if it was computed to look the identifier up.
+  void markIdentifierUpToDate(IdentifierInfo *II,
+                              Optional<unsigned> NameHash = None);
 
   /// Load all external visible decls in the given DeclContext.
   void completeVisibleDeclsMap(const DeclContext *DC) override;
@@ -2352,9 +2491,16 @@ public:
   SmallVector<std::pair<llvm::BitstreamCursor,
                         serialization::ModuleFile *>, 8> CommentsCursors;
 
+  /// The blobs of the comments of each file which ReadComments() deferred
+  /// loading, keyed by the raw encoding of the start of the file.
+  llvm::DenseMap<unsigned, SmallVector<StringRef, 1>> PendingFileComments;
+
   /// Loads comments ranges.
   void ReadComments() override;
 
+  /// Loads the comment ranges of \p File which ReadComments() deferred.
+  void ReadCommentsInFile(FileID File) override;
+
   /// Visit all the input files of the given module file.
   void visitInputFiles(serialization::ModuleFile &MF,
                        bool IncludeSystem, bool Complain,
@@ -67,6 +67,11 @@ class GlobalModuleIndex {
   /// GlobalModuleIndex.
   void *IdentifierIndex;
 
+  /// The hash table mapping the names of the selectors of the Objective-C
+  /// method pool to the module files that have them, which also points to a
+  /// IdentifierIndexTable object. Null if the index has no selector index.
+  void *SelectorIndex;
+
   /// Information about a given module file.
   struct ModuleInfo {
     ModuleInfo() : File(), Size(), ModTime() { }
@@ -113,6 +118,12 @@ class GlobalModuleIndex {
   /// identifier.
   unsigned NumIdentifierLookupHits;
 
+  /// The number of selector lookups we performed.
+  unsigned NumSelectorLookups;
+
+  /// The number of selector lookup hits, where we recognize the selector.
+  unsigned NumSelectorLookupHits;
+
   /// Internal constructor. Use \c readIndex() to read an index.
   explicit GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                              llvm::BitstreamCursor Cursor);
@@ -163,6 +174,19 @@ public:
   /// \returns true if the identifier is known to the index, false otherwise.
   bool lookupIdentifier(llvm::StringRef Name, HitSet &Hits);
 
+  /// Look for all of the module files with information about the given
+  /// identifier, whose hash in the on-disk tables, \c llvm::djbHash of the
+  /// name, the caller already computed as \p NameHash.
+  bool lookupIdentifier(llvm::StringRef Name, unsigned NameHash,
+                        HitSet &Hits);
+
+  /// Look for all of the module files whose method pool has the selector
+  /// named \p Name, as spelled by \c Selector::getAsString().
+  ///
+  /// \returns true if the index knows which module files have the selector,
+  /// false if all of them have to be searched.
+  bool lookupSelector(llvm::StringRef Name, HitSet &Hits);
+
   /// Note that the given module file has been loaded.
   ///
   /// \returns false if the global module index has information about this
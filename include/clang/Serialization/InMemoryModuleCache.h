@@ -75,6 +75,16 @@ public:
   llvm::MemoryBuffer &addBuiltPCM(llvm::StringRef Filename,
                                   std::unique_ptr<llvm::MemoryBuffer> Buffer);
 
+  /// Replace the buffer of a just-built PCM by \p Buffer, e.g. a mapping of
+  /// the file it was written to, if they have the same contents.
+  ///
+  /// The old buffer is freed, so this must be done before the PCM is used.
+  ///
+  /// \pre state is Final.
+  /// \return true if the buffer was replaced.
+  bool replaceBuiltPCM(llvm::StringRef Filename,
+                       std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
   /// Try to remove a buffer from the cache.  No effect if state is Final.
   ///
   /// \pre state is Tentative/Final.
@@ -27,6 +27,7 @@
 #include "llvm/Bitstream/BitstreamReader.h"
 #include "llvm/Support/Endian.h"
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -59,6 +60,31 @@ enum ModuleKind {
   MK_PrebuiltModule
 };
 
+/// Why declarations are deserialized, for the statistics of the module
+/// files. The declarations needed by a declaration are read for the same
+/// reason as it.
+enum DeserializationReason {
+  /// Anything else, e.g. the iteration of a DeclContext.
+  DR_Other,
+
+  /// The lookup of an identifier.
+  DR_IdentifierLookup,
+
+  /// The lookup of a name in a DeclContext.
+  DR_DeclContextLookup,
+
+  /// The update records of a declaration of another module file.
+  DR_UpdateRecord,
+
+  /// The declarations which are passed to the consumer eagerly.
+  DR_EagerDecl,
+
+  NUM_DESERIALIZATION_REASONS
+};
+
+/// \returns a short description of \p Reason.
+const char *getDeserializationReasonName(DeserializationReason Reason);
+
 /// The input file that has been loaded from this AST file, along with
 /// bools indicating whether this was an overridden buffer or if it was
 /// out-of-date or not-found.
@@ -150,6 +176,16 @@ public:
 
   std::string ModuleMapPath;
 
+  /// The command-line macros this module file observed, directly or through
+  /// its imports, with the definitions they had when it was built, or an
+  /// empty definition if they were undefined. See
+  /// HeaderSearchOptions::ModulesHashObservedMacros.
+  std::vector<std::pair<std::string, std::string>> ObservedMacros;
+
+  /// The command-line macros this module file was built with but did not
+  /// observe.
+  std::vector<std::string> UnobservedMacros;
+
   /// Whether this precompiled header is a relocatable PCH file.
   bool RelocatablePCH = false;
 
@@ -247,7 +283,7 @@ public:
   int SLocEntryBaseID = 0;
 
   /// The base offset in the source manager's view of this module.
-  unsigned SLocEntryBaseOffset = 0;
+  SourceLocation::UIntTy SLocEntryBaseOffset = 0;
 
   /// Offsets for all of the source location entries in the
   /// AST file.
@@ -257,7 +293,8 @@ public:
   SmallVector<uint64_t, 4> PreloadSLocEntries;
 
   /// Remapping table for source locations in this module.
-  ContinuousRangeMap<uint32_t, int, 2> SLocRemap;
+  ContinuousRangeMap<SourceLocation::UIntTy, SourceLocation::IntTy, 2>
+      SLocRemap;
 
   // === Identifiers ===
 
@@ -457,6 +494,27 @@ public:
   /// Remapping table for type IDs in this module.
   ContinuousRangeMap<uint32_t, int, 2> TypeRemap;
 
+  // === Statistics ===
+
+  /// The number of declarations read from this file for each
+  /// DeserializationReason.
+  unsigned NumDeclsRead[NUM_DESERIALIZATION_REASONS] = {};
+
+  /// The number of types read from this file.
+  unsigned NumTypesRead = 0;
+
+  /// The number of statements read from this file.
+  unsigned NumStatementsRead = 0;
+
+  /// The size of the declaration, type and function body records read from
+  /// this file.
+  uint64_t NumBitsRead = 0;
+
+  /// The time spent reading the records of this file, without the time spent
+  /// in the records of the declarations and types of other files that they
+  /// need. It is only measured while the statistics are enabled.
+  std::chrono::steady_clock::duration ReadTime{};
+
   // === Miscellaneous ===
 
   /// Diagnostic IDs and their mappings that the user changed.
@@ -126,6 +126,7 @@ enum class ExplorationStrategyKind {
   UnexploredFirstQueue,
   UnexploredFirstLocationQueue,
   BFSBlockDFSContents,
+  CoverageGainQueue,
 };
 
 /// Describes the kinds for high-level analyzer mode.
@@ -241,6 +242,7 @@ public:
   unsigned ShouldEmitErrorsOnInvalidConfigValue : 1;
   unsigned AnalyzeAll : 1;
   unsigned AnalyzerDisplayProgress : 1;
+  unsigned AnalyzerCheckerTiming : 1;
   unsigned AnalyzeNestedBlocks : 1;
 
   unsigned eagerlyAssumeBinOpBifurcation : 1;
@@ -306,7 +308,8 @@ public:
         ShowCheckerOptionList(false), ShowCheckerOptionAlphaList(false),
         ShowCheckerOptionDeveloperList(false), ShowEnabledCheckerList(false),
         ShowConfigOptionsList(false), AnalyzeAll(false),
-        AnalyzerDisplayProgress(false), AnalyzeNestedBlocks(false),
+        AnalyzerDisplayProgress(false), AnalyzerCheckerTiming(false),
+        AnalyzeNestedBlocks(false),
         eagerlyAssumeBinOpBifurcation(false), TrimGraph(false),
         visualizeExplodedGraphWithGraphViz(false), UnoptimizedCFG(false),
         PrintStats(false), NoRetryExhausted(false), AnalyzerWerror(false) {
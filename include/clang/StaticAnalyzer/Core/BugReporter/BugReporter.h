@@ -32,6 +32,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/ADT/ilist_node.h"
 #include "llvm/ADT/iterator_range.h"
@@ -566,6 +567,12 @@ public:
   virtual ASTContext &getASTContext() = 0;
   virtual SourceManager &getSourceManager() = 0;
   virtual AnalyzerOptions &getAnalyzerOptions() = 0;
+
+  /// Returns the issue hashes of the reports that should not be emitted, or
+  /// null if there are none.
+  virtual const llvm::StringSet<> *getSuppressedIssueHashes() {
+    return nullptr;
+  }
 };
 
 /// BugReporter is a utility class for generating PathDiagnostics for analysis.
@@ -580,6 +587,9 @@ private:
   /// Generate and flush the diagnostics for the given bug report.
   void FlushReport(BugReportEquivClass& EQ);
 
+  /// Returns true if the issue hash of \p R is suppressed.
+  bool isSuppressedIssue(const BugReport &R);
+
   /// The set of bug reports tracked by the BugReporter.
   llvm::FoldingSet<BugReportEquivClass> EQClasses;
 
@@ -20,11 +20,17 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <memory>
 
+namespace llvm {
+class SMTSolver;
+} // namespace llvm
+
 namespace clang {
 
+class ASTContext;
 class BinaryOperator;
 class CFGBlock;
 class DeclRefExpr;
@@ -370,6 +376,30 @@ public:
 /// The bug visitor will walk all the nodes in a path and collect all the
 /// constraints. When it reaches the root node, will create a refutation
 /// manager and check if the constraints are satisfiable
+/// The results of the refutation of the reports of a translation unit.
+///
+/// The reports of a translation unit often have the same constraints at the
+/// end of their paths, e.g. the reports of several checkers at the same
+/// node, so the satisfiability of each set of constraints is checked once.
+/// A single solver is kept for all the checks, and each set of constraints is
+/// added to it in a scope of its own.
+class RefutationCache {
+public:
+  RefutationCache();
+  ~RefutationCache();
+
+  /// \return Whether \p Constraints can be satisfied, or None if the solver
+  /// could not tell.
+  Optional<bool> isSatisfiable(const ConstraintRangeTy &Constraints,
+                               ASTContext &Ctx);
+
+private:
+  std::shared_ptr<llvm::SMTSolver> Solver;
+  /// The results by the text of the solver's expressions of the constraints,
+  /// which does not depend on the addresses of the symbols.
+  llvm::StringMap<Optional<bool>> Results;
+};
+
 class FalsePositiveRefutationBRVisitor final : public BugReporterVisitor {
 private:
   /// Holds the constraints in a given path
@@ -20,7 +20,10 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Timer.h"
+#include <chrono>
 #include <vector>
 
 namespace clang {
@@ -121,6 +124,28 @@ class CheckerManager {
   AnalyzerOptions &AOptions;
   CheckerNameRef CurrentCheckerName;
 
+  /// The timers of the checkers, if -analyzer-checker-timing is given.
+  std::unique_ptr<llvm::TimerGroup> CheckerTimerGroup;
+  llvm::DenseMap<const CheckerBase *, std::unique_ptr<llvm::Timer>>
+      CheckerTimers;
+
+public:
+  /// The cost of the path-sensitive callbacks of a checker.
+  struct CheckerProfile {
+    uint64_t NumCallbacks = 0;
+    std::chrono::steady_clock::duration Time{};
+    uint64_t NumNodes = 0;
+    uint64_t NumStates = 0;
+    /// Whether a callback of the checker is running.
+    bool Active = false;
+  };
+
+private:
+  /// The profiles of the checkers, if the checker-profile-file option is set.
+  bool ShouldProfileCheckers = false;
+  llvm::DenseMap<const CheckerBase *, std::unique_ptr<CheckerProfile>>
+      CheckerProfiles;
+
 public:
   CheckerManager(ASTContext &Context, AnalyzerOptions &AOptions)
       : Context(Context), LangOpts(Context.getLangOpts()), AOptions(AOptions) {}
@@ -132,6 +157,19 @@ public:
 
   bool hasPathSensitiveCheckers() const;
 
+  /// Returns the timer of the callbacks of \p Checker, or null if the
+  /// checkers aren't timed.
+  llvm::Timer *getCheckerTimer(const CheckerBase *Checker);
+
+  /// Returns the profile of \p Checker, or null if the checkers aren't
+  /// profiled.
+  CheckerProfile *getCheckerProfile(const CheckerBase *Checker);
+
+  /// Write the profiles of the checkers as JSON. The entries are keyed by
+  /// checker name, so that the reports of several translation units can be
+  /// merged by adding up the fields of the entries with the same name.
+  void writeCheckerProfile(raw_ostream &OS) const;
+
   void finishedCheckerRegistration();
 
   const LangOptions &getLangOpts() const { return LangOpts; }
@@ -605,9 +643,10 @@ private:
   };
   std::vector<StmtCheckerInfo> StmtCheckers;
 
+  /// The checkers of each statement class, indexed by
+  /// (StmtClass << 1) | IsPreVisit. They are computed on first use.
   using CachedStmtCheckers = SmallVector<CheckStmtFunc, 4>;
-  using CachedStmtCheckersMapTy = llvm::DenseMap<unsigned, CachedStmtCheckers>;
-  CachedStmtCheckersMapTy CachedStmtCheckersMap;
+  std::vector<Optional<CachedStmtCheckers>> CachedStmtCheckersTable;
 
   const CachedStmtCheckers &getCachedStmtCheckersFor(const Stmt *S,
                                                      bool isPreVisit);
@@ -26,6 +26,7 @@ class CodeInjector;
 
 namespace ento {
   class CheckerManager;
+  class RefutationCache;
 
 class AnalysisManager : public BugReporterData {
   virtual void anchor();
@@ -41,6 +42,12 @@ class AnalysisManager : public BugReporterData {
 
   CheckerManager *CheckerMgr;
 
+  llvm::StringSet<> SuppressedIssueHashes;
+
+  /// The results of the refutation of the reports, created when the first
+  /// report is refuted.
+  std::unique_ptr<RefutationCache> Refutations;
+
 public:
   AnalyzerOptions &options;
 
@@ -91,8 +98,14 @@ public:
     return PathConsumers;
   }
 
+  const llvm::StringSet<> *getSuppressedIssueHashes() override {
+    return SuppressedIssueHashes.empty() ? nullptr : &SuppressedIssueHashes;
+  }
+
   void FlushDiagnostics();
 
+  RefutationCache &getRefutationCache();
+
   bool shouldVisualize() const {
     return options.visualizeExplodedGraphWithGraphViz;
   }
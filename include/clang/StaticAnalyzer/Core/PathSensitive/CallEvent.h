@@ -38,6 +38,7 @@
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
@@ -1103,6 +1104,10 @@ public:
 
   /// Get the name of the function that this object matches.
   StringRef getFunctionName() const { return QualifiedName.back(); }
+
+  /// \returns true if this only matches functions named getFunctionName(),
+  /// unlike the descriptions of builtins.
+  bool matchesOnlyFunctionName() const { return !(Flags & CDF_MaybeBuiltin); }
 };
 
 /// An immutable map from CallDescriptions to arbitrary data. Provides a unified
@@ -1110,15 +1115,28 @@ public:
 template <typename T> class CallDescriptionMap {
   // Some call descriptions aren't easily hashable (eg., the ones with qualified
   // names in which some sections are omitted), so let's put them
-  // in a simple vector and use linear lookup.
-  // TODO: Implement an actual map for fast lookup for "hashable" call
-  // descriptions (eg., the ones for C functions that just match the name).
+  // in a simple vector and match them one by one. Only those which may match
+  // the name of the callee are tried, in the order of the vector.
   std::vector<std::pair<CallDescription, T>> LinearMap;
 
+  // The indices of the descriptions matching each function name.
+  llvm::StringMap<SmallVector<unsigned, 1>> ByFunctionName;
+
+  // The indices of the descriptions which may match other names too.
+  SmallVector<unsigned, 4> Unnamed;
+
 public:
   CallDescriptionMap(
       std::initializer_list<std::pair<CallDescription, T>> &&List)
-      : LinearMap(List) {}
+      : LinearMap(List) {
+    for (unsigned I = 0, E = LinearMap.size(); I != E; ++I) {
+      const CallDescription &CD = LinearMap[I].first;
+      if (CD.matchesOnlyFunctionName())
+        ByFunctionName[CD.getFunctionName()].push_back(I);
+      else
+        Unnamed.push_back(I);
+    }
+  }
 
   ~CallDescriptionMap() = default;
 
@@ -1128,11 +1146,31 @@ public:
   CallDescriptionMap &operator=(const CallDescription &) = delete;
 
   const T *lookup(const CallEvent &Call) const {
-    // Slow path: linear lookup.
-    // TODO: Implement some sort of fast path.
-    for (const std::pair<CallDescription, T> &I : LinearMap)
-      if (Call.isCalled(I.first))
-        return &I.second;
+    const IdentifierInfo *II = Call.getCalleeIdentifier();
+    if (!II)
+      return nullptr;
+
+    ArrayRef<unsigned> Named;
+    auto It = ByFunctionName.find(II->getName());
+    if (It != ByFunctionName.end())
+      Named = It->second;
+
+    // Try both lists of candidates in the order of the descriptions, so that
+    // the first matching description wins.
+    ArrayRef<unsigned> Others = Unnamed;
+    while (!Named.empty() || !Others.empty()) {
+      unsigned I;
+      if (Others.empty() ||
+          (!Named.empty() && Named.front() < Others.front())) {
+        I = Named.front();
+        Named = Named.drop_front();
+      } else {
+        I = Others.front();
+        Others = Others.drop_front();
+      }
+      if (Call.isCalled(LinearMap[I].first))
+        return &LinearMap[I].second;
+    }
 
     return nullptr;
   }
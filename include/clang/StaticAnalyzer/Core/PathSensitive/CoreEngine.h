@@ -27,6 +27,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include <cassert>
+#include <chrono>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -68,6 +69,9 @@ public:
   using BlocksAborted =
       std::vector<std::pair<const CFGBlock *, const ExplodedNode *>>;
 
+  /// The budgets of the analysis of a top-level function.
+  enum class BudgetKind { None, Time, Memory };
+
 private:
   SubEngine &SubEng;
 
@@ -96,6 +100,17 @@ private:
   /// (This data is owned by AnalysisConsumer.)
   FunctionSummariesTy *FunctionSummaries;
 
+  /// The number of bytes the graph may allocate before the analysis stops, or
+  /// 0 if there is no limit.
+  uint64_t MaxGraphBytes;
+
+  /// The time the worklist may run before the analysis stops, or 0 if there
+  /// is no limit.
+  std::chrono::milliseconds MaxTime;
+
+  /// The budget which stopped the analysis, if any.
+  BudgetKind ExhaustedBudget = BudgetKind::None;
+
   /// Add path note tags along the path when we see that something interesting
   /// is happening. This field is the allocator for such tags.
   NoteTag::Factory NoteTags;
@@ -158,6 +173,7 @@ public:
   // Functions for external checking of whether we have unfinished work
   bool wasBlockAborted() const { return !blocksAborted.empty(); }
   bool wasBlocksExhausted() const { return !blocksExhausted.empty(); }
+  BudgetKind getExhaustedBudget() const { return ExhaustedBudget; }
   bool hasWorkRemaining() const { return wasBlocksExhausted() ||
                                          WList->hasWork() ||
                                          wasBlockAborted(); }
@@ -91,6 +91,13 @@ public:
     return ExprBindings == RHS.ExprBindings;
   }
 
+  /// Returns true if the two environments share their bindings, which unlike
+  /// operator== doesn't compare the bindings one by one.
+  bool hasSameBindings(const Environment &RHS) const {
+    return ExprBindings.getRootWithoutRetain() ==
+           RHS.ExprBindings.getRootWithoutRetain();
+  }
+
   void printJson(raw_ostream &Out, const ASTContext &Ctx,
                  const LocationContext *LCtx = nullptr, const char *NL = "\n",
                  unsigned int Space = 0, bool IsDot = false) const;
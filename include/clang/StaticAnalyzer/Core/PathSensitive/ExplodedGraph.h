@@ -331,6 +331,10 @@ protected:
   /// A list of recently allocated nodes that can potentially be recycled.
   NodeVector ChangedNodes;
 
+  /// The nodes which had no successor yet when they were last considered for
+  /// reclamation. They are considered once more the next time.
+  NodeVector FrontierNodes;
+
   /// A list of nodes that can be reused.
   NodeVector FreeNodes;
 
@@ -448,7 +452,8 @@ public:
   }
 
   /// Reclaim "uninteresting" nodes created since the last time this method
-  /// was called.
+  /// was called, and those which were on the frontier of the graph at that
+  /// time.
   void reclaimRecentlyAllocatedNodes();
 
   /// Returns true if nodes for the given expression kind are always
@@ -20,6 +20,7 @@
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/StringSet.h"
 #include <cassert>
 #include <deque>
 #include <utility>
@@ -37,7 +38,7 @@ class FunctionSummariesTy {
     llvm::SmallBitVector VisitedBasicBlocks;
 
     /// Total number of blocks in the function.
-    unsigned TotalBasicBlocks : 30;
+    unsigned TotalBasicBlocks : 29;
 
     /// True if this function has been checked against the rules for which
     /// functions may be inlined.
@@ -46,17 +47,25 @@ class FunctionSummariesTy {
     /// True if this function may be inlined.
     unsigned MayInline : 1;
 
+    /// True if the analysis of an inlined call to this function reached the
+    /// maximum block count.
+    unsigned ReachedMaxBlockCount : 1;
+
     /// The number of times the function has been inlined.
     unsigned TimesInlined : 32;
 
     FunctionSummary()
         : TotalBasicBlocks(0), InlineChecked(0), MayInline(0),
-          TimesInlined(0) {}
+          ReachedMaxBlockCount(0), TimesInlined(0) {}
   };
 
   using MapTy = llvm::DenseMap<const Decl *, FunctionSummary>;
   MapTy Map;
 
+  /// The cross translation unit lookup names of the functions which reached
+  /// the maximum block count when they were inlined by earlier analyses.
+  llvm::StringSet<> ExhaustedFunctions;
+
 public:
   MapTy::iterator findOrInsertSummary(const Decl *D) {
     MapTy::iterator I = Map.find(D);
@@ -84,8 +93,24 @@ public:
 
   void markReachedMaxBlockCount(const Decl *D) {
     markShouldNotInline(D);
+    findOrInsertSummary(D)->second.ReachedMaxBlockCount = 1;
   }
 
+  /// Returns true if an inlined call to \p D reached the maximum block count
+  /// in an earlier analysis, which makes inlining it again a waste of time.
+  bool isKnownToReachMaxBlockCount(const Decl *D) const;
+
+  /// Read the functions which reached the maximum block count when they were
+  /// inlined from \p File, as written by writeExhaustedFunctions for other
+  /// translation units. A missing file has no functions.
+  void readExhaustedFunctions(StringRef File);
+
+  /// Add the functions which reached the maximum block count when they were
+  /// inlined in this analysis to \p File. The file is replaced atomically, so
+  /// that it can be shared by concurrent analyses; the additions of one of
+  /// them may be lost if several write it at the same time.
+  void writeExhaustedFunctions(StringRef File);
+
   Optional<bool> mayInline(const Decl *D) {
     MapTy::const_iterator I = Map.find(D);
     if (I != Map.end() && I->second.InlineChecked)
@@ -80,6 +80,7 @@ private:
   friend class ProgramStateManager;
   friend class ExplodedGraph;
   friend class ExplodedNode;
+  friend struct llvm::FoldingSetTrait<ProgramState>;
 
   ProgramStateManager *stateMgr;
   Environment Env;           // Maps a Stmt to its current SVal.
@@ -87,6 +88,11 @@ private:
   GenericDataMap   GDM;      // Custom data stored by a client of this class.
   unsigned refCount;
 
+  /// The hash of the profile, which is computed when the state is made
+  /// persistent, so that the StateSet neither profiles a state again when it
+  /// grows nor when the state is compared with another.
+  unsigned ProfileHash = 0;
+
   /// makeWithStore - Return a ProgramState with the same values as the current
   ///  state with the exception of using the specified Store.
   ProgramStateRef makeWithStore(const StoreRef &store) const;
@@ -449,6 +455,32 @@ private:
                         const CallEvent *Call) const;
 };
 
+} // end ento namespace
+} // end clang namespace
+
+namespace llvm {
+template <>
+struct FoldingSetTrait<clang::ento::ProgramState>
+    : DefaultFoldingSetTrait<clang::ento::ProgramState> {
+  static bool Equals(const clang::ento::ProgramState &X,
+                     const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID) {
+    if (X.ProfileHash != IDHash)
+      return false;
+    X.Profile(TempID);
+    return TempID == ID;
+  }
+
+  static unsigned ComputeHash(const clang::ento::ProgramState &X,
+                              FoldingSetNodeID &TempID) {
+    return X.ProfileHash;
+  }
+};
+} // end llvm namespace
+
+namespace clang {
+namespace ento {
+
 //===----------------------------------------------------------------------===//
 // ProgramStateManager - Factory object for ProgramStates.
 //===----------------------------------------------------------------------===//
@@ -485,6 +517,9 @@ private:
   /// A vector of ProgramStates that we can reuse.
   std::vector<ProgramState *> freeStates;
 
+  /// The number of states created so far, including the reused ones.
+  uint64_t NumCreatedStates = 0;
+
 public:
   ProgramStateManager(ASTContext &Ctx,
                  StoreManagerCreator CreateStoreManager,
@@ -496,6 +531,8 @@ public:
 
   ProgramStateRef getInitialState(const LocationContext *InitLoc);
 
+  uint64_t getNumCreatedStates() const { return NumCreatedStates; }
+
   ASTContext &getContext() { return svalBuilder->getContext(); }
   const ASTContext &getContext() const { return svalBuilder->getContext(); }
 
@@ -110,6 +110,9 @@ private:
 
   bool pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const;
 
+  bool isWithinRange(const llvm::APSInt &Lower,
+                     const llvm::APSInt &Upper) const;
+
 public:
   RangeSet Intersect(BasicValueFactory &BV, Factory &F, llvm::APSInt Lower,
                      llvm::APSInt Upper) const;
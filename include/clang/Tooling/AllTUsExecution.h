@@ -63,6 +63,8 @@ private:
   // Used to store the parser when the executor is initialized with parser.
   llvm::Optional<CommonOptionsParser> OptionsParser;
   const CompilationDatabase &Compilations;
+  // The error to report on execution if --results-file can't be opened.
+  std::string ResultsError;
   std::unique_ptr<ToolResults> Results;
   ExecutionContext Context;
   llvm::StringMap<std::string> OverlayFiles;
@@ -71,6 +73,10 @@ private:
 
 extern llvm::cl::opt<unsigned> ExecutorConcurrency;
 extern llvm::cl::opt<std::string> Filter;
+extern llvm::cl::opt<std::string> Shard;
+extern llvm::cl::opt<std::string> CheckpointFile;
+extern llvm::cl::opt<std::string> ResultsFile;
+extern llvm::cl::opt<std::string> TimingsFile;
 
 } // end namespace tooling
 } // end namespace clang
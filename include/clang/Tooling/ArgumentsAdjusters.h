@@ -37,6 +37,9 @@ using ArgumentsAdjuster = std::function<CommandLineArguments(
 
 /// Gets an argument adjuster that converts input command line arguments
 /// to the "syntax check only" variant.
+///
+/// The commands running the static analyzer (--analyze) are left as they are,
+/// since they don't generate code either.
 ArgumentsAdjuster getClangSyntaxOnlyAdjuster();
 
 /// Gets an argument adjuster which removes output-related command line
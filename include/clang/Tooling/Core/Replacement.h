@@ -328,6 +328,17 @@ bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite);
 llvm::Expected<std::string> applyAllReplacements(StringRef Code,
                                                  const Replacements &Replaces);
 
+/// Writes \p Code with all replacements in \p Replaces applied to \p OS.
+///
+/// Like the overload above, this ignores the path stored in each replacement.
+/// The code is streamed out in a single pass over the replacements, without
+/// building a buffer of the whole result.
+///
+/// \returns an error if a replacement is out of the bounds of \p Code, in
+/// which case part of the result may have been written.
+llvm::Error applyAllReplacements(StringRef Code, const Replacements &Replaces,
+                                 llvm::raw_ostream &OS);
+
 /// Collection of Replacements generated from a single translation unit.
 struct TranslationUnitReplacements {
   /// Name of the main source for the translation unit.
@@ -11,11 +11,14 @@
 
 #include "clang/Basic/LLVM.h"
 #include "clang/Lex/PreprocessorExcludedConditionalDirectiveSkipMapping.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include <atomic>
 #include <mutex>
 
 namespace clang {
@@ -46,9 +49,14 @@ public:
   /// mismatching size of the file. If file is not minimized, the full file is
   /// read and copied into memory to ensure that it's not memory mapped to avoid
   /// running out of file descriptors.
+  ///
+  /// If \p OnDiskCachePath is not empty, minimized contents are looked up in
+  /// (and stored to) the on-disk cache in that directory. A cache hit avoids
+  /// reading and minimizing the original file altogether.
   static CachedFileSystemEntry createFileEntry(StringRef Filename,
                                                llvm::vfs::FileSystem &FS,
-                                               bool Minimize = true);
+                                               bool Minimize = true,
+                                               StringRef OnDiskCachePath = "");
 
   /// Create an entry that represents a directory on the filesystem.
   static CachedFileSystemEntry createDirectoryEntry(llvm::vfs::Status &&Stat);
@@ -65,9 +73,14 @@ public:
       return MaybeStat.getError();
     assert(!MaybeStat->isDirectory() && "not a file");
     assert(isValid() && "not initialized");
+    if (OnDiskContents)
+      return OnDiskContentsRef;
     return StringRef(Contents);
   }
 
+  /// \returns True if the contents were loaded from the on-disk cache.
+  bool isFromOnDiskCache() const { return OnDiskContents != nullptr; }
+
   /// \returns The error or the status of the entry.
   llvm::ErrorOr<llvm::vfs::Status> getStatus() const {
     assert(isValid() && "not initialized");
@@ -99,6 +112,11 @@ private:
   // Note: small size of 1 allows us to store an empty string with an implicit
   // null terminator without any allocations.
   llvm::SmallString<1> Contents;
+  /// The on-disk cache file the minimized contents were loaded from, if any.
+  /// The contents are the (null terminated) tail of this buffer, which is
+  /// usually memory mapped.
+  std::unique_ptr<llvm::MemoryBuffer> OnDiskContents;
+  StringRef OnDiskContentsRef;
   PreprocessorSkippedRangeMapping PPSkippedRangeMapping;
 };
 
@@ -122,6 +140,33 @@ public:
   /// thread safe call.
   SharedFileSystemEntry &get(StringRef Key);
 
+  /// Set the directory of the persistent on-disk cache of minimized sources.
+  /// An empty path disables the on-disk cache. This must be set before any
+  /// worker starts using the cache.
+  void setOnDiskCachePath(StringRef Path) { OnDiskCachePath = Path; }
+
+  /// \returns The directory of the on-disk cache, or an empty string.
+  StringRef getOnDiskCachePath() const { return OnDiskCachePath; }
+
+  /// Invalidate the cache entry for the given key, so that the next lookup
+  /// goes to the underlying file system again.
+  ///
+  /// Workers keep pointers to the entries between lookups, so this must not be
+  /// called while any worker is scanning. Workers notice the invalidation
+  /// through \c getGeneration when they start their next scan.
+  void invalidate(StringRef Key);
+
+  /// Invalidate every entry in the cache. See \c invalidate.
+  void invalidateAll();
+
+  /// Call \p Fn for every entry that holds a cached file system query.
+  void forEachValidEntry(
+      llvm::function_ref<void(StringRef Key, const CachedFileSystemEntry &)>
+          Fn);
+
+  /// \returns A counter that changes every time entries are invalidated.
+  unsigned getGeneration() const { return Generation; }
+
 private:
   struct CacheShard {
     std::mutex CacheLock;
@@ -129,6 +174,8 @@ private:
   };
   std::unique_ptr<CacheShard[]> CacheShards;
   unsigned NumShards;
+  std::string OnDiskCachePath;
+  std::atomic<unsigned> Generation{0};
 };
 
 /// A virtual file system optimized for the dependency discovery.
@@ -156,6 +203,10 @@ public:
   /// The set of files that should not be minimized.
   llvm::StringSet<> IgnoredFiles;
 
+  /// Drop the entries cached locally by this worker. This must be done after
+  /// entries of the shared cache have been invalidated.
+  void clearLocalCache() { Cache.clear(); }
+
 private:
   void setCachedEntry(StringRef Filename, const CachedFileSystemEntry *Entry) {
     bool IsInserted = Cache.try_emplace(Filename, Entry).second;
@@ -9,6 +9,9 @@
 #ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_SERVICE_H
 #define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_SERVICE_H
 
+#include "clang/Frontend/CompilerInvocationCache.h"
+#include "clang/Lex/DirectoryListingCache.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 
 namespace clang {
@@ -30,15 +33,34 @@ enum class ScanningMode {
   MinimizedSourcePreprocessing
 };
 
+/// The format that is output by the dependency scanner.
+enum class ScanningOutputFormat {
+  /// This is the Makefile compatible dep format. This will include all of the
+  /// deps necessary for an implicit modules build, but won't include any
+  /// intermodule dependency information.
+  Make,
+
+  /// This outputs the full module dependency graph suitable for use for
+  /// explicitly building modules.
+  Full,
+};
+
 /// The dependency scanning service contains the shared state that is used by
 /// the invidual dependency scanning workers.
 class DependencyScanningService {
 public:
-  DependencyScanningService(ScanningMode Mode, bool ReuseFileManager = true,
-                            bool SkipExcludedPPRanges = true);
+  /// \param MinimizedSourceCacheDir If not empty, the directory of a
+  /// persistent on-disk cache of minimized sources that is shared by all the
+  /// runs of the scanner that use it.
+  DependencyScanningService(ScanningMode Mode, ScanningOutputFormat Format,
+                            bool ReuseFileManager = true,
+                            bool SkipExcludedPPRanges = true,
+                            StringRef MinimizedSourceCacheDir = "");
 
   ScanningMode getMode() const { return Mode; }
 
+  ScanningOutputFormat getFormat() const { return Format; }
+
   bool canReuseFileManager() const { return ReuseFileManager; }
 
   bool canSkipExcludedPPRanges() const { return SkipExcludedPPRanges; }
@@ -47,8 +69,17 @@ public:
     return SharedCache;
   }
 
+  DirectoryListingCache &getDirectoryListingCache() {
+    return DirListingCache;
+  }
+
+  IncludeGuardCache &getIncludeGuardCache() { return IncludeGuards; }
+
+  CompilerInvocationCache &getInvocationCache() { return Invocations; }
+
 private:
   const ScanningMode Mode;
+  const ScanningOutputFormat Format;
   const bool ReuseFileManager;
   /// Set to true to use the preprocessor optimization that skips excluded PP
   /// ranges by bumping the buffer pointer in the lexer instead of lexing the
@@ -56,6 +87,16 @@ private:
   const bool SkipExcludedPPRanges;
   /// The global file system cache.
   DependencyScanningFilesystemSharedCache SharedCache;
+  /// The contents of the header search directories, shared by the workers so
+  /// that the include lookups that miss don't stat every search directory.
+  DirectoryListingCache DirListingCache;
+  /// The controlling macros of the headers, shared by the workers so that
+  /// a header is skipped as soon as its guard is defined.
+  IncludeGuardCache IncludeGuards;
+  /// The invocations of the compile commands, shared by the workers so that
+  /// the commands which only differ by their input, output and macros are
+  /// parsed once.
+  CompilerInvocationCache Invocations;
 };
 
 } // end namespace dependencies
@@ -11,13 +11,31 @@
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include <string>
+#include <vector>
 
 namespace clang{
 namespace tooling{
 namespace dependencies{
 
+/// The full dependencies of a translation unit, and the modules it imports.
+struct FullDependencies {
+  /// The context hash of the modules imported by the translation unit.
+  std::string ContextHash;
+
+  /// The source files the translation unit depends on, not including the
+  /// files of the modules it imports.
+  std::vector<std::string> FileDeps;
+
+  /// The names of the modules the translation unit directly imports.
+  std::vector<std::string> ClangModuleDeps;
+
+  /// Every module the translation unit transitively imports.
+  std::vector<ModuleDeps> DiscoveredModules;
+};
+
 /// The high-level implementation of the dependency discovery tool that runs on
 /// an individual worker thread.
 class DependencyScanningTool {
@@ -36,6 +54,15 @@ public:
   /// occurred, dependency file contents otherwise.
   llvm::Expected<std::string> getDependencyFile(const std::string &Input, StringRef CWD);
 
+  /// Collect the file dependencies of the translation unit, and the modules
+  /// it imports along with their own dependencies. This requires a service
+  /// that uses \c ScanningOutputFormat::Full.
+  ///
+  /// \returns A \c StringError with the diagnostic output if clang errors
+  /// occurred, the full dependencies otherwise.
+  llvm::Expected<FullDependencies>
+  getFullDependencies(const std::string &Input, StringRef CWD);
+
 private:
   DependencyScanningWorker Worker;
   const tooling::CompilationDatabase &Compilations;
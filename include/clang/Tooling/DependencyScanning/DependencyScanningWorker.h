@@ -15,6 +15,8 @@
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Lex/PreprocessorExcludedConditionalDirectiveSkipMapping.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include <string>
@@ -26,7 +28,6 @@ class DependencyOutputOptions;
 namespace tooling {
 namespace dependencies {
 
-class DependencyScanningService;
 class DependencyScanningWorkerFilesystem;
 
 class DependencyConsumer {
@@ -36,7 +37,13 @@ public:
   virtual void handleFileDependency(const DependencyOutputOptions &Opts,
                                     StringRef Filename) = 0;
 
-  // FIXME: Add support for reporting modular dependencies.
+  /// Called for each module the translation unit transitively imports, when
+  /// scanning with \c ScanningOutputFormat::Full.
+  virtual void handleModuleDependency(ModuleDeps MD) = 0;
+
+  /// Called with the context hash of the translation unit's modules, when
+  /// scanning with \c ScanningOutputFormat::Full.
+  virtual void handleContextHash(std::string Hash) = 0;
 };
 
 /// An individual dependency scanning worker that is able to run on its own
@@ -61,6 +68,14 @@ public:
                                   DependencyConsumer &Consumer);
 
 private:
+  /// Drop the per-worker state that may refer to invalidated entries of the
+  /// shared file system cache.
+  void resetAfterInvalidation();
+
+  DependencyScanningService &Service;
+  /// The generation of the shared cache the per-worker state was built with.
+  unsigned CacheGeneration;
+
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
   std::unique_ptr<ExcludedPreprocessorDirectiveSkipMapping> PPSkipMappings;
@@ -73,6 +88,7 @@ private:
   /// The file manager that is reused accross multiple invocations by this
   /// worker. If null, the file manager will not be reused.
   llvm::IntrusiveRefCntPtr<FileManager> Files;
+  ScanningOutputFormat Format;
 };
 
 } // end namespace dependencies
@@ -0,0 +1,138 @@
+//===- ModuleDepCollector.h - Callbacks to collect deps ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
+#define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/raw_ostream.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tooling {
+namespace dependencies {
+
+class DependencyConsumer;
+
+/// The dependencies of a single module, which can be built independently of
+/// the translation units that import it.
+struct ModuleDeps {
+  /// The full name of the top level module.
+  std::string ModuleName;
+
+  /// The context hash of the compiler invocation that built the module. Two
+  /// modules with the same name but different context hashes are different
+  /// modules, and need to be built separately.
+  std::string ContextHash;
+
+  /// The path to the module map file that defines the module, or empty if
+  /// the module was not defined by a module map (e.g. a Modules TS module
+  /// interface unit).
+  std::string ClangModuleMapFile;
+
+  /// The path to the module interface unit the module was built from, if it
+  /// was not defined by a module map.
+  std::string ModuleInterfaceFile;
+
+  /// The path of the PCM the implicit build of the module produced.
+  std::string ModulePCMPath;
+
+  /// The source files the module depends on.
+  llvm::StringSet<> FileDeps;
+
+  /// The names of the modules this module directly imports. They have the
+  /// same context hash as this module.
+  llvm::StringSet<> ClangModuleDeps;
+
+  /// Whether this module is directly imported by the main file of the
+  /// translation unit, rather than only by other modules.
+  bool ImportedByMainFile = false;
+
+  /// Get the -cc1 arguments that build this module's PCM at \c ModulePCMPath
+  /// from the modules it imports. They replace the input, output and
+  /// dependency options of the -cc1 command line of a translation unit that
+  /// imports the module.
+  ///
+  /// \param LookupModuleDeps Returns the dependencies of one of the modules
+  /// in \c ClangModuleDeps.
+  std::vector<std::string> getModuleBuildArguments(
+      llvm::function_ref<const ModuleDeps &(StringRef ModuleName)>
+          LookupModuleDeps) const;
+};
+
+class ModuleDepCollector;
+
+/// Collects the module imports of the main file and the file dependencies of
+/// the translation unit as the preprocessor runs.
+class ModuleDepCollectorPP final : public PPCallbacks {
+public:
+  ModuleDepCollectorPP(CompilerInstance &I, ModuleDepCollector &MDC)
+      : Instance(I), MDC(MDC) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override;
+  void FileSkipped(const FileEntryRef &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override;
+  void InclusionDirective(SourceLocation HashLoc, const Token &IncludeTok,
+                          StringRef FileName, bool IsAngled,
+                          CharSourceRange FilenameRange, const FileEntry *File,
+                          StringRef SearchPath, StringRef RelativePath,
+                          const Module *Imported,
+                          SrcMgr::CharacteristicKind FileType) override;
+  void moduleImport(SourceLocation ImportLoc, ModuleIdPath Path,
+                    const Module *Imported) override;
+
+  void EndOfMainFile() override;
+
+private:
+  CompilerInstance &Instance;
+  ModuleDepCollector &MDC;
+  /// The top level modules directly imported by the main file.
+  llvm::DenseSet<const Module *> DirectDeps;
+
+  void handleImport(const Module *Imported);
+  void handleTopLevelModule(const Module *M);
+  void addAllSubmoduleDeps(const Module *M, ModuleDeps &MD);
+  void addModuleDep(const Module *M, ModuleDeps &MD);
+};
+
+/// Reports the file dependencies of the translation unit, and the modules it
+/// transitively imports, to a \c DependencyConsumer.
+class ModuleDepCollector final : public DependencyCollector {
+public:
+  ModuleDepCollector(CompilerInstance &I, DependencyConsumer &C);
+
+  void attachToPreprocessor(Preprocessor &PP) override;
+  void attachToASTReader(ASTReader &R) override;
+
+private:
+  friend ModuleDepCollectorPP;
+
+  CompilerInstance &Instance;
+  DependencyConsumer &Consumer;
+  std::string MainFile;
+  std::string ContextHash;
+  std::vector<std::string> MainDeps;
+  /// The modules, keyed by context hash and module name.
+  std::map<std::string, ModuleDeps> Deps;
+};
+
+} // end namespace dependencies
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
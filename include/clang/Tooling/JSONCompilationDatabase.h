@@ -18,17 +18,23 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/FileMatchTrie.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/SourceMgr.h"
-#include "llvm/Support/YAMLParser.h"
+#include "llvm/Support/StringSaver.h"
 #include <memory>
 #include <string>
-#include <tuple>
 #include <utility>
 #include <vector>
 
+namespace llvm {
+namespace yaml {
+class ScalarNode;
+} // namespace yaml
+} // namespace llvm
+
 namespace clang {
 namespace tooling {
 
@@ -68,6 +74,18 @@ public:
   loadFromFile(StringRef FilePath, std::string &ErrorMessage,
                JSONCommandLineSyntax Syntax);
 
+  /// Loads a JSON compilation database from the specified file, like
+  /// loadFromFile(), through \p CachePath, a binary cache of the parsed
+  /// database.
+  ///
+  /// The cache is used if it was written for the current size and
+  /// modification time of the file, and is written again after parsing the
+  /// file otherwise. Failing to write the cache is not an error.
+  static std::unique_ptr<JSONCompilationDatabase>
+  loadFromFileWithCache(StringRef FilePath, StringRef CachePath,
+                        std::string &ErrorMessage,
+                        JSONCommandLineSyntax Syntax);
+
   /// Loads a JSON compilation database from a data buffer.
   ///
   /// Returns NULL and sets ErrorMessage if the database could not be loaded.
@@ -96,8 +114,7 @@ private:
   /// Constructs a JSON compilation database on a memory buffer.
   JSONCompilationDatabase(std::unique_ptr<llvm::MemoryBuffer> Database,
                           JSONCommandLineSyntax Syntax)
-      : Database(std::move(Database)), Syntax(Syntax),
-        YAMLStream(this->Database->getBuffer(), SM) {}
+      : Database(std::move(Database)), Syntax(Syntax), Strings(Alloc) {}
 
   /// Parses the database file and creates the index.
   ///
@@ -105,24 +122,58 @@ private:
   /// failed.
   bool parse(std::string &ErrorMessage);
 
-  // Tuple (directory, filename, commandline, output) where 'commandline'
-  // points to the corresponding scalar nodes in the YAML stream.
-  // If the command line contains a single argument, it is a shell-escaped
-  // command line.
+  /// Creates the index from a database in plain JSON, in a single pass over
+  /// the database buffer which doesn't build the values of the commands.
+  /// Returns false, without changing the index, if the buffer isn't a valid
+  /// database in plain JSON.
+  bool scan();
+
+  /// Parses the database with the YAML parser, which accepts more than plain
+  /// JSON and explains the errors.
+  bool parseYAML(std::string &ErrorMessage);
+
+  /// Creates the index from a cache written by writeCache(), which is the
+  /// database buffer. Returns whether the cache is valid.
+  bool readCache(uint64_t Size, uint64_t ModificationTime);
+
+  /// Writes the parsed database to the cache \p CachePath, for the JSON file
+  /// of size \p Size and with the modification time \p ModificationTime.
+  void writeCache(StringRef CachePath, uint64_t Size,
+                  uint64_t ModificationTime) const;
+
+  /// The (unescaped) value of \p Node, which points into the database buffer
+  /// unless the value had escapes.
+  StringRef getValue(llvm::yaml::ScalarNode *Node);
+
+  // The directory, filename, command line and output of a command, which
+  // point into the database buffer or into Strings.
+  // The command line is the raw JSON of either the 'command' string or the
+  // elements of the 'arguments' array, which are only unescaped when the
+  // command is built. If the command line contains a single argument, it is a
+  // shell-escaped command line.
   // Otherwise, each entry in the command line vector is a literal
   // argument to the compiler.
-  // The output field may be a nullptr.
-  using CompileCommandRef =
-      std::tuple<llvm::yaml::ScalarNode *, llvm::yaml::ScalarNode *,
-                 std::vector<llvm::yaml::ScalarNode *>,
-                 llvm::yaml::ScalarNode *>;
-
-  /// Converts the given array of CompileCommandRefs to CompileCommands.
-  void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
-                   std::vector<CompileCommand> &Commands) const;
-
-  // Maps file paths to the compile command lines for that file.
-  llvm::StringMap<std::vector<CompileCommandRef>> IndexByFile;
+  // The output field may be empty.
+  struct CompileCommandRef {
+    StringRef Directory;
+    StringRef Filename;
+    StringRef CommandLine;
+    bool HasArguments = false;
+    StringRef Output;
+    /// The absolute native path of the file, which is its key in
+    /// IndexByFile.
+    StringRef NativeFilePath;
+  };
+
+  /// Adds \p Command for the file \p NativeFilePath to the index.
+  void addCommand(StringRef NativeFilePath, CompileCommandRef Command);
+
+  /// Converts the given CompileCommandRef to a CompileCommand.
+  CompileCommand getCommand(const CompileCommandRef &CommandRef) const;
+
+  // Maps file paths to the positions of the compile commands for that file in
+  // AllCommands.
+  llvm::StringMap<SmallVector<unsigned, 1>> IndexByFile;
 
   /// All the compile commands in the order that they were provided in the
   /// JSON stream.
@@ -132,8 +183,9 @@ private:
 
   std::unique_ptr<llvm::MemoryBuffer> Database;
   JSONCommandLineSyntax Syntax;
-  llvm::SourceMgr SM;
-  llvm::yaml::Stream YAMLStream;
+  llvm::BumpPtrAllocator Alloc;
+  /// The values of the database which had escapes.
+  llvm::StringSaver Strings;
 };
 
 } // namespace tooling
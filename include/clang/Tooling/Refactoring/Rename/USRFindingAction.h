@@ -41,6 +41,18 @@ const NamedDecl *getCanonicalSymbolDeclaration(const NamedDecl *FoundDecl);
 std::vector<std::string> getUSRsForDeclaration(const NamedDecl *ND,
                                                ASTContext &Context);
 
+/// Returns the files of \p Files which may have occurrences of the USRs of
+/// \p USRList, according to the index units and records written in
+/// \p RecordDir by an index::IndexRecordWriter. So, only those files need to
+/// be parsed to rename the symbols.
+///
+/// A file is kept unless its unit has no record with an occurrence of the
+/// USRs, and neither the main file nor the files of the records were modified
+/// after the unit was written. Files without a unit are kept.
+std::vector<std::string>
+getFilesWithUSROccurrences(ArrayRef<std::string> Files, StringRef RecordDir,
+                           ArrayRef<std::vector<std::string>> USRList);
+
 struct USRFindingAction {
   USRFindingAction(ArrayRef<unsigned> SymbolOffsets,
                    ArrayRef<std::string> QualifiedNames, bool Force)
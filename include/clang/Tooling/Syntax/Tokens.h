@@ -35,10 +35,13 @@
 #include "clang/Lex/Token.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <tuple>
 
 namespace clang {
@@ -315,6 +318,29 @@ private:
 std::vector<syntax::Token> tokenize(FileID FID, const SourceManager &SM,
                                     const LangOptions &LO);
 
+/// A thread-safe cache of the spelled tokens of files, which can be shared by
+/// the TokenCollectors of several translation units, so that a header they all
+/// include is lexed only once. The tokens are cached by the contents of the
+/// file and the language options, with offsets instead of source locations.
+class SpelledTokenCache {
+public:
+  /// Same as syntax::tokenize(), but reuses the tokens of a file with the same
+  /// contents which was tokenized before with the same options.
+  std::vector<syntax::Token> tokenize(FileID FID, const SourceManager &SM,
+                                      const LangOptions &LO);
+
+private:
+  struct CachedToken {
+    unsigned Offset;
+    unsigned Length;
+    tok::TokenKind Kind;
+  };
+  using CachedTokens = std::vector<CachedToken>;
+
+  std::mutex Mutex;
+  llvm::StringMap<std::shared_ptr<const CachedTokens>> Files;
+};
+
 /// Collects tokens for the main file while running the frontend action. An
 /// instance of this object should be created on
 /// FrontendAction::BeginSourceFile() and the results should be consumed after
@@ -324,7 +350,10 @@ public:
   /// Adds the hooks to collect the tokens. Should be called before the
   /// preprocessing starts, i.e. as a part of BeginSourceFile() or
   /// CreateASTConsumer().
-  TokenCollector(Preprocessor &P);
+  ///
+  /// If \p SharedTokens is not null, the spelled tokens of the files are
+  /// looked up in it, and added to it. It must outlive consume().
+  TokenCollector(Preprocessor &P, SpelledTokenCache *SharedTokens = nullptr);
 
   /// Finalizes token collection. Should be called after preprocessing is
   /// finished, i.e. after running Execute().
@@ -357,6 +386,7 @@ private:
   PPExpansions Expansions;
   Preprocessor &PP;
   CollectPPExpansions *Collector;
+  SpelledTokenCache *SharedTokens;
 };
 
 } // namespace syntax
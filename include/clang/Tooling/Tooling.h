@@ -52,8 +52,11 @@ namespace clang {
 
 class CompilerInstance;
 class CompilerInvocation;
+class CompilerInvocationCache;
 class DiagnosticConsumer;
 class DiagnosticsEngine;
+class IncludeGuardCache;
+class SharedFileSystemStatCache;
 class SourceManager;
 
 namespace driver {
@@ -270,6 +273,17 @@ public:
   // FIXME: remove this when all users have migrated!
   void mapVirtualFile(StringRef FilePath, StringRef Content);
 
+  /// Set the controlling macros of headers shared with other invocations.
+  void setIncludeGuardCache(IncludeGuardCache *Cache) {
+    IncludeGuards = Cache;
+  }
+
+  /// Set the invocations shared with other invocations, which let the cc1
+  /// arguments which only differ by their input and macros be parsed once.
+  void setInvocationCache(CompilerInvocationCache *Cache) {
+    Invocations = Cache;
+  }
+
   /// Run the clang invocation.
   ///
   /// \returns True if there were no errors during execution.
@@ -291,6 +305,8 @@ public:
   // Maps <file name> -> <file content>.
   llvm::StringMap<StringRef> MappedFileContents;
   DiagnosticConsumer *DiagConsumer = nullptr;
+  IncludeGuardCache *IncludeGuards = nullptr;
+  CompilerInvocationCache *Invocations = nullptr;
 };
 
 /// Utility to run a FrontendAction over a set of files.
@@ -365,6 +381,21 @@ public:
   /// default, if an action fails, a message is printed out to stderr.
   void setPrintErrorMessage(bool PrintErrorMessage);
 
+  /// Sets a stat cache shared with other clang tools, that the file manager
+  /// uses for every translation unit. The cache must outlive the tool.
+  void setSharedStatCache(SharedFileSystemStatCache *Cache);
+
+  /// Sets the controlling macros of headers shared with other clang tools,
+  /// which let the preprocessor skip the guarded headers without reading
+  /// them. The cache must outlive the tool.
+  void setIncludeGuardCache(IncludeGuardCache *Cache);
+
+  /// Sets the invocations shared with other clang tools, which let the
+  /// translation units whose compile commands only differ by their input,
+  /// output and macros share the parsing of their arguments. The cache must
+  /// outlive the tool.
+  void setInvocationCache(CompilerInvocationCache *Cache);
+
   /// Returns the file manager used in the tool.
   ///
   /// The file manager is shared between all translation units.
@@ -392,6 +423,10 @@ private:
 
   bool RestoreCWD = true;
   bool PrintErrorMessage = true;
+
+  SharedFileSystemStatCache *SharedStatCache = nullptr;
+  IncludeGuardCache *IncludeGuards = nullptr;
+  CompilerInvocationCache *Invocations = nullptr;
 };
 
 template <typename T>
@@ -501,9 +536,11 @@ llvm::Expected<std::string> getAbsolutePath(llvm::vfs::FileSystem &FS,
 void addTargetAndModeForProgramName(std::vector<std::string> &CommandLine,
                                     StringRef InvokedAs);
 
-/// Creates a \c CompilerInvocation.
+/// Creates a \c CompilerInvocation, copying the one of \p Cache which was
+/// created from the same arguments if any.
 CompilerInvocation *newInvocation(DiagnosticsEngine *Diagnostics,
-                                  const llvm::opt::ArgStringList &CC1Args);
+                                  const llvm::opt::ArgStringList &CC1Args,
+                                  CompilerInvocationCache *Cache = nullptr);
 
 } // namespace tooling
 
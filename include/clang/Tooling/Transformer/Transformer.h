@@ -14,7 +14,9 @@
 #include "clang/Tooling/Transformer/RewriteRule.h"
 #include "llvm/Support/Error.h"
 #include <functional>
+#include <map>
 #include <utility>
+#include <vector>
 
 namespace clang {
 namespace tooling {
@@ -46,6 +48,46 @@ private:
   /// Receives each successful rewrites as an \c AtomicChange.
   ChangeConsumer Consumer;
 };
+
+/// Applies many independent `RewriteRule`s in a single traversal of the AST.
+///
+/// Unlike a `Transformer` for each rule, the rules share a single callback,
+/// and their matches don't produce conflicting changes: the edits of a match
+/// are dropped when their ranges overlap with the edits of an earlier match
+/// of the translation unit, in the order of the matches. The replacements of
+/// the edits are only generated for the matches which are kept, and the
+/// ranges of the edits are only selected once for both purposes.
+class RuleSetTransformer : public ast_matchers::MatchFinder::MatchCallback {
+public:
+  using ChangeConsumer = Transformer::ChangeConsumer;
+
+  /// \param Consumer Receives each rewrite or error, like the consumer of a
+  /// `Transformer`.
+  RuleSetTransformer(std::vector<transformer::RewriteRule> Rules,
+                     ChangeConsumer Consumer)
+      : Rules(std::move(Rules)), Consumer(std::move(Consumer)) {}
+
+  /// N.B. Passes `this` pointer to `MatchFinder`.  So, this object should not
+  /// be moved after this call.
+  void registerMatchers(ast_matchers::MatchFinder *MatchFinder);
+
+  void onStartOfTranslationUnit() override;
+
+  /// Not called directly by users -- called by the framework, via base class
+  /// pointer.
+  void run(const ast_matchers::MatchFinder::MatchResult &Result) override;
+
+private:
+  /// Whether \p Range overlaps with the edits of a change of the translation
+  /// unit.
+  bool conflicts(const SourceManager &SM, CharSourceRange Range) const;
+
+  std::vector<transformer::RewriteRule> Rules;
+  ChangeConsumer Consumer;
+  /// The end offsets of the edits of the changes of the translation unit, by
+  /// their file and begin offset.
+  std::map<std::pair<FileID, unsigned>, unsigned> EditedRanges;
+};
 } // namespace tooling
 } // namespace clang
 
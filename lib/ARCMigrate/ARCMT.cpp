@@ -601,6 +601,7 @@ bool MigrationProcess::applyTransform(TransformFn trans,
     std::string newFname = file->getName();
     newFname += "-trans";
     SmallString<512> newText;
+    newText.reserve(buf.size());
     llvm::raw_svector_ostream vecOS(newText);
     buf.write(vecOS);
     std::unique_ptr<llvm::MemoryBuffer> memBuf(
@@ -29,8 +29,10 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/YAMLParser.h"
 
 using namespace clang;
@@ -1756,18 +1758,26 @@ bool ObjCMigrateASTConsumer::InsertFoundation(ASTContext &Ctx,
 
 namespace {
 
+/// Collects the rewrites, which don't overlap, to apply them to the Rewriter
+/// at once.
 class RewritesReceiver : public edit::EditsReceiver {
   Rewriter &Rewrite;
+  std::vector<Rewriter::Edit> Edits;
+  llvm::BumpPtrAllocator Allocator;
+  llvm::StringSaver Saver{Allocator};
 
 public:
   RewritesReceiver(Rewriter &Rewrite) : Rewrite(Rewrite) { }
 
   void insert(SourceLocation loc, StringRef text) override {
-    Rewrite.InsertText(loc, text);
+    Edits.push_back(
+        {CharSourceRange::getCharRange(loc, loc), Saver.save(text)});
   }
   void replace(CharSourceRange range, StringRef text) override {
-    Rewrite.ReplaceText(range.getBegin(), Rewrite.getRangeSize(range), text);
+    Edits.push_back({range, Saver.save(text)});
   }
+
+  void apply() { Rewrite.ApplyEdits(Edits); }
 };
 
 class JSONEditWriter : public edit::EditsReceiver {
@@ -1967,6 +1977,7 @@ void ObjCMigrateASTConsumer::HandleTranslationUnit(ASTContext &Ctx) {
   Rewriter rewriter(Ctx.getSourceManager(), Ctx.getLangOpts());
   RewritesReceiver Rec(rewriter);
   Editor->applyRewrites(Rec);
+  Rec.apply();
 
   for (Rewriter::buffer_iterator
         I = rewriter.buffer_begin(), E = rewriter.buffer_end(); I != E; ++I) {
@@ -2205,11 +2216,7 @@ static std::string applyEditsToTemp(const FileEntry *FE,
   Rewriter rewriter(SM, LangOpts);
   RewritesReceiver Rec(rewriter);
   Editor.applyRewrites(Rec, /*adjustRemovals=*/false);
-
-  const RewriteBuffer *Buf = rewriter.getRewriteBufferFor(FID);
-  SmallString<512> NewText;
-  llvm::raw_svector_ostream OS(NewText);
-  Buf->write(OS);
+  Rec.apply();
 
   SmallString<64> TempPath;
   int FD;
@@ -2221,7 +2228,7 @@ static std::string applyEditsToTemp(const FileEntry *FE,
   }
 
   llvm::raw_fd_ostream TmpOut(FD, /*shouldClose=*/true);
-  TmpOut.write(NewText.data(), NewText.size());
+  rewriter.getRewriteBufferFor(FID)->write(TmpOut);
   TmpOut.close();
 
   return TempPath.str();
@@ -88,7 +88,7 @@ public:
       return false;
 
     SourceLocation Loc = OwnershipAttr->getLocation();
-    unsigned RawLoc = Loc.getRawEncoding();
+    SourceLocation::UIntTy RawLoc = Loc.getRawEncoding();
     if (MigrateCtx.AttrSet.count(RawLoc))
       return true;
 
@@ -297,7 +297,7 @@ static void checkAllAtProps(MigrationContext &MigrateCtx,
 static void checkAllProps(MigrationContext &MigrateCtx,
                           std::vector<ObjCPropertyDecl *> &AllProps) {
   typedef llvm::TinyPtrVector<ObjCPropertyDecl *> IndivPropsTy;
-  llvm::DenseMap<unsigned, IndivPropsTy> AtProps;
+  llvm::DenseMap<SourceLocation::UIntTy, IndivPropsTy> AtProps;
 
   for (unsigned i = 0, e = AllProps.size(); i != e; ++i) {
     ObjCPropertyDecl *PD = AllProps[i];
@@ -307,12 +307,12 @@ static void checkAllProps(MigrationContext &MigrateCtx,
       SourceLocation AtLoc = PD->getAtLoc();
       if (AtLoc.isInvalid())
         continue;
-      unsigned RawAt = AtLoc.getRawEncoding();
+      SourceLocation::UIntTy RawAt = AtLoc.getRawEncoding();
       AtProps[RawAt].push_back(PD);
     }
   }
 
-  for (llvm::DenseMap<unsigned, IndivPropsTy>::iterator
+  for (llvm::DenseMap<SourceLocation::UIntTy, IndivPropsTy>::iterator
          I = AtProps.begin(), E = AtProps.end(); I != E; ++I) {
     SourceLocation AtLoc = SourceLocation::getFromRawEncoding(I->first);
     IndivPropsTy &IndProps = I->second;
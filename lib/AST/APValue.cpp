@@ -219,7 +219,123 @@ struct APValue::MemberPointerData : MemberPointerBase {
 APValue::Arr::Arr(unsigned NumElts, unsigned Size) :
   Elts(new APValue[NumElts + (NumElts != Size ? 1 : 0)]),
   NumElts(NumElts), ArrSize(Size) {}
-APValue::Arr::~Arr() { delete [] Elts; }
+APValue::Arr::~Arr() {
+  delete [] Elts;
+  delete [] PackedElts;
+}
+
+/// \returns the bytes taken by each packed integer of \p BitWidth bits.
+static unsigned getPackedEltSize(unsigned BitWidth) {
+  return BitWidth <= 8 ? 1 : BitWidth <= 16 ? 2 : BitWidth <= 32 ? 4 : 8;
+}
+
+uint64_t APValue::getPackedArrayBits(unsigned I) const {
+  assert(isPackedArray() && "Invalid accessor");
+  assert(I < getArrayInitializedElts() && "Index out of range");
+  const Arr *A = (const Arr *)(const void *)Data.buffer;
+  const char *Elt = A->PackedElts + I * getPackedEltSize(A->PackedBitWidth);
+  switch (getPackedEltSize(A->PackedBitWidth)) {
+  case 1:
+    return *reinterpret_cast<const uint8_t *>(Elt);
+  case 2:
+    return *reinterpret_cast<const uint16_t *>(Elt);
+  case 4:
+    return *reinterpret_cast<const uint32_t *>(Elt);
+  default:
+    return *reinterpret_cast<const uint64_t *>(Elt);
+  }
+}
+
+APSInt APValue::getPackedArrayElt(unsigned I) const {
+  const Arr *A = (const Arr *)(const void *)Data.buffer;
+  return APSInt(llvm::APInt(A->PackedBitWidth, getPackedArrayBits(I)),
+                A->PackedIsUnsigned);
+}
+
+void APValue::packArrays() {
+  switch (getKind()) {
+  case Array: {
+    Arr *A = (Arr *)(char *)Data.buffer;
+    if (A->PackedElts)
+      return;
+
+    // The arrays of a few elements aren't worth it.
+    unsigned NumElts = A->NumElts;
+    bool Packable = NumElts >= 16;
+    for (unsigned I = 0; Packable && I != NumElts; ++I) {
+      const APValue &Elt = A->Elts[I];
+      Packable = Elt.isInt() && Elt.getInt().getBitWidth() <= 64 &&
+                 Elt.getInt().getBitWidth() ==
+                     A->Elts[0].getInt().getBitWidth() &&
+                 Elt.getInt().isUnsigned() == A->Elts[0].getInt().isUnsigned();
+    }
+    if (!Packable) {
+      for (unsigned I = 0, N = NumElts + hasArrayFiller(); I != N; ++I)
+        A->Elts[I].packArrays();
+      return;
+    }
+
+    unsigned BitWidth = A->Elts[0].getInt().getBitWidth();
+    unsigned EltSize = getPackedEltSize(BitWidth);
+    char *PackedElts = new char[NumElts * EltSize];
+    for (unsigned I = 0; I != NumElts; ++I) {
+      uint64_t Bits = A->Elts[I].getInt().getZExtValue();
+      char *Elt = PackedElts + I * EltSize;
+      switch (EltSize) {
+      case 1:
+        *reinterpret_cast<uint8_t *>(Elt) = Bits;
+        break;
+      case 2:
+        *reinterpret_cast<uint16_t *>(Elt) = Bits;
+        break;
+      case 4:
+        *reinterpret_cast<uint32_t *>(Elt) = Bits;
+        break;
+      default:
+        *reinterpret_cast<uint64_t *>(Elt) = Bits;
+        break;
+      }
+    }
+
+    APValue *Filler = nullptr;
+    if (hasArrayFiller()) {
+      Filler = new APValue[1];
+      Filler->swap(A->Elts[NumElts]);
+    }
+    A->PackedIsUnsigned = A->Elts[0].getInt().isUnsigned();
+    delete [] A->Elts;
+    A->Elts = Filler;
+    A->PackedElts = PackedElts;
+    A->PackedBitWidth = BitWidth;
+    return;
+  }
+  case Struct:
+    for (unsigned I = 0, N = getStructNumBases(); I != N; ++I)
+      getStructBase(I).packArrays();
+    for (unsigned I = 0, N = getStructNumFields(); I != N; ++I)
+      getStructField(I).packArrays();
+    return;
+  case Union:
+    getUnionValue().packArrays();
+    return;
+  default:
+    return;
+  }
+}
+
+void APValue::unpackArray() {
+  Arr *A = (Arr *)(char *)Data.buffer;
+  assert(A->PackedElts && "Array isn't packed");
+  APValue *Elts = new APValue[A->NumElts + (A->NumElts != A->ArrSize)];
+  for (unsigned I = 0; I != A->NumElts; ++I)
+    Elts[I] = APValue(getPackedArrayElt(I));
+  if (A->NumElts != A->ArrSize)
+    Elts[A->NumElts].swap(A->Elts[0]);
+  delete [] A->Elts;
+  delete [] A->PackedElts;
+  A->Elts = Elts;
+  A->PackedElts = nullptr;
+}
 
 APValue::StructData::StructData(unsigned NumBases, unsigned NumFields) :
   Elts(new APValue[NumBases+NumFields]),
@@ -275,6 +391,23 @@ APValue::APValue(const APValue &RHS) : Kind(None) {
                 RHS.isNullPointer());
     break;
   case Array:
+    if (RHS.isPackedArray()) {
+      // Copy the packed elements as they are, and allocate an element for
+      // the filler only.
+      const Arr *RHSArr = (const Arr *)(const void *)RHS.Data.buffer;
+      MakeArray(0, RHS.hasArrayFiller());
+      Arr *A = (Arr *)(char *)Data.buffer;
+      A->NumElts = RHSArr->NumElts;
+      A->ArrSize = RHSArr->ArrSize;
+      size_t Size = A->NumElts * getPackedEltSize(RHSArr->PackedBitWidth);
+      A->PackedElts = new char[Size];
+      memcpy(A->PackedElts, RHSArr->PackedElts, Size);
+      A->PackedBitWidth = RHSArr->PackedBitWidth;
+      A->PackedIsUnsigned = RHSArr->PackedIsUnsigned;
+      if (RHS.hasArrayFiller())
+        getArrayFiller() = RHS.getArrayFiller();
+      break;
+    }
     MakeArray(RHS.getArrayInitializedElts(), RHS.getArraySize());
     for (unsigned I = 0, N = RHS.getArrayInitializedElts(); I != N; ++I)
       getArrayInitializedElt(I) = RHS.getArrayInitializedElt(I);
@@ -276,15 +276,18 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (DeclLoc.isInvalid() || !DeclLoc.isFileID())
     return nullptr;
 
-  if (ExternalSource && !CommentsLoaded) {
-    ExternalSource->ReadComments();
-    CommentsLoaded = true;
+  const FileID File = SourceMgr.getDecomposedLoc(DeclLoc).first;
+  if (ExternalSource) {
+    if (!CommentsLoaded) {
+      ExternalSource->ReadComments();
+      CommentsLoaded = true;
+    }
+    ExternalSource->ReadCommentsInFile(File);
   }
 
   if (Comments.empty())
     return nullptr;
 
-  const FileID File = SourceMgr.getDecomposedLoc(DeclLoc).first;
   const auto CommentsInThisFile = Comments.getCommentsInFile(File);
   if (!CommentsInThisFile || CommentsInThisFile->empty())
     return nullptr;
@@ -845,7 +848,9 @@ ASTContext::ASTContext(LangOptions &LOpts, SourceManager &SM,
   TraversalScope = {TUDecl};
 }
 
-ASTContext::~ASTContext() {
+ASTContext::~ASTContext() { cleanup(); }
+
+void ASTContext::cleanup() {
   // Release the DenseMaps associated with DeclContext objects.
   // FIXME: Is this the ideal solution?
   ReleaseDeclContextMaps();
@@ -853,6 +858,7 @@ ASTContext::~ASTContext() {
   // Call all of the deallocation functions on all of their targets.
   for (auto &Pair : Deallocations)
     (Pair.first)(Pair.second);
+  Deallocations.clear();
 
   // ASTRecordLayout objects in ASTRecordLayouts must always be destroyed
   // because they can contain DenseMaps.
@@ -862,6 +868,7 @@ ASTContext::~ASTContext() {
     // Increment in loop to prevent using deallocated memory.
     if (auto *R = const_cast<ASTRecordLayout *>((I++)->second))
       R->Destroy(*this);
+  ObjCLayouts.clear();
 
   for (llvm::DenseMap<const RecordDecl*, const ASTRecordLayout*>::iterator
        I = ASTRecordLayouts.begin(), E = ASTRecordLayouts.end(); I != E; ) {
@@ -869,21 +876,31 @@ ASTContext::~ASTContext() {
     if (auto *R = const_cast<ASTRecordLayout *>((I++)->second))
       R->Destroy(*this);
   }
+  ASTRecordLayouts.clear();
 
   for (llvm::DenseMap<const Decl*, AttrVec*>::iterator A = DeclAttrs.begin(),
                                                     AEnd = DeclAttrs.end();
        A != AEnd; ++A)
     A->second->~AttrVec();
+  DeclAttrs.clear();
 
   for (std::pair<const MaterializeTemporaryExpr *, APValue *> &MTVPair :
        MaterializedTemporaryValues)
     MTVPair.second->~APValue();
+  MaterializedTemporaryValues.clear();
+
+  for (const auto &Memoized : ConstexprCallResults)
+    Memoized.second->~APValue();
+  ConstexprCallResults.clear();
+  ConstexprCallResultsSize = 0;
 
   for (const auto &Value : ModuleInitializers)
     Value.second->~PerModuleInitializers();
+  ModuleInitializers.clear();
 
   for (APValue *Value : APValueCleanups)
     Value->~APValue();
+  APValueCleanups.clear();
 }
 
 class ASTContext::ParentMap {
@@ -907,6 +924,9 @@ class ASTContext::ParentMap {
 
   ParentMapPointers PointerParents;
   ParentMapOtherNodes OtherParents;
+  /// The parents which are neither a Decl nor a Stmt. Each of them is
+  /// allocated once, and shared by the entries of all of its children.
+  llvm::SpecificBumpPtrAllocator<ast_type_traits::DynTypedNode> NodeAllocator;
   class ASTVisitor;
 
   static ast_type_traits::DynTypedNode
@@ -934,20 +954,10 @@ class ASTContext::ParentMap {
 public:
   ParentMap(ASTContext &Ctx);
   ~ParentMap() {
-    for (const auto &Entry : PointerParents) {
-      if (Entry.second.is<ast_type_traits::DynTypedNode *>()) {
-        delete Entry.second.get<ast_type_traits::DynTypedNode *>();
-      } else if (Entry.second.is<ParentVector *>()) {
-        delete Entry.second.get<ParentVector *>();
-      }
-    }
-    for (const auto &Entry : OtherParents) {
-      if (Entry.second.is<ast_type_traits::DynTypedNode *>()) {
-        delete Entry.second.get<ast_type_traits::DynTypedNode *>();
-      } else if (Entry.second.is<ParentVector *>()) {
-        delete Entry.second.get<ParentVector *>();
-      }
-    }
+    for (const auto &Entry : PointerParents)
+      delete Entry.second.dyn_cast<ParentVector *>();
+    for (const auto &Entry : OtherParents)
+      delete Entry.second.dyn_cast<ParentVector *>();
   }
 
   DynTypedNodeList getParents(const ast_type_traits::DynTypedNode &Node) {
@@ -971,6 +981,41 @@ ASTContext::setExternalSource(IntrusiveRefCntPtr<ExternalASTSource> Source) {
   ExternalSource = std::move(Source);
 }
 
+bool ASTContext::TrackNodeAllocations = false;
+char *ASTContext::LastNodeAllocation = nullptr;
+size_t ASTContext::LastNodeAllocationSize = 0;
+
+size_t ASTContext::takeNodeAllocationSize(const void *Node) {
+  const char *Begin = LastNodeAllocation;
+  const char *End = Begin + LastNodeAllocationSize;
+  const char *NodeBegin = static_cast<const char *>(Node);
+  if (!Begin || NodeBegin < Begin || NodeBegin >= End)
+    return 0;
+  LastNodeAllocation = nullptr;
+  return End - NodeBegin;
+}
+
+void ASTContext::visitTypeStats(
+    llvm::function_ref<void(StringRef, unsigned, uint64_t)> Visit) const {
+  unsigned Counts[] = {
+#define TYPE(Name, Parent) 0,
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.inc"
+    0 // Extra
+  };
+
+  for (const Type *T : Types)
+    ++Counts[(unsigned)T->getTypeClass()];
+
+  unsigned Idx = 0;
+#define TYPE(Name, Parent)                                              \
+  if (Counts[Idx])                                                      \
+    Visit(#Name, Counts[Idx], Counts[Idx] * sizeof(Name##Type));        \
+  ++Idx;
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.inc"
+}
+
 void ASTContext::PrintStats() const {
   llvm::errs() << "\n*** AST Context Stats:\n";
   llvm::errs() << "  " << Types.size() << " types total.\n";
@@ -1024,6 +1069,22 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  llvm::errs() << NumUniquedTypeComparisons
+               << " template specialization types compared while uniquing, "
+               << NumUniquedTypeHashCollisions
+               << " with the same hash but a different profile\n";
+
+  if (getLangOpts().ConstexprCallCacheSize) {
+    llvm::errs() << "\n";
+    llvm::errs() << ConstexprCallResults.size()
+                 << " constexpr call results memoized ("
+                 << ConstexprCallResultsSize << " bytes)\n";
+    llvm::errs() << NumMemoizedConstexprCallHits
+                 << " constexpr calls reused a memoized result\n";
+    llvm::errs() << NumConstexprCallsNotMemoized
+                 << " constexpr call results not memoized, cache full\n";
+  }
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -4268,6 +4329,7 @@ QualType ASTContext::getCanonicalTemplateSpecializationType(
     Spec = new (Mem) TemplateSpecializationType(CanonTemplate,
                                                 CanonArgs,
                                                 QualType(), QualType());
+    Spec->ProfileHash = ID.ComputeHash();
     Types.push_back(Spec);
     TemplateSpecializationTypes.InsertNode(Spec, InsertPos);
   }
@@ -4381,6 +4443,37 @@ ASTContext::getDependentTemplateSpecializationType(
   return getDependentTemplateSpecializationType(Keyword, NNS, Name, ArgCopy);
 }
 
+/// Compare the uniqued type \p X, whose profile hashes to \p ProfileHash,
+/// with the type profiled as \p ID, profiling \p X only if the hashes match.
+template <typename T>
+static bool equalsUniquedType(T &X, unsigned ProfileHash,
+                              const llvm::FoldingSetNodeID &ID,
+                              unsigned IDHash, llvm::FoldingSetNodeID &TempID,
+                              ASTContext &Context) {
+  ++Context.NumUniquedTypeComparisons;
+  if (ProfileHash != IDHash)
+    return false;
+  X.Profile(TempID, Context);
+  if (TempID == ID)
+    return true;
+  ++Context.NumUniquedTypeHashCollisions;
+  return false;
+}
+
+bool llvm::ContextualFoldingSetTrait<TemplateSpecializationType,
+                                     ASTContext &>::
+    Equals(TemplateSpecializationType &X, const FoldingSetNodeID &ID,
+           unsigned IDHash, FoldingSetNodeID &TempID, ASTContext &Context) {
+  return equalsUniquedType(X, X.ProfileHash, ID, IDHash, TempID, Context);
+}
+
+bool llvm::ContextualFoldingSetTrait<DependentTemplateSpecializationType,
+                                     ASTContext &>::
+    Equals(DependentTemplateSpecializationType &X, const FoldingSetNodeID &ID,
+           unsigned IDHash, FoldingSetNodeID &TempID, ASTContext &Context) {
+  return equalsUniquedType(X, X.ProfileHash, ID, IDHash, TempID, Context);
+}
+
 QualType
 ASTContext::getDependentTemplateSpecializationType(
                                  ElaboratedTypeKeyword Keyword,
@@ -4429,6 +4522,7 @@ ASTContext::getDependentTemplateSpecializationType(
                        TypeAlignment);
   T = new (Mem) DependentTemplateSpecializationType(Keyword, NNS,
                                                     Name, Args, Canon);
+  T->ProfileHash = ID.ComputeHash();
   Types.push_back(T);
   DependentTemplateSpecializationTypes.InsertNode(T, InsertPos);
   return QualType(T, 0);
@@ -10339,6 +10433,32 @@ ASTContext::getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
   return MaterializedTemporaryValues.lookup(E);
 }
 
+const APValue *ASTContext::getMemoizedConstexprCall(StringRef Key) {
+  APValue *Result = ConstexprCallResults.lookup(Key);
+  if (Result)
+    ++NumMemoizedConstexprCallHits;
+  return Result;
+}
+
+void ASTContext::memoizeConstexprCall(StringRef Key, const APValue &Result) {
+  // Account for the map entry, the key stored in it and the value.
+  uint64_t Size = sizeof(llvm::StringMapEntry<APValue *>) + Key.size() + 1 +
+                  sizeof(APValue);
+  if (Result.needsCleanup() && Result.isInt())
+    Size += Result.getInt().getNumWords() * sizeof(uint64_t);
+  if (ConstexprCallResultsSize + Size >
+      uint64_t(getLangOpts().ConstexprCallCacheSize) * 1024) {
+    ++NumConstexprCallsNotMemoized;
+    return;
+  }
+
+  APValue *&Memoized = ConstexprCallResults[Key];
+  if (Memoized)
+    return;
+  Memoized = new (*this) APValue(Result);
+  ConstexprCallResultsSize += Size;
+}
+
 QualType ASTContext::getStringLiteralArrayType(QualType EltTy,
                                                unsigned Length) const {
   // A C++ string literal has a const-qualified element type (C++ 2.13.4p1).
@@ -10439,35 +10559,27 @@ private:
       // comparison operators for all types that DynTypedNode supports that
       // do not have pointer identity.
       auto &NodeOrVector = (*Parents)[MapNode];
+      const ast_type_traits::DynTypedNode &Parent = ParentStack.back().Node;
       if (NodeOrVector.isNull()) {
-        if (const auto *D = ParentStack.back().get<Decl>())
-          NodeOrVector = D;
-        else if (const auto *S = ParentStack.back().get<Stmt>())
-          NodeOrVector = S;
-        else
-          NodeOrVector = new ast_type_traits::DynTypedNode(ParentStack.back());
+        NodeOrVector = getStoredParent();
       } else {
-        if (!NodeOrVector.template is<ParentVector *>()) {
-          auto *Vector = new ParentVector(
+        if (!NodeOrVector.template is<ParentVector *>())
+          NodeOrVector = new ParentVector(
               1, getSingleDynTypedNodeFromParentMap(NodeOrVector));
-          delete NodeOrVector
-              .template dyn_cast<ast_type_traits::DynTypedNode *>();
-          NodeOrVector = Vector;
-        }
 
         auto *Vector = NodeOrVector.template get<ParentVector *>();
         // Skip duplicates for types that have memoization data.
         // We must check that the type has memoization data before calling
         // std::find() because DynTypedNode::operator== can't compare all
         // types.
-        bool Found = ParentStack.back().getMemoizationData() &&
-                     std::find(Vector->begin(), Vector->end(),
-                               ParentStack.back()) != Vector->end();
+        bool Found = Parent.getMemoizationData() &&
+                     std::find(Vector->begin(), Vector->end(), Parent) !=
+                         Vector->end();
         if (!Found)
-          Vector->push_back(ParentStack.back());
+          Vector->push_back(Parent);
       }
     }
-    ParentStack.push_back(createDynTypedNode(Node));
+    ParentStack.push_back({createDynTypedNode(Node), nullptr});
     bool Result = BaseTraverse();
     ParentStack.pop_back();
     return Result;
@@ -10499,8 +10611,29 @@ private:
         &Map.OtherParents);
   }
 
+  /// Returns the parent on top of the stack, as stored in the map entries of
+  /// its children.
+  ParentMapPointers::mapped_type getStoredParent() {
+    ParentStackEntry &Top = ParentStack.back();
+    if (const auto *D = Top.Node.get<Decl>())
+      return D;
+    if (const auto *S = Top.Node.get<Stmt>())
+      return S;
+    if (!Top.Stored)
+      Top.Stored = new (Map.NodeAllocator.Allocate())
+          ast_type_traits::DynTypedNode(Top.Node);
+    return Top.Stored;
+  }
+
+  struct ParentStackEntry {
+    ast_type_traits::DynTypedNode Node;
+    /// The copy of Node shared by the map entries of its children, if they
+    /// need one.
+    ast_type_traits::DynTypedNode *Stored;
+  };
+
   ParentMap &Map;
-  llvm::SmallVector<ast_type_traits::DynTypedNode, 16> ParentStack;
+  llvm::SmallVector<ParentStackEntry, 16> ParentStack;
 };
 
 ASTContext::ParentMap::ParentMap(ASTContext &Ctx) {
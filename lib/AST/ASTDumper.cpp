@@ -183,9 +183,10 @@ LLVM_DUMP_METHOD void Decl::dump(raw_ostream &OS, bool Deserialize,
   ASTContext &Ctx = getASTContext();
   const SourceManager &SM = Ctx.getSourceManager();
 
-  if (ADOF_JSON == Format) {
+  if (ADOF_JSON == Format || ADOF_JSONCompact == Format) {
     JSONDumper P(OS, SM, Ctx, Ctx.getPrintingPolicy(),
-                 &Ctx.getCommentCommandTraits());
+                 &Ctx.getCommentCommandTraits(),
+                 /*IndentSize=*/ADOF_JSON == Format ? 2 : 0);
     (void)Deserialize; // FIXME?
     P.Visit(this);
   } else {
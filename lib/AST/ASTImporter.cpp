@@ -1990,6 +1990,7 @@ bool ASTNodeImporter::IsStructuralMatch(Decl *From, Decl *To, bool Complain) {
       Importer.getFromContext(), Importer.getToContext(),
       Importer.getNonEquivalentDecls(), getStructuralEquivalenceKind(Importer),
       false, Complain);
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(From, To);
 }
 
@@ -2009,6 +2010,7 @@ bool ASTNodeImporter::IsStructuralMatch(RecordDecl *FromRecord,
                                    Importer.getNonEquivalentDecls(),
                                    getStructuralEquivalenceKind(Importer),
                                    false, Complain);
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(FromRecord, ToRecord);
 }
 
@@ -2018,6 +2020,7 @@ bool ASTNodeImporter::IsStructuralMatch(VarDecl *FromVar, VarDecl *ToVar,
       Importer.getFromContext(), Importer.getToContext(),
       Importer.getNonEquivalentDecls(), getStructuralEquivalenceKind(Importer),
       false, Complain);
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(FromVar, ToVar);
 }
 
@@ -2031,6 +2034,7 @@ bool ASTNodeImporter::IsStructuralMatch(EnumDecl *FromEnum, EnumDecl *ToEnum) {
   StructuralEquivalenceContext Ctx(
       Importer.getFromContext(), Importer.getToContext(),
       Importer.getNonEquivalentDecls(), getStructuralEquivalenceKind(Importer));
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(FromEnum, ToEnum);
 }
 
@@ -2040,6 +2044,7 @@ bool ASTNodeImporter::IsStructuralMatch(FunctionTemplateDecl *From,
       Importer.getFromContext(), Importer.getToContext(),
       Importer.getNonEquivalentDecls(), getStructuralEquivalenceKind(Importer),
       false, false);
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(From, To);
 }
 
@@ -2048,6 +2053,7 @@ bool ASTNodeImporter::IsStructuralMatch(FunctionDecl *From, FunctionDecl *To) {
       Importer.getFromContext(), Importer.getToContext(),
       Importer.getNonEquivalentDecls(), getStructuralEquivalenceKind(Importer),
       false, false);
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(From, To);
 }
 
@@ -2067,6 +2073,7 @@ bool ASTNodeImporter::IsStructuralMatch(ClassTemplateDecl *From,
                                    Importer.getToContext(),
                                    Importer.getNonEquivalentDecls(),
                                    getStructuralEquivalenceKind(Importer));
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(From, To);
 }
 
@@ -2076,6 +2083,7 @@ bool ASTNodeImporter::IsStructuralMatch(VarTemplateDecl *From,
                                    Importer.getToContext(),
                                    Importer.getNonEquivalentDecls(),
                                    getStructuralEquivalenceKind(Importer));
+  Ctx.EquivalentDecls = &Importer.getEquivalentDecls();
   return Ctx.IsEquivalent(From, To);
 }
 
@@ -7850,6 +7858,10 @@ ASTImporter::findDeclsInToCtx(DeclContext *DC, DeclarationName Name) {
   }
 }
 
+ASTImporter::EquivalentDeclSet &ASTImporter::getEquivalentDecls() {
+  return SharedState->getEquivalentDecls();
+}
+
 void ASTImporter::AddToLookupTable(Decl *ToD) {
   SharedState->addDeclToLookup(ToD);
 }
@@ -8805,5 +8817,6 @@ bool ASTImporter::IsStructurallyEquivalent(QualType From, QualType To,
   StructuralEquivalenceContext Ctx(FromContext, ToContext, NonEquivalentDecls,
                                    getStructuralEquivalenceKind(*this), false,
                                    Complain);
+  Ctx.EquivalentDecls = &getEquivalentDecls();
   return Ctx.IsEquivalent(From, To);
 }
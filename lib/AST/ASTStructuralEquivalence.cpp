@@ -1583,6 +1583,9 @@ static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
   if (Context.NonEquivalentDecls.count(P))
     return false;
 
+  if (Context.EquivalentDecls && Context.EquivalentDecls->count(P))
+    return true;
+
   // Check if a check for these declarations is already pending.
   // If yes D1 and D2 will be checked later (from DeclsToCheck),
   // or these are already checked (and equivalent).
@@ -1718,7 +1721,10 @@ bool StructuralEquivalenceContext::IsEquivalent(Decl *D1, Decl *D2) {
   if (!::IsStructurallyEquivalent(*this, D1, D2))
     return false;
 
-  return !Finish();
+  if (Finish())
+    return false;
+  cacheEquivalentDecls();
+  return true;
 }
 
 bool StructuralEquivalenceContext::IsEquivalent(QualType T1, QualType T2) {
@@ -1727,7 +1733,10 @@ bool StructuralEquivalenceContext::IsEquivalent(QualType T1, QualType T2) {
   if (!::IsStructurallyEquivalent(*this, T1, T2))
     return false;
 
-  return !Finish();
+  if (Finish())
+    return false;
+  cacheEquivalentDecls();
+  return true;
 }
 
 bool StructuralEquivalenceContext::CheckCommonEquivalence(Decl *D1, Decl *D2) {
@@ -1879,6 +1888,30 @@ bool StructuralEquivalenceContext::CheckKindSpecificEquivalence(
   return true;
 }
 
+/// Determine whether the equivalence of \p D with another declaration can't
+/// change anymore, as it does when a class gets defined.
+static bool isEquivalenceFinal(const Decl *D) {
+  if (const auto *Tag = dyn_cast<TagDecl>(D)) {
+    const TagDecl *Definition = Tag->getDefinition();
+    return Definition && !Definition->isBeingDefined();
+  }
+  if (const auto *Interface = dyn_cast<ObjCInterfaceDecl>(D))
+    return Interface->hasDefinition();
+  return true;
+}
+
+void StructuralEquivalenceContext::cacheEquivalentDecls() {
+  // A minimal check skips the contexts which aren't loaded yet.
+  if (!EquivalentDecls || EqKind == StructuralEquivalenceKind::Minimal)
+    return;
+  // The pairs were only found equivalent assuming the others are, so either
+  // all of them are cached or none.
+  for (const std::pair<Decl *, Decl *> &P : VisitedDecls)
+    if (!isEquivalenceFinal(P.first) || !isEquivalenceFinal(P.second))
+      return;
+  EquivalentDecls->insert(VisitedDecls.begin(), VisitedDecls.end());
+}
+
 bool StructuralEquivalenceContext::Finish() {
   while (!DeclsToCheck.empty()) {
     // Check the next declaration.
@@ -2370,11 +2370,14 @@ APValue *VarDecl::evaluateValue(
 
   // Ensure the computed APValue is cleaned up later if evaluation succeeded,
   // or that it's empty (so that there's nothing to clean up) if evaluation
-  // failed.
-  if (!Result)
+  // failed. The value is kept as long as the AST, so pack its integer arrays.
+  if (!Result) {
     Eval->Evaluated = APValue();
-  else if (Eval->Evaluated.needsCleanup())
-    getASTContext().addDestruction(&Eval->Evaluated);
+  } else {
+    Eval->Evaluated.packArrays();
+    if (Eval->Evaluated.needsCleanup())
+      getASTContext().addDestruction(&Eval->Evaluated);
+  }
 
   Eval->IsEvaluating = false;
   Eval->WasEvaluated = true;
@@ -60,6 +60,11 @@ using namespace clang;
 #define ABSTRACT_DECL(DECL)
 #include "clang/AST/DeclNodes.inc"
 
+// The bytes allocated for the decls, including their trailing objects.
+#define DECL(DERIVED, BASE) static uint64_t Allocated##DERIVED##Bytes = 0;
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+
 void Decl::updateOutOfDate(IdentifierInfo &II) const {
   getASTContext().getExternalSource()->updateOutOfDateIdentifier(II);
 }
@@ -164,6 +169,7 @@ const char *DeclContext::getDeclKindName() const {
 bool Decl::StatisticsEnabled = false;
 void Decl::EnableStatistics() {
   StatisticsEnabled = true;
+  ASTContext::EnableNodeAllocationTracking();
 }
 
 void Decl::PrintStats() {
@@ -176,23 +182,44 @@ void Decl::PrintStats() {
   llvm::errs() << "  " << totalDecls << " decls total.\n";
 
   int totalBytes = 0;
+  uint64_t totalAllocatedBytes = 0;
 #define DECL(DERIVED, BASE)                                             \
   if (n##DERIVED##s > 0) {                                              \
     totalBytes += (int)(n##DERIVED##s * sizeof(DERIVED##Decl));         \
+    totalAllocatedBytes += Allocated##DERIVED##Bytes;                   \
     llvm::errs() << "    " << n##DERIVED##s << " " #DERIVED " decls, "  \
                  << sizeof(DERIVED##Decl) << " each ("                  \
                  << n##DERIVED##s * sizeof(DERIVED##Decl)               \
-                 << " bytes)\n";                                        \
+                 << " bytes, " << Allocated##DERIVED##Bytes             \
+                 << " bytes with trailing objects)\n";                  \
   }
 #define ABSTRACT_DECL(DECL)
 #include "clang/AST/DeclNodes.inc"
 
   llvm::errs() << "Total bytes = " << totalBytes << "\n";
+  llvm::errs() << "Total bytes with trailing objects = "
+               << totalAllocatedBytes << "\n";
+}
+
+void Decl::visitStats(
+    llvm::function_ref<void(StringRef, unsigned, uint64_t)> Visit) {
+#define DECL(DERIVED, BASE)                                             \
+  if (n##DERIVED##s > 0)                                                \
+    Visit(#DERIVED, n##DERIVED##s, Allocated##DERIVED##Bytes);
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
 }
 
-void Decl::add(Kind k) {
+void Decl::add(Kind k, const Decl *D) {
+  // Decls that weren't allocated by an ASTContext are only accounted for by
+  // their size.
+  size_t Bytes = ASTContext::takeNodeAllocationSize(D);
   switch (k) {
-#define DECL(DERIVED, BASE) case DERIVED: ++n##DERIVED##s; break;
+#define DECL(DERIVED, BASE)                                             \
+  case DERIVED:                                                         \
+    ++n##DERIVED##s;                                                    \
+    Allocated##DERIVED##Bytes += Bytes ? Bytes : sizeof(DERIVED##Decl); \
+    break;
 #define ABSTRACT_DECL(DECL)
 #include "clang/AST/DeclNodes.inc"
   }
@@ -1316,6 +1343,12 @@ DeclContext::LoadLexicalDeclsFromExternalStorage() const {
   FirstDecl = ExternalFirst;
   if (!LastDecl)
     LastDecl = ExternalLast;
+
+  // Outside of C++, buildLookupImpl adds the declarations from AST files to
+  // the lookup table of the translation unit, so the next build needs to
+  // walk the declarations that were spliced in before the ones it added.
+  if (!getParentASTContext().getLangOpts().CPlusPlus)
+    setLookupBuildPosition(nullptr, nullptr);
   return true;
 }
 
@@ -1445,6 +1478,7 @@ void DeclContext::removeDecl(Decl *D) {
          "decl is not in decls list");
 
   // Remove D from the decl chain.  This is O(n) but hopefully rare.
+  Decl *Prev = nullptr;
   if (D == FirstDecl) {
     if (D == LastDecl)
       FirstDecl = LastDecl = nullptr;
@@ -1456,11 +1490,16 @@ void DeclContext::removeDecl(Decl *D) {
       if (I->NextInContextAndBits.getPointer() == D) {
         I->NextInContextAndBits.setPointer(D->NextInContextAndBits.getPointer());
         if (D == LastDecl) LastDecl = I;
+        Prev = I;
         break;
       }
     }
   }
 
+  // The lookup tables that were built up to D continue after the declaration
+  // before it.
+  setLookupBuildPosition(D, Prev);
+
   // Mark that D is no longer in the decl chain.
   D->NextInContextAndBits.setPointer(nullptr);
 
@@ -1578,7 +1617,19 @@ StoredDeclsMap *DeclContext::buildLookup() {
 /// DeclContext, a DeclContext linked to it, or a transparent context
 /// nested within it.
 void DeclContext::buildLookupImpl(DeclContext *DCtx, bool Internal) {
-  for (auto *D : DCtx->noload_decls()) {
+  // Skip the declarations that an earlier build already added; the ones
+  // added to the lookup table since then were added eagerly.
+  Decl *First = DCtx->FirstDecl;
+  if (LookupPtr) {
+    auto Pos = LookupPtr->LastBuiltDecls.find(DCtx);
+    if (Pos != LookupPtr->LastBuiltDecls.end())
+      First = Pos->second->getNextDeclInContext();
+  }
+
+  Decl *Last = nullptr;
+  for (Decl *D = First; D; D = D->getNextDeclInContext()) {
+    Last = D;
+
     // Insert this declaration into the lookup structure, but only if
     // it's semantically within its decl context. Any other decls which
     // should be found in this context are added eagerly.
@@ -1601,6 +1652,33 @@ void DeclContext::buildLookupImpl(DeclContext *DCtx, bool Internal) {
       if (InnerCtx->isTransparentContext() || InnerCtx->isInlineNamespace())
         buildLookupImpl(InnerCtx, Internal);
   }
+
+  // If nothing was added, there is no lookup table to record the position in,
+  // and the next build walks the declarations again.
+  if (Last && LookupPtr)
+    LookupPtr->LastBuiltDecls[DCtx] = Last;
+}
+
+/// setLookupBuildPosition - If the lookup tables that contain the
+/// declarations of this context were last built up to \p From (or up to any
+/// declaration, if \p From is null), make their next builds continue after
+/// \p To instead, or start from the first declaration if \p To is null.
+void DeclContext::setLookupBuildPosition(const Decl *From, Decl *To) const {
+  const DeclContext *DC = this;
+  while (true) {
+    if (StoredDeclsMap *Map = DC->getPrimaryContext()->LookupPtr) {
+      auto Pos = Map->LastBuiltDecls.find(this);
+      if (Pos != Map->LastBuiltDecls.end() && (!From || Pos->second == From)) {
+        if (To)
+          Pos->second = To;
+        else
+          Map->LastBuiltDecls.erase(Pos);
+      }
+    }
+    if (!DC->isTransparentContext() && !DC->isInlineNamespace())
+      break;
+    DC = DC->getParent();
+  }
 }
 
 NamedDecl *const DeclContextLookupResult::SingleElementDummyList = nullptr;
@@ -1938,6 +2016,7 @@ void ASTContext::ReleaseDeclContextMaps() {
   // pointer because the subclass doesn't add anything that needs to
   // be deleted.
   StoredDeclsMap::DestroyAll(LastSDM.getPointer(), LastSDM.getInt());
+  LastSDM.setPointer(nullptr);
 }
 
 void StoredDeclsMap::DestroyAll(StoredDeclsMap *Map, bool Dependent) {
@@ -55,6 +55,7 @@
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -3174,6 +3175,8 @@ findSubobject(EvalInfo &Info, const Expr *E, const CompleteObject &Obj,
   QualType ObjType = Obj.Type;
   const FieldDecl *LastField = nullptr;
   const FieldDecl *VolatileField = nullptr;
+  // The element read out of a packed array, which reading doesn't unpack.
+  APValue PackedElt;
 
   // Walk the designator's path to find the subobject.
   for (unsigned I = 0, N = Sub.Entries.size(); /**/; ++I) {
@@ -3274,7 +3277,11 @@ findSubobject(EvalInfo &Info, const Expr *E, const CompleteObject &Obj,
 
       ObjType = CAT->getElementType();
 
-      if (O->getArrayInitializedElts() > Index)
+      if (O->isPackedArray() && isRead(handler.AccessKind) &&
+          O->getArrayInitializedElts() > Index) {
+        PackedElt = APValue(O->getPackedArrayElt(Index));
+        O = &PackedElt;
+      } else if (O->getArrayInitializedElts() > Index)
         O = &O->getArrayInitializedElt(Index);
       else if (!isRead(handler.AccessKind)) {
         expandArray(*O, Index);
@@ -5462,6 +5469,62 @@ static bool EvaluateArgs(ArrayRef<const Expr *> Args, ArgVector &ArgValues,
 }
 
 /// Evaluate a function call.
+/// Append the raw contents of \p Value to \p Key.
+template <typename T>
+static void appendToMemoKey(SmallVectorImpl<char> &Key, const T &Value) {
+  const char *Data = reinterpret_cast<const char *>(&Value);
+  Key.append(Data, Data + sizeof(T));
+}
+
+static void appendToMemoKey(SmallVectorImpl<char> &Key, const APInt &Value) {
+  appendToMemoKey(Key, Value.getBitWidth());
+  const char *Data = reinterpret_cast<const char *>(Value.getRawData());
+  Key.append(Data, Data + Value.getNumWords() * sizeof(uint64_t));
+}
+
+/// Compute the key under which the result of a call is memoized, see
+/// -fconstexpr-call-cache-size.
+///
+/// Only calls of functions which are passed nothing but integer and
+/// floating-point values are memoized: such a call can't read or modify
+/// objects created by the enclosing evaluation, so its result only depends on
+/// its arguments and on the kind of evaluation.
+///
+/// \returns false if the call can't be memoized.
+static bool getMemoKey(EvalInfo &Info, const FunctionDecl *Callee,
+                       const LValue *This, ArrayRef<APValue> ArgValues,
+                       SmallVectorImpl<char> &Key) {
+  if (!Info.getLangOpts().ConstexprCallCacheSize || This ||
+      Info.checkingPotentialConstantExpression() ||
+      Info.checkingForUndefinedBehavior())
+    return false;
+  QualType ReturnType = Callee->getReturnType();
+  if (!ReturnType->isIntegralOrEnumerationType() &&
+      !ReturnType->isRealFloatingType())
+    return false;
+
+  // The notes produced by an evaluation are only kept if there's somewhere to
+  // keep them, and some results depend on whether the constant evaluation is
+  // required.
+  appendToMemoKey(Key, Callee->getCanonicalDecl());
+  appendToMemoKey(Key, Info.EvalMode);
+  appendToMemoKey(Key, Info.InConstantContext);
+  appendToMemoKey(Key, Info.EvalStatus.Diag != nullptr);
+  for (const APValue &Arg : ArgValues) {
+    appendToMemoKey(Key, Arg.getKind());
+    if (Arg.isInt()) {
+      appendToMemoKey(Key, Arg.getInt().isUnsigned());
+      appendToMemoKey(Key, static_cast<const APInt &>(Arg.getInt()));
+    } else if (Arg.isFloat()) {
+      appendToMemoKey(Key, &Arg.getFloat().getSemantics());
+      appendToMemoKey(Key, Arg.getFloat().bitcastToAPInt());
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
 static bool HandleFunctionCall(SourceLocation CallLoc,
                                const FunctionDecl *Callee, const LValue *This,
                                ArrayRef<const Expr*> Args, const Stmt *Body,
@@ -5474,6 +5537,17 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
+  // Reuse the result of an earlier evaluation of the same call.
+  SmallString<64> MemoKey;
+  if (!getMemoKey(Info, Callee, This, ArgValues, MemoKey)) {
+    MemoKey.clear();
+  } else if (const APValue *Memoized =
+                 Info.Ctx.getMemoizedConstexprCall(MemoKey)) {
+    Result = *Memoized;
+    return true;
+  }
+  size_t NumHeapAllocs = Info.HeapAllocs.size();
+
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -5521,7 +5595,18 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
       return true;
     Info.FFDiag(Callee->getEndLoc(), diag::note_constexpr_no_return);
   }
-  return ESR == ESR_Returned;
+  if (ESR != ESR_Returned)
+    return false;
+
+  // Only memoize calls whose evaluation can be replaced by their result:
+  // calls without notes, side effects or leaked allocations.
+  if (!MemoKey.empty() && (Result.isInt() || Result.isFloat()) &&
+      !Info.EvalStatus.HasSideEffects &&
+      !Info.EvalStatus.HasUndefinedBehavior &&
+      (!Info.EvalStatus.Diag || Info.EvalStatus.Diag->empty()) &&
+      Info.HeapAllocs.size() == NumHeapAllocs)
+    Info.Ctx.memoizeConstexprCall(MemoKey, Result);
+  return true;
 }
 
 /// Evaluate a constructor call.
@@ -13418,6 +13503,22 @@ static bool FastEvaluateAsRValue(const Expr *Exp, Expr::EvalResult &Result,
     return true;
   }
 
+  // The same goes for the constant expressions whose integer value was saved
+  // when they were checked, such as the values of the cases of huge switches.
+  if (const auto *CE = dyn_cast<ConstantExpr>(Exp)) {
+    if (CE->getResultAPValueKind() == APValue::Int) {
+      Result.Val = CE->getAPValueResult();
+      IsConst = true;
+      return true;
+    }
+    if (const auto *L = dyn_cast<IntegerLiteral>(CE->getSubExpr())) {
+      Result.Val = APValue(APSInt(L->getValue(),
+                                  L->getType()->isUnsignedIntegerType()));
+      IsConst = true;
+      return true;
+    }
+  }
+
   // This case should be rare, but we need to check it before we check on
   // the type below.
   if (Exp->getType().isNull()) {
@@ -63,6 +63,8 @@ void ExternalASTSource::CompleteType(ObjCInterfaceDecl *Class) {}
 
 void ExternalASTSource::ReadComments() {}
 
+void ExternalASTSource::ReadCommentsInFile(FileID File) {}
+
 void ExternalASTSource::StartedDeserializing() {}
 
 void ExternalASTSource::FinishedDeserializing() {}
@@ -79,6 +81,11 @@ bool ExternalASTSource::layoutRecordType(
   return false;
 }
 
+const ASTRecordLayout *
+ExternalASTSource::getRecordLayout(const RecordDecl *Record) {
+  return nullptr;
+}
+
 Decl *ExternalASTSource::GetExternalDecl(uint32_t ID) {
   return nullptr;
 }
@@ -57,7 +57,10 @@ Expected<Function *> ByteCodeEmitter::compileFunc(const FunctionDecl *F) {
   Function *Func = P.createFunction(F, ParamOffset, std::move(ParamTypes),
                                     std::move(ParamDescriptors));
   // Compile the function body.
-  if (!F->isConstexpr() || !visitFunc(F)) {
+  Func->IsBeingCompiled = true;
+  bool Compiled = F->isConstexpr() && visitFunc(F);
+  Func->IsBeingCompiled = false;
+  if (!Compiled) {
     // Return a dummy function if compilation failed.
     if (BailLocation)
       return llvm::make_error<ByteCodeGenError>(*BailLocation);
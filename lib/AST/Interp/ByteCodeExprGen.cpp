@@ -155,6 +155,24 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
     if (!this->Visit(RHS))
       return false;
     return true;
+  case BO_Assign: {
+    // Only primitive values are assigned here.
+    if (!classify(LHS->getType()))
+      return this->bail(BO);
+    return dereference(
+        LHS, DerefKind::Write,
+        [this, RHS](PrimType) {
+          // Local or parameter - compute the value to be stored.
+          return visit(RHS);
+        },
+        [this, RHS, BO](PrimType T) {
+          // Pointer on stack - store the value through it.
+          if (!visit(RHS))
+            return false;
+          return DiscardResult ? this->emitStorePop(T, BO)
+                               : this->emitStore(T, BO);
+        });
+  }
   default:
     break;
   }
@@ -205,6 +223,164 @@ bool ByteCodeExprGen<Emitter>::VisitBinaryOperator(const BinaryOperator *BO) {
   return this->bail(BO);
 }
 
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCompoundAssignOperator(
+    const CompoundAssignOperator *CAO) {
+  const Expr *LHS = CAO->getLHS();
+  const Expr *RHS = CAO->getRHS();
+
+  // Only operations computed in the type of the LHS, which both operands
+  // have, are supported.
+  ASTContext &ASTCtx = Ctx.getASTContext();
+  Optional<PrimType> T = classify(LHS->getType());
+  if (!T || *T == PT_Ptr || classify(RHS->getType()) != T ||
+      !ASTCtx.hasSameUnqualifiedType(CAO->getComputationLHSType(),
+                                     LHS->getType()) ||
+      !ASTCtx.hasSameUnqualifiedType(CAO->getComputationResultType(),
+                                     LHS->getType()))
+    return this->bail(CAO);
+
+  UnaryFn Op;
+  switch (CAO->getOpcode()) {
+  case BO_AddAssign:
+    Op = &ByteCodeExprGen::emitAdd;
+    break;
+  case BO_SubAssign:
+    Op = &ByteCodeExprGen::emitSub;
+    break;
+  case BO_MulAssign:
+    Op = &ByteCodeExprGen::emitMul;
+    break;
+  default:
+    return this->bail(CAO);
+  }
+
+  return dereference(
+      LHS, DerefKind::ReadWrite,
+      [this, RHS, Op, CAO](PrimType T) {
+        // Value on stack - combine it with the RHS.
+        return visit(RHS) && (this->*Op)(T, CAO);
+      },
+      [this, RHS, Op, CAO](PrimType T) {
+        // Pointer on stack - load, combine and store the value.
+        if (!this->emitLoad(T, CAO) || !visit(RHS) || !(this->*Op)(T, CAO))
+          return false;
+        return DiscardResult ? this->emitStorePop(T, CAO)
+                             : this->emitStore(T, CAO);
+      });
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitUnaryOperator(const UnaryOperator *UO) {
+  const Expr *SubExpr = UO->getSubExpr();
+
+  switch (UO->getOpcode()) {
+  case UO_PreInc:
+  case UO_PreDec:
+  case UO_PostInc:
+  case UO_PostDec: {
+    Optional<PrimType> T = classify(SubExpr->getType());
+    if (!T || *T == PT_Bool || *T == PT_Ptr)
+      return this->bail(UO);
+    // The value of a postfix operator is the old value, which is not kept.
+    // Discarded postfix operators are the same as prefix ones.
+    if (UO->isPostfix() && !DiscardResult)
+      return this->bail(UO);
+
+    UnaryFn Op = UO->isIncrementOp() ? &ByteCodeExprGen::emitAdd
+                                     : &ByteCodeExprGen::emitSub;
+    unsigned NumBits = getIntWidth(SubExpr->getType());
+    auto Step = [this, Op, NumBits, UO](PrimType T) {
+      return emitConst(T, NumBits, APInt(NumBits, 1), UO) &&
+             (this->*Op)(T, UO);
+    };
+
+    return dereference(
+        SubExpr, DerefKind::ReadWrite,
+        [&Step](PrimType T) {
+          // Value on stack - step it.
+          return Step(T);
+        },
+        [this, &Step, UO](PrimType T) {
+          // Pointer on stack - load, step and store the value.
+          if (!this->emitLoad(T, UO) || !Step(T))
+            return false;
+          return DiscardResult ? this->emitStorePop(T, UO)
+                               : this->emitStore(T, UO);
+        });
+  }
+  case UO_Extension:
+    return this->Visit(SubExpr);
+  default:
+    return this->bail(UO);
+  }
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitDeclRefExpr(const DeclRefExpr *DE) {
+  const ValueDecl *D = DE->getDecl();
+
+  // References to locals and parameters would need the referenced pointer to
+  // be loaded.
+  if (D->getType()->isReferenceType())
+    return this->bail(DE);
+  if (DiscardResult)
+    return true;
+
+  auto It = Locals.find(D);
+  if (It != Locals.end())
+    return this->emitGetPtrLocal(It->second.Offset, DE);
+  if (auto *PD = dyn_cast<ParmVarDecl>(D)) {
+    auto ParamIt = this->Params.find(PD);
+    if (ParamIt != this->Params.end())
+      return this->emitGetPtrParam(ParamIt->second, DE);
+  }
+  if (auto *VD = dyn_cast<VarDecl>(D))
+    if (!VD->hasLocalStorage())
+      return getPtrVarDecl(VD, DE);
+  return this->bail(DE);
+}
+
+template <class Emitter>
+bool ByteCodeExprGen<Emitter>::VisitCallExpr(const CallExpr *CE) {
+  // Only direct calls to functions which take and return primitives are
+  // supported.
+  const FunctionDecl *FD = CE->getDirectCallee();
+  if (!FD || isa<CXXMethodDecl>(FD) || FD->getBuiltinID() ||
+      CE->getNumArgs() != FD->getNumParams())
+    return this->bail(CE);
+
+  QualType RetTy = FD->getReturnType();
+  Optional<PrimType> T = classify(RetTy);
+  if (!T && !RetTy->isVoidType())
+    return this->bail(CE);
+  for (const ParmVarDecl *PD : FD->parameters())
+    if (!classify(PD->getType()) || PD->getType()->isReferenceType())
+      return this->bail(CE);
+
+  // Functions which are not constexpr, not defined yet or can't be compiled
+  // are left for the caller to diagnose.
+  Expected<Function *> Func = P.getOrCreateFunction(FD);
+  if (!Func) {
+    consumeError(Func.takeError());
+    return this->bail(CE);
+  }
+  if (!*Func || !((*Func)->isConstexpr() || (*Func)->isBeingCompiled()))
+    return this->bail(CE);
+
+  // The arguments are pushed in order, they become the parameters of the
+  // frame of the callee.
+  for (const Expr *Arg : CE->arguments())
+    if (!visit(Arg))
+      return false;
+
+  if (!this->emitCall(*Func, CE))
+    return false;
+  if (T)
+    return DiscardResult ? this->emitPop(*T, CE) : true;
+  return true;
+}
+
 template <class Emitter>
 bool ByteCodeExprGen<Emitter>::discard(const Expr *E) {
   OptionScope<Emitter> Scope(this, /*discardResult=*/true);
@@ -70,6 +70,10 @@ public:
   bool VisitIntegerLiteral(const IntegerLiteral *E);
   bool VisitParenExpr(const ParenExpr *E);
   bool VisitBinaryOperator(const BinaryOperator *E);
+  bool VisitCompoundAssignOperator(const CompoundAssignOperator *E);
+  bool VisitUnaryOperator(const UnaryOperator *E);
+  bool VisitDeclRefExpr(const DeclRefExpr *E);
+  bool VisitCallExpr(const CallExpr *E);
 
 protected:
   bool visitExpr(const Expr *E) override;
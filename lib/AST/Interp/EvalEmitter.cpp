@@ -231,6 +231,20 @@ bool EvalEmitter::emitSetLocal(uint32_t I, const SourceInfo &Info) {
   return true;
 }
 
+bool EvalEmitter::emitCall(Function *Func, const SourceInfo &Info) {
+  if (!isActive())
+    return true;
+
+  CurrentSource = Info;
+  if (!CheckCallable(S, OpPC, Func) || !CheckCallDepth(S, OpPC))
+    return false;
+
+  // Run the callee to completion: it returns to the root frame, leaving its
+  // result on the stack.
+  S.Current = new InterpFrame(S, Func, S.Current, CodePtr(), {});
+  return Interpret(S, Result);
+}
+
 bool EvalEmitter::emitDestroy(uint32_t I, const SourceInfo &Info) {
   if (!isActive())
     return true;
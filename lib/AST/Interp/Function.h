@@ -102,6 +102,10 @@ public:
   /// Checks if the function is valid to call in constexpr.
   bool isConstexpr() const { return IsValid; }
 
+  /// Checks if the code of the function is being generated, e.g. because it
+  /// is recursive.
+  bool isBeingCompiled() const { return IsBeingCompiled; }
+
   /// Checks if the function is virtual.
   bool isVirtual() const;
 
@@ -150,6 +154,8 @@ private:
   llvm::DenseMap<unsigned, ParamDescriptor> Params;
   /// Flag to indicate if the function is valid.
   bool IsValid = false;
+  /// Flag to indicate if the code of the function is being generated.
+  bool IsBeingCompiled = false;
 
 public:
   /// Dumps the disassembled bytecode to \c llvm::errs().
@@ -75,6 +75,30 @@ static bool RetValue(InterpState &S, CodePtr &Pt, APValue &Result) {
   llvm::report_fatal_error("Interpreter cannot return values");
 }
 
+//===----------------------------------------------------------------------===//
+// Call
+//===----------------------------------------------------------------------===//
+
+static bool Call(InterpState &S, CodePtr &PC, Function *Func) {
+  // The source info is attached to the address after the opcode.
+  CodePtr OpPC = PC - sizeof(Function *);
+  if (!CheckCallable(S, OpPC, Func))
+    return false;
+
+  // The arguments are unknown when checking for a potential constant
+  // expression, so the callee is not evaluated.
+  if (S.checkingPotentialConstantExpression())
+    return false;
+
+  if (!CheckCallDepth(S, OpPC))
+    return false;
+
+  // The arguments were pushed by the caller. Ret returns to the next opcode.
+  S.Current = new InterpFrame(S, Func, S.Current, PC, {});
+  PC = Func->getCodeBegin();
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 // Jmp, Jt, Jf
 //===----------------------------------------------------------------------===//
@@ -390,6 +414,18 @@ bool CheckThis(InterpState &S, CodePtr OpPC, const Pointer &This) {
   return false;
 }
 
+bool CheckCallDepth(InterpState &S, CodePtr OpPC) {
+  unsigned Limit = S.getLangOpts().ConstexprCallDepth;
+  if (S.CallStackDepth > Limit) {
+    S.FFDiag(S.Current->getSource(OpPC),
+             diag::note_constexpr_depth_limit_exceeded)
+        << Limit;
+    return false;
+  }
+  S.CallStackDepth++;
+  return true;
+}
+
 bool CheckPure(InterpState &S, CodePtr OpPC, const CXXMethodDecl *MD) {
   if (!MD->isPure())
     return true;
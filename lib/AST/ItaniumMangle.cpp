@@ -123,6 +123,12 @@ class ItaniumMangleContextImpl : public ItaniumMangleContext {
   llvm::DenseMap<const NamedDecl*, unsigned> Uniquifier;
 
 public:
+  /// The sorted unique ABI tags used by the mangling of each type from an
+  /// empty substitution table, which the manglers look up rather than
+  /// mangle the return type of every function and the type of every variable
+  /// again to derive their tags.
+  llvm::DenseMap<QualType, SmallVector<StringRef, 4>> DerivedAbiTags;
+
   explicit ItaniumMangleContextImpl(ASTContext &Context,
                                     DiagnosticsEngine &Diags)
       : ItaniumMangleContext(Context, Diags) {}
@@ -564,6 +570,8 @@ private:
   AbiTagList makeFunctionReturnTypeTags(const FunctionDecl *FD);
   // Returns sorted unique list of ABI tags.
   AbiTagList makeVariableTypeTags(const VarDecl *VD);
+  // Returns sorted unique list of ABI tags.
+  AbiTagList makeTypeTags(QualType T, bool InResultType);
 };
 
 }
@@ -4883,19 +4891,9 @@ CXXNameMangler::makeFunctionReturnTypeTags(const FunctionDecl *FD) {
   if (DisableDerivedAbiTags)
     return AbiTagList();
 
-  llvm::raw_null_ostream NullOutStream;
-  CXXNameMangler TrackReturnTypeTags(*this, NullOutStream);
-  TrackReturnTypeTags.disableDerivedAbiTags();
-
   const FunctionProtoType *Proto =
       cast<FunctionProtoType>(FD->getType()->getAs<FunctionType>());
-  FunctionTypeDepthState saved = TrackReturnTypeTags.FunctionTypeDepth.push();
-  TrackReturnTypeTags.FunctionTypeDepth.enterResultType();
-  TrackReturnTypeTags.mangleType(Proto->getReturnType());
-  TrackReturnTypeTags.FunctionTypeDepth.leaveResultType();
-  TrackReturnTypeTags.FunctionTypeDepth.pop(saved);
-
-  return TrackReturnTypeTags.AbiTagsRoot.getSortedUniqueUsedAbiTags();
+  return makeTypeTags(Proto->getReturnType(), /*InResultType=*/true);
 }
 
 CXXNameMangler::AbiTagList
@@ -4904,13 +4902,37 @@ CXXNameMangler::makeVariableTypeTags(const VarDecl *VD) {
   if (DisableDerivedAbiTags)
     return AbiTagList();
 
-  llvm::raw_null_ostream NullOutStream;
-  CXXNameMangler TrackVariableType(*this, NullOutStream);
-  TrackVariableType.disableDerivedAbiTags();
+  return makeTypeTags(VD->getType(), /*InResultType=*/false);
+}
 
-  TrackVariableType.mangleType(VD->getType());
+CXXNameMangler::AbiTagList CXXNameMangler::makeTypeTags(QualType T,
+                                                        bool InResultType) {
+  // The mangling of a type only substitutes the parts of it which it already
+  // mangled, so from an empty substitution table the tags it uses only depend
+  // on the type.
+  bool Cacheable = Substitutions.empty();
+  if (Cacheable) {
+    auto It = Context.DerivedAbiTags.find(T);
+    if (It != Context.DerivedAbiTags.end())
+      return It->second;
+  }
 
-  return TrackVariableType.AbiTagsRoot.getSortedUniqueUsedAbiTags();
+  llvm::raw_null_ostream NullOutStream;
+  CXXNameMangler TrackTypeTags(*this, NullOutStream);
+  TrackTypeTags.disableDerivedAbiTags();
+
+  FunctionTypeDepthState saved = TrackTypeTags.FunctionTypeDepth.push();
+  if (InResultType)
+    TrackTypeTags.FunctionTypeDepth.enterResultType();
+  TrackTypeTags.mangleType(T);
+  TrackTypeTags.FunctionTypeDepth.leaveResultType();
+  TrackTypeTags.FunctionTypeDepth.pop(saved);
+
+  const AbiTagList &Tags =
+      TrackTypeTags.AbiTagsRoot.getSortedUniqueUsedAbiTags();
+  if (Cacheable)
+    Context.DerivedAbiTags[T] = Tags;
+  return Tags;
 }
 
 bool CXXNameMangler::shouldHaveAbiTags(ItaniumMangleContextImpl &C,
@@ -29,7 +29,9 @@ void JSONNodeDumper::Visit(const Attr *A) {
   }
   JOS.attribute("id", createPointerRepresentation(A));
   JOS.attribute("kind", AttrName);
-  JOS.attributeObject("range", [A, this] { writeSourceRange(A->getRange()); });
+  if (DumpLocations)
+    JOS.attributeObject("range",
+                        [A, this] { writeSourceRange(A->getRange()); });
   attributeOnlyIfTrue("inherited", A->isInherited());
   attributeOnlyIfTrue("implicit", A->isImplicit());
 
@@ -48,8 +50,9 @@ void JSONNodeDumper::Visit(const Stmt *S) {
 
   JOS.attribute("id", createPointerRepresentation(S));
   JOS.attribute("kind", S->getStmtClassName());
-  JOS.attributeObject("range",
-                      [S, this] { writeSourceRange(S->getSourceRange()); });
+  if (DumpLocations)
+    JOS.attributeObject("range",
+                        [S, this] { writeSourceRange(S->getSourceRange()); });
 
   if (const auto *E = dyn_cast<Expr>(S)) {
     JOS.attribute("type", createQualType(E->getType()));
@@ -96,10 +99,12 @@ void JSONNodeDumper::Visit(const Decl *D) {
     return;
 
   JOS.attribute("kind", (llvm::Twine(D->getDeclKindName()) + "Decl").str());
-  JOS.attributeObject("loc",
-                      [D, this] { writeSourceLocation(D->getLocation()); });
-  JOS.attributeObject("range",
-                      [D, this] { writeSourceRange(D->getSourceRange()); });
+  if (DumpLocations) {
+    JOS.attributeObject("loc",
+                        [D, this] { writeSourceLocation(D->getLocation()); });
+    JOS.attributeObject("range",
+                        [D, this] { writeSourceRange(D->getSourceRange()); });
+  }
   attributeOnlyIfTrue("isImplicit", D->isImplicit());
   attributeOnlyIfTrue("isInvalid", D->isInvalidDecl());
 
@@ -131,10 +136,12 @@ void JSONNodeDumper::Visit(const comments::Comment *C,
 
   JOS.attribute("id", createPointerRepresentation(C));
   JOS.attribute("kind", C->getCommentKindName());
-  JOS.attributeObject("loc",
-                      [C, this] { writeSourceLocation(C->getLocation()); });
-  JOS.attributeObject("range",
-                      [C, this] { writeSourceRange(C->getSourceRange()); });
+  if (DumpLocations) {
+    JOS.attributeObject("loc",
+                        [C, this] { writeSourceLocation(C->getLocation()); });
+    JOS.attributeObject("range",
+                        [C, this] { writeSourceRange(C->getSourceRange()); });
+  }
 
   InnerCommentVisitor::visit(C, FC);
 }
@@ -142,7 +149,7 @@ void JSONNodeDumper::Visit(const comments::Comment *C,
 void JSONNodeDumper::Visit(const TemplateArgument &TA, SourceRange R,
                            const Decl *From, StringRef Label) {
   JOS.attribute("kind", "TemplateArgument");
-  if (R.isValid())
+  if (DumpLocations && R.isValid())
     JOS.attributeObject("range", [R, this] { writeSourceRange(R); });
 
   if (From)
@@ -577,8 +584,9 @@ void JSONNodeDumper::VisitConstantArrayType(const ConstantArrayType *CAT) {
 
 void JSONNodeDumper::VisitDependentSizedExtVectorType(
     const DependentSizedExtVectorType *VT) {
-  JOS.attributeObject(
-      "attrLoc", [VT, this] { writeSourceLocation(VT->getAttributeLoc()); });
+  if (DumpLocations)
+    JOS.attributeObject(
+        "attrLoc", [VT, this] { writeSourceLocation(VT->getAttributeLoc()); });
 }
 
 void JSONNodeDumper::VisitVectorType(const VectorType *VT) {
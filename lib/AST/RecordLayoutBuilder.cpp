@@ -3040,9 +3040,14 @@ ASTContext::getASTRecordLayout(const RecordDecl *D) const {
   const ASTRecordLayout *Entry = ASTRecordLayouts[D];
   if (Entry) return *Entry;
 
+  // Reuse the layout computed when the external source was built, if any.
   const ASTRecordLayout *NewEntry = nullptr;
+  if (ExternalASTSource *Source = getExternalSource())
+    NewEntry = Source->getRecordLayout(D);
 
-  if (isMsLayout(*this)) {
+  if (NewEntry) {
+    // Nothing to compute.
+  } else if (isMsLayout(*this)) {
     MicrosoftRecordLayoutBuilder Builder(*this);
     if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
       Builder.cxxLayout(RD);
@@ -49,6 +49,8 @@ static struct StmtClassNameTable {
   const char *Name;
   unsigned Counter;
   unsigned Size;
+  /// The bytes allocated for the nodes, including their trailing objects.
+  uint64_t Bytes;
 } StmtClassInfo[Stmt::lastStmtConstant+1];
 
 static StmtClassNameTable &getStmtInfoTableEntry(Stmt::StmtClass E) {
@@ -99,6 +101,7 @@ void Stmt::PrintStats() {
   getStmtInfoTableEntry(Stmt::NullStmtClass);
 
   unsigned sum = 0;
+  uint64_t AllocatedSum = 0;
   llvm::errs() << "\n*** Stmt/Expr Stats:\n";
   for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
     if (StmtClassInfo[i].Name == nullptr) continue;
@@ -112,20 +115,40 @@ void Stmt::PrintStats() {
     llvm::errs() << "    " << StmtClassInfo[i].Counter << " "
                  << StmtClassInfo[i].Name << ", " << StmtClassInfo[i].Size
                  << " each (" << StmtClassInfo[i].Counter*StmtClassInfo[i].Size
-                 << " bytes)\n";
+                 << " bytes, " << StmtClassInfo[i].Bytes
+                 << " bytes with trailing objects)\n";
     sum += StmtClassInfo[i].Counter*StmtClassInfo[i].Size;
+    AllocatedSum += StmtClassInfo[i].Bytes;
   }
 
   llvm::errs() << "Total bytes = " << sum << "\n";
+  llvm::errs() << "Total bytes with trailing objects = " << AllocatedSum
+               << "\n";
 }
 
-void Stmt::addStmtClass(StmtClass s) {
-  ++getStmtInfoTableEntry(s).Counter;
+void Stmt::visitStats(
+    llvm::function_ref<void(StringRef, unsigned, uint64_t)> Visit) {
+  // Ensure the table is primed.
+  getStmtInfoTableEntry(Stmt::NullStmtClass);
+
+  for (const StmtClassNameTable &Info : StmtClassInfo)
+    if (Info.Name && Info.Counter)
+      Visit(Info.Name, Info.Counter, Info.Bytes);
+}
+
+void Stmt::addStmtClass(StmtClass s, const Stmt *S) {
+  StmtClassNameTable &Entry = getStmtInfoTableEntry(s);
+  ++Entry.Counter;
+  // Nodes that weren't allocated by an ASTContext, e.g. the ones on the
+  // stack, are only accounted for by their size.
+  size_t Bytes = ASTContext::takeNodeAllocationSize(S);
+  Entry.Bytes += Bytes ? Bytes : Entry.Size;
 }
 
 bool Stmt::StatisticsEnabled = false;
 void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
+  ASTContext::EnableNodeAllocationTracking();
 }
 
 /// Skip no-op (attributed, compound) container stmts and skip captured
@@ -2235,6 +2235,36 @@ uint64_t ItaniumVTableContext::getMethodVTableIndex(GlobalDecl GD) {
   return I->second;
 }
 
+/// Could \p MD need a thunk in the vtables of its class? Thunks adjust the
+/// 'this' pointer or the returned pointer for the slots of the methods that
+/// \p MD overrides, so there are none if each of these methods is in a base
+/// at offset 0 of a single inheritance chain, and returns the same type.
+static bool mayHaveThunks(const CXXMethodDecl *MD) {
+  for (const CXXMethodDecl *Overridden : MD->overridden_methods()) {
+    if (MD->getReturnType().getCanonicalType() !=
+        Overridden->getReturnType().getCanonicalType())
+      return true;
+    for (const CXXRecordDecl *RD = MD->getParent();
+         RD != Overridden->getParent();
+         RD = RD->bases_begin()->getType()->getAsCXXRecordDecl())
+      if (RD->getNumBases() != 1 || RD->bases_begin()->isVirtual())
+        return true;
+    if (mayHaveThunks(Overridden))
+      return true;
+  }
+  return false;
+}
+
+const ItaniumVTableContext::ThunkInfoVectorTy *
+ItaniumVTableContext::getThunkInfo(GlobalDecl GD) {
+  // Most virtual functions don't have thunks, so don't compute the vtable
+  // layout of a class only to find that out, in particular when its vtable
+  // is emitted by another translation unit.
+  if (!mayHaveThunks(cast<CXXMethodDecl>(GD.getDecl())->getCanonicalDecl()))
+    return nullptr;
+  return VTableContextBase::getThunkInfo(GD);
+}
+
 CharUnits
 ItaniumVTableContext::getVirtualBaseOffsetOffset(const CXXRecordDecl *RD,
                                                  const CXXRecordDecl *VBase) {
@@ -22,7 +22,8 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Timer.h"
-#include <deque>
+#include <list>
+#include <map>
 #include <memory>
 #include <set>
 
@@ -33,7 +34,8 @@ namespace {
 
 typedef MatchFinder::MatchCallback MatchCallback;
 
-// The maximum number of memoization entries to store.
+// The maximum number of memoization entries to store. Once it is reached,
+// the least recently used entry is evicted for each new entry.
 // 10k has been experimentally found to give a good trade-off
 // of performance vs. memory consumption by running matcher
 // that match on every statement over a very large codebase.
@@ -72,6 +74,64 @@ struct MemoizedMatchResult {
   BoundNodesTreeBuilder Nodes;
 };
 
+// Maps (matcher, node) -> the match result for memoization, keeping at most
+// MaxMemoizationEntries of the most recently used results.
+class MemoizationCache {
+public:
+  // Returns the result for \p Key, or null if it isn't cached.
+  const MemoizedMatchResult *find(const MatchKey &Key) {
+    auto I = Results.find(Key);
+    if (I == Results.end())
+      return nullptr;
+    Recency.splice(Recency.begin(), Recency, I->second.Position);
+    return &I->second.Result;
+  }
+
+  // Caches \p Result for \p Key, evicting the least recently used result if
+  // the cache is full.
+  const MemoizedMatchResult &insert(const MatchKey &Key,
+                                    MemoizedMatchResult Result) {
+    auto Inserted = Results.insert(std::make_pair(Key, Entry()));
+    Entry &E = Inserted.first->second;
+    E.Result = std::move(Result);
+    if (Inserted.second) {
+      Recency.push_front(&Inserted.first->first);
+      E.Position = Recency.begin();
+    } else {
+      Recency.splice(Recency.begin(), Recency, E.Position);
+    }
+    if (Results.size() > MaxMemoizationEntries) {
+      Results.erase(*Recency.back());
+      Recency.pop_back();
+    }
+    return E.Result;
+  }
+
+private:
+  struct Entry {
+    MemoizedMatchResult Result;
+    std::list<const MatchKey *>::iterator Position;
+  };
+
+  std::map<MatchKey, Entry> Results;
+  // The keys of Results, the most recently used first.
+  std::list<const MatchKey *> Recency;
+};
+
+// The indices of the matchers which may match the nodes of a kind.
+//
+// The matchers which only match declarations with some names, like
+// \c hasName(), are also indexed by those names, so that the other
+// declarations don't have to run them.
+struct MatcherFilter {
+  // The matchers which pass the restrict check.
+  std::vector<unsigned short> All;
+  // The matchers in \c All which don't require a name.
+  std::vector<unsigned short> Unrestricted;
+  // The other matchers in \c All, by the names they require.
+  llvm::StringMap<std::vector<unsigned short>> ByName;
+};
+
 // A RecursiveASTVisitor that traverses all children or all descendants of
 // a node.
 class MatchChildASTVisitor
@@ -405,10 +465,9 @@ public:
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -416,8 +475,8 @@ public:
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(Key, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -450,8 +509,6 @@ public:
                       BoundNodesTreeBuilder *Builder,
                       ast_type_traits::TraversalKind Traversal,
                       BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, 1, Traversal,
                                       Bind);
   }
@@ -460,8 +517,6 @@ public:
                            const DynTypedMatcher &Matcher,
                            BoundNodesTreeBuilder *Builder,
                            BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, INT_MAX,
                                       ast_type_traits::TraversalKind::TK_AsIs,
                                       Bind);
@@ -471,10 +526,6 @@ public:
                          const DynTypedMatcher &Matcher,
                          BoundNodesTreeBuilder *Builder,
                          AncestorMatchMode MatchMode) override {
-    // Reset the cache outside of the recursive call to make sure we
-    // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesAncestorOfRecursively(Node, Matcher, Builder,
                                                 MatchMode);
   }
@@ -565,13 +616,33 @@ private:
     const auto &Filter =
         it != MatcherFiltersMap.end() ? it->second : getFilterForKind(Kind);
 
-    if (Filter.empty())
+    if (Filter.All.empty())
       return;
 
+    // Only try the matchers which require a name on the declarations which
+    // have it. The declarations without an identifier, e.g. constructors,
+    // are matched against all of the matchers.
+    ArrayRef<unsigned short> Indices = Filter.All;
+    SmallVector<unsigned short, 16> NamedIndices;
+    if (!Filter.ByName.empty()) {
+      const auto *ND = DynNode.get<NamedDecl>();
+      if (const IdentifierInfo *II = ND ? ND->getIdentifier() : nullptr) {
+        ArrayRef<unsigned short> Named;
+        auto NameIt = Filter.ByName.find(II->getName());
+        if (NameIt != Filter.ByName.end())
+          Named = NameIt->second;
+        // Keep the matchers in the order they were added.
+        std::merge(Filter.Unrestricted.begin(), Filter.Unrestricted.end(),
+                   Named.begin(), Named.end(),
+                   std::back_inserter(NamedIndices));
+        Indices = NamedIndices;
+      }
+    }
+
     const bool EnableCheckProfiling = Options.CheckProfiling.hasValue();
     TimeBucketRegion Timer;
     auto &Matchers = this->Matchers->DeclOrStmt;
-    for (unsigned short I : Filter) {
+    for (unsigned short I : Indices) {
       auto &MP = Matchers[I];
       if (EnableCheckProfiling)
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
@@ -583,14 +654,25 @@ private:
     }
   }
 
-  const std::vector<unsigned short> &
-  getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
+  const MatcherFilter &getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
     auto &Filter = MatcherFiltersMap[Kind];
     auto &Matchers = this->Matchers->DeclOrStmt;
     assert((Matchers.size() < USHRT_MAX) && "Too many matchers.");
+    std::vector<StringRef> Names;
     for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
-      if (Matchers[I].first.canMatchNodesOfKind(Kind)) {
-        Filter.push_back(I);
+      if (!Matchers[I].first.canMatchNodesOfKind(Kind))
+        continue;
+      Filter.All.push_back(I);
+      Names.clear();
+      if (!Matchers[I].first.getRequiredNames(Names)) {
+        Filter.Unrestricted.push_back(I);
+        continue;
+      }
+      for (StringRef Name : Names) {
+        auto &Indices = Filter.ByName[Name];
+        // hasAnyName("a", "n::a") requires "a" twice.
+        if (Indices.empty() || Indices.back() != I)
+          Indices.push_back(I);
       }
     }
     return Filter;
@@ -651,12 +733,11 @@ private:
     Key.Node = Node;
     Key.BoundNodes = *Builder;
 
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    // Note that we cannot insert before the match and reuse the entry, as
+    // recursive calls to match might evict it.
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -664,8 +745,8 @@ private:
     Result.ResultOfMatch =
         matchesAncestorOfRecursively(Node, Matcher, &Result.Nodes, MatchMode);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(Key, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -712,18 +793,19 @@ private:
       }
     } else {
       // Multiple parents - BFS over the rest of the nodes.
+      // The visited nodes are kept in the queue, which saves the allocations
+      // of a std::deque.
       llvm::DenseSet<const void *> Visited;
-      std::deque<ast_type_traits::DynTypedNode> Queue(Parents.begin(),
-                                                      Parents.end());
-      while (!Queue.empty()) {
+      SmallVector<ast_type_traits::DynTypedNode, 8> Queue(Parents.begin(),
+                                                          Parents.end());
+      for (size_t I = 0; I != Queue.size(); ++I) {
         BoundNodesTreeBuilder BuilderCopy = *Builder;
-        if (Matcher.matches(Queue.front(), this, &BuilderCopy)) {
+        if (Matcher.matches(Queue[I], this, &BuilderCopy)) {
           *Builder = std::move(BuilderCopy);
           return true;
         }
         if (MatchMode != ASTMatchFinder::AMM_ParentOnly) {
-          for (const auto &Parent :
-               ActiveASTContext->getParents(Queue.front())) {
+          for (const auto &Parent : ActiveASTContext->getParents(Queue[I])) {
             // Make sure we do not visit the same node twice.
             // Otherwise, we'll visit the common ancestors as often as there
             // are splits on the way down.
@@ -731,7 +813,6 @@ private:
               Queue.push_back(Parent);
           }
         }
-        Queue.pop_front();
       }
     }
     return false;
@@ -806,7 +887,7 @@ private:
   /// We precalculate a list of matchers that pass the toplevel restrict check.
   /// This also allows us to skip the restrict check at matching time. See
   /// use \c matchesNoKindCheck() above.
-  llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
+  llvm::DenseMap<ast_type_traits::ASTNodeKind, MatcherFilter>
       MatcherFiltersMap;
 
   const MatchFinder::MatchFinderOptions &Options;
@@ -820,9 +901,7 @@ private:
                  llvm::SmallPtrSet<const ObjCCompatibleAliasDecl *, 2>>
       CompatibleAliases;
 
-  // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
-  MemoizationMap ResultCache;
+  MemoizationCache ResultCache;
 };
 
 static CXXRecordDecl *
@@ -1077,6 +1156,22 @@ bool MatchFinder::addDynamicMatcher(const internal::DynTypedMatcher &NodeMatch,
   return false;
 }
 
+void MatchFinder::addMatchers(const MatchFinder &Other) {
+  assert(&Other != this && "Cannot add the matchers of a finder to itself");
+  const MatchersByType &OtherMatchers = Other.Matchers;
+  auto Append = [](auto &To, const auto &From) {
+    To.insert(To.end(), From.begin(), From.end());
+  };
+  Append(Matchers.DeclOrStmt, OtherMatchers.DeclOrStmt);
+  Append(Matchers.Type, OtherMatchers.Type);
+  Append(Matchers.NestedNameSpecifier, OtherMatchers.NestedNameSpecifier);
+  Append(Matchers.NestedNameSpecifierLoc, OtherMatchers.NestedNameSpecifierLoc);
+  Append(Matchers.TypeLoc, OtherMatchers.TypeLoc);
+  Append(Matchers.CtorInit, OtherMatchers.CtorInit);
+  Matchers.AllCallbacks.insert(OtherMatchers.AllCallbacks.begin(),
+                               OtherMatchers.AllCallbacks.end());
+}
+
 std::unique_ptr<ASTConsumer> MatchFinder::newASTConsumer() {
   return std::make_unique<internal::MatchASTConsumer>(this, ParsingDone);
 }
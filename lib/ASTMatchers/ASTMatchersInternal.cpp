@@ -17,6 +17,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/PrettyPrinter.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
@@ -85,8 +86,9 @@ using VariadicOperatorFunction = bool (*)(
 template <VariadicOperatorFunction Func>
 class VariadicMatcher : public DynMatcherInterface {
 public:
-  VariadicMatcher(std::vector<DynTypedMatcher> InnerMatchers)
-      : InnerMatchers(std::move(InnerMatchers)) {}
+  VariadicMatcher(DynTypedMatcher::VariadicOperator Op,
+                  std::vector<DynTypedMatcher> InnerMatchers)
+      : Op(Op), InnerMatchers(std::move(InnerMatchers)) {}
 
   bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                   ASTMatchFinder *Finder,
@@ -94,7 +96,34 @@ public:
     return Func(DynNode, Finder, Builder, InnerMatchers);
   }
 
+  bool getRequiredNames(std::vector<StringRef> &Names) const override {
+    switch (Op) {
+    case DynTypedMatcher::VO_AllOf:
+      // The names required by any of the matchers are required by allOf().
+      for (const DynTypedMatcher &InnerMatcher : InnerMatchers)
+        if (InnerMatcher.getRequiredNames(Names))
+          return true;
+      return false;
+    case DynTypedMatcher::VO_AnyOf:
+    case DynTypedMatcher::VO_EachOf: {
+      // The node must have one of the names of each of the matchers.
+      size_t Size = Names.size();
+      for (const DynTypedMatcher &InnerMatcher : InnerMatchers) {
+        if (!InnerMatcher.getRequiredNames(Names)) {
+          Names.resize(Size);
+          return false;
+        }
+      }
+      return true;
+    }
+    case DynTypedMatcher::VO_UnaryNot:
+      return false;
+    }
+    llvm_unreachable("Invalid Op value.");
+  }
+
 private:
+  const DynTypedMatcher::VariadicOperator Op;
   std::vector<DynTypedMatcher> InnerMatchers;
 };
 
@@ -112,6 +141,10 @@ public:
     return Result;
   }
 
+  bool getRequiredNames(std::vector<StringRef> &Names) const override {
+    return InnerMatcher->getRequiredNames(Names);
+  }
+
 private:
   const std::string ID;
   const IntrusiveRefCntPtr<DynMatcherInterface> InnerMatcher;
@@ -167,24 +200,28 @@ DynTypedMatcher DynTypedMatcher::constructVariadic(
     }
     return DynTypedMatcher(
         SupportedKind, RestrictKind,
-        new VariadicMatcher<AllOfVariadicOperator>(std::move(InnerMatchers)));
+        new VariadicMatcher<AllOfVariadicOperator>(
+            Op, std::move(InnerMatchers)));
 
   case VO_AnyOf:
     return DynTypedMatcher(
         SupportedKind, RestrictKind,
-        new VariadicMatcher<AnyOfVariadicOperator>(std::move(InnerMatchers)));
+        new VariadicMatcher<AnyOfVariadicOperator>(
+            Op, std::move(InnerMatchers)));
 
   case VO_EachOf:
     return DynTypedMatcher(
         SupportedKind, RestrictKind,
-        new VariadicMatcher<EachOfVariadicOperator>(std::move(InnerMatchers)));
+        new VariadicMatcher<EachOfVariadicOperator>(
+            Op, std::move(InnerMatchers)));
 
   case VO_UnaryNot:
     // FIXME: Implement the Not operator to take a single matcher instead of a
     // vector.
     return DynTypedMatcher(
         SupportedKind, RestrictKind,
-        new VariadicMatcher<NotUnaryOperator>(std::move(InnerMatchers)));
+        new VariadicMatcher<NotUnaryOperator>(
+            Op, std::move(InnerMatchers)));
   }
   llvm_unreachable("Invalid Op value.");
 }
@@ -536,6 +573,23 @@ bool HasNameMatcher::matchesNodeFullSlow(const NamedDecl &Node) const {
   return false;
 }
 
+bool HasNameMatcher::getRequiredNames(std::vector<StringRef> &Names) const {
+  size_t Size = Names.size();
+  for (StringRef Pattern : this->Names) {
+    StringRef Name = Pattern.rsplit("::").second;
+    if (Name.empty())
+      Name = Pattern;
+    // Patterns such as "operator+" don't name an identifier.
+    if (!llvm::all_of(Name,
+                      [](char C) { return isIdentifierBody(C, true); })) {
+      Names.resize(Size);
+      return false;
+    }
+    Names.push_back(Name);
+  }
+  return true;
+}
+
 bool HasNameMatcher::matchesNode(const NamedDecl &Node) const {
   assert(matchesNodeFullFast(Node) == matchesNodeFullSlow(Node));
   if (UseUnqualifiedMatch) {
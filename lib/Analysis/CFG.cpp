@@ -4025,6 +4025,17 @@ CFGBlock *CFGBuilder::VisitSwitchStmt(SwitchStmt *Terminator) {
   // Create a new block that will contain the switch statement.
   SwitchTerminatedBlock = createBlock(false);
 
+  // Each case adds a successor to the switch, and the default one is added
+  // last. Make room for all of them at once: the grown storage of a bump
+  // vector is not reused, which adds up for switches with thousands of cases.
+  unsigned NumSuccessors = 1;
+  for (const SwitchCase *SC = Terminator->getSwitchCaseList(); SC;
+       SC = SC->getNextSwitchCase())
+    if (isa<CaseStmt>(SC))
+      ++NumSuccessors;
+  SwitchTerminatedBlock->reserveSuccessors(NumSuccessors,
+                                           cfg->getBumpVectorContext());
+
   // Now process the switch body.  The code after the switch is the implicit
   // successor.
   Succ = SwitchSuccessor;
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Analysis/CallGraph.h"
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/DeclObjC.h"
@@ -20,6 +21,7 @@
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Statistic.h"
@@ -27,7 +29,10 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/DOTGraphTraits.h"
 #include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <string>
@@ -41,14 +46,24 @@ STATISTIC(NumBlockCallEdges, "Number of block call edges");
 
 namespace {
 
+/// A call site found in a function body: the called declaration, or, if the
+/// flag is set, the call operator of a lambda defined in the body.
+using CallEvent = llvm::PointerIntPair<Decl *, 1, bool>;
+
 /// A helper class, which walks the AST and locates all the call sites in the
 /// given function body.
 class CGBuilder : public StmtVisitor<CGBuilder> {
   CallGraph *G;
   CallGraphNode *CallerNode;
 
+  /// If non-null, the call sites are only recorded here, in order, and the
+  /// graph is left untouched, so that several bodies can be visited at once.
+  std::vector<CallEvent> *Events = nullptr;
+
 public:
   CGBuilder(CallGraph *g, CallGraphNode *N) : G(g), CallerNode(N) {}
+  CGBuilder(CallGraph *g, std::vector<CallEvent> &Events)
+      : G(g), CallerNode(nullptr), Events(&Events) {}
 
   void VisitStmt(Stmt *S) { VisitChildren(S); }
 
@@ -67,6 +82,10 @@ public:
   }
 
   void addCalledDecl(Decl *D) {
+    if (Events) {
+      Events->emplace_back(D, false);
+      return;
+    }
     if (G->includeInGraph(D)) {
       CallGraphNode *CalleeNode = G->getOrInsertNode(D);
       CallerNode->addCallee(CalleeNode);
@@ -82,9 +101,16 @@ public:
   void VisitLambdaExpr(LambdaExpr *LE) {
     if (FunctionTemplateDecl *FTD = LE->getDependentCallOperator())
       for (FunctionDecl *FD : FTD->specializations())
-        G->VisitFunctionDecl(FD);
+        visitLambdaCallOperator(FD);
     else if (CXXMethodDecl *MD = LE->getCallOperator())
-      G->VisitFunctionDecl(MD);
+      visitLambdaCallOperator(MD);
+  }
+
+  void visitLambdaCallOperator(FunctionDecl *FD) {
+    if (Events)
+      Events->emplace_back(FD, true);
+    else
+      G->VisitFunctionDecl(FD);
   }
 
   void VisitCXXNewExpr(CXXNewExpr *E) {
@@ -128,6 +154,20 @@ public:
     }
   }
 
+  /// Visit the body of \p D, and its member initializers if it is a
+  /// constructor.
+  void visitDecl(Decl *D) {
+    if (Stmt *Body = D->getBody())
+      Visit(Body);
+
+    // Include C++ constructor member initializers.
+    if (auto constructor = dyn_cast<CXXConstructorDecl>(D)) {
+      for (CXXCtorInitializer *init : constructor->inits()) {
+        Visit(init->getInit());
+      }
+    }
+  }
+
   void VisitChildren(Stmt *S) {
     for (Stmt *SubStmt : S->children())
       if (SubStmt)
@@ -174,20 +214,115 @@ bool CallGraph::includeInGraph(const Decl *D) {
 void CallGraph::addNodeForDecl(Decl* D, bool IsGlobal) {
   assert(D);
 
+  // The calls are visited later, possibly on another thread.
+  if (DeferredDecls) {
+    DeferredDecls->push_back(D);
+    return;
+  }
+
   // Allocate a new node, mark it as root, and process its calls.
   CallGraphNode *Node = getOrInsertNode(D);
 
   // Process all the calls by this function as well.
   CGBuilder builder(this, Node);
-  if (Stmt *Body = D->getBody())
-    builder.Visit(Body);
+  builder.visitDecl(D);
+}
+
+void CallGraph::addToCallGraph(ArrayRef<Decl *> Decls, unsigned NumThreads) {
+  // Deserializing declarations while visiting the bodies is not thread-safe.
+  if (NumThreads <= 1 || Decls.empty() ||
+      Decls.front()->getASTContext().getExternalSource()) {
+    for (Decl *D : Decls)
+      addToCallGraph(D);
+    return;
+  }
+
+  // Collect the declarations whose bodies are visited, in order.
+  std::vector<Decl *> Deferred;
+  DeferredDecls = &Deferred;
+  for (Decl *D : Decls)
+    addToCallGraph(D);
+  DeferredDecls = nullptr;
+
+  // Find the call sites of each body; this only reads the AST.
+  std::vector<std::vector<CallEvent>> Events(Deferred.size());
+  {
+    llvm::ThreadPool Pool(std::min<unsigned>(NumThreads, Deferred.size()));
+    for (size_t I = 0, E = Deferred.size(); I != E; ++I)
+      Pool.async([this, &Deferred, &Events, I] {
+        CGBuilder(this, Events[I]).visitDecl(Deferred[I]);
+      });
+    Pool.wait();
+  }
+
+  // Build the graph in the order in which addNodeForDecl() would have, so
+  // that the nodes, and the edges of each node, are in the same order.
+  for (size_t I = 0, E = Deferred.size(); I != E; ++I) {
+    CallGraphNode *Node = getOrInsertNode(Deferred[I]);
+    CGBuilder Builder(this, Node);
+    for (CallEvent Event : Events[I]) {
+      if (Event.getInt())
+        VisitFunctionDecl(cast<FunctionDecl>(Event.getPointer()));
+      else
+        Builder.addCalledDecl(Event.getPointer());
+    }
+  }
+}
+
+void CallGraph::getEdgesByName(
+    llvm::function_ref<Optional<std::string>(const Decl *)> GetName,
+    EdgesByName &Edges) const {
+  for (const auto &Entry : FunctionMap) {
+    const CallGraphNode *Node = Entry.second.get();
+    if (Node == Root)
+      continue;
+    Optional<std::string> Caller = GetName(Node->getDecl());
+    if (!Caller)
+      continue;
+    std::set<std::string> &Callees = Edges[*Caller];
+    for (const CallGraphNode *Callee : *Node)
+      if (Optional<std::string> Name = GetName(Callee->getDecl()))
+        Callees.insert(std::move(*Name));
+  }
+}
+
+void CallGraph::writeEdges(const EdgesByName &Edges, raw_ostream &OS) {
+  llvm::json::OStream J(OS, /*IndentSize=*/2);
+  J.object([&] {
+    for (const auto &Entry : Edges)
+      J.attributeArray(Entry.first, [&] {
+        for (const std::string &Callee : Entry.second)
+          J.value(Callee);
+      });
+  });
+  OS << '\n';
+}
 
-  // Include C++ constructor member initializers.
-  if (auto constructor = dyn_cast<CXXConstructorDecl>(D)) {
-    for (CXXCtorInitializer *init : constructor->inits()) {
-      builder.Visit(init->getInit());
+llvm::Error CallGraph::readEdges(StringRef JSON, EdgesByName &Edges) {
+  llvm::Expected<llvm::json::Value> Value = llvm::json::parse(JSON);
+  if (!Value)
+    return Value.takeError();
+  const llvm::json::Object *Object = Value->getAsObject();
+  if (!Object)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "expected a JSON object");
+  for (const auto &Entry : *Object) {
+    const llvm::json::Array *Callees = Entry.second.getAsArray();
+    if (!Callees)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "expected an array of callees for '%s'",
+                                     Entry.first.str().c_str());
+    std::set<std::string> &Names = Edges[Entry.first.str()];
+    for (const llvm::json::Value &Callee : *Callees) {
+      Optional<StringRef> Name = Callee.getAsString();
+      if (!Name)
+        return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                       "expected a callee name for '%s'",
+                                       Entry.first.str().c_str());
+      Names.insert(Name->str());
     }
   }
+  return llvm::Error::success();
 }
 
 CallGraphNode *CallGraph::getNode(const Decl *F) const {
@@ -407,6 +407,21 @@ void RecursiveCloneTypeIIHashConstraint::constrain(
   Sequences = Result;
 }
 
+size_t RecursiveCloneTypeIIHashConstraint::getHash(const StmtSequence &S) {
+  std::vector<std::pair<size_t, StmtSequence>> StmtsByHash;
+  if (!S.holdsSequence())
+    return saveHash(S.front(), S.getContainingDecl(), StmtsByHash);
+
+  // Hash the child hashes of the subsequence like saveHash() does.
+  llvm::MD5 Hash;
+  for (const Stmt *Child : S) {
+    size_t ChildHash = saveHash(Child, S.getContainingDecl(), StmtsByHash);
+    Hash.update(
+        StringRef(reinterpret_cast<char *>(&ChildHash), sizeof(ChildHash)));
+  }
+  return createHash(Hash);
+}
+
 void RecursiveCloneTypeIIVerifyConstraint::constrain(
     std::vector<CloneDetector::CloneGroup> &Sequences) {
   CloneConstraint::splitCloneGroups(
@@ -14,8 +14,40 @@ using namespace ast_matchers;
 
 namespace {
 
-AST_MATCHER_P(LambdaExpr, hasCaptureInit, const Expr *, E) {
-  return llvm::is_contained(Node.capture_inits(), E);
+/// Matches each initializer of a capture of a lambda, unlike
+/// lambdaExpr(has(...)), which only matches the first.
+AST_MATCHER_P(LambdaExpr, forEachCaptureInit,
+              ast_matchers::internal::Matcher<Expr>, InnerMatcher) {
+  ast_matchers::internal::BoundNodesTreeBuilder Result;
+  bool Matched = false;
+  for (const Expr *Init : Node.capture_inits()) {
+    ast_matchers::internal::BoundNodesTreeBuilder InitBuilder(*Builder);
+    if (Init && InnerMatcher.matches(*Init, Finder, &InitBuilder)) {
+      Matched = true;
+      Result.addMatch(InitBuilder);
+    }
+  }
+  *Builder = std::move(Result);
+  return Matched;
+}
+
+/// Matches each argument of a call, unlike hasAnyArgument(), which only
+/// matches the first argument matching \p InnerMatcher.
+AST_POLYMORPHIC_MATCHER_P(forEachArgument,
+                          AST_POLYMORPHIC_SUPPORTED_TYPES(
+                              CallExpr, CXXUnresolvedConstructExpr),
+                          ast_matchers::internal::Matcher<Expr>, InnerMatcher) {
+  ast_matchers::internal::BoundNodesTreeBuilder Result;
+  bool Matched = false;
+  for (const Expr *Arg : Node.arguments()) {
+    ast_matchers::internal::BoundNodesTreeBuilder ArgBuilder(*Builder);
+    if (InnerMatcher.matches(*Arg, Finder, &ArgBuilder)) {
+      Matched = true;
+      Result.addMatch(ArgBuilder);
+    }
+  }
+  *Builder = std::move(Result);
+  return Matched;
 }
 
 AST_MATCHER_P(CXXForRangeStmt, hasRangeStmt,
@@ -81,6 +113,12 @@ template <> struct NodeID<Decl> { static const std::string value; };
 const std::string NodeID<Expr>::value = "expr";
 const std::string NodeID<Decl>::value = "decl";
 
+/// The ID of the expression by which the matches are indexed.
+const char BaseID[] = "base";
+
+/// Matches any expression and binds it as the index of the match.
+const auto base = [] { return expr().bind(BaseID); };
+
 template <class T, class F = const Stmt *(ExprMutationAnalyzer::*)(const T *)>
 const Stmt *tryEachMatch(ArrayRef<ast_matchers::BoundNodes> Matches,
                          ExprMutationAnalyzer *Analyzer, F Finder) {
@@ -136,13 +174,36 @@ const Stmt *ExprMutationAnalyzer::findMutationMemoized(
   return MemoizedResults[Exp] = nullptr;
 }
 
+ArrayRef<BoundNodes> ExprMutationAnalyzer::getIndexedMatches(
+    Optional<MatchIndex> &Index, const Expr *Exp,
+    llvm::function_ref<SmallVector<BoundNodes, 1>()> Match) {
+  if (!Index) {
+    Index.emplace();
+    for (BoundNodes &Nodes : Match())
+      if (const auto *Base = Nodes.getNodeAs<Expr>(BaseID))
+        (*Index)[Base].push_back(std::move(Nodes));
+  }
+  const auto Matches = Index->find(Exp);
+  if (Matches == Index->end())
+    return None;
+  return Matches->second;
+}
+
 const Stmt *ExprMutationAnalyzer::tryEachDeclRef(const Decl *Dec,
                                                  MutationFinder Finder) {
-  const auto Refs =
-      match(findAll(declRefExpr(to(equalsNode(Dec))).bind(NodeID<Expr>::value)),
-            Stm, Context);
-  for (const auto &RefNodes : Refs) {
-    const auto *E = RefNodes.getNodeAs<Expr>(NodeID<Expr>::value);
+  if (!DeclRefs) {
+    DeclRefs.emplace();
+    const auto Refs =
+        match(findAll(declRefExpr().bind(NodeID<Expr>::value)), Stm, Context);
+    for (const auto &RefNodes : Refs) {
+      const auto *E = RefNodes.getNodeAs<DeclRefExpr>(NodeID<Expr>::value);
+      (*DeclRefs)[E->getDecl()].push_back(E);
+    }
+  }
+  const auto Refs = DeclRefs->find(Dec);
+  if (Refs == DeclRefs->end())
+    return nullptr;
+  for (const Expr *E : Refs->second) {
     if ((this->*Finder)(E))
       return E;
   }
@@ -150,34 +211,37 @@ const Stmt *ExprMutationAnalyzer::tryEachDeclRef(const Decl *Dec,
 }
 
 bool ExprMutationAnalyzer::isUnevaluated(const Expr *Exp) {
-  return selectFirst<Expr>(
-             NodeID<Expr>::value,
-             match(
-                 findAll(
-                     expr(equalsNode(Exp),
-                          anyOf(
-                              // `Exp` is part of the underlying expression of
-                              // decltype/typeof if it has an ancestor of
-                              // typeLoc.
-                              hasAncestor(typeLoc(unless(
-                                  hasAncestor(unaryExprOrTypeTraitExpr())))),
-                              hasAncestor(expr(anyOf(
-                                  // `UnaryExprOrTypeTraitExpr` is unevaluated
-                                  // unless it's sizeof on VLA.
-                                  unaryExprOrTypeTraitExpr(unless(sizeOfExpr(
-                                      hasArgumentOfType(variableArrayType())))),
-                                  // `CXXTypeidExpr` is unevaluated unless it's
-                                  // applied to an expression of glvalue of
-                                  // polymorphic class type.
-                                  cxxTypeidExpr(
-                                      unless(isPotentiallyEvaluated())),
-                                  // The controlling expression of
-                                  // `GenericSelectionExpr` is unevaluated.
-                                  genericSelectionExpr(hasControllingExpr(
-                                      hasDescendant(equalsNode(Exp)))),
-                                  cxxNoexceptExpr())))))
-                         .bind(NodeID<Expr>::value)),
-                 Stm, Context)) != nullptr;
+  if (!UnevaluatedExprs) {
+    UnevaluatedExprs.emplace();
+    const auto Matches = match(
+        findAll(expr(anyOf(
+                         // `Exp` is part of the underlying expression of
+                         // decltype/typeof if it has an ancestor of typeLoc.
+                         hasAncestor(typeLoc(
+                             unless(hasAncestor(unaryExprOrTypeTraitExpr())))),
+                         hasAncestor(expr(anyOf(
+                             // `UnaryExprOrTypeTraitExpr` is unevaluated
+                             // unless it's sizeof on VLA.
+                             unaryExprOrTypeTraitExpr(unless(sizeOfExpr(
+                                 hasArgumentOfType(variableArrayType())))),
+                             // `CXXTypeidExpr` is unevaluated unless it's
+                             // applied to an expression of glvalue of
+                             // polymorphic class type.
+                             cxxTypeidExpr(unless(isPotentiallyEvaluated())),
+                             cxxNoexceptExpr())))))
+                    .bind(BaseID)),
+        Stm, Context);
+    for (const auto &Nodes : Matches)
+      UnevaluatedExprs->insert(Nodes.getNodeAs<Expr>(BaseID));
+    // The controlling expression of `GenericSelectionExpr` is unevaluated.
+    const auto Controlling = match(
+        findAll(genericSelectionExpr(
+            hasControllingExpr(forEachDescendant(base())))),
+        Stm, Context);
+    for (const auto &Nodes : Controlling)
+      UnevaluatedExprs->insert(Nodes.getNodeAs<Expr>(BaseID));
+  }
+  return UnevaluatedExprs->count(Exp);
 }
 
 const Stmt *
@@ -203,198 +267,211 @@ const Stmt *ExprMutationAnalyzer::findDeclPointeeMutation(
 }
 
 const Stmt *ExprMutationAnalyzer::findDirectMutation(const Expr *Exp) {
-  // LHS of any assignment operators.
-  const auto AsAssignmentLhs =
-      binaryOperator(isAssignmentOperator(),
-                     hasLHS(maybeEvalCommaExpr(equalsNode(Exp))));
-
-  // Operand of increment/decrement operators.
-  const auto AsIncDecOperand =
-      unaryOperator(anyOf(hasOperatorName("++"), hasOperatorName("--")),
-                    hasUnaryOperand(maybeEvalCommaExpr(equalsNode(Exp))));
-
-  // Invoking non-const member function.
-  // A member function is assumed to be non-const when it is unresolved.
-  const auto NonConstMethod = cxxMethodDecl(unless(isConst()));
-  const auto AsNonConstThis =
-      expr(anyOf(cxxMemberCallExpr(callee(NonConstMethod),
-                                   on(maybeEvalCommaExpr(equalsNode(Exp)))),
-                 cxxOperatorCallExpr(callee(NonConstMethod),
-                                     hasArgument(0,
-                                                 maybeEvalCommaExpr(equalsNode(Exp)))),
-                 callExpr(callee(expr(anyOf(
-                     unresolvedMemberExpr(
-                       hasObjectExpression(maybeEvalCommaExpr(equalsNode(Exp)))),
-                     cxxDependentScopeMemberExpr(
-                         hasObjectExpression(maybeEvalCommaExpr(equalsNode(Exp))))))))));
-
-  // Taking address of 'Exp'.
-  // We're assuming 'Exp' is mutated as soon as its address is taken, though in
-  // theory we can follow the pointer and see whether it escaped `Stm` or is
-  // dereferenced and then mutated. This is left for future improvements.
-  const auto AsAmpersandOperand =
-      unaryOperator(hasOperatorName("&"),
-                    // A NoOp implicit cast is adding const.
-                    unless(hasParent(implicitCastExpr(hasCastKind(CK_NoOp)))),
-                    hasUnaryOperand(maybeEvalCommaExpr(equalsNode(Exp))));
-  const auto AsPointerFromArrayDecay =
-      castExpr(hasCastKind(CK_ArrayToPointerDecay),
-               unless(hasParent(arraySubscriptExpr())),
-               has(maybeEvalCommaExpr(equalsNode(Exp))));
-  // Treat calling `operator->()` of move-only classes as taking address.
-  // These are typically smart pointers with unique ownership so we treat
-  // mutation of pointee as mutation of the smart pointer itself.
-  const auto AsOperatorArrowThis =
-      cxxOperatorCallExpr(hasOverloadedOperatorName("->"),
-                          callee(cxxMethodDecl(ofClass(isMoveOnly()),
-                                               returns(nonConstPointerType()))),
-                          argumentCountIs(1),
-                          hasArgument(0, maybeEvalCommaExpr(equalsNode(Exp))));
-
-  // Used as non-const-ref argument when calling a function.
-  // An argument is assumed to be non-const-ref when the function is unresolved.
-  // Instantiated template functions are not handled here but in
-  // findFunctionArgMutation which has additional smarts for handling forwarding
-  // references.
-  const auto NonConstRefParam = forEachArgumentWithParam(
-      maybeEvalCommaExpr(equalsNode(Exp)),
-      parmVarDecl(hasType(nonConstReferenceType())));
-  const auto NotInstantiated = unless(hasDeclaration(isInstantiated()));
-  const auto AsNonConstRefArg = anyOf(
-      callExpr(NonConstRefParam, NotInstantiated),
-      cxxConstructExpr(NonConstRefParam, NotInstantiated),
-      callExpr(callee(expr(anyOf(unresolvedLookupExpr(), unresolvedMemberExpr(),
-                                 cxxDependentScopeMemberExpr(),
-                                 hasType(templateTypeParmType())))),
-               hasAnyArgument(maybeEvalCommaExpr(equalsNode(Exp)))),
-      cxxUnresolvedConstructExpr(hasAnyArgument(maybeEvalCommaExpr(equalsNode(Exp)))));
-
-  // Captured by a lambda by reference.
-  // If we're initializing a capture with 'Exp' directly then we're initializing
-  // a reference capture.
-  // For value captures there will be an ImplicitCastExpr <LValueToRValue>.
-  const auto AsLambdaRefCaptureInit = lambdaExpr(hasCaptureInit(Exp));
-
-  // Returned as non-const-ref.
-  // If we're returning 'Exp' directly then it's returned as non-const-ref.
-  // For returning by value there will be an ImplicitCastExpr <LValueToRValue>.
-  // For returning by const-ref there will be an ImplicitCastExpr <NoOp> (for
-  // adding const.)
-  const auto AsNonConstRefReturn = returnStmt(hasReturnValue(
-                                                maybeEvalCommaExpr(equalsNode(Exp))));
-
-  const auto Matches =
-      match(findAll(stmt(anyOf(AsAssignmentLhs, AsIncDecOperand, AsNonConstThis,
-                               AsAmpersandOperand, AsPointerFromArrayDecay,
-                               AsOperatorArrowThis, AsNonConstRefArg,
-                               AsLambdaRefCaptureInit, AsNonConstRefReturn))
-                        .bind("stmt")),
-            Stm, Context);
-  return selectFirst<Stmt>("stmt", Matches);
+  const auto Matches = getIndexedMatches(DirectMutations, Exp, [this] {
+    // LHS of any assignment operators.
+    const auto AsAssignmentLhs = binaryOperator(
+        isAssignmentOperator(), hasLHS(maybeEvalCommaExpr(base())));
+
+    // Operand of increment/decrement operators.
+    const auto AsIncDecOperand =
+        unaryOperator(anyOf(hasOperatorName("++"), hasOperatorName("--")),
+                      hasUnaryOperand(maybeEvalCommaExpr(base())));
+
+    // Invoking non-const member function.
+    // A member function is assumed to be non-const when it is unresolved.
+    const auto NonConstMethod = cxxMethodDecl(unless(isConst()));
+    const auto AsNonConstThis = expr(eachOf(
+        cxxMemberCallExpr(callee(NonConstMethod),
+                          on(maybeEvalCommaExpr(base()))),
+        cxxOperatorCallExpr(callee(NonConstMethod),
+                            hasArgument(0, maybeEvalCommaExpr(base()))),
+        callExpr(callee(expr(
+            anyOf(unresolvedMemberExpr(
+                      hasObjectExpression(maybeEvalCommaExpr(base()))),
+                  cxxDependentScopeMemberExpr(
+                      hasObjectExpression(maybeEvalCommaExpr(base())))))))));
+
+    // Taking address of 'Exp'.
+    // We're assuming 'Exp' is mutated as soon as its address is taken, though
+    // in theory we can follow the pointer and see whether it escaped `Stm` or
+    // is dereferenced and then mutated. This is left for future improvements.
+    const auto AsAmpersandOperand =
+        unaryOperator(hasOperatorName("&"),
+                      // A NoOp implicit cast is adding const.
+                      unless(hasParent(implicitCastExpr(hasCastKind(CK_NoOp)))),
+                      hasUnaryOperand(maybeEvalCommaExpr(base())));
+    const auto AsPointerFromArrayDecay =
+        castExpr(hasCastKind(CK_ArrayToPointerDecay),
+                 unless(hasParent(arraySubscriptExpr())),
+                 has(maybeEvalCommaExpr(base())));
+    // Treat calling `operator->()` of move-only classes as taking address.
+    // These are typically smart pointers with unique ownership so we treat
+    // mutation of pointee as mutation of the smart pointer itself.
+    const auto AsOperatorArrowThis = cxxOperatorCallExpr(
+        hasOverloadedOperatorName("->"),
+        callee(cxxMethodDecl(ofClass(isMoveOnly()),
+                             returns(nonConstPointerType()))),
+        argumentCountIs(1), hasArgument(0, maybeEvalCommaExpr(base())));
+
+    // Used as non-const-ref argument when calling a function.
+    // An argument is assumed to be non-const-ref when the function is
+    // unresolved.
+    // Instantiated template functions are not handled here but in
+    // findFunctionArgMutation which has additional smarts for handling
+    // forwarding references.
+    const auto NonConstRefParam =
+        forEachArgumentWithParam(maybeEvalCommaExpr(base()),
+                                 parmVarDecl(hasType(nonConstReferenceType())));
+    const auto NotInstantiated = unless(hasDeclaration(isInstantiated()));
+    const auto AsNonConstRefArg = eachOf(
+        callExpr(NonConstRefParam, NotInstantiated),
+        cxxConstructExpr(NonConstRefParam, NotInstantiated),
+        callExpr(callee(expr(anyOf(unresolvedLookupExpr(),
+                                   unresolvedMemberExpr(),
+                                   cxxDependentScopeMemberExpr(),
+                                   hasType(templateTypeParmType())))),
+                 forEachArgument(maybeEvalCommaExpr(base()))),
+        cxxUnresolvedConstructExpr(
+            forEachArgument(maybeEvalCommaExpr(base()))));
+
+    // Captured by a lambda by reference.
+    // If we're initializing a capture with 'Exp' directly then we're
+    // initializing a reference capture.
+    // For value captures there will be an ImplicitCastExpr <LValueToRValue>.
+    const auto AsLambdaRefCaptureInit = lambdaExpr(forEachCaptureInit(base()));
+
+    // Returned as non-const-ref.
+    // If we're returning 'Exp' directly then it's returned as non-const-ref.
+    // For returning by value there will be an ImplicitCastExpr
+    // <LValueToRValue>. For returning by const-ref there will be an
+    // ImplicitCastExpr <NoOp> (for adding const.)
+    const auto AsNonConstRefReturn =
+        returnStmt(hasReturnValue(maybeEvalCommaExpr(base())));
+
+    // Unlike anyOf(), eachOf() reports every expression that a statement
+    // mutates.
+    return match(
+        findAll(stmt(eachOf(AsAssignmentLhs, AsIncDecOperand, AsNonConstThis,
+                            AsAmpersandOperand, AsPointerFromArrayDecay,
+                            AsOperatorArrowThis, AsNonConstRefArg,
+                            AsLambdaRefCaptureInit, AsNonConstRefReturn))
+                    .bind("stmt")),
+        Stm, Context);
+  });
+  return Matches.empty() ? nullptr : Matches.front().getNodeAs<Stmt>("stmt");
 }
 
 const Stmt *ExprMutationAnalyzer::findMemberMutation(const Expr *Exp) {
   // Check whether any member of 'Exp' is mutated.
-  const auto MemberExprs =
-      match(findAll(expr(anyOf(memberExpr(hasObjectExpression(equalsNode(Exp))),
-                               cxxDependentScopeMemberExpr(
-                                   hasObjectExpression(equalsNode(Exp)))))
-                        .bind(NodeID<Expr>::value)),
-            Stm, Context);
-  return findExprMutation(MemberExprs);
+  return findExprMutation(getIndexedMatches(MemberExprs, Exp, [this] {
+    return match(
+        findAll(expr(anyOf(memberExpr(hasObjectExpression(base())),
+                           cxxDependentScopeMemberExpr(
+                               hasObjectExpression(base()))))
+                    .bind(NodeID<Expr>::value)),
+        Stm, Context);
+  }));
 }
 
 const Stmt *ExprMutationAnalyzer::findArrayElementMutation(const Expr *Exp) {
   // Check whether any element of an array is mutated.
-  const auto SubscriptExprs = match(
-      findAll(arraySubscriptExpr(hasBase(ignoringImpCasts(equalsNode(Exp))))
-                  .bind(NodeID<Expr>::value)),
-      Stm, Context);
-  return findExprMutation(SubscriptExprs);
+  return findExprMutation(getIndexedMatches(SubscriptExprs, Exp, [this] {
+    return match(findAll(arraySubscriptExpr(hasBase(ignoringImpCasts(base())))
+                             .bind(NodeID<Expr>::value)),
+                 Stm, Context);
+  }));
 }
 
 const Stmt *ExprMutationAnalyzer::findCastMutation(const Expr *Exp) {
   // If 'Exp' is casted to any non-const reference type, check the castExpr.
-  const auto Casts =
-      match(findAll(castExpr(hasSourceExpression(equalsNode(Exp)),
-                             anyOf(explicitCastExpr(hasDestinationType(
-                                       nonConstReferenceType())),
-                                   implicitCastExpr(hasImplicitDestinationType(
-                                       nonConstReferenceType()))))
-                        .bind(NodeID<Expr>::value)),
-            Stm, Context);
+  const auto Casts = getIndexedMatches(ReferenceCasts, Exp, [this] {
+    return match(findAll(castExpr(hasSourceExpression(base()),
+                                  anyOf(explicitCastExpr(hasDestinationType(
+                                            nonConstReferenceType())),
+                                        implicitCastExpr(
+                                            hasImplicitDestinationType(
+                                                nonConstReferenceType()))))
+                             .bind(NodeID<Expr>::value)),
+                 Stm, Context);
+  });
   if (const Stmt *S = findExprMutation(Casts))
     return S;
   // Treat std::{move,forward} as cast.
-  const auto Calls =
-      match(findAll(callExpr(callee(namedDecl(
-                                 hasAnyName("::std::move", "::std::forward"))),
-                             hasArgument(0, equalsNode(Exp)))
-                        .bind("expr")),
-            Stm, Context);
-  return findExprMutation(Calls);
+  return findExprMutation(getIndexedMatches(MoveCalls, Exp, [this] {
+    return match(
+        findAll(callExpr(callee(namedDecl(
+                             hasAnyName("::std::move", "::std::forward"))),
+                         hasArgument(0, base()))
+                    .bind("expr")),
+        Stm, Context);
+  }));
 }
 
 const Stmt *ExprMutationAnalyzer::findRangeLoopMutation(const Expr *Exp) {
   // If range for looping over 'Exp' with a non-const reference loop variable,
   // check all declRefExpr of the loop variable.
-  const auto LoopVars =
-      match(findAll(cxxForRangeStmt(
-                hasLoopVariable(varDecl(hasType(nonConstReferenceType()))
-                                    .bind(NodeID<Decl>::value)),
-                hasRangeInit(equalsNode(Exp)))),
-            Stm, Context);
-  return findDeclMutation(LoopVars);
+  return findDeclMutation(getIndexedMatches(RangeLoopVars, Exp, [this] {
+    return match(
+        findAll(cxxForRangeStmt(
+            hasLoopVariable(varDecl(hasType(nonConstReferenceType()))
+                                .bind(NodeID<Decl>::value)),
+            hasRangeInit(base()))),
+        Stm, Context);
+  }));
 }
 
 const Stmt *ExprMutationAnalyzer::findReferenceMutation(const Expr *Exp) {
   // Follow non-const reference returned by `operator*()` of move-only classes.
   // These are typically smart pointers with unique ownership so we treat
   // mutation of pointee as mutation of the smart pointer itself.
-  const auto Ref =
-      match(findAll(cxxOperatorCallExpr(
-                        hasOverloadedOperatorName("*"),
-                        callee(cxxMethodDecl(ofClass(isMoveOnly()),
-                                             returns(nonConstReferenceType()))),
-                        argumentCountIs(1), hasArgument(0, equalsNode(Exp)))
-                        .bind(NodeID<Expr>::value)),
-            Stm, Context);
+  const auto Ref = getIndexedMatches(DerefCalls, Exp, [this] {
+    return match(
+        findAll(cxxOperatorCallExpr(
+                    hasOverloadedOperatorName("*"),
+                    callee(cxxMethodDecl(ofClass(isMoveOnly()),
+                                         returns(nonConstReferenceType()))),
+                    argumentCountIs(1), hasArgument(0, base()))
+                    .bind(NodeID<Expr>::value)),
+        Stm, Context);
+  });
   if (const Stmt *S = findExprMutation(Ref))
     return S;
 
   // If 'Exp' is bound to a non-const reference, check all declRefExpr to that.
-  const auto Refs = match(
-      stmt(forEachDescendant(
-          varDecl(
-              hasType(nonConstReferenceType()),
-              hasInitializer(anyOf(equalsNode(Exp),
-                                   conditionalOperator(anyOf(
-                                       hasTrueExpression(equalsNode(Exp)),
-                                       hasFalseExpression(equalsNode(Exp)))))),
-              hasParent(declStmt().bind("stmt")),
-              // Don't follow the reference in range statement, we've handled
-              // that separately.
-              unless(hasParent(declStmt(hasParent(
-                  cxxForRangeStmt(hasRangeStmt(equalsBoundNode("stmt"))))))))
-              .bind(NodeID<Decl>::value))),
-      Stm, Context);
-  return findDeclMutation(Refs);
+  return findDeclMutation(getIndexedMatches(ReferenceVars, Exp, [this] {
+    return match(
+        stmt(forEachDescendant(
+            varDecl(
+                hasType(nonConstReferenceType()),
+                hasInitializer(eachOf(
+                    base(), conditionalOperator(
+                                eachOf(hasTrueExpression(base()),
+                                       hasFalseExpression(base()))))),
+                hasParent(declStmt().bind("stmt")),
+                // Don't follow the reference in range statement, we've handled
+                // that separately.
+                unless(hasParent(declStmt(hasParent(
+                    cxxForRangeStmt(hasRangeStmt(equalsBoundNode("stmt"))))))))
+                .bind(NodeID<Decl>::value))),
+        Stm, Context);
+  }));
 }
 
 const Stmt *ExprMutationAnalyzer::findFunctionArgMutation(const Expr *Exp) {
-  const auto NonConstRefParam = forEachArgumentWithParam(
-      equalsNode(Exp),
-      parmVarDecl(hasType(nonConstReferenceType())).bind("parm"));
-  const auto IsInstantiated = hasDeclaration(isInstantiated());
-  const auto FuncDecl = hasDeclaration(functionDecl().bind("func"));
-  const auto Matches = match(
-      findAll(expr(anyOf(callExpr(NonConstRefParam, IsInstantiated, FuncDecl,
-                                  unless(callee(namedDecl(hasAnyName(
-                                      "::std::move", "::std::forward"))))),
-                         cxxConstructExpr(NonConstRefParam, IsInstantiated,
-                                          FuncDecl)))
-                  .bind(NodeID<Expr>::value)),
-      Stm, Context);
+  const auto Matches = getIndexedMatches(RefArgCalls, Exp, [this] {
+    const auto NonConstRefParam = forEachArgumentWithParam(
+        base(), parmVarDecl(hasType(nonConstReferenceType())).bind("parm"));
+    const auto IsInstantiated = hasDeclaration(isInstantiated());
+    const auto FuncDecl = hasDeclaration(functionDecl().bind("func"));
+    return match(
+        findAll(expr(anyOf(callExpr(NonConstRefParam, IsInstantiated, FuncDecl,
+                                    unless(callee(namedDecl(hasAnyName(
+                                        "::std::move", "::std::forward"))))),
+                           cxxConstructExpr(NonConstRefParam, IsInstantiated,
+                                            FuncDecl)))
+                    .bind(NodeID<Expr>::value)),
+        Stm, Context);
+  });
   for (const auto &Nodes : Matches) {
     const auto *Exp = Nodes.getNodeAs<Expr>(NodeID<Expr>::value);
     const auto *Func = Nodes.getNodeAs<FunctionDecl>("func");
@@ -48,6 +48,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -1021,10 +1022,27 @@ class ThreadSafetyAnalyzer {
 
   BeforeSet *GlobalBeforeSet;
 
+  /// The translations of the capability expressions of the attributes that do
+  /// not depend on the expression which the attribute is checked for. They
+  /// are keyed by the argument of the attribute, the declaration that the
+  /// attribute is attached to, and whether 'this' is accessed with an arrow.
+  llvm::DenseMap<std::pair<const Expr *,
+                           llvm::PointerIntPair<const NamedDecl *, 1, bool>>,
+                 CapabilityExpr>
+      TranslatedAttrExprs;
+
 public:
   ThreadSafetyAnalyzer(ThreadSafetyHandler &H, BeforeSet* Bset)
       : Arena(&Bpa), SxBuilder(Arena), Handler(H), GlobalBeforeSet(Bset) {}
 
+  /// Translates the argument of an attribute like
+  /// SExprBuilder::translateAttrExpr() does. The translations are reused if
+  /// \p DeclExp is missing or accesses a member of 'this', e.g. for every
+  /// access to a guarded member in a method.
+  CapabilityExpr translateAttrExpr(const Expr *AttrExp, const NamedDecl *D,
+                                   const Expr *DeclExp,
+                                   VarDecl *SelfDecl = nullptr);
+
   bool inCurrentScope(const CapabilityExpr &CapE);
 
   void addLock(FactSet &FSet, std::unique_ptr<FactEntry> Entry,
@@ -1268,6 +1286,33 @@ ClassifyDiagnostic(const AttrTy *A) {
   return "mutex";
 }
 
+CapabilityExpr ThreadSafetyAnalyzer::translateAttrExpr(const Expr *AttrExp,
+                                                       const NamedDecl *D,
+                                                       const Expr *DeclExp,
+                                                       VarDecl *SelfDecl) {
+  // Without an expression, only the argument itself is translated.
+  const NamedDecl *KeyDecl = nullptr;
+  bool IsArrow = false;
+  if (DeclExp) {
+    const auto *ME = dyn_cast<MemberExpr>(DeclExp);
+    if (!ME || !isa<CXXThisExpr>(ME->getBase()))
+      return SxBuilder.translateAttrExpr(AttrExp, D, DeclExp, SelfDecl);
+    KeyDecl = D;
+    IsArrow = ME->isArrow();
+  }
+
+  auto Key = std::make_pair(
+      AttrExp,
+      llvm::PointerIntPair<const NamedDecl *, 1, bool>(KeyDecl, IsArrow));
+  auto It = TranslatedAttrExprs.find(Key);
+  if (It != TranslatedAttrExprs.end())
+    return It->second;
+  CapabilityExpr Cp = SxBuilder.translateAttrExpr(AttrExp, D, DeclExp,
+                                                  SelfDecl);
+  TranslatedAttrExprs.insert({Key, Cp});
+  return Cp;
+}
+
 bool ThreadSafetyAnalyzer::inCurrentScope(const CapabilityExpr &CapE) {
   if (!CurrentMethod)
       return false;
@@ -1351,7 +1396,7 @@ void ThreadSafetyAnalyzer::getMutexIDs(CapExprSet &Mtxs, AttrType *Attr,
                                        VarDecl *SelfDecl) {
   if (Attr->args_size() == 0) {
     // The mutex held is the "this" object.
-    CapabilityExpr Cp = SxBuilder.translateAttrExpr(nullptr, D, Exp, SelfDecl);
+    CapabilityExpr Cp = translateAttrExpr(nullptr, D, Exp, SelfDecl);
     if (Cp.isInvalid()) {
        warnInvalidLock(Handler, nullptr, D, Exp, ClassifyDiagnostic(Attr));
        return;
@@ -1363,7 +1408,7 @@ void ThreadSafetyAnalyzer::getMutexIDs(CapExprSet &Mtxs, AttrType *Attr,
   }
 
   for (const auto *Arg : Attr->args()) {
-    CapabilityExpr Cp = SxBuilder.translateAttrExpr(Arg, D, Exp, SelfDecl);
+    CapabilityExpr Cp = translateAttrExpr(Arg, D, Exp, SelfDecl);
     if (Cp.isInvalid()) {
        warnInvalidLock(Handler, nullptr, D, Exp, ClassifyDiagnostic(Attr));
        continue;
@@ -1616,7 +1661,7 @@ void BuildLockset::warnIfMutexNotHeld(const NamedDecl *D, const Expr *Exp,
                                       StringRef DiagKind, SourceLocation Loc) {
   LockKind LK = getLockKindFromAccessKind(AK);
 
-  CapabilityExpr Cp = Analyzer->SxBuilder.translateAttrExpr(MutexExp, D, Exp);
+  CapabilityExpr Cp = Analyzer->translateAttrExpr(MutexExp, D, Exp);
   if (Cp.isInvalid()) {
     warnInvalidLock(Analyzer->Handler, MutexExp, D, Exp, DiagKind);
     return;
@@ -1675,7 +1720,7 @@ void BuildLockset::warnIfMutexNotHeld(const NamedDecl *D, const Expr *Exp,
 /// Warn if the LSet contains the given lock.
 void BuildLockset::warnIfMutexHeld(const NamedDecl *D, const Expr *Exp,
                                    Expr *MutexExp, StringRef DiagKind) {
-  CapabilityExpr Cp = Analyzer->SxBuilder.translateAttrExpr(MutexExp, D, Exp);
+  CapabilityExpr Cp = Analyzer->translateAttrExpr(MutexExp, D, Exp);
   if (Cp.isInvalid()) {
     warnInvalidLock(Analyzer->Handler, MutexExp, D, Exp, DiagKind);
     return;
@@ -2291,11 +2336,15 @@ void ThreadSafetyAnalyzer::runAnalysis(AnalysisDeclContext &AC) {
   // Mark entry block as reachable
   BlockInfo[CFGraph->getEntry().getBlockID()].Reachable = true;
 
-  // Compute SSA names for local variables
-  LocalVarMap.traverseCFG(CFGraph, SortedGraph, BlockInfo);
+  {
+    llvm::TimeTraceScope TimeScope("ThreadSafetyLocalVarMap", StringRef(""));
+
+    // Compute SSA names for local variables
+    LocalVarMap.traverseCFG(CFGraph, SortedGraph, BlockInfo);
 
-  // Fill in source locations for all CFGBlocks.
-  findBlockLocations(CFGraph, SortedGraph, BlockInfo);
+    // Fill in source locations for all CFGBlocks.
+    findBlockLocations(CFGraph, SortedGraph, BlockInfo);
+  }
 
   CapExprSet ExclusiveLocksAcquired;
   CapExprSet SharedLocksAcquired;
@@ -2360,6 +2409,7 @@ void ThreadSafetyAnalyzer::runAnalysis(AnalysisDeclContext &AC) {
     }
   }
 
+  llvm::TimeTraceScope BlocksTimeScope("ThreadSafetyBlocks", StringRef(""));
   for (const auto *CurrBlock : *SortedGraph) {
     unsigned CurrBlockID = CurrBlock->getBlockID();
     CFGBlockInfo *CurrBlockInfo = &BlockInfo[CurrBlockID];
@@ -2549,6 +2599,11 @@ void ThreadSafetyAnalyzer::runAnalysis(AnalysisDeclContext &AC) {
 void threadSafety::runThreadSafetyAnalysis(AnalysisDeclContext &AC,
                                            ThreadSafetyHandler &Handler,
                                            BeforeSet **BSet) {
+  llvm::TimeTraceScope TimeScope("ThreadSafetyAnalysis", [&]() {
+    if (const auto *ND = dyn_cast_or_null<NamedDecl>(AC.getDecl()))
+      return ND->getQualifiedNameAsString();
+    return std::string();
+  });
   if (!*BSet)
     *BSet = new BeforeSet;
   ThreadSafetyAnalyzer Analyzer(Handler, *BSet);
@@ -14,7 +14,14 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/MathExtras.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 using namespace clang;
 
 static const Builtin::Info BuiltinInfo[] = {
@@ -57,7 +64,7 @@ bool Builtin::Context::isBuiltinFunc(const char *Name) {
 }
 
 bool Builtin::Context::builtinIsSupported(const Builtin::Info &BuiltinInfo,
-                                          const LangOptions &LangOpts) {
+                                          const LangOptions &LangOpts) const {
   bool BuiltinsUnsupported =
       (LangOpts.NoBuiltin || LangOpts.isNoBuiltinFunc(BuiltinInfo.Name)) &&
       strchr(BuiltinInfo.Attributes, 'f');
@@ -84,26 +91,111 @@ bool Builtin::Context::builtinIsSupported(const Builtin::Info &BuiltinInfo,
          !CPlusPlusUnsupported;
 }
 
-/// initializeBuiltins - Mark the identifiers for all the builtins with their
-/// appropriate builtin ID # and mark any non-portable builtin identifiers as
-/// such.
+namespace clang {
+namespace Builtin {
+/// An open addressing hash table of the records of builtins, keyed by their
+/// names.
+///
+/// The records of the builtins are static, so the tables are built once per
+/// process rather than once per translation unit.
+class NameTable {
+public:
+  explicit NameTable(ArrayRef<Info> Records) : Records(Records) {
+    Buckets.resize(llvm::PowerOf2Ceil(2 * Records.size() + 1));
+    for (unsigned I = 0, E = Records.size(); I != E; ++I) {
+      unsigned Bucket = getBucket(Records[I].Name);
+      while (Buckets[Bucket])
+        Bucket = (Bucket + 1) & (Buckets.size() - 1);
+      Buckets[Bucket] = I + 1;
+    }
+  }
+
+  /// \returns one plus the index of the last record named \p Name which
+  /// satisfies \p IsSupported, or 0 if there is none.
+  unsigned findLast(StringRef Name,
+                    llvm::function_ref<bool(const Info &)> IsSupported) const {
+    unsigned Result = 0;
+    for (unsigned Bucket = getBucket(Name); Buckets[Bucket];
+         Bucket = (Bucket + 1) & (Buckets.size() - 1)) {
+      unsigned Index = Buckets[Bucket] - 1;
+      if (Index + 1 > Result && Name == Records[Index].Name &&
+          IsSupported(Records[Index]))
+        Result = Index + 1;
+    }
+    return Result;
+  }
+
+  /// \returns the table of \p Records.
+  static const NameTable &get(ArrayRef<Info> Records) {
+    static std::mutex Lock;
+    static std::map<std::pair<const Info *, size_t>,
+                    std::unique_ptr<NameTable>> Tables;
+    std::lock_guard<std::mutex> Guard(Lock);
+    std::unique_ptr<NameTable> &Table =
+        Tables[std::make_pair(Records.data(), Records.size())];
+    if (!Table)
+      Table = std::make_unique<NameTable>(Records);
+    return *Table;
+  }
+
+private:
+  unsigned getBucket(StringRef Name) const {
+    return llvm::djbHash(Name) & (Buckets.size() - 1);
+  }
+
+  ArrayRef<Info> Records;
+
+  /// One plus the indices of the records, or 0 for the empty buckets.
+  std::vector<unsigned> Buckets;
+};
+} // end namespace Builtin
+} // end namespace clang
+
 void Builtin::Context::initializeBuiltins(IdentifierTable &Table,
                                           const LangOptions& LangOpts) {
-  // Step #1: mark all target-independent builtins with their ID's.
-  for (unsigned i = Builtin::NotBuiltin+1; i != Builtin::FirstTSBuiltin; ++i)
-    if (builtinIsSupported(BuiltinInfo[i], LangOpts)) {
-      Table.get(BuiltinInfo[i].Name).setBuiltinID(i);
-    }
+  this->LangOpts = &LangOpts;
+  Names = &NameTable::get(BuiltinInfo);
+  TSNames = &NameTable::get(TSRecords);
+  AuxTSNames = &NameTable::get(AuxTSRecords);
 
-  // Step #2: Register target-specific builtins.
-  for (unsigned i = 0, e = TSRecords.size(); i != e; ++i)
-    if (builtinIsSupported(TSRecords[i], LangOpts))
-      Table.get(TSRecords[i].Name).setBuiltinID(i + Builtin::FirstTSBuiltin);
+  // Mark the identifiers which already exist, e.g. the keywords. The table
+  // marks the others as it creates them.
+  for (const auto &Entry : Table)
+    if (Entry.getValue())
+      if (unsigned ID = lookupBuiltinID(Entry.getKey()))
+        Entry.getValue()->setBuiltinID(ID);
+  Table.setBuiltinInfo(this);
+}
+
+unsigned Builtin::Context::lookupBuiltinID(StringRef Name) const {
+  assert(LangOpts && "Builtins not initialized");
+  // The builtins of the auxiliary target win over those of the target, which
+  // win over the target-independent ones. The builtins of the auxiliary
+  // target are always supported.
+  auto IsAlwaysSupported = [](const Info &) { return true; };
+  if (unsigned I = AuxTSNames->findLast(Name, IsAlwaysSupported))
+    return I - 1 + Builtin::FirstTSBuiltin + TSRecords.size();
+  auto IsSupported = [&](const Info &BuiltinInfo) {
+    return builtinIsSupported(BuiltinInfo, *LangOpts);
+  };
+  if (unsigned I = TSNames->findLast(Name, IsSupported))
+    return I - 1 + Builtin::FirstTSBuiltin;
+  if (unsigned I = Names->findLast(Name, IsSupported))
+    return I - 1;
+  return 0;
+}
 
-  // Step #3: Register target-specific builtins for AuxTarget.
-  for (unsigned i = 0, e = AuxTSRecords.size(); i != e; ++i)
-    Table.get(AuxTSRecords[i].Name)
-        .setBuiltinID(i + Builtin::FirstTSBuiltin + TSRecords.size());
+void Builtin::Context::materializeBuiltins(IdentifierTable &Table) const {
+  if (!LangOpts)
+    return;
+  for (unsigned i = Builtin::NotBuiltin+1; i != Builtin::FirstTSBuiltin; ++i)
+    if (builtinIsSupported(BuiltinInfo[i], *LangOpts))
+      Table.get(BuiltinInfo[i].Name);
+  for (const Info &Record : TSRecords)
+    if (builtinIsSupported(Record, *LangOpts))
+      Table.get(Record.Name);
+  for (const Info &Record : AuxTSRecords)
+    Table.get(Record.Name);
 }
 
 void Builtin::Context::forgetBuiltin(unsigned ID, IdentifierTable &Table) {
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/CodeGenOptions.h"
+#include "llvm/ADT/Twine.h"
 #include <string.h>
 
 namespace clang {
@@ -28,4 +29,11 @@ bool CodeGenOptions::isNoBuiltinFunc(const char *Name) const {
   return false;
 }
 
+std::string CodeGenOptions::getParallelCodeGenPartitionName(StringRef Output,
+                                                            unsigned Partition) {
+  if (Partition == 0)
+    return Output;
+  return (Output + ".part" + Twine(Partition) + ".o").str();
+}
+
 }  // end namespace clang
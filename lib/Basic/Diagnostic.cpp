@@ -199,12 +199,18 @@ DiagnosticsEngine::DiagStateMap::lookup(SourceManager &SrcMgr,
     return FirstDiagState;
 
   std::pair<FileID, unsigned> Decomp = SrcMgr.getDecomposedLoc(Loc);
-  const File *F = getFile(SrcMgr, Decomp.first);
-  return F->lookup(Decomp.second);
+  if (!LastLookupFile || LastLookupID != Decomp.first) {
+    LastLookupFile = getFile(SrcMgr, Decomp.first);
+    LastLookupID = Decomp.first;
+  }
+  return LastLookupFile->lookup(Decomp.second);
 }
 
 DiagnosticsEngine::DiagState *
 DiagnosticsEngine::DiagStateMap::File::lookup(unsigned Offset) const {
+  // Most files have no diagnostic pragmas.
+  if (StateTransitions.size() == 1)
+    return StateTransitions.front().State;
   auto OnePastIt =
       llvm::partition_point(StateTransitions, [=](const DiagStatePoint &P) {
         return P.Offset <= Offset;
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Chrono.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/Path.h"
@@ -98,6 +99,81 @@ FileSystemStatCache::get(StringRef Path, llvm::vfs::Status &Status,
   return std::error_code();
 }
 
+namespace {
+
+/// The stat cache of a single FileManager, which forwards to a cache shared
+/// with other FileManagers.
+class SharedStatCacheClient : public FileSystemStatCache {
+public:
+  SharedStatCacheClient(SharedFileSystemStatCache &Shared) : Shared(Shared) {}
+
+  std::error_code getStat(StringRef Path, llvm::vfs::Status &Status,
+                          bool isFile, std::unique_ptr<llvm::vfs::File> *F,
+                          llvm::vfs::FileSystem &FS) override {
+    if (!llvm::sys::path::is_absolute(Path))
+      return get(Path, Status, isFile, F, nullptr, FS);
+
+    if (auto Cached = Shared.lookup(Path)) {
+      if (!*Cached)
+        return Cached->getError();
+      Status = **Cached;
+      return std::error_code();
+    }
+
+    // Don't open the file even if the client would like it to be opened: the
+    // result must not depend on whether the path was looked up as a file or
+    // as a directory. FileManager opens the file when it needs the contents.
+    llvm::ErrorOr<llvm::vfs::Status> Result = FS.status(Path);
+    Shared.insert(Path, Result);
+    if (!Result)
+      return Result.getError();
+    Status = *Result;
+    return std::error_code();
+  }
+
+private:
+  SharedFileSystemStatCache &Shared;
+};
+
+} // end anonymous namespace
+
+SharedFileSystemStatCache::SharedFileSystemStatCache()
+    : Shards(new CacheShard[NumShards]) {}
+
+std::unique_ptr<FileSystemStatCache>
+SharedFileSystemStatCache::createStatCache() {
+  return std::make_unique<SharedStatCacheClient>(*this);
+}
+
+SharedFileSystemStatCache::CacheShard &
+SharedFileSystemStatCache::getShard(StringRef Path) {
+  return Shards[llvm::hash_value(Path) % NumShards];
+}
+
+Optional<llvm::ErrorOr<llvm::vfs::Status>>
+SharedFileSystemStatCache::lookup(StringRef Path) {
+  CacheShard &Shard = getShard(Path);
+  std::unique_lock<std::mutex> LockGuard(Shard.Lock);
+  auto It = Shard.Cache.find(Path);
+  if (It == Shard.Cache.end())
+    return None;
+  return It->getValue();
+}
+
+void SharedFileSystemStatCache::insert(
+    StringRef Path, const llvm::ErrorOr<llvm::vfs::Status> &Result) {
+  CacheShard &Shard = getShard(Path);
+  std::unique_lock<std::mutex> LockGuard(Shard.Lock);
+  Shard.Cache.try_emplace(Path, Result);
+}
+
+void SharedFileSystemStatCache::clear() {
+  for (unsigned I = 0; I != NumShards; ++I) {
+    std::unique_lock<std::mutex> LockGuard(Shards[I].Lock);
+    Shards[I].Cache.clear();
+  }
+}
+
 std::error_code
 MemorizeStatCalls::getStat(StringRef Path, llvm::vfs::Status &Status,
                            bool isFile,
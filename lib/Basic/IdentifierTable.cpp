@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/Builtins.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/OperatorKinds.h"
@@ -68,6 +69,11 @@ IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
   AddKeywords(LangOpts);
 }
 
+void IdentifierTable::markBuiltin(IdentifierInfo &II) {
+  if (unsigned ID = Builtins->lookupBuiltinID(II.getName()))
+    II.setBuiltinID(ID);
+}
+
 //===----------------------------------------------------------------------===//
 // Language Keyword Implementation
 //===----------------------------------------------------------------------===//
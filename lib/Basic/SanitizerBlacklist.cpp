@@ -18,6 +18,19 @@ SanitizerBlacklist::SanitizerBlacklist(
     const std::vector<std::string> &BlacklistPaths, SourceManager &SM)
     : SSCL(SanitizerSpecialCaseList::createOrDie(BlacklistPaths)), SM(SM) {}
 
+template <typename ComputeFn>
+bool SanitizerBlacklist::getCachedResult(CachedResults &Results,
+                                         SanitizerMask Mask,
+                                         StringRef Category,
+                                         ComputeFn Compute) {
+  for (const CachedResult &Result : Results)
+    if (Result.Mask == Mask && Result.Category == Category)
+      return Result.Blacklisted;
+  bool Blacklisted = Compute();
+  Results.push_back({Mask, Category.str(), Blacklisted});
+  return Blacklisted;
+}
+
 bool SanitizerBlacklist::isBlacklistedGlobal(SanitizerMask Mask,
                                              StringRef GlobalName,
                                              StringRef Category) const {
@@ -27,7 +40,9 @@ bool SanitizerBlacklist::isBlacklistedGlobal(SanitizerMask Mask,
 bool SanitizerBlacklist::isBlacklistedType(SanitizerMask Mask,
                                            StringRef MangledTypeName,
                                            StringRef Category) const {
-  return SSCL->inSection(Mask, "type", MangledTypeName, Category);
+  return getCachedResult(TypeResults[MangledTypeName], Mask, Category, [&] {
+    return SSCL->inSection(Mask, "type", MangledTypeName, Category);
+  });
 }
 
 bool SanitizerBlacklist::isBlacklistedFunction(SanitizerMask Mask,
@@ -44,7 +59,13 @@ bool SanitizerBlacklist::isBlacklistedFile(SanitizerMask Mask,
 bool SanitizerBlacklist::isBlacklistedLocation(SanitizerMask Mask,
                                                SourceLocation Loc,
                                                StringRef Category) const {
-  return Loc.isValid() &&
-         isBlacklistedFile(Mask, SM.getFilename(SM.getFileLoc(Loc)), Category);
+  if (Loc.isInvalid())
+    return false;
+  SourceLocation FileLoc = SM.getFileLoc(Loc);
+  return getCachedResult(LocationResults[SM.getFileID(FileLoc)], Mask,
+                         Category, [&] {
+                           return isBlacklistedFile(
+                               Mask, SM.getFilename(FileLoc), Category);
+                         });
 }
 
@@ -95,6 +95,17 @@ void ContentCache::replaceBuffer(const llvm::MemoryBuffer *B, bool DoNotFree) {
   Buffer.setInt((B && DoNotFree) ? DoNotFreeFlag : 0);
 }
 
+unsigned ContentCache::evictBuffer() {
+  if (!canEvictBuffer())
+    return 0;
+
+  const llvm::MemoryBuffer *B = Buffer.getPointer();
+  unsigned Size = B->getBufferSize();
+  delete B;
+  Buffer.setPointer(nullptr);
+  return Size;
+}
+
 const llvm::MemoryBuffer *ContentCache::getBuffer(DiagnosticsEngine &Diag,
                                                   FileManager &FM,
                                                   SourceLocation Loc,
@@ -364,11 +375,14 @@ SourceManager::~SourceManager() {
 void SourceManager::clearIDTables() {
   MainFileID = FileID();
   LocalSLocEntryTable.clear();
+  LocalSLocEntryOffsets.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
   LastFileIDLookup = FileID();
+  for (FileIDLookupRange &Range : FileIDLookupRanges)
+    Range = FileIDLookupRange();
 
   if (LineTable)
     LineTable->clear();
@@ -473,9 +487,9 @@ const SrcMgr::SLocEntry &SourceManager::loadSLocEntry(unsigned Index,
   return LoadedSLocEntryTable[Index];
 }
 
-std::pair<int, unsigned>
+std::pair<int, SourceLocation::UIntTy>
 SourceManager::AllocateLoadedSLocEntries(unsigned NumSLocEntries,
-                                         unsigned TotalSize) {
+                                         SourceLocation::UIntTy TotalSize) {
   assert(ExternalSLocEntries && "Don't have an external sloc source");
   // Make sure we're not about to run out of source locations.
   if (CurrentLoadedOffset - TotalSize < NextLocalOffset)
@@ -556,7 +570,8 @@ FileID SourceManager::getNextFileID(FileID FID) const {
 FileID SourceManager::createFileID(const ContentCache *File, StringRef Filename,
                                    SourceLocation IncludePos,
                                    SrcMgr::CharacteristicKind FileCharacter,
-                                   int LoadedID, unsigned LoadedOffset) {
+                                   int LoadedID,
+                                   SourceLocation::UIntTy LoadedOffset) {
   if (LoadedID < 0) {
     assert(LoadedID != -1 && "Loading sentinel FileID");
     unsigned Index = unsigned(-LoadedID) - 2;
@@ -570,6 +585,7 @@ FileID SourceManager::createFileID(const ContentCache *File, StringRef Filename,
   LocalSLocEntryTable.push_back(
       SLocEntry::get(NextLocalOffset,
                      FileInfo::get(IncludePos, File, FileCharacter, Filename)));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   unsigned FileSize = File->getSize();
   assert(NextLocalOffset + FileSize + 1 > NextLocalOffset &&
          NextLocalOffset + FileSize + 1 <= CurrentLoadedOffset &&
@@ -600,7 +616,7 @@ SourceManager::createExpansionLoc(SourceLocation SpellingLoc,
                                   unsigned TokLength,
                                   bool ExpansionIsTokenRange,
                                   int LoadedID,
-                                  unsigned LoadedOffset) {
+                                  SourceLocation::UIntTy LoadedOffset) {
   ExpansionInfo Info = ExpansionInfo::create(
       SpellingLoc, ExpansionLocStart, ExpansionLocEnd, ExpansionIsTokenRange);
   return createExpansionLocImpl(Info, TokLength, LoadedID, LoadedOffset);
@@ -620,7 +636,7 @@ SourceLocation
 SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
                                       unsigned TokLength,
                                       int LoadedID,
-                                      unsigned LoadedOffset) {
+                                      SourceLocation::UIntTy LoadedOffset) {
   if (LoadedID < 0) {
     assert(LoadedID != -1 && "Loading sentinel FileID");
     unsigned Index = unsigned(-LoadedID) - 2;
@@ -631,6 +647,7 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
          NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
          "Ran out of source locations!");
@@ -718,10 +735,20 @@ StringRef SourceManager::getBufferData(FileID FID, bool *Invalid) const {
 /// This is the cache-miss path of getFileID. Not as hot as that function, but
 /// still very important. It is responsible for finding the entry in the
 /// SLocEntry tables that contains the specified location.
-FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
+FileID
+SourceManager::getFileIDSlow(SourceLocation::UIntTy SLocOffset) const {
   if (!SLocOffset)
     return FileID::get(0);
 
+  // Check the files that were looked up recently. Their ranges never change
+  // once computed, except for the last local entry which can only grow.
+  for (const FileIDLookupRange &Range : FileIDLookupRanges) {
+    if (SLocOffset - Range.Begin < Range.End - Range.Begin) {
+      ++NumRangeCacheHits;
+      return LastFileIDLookup = Range.FID;
+    }
+  }
+
   // Now it is time to search for the correct file. See where the SLocOffset
   // sits in the global view and consult local or loaded buffers for it.
   if (SLocOffset < NextLocalOffset)
@@ -729,11 +756,29 @@ FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
   return getFileIDLoaded(SLocOffset);
 }
 
+/// Remember the offset range of the file \p FID in the small cache that
+/// getFileIDSlow checks before searching the SLocEntry tables.
+void SourceManager::rememberFileIDLookup(FileID FID) const {
+  LastFileIDLookup = FID;
+
+  FileIDLookupRange &Range = FileIDLookupRanges[NextFileIDLookupRange];
+  NextFileIDLookupRange = (NextFileIDLookupRange + 1) % NumFileIDLookupRanges;
+  Range.Begin = getSLocEntryByID(FID.ID).getOffset();
+  if (FID.ID == -2)
+    Range.End = MaxLoadedOffset;
+  else if (FID.ID + 1 == static_cast<int>(LocalSLocEntryTable.size()))
+    Range.End = NextLocalOffset;
+  else
+    Range.End = getSLocEntryByID(FID.ID + 1).getOffset();
+  Range.FID = FID;
+}
+
 /// Return the FileID for a SourceLocation with a low offset.
 ///
 /// This function knows that the SourceLocation is in a local buffer, not a
 /// loaded one.
-FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
+FileID
+SourceManager::getFileIDLocal(SourceLocation::UIntTy SLocOffset) const {
   assert(SLocOffset < NextLocalOffset && "Bad function choice");
 
   // After the first and second level caches, I see two common sorts of
@@ -769,7 +814,7 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       // If this isn't an expansion, remember it.  We have good locality across
       // FileID lookups.
       if (!I->isExpansion())
-        LastFileIDLookup = Res;
+        rememberFileIDLookup(Res);
       NumLinearScans += NumProbes+1;
       return Res;
     }
@@ -780,51 +825,30 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   // Convert "I" back into an index.  We know that it is an entry whose index is
   // larger than the offset we are looking for.
   unsigned GreaterIndex = I - LocalSLocEntryTable.begin();
-  // LessIndex - This is the lower bound of the range that we're searching.
-  // We know that the offset corresponding to the FileID is is less than
-  // SLocOffset.
-  unsigned LessIndex = 0;
-  NumProbes = 0;
-  while (true) {
-    bool Invalid = false;
-    unsigned MiddleIndex = (GreaterIndex-LessIndex)/2+LessIndex;
-    unsigned MidOffset = getLocalSLocEntry(MiddleIndex, &Invalid).getOffset();
-    if (Invalid)
-      return FileID::get(0);
-
-    ++NumProbes;
-
-    // If the offset of the midpoint is too large, chop the high side of the
-    // range to the midpoint.
-    if (MidOffset > SLocOffset) {
-      GreaterIndex = MiddleIndex;
-      continue;
-    }
 
-    // If the middle index contains the value, succeed and return.
-    // FIXME: This could be made faster by using a function that's aware of
-    // being in the local area.
-    if (isOffsetInFileID(FileID::get(MiddleIndex), SLocOffset)) {
-      FileID Res = FileID::get(MiddleIndex);
-
-      // If this isn't a macro expansion, remember it.  We have good locality
-      // across FileID lookups.
-      if (!LocalSLocEntryTable[MiddleIndex].isExpansion())
-        LastFileIDLookup = Res;
-      NumBinaryProbes += NumProbes;
-      return Res;
-    }
-
-    // Otherwise, move the low-side up to the middle index.
-    LessIndex = MiddleIndex;
-  }
+  // Binary search the dense offsets for the last entry that starts at or
+  // before SLocOffset. The first entry starts at offset 0, so there is one.
+  const SourceLocation::UIntTy *Begin = LocalSLocEntryOffsets.begin();
+  const SourceLocation::UIntTy *Pos =
+      std::upper_bound(Begin, Begin + GreaterIndex, SLocOffset);
+  assert(Pos != Begin && "no entry starts before the offset");
+  unsigned Index = Pos - Begin - 1;
+  NumBinaryProbes += llvm::Log2_32_Ceil(GreaterIndex) + 1;
+
+  FileID Res = FileID::get(Index);
+  // If this isn't a macro expansion, remember it.  We have good locality
+  // across FileID lookups.
+  if (!LocalSLocEntryTable[Index].isExpansion())
+    rememberFileIDLookup(Res);
+  return Res;
 }
 
 /// Return the FileID for a SourceLocation with a high offset.
 ///
 /// This function knows that the SourceLocation is in a loaded buffer, not a
 /// local one.
-FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
+FileID
+SourceManager::getFileIDLoaded(SourceLocation::UIntTy SLocOffset) const {
   // Sanity checking, otherwise a bug may lead to hanging in release build.
   if (SLocOffset < CurrentLoadedOffset) {
     assert(0 && "Invalid SLocOffset or bad function choice");
@@ -850,7 +874,7 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
       FileID Res = FileID::get(-int(I) - 2);
 
       if (!E.isExpansion())
-        LastFileIDLookup = Res;
+        rememberFileIDLookup(Res);
       NumLinearScans += NumProbes + 1;
       return Res;
     }
@@ -884,7 +908,7 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
     if (isOffsetInFileID(FileID::get(-int(MiddleIndex) - 2), SLocOffset)) {
       FileID Res = FileID::get(-int(MiddleIndex) - 2);
       if (!E.isExpansion())
-        LastFileIDLookup = Res;
+        rememberFileIDLookup(Res);
       NumBinaryProbes += NumProbes;
       return Res;
     }
@@ -1363,6 +1387,42 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
   return LineNo;
 }
 
+ArrayRef<unsigned> SourceManager::getLineOffsets(FileID FID) const {
+  bool MyInvalid = false;
+  const SLocEntry &Entry = getSLocEntry(FID, &MyInvalid);
+  if (MyInvalid || !Entry.isFile())
+    return None;
+
+  ContentCache *Content =
+      const_cast<ContentCache *>(Entry.getFile().getContentCache());
+  if (!Content->SourceLineCache) {
+    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid);
+    if (MyInvalid)
+      return None;
+  }
+  return llvm::makeArrayRef(Content->SourceLineCache, Content->NumLines);
+}
+
+void SourceManager::setLineOffsets(FileID FID,
+                                   ArrayRef<unsigned> LineOffsets) {
+  bool MyInvalid = false;
+  const SLocEntry &Entry = getSLocEntry(FID, &MyInvalid);
+  if (MyInvalid || !Entry.isFile() || LineOffsets.empty())
+    return;
+
+  ContentCache *Content =
+      const_cast<ContentCache *>(Entry.getFile().getContentCache());
+  if (Content->SourceLineCache)
+    return;
+
+  assert(LineOffsets.front() == 0 && "the first line starts at offset 0");
+  Content->NumLines = LineOffsets.size();
+  Content->SourceLineCache =
+      ContentCacheAlloc.Allocate<unsigned>(LineOffsets.size());
+  std::copy(LineOffsets.begin(), LineOffsets.end(), Content->SourceLineCache);
+  ++NumLineOffsetsProvided;
+}
+
 unsigned SourceManager::getSpellingLineNumber(SourceLocation Loc,
                                               bool *Invalid) const {
   if (isInvalid(Loc, Invalid)) return 0;
@@ -1542,7 +1602,7 @@ unsigned SourceManager::getFileIDSize(FileID FID) const {
     return 0;
 
   int ID = FID.ID;
-  unsigned NextOffset;
+  SourceLocation::UIntTy NextOffset;
   if ((ID > 0 && unsigned(ID+1) == local_sloc_entry_size()))
     NextOffset = getNextLocalOffset();
   else if (ID+1 == -1)
@@ -1746,8 +1806,8 @@ void SourceManager::associateFileChunkWithMacroArgExp(
                                          SourceLocation ExpansionLoc,
                                          unsigned ExpansionLength) const {
   if (!SpellLoc.isFileID()) {
-    unsigned SpellBeginOffs = SpellLoc.getOffset();
-    unsigned SpellEndOffs = SpellBeginOffs + ExpansionLength;
+    SourceLocation::UIntTy SpellBeginOffs = SpellLoc.getOffset();
+    SourceLocation::UIntTy SpellEndOffs = SpellBeginOffs + ExpansionLength;
 
     // The spelling range for this macro argument expansion can span multiple
     // consecutive FileID entries. Go through each entry contained in the
@@ -1759,9 +1819,9 @@ void SourceManager::associateFileChunkWithMacroArgExp(
     std::tie(SpellFID, SpellRelativeOffs) = getDecomposedLoc(SpellLoc);
     while (true) {
       const SLocEntry &Entry = getSLocEntry(SpellFID);
-      unsigned SpellFIDBeginOffs = Entry.getOffset();
+      SourceLocation::UIntTy SpellFIDBeginOffs = Entry.getOffset();
       unsigned SpellFIDSize = getFileIDSize(SpellFID);
-      unsigned SpellFIDEndOffs = SpellFIDBeginOffs + SpellFIDSize;
+      SourceLocation::UIntTy SpellFIDEndOffs = SpellFIDBeginOffs + SpellFIDSize;
       const ExpansionInfo &Info = Entry.getExpansion();
       if (Info.isMacroArgExpansion()) {
         unsigned CurrSpellLength;
@@ -2058,17 +2118,21 @@ void SourceManager::PrintStats() const {
   unsigned NumMacroArgsComputed = MacroArgsCacheMap.size();
 
   llvm::errs() << NumFileBytesMapped << " bytes of files mapped, "
-               << NumLineNumsComputed << " files with line #'s computed, "
+               << NumLineNumsComputed << " files with line #'s computed ("
+               << NumLineOffsetsProvided << " provided), "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
-               << NumBinaryProbes << " binary.\n";
+               << NumBinaryProbes << " binary, " << NumRangeCacheHits
+               << " cached.\n";
+  if (NumEvictedBuffers)
+    llvm::errs() << NumEvictedBuffers << " file buffers evicted.\n";
 }
 
 LLVM_DUMP_METHOD void SourceManager::dump() const {
   llvm::raw_ostream &out = llvm::errs();
 
   auto DumpSLocEntry = [&](int ID, const SrcMgr::SLocEntry &Entry,
-                           llvm::Optional<unsigned> NextStart) {
+                           llvm::Optional<SourceLocation::UIntTy> NextStart) {
     out << "SLocEntry <FileID " << ID << "> " << (Entry.isFile() ? "file" : "expansion")
         << " <SourceLocation " << Entry.getOffset() << ":";
     if (NextStart)
@@ -2109,7 +2173,7 @@ LLVM_DUMP_METHOD void SourceManager::dump() const {
                                    : LocalSLocEntryTable[ID + 1].getOffset());
   }
   // Dump loaded SLocEntries.
-  llvm::Optional<unsigned> NextStart;
+  llvm::Optional<SourceLocation::UIntTy> NextStart;
   for (unsigned Index = 0; Index != LoadedSLocEntryTable.size(); ++Index) {
     int ID = -(int)Index - 2;
     if (SLocEntryLoaded[Index]) {
@@ -2125,6 +2189,39 @@ ExternalSLocEntrySource::~ExternalSLocEntrySource() = default;
 
 /// Return the amount of memory used by memory buffers, breaking down
 /// by heap-backed versus mmap'ed memory.
+unsigned SourceManager::evictFileBuffers() {
+  if (!FileBufferBudget)
+    return 0;
+
+  size_t Bytes = 0;
+  SmallVector<ContentCache *, 16> Evictable;
+  for (const auto &Info : FileInfos) {
+    ContentCache *CC = Info.second;
+    if (!CC->getRawBuffer())
+      continue;
+    Bytes += CC->getSizeBytesMapped();
+    if (CC->canEvictBuffer())
+      Evictable.push_back(CC);
+  }
+  if (Bytes <= FileBufferBudget)
+    return 0;
+
+  // Free the largest buffers first, so that as many files as possible don't
+  // have to be read again.
+  llvm::sort(Evictable, [](const ContentCache *LHS, const ContentCache *RHS) {
+    return LHS->getSizeBytesMapped() > RHS->getSizeBytesMapped();
+  });
+  unsigned NumEvicted = 0;
+  for (ContentCache *CC : Evictable) {
+    if (Bytes <= FileBufferBudget)
+      break;
+    Bytes -= CC->evictBuffer();
+    ++NumEvicted;
+  }
+  NumEvictedBuffers += NumEvicted;
+  return NumEvicted;
+}
+
 SourceManager::MemoryBufferSizes SourceManager::getMemoryBufferSizes() const {
   size_t malloc_bytes = 0;
   size_t mmap_bytes = 0;
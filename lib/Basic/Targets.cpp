@@ -39,6 +39,8 @@
 #include "clang/Basic/Diagnostic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
 
 using namespace clang;
 
@@ -607,11 +609,27 @@ TargetInfo *AllocateTarget(const llvm::Triple &Triple,
 } // namespace clang
 
 using namespace clang::targets;
+
+static std::atomic<void (*)()> LazyTargetRegistration{nullptr};
+
+void TargetInfo::setLazyTargetRegistration(void (*Register)()) {
+  LazyTargetRegistration = Register;
+}
+
+void TargetInfo::registerLazyTargets() {
+  if (void (*Register)() = LazyTargetRegistration) {
+    static llvm::once_flag Registered;
+    llvm::call_once(Registered, Register);
+  }
+}
+
 /// CreateTargetInfo - Return the target info object for the specified target
 /// options.
 TargetInfo *
 TargetInfo::CreateTargetInfo(DiagnosticsEngine &Diags,
                              const std::shared_ptr<TargetOptions> &Opts) {
+  registerLazyTargets();
+
   llvm::Triple Triple(Opts->Triple);
 
   // Construct the target
@@ -63,6 +63,13 @@ XRayFunctionFilter::shouldImbueLocation(SourceLocation Loc,
                                         StringRef Category) const {
   if (!Loc.isValid())
     return ImbueAttribute::NONE;
-  return this->shouldImbueFunctionsInFile(SM.getFilename(SM.getFileLoc(Loc)),
-                                          Category);
+  SourceLocation FileLoc = SM.getFileLoc(Loc);
+  auto &Results = LocationResults[SM.getFileID(FileLoc)];
+  for (const auto &Result : Results)
+    if (Result.first == Category)
+      return Result.second;
+  ImbueAttribute Attr =
+      this->shouldImbueFunctionsInFile(SM.getFilename(FileLoc), Category);
+  Results.emplace_back(Category, Attr);
+  return Attr;
 }
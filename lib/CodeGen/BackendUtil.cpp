@@ -43,6 +43,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -68,9 +69,12 @@
 #include "llvm/Transforms/Scalar/GVN.h"
 #include "llvm/Transforms/Utils.h"
 #include "llvm/Transforms/Utils/CanonicalizeAliases.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/EntryExitInstrumenter.h"
 #include "llvm/Transforms/Utils/NameAnonGlobals.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
+#include <atomic>
 #include <memory>
 using namespace clang;
 using namespace llvm;
@@ -111,12 +115,38 @@ class EmitAssemblyHelper {
   /// the requested target.
   void CreateTargetMachine(bool MustCreateTM);
 
+  /// Generates a new TargetMachine for the target of the module.
+  ///
+  /// \return null if the target isn't registered, setting \p Error.
+  std::unique_ptr<TargetMachine> newTargetMachine(std::string &Error) const;
+
   /// Add passes necessary to emit assembly or LLVM IR.
   ///
   /// \return True on success.
   bool AddEmitPasses(legacy::PassManager &CodeGenPasses, BackendAction Action,
                      raw_pwrite_stream &OS, raw_pwrite_stream *DwoOS);
 
+  /// Add the passes which generate code with \p CodeGenTM, without
+  /// diagnosing failures, so that it can be used by any thread.
+  ///
+  /// \return True on success.
+  bool addCodeGenPasses(legacy::PassManager &CodeGenPasses,
+                        TargetMachine &CodeGenTM, BackendAction Action,
+                        raw_pwrite_stream &OS, raw_pwrite_stream *DwoOS) const;
+
+  /// Whether the code generation for \p Action is split in partitions which
+  /// are generated concurrently, see -fparallel-codegen=.
+  bool usesParallelCodeGen(BackendAction Action) const {
+    return CodeGenOpts.ParallelCodeGen > 1 && Action == Backend_EmitObj &&
+           !CodeGenOpts.ParallelCodeGenOutput.empty() &&
+           CodeGenOpts.SplitDwarfOutput.empty();
+  }
+
+  /// Split the module in partitions and generate their object files
+  /// concurrently. The first partition is written to \p OS, the others to the
+  /// files named by CodeGenOptions::getParallelCodeGenPartitionName().
+  void RunParallelCodeGen(BackendAction Action, raw_pwrite_stream &OS);
+
   std::unique_ptr<llvm::ToolOutputFile> openOutputFile(StringRef Path) {
     std::error_code EC;
     auto F = std::make_unique<llvm::ToolOutputFile>(Path, EC,
@@ -542,6 +572,22 @@ getInstrProfOptions(const CodeGenOptions &CodeGenOpts,
   return Options;
 }
 
+/// Does the module have functions or calls that the always inliner inlines?
+/// If not, there is nothing for it to do at -O0, where building the call
+/// graph it iterates over is a significant part of the time spent.
+static bool hasAlwaysInlineCalls(const Module &M) {
+  for (const Function &F : M) {
+    if (F.hasFnAttribute(Attribute::AlwaysInline))
+      return true;
+    for (const BasicBlock &BB : F)
+      for (const Instruction &I : BB)
+        if (const auto *Call = dyn_cast<CallBase>(&I))
+          if (Call->getAttributes().hasFnAttribute(Attribute::AlwaysInline))
+            return true;
+  }
+  return false;
+}
+
 void EmitAssemblyHelper::CreatePasses(legacy::PassManager &MPM,
                                       legacy::FunctionPassManager &FPM) {
   // Handle disabling of all LLVM passes, where we want to preserve the
@@ -559,12 +605,15 @@ void EmitAssemblyHelper::CreatePasses(legacy::PassManager &MPM,
 
   PassManagerBuilderWrapper PMBuilder(TargetTriple, CodeGenOpts, LangOpts);
 
-  // At O0 and O1 we only run the always inliner which is more efficient. At
-  // higher optimization levels we run the normal inliner.
+  // At O0 and O1 we only run the always inliner which is more efficient, and
+  // only if there is something to inline at O0. At higher optimization levels
+  // we run the normal inliner.
   if (CodeGenOpts.OptimizationLevel <= 1) {
     bool InsertLifetimeIntrinsics = (CodeGenOpts.OptimizationLevel != 0 &&
                                      !CodeGenOpts.DisableLifetimeMarkers);
-    PMBuilder.Inliner = createAlwaysInlinerLegacyPass(InsertLifetimeIntrinsics);
+    if (CodeGenOpts.OptimizationLevel != 0 || hasAlwaysInlineCalls(*TheModule))
+      PMBuilder.Inliner =
+          createAlwaysInlinerLegacyPass(InsertLifetimeIntrinsics);
   } else {
     // We do not want to inline hot callsites for SamplePGO module-summary build
     // because profile annotation will happen again in ThinLTO backend, and we
@@ -755,13 +804,17 @@ static void setCommandLineOpts(const CodeGenOptions &CodeGenOpts) {
 void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
   // Create the TargetMachine for generating code.
   std::string Error;
+  TM = newTargetMachine(Error);
+  if (!Error.empty() && MustCreateTM)
+    Diags.Report(diag::err_fe_unable_to_create_target) << Error;
+}
+
+std::unique_ptr<TargetMachine>
+EmitAssemblyHelper::newTargetMachine(std::string &Error) const {
   std::string Triple = TheModule->getTargetTriple();
   const llvm::Target *TheTarget = TargetRegistry::lookupTarget(Triple, Error);
-  if (!TheTarget) {
-    if (MustCreateTM)
-      Diags.Report(diag::err_fe_unable_to_create_target) << Error;
-    return;
-  }
+  if (!TheTarget)
+    return nullptr;
 
   Optional<llvm::CodeModel::Model> CM = getCodeModel(CodeGenOpts);
   std::string FeaturesStr =
@@ -771,14 +824,27 @@ void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
 
   llvm::TargetOptions Options;
   initTargetOptions(Options, CodeGenOpts, TargetOpts, LangOpts, HSOpts);
-  TM.reset(TheTarget->createTargetMachine(Triple, TargetOpts.CPU, FeaturesStr,
-                                          Options, RM, CM, OptLevel));
+  return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+      Triple, TargetOpts.CPU, FeaturesStr, Options, RM, CM, OptLevel));
 }
 
 bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
                                        BackendAction Action,
                                        raw_pwrite_stream &OS,
                                        raw_pwrite_stream *DwoOS) {
+  if (!addCodeGenPasses(CodeGenPasses, *TM, Action, OS, DwoOS)) {
+    Diags.Report(diag::err_fe_unable_to_interface_with_target);
+    return false;
+  }
+
+  return true;
+}
+
+bool EmitAssemblyHelper::addCodeGenPasses(legacy::PassManager &CodeGenPasses,
+                                          TargetMachine &CodeGenTM,
+                                          BackendAction Action,
+                                          raw_pwrite_stream &OS,
+                                          raw_pwrite_stream *DwoOS) const {
   // Add LibraryInfo.
   llvm::Triple TargetTriple(TheModule->getTargetTriple());
   std::unique_ptr<TargetLibraryInfoImpl> TLII(
@@ -795,13 +861,77 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   if (CodeGenOpts.OptimizationLevel > 0)
     CodeGenPasses.add(createObjCARCContractPass());
 
-  if (TM->addPassesToEmitFile(CodeGenPasses, OS, DwoOS, CGFT,
-                              /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
-    Diags.Report(diag::err_fe_unable_to_interface_with_target);
-    return false;
+  return !CodeGenTM.addPassesToEmitFile(
+      CodeGenPasses, OS, DwoOS, CGFT,
+      /*DisableVerify=*/!CodeGenOpts.VerifyModule);
+}
+
+void EmitAssemblyHelper::RunParallelCodeGen(BackendAction Action,
+                                            raw_pwrite_stream &OS) {
+  unsigned NumPartitions = CodeGenOpts.ParallelCodeGen;
+  SmallVector<raw_pwrite_stream *, 8> PartitionOSs = {&OS};
+  std::vector<std::unique_ptr<llvm::ToolOutputFile>> PartitionFiles;
+  for (unsigned I = 1; I != NumPartitions; ++I) {
+    PartitionFiles.push_back(
+        openOutputFile(CodeGenOptions::getParallelCodeGenPartitionName(
+            CodeGenOpts.ParallelCodeGenOutput, I)));
+    if (!PartitionFiles.back())
+      return;
+    PartitionOSs.push_back(&PartitionFiles.back()->os());
   }
 
-  return true;
+  // The partitions are generated in their own LLVMContext, as contexts can't
+  // be shared by threads. They are moved there by serializing them, as in
+  // llvm::splitCodeGen, but with the same code generation passes as the
+  // serial mode. SplitModule consumes the module it splits, and the caller
+  // still owns TheModule, so a clone of it is split.
+  std::atomic<bool> Failed(false);
+  {
+    llvm::ThreadPool Pool(NumPartitions);
+    unsigned Partition = 0;
+    SplitModule(
+        CloneModule(*TheModule), NumPartitions,
+        [&](std::unique_ptr<Module> PartitionModule) {
+          SmallString<0> Bitcode;
+          {
+            raw_svector_ostream BitcodeOS(Bitcode);
+            WriteBitcodeToFile(*PartitionModule, BitcodeOS);
+          }
+          raw_pwrite_stream *PartitionOS = PartitionOSs[Partition++];
+          Pool.async(
+              [this, Action, PartitionOS, &Failed](const SmallString<0> &BC) {
+                LLVMContext Context;
+                Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+                    MemoryBufferRef(StringRef(BC.data(), BC.size()),
+                                    "<split-module>"),
+                    Context);
+                if (!MOrErr)
+                  report_fatal_error("Failed to read bitcode");
+                std::unique_ptr<Module> M = std::move(MOrErr.get());
+
+                std::string Error;
+                std::unique_ptr<TargetMachine> PartitionTM =
+                    newTargetMachine(Error);
+                legacy::PassManager CodeGenPasses;
+                if (!PartitionTM ||
+                    !addCodeGenPasses(CodeGenPasses, *PartitionTM, Action,
+                                      *PartitionOS, /*DwoOS=*/nullptr)) {
+                  Failed = true;
+                  return;
+                }
+                CodeGenPasses.run(*M);
+              },
+              std::move(Bitcode));
+        },
+        /*PreserveLocals=*/false);
+  }
+
+  if (Failed) {
+    Diags.Report(diag::err_fe_unable_to_interface_with_target);
+    return;
+  }
+  for (auto &File : PartitionFiles)
+    File->keep();
 }
 
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
@@ -882,7 +1012,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
       if (!DwoOS)
         return;
     }
-    if (!AddEmitPasses(CodeGenPasses, Action, *OS,
+    if (!usesParallelCodeGen(Action) &&
+        !AddEmitPasses(CodeGenPasses, Action, *OS,
                        DwoOS ? &DwoOS->os() : nullptr))
       return;
   }
@@ -913,7 +1044,10 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
   {
     PrettyStackTraceString CrashInfo("Code generation");
     llvm::TimeTraceScope TimeScope("CodeGenPasses", StringRef(""));
-    CodeGenPasses.run(*TheModule);
+    if (usesParallelCodeGen(Action))
+      RunParallelCodeGen(Action, *OS);
+    else
+      CodeGenPasses.run(*TheModule);
   }
 
   if (ThinLinkOS)
@@ -1125,7 +1259,8 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
       // which is just that always inlining occurs. Further, disable generating
       // lifetime intrinsics to avoid enabling further optimizations during
       // code generation.
-      MPM.addPass(AlwaysInlinerPass(/*InsertLifetimeIntrinsics=*/false));
+      if (hasAlwaysInlineCalls(*TheModule))
+        MPM.addPass(AlwaysInlinerPass(/*InsertLifetimeIntrinsics=*/false));
 
       // At -O0, we can still do PGO. Add all the requested passes for
       // instrumentation PGO, if requested.
@@ -1308,7 +1443,8 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
       if (!DwoOS)
         return;
     }
-    if (!AddEmitPasses(CodeGenPasses, Action, *OS,
+    if (!usesParallelCodeGen(Action) &&
+        !AddEmitPasses(CodeGenPasses, Action, *OS,
                        DwoOS ? &DwoOS->os() : nullptr))
       // FIXME: Should we handle this error differently?
       return;
@@ -1327,7 +1463,10 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   // Now if needed, run the legacy PM for codegen.
   if (NeedCodeGen) {
     PrettyStackTraceString CrashInfo("Code generation");
-    CodeGenPasses.run(*TheModule);
+    if (usesParallelCodeGen(Action))
+      RunParallelCodeGen(Action, *OS);
+    else
+      CodeGenPasses.run(*TheModule);
   }
 
   if (ThinLinkOS)
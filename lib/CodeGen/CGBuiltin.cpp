@@ -5103,29 +5103,55 @@ static const NeonIntrinsicInfo AArch64SISDIntrinsicMap[] = {
 #undef NEONMAP1
 #undef NEONMAP2
 
-static bool NEONSIMDIntrinsicsProvenSorted = false;
-
-static bool AArch64SIMDIntrinsicsProvenSorted = false;
-static bool AArch64SISDIntrinsicsProvenSorted = false;
-
-
-static const NeonIntrinsicInfo *
-findNeonIntrinsicInMap(ArrayRef<NeonIntrinsicInfo> IntrinsicMap,
-                       unsigned BuiltinID, bool &MapProvenSorted) {
-
-#ifndef NDEBUG
-  if (!MapProvenSorted) {
+namespace {
+/// The entries of a NEON intrinsic map indexed by builtin ID, so that the
+/// entry of a builtin is found without searching the map.
+class NeonIntrinsicIndex {
+  ArrayRef<NeonIntrinsicInfo> IntrinsicMap;
+
+  /// For each NEON builtin, one plus the position of its entry in the map, or
+  /// zero if it has none.
+  std::vector<uint16_t> Positions;
+
+public:
+  explicit NeonIntrinsicIndex(ArrayRef<NeonIntrinsicInfo> IntrinsicMap)
+      : IntrinsicMap(IntrinsicMap),
+        Positions(NEON::FirstTSBuiltin - clang::Builtin::FirstTSBuiltin) {
     assert(std::is_sorted(std::begin(IntrinsicMap), std::end(IntrinsicMap)));
-    MapProvenSorted = true;
+    assert(IntrinsicMap.size() < UINT16_MAX && "too many intrinsics");
+    // Walk the map backwards so that the first of several entries wins.
+    for (unsigned I = IntrinsicMap.size(); I != 0; --I) {
+      unsigned BuiltinID = IntrinsicMap[I - 1].BuiltinID;
+      assert(BuiltinID >= clang::Builtin::FirstTSBuiltin &&
+             BuiltinID < NEON::FirstTSBuiltin && "not a NEON builtin");
+      Positions[BuiltinID - clang::Builtin::FirstTSBuiltin] = I;
+    }
+  }
+
+  const NeonIntrinsicInfo *lookup(unsigned BuiltinID) const {
+    if (BuiltinID < clang::Builtin::FirstTSBuiltin ||
+        BuiltinID >= NEON::FirstTSBuiltin)
+      return nullptr;
+    unsigned Position = Positions[BuiltinID - clang::Builtin::FirstTSBuiltin];
+    return Position ? &IntrinsicMap[Position - 1] : nullptr;
   }
-#endif
+};
+} // end anonymous namespace
 
-  const NeonIntrinsicInfo *Builtin = llvm::lower_bound(IntrinsicMap, BuiltinID);
+// The indices are built the first time a builtin of their map is emitted.
+static const NeonIntrinsicInfo *findARMSIMDIntrinsic(unsigned BuiltinID) {
+  static const NeonIntrinsicIndex Index(ARMSIMDIntrinsicMap);
+  return Index.lookup(BuiltinID);
+}
 
-  if (Builtin != IntrinsicMap.end() && Builtin->BuiltinID == BuiltinID)
-    return Builtin;
+static const NeonIntrinsicInfo *findAArch64SIMDIntrinsic(unsigned BuiltinID) {
+  static const NeonIntrinsicIndex Index(AArch64SIMDIntrinsicMap);
+  return Index.lookup(BuiltinID);
+}
 
-  return nullptr;
+static const NeonIntrinsicInfo *findAArch64SISDIntrinsic(unsigned BuiltinID) {
+  static const NeonIntrinsicIndex Index(AArch64SISDIntrinsicMap);
+  return Index.lookup(BuiltinID);
 }
 
 Function *CodeGenFunction::LookupNeonLLVMIntrinsic(unsigned IntrinsicID,
@@ -6640,9 +6666,7 @@ Value *CodeGenFunction::EmitARMBuiltinExpr(unsigned BuiltinID,
 
   // Many NEON builtins have identical semantics and uses in ARM and
   // AArch64. Emit these in a single function.
-  auto IntrinsicMap = makeArrayRef(ARMSIMDIntrinsicMap);
-  const NeonIntrinsicInfo *Builtin = findNeonIntrinsicInMap(
-      IntrinsicMap, BuiltinID, NEONSIMDIntrinsicsProvenSorted);
+  const NeonIntrinsicInfo *Builtin = findARMSIMDIntrinsic(BuiltinID);
   if (Builtin)
     return EmitCommonNeonBuiltinExpr(
         Builtin->BuiltinID, Builtin->LLVMIntrinsic, Builtin->AltLLVMIntrinsic,
@@ -7348,9 +7372,7 @@ Value *CodeGenFunction::EmitAArch64BuiltinExpr(unsigned BuiltinID,
     }
   }
 
-  auto SISDMap = makeArrayRef(AArch64SISDIntrinsicMap);
-  const NeonIntrinsicInfo *Builtin = findNeonIntrinsicInMap(
-      SISDMap, BuiltinID, AArch64SISDIntrinsicsProvenSorted);
+  const NeonIntrinsicInfo *Builtin = findAArch64SISDIntrinsic(BuiltinID);
 
   if (Builtin) {
     Ops.push_back(EmitScalarExpr(E->getArg(E->getNumArgs() - 1)));
@@ -8189,8 +8211,7 @@ Value *CodeGenFunction::EmitAArch64BuiltinExpr(unsigned BuiltinID,
 
   // Not all intrinsics handled by the common case work for AArch64 yet, so only
   // defer to common code if it's been added to our special map.
-  Builtin = findNeonIntrinsicInMap(AArch64SIMDIntrinsicMap, BuiltinID,
-                                   AArch64SIMDIntrinsicsProvenSorted);
+  Builtin = findAArch64SIMDIntrinsic(BuiltinID);
 
   if (Builtin)
     return EmitCommonNeonBuiltinExpr(
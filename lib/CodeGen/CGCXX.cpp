@@ -213,6 +213,10 @@ llvm::Function *CodeGenModule::codegenCXXStructor(GlobalDecl GD) {
 
   CodeGenFunction(*this).GenerateCode(GD, Fn, FnInfo);
   setNonAliasAttributes(GD, Fn);
+
+  if (CGDebugInfo *DI = getModuleDebugInfo())
+    if (const auto *CD = dyn_cast<CXXConstructorDecl>(GD.getDecl()))
+      DI->completeConstructedClass(*CD);
   SetLLVMFunctionAttributesForDefinition(cast<CXXMethodDecl>(GD.getDecl()), Fn);
   return Fn;
 }
@@ -216,7 +216,7 @@ void EHScopeStack::popCleanup() {
     // If we no longer have any normal cleanups, all the fixups are
     // complete.
     if (!hasNormalCleanups())
-      BranchFixups.clear();
+      clearFixups();
 
     // Otherwise we can still trim out unnecessary nulls.
     else
@@ -377,21 +377,23 @@ static llvm::SwitchInst *TransitionToCleanupSwitch(CodeGenFunction &CGF,
 
 void CodeGenFunction::ResolveBranchFixups(llvm::BasicBlock *Block) {
   assert(Block && "resolving a null target block");
-  if (!EHStack.getNumBranchFixups()) return;
+  // Most labels aren't the destination of any fixup.
+  unsigned NumUnresolved = EHStack.getNumBranchFixupsTo(Block);
+  if (!NumUnresolved) return;
 
   assert(EHStack.hasNormalCleanups() &&
          "branch fixups exist with no normal cleanups on stack");
 
   llvm::SmallPtrSet<llvm::BasicBlock*, 4> ModifiedOptimisticBlocks;
-  bool ResolvedAny = false;
 
-  for (unsigned I = 0, E = EHStack.getNumBranchFixups(); I != E; ++I) {
+  for (unsigned I = 0, E = EHStack.getNumBranchFixups();
+       NumUnresolved && I != E; ++I) {
     // Skip this fixup if its destination doesn't match.
     BranchFixup &Fixup = EHStack.getBranchFixup(I);
     if (Fixup.Destination != Block) continue;
 
-    Fixup.Destination = nullptr;
-    ResolvedAny = true;
+    EHStack.resolveBranchFixup(Fixup);
+    --NumUnresolved;
 
     // If it doesn't have an optimistic branch block, LatestBranch is
     // already pointing to the right place.
@@ -409,8 +411,7 @@ void CodeGenFunction::ResolveBranchFixups(llvm::BasicBlock *Block) {
     Switch->addCase(Builder.getInt32(Fixup.DestinationIndex), Block);
   }
 
-  if (ResolvedAny)
-    EHStack.popNullFixups();
+  EHStack.popNullFixups();
 }
 
 /// Pops cleanup blocks until the given savepoint is reached.
@@ -1067,8 +1068,7 @@ void CodeGenFunction::EmitBranchThroughCleanup(JumpDest Dest) {
   // If we can't resolve the destination cleanup scope, just add this
   // to the current cleanup scope as a branch fixup.
   if (!Dest.getScopeDepth().isValid()) {
-    BranchFixup &Fixup = EHStack.addBranchFixup();
-    Fixup.Destination = Dest.getBlock();
+    BranchFixup &Fixup = EHStack.addBranchFixup(Dest.getBlock());
     Fixup.DestinationIndex = Dest.getDestIndex();
     Fixup.InitialBranch = BI;
     Fixup.OptimisticBranchBlock = nullptr;
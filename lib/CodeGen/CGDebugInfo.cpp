@@ -65,6 +65,7 @@ static uint32_t getDeclAlignIfRequired(const Decl *D, const ASTContext &Ctx) {
 CGDebugInfo::CGDebugInfo(CodeGenModule &CGM)
     : CGM(CGM), DebugKind(CGM.getCodeGenOpts().getDebugInfo()),
       DebugTypeExtRefs(CGM.getCodeGenOpts().DebugTypeExtRefs),
+      DebugTypeHoming(CGM.getCodeGenOpts().DebugTypeHoming),
       DBuilder(CGM.getModule()) {
   for (const auto &KV : CGM.getCodeGenOpts().DebugPrefixMap)
     DebugPrefixMap[KV.first] = KV.second;
@@ -2159,8 +2160,20 @@ static bool hasExplicitMemberDefinition(CXXRecordDecl::method_iterator I,
   return false;
 }
 
+/// Can the class only be created by calling one of its constructors, so that
+/// its definition can be emitted with them (-fdebug-type-homing)? This
+/// excludes the classes whose objects can be created by aggregate
+/// initialization, by trivial or constexpr constructors, and lambdas.
+static bool isHomedWithConstructors(const CXXRecordDecl *RD) {
+  return RD->hasDefinition() && !RD->isLambda() && !RD->isAggregate() &&
+         !RD->hasTrivialDefaultConstructor() &&
+         !RD->hasConstexprNonCopyMoveConstructor() &&
+         !isClassOrMethodDLLImport(RD);
+}
+
 static bool shouldOmitDefinition(codegenoptions::DebugInfoKind DebugKind,
-                                 bool DebugTypeExtRefs, const RecordDecl *RD,
+                                 bool DebugTypeExtRefs, bool DebugTypeHoming,
+                                 const RecordDecl *RD,
                                  const LangOptions &LangOpts) {
   if (DebugTypeExtRefs && isDefinedInClangModule(RD->getDefinition()))
     return true;
@@ -2193,6 +2206,11 @@ static bool shouldOmitDefinition(codegenoptions::DebugInfoKind DebugKind,
       !isClassOrMethodDLLImport(CXXDecl))
     return true;
 
+  // With type homing, the definition is emitted when one of the constructors
+  // is, see CodeGenModule::codegenCXXStructor().
+  if (DebugTypeHoming && isHomedWithConstructors(CXXDecl))
+    return true;
+
   TemplateSpecializationKind Spec = TSK_Undeclared;
   if (const auto *SD = dyn_cast<ClassTemplateSpecializationDecl>(RD))
     Spec = SD->getSpecializationKind();
@@ -2206,7 +2224,8 @@ static bool shouldOmitDefinition(codegenoptions::DebugInfoKind DebugKind,
 }
 
 void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
-  if (shouldOmitDefinition(DebugKind, DebugTypeExtRefs, RD, CGM.getLangOpts()))
+  if (shouldOmitDefinition(DebugKind, DebugTypeExtRefs, DebugTypeHoming, RD,
+                           CGM.getLangOpts()))
     return;
 
   QualType Ty = CGM.getContext().getRecordType(RD);
@@ -2218,8 +2237,8 @@ void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
 llvm::DIType *CGDebugInfo::CreateType(const RecordType *Ty) {
   RecordDecl *RD = Ty->getDecl();
   llvm::DIType *T = cast_or_null<llvm::DIType>(getTypeOrNull(QualType(Ty, 0)));
-  if (T || shouldOmitDefinition(DebugKind, DebugTypeExtRefs, RD,
-                                CGM.getLangOpts())) {
+  if (T || shouldOmitDefinition(DebugKind, DebugTypeExtRefs, DebugTypeHoming,
+                                RD, CGM.getLangOpts())) {
     if (!T)
       T = getOrCreateRecordFwdDecl(Ty, getDeclContextDescriptor(RD));
     return T;
@@ -2942,6 +2961,14 @@ void CGDebugInfo::completeUnusedClass(const CXXRecordDecl &D) {
   RetainedTypes.push_back(CGM.getContext().getRecordType(&D).getAsOpaquePtr());
 }
 
+void CGDebugInfo::completeConstructedClass(const CXXConstructorDecl &Ctor) {
+  const CXXRecordDecl *RD = Ctor.getParent();
+  if (!DebugTypeHoming || DebugKind != codegenoptions::LimitedDebugInfo ||
+      RD->isDynamicClass() || !isHomedWithConstructors(RD))
+    return;
+  completeUnusedClass(*RD);
+}
+
 llvm::DIType *CGDebugInfo::getOrCreateType(QualType Ty, llvm::DIFile *Unit) {
   if (Ty.isNull())
     return nullptr;
@@ -57,6 +57,7 @@ class CGDebugInfo {
   CodeGenModule &CGM;
   const codegenoptions::DebugInfoKind DebugKind;
   bool DebugTypeExtRefs;
+  bool DebugTypeHoming;
   llvm::DIBuilder DBuilder;
   llvm::DICompileUnit *TheCU = nullptr;
   ModuleMap *ClangModuleMap = nullptr;
@@ -503,6 +504,10 @@ public:
   void completeTemplateDefinition(const ClassTemplateSpecializationDecl &SD);
   void completeUnusedClass(const CXXRecordDecl &D);
 
+  /// Emit the definition of the class of a constructor which is emitted, if
+  /// the class is homed with its constructors (-fdebug-type-homing).
+  void completeConstructedClass(const CXXConstructorDecl &Ctor);
+
   /// Create debug info for a macro defined by a #define directive or a macro
   /// undefined by a #undef directive.
   llvm::DIMacro *CreateMacro(llvm::DIMacroFile *Parent, unsigned MType,
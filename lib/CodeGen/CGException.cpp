@@ -787,23 +787,49 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
   // try/catches.
   // Build the landingpad instruction.
 
-  // Accumulate all the handlers in scope.
+  // Accumulate all the handlers in scope. Only the EH scopes matter, so walk
+  // the chain of the enclosing EH scopes rather than the whole stack.
   bool hasCatchAll = false;
   bool hasCleanup = false;
   bool hasFilter = false;
   SmallVector<llvm::Value*, 4> filterTypes;
   llvm::SmallPtrSet<llvm::Value*, 4> catchTypes;
-  for (EHScopeStack::iterator I = EHStack.begin(), E = EHStack.end(); I != E;
-       ++I) {
+  for (EHScopeStack::stable_iterator SI = EHStack.getInnermostEHScope();
+       SI != EHStack.stable_end();
+       SI = EHStack.find(SI)->getEnclosingEHScope()) {
+    EHScopeStack::iterator I = EHStack.find(SI);
 
     switch (I->getKind()) {
     case EHScope::Cleanup:
       // If we have a cleanup, remember that.
       hasCleanup = (hasCleanup || cast<EHCleanupScope>(*I).isEHCleanup());
+
+      // The handlers of the enclosing EH scopes are those of their landing
+      // pad, if it was already built. Nested cleanups thus share the clauses
+      // of their enclosing landing pad, rather than each walking the stack.
+      if (catchTypes.empty() &&
+          I->getEnclosingEHScope() != EHStack.stable_end()) {
+        EHScope &enclosing = *EHStack.find(I->getEnclosingEHScope());
+        llvm::LandingPadInst *enclosingLPad = nullptr;
+        if (llvm::BasicBlock *block = enclosing.getCachedLandingPad())
+          enclosingLPad =
+              dyn_cast_or_null<llvm::LandingPadInst>(block->getFirstNonPHI());
+        if (enclosingLPad) {
+          unsigned numClauses = enclosingLPad->getNumClauses();
+          for (unsigned i = 0; i != numClauses; ++i)
+            LPadInst->addClause(enclosingLPad->getClause(i));
+          // As below, a catch-all makes the cleanup implicit.
+          if (!numClauses || enclosingLPad->getClause(numClauses - 1) !=
+                                 getCatchAllValue(*this))
+            LPadInst->setCleanup(true);
+          goto copied;
+        }
+      }
       continue;
 
     case EHScope::Filter: {
-      assert(I.next() == EHStack.end() && "EH filter is not end of EH stack");
+      assert(I->getEnclosingEHScope() == EHStack.stable_end() &&
+             "EH filter is not end of EH stack");
       assert(!hasCatchAll && "EH filter reached after catch-all");
 
       // Filter scopes get added to the landingpad in weird ways.
@@ -881,6 +907,7 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
     LPadInst->setCleanup(true);
   }
 
+copied:
   assert((LPadInst->getNumClauses() > 0 || LPadInst->isCleanup()) &&
          "landingpad instruction has no clauses!");
 
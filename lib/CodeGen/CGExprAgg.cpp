@@ -19,6 +19,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/StmtVisitor.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalVariable.h"
@@ -27,6 +28,18 @@
 using namespace clang;
 using namespace CodeGen;
 
+#define DEBUG_TYPE "cgexpragg"
+
+STATISTIC(NumConstantArrayInits,
+          "Number of array initializers copied from a constant global");
+STATISTIC(NumPatchedArrayInits,
+          "Number of mostly constant array initializers copied from a "
+          "constant global and then patched");
+STATISTIC(NumCopiedArrayInitElements,
+          "Number of array elements initialized by copying from a global");
+STATISTIC(NumPatchedArrayInitElements,
+          "Number of array elements initialized after copying from a global");
+
 //===----------------------------------------------------------------------===//
 //                        Aggregate Expression Emitter
 //===----------------------------------------------------------------------===//
@@ -87,6 +100,9 @@ public:
 
   void EmitArrayInit(Address DestPtr, llvm::ArrayType *AType,
                      QualType ArrayQTy, InitListExpr *E);
+  bool EmitPatchedArrayInit(llvm::Value *Begin, CharUnits ElementAlign,
+                            llvm::ArrayType *AType, QualType ArrayQTy,
+                            InitListExpr *E);
 
   AggValueSlot::NeedsGCBarriers_t needsGC(QualType T) {
     if (CGF.getLangOpts().getGC() && TypeRequiresGCollection(T))
@@ -506,8 +522,15 @@ void AggExprEmitter::EmitArrayInit(Address DestPtr, llvm::ArrayType *AType,
       CharUnits Align = CGM.getContext().getTypeAlignInChars(ArrayQTy);
       GV->setAlignment(Align.getAsAlign());
       EmitFinalDestCopy(ArrayQTy, CGF.MakeAddrLValue(GV, ArrayQTy, Align));
+      ++NumConstantArrayInits;
+      NumCopiedArrayInitElements += NumInitElements;
       return;
     }
+
+    // Otherwise, if most of the elements are constant, copy those from a
+    // global too and only emit the others.
+    if (EmitPatchedArrayInit(begin, elementAlign, AType, ArrayQTy, E))
+      return;
   }
 
   // Exception safety requires us to destroy all the
@@ -632,6 +655,98 @@ void AggExprEmitter::EmitArrayInit(Address DestPtr, llvm::ArrayType *AType,
   if (dtorKind) CGF.DeactivateCleanupBlock(cleanup, cleanupDominator);
 }
 
+/// The least size of the explicit initializers of a mostly constant array
+/// initializer that is copied from a global and then patched.
+static const uint64_t MinPatchedArrayInitSize = 64;
+
+/// The least number of constant elements for each element which isn't of a
+/// mostly constant array initializer that is copied from a global.
+static const uint64_t MinConstantsPerPatchedElement = 4;
+
+/// Emit the initialization of a trivially copyable array from an initializer
+/// list most of whose elements are constant, as a copy from a global holding
+/// the constant elements and the stores of the other elements.
+///
+/// \returns false, and emits nothing, if the initializer isn't large enough
+/// or has too many elements which aren't constant.
+bool AggExprEmitter::EmitPatchedArrayInit(llvm::Value *Begin,
+                                          CharUnits ElementAlign,
+                                          llvm::ArrayType *AType,
+                                          QualType ArrayQTy, InitListExpr *E) {
+  uint64_t NumInitElements = E->getNumInits();
+  uint64_t NumArrayElements = AType->getNumElements();
+  QualType ElementType =
+      CGF.getContext().getAsArrayType(ArrayQTy)->getElementType();
+  CharUnits ElementSize = CGF.getContext().getTypeSizeInChars(ElementType);
+  if (NumInitElements * ElementSize.getQuantity() < MinPatchedArrayInitSize)
+    return false;
+
+  // The elements without an initializer are zeroed by the global.
+  if (NumInitElements != NumArrayElements &&
+      (!isTrivialFiller(E->getArrayFiller()) ||
+       !CGF.getTypes().isZeroInitializable(ElementType)))
+    return false;
+
+  ConstantEmitter Emitter(CGF);
+  llvm::Type *ElementTy = AType->getElementType();
+  llvm::Constant *Null = nullptr;
+  SmallVector<llvm::Constant *, 16> Elements;
+  SmallVector<unsigned, 4> Dynamic;
+  Elements.reserve(NumInitElements);
+  for (unsigned I = 0; I != NumInitElements; ++I) {
+    // The elements of the updater of a designated initializer which aren't
+    // updated must be left alone.
+    if (isa<NoInitExpr>(E->getInit(I)))
+      return false;
+    llvm::Constant *C =
+        Emitter.tryEmitAbstractForMemory(E->getInit(I), ElementType);
+    if (!C || C->getType() != ElementTy) {
+      if ((Dynamic.size() + 1) * MinConstantsPerPatchedElement >
+          NumInitElements)
+        return false;
+      if (!Null)
+        Null = Emitter.emitNullForMemory(ElementType);
+      if (Null->getType() != ElementTy)
+        return false;
+      C = Null;
+      Dynamic.push_back(I);
+    }
+    Elements.push_back(C);
+  }
+
+  CodeGenModule &CGM = CGF.CGM;
+  llvm::Constant *Init = llvm::ConstantArray::get(
+      llvm::ArrayType::get(ElementTy, NumInitElements), Elements);
+  if (NumInitElements != NumArrayElements)
+    Init = llvm::ConstantStruct::getAnon(
+        {Init, llvm::ConstantAggregateZero::get(llvm::ArrayType::get(
+                   ElementTy, NumArrayElements - NumInitElements))});
+  LangAS AS = ArrayQTy.getAddressSpace();
+  auto GV = new llvm::GlobalVariable(
+      CGM.getModule(), Init->getType(),
+      CGM.isTypeConstant(ArrayQTy, /* ExcludeCtorDtor= */ true),
+      llvm::GlobalValue::PrivateLinkage, Init, "constinit",
+      /* InsertBefore= */ nullptr, llvm::GlobalVariable::NotThreadLocal,
+      CGM.getContext().getTargetAddressSpace(AS));
+  CharUnits Align = CGM.getContext().getTypeAlignInChars(ArrayQTy);
+  GV->setAlignment(Align.getAsAlign());
+  EmitFinalDestCopy(ArrayQTy, CGF.MakeAddrLValue(GV, ArrayQTy, Align));
+
+  // Then store the elements which aren't constant, in order.
+  for (unsigned I : Dynamic) {
+    llvm::Value *Element = Builder.CreateInBoundsGEP(
+        Begin, llvm::ConstantInt::get(CGF.SizeTy, I), "arrayinit.element");
+    LValue ElementLV =
+        CGF.MakeAddrLValue(Address(Element, ElementAlign), ElementType);
+    EmitInitializationToLValue(E->getInit(I), ElementLV);
+  }
+
+  ++NumPatchedArrayInits;
+  NumCopiedArrayInitElements += NumInitElements - Dynamic.size();
+  NumPatchedArrayInitElements += Dynamic.size();
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 //                            Visitor Methods
 //===----------------------------------------------------------------------===//
@@ -2008,6 +2008,118 @@ ConstantLValueEmitter::VisitMaterializeTemporaryExpr(
   return CGM.GetAddrOfGlobalTemporary(E, Inner);
 }
 
+template <typename T>
+static llvm::Constant *getDataArrayConstant(llvm::Type *EltTy,
+                                            ArrayRef<uint64_t> Data) {
+  SmallVector<T, 64> Elts(Data.begin(), Data.end());
+  if (EltTy->isIntegerTy())
+    return llvm::ConstantDataArray::get(EltTy->getContext(), Elts);
+  return llvm::ConstantDataArray::getFP(EltTy->getContext(), Elts);
+}
+
+/// Try to emit the array \p Value of integer or floating-point elements from
+/// the raw bits of its elements, without creating a constant for each element
+/// first. Large lookup tables are common, and this is much faster than
+/// emitting each element and letting ConstantArray::get fold them together.
+/// The result is the same as the one EmitArrayConstant would produce.
+static llvm::Constant *tryEmitDataArrayConstant(CodeGenModule &CGM,
+                                                const APValue &Value,
+                                                QualType EltTy,
+                                                llvm::ArrayType *DesiredType) {
+  llvm::Type *EltLLVMTy = DesiredType->getElementType();
+  unsigned EltBits = EltLLVMTy->getPrimitiveSizeInBits();
+  if (EltLLVMTy->isIntegerTy()) {
+    if (!EltTy->isIntegralOrEnumerationType() ||
+        (EltBits != 8 && EltBits != 16 && EltBits != 32 && EltBits != 64))
+      return nullptr;
+  } else if (EltLLVMTy->isFloatTy() || EltLLVMTy->isDoubleTy()) {
+    if (!EltTy->isRealFloatingType())
+      return nullptr;
+  } else {
+    return nullptr;
+  }
+
+  auto GetBits = [&](const APValue &Elt, uint64_t &Bits) {
+    llvm::APInt Int;
+    if (Elt.isInt())
+      Int = Elt.getInt();
+    else if (Elt.isFloat())
+      Int = Elt.getFloat().bitcastToAPInt();
+    else
+      return false;
+    if (Int.getBitWidth() > EltBits)
+      return false;
+    Bits = Int.getZExtValue();
+    return true;
+  };
+
+  unsigned NumElements = Value.getArraySize();
+  unsigned NumInitElts = Value.getArrayInitializedElts();
+  uint64_t FillerBits = 0;
+  if (Value.hasArrayFiller() && !GetBits(Value.getArrayFiller(), FillerBits))
+    return nullptr;
+
+  SmallVector<uint64_t, 64> Data(NumInitElts);
+  if (Value.isPackedArray()) {
+    // Read the packed elements as they are, rather than unpacking them.
+    if (Value.getPackedArrayBitWidth() > EltBits)
+      return nullptr;
+    for (unsigned I = 0; I != NumInitElts; ++I)
+      Data[I] = Value.getPackedArrayBits(I);
+  } else {
+    for (unsigned I = 0; I != NumInitElts; ++I)
+      if (!GetBits(Value.getArrayInitializedElt(I), Data[I]))
+        return nullptr;
+  }
+
+  // Figure out how long the initial prefix of non-zero elements is.
+  unsigned NonzeroLength = NumElements;
+  if (NumInitElts < NonzeroLength && FillerBits == 0)
+    NonzeroLength = NumInitElts;
+  if (NonzeroLength == NumInitElts) {
+    while (NonzeroLength > 0 && Data[NonzeroLength - 1] == 0)
+      --NonzeroLength;
+  }
+
+  if (NonzeroLength == 0)
+    return llvm::ConstantAggregateZero::get(DesiredType);
+
+  auto GetArray = [&](unsigned Length) -> llvm::Constant * {
+    ArrayRef<uint64_t> Elts = makeArrayRef(Data).take_front(Length);
+    switch (EltBits) {
+    case 8:
+      return getDataArrayConstant<uint8_t>(EltLLVMTy, Elts);
+    case 16:
+      return getDataArrayConstant<uint16_t>(EltLLVMTy, Elts);
+    case 32:
+      return getDataArrayConstant<uint32_t>(EltLLVMTy, Elts);
+    default:
+      return getDataArrayConstant<uint64_t>(EltLLVMTy, Elts);
+    }
+  };
+
+  // Use a zeroinitializer array filler if we have lots of trailing zeroes.
+  // EmitArrayConstant emits a struct of the individual elements followed by
+  // the filler when there are only a few of them; leave that case to it.
+  unsigned TrailingZeroes = NumElements - NonzeroLength;
+  if (TrailingZeroes >= 8) {
+    if (NonzeroLength < 8)
+      return nullptr;
+    llvm::Constant *Elts[] = {
+        GetArray(NonzeroLength),
+        llvm::ConstantAggregateZero::get(
+            llvm::ArrayType::get(EltLLVMTy, TrailingZeroes))};
+    llvm::StructType *SType = llvm::StructType::get(
+        CGM.getLLVMContext(), {Elts[0]->getType(), Elts[1]->getType()},
+        /*isPacked=*/true);
+    return llvm::ConstantStruct::get(SType, Elts);
+  }
+
+  // Otherwise pad to the right size with the filler if necessary.
+  Data.resize(NumElements, FillerBits);
+  return GetArray(NumElements);
+}
+
 llvm::Constant *ConstantEmitter::tryEmitPrivate(const APValue &Value,
                                                 QualType DestType) {
   switch (Value.getKind()) {
@@ -2100,6 +2212,15 @@ llvm::Constant *ConstantEmitter::tryEmitPrivate(const APValue &Value,
     unsigned NumElements = Value.getArraySize();
     unsigned NumInitElts = Value.getArrayInitializedElts();
 
+    // Emit arrays of integers and floating-point values from their raw data.
+    if (CAT && NumInitElts) {
+      auto *Desired =
+          cast<llvm::ArrayType>(CGM.getTypes().ConvertType(DestType));
+      if (llvm::Constant *C = tryEmitDataArrayConstant(
+              CGM, Value, CAT->getElementType(), Desired))
+        return C;
+    }
+
     // Emit array filler, if there is one.
     llvm::Constant *Filler = nullptr;
     if (Value.hasArrayFiller()) {
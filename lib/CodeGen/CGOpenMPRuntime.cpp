@@ -19,6 +19,8 @@
 #include "clang/AST/Decl.h"
 #include "clang/AST/StmtOpenMP.h"
 #include "clang/Basic/BitmaskEnum.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -1672,7 +1674,10 @@ llvm::Value *CGOpenMPRuntime::emitUpdateLocation(CodeGenFunction &CGF,
     if (const auto *FD = dyn_cast_or_null<FunctionDecl>(CGF.CurFuncDecl))
       OS2 << FD->getQualifiedNameAsString();
     OS2 << ";" << PLoc.getLine() << ";" << PLoc.getColumn() << ";;";
-    OMPDebugLoc = CGF.Builder.CreateGlobalStringPtr(OS2.str());
+    llvm::Value *&DebugLocString = OpenMPDebugLocStrings[OS2.str()];
+    if (!DebugLocString)
+      DebugLocString = CGF.Builder.CreateGlobalStringPtr(OS2.str());
+    OMPDebugLoc = DebugLocString;
     OpenMPDebugLocMap[Loc.getRawEncoding()] = OMPDebugLoc;
   }
   // *psource = ";<File>;<Function>;<Line>;<Column>;;";
@@ -1773,6 +1778,13 @@ llvm::Type *CGOpenMPRuntime::getKmpc_MicroPointerTy() {
 }
 
 llvm::FunctionCallee CGOpenMPRuntime::createRuntimeFunction(unsigned Function) {
+  llvm::FunctionCallee &RTLFn = RuntimeFunctions[Function];
+  if (!RTLFn)
+    RTLFn = buildRuntimeFunction(Function);
+  return RTLFn;
+}
+
+llvm::FunctionCallee CGOpenMPRuntime::buildRuntimeFunction(unsigned Function) {
   llvm::FunctionCallee RTLFn = nullptr;
   switch (static_cast<OpenMPRTLFunction>(Function)) {
   case OMPRTL__kmpc_fork_call: {
@@ -4229,7 +4241,10 @@ void CGOpenMPRuntime::loadOffloadInfoMetadata() {
   if (CGM.getLangOpts().OMPHostIRFile.empty())
     return;
 
-  auto Buf = llvm::MemoryBuffer::getFile(CGM.getLangOpts().OMPHostIRFile);
+  // The host IR is read through the file manager, so that the compile cache
+  // knows that the compilation depends on it.
+  FileManager &FileMgr = CGM.getContext().getSourceManager().getFileManager();
+  auto Buf = FileMgr.getBufferForFile(CGM.getLangOpts().OMPHostIRFile);
   if (auto EC = Buf.getError()) {
     CGM.getDiags().Report(diag::err_cannot_open_file)
         << CGM.getLangOpts().OMPHostIRFile << EC.message();
@@ -331,6 +331,12 @@ private:
   /// Map for SourceLocation and OpenMP runtime library debug locations.
   typedef llvm::DenseMap<unsigned, llvm::Value *> OpenMPDebugLocMapTy;
   OpenMPDebugLocMapTy OpenMPDebugLocMap;
+  /// Map of the strings of the debug locations and their globals, which are
+  /// shared by the locations with the same presumed location, e.g. the
+  /// directives expanded from one macro.
+  llvm::StringMap<llvm::Value *> OpenMPDebugLocStrings;
+  /// Map of the OpenMP runtime functions which were already created.
+  llvm::DenseMap<unsigned, llvm::FunctionCallee> RuntimeFunctions;
   /// The type for a microtask which gets passed to __kmpc_fork_call().
   /// Original representation is:
   /// typedef void (kmpc_micro)(kmp_int32 global_tid, kmp_int32 bound_tid,...);
@@ -702,6 +708,9 @@ private:
   /// \return Specified function.
   llvm::FunctionCallee createRuntimeFunction(unsigned Function);
 
+  /// Builds the declaration of the OpenMP runtime function \a Function.
+  llvm::FunctionCallee buildRuntimeFunction(unsigned Function);
+
   /// Returns __kmpc_for_static_init_* runtime function for the specified
   /// size \a IVSize and sign \a IVSigned.
   llvm::FunctionCallee createForStaticInitFunction(unsigned IVSize,
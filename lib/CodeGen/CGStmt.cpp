@@ -1643,18 +1643,21 @@ void CodeGenFunction::EmitSwitchStmt(const SwitchStmt &S) {
   // explicit case ranges tests can have a place to jump to on
   // failure.
   llvm::BasicBlock *DefaultBlock = createBasicBlock("sw.default");
-  SwitchInsn = Builder.CreateSwitch(CondV, DefaultBlock);
+
+  // Walk the SwitchCase list to find how many there are, so that the operands
+  // of huge switches aren't reallocated as the cases are added.
+  uint64_t DefaultCount = 0;
+  unsigned NumCases = 0;
+  for (const SwitchCase *Case = S.getSwitchCaseList();
+       Case;
+       Case = Case->getNextSwitchCase()) {
+    if (isa<DefaultStmt>(Case) && PGO.haveRegionCounts())
+      DefaultCount = getProfileCount(Case);
+    NumCases += 1;
+  }
+
+  SwitchInsn = Builder.CreateSwitch(CondV, DefaultBlock, NumCases);
   if (PGO.haveRegionCounts()) {
-    // Walk the SwitchCase list to find how many there are.
-    uint64_t DefaultCount = 0;
-    unsigned NumCases = 0;
-    for (const SwitchCase *Case = S.getSwitchCaseList();
-         Case;
-         Case = Case->getNextSwitchCase()) {
-      if (isa<DefaultStmt>(Case))
-        DefaultCount = getProfileCount(Case);
-      NumCases += 1;
-    }
     SwitchWeights = new SmallVector<uint64_t, 16>();
     SwitchWeights->reserve(NumCases);
     // The default needs to be first. We store the edge count, so we already
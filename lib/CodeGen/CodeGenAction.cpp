@@ -103,6 +103,10 @@ namespace clang {
     /// can happen when Clang plugins trigger additional AST deserialization.
     bool IRGenFinished = false;
 
+    /// True if the AST was freed before running the backend. Diagnostics from
+    /// the backend can't refer to declarations anymore.
+    bool ASTCleared = false;
+
     std::unique_ptr<CodeGenerator> Gen;
 
     SmallVector<LinkModule, 4> LinkModules;
@@ -304,6 +308,15 @@ namespace clang {
 
       EmbedBitcode(getModule(), CodeGenOpts, llvm::MemoryBufferRef());
 
+      // Nothing reads the AST past this point, so its memory can be reused by
+      // the backend. The rest of the context, e.g. the source manager needed
+      // for diagnostics, stays alive.
+      if (CodeGenOpts.ClearASTBeforeBackend) {
+        C.cleanup();
+        C.getAllocator().Reset();
+        ASTCleared = true;
+      }
+
       EmitBackendOutput(Diags, HeaderSearchOpts, CodeGenOpts, TargetOpts,
                         LangOpts, C.getTargetInfo().getDataLayout(),
                         getModule(), Action, std::move(AsmOutStream));
@@ -547,6 +560,9 @@ BackendConsumer::StackSizeDiagHandler(const llvm::DiagnosticInfoStackSize &D) {
     // We do not know how to format other severities.
     return false;
 
+  if (ASTCleared)
+    return false;
+
   if (const Decl *ND = Gen->GetDeclForMangledName(D.getFunction().getName())) {
     // FIXME: Shouldn't need to truncate to uint32_t
     Diags.Report(ND->getASTContext().getFullLoc(ND->getLocation()),
@@ -584,7 +600,7 @@ const FullSourceLoc BackendConsumer::getBestLocationFromDebugLoc(
   // function definition. We use the definition's right brace to differentiate
   // from diagnostics that genuinely relate to the function itself.
   FullSourceLoc Loc(DILoc, SourceMgr);
-  if (Loc.isInvalid())
+  if (Loc.isInvalid() && !ASTCleared)
     if (const Decl *FD = Gen->GetDeclForMangledName(D.getFunction().getName()))
       Loc = FD->getASTContext().getFullLoc(FD->getLocation());
 
@@ -875,7 +891,10 @@ GetOutputStream(CompilerInstance &CI, StringRef InFile, BackendAction Action) {
   case Backend_EmitLL:
     return CI.createDefaultOutputFile(false, InFile, "ll");
   case Backend_EmitBC:
-    return CI.createDefaultOutputFile(true, InFile, "bc");
+    // The bitcode writers assemble the bitcode in memory and write it out in
+    // one go, so don't buffer it a second time when writing to a pipe.
+    return CI.createDefaultOutputFile(true, InFile, "bc",
+                                      /*NeedsSeeking=*/false);
   case Backend_EmitNothing:
     return nullptr;
   case Backend_EmitMCNull:
@@ -58,6 +58,7 @@
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TimeProfiler.h"
 
 using namespace clang;
@@ -167,6 +168,24 @@ CodeGenModule::CodeGenModule(ASTContext &C, const HeaderSearchOptions &HSO,
       PGOReader = std::move(ReaderOrErr.get());
   }
 
+  if (!CodeGenOpts.HomedFunctionsFile.empty()) {
+    auto BufferOrErr =
+        llvm::MemoryBuffer::getFile(CodeGenOpts.HomedFunctionsFile);
+    if (std::error_code EC = BufferOrErr.getError()) {
+      getDiags().Report(diag::err_cannot_open_file)
+          << CodeGenOpts.HomedFunctionsFile << EC.message();
+    } else {
+      // One mangled name per line; blank lines and '#' comments are ignored.
+      SmallVector<StringRef, 0> Lines;
+      (*BufferOrErr)->getBuffer().split(Lines, '\n');
+      for (StringRef Line : Lines) {
+        Line = Line.trim();
+        if (!Line.empty() && !Line.startswith("#"))
+          HomedFunctions.insert(Line);
+      }
+    }
+  }
+
   // If coverage mapping generation is enabled, create the
   // CoverageMappingModuleGen object.
   if (CodeGenOpts.CoverageMapping)
@@ -1188,6 +1207,12 @@ CodeGenModule::getFunctionLinkage(GlobalDecl GD) {
 
   GVALinkage Linkage = getContext().GetGVALinkageForFunction(D);
 
+  // A discardable function provided by its home object file only needs to be
+  // available for inlining here, and must be kept by the home object file.
+  if (Linkage == GVA_DiscardableODR && isHomedFunction(GD))
+    Linkage = CodeGenOpts.HomedFunctionsHome ? GVA_StrongODR
+                                             : GVA_AvailableExternally;
+
   if (const auto *Dtor = dyn_cast<CXXDestructorDecl>(D))
     return getCXXABI().getCXXDestructorLinkage(Linkage, Dtor, GD.getDtorType());
 
@@ -2088,6 +2113,12 @@ void CodeGenModule::EmitDeferred() {
   if (DeferredDeclsToEmit.empty())
     return;
 
+  // The bodies are emitted one at a time: emitting one mangles names, creates
+  // types and constants in the LLVMContext, completes declarations of the
+  // ASTContext and schedules more decls, none of which is thread-safe. Split
+  // the module after IR emission instead, with -fparallel-codegen=, to
+  // generate code concurrently.
+
   // Grab the list of decls to emit. If EmitGlobalDefinition schedules more
   // work, it will not interfere with this.
   std::vector<GlobalDecl> CurDeclsToEmit;
@@ -2550,6 +2581,11 @@ void CodeGenModule::EmitGlobal(GlobalDecl GD) {
     // The value must be emitted, but cannot be emitted eagerly.
     assert(!MayBeEmittedEagerly(Global));
     addDeferredDeclToEmit(GD);
+  } else if (CodeGenOpts.HomedFunctionsHome && isa<FunctionDecl>(Global) &&
+             isHomedFunction(GD)) {
+    // The home object file provides the function to the other object files,
+    // even if it doesn't use it itself.
+    addDeferredDeclToEmit(GD);
   } else {
     // Otherwise, remember that we saw a deferred decl with this name.  The
     // first use of the mangled name will cause it to move into
@@ -2722,6 +2758,10 @@ bool CodeGenModule::shouldEmitFunction(GlobalDecl GD) {
   return !isTriviallyRecursive(F);
 }
 
+bool CodeGenModule::isHomedFunction(GlobalDecl GD) {
+  return !HomedFunctions.empty() && HomedFunctions.count(getMangledName(GD));
+}
+
 bool CodeGenModule::shouldOpportunisticallyEmitVTables() {
   return CodeGenOpts.OptimizationLevel > 0;
 }
@@ -3839,7 +3879,8 @@ static bool shouldBeInCOMDAT(CodeGenModule &CGM, const Decl &D) {
 
 void CodeGenModule::maybeSetTrivialComdat(const Decl &D,
                                           llvm::GlobalObject &GO) {
-  if (!shouldBeInCOMDAT(*this, D))
+  // Functions provided by a home object file are not emitted in a COMDAT.
+  if (GO.hasAvailableExternallyLinkage() || !shouldBeInCOMDAT(*this, D))
     return;
   GO.setComdat(TheModule.getOrInsertComdat(GO.getName()));
 }
@@ -5500,6 +5541,15 @@ void CodeGenModule::ClearUnusedCoverageMapping(const Decl *D) {
     I->second = false;
 }
 
+bool CodeGenModule::isCoverageMappedByHome(GlobalDecl GD) {
+  // The copies of the function in the other object files are only there to
+  // be inlined, and share the counters and the mapping of the home one.
+  return CodeGenOpts.CoverageMapping && !CodeGenOpts.HomedFunctionsHome &&
+         getContext().GetGVALinkageForFunction(
+             cast<FunctionDecl>(GD.getDecl())) == GVA_DiscardableODR &&
+         isHomedFunction(GD);
+}
+
 void CodeGenModule::EmitDeferredUnusedCoverageMappings() {
   // We call takeVector() here to avoid use-after-free.
   // FIXME: DeferredEmptyCoverageMappingDecls is getting mutated because
@@ -5516,6 +5566,8 @@ void CodeGenModule::EmitDeferredUnusedCoverageMappings() {
     case Decl::ObjCMethod: {
       CodeGenPGO PGO(*this);
       GlobalDecl GD(cast<FunctionDecl>(D));
+      if (isCoverageMappedByHome(GD))
+        break;
       PGO.emitEmptyCounterMapping(D, getMangledName(GD),
                                   getFunctionLinkage(GD));
       break;
@@ -5523,6 +5575,8 @@ void CodeGenModule::EmitDeferredUnusedCoverageMappings() {
     case Decl::CXXConstructor: {
       CodeGenPGO PGO(*this);
       GlobalDecl GD(cast<CXXConstructorDecl>(D), Ctor_Base);
+      if (isCoverageMappedByHome(GD))
+        break;
       PGO.emitEmptyCounterMapping(D, getMangledName(GD),
                                   getFunctionLinkage(GD));
       break;
@@ -5530,6 +5584,8 @@ void CodeGenModule::EmitDeferredUnusedCoverageMappings() {
     case Decl::CXXDestructor: {
       CodeGenPGO PGO(*this);
       GlobalDecl GD(cast<CXXDestructorDecl>(D), Dtor_Base);
+      if (isCoverageMappedByHome(GD))
+        break;
       PGO.emitEmptyCounterMapping(D, getMangledName(GD),
                                   getFunctionLinkage(GD));
       break;
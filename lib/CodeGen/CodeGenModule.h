@@ -32,6 +32,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/Transforms/Utils/SanitizerStats.h"
@@ -338,6 +339,10 @@ private:
   /// yet.
   std::map<StringRef, GlobalDecl> DeferredDecls;
 
+  /// The mangled names of the discardable functions which are provided by a
+  /// home object file, see -fhomed-functions-file.
+  llvm::StringSet<> HomedFunctions;
+
   /// This is a list of deferred decls which we have seen that *are* actually
   /// referenced. These get code generated when the module is done.
   std::vector<GlobalDecl> DeferredDeclsToEmit;
@@ -498,6 +503,9 @@ private:
 
   bool isTriviallyRecursive(const FunctionDecl *F);
   bool shouldEmitFunction(GlobalDecl GD);
+  /// Determine whether \p GD is one of the functions provided by a home
+  /// object file, see -fhomed-functions-file.
+  bool isHomedFunction(GlobalDecl GD);
   bool shouldOpportunisticallyEmitVTables();
   /// Map used to be sure we don't emit the same CompoundLiteral twice.
   llvm::DenseMap<const CompoundLiteralExpr *, llvm::GlobalVariable *>
@@ -1001,6 +1009,10 @@ public:
   /// declaration is actually instrumented.
   void ClearUnusedCoverageMapping(const Decl *D);
 
+  /// Determine whether the coverage mapping of \p GD is left to the home
+  /// object file which provides it, see -fhomed-functions-file.
+  bool isCoverageMappedByHome(GlobalDecl GD);
+
   /// Emit all the deferred coverage mappings
   /// for the uninstrumented functions.
   void EmitDeferredUnusedCoverageMappings();
@@ -783,7 +783,7 @@ void CodeGenPGO::assignRegionCounters(GlobalDecl GD, llvm::Function *Fn) {
   setFuncName(Fn);
 
   mapRegionCounters(D);
-  if (CGM.getCodeGenOpts().CoverageMapping)
+  if (CGM.getCodeGenOpts().CoverageMapping && !CGM.isCoverageMappedByHome(GD))
     emitCounterRegionMapping(D);
   if (PGOReader) {
     SourceManager &SM = CGM.getContext().getSourceManager();
@@ -887,6 +887,17 @@ CodeGenPGO::applyFunctionAttributes(llvm::IndexedInstrProfReader *PGOReader,
 
   uint64_t FunctionCount = getRegionCount(nullptr);
   Fn->setEntryCount(FunctionCount);
+
+  // A function which was never executed while profiling isn't worth the time
+  // of optimizing it. optnone can't be combined with always_inline.
+  if (FunctionCount == 0 && CGM.getCodeGenOpts().ProfileColdOptNone &&
+      !Fn->hasFnAttribute(llvm::Attribute::AlwaysInline)) {
+    Fn->addFnAttr(llvm::Attribute::OptimizeNone);
+    Fn->addFnAttr(llvm::Attribute::NoInline);
+    Fn->removeFnAttr(llvm::Attribute::InlineHint);
+    Fn->removeFnAttr(llvm::Attribute::OptimizeForSize);
+    Fn->removeFnAttr(llvm::Attribute::MinSize);
+  }
 }
 
 void CodeGenPGO::emitCounterIncrement(CGBuilderTy &Builder, const Stmt *S,
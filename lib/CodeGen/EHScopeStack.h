@@ -16,6 +16,7 @@
 #define LLVM_CLANG_LIB_CODEGEN_EHSCOPESTACK_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/BasicBlock.h"
@@ -257,6 +258,10 @@ private:
   ///     bar();
   SmallVector<BranchFixup, 8> BranchFixups;
 
+  /// The number of the unresolved branch fixups to each destination, so that
+  /// emitting a label which no fixup branches to doesn't scan the fixups.
+  llvm::DenseMap<llvm::BasicBlock *, unsigned> NumFixupsToDestination;
+
   char *allocate(size_t Size);
   void deallocate(size_t Size);
 
@@ -391,10 +396,12 @@ public:
   /// to the EH stack.
   iterator find(stable_iterator save) const;
 
-  /// Add a branch fixup to the current cleanup scope.
-  BranchFixup &addBranchFixup() {
+  /// Add a branch fixup to \p Destination to the current cleanup scope.
+  BranchFixup &addBranchFixup(llvm::BasicBlock *Destination) {
     assert(hasNormalCleanups() && "adding fixup in scope without cleanups");
     BranchFixups.push_back(BranchFixup());
+    BranchFixups.back().Destination = Destination;
+    ++NumFixupsToDestination[Destination];
     return BranchFixups.back();
   }
 
@@ -404,6 +411,20 @@ public:
     return BranchFixups[I];
   }
 
+  /// \returns the number of the unresolved branch fixups to \p Destination.
+  unsigned getNumBranchFixupsTo(llvm::BasicBlock *Destination) const {
+    return NumFixupsToDestination.lookup(Destination);
+  }
+
+  /// Mark \p Fixup as resolved, by nulling its destination.
+  void resolveBranchFixup(BranchFixup &Fixup) {
+    assert(Fixup.Destination && "resolving a fixup twice");
+    auto It = NumFixupsToDestination.find(Fixup.Destination);
+    if (--It->second == 0)
+      NumFixupsToDestination.erase(It);
+    Fixup.Destination = nullptr;
+  }
+
   /// Pops lazily-removed fixups from the end of the list.  This
   /// should only be called by procedures which have just popped a
   /// cleanup or resolved one or more fixups.
@@ -411,7 +432,10 @@ public:
 
   /// Clears the branch-fixups list.  This should only be called by
   /// ResolveAllBranchFixups.
-  void clearFixups() { BranchFixups.clear(); }
+  void clearFixups() {
+    BranchFixups.clear();
+    NumFixupsToDestination.clear();
+  }
 };
 
 } // namespace CodeGen
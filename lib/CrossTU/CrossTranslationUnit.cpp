@@ -12,17 +12,27 @@
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/AST/ASTImporter.h"
 #include "clang/AST/Decl.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/CrossTU/CrossTUDiagnostic.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Index/USRGeneration.h"
+#include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <fstream>
 #include <sstream>
@@ -49,6 +59,9 @@ STATISTIC(NumLangMismatch, "The # of language mismatches");
 STATISTIC(NumLangDialectMismatch, "The # of language dialect mismatches");
 STATISTIC(NumASTLoadThresholdReached,
           "The # of ASTs not loaded because of threshold");
+STATISTIC(NumASTsParsed, "The # of ASTs parsed from source files");
+STATISTIC(NumASTsEvicted,
+          "The # of ASTs unloaded because of the memory limit");
 
 // Same as Triple's equality operator, but we check a field only if that is
 // known in both instances.
@@ -110,6 +123,14 @@ public:
       return "Language dialect mismatch";
     case index_error_code::load_threshold_reached:
       return "Load threshold reached";
+    case index_error_code::missing_compilation_database:
+      return "The compilation database is missing.";
+    case index_error_code::invalid_compilation_database:
+      return "Invalid compilation database format.";
+    case index_error_code::missing_compile_command:
+      return "Missing compile command from the compilation database.";
+    case index_error_code::invalid_binary_index_format:
+      return "Invalid binary index file format.";
     }
     llvm_unreachable("Unrecognized index_error_code.");
   }
@@ -166,6 +187,236 @@ createCrossTUIndexString(const llvm::StringMap<std::string> &Index) {
   return Result.str();
 }
 
+/// The magic number at the start of a binary index. The file ends with the
+/// number of files, the offset of the file table, and the offset of the
+/// buckets of the hash table, as little-endian 64-bit integers.
+static const char BinaryIndexMagic[] = "CTUIDX01";
+static const size_t BinaryIndexMagicSize = sizeof(BinaryIndexMagic) - 1;
+static const size_t BinaryIndexTrailerSize = 3 * sizeof(uint64_t);
+
+/// The traits of the on-disk hash table of a binary index, which maps the
+/// lookup names to the positions of their files in the file table.
+class CrossTUBinaryIndex::Trait {
+public:
+  using key_type = StringRef;
+  using key_type_ref = StringRef;
+  using internal_key_type = StringRef;
+  using external_key_type = StringRef;
+  using data_type = uint32_t;
+  using data_type_ref = uint32_t;
+  using hash_value_type = uint32_t;
+  using offset_type = uint64_t;
+
+  static hash_value_type ComputeHash(StringRef Key) {
+    return llvm::djbHash(Key);
+  }
+
+  static bool EqualKey(StringRef LHS, StringRef RHS) { return LHS == RHS; }
+
+  static StringRef GetInternalKey(StringRef Key) { return Key; }
+
+  static std::pair<unsigned, unsigned>
+  EmitKeyDataLength(raw_ostream &Out, StringRef Key, uint32_t) {
+    llvm::support::endian::write<uint32_t>(Out, Key.size(),
+                                           llvm::support::little);
+    return std::make_pair(Key.size(), sizeof(uint32_t));
+  }
+
+  static void EmitKey(raw_ostream &Out, StringRef Key, unsigned) {
+    Out << Key;
+  }
+
+  static void EmitData(raw_ostream &Out, StringRef, uint32_t File, unsigned) {
+    llvm::support::endian::write<uint32_t>(Out, File, llvm::support::little);
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char *&D) {
+    using namespace llvm::support;
+    unsigned KeyLen = endian::readNext<uint32_t, little, unaligned>(D);
+    return std::make_pair(KeyLen, sizeof(uint32_t));
+  }
+
+  static StringRef ReadKey(const unsigned char *D, unsigned N) {
+    return StringRef(reinterpret_cast<const char *>(D), N);
+  }
+
+  static uint32_t ReadData(StringRef, const unsigned char *D, unsigned) {
+    using namespace llvm::support;
+    return endian::readNext<uint32_t, little, unaligned>(D);
+  }
+};
+
+CrossTUBinaryIndex::~CrossTUBinaryIndex() {}
+
+void CrossTUBinaryIndex::write(const llvm::StringMap<std::string> &Index,
+                               raw_ostream &OS) {
+  using namespace llvm::support;
+  OS.write(BinaryIndexMagic, BinaryIndexMagicSize);
+
+  // Insert the names in order, for the output not to depend on the order of
+  // the entries of the map. Each file name is stored once in the file table.
+  std::vector<StringRef> Names;
+  Names.reserve(Index.size());
+  for (const auto &E : Index)
+    Names.push_back(E.getKey());
+  llvm::sort(Names);
+
+  llvm::OnDiskChainedHashTableGenerator<Trait> Generator;
+  std::vector<StringRef> Files;
+  llvm::StringMap<uint32_t> FileIDs;
+  for (StringRef Name : Names) {
+    StringRef File = Index.find(Name)->second;
+    auto Inserted = FileIDs.try_emplace(File, Files.size());
+    if (Inserted.second)
+      Files.push_back(File);
+    Generator.insert(Name, Inserted.first->second);
+  }
+
+  uint64_t FileTableOffset = OS.tell();
+  for (StringRef File : Files) {
+    endian::write<uint32_t>(OS, File.size(), little);
+    OS << File;
+  }
+  uint64_t BucketOffset = Generator.Emit(OS);
+
+  endian::write<uint64_t>(OS, Files.size(), little);
+  endian::write<uint64_t>(OS, FileTableOffset, little);
+  endian::write<uint64_t>(OS, BucketOffset, little);
+}
+
+bool CrossTUBinaryIndex::isBinaryIndex(StringRef Contents) {
+  return Contents.startswith(StringRef(BinaryIndexMagic, BinaryIndexMagicSize));
+}
+
+llvm::Expected<std::unique_ptr<CrossTUBinaryIndex>>
+CrossTUBinaryIndex::create(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                           StringRef CrossTUDir) {
+  using namespace llvm::support;
+  StringRef Contents = Buffer->getBuffer();
+  auto InvalidIndex = [&Buffer] {
+    return llvm::make_error<IndexError>(
+        index_error_code::invalid_binary_index_format,
+        Buffer->getBufferIdentifier().str());
+  };
+  if (!isBinaryIndex(Contents) ||
+      Contents.size() < BinaryIndexMagicSize + BinaryIndexTrailerSize)
+    return InvalidIndex();
+
+  const auto *Base = reinterpret_cast<const unsigned char *>(Contents.data());
+  const uint64_t TrailerOffset = Contents.size() - BinaryIndexTrailerSize;
+  const unsigned char *Trailer = Base + TrailerOffset;
+  uint64_t NumFiles = endian::readNext<uint64_t, little, unaligned>(Trailer);
+  uint64_t FileTableOffset =
+      endian::readNext<uint64_t, little, unaligned>(Trailer);
+  uint64_t BucketOffset =
+      endian::readNext<uint64_t, little, unaligned>(Trailer);
+  if (FileTableOffset < BinaryIndexMagicSize ||
+      FileTableOffset > BucketOffset || BucketOffset >= TrailerOffset ||
+      BucketOffset % alignof(Trait::offset_type) != 0)
+    return InvalidIndex();
+
+  std::unique_ptr<CrossTUBinaryIndex> Index(new CrossTUBinaryIndex());
+  const unsigned char *File = Base + FileTableOffset;
+  const unsigned char *FileTableEnd = Base + BucketOffset;
+  for (uint64_t I = 0; I != NumFiles; ++I) {
+    if (FileTableEnd - File < int64_t(sizeof(uint32_t)))
+      return InvalidIndex();
+    uint32_t Length = endian::readNext<uint32_t, little, unaligned>(File);
+    if (FileTableEnd - File < int64_t(Length))
+      return InvalidIndex();
+    SmallString<256> FilePath = CrossTUDir;
+    llvm::sys::path::append(
+        FilePath, StringRef(reinterpret_cast<const char *>(File), Length));
+    Index->FilePaths.push_back(FilePath.str().str());
+    File += Length;
+  }
+
+  Index->Table.reset(
+      llvm::OnDiskChainedHashTable<Trait>::Create(Base + BucketOffset, Base));
+  Index->Buffer = std::move(Buffer);
+  return std::move(Index);
+}
+
+llvm::Optional<StringRef>
+CrossTUBinaryIndex::lookup(StringRef LookupName) const {
+  auto Entry = Table->find(LookupName);
+  if (Entry == Table->end())
+    return None;
+  uint32_t File = *Entry;
+  if (File >= FilePaths.size())
+    return None;
+  return StringRef(FilePaths[File]);
+}
+
+llvm::Expected<llvm::StringMap<std::vector<std::string>>>
+parseCrossTUCompilationDatabase(StringRef DatabasePath) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(DatabasePath);
+  if (!Buffer)
+    return llvm::make_error<IndexError>(
+        index_error_code::missing_compilation_database, DatabasePath.str());
+
+  auto InvalidDatabase = [DatabasePath] {
+    return llvm::make_error<IndexError>(
+        index_error_code::invalid_compilation_database, DatabasePath.str());
+  };
+
+  llvm::Expected<llvm::json::Value> Database =
+      llvm::json::parse((*Buffer)->getBuffer());
+  if (!Database) {
+    llvm::consumeError(Database.takeError());
+    return InvalidDatabase();
+  }
+  const llvm::json::Array *Commands = Database->getAsArray();
+  if (!Commands)
+    return InvalidDatabase();
+
+  llvm::StringMap<std::vector<std::string>> Result;
+  for (const llvm::json::Value &Command : *Commands) {
+    const llvm::json::Object *Fields = Command.getAsObject();
+    if (!Fields)
+      return InvalidDatabase();
+    llvm::Optional<StringRef> Directory = Fields->getString("directory");
+    llvm::Optional<StringRef> File = Fields->getString("file");
+    if (!Directory || !File)
+      return InvalidDatabase();
+
+    std::vector<std::string> Args;
+    if (const llvm::json::Array *Arguments = Fields->getArray("arguments")) {
+      for (const llvm::json::Value &Argument : *Arguments) {
+        llvm::Optional<StringRef> Arg = Argument.getAsString();
+        if (!Arg)
+          return InvalidDatabase();
+        Args.push_back(Arg->str());
+      }
+    } else if (llvm::Optional<StringRef> CommandLine =
+                   Fields->getString("command")) {
+      llvm::BumpPtrAllocator Alloc;
+      llvm::StringSaver Saver(Alloc);
+      SmallVector<const char *, 32> Tokens;
+      llvm::cl::TokenizeGNUCommandLine(*CommandLine, Saver, Tokens);
+      Args.assign(Tokens.begin(), Tokens.end());
+    }
+    if (Args.empty())
+      return InvalidDatabase();
+
+    // The relative paths of the command are relative to its directory.
+    Args.insert(Args.begin() + 1, ("-working-directory=" + *Directory).str());
+
+    SmallString<256> FilePath = *Directory;
+    if (llvm::sys::path::is_absolute(*File))
+      FilePath = *File;
+    else
+      llvm::sys::path::append(FilePath, *File);
+    llvm::sys::path::remove_dots(FilePath, /*remove_dot_dot=*/true);
+
+    // A file may be compiled by several commands, use the first one.
+    Result.try_emplace(FilePath, std::move(Args));
+  }
+  return Result;
+}
+
 bool containsConst(const VarDecl *VD, const ASTContext &ACtx) {
   CanQualType CT = ACtx.getCanonicalType(VD->getType());
   if (!CT.isConstQualified()) {
@@ -188,7 +439,8 @@ template <typename T> static bool hasBodyOrInit(const T *D) {
 }
 
 CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI)
-    : Context(CI.getASTContext()), ASTStorage(CI) {}
+    : Context(CI.getASTContext()),
+      ASTStorage(CI, [this](ASTUnit &Unit) { forgetASTUnit(Unit); }) {}
 
 CrossTranslationUnitContext::~CrossTranslationUnitContext() {}
 
@@ -321,9 +573,18 @@ CrossTranslationUnitContext::getCrossTUDefinition(const VarDecl *VD,
 void CrossTranslationUnitContext::emitCrossTUDiagnostics(const IndexError &IE) {
   switch (IE.getCode()) {
   case index_error_code::missing_index_file:
+  case index_error_code::missing_compilation_database:
     Context.getDiagnostics().Report(diag::err_ctu_error_opening)
         << IE.getFileName();
     break;
+  case index_error_code::invalid_compilation_database:
+    Context.getDiagnostics().Report(diag::err_ctu_compilation_database_parsing)
+        << IE.getFileName();
+    break;
+  case index_error_code::invalid_binary_index_format:
+    Context.getDiagnostics().Report(diag::err_ctu_binary_index_parsing)
+        << IE.getFileName();
+    break;
   case index_error_code::invalid_index_format:
     Context.getDiagnostics().Report(diag::err_extdefmap_parsing)
         << IE.getFileName() << IE.getLineNum();
@@ -343,10 +604,20 @@ void CrossTranslationUnitContext::emitCrossTUDiagnostics(const IndexError &IE) {
 
 CrossTranslationUnitContext::ASTFileLoader::ASTFileLoader(
     const CompilerInstance &CI)
-    : CI(CI) {}
+    : CI(CI), CompilationDatabasePath(const_cast<CompilerInstance &>(CI)
+                                          .getAnalyzerOpts()
+                                          ->CTUCompilationDatabase) {}
+
+llvm::Expected<std::unique_ptr<ASTUnit>>
+CrossTranslationUnitContext::ASTFileLoader::operator()(StringRef FilePath) {
+  if (CompilationDatabasePath.empty())
+    return loadFromDump(FilePath);
+  return loadFromSource(FilePath);
+}
 
 std::unique_ptr<ASTUnit>
-CrossTranslationUnitContext::ASTFileLoader::operator()(StringRef ASTFilePath) {
+CrossTranslationUnitContext::ASTFileLoader::loadFromDump(
+    StringRef ASTFilePath) {
   // Load AST from ast-dump.
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
   TextDiagnosticPrinter *DiagClient =
@@ -360,11 +631,79 @@ CrossTranslationUnitContext::ASTFileLoader::operator()(StringRef ASTFilePath) {
       ASTUnit::LoadEverything, Diags, CI.getFileSystemOpts());
 }
 
+llvm::Expected<std::unique_ptr<ASTUnit>>
+CrossTranslationUnitContext::ASTFileLoader::loadFromSource(
+    StringRef SourceFilePath) {
+  if (CompileCommands.empty()) {
+    llvm::Expected<llvm::StringMap<std::vector<std::string>>> Commands =
+        parseCrossTUCompilationDatabase(CompilationDatabasePath);
+    if (!Commands)
+      return Commands.takeError();
+    CompileCommands = std::move(*Commands);
+  }
+
+  SmallString<256> Path = SourceFilePath;
+  llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+  auto Command = CompileCommands.find(Path);
+  if (Command == CompileCommands.end())
+    return llvm::make_error<IndexError>(
+        index_error_code::missing_compile_command, Path.str().str());
+
+  SmallVector<const char *, 32> Args;
+  for (const std::string &Arg : Command->second)
+    Args.push_back(Arg.c_str());
+
+  // The diagnostics of the unit were already reported when it was compiled.
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
+      new DiagnosticsEngine(new DiagnosticIDs(), new DiagnosticOptions(),
+                            new IgnoringDiagConsumer()));
+
+  // The working directory of the command is set on a file system of its own,
+  // rather than on the process.
+  IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS =
+      llvm::vfs::createPhysicalFileSystem().release();
+
+  // The included headers are parsed into a precompiled preamble, from which
+  // only the declarations that the imported definitions refer to are
+  // deserialized.
+  std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCommandLine(
+      Args.begin(), Args.end(), CI.getPCHContainerOperations(), Diags,
+      CI.getHeaderSearchOpts().ResourceDir, /*OnlyLocalDecls=*/false,
+      CaptureDiagsKind::None, /*RemappedFiles=*/None,
+      /*RemappedFilesKeepOriginalName=*/true,
+      /*PrecompilePreambleAfterNParses=*/1, TU_Complete,
+      /*CacheCodeCompletionResults=*/false,
+      /*IncludeBriefCommentsInCodeCompletion=*/false,
+      /*AllowPCHWithCompilerErrors=*/false, SkipFunctionBodiesScope::None,
+      /*SingleFileParse=*/false, /*UserFilesAreVolatile=*/false,
+      /*ForSerialization=*/false, /*RetainExcludedConditionalBlocks=*/false,
+      /*ModuleFormat=*/llvm::None, /*ErrAST=*/nullptr, FS));
+  ++NumASTsParsed;
+  return std::move(Unit);
+}
+
+/// The memory used by a loaded unit, which grows as the declarations of an
+/// AST-dump or of a preamble are deserialized for the imports.
+static size_t getMemoryUsage(const ASTUnit &Unit) {
+  const ASTContext &Ctx = Unit.getASTContext();
+  const SourceManager &SM = Unit.getSourceManager();
+  SourceManager::MemoryBufferSizes Buffers = SM.getMemoryBufferSizes();
+  return Ctx.getASTAllocatedMemory() + Ctx.getSideTableAllocatedMemory() +
+         SM.getContentCacheSize() + SM.getDataStructureSizes() +
+         Buffers.malloc_bytes + Buffers.mmap_bytes +
+         Unit.getPreprocessor().getTotalMemory();
+}
+
 CrossTranslationUnitContext::ASTUnitStorage::ASTUnitStorage(
-    const CompilerInstance &CI)
+    const CompilerInstance &CI, std::function<void(ASTUnit &)> OnUnitEvicted)
     : FileAccessor(CI), LoadGuard(const_cast<CompilerInstance &>(CI)
                                       .getAnalyzerOpts()
-                                      ->CTUImportThreshold) {}
+                                      ->CTUImportThreshold),
+      MemoryLimit(size_t(const_cast<CompilerInstance &>(CI)
+                             .getAnalyzerOpts()
+                             ->CTUMaxMemory)
+                  << 20),
+      OnUnitEvicted(std::move(OnUnitEvicted)) {}
 
 llvm::Expected<ASTUnit *>
 CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
@@ -373,32 +712,76 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
   auto ASTCacheEntry = FileASTUnitMap.find(FileName);
   if (ASTCacheEntry == FileASTUnitMap.end()) {
 
-    // Do not load if the limit is reached.
-    if (!LoadGuard) {
+    // Do not load if the limit is reached. The units are unloaded instead if
+    // their memory is limited.
+    if (!MemoryLimit && !LoadGuard) {
       ++NumASTLoadThresholdReached;
       return llvm::make_error<IndexError>(
           index_error_code::load_threshold_reached);
     }
 
-    // Load the ASTUnit from the pre-dumped AST file specified by ASTFileName.
-    std::unique_ptr<ASTUnit> LoadedUnit = FileAccessor(FileName);
+    // Load the ASTUnit from the pre-dumped AST file specified by ASTFileName,
+    // or parse it from the source file.
+    llvm::Expected<std::unique_ptr<ASTUnit>> LoadedUnit =
+        FileAccessor(FileName);
 
-    // Need the raw pointer and the unique_ptr as well.
-    ASTUnit *Unit = LoadedUnit.get();
+    // Update the cache. A unit that can not be loaded is not retried.
+    CachedUnit &Entry = FileASTUnitMap[FileName];
+    Entry.LastUse = ++UseCounter;
+    if (!LoadedUnit)
+      return LoadedUnit.takeError();
+    Entry.Unit = std::move(*LoadedUnit);
 
-    // Update the cache.
-    FileASTUnitMap[FileName] = std::move(LoadedUnit);
+    // Need the raw pointer and the unique_ptr as well.
+    ASTUnit *Unit = Entry.Unit.get();
 
     LoadGuard.indicateLoadSuccess();
 
     if (DisplayCTUProgress)
       llvm::errs() << "CTU loaded AST file: " << FileName << "\n";
 
+    if (MemoryLimit)
+      evictUnitsOverMemoryLimit(Unit);
+
     return Unit;
 
   } else {
     // Found in the cache.
-    return ASTCacheEntry->second.get();
+    ASTCacheEntry->second.LastUse = ++UseCounter;
+    return ASTCacheEntry->second.Unit.get();
+  }
+}
+
+void CrossTranslationUnitContext::ASTUnitStorage::evictUnitsOverMemoryLimit(
+    const ASTUnit *Keep) {
+  size_t Memory = 0;
+  for (const auto &Entry : FileASTUnitMap)
+    if (const ASTUnit *Unit = Entry.second.Unit.get())
+      Memory += getMemoryUsage(*Unit);
+
+  while (Memory > MemoryLimit) {
+    auto Victim = FileASTUnitMap.end();
+    for (auto I = FileASTUnitMap.begin(), E = FileASTUnitMap.end(); I != E;
+         ++I) {
+      const ASTUnit *Unit = I->second.Unit.get();
+      if (Unit && Unit != Keep &&
+          (Victim == FileASTUnitMap.end() ||
+           I->second.LastUse < Victim->second.LastUse))
+        Victim = I;
+    }
+    if (Victim == FileASTUnitMap.end())
+      return;
+
+    ASTUnit &Unit = *Victim->second.Unit;
+    for (auto I = NameASTUnitMap.begin(), E = NameASTUnitMap.end(); I != E;) {
+      auto Current = I++;
+      if (Current->second == &Unit)
+        NameASTUnitMap.erase(Current);
+    }
+    OnUnitEvicted(Unit);
+    Memory -= getMemoryUsage(Unit);
+    FileASTUnitMap.erase(Victim);
+    ++NumASTsEvicted;
   }
 }
 
@@ -416,16 +799,16 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
             ensureCTUIndexLoaded(CrossTUDir, IndexName))
       return std::move(IndexLoadError);
 
-    // Check if there is and entry in the index for the function.
-    if (!NameFileMap.count(FunctionName)) {
+    // Search in the index for the filename where the definition of FuncitonName
+    // resides.
+    llvm::Optional<StringRef> FileName = lookupFileForFunction(FunctionName);
+    if (!FileName) {
       ++NumNotInOtherTU;
       return llvm::make_error<IndexError>(index_error_code::missing_definition);
     }
 
-    // Search in the index for the filename where the definition of FuncitonName
-    // resides.
     if (llvm::Expected<ASTUnit *> FoundForFile =
-            getASTUnitForFile(NameFileMap[FunctionName], DisplayCTUProgress)) {
+            getASTUnitForFile(*FileName, DisplayCTUProgress)) {
 
       // Update the cache.
       NameASTUnitMap[FunctionName] = *FoundForFile;
@@ -435,7 +818,15 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
       return FoundForFile.takeError();
     }
   } else {
-    // Found in the cache.
+    // Found in the cache. The unit is used again, which matters to the
+    // eviction of the least recently used units.
+    if (MemoryLimit) {
+      auto FileEntry =
+          FileASTUnitMap.find(*lookupFileForFunction(FunctionName));
+      assert(FileEntry != FileASTUnitMap.end() &&
+             "Unloaded units should not be cached by name.");
+      FileEntry->second.LastUse = ++UseCounter;
+    }
     return ASTCacheEntry->second;
   }
 }
@@ -445,13 +836,24 @@ CrossTranslationUnitContext::ASTUnitStorage::getFileForFunction(
     StringRef FunctionName, StringRef CrossTUDir, StringRef IndexName) {
   if (llvm::Error IndexLoadError = ensureCTUIndexLoaded(CrossTUDir, IndexName))
     return std::move(IndexLoadError);
-  return NameFileMap[FunctionName];
+  return lookupFileForFunction(FunctionName).getValueOr("").str();
+}
+
+llvm::Optional<StringRef>
+CrossTranslationUnitContext::ASTUnitStorage::lookupFileForFunction(
+    StringRef FunctionName) {
+  if (BinaryIndex)
+    return BinaryIndex->lookup(FunctionName);
+  auto Entry = NameFileMap.find(FunctionName);
+  if (Entry == NameFileMap.end())
+    return None;
+  return StringRef(Entry->second);
 }
 
 llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
     StringRef CrossTUDir, StringRef IndexName) {
   // Dont initialize if the map is filled.
-  if (!NameFileMap.empty())
+  if (!NameFileMap.empty() || BinaryIndex)
     return llvm::Error::success();
 
   // Get the absolute path to the index file.
@@ -461,9 +863,22 @@ llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
   else
     llvm::sys::path::append(IndexFile, IndexName);
 
+  // A binary index is looked up in the mapped file instead of being parsed.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(IndexFile, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (Buffer && CrossTUBinaryIndex::isBinaryIndex((*Buffer)->getBuffer())) {
+    llvm::Expected<std::unique_ptr<CrossTUBinaryIndex>> Index =
+        CrossTUBinaryIndex::create(std::move(*Buffer), CrossTUDir);
+    if (!Index)
+      return Index.takeError();
+    BinaryIndex = std::move(*Index);
+    return llvm::Error::success();
+  }
+
   if (auto IndexMapping = parseCrossTUIndex(IndexFile, CrossTUDir)) {
     // Initialize member map.
-    NameFileMap = *IndexMapping;
+    NameFileMap = std::move(*IndexMapping);
     return llvm::Error::success();
   } else {
     // Error while parsing CrossTU index file.
@@ -546,6 +961,18 @@ void CrossTranslationUnitContext::lazyInitImporterSharedSt(
     ImporterSharedSt = std::make_shared<ASTImporterSharedState>(*ToTU);
 }
 
+void CrossTranslationUnitContext::forgetASTUnit(ASTUnit &Unit) {
+  // The imported declarations and files are copies, which do not refer to the
+  // unit, but the original locations of the imported files can no longer be
+  // looked up.
+  ASTUnitImporterMap.erase(Unit.getASTContext().getTranslationUnitDecl());
+  for (auto I = ImportedFileIDs.begin(), E = ImportedFileIDs.end(); I != E;) {
+    auto Current = I++;
+    if (Current->second.second == &Unit)
+      ImportedFileIDs.erase(Current);
+  }
+}
+
 ASTImporter &
 CrossTranslationUnitContext::getOrCreateASTImporter(ASTUnit *Unit) {
   ASTContext &From = Unit->getASTContext();
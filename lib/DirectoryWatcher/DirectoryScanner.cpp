@@ -8,6 +8,8 @@
 
 #include "DirectoryScanner.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Path.h"
 
 namespace clang {
@@ -39,6 +41,24 @@ std::vector<std::string> scanDirectory(StringRef Path) {
   return Result;
 }
 
+std::vector<std::string> scanDirectoryTree(StringRef Path) {
+  using namespace llvm::sys;
+  std::vector<std::string> Result;
+
+  std::error_code EC;
+  for (auto It = fs::recursive_directory_iterator(Path, EC,
+                                                  /*follow_symlinks=*/false),
+            End = fs::recursive_directory_iterator();
+       !EC && It != End; It.increment(EC)) {
+    if (It->type() == fs::file_type::directory_file)
+      continue;
+    StringRef Relative = StringRef(It->path()).drop_front(Path.size());
+    Result.emplace_back(Relative.ltrim(path::get_separator()));
+  }
+
+  return Result;
+}
+
 std::vector<DirectoryWatcher::Event>
 getAsFileEvents(const std::vector<std::string> &Scan) {
   std::vector<DirectoryWatcher::Event> Events;
@@ -51,4 +71,29 @@ getAsFileEvents(const std::vector<std::string> &Scan) {
   return Events;
 }
 
+std::vector<DirectoryWatcher::Event>
+coalesceEvents(std::vector<DirectoryWatcher::Event> Events) {
+  auto Invalidated =
+      llvm::find_if(Events, [](const DirectoryWatcher::Event &E) {
+        return E.Kind ==
+               DirectoryWatcher::Event::EventKind::WatcherGotInvalidated;
+      });
+  if (Invalidated != Events.end())
+    Events.erase(std::next(Invalidated), Events.end());
+
+  StringMap<size_t> Last;
+  for (size_t I = 0, E = Events.size(); I != E; ++I)
+    if (!Events[I].Filename.empty())
+      Last[Events[I].Filename] = I;
+  if (Last.size() == Events.size())
+    return Events;
+
+  std::vector<DirectoryWatcher::Event> Result;
+  Result.reserve(Events.size());
+  for (size_t I = 0, E = Events.size(); I != E; ++I)
+    if (Events[I].Filename.empty() || Last[Events[I].Filename] == I)
+      Result.push_back(std::move(Events[I]));
+  return Result;
+}
+
 } // namespace clang
\ No newline at end of file
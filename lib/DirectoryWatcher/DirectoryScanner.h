@@ -18,10 +18,19 @@ namespace clang {
 /// be read from.
 std::vector<std::string> scanDirectory(llvm::StringRef Path);
 
+/// Gets the paths, relative to \p Path, of the files in the tree of the
+/// directory at \p Path. Symbolic links to directories aren't followed.
+std::vector<std::string> scanDirectoryTree(llvm::StringRef Path);
+
 /// Create event with EventKind::Added for every element in \p Scan.
 std::vector<DirectoryWatcher::Event>
 getAsFileEvents(const std::vector<std::string> &Scan);
 
+/// Drops the events of \p Events which are followed by another event of the
+/// same file, and the events following a WatcherGotInvalidated.
+std::vector<DirectoryWatcher::Event>
+coalesceEvents(std::vector<DirectoryWatcher::Event> Events);
+
 /// Gets status of file (or directory) at \p Path.
 /// \returns llvm::None if \p Path doesn't exist or can't get the status.
 llvm::Optional<llvm::sys::fs::file_status> getFileStatus(llvm::StringRef Path);
@@ -14,7 +14,7 @@ using namespace clang;
 llvm::Expected<std::unique_ptr<DirectoryWatcher>> clang::DirectoryWatcher::create(
     StringRef Path,
     std::function<void(llvm::ArrayRef<DirectoryWatcher::Event>, bool)> Receiver,
-    bool WaitForInitialSync) {
+    bool WaitForInitialSync, bool Recursive) {
   return llvm::make_error<llvm::StringError>(
       "DirectoryWatcher is not implemented for this platform!",
       llvm::inconvertibleErrorCode());
@@ -11,6 +11,7 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/AlignOf.h"
 #include "llvm/Support/Errno.h"
 #include "llvm/Support/Error.h"
@@ -18,9 +19,9 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <fcntl.h>
@@ -83,33 +84,143 @@ struct SemaphorePipe {
 class EventQueue {
   std::mutex Mtx;
   std::condition_variable NonEmpty;
-  std::queue<DirectoryWatcher::Event> Events;
+  std::vector<DirectoryWatcher::Event> Events;
 
 public:
   void push_back(const DirectoryWatcher::Event::EventKind K,
                  StringRef Filename) {
     {
       std::unique_lock<std::mutex> L(Mtx);
-      Events.emplace(K, Filename);
+      Events.emplace_back(K, Filename);
     }
     NonEmpty.notify_one();
   }
 
-  // Blocks on caller thread and uses codition_variable to wait until there's an
-  // event to return.
-  DirectoryWatcher::Event pop_front_blocking() {
-    std::unique_lock<std::mutex> L(Mtx);
-    while (true) {
+  void push_back(std::vector<DirectoryWatcher::Event> &&NewEvents) {
+    if (NewEvents.empty())
+      return;
+    {
+      std::unique_lock<std::mutex> L(Mtx);
+      if (Events.empty())
+        Events = std::move(NewEvents);
+      else
+        Events.insert(Events.end(), std::make_move_iterator(NewEvents.begin()),
+                      std::make_move_iterator(NewEvents.end()));
+    }
+    NewEvents.clear();
+    NonEmpty.notify_one();
+  }
+
+  // Blocks on caller thread and uses codition_variable to wait until there are
+  // events to return. Returns all of them, keeping only the last event of every
+  // file, and none after a WatcherGotInvalidated.
+  std::vector<DirectoryWatcher::Event> pop_all_blocking() {
+    std::vector<DirectoryWatcher::Event> Popped;
+    {
+      std::unique_lock<std::mutex> L(Mtx);
       // Since we might have missed all the prior notifications on NonEmpty we
       // have to check the queue first (under lock).
-      if (!Events.empty()) {
-        DirectoryWatcher::Event Front = Events.front();
-        Events.pop();
-        return Front;
-      }
       NonEmpty.wait(L, [this]() { return !Events.empty(); });
+      Popped.swap(Events);
+    }
+    return coalesceEvents(std::move(Popped));
+  }
+};
+
+/// The inotify watches of the directories of a watcher. A watcher which isn't
+/// recursive only watches the watched directory.
+class InotifyWatches {
+public:
+  InotifyWatches(int InotifyFD, StringRef WatchedDirPath)
+      : InotifyFD(InotifyFD), WatchedDirPath(WatchedDirPath) {}
+
+  /// The most directories a watcher watches. Each one takes an inotify watch,
+  /// which the kernel limits per user.
+  static constexpr size_t MaxWatches = 8192;
+
+  static constexpr uint32_t Mask =
+      IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MODIFY | IN_MOVED_FROM |
+      IN_MOVE_SELF | IN_MOVED_TO | IN_ONLYDIR | IN_IGNORED
+#ifdef IN_EXCL_UNLINK
+      | IN_EXCL_UNLINK
+#endif
+      ;
+
+  /// Watch the watched directory.
+  /// \returns the watch descriptor, or -1 with errno set.
+  int addRoot() {
+    int WD = inotify_add_watch(InotifyFD, WatchedDirPath.c_str(), Mask);
+    if (WD != -1)
+      Directories[WD] = "";
+    return WD;
+  }
+
+  /// Watch the directory at \p RelativePath and all its subdirectories,
+  /// appending the paths of the files found in them to \p Files.
+  /// Directories which are gone before they are watched are skipped.
+  /// \returns false if the directories couldn't all be watched.
+  bool addTree(StringRef RelativePath, std::vector<std::string> &Files) {
+    SmallVector<std::string, 16> Worklist;
+    Worklist.emplace_back(RelativePath);
+    while (!Worklist.empty()) {
+      std::string Dir = Worklist.pop_back_val();
+      SmallString<256> Path(WatchedDirPath);
+      llvm::sys::path::append(Path, Dir);
+      if (!Dir.empty()) {
+        if (Directories.size() >= MaxWatches)
+          return false;
+        int WD = inotify_add_watch(InotifyFD, Path.c_str(), Mask);
+        if (WD == -1) {
+          if (errno == ENOENT || errno == ENOTDIR)
+            continue;
+          return false;
+        }
+        Directories[WD] = Dir;
+      }
+
+      std::error_code EC;
+      for (llvm::sys::fs::directory_iterator
+               It(Path, EC, /*follow_symlinks=*/false),
+           End;
+           !EC && It != End; It.increment(EC)) {
+        SmallString<256> Entry(Dir);
+        llvm::sys::path::append(Entry, llvm::sys::path::filename(It->path()));
+        if (It->type() == llvm::sys::fs::file_type::directory_file)
+          Worklist.emplace_back(Entry.str());
+        else
+          Files.emplace_back(Entry.str());
+      }
+    }
+    return true;
+  }
+
+  /// Stop watching the directory at \p RelativePath and its subdirectories.
+  void removeTree(StringRef RelativePath) {
+    for (auto It = Directories.begin(); It != Directories.end();) {
+      StringRef Dir = It->second;
+      if (Dir.consume_front(RelativePath) &&
+          (Dir.empty() || Dir.front() == '/')) {
+        inotify_rm_watch(InotifyFD, It->first);
+        It = Directories.erase(It);
+      } else {
+        ++It;
+      }
     }
   }
+
+  /// \returns the path of the directory watched by \p WD relative to the
+  /// watched directory, or null if the watch was removed.
+  const std::string *lookup(int WD) const {
+    auto It = Directories.find(WD);
+    return It == Directories.end() ? nullptr : &It->second;
+  }
+
+  void erase(int WD) { Directories.erase(WD); }
+
+private:
+  const int InotifyFD;
+  const std::string WatchedDirPath;
+  std::unordered_map<int, std::string> Directories;
 };
 
 class DirectoryWatcherLinux : public clang::DirectoryWatcher {
@@ -117,7 +228,8 @@ public:
   DirectoryWatcherLinux(
       llvm::StringRef WatchedDirPath,
       std::function<void(llvm::ArrayRef<Event>, bool)> Receiver,
-      bool WaitForInitialSync, int InotifyFD, int InotifyWD,
+      bool WaitForInitialSync, bool Recursive, int InotifyFD, int InotifyWD,
+      InotifyWatches &&Watches, std::vector<std::string> &&InitialFiles,
       SemaphorePipe &&InotifyPollingStopSignal);
 
   ~DirectoryWatcherLinux() override {
@@ -130,10 +242,15 @@ public:
 
 private:
   const std::string WatchedDirPath;
+  const bool Recursive;
   // inotify file descriptor
   int InotifyFD = -1;
-  // inotify watch descriptor
+  // inotify watch descriptor of the watched directory
   int InotifyWD = -1;
+  // Only used by InotifyPollingThread once it started.
+  InotifyWatches Watches;
+  // The files found while the tree of a recursive watcher was watched.
+  std::vector<std::string> InitialFiles;
 
   EventQueue Queue;
 
@@ -141,7 +258,8 @@ private:
   // EventsReceivingThread.
   std::function<void(llvm::ArrayRef<Event>, bool)> Receiver;
 
-  // Consumes inotify events and pushes directory watcher events to the Queue.
+  // Consumes inotify events and pushes directory watcher events to the Queue,
+  // all the events read at once together.
   void InotifyPollingLoop();
   std::thread InotifyPollingThread;
   // Using pipe so we can epoll two file descriptors at once - inotify and
@@ -235,6 +353,7 @@ void DirectoryWatcherLinux::InotifyPollingLoop() {
     // event for stopping, it must be an inotify event ready for reading.
     ssize_t NumRead = llvm::sys::RetryAfterSignal(-1, read, InotifyFD, Buf,
                                                   EventBufferLength);
+    std::vector<DirectoryWatcher::Event> Events;
     for (char *P = Buf; P < Buf + NumRead;) {
       if (P + sizeof(struct inotify_event) > Buf + NumRead) {
         StopWork();
@@ -245,6 +364,20 @@ void DirectoryWatcherLinux::InotifyPollingLoop() {
       struct inotify_event *Event = reinterpret_cast<struct inotify_event *>(P);
       P += sizeof(struct inotify_event) + Event->len;
 
+      if (Event->mask & IN_Q_OVERFLOW) {
+        // Events were dropped.
+        Queue.push_back(std::move(Events));
+        StopWork();
+        return;
+      }
+
+      // Events of the subdirectories which were moved or removed can still
+      // follow.
+      const std::string *Dir = Watches.lookup(Event->wd);
+      if (!Dir)
+        continue;
+      const bool IsWatchedDir = Event->wd == InotifyWD;
+
       if (Event->mask & (IN_CREATE | IN_MODIFY | IN_MOVED_TO | IN_DELETE) &&
           Event->len <= 0) {
         StopWork();
@@ -252,18 +385,53 @@ void DirectoryWatcherLinux::InotifyPollingLoop() {
         return;
       }
 
+      SmallString<256> Filename(*Dir);
+      if (Event->len > 0)
+        llvm::sys::path::append(Filename, Event->name);
+
+      if (Recursive && (Event->mask & IN_ISDIR) && Event->len > 0) {
+        if (Event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          // The files created before the directory got watched have no
+          // events of their own.
+          std::vector<std::string> Files;
+          if (!Watches.addTree(Filename, Files)) {
+            Queue.push_back(std::move(Events));
+            StopWork();
+            return;
+          }
+          for (const std::string &File : Files)
+            Events.emplace_back(DirectoryWatcher::Event::EventKind::Modified,
+                                File);
+        } else if (Event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+          Watches.removeTree(Filename);
+          if (Event->mask & IN_MOVED_FROM)
+            Events.emplace_back(DirectoryWatcher::Event::EventKind::Removed,
+                                Filename);
+        }
+        continue;
+      }
+
       if (Event->mask & (IN_CREATE | IN_MOVED_TO | IN_MODIFY)) {
-        Queue.push_back(DirectoryWatcher::Event::EventKind::Modified,
-                        Event->name);
+        Events.emplace_back(DirectoryWatcher::Event::EventKind::Modified,
+                            Filename);
       } else if (Event->mask & (IN_DELETE | IN_MOVED_FROM)) {
-        Queue.push_back(DirectoryWatcher::Event::EventKind::Removed,
-                        Event->name);
+        Events.emplace_back(DirectoryWatcher::Event::EventKind::Removed,
+                            Filename);
       } else if (Event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
-        Queue.push_back(DirectoryWatcher::Event::EventKind::WatchedDirRemoved,
-                        "");
+        // The parent of a subdirectory reports it.
+        if (!IsWatchedDir)
+          continue;
+        Events.emplace_back(
+            DirectoryWatcher::Event::EventKind::WatchedDirRemoved, "");
+        Queue.push_back(std::move(Events));
         StopWork();
         return;
       } else if (Event->mask & IN_IGNORED) {
+        if (!IsWatchedDir) {
+          Watches.erase(Event->wd);
+          continue;
+        }
+        Queue.push_back(std::move(Events));
         StopWork();
         return;
       } else {
@@ -272,19 +440,26 @@ void DirectoryWatcherLinux::InotifyPollingLoop() {
         return;
       }
     }
+    Queue.push_back(std::move(Events));
   }
 }
 
 void DirectoryWatcherLinux::InitialScan() {
-  this->Receiver(getAsFileEvents(scanDirectory(WatchedDirPath)),
-                 /*IsInitial=*/true);
+  if (!Recursive) {
+    this->Receiver(getAsFileEvents(scanDirectory(WatchedDirPath)),
+                   /*IsInitial=*/true);
+    return;
+  }
+  this->Receiver(getAsFileEvents(InitialFiles), /*IsInitial=*/true);
+  std::vector<std::string>().swap(InitialFiles);
 }
 
 void DirectoryWatcherLinux::EventReceivingLoop() {
   while (true) {
-    DirectoryWatcher::Event Event = this->Queue.pop_front_blocking();
-    this->Receiver(Event, false);
-    if (Event.Kind ==
+    std::vector<DirectoryWatcher::Event> Events =
+        this->Queue.pop_all_blocking();
+    this->Receiver(Events, false);
+    if (Events.back().Kind ==
         DirectoryWatcher::Event::EventKind::WatcherGotInvalidated) {
       StopWork();
       return;
@@ -295,10 +470,12 @@ void DirectoryWatcherLinux::EventReceivingLoop() {
 DirectoryWatcherLinux::DirectoryWatcherLinux(
     StringRef WatchedDirPath,
     std::function<void(llvm::ArrayRef<Event>, bool)> Receiver,
-    bool WaitForInitialSync, int InotifyFD, int InotifyWD,
+    bool WaitForInitialSync, bool Recursive, int InotifyFD, int InotifyWD,
+    InotifyWatches &&Watches, std::vector<std::string> &&InitialFiles,
     SemaphorePipe &&InotifyPollingStopSignal)
-    : WatchedDirPath(WatchedDirPath), InotifyFD(InotifyFD),
-      InotifyWD(InotifyWD), Receiver(Receiver),
+    : WatchedDirPath(WatchedDirPath), Recursive(Recursive),
+      InotifyFD(InotifyFD), InotifyWD(InotifyWD), Watches(std::move(Watches)),
+      InitialFiles(std::move(InitialFiles)), Receiver(Receiver),
       InotifyPollingStopSignal(std::move(InotifyPollingStopSignal)) {
 
   InotifyPollingThread = std::thread([this]() { InotifyPollingLoop(); });
@@ -323,7 +500,7 @@ DirectoryWatcherLinux::DirectoryWatcherLinux(
 llvm::Expected<std::unique_ptr<DirectoryWatcher>> clang::DirectoryWatcher::create(
     StringRef Path,
     std::function<void(llvm::ArrayRef<DirectoryWatcher::Event>, bool)> Receiver,
-    bool WaitForInitialSync) {
+    bool WaitForInitialSync, bool Recursive) {
   if (Path.empty())
     llvm::report_fatal_error(
         "DirectoryWatcher::create can not accept an empty Path.");
@@ -333,20 +510,25 @@ llvm::Expected<std::unique_ptr<DirectoryWatcher>> clang::DirectoryWatcher::creat
     return llvm::make_error<llvm::StringError>(
         std::string("inotify_init1() error: ") + strerror(errno),
         llvm::inconvertibleErrorCode());
+  auto InotifyFDGuard = llvm::make_scope_exit([InotifyFD]() {
+    llvm::sys::RetryAfterSignal(-1, close, InotifyFD);
+  });
 
-  const int InotifyWD = inotify_add_watch(
-      InotifyFD, Path.str().c_str(),
-      IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MODIFY |
-      IN_MOVED_FROM | IN_MOVE_SELF | IN_MOVED_TO | IN_ONLYDIR | IN_IGNORED
-#ifdef IN_EXCL_UNLINK
-      | IN_EXCL_UNLINK
-#endif
-      );
+  InotifyWatches Watches(InotifyFD, Path);
+  const int InotifyWD = Watches.addRoot();
   if (InotifyWD == -1)
     return llvm::make_error<llvm::StringError>(
         std::string("inotify_add_watch() error: ") + strerror(errno),
         llvm::inconvertibleErrorCode());
 
+  // The subdirectories are watched before the initial scan, like the watched
+  // directory, which finds their files along the way.
+  std::vector<std::string> InitialFiles;
+  if (Recursive && !Watches.addTree("", InitialFiles))
+    return llvm::make_error<llvm::StringError>(
+        "cannot watch all the subdirectories of '" + Path + "'",
+        llvm::inconvertibleErrorCode());
+
   auto InotifyPollingStopper = SemaphorePipe::create();
 
   if (!InotifyPollingStopper)
@@ -354,7 +536,9 @@ llvm::Expected<std::unique_ptr<DirectoryWatcher>> clang::DirectoryWatcher::creat
         std::string("SemaphorePipe::create() error: ") + strerror(errno),
         llvm::inconvertibleErrorCode());
 
+  InotifyFDGuard.release();
   return std::make_unique<DirectoryWatcherLinux>(
-      Path, Receiver, WaitForInitialSync, InotifyFD, InotifyWD,
+      Path, Receiver, WaitForInitialSync, Recursive, InotifyFD, InotifyWD,
+      std::move(Watches), std::move(InitialFiles),
       std::move(*InotifyPollingStopper));
 }
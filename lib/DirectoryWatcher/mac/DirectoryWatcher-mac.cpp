@@ -69,12 +69,23 @@ private:
 struct EventStreamContextData {
   std::string WatchedPath;
   std::function<void(llvm::ArrayRef<DirectoryWatcher::Event>, bool)> Receiver;
+  bool Recursive;
 
   EventStreamContextData(
       std::string &&WatchedPath,
       std::function<void(llvm::ArrayRef<DirectoryWatcher::Event>, bool)>
-          Receiver)
-      : WatchedPath(std::move(WatchedPath)), Receiver(Receiver) {}
+          Receiver,
+      bool Recursive)
+      : WatchedPath(std::move(WatchedPath)), Receiver(Receiver),
+        Recursive(Recursive) {}
+
+  /// The name of the file at \p Path in the events: its path relative to the
+  /// watched directory if the watcher is recursive, its filename otherwise.
+  StringRef getEventFilename(StringRef Path) const {
+    if (Recursive && Path.startswith(WatchedPath))
+      return Path.drop_front(WatchedPath.size()).ltrim('/');
+    return llvm::sys::path::filename(Path);
+  }
 
   // Needed for FSEvents
   static void dispose(const void *ctx) {
@@ -118,19 +129,25 @@ static void eventStreamCallback(ConstFSEventStreamRef Stream,
             DirectoryWatcher::Event::EventKind::WatcherGotInvalidated, ""});
         break;
       }
-      // No support for subdirectories - just ignore everything.
+      // A directory moved out of the tree of a recursive watcher has no
+      // events for its files.
+      if (ctx->Recursive && (Flags & kFSEventStreamEventFlagItemRenamed) &&
+          !getFileStatus(Path).hasValue())
+        Events.emplace_back(DirectoryWatcher::Event::EventKind::Removed,
+                            ctx->getEventFilename(Path));
+      // Otherwise, no events for the directories - just ignore everything.
       continue;
     } else if (Flags & kFSEventStreamEventFlagItemRemoved) {
       Events.emplace_back(DirectoryWatcher::Event::EventKind::Removed,
-                          llvm::sys::path::filename(Path));
+                          ctx->getEventFilename(Path));
       continue;
     } else if (Flags & ModifyingFileEvents) {
       if (!getFileStatus(Path).hasValue()) {
         Events.emplace_back(DirectoryWatcher::Event::EventKind::Removed,
-                            llvm::sys::path::filename(Path));
+                            ctx->getEventFilename(Path));
       } else {
         Events.emplace_back(DirectoryWatcher::Event::EventKind::Modified,
-                            llvm::sys::path::filename(Path));
+                            ctx->getEventFilename(Path));
       }
       continue;
     }
@@ -142,14 +159,14 @@ static void eventStreamCallback(ConstFSEventStreamRef Stream,
   }
 
   if (!Events.empty()) {
-    ctx->Receiver(Events, /*IsInitial=*/false);
+    ctx->Receiver(coalesceEvents(std::move(Events)), /*IsInitial=*/false);
   }
 }
 
 FSEventStreamRef createFSEventStream(
     StringRef Path,
     std::function<void(llvm::ArrayRef<DirectoryWatcher::Event>, bool)> Receiver,
-    dispatch_queue_t Queue) {
+    dispatch_queue_t Queue, bool Recursive) {
   if (Path.empty())
     return nullptr;
 
@@ -178,7 +195,8 @@ FSEventStreamRef createFSEventStream(
 
     FSEventStreamContext Context;
     Context.version = 0;
-    Context.info = new EventStreamContextData(std::move(RealPath), Receiver);
+    Context.info =
+        new EventStreamContextData(std::move(RealPath), Receiver, Recursive);
     Context.retain = nullptr;
     Context.release = EventStreamContextData::dispose;
     Context.copyDescription = nullptr;
@@ -205,7 +223,7 @@ void stopFSEventStream(FSEventStreamRef EventStream) {
 llvm::Expected<std::unique_ptr<DirectoryWatcher>> clang::DirectoryWatcher::create(
     StringRef Path,
     std::function<void(llvm::ArrayRef<DirectoryWatcher::Event>, bool)> Receiver,
-    bool WaitForInitialSync) {
+    bool WaitForInitialSync, bool Recursive) {
   dispatch_queue_t Queue =
       dispatch_queue_create("DirectoryWatcher", DISPATCH_QUEUE_SERIAL);
 
@@ -213,7 +231,7 @@ llvm::Expected<std::unique_ptr<DirectoryWatcher>> clang::DirectoryWatcher::creat
     llvm::report_fatal_error(
         "DirectoryWatcher::create can not accept an empty Path.");
 
-  auto EventStream = createFSEventStream(Path, Receiver, Queue);
+  auto EventStream = createFSEventStream(Path, Receiver, Queue, Recursive);
   assert(EventStream && "EventStream expected to be non-null");
 
   std::unique_ptr<DirectoryWatcher> Result =
@@ -234,7 +252,9 @@ llvm::Expected<std::unique_ptr<DirectoryWatcher>> clang::DirectoryWatcher::creat
     // and FSEvents has incremented it. Since we have to wait for FSEvents to
     // take ownership it's the easiest to do it here rather than main thread.
     dispatch_release(Queue);
-    Receiver(getAsFileEvents(scanDirectory(CopiedPath)), /*IsInitial=*/true);
+    Receiver(getAsFileEvents(Recursive ? scanDirectoryTree(CopiedPath)
+                                       : scanDirectory(CopiedPath)),
+             /*IsInitial=*/true);
   };
 
   if (WaitForInitialSync) {
@@ -44,7 +44,7 @@ llvm::Expected<std::unique_ptr<DirectoryWatcher>>
 clang::DirectoryWatcher::create(
     StringRef Path,
     std::function<void(llvm::ArrayRef<DirectoryWatcher::Event>, bool)> Receiver,
-    bool WaitForInitialSync) {
+    bool WaitForInitialSync, bool Recursive) {
   return llvm::Expected<std::unique_ptr<DirectoryWatcher>>(
       llvm::errorCodeToError(std::make_error_code(std::errc::not_supported)));
 }
@@ -15,16 +15,26 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "clang/Driver/Util.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptSpecifier.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -148,49 +158,68 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  if ((getDriver().CCPrintOptions ||
-       getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
-    std::unique_ptr<llvm::raw_fd_ostream> OwnedStream;
-
-    // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
-    // output stream.
-    if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
-      std::error_code EC;
-      OwnedStream.reset(new llvm::raw_fd_ostream(
-          getDriver().CCPrintOptionsFilename, EC,
-          llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text));
-      if (EC) {
-        getDriver().Diag(diag::err_drv_cc_print_options_failure)
-            << EC.message();
-        FailingCommand = &C;
-        return 1;
-      }
-      OS = OwnedStream.get();
+/// Prints the command \p Cmd of \p C for -v or CC_PRINT_OPTIONS.
+/// \returns false if the options couldn't be logged.
+static bool printCommand(const Compilation &C, const Command &Cmd) {
+  const Driver &D = C.getDriver();
+  if ((!D.CCPrintOptions && !C.getArgs().hasArg(options::OPT_v)) ||
+      D.CCGenDiagnostics)
+    return true;
+
+  raw_ostream *OS = &llvm::errs();
+  std::unique_ptr<llvm::raw_fd_ostream> OwnedStream;
+
+  // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
+  // output stream.
+  if (D.CCPrintOptions && D.CCPrintOptionsFilename) {
+    std::error_code EC;
+    OwnedStream.reset(new llvm::raw_fd_ostream(
+        D.CCPrintOptionsFilename, EC,
+        llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text));
+    if (EC) {
+      D.Diag(diag::err_drv_cc_print_options_failure) << EC.message();
+      return false;
     }
+    OS = OwnedStream.get();
+  }
 
-    if (getDriver().CCPrintOptions)
-      *OS << "[Logging clang options]";
+  if (D.CCPrintOptions)
+    *OS << "[Logging clang options]";
 
-    C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
-  }
+  Cmd.Print(*OS, "\n", /*Quote=*/D.CCPrintOptions);
+  return true;
+}
 
-  std::string Error;
-  bool ExecutionFailed;
-  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+/// Reports the error of the execution of \p Cmd, if any, and \returns its
+/// result code.
+static int getCommandResult(const Compilation &C, const Command &Cmd, int Res,
+                            StringRef Error, bool ExecutionFailed,
+                            const Command *&FailingCommand) {
   if (!Error.empty()) {
     assert(Res && "Error string set with 0 result code!");
-    getDriver().Diag(diag::err_drv_command_failure) << Error;
+    C.getDriver().Diag(diag::err_drv_command_failure) << Error;
   }
 
   if (Res)
-    FailingCommand = &C;
+    FailingCommand = &Cmd;
 
   return ExecutionFailed ? 1 : Res;
 }
 
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!printCommand(*this, C)) {
+    FailingCommand = &C;
+    return 1;
+  }
+
+  std::string Error;
+  bool ExecutionFailed;
+  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+  return getCommandResult(*this, C, Res, Error, ExecutionFailed,
+                          FailingCommand);
+}
+
 using FailingCommandList = SmallVectorImpl<std::pair<int, const Command *>>;
 
 static bool ActionFailed(const Action *A,
@@ -220,8 +249,203 @@ static bool InputsOk(const Command &C,
   return !ActionFailed(&C.getSource(), FailingCommands);
 }
 
+namespace {
+
+/// A job which is executed concurrently with the others. Its output is
+/// redirected to temporary files, which are printed in the order of the jobs.
+struct ParallelJob {
+  enum JobState { Waiting, Running, Finished, Skipped };
+
+  const Command *Cmd = nullptr;
+  /// The jobs which must finish before this one starts.
+  SmallVector<unsigned, 4> Dependencies;
+  JobState State = Waiting;
+  /// Whether the command couldn't be logged, in which case it isn't executed.
+  bool PrintFailed = false;
+  SmallString<128> OutputPath;
+  SmallString<128> ErrorPath;
+
+  // The results of the execution.
+  int Res = 0;
+  std::string Error;
+  bool ExecutionFailed = false;
+};
+
+/// Maps the sources of the jobs to their last job.
+using JobsByActionMap = llvm::DenseMap<const Action *, unsigned>;
+
+} // namespace
+
+/// Adds the jobs which produce the inputs of \p A to \p Dependencies.
+static void collectDependencies(const Action *A,
+                                const JobsByActionMap &JobsByAction,
+                                llvm::SmallPtrSetImpl<const Action *> &Visited,
+                                SmallVectorImpl<unsigned> &Dependencies) {
+  for (const Action *Input : A->inputs()) {
+    if (!Visited.insert(Input).second)
+      continue;
+    // The job of the input depends on the jobs of its own inputs.
+    auto It = JobsByAction.find(Input);
+    if (It != JobsByAction.end())
+      Dependencies.push_back(It->second);
+    else
+      collectDependencies(Input, JobsByAction, Visited, Dependencies);
+  }
+}
+
+/// Replays the output of a parallel job, which is in the file \p Path, to
+/// \p OS and removes the file.
+static void replayOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+          llvm::MemoryBuffer::getFile(Path))
+    OS << (*Buffer)->getBuffer();
+  OS.flush();
+  llvm::sys::fs::remove(Path);
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs, FailingCommandList &FailingCommands) const {
+  // The jobs are in the order of their dependencies. Several jobs may be built
+  // for the same action, which are executed in order.
+  std::vector<ParallelJob> ParallelJobs(Jobs.size());
+  JobsByActionMap JobsByAction;
+  unsigned JobIndex = 0;
+  for (const Command &Cmd : Jobs) {
+    ParallelJob &PJ = ParallelJobs[JobIndex];
+    PJ.Cmd = &Cmd;
+    llvm::SmallPtrSet<const Action *, 16> Visited;
+    collectDependencies(&Cmd.getSource(), JobsByAction, Visited,
+                        PJ.Dependencies);
+    auto Inserted = JobsByAction.try_emplace(&Cmd.getSource(), JobIndex);
+    if (!Inserted.second) {
+      PJ.Dependencies.push_back(Inserted.first->second);
+      Inserted.first->second = JobIndex;
+    }
+    ++JobIndex;
+  }
+
+  unsigned NumThreads =
+      std::min<unsigned>(TheDriver.getParallelJobs(), ParallelJobs.size());
+  std::mutex Lock;
+  std::condition_variable JobFinished;
+  // The jobs which finished since the scheduler last woke up.
+  SmallVector<unsigned, 8> FinishedJobs;
+  // The failures which are known when starting the jobs, which are only
+  // reported to FailingCommands in the order of the jobs.
+  SmallVector<std::pair<int, const Command *>, 4> Failures;
+  unsigned NumRunning = 0;
+  unsigned NextToReport = 0;
+  llvm::ThreadPool Pool(NumThreads);
+
+  auto IsDone = [&](unsigned Dependency) {
+    return ParallelJobs[Dependency].State >= ParallelJob::Finished;
+  };
+
+  while (true) {
+    // Start the jobs whose dependencies are done, in order.
+    for (unsigned I = NextToReport;
+         I != ParallelJobs.size() && NumRunning < NumThreads; ++I) {
+      ParallelJob &PJ = ParallelJobs[I];
+      if (PJ.State != ParallelJob::Waiting ||
+          !llvm::all_of(PJ.Dependencies, IsDone))
+        continue;
+      if (!InputsOk(*PJ.Cmd, Failures)) {
+        PJ.State = ParallelJob::Skipped;
+        continue;
+      }
+      if (!printCommand(*this, *PJ.Cmd)) {
+        PJ.PrintFailed = true;
+        PJ.State = ParallelJob::Finished;
+        Failures.push_back(std::make_pair(1, PJ.Cmd));
+        continue;
+      }
+
+      // If the output can't be redirected, it is printed as it comes.
+      int FD;
+      if (!llvm::sys::fs::createTemporaryFile("clang-job", "out", FD,
+                                               PJ.OutputPath))
+        llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+      else
+        PJ.OutputPath.clear();
+      if (!llvm::sys::fs::createTemporaryFile("clang-job", "err", FD,
+                                               PJ.ErrorPath))
+        llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+      else
+        PJ.ErrorPath.clear();
+
+      PJ.State = ParallelJob::Running;
+      ++NumRunning;
+      Pool.async([&, I] {
+        ParallelJob &Job = ParallelJobs[I];
+        auto getRedirect = [](StringRef Path) -> Optional<StringRef> {
+          if (Path.empty())
+            return None;
+          return Path;
+        };
+        Optional<StringRef> JobRedirects[] = {
+            None, getRedirect(Job.OutputPath), getRedirect(Job.ErrorPath)};
+        Job.Res =
+            Job.Cmd->Execute(JobRedirects, &Job.Error, &Job.ExecutionFailed);
+
+        std::lock_guard<std::mutex> Guard(Lock);
+        FinishedJobs.push_back(I);
+        JobFinished.notify_one();
+      });
+    }
+
+    // Report the results of the jobs in order.
+    for (; NextToReport != ParallelJobs.size() && IsDone(NextToReport);
+         ++NextToReport) {
+      ParallelJob &PJ = ParallelJobs[NextToReport];
+      if (PJ.State == ParallelJob::Skipped)
+        continue;
+      if (PJ.PrintFailed) {
+        FailingCommands.push_back(std::make_pair(1, PJ.Cmd));
+        continue;
+      }
+      replayOutput(PJ.OutputPath, llvm::outs());
+      replayOutput(PJ.ErrorPath, llvm::errs());
+      const Command *FailingCommand = nullptr;
+      if (int Res = getCommandResult(*this, *PJ.Cmd, PJ.Res, PJ.Error,
+                                     PJ.ExecutionFailed, FailingCommand))
+        FailingCommands.push_back(std::make_pair(Res, FailingCommand));
+    }
+    if (NextToReport == ParallelJobs.size())
+      break;
+    // A job which is waiting for the ones that are done can start now.
+    if (NumRunning == 0)
+      continue;
+
+    std::unique_lock<std::mutex> Guard(Lock);
+    JobFinished.wait(Guard, [&] { return !FinishedJobs.empty(); });
+    for (unsigned Finished : FinishedJobs) {
+      ParallelJob &PJ = ParallelJobs[Finished];
+      PJ.State = ParallelJob::Finished;
+      --NumRunning;
+      if (PJ.Res || PJ.ExecutionFailed)
+        Failures.push_back(std::make_pair(PJ.ExecutionFailed ? 1 : PJ.Res,
+                                          PJ.Cmd));
+    }
+    FinishedJobs.clear();
+  }
+  Pool.wait();
+}
+
 void Compilation::ExecuteJobs(const JobList &Jobs,
                               FailingCommandList &FailingCommands) const {
+#if LLVM_ENABLE_THREADS
+  // The jobs of the cl driver are executed in order, since it stops at the
+  // first failure. The jobs aren't executed concurrently either when their
+  // output is redirected, e.g. to generate crash diagnostics.
+  if (TheDriver.getParallelJobs() > 1 && Jobs.size() > 1 &&
+      !TheDriver.IsCLMode() && Redirects.empty()) {
+    ExecuteJobsInParallel(Jobs, FailingCommands);
+    return;
+  }
+#endif
+
   // According to UNIX standard, driver need to continue compiling all the
   // inputs on the command line even one of them failed.
   // In all but CLMode, execute all the jobs unless the necessary inputs for the
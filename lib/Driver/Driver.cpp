@@ -76,6 +76,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -135,6 +136,10 @@ Driver::Driver(StringRef ClangExecutable, StringRef TargetTriple,
   if (!this->VFS)
     this->VFS = llvm::vfs::getRealFileSystem();
 
+  if (Optional<std::string> CachePath =
+          llvm::sys::Process::GetEnv("CLANG_TOOLCHAIN_CACHE_FILE"))
+    DiscoveryCache = std::make_unique<ToolChainCache>(*CachePath, *this->VFS);
+
   Name = llvm::sys::path::filename(ClangExecutable);
   Dir = llvm::sys::path::parent_path(ClangExecutable);
   InstalledDir = Dir; // Provide a sensible default installed dir.
@@ -196,8 +201,8 @@ InputArgList Driver::ParseArgStrings(ArrayRef<const char *> ArgStrings,
 
   unsigned MissingArgIndex, MissingArgCount;
   InputArgList Args =
-      getOpts().ParseArgs(ArgStrings, MissingArgIndex, MissingArgCount,
-                          IncludedFlagsBitmask, ExcludedFlagsBitmask);
+      parseDriverArgs(ArgStrings, MissingArgIndex, MissingArgCount,
+                      IncludedFlagsBitmask, ExcludedFlagsBitmask);
 
   // Check for missing argument error.
   if (MissingArgCount) {
@@ -933,6 +938,7 @@ bool Driver::loadConfigFile() {
 
 Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   llvm::PrettyStackTraceString CrashInfo("Compilation construction");
+  llvm::TimeTraceScope TimeScope("BuildCompilation", StringRef(""));
 
   // FIXME: Handle environment options which affect driver behavior, somewhere
   // (client?). GCC_EXEC_PREFIX, LPATH, CC_PRINT_OPTIONS.
@@ -1026,6 +1032,10 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // -no-canonical-prefixes is used very early in main.
   Args.ClaimAllArgs(options::OPT_no_canonical_prefixes);
 
+  // -f(no-)integrated-cc1 is also used very early in main.
+  Args.ClaimAllArgs(options::OPT_fintegrated_cc1);
+  Args.ClaimAllArgs(options::OPT_fno_integrated_cc1);
+
   // Ignore -pipe.
   Args.ClaimAllArgs(options::OPT_pipe);
 
@@ -1042,6 +1052,13 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   GenReproducer = Args.hasFlag(options::OPT_gen_reproducer,
                                options::OPT_fno_crash_diagnostics,
                                !!::getenv("FORCE_CLANG_DIAGNOSTICS_CRASH"));
+  if (const Arg *A = Args.getLastArg(options::OPT_fdriver_jobs_EQ)) {
+    StringRef Value = A->getValue();
+    if (Value.getAsInteger(10, ParallelJobs) || ParallelJobs == 0) {
+      Diag(diag::err_drv_invalid_int_value) << A->getAsString(Args) << Value;
+      ParallelJobs = 1;
+    }
+  }
   // FIXME: TargetTriple is used by the target-prefixed calls to as/ld
   // and getToolChain is const.
   if (IsCLMode()) {
@@ -1434,8 +1451,10 @@ void Driver::setUpResponseFiles(Compilation &C, Command &Cmd) {
   // Since commandLineFitsWithinSystemLimits() may underestimate system's
   // capacity if the tool does not support response files, there is a chance/
   // that things will just work without a response file, so we silently just
-  // skip it.
-  if (Cmd.getCreator().getResponseFilesSupport() == Tool::RF_None ||
+  // skip it. In-process cc1 jobs are handed their arguments directly and never
+  // need one.
+  if (Cmd.isInProcess() ||
+      Cmd.getCreator().getResponseFilesSupport() == Tool::RF_None ||
       llvm::sys::commandLineFitsWithinSystemLimits(Cmd.getExecutable(),
                                                    Cmd.getArguments()))
     return;
@@ -3665,6 +3684,16 @@ void Driver::BuildJobs(Compilation &C) const {
                        /*TargetDeviceOffloadKind*/ Action::OFK_None);
   }
 
+  // The cc1 tool relies on process-wide state (llvm::cl options, leaked
+  // memory under -disable-free), so only run it in-process when there is a
+  // single cc1 job in the compilation, and when the jobs aren't executed
+  // concurrently.
+  if (llvm::count_if(C.getJobs(),
+                     [](const Command &J) { return J.isInProcess(); }) > 1 ||
+      (ParallelJobs > 1 && C.getJobs().size() > 1))
+    for (auto &J : C.getJobs())
+      J.disableInProcess();
+
   // If the user passed -Qunused-arguments or there were errors, don't warn
   // about any unused arguments.
   if (Diags.hasErrorOccurred() ||
@@ -4698,6 +4727,7 @@ const ToolChain &Driver::getToolChain(const ArgList &Args,
 
   auto &TC = ToolChains[Target.str()];
   if (!TC) {
+    llvm::TimeTraceScope TimeScope("Create ToolChain", StringRef(Target.str()));
     switch (Target.getOS()) {
     case llvm::Triple::Haiku:
       TC = std::make_unique<toolchains::Haiku>(*this, Target, Args);
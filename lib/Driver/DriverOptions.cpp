@@ -8,9 +8,12 @@
 
 #include "clang/Driver/Options.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Option/Arg.h"
+#include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include <cassert>
+#include <cstring>
 
 using namespace clang::driver;
 using namespace clang::driver::options;
@@ -53,3 +56,91 @@ const llvm::opt::OptTable &clang::driver::getDriverOptTable() {
   }();
   return *Table;
 }
+
+/// Parses the argument at \p Index if it is a -D, -I or -U option, which are
+/// the only options spelled with these letters after a single dash. Since
+/// they are joined or separate options, their spelling is the first two
+/// characters of the argument.
+///
+/// \returns null if the argument is another option, leaving \p Index
+/// unchanged, or if its value is missing, in which case \p Index is past the
+/// end of the arguments.
+static Arg *parseJoinedOrSeparateArg(const OptTable &Opts,
+                                     const InputArgList &Args,
+                                     unsigned &Index, unsigned FlagsToInclude,
+                                     unsigned FlagsToExclude) {
+  const char *Str = Args.getArgString(Index);
+  if (Str[0] != '-')
+    return nullptr;
+  OptSpecifier ID;
+  switch (Str[1]) {
+  case 'D':
+    ID = OPT_D;
+    break;
+  case 'I':
+    // -I- is a flag.
+    if (std::strcmp(Str, "-I-") == 0)
+      return nullptr;
+    ID = OPT_I;
+    break;
+  case 'U':
+    ID = OPT_U;
+    break;
+  default:
+    return nullptr;
+  }
+
+  Option Opt = Opts.getOption(ID);
+  if ((FlagsToInclude && !Opt.hasFlag(FlagsToInclude)) ||
+      Opt.hasFlag(FlagsToExclude))
+    return nullptr;
+
+  llvm::StringRef Spelling(Str, 2);
+  if (Str[2])
+    return new Arg(Opt, Spelling, Index++, Str + 2);
+  Index += 2;
+  if (Index > Args.getNumInputArgStrings() ||
+      Args.getArgString(Index - 1) == nullptr)
+    return nullptr;
+  return new Arg(Opt, Spelling, Index - 2, Args.getArgString(Index - 1));
+}
+
+InputArgList
+clang::driver::parseDriverArgs(llvm::ArrayRef<const char *> ArgArr,
+                               unsigned &MissingArgIndex,
+                               unsigned &MissingArgCount,
+                               unsigned FlagsToInclude,
+                               unsigned FlagsToExclude) {
+  const OptTable &Opts = getDriverOptTable();
+  InputArgList Args(ArgArr.begin(), ArgArr.end());
+  MissingArgIndex = MissingArgCount = 0;
+  unsigned Index = 0, End = ArgArr.size();
+  while (Index < End) {
+    // Ignore nullptrs, they are response file's EOL markers, and empty
+    // arguments, which other options may still take as their value.
+    const char *Str = Args.getArgString(Index);
+    if (Str == nullptr || Str[0] == '\0') {
+      ++Index;
+      continue;
+    }
+
+    unsigned Prev = Index;
+    Arg *A = parseJoinedOrSeparateArg(Opts, Args, Index, FlagsToInclude,
+                                      FlagsToExclude);
+    if (!A && Index == Prev)
+      A = Opts.ParseOneArg(Args, Index, FlagsToInclude, FlagsToExclude);
+    assert(Index > Prev && "Parser failed to consume argument.");
+
+    // Check for missing argument error.
+    if (!A) {
+      assert(Index >= End && "Unexpected parser error.");
+      assert(Index - Prev - 1 && "No missing arguments!");
+      MissingArgIndex = Prev;
+      MissingArgCount = Index - Prev - 1;
+      break;
+    }
+
+    Args.append(A);
+  }
+  return Args;
+}
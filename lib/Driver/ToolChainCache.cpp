@@ -0,0 +1,172 @@
+//===--- ToolChainCache.cpp - Cache of the toolchain discovery ------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Driver/ToolChainCache.h"
+#include "clang/Basic/Version.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+
+using namespace clang::driver;
+using namespace clang;
+
+/// The version of the format of the cache file, which is changed along with
+/// the values written by the discoveries.
+static const int64_t CacheVersion = 1;
+
+static Optional<int64_t> getModTime(llvm::vfs::FileSystem &VFS,
+                                    StringRef Path) {
+  llvm::ErrorOr<llvm::vfs::Status> Status = VFS.status(Path);
+  if (!Status)
+    return None;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Status->getLastModificationTime().time_since_epoch())
+      .count();
+}
+
+void ToolChainCache::Roots::add(StringRef Path) { addPath(Path); }
+
+bool ToolChainCache::Roots::addPath(StringRef Path) {
+  auto It = ModTimes.find(Path);
+  if (It == ModTimes.end())
+    It = ModTimes.try_emplace(Path, getModTime(VFS, Path)).first;
+  return It->second.hasValue();
+}
+
+void ToolChainCache::Roots::addProbe(StringRef Base, StringRef Path) {
+  // The missing parents aren't recorded: the modification time of the deepest
+  // existing one changes when they are created.
+  for (StringRef P = Path; P.size() > Base.size() && P.startswith(Base);
+       P = llvm::sys::path::parent_path(P)) {
+    auto It = ModTimes.find(P);
+    if (It != ModTimes.end() && It->second)
+      return;
+    if (Optional<int64_t> ModTime = getModTime(VFS, P)) {
+      ModTimes[P] = ModTime;
+      return;
+    }
+  }
+  add(Base);
+}
+
+ToolChainCache::ToolChainCache(StringRef Path, llvm::vfs::FileSystem &VFS)
+    : Path(Path), VFS(VFS) {
+  // The cache is an optimization, so a missing or invalid cache file is
+  // replaced without an error.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+  Expected<llvm::json::Value> Contents =
+      llvm::json::parse((*Buffer)->getBuffer());
+  if (!Contents) {
+    llvm::consumeError(Contents.takeError());
+    return;
+  }
+  const llvm::json::Object *Obj = Contents->getAsObject();
+  // The discovery differs between the releases of clang, which therefore
+  // don't share the entries.
+  if (!Obj || Obj->getInteger("version") != CacheVersion ||
+      Obj->getString("clang") != StringRef(getClangFullVersion()))
+    return;
+  const llvm::json::Object *CachedEntries = Obj->getObject("entries");
+  if (!CachedEntries)
+    return;
+
+  for (const auto &KV : *CachedEntries) {
+    const llvm::json::Object *CachedEntry = KV.second.getAsObject();
+    if (!CachedEntry)
+      continue;
+    const llvm::json::Object *Values = CachedEntry->getObject("values");
+    const llvm::json::Object *ModTimes = CachedEntry->getObject("roots");
+    if (!Values || !ModTimes)
+      continue;
+
+    Entry E;
+    E.Values = *Values;
+    bool IsValid = true;
+    for (const auto &Root : *ModTimes) {
+      if (Root.second.getAsNull())
+        E.ModTimes[Root.first] = None;
+      else if (Optional<int64_t> ModTime = Root.second.getAsInteger())
+        E.ModTimes[Root.first] = ModTime;
+      else
+        IsValid = false;
+    }
+    if (IsValid)
+      Entries[KV.first] = std::move(E);
+  }
+}
+
+ToolChainCache::~ToolChainCache() {
+  if (IsDirty)
+    save();
+}
+
+const llvm::json::Object *ToolChainCache::lookup(StringRef Key) {
+  auto It = Entries.find(Key);
+  if (It == Entries.end())
+    return nullptr;
+  Entry &E = It->second;
+  if (!E.IsChecked) {
+    for (const auto &Root : E.ModTimes)
+      if (getModTime(VFS, Root.getKey()) != Root.getValue())
+        return nullptr;
+    E.IsChecked = true;
+  }
+  return &E.Values;
+}
+
+void ToolChainCache::insert(StringRef Key, llvm::json::Object Values,
+                            Roots R) {
+  Entry &E = Entries[Key];
+  E.Values = std::move(Values);
+  E.ModTimes = std::move(R.ModTimes);
+  E.IsChecked = true;
+  IsDirty = true;
+}
+
+void ToolChainCache::save() {
+  llvm::json::Object CachedEntries;
+  for (const auto &E : Entries) {
+    llvm::json::Object ModTimes;
+    for (const auto &Root : E.second.ModTimes) {
+      if (Root.getValue())
+        ModTimes[Root.getKey().str()] = *Root.getValue();
+      else
+        ModTimes[Root.getKey().str()] = nullptr;
+    }
+    CachedEntries[E.getKey().str()] =
+        llvm::json::Object{{"values", llvm::json::Object(E.second.Values)},
+                           {"roots", std::move(ModTimes)}};
+  }
+
+  int FD;
+  SmallString<256> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << llvm::json::Value(llvm::json::Object{
+        {"version", CacheVersion},
+        {"clang", getClangFullVersion()},
+        {"entries", std::move(CachedEntries)}});
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
+}
@@ -2776,6 +2776,9 @@ static void RenderModulesOptions(Compilation &C, const Driver &D,
                      options::OPT_fno_modules_validate_input_files_content,
                      false))
       CmdArgs.push_back("-fvalidate-ast-input-files-content");
+  if (Args.hasFlag(options::OPT_fpch_instantiate_templates,
+                   options::OPT_fno_pch_instantiate_templates, false))
+    CmdArgs.push_back("-fpch-instantiate-templates");
   }
 
   // -fmodule-name specifies the module that is currently being built (or
@@ -2821,6 +2824,7 @@ static void RenderModulesOptions(Compilation &C, const Driver &D,
 
   if (HaveClangModules)
     Args.AddLastArg(CmdArgs, options::OPT_fmodules_user_build_path);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodule_map_cache_EQ);
 
   // Pass through all -fmodules-ignore-macro arguments.
   Args.AddAllArgs(CmdArgs, options::OPT_fmodules_ignore_macro);
@@ -3271,6 +3275,10 @@ static void RenderDebugOptions(const ToolChain &TC, const Driver &D,
     (void)checkDebugInfoOption(A, Args, D, TC);
   if (DebugInfoKind == codegenoptions::LimitedDebugInfo && NeedFullDebug)
     DebugInfoKind = codegenoptions::FullDebugInfo;
+  if (Args.hasFlag(options::OPT_fdebug_type_homing,
+                   options::OPT_fno_debug_type_homing, false) &&
+      DebugInfoKind == codegenoptions::LimitedDebugInfo)
+    CmdArgs.push_back("-fdebug-type-homing");
 
   if (Args.hasFlag(options::OPT_gembed_source, options::OPT_gno_embed_source,
                    false)) {
@@ -3915,6 +3923,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_profile_sample_accurate, false))
     CmdArgs.push_back("-fprofile-sample-accurate");
 
+  if (Args.hasFlag(options::OPT_fprofile_cold_optnone,
+                   options::OPT_fno_profile_cold_optnone, false))
+    CmdArgs.push_back("-fprofile-cold-optnone");
+
   if (!Args.hasFlag(options::OPT_fpreserve_as_comments,
                     options::OPT_fno_preserve_as_comments, true))
     CmdArgs.push_back("-fno-preserve-as-comments");
@@ -4391,6 +4403,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fconstexpr_call_cache_size_EQ)) {
+    CmdArgs.push_back("-fconstexpr-call-cache-size");
+    CmdArgs.push_back(A->getValue());
+  }
+
   if (Args.hasArg(options::OPT_fexperimental_new_constant_interpreter))
     CmdArgs.push_back("-fexperimental-new-constant-interpreter");
 
@@ -4465,6 +4482,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fspell_checking_work_limit_EQ)) {
+    CmdArgs.push_back("-fspell-checking-work-limit");
+    CmdArgs.push_back(A->getValue());
+  }
+
   // Pass -fmessage-length=.
   CmdArgs.push_back("-fmessage-length");
   if (Arg *A = Args.getLastArg(options::OPT_fmessage_length_EQ)) {
@@ -4504,6 +4526,21 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_femulated_tls,
                   options::OPT_fno_emulated_tls);
   Args.AddLastArg(CmdArgs, options::OPT_fkeep_static_consts);
+  Args.AddLastArg(CmdArgs, options::OPT_fhomed_functions_file_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fhomed_functions_home);
+  Args.AddLastArg(CmdArgs, options::OPT_fparallel_codegen_EQ);
+
+  // The other partitions of a temporary object file are temporary too.
+  unsigned ParallelCodeGenPartitions = getParallelCodeGenPartitions(TC, Args);
+  if (ParallelCodeGenPartitions > 1 && Output.isFilename() &&
+      Output.getType() == types::TY_Object &&
+      llvm::any_of(C.getTempFiles(), [&](const char *TempFile) {
+        return StringRef(TempFile) == Output.getFilename();
+      }))
+    for (unsigned I = 1; I != ParallelCodeGenPartitions; ++I)
+      C.addTempFile(
+          Args.MakeArgString(CodeGenOptions::getParallelCodeGenPartitionName(
+              Output.getFilename(), I)));
 
   // AltiVec-like language extensions aren't relevant for assembling.
   if (!isa<PreprocessJobAction>(JA) || Output.getType() != types::TY_PP_Asm)
@@ -4593,6 +4630,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_trace);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_granularity_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_ftemplate_profile_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fheader_cost_report_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fmemory_report_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fcompile_cache_path_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fauto_pch_path_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
   Args.AddLastArg(CmdArgs, options::OPT_malign_double);
 
@@ -4896,6 +4938,23 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_pch_validate_input_files_content, false))
     CmdArgs.push_back("-fvalidate-ast-input-files-content");
 
+  // The same inputs give the same AST files, which are validated by the
+  // content of their input files rather than by their timestamps.
+  if (Args.hasArg(options::OPT_fmodules_deterministic_output)) {
+    CmdArgs.push_back("-fno-pch-timestamp");
+    CmdArgs.push_back("-fmodules-hash-content");
+    CmdArgs.push_back("-fvalidate-ast-input-files-content");
+  }
+
+  for (const Arg *A : Args.filtered(options::OPT_fmodule_file_prefix_map_EQ)) {
+    StringRef Map = A->getValue();
+    if (Map.find('=') == StringRef::npos)
+      D.Diag(diag::err_drv_invalid_argument_to_fmodule_file_prefix_map) << Map;
+    else
+      CmdArgs.push_back(Args.MakeArgString("-fmodule-file-prefix-map=" + Map));
+    A->claim();
+  }
+
   Args.AddLastArg(CmdArgs, options::OPT_fexperimental_new_pass_manager,
                   options::OPT_fno_experimental_new_pass_manager);
 
@@ -5509,6 +5568,16 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     assert(Output.isNothing() && "Invalid output.");
   }
 
+  // The stubs come from the parse which produces the object.
+  if (Args.hasArg(options::OPT_write_interface_stubs) && Output.isFilename() &&
+      (Output.getType() == types::TY_Object ||
+       Output.getType() == types::TY_LTO_BC)) {
+    SmallString<128> StubsFile(Output.getFilename());
+    llvm::sys::path::replace_extension(StubsFile, "ifs");
+    CmdArgs.push_back("-interface-stubs-output");
+    CmdArgs.push_back(Args.MakeArgString(StubsFile));
+  }
+
   addDashXForInput(Args, Input, CmdArgs);
 
   ArrayRef<InputInfo> FrontendInputs = Input;
@@ -5538,6 +5607,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     // fails, so that the main compilation's fallback to cl.exe runs.
     C.addCommand(std::make_unique<ForceSuccessCommand>(JA, *this, Exec,
                                                         CmdArgs, Inputs));
+  } else if (D.CC1Main && !D.CCGenDiagnostics) {
+    // Invoke the CC1 directly in this process
+    C.addCommand(
+        std::make_unique<CC1Command>(JA, *this, Exec, CmdArgs, Inputs));
   } else {
     C.addCommand(std::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
   }
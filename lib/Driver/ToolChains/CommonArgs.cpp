@@ -21,6 +21,7 @@
 #include "Hexagon.h"
 #include "InputInfo.h"
 #include "clang/Basic/CharInfo.h"
+#include "clang/Basic/CodeGenOptions.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/ObjCRuntime.h"
 #include "clang/Basic/Version.h"
@@ -154,6 +155,8 @@ void tools::AddLinkerInputs(const ToolChain &TC, const InputInfoList &Inputs,
   if (!TC.isCrossCompiling())
     addDirectoryList(Args, CmdArgs, "-L", "LIBRARY_PATH");
 
+  unsigned ParallelCodeGenPartitions = getParallelCodeGenPartitions(TC, Args);
+
   for (const auto &II : Inputs) {
     // If the current tool chain refers to an OpenMP or HIP offloading host, we
     // should ignore inputs that refer to OpenMP or HIP offloading devices -
@@ -172,6 +175,14 @@ void tools::AddLinkerInputs(const ToolChain &TC, const InputInfoList &Inputs,
     // Add filenames immediately.
     if (II.isFilename()) {
       CmdArgs.push_back(II.getFilename());
+      // The objects we compiled with -fparallel-codegen= come with the
+      // objects of their other partitions.
+      if (ParallelCodeGenPartitions > 1 && II.getType() == types::TY_Object &&
+          II.getAction() && !isa<InputAction>(II.getAction()))
+        for (unsigned I = 1; I != ParallelCodeGenPartitions; ++I)
+          CmdArgs.push_back(
+              Args.MakeArgString(CodeGenOptions::getParallelCodeGenPartitionName(
+                  II.getFilename(), I)));
       continue;
     }
 
@@ -351,6 +362,22 @@ unsigned tools::getLTOParallelism(const ArgList &Args, const Driver &D) {
   return Parallelism;
 }
 
+unsigned tools::getParallelCodeGenPartitions(const ToolChain &TC,
+                                             const ArgList &Args) {
+  unsigned Partitions = 1;
+  Arg *A = Args.getLastArg(options::OPT_fparallel_codegen_EQ);
+  // Invalid values are diagnosed by -cc1.
+  if (!A || StringRef(A->getValue()).getAsInteger(10, Partitions) ||
+      Partitions <= 1)
+    return 1;
+  // Only the integrated assembler writes the partitions, and the backend
+  // generates the code serially for split DWARF and LTO.
+  if (!TC.useIntegratedAs() || TC.getDriver().isUsingLTO() ||
+      Args.hasArg(options::OPT_gsplit_dwarf, options::OPT_gsplit_dwarf_EQ))
+    return 1;
+  return Partitions;
+}
+
 // CloudABI uses -ffunction-sections and -fdata-sections by default.
 bool tools::isUseSeparateSections(const llvm::Triple &Triple) {
   return Triple.getOS() == llvm::Triple::CloudABI;
@@ -87,6 +87,11 @@ bool isObjCAutoRefCount(const llvm::opt::ArgList &Args);
 
 unsigned getLTOParallelism(const llvm::opt::ArgList &Args, const Driver &D);
 
+/// Get the number of object files that each compile job of \p TC writes with
+/// -fparallel-codegen=, or 1 if the code is generated serially.
+unsigned getParallelCodeGenPartitions(const ToolChain &TC,
+                                      const llvm::opt::ArgList &Args);
+
 bool areOptimizationsEnabled(const llvm::opt::ArgList &Args);
 
 bool isUseSeparateSections(const llvm::Triple &Triple);
@@ -21,7 +21,9 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 #include <system_error>
 
 using namespace clang::driver;
@@ -69,6 +71,8 @@ CudaInstallationDetector::CudaInstallationDetector(
     const Driver &D, const llvm::Triple &HostTriple,
     const llvm::opt::ArgList &Args)
     : D(D) {
+  llvm::TimeTraceScope TimeScope("Detect CudaInstallation",
+                                 StringRef(HostTriple.str()));
   struct Candidate {
     std::string Path;
     bool StrictChecking;
@@ -123,14 +127,37 @@ CudaInstallationDetector::CudaInstallationDetector(
 
   bool NoCudaLib = Args.hasArg(options::OPT_nogpulib);
 
+  // Reuse the installation found by an earlier invocation with the same
+  // candidates, unless one of them changed.
+  ToolChainCache *Cache = D.getToolChainCache();
+  std::string CacheKey;
+  Optional<ToolChainCache::Roots> Roots;
+  if (Cache) {
+    llvm::raw_string_ostream OS(CacheKey);
+    OS << "cuda\n" << HostTriple.str() << '\n' << NoCudaLib << '\n';
+    for (const auto &Candidate : Candidates)
+      OS << Candidate.StrictChecking << ' ' << Candidate.Path << '\n';
+    OS.flush();
+    if (const llvm::json::Object *Values = Cache->lookup(CacheKey))
+      if (loadFromCache(*Values))
+        return;
+    Roots.emplace(D.getVFS());
+  }
+
   for (const auto &Candidate : Candidates) {
     InstallPath = Candidate.Path;
+    if (Roots && !InstallPath.empty())
+      Roots->add(InstallPath);
     if (InstallPath.empty() || !D.getVFS().exists(InstallPath))
       continue;
 
     BinPath = InstallPath + "/bin";
     IncludePath = InstallPath + "/include";
     LibDevicePath = InstallPath + "/nvvm/libdevice";
+    if (Roots) {
+      Roots->addProbe(InstallPath, LibDevicePath);
+      Roots->add(InstallPath + "/version.txt");
+    }
 
     auto &FS = D.getVFS();
     if (!(FS.exists(IncludePath) && FS.exists(BinPath)))
@@ -227,6 +254,54 @@ CudaInstallationDetector::CudaInstallationDetector(
     IsValid = true;
     break;
   }
+
+  if (Cache)
+    Cache->insert(CacheKey, getCacheValues(), std::move(*Roots));
+}
+
+bool CudaInstallationDetector::loadFromCache(const llvm::json::Object &Values) {
+  Optional<bool> Valid = Values.getBoolean("valid");
+  if (!Valid)
+    return false;
+  // The negative results are cached too.
+  if (!*Valid)
+    return true;
+
+  Optional<StringRef> CachedInstallPath = Values.getString("path");
+  Optional<StringRef> CachedVersion = Values.getString("version");
+  Optional<StringRef> CachedLibPath = Values.getString("lib");
+  const llvm::json::Object *CachedLibDeviceMap = Values.getObject("libdevice");
+  if (!CachedInstallPath || !CachedVersion || !CachedLibPath ||
+      !CachedLibDeviceMap)
+    return false;
+  for (const auto &KV : *CachedLibDeviceMap) {
+    Optional<StringRef> FilePath = KV.second.getAsString();
+    if (!FilePath)
+      return false;
+    LibDeviceMap[KV.first] = FilePath->str();
+  }
+
+  InstallPath = CachedInstallPath->str();
+  BinPath = InstallPath + "/bin";
+  IncludePath = InstallPath + "/include";
+  LibDevicePath = InstallPath + "/nvvm/libdevice";
+  LibPath = CachedLibPath->str();
+  Version = CudaStringToVersion(*CachedVersion);
+  IsValid = true;
+  return true;
+}
+
+llvm::json::Object CudaInstallationDetector::getCacheValues() const {
+  if (!IsValid)
+    return llvm::json::Object{{"valid", false}};
+  llvm::json::Object CachedLibDeviceMap;
+  for (const auto &KV : LibDeviceMap)
+    CachedLibDeviceMap[KV.getKey().str()] = KV.getValue();
+  return llvm::json::Object{{"valid", true},
+                            {"path", InstallPath},
+                            {"version", CudaVersionToString(Version)},
+                            {"lib", LibPath},
+                            {"libdevice", std::move(CachedLibDeviceMap)}};
 }
 
 void CudaInstallationDetector::AddCudaIncludeArgs(
@@ -14,6 +14,7 @@
 #include "clang/Driver/Multilib.h"
 #include "clang/Driver/Tool.h"
 #include "clang/Driver/ToolChain.h"
+#include "clang/Driver/ToolChainCache.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/Compiler.h"
@@ -41,6 +42,13 @@ private:
   // CheckCudaVersionSupportsArch.
   mutable llvm::SmallSet<CudaArch, 4> ArchsWithBadVersion;
 
+  /// Restores the installation from the values of a ToolChainCache entry.
+  /// \returns false if they are invalid.
+  bool loadFromCache(const llvm::json::Object &Values);
+
+  /// The values of the ToolChainCache entry of the installation.
+  llvm::json::Object getCacheValues() const;
+
 public:
   CudaInstallationDetector(const Driver &D, const llvm::Triple &HostTriple,
                            const llvm::opt::ArgList &Args);
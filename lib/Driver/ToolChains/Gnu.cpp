@@ -26,6 +26,7 @@
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetParser.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <system_error>
 
@@ -1752,6 +1753,27 @@ static llvm::StringRef getGCCToolchainDir(const ArgList &Args,
 /// This performs all of the autodetection and sets up the various paths.
 /// Once constructed, a GCCInstallationDetector is essentially immutable.
 ///
+/// The key of the ToolChainCache entry of the GCC installation found in
+/// \p Prefixes. The multilibs, which decide whether an installation is usable,
+/// depend on the target flags.
+static std::string getGCCCacheKey(const llvm::Triple &TargetTriple,
+                                  const ArgList &Args,
+                                  ArrayRef<std::string> Prefixes,
+                                  ArrayRef<std::string> ExtraTripleAliases) {
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << "gcc\n" << TargetTriple.str() << '\n';
+  for (const std::string &Prefix : Prefixes)
+    OS << "prefix " << Prefix << '\n';
+  for (const std::string &Alias : ExtraTripleAliases)
+    OS << "alias " << Alias << '\n';
+  for (const Arg *A : Args.filtered(options::OPT_m_Group,
+                                    options::OPT_mlittle_endian,
+                                    options::OPT_mbig_endian))
+    OS << A->getAsString(Args) << '\n';
+  return OS.str();
+}
+
 /// FIXME: We shouldn't need an explicit TargetTriple parameter here, and
 /// should instead pull the target out of the driver. This is currently
 /// necessary because the driver doesn't store the final version of the target
@@ -1759,6 +1781,8 @@ static llvm::StringRef getGCCToolchainDir(const ArgList &Args,
 void Generic_GCC::GCCInstallationDetector::init(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     ArrayRef<std::string> ExtraTripleAliases) {
+  llvm::TimeTraceScope TimeScope("Detect GCCInstallation",
+                                 StringRef(TargetTriple.str()));
   llvm::Triple BiarchVariantTriple = TargetTriple.isArch32Bit()
                                          ? TargetTriple.get64BitArchVariant()
                                          : TargetTriple.get32BitArchVariant();
@@ -1821,33 +1845,120 @@ void Generic_GCC::GCCInstallationDetector::init(
       return;
   }
 
+  Version = GCCVersion::Parse("0.0.0");
+
+  // Reuse the installation found by an earlier invocation with the same
+  // prefixes and flags, unless one of the probed directories changed.
+  ToolChainCache *Cache = D.getToolChainCache();
+  std::string CacheKey;
+  Optional<ToolChainCache::Roots> Roots;
+  if (Cache) {
+    CacheKey =
+        getGCCCacheKey(TargetTriple, Args, Prefixes, ExtraTripleAliases);
+    if (const llvm::json::Object *Values = Cache->lookup(CacheKey))
+      if (loadFromCache(TargetTriple, Args, *Values))
+        return;
+    Roots.emplace(D.getVFS());
+  }
+  ToolChainCache::Roots *ProbedRoots = Roots.getPointer();
+
   // Loop over the various components which exist and select the best GCC
   // installation available. GCC installs are ranked by version number.
-  Version = GCCVersion::Parse("0.0.0");
   for (const std::string &Prefix : Prefixes) {
+    if (ProbedRoots)
+      ProbedRoots->add(Prefix);
     if (!D.getVFS().exists(Prefix))
       continue;
     for (StringRef Suffix : CandidateLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      if (ProbedRoots)
+        ProbedRoots->addProbe(Prefix, LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       // Try to match the exact target triple first.
-      ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, TargetTriple.str());
+      ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, TargetTriple.str(),
+                             /*NeedsBiarchSuffix=*/false, ProbedRoots);
       // Try rest of possible triples.
       for (StringRef Candidate : ExtraTripleAliases) // Try these first.
-        ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate);
+        ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate,
+                               /*NeedsBiarchSuffix=*/false, ProbedRoots);
       for (StringRef Candidate : CandidateTripleAliases)
-        ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate);
+        ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate,
+                               /*NeedsBiarchSuffix=*/false, ProbedRoots);
     }
     for (StringRef Suffix : CandidateBiarchLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      if (ProbedRoots)
+        ProbedRoots->addProbe(Prefix, LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       for (StringRef Candidate : CandidateBiarchTripleAliases)
         ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate,
-                               /*NeedsBiarchSuffix=*/ true);
+                               /*NeedsBiarchSuffix=*/ true, ProbedRoots);
     }
   }
+
+  if (Cache)
+    Cache->insert(CacheKey, getCacheValues(), std::move(*Roots));
+}
+
+bool Generic_GCC::GCCInstallationDetector::loadFromCache(
+    const llvm::Triple &TargetTriple, const ArgList &Args,
+    const llvm::json::Object &Values) {
+  const llvm::json::Array *Candidates = Values.getArray("candidates");
+  if (!Candidates)
+    return false;
+  std::set<std::string> CandidatePaths;
+  for (const llvm::json::Value &Candidate : *Candidates) {
+    if (Optional<StringRef> Path = Candidate.getAsString())
+      CandidatePaths.insert(Path->str());
+    else
+      return false;
+  }
+
+  // The negative results are cached too.
+  Optional<StringRef> InstallPath = Values.getString("path");
+  if (!InstallPath) {
+    CandidateGCCInstallPaths = std::move(CandidatePaths);
+    return true;
+  }
+
+  Optional<StringRef> Triple = Values.getString("triple");
+  Optional<StringRef> ParentLibPath = Values.getString("parent");
+  Optional<StringRef> VersionText = Values.getString("version");
+  Optional<bool> InBiarchLibDir = Values.getBoolean("biarch");
+  if (!Triple || !ParentLibPath || !VersionText || !InBiarchLibDir)
+    return false;
+
+  // The multilibs aren't cached, since they are cheap to find again once the
+  // installation is known.
+  if (!ScanGCCForMultilibs(TargetTriple, Args, *InstallPath, *InBiarchLibDir))
+    return false;
+
+  CandidateGCCInstallPaths = std::move(CandidatePaths);
+  Version = GCCVersion::Parse(*VersionText);
+  GCCTriple.setTriple(*Triple);
+  GCCInstallPath = InstallPath->str();
+  GCCParentLibPath = ParentLibPath->str();
+  IsInBiarchLibDir = *InBiarchLibDir;
+  IsValid = true;
+  return true;
+}
+
+llvm::json::Object
+Generic_GCC::GCCInstallationDetector::getCacheValues() const {
+  llvm::json::Array Candidates;
+  for (const std::string &Candidate : CandidateGCCInstallPaths)
+    Candidates.push_back(Candidate);
+  llvm::json::Object Values{{"candidates", std::move(Candidates)}};
+  if (IsValid) {
+    Values["triple"] = GCCTriple.str();
+    Values["path"] = GCCInstallPath;
+    Values["parent"] = GCCParentLibPath;
+    Values["version"] = Version.Text;
+    Values["biarch"] = IsInBiarchLibDir;
+  }
+  return Values;
 }
 
 void Generic_GCC::GCCInstallationDetector::print(raw_ostream &OS) const {
@@ -2332,7 +2443,7 @@ bool Generic_GCC::GCCInstallationDetector::ScanGCCForMultilibs(
 void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     const std::string &LibDir, StringRef CandidateTriple,
-    bool NeedsBiarchSuffix) {
+    bool NeedsBiarchSuffix, ToolChainCache::Roots *Roots) {
   llvm::Triple::ArchType TargetArch = TargetTriple.getArch();
   // Locations relative to the system lib directory where GCC's triple-specific
   // directories might reside.
@@ -2382,6 +2493,8 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       continue;
 
     StringRef LibSuffix = Suffix.LibSuffix;
+    if (Roots)
+      Roots->addProbe(LibDir, LibDir + "/" + LibSuffix);
     std::error_code EC;
     for (llvm::vfs::directory_iterator
              LI = D.getVFS().dir_begin(LibDir + "/" + LibSuffix, EC),
@@ -2397,11 +2510,16 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       if (CandidateVersion <= Version)
         continue;
 
+      // The installations which are rejected for their multilibs are only
+      // checked again when their directory changes.
+      if (Roots)
+        Roots->add(LI->path());
       if (!ScanGCCForMultilibs(TargetTriple, Args, LI->path(),
                                NeedsBiarchSuffix))
         continue;
 
       Version = CandidateVersion;
+      IsInBiarchLibDir = NeedsBiarchSuffix;
       GCCTriple.setTriple(CandidateTriple);
       // FIXME: We hack together the directory name here instead of
       // using LI to ensure stable path separators across Windows and
@@ -12,6 +12,7 @@
 #include "Cuda.h"
 #include "clang/Driver/Tool.h"
 #include "clang/Driver/ToolChain.h"
+#include "clang/Driver/ToolChainCache.h"
 #include <set>
 
 namespace clang {
@@ -200,6 +201,9 @@ public:
 
     GCCVersion Version;
 
+    /// Whether the installation was found in a biarch library directory.
+    bool IsInBiarchLibDir = false;
+
     // We retain the list of install paths that were considered and rejected in
     // order to print out detailed information in verbose mode.
     std::set<std::string> CandidateGCCInstallPaths;
@@ -258,11 +262,23 @@ public:
                              StringRef Path,
                              bool NeedsBiarchSuffix = false);
 
+    /// \param Roots If not null, the directories which were probed are added
+    /// to it.
     void ScanLibDirForGCCTriple(const llvm::Triple &TargetArch,
                                 const llvm::opt::ArgList &Args,
                                 const std::string &LibDir,
                                 StringRef CandidateTriple,
-                                bool NeedsBiarchSuffix = false);
+                                bool NeedsBiarchSuffix = false,
+                                ToolChainCache::Roots *Roots = nullptr);
+
+    /// Restores the installation from the values of a ToolChainCache entry.
+    /// \returns false if they don't describe a usable installation anymore.
+    bool loadFromCache(const llvm::Triple &TargetTriple,
+                       const llvm::opt::ArgList &Args,
+                       const llvm::json::Object &Values);
+
+    /// The values of the ToolChainCache entry of the installation.
+    llvm::json::Object getCacheValues() const;
 
     bool ScanGentooConfigs(const llvm::Triple &TargetTriple,
                            const llvm::opt::ArgList &Args,
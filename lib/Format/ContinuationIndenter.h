@@ -18,6 +18,7 @@
 #include "Encoding.h"
 #include "FormatToken.h"
 #include "clang/Format/Format.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Regex.h"
 #include <map>
 #include <tuple>
@@ -368,6 +369,25 @@ struct ParenState {
       return NestedBlockInlined;
     return false;
   }
+
+  /// Hashes the members compared by \c operator<.
+  friend llvm::hash_code hash_value(const ParenState &State) {
+    return llvm::hash_combine(
+        llvm::hash_combine(State.Indent, State.LastSpace,
+                           State.NestedBlockIndent, State.FirstLessLess,
+                           State.QuestionColumn, State.ColonPos,
+                           State.StartOfFunctionCall),
+        State.StartOfArraySubscripts, State.CallContinuation,
+        State.VariablePos,
+        unsigned(State.BreakBeforeClosingBrace) |
+            unsigned(State.AvoidBinPacking) << 1 |
+            unsigned(State.BreakBeforeParameter) << 2 |
+            unsigned(State.NoLineBreak) << 3 |
+            unsigned(State.LastOperatorWrapped) << 4 |
+            unsigned(State.ContainsLineBreak) << 5 |
+            unsigned(State.ContainsUnwrappedBuilder) << 6 |
+            unsigned(State.NestedBlockInlined) << 7);
+  }
 };
 
 /// The current state when indenting a unwrapped line.
@@ -444,6 +464,20 @@ struct LineState {
       return false;
     return Stack < Other.Stack;
   }
+
+  /// Hashes the members compared by \c operator<, so that states which are
+  /// equivalent for it have the same hash. The stack is not hashed if
+  /// \p IgnoreStack is \c true, so that the hash is also the same for the
+  /// states compared with \c IgnoreStackForComparison.
+  llvm::hash_code getHash(bool IgnoreStack) const {
+    llvm::hash_code Hash = llvm::hash_combine(
+        NextToken, Column, LineContainsContinuedForLoopSection, NoContinuation,
+        StartOfLineLevel, LowestLevelOnLine, StartOfStringLiteral);
+    if (IgnoreStack)
+      return Hash;
+    return llvm::hash_combine(
+        Hash, llvm::hash_combine_range(Stack.begin(), Stack.end()));
+  }
 };
 
 } // end namespace format
@@ -1331,14 +1331,16 @@ private:
 class Formatter : public TokenAnalyzer {
 public:
   Formatter(const Environment &Env, const FormatStyle &Style,
-            FormattingAttemptStatus *Status)
-      : TokenAnalyzer(Env, Style), Status(Status) {}
+            FormattingAttemptStatus *Status,
+            internal::FragmentBoundaries *Boundaries = nullptr)
+      : TokenAnalyzer(Env, Style), Status(Status), Boundaries(Boundaries) {}
 
   std::pair<tooling::Replacements, unsigned>
   analyze(TokenAnnotator &Annotator,
           SmallVectorImpl<AnnotatedLine *> &AnnotatedLines,
           FormatTokenLexer &Tokens) override {
     tooling::Replacements Result;
+    bool CanSplit = Boundaries && canSplit();
     deriveLocalStyle(AnnotatedLines);
     AffectedRangeMgr.computeAffectedLines(AnnotatedLines);
     for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
@@ -1365,10 +1367,136 @@ public:
     for (const auto &R : Whitespaces.generateReplacements())
       if (Result.add(R))
         return std::make_pair(Result, 0);
+    if (CanSplit)
+      computeFragmentBoundaries(AnnotatedLines, Result);
     return std::make_pair(Result, Penalty);
   }
 
 private:
+  /// Whether the formatting of the code only depends on the code around each
+  /// line, so that the code can be split into fragments.
+  bool canSplit() const {
+    // The lines of the branches of conditionals are formatted in runs of
+    // their own.
+    if (Runs != 1)
+      return false;
+    // The alignment of consecutive lines stops at empty lines, unless they
+    // are removed.
+    if (Style.Language != FormatStyle::LK_Cpp || Style.MaxEmptyLinesToKeep == 0)
+      return false;
+    // These are derived from the whole code.
+    if (Style.DerivePointerAlignment ||
+        Style.Standard == FormatStyle::LS_Auto ||
+        Style.ExperimentalAutoDetectBinPacking ||
+        Encoding != encoding::Encoding_UTF8)
+      return false;
+    // Nested namespaces are indented according to their parents.
+    if (Style.NamespaceIndentation != FormatStyle::NI_None ||
+        Style.IndentPPDirectives != FormatStyle::PPDIS_None ||
+        Env.getFirstStartColumn() != 0 || Env.getNextStartColumn() != 0 ||
+        Env.getLastStartColumn() != 0)
+      return false;
+    StringRef Code = Env.getSourceManager().getBufferData(Env.getFileID());
+    return Code.find('\r') == StringRef::npos;
+  }
+
+  /// Sets \c Boundaries to the lines of \p AnnotatedLines at which a fragment
+  /// can start: the top-level lines after an empty line which are outside of
+  /// the blocks and of the conditionals which can hide code. The lines of
+  /// namespaces are not indented by the parser, so they can be split too.
+  void computeFragmentBoundaries(
+      const SmallVectorImpl<AnnotatedLine *> &AnnotatedLines,
+      const tooling::Replacements &Replaces) {
+    const SourceManager &SM = Env.getSourceManager();
+    // Whether each open brace opens a block, rather than a namespace or an
+    // extern block.
+    SmallVector<bool, 8> OpenBraces;
+    unsigned OpenBlocks = 0;
+    // Whether each open conditional can hide code, which only "#ifndef" with
+    // no "#else" cannot.
+    SmallVector<bool, 4> OpenConditionals;
+    unsigned OpenHidingConditionals = 0;
+    bool Balanced = true;
+    const AnnotatedLine *PreviousLine = nullptr;
+    for (const AnnotatedLine *Line : AnnotatedLines) {
+      const FormatToken *First = Line->First;
+      if (First->is(tok::eof))
+        break;
+      if (Line->Type == LT_Invalid)
+        Balanced = false;
+      if (OpenBlocks == 0 && OpenHidingConditionals == 0 && Line->Level == 0 &&
+          !Line->InPPDirective && First->NewlinesBefore > 1 &&
+          First->isNot(tok::r_brace) &&
+          (!PreviousLine || (!PreviousLine->InPPDirective &&
+                             !PreviousLine->endsWith(tok::l_brace))))
+        Boundaries->Offsets.push_back(Replaces.getShiftedCodePosition(
+            SM.getFileOffset(First->WhitespaceRange.getBegin())));
+
+      if (Line->InPPDirective) {
+        // The braces of macro definitions are not counted.
+        if (First->is(tok::hash) && First->Next &&
+            First->Next->Tok.getIdentifierInfo()) {
+          switch (First->Next->Tok.getIdentifierInfo()->getPPKeywordID()) {
+          case tok::pp_if:
+          case tok::pp_ifdef:
+          case tok::pp_ifndef: {
+            bool Hiding = First->Next->TokenText != "ifndef";
+            OpenConditionals.push_back(Hiding);
+            OpenHidingConditionals += Hiding;
+            break;
+          }
+          case tok::pp_elif:
+          case tok::pp_else:
+            if (!OpenConditionals.empty() && !OpenConditionals.back()) {
+              OpenConditionals.back() = true;
+              ++OpenHidingConditionals;
+            }
+            break;
+          case tok::pp_endif:
+            if (OpenConditionals.empty())
+              Balanced = false;
+            else if (OpenConditionals.pop_back_val())
+              --OpenHidingConditionals;
+            break;
+          default:
+            break;
+          }
+        }
+      } else {
+        bool OpensNamespace =
+            Line->startsWithNamespace() ||
+            (Line->startsWith(tok::kw_extern) && First->Next &&
+             First->Next->isStringLiteral());
+        for (const FormatToken *Tok = First; Tok; Tok = Tok->Next) {
+          if (Tok->is(tok::l_brace)) {
+            OpenBraces.push_back(!OpensNamespace);
+            OpenBlocks += !OpensNamespace;
+            OpensNamespace = false;
+          } else if (Tok->is(tok::r_brace)) {
+            if (OpenBraces.empty())
+              Balanced = false;
+            else if (OpenBraces.pop_back_val())
+              --OpenBlocks;
+          }
+        }
+      }
+      PreviousLine = Line;
+    }
+
+    // The code must not end within a directive, nor within a token which
+    // would go on in the code that follows.
+    bool Complete = true;
+    if (PreviousLine) {
+      const FormatToken *Last = PreviousLine->Last;
+      Complete = !PreviousLine->InPPDirective && Last->isNot(tok::unknown) &&
+                 !(Last->is(tok::comment) && Last->TokenText.startswith("/*") &&
+                   (Last->TokenText.size() < 4 ||
+                    !Last->TokenText.endswith("*/")));
+    }
+    Boundaries->IsFragment = Balanced && Complete && OpenBraces.empty() &&
+                             OpenConditionals.empty();
+  }
+
   static bool inputUsesCRLF(StringRef Text) {
     return Text.count('\r') * 2 > Text.count('\n');
   }
@@ -1442,6 +1570,7 @@ private:
 
   bool BinPackInconclusiveFunctions;
   FormattingAttemptStatus *Status;
+  internal::FragmentBoundaries *Boundaries;
 };
 
 // This class clean up the erroneous/redundant code around the given ranges in
@@ -2377,7 +2506,9 @@ std::pair<tooling::Replacements, unsigned>
 reformat(const FormatStyle &Style, StringRef Code,
          ArrayRef<tooling::Range> Ranges, unsigned FirstStartColumn,
          unsigned NextStartColumn, unsigned LastStartColumn, StringRef FileName,
-         FormattingAttemptStatus *Status) {
+         FormattingAttemptStatus *Status, FragmentBoundaries *Boundaries) {
+  if (Boundaries)
+    *Boundaries = FragmentBoundaries();
   FormatStyle Expanded = expandPresets(Style);
   if (Expanded.DisableFormat)
     return {tooling::Replacements(), 0};
@@ -2387,52 +2518,60 @@ reformat(const FormatStyle &Style, StringRef Code,
     return {tooling::Replacements(), 0};
 
   typedef std::function<std::pair<tooling::Replacements, unsigned>(
-      const Environment &)>
+      const Environment &, AnnotatedCode &)>
       AnalyzerPass;
   SmallVector<AnalyzerPass, 4> Passes;
 
   if (Style.Language == FormatStyle::LK_Cpp) {
     if (Style.FixNamespaceComments)
-      Passes.emplace_back([&](const Environment &Env) {
-        return NamespaceEndCommentsFixer(Env, Expanded).process();
+      Passes.emplace_back([&](const Environment &Env, AnnotatedCode &Lines) {
+        return NamespaceEndCommentsFixer(Env, Expanded).process(&Lines);
       });
 
     if (Style.SortUsingDeclarations)
-      Passes.emplace_back([&](const Environment &Env) {
-        return UsingDeclarationsSorter(Env, Expanded).process();
+      Passes.emplace_back([&](const Environment &Env, AnnotatedCode &Lines) {
+        return UsingDeclarationsSorter(Env, Expanded).process(&Lines);
       });
   }
 
   if (Style.Language == FormatStyle::LK_JavaScript &&
       Style.JavaScriptQuotes != FormatStyle::JSQS_Leave)
-    Passes.emplace_back([&](const Environment &Env) {
-      return JavaScriptRequoter(Env, Expanded).process();
+    Passes.emplace_back([&](const Environment &Env, AnnotatedCode &Lines) {
+      return JavaScriptRequoter(Env, Expanded).process(&Lines);
     });
 
-  Passes.emplace_back([&](const Environment &Env) {
-    return Formatter(Env, Expanded, Status).process();
+  Passes.emplace_back([&](const Environment &Env, AnnotatedCode &Lines) {
+    return Formatter(Env, Expanded, Status, Boundaries).process(&Lines);
   });
 
   auto Env =
       std::make_unique<Environment>(Code, FileName, Ranges, FirstStartColumn,
                                     NextStartColumn, LastStartColumn);
+  // The passes share the lines of the code until one of them changes it.
+  auto Lines = std::make_unique<AnnotatedCode>();
   llvm::Optional<std::string> CurrentCode = None;
   tooling::Replacements Fixes;
   unsigned Penalty = 0;
   for (size_t I = 0, E = Passes.size(); I < E; ++I) {
-    std::pair<tooling::Replacements, unsigned> PassFixes = Passes[I](*Env);
+    std::pair<tooling::Replacements, unsigned> PassFixes =
+        Passes[I](*Env, *Lines);
     auto NewCode = applyAllReplacements(
         CurrentCode ? StringRef(*CurrentCode) : Code, PassFixes.first);
     if (NewCode) {
       Fixes = Fixes.merge(PassFixes.first);
       Penalty += PassFixes.second;
-      if (I + 1 < E) {
+      if (I + 1 < E && !PassFixes.first.empty()) {
         CurrentCode = std::move(*NewCode);
+        // The lines refer to the source manager of the environment.
+        Lines = std::make_unique<AnnotatedCode>();
         Env = std::make_unique<Environment>(
             *CurrentCode, FileName,
             tooling::calculateRangesAfterReplacements(Fixes, Ranges),
             FirstStartColumn, NextStartColumn, LastStartColumn);
       }
+    } else if (Boundaries) {
+      // The boundaries would be those of code without the replacements.
+      *Boundaries = FragmentBoundaries();
     }
   }
 
@@ -2470,6 +2609,158 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
   return Result;
 }
 
+FormattingSession::FormattingSession(const FormatStyle &Style,
+                                     StringRef FileName)
+    : Style(Style), FileName(FileName) {}
+
+tooling::Replacements
+FormattingSession::reformat(StringRef NewCode, ArrayRef<tooling::Range> Ranges,
+                            FormattingAttemptStatus *Status) {
+  if (!HasCode || Boundaries.empty())
+    return reformatAll(NewCode, Ranges, Status);
+
+  // Find the part of the code that changed since the previous version.
+  size_t Common = std::min(Code.size(), NewCode.size());
+  size_t Prefix = 0;
+  while (Prefix < Common && Code[Prefix] == NewCode[Prefix])
+    ++Prefix;
+  size_t Suffix = 0;
+  while (Suffix < Common - Prefix &&
+         Code[Code.size() - Suffix - 1] == NewCode[NewCode.size() - Suffix - 1])
+    ++Suffix;
+
+  // The boundaries before and after the change, in the new code.
+  std::vector<unsigned> Kept;
+  for (unsigned Offset : Boundaries) {
+    if (Offset <= Prefix)
+      Kept.push_back(Offset);
+    else if (Offset >= Code.size() - Suffix)
+      Kept.push_back(Offset + NewCode.size() - Code.size());
+  }
+
+  // Extend the change and the ranges to the fragments they touch.
+  SmallVector<std::pair<size_t, size_t>, 4> Regions;
+  if (Code != NewCode)
+    Regions.push_back({Prefix, NewCode.size() - Suffix});
+  for (const tooling::Range &R : Ranges)
+    Regions.push_back(
+        {std::min<size_t>(R.getOffset(), NewCode.size()),
+         std::min<size_t>(R.getOffset() + R.getLength(), NewCode.size())});
+  llvm::sort(Regions);
+  SmallVector<std::pair<unsigned, unsigned>, 4> Spans;
+  for (const auto &Region : Regions) {
+    auto I = llvm::lower_bound(Kept, Region.first);
+    unsigned Begin = I == Kept.begin() ? 0 : *std::prev(I);
+    auto J = llvm::upper_bound(Kept, Region.second);
+    unsigned End = J == Kept.end() ? NewCode.size() : *J;
+    if (!Spans.empty() && Begin <= Spans.back().second)
+      Spans.back().second = std::max(Spans.back().second, End);
+    else
+      Spans.push_back({Begin, End});
+  }
+  if (Spans.size() == 1 && Spans.front().first == 0 &&
+      Spans.front().second == NewCode.size())
+    return reformatAll(NewCode, Ranges, Status);
+
+  tooling::Replacements Result;
+  std::vector<unsigned> NewBoundaries;
+  // The difference between the lengths of the formatted code and of the code
+  // up to the current span.
+  int Shift = 0;
+  size_t K = 0;
+  for (const auto &Span : Spans) {
+    std::vector<tooling::Range> FragmentRanges;
+    for (const tooling::Range &R : Ranges) {
+      unsigned RangeBegin = R.getOffset();
+      unsigned RangeEnd = R.getOffset() + R.getLength();
+      if (RangeEnd < Span.first || RangeBegin > Span.second)
+        continue;
+      RangeBegin = std::max(RangeBegin, Span.first);
+      RangeEnd = std::min(RangeEnd, Span.second);
+      FragmentRanges.push_back(
+          tooling::Range(RangeBegin - Span.first, RangeEnd - RangeBegin));
+    }
+
+    internal::FragmentBoundaries Fragments;
+    FormattingAttemptStatus FragmentStatus;
+    tooling::Replacements Replaces =
+        internal::reformat(Style, NewCode.slice(Span.first, Span.second),
+                           FragmentRanges,
+                           /*FirstStartColumn=*/0,
+                           /*NextStartColumn=*/0,
+                           /*LastStartColumn=*/0, FileName, &FragmentStatus,
+                           &Fragments)
+            .first;
+    // The edits may have changed the code that follows or precedes the
+    // fragment, e.g. by opening a block or a comment.
+    if (!Fragments.IsFragment ||
+        (Span.first > 0 &&
+         (Fragments.Offsets.empty() || Fragments.Offsets.front() != 0)))
+      return reformatAll(NewCode, Ranges, Status);
+    if (!FragmentStatus.FormatComplete && Status) {
+      Status->FormatComplete = false;
+      Status->Line = FragmentStatus.Line +
+                     NewCode.take_front(Span.first).count('\n');
+    }
+
+    for (; K < Kept.size() && Kept[K] < Span.first; ++K)
+      NewBoundaries.push_back(Kept[K] + Shift);
+    for (unsigned Offset : Fragments.Offsets)
+      if (Span.first + Offset > 0)
+        NewBoundaries.push_back(Span.first + Shift + Offset);
+    for (; K < Kept.size() && Kept[K] < Span.second; ++K)
+      ;
+
+    for (const tooling::Replacement &R : Replaces) {
+      Shift += int(R.getReplacementText().size()) - int(R.getLength());
+      if (auto Err = Result.add(tooling::Replacement(
+              FileName, Span.first + R.getOffset(), R.getLength(),
+              R.getReplacementText()))) {
+        llvm::consumeError(std::move(Err));
+        return reformatAll(NewCode, Ranges, Status);
+      }
+    }
+  }
+  for (; K < Kept.size(); ++K)
+    NewBoundaries.push_back(Kept[K] + Shift);
+
+  Boundaries = std::move(NewBoundaries);
+  setCode(NewCode, Result);
+  return Result;
+}
+
+tooling::Replacements
+FormattingSession::reformatAll(StringRef NewCode,
+                               ArrayRef<tooling::Range> Ranges,
+                               FormattingAttemptStatus *Status) {
+  internal::FragmentBoundaries Fragments;
+  tooling::Replacements Result =
+      internal::reformat(Style, NewCode, Ranges,
+                         /*FirstStartColumn=*/0,
+                         /*NextStartColumn=*/0,
+                         /*LastStartColumn=*/0, FileName, Status, &Fragments)
+          .first;
+  Boundaries.clear();
+  for (unsigned Offset : Fragments.Offsets)
+    if (Offset > 0)
+      Boundaries.push_back(Offset);
+  setCode(NewCode, Result);
+  return Result;
+}
+
+void FormattingSession::setCode(StringRef NewCode,
+                                const tooling::Replacements &Replaces) {
+  HasCode = true;
+  auto Formatted = applyAllReplacements(NewCode, Replaces);
+  if (Formatted) {
+    Code = std::move(*Formatted);
+  } else {
+    llvm::consumeError(Formatted.takeError());
+    Code = NewCode;
+    Boundaries.clear();
+  }
+}
+
 tooling::Replacements fixNamespaceEndComments(const FormatStyle &Style,
                                               StringRef Code,
                                               ArrayRef<tooling::Range> Ranges,
@@ -2568,10 +2859,77 @@ const char *DefaultFormatStyle = "file";
 
 const char *DefaultFallbackStyle = "LLVM";
 
+bool FormatStyleCache::lookupConfigFile(StringRef Directory,
+                                        std::string &ConfigFile) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto It = ConfigFiles.find(Directory);
+  if (It == ConfigFiles.end())
+    return false;
+  ConfigFile = It->second;
+  return true;
+}
+
+void FormatStyleCache::addConfigFile(StringRef Directory,
+                                     StringRef ConfigFile) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  ConfigFiles.try_emplace(Directory, ConfigFile);
+}
+
+bool FormatStyleCache::lookupConfiguration(StringRef ConfigFile,
+                                           FormatStyle &Style,
+                                           std::error_code &EC) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto It = Configurations.find({ConfigFile.str(), Style.Language});
+  if (It == Configurations.end())
+    return false;
+  Style = It->second.first;
+  EC = It->second.second;
+  return true;
+}
+
+void FormatStyleCache::addConfiguration(StringRef ConfigFile,
+                                        const FormatStyle &Style,
+                                        std::error_code EC) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Configurations.emplace(std::make_pair(ConfigFile.str(), Style.Language),
+                         std::make_pair(Style, EC));
+}
+
+// Returns the .clang-format or _clang-format file of Directory, or an empty
+// string if there is none.
+static std::string findConfigFile(llvm::vfs::FileSystem *FS,
+                                  StringRef Directory) {
+  auto Status = FS->status(Directory);
+  if (!Status ||
+      Status->getType() != llvm::sys::fs::file_type::directory_file) {
+    return "";
+  }
+
+  SmallString<128> ConfigFile(Directory);
+
+  llvm::sys::path::append(ConfigFile, ".clang-format");
+  LLVM_DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
+
+  Status = FS->status(ConfigFile.str());
+  bool FoundConfigFile =
+      Status && (Status->getType() == llvm::sys::fs::file_type::regular_file);
+  if (!FoundConfigFile) {
+    // Try _clang-format too, since dotfiles are not commonly used on Windows.
+    ConfigFile = Directory;
+    llvm::sys::path::append(ConfigFile, "_clang-format");
+    LLVM_DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
+    Status = FS->status(ConfigFile.str());
+    FoundConfigFile = Status && (Status->getType() ==
+                                 llvm::sys::fs::file_type::regular_file);
+  }
+  return FoundConfigFile ? ConfigFile.str().str() : "";
+}
+
 llvm::Expected<FormatStyle> getStyle(StringRef StyleName, StringRef FileName,
                                      StringRef FallbackStyleName,
                                      StringRef Code,
-                                     llvm::vfs::FileSystem *FS) {
+                                     llvm::vfs::FileSystem *FS,
+                                     FormatStyleCache *Cache) {
   if (!FS) {
     FS = llvm::vfs::getRealFileSystem().get();
   }
@@ -2602,38 +2960,25 @@ llvm::Expected<FormatStyle> getStyle(StringRef StyleName, StringRef FileName,
 
   for (StringRef Directory = Path; !Directory.empty();
        Directory = llvm::sys::path::parent_path(Directory)) {
-
-    auto Status = FS->status(Directory);
-    if (!Status ||
-        Status->getType() != llvm::sys::fs::file_type::directory_file) {
-      continue;
-    }
-
-    SmallString<128> ConfigFile(Directory);
-
-    llvm::sys::path::append(ConfigFile, ".clang-format");
-    LLVM_DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
-
-    Status = FS->status(ConfigFile.str());
-    bool FoundConfigFile =
-        Status && (Status->getType() == llvm::sys::fs::file_type::regular_file);
-    if (!FoundConfigFile) {
-      // Try _clang-format too, since dotfiles are not commonly used on Windows.
-      ConfigFile = Directory;
-      llvm::sys::path::append(ConfigFile, "_clang-format");
-      LLVM_DEBUG(llvm::dbgs() << "Trying " << ConfigFile << "...\n");
-      Status = FS->status(ConfigFile.str());
-      FoundConfigFile = Status && (Status->getType() ==
-                                   llvm::sys::fs::file_type::regular_file);
+    std::string ConfigFile;
+    if (!Cache || !Cache->lookupConfigFile(Directory, ConfigFile)) {
+      ConfigFile = findConfigFile(FS, Directory);
+      if (Cache)
+        Cache->addConfigFile(Directory, ConfigFile);
     }
 
-    if (FoundConfigFile) {
-      llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Text =
-          FS->getBufferForFile(ConfigFile.str());
-      if (std::error_code EC = Text.getError())
-        return make_string_error(EC.message());
-      if (std::error_code ec =
-              parseConfiguration(Text.get()->getBuffer(), &Style)) {
+    if (!ConfigFile.empty()) {
+      std::error_code ec;
+      if (!Cache || !Cache->lookupConfiguration(ConfigFile, Style, ec)) {
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Text =
+            FS->getBufferForFile(ConfigFile);
+        if (std::error_code EC = Text.getError())
+          return make_string_error(EC.message());
+        ec = parseConfiguration(Text.get()->getBuffer(), &Style);
+        if (Cache)
+          Cache->addConfiguration(ConfigFile, Style, ec);
+      }
+      if (ec) {
         if (ec == ParseError::Unsuitable) {
           if (!UnsuitableConfigFiles.empty())
             UnsuitableConfigFiles.append(", ");
@@ -18,11 +18,23 @@
 #include "BreakableToken.h"
 #include "clang/Tooling/Core/Lookup.h"
 #include <utility>
+#include <vector>
 
 namespace clang {
 namespace format {
 namespace internal {
 
+/// Where the code formatted by \c reformat() can be split into fragments that
+/// are formatted independently of each other, see \c FormattingSession.
+struct FragmentBoundaries {
+  /// The sorted offsets, in the formatted code, of the starts of the leading
+  /// whitespace of the lines at which a fragment can start.
+  std::vector<unsigned> Offsets;
+  /// Whether the whole code can be formatted on its own: its braces and
+  /// preprocessor conditionals are balanced and its last line is complete.
+  bool IsFragment = false;
+};
+
 /// Reformats the given \p Ranges in the code fragment \p Code.
 ///
 /// A fragment of code could conceptually be surrounded by other code that might
@@ -69,11 +81,15 @@ namespace internal {
 ///
 /// If ``Status`` is non-null, its value will be populated with the status of
 /// this formatting attempt. See \c FormattingAttemptStatus.
+///
+/// If ``Boundaries`` is non-null, it is set to the boundaries of the fragments
+/// of the formatted code.
 std::pair<tooling::Replacements, unsigned>
 reformat(const FormatStyle &Style, StringRef Code,
          ArrayRef<tooling::Range> Ranges, unsigned FirstStartColumn,
          unsigned NextStartColumn, unsigned LastStartColumn, StringRef FileName,
-         FormattingAttemptStatus *Status);
+         FormattingAttemptStatus *Status,
+         FragmentBoundaries *Boundaries = nullptr);
 
 } // namespace internal
 } // namespace format
@@ -138,10 +138,6 @@ struct FormatToken {
   /// and thereby e.g. leave an empty line between two function definitions.
   unsigned NewlinesBefore = 0;
 
-  /// Whether there is at least one unescaped newline before the \c
-  /// Token.
-  bool HasUnescapedNewline = false;
-
   /// The range of the whitespace immediately preceding the \c Token.
   SourceRange WhitespaceRange;
 
@@ -158,6 +154,10 @@ struct FormatToken {
   /// token.
   unsigned LastLineColumnWidth = 0;
 
+  /// Whether there is at least one unescaped newline before the \c
+  /// Token.
+  bool HasUnescapedNewline = false;
+
   /// Whether the token text contains newlines (escaped or not).
   bool IsMultiline = false;
 
@@ -170,15 +170,26 @@ struct FormatToken {
   /// before the token.
   bool MustBreakBefore = false;
 
+  /// Set to \c true if this token is an unterminated literal.
+  bool IsUnterminatedLiteral = 0;
+
+  /// \c true if it is allowed to break before this token.
+  bool CanBreakBefore = false;
+
+  /// \c true if this is the ">" of "template<..>".
+  bool ClosesTemplateDeclaration = false;
+
+  /// If \c true, this token has been fully formatted (indented and
+  /// potentially re-formatted inside), and we do not allow further formatting
+  /// changes.
+  bool Finalized = false;
+
   /// The raw text of the token.
   ///
   /// Contains the raw token text without leading whitespace and without leading
   /// escaped newlines.
   StringRef TokenText;
 
-  /// Set to \c true if this token is an unterminated literal.
-  bool IsUnterminatedLiteral = 0;
-
   /// Contains the kind of block if this token is a brace.
   BraceBlockKind BlockKind = BK_Unknown;
 
@@ -187,12 +198,6 @@ struct FormatToken {
   /// The number of spaces that should be inserted before this token.
   unsigned SpacesRequiredBefore = 0;
 
-  /// \c true if it is allowed to break before this token.
-  bool CanBreakBefore = false;
-
-  /// \c true if this is the ">" of "template<..>".
-  bool ClosesTemplateDeclaration = false;
-
   /// Number of parameters, if this is "(", "[" or "<".
   unsigned ParameterCount = 0;
 
@@ -255,6 +260,9 @@ struct FormatToken {
   /// For now calculated only for ObjC.
   unsigned ParameterIndex = 0;
 
+  /// Stores the formatting decision for the token once it was made.
+  FormatDecision Decision = FD_Unformatted;
+
   /// Stores the number of required fake parentheses and the
   /// corresponding operator precedence.
   ///
@@ -270,14 +278,6 @@ struct FormatToken {
   /// \c true if this token ends a binary expression.
   bool EndsBinaryExpression = false;
 
-  /// If this is an operator (or "."/"->") in a sequence of operators
-  /// with the same precedence, contains the 0-based operator index.
-  unsigned OperatorIndex = 0;
-
-  /// If this is an operator (or "."/"->") in a sequence of operators
-  /// with the same precedence, points to the next operator.
-  FormatToken *NextOperator = nullptr;
-
   /// Is this token part of a \c DeclStmt defining multiple variables?
   ///
   /// Only set if \c Type == \c TT_StartOfName.
@@ -288,6 +288,14 @@ struct FormatToken {
   /// Only set to true if \c Type == \c TT_LineComment.
   bool ContinuesLineCommentSection = false;
 
+  /// If this is an operator (or "."/"->") in a sequence of operators
+  /// with the same precedence, contains the 0-based operator index.
+  unsigned OperatorIndex = 0;
+
+  /// If this is an operator (or "."/"->") in a sequence of operators
+  /// with the same precedence, points to the next operator.
+  FormatToken *NextOperator = nullptr;
+
   /// If this is a bracket, this points to the matching one.
   FormatToken *MatchingParen = nullptr;
 
@@ -301,14 +309,6 @@ struct FormatToken {
   /// in it.
   SmallVector<AnnotatedLine *, 1> Children;
 
-  /// Stores the formatting decision for the token once it was made.
-  FormatDecision Decision = FD_Unformatted;
-
-  /// If \c true, this token has been fully formatted (indented and
-  /// potentially re-formatted inside), and we do not allow further formatting
-  /// changes.
-  bool Finalized = false;
-
   bool is(tok::TokenKind Kind) const { return Tok.is(Kind); }
   bool is(TokenType TT) const { return Type == TT; }
   bool is(const IdentifierInfo *II) const {
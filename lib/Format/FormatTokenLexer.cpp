@@ -30,7 +30,9 @@ FormatTokenLexer::FormatTokenLexer(const SourceManager &SourceMgr, FileID ID,
       Style(Style), IdentTable(getFormattingLangOpts(Style)),
       Keywords(IdentTable), Encoding(Encoding), FirstInLineIndex(0),
       FormattingDisabled(false), MacroBlockBeginRegex(Style.MacroBlockBegin),
-      MacroBlockEndRegex(Style.MacroBlockEnd) {
+      MacroBlockEndRegex(Style.MacroBlockEnd),
+      HasMacroBlockRegexes(!Style.MacroBlockBegin.empty() ||
+                           !Style.MacroBlockEnd.empty()) {
   Lex.reset(new Lexer(ID, SourceMgr.getBuffer(ID), SourceMgr,
                       getFormattingLangOpts(Style)));
   Lex->SetKeepWhitespaceMode(true);
@@ -43,6 +45,34 @@ FormatTokenLexer::FormatTokenLexer(const SourceManager &SourceMgr, FileID ID,
     Macros.insert({&IdentTable.get(TypenameMacro), TT_TypenameMacro});
   for (const std::string &NamespaceMacro : Style.NamespaceMacros)
     Macros.insert({&IdentTable.get(NamespaceMacro), TT_NamespaceMacro});
+
+  static const tok::TokenKind JSIdentity[] = {tok::equalequal, tok::equal};
+  static const tok::TokenKind JSNotIdentity[] = {tok::exclaimequal,
+                                                 tok::equal};
+  static const tok::TokenKind JSShiftEqual[] = {tok::greater, tok::greater,
+                                                tok::greaterequal};
+  static const tok::TokenKind JSRightArrow[] = {tok::equal, tok::greater};
+  static const tok::TokenKind JSExponentiation[] = {tok::star, tok::star};
+  static const tok::TokenKind JSExponentiationEqual[] = {tok::star,
+                                                         tok::starequal};
+  static const tok::TokenKind JavaRightLogicalShiftAssign[] = {
+      tok::greater, tok::greater, tok::greaterequal};
+  if (Style.isCSharp()) {
+    TokenMerges.push_back({JSRightArrow, TT_JsFatArrow, tok::unknown});
+  } else if (Style.Language == FormatStyle::LK_JavaScript) {
+    // FIXME: Investigate what token type gives the correct operator priority.
+    TokenMerges.push_back({JSIdentity, TT_BinaryOperator, tok::unknown});
+    TokenMerges.push_back({JSNotIdentity, TT_BinaryOperator, tok::unknown});
+    TokenMerges.push_back({JSShiftEqual, TT_BinaryOperator, tok::unknown});
+    TokenMerges.push_back({JSRightArrow, TT_JsFatArrow, tok::unknown});
+    TokenMerges.push_back(
+        {JSExponentiation, TT_JsExponentiation, tok::unknown});
+    TokenMerges.push_back(
+        {JSExponentiationEqual, TT_JsExponentiationEqual, tok::starequal});
+  } else if (Style.Language == FormatStyle::LK_Java) {
+    TokenMerges.push_back(
+        {JavaRightLogicalShiftAssign, TT_BinaryOperator, tok::unknown});
+  }
 }
 
 ArrayRef<FormatToken *> FormatTokenLexer::lex() {
@@ -82,49 +112,21 @@ void FormatTokenLexer::tryMergePreviousTokens() {
       return;
     if (tryTransformCSharpForEach())
       return;
-    static const tok::TokenKind JSRightArrow[] = {tok::equal, tok::greater};
-    if (tryMergeTokens(JSRightArrow, TT_JsFatArrow))
-      return;
   }
 
   if (tryMergeNSStringLiteral())
     return;
 
-  if (Style.Language == FormatStyle::LK_JavaScript) {
-    static const tok::TokenKind JSIdentity[] = {tok::equalequal, tok::equal};
-    static const tok::TokenKind JSNotIdentity[] = {tok::exclaimequal,
-                                                   tok::equal};
-    static const tok::TokenKind JSShiftEqual[] = {tok::greater, tok::greater,
-                                                  tok::greaterequal};
-    static const tok::TokenKind JSRightArrow[] = {tok::equal, tok::greater};
-    static const tok::TokenKind JSExponentiation[] = {tok::star, tok::star};
-    static const tok::TokenKind JSExponentiationEqual[] = {tok::star,
-                                                           tok::starequal};
+  if (Style.Language == FormatStyle::LK_JavaScript &&
+      tryMergeJSPrivateIdentifier())
+    return;
 
-    // FIXME: Investigate what token type gives the correct operator priority.
-    if (tryMergeTokens(JSIdentity, TT_BinaryOperator))
-      return;
-    if (tryMergeTokens(JSNotIdentity, TT_BinaryOperator))
-      return;
-    if (tryMergeTokens(JSShiftEqual, TT_BinaryOperator))
-      return;
-    if (tryMergeTokens(JSRightArrow, TT_JsFatArrow))
-      return;
-    if (tryMergeTokens(JSExponentiation, TT_JsExponentiation))
-      return;
-    if (tryMergeTokens(JSExponentiationEqual, TT_JsExponentiationEqual)) {
-      Tokens.back()->Tok.setKind(tok::starequal);
+  for (const TokenMerge &Merge : TokenMerges) {
+    if (tryMergeTokens(Merge.Kinds, Merge.Type)) {
+      if (Merge.Kind != tok::unknown)
+        Tokens.back()->Tok.setKind(Merge.Kind);
       return;
     }
-    if (tryMergeJSPrivateIdentifier())
-      return;
-  }
-
-  if (Style.Language == FormatStyle::LK_Java) {
-    static const tok::TokenKind JavaRightLogicalShiftAssign[] = {
-        tok::greater, tok::greater, tok::greaterequal};
-    if (tryMergeTokens(JavaRightLogicalShiftAssign, TT_BinaryOperator))
-      return;
   }
 }
 
@@ -299,7 +301,8 @@ bool FormatTokenLexer::tryMergeLessLess() {
 
 bool FormatTokenLexer::tryMergeTokens(ArrayRef<tok::TokenKind> Kinds,
                                       TokenType NewType) {
-  if (Tokens.size() < Kinds.size())
+  // Most tokens do not end a sequence, so check the last one first.
+  if (Tokens.size() < Kinds.size() || !Tokens.back()->is(Kinds.back()))
     return false;
 
   SmallVectorImpl<FormatToken *>::const_iterator First =
@@ -814,18 +817,27 @@ FormatToken *FormatTokenLexer::getNextToken() {
               tok::pp_define) &&
         it != Macros.end()) {
       FormatTok->Type = it->second;
-    } else if (FormatTok->is(tok::identifier)) {
-      if (MacroBlockBeginRegex.match(Text)) {
-        FormatTok->Type = TT_MacroBlockBegin;
-      } else if (MacroBlockEndRegex.match(Text)) {
-        FormatTok->Type = TT_MacroBlockEnd;
-      }
+    } else if (FormatTok->is(tok::identifier) && HasMacroBlockRegexes) {
+      TokenType Type = getMacroBlockType(FormatTok->Tok.getIdentifierInfo());
+      if (Type != TT_Unknown)
+        FormatTok->Type = Type;
     }
   }
 
   return FormatTok;
 }
 
+TokenType FormatTokenLexer::getMacroBlockType(IdentifierInfo *II) {
+  auto Inserted = MacroBlockTypes.try_emplace(II, TT_Unknown);
+  if (Inserted.second) {
+    if (MacroBlockBeginRegex.match(II->getName()))
+      Inserted.first->second = TT_MacroBlockBegin;
+    else if (MacroBlockEndRegex.match(II->getName()))
+      Inserted.first->second = TT_MacroBlockEnd;
+  }
+  return Inserted.first->second;
+}
+
 void FormatTokenLexer::readRawToken(FormatToken &Tok) {
   Lex->LexFromRawLexer(Tok.Tok);
   Tok.TokenText = StringRef(SourceMgr.getCharacterData(Tok.Tok.getLocation()),
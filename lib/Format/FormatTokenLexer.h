@@ -20,6 +20,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Format/Format.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/Support/Regex.h"
 
@@ -57,6 +58,10 @@ private:
 
   bool tryMergeTokens(ArrayRef<tok::TokenKind> Kinds, TokenType NewType);
 
+  // Returns the type of the macro block which the identifier \p II begins or
+  // ends, or TT_Unknown.
+  TokenType getMacroBlockType(IdentifierInfo *II);
+
   // Returns \c true if \p Tok can only be followed by an operand in JavaScript.
   bool precedesOperand(FormatToken *Tok);
 
@@ -108,10 +113,25 @@ private:
 
   llvm::SmallMapVector<IdentifierInfo *, TokenType, 8> Macros;
 
+  // A sequence of tokens which is merged into one token of type \c Type, and
+  // of kind \c Kind unless that is tok::unknown.
+  struct TokenMerge {
+    ArrayRef<tok::TokenKind> Kinds;
+    TokenType Type;
+    tok::TokenKind Kind;
+  };
+  // The sequences of tokens merged in the language of the style, which
+  // cannot overlap each other, or the other merges.
+  SmallVector<TokenMerge, 8> TokenMerges;
+
   bool FormattingDisabled;
 
   llvm::Regex MacroBlockBeginRegex;
   llvm::Regex MacroBlockEndRegex;
+  bool HasMacroBlockRegexes;
+  // The results of getMacroBlockType(), as matching the regexes for each
+  // identifier is costly.
+  llvm::DenseMap<IdentifierInfo *, TokenType> MacroBlockTypes;
 
   void readRawToken(FormatToken &Tok);
 
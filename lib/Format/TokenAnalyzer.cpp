@@ -62,15 +62,46 @@ TokenAnalyzer::TokenAnalyzer(const Environment &Env, const FormatStyle &Style)
                           << "\n");
 }
 
-std::pair<tooling::Replacements, unsigned> TokenAnalyzer::process() {
+AnnotatedCode::~AnnotatedCode() {
+  for (AnnotatedLine *Line : Lines)
+    delete Line;
+}
+
+std::pair<tooling::Replacements, unsigned>
+TokenAnalyzer::process(AnnotatedCode *Code) {
+  if (Code && Code->Tokens) {
+    LLVM_DEBUG(llvm::dbgs() << "Reusing the annotated lines...\n");
+    Runs = 1;
+    for (size_t I = 0, E = Code->AllTokens.size(); I != E; ++I)
+      Code->AllTokens[I]->Finalized = Code->Finalized[I];
+    TokenAnnotator Annotator(Style, Code->Tokens->getKeywords());
+    return analyze(Annotator, Code->Lines, *Code->Tokens);
+  }
+
   tooling::Replacements Result;
-  FormatTokenLexer Tokens(Env.getSourceManager(), Env.getFileID(),
-                          Env.getFirstStartColumn(), Style, Encoding);
+  const FormatStyle *LexerStyle = &Style;
+  if (Code) {
+    Code->Style = Style;
+    LexerStyle = &Code->Style;
+  }
+  auto TokensPtr = std::make_unique<FormatTokenLexer>(
+      Env.getSourceManager(), Env.getFileID(), Env.getFirstStartColumn(),
+      *LexerStyle, Encoding);
+  FormatTokenLexer &Tokens = *TokensPtr;
 
+  ArrayRef<FormatToken *> AllTokens = Tokens.lex();
   UnwrappedLineParser Parser(Style, Tokens.getKeywords(),
-                             Env.getFirstStartColumn(), Tokens.lex(), *this);
+                             Env.getFirstStartColumn(), AllTokens, *this);
   Parser.parse();
   assert(UnwrappedLines.rbegin()->empty());
+  Runs = UnwrappedLines.size() - 1;
+  bool ShareLines = Code && Runs == 1;
+  if (ShareLines) {
+    Code->AllTokens = AllTokens;
+    Code->Finalized.clear();
+    for (const FormatToken *Tok : AllTokens)
+      Code->Finalized.push_back(Tok->Finalized);
+  }
   unsigned Penalty = 0;
   for (unsigned Run = 0, RunE = UnwrappedLines.size(); Run + 1 != RunE; ++Run) {
     LLVM_DEBUG(llvm::dbgs() << "Run " << Run << "...\n");
@@ -93,8 +124,13 @@ std::pair<tooling::Replacements, unsigned> TokenAnalyzer::process() {
         llvm::dbgs() << I->toString() << "\n";
       }
     });
-    for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
-      delete AnnotatedLines[i];
+    if (ShareLines) {
+      Code->Tokens = std::move(TokensPtr);
+      Code->Lines = std::move(AnnotatedLines);
+    } else {
+      for (unsigned i = 0, e = AnnotatedLines.size(); i != e; ++i) {
+        delete AnnotatedLines[i];
+      }
     }
 
     Penalty += RunResult.second;
@@ -77,11 +77,44 @@ private:
   unsigned LastStartColumn;
 };
 
+/// The tokens and the annotated lines of the code of an \c Environment, which
+/// the \c TokenAnalyzer passes over that code can share as long as none of
+/// them changes it, instead of lexing, parsing and annotating it again.
+///
+/// Only code which is formatted in a single run is shared: the runs of the
+/// branches of conditionals share their tokens, which annotating a run
+/// modifies. The analyzers mark the tokens they have handled as finalized,
+/// which is undone before the lines are reused.
+class AnnotatedCode {
+public:
+  AnnotatedCode() = default;
+  AnnotatedCode(const AnnotatedCode &) = delete;
+  AnnotatedCode &operator=(const AnnotatedCode &) = delete;
+  ~AnnotatedCode();
+
+private:
+  friend class TokenAnalyzer;
+
+  // The style the code was lexed with, which the lexer refers to.
+  FormatStyle Style;
+  // Owns the tokens of the lines.
+  std::unique_ptr<FormatTokenLexer> Tokens;
+  SmallVector<AnnotatedLine *, 16> Lines;
+  // All the tokens, and whether each was finalized before the analysis.
+  ArrayRef<FormatToken *> AllTokens;
+  std::vector<bool> Finalized;
+};
+
 class TokenAnalyzer : public UnwrappedLineConsumer {
 public:
   TokenAnalyzer(const Environment &Env, const FormatStyle &Style);
 
-  std::pair<tooling::Replacements, unsigned> process();
+  /// Analyzes the code of the environment. If \p Code is given, the lines
+  /// it holds are reused if there are any, and the lines of the code are
+  /// stored into it otherwise. All the analyzers which share \p Code must
+  /// use the same environment and style.
+  std::pair<tooling::Replacements, unsigned>
+  process(AnnotatedCode *Code = nullptr);
 
 protected:
   virtual std::pair<tooling::Replacements, unsigned>
@@ -99,6 +132,9 @@ protected:
   // AffectedRangeMgr stores ranges to be fixed.
   AffectedRangeManager AffectedRangeMgr;
   SmallVector<SmallVector<UnwrappedLine, 16>, 2> UnwrappedLines;
+  // The number of runs the code is formatted in. Unlike the size of
+  // UnwrappedLines, this is also set when the lines are reused.
+  unsigned Runs = 0;
   encoding::Encoding Encoding;
 };
 
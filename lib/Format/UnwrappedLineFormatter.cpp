@@ -9,6 +9,7 @@
 #include "UnwrappedLineFormatter.h"
 #include "NamespaceEndCommentsFixer.h"
 #include "WhitespaceManager.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/Debug.h"
 #include <queue>
 
@@ -898,12 +899,6 @@ public:
   }
 
 private:
-  struct CompareLineStatePointers {
-    bool operator()(LineState *obj1, LineState *obj2) const {
-      return *obj1 < *obj2;
-    }
-  };
-
   /// A pair of <penalty, count> that is used to prioritize the BFS on.
   ///
   /// In case of equal penalties, we want to prefer states that were inserted
@@ -919,8 +914,35 @@ private:
     LineState State;
     bool NewLine;
     StateNode *Previous;
+    /// The hash of \c State, ignoring its stack if it is compared without.
+    unsigned Hash = 0;
+
+    void updateHash() {
+      Hash = State.getHash(State.IgnoreStackForComparison);
+    }
   };
 
+  /// Hashes and compares the \c StateNodes by their \c States, so that the
+  /// states already examined are found without comparing whole stacks.
+  struct SeenStateInfo {
+    static StateNode *getEmptyKey() {
+      return llvm::DenseMapInfo<StateNode *>::getEmptyKey();
+    }
+    static StateNode *getTombstoneKey() {
+      return llvm::DenseMapInfo<StateNode *>::getTombstoneKey();
+    }
+    static unsigned getHashValue(const StateNode *Node) { return Node->Hash; }
+    static bool isEqual(const StateNode *LHS, const StateNode *RHS) {
+      if (LHS == RHS)
+        return true;
+      if (LHS == getEmptyKey() || LHS == getTombstoneKey() ||
+          RHS == getEmptyKey() || RHS == getTombstoneKey())
+        return false;
+      return !(LHS->State < RHS->State) && !(RHS->State < LHS->State);
+    }
+  };
+  typedef llvm::DenseSet<StateNode *, SeenStateInfo> SeenSet;
+
   /// An item in the prioritized BFS search queue. The \c StateNode's
   /// \c State has the given \c OrderedPenalty.
   typedef std::pair<OrderedPenalty, StateNode *> QueueItem;
@@ -939,7 +961,9 @@ private:
   ///
   /// If \p DryRun is \c false, directly applies the changes.
   unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun) {
-    std::set<LineState *, CompareLineStatePointers> Seen;
+    // The states already examined, which have a penalty at most that of the
+    // states in the queue.
+    SeenSet Seen;
 
     // Increasing count of \c StateNode items we have created. This is used to
     // create a deterministic order independent of the container.
@@ -949,10 +973,12 @@ private:
     // Insert start element into queue.
     StateNode *Node =
         new (Allocator.Allocate()) StateNode(InitialState, false, nullptr);
+    Node->updateHash();
     Queue.push(QueueItem(OrderedPenalty(0, Count), Node));
     ++Count;
 
     unsigned Penalty = 0;
+    bool IgnoringStacks = false;
 
     // While not empty, take first element and follow edges.
     while (!Queue.empty()) {
@@ -967,18 +993,34 @@ private:
 
       // Cut off the analysis of certain solutions if the analysis gets too
       // complex. See description of IgnoreStackForComparison.
-      if (Count > 50000)
+      if (Count > 50000 && !Node->State.IgnoreStackForComparison) {
+        if (!IgnoringStacks) {
+          // From now on, the states are compared without their stacks, so the
+          // states already examined are hashed without them too.
+          IgnoringStacks = true;
+          std::vector<StateNode *> Examined(Seen.begin(), Seen.end());
+          Seen.clear();
+          for (StateNode *ExaminedNode : Examined) {
+            ExaminedNode->Hash =
+                ExaminedNode->State.getHash(/*IgnoreStack=*/true);
+            Seen.insert(ExaminedNode);
+          }
+        }
         Node->State.IgnoreStackForComparison = true;
+        Node->updateHash();
+      }
 
-      if (!Seen.insert(&Node->State).second)
+      if (!Seen.insert(Node).second)
         // State already examined with lower penalty.
         continue;
 
       FormatDecision LastFormat = Node->State.NextToken->Decision;
       if (LastFormat == FD_Unformatted || LastFormat == FD_Continue)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, Seen, &Count,
+                            &Queue);
       if (LastFormat == FD_Unformatted || LastFormat == FD_Break)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, Seen, &Count,
+                            &Queue);
     }
 
     if (Queue.empty()) {
@@ -1003,20 +1045,33 @@ private:
   ///
   /// Assume the current state is \p PreviousNode and has been reached with a
   /// penalty of \p Penalty. Insert a line break if \p NewLine is \c true.
+  ///
+  /// The state is not queued if it is in \p Seen, i.e. it was already
+  /// examined with a penalty at most \p Penalty, as it would be skipped when
+  /// taken from the queue.
   void addNextStateToQueue(unsigned Penalty, StateNode *PreviousNode,
-                           bool NewLine, unsigned *Count, QueueType *Queue) {
+                           bool NewLine, const SeenSet &Seen, unsigned *Count,
+                           QueueType *Queue) {
     if (NewLine && !Indenter->canBreak(PreviousNode->State))
       return;
     if (!NewLine && Indenter->mustBreak(PreviousNode->State))
       return;
 
-    StateNode *Node = new (Allocator.Allocate())
-        StateNode(PreviousNode->State, NewLine, PreviousNode);
-    if (!formatChildren(Node->State, NewLine, /*DryRun=*/true, Penalty))
+    StateNode Next(PreviousNode->State, NewLine, PreviousNode);
+    if (!formatChildren(Next.State, NewLine, /*DryRun=*/true, Penalty))
       return;
 
-    Penalty += Indenter->addTokenToState(Node->State, NewLine, true);
+    Penalty += Indenter->addTokenToState(Next.State, NewLine, true);
+
+    // The count is still increased, so that the order of the queue and the
+    // cut-off of the analysis are the same as if the state was queued.
+    Next.updateHash();
+    if (Seen.count(&Next)) {
+      ++(*Count);
+      return;
+    }
 
+    StateNode *Node = new (Allocator.Allocate()) StateNode(std::move(Next));
     Queue->push(QueueItem(OrderedPenalty(Penalty, *Count), Node));
     ++(*Count);
   }
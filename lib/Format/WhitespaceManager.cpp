@@ -19,9 +19,12 @@ namespace format {
 
 bool WhitespaceManager::Change::IsBeforeInFile::operator()(
     const Change &C1, const Change &C2) const {
-  return SourceMgr.isBeforeInTranslationUnit(
-      C1.OriginalWhitespaceRange.getBegin(),
-      C2.OriginalWhitespaceRange.getBegin());
+  // All the changes are in the file being formatted, where the locations are
+  // ordered like their offsets.
+  assert(SourceMgr.getFileID(C1.OriginalWhitespaceRange.getBegin()) ==
+         SourceMgr.getFileID(C2.OriginalWhitespaceRange.getBegin()));
+  return C1.OriginalWhitespaceRange.getBegin() <
+         C2.OriginalWhitespaceRange.getBegin();
 }
 
 WhitespaceManager::Change::Change(const FormatToken &Tok,
@@ -746,6 +749,8 @@ void WhitespaceManager::alignEscapedNewlines(unsigned Start, unsigned End,
 }
 
 void WhitespaceManager::generateChanges() {
+  // The text of each replacement is built in the same buffer.
+  std::string ReplacementText;
   for (unsigned i = 0, e = Changes.size(); i != e; ++i) {
     const Change &C = Changes[i];
     if (i > 0) {
@@ -754,7 +759,7 @@ void WhitespaceManager::generateChanges() {
              "Generating two replacements for the same location");
     }
     if (C.CreateReplacement) {
-      std::string ReplacementText = C.PreviousLinePostfix;
+      ReplacementText.assign(C.PreviousLinePostfix);
       if (C.ContinuesPPDirective)
         appendEscapedNewlineText(ReplacementText, C.NewlinesBefore,
                                  C.PreviousEndOfTokenColumn,
@@ -771,14 +776,27 @@ void WhitespaceManager::generateChanges() {
 }
 
 void WhitespaceManager::storeReplacement(SourceRange Range, StringRef Text) {
-  unsigned WhitespaceLength = SourceMgr.getFileOffset(Range.getEnd()) -
-                              SourceMgr.getFileOffset(Range.getBegin());
+  std::pair<FileID, unsigned> Begin =
+      SourceMgr.getDecomposedLoc(Range.getBegin());
+  unsigned WhitespaceLength =
+      SourceMgr.getFileOffset(Range.getEnd()) - Begin.second;
   // Don't create a replacement, if it does not change anything.
   if (StringRef(SourceMgr.getCharacterData(Range.getBegin()),
                 WhitespaceLength) == Text)
     return;
-  auto Err = Replaces.add(tooling::Replacement(
-      SourceMgr, CharSourceRange::getCharRange(Range), Text));
+  // Look up the name of the file once, rather than for each replacement.
+  if (Begin.first != ReplacementsFile) {
+    ReplacementsFile = Begin.first;
+    const FileEntry *Entry = SourceMgr.getFileEntryForID(Begin.first);
+    ReplacementsFilePath = Entry ? Entry->getName() : StringRef();
+  }
+  tooling::Replacement Replacement =
+      ReplacementsFilePath.empty()
+          ? tooling::Replacement(SourceMgr,
+                                 CharSourceRange::getCharRange(Range), Text)
+          : tooling::Replacement(ReplacementsFilePath, Begin.second,
+                                 WhitespaceLength, Text);
+  auto Err = Replaces.add(Replacement);
   // FIXME: better error handling. For now, just print an error message in the
   // release version.
   if (Err) {
@@ -209,6 +209,9 @@ private:
   SmallVector<Change, 16> Changes;
   const SourceManager &SourceMgr;
   tooling::Replacements Replaces;
+  // The file of the last replacement, and its name.
+  FileID ReplacementsFile;
+  StringRef ReplacementsFilePath;
   const FormatStyle &Style;
   bool UseCRLF;
 };
@@ -14,6 +14,7 @@
 #include "clang/AST/AST.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/JSONNodeDumper.h"
 #include "clang/AST/PrettyPrinter.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/AST/RecursiveASTVisitor.h"
@@ -36,10 +37,12 @@ namespace {
     enum Kind { DumpFull, Dump, Print, None };
     ASTPrinter(std::unique_ptr<raw_ostream> Out, Kind K,
                ASTDumpOutputFormat Format, StringRef FilterString,
-               bool DumpLookups = false)
+               bool DumpLookups = false, bool NoLocations = false,
+               bool NoImplicit = false)
         : Out(Out ? *Out : llvm::outs()), OwnedOut(std::move(Out)),
           OutputKind(K), OutputFormat(Format), FilterString(FilterString),
-          DumpLookups(DumpLookups) {}
+          DumpLookups(DumpLookups), NoLocations(NoLocations),
+          NoImplicit(NoImplicit) {}
 
     void HandleTranslationUnit(ASTContext &Context) override {
       TranslationUnitDecl *D = Context.getTranslationUnitDecl();
@@ -91,6 +94,16 @@ namespace {
       } else if (OutputKind == Print) {
         PrintingPolicy Policy(D->getASTContext().getLangOpts());
         D->print(Out, Policy, /*Indentation=*/0, /*PrintInstantiation=*/true);
+      } else if (OutputKind != None && OutputFormat != ADOF_Default &&
+                 (NoLocations || NoImplicit)) {
+        // Decl::dump has no parameters for the filters of the JSON dumps.
+        ASTContext &Ctx = D->getASTContext();
+        JSONDumper P(Out, Ctx.getSourceManager(), Ctx, Ctx.getPrintingPolicy(),
+                     &Ctx.getCommentCommandTraits(),
+                     /*IndentSize=*/OutputFormat == ADOF_JSON ? 2 : 0);
+        P.doGetNodeDelegate().setDumpLocations(!NoLocations);
+        P.setSkipImplicitDecls(NoImplicit);
+        P.Visit(D);
       } else if (OutputKind != None)
         D->dump(Out, OutputKind == DumpFull, OutputFormat);
     }
@@ -111,6 +124,12 @@ namespace {
     /// results will be output with a format determined by OutputKind. This is
     /// incompatible with OutputKind == Print.
     bool DumpLookups;
+
+    /// Whether JSON dumps omit the source locations.
+    bool NoLocations;
+
+    /// Whether JSON dumps omit the implicit declarations.
+    bool NoImplicit;
   };
 
   class ASTDeclNodeLister : public ASTConsumer,
@@ -146,13 +165,15 @@ clang::CreateASTPrinter(std::unique_ptr<raw_ostream> Out,
 std::unique_ptr<ASTConsumer>
 clang::CreateASTDumper(std::unique_ptr<raw_ostream> Out, StringRef FilterString,
                        bool DumpDecls, bool Deserialize, bool DumpLookups,
-                       ASTDumpOutputFormat Format) {
+                       ASTDumpOutputFormat Format, bool NoLocations,
+                       bool NoImplicit) {
   assert((DumpDecls || Deserialize || DumpLookups) && "nothing to dump");
   return std::make_unique<ASTPrinter>(std::move(Out),
                                        Deserialize ? ASTPrinter::DumpFull :
                                        DumpDecls ? ASTPrinter::Dump :
                                        ASTPrinter::None, Format,
-                                       FilterString, DumpLookups);
+                                       FilterString, DumpLookups, NoLocations,
+                                       NoImplicit);
 }
 
 std::unique_ptr<ASTConsumer> clang::CreateASTDeclNodeLister() {
@@ -43,9 +43,12 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendOptions.h"
 #include "clang/Frontend/MultiplexConsumer.h"
+#include "clang/Frontend/PreambleCache.h"
 #include "clang/Frontend/PrecompiledPreamble.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Lex/DirectoryListingCache.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/PPCallbacks.h"
@@ -233,6 +236,11 @@ void ASTUnit::clearFileLevelDecls() {
 /// preamble.
 const unsigned DefaultPreambleRebuildInterval = 5;
 
+static bool isCancelled(const CompilerInvocation &CI) {
+  const std::atomic<bool> *Flag = CI.getFrontendOpts().CancellationFlag;
+  return Flag && Flag->load(std::memory_order_relaxed);
+}
+
 /// Tracks the number of ASTUnit objects that are currently active.
 ///
 /// Used for debugging purposes only.
@@ -1130,6 +1138,16 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   llvm::CrashRecoveryContextCleanupRegistrar<CompilerInstance>
     CICleanup(Clang.get());
 
+  // Keep the listings of the search directories and the controlling macros of
+  // the headers from one parse to the next.
+  if (!DirListingCache)
+    DirListingCache = std::make_unique<DirectoryListingCache>();
+  CCInvocation->getPreprocessorOpts().HeaderSearchDirectoryListingCache =
+      DirListingCache.get();
+  if (!IncludeGuards)
+    IncludeGuards = std::make_unique<IncludeGuardCache>();
+  CCInvocation->getPreprocessorOpts().SharedIncludeGuards = IncludeGuards.get();
+
   Clang->setInvocation(CCInvocation);
   OriginalSourceFile = Clang->getFrontendOpts().Inputs[0].getFile();
 
@@ -1166,6 +1184,7 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
 
   SourceMgr = new SourceManager(getDiagnostics(), *FileMgr,
                                 UserFilesAreVolatile);
+  SourceMgr->setFileBufferBudget(Clang->getFrontendOpts().SourceBufferBudget);
   if (!OverrideMainBuffer) {
     checkAndRemoveNonDriverDiags(StoredDiagnostics);
     TopLevelDeclsInPreamble.clear();
@@ -1212,6 +1231,11 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     goto error;
   }
 
+  // A cancelled parse stops after any top-level declaration, so the AST is
+  // incomplete.
+  if (isCancelled(*Invocation))
+    goto error;
+
   transferASTDataFromCompilerInstance(*Clang);
 
   Act->EndSourceFile();
@@ -1341,6 +1365,44 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     }
   }
 
+  // Another unit may have built the same preamble already.
+  std::string SharedPreambleKey;
+  if (SharedPreambles) {
+    SharedPreambleKey = PreambleCache::getKey(
+        PreambleInvocationIn, MainFilePath,
+        SkipFunctionBodies == SkipFunctionBodiesScope::Preamble);
+    if (Optional<PreambleCache::Entry> Shared =
+            SharedPreambles->lookup(SharedPreambleKey, PreambleInvocationIn,
+                                    MainFileBuffer.get(), Bounds, VFS.get())) {
+      Preamble = std::move(Shared->Preamble);
+      PreambleRebuildCountdown = 1;
+      PreambleSrcLocCache.clear();
+
+      getDiagnostics().Reset();
+      ProcessWarningOptions(getDiagnostics(),
+                            PreambleInvocationIn.getDiagnosticOpts());
+      NumWarningsInPreamble = Shared->NumWarnings;
+      getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+
+      // The diagnostics in the preamble of the file which built it are in
+      // the preamble of this one.
+      for (StandaloneDiagnostic &D : Shared->Diagnostics)
+        if (D.Filename == Shared->MainFilePath)
+          D.Filename = MainFilePath;
+      checkAndRemoveNonDriverDiags(StoredDiagnostics);
+      PreambleDiagnostics = std::move(Shared->Diagnostics);
+
+      TopLevelDecls.clear();
+      TopLevelDeclsInPreamble = std::move(Shared->TopLevelDecls);
+      PreambleTopLevelHashValue = Shared->TopLevelHashValue;
+      if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+        CompletionCacheTopLevelHashValue = 0;
+        PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+      }
+      return MainFileBuffer;
+    }
+  }
+
   // If the preamble rebuild counter > 1, it's because we previously
   // failed to build a preamble and we're not yet ready to try
   // again. Decrement the counter and return a failure.
@@ -1383,8 +1445,14 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
         PreviousSkipFunctionBodies;
 
     if (NewPreamble) {
-      Preamble = std::move(*NewPreamble);
+      Preamble =
+          std::make_shared<PrecompiledPreamble>(std::move(*NewPreamble));
       PreambleRebuildCountdown = 1;
+    } else if (isCancelled(PreambleInvocationIn)) {
+      // The preamble was not emitted because the parse was cancelled, which
+      // says nothing about the next attempt.
+      PreambleRebuildCountdown = 1;
+      return nullptr;
     } else {
       switch (static_cast<BuildPreambleError>(NewPreamble.getError().value())) {
       case BuildPreambleError::CouldntCreateTempFile:
@@ -1415,6 +1483,17 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   StoredDiagnostics = std::move(NewPreambleDiags);
   PreambleDiagnostics = std::move(NewPreambleDiagsStandalone);
 
+  if (SharedPreambles) {
+    PreambleCache::Entry Shared;
+    Shared.Preamble = Preamble;
+    Shared.MainFilePath = MainFilePath;
+    Shared.TopLevelDecls = TopLevelDeclsInPreamble;
+    Shared.TopLevelHashValue = PreambleTopLevelHashValue;
+    Shared.NumWarnings = NumWarningsInPreamble;
+    Shared.Diagnostics = PreambleDiagnostics;
+    SharedPreambles->insert(SharedPreambleKey, std::move(Shared));
+  }
+
   // If the hash of top-level entities differs from the hash of the top-level
   // entities the last time we rebuilt the preamble, clear out the completion
   // cache.
@@ -1696,7 +1775,7 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromCompilerInvocation(
     bool OnlyLocalDecls, CaptureDiagsKind CaptureDiagnostics,
     unsigned PrecompilePreambleAfterNParses, TranslationUnitKind TUKind,
     bool CacheCodeCompletionResults, bool IncludeBriefCommentsInCodeCompletion,
-    bool UserFilesAreVolatile) {
+    bool UserFilesAreVolatile, std::shared_ptr<PreambleCache> SharedPreambles) {
   // Create the AST unit.
   std::unique_ptr<ASTUnit> AST(new ASTUnit(false));
   ConfigureDiags(Diags, *AST, CaptureDiagnostics);
@@ -1711,6 +1790,7 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromCompilerInvocation(
   AST->FileSystemOpts = FileMgr->getFileSystemOpts();
   AST->FileMgr = FileMgr;
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->SharedPreambles = std::move(SharedPreambles);
 
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<ASTUnit>
@@ -1738,7 +1818,9 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     bool SingleFileParse, bool UserFilesAreVolatile, bool ForSerialization,
     bool RetainExcludedConditionalBlocks,
     llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST,
-    IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS) {
+    IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
+    const std::atomic<bool> *CancellationFlag,
+    std::shared_ptr<PreambleCache> SharedPreambles) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
@@ -1771,6 +1853,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
 
   CI->getFrontendOpts().SkipFunctionBodies =
       SkipFunctionBodies == SkipFunctionBodiesScope::PreambleAndMainFile;
+  CI->getFrontendOpts().CancellationFlag = CancellationFlag;
 
   if (ModuleFormat)
     CI->getHeaderSearchOpts().ModuleFormat = ModuleFormat.getValue();
@@ -1797,6 +1880,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
   AST->Invocation = CI;
   AST->SkipFunctionBodies = SkipFunctionBodies;
+  AST->SharedPreambles = std::move(SharedPreambles);
   if (ForSerialization)
     AST->WriterData.reset(new ASTWriterData(*AST->ModuleCache));
   // Zero out now to ease cleanup during crash recovery.
@@ -1807,9 +1891,11 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   llvm::CrashRecoveryContextCleanupRegistrar<ASTUnit>
     ASTUnitCleanup(AST.get());
 
-  if (AST->LoadFromCompilerInvocation(std::move(PCHContainerOps),
-                                      PrecompilePreambleAfterNParses,
-                                      VFS)) {
+  bool Failed = AST->LoadFromCompilerInvocation(
+      std::move(PCHContainerOps), PrecompilePreambleAfterNParses, VFS);
+  // The flag is only used for this load.
+  AST->setCancellationFlag(nullptr);
+  if (Failed) {
     // Some error occurred, if caller wants to examine diagnostics, pass it the
     // ASTUnit.
     if (ErrAST) {
@@ -1822,6 +1908,11 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   return AST.release();
 }
 
+void ASTUnit::setCancellationFlag(const std::atomic<bool> *Flag) {
+  if (Invocation)
+    Invocation->getFrontendOpts().CancellationFlag = Flag;
+}
+
 bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
                       ArrayRef<RemappedFile> RemappedFiles,
                       IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS) {
@@ -2129,8 +2220,11 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
     return;
   }
 
+  // The results from Sema were filtered already, but the cached ones were
+  // not.
+  unsigned NumAllResults = filterResults(AllResults.data(), AllResults.size());
   Next.ProcessCodeCompleteResults(S, Context, AllResults.data(),
-                                  AllResults.size());
+                                  NumAllResults);
 }
 
 void ASTUnit::CodeComplete(
@@ -2162,6 +2256,8 @@ void ASTUnit::CodeComplete(
   CodeCompleteOpts.IncludeBriefComments = IncludeBriefComments;
   CodeCompleteOpts.LoadExternal = Consumer.loadExternal();
   CodeCompleteOpts.IncludeFixIts = Consumer.includeFixIts();
+  CodeCompleteOpts.ResultFilter = std::string(Consumer.getResultFilter());
+  CodeCompleteOpts.ResultLimit = Consumer.getResultLimit();
 
   assert(IncludeBriefComments == this->IncludeBriefCommentsInCodeCompletion);
 
@@ -0,0 +1,346 @@
+//===--- AutoPCH.cpp - Precompiled preambles shared by compilations -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/AutoPCH.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/PreambleCache.h"
+#include "clang/Frontend/PrecompiledPreamble.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+
+using namespace clang;
+
+/// The version of the format of the dependency files, which is part of the
+/// keys.
+static const int64_t AutoPCHVersion = 1;
+
+/// \returns the modification time of \p Status, as it is recorded in the
+/// dependency files: in seconds for the files, as given by FileEntry, and in
+/// nanoseconds for the directories, whose sizes usually don't change when a
+/// file is created in them.
+static int64_t getModTime(const llvm::vfs::Status &Status) {
+  if (Status.isDirectory())
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Status.getLastModificationTime().time_since_epoch())
+        .count();
+  return llvm::sys::toTimeT(Status.getLastModificationTime());
+}
+
+static bool canUseAutoPCH(const CompilerInvocation &Invocation) {
+  const FrontendOptions &FEOpts = Invocation.getFrontendOpts();
+  switch (FEOpts.ProgramAction) {
+  case frontend::EmitAssembly:
+  case frontend::EmitBC:
+  case frontend::EmitCodeGenOnly:
+  case frontend::EmitLLVM:
+  case frontend::EmitLLVMOnly:
+  case frontend::EmitObj:
+  case frontend::ParseSyntaxOnly:
+    break;
+  default:
+    return false;
+  }
+  if (FEOpts.Inputs.size() != 1 || !FEOpts.Inputs[0].isFile())
+    return false;
+  InputKind Kind = FEOpts.Inputs[0].getKind();
+  if (Kind.getFormat() != InputKind::Source || Kind.isPreprocessed() ||
+      Kind.getLanguage() == Language::LLVM_IR ||
+      Kind.getLanguage() == Language::Asm)
+    return false;
+  // The secondary outputs would leave out the declarations of the preamble.
+  if (!FEOpts.ASTOutputFile.empty() || !FEOpts.IndexRecordPath.empty() ||
+      !FEOpts.InterfaceStubsOutputFile.empty() || !FEOpts.ASTMergeFiles.empty())
+    return false;
+
+  // The compilations which already load a PCH keep it, and the implicit
+  // includes would be parsed both in the preamble and in the compilation.
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  if (!PPOpts.ImplicitPCHInclude.empty() ||
+      PPOpts.PrecompiledPreambleBytes.first != 0 || !PPOpts.Includes.empty() ||
+      !PPOpts.MacroIncludes.empty() || !PPOpts.RemappedFiles.empty() ||
+      !PPOpts.RemappedFileBuffers.empty())
+    return false;
+
+  if (Invocation.getLangOpts()->Modules)
+    return false;
+
+  // The headers of the preamble aren't entered again by the compilation.
+  const DependencyOutputOptions &DepOpts = Invocation.getDependencyOutputOpts();
+  if (DepOpts.ShowHeaderIncludes || !DepOpts.HeaderIncludeOutputFile.empty() ||
+      DepOpts.ShowIncludesDest != ShowIncludesDestination::None ||
+      !DepOpts.DOTOutputFile.empty())
+    return false;
+
+  return !Invocation.getDiagnosticOpts().VerifyDiagnostics;
+}
+
+namespace {
+
+/// Records the files which were entered while building a preamble and the
+/// directories in which the headers are looked for, with their sizes and
+/// modification times.
+class PreambleFilesRecorder : public PreambleCallbacks {
+public:
+  /// \p OutputFile is the output of the compilation.
+  explicit PreambleFilesRecorder(StringRef OutputFile)
+      : OutputDir(llvm::sys::path::parent_path(OutputFile)) {
+    if (OutputDir.empty())
+      OutputDir = ".";
+  }
+
+  void AfterExecute(CompilerInstance &CI) override {
+    SourceManager &SM = CI.getSourceManager();
+    const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+    for (auto It = SM.fileinfo_begin(), End = SM.fileinfo_end(); It != End;
+         ++It) {
+      const FileEntry *File = It->first;
+      if (File != MainFile)
+        record(File->getName(), File->getSize(), File->getModificationTime());
+    }
+
+    // Creating a header in a directory which is searched before the one of
+    // an included header changes the modification time of the directory. The
+    // directory of the output isn't recorded, since the other compilations
+    // write their outputs there too.
+    FileManager &FM = CI.getFileManager();
+    llvm::vfs::FileSystem &VFS = FM.getVirtualFileSystem();
+    const DirectoryEntry *OutputDirEntry = nullptr;
+    if (auto Dir = FM.getDirectory(OutputDir))
+      OutputDirEntry = *Dir;
+    HeaderSearch &HS = CI.getPreprocessor().getHeaderSearchInfo();
+    for (auto It = HS.search_dir_begin(), End = HS.search_dir_end(); It != End;
+         ++It) {
+      const DirectoryEntry *Dir = It->getDir();
+      if (!Dir || Dir == OutputDirEntry)
+        continue;
+      llvm::ErrorOr<llvm::vfs::Status> Status = VFS.status(Dir->getName());
+      if (Status)
+        record(Dir->getName(), Status->getSize(), getModTime(*Status));
+    }
+  }
+
+  llvm::json::Object Files;
+
+private:
+  std::string OutputDir;
+
+  void record(StringRef Path, uint64_t Size, int64_t ModTime) {
+    Files[Path] = llvm::json::Object{{"size", static_cast<int64_t>(Size)},
+                                     {"mtime", ModTime}};
+  }
+};
+
+} // end anonymous namespace
+
+/// \returns whether the files and directories which were recorded in the
+/// dependency file \p DepsPath, written along with a preamble, are unchanged
+/// in \p VFS. \p IsUsable is set to whether the preamble was written, i.e. whether it
+/// could be built without diagnostics.
+static bool isUpToDate(StringRef DepsPath, llvm::vfs::FileSystem &VFS,
+                       bool &IsUsable) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(DepsPath);
+  if (!Buffer)
+    return false;
+  Expected<llvm::json::Value> Contents =
+      llvm::json::parse((*Buffer)->getBuffer());
+  if (!Contents) {
+    llvm::consumeError(Contents.takeError());
+    return false;
+  }
+  const llvm::json::Object *Obj = Contents->getAsObject();
+  if (!Obj)
+    return false;
+  Optional<bool> Usable = Obj->getBoolean("usable");
+  const llvm::json::Object *Files = Obj->getObject("files");
+  if (!Usable || !Files)
+    return false;
+
+  for (const auto &KV : *Files) {
+    const llvm::json::Object *File = KV.second.getAsObject();
+    if (!File)
+      return false;
+    llvm::ErrorOr<llvm::vfs::Status> Status = VFS.status(KV.first.str());
+    if (!Status ||
+        File->getInteger("size") != static_cast<int64_t>(Status->getSize()) ||
+        File->getInteger("mtime") != getModTime(*Status))
+      return false;
+  }
+  IsUsable = *Usable;
+  return true;
+}
+
+/// Writes \p Path with \p Write through a temporary file, which is renamed
+/// so that the concurrent compilations never read a partial file.
+static bool writeAtomically(StringRef Path,
+                            llvm::function_ref<bool(raw_ostream &)> Write) {
+  int FD;
+  SmallString<256> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return false;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    bool Written = Write(OS);
+    OS.close();
+    if (!Written || OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
+/// Builds the preamble of \p MainFile and writes it to \p PCHPath, unless
+/// it emits diagnostics, along with the dependency file \p DepsPath.
+///
+/// \returns whether the preamble was written.
+static bool buildPreamble(CompilerInstance &Clang,
+                          const llvm::MemoryBuffer &MainFile,
+                          PreambleBounds Bounds, StringRef PCHPath,
+                          StringRef DepsPath) {
+  StringRef MainFilePath = Clang.getFrontendOpts().Inputs[0].getFile();
+  Clang.getDiagnostics().Report(diag::remark_auto_pch_build)
+      << MainFilePath << PCHPath;
+
+  // The preamble is only a PCH, which doesn't write the outputs of the
+  // compilation.
+  CompilerInvocation Invocation(Clang.getInvocation());
+  Invocation.getDependencyOutputOpts() = DependencyOutputOptions();
+
+  // The diagnostics of the preamble are dropped, since the compilations
+  // which use it wouldn't print them. The compilations parse the preambles
+  // with diagnostics instead.
+  IntrusiveRefCntPtr<DiagnosticsEngine> PreambleDiags = new DiagnosticsEngine(
+      new DiagnosticIDs, &Invocation.getDiagnosticOpts(),
+      new DiagnosticConsumer);
+  PreambleFilesRecorder Recorder(Clang.getFrontendOpts().OutputFile);
+  llvm::ErrorOr<PrecompiledPreamble> Preamble = PrecompiledPreamble::Build(
+      Invocation, &MainFile, Bounds, *PreambleDiags,
+      llvm::vfs::getRealFileSystem(), Clang.getPCHContainerOperations(),
+      /*StoreInMemory=*/true, Recorder);
+  // Nothing was parsed, so the failure may not depend on the files.
+  if (Recorder.Files.empty())
+    return false;
+
+  bool IsUsable = Preamble && !PreambleDiags->hasErrorOccurred() &&
+                  PreambleDiags->getNumWarnings() == 0;
+  if (IsUsable && !writeAtomically(PCHPath, [&](raw_ostream &OS) {
+        return Preamble->writePCH(OS);
+      }))
+    return false;
+
+  // The dependency file of a preamble which can't be used is written too, so
+  // that the next compilations don't build it again while its headers are
+  // unchanged.
+  writeAtomically(DepsPath, [&](raw_ostream &OS) {
+    OS << llvm::json::Value(llvm::json::Object{
+        {"usable", IsUsable}, {"files", std::move(Recorder.Files)}});
+    return true;
+  });
+  return IsUsable;
+}
+
+bool clang::useAutoPCH(CompilerInstance &Clang) {
+  CompilerInvocation &Invocation = Clang.getInvocation();
+  if (!canUseAutoPCH(Invocation))
+    return false;
+
+  DiagnosticsEngine &Diags = Clang.getDiagnostics();
+  IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS =
+      createVFSFromCompilerInvocation(Invocation, Diags);
+  StringRef MainFilePath = Invocation.getFrontendOpts().Inputs[0].getFile();
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> MainFile =
+      VFS->getBufferForFile(MainFilePath);
+  if (!MainFile)
+    return false;
+  PreambleBounds Bounds =
+      ComputePreambleBounds(*Invocation.getLangOpts(), MainFile->get(), 0);
+  if (Bounds.Size == 0)
+    return false;
+
+  // The relative paths of the headers depend on the working directory.
+  SmallString<256> WorkingDir;
+  if (llvm::sys::fs::current_path(WorkingDir))
+    return false;
+  llvm::MD5 Hash;
+  Hash.update(getClangFullVersion());
+  Hash.update(llvm::utostr(AutoPCHVersion));
+  Hash.update(WorkingDir);
+  Hash.update(PreambleCache::getKey(Invocation, MainFilePath,
+                                    /*SkipFunctionBodies=*/false));
+  Hash.update((*MainFile)->getBuffer().take_front(Bounds.Size));
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  std::string Key = Result.digest().str();
+
+  StringRef Dir = Invocation.getFrontendOpts().AutoPCHPath;
+  if (llvm::sys::fs::create_directories(Dir))
+    return false;
+  SmallString<256> PCHPath(Dir);
+  llvm::sys::path::append(PCHPath, Key + ".pch");
+  SmallString<256> DepsPath(Dir);
+  llvm::sys::path::append(DepsPath, Key + ".deps");
+
+  bool IsUsable = false;
+  while (!isUpToDate(DepsPath, *VFS, IsUsable)) {
+    llvm::LockFileManager Locked(PCHPath);
+    switch (Locked) {
+    case llvm::LockFileManager::LFS_Error:
+      // The preamble can't be shared, e.g. because the directory isn't
+      // writable.
+      return false;
+
+    case llvm::LockFileManager::LFS_Owned:
+      // The preamble may have been built while the lock was acquired.
+      if (isUpToDate(DepsPath, *VFS, IsUsable))
+        break;
+      IsUsable = buildPreamble(Clang, **MainFile, Bounds, PCHPath, DepsPath);
+      break;
+
+    case llvm::LockFileManager::LFS_Shared:
+      // Another compilation is building the preamble: wait for it, then
+      // check its dependency file again.
+      if (Locked.waitForUnlock() == llvm::LockFileManager::Res_Timeout)
+        Locked.unsafeRemoveLockFile();
+      continue;
+    }
+    break;
+  }
+  if (!IsUsable) {
+    Diags.Report(diag::remark_auto_pch_unusable) << MainFilePath;
+    return false;
+  }
+
+  PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  PPOpts.ImplicitPCHInclude = PCHPath.str();
+  PPOpts.PrecompiledPreambleBytes.first = Bounds.Size;
+  PPOpts.PrecompiledPreambleBytes.second = Bounds.PreambleEndsAtStartOfLine;
+  // The headers were checked along with the dependency file.
+  PPOpts.DisablePCHValidation = true;
+  return true;
+}
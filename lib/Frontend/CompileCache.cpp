@@ -0,0 +1,532 @@
+//===--- CompileCache.cpp - Cache of the compilation results --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompileCache.h"
+#include "clang/Basic/Version.h"
+#include "clang/Driver/Options.h"
+#include "clang/Frontend/ChainedDiagnosticConsumer.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/MacroInfo.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace clang::compile_cache;
+
+/// The version of the format of the cache, which is part of the keys.
+static const int64_t CacheVersion = 1;
+
+/// The number of results of a compilation which are kept in its manifest.
+static const size_t MaxResultsPerManifest = 8;
+
+namespace clang {
+namespace compile_cache {
+
+/// A file system which records the files which were read or looked for.
+class TrackingFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+  /// The states are ordered, since a file which was found may be read later.
+  enum FileState { Missing, Found, Read };
+
+  explicit TrackingFileSystem(IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override {
+    llvm::ErrorOr<llvm::vfs::Status> Result = ProxyFileSystem::status(Path);
+    record(Path, Result ? Found : Missing);
+    return Result;
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> Result =
+        ProxyFileSystem::openFileForRead(Path);
+    record(Path, Result ? Read : Missing);
+    return Result;
+  }
+
+  llvm::vfs::directory_iterator dir_begin(const Twine &Dir,
+                                          std::error_code &EC) override {
+    // The contents of the directories aren't recorded.
+    IsComplete = false;
+    return ProxyFileSystem::dir_begin(Dir, EC);
+  }
+
+  const llvm::StringMap<FileState> &getFiles() const { return Files; }
+
+  /// \returns whether the files are enough to check that the inputs of the
+  /// compilation are unchanged.
+  bool isComplete() const { return IsComplete; }
+
+private:
+  void record(const Twine &Path, FileState State) {
+    FileState &Recorded = Files.try_emplace(Path.str(), State).first->second;
+    Recorded = std::max(Recorded, State);
+  }
+
+  llvm::StringMap<FileState> Files;
+  bool IsComplete = true;
+};
+
+/// Notices the expansions of the macros whose values differ between the runs
+/// of the same compilation.
+class UncacheableMacroCollector : public DependencyCollector {
+public:
+  void attachToPreprocessor(Preprocessor &PP) override {
+    PP.addPPCallbacks(std::make_unique<Callbacks>(*this));
+  }
+
+  bool isCacheable() const { return IsCacheable; }
+
+private:
+  class Callbacks : public PPCallbacks {
+  public:
+    explicit Callbacks(UncacheableMacroCollector &Collector)
+        : Collector(Collector) {}
+
+    void MacroExpands(const Token &MacroNameTok, const MacroDefinition &MD,
+                      SourceRange Range, const MacroArgs *Args) override {
+      const MacroInfo *MI = MD.getMacroInfo();
+      const IdentifierInfo *II = MacroNameTok.getIdentifierInfo();
+      if (MI && MI->isBuiltinMacro() && II &&
+          (II->isStr("__DATE__") || II->isStr("__TIME__") ||
+           II->isStr("__TIMESTAMP__")))
+        Collector.IsCacheable = false;
+    }
+
+  private:
+    UncacheableMacroCollector &Collector;
+  };
+
+  bool IsCacheable = true;
+};
+
+/// Prints the diagnostics into a string, which is stored with the result.
+class DiagnosticRecorder : public DiagnosticConsumer {
+public:
+  explicit DiagnosticRecorder(DiagnosticOptions *DiagOpts)
+      : OS(Text), Printer(OS, DiagOpts) {}
+
+  void BeginSourceFile(const LangOptions &LangOpts,
+                       const Preprocessor *PP) override {
+    Printer.BeginSourceFile(LangOpts, PP);
+  }
+
+  void EndSourceFile() override { Printer.EndSourceFile(); }
+
+  void HandleDiagnostic(DiagnosticsEngine::Level Level,
+                        const Diagnostic &Info) override {
+    DiagnosticConsumer::HandleDiagnostic(Level, Info);
+    Printer.HandleDiagnostic(Level, Info);
+  }
+
+  StringRef getText() { return OS.str(); }
+
+private:
+  std::string Text;
+  llvm::raw_string_ostream OS;
+  TextDiagnosticPrinter Printer;
+};
+
+} // namespace compile_cache
+} // namespace clang
+
+/// \returns whether all of the outputs of the compilation \p Invocation are
+/// stored in the cache, and all of its inputs are read through the file
+/// manager.
+static bool isCacheable(const CompilerInvocation &Invocation) {
+  const FrontendOptions &FEOpts = Invocation.getFrontendOpts();
+  switch (FEOpts.ProgramAction) {
+  case frontend::EmitAssembly:
+  case frontend::EmitBC:
+  case frontend::EmitLLVM:
+  case frontend::EmitObj:
+    break;
+  default:
+    return false;
+  }
+  if (FEOpts.Inputs.size() != 1 || FEOpts.OutputFile.empty() ||
+      FEOpts.OutputFile == "-" || FEOpts.ShowHelp || FEOpts.ShowVersion ||
+      FEOpts.ShowStats || FEOpts.ShowTimers || FEOpts.TimeTrace ||
+      !FEOpts.StatsFile.empty() || !FEOpts.TemplateProfileFile.empty() ||
+      !FEOpts.HeaderCostReportFile.empty() ||
+      !FEOpts.MemoryReportFile.empty() ||
+      !FEOpts.Plugins.empty() || !FEOpts.AddPluginActions.empty() ||
+      !FEOpts.ASTOutputFile.empty() || !FEOpts.IndexRecordPath.empty() ||
+      !FEOpts.InterfaceStubsOutputFile.empty())
+    return false;
+
+  // The headers of the automatic preambles aren't read by the compilation,
+  // which therefore can't tell whether they changed.
+  if (!FEOpts.AutoPCHPath.empty())
+    return false;
+
+  // The modules are built into the module cache.
+  const LangOptions &LangOpts = *Invocation.getLangOpts();
+  if (LangOpts.Modules)
+    return false;
+
+  const CodeGenOptions &CodeGenOpts = Invocation.getCodeGenOpts();
+  if (!CodeGenOpts.SplitDwarfFile.empty() ||
+      !CodeGenOpts.OptRecordFile.empty() || CodeGenOpts.EmitGcovNotes ||
+      !CodeGenOpts.SampleProfileFile.empty() ||
+      !CodeGenOpts.ProfileInstrumentUsePath.empty() ||
+      !CodeGenOpts.ProfileRemappingFile.empty() ||
+      !CodeGenOpts.ThinLTOIndexFile.empty())
+    return false;
+
+  const DependencyOutputOptions &DepOpts = Invocation.getDependencyOutputOpts();
+  if (DepOpts.OutputFile == "-" ||
+      (!DepOpts.OutputFile.empty() && DepOpts.Targets.empty()) ||
+      DepOpts.ShowHeaderIncludes || !DepOpts.HeaderIncludeOutputFile.empty() ||
+      DepOpts.ShowIncludesDest != ShowIncludesDestination::None ||
+      !DepOpts.DOTOutputFile.empty() ||
+      !DepOpts.ModuleDependencyOutputDir.empty())
+    return false;
+
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+  if (!DiagOpts.DiagnosticLogFile.empty() ||
+      !DiagOpts.DiagnosticSerializationFile.empty())
+    return false;
+
+  // The overlays are read before the file manager is created.
+  return Invocation.getHeaderSearchOpts().VFSOverlayFiles.empty();
+}
+
+static std::string hashContents(StringRef Contents) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return std::string(Result.digest().str());
+}
+
+static Optional<std::string> hashFile(llvm::vfs::FileSystem &FS,
+                                      StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      FS.getBufferForFile(Path, /*FileSize=*/-1,
+                          /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return None;
+  return hashContents((*Buffer)->getBuffer());
+}
+
+/// \returns the key of the compilation whose cc1 arguments are \p Argv, in
+/// the working directory \p WorkingDir.
+static std::string getKey(ArrayRef<const char *> Argv, StringRef WorkingDir) {
+  unsigned MissingArgIndex, MissingArgCount;
+  llvm::opt::InputArgList Args =
+      driver::parseDriverArgs(Argv, MissingArgIndex, MissingArgCount,
+                              driver::options::CC1Option);
+
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << CacheVersion << '\0' << getClangFullVersion() << '\0' << WorkingDir
+     << '\0';
+  for (const llvm::opt::Arg *A : Args) {
+    // The outputs are copied from the cache, so their paths don't change the
+    // results.
+    const llvm::opt::Option &O = A->getOption();
+    if (O.matches(driver::options::OPT_o) ||
+        O.matches(driver::options::OPT_dependency_file) ||
+        O.matches(driver::options::OPT_fcompile_cache_path_EQ))
+      continue;
+    llvm::opt::ArgStringList Rendered;
+    A->render(Args, Rendered);
+    for (const char *Value : Rendered)
+      OS << Value << '\0';
+  }
+  return hashContents(OS.str());
+}
+
+/// Writes \p Contents into a temporary file, which is renamed to \p Path so
+/// that the concurrent compilations never read a partial file.
+static bool writeAtomically(StringRef Path, StringRef Contents) {
+  int FD;
+  SmallString<256> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return false;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
+/// \returns whether the files of the entry \p Entry of a manifest are
+/// unchanged in \p FS. \p Hashes holds the hashes of the files which were
+/// already read for the other entries.
+static bool isUpToDate(const llvm::json::Object &Entry,
+                       llvm::vfs::FileSystem &FS,
+                       llvm::StringMap<Optional<std::string>> &Hashes) {
+  const llvm::json::Object *Read = Entry.getObject("read");
+  const llvm::json::Array *Found = Entry.getArray("found");
+  const llvm::json::Array *Missing = Entry.getArray("missing");
+  if (!Read || !Found || !Missing)
+    return false;
+
+  // Check the files which are only stat'ed before reading the others.
+  for (const llvm::json::Value &Path : *Found) {
+    Optional<StringRef> P = Path.getAsString();
+    if (!P || !FS.exists(*P))
+      return false;
+  }
+  for (const llvm::json::Value &Path : *Missing) {
+    Optional<StringRef> P = Path.getAsString();
+    if (!P || FS.exists(*P))
+      return false;
+  }
+  for (const auto &File : *Read) {
+    Optional<StringRef> Hash = File.second.getAsString();
+    auto It = Hashes.find(File.first);
+    if (It == Hashes.end())
+      It = Hashes.try_emplace(File.first, hashFile(FS, File.first)).first;
+    if (!Hash || !It->second || *It->second != *Hash)
+      return false;
+  }
+  return true;
+}
+
+CompileCache::CompileCache(CompilerInstance &Clang, std::string Key,
+                           IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+    : Clang(Clang), Key(std::move(Key)), FS(std::move(FS)) {}
+
+CompileCache::~CompileCache() = default;
+
+std::unique_ptr<CompileCache>
+CompileCache::create(CompilerInstance &Clang, ArrayRef<const char *> Argv) {
+  if (Clang.getFrontendOpts().CompileCachePath.empty() ||
+      !isCacheable(Clang.getInvocation()))
+    return nullptr;
+  SmallString<256> WorkingDir;
+  if (llvm::sys::fs::current_path(WorkingDir))
+    return nullptr;
+  return std::unique_ptr<CompileCache>(new CompileCache(
+      Clang, getKey(Argv, WorkingDir),
+      createVFSFromCompilerInvocation(Clang.getInvocation(),
+                                      Clang.getDiagnostics())));
+}
+
+std::string CompileCache::getCachePath(StringRef Name) const {
+  SmallString<256> Path(Clang.getFrontendOpts().CompileCachePath);
+  llvm::sys::path::append(Path, Name);
+  return std::string(Path.str());
+}
+
+bool CompileCache::replay() {
+  // The cache is an optimization, so the missing or invalid files of the
+  // cache are ignored.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Manifest =
+      llvm::MemoryBuffer::getFile(getCachePath(Key + ".manifest"));
+  if (!Manifest)
+    return false;
+  Expected<llvm::json::Value> Entries =
+      llvm::json::parse((*Manifest)->getBuffer());
+  if (!Entries) {
+    llvm::consumeError(Entries.takeError());
+    return false;
+  }
+  if (!Entries->getAsArray())
+    return false;
+
+  llvm::StringMap<Optional<std::string>> Hashes;
+  for (const llvm::json::Value &V : *Entries->getAsArray()) {
+    const llvm::json::Object *Entry = V.getAsObject();
+    if (!Entry || !isUpToDate(*Entry, *FS, Hashes))
+      continue;
+    if (Optional<StringRef> Result = Entry->getString("result"))
+      return restore(*Result);
+  }
+  return false;
+}
+
+bool CompileCache::restore(StringRef Result) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Object =
+      llvm::MemoryBuffer::getFile(getCachePath(Result.str() + ".o"),
+                                  /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Metadata =
+      llvm::MemoryBuffer::getFile(getCachePath(Result.str() + ".json"));
+  if (!Object || !Metadata)
+    return false;
+  Expected<llvm::json::Value> Contents =
+      llvm::json::parse((*Metadata)->getBuffer());
+  if (!Contents) {
+    llvm::consumeError(Contents.takeError());
+    return false;
+  }
+  const llvm::json::Object *Obj = Contents->getAsObject();
+  if (!Obj)
+    return false;
+  Optional<StringRef> Diagnostics = Obj->getString("diagnostics");
+  Optional<int64_t> NumWarnings = Obj->getInteger("warnings");
+  Optional<StringRef> Dependencies = Obj->getString("dependencies");
+  const DependencyOutputOptions &DepOpts = Clang.getDependencyOutputOpts();
+  if (!Diagnostics || !NumWarnings ||
+      (!DepOpts.OutputFile.empty() && !Dependencies))
+    return false;
+
+  if (!writeAtomically(Clang.getFrontendOpts().OutputFile,
+                       (*Object)->getBuffer()) ||
+      (!DepOpts.OutputFile.empty() &&
+       !writeAtomically(DepOpts.OutputFile, *Dependencies)))
+    return false;
+
+  Clang.getDiagnostics().Report(diag::remark_compile_cache_hit)
+      << Clang.getFrontendOpts().Inputs[0].getFile();
+  llvm::errs() << *Diagnostics;
+  // The compilations with errors aren't cached.
+  if (Clang.getDiagnosticOpts().ShowCarets && *NumWarnings)
+    llvm::errs() << *NumWarnings << " warning"
+                 << (*NumWarnings == 1 ? "" : "s") << " generated.\n";
+  return true;
+}
+
+void CompileCache::attach() {
+  TrackingFS = new TrackingFileSystem(FS);
+  Clang.createFileManager(TrackingFS);
+  MacroCollector = std::make_shared<UncacheableMacroCollector>();
+  Clang.addDependencyCollector(MacroCollector);
+
+  // The diagnostics are still printed by the client of the compilation.
+  auto Recorder =
+      std::make_unique<DiagnosticRecorder>(&Clang.getDiagnosticOpts());
+  Diagnostics = Recorder.get();
+  DiagnosticsEngine &Diags = Clang.getDiagnostics();
+  if (Diags.ownsClient())
+    Diags.setClient(new ChainedDiagnosticConsumer(Diags.takeClient(),
+                                                  std::move(Recorder)));
+  else
+    Diags.setClient(
+        new ChainedDiagnosticConsumer(Diags.getClient(), std::move(Recorder)));
+}
+
+void CompileCache::store() {
+  if (!TrackingFS || !TrackingFS->isComplete() ||
+      !MacroCollector->isCacheable() ||
+      Clang.getDiagnostics().hasErrorOccurred())
+    return;
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Object =
+      llvm::MemoryBuffer::getFile(Clang.getFrontendOpts().OutputFile,
+                                  /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Object)
+    return;
+  llvm::json::Value Dependencies = nullptr;
+  const DependencyOutputOptions &DepOpts = Clang.getDependencyOutputOpts();
+  if (!DepOpts.OutputFile.empty()) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(DepOpts.OutputFile);
+    if (!Buffer)
+      return;
+    Dependencies = (*Buffer)->getBuffer();
+  }
+
+  // The result is named after the key and the states of the files, which are
+  // sorted so that the same inputs always give the same name.
+  const llvm::StringMap<TrackingFileSystem::FileState> &Files =
+      TrackingFS->getFiles();
+  std::vector<StringRef> Paths;
+  for (const auto &File : Files)
+    Paths.push_back(File.getKey());
+  llvm::sort(Paths);
+
+  std::string ResultKey;
+  llvm::raw_string_ostream ResultOS(ResultKey);
+  ResultOS << Key << '\0';
+  llvm::json::Object Read;
+  llvm::json::Array Found, Missing;
+  for (StringRef Path : Paths) {
+    TrackingFileSystem::FileState State = Files.lookup(Path);
+    ResultOS << unsigned(State) << Path << '\0';
+    switch (State) {
+    case TrackingFileSystem::Read: {
+      Optional<std::string> Hash = hashFile(*FS, Path);
+      if (!Hash)
+        return;
+      ResultOS << *Hash << '\0';
+      Read[Path] = std::move(*Hash);
+      break;
+    }
+    case TrackingFileSystem::Found:
+      Found.push_back(Path);
+      break;
+    case TrackingFileSystem::Missing:
+      Missing.push_back(Path);
+      break;
+    }
+  }
+  std::string Result = hashContents(ResultOS.str());
+
+  if (llvm::sys::fs::create_directories(
+          Clang.getFrontendOpts().CompileCachePath))
+    return;
+  // The result is written before the manifest, which never names a missing
+  // result.
+  std::string Metadata;
+  llvm::raw_string_ostream MetadataOS(Metadata);
+  MetadataOS << llvm::json::Value(llvm::json::Object{
+      {"diagnostics", Diagnostics->getText()},
+      {"warnings", int64_t(Diagnostics->getNumWarnings())},
+      {"dependencies", std::move(Dependencies)}});
+  if (!writeAtomically(getCachePath(Result + ".o"), (*Object)->getBuffer()) ||
+      !writeAtomically(getCachePath(Result + ".json"), MetadataOS.str()))
+    return;
+
+  // The new result comes first, followed by the most recent earlier ones.
+  std::string ManifestPath = getCachePath(Key + ".manifest");
+  llvm::json::Array Entries;
+  Entries.push_back(llvm::json::Object{{"read", std::move(Read)},
+                                       {"found", std::move(Found)},
+                                       {"missing", std::move(Missing)},
+                                       {"result", Result}});
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Manifest =
+          llvm::MemoryBuffer::getFile(ManifestPath)) {
+    Expected<llvm::json::Value> OldEntries =
+        llvm::json::parse((*Manifest)->getBuffer());
+    if (!OldEntries)
+      llvm::consumeError(OldEntries.takeError());
+    else if (const llvm::json::Array *A = OldEntries->getAsArray())
+      for (const llvm::json::Value &V : *A) {
+        if (Entries.size() == MaxResultsPerManifest)
+          break;
+        const llvm::json::Object *Entry = V.getAsObject();
+        if (Entry && Entry->getString("result") != StringRef(Result))
+          Entries.push_back(V);
+      }
+  }
+  std::string Manifest;
+  llvm::raw_string_ostream ManifestOS(Manifest);
+  ManifestOS << llvm::json::Value(std::move(Entries));
+  writeAtomically(ManifestPath, ManifestOS.str());
+}
@@ -10,6 +10,7 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/Stmt.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
@@ -24,6 +25,7 @@
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/LogDiagnosticPrinter.h"
+#include "clang/Frontend/MemoryReport.h"
 #include "clang/Frontend/SerializedDiagnosticPrinter.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
@@ -33,6 +35,7 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateInstCallback.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
@@ -322,6 +325,7 @@ FileManager *CompilerInstance::createFileManager(
 
 void CompilerInstance::createSourceManager(FileManager &FileMgr) {
   SourceMgr = new SourceManager(getDiagnostics(), FileMgr);
+  SourceMgr->setFileBufferBudget(getFrontendOpts().SourceBufferBudget);
 }
 
 // Initialize the remapping of files to alternative contents, e.g.,
@@ -465,6 +469,12 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
                            /*ShowAllHeaders=*/true, /*OutputPath=*/"",
                            /*ShowDepth=*/true, /*MSStyle=*/true);
   }
+
+  if (!getFrontendOpts().HeaderCostReportFile.empty())
+    AttachHeaderCostReportGen(*this, getFrontendOpts().HeaderCostReportFile);
+
+  if (MemReport)
+    MemReport->attachToPreprocessor(*this);
 }
 
 std::string CompilerInstance::getSpecificModuleCachePath() {
@@ -628,6 +638,16 @@ void CompilerInstance::createSema(TranslationUnitKind TUKind,
     TheSema->addExternalSource(ExternalSemaSrc.get());
     ExternalSemaSrc->InitializeSema(*TheSema);
   }
+
+  if (!getFrontendOpts().TemplateProfileFile.empty())
+    TheSema->TemplateInstCallbacks.push_back(
+        createTemplateProfileCallback(getFrontendOpts().TemplateProfileFile));
+
+  // The includes of a prefix or of a module are meant for its users.
+  if (TUKind == TU_Complete && !getLangOpts().isCompilingModule() &&
+      !getDiagnostics().isIgnored(diag::warn_fe_unused_include,
+                                  SourceLocation()))
+    AttachUnusedIncludeFinder(*this);
 }
 
 // Output Files
@@ -669,10 +689,12 @@ void CompilerInstance::clearOutputFiles(bool EraseFiles) {
 
 std::unique_ptr<raw_pwrite_stream>
 CompilerInstance::createDefaultOutputFile(bool Binary, StringRef InFile,
-                                          StringRef Extension) {
+                                          StringRef Extension,
+                                          bool NeedsSeeking) {
   return createOutputFile(getFrontendOpts().OutputFile, Binary,
                           /*RemoveFileOnSignal=*/true, InFile, Extension,
-                          /*UseTemporary=*/true);
+                          /*UseTemporary=*/true,
+                          /*CreateMissingDirectories=*/false, NeedsSeeking);
 }
 
 std::unique_ptr<raw_pwrite_stream> CompilerInstance::createNullOutputFile() {
@@ -683,12 +705,14 @@ std::unique_ptr<raw_pwrite_stream>
 CompilerInstance::createOutputFile(StringRef OutputPath, bool Binary,
                                    bool RemoveFileOnSignal, StringRef InFile,
                                    StringRef Extension, bool UseTemporary,
-                                   bool CreateMissingDirectories) {
+                                   bool CreateMissingDirectories,
+                                   bool NeedsSeeking) {
   std::string OutputPathName, TempPathName;
   std::error_code EC;
   std::unique_ptr<raw_pwrite_stream> OS = createOutputFile(
       OutputPath, EC, Binary, RemoveFileOnSignal, InFile, Extension,
-      UseTemporary, CreateMissingDirectories, &OutputPathName, &TempPathName);
+      UseTemporary, CreateMissingDirectories, &OutputPathName, &TempPathName,
+      NeedsSeeking);
   if (!OS) {
     getDiagnostics().Report(diag::err_fe_unable_to_open_output) << OutputPath
                                                                 << EC.message();
@@ -707,7 +731,8 @@ std::unique_ptr<llvm::raw_pwrite_stream> CompilerInstance::createOutputFile(
     StringRef OutputPath, std::error_code &Error, bool Binary,
     bool RemoveFileOnSignal, StringRef InFile, StringRef Extension,
     bool UseTemporary, bool CreateMissingDirectories,
-    std::string *ResultPathName, std::string *TempPathName) {
+    std::string *ResultPathName, std::string *TempPathName,
+    bool NeedsSeeking) {
   assert((!CreateMissingDirectories || UseTemporary) &&
          "CreateMissingDirectories is only allowed when using temporary files");
 
@@ -799,7 +824,7 @@ std::unique_ptr<llvm::raw_pwrite_stream> CompilerInstance::createOutputFile(
   if (TempPathName)
     *TempPathName = TempFile;
 
-  if (!Binary || OS->supportsSeeking())
+  if (!Binary || !NeedsSeeking || OS->supportsSeeking())
     return std::move(OS);
 
   auto B = std::make_unique<llvm::buffer_ostream>(*OS);
@@ -954,6 +979,14 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   if (getFrontendOpts().ShowStats || !getFrontendOpts().StatsFile.empty())
     llvm::EnableStatistics(false);
 
+  StringRef MemoryReportFile = getFrontendOpts().MemoryReportFile;
+  if (!MemoryReportFile.empty()) {
+    MemReport = std::make_unique<MemoryReport>();
+    // Split the AST per kind of node.
+    Decl::EnableStatistics();
+    Stmt::EnableStatistics();
+  }
+
   for (const FrontendInputFile &FIF : getFrontendOpts().Inputs) {
     // Reset the ID tables if we are reusing the SourceManager and parsing
     // regular files.
@@ -961,13 +994,22 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
       getSourceManager().clearIDTables();
 
     if (Act.BeginSourceFile(*this, FIF)) {
+      if (MemReport)
+        MemReport->addSnapshot("begin-source-file", *this);
       if (llvm::Error Err = Act.Execute()) {
         consumeError(std::move(Err)); // FIXME this drops errors on the floor.
       }
+      if (MemReport)
+        MemReport->addSnapshot("execute", *this);
       Act.EndSourceFile();
     }
   }
 
+  if (MemReport) {
+    MemReport->write(MemoryReportFile, *this);
+    MemReport.reset();
+  }
+
   // Notify the diagnostic client that all files were processed.
   getDiagnostics().getClient()->finish();
 
@@ -1031,6 +1073,28 @@ static Language getLanguageFromOptions(const LangOptions &LangOpts) {
   return LangOpts.CPlusPlus ? Language::CXX : Language::C;
 }
 
+/// Replace the in-memory copy of the module file \p ModuleFileName that was
+/// just built by a mapping of the file that was written, so that the pages of
+/// the module file are shared with the other processes that read it.
+///
+/// The mapping is only used if it has the contents that were built, since
+/// another process may have replaced the file in the meantime.
+static void mapBuiltModuleFile(CompilerInstance &ImportingInstance,
+                               StringRef ModuleFileName) {
+  InMemoryModuleCache &ModuleCache = ImportingInstance.getModuleCache();
+  if (!ModuleCache.isPCMFinal(ModuleFileName) ||
+      !ModuleCache.lookupPCM(ModuleFileName))
+    return;
+
+  auto Buffer = ImportingInstance.getVirtualFileSystem().getBufferForFile(
+      ModuleFileName, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  // Small files are read rather than mapped; keep the copy we have then.
+  if (!Buffer ||
+      (*Buffer)->getBufferKind() != llvm::MemoryBuffer::MemoryBuffer_MMap)
+    return;
+  ModuleCache.replaceBuiltPCM(ModuleFileName, std::move(*Buffer));
+}
+
 /// Compile a module file for the given module, using the options
 /// provided by the importing compiler instance. Returns true if the module
 /// was built without errors.
@@ -1091,6 +1155,8 @@ compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
   FrontendOpts.OutputFile = ModuleFileName.str();
   FrontendOpts.DisableFree = false;
   FrontendOpts.GenerateGlobalModuleIndex = false;
+  FrontendOpts.TemplateProfileFile.clear();
+  FrontendOpts.HeaderCostReportFile.clear();
   FrontendOpts.BuildingImplicitModule = true;
   FrontendOpts.OriginalModuleMap = OriginalModuleMapFile;
   // Force implicitly-built modules to hash the content of the module file.
@@ -1161,7 +1227,12 @@ compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
   // doesn't make sense for all clients, so clean this up manually.
   Instance.clearOutputFiles(/*EraseFiles=*/true);
 
-  return !Instance.getDiagnostics().hasErrorOccurred();
+  if (Instance.getDiagnostics().hasErrorOccurred())
+    return false;
+
+  if (ImportingInstance.getHeaderSearchOpts().ModulesMapBuiltFiles)
+    mapBuiltModuleFile(ImportingInstance, ModuleFileName);
+  return true;
 }
 
 static const FileEntry *getPublicModuleMap(const FileEntry *File,
@@ -1218,6 +1289,7 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
 
     std::string InferredModuleMapContent;
     llvm::raw_string_ostream OS(InferredModuleMapContent);
+    ModMap.inferAllSubframeworks(Module);
     Module->print(OS);
     OS.flush();
 
@@ -1245,6 +1317,25 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   return Result;
 }
 
+/// Record which command-line macros the freshly built module file
+/// \p ModuleFileName observed, so that later translation units can tell which
+/// module file matches their configuration.
+static void recordObservedMacros(CompilerInstance &ImportingInstance,
+                                 Module *Module, StringRef ModuleFileName) {
+  serialization::ModuleFile *MF = ImportingInstance.getModuleManager()
+                                      ->getModuleManager()
+                                      .lookupByFileName(ModuleFileName);
+  if (!MF)
+    return;
+
+  std::vector<std::string> MacroNames;
+  for (const auto &Macro : MF->ObservedMacros)
+    MacroNames.push_back(Macro.first);
+  ImportingInstance.getPreprocessor()
+      .getHeaderSearchInfo()
+      .addObservedCommandLineMacros(Module, MacroNames);
+}
+
 static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
                                  SourceLocation ImportLoc,
                                  SourceLocation ModuleNameLoc, Module *Module,
@@ -1324,6 +1415,10 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
       // The ASTReader didn't diagnose the error, so conservatively report it.
       diagnoseBuildFailure();
     }
+
+    if (ReadResult == ASTReader::Success &&
+        ImportingInstance.getHeaderSearchOpts().ModulesHashObservedMacros)
+      recordObservedMacros(ImportingInstance, Module, ModuleFileName);
     return ReadResult == ASTReader::Success;
   }
 }
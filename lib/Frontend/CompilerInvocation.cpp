@@ -115,6 +115,14 @@ CompilerInvocationBase::CompilerInvocationBase(const CompilerInvocationBase &X)
 
 CompilerInvocationBase::~CompilerInvocationBase() = default;
 
+CompilerInvocation::CompilerInvocation(const CompilerInvocation &X)
+    : CompilerInvocationBase(X),
+      AnalyzerOpts(new AnalyzerOptions(*X.AnalyzerOpts)),
+      MigratorOpts(X.MigratorOpts), CodeGenOpts(X.CodeGenOpts),
+      DependencyOutputOpts(X.DependencyOutputOpts),
+      FileSystemOpts(X.FileSystemOpts), FrontendOpts(X.FrontendOpts),
+      PreprocessorOutputOpts(X.PreprocessorOutputOpts) {}
+
 //===----------------------------------------------------------------------===//
 // Deserialization (from args)
 //===----------------------------------------------------------------------===//
@@ -312,6 +320,7 @@ static bool ParseAnalyzerArgs(AnalyzerOptions &Opts, ArgList &Args,
   Opts.AnalyzerWerror = Args.hasArg(OPT_analyzer_werror);
   Opts.AnalyzeAll = Args.hasArg(OPT_analyzer_opt_analyze_headers);
   Opts.AnalyzerDisplayProgress = Args.hasArg(OPT_analyzer_display_progress);
+  Opts.AnalyzerCheckerTiming = Args.hasArg(OPT_analyzer_checker_timing);
   Opts.AnalyzeNestedBlocks =
     Args.hasArg(OPT_analyzer_opt_analyze_nested_blocks);
   Opts.AnalyzeSpecificFunction = Args.getLastArgValue(OPT_analyze_function);
@@ -500,6 +509,14 @@ static void parseAnalyzerConfigs(AnalyzerOptions &AnOpts,
     Diags->Report(diag::err_analyzer_config_invalid_input)
         << "track-conditions-debug" << "'track-conditions' to also be enabled";
 
+  if (AnOpts.PartitionCount == 0)
+    Diags->Report(diag::err_analyzer_config_invalid_input)
+        << "partition-count" << "a positive";
+
+  if (AnOpts.PartitionIndex >= std::max(AnOpts.PartitionCount, 1U))
+    Diags->Report(diag::err_analyzer_config_invalid_input)
+        << "partition-index" << "a 'partition-count' - 1 or smaller";
+
   if (!AnOpts.CTUDir.empty() && !llvm::sys::fs::is_directory(AnOpts.CTUDir))
     Diags->Report(diag::err_analyzer_config_invalid_input) << "ctu-dir"
                                                            << "a filename";
@@ -763,9 +780,17 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.LTOVisibilityPublicStd = Args.hasArg(OPT_flto_visibility_public_std);
   Opts.SplitDwarfFile = Args.getLastArgValue(OPT_split_dwarf_file);
   Opts.SplitDwarfOutput = Args.getLastArgValue(OPT_split_dwarf_output);
+
+  Opts.ParallelCodeGen =
+      getLastArgIntValue(Args, OPT_fparallel_codegen_EQ, 1, Diags);
+  // The partitions are written next to the output file, so they can't be
+  // written to stdout.
+  if (Opts.ParallelCodeGen > 1 && FrontendOpts.OutputFile != "-")
+    Opts.ParallelCodeGenOutput = FrontendOpts.OutputFile;
   Opts.SplitDwarfInlining = !Args.hasArg(OPT_fno_split_dwarf_inlining);
   Opts.DebugTypeExtRefs = Args.hasArg(OPT_dwarf_ext_refs);
   Opts.DebugExplicitImport = Args.hasArg(OPT_dwarf_explicit_import);
+  Opts.DebugTypeHoming = Args.hasArg(OPT_fdebug_type_homing);
   Opts.DebugFwdTemplateParams = Args.hasArg(OPT_debug_forward_template_params);
   Opts.EmbedSource = Args.hasArg(OPT_gembed_source);
 
@@ -885,6 +910,7 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
     Opts.setFramePointer(CodeGenOptions::FramePointerKind::All);
 
   Opts.DisableFree = Args.hasArg(OPT_disable_free);
+  Opts.ClearASTBeforeBackend = Args.hasArg(OPT_clear_ast_before_backend);
   Opts.DiscardValueNames = Args.hasArg(OPT_discard_value_names);
   Opts.DisableTailCalls = Args.hasArg(OPT_mdisable_tail_calls);
   Opts.NoEscapingBlockTailCalls =
@@ -967,6 +993,7 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.NullPointerIsValid = Args.hasArg(OPT_fno_delete_null_pointer_checks);
 
   Opts.ProfileSampleAccurate = Args.hasArg(OPT_fprofile_sample_accurate);
+  Opts.ProfileColdOptNone = Args.hasArg(OPT_fprofile_cold_optnone);
 
   Opts.PrepareForLTO = Args.hasArg(OPT_flto, OPT_flto_EQ);
   Opts.PrepareForThinLTO = false;
@@ -1401,6 +1428,9 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
 
   Opts.KeepStaticConsts = Args.hasArg(OPT_fkeep_static_consts);
 
+  Opts.HomedFunctionsFile = Args.getLastArgValue(OPT_fhomed_functions_file_EQ);
+  Opts.HomedFunctionsHome = Args.hasArg(OPT_fhomed_functions_home);
+
   Opts.SpeculativeLoadHardening = Args.hasArg(OPT_mspeculative_load_hardening);
 
   Opts.DefaultFunctionAttrs = Args.getAllArgValues(OPT_default_function_attr);
@@ -1623,6 +1653,9 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.SpellCheckingLimit = getLastArgIntValue(
       Args, OPT_fspell_checking_limit,
       DiagnosticOptions::DefaultSpellCheckingLimit, Diags);
+  Opts.SpellCheckingWorkLimit = getLastArgIntValue(
+      Args, OPT_fspell_checking_work_limit,
+      DiagnosticOptions::DefaultSpellCheckingWorkLimit, Diags);
   Opts.SnippetLineLimit = getLastArgIntValue(
       Args, OPT_fcaret_diagnostics_max_lines,
       DiagnosticOptions::DefaultSnippetLineLimit, Diags);
@@ -1684,6 +1717,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       unsigned Val = llvm::StringSwitch<unsigned>(A->getValue())
                          .CaseLower("default", ADOF_Default)
                          .CaseLower("json", ADOF_JSON)
+                         .CaseLower("json-compact", ADOF_JSONCompact)
                          .Default(std::numeric_limits<unsigned>::max());
 
       if (Val != std::numeric_limits<unsigned>::max())
@@ -1841,10 +1875,22 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ShowTimers = Args.hasArg(OPT_ftime_report);
   Opts.PrintSupportedCPUs = Args.hasArg(OPT_print_supported_cpus);
   Opts.TimeTrace = Args.hasArg(OPT_ftime_trace);
+  Opts.TemplateProfileFile = Args.getLastArgValue(OPT_ftemplate_profile_EQ);
+  Opts.HeaderCostReportFile =
+      Args.getLastArgValue(OPT_fheader_cost_report_EQ);
+  Opts.MemoryReportFile = Args.getLastArgValue(OPT_fmemory_report_EQ);
+  Opts.CompileCachePath = Args.getLastArgValue(OPT_fcompile_cache_path_EQ);
+  Opts.AutoPCHPath = Args.getLastArgValue(OPT_fauto_pch_path_EQ);
   Opts.TimeTraceGranularity = getLastArgIntValue(
       Args, OPT_ftime_trace_granularity_EQ, Opts.TimeTraceGranularity, Diags);
+  Opts.SourceBufferBudget =
+      getLastArgIntValue(Args, OPT_source_buffer_budget, 0, Diags);
   Opts.ShowVersion = Args.hasArg(OPT_version);
   Opts.ASTMergeFiles = Args.getAllArgValues(OPT_ast_merge);
+  Opts.ASTOutputFile = Args.getLastArgValue(OPT_ast_output);
+  Opts.IndexRecordPath = Args.getLastArgValue(OPT_index_record_path);
+  Opts.InterfaceStubsOutputFile =
+      Args.getLastArgValue(OPT_interface_stubs_output);
   Opts.LLVMArgs = Args.getAllArgValues(OPT_mllvm);
   Opts.FixWhatYouCan = Args.hasArg(OPT_fix_what_you_can);
   Opts.FixOnlyWarnings = Args.hasArg(OPT_fix_only_warnings);
@@ -1854,6 +1900,8 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ASTDumpAll = Args.hasArg(OPT_ast_dump_all, OPT_ast_dump_all_EQ);
   Opts.ASTDumpFilter = Args.getLastArgValue(OPT_ast_dump_filter);
   Opts.ASTDumpLookups = Args.hasArg(OPT_ast_dump_lookups);
+  Opts.ASTDumpNoLocations = Args.hasArg(OPT_ast_dump_json_no_locations);
+  Opts.ASTDumpNoImplicit = Args.hasArg(OPT_ast_dump_json_no_implicit);
   Opts.UseGlobalModuleIndex = !Args.hasArg(OPT_fno_modules_global_index);
   Opts.GenerateGlobalModuleIndex = Opts.UseGlobalModuleIndex;
   Opts.ModuleMapFiles = Args.getAllArgValues(OPT_fmodule_map_file);
@@ -1879,6 +1927,10 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     = Args.hasArg(OPT_code_completion_brief_comments);
   Opts.CodeCompleteOpts.IncludeFixIts
     = Args.hasArg(OPT_code_completion_with_fixits);
+  Opts.CodeCompleteOpts.ResultFilter =
+      Args.getLastArgValue(OPT_code_completion_filter);
+  Opts.CodeCompleteOpts.ResultLimit =
+      getLastArgIntValue(Args, OPT_code_completion_limit, 0, Diags);
 
   Opts.OverrideRecordLayoutsFile
     = Args.getLastArgValue(OPT_foverride_record_layout_EQ);
@@ -2057,6 +2109,7 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
   Opts.ModuleCachePath = P.str();
 
   Opts.ModuleUserBuildPath = Args.getLastArgValue(OPT_fmodules_user_build_path);
+  Opts.ModuleMapCachePath = Args.getLastArgValue(OPT_fmodule_map_cache_EQ);
   // Only the -fmodule-file=<name>=<file> form.
   for (const auto *A : Args.filtered(OPT_fmodule_file)) {
     StringRef Val = A->getValue();
@@ -2068,6 +2121,10 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
   Opts.DisableModuleHash = Args.hasArg(OPT_fdisable_module_hash);
   Opts.ModulesHashContent = Args.hasArg(OPT_fmodules_hash_content);
   Opts.ModulesStrictContextHash = Args.hasArg(OPT_fmodules_strict_context_hash);
+  Opts.ModulesLazyIdentifiers = Args.hasArg(OPT_fmodules_lazy_identifiers);
+  Opts.ModulesHashObservedMacros =
+      Args.hasArg(OPT_fmodules_hash_observed_macros);
+  Opts.ModulesMapBuiltFiles = Args.hasArg(OPT_fmodules_map_built_files);
   Opts.ModulesValidateDiagnosticOptions =
       !Args.hasArg(OPT_fmodules_disable_diagnostic_validation);
   Opts.ImplicitModuleMaps = Args.hasArg(OPT_fimplicit_module_maps);
@@ -2084,6 +2141,8 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
       Args.hasArg(OPT_fmodules_validate_system_headers);
   Opts.ValidateASTInputFilesContent =
       Args.hasArg(OPT_fvalidate_ast_input_files_content);
+  for (const auto &Map : Args.getAllArgValues(OPT_fmodule_file_prefix_map_EQ))
+    Opts.ModuleFilePrefixMap.push_back(StringRef(Map).split('='));
   if (const Arg *A = Args.getLastArg(OPT_fmodule_format_EQ))
     Opts.ModuleFormat = A->getValue();
 
@@ -2821,6 +2880,8 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       getLastArgIntValue(Args, OPT_fconstexpr_depth, 512, Diags);
   Opts.ConstexprStepLimit =
       getLastArgIntValue(Args, OPT_fconstexpr_steps, 1048576, Diags);
+  Opts.ConstexprCallCacheSize =
+      getLastArgIntValue(Args, OPT_fconstexpr_call_cache_size, 0, Diags);
   Opts.EnableNewConstInterp =
       Args.hasArg(OPT_fexperimental_new_constant_interpreter);
   Opts.ForceNewConstInterp =
@@ -3216,6 +3277,7 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
 
   Opts.CompleteMemberPointers = Args.hasArg(OPT_fcomplete_member_pointers);
   Opts.BuildingPCHWithObjectFile = Args.hasArg(OPT_building_pch_with_obj);
+  Opts.PCHInstantiateTemplates = Args.hasArg(OPT_fpch_instantiate_templates);
 }
 
 static bool isStrictlyPreprocessorAction(frontend::ActionKind Action) {
@@ -3272,8 +3334,11 @@ static void ParsePreprocessorArgs(PreprocessorOptions &Opts, ArgList &Args,
   Opts.PCHThroughHeader = Args.getLastArgValue(OPT_pch_through_header_EQ);
   Opts.UsePredefines = !Args.hasArg(OPT_undef);
   Opts.DetailedRecord = Args.hasArg(OPT_detailed_preprocessing_record);
+  Opts.ParallelASTWriting = Args.hasArg(OPT_parallel_ast_writing);
   Opts.DisablePCHValidation = Args.hasArg(OPT_fno_validate_pch);
   Opts.AllowPCHWithCompilerErrors = Args.hasArg(OPT_fallow_pch_with_errors);
+  Opts.ParallelLexThreshold =
+      getLastArgIntValue(Args, OPT_parallel_lex_threshold_EQ, 0, Diags);
 
   Opts.DumpDeserializedPCHDecls = Args.hasArg(OPT_dump_deserialized_pch_decls);
   for (const auto *A : Args.filtered(OPT_error_on_deserialized_pch_decl))
@@ -3372,6 +3437,7 @@ static void ParsePreprocessorOutputArgs(PreprocessorOutputOptions &Opts,
   Opts.RewriteIncludes = Args.hasArg(OPT_frewrite_includes);
   Opts.RewriteImports = Args.hasArg(OPT_frewrite_imports);
   Opts.UseLineDirectives = Args.hasArg(OPT_fuse_line_directives);
+  Opts.CopySourceSpans = Args.hasArg(OPT_preprocessed_output_copy_spans);
 }
 
 static void ParseTargetArgs(TargetOptions &Opts, ArgList &Args,
@@ -3424,8 +3490,8 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
   const OptTable &Opts = getDriverOptTable();
   const unsigned IncludedFlagsBitmask = options::CC1Option;
   unsigned MissingArgIndex, MissingArgCount;
-  InputArgList Args = Opts.ParseArgs(CommandLineArgs, MissingArgIndex,
-                                     MissingArgCount, IncludedFlagsBitmask);
+  InputArgList Args = parseDriverArgs(CommandLineArgs, MissingArgIndex,
+                                      MissingArgCount, IncludedFlagsBitmask);
   LangOptions &LangOpts = *Res.getLangOpts();
 
   // Check for missing argument error.
@@ -3523,6 +3589,15 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
       !LangOpts.Sanitize.has(SanitizerKind::Memory) &&
       !LangOpts.Sanitize.has(SanitizerKind::KernelMemory);
 
+  // The statistics and the template profile are computed from the AST after
+  // the backend has run, and plugin consumers may look at the AST after the
+  // code generator.
+  Res.getCodeGenOpts().ClearASTBeforeBackend &=
+      !Res.getFrontendOpts().ShowStats &&
+      Res.getFrontendOpts().TemplateProfileFile.empty() &&
+      Res.getFrontendOpts().Plugins.empty() &&
+      Res.getFrontendOpts().AddPluginActions.empty();
+
   ParsePreprocessorArgs(Res.getPreprocessorOpts(), Args, Diags,
                         Res.getFrontendOpts().ProgramAction);
   ParsePreprocessorOutputArgs(Res.getPreprocessorOutputOpts(), Args,
@@ -3578,6 +3653,12 @@ std::string CompilerInvocation::getModuleHash() const {
   code = hash_combine(code, ppOpts.UsePredefines, ppOpts.DetailedRecord);
 
   for (const auto &I : getPreprocessorOpts().Macros) {
+    // When modules are keyed by the macros they observe, those macros are
+    // part of the module file name instead; see
+    // HeaderSearch::getCachedModuleFileName().
+    if (hsOpts.ModulesHashObservedMacros)
+      break;
+
     // If we're supposed to ignore this macro for the purposes of modules,
     // don't put it into the hash.
     if (!hsOpts.ModulesIgnoreMacros.empty()) {
@@ -3599,7 +3680,8 @@ std::string CompilerInvocation::getModuleHash() const {
                       hsOpts.UseStandardSystemIncludes,
                       hsOpts.UseStandardCXXIncludes,
                       hsOpts.UseLibcxx,
-                      hsOpts.ModulesValidateDiagnosticOptions);
+                      hsOpts.ModulesValidateDiagnosticOptions,
+                      hsOpts.ModulesHashObservedMacros);
   code = hash_combine(code, hsOpts.ResourceDir);
 
   if (hsOpts.ModulesStrictContextHash) {
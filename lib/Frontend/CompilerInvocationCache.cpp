@@ -0,0 +1,146 @@
+//===- CompilerInvocationCache.cpp - Invocations shared by tools ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the CompilerInvocationCache.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompilerInvocationCache.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Driver/Options.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/Option/Arg.h"
+#include "llvm/Option/ArgList.h"
+#include <iterator>
+
+using namespace clang;
+using namespace clang::driver;
+using namespace llvm::opt;
+
+/// \returns the key of the invocations created from \p Args.
+static std::string getKey(const ArgList &Args) {
+  std::string Key;
+  for (const Arg *A : Args) {
+    switch (A->getOption().getID()) {
+    case options::OPT_D:
+    case options::OPT_U:
+      continue;
+    case options::OPT_INPUT:
+      // Without -x, the kind of the input depends on its extension.
+      Key += "<input>.";
+      Key += StringRef(A->getValue()).rsplit('.').second;
+      Key += '\0';
+      continue;
+    case options::OPT_o:
+    case options::OPT_main_file_name:
+    case options::OPT_MT:
+    case options::OPT_dependency_file:
+      // Only the values of these can differ, e.g. -dependency-file without
+      // -MT is an error.
+      Key += A->getSpelling();
+      Key += '\0';
+      continue;
+    }
+
+    ArgStringList Rendered;
+    A->render(Args, Rendered);
+    for (const char *Value : Rendered) {
+      Key += Value;
+      Key += '\0';
+    }
+  }
+  return Key;
+}
+
+/// \returns true if the options of \p Invocation only depend on the options
+/// which are part of the key, besides those set by applyPerInputArgs().
+static bool isCacheable(const CompilerInvocation &Invocation) {
+  // The derived paths of the output file, and the profile which is read while
+  // parsing the arguments. Embedding the command line in the bitcode embeds
+  // the -D macros too.
+  const CodeGenOptions &CodeGenOpts = Invocation.getCodeGenOpts();
+  return Invocation.getFrontendOpts().Inputs.size() == 1 &&
+         CodeGenOpts.SaveTempsFilePrefix.empty() &&
+         CodeGenOpts.ParallelCodeGenOutput.empty() &&
+         CodeGenOpts.ProfileInstrumentUsePath.empty() &&
+         CodeGenOpts.getEmbedBitcode() != CodeGenOptions::Embed_All;
+}
+
+/// Set the options of \p Invocation which aren't part of the key from
+/// \p Args.
+static void applyPerInputArgs(CompilerInvocation &Invocation,
+                              const ArgList &Args, size_t NumImplicitMacros) {
+  FrontendOptions &FrontendOpts = Invocation.getFrontendOpts();
+  const FrontendInputFile &Input = FrontendOpts.Inputs[0];
+  FrontendOpts.Inputs[0] =
+      FrontendInputFile(Args.getLastArgValue(options::OPT_INPUT, "-"),
+                        Input.getKind(), Input.isSystem());
+  FrontendOpts.OutputFile = Args.getLastArgValue(options::OPT_o);
+
+  Invocation.getCodeGenOpts().MainFileName =
+      Args.getLastArgValue(options::OPT_main_file_name);
+
+  DependencyOutputOptions &DepOpts = Invocation.getDependencyOutputOpts();
+  DepOpts.OutputFile = Args.getLastArgValue(options::OPT_dependency_file);
+  DepOpts.Targets = Args.getAllArgValues(options::OPT_MT);
+
+  PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  PPOpts.Macros.resize(NumImplicitMacros);
+  for (const Arg *A : Args.filtered(options::OPT_D, options::OPT_U)) {
+    if (A->getOption().matches(options::OPT_D))
+      PPOpts.addMacroDef(A->getValue());
+    else
+      PPOpts.addMacroUndef(A->getValue());
+  }
+}
+
+std::unique_ptr<CompilerInvocation> CompilerInvocationCache::createInvocation(
+    ArrayRef<const char *> CommandLineArgs, DiagnosticsEngine &Diags) {
+  unsigned MissingArgIndex, MissingArgCount;
+  InputArgList Args = parseDriverArgs(CommandLineArgs, MissingArgIndex,
+                                      MissingArgCount, options::CC1Option);
+  std::string Key = getKey(Args);
+
+  Entry Cached;
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto It = Invocations.find(Key);
+    if (It != Invocations.end())
+      Cached = It->second;
+  }
+  if (Cached.Invocation) {
+    auto Invocation = std::make_unique<CompilerInvocation>(*Cached.Invocation);
+    applyPerInputArgs(*Invocation, Args, Cached.NumImplicitMacros);
+    return Invocation;
+  }
+
+  auto Invocation = std::make_unique<CompilerInvocation>();
+  DiagnosticErrorTrap Trap(Diags);
+  unsigned NumWarnings = Diags.getNumWarnings();
+  bool Success =
+      CompilerInvocation::CreateFromArgs(*Invocation, CommandLineArgs, Diags);
+  if (!Success || MissingArgCount || Trap.hasErrorOccurred() ||
+      Diags.getNumWarnings() != NumWarnings || !isCacheable(*Invocation))
+    return Invocation;
+
+  auto Macros = Args.filtered(options::OPT_D, options::OPT_U);
+  size_t NumMacros = std::distance(Macros.begin(), Macros.end());
+  Cached.Invocation = std::make_shared<CompilerInvocation>(*Invocation);
+  Cached.NumImplicitMacros =
+      Invocation->getPreprocessorOpts().Macros.size() - NumMacros;
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  Invocations.try_emplace(Key, std::move(Cached));
+  return Invocation;
+}
+
+void CompilerInvocationCache::clear() {
+  std::lock_guard<std::mutex> Guard(Lock);
+  Invocations.clear();
+}
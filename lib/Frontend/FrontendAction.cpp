@@ -467,6 +467,9 @@ static Module *prepareToBuildModule(CompilerInstance &CI,
     return nullptr;
   }
 
+  // Building the module needs all of its subframeworks.
+  HS.getModuleMap().inferAllSubframeworks(M);
+
   // Check whether we can build this module at all.
   if (Preprocessor::checkModuleIsAvailable(CI.getLangOpts(), CI.getTarget(),
                                            CI.getDiagnostics(), M))
@@ -981,6 +984,16 @@ void FrontendAction::EndSourceFile() {
     CI.setASTConsumer(nullptr);
   }
 
+  if (CI.hasPreprocessor())
+    CI.getPreprocessor()
+        .getHeaderSearchInfo()
+        .getModuleMap()
+        .writeModuleMapCache();
+
+  // No lexer points into the file contents once the input file is done.
+  if (CI.hasSourceManager())
+    CI.getSourceManager().evictFileBuffers();
+
   if (CI.getFrontendOpts().ShowStats) {
     llvm::errs() << "\nSTATISTICS FOR '" << getCurrentFile() << "':\n";
     CI.getPreprocessor().PrintStats();
@@ -1040,7 +1053,8 @@ void ASTFrontendAction::ExecuteAction() {
     CI.createSema(getTranslationUnitKind(), CompletionConsumer);
 
   ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
-           CI.getFrontendOpts().SkipFunctionBodies);
+           CI.getFrontendOpts().SkipFunctionBodies,
+           CI.getFrontendOpts().CancellationFlag);
 }
 
 void PluginASTAction::anchor() { }
@@ -78,7 +78,8 @@ ASTDumpAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
   const FrontendOptions &Opts = CI.getFrontendOpts();
   return CreateASTDumper(nullptr /*Dump to stdout.*/, Opts.ASTDumpFilter,
                          Opts.ASTDumpDecls, Opts.ASTDumpAll,
-                         Opts.ASTDumpLookups, Opts.ASTDumpFormat);
+                         Opts.ASTDumpLookups, Opts.ASTDumpFormat,
+                         Opts.ASTDumpNoLocations, Opts.ASTDumpNoImplicit);
 }
 
 std::unique_ptr<ASTConsumer>
@@ -103,6 +104,15 @@ GeneratePCHAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
   if (!OS)
     return nullptr;
 
+  return CreatePCHWriter(CI, InFile, OutputFile, std::move(OS),
+                         std::move(Sysroot));
+}
+
+std::unique_ptr<ASTConsumer>
+GeneratePCHAction::CreatePCHWriter(CompilerInstance &CI, StringRef InFile,
+                                   StringRef OutputFile,
+                                   std::unique_ptr<raw_pwrite_stream> OS,
+                                   std::string Sysroot) {
   if (!CI.getFrontendOpts().RelocatablePCH)
     Sysroot.clear();
 
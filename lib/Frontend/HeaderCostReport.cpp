@@ -0,0 +1,169 @@
+//===- HeaderCostReport.cpp - Aggregated costs of the included headers ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the -fheader-cost-report report, which attributes the
+// time and the AST memory spent while the preprocessor was lexing a header,
+// i.e. preprocessing it and parsing and checking its declarations, to that
+// header.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+
+using namespace clang;
+
+namespace {
+class HeaderCostCallback : public PPCallbacks {
+  using Clock = std::chrono::steady_clock;
+
+  /// The costs of the inclusions of one header.
+  struct Entry {
+    uint64_t Count = 0;
+    /// The costs including those of the headers that this header included.
+    /// Recursive inclusions of the same header are only counted once.
+    Clock::duration InclusiveTime{};
+    uint64_t InclusiveBytes = 0;
+    /// The costs of this header alone.
+    Clock::duration ExclusiveTime{};
+    uint64_t ExclusiveBytes = 0;
+    /// The number of inclusions of this header in progress.
+    unsigned Active = 0;
+  };
+
+  /// A file being lexed. The buffers which aren't files, e.g. the
+  /// predefines, have no entry but still count as the children of their
+  /// includer.
+  struct Frame {
+    const FileEntry *File;
+    Clock::time_point StartTime;
+    uint64_t StartBytes;
+    Clock::duration ChildTime{};
+    uint64_t ChildBytes = 0;
+  };
+
+  CompilerInstance &CI;
+  std::string OutputFile;
+  llvm::DenseMap<const FileEntry *, Entry> Entries;
+  std::vector<Frame> Stack;
+
+  /// The AST is created after the preprocessor, and isn't created at all
+  /// when only preprocessing.
+  uint64_t getAllocatedBytes() const {
+    if (!CI.hasASTContext())
+      return 0;
+    return CI.getASTContext().getAllocator().getBytesAllocated();
+  }
+
+public:
+  HeaderCostCallback(CompilerInstance &CI, StringRef OutputFile)
+      : CI(CI), OutputFile(OutputFile) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile) {
+      SourceManager &SM = CI.getSourceManager();
+      const FileEntry *File = SM.getFileEntryForID(SM.getFileID(Loc));
+      // The main file isn't a header.
+      if (Stack.empty())
+        File = nullptr;
+      if (File)
+        ++Entries[File].Active;
+      Stack.push_back({File, Clock::now(), getAllocatedBytes()});
+      return;
+    }
+    // The main file is never exited.
+    if (Reason != ExitFile || Stack.size() < 2)
+      return;
+
+    Frame F = Stack.back();
+    Stack.pop_back();
+    Clock::duration Time = Clock::now() - F.StartTime;
+    uint64_t Bytes = getAllocatedBytes() - F.StartBytes;
+    if (F.File) {
+      Entry &E = Entries[F.File];
+      ++E.Count;
+      E.ExclusiveTime += Time - F.ChildTime;
+      E.ExclusiveBytes += Bytes - F.ChildBytes;
+      if (--E.Active == 0) {
+        E.InclusiveTime += Time;
+        E.InclusiveBytes += Bytes;
+      }
+    }
+    Stack.back().ChildTime += Time;
+    Stack.back().ChildBytes += Bytes;
+  }
+
+  void EndOfMainFile() override {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << OutputFile << EC.message();
+      return;
+    }
+    write(OS);
+  }
+
+private:
+  /// Write the report as JSON. The entries are keyed by the path of the
+  /// header, so that the reports of several translation units can be merged
+  /// by adding up the fields of the entries with the same path.
+  void write(raw_ostream &OS) {
+    using namespace std::chrono;
+
+    std::vector<std::pair<const FileEntry *, const Entry *>> Sorted;
+    for (const auto &E : Entries)
+      if (E.second.Count)
+        Sorted.push_back({E.first, &E.second});
+    llvm::sort(Sorted, [](const auto &LHS, const auto &RHS) {
+      return LHS.second->ExclusiveTime > RHS.second->ExclusiveTime;
+    });
+
+    llvm::json::Array Headers;
+    for (const auto &E : Sorted) {
+      const Entry &Costs = *E.second;
+      Headers.push_back(llvm::json::Object{
+          {"path", E.first->getName()},
+          {"translation_units", 1},
+          {"count", int64_t(Costs.Count)},
+          {"inclusive_us",
+           int64_t(duration_cast<microseconds>(Costs.InclusiveTime).count())},
+          {"exclusive_us",
+           int64_t(duration_cast<microseconds>(Costs.ExclusiveTime).count())},
+          {"inclusive_bytes", int64_t(Costs.InclusiveBytes)},
+          {"exclusive_bytes", int64_t(Costs.ExclusiveBytes)},
+      });
+    }
+
+    OS << llvm::formatv("{0:2}\n",
+                        llvm::json::Value(llvm::json::Object{
+                            {"version", 1},
+                            {"headers", std::move(Headers)},
+                        }));
+  }
+};
+} // namespace
+
+void clang::AttachHeaderCostReportGen(CompilerInstance &CI,
+                                      StringRef OutputFile) {
+  CI.getPreprocessor().addPPCallbacks(
+      std::make_unique<HeaderCostCallback>(CI, OutputFile));
+}
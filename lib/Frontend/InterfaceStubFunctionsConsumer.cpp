@@ -12,6 +12,7 @@
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Sema/TemplateInstCallback.h"
 #include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace clang;
 
@@ -20,6 +21,7 @@ class InterfaceStubFunctionsConsumer : public ASTConsumer {
   CompilerInstance &Instance;
   StringRef InFile;
   StringRef Format;
+  StringRef OutputFile;
   std::set<std::string> ParsedTemplates;
 
   enum RootDeclOrigin { TopLevel = 0, FromTU = 1, IsLate = 2 };
@@ -203,8 +205,9 @@ class InterfaceStubFunctionsConsumer : public ASTConsumer {
 
 public:
   InterfaceStubFunctionsConsumer(CompilerInstance &Instance, StringRef InFile,
-                                 StringRef Format)
-      : Instance(Instance), InFile(InFile), Format(Format) {}
+                                 StringRef Format, StringRef OutputFile)
+      : Instance(Instance), InFile(InFile), Format(Format),
+        OutputFile(OutputFile) {}
 
   void HandleTranslationUnit(ASTContext &context) override {
     struct Visitor : public RecursiveASTVisitor<Visitor> {
@@ -232,10 +235,6 @@ public:
     v.TraverseDecl(context.getTranslationUnitDecl());
 
     MangledSymbols Symbols;
-    auto OS = Instance.createDefaultOutputFile(/*Binary=*/false, InFile, "ifs");
-    if (!OS)
-      return;
-
     if (Instance.getLangOpts().DelayedTemplateParsing) {
       clang::Sema &S = Instance.getSema();
       for (const auto *FD : v.LateParsedDecls) {
@@ -260,42 +259,74 @@ public:
       OS << "Triple: " << T.str() << "\n";
       OS << "ObjectFileFormat: " << "ELF" << "\n"; // TODO: For now, just ELF.
       OS << "Symbols:\n";
+      // The symbols are keyed by their declarations, whose addresses differ
+      // from one run to the next. Sort them by name instead, so that the
+      // stubs only change when the interface does.
+      std::map<std::string, std::string> Lines;
       for (const auto &E : Symbols) {
         const MangledSymbol &Symbol = E.second;
         for (auto Name : Symbol.Names) {
-          OS << "  \""
-             << (Symbol.ParentName.empty() || Instance.getLangOpts().CPlusPlus
-                     ? ""
-                     : (Symbol.ParentName + "."))
-             << Name << "\" : { Type: ";
+          std::string EmittedName =
+              (Symbol.ParentName.empty() || Instance.getLangOpts().CPlusPlus
+                   ? ""
+                   : (Symbol.ParentName + ".")) +
+              Name;
+          std::string Line;
+          llvm::raw_string_ostream LineOS(Line);
+          LineOS << "  \"" << EmittedName << "\" : { Type: ";
           switch (Symbol.Type) {
           default:
             llvm_unreachable(
                 "clang -emit-interface-stubs: Unexpected symbol type.");
           case llvm::ELF::STT_NOTYPE:
-            OS << "NoType";
+            LineOS << "NoType";
             break;
           case llvm::ELF::STT_OBJECT: {
             auto VD = cast<ValueDecl>(E.first)->getType();
-            OS << "Object, Size: "
-               << context.getTypeSizeInChars(VD).getQuantity();
+            LineOS << "Object, Size: "
+                   << context.getTypeSizeInChars(VD).getQuantity();
             break;
           }
           case llvm::ELF::STT_FUNC:
-            OS << "Func";
+            LineOS << "Func";
             break;
           }
           if (Symbol.Binding == llvm::ELF::STB_WEAK)
-            OS << ", Weak: true";
-          OS << " }\n";
+            LineOS << ", Weak: true";
+          LineOS << " }\n";
+          Lines.emplace(std::move(EmittedName), LineOS.str());
         }
       }
+      for (const auto &Line : Lines)
+        OS << Line.second;
       OS << "...\n";
       OS.flush();
     };
 
     assert(Format == "experimental-ifs-v1" && "Unexpected IFS Format.");
-    writeIfsV1(Instance.getTarget().getTriple(), Symbols, context, Format, *OS);
+    std::string Stubs;
+    llvm::raw_string_ostream StubsOS(Stubs);
+    writeIfsV1(Instance.getTarget().getTriple(), Symbols, context, Format,
+               StubsOS);
+
+    // Leave the stubs written beside another output alone when they didn't
+    // change, so that a build system which compares their modification times
+    // doesn't relink the dependents of the library.
+    if (!OutputFile.empty()) {
+      auto Existing = llvm::MemoryBuffer::getFile(OutputFile);
+      if (Existing && (*Existing)->getBuffer() == Stubs)
+        return;
+    }
+
+    auto OS = OutputFile.empty()
+                  ? Instance.createDefaultOutputFile(/*Binary=*/false, InFile,
+                                                     "ifs")
+                  : Instance.createOutputFile(
+                        OutputFile, /*Binary=*/false,
+                        /*RemoveFileOnSignal=*/true, InFile,
+                        /*Extension=*/"", /*UseTemporary=*/true);
+    if (OS)
+      *OS << Stubs;
   }
 };
 } // namespace
@@ -303,6 +334,13 @@ public:
 std::unique_ptr<ASTConsumer>
 GenerateInterfaceIfsExpV1Action::CreateASTConsumer(CompilerInstance &CI,
                                                    StringRef InFile) {
+  return CreateStubsWriter(CI, InFile, /*OutputFile=*/"");
+}
+
+std::unique_ptr<ASTConsumer>
+GenerateInterfaceIfsExpV1Action::CreateStubsWriter(CompilerInstance &CI,
+                                                   StringRef InFile,
+                                                   StringRef OutputFile) {
   return std::make_unique<InterfaceStubFunctionsConsumer>(
-      CI, InFile, "experimental-ifs-v1");
+      CI, InFile, "experimental-ifs-v1", OutputFile);
 }
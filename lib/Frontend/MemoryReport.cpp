@@ -0,0 +1,157 @@
+//===- MemoryReport.cpp - Memory of the compiler per domain ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the MemoryReport of -fmemory-report.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/MemoryReport.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/ExternalASTSource.h"
+#include "clang/AST/Stmt.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+/// \returns an object with the count and the bytes of each kind of node
+/// that \p VisitStats visits.
+template <typename VisitStatsFn>
+static llvm::json::Object getKindStats(VisitStatsFn VisitStats) {
+  llvm::json::Object Kinds;
+  VisitStats([&](StringRef Kind, unsigned Count, uint64_t Bytes) {
+    Kinds[Kind] = llvm::json::Object{{"count", int64_t(Count)},
+                                     {"bytes", int64_t(Bytes)}};
+  });
+  return Kinds;
+}
+
+void MemoryReport::addSnapshot(StringRef Phase, const CompilerInstance &CI) {
+  llvm::json::Object Domains;
+
+  if (CI.hasASTContext()) {
+    ASTContext &Ctx = CI.getASTContext();
+    // The declarations and the statements are counted since the start of
+    // the compilation, from when -fmemory-report enabled their statistics.
+    Domains["ast"] = llvm::json::Object{
+        {"total_bytes", int64_t(Ctx.getASTAllocatedMemory())},
+        {"side_table_bytes", int64_t(Ctx.getSideTableAllocatedMemory())},
+        {"decls", getKindStats(Decl::visitStats)},
+        {"stmts", getKindStats(Stmt::visitStats)},
+        {"types", getKindStats([&](auto Visit) { Ctx.visitTypeStats(Visit); })},
+    };
+
+    if (ExternalASTSource *Source = Ctx.getExternalSource()) {
+      ExternalASTSource::MemoryBufferSizes Sizes =
+          Source->getMemoryBufferSizes();
+      Domains["ast_reader"] = llvm::json::Object{
+          {"malloc_buffer_bytes", int64_t(Sizes.malloc_bytes)},
+          {"mmap_buffer_bytes", int64_t(Sizes.mmap_bytes)},
+      };
+    }
+  }
+
+  if (CI.hasSourceManager()) {
+    SourceManager &SM = CI.getSourceManager();
+    SourceManager::MemoryBufferSizes Sizes = SM.getMemoryBufferSizes();
+    Domains["source_manager"] = llvm::json::Object{
+        {"content_cache_bytes", int64_t(SM.getContentCacheSize())},
+        {"malloc_buffer_bytes", int64_t(Sizes.malloc_bytes)},
+        {"mmap_buffer_bytes", int64_t(Sizes.mmap_bytes)},
+        {"data_structure_bytes", int64_t(SM.getDataStructureSizes())},
+    };
+  }
+
+  if (CI.hasPreprocessor()) {
+    Preprocessor &PP = CI.getPreprocessor();
+    PreprocessingRecord *Record = PP.getPreprocessingRecord();
+    Domains["preprocessor"] = llvm::json::Object{
+        {"total_bytes", int64_t(PP.getTotalMemory())},
+        {"identifier_bytes",
+         int64_t(PP.getIdentifierTable().getAllocator().getTotalMemory())},
+        {"selector_bytes", int64_t(PP.getSelectorTable().getTotalMemory())},
+        {"header_search_bytes",
+         int64_t(PP.getHeaderSearchInfo().getTotalMemory())},
+        {"preprocessing_record_bytes",
+         int64_t(Record ? Record->getTotalMemory() : 0)},
+    };
+  }
+
+  for (const auto &Domain : Peaks) {
+    llvm::json::Object Fields;
+    for (const auto &Field : Domain.second)
+      Fields[Field.getKey().str()] = int64_t(Field.second);
+    Domains[Domain.getKey().str()] = std::move(Fields);
+  }
+  Peaks.clear();
+
+  // The memory which isn't held by the domains above, e.g. the LLVM module
+  // of the code generator, only shows up in the total of the process.
+  Domains["process"] = llvm::json::Object{
+      {"malloc_bytes", int64_t(llvm::sys::Process::GetMallocUsage())},
+  };
+
+  Snapshots.push_back(llvm::json::Object{
+      {"phase", Phase.str()},
+      {"domains", std::move(Domains)},
+  });
+}
+
+namespace {
+class MemoryReportCallback : public PPCallbacks {
+  MemoryReport &Report;
+  const CompilerInstance &CI;
+
+public:
+  MemoryReportCallback(MemoryReport &Report, const CompilerInstance &CI)
+      : Report(Report), CI(CI) {}
+
+  void EndOfMainFile() override { Report.addSnapshot("end-of-main-file", CI); }
+};
+} // namespace
+
+void MemoryReport::attachToPreprocessor(CompilerInstance &CI) {
+  CI.getPreprocessor().addPPCallbacks(
+      std::make_unique<MemoryReportCallback>(*this, CI));
+}
+
+void MemoryReport::notePeak(StringRef Domain, StringRef Field,
+                            uint64_t Value) {
+  uint64_t &Peak = Peaks[Domain][Field];
+  Peak = std::max(Peak, Value);
+}
+
+void MemoryReport::write(raw_ostream &OS) const {
+  OS << llvm::formatv("{0:2}\n",
+                      llvm::json::Value(llvm::json::Object{
+                          {"version", 1},
+                          {"snapshots", llvm::json::Array(Snapshots)},
+                      }));
+}
+
+bool MemoryReport::write(StringRef OutputFile, CompilerInstance &CI) const {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::OF_Text);
+  if (EC) {
+    CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << OutputFile << EC.message();
+    return true;
+  }
+  write(OS);
+  return false;
+}
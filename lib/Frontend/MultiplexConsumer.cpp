@@ -352,6 +352,13 @@ bool MultiplexConsumer::shouldSkipFunctionBody(Decl *D) {
   return Skip;
 }
 
+bool MultiplexConsumer::shouldDeferFunctionBody(Decl *D) {
+  for (auto &Consumer : Consumers)
+    if (Consumer->shouldDeferFunctionBody(D))
+      return true;
+  return false;
+}
+
 void MultiplexConsumer::InitializeSema(Sema &S) {
   for (auto &Consumer : Consumers)
     if (SemaConsumer *SC = dyn_cast<SemaConsumer>(Consumer.get()))
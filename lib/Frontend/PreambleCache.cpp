@@ -0,0 +1,109 @@
+//===- PreambleCache.cpp - Preambles shared between ASTUnits --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the PreambleCache.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/PreambleCache.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+std::string PreambleCache::getKey(const CompilerInvocation &Invocation,
+                                  StringRef MainFilePath,
+                                  bool SkipFunctionBodies) {
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+
+  // The module hash covers the language, target and sysroot options, but not
+  // all of the macros or the include paths.
+  OS << Invocation.getModuleHash() << '\0'
+     << llvm::sys::path::parent_path(MainFilePath) << '\0'
+     << SkipFunctionBodies << '\0';
+
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (const auto &Macro : PPOpts.Macros)
+    OS << (Macro.second ? "-U" : "-D") << Macro.first << '\0';
+  for (const std::string &Include : PPOpts.Includes)
+    OS << "-include" << Include << '\0';
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    OS << "-imacros" << Include << '\0';
+  OS << PPOpts.ImplicitPCHInclude << '\0';
+
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  for (const HeaderSearchOptions::Entry &E : HSOpts.UserEntries)
+    OS << unsigned(E.Group) << E.IsFramework << E.IgnoreSysRoot << E.Path
+       << '\0';
+  for (const HeaderSearchOptions::SystemHeaderPrefix &P :
+       HSOpts.SystemHeaderPrefixes)
+    OS << P.IsSystemHeader << P.Prefix << '\0';
+  for (const std::string &Overlay : HSOpts.VFSOverlayFiles)
+    OS << "-ivfsoverlay" << Overlay << '\0';
+
+  // The diagnostics of the preamble are reused along with it.
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+  for (const std::string &Warning : DiagOpts.Warnings)
+    OS << "-W" << Warning << '\0';
+  for (const std::string &Remark : DiagOpts.Remarks)
+    OS << "-R" << Remark << '\0';
+#define DIAGOPT(Name, Bits, Default) OS << DiagOpts.Name << ' ';
+#define ENUM_DIAGOPT(Name, Type, Bits, Default)                                \
+  OS << unsigned(DiagOpts.get##Name()) << ' ';
+#include "clang/Basic/DiagnosticOptions.def"
+
+  return OS.str();
+}
+
+Optional<PreambleCache::Entry>
+PreambleCache::lookup(StringRef Key, const CompilerInvocation &Invocation,
+                      const llvm::MemoryBuffer *MainFileBuffer,
+                      PreambleBounds Bounds, llvm::vfs::FileSystem *VFS) {
+  // Check the candidates without the lock, since checking whether a preamble
+  // can be reused stats its files.
+  SmallVector<Entry, 2> Candidates;
+  {
+    std::lock_guard<std::mutex> LockGuard(Lock);
+    auto It = Preambles.find(Key);
+    if (It == Preambles.end())
+      return None;
+    for (const CachedEntry &CE : It->second) {
+      if (auto Preamble = CE.Preamble.lock()) {
+        if (Preamble->getBounds().Size != Bounds.Size)
+          continue;
+        Candidates.push_back(CE.Results);
+        Candidates.back().Preamble = std::move(Preamble);
+      }
+    }
+  }
+
+  for (Entry &E : Candidates)
+    if (E.Preamble->CanReuse(Invocation, MainFileBuffer, Bounds, VFS))
+      return std::move(E);
+  return None;
+}
+
+void PreambleCache::insert(StringRef Key, Entry E) {
+  CachedEntry CE;
+  CE.Preamble = E.Preamble;
+  CE.Results = std::move(E);
+  CE.Results.Preamble = nullptr;
+
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  std::vector<CachedEntry> &Entries = Preambles[Key];
+  // Drop the preambles which were freed by all of their units.
+  Entries.erase(llvm::remove_if(Entries,
+                                [](const CachedEntry &CE) {
+                                  return CE.Preamble.expired();
+                                }),
+                Entries.end());
+  Entries.push_back(std::move(CE));
+}
@@ -375,9 +375,15 @@ llvm::ErrorOr<PrecompiledPreamble> PrecompiledPreamble::Build(
       continue;
     auto File = *FileOrErr;
     if (time_t ModTime = File->getModificationTime()) {
+      // Remember the contents of the file too, which were read to build the
+      // preamble, for a change of the modification time alone not to
+      // invalidate it.
+      bool Invalid = false;
+      const llvm::MemoryBuffer *Buffer =
+          SourceMgr.getMemoryBufferForFile(File, &Invalid);
       FilesInPreamble[File->getName()] =
-          PrecompiledPreamble::PreambleFileHash::createForFile(File->getSize(),
-                                                               ModTime);
+          PrecompiledPreamble::PreambleFileHash::createForFile(
+              File->getSize(), ModTime, Invalid ? nullptr : Buffer);
     } else {
       const llvm::MemoryBuffer *Buffer = SourceMgr.getMemoryBufferForFile(File);
       FilesInPreamble[File->getName()] =
@@ -415,6 +421,27 @@ std::size_t PrecompiledPreamble::getSize() const {
   llvm_unreachable("Unhandled storage kind");
 }
 
+bool PrecompiledPreamble::writePCH(raw_ostream &OS) const {
+  switch (Storage.getKind()) {
+  case PCHStorage::Kind::Empty:
+    assert(false && "Calling writePCH() on invalid PrecompiledPreamble. "
+                    "Was it std::moved?");
+    return false;
+  case PCHStorage::Kind::InMemory:
+    OS << Storage.asMemory().Data;
+    return true;
+  case PCHStorage::Kind::TempFile: {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(Storage.asFile().getFilePath());
+    if (!Buffer)
+      return false;
+    OS << (*Buffer)->getBuffer();
+    return true;
+  }
+  }
+  llvm_unreachable("Unhandled storage kind");
+}
+
 bool PrecompiledPreamble::CanReuse(const CompilerInvocation &Invocation,
                                    const llvm::MemoryBuffer *MainFileBuffer,
                                    PreambleBounds Bounds,
@@ -498,10 +525,23 @@ bool PrecompiledPreamble::CanReuse(const CompilerInvocation &Invocation,
 
     // Neither the file's buffer nor the file itself was remapped;
     // check whether it has changed on disk.
-    if (Status.getSize() != uint64_t(F.second.Size) ||
-        llvm::sys::toTimeT(Status.getLastModificationTime()) !=
-            F.second.ModTime)
+    if (Status.getSize() != uint64_t(F.second.Size))
       return false;
+    if (llvm::sys::toTimeT(Status.getLastModificationTime()) !=
+        F.second.ModTime) {
+      // The file was touched, e.g. saved without changes or regenerated by
+      // the build, or the buffer it was remapped to was dropped. It has only
+      // changed if its contents did. The preamble is loaded without
+      // validating the modification times of its inputs.
+      if (!F.second.hasMD5())
+        return false;
+      auto Buffer = VFS->getBufferForFile(F.first());
+      if (!Buffer)
+        return false;
+      if (!F.second.hasSameContents(
+              PreambleFileHash::createForMemoryBuffer(Buffer->get())))
+        return false;
+    }
   }
   return true;
 }
@@ -677,12 +717,17 @@ void PrecompiledPreamble::PCHStorage::setEmpty() {
 }
 
 PrecompiledPreamble::PreambleFileHash
-PrecompiledPreamble::PreambleFileHash::createForFile(off_t Size,
-                                                     time_t ModTime) {
+PrecompiledPreamble::PreambleFileHash::createForFile(
+    off_t Size, time_t ModTime, const llvm::MemoryBuffer *Contents) {
   PreambleFileHash Result;
   Result.Size = Size;
   Result.ModTime = ModTime;
   Result.MD5 = {};
+  if (Contents) {
+    llvm::MD5 MD5Ctx;
+    MD5Ctx.update(Contents->getBuffer());
+    MD5Ctx.final(Result.MD5);
+  }
   return Result;
 }
 
@@ -694,7 +739,7 @@ PrecompiledPreamble::PreambleFileHash::createForMemoryBuffer(
   Result.ModTime = 0;
 
   llvm::MD5 MD5Ctx;
-  MD5Ctx.update(Buffer->getBuffer().data());
+  MD5Ctx.update(Buffer->getBuffer());
   MD5Ctx.final(Result.MD5);
 
   return Result;
@@ -709,11 +709,25 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+/// Whether \p Tok can be printed by copying its source text.
+static bool canCopySourceOfToken(const Token &Tok) {
+  return Tok.getLocation().isFileID() && !Tok.needsCleaning() &&
+         !Tok.isAnnotation() &&
+         !Tok.isOneOf(tok::comment, tok::unknown, tok::eod, tok::eof);
+}
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
-                                    raw_ostream &OS) {
+                                    raw_ostream &OS, bool CopySourceSpans) {
   bool DropComments = PP.getLangOpts().TraditionalCPP &&
                       !PP.getCommentRetentionState();
+  SourceManager &SM = PP.getSourceManager();
+
+  // The end of the last token printed from its source text, when printing
+  // the unexpanded tokens by copying the source.
+  FileID SpanFID;
+  StringRef SpanBuffer;
+  unsigned SpanEnd = 0;
 
   char Buffer[256];
   Token PrevPrevTok, PrevTok;
@@ -725,6 +739,29 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
       Callbacks->MoveToLine(Tok.getLocation());
     }
 
+    // A token that follows the previous one on the same line of the same file,
+    // separated by whitespace only, is printed along with that whitespace by
+    // copying the source text. It needs neither its spelling nor any check
+    // that it doesn't concatenate with the previous token.
+    std::pair<FileID, unsigned> TokLoc;
+    if (CopySourceSpans && canCopySourceOfToken(Tok)) {
+      TokLoc = SM.getDecomposedLoc(Tok.getLocation());
+      if (SpanFID.isValid() && TokLoc.first == SpanFID &&
+          TokLoc.second >= SpanEnd && !Tok.isAtStartOfLine() &&
+          Callbacks->hasEmittedTokensOnThisLine() &&
+          SpanBuffer.slice(SpanEnd, TokLoc.second).find_first_not_of(" \t") ==
+              StringRef::npos) {
+        unsigned TokEnd = TokLoc.second + Tok.getLength();
+        OS << SpanBuffer.slice(SpanEnd, TokEnd);
+        SpanEnd = TokEnd;
+
+        PrevPrevTok = PrevTok;
+        PrevTok = Tok;
+        PP.Lex(Tok);
+        continue;
+      }
+    }
+
     // If this token is at the start of a line, emit newlines if needed.
     if (Tok.isAtStartOfLine() && Callbacks->HandleFirstTokOnLine(Tok)) {
       // done.
@@ -809,6 +846,18 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
     }
     Callbacks->setEmittedTokensOnThisLine();
 
+    if (CopySourceSpans) {
+      if (TokLoc.first.isValid()) {
+        if (TokLoc.first != SpanFID) {
+          SpanFID = TokLoc.first;
+          SpanBuffer = SM.getBufferData(SpanFID);
+        }
+        SpanEnd = TokLoc.second + Tok.getLength();
+      } else {
+        SpanFID = FileID();
+      }
+    }
+
     if (Tok.is(tok::eof)) break;
 
     PrevPrevTok = PrevTok;
@@ -926,7 +975,7 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
   } while (true);
 
   // Read all the preprocessed tokens, printing them out to the stream.
-  PrintPreprocessedTokens(PP, Tok, Callbacks, *OS);
+  PrintPreprocessedTokens(PP, Tok, Callbacks, *OS, Opts.CopySourceSpans);
   *OS << '\n';
 
   // Remove the handlers we just added to leave the preprocessor in a sane state
@@ -24,13 +24,16 @@
 #include "clang/Rewrite/Core/RewriteBuffer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
 #include <memory>
 #include <string>
 #include <system_error>
 #include <utility>
+#include <vector>
 
 using namespace clang;
 
@@ -58,19 +61,27 @@ bool FixItRewriter::WriteFixedFile(FileID ID, raw_ostream &OS) {
 
 namespace {
 
+/// Collects the rewrites, which don't overlap, to apply them to the Rewriter
+/// at once.
 class RewritesReceiver : public edit::EditsReceiver {
   Rewriter &Rewrite;
+  std::vector<Rewriter::Edit> Edits;
+  llvm::BumpPtrAllocator Allocator;
+  llvm::StringSaver Saver{Allocator};
 
 public:
   RewritesReceiver(Rewriter &Rewrite) : Rewrite(Rewrite) {}
 
   void insert(SourceLocation loc, StringRef text) override {
-    Rewrite.InsertText(loc, text);
+    Edits.push_back(
+        {CharSourceRange::getCharRange(loc, loc), Saver.save(text)});
   }
 
   void replace(CharSourceRange range, StringRef text) override {
-    Rewrite.ReplaceText(range.getBegin(), Rewrite.getRangeSize(range), text);
+    Edits.push_back({range, Saver.save(text)});
   }
+
+  void apply() { Rewrite.ApplyEdits(Edits); }
 };
 
 } // namespace
@@ -84,6 +95,7 @@ bool FixItRewriter::WriteFixedFiles(
 
   RewritesReceiver Rec(Rewrite);
   Editor.applyRewrites(Rec);
+  Rec.apply();
 
   if (FixItOpts->InPlace) {
     // Overwriting open files on Windows is tricky, but the rewriter can do it
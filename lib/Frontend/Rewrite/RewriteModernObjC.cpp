@@ -5857,7 +5857,7 @@ void RewriteModernObjC::HandleTranslationUnit(ASTContext &C) {
   if (const RewriteBuffer *RewriteBuf =
       Rewrite.getRewriteBufferFor(MainFileID)) {
     //printf("Changed:\n");
-    *OutFile << std::string(RewriteBuf->begin(), RewriteBuf->end());
+    RewriteBuf->write(*OutFile);
   } else {
     llvm::errs() << "No changes\n";
   }
@@ -4916,7 +4916,7 @@ void RewriteObjC::HandleTranslationUnit(ASTContext &C) {
   if (const RewriteBuffer *RewriteBuf =
       Rewrite.getRewriteBufferFor(MainFileID)) {
     //printf("Changed:\n");
-    *OutFile << std::string(RewriteBuf->begin(), RewriteBuf->end());
+    RewriteBuf->write(*OutFile);
   } else {
     llvm::errs() << "No changes\n";
   }
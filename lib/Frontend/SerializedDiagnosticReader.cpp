@@ -7,8 +7,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Frontend/SerializedDiagnosticReader.h"
-#include "clang/Basic/FileManager.h"
-#include "clang/Basic/FileSystemOptions.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
@@ -19,6 +17,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <cstdint>
 #include <system_error>
 
@@ -26,16 +25,65 @@ using namespace clang;
 using namespace serialized_diags;
 
 std::error_code SerializedDiagnosticReader::readDiagnostics(StringRef File) {
-  // Open the diagnostics file.
-  FileSystemOptions FO;
-  FileManager FileMgr(FO);
-
-  auto Buffer = FileMgr.getBufferForFile(File);
+  // Open the diagnostics file, which is memory mapped if it is large enough.
+  auto Buffer = llvm::MemoryBuffer::getFile(File, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!Buffer)
     return SDError::CouldNotLoad;
 
-  llvm::BitstreamCursor Stream(**Buffer);
-  Optional<llvm::BitstreamBlockInfo> BlockInfo;
+  return readDiagnostics(**Buffer);
+}
+
+std::error_code
+SerializedDiagnosticReader::readDiagnostics(llvm::MemoryBufferRef Buffer) {
+  return readDiagnostics(Buffer, /*IndexOnly=*/false);
+}
+
+std::error_code
+SerializedDiagnosticReader::indexDiagnostics(llvm::MemoryBufferRef Buffer) {
+  return readDiagnostics(Buffer, /*IndexOnly=*/true);
+}
+
+std::error_code
+SerializedDiagnosticReader::readDiagnosticAt(llvm::MemoryBufferRef Buffer,
+                                             uint64_t BitOffset) {
+  if (!BlockInfo)
+    return SDError::MalformedBlockInfoBlock;
+
+  llvm::BitstreamCursor Stream(Buffer);
+  Stream.setBlockInfo(&*BlockInfo);
+  if (llvm::Error Err = Stream.JumpToBit(BitOffset)) {
+    // FIXME this drops the error on the floor.
+    consumeError(std::move(Err));
+    return SDError::InvalidDiagnostics;
+  }
+
+  Expected<unsigned> MaybeCode = Stream.ReadCode();
+  if (!MaybeCode) {
+    // FIXME this drops the error on the floor.
+    consumeError(MaybeCode.takeError());
+    return SDError::InvalidDiagnostics;
+  }
+  Expected<unsigned> MaybeSubBlockID = Stream.ReadSubBlockID();
+  if (!MaybeSubBlockID) {
+    // FIXME this drops the error on the floor.
+    consumeError(MaybeSubBlockID.takeError());
+    return SDError::InvalidDiagnostics;
+  }
+  if (MaybeCode.get() != llvm::bitc::ENTER_SUBBLOCK ||
+      MaybeSubBlockID.get() != BLOCK_DIAG)
+    return SDError::MalformedDiagnosticBlock;
+
+  IndexOnly = false;
+  return readDiagnosticBlock(Stream);
+}
+
+std::error_code
+SerializedDiagnosticReader::readDiagnostics(llvm::MemoryBufferRef Buffer,
+                                            bool OnlyIndex) {
+  llvm::BitstreamCursor Stream(Buffer);
+  BlockInfo = None;
+  IndexOnly = OnlyIndex;
 
   if (Stream.AtEndOfStream())
     return SDError::InvalidSignature;
@@ -54,6 +102,7 @@ std::error_code SerializedDiagnosticReader::readDiagnostics(StringRef File) {
 
   // Read the top level blocks.
   while (!Stream.AtEndOfStream()) {
+    uint64_t BlockOffset = Stream.GetCurrentBitNo();
     if (Expected<unsigned> Res = Stream.ReadCode()) {
       if (Res.get() != llvm::bitc::ENTER_SUBBLOCK)
         return SDError::InvalidDiagnostics;
@@ -91,7 +140,8 @@ std::error_code SerializedDiagnosticReader::readDiagnostics(StringRef File) {
         return EC;
       continue;
     case BLOCK_DIAG:
-      if ((EC = readDiagnosticBlock(Stream)))
+      if ((EC = readDiagnosticBlock(
+               Stream, IndexOnly ? Optional<uint64_t>(BlockOffset) : None)))
         return EC;
       continue;
     default:
@@ -207,8 +257,8 @@ SerializedDiagnosticReader::readMetaBlock(llvm::BitstreamCursor &Stream) {
   }
 }
 
-std::error_code
-SerializedDiagnosticReader::readDiagnosticBlock(llvm::BitstreamCursor &Stream) {
+std::error_code SerializedDiagnosticReader::readDiagnosticBlock(
+    llvm::BitstreamCursor &Stream, Optional<uint64_t> IndexedOffset) {
   if (llvm::Error Err =
           Stream.EnterSubBlock(clang::serialized_diags::BLOCK_DIAG)) {
     // FIXME this drops the error on the floor.
@@ -216,8 +266,12 @@ SerializedDiagnosticReader::readDiagnosticBlock(llvm::BitstreamCursor &Stream) {
     return SDError::MalformedDiagnosticBlock;
   }
 
+  // When indexing, the records which define the categories, flags and files
+  // are still visited, since they are only written before their first use.
+  const bool VisitDiagnostic = !IndexOnly;
+
   std::error_code EC;
-  if ((EC = visitStartOfDiagnostic()))
+  if (VisitDiagnostic && (EC = visitStartOfDiagnostic()))
     return EC;
 
   SmallVector<uint64_t, 16> Record;
@@ -240,7 +294,7 @@ SerializedDiagnosticReader::readDiagnosticBlock(llvm::BitstreamCursor &Stream) {
       }
       continue;
     case Cursor::BlockEnd:
-      if ((EC = visitEndOfDiagnostic()))
+      if (VisitDiagnostic && (EC = visitEndOfDiagnostic()))
         return EC;
       return {};
     case Cursor::Record:
@@ -273,10 +327,19 @@ SerializedDiagnosticReader::readDiagnosticBlock(llvm::BitstreamCursor &Stream) {
       // size.
       if (Record.size() != 8)
         return SDError::MalformedDiagnosticRecord;
-      if ((EC = visitDiagnosticRecord(
-               Record[0], Location(Record[1], Record[2], Record[3], Record[4]),
-               Record[5], Record[6], Blob)))
+      if (IndexedOffset) {
+        if ((EC = visitIndexedDiagnostic(
+                 *IndexedOffset, Record[0],
+                 Location(Record[1], Record[2], Record[3], Record[4]),
+                 Record[5], Record[6], Blob)))
+          return EC;
+      } else if (VisitDiagnostic &&
+                 (EC = visitDiagnosticRecord(
+                      Record[0],
+                      Location(Record[1], Record[2], Record[3], Record[4]),
+                      Record[5], Record[6], Blob))) {
         return EC;
+      }
       continue;
     case RECORD_DIAG_FLAG:
       // A diagnostic flag has ID and name size.
@@ -297,16 +360,19 @@ SerializedDiagnosticReader::readDiagnosticBlock(llvm::BitstreamCursor &Stream) {
       // A fixit has two locations (4 each) and message size.
       if (Record.size() != 9)
         return SDError::MalformedDiagnosticRecord;
-      if ((EC = visitFixitRecord(
+      if (VisitDiagnostic &&
+          (EC = visitFixitRecord(
                Location(Record[0], Record[1], Record[2], Record[3]),
-               Location(Record[4], Record[5], Record[6], Record[7]), Blob)))
+               Location(Record[4], Record[5], Record[6], Record[7]),
+               Blob)))
         return EC;
       continue;
     case RECORD_SOURCE_RANGE:
       // A source range is two locations (4 each).
       if (Record.size() != 8)
         return SDError::MalformedDiagnosticRecord;
-      if ((EC = visitSourceRangeRecord(
+      if (VisitDiagnostic &&
+          (EC = visitSourceRangeRecord(
                Location(Record[0], Record[1], Record[2], Record[3]),
                Location(Record[4], Record[5], Record[6], Record[7]))))
         return EC;
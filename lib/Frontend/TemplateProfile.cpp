@@ -0,0 +1,202 @@
+//===- TemplateProfile.cpp - Aggregated template instantiation costs ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the -ftemplate-profile report, which attributes the
+// time and the AST memory spent instantiating templates to the templates that
+// were instantiated.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Sema/TemplateInstCallback.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+
+using namespace clang;
+
+namespace {
+/// Find the template whose instantiation \p D is: the primary template of a
+/// specialization, or the member of a class template that \p D instantiates.
+const Decl *getInstantiatedTemplate(const Decl *D) {
+  if (const auto *Spec = dyn_cast<ClassTemplateSpecializationDecl>(D))
+    return Spec->getSpecializedTemplate();
+  if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
+    if (const CXXRecordDecl *Member = RD->getInstantiatedFromMemberClass())
+      return Member;
+  } else if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+    if (const FunctionTemplateDecl *Primary = FD->getPrimaryTemplate())
+      return Primary;
+    if (const FunctionDecl *Member = FD->getInstantiatedFromMemberFunction())
+      return Member;
+  } else if (const auto *Spec = dyn_cast<VarTemplateSpecializationDecl>(D)) {
+    return Spec->getSpecializedTemplate();
+  } else if (const auto *VD = dyn_cast<VarDecl>(D)) {
+    if (const VarDecl *Member = VD->getInstantiatedFromStaticDataMember())
+      return Member;
+  } else if (const auto *ED = dyn_cast<EnumDecl>(D)) {
+    if (const EnumDecl *Member = ED->getInstantiatedFromMemberEnum())
+      return Member;
+  }
+  return D;
+}
+
+class TemplateProfileCallback : public TemplateInstantiationCallback {
+  using Clock = std::chrono::steady_clock;
+
+  /// The costs of the instantiations of one template.
+  struct Entry {
+    uint64_t Count = 0;
+    /// The costs including those of the instantiations of other templates
+    /// that this template's instantiations triggered. Recursive instantiations
+    /// of the same template are only counted once.
+    Clock::duration InclusiveTime{};
+    uint64_t InclusiveBytes = 0;
+    /// The costs of the instantiations of this template alone.
+    Clock::duration ExclusiveTime{};
+    uint64_t ExclusiveBytes = 0;
+    /// The number of instantiations of this template in progress.
+    unsigned Active = 0;
+  };
+
+  /// An instantiation in progress.
+  struct Frame {
+    const Decl *Template;
+    Clock::time_point StartTime;
+    uint64_t StartBytes;
+    Clock::duration ChildTime{};
+    uint64_t ChildBytes = 0;
+  };
+
+  std::string OutputFile;
+  llvm::DenseMap<const Decl *, Entry> Entries;
+  std::vector<Frame> Stack;
+
+  static bool isInstantiation(const Sema::CodeSynthesisContext &Inst) {
+    return Inst.Kind == Sema::CodeSynthesisContext::TemplateInstantiation &&
+           Inst.Entity;
+  }
+
+  static uint64_t getAllocatedBytes(const Sema &TheSema) {
+    return TheSema.getASTContext().getAllocator().getBytesAllocated();
+  }
+
+public:
+  explicit TemplateProfileCallback(StringRef OutputFile)
+      : OutputFile(OutputFile) {}
+
+  void initialize(const Sema &) override {}
+
+  void atTemplateBegin(const Sema &TheSema,
+                       const Sema::CodeSynthesisContext &Inst) override {
+    if (!isInstantiation(Inst))
+      return;
+    const Decl *Template =
+        getInstantiatedTemplate(Inst.Entity)->getCanonicalDecl();
+    ++Entries[Template].Active;
+    Stack.push_back({Template, Clock::now(), getAllocatedBytes(TheSema)});
+  }
+
+  void atTemplateEnd(const Sema &TheSema,
+                     const Sema::CodeSynthesisContext &Inst) override {
+    if (!isInstantiation(Inst) || Stack.empty())
+      return;
+    Frame F = Stack.back();
+    Stack.pop_back();
+
+    Clock::duration Time = Clock::now() - F.StartTime;
+    uint64_t Bytes = getAllocatedBytes(TheSema) - F.StartBytes;
+    Entry &E = Entries[F.Template];
+    ++E.Count;
+    E.ExclusiveTime += Time - F.ChildTime;
+    E.ExclusiveBytes += Bytes - F.ChildBytes;
+    if (--E.Active == 0) {
+      E.InclusiveTime += Time;
+      E.InclusiveBytes += Bytes;
+    }
+    if (!Stack.empty()) {
+      Stack.back().ChildTime += Time;
+      Stack.back().ChildBytes += Bytes;
+    }
+  }
+
+  void finalize(const Sema &TheSema) override {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+      TheSema.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << OutputFile << EC.message();
+      return;
+    }
+    write(TheSema, OS);
+  }
+
+private:
+  /// Write the report as JSON. The entries are keyed by template name and
+  /// location, so that the reports of several translation units can be
+  /// merged by adding up the fields of the entries with the same key.
+  void write(const Sema &TheSema, raw_ostream &OS) {
+    using namespace std::chrono;
+    SourceManager &SM = TheSema.getSourceManager();
+
+    std::vector<std::pair<const Decl *, const Entry *>> Sorted;
+    for (const auto &E : Entries)
+      Sorted.push_back({E.first, &E.second});
+    llvm::sort(Sorted, [](const auto &LHS, const auto &RHS) {
+      return LHS.second->ExclusiveTime > RHS.second->ExclusiveTime;
+    });
+
+    llvm::json::Array Templates;
+    for (const auto &E : Sorted) {
+      std::string Name;
+      if (const auto *ND = dyn_cast<NamedDecl>(E.first)) {
+        llvm::raw_string_ostream NameOS(Name);
+        ND->getNameForDiagnostic(NameOS, TheSema.getLangOpts(),
+                                 /*Qualified=*/true);
+      }
+      std::string Location;
+      PresumedLoc Loc = SM.getPresumedLoc(E.first->getLocation());
+      if (Loc.isValid())
+        Location = std::string(Loc.getFilename()) + ":" +
+                   std::to_string(Loc.getLine()) + ":" +
+                   std::to_string(Loc.getColumn());
+
+      const Entry &Costs = *E.second;
+      Templates.push_back(llvm::json::Object{
+          {"name", std::move(Name)},
+          {"location", std::move(Location)},
+          {"count", int64_t(Costs.Count)},
+          {"inclusive_us",
+           int64_t(duration_cast<microseconds>(Costs.InclusiveTime).count())},
+          {"exclusive_us",
+           int64_t(duration_cast<microseconds>(Costs.ExclusiveTime).count())},
+          {"inclusive_bytes", int64_t(Costs.InclusiveBytes)},
+          {"exclusive_bytes", int64_t(Costs.ExclusiveBytes)},
+      });
+    }
+
+    OS << llvm::formatv("{0:2}\n",
+                        llvm::json::Value(llvm::json::Object{
+                            {"version", 1},
+                            {"templates", std::move(Templates)},
+                        }));
+  }
+};
+} // namespace
+
+std::unique_ptr<TemplateInstantiationCallback>
+clang::createTemplateProfileCallback(StringRef OutputFile) {
+  return std::make_unique<TemplateProfileCallback>(OutputFile);
+}
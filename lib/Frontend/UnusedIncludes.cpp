@@ -0,0 +1,236 @@
+//===- UnusedIncludes.cpp - Includes whose declarations are never used ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements -Wunused-include, which diagnoses the includes of the
+// main file that neither the included header nor the headers it includes
+// declare anything used by the rest of the translation unit.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/DeclBase.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/MacroInfo.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Sema/DeclReferenceCallback.h"
+#include "clang/Sema/Sema.h"
+#include "clang/Tooling/Inclusions/HeaderIncludes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FormatVariadic.h"
+#include <chrono>
+
+using namespace clang;
+
+namespace {
+/// Tracks the includes of the main file, and which of them provide the
+/// declarations and the macros that are used.
+///
+/// A use marks the include the used declaration was entered through, unless
+/// the use itself comes from that include. The includes which provide
+/// something to the other includes are thus kept too.
+class UnusedIncludeFinder : public PPCallbacks {
+  using Clock = std::chrono::steady_clock;
+
+  struct Include {
+    SourceLocation HashLoc;
+    std::string Spelling;
+    bool IsAngled;
+    /// The included file, which is invalid until it is entered and stays
+    /// invalid if the file was skipped, e.g. because of its include guard.
+    FileID ID;
+    /// The time spent while the included file was being lexed, the
+    /// inclusive time of -fheader-cost-report.
+    Clock::duration Time{};
+    bool Used = false;
+  };
+
+  CompilerInstance &CI;
+  SourceManager &SM;
+  std::vector<Include> Includes;
+
+  /// The index of the include of the main file each file was entered
+  /// through, or -1 for the main file and the buffers which aren't included.
+  llvm::DenseMap<FileID, int> IncludeOfFile;
+
+  /// The include whose file is about to be entered.
+  Optional<unsigned> Pending;
+
+  /// The include whose file is being lexed, and when it was entered.
+  Optional<unsigned> Current;
+  Clock::time_point StartTime;
+
+  int getIncludeOf(SourceLocation Loc) {
+    FileID ID = SM.getFileID(SM.getExpansionLoc(Loc));
+    SmallVector<FileID, 4> Visited;
+    int Result = -1;
+    while (ID.isValid() && ID != SM.getMainFileID()) {
+      auto It = IncludeOfFile.find(ID);
+      if (It != IncludeOfFile.end()) {
+        Result = It->second;
+        break;
+      }
+      Visited.push_back(ID);
+      ID = SM.getFileID(SM.getIncludeLoc(ID));
+    }
+    for (FileID V : Visited)
+      IncludeOfFile[V] = Result;
+    return Result;
+  }
+
+public:
+  explicit UnusedIncludeFinder(CompilerInstance &CI)
+      : CI(CI), SM(CI.getSourceManager()) {}
+
+  /// Note that the entity declared at \p DeclLoc is used at \p UseLoc.
+  void markUsed(SourceLocation UseLoc, SourceLocation DeclLoc) {
+    if (DeclLoc.isInvalid())
+      return;
+    int User = UseLoc.isValid() ? getIncludeOf(UseLoc) : -1;
+    // A declaration written by a macro expansion comes from both the file of
+    // the expansion and the file of the macro definition.
+    for (SourceLocation Loc :
+         {SM.getExpansionLoc(DeclLoc), SM.getSpellingLoc(DeclLoc)}) {
+      int Provider = getIncludeOf(Loc);
+      if (Provider >= 0 && Provider != User)
+        Includes[Provider].Used = true;
+    }
+  }
+
+  void InclusionDirective(SourceLocation HashLoc, const Token &IncludeTok,
+                          StringRef FileName, bool IsAngled,
+                          CharSourceRange FilenameRange, const FileEntry *File,
+                          StringRef SearchPath, StringRef RelativePath,
+                          const Module *Imported,
+                          SrcMgr::CharacteristicKind FileType) override {
+    Pending = None;
+    if (!File || Imported || !SM.isWrittenInMainFile(HashLoc))
+      return;
+    Includes.push_back({HashLoc, FileName, IsAngled});
+    Pending = Includes.size() - 1;
+  }
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile && Pending) {
+      FileID ID = SM.getFileID(Loc);
+      Includes[*Pending].ID = ID;
+      IncludeOfFile[ID] = *Pending;
+      Current = Pending;
+      Pending = None;
+      StartTime = Clock::now();
+    } else if (Reason == ExitFile && Current &&
+               PrevFID == Includes[*Current].ID) {
+      Includes[*Current].Time += Clock::now() - StartTime;
+      Current = None;
+    }
+  }
+
+  void FileSkipped(const FileEntryRef &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override {
+    Pending = None;
+  }
+
+  void MacroExpands(const Token &MacroNameTok, const MacroDefinition &MD,
+                    SourceRange Range, const MacroArgs *Args) override {
+    markMacroUsed(MacroNameTok.getLocation(), MD);
+  }
+
+  void Defined(const Token &MacroNameTok, const MacroDefinition &MD,
+               SourceRange Range) override {
+    markMacroUsed(MacroNameTok.getLocation(), MD);
+  }
+
+  void Ifdef(SourceLocation Loc, const Token &MacroNameTok,
+             const MacroDefinition &MD) override {
+    markMacroUsed(Loc, MD);
+  }
+
+  void Ifndef(SourceLocation Loc, const Token &MacroNameTok,
+              const MacroDefinition &MD) override {
+    markMacroUsed(Loc, MD);
+  }
+
+  /// Diagnose the unused includes, the most expensive ones first.
+  void report() {
+    DiagnosticsEngine &Diags = CI.getDiagnostics();
+    // After an error, some of the uses may not have been seen.
+    if (Diags.hasUncompilableErrorOccurred())
+      return;
+
+    std::vector<const Include *> Unused;
+    for (const Include &I : Includes)
+      if (!I.Used && I.ID.isValid())
+        Unused.push_back(&I);
+    llvm::stable_sort(Unused, [](const Include *LHS, const Include *RHS) {
+      return LHS->Time > RHS->Time;
+    });
+    if (Unused.empty())
+      return;
+
+    FileID MainFID = SM.getMainFileID();
+    const FileEntry *MainFile = SM.getFileEntryForID(MainFID);
+    tooling::HeaderIncludes Directives(MainFile ? MainFile->getName() : "",
+                                       SM.getBufferData(MainFID),
+                                       tooling::IncludeStyle());
+    SourceLocation FileStart = SM.getLocForStartOfFile(MainFID);
+    for (const Include *I : Unused) {
+      double Milliseconds =
+          std::chrono::duration<double, std::milli>(I->Time).count();
+      auto Diag = Diags.Report(I->HashLoc, diag::warn_fe_unused_include)
+                  << I->Spelling << llvm::formatv("{0:f1}", Milliseconds).str();
+      // The removal of a header included more than once would remove all of
+      // its includes.
+      tooling::Replacements Removals =
+          Directives.remove(I->Spelling, I->IsAngled);
+      if (Removals.size() != 1)
+        continue;
+      const tooling::Replacement &Removal = *Removals.begin();
+      SourceLocation Start = FileStart.getLocWithOffset(Removal.getOffset());
+      Diag << FixItHint::CreateRemoval(CharSourceRange::getCharRange(
+          Start, Start.getLocWithOffset(Removal.getLength())));
+    }
+  }
+
+private:
+  void markMacroUsed(SourceLocation Loc, const MacroDefinition &MD) {
+    if (const MacroInfo *MI = MD.getMacroInfo())
+      markUsed(Loc, MI->getDefinitionLoc());
+  }
+};
+
+/// Forwards the references Sema sees to the UnusedIncludeFinder, which the
+/// preprocessor owns and outlives Sema.
+class UnusedIncludeReferences : public DeclReferenceCallback {
+  UnusedIncludeFinder &Finder;
+
+public:
+  explicit UnusedIncludeReferences(UnusedIncludeFinder &Finder)
+      : Finder(Finder) {}
+
+  void referenced(const Sema &TheSema, SourceLocation Loc,
+                  const Decl *D) override {
+    // Any redeclaration, e.g. the definition of a class that is used through
+    // a forward declaration, may be what the use needs.
+    for (const Decl *R : D->redecls())
+      Finder.markUsed(Loc, R->getLocation());
+  }
+
+  void finalize(const Sema &TheSema) override { Finder.report(); }
+};
+} // namespace
+
+void clang::AttachUnusedIncludeFinder(CompilerInstance &CI) {
+  auto Finder = std::make_unique<UnusedIncludeFinder>(CI);
+  CI.getSema().DeclReferenceCallbacks.push_back(
+      std::make_unique<UnusedIncludeReferences>(*Finder));
+  CI.getPreprocessor().addPPCallbacks(std::move(Finder));
+}
@@ -15,13 +15,17 @@
 #include "clang/CodeGen/CodeGenAction.h"
 #include "clang/Config/config.h"
 #include "clang/Driver/Options.h"
+#include "clang/Frontend/AutoPCH.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendPluginRegistry.h"
+#include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/FrontendTool/Utils.h"
+#include "clang/Index/IndexRecord.h"
+#include "clang/Index/IndexingAction.h"
 #include "clang/Rewrite/Frontend/FrontendActions.h"
 #include "clang/StaticAnalyzer/Frontend/FrontendActions.h"
 #include "llvm/Option/OptTable.h"
@@ -34,6 +38,55 @@ using namespace llvm::opt;
 
 namespace clang {
 
+namespace {
+/// Runs the wrapped action along with the consumers of the secondary outputs
+/// of the translation unit, so that all of them share one parse.
+class SecondaryOutputsAction : public WrapperFrontendAction {
+public:
+  using WrapperFrontendAction::WrapperFrontendAction;
+
+protected:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef InFile) override;
+};
+} // namespace
+
+std::unique_ptr<ASTConsumer>
+SecondaryOutputsAction::CreateASTConsumer(CompilerInstance &CI,
+                                          StringRef InFile) {
+  std::unique_ptr<ASTConsumer> Consumer =
+      WrapperFrontendAction::CreateASTConsumer(CI, InFile);
+  if (!Consumer)
+    return nullptr;
+
+  // The secondary consumers come after the main one, like the plugins which
+  // are added after the main action.
+  const FrontendOptions &FEOpts = CI.getFrontendOpts();
+  std::vector<std::unique_ptr<ASTConsumer>> Consumers;
+  Consumers.push_back(std::move(Consumer));
+  if (!FEOpts.IndexRecordPath.empty())
+    Consumers.push_back(index::createIndexingASTConsumer(
+        std::make_shared<index::IndexRecordWriter>(FEOpts.IndexRecordPath,
+                                                   /*WriteUnit=*/true),
+        index::IndexingOptions(), CI.getPreprocessorPtr()));
+  if (!FEOpts.ASTOutputFile.empty()) {
+    std::string Sysroot;
+    if (!GeneratePCHAction::ComputeASTConsumerArguments(CI, Sysroot))
+      return nullptr;
+    std::unique_ptr<raw_pwrite_stream> OS = CI.createOutputFile(
+        FEOpts.ASTOutputFile, /*Binary=*/true, /*RemoveFileOnSignal=*/false,
+        InFile, /*Extension=*/"", /*UseTemporary=*/true);
+    if (!OS)
+      return nullptr;
+    Consumers.push_back(GeneratePCHAction::CreatePCHWriter(
+        CI, InFile, FEOpts.ASTOutputFile, std::move(OS), std::move(Sysroot)));
+  }
+  if (!FEOpts.InterfaceStubsOutputFile.empty())
+    Consumers.push_back(GenerateInterfaceIfsExpV1Action::CreateStubsWriter(
+        CI, InFile, FEOpts.InterfaceStubsOutputFile));
+  return std::make_unique<MultiplexConsumer>(std::move(Consumers));
+}
+
 static std::unique_ptr<FrontendAction>
 CreateFrontendBaseAction(CompilerInstance &CI) {
   using namespace clang::frontend;
@@ -173,6 +226,23 @@ CreateFrontendAction(CompilerInstance &CI) {
   }
 #endif
 
+  // Write the secondary outputs from the AST of the action.
+  StringRef SecondaryOutputOption;
+  if (!FEOpts.ASTOutputFile.empty())
+    SecondaryOutputOption = "-ast-output";
+  else if (!FEOpts.IndexRecordPath.empty())
+    SecondaryOutputOption = "-index-record-path";
+  else if (!FEOpts.InterfaceStubsOutputFile.empty())
+    SecondaryOutputOption = "-interface-stubs-output";
+  if (!SecondaryOutputOption.empty()) {
+    if (Act->usesPreprocessorOnly()) {
+      CI.getDiagnostics().Report(diag::err_fe_secondary_output_without_ast)
+          << SecondaryOutputOption;
+      return nullptr;
+    }
+    Act = std::make_unique<SecondaryOutputsAction>(std::move(Act));
+  }
+
   // If there are any AST files to merge, create a frontend action
   // adaptor to perform the merge.
   if (!FEOpts.ASTMergeFiles.empty())
@@ -283,6 +353,11 @@ bool ExecuteCompilerInvocation(CompilerInstance *Clang) {
   // If there were errors in processing arguments, don't do anything else.
   if (Clang->getDiagnostics().hasErrorOccurred())
     return false;
+
+  // Load the leading includes of the main file from the shared preambles.
+  if (!Clang->getFrontendOpts().AutoPCHPath.empty())
+    useAutoPCH(*Clang);
+
   // Create and execute the frontend action.
   std::unique_ptr<FrontendAction> Act(CreateFrontendAction(*Clang));
   if (!Act)
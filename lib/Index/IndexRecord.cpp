@@ -0,0 +1,445 @@
+//===--- IndexRecord.cpp - On-disk index records --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/IndexRecord.h"
+#include "FileIndexRecord.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace clang;
+using namespace clang::index;
+
+static const char RecordMagic[] = "IDXREC01";
+
+static_assert(sizeof(record::Header) == 32, "unexpected record header size");
+static_assert(sizeof(record::Symbol) == 32, "unexpected record symbol size");
+static_assert(sizeof(record::Occurrence) == 20,
+              "unexpected record occurrence size");
+
+namespace {
+/// A symbol of a record being written.
+struct SymbolData {
+  std::string USR;
+  std::string Name;
+  SymbolInfo Info;
+  /// The positions of the occurrences of the symbol in the record, in the
+  /// order of their offsets.
+  SmallVector<unsigned, 4> Occurrences;
+};
+} // namespace
+
+/// Serializes the occurrences of \p Record into \p Buffer.
+static void writeRecord(const FileIndexRecord &Record, const ASTContext &Ctx,
+                        USRCache &USRs, SmallVectorImpl<char> &Buffer) {
+  const SourceManager &SM = Ctx.getSourceManager();
+  FileID FID = Record.getFileID();
+
+  // Give each declaration a symbol. Declarations without a USR are not
+  // recorded, and the declarations with the same USR share their symbol.
+  const unsigned NoSymbol = ~0u;
+  std::vector<SymbolData> Symbols;
+  llvm::DenseMap<const Decl *, unsigned> SymbolOfDecl;
+  llvm::StringMap<unsigned> SymbolOfUSR;
+  std::vector<std::pair<unsigned, const DeclOccurrence *>> Occurrences;
+  SmallString<128> USR;
+  for (const DeclOccurrence &Occ : Record.getDeclOccurrencesSortedByOffset()) {
+    auto It = SymbolOfDecl.find(Occ.Dcl);
+    if (It == SymbolOfDecl.end()) {
+      unsigned Symbol = NoSymbol;
+      USR.clear();
+      if (!USRs.generateUSRForDecl(Occ.Dcl, USR)) {
+        auto Inserted = SymbolOfUSR.try_emplace(USR, Symbols.size());
+        Symbol = Inserted.first->second;
+        if (Inserted.second) {
+          Symbols.emplace_back();
+          SymbolData &S = Symbols.back();
+          S.USR = std::string(USR.str());
+          if (const auto *ND = dyn_cast<NamedDecl>(Occ.Dcl))
+            S.Name = ND->getQualifiedNameAsString();
+          S.Info = getSymbolInfo(Occ.Dcl);
+        }
+      }
+      It = SymbolOfDecl.insert({Occ.Dcl, Symbol}).first;
+    }
+    if (It->second == NoSymbol)
+      continue;
+    Symbols[It->second].Occurrences.push_back(Occurrences.size());
+    Occurrences.push_back({It->second, &Occ});
+  }
+
+  // Sort the symbols by USR, for the reader to find them by binary search.
+  std::vector<unsigned> Order(Symbols.size());
+  for (unsigned I = 0, E = Symbols.size(); I != E; ++I)
+    Order[I] = I;
+  llvm::sort(Order, [&](unsigned LHS, unsigned RHS) {
+    return Symbols[LHS].USR < Symbols[RHS].USR;
+  });
+  std::vector<unsigned> NewIndex(Symbols.size());
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    NewIndex[Order[I]] = I;
+
+  StringRef Path = getFilePath(SM.getFileEntryForID(FID));
+
+  std::string Strings;
+  auto AddString = [&Strings](StringRef S) {
+    uint32_t Offset = Strings.size();
+    Strings += S;
+    return Offset;
+  };
+
+  llvm::raw_svector_ostream OS(Buffer);
+  llvm::support::endian::Writer W(OS, llvm::support::little);
+  OS.write(RecordMagic, sizeof(RecordMagic) - 1);
+  W.write<uint32_t>(Symbols.size());
+  W.write<uint32_t>(Occurrences.size());
+  size_t StringTableSizePos = Buffer.size();
+  W.write<uint32_t>(0);
+  W.write<uint32_t>(AddString(Path));
+  W.write<uint32_t>(Path.size());
+  W.write<uint32_t>(0);
+
+  uint32_t FirstOccurrence = 0;
+  for (unsigned I : Order) {
+    const SymbolData &S = Symbols[I];
+    W.write<uint32_t>(AddString(S.USR));
+    W.write<uint32_t>(S.USR.size());
+    W.write<uint32_t>(AddString(S.Name));
+    W.write<uint32_t>(S.Name.size());
+    W.write<uint8_t>(static_cast<uint8_t>(S.Info.Kind));
+    W.write<uint8_t>(static_cast<uint8_t>(S.Info.SubKind));
+    W.write<uint8_t>(static_cast<uint8_t>(S.Info.Lang));
+    W.write<uint8_t>(0);
+    W.write<uint32_t>(S.Info.Properties);
+    W.write<uint32_t>(FirstOccurrence);
+    W.write<uint32_t>(S.Occurrences.size());
+    FirstOccurrence += S.Occurrences.size();
+  }
+
+  // The occurrences are grouped by symbol, and each occurrence remembers its
+  // position for the table of the occurrences sorted by offset.
+  std::vector<uint32_t> Position(Occurrences.size());
+  uint32_t Next = 0;
+  for (unsigned I : Order) {
+    for (unsigned OccIndex : Symbols[I].Occurrences) {
+      const DeclOccurrence &Occ = *Occurrences[OccIndex].second;
+      W.write<uint32_t>(NewIndex[I]);
+      W.write<uint32_t>(Occ.Roles);
+      W.write<uint32_t>(Occ.Offset);
+      W.write<uint32_t>(SM.getLineNumber(FID, Occ.Offset));
+      W.write<uint32_t>(SM.getColumnNumber(FID, Occ.Offset));
+      Position[OccIndex] = Next++;
+    }
+  }
+  for (uint32_t P : Position)
+    W.write<uint32_t>(P);
+
+  OS << Strings;
+  llvm::support::endian::write32le(Buffer.data() + StringTableSizePos,
+                                   Strings.size());
+}
+
+/// Writes \p Contents to \p Path through a temporary file, so that concurrent
+/// readers never read partial contents.
+static void writeAtomically(StringRef Path, StringRef Contents,
+                            DiagnosticsEngine &Diags) {
+  int FD;
+  SmallString<256> TempPath;
+  if (std::error_code EC =
+          llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath)) {
+    Diags.Report(diag::err_fe_unable_to_open_output) << Path << EC.message();
+    return;
+  }
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) {
+      Diags.Report(diag::err_fe_unable_to_open_output)
+          << TempPath << OS.error().message();
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, Path)) {
+    Diags.Report(diag::err_fe_unable_to_open_output) << Path << EC.message();
+    llvm::sys::fs::remove(TempPath);
+  }
+}
+
+/// The real path of the file \p FE, or its name if it has none.
+static StringRef getFilePath(const FileEntry *FE) {
+  StringRef Path = FE->tryGetRealPathName();
+  return Path.empty() ? FE->getName() : Path;
+}
+
+std::string IndexUnit::getPath(StringRef RecordDir, StringRef MainFilePath) {
+  SmallString<256> Path(RecordDir);
+  llvm::sys::path::append(
+      Path, llvm::sys::path::filename(MainFilePath) + "-" +
+                llvm::utohexstr(llvm::xxHash64(MainFilePath),
+                                /*LowerCase=*/true) +
+                ".unit");
+  return std::string(Path.str());
+}
+
+llvm::Expected<IndexUnit> IndexUnit::read(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return llvm::errorCodeToError(Buffer.getError());
+  SmallVector<StringRef, 16> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  if (Lines.empty())
+    return llvm::make_error<llvm::StringError>(
+        "invalid index unit '" + Path + "'", llvm::inconvertibleErrorCode());
+
+  IndexUnit Unit;
+  Unit.MainFilePath = std::string(Lines[0]);
+  StringRef Dir = llvm::sys::path::parent_path(Path);
+  for (StringRef Name : makeArrayRef(Lines).drop_front()) {
+    SmallString<256> RecordPath(Dir);
+    llvm::sys::path::append(RecordPath, Name);
+    Unit.RecordPaths.push_back(std::string(RecordPath.str()));
+  }
+  return std::move(Unit);
+}
+
+IndexRecordWriter::IndexRecordWriter(StringRef RecordDir, bool WriteUnit)
+    : RecordDir(RecordDir), ShouldWriteUnit(WriteUnit) {}
+
+IndexRecordWriter::~IndexRecordWriter() {}
+
+void IndexRecordWriter::initialize(ASTContext &Ctx) {
+  this->Ctx = &Ctx;
+  Records.clear();
+  RecordPaths.clear();
+  USRs.clear();
+}
+
+bool IndexRecordWriter::handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                                            ArrayRef<SymbolRelation> Relations,
+                                            SourceLocation Loc,
+                                            ASTNodeInfo ASTNode) {
+  SourceManager &SM = Ctx->getSourceManager();
+  SourceLocation FileLoc = SM.getFileLoc(Loc);
+  if (FileLoc.isInvalid())
+    return true;
+  FileID FID;
+  unsigned Offset;
+  std::tie(FID, Offset) = SM.getDecomposedLoc(FileLoc);
+  if (FID.isInvalid() || !SM.getFileEntryForID(FID))
+    return true;
+
+  std::unique_ptr<FileIndexRecord> &Record = Records[FID];
+  if (!Record)
+    Record = std::make_unique<FileIndexRecord>(
+        FID, SM.isInSystemHeader(FileLoc));
+  Record->addDeclOccurence(Roles, Offset, D->getCanonicalDecl(), Relations);
+  return true;
+}
+
+void IndexRecordWriter::finish() {
+  if (!Ctx || Records.empty())
+    return;
+  DiagnosticsEngine &Diags = Ctx->getDiagnostics();
+  if (std::error_code EC = llvm::sys::fs::create_directories(RecordDir)) {
+    Diags.Report(diag::err_fe_unable_to_open_output) << RecordDir
+                                                     << EC.message();
+    return;
+  }
+
+  // Write the records in the order of their files, for the list of the paths
+  // not to depend on the order of the map.
+  std::vector<FileIndexRecord *> Sorted;
+  for (auto &R : Records)
+    Sorted.push_back(R.second.get());
+  llvm::sort(Sorted, [](const FileIndexRecord *LHS,
+                        const FileIndexRecord *RHS) {
+    return LHS->getFileID() < RHS->getFileID();
+  });
+
+  SmallString<4096> Buffer;
+  for (const FileIndexRecord *Record : Sorted) {
+    Buffer.clear();
+    writeRecord(*Record, *Ctx, USRs, Buffer);
+
+    // The name of a record is the hash of its contents, which include the
+    // path of the file, so an existing record with the same name is the same
+    // record.
+    const FileEntry *FE =
+        Ctx->getSourceManager().getFileEntryForID(Record->getFileID());
+    SmallString<256> Path(RecordDir);
+    llvm::sys::path::append(
+        Path, llvm::sys::path::filename(FE->getName()) + "-" +
+                  llvm::utohexstr(llvm::xxHash64(Buffer), /*LowerCase=*/true) +
+                  ".idx");
+    RecordPaths.push_back(std::string(Path.str()));
+    // The translation units which write the same record concurrently never
+    // read a partial one.
+    if (!llvm::sys::fs::exists(Path))
+      writeAtomically(Path, Buffer, Diags);
+  }
+  Records.clear();
+
+  if (ShouldWriteUnit)
+    writeUnit();
+}
+
+void IndexRecordWriter::writeUnit() {
+  const SourceManager &SM = Ctx->getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  if (!MainFile)
+    return;
+  StringRef MainFilePath = getFilePath(MainFile);
+
+  std::string Unit = MainFilePath.str();
+  Unit += '\n';
+  for (const std::string &Path : RecordPaths) {
+    Unit += llvm::sys::path::filename(Path);
+    Unit += '\n';
+  }
+  // Units are rewritten when their translation unit is indexed again.
+  writeAtomically(IndexUnit::getPath(RecordDir, MainFilePath), Unit,
+                  Ctx->getDiagnostics());
+}
+
+llvm::Expected<std::unique_ptr<IndexRecordReader>>
+IndexRecordReader::create(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  StringRef Contents = Buffer->getBuffer();
+  auto InvalidRecord = [&Buffer] {
+    return llvm::make_error<llvm::StringError>(
+        "invalid index record '" + Buffer->getBufferIdentifier() + "'",
+        llvm::inconvertibleErrorCode());
+  };
+  if (Contents.size() < sizeof(record::Header) ||
+      !Contents.startswith(StringRef(RecordMagic, sizeof(RecordMagic) - 1)))
+    return InvalidRecord();
+
+  const auto *Hdr = reinterpret_cast<const record::Header *>(Contents.data());
+  uint64_t NumSymbols = Hdr->NumSymbols;
+  uint64_t NumOccurrences = Hdr->NumOccurrences;
+  uint64_t SymbolsOffset = sizeof(record::Header);
+  uint64_t OccurrencesOffset =
+      SymbolsOffset + NumSymbols * sizeof(record::Symbol);
+  uint64_t ByOffsetOffset =
+      OccurrencesOffset + NumOccurrences * sizeof(record::Occurrence);
+  uint64_t StringsOffset =
+      ByOffsetOffset + NumOccurrences * sizeof(record::ulittle32_t);
+  if (StringsOffset + Hdr->StringTableSize != Contents.size())
+    return InvalidRecord();
+
+  std::unique_ptr<IndexRecordReader> Reader(new IndexRecordReader());
+  const char *Base = Contents.data();
+  Reader->Hdr = Hdr;
+  Reader->Symbols = makeArrayRef(
+      reinterpret_cast<const record::Symbol *>(Base + SymbolsOffset),
+      NumSymbols);
+  Reader->Occurrences = makeArrayRef(
+      reinterpret_cast<const record::Occurrence *>(Base + OccurrencesOffset),
+      NumOccurrences);
+  Reader->OccurrencesByOffset = makeArrayRef(
+      reinterpret_cast<const record::ulittle32_t *>(Base + ByOffsetOffset),
+      NumOccurrences);
+  Reader->Strings = Contents.substr(StringsOffset);
+
+  // Check the offsets of the tables once, for their accessors not to.
+  auto IsInStrings = [&](uint64_t Offset, uint64_t Length) {
+    return Offset + Length <= Reader->Strings.size();
+  };
+  if (!IsInStrings(Hdr->PathOffset, Hdr->PathLength))
+    return InvalidRecord();
+  for (const record::Symbol &S : Reader->Symbols)
+    if (!IsInStrings(S.USROffset, S.USRLength) ||
+        !IsInStrings(S.NameOffset, S.NameLength) ||
+        uint64_t(S.FirstOccurrence) + S.NumOccurrences > NumOccurrences)
+      return InvalidRecord();
+  for (const record::Occurrence &O : Reader->Occurrences)
+    if (O.Symbol >= NumSymbols)
+      return InvalidRecord();
+  for (uint32_t Position : Reader->OccurrencesByOffset)
+    if (Position >= NumOccurrences)
+      return InvalidRecord();
+
+  Reader->Buffer = std::move(Buffer);
+  return std::move(Reader);
+}
+
+llvm::Expected<std::unique_ptr<IndexRecordReader>>
+IndexRecordReader::create(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return llvm::errorCodeToError(Buffer.getError());
+  return create(std::move(*Buffer));
+}
+
+StringRef IndexRecordReader::getFilePath() const {
+  return Strings.substr(Hdr->PathOffset, Hdr->PathLength);
+}
+
+StringRef IndexRecordReader::getUSR(const record::Symbol &S) const {
+  return Strings.substr(S.USROffset, S.USRLength);
+}
+
+StringRef IndexRecordReader::getName(const record::Symbol &S) const {
+  return Strings.substr(S.NameOffset, S.NameLength);
+}
+
+SymbolInfo IndexRecordReader::getSymbolInfo(const record::Symbol &S) const {
+  SymbolInfo Info;
+  Info.Kind = static_cast<SymbolKind>(S.Kind);
+  Info.SubKind = static_cast<SymbolSubKind>(S.SubKind);
+  Info.Lang = static_cast<SymbolLanguage>(S.Lang);
+  Info.Properties = S.Properties;
+  return Info;
+}
+
+const record::Symbol *IndexRecordReader::findSymbol(StringRef USR) const {
+  auto It = llvm::partition_point(Symbols, [&](const record::Symbol &S) {
+    return getUSR(S) < USR;
+  });
+  if (It == Symbols.end() || getUSR(*It) != USR)
+    return nullptr;
+  return It;
+}
+
+ArrayRef<record::Occurrence>
+IndexRecordReader::getOccurrences(const record::Symbol &S) const {
+  return Occurrences.slice(S.FirstOccurrence, S.NumOccurrences);
+}
+
+void IndexRecordReader::forEachOccurrence(
+    llvm::function_ref<bool(const record::Occurrence &)> Receiver) const {
+  for (uint32_t Position : OccurrencesByOffset)
+    if (!Receiver(Occurrences[Position]))
+      return;
+}
+
+const record::Occurrence *
+IndexRecordReader::findOccurrenceAt(unsigned Offset) const {
+  auto It = llvm::partition_point(
+      OccurrencesByOffset, [&](const record::ulittle32_t &Position) {
+        return Occurrences[Position].Offset < Offset;
+      });
+  if (It == OccurrencesByOffset.end() || Occurrences[*It].Offset != Offset)
+    return nullptr;
+  return &Occurrences[*It];
+}
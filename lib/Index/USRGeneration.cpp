@@ -11,6 +11,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Lex/PreprocessingRecord.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -61,25 +62,31 @@ class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   bool IgnoreResults;
   ASTContext *Context;
   bool generatedLoc;
+  USRCache *Cache;
 
   llvm::DenseMap<const Type *, unsigned> TypeSubstitutions;
 
 public:
-  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf)
+  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf,
+                        USRCache *Cache = nullptr)
   : Buf(Buf),
     Out(Buf),
     IgnoreResults(false),
     Context(Ctx),
-    generatedLoc(false)
+    generatedLoc(false),
+    Cache(Cache)
   {
     // Add the USR space prefix.
     Out << getUSRSpacePrefix();
   }
 
   bool ignoreResults() const { return IgnoreResults; }
+  bool generatedLocation() const { return generatedLoc; }
+  bool usesTypeSubstitutions() const { return !TypeSubstitutions.empty(); }
 
   // Visitation methods from generating USRs from AST elements.
   void VisitDeclContext(const DeclContext *D);
+  bool VisitCachedDeclContext(const NamedDecl *D);
   void VisitFieldDecl(const FieldDecl *D);
   void VisitFunctionDecl(const FunctionDecl *D);
   void VisitNamedDecl(const NamedDecl *D);
@@ -195,12 +202,27 @@ bool USRGenerator::ShouldGenerateLocation(const NamedDecl *D) {
 }
 
 void USRGenerator::VisitDeclContext(const DeclContext *DC) {
-  if (const NamedDecl *D = dyn_cast<NamedDecl>(DC))
-    Visit(D);
-  else if (isa<LinkageSpecDecl>(DC)) // Linkage specs are transparent in USRs.
+  if (const NamedDecl *D = dyn_cast<NamedDecl>(DC)) {
+    if (!Cache || !VisitCachedDeclContext(D))
+      Visit(D);
+  } else if (isa<LinkageSpecDecl>(DC)) // Linkage specs are transparent in USRs.
     VisitDeclContext(DC->getParent());
 }
 
+/// Emits the cached USR of the context \p D, if the USR does not depend on
+/// what was emitted before it.
+bool USRGenerator::VisitCachedDeclContext(const NamedDecl *D) {
+  const USRCache::Entry &E = Cache->getEntry(D);
+  // The types of the USR of the context could be substitutions of the types
+  // generated before it, and its location is omitted if a location was.
+  if (E.UsesTypeSubstitutions || (E.GeneratedLoc && generatedLoc))
+    return false;
+  Out << E.USR.drop_front(getUSRSpacePrefix().size());
+  IgnoreResults |= E.IgnoreResults;
+  generatedLoc |= E.GeneratedLoc;
+  return true;
+}
+
 void USRGenerator::VisitFieldDecl(const FieldDecl *D) {
   // The USR for an ivar declared in a class extension is based on the
   // ObjCInterfaceDecl, not the ObjCCategoryDecl.
@@ -1082,6 +1104,32 @@ bool clang::index::generateUSRForDecl(const Decl *D,
   return UG.ignoreResults();
 }
 
+bool USRCache::generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf) {
+  if (!D)
+    return true;
+  const Entry &E = getEntry(D);
+  Buf.append(E.USR.begin(), E.USR.end());
+  return E.IgnoreResults;
+}
+
+const USRCache::Entry &USRCache::getEntry(const Decl *D) {
+  auto It = Entries.find(D);
+  if (It != Entries.end())
+    return It->second;
+
+  // Generating the USR caches the USRs of the contexts of D, so the entry is
+  // only inserted once the USR is generated.
+  SmallString<128> Buf;
+  USRGenerator UG(&D->getASTContext(), Buf, this);
+  UG.Visit(D);
+  Entry E;
+  E.USR = StringRef(Buf).copy(Alloc);
+  E.IgnoreResults = UG.ignoreResults();
+  E.GeneratedLoc = UG.generatedLocation();
+  E.UsesTypeSubstitutions = UG.usesTypeSubstitutions();
+  return Entries.insert({D, E}).first->second;
+}
+
 bool clang::index::generateUSRForMacro(const MacroDefinitionRecord *MD,
                                        const SourceManager &SM,
                                        SmallVectorImpl<char> &Buf) {
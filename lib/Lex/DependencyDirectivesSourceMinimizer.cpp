@@ -20,6 +20,7 @@
 #include "clang/Lex/LexDiagnostic.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <cstring>
 
 using namespace llvm;
 using namespace clang;
@@ -118,6 +119,30 @@ static void skipOverSpaces(const char *&First, const char *const End) {
     ++First;
 }
 
+/// Advance \p First to the next character which is one of \p Chars, or to
+/// \p End. Most of the characters of a line don't matter to the minimizer,
+/// so they are skipped eight at a time while there are that many left.
+static void skipUntilAnyOf(const char *&First, const char *const End,
+                           StringRef Chars) {
+  const uint64_t Ones = 0x0101010101010101ULL;
+  const uint64_t Highs = 0x8080808080808080ULL;
+  while (End - First >= 8) {
+    uint64_t Word;
+    std::memcpy(&Word, First, sizeof(Word));
+    uint64_t Found = 0;
+    for (char C : Chars) {
+      // A byte of Word is C if and only if that byte of Match is zero.
+      uint64_t Match = Word ^ (Ones * (unsigned char)C);
+      Found |= (Match - Ones) & ~Match & Highs;
+    }
+    if (Found)
+      break;
+    First += 8;
+  }
+  while (First != End && Chars.find(*First) == StringRef::npos)
+    ++First;
+}
+
 LLVM_NODISCARD static bool isRawStringLiteral(const char *First,
                                               const char *Current) {
   assert(First <= Current);
@@ -158,11 +183,11 @@ static void skipRawString(const char *&First, const char *const End) {
   StringRef Terminator(First, Last - First);
   for (;;) {
     // Move First to just past the next ")".
-    First = Last;
-    while (First != End && *First != ')')
-      ++First;
-    if (First == End)
+    First = static_cast<const char *>(std::memchr(Last, ')', End - Last));
+    if (!First) {
+      First = End;
       return;
+    }
     ++First;
 
     // Look ahead for the terminator sequence.
@@ -248,11 +273,11 @@ static void skipToNewlineRaw(const char *&First, const char *const End) {
     if (Len)
       return;
 
-    do {
-      if (++First == End)
-        return;
-      Len = isEOL(First, End);
-    } while (!Len);
+    ++First;
+    skipUntilAnyOf(First, End, "\n\r");
+    if (First == End)
+      return;
+    Len = isEOL(First, End);
 
     if (First[-1] != '\\')
       return;
@@ -290,11 +315,17 @@ static void skipBlockComment(const char *&First, const char *const End) {
     First = End;
     return;
   }
-  for (First += 3; First != End; ++First)
-    if (First[-1] == '*' && First[0] == '/') {
+  for (First += 3; First != End; ++First) {
+    First = static_cast<const char *>(std::memchr(First, '/', End - First));
+    if (!First) {
+      First = End;
+      return;
+    }
+    if (First[-1] == '*') {
       ++First;
       return;
     }
+  }
 }
 
 /// \returns True if the current single quotation mark character is a C++ 14
@@ -332,7 +363,12 @@ static void skipLine(const char *&First, const char *const End) {
       return;
     }
     const char *Start = First;
-    while (First != End && !isVerticalWhitespace(*First)) {
+    for (;;) {
+      // Only newlines, quotes and slashes need to be looked at.
+      skipUntilAnyOf(First, End, "\n\r\"'/");
+      if (First == End || isVerticalWhitespace(*First))
+        break;
+
       // Iterate over strings correctly to avoid comments and newlines.
       if (*First == '"' ||
           (*First == '\'' && !isQuoteCppDigitSeparator(Start, First, End))) {
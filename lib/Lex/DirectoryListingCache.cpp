@@ -0,0 +1,62 @@
+//===- DirectoryListingCache.cpp - Cache of directory contents ------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the DirectoryListingCache.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DirectoryListingCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+using namespace clang;
+
+bool DirectoryListingCache::Listing::mayContain(StringRef Name) const {
+  return Entries.count(Name.lower());
+}
+
+std::shared_ptr<const DirectoryListingCache::Listing>
+DirectoryListingCache::getListing(StringRef Dir, llvm::vfs::FileSystem &FS) {
+  SmallString<256> Path(Dir);
+  if (FS.makeAbsolute(Path))
+    return nullptr;
+  llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/false);
+
+  llvm::ErrorOr<llvm::vfs::Status> Status = FS.status(Path);
+  if (!Status || !Status->isDirectory())
+    return nullptr;
+
+  {
+    std::lock_guard<std::mutex> LockGuard(Lock);
+    auto It = Listings.find(Path);
+    if (It != Listings.end() &&
+        It->second->ModTime == Status->getLastModificationTime())
+      return It->second;
+  }
+
+  // Read the directory without holding the lock. Another thread may be doing
+  // the same, in which case the last listing read wins; both are up to date.
+  auto Result = std::make_shared<Listing>();
+  Result->ModTime = Status->getLastModificationTime();
+  std::error_code EC;
+  for (llvm::vfs::directory_iterator I = FS.dir_begin(Path, EC), E;
+       !EC && I != E; I.increment(EC))
+    Result->Entries.insert(llvm::sys::path::filename(I->path()).lower());
+  if (EC)
+    return nullptr;
+
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  Listings[Path] = Result;
+  return Result;
+}
+
+void DirectoryListingCache::clear() {
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  Listings.clear();
+}
@@ -34,6 +34,8 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <algorithm>
@@ -41,6 +43,7 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <set>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -54,6 +57,9 @@ ALWAYS_ENABLED_STATISTIC(
     NumMultiIncludeFileOptzn,
     "Number of #includes skipped due to the multi-include optimization.");
 ALWAYS_ENABLED_STATISTIC(NumFrameworkLookups, "Number of framework lookups.");
+ALWAYS_ENABLED_STATISTIC(NumDirListingMisses,
+                         "Number of directory lookups answered by the "
+                         "directory listing cache.");
 ALWAYS_ENABLED_STATISTIC(NumSubFrameworkLookups,
                          "Number of subframework lookups.");
 
@@ -105,7 +111,9 @@ void HeaderSearch::PrintStats() {
                << " #includes skipped due to the multi-include optimization.\n";
 
   llvm::errs() << NumFrameworkLookups << " framework lookups.\n"
-               << NumSubFrameworkLookups << " subframework lookups.\n";
+               << NumSubFrameworkLookups << " subframework lookups.\n"
+               << NumDirListingMisses
+               << " directory lookups skipped by the directory listings.\n";
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -164,8 +172,72 @@ std::string HeaderSearch::getPrebuiltModuleFileName(StringRef ModuleName,
   return {};
 }
 
+/// Read the names of the observed command-line macros recorded in
+/// \p MacrosFileName by HeaderSearch::addObservedCommandLineMacros().
+static std::set<std::string> readObservedMacros(StringRef MacrosFileName) {
+  std::set<std::string> Names;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(MacrosFileName);
+  if (!Buffer)
+    return Names;
+  SmallVector<StringRef, 16> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  Names.insert(Lines.begin(), Lines.end());
+  return Names;
+}
+
 std::string HeaderSearch::getCachedModuleFileName(StringRef ModuleName,
                                                   StringRef ModuleMapPath) {
+  std::string Result = getCachedModuleFileBaseName(ModuleName, ModuleMapPath);
+  if (Result.empty())
+    return {};
+
+  if (HSOpts->ModulesHashObservedMacros) {
+    // Append the hash of the definitions the observed macros have here, so
+    // that each configuration of them gets its own module file. The names of
+    // the macros are kept next to the module files.
+    llvm::hash_code Hash = llvm::hash_value(StringRef());
+    for (const std::string &Name : readObservedMacros(Result + ".macros"))
+      Hash = llvm::hash_combine(Hash, Name, CommandLineMacros.lookup(Name));
+
+    SmallString<128> HashStr;
+    llvm::APInt(64, size_t(Hash)).toStringUnsigned(HashStr, /*Radix*/36);
+    Result += "-";
+    Result += HashStr.str();
+  }
+  return Result + ".pcm";
+}
+
+void HeaderSearch::addObservedCommandLineMacros(
+    Module *Module, ArrayRef<std::string> MacroNames) {
+  const FileEntry *ModuleMap =
+      getModuleMap().getModuleMapFileForUniquing(Module);
+  if (!ModuleMap)
+    return;
+  std::string BaseName =
+      getCachedModuleFileBaseName(Module->Name, ModuleMap->getName());
+  if (BaseName.empty())
+    return;
+
+  std::string MacrosFileName = BaseName + ".macros";
+  std::set<std::string> Names = readObservedMacros(MacrosFileName);
+  size_t NumKnownNames = Names.size();
+  Names.insert(MacroNames.begin(), MacroNames.end());
+  if (Names.size() == NumKnownNames)
+    return;
+
+  // Another process may be adding names too; the names lost that way are
+  // added again once they're observed again.
+  std::string Contents;
+  for (const std::string &Name : Names)
+    Contents += Name + "\n";
+  llvm::consumeError(llvm::writeFileAtomically(MacrosFileName + "-%%%%%%%%",
+                                               MacrosFileName, Contents));
+}
+
+std::string HeaderSearch::getCachedModuleFileBaseName(StringRef ModuleName,
+                                                      StringRef ModuleMapPath) {
   // If we don't have a module cache path or aren't supposed to use one, we
   // can't do anything.
   if (getModuleCachePath().empty())
@@ -175,7 +247,7 @@ std::string HeaderSearch::getCachedModuleFileName(StringRef ModuleName,
   llvm::sys::fs::make_absolute(Result);
 
   if (HSOpts->DisableModuleHash) {
-    llvm::sys::path::append(Result, ModuleName + ".pcm");
+    llvm::sys::path::append(Result, ModuleName);
   } else {
     // Construct the name <ModuleName>-<hash of ModuleMapPath>.pcm which should
     // ideally be globally unique to this particular module. Name collisions
@@ -198,7 +270,7 @@ std::string HeaderSearch::getCachedModuleFileName(StringRef ModuleName,
 
     SmallString<128> HashStr;
     llvm::APInt(64, size_t(Hash)).toStringUnsigned(HashStr, /*Radix*/36);
-    llvm::sys::path::append(Result, ModuleName + "-" + HashStr + ".pcm");
+    llvm::sys::path::append(Result, ModuleName + "-" + HashStr);
   }
   return Result.str().str();
 }
@@ -316,6 +388,49 @@ StringRef DirectoryLookup::getName() const {
   return getHeaderMap()->getFileName();
 }
 
+bool HeaderSearch::isKnownMissingFromDirectory(const DirectoryEntry *Dir,
+                                               StringRef Filename) {
+  if (!DirListingCache)
+    return false;
+
+  // The file system doesn't know about virtual files, so the listings of
+  // their directories are incomplete.
+  if (FileMgr.getNumVirtualFiles() != NumVirtualFilesSeen) {
+    NumVirtualFilesSeen = FileMgr.getNumVirtualFiles();
+    SmallVector<const FileEntry *, 4> VirtualFiles;
+    FileMgr.GetVirtualFiles(VirtualFiles);
+    for (const FileEntry *FE : VirtualFiles)
+      for (StringRef Path = llvm::sys::path::parent_path(FE->getName());
+           !Path.empty(); Path = llvm::sys::path::parent_path(Path))
+        if (!VirtualFileDirs.insert(Path).second)
+          break;
+  }
+  if (VirtualFileDirs.count(Dir->getName()))
+    return false;
+
+  // Only the first component of the file name is looked up, e.g. "sys" for
+  // "sys/types.h".
+  auto FirstComponent = llvm::sys::path::begin(Filename);
+  if (FirstComponent == llvm::sys::path::end(Filename) ||
+      *FirstComponent == "." || *FirstComponent == "..")
+    return false;
+
+  auto Known = DirListings.find(Dir);
+  if (Known == DirListings.end()) {
+    SmallString<256> DirPath(Dir->getName());
+    FileMgr.makeAbsolutePath(DirPath);
+    Known = DirListings
+                .insert({Dir, DirListingCache->getListing(
+                                  DirPath, FileMgr.getVirtualFileSystem())})
+                .first;
+  }
+  if (!Known->second || Known->second->mayContain(*FirstComponent))
+    return false;
+
+  ++NumDirListingMisses;
+  return true;
+}
+
 Optional<FileEntryRef> HeaderSearch::getFileAndSuggestModule(
     StringRef FileName, SourceLocation IncludeLoc, const DirectoryEntry *Dir,
     bool IsSystemHeaderDir, Module *RequestingModule,
@@ -372,6 +487,9 @@ Optional<FileEntryRef> DirectoryLookup::LookupFile(
       RelativePath->append(Filename.begin(), Filename.end());
     }
 
+    if (HS.isKnownMissingFromDirectory(getDir(), Filename))
+      return None;
+
     return HS.getFileAndSuggestModule(TmpDir, IncludeLoc, getDir(),
                                       isSystemHeaderDirectory(),
                                       RequestingModule, SuggestedModule);
@@ -1308,6 +1426,15 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
       return false;
   }
 
+  // If another translation unit found the controlling macro of the file, use
+  // it before the file was ever lexed here.
+  if (IncludeGuards && !FileInfo.getControllingMacro(ExternalLookup) &&
+      !PP.getSourceManager().isFileOverridden(File)) {
+    std::string Guard = IncludeGuards->lookup(*File);
+    if (!Guard.empty())
+      FileInfo.ControllingMacro = PP.getIdentifierInfo(Guard);
+  }
+
   // Next, check to see if the file is wrapped with #ifndef guards.  If so, and
   // if the macro that guards it is defined, we know the #include has no effect.
   if (const IdentifierInfo *ControllingMacro
@@ -0,0 +1,49 @@
+//===- IncludeGuardCache.cpp - Controlling macros of headers --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the IncludeGuardCache.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/IncludeGuardCache.h"
+#include "clang/Basic/FileManager.h"
+
+using namespace clang;
+
+/// Virtual files that don't exist on disk don't have a unique ID.
+static bool hasUniqueID(const FileEntry &File) {
+  return File.getUniqueID() != llvm::sys::fs::UniqueID(0, 0);
+}
+
+std::string IncludeGuardCache::lookup(const FileEntry &File) {
+  if (!hasUniqueID(File))
+    return std::string();
+
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  auto It = Guards.find(File.getUniqueID());
+  if (It == Guards.end() || It->second.ModTime != File.getModificationTime() ||
+      It->second.Size != File.getSize())
+    return std::string();
+  return It->second.MacroName;
+}
+
+void IncludeGuardCache::insert(const FileEntry &File, StringRef MacroName) {
+  if (!hasUniqueID(File))
+    return;
+
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  Entry &E = Guards[File.getUniqueID()];
+  E.ModTime = File.getModificationTime();
+  E.Size = File.getSize();
+  E.MacroName = MacroName;
+}
+
+void IncludeGuardCache::clear() {
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  Guards.clear();
+}
@@ -47,6 +47,16 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CLANG_LEXER_USE_NEON 1
+#endif
+
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -1634,9 +1644,134 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Vectorized scanning helpers
+//===----------------------------------------------------------------------===//
+//
+// Each helper returns a pointer to the first character at or after \p Ptr
+// that may not belong to the run being skipped. They only ever read whole
+// 16-byte blocks that end at or before \p End, and may return early (at worst
+// \p Ptr itself), so callers must still finish the run with their scalar loop.
+// That keeps the hard cases (end of buffer, code-completion points, escaped
+// newlines, trigraphs, UCNs and non-ASCII characters) on the existing paths.
+
+#ifdef __SSE2__
+/// Return a byte mask of the characters in \p Chars that lie in [Lo, Hi].
+/// Only valid for ASCII bounds: bytes >= 0x80 compare as negative and never
+/// match.
+static inline __m128i inRangeSSE2(__m128i Chars, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(Chars, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(Hi + 1), Chars));
+}
+#endif
+
+#ifdef CLANG_LEXER_USE_NEON
+/// Return a byte mask of the characters in \p Chars that lie in [Lo, Hi].
+static inline uint8x16_t inRangeNEON(uint8x16_t Chars, uint8_t Lo,
+                                     uint8_t Hi) {
+  return vcleq_u8(vsubq_u8(Chars, vdupq_n_u8(Lo)), vdupq_n_u8(Hi - Lo));
+}
+#endif
+
+/// Skip over characters matching [_A-Za-z0-9].
+static inline const char *fastSkipIdentifierBody(const char *Ptr,
+                                                 const char *End) {
+#ifdef __SSE2__
+  while (Ptr + 16 <= End) {
+    __m128i Chars = _mm_loadu_si128((const __m128i *)Ptr);
+    // Folding case leaves '_' and all non-letters outside [a-z].
+    __m128i Lower = _mm_or_si128(Chars, _mm_set1_epi8(0x20));
+    __m128i IsBody =
+        _mm_or_si128(_mm_or_si128(inRangeSSE2(Lower, 'a', 'z'),
+                                  inRangeSSE2(Chars, '0', '9')),
+                     _mm_cmpeq_epi8(Chars, _mm_set1_epi8('_')));
+    unsigned Mask = _mm_movemask_epi8(IsBody);
+    if (Mask != 0xFFFF)
+      return Ptr + llvm::countTrailingOnes(Mask);
+    Ptr += 16;
+  }
+#elif defined(CLANG_LEXER_USE_NEON)
+  while (Ptr + 16 <= End) {
+    uint8x16_t Chars = vld1q_u8((const uint8_t *)Ptr);
+    uint8x16_t Lower = vorrq_u8(Chars, vdupq_n_u8(0x20));
+    uint8x16_t IsBody =
+        vorrq_u8(vorrq_u8(inRangeNEON(Lower, 'a', 'z'),
+                          inRangeNEON(Chars, '0', '9')),
+                 vceqq_u8(Chars, vdupq_n_u8('_')));
+    if (vminvq_u8(IsBody) != 0xFF)
+      break;
+    Ptr += 16;
+  }
+#endif
+  return Ptr;
+}
+
+/// Skip over horizontal whitespace: ' ', '\t', '\f' and '\v'.
+static inline const char *fastSkipHorizontalWhitespace(const char *Ptr,
+                                                       const char *End) {
+#ifdef __SSE2__
+  while (Ptr + 16 <= End) {
+    __m128i Chars = _mm_loadu_si128((const __m128i *)Ptr);
+    __m128i IsSpace =
+        _mm_or_si128(_mm_cmpeq_epi8(Chars, _mm_set1_epi8(' ')),
+                     _mm_or_si128(_mm_cmpeq_epi8(Chars, _mm_set1_epi8('\t')),
+                                  inRangeSSE2(Chars, '\v', '\f')));
+    unsigned Mask = _mm_movemask_epi8(IsSpace);
+    if (Mask != 0xFFFF)
+      return Ptr + llvm::countTrailingOnes(Mask);
+    Ptr += 16;
+  }
+#elif defined(CLANG_LEXER_USE_NEON)
+  while (Ptr + 16 <= End) {
+    uint8x16_t Chars = vld1q_u8((const uint8_t *)Ptr);
+    uint8x16_t IsSpace =
+        vorrq_u8(vceqq_u8(Chars, vdupq_n_u8(' ')),
+                 vorrq_u8(vceqq_u8(Chars, vdupq_n_u8('\t')),
+                          inRangeNEON(Chars, '\v', '\f')));
+    if (vminvq_u8(IsSpace) != 0xFF)
+      break;
+    Ptr += 16;
+  }
+#endif
+  return Ptr;
+}
+
+/// Skip over the body of a line comment, stopping at the first '\n', '\r' or
+/// '\0'. Escaped newlines are detected by the caller looking backwards from the
+/// newline, so backslashes and trigraphs need no special treatment here.
+static inline const char *fastSkipLineCommentBody(const char *Ptr,
+                                                  const char *End) {
+#ifdef __SSE2__
+  while (Ptr + 16 <= End) {
+    __m128i Chars = _mm_loadu_si128((const __m128i *)Ptr);
+    __m128i IsStop =
+        _mm_or_si128(_mm_cmpeq_epi8(Chars, _mm_set1_epi8('\n')),
+                     _mm_or_si128(_mm_cmpeq_epi8(Chars, _mm_set1_epi8('\r')),
+                                  _mm_cmpeq_epi8(Chars, _mm_setzero_si128())));
+    unsigned Mask = _mm_movemask_epi8(IsStop);
+    if (Mask != 0)
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#elif defined(CLANG_LEXER_USE_NEON)
+  while (Ptr + 16 <= End) {
+    uint8x16_t Chars = vld1q_u8((const uint8_t *)Ptr);
+    uint8x16_t IsStop =
+        vorrq_u8(vceqq_u8(Chars, vdupq_n_u8('\n')),
+                 vorrq_u8(vceqq_u8(Chars, vdupq_n_u8('\r')),
+                          vceqq_u8(Chars, vdupq_n_u8(0))));
+    if (vmaxvq_u8(IsStop) != 0)
+      break;
+    Ptr += 16;
+  }
+#endif
+  return Ptr;
+}
+
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = fastSkipIdentifierBody(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -2192,6 +2327,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = fastSkipHorizontalWhitespace(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2261,6 +2400,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    CurPtr = fastSkipLineCommentBody(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2468,13 +2608,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -2553,6 +2686,12 @@ bool Lexer::SkipBlockComment(Token &Result, const char *CurPtr,
       while (CurPtr+16 <= BufferEnd &&
              !vec_any_eq(*(const vector unsigned char*)CurPtr, Slashes))
         CurPtr += 16;
+#elif defined(CLANG_LEXER_USE_NEON)
+      uint8x16_t Slashes = vdupq_n_u8('/');
+      while (CurPtr+16 <= BufferEnd &&
+             vmaxvq_u8(vceqq_u8(vld1q_u8((const uint8_t *)CurPtr),
+                                Slashes)) == 0)
+        CurPtr += 16;
 #else
       // Scan for '/' quickly.  Many block comments are very large.
       while (CurPtr[0] != '/' &&
@@ -3157,12 +3296,83 @@ bool Lexer::Lex(Token &Result) {
   IsAtPhysicalStartOfLine = false;
   bool isRawLex = isLexingRawMode();
   (void) isRawLex;
-  bool returnedToken = LexTokenInternal(Result, atPhysicalStartOfLine);
+  bool returnedToken;
+  if (const PreLexedBuffer::Token *PreLexedTok = getNextPreLexedToken(Result))
+    returnedToken = LexPreLexedToken(Result, *PreLexedTok);
+  else
+    returnedToken = LexTokenInternal(Result, atPhysicalStartOfLine);
   // (After the LexTokenInternal call, the lexer might be destroyed.)
   assert((returnedToken || !isRawLex) && "Raw lex must succeed");
   return returnedToken;
 }
 
+const PreLexedBuffer::Token *Lexer::getNextPreLexedToken(Token &Result) {
+  if (!PreLexed || LexingRawMode || ParsingPreprocessorDirective ||
+      isKeepWhitespaceMode())
+    return nullptr;
+
+  // The lexer usually moves forward one token at a time, but it can also skip
+  // ahead, e.g. over an excluded block, or be moved back.
+  ArrayRef<PreLexedBuffer::Token> Toks = PreLexed->tokens();
+  unsigned Offset = BufferPtr - BufferStart;
+  if (NextPreLexedToken == Toks.size() ||
+      Toks[NextPreLexedToken].Offset < Offset ||
+      (NextPreLexedToken && Toks[NextPreLexedToken - 1].Offset >= Offset))
+    NextPreLexedToken =
+        llvm::partition_point(Toks,
+                              [=](const PreLexedBuffer::Token &Tok) {
+                                return Tok.Offset < Offset;
+                              }) -
+        Toks.begin();
+  if (NextPreLexedToken == Toks.size() || !Toks[NextPreLexedToken].Reusable)
+    return nullptr;
+
+  // The token is the next one only if nothing but whitespace separates it
+  // from the current position.
+  const PreLexedBuffer::Token &Tok = Toks[NextPreLexedToken];
+  const char *TokStart = BufferStart + Tok.Offset;
+  bool SawNewline = false;
+  for (const char *CurPtr = BufferPtr; CurPtr != TokStart; ++CurPtr) {
+    if (!isWhitespace(*CurPtr))
+      return nullptr;
+    SawNewline |= isVerticalWhitespace(*CurPtr);
+  }
+
+  // Set the flags the same way as SkipWhitespace.
+  if (SawNewline) {
+    Result.setFlag(Token::StartOfLine);
+    Result.setFlagValue(Token::LeadingSpace,
+                        !isVerticalWhitespace(TokStart[-1]));
+  } else if (TokStart != BufferPtr) {
+    Result.setFlag(Token::LeadingSpace);
+  }
+  ++NextPreLexedToken;
+  return &Tok;
+}
+
+bool Lexer::LexPreLexedToken(Token &Result, const PreLexedBuffer::Token &Tok) {
+  // Notify MIOpt that we read a non-whitespace/non-comment token.
+  MIOpt.ReadToken();
+
+  const char *TokStart = BufferStart + Tok.Offset;
+  BufferPtr = TokStart;
+  FormTokenWithChars(Result, TokStart + Tok.Length, Tok.Kind);
+
+  if (Tok.Kind == tok::numeric_constant) {
+    Result.setLiteralData(TokStart);
+    return true;
+  }
+  if (Tok.Kind != tok::raw_identifier)
+    return true;
+
+  // The rest is the same as for the identifiers of LexIdentifier.
+  Result.setRawIdentifierData(TokStart);
+  IdentifierInfo *II = PP->LookUpIdentifierInfo(Result);
+  if (II->isHandleIdentifierCase())
+    return PP->HandleIdentifier(Result);
+  return true;
+}
+
 /// LexTokenInternal - This implements a simple C family lexer.  It is an
 /// extremely performance critical piece of code.  This assumes that the buffer
 /// has a null character at the end of the file.  This returns a preprocessing
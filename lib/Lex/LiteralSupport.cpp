@@ -1517,6 +1517,14 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
   assert((CharByteWidth & 7) == 0 && "Assumes character size is byte multiple");
   CharByteWidth /= 8;
 
+  // A narrow string which needs no processing, e.g. a large embedded
+  // resource, is referenced in the source buffer instead of being copied.
+  if (StringToks.size() == 1 && CharByteWidth == 1 && !hadError) {
+    SourceString = getUnprocessedString(StringToks[0]);
+    if (SourceString)
+      return DiagnoseTooManyChars(StringToks);
+  }
+
   // The output buffer size needs to be large enough to hold wide characters.
   // This is a worst-case assumption which basically corresponds to L"" "long".
   SizeBound *= CharByteWidth;
@@ -1524,9 +1532,8 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
   // Size the temporary buffer to hold the result string data.
   ResultBuf.resize(SizeBound);
 
-  // Likewise, but for each string piece.
+  // Likewise, but for each string piece which needs cleaning.
   SmallString<512> TokenBuf;
-  TokenBuf.resize(MaxTokenLength);
 
   // Loop over all the strings, getting their spelling, and expanding them to
   // wide strings as appropriate.
@@ -1537,7 +1544,9 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
   SourceLocation UDSuffixTokLoc;
 
   for (unsigned i = 0, e = StringToks.size(); i != e; ++i) {
-    const char *ThisTokBuf = &TokenBuf[0];
+    if (StringToks[i].needsCleaning())
+      TokenBuf.resize(MaxTokenLength);
+    const char *ThisTokBuf = TokenBuf.data();
     // Get the spelling of the token, which eliminates trigraphs, etc.  We know
     // that ThisTokBuf points to a buffer that is big enough for the whole token
     // and 'spelled' tokens can only shrink.
@@ -1660,9 +1669,10 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
         // Is this a span of non-escape characters?
         if (ThisTokBuf[0] != '\\') {
           const char *InStart = ThisTokBuf;
-          do {
-            ++ThisTokBuf;
-          } while (ThisTokBuf != ThisTokEnd && ThisTokBuf[0] != '\\');
+          ThisTokBuf = static_cast<const char *>(
+              memchr(ThisTokBuf, '\\', ThisTokEnd - ThisTokBuf));
+          if (!ThisTokBuf)
+            ThisTokBuf = ThisTokEnd;
 
           // Copy the character span over.
           if (CopyStringFragment(StringToks[i], ThisTokBegin,
@@ -1730,20 +1740,81 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
       hadError = true;
       return;
     }
-  } else if (Diags) {
-    // Complain if this string literal has too many characters.
-    unsigned MaxChars = Features.CPlusPlus? 65536 : Features.C99 ? 4095 : 509;
-
-    if (GetNumStringChars() > MaxChars)
-      Diags->Report(StringToks.front().getLocation(),
-                    diag::ext_string_too_long)
-        << GetNumStringChars() << MaxChars
-        << (Features.CPlusPlus ? 2 : Features.C99 ? 1 : 0)
-        << SourceRange(StringToks.front().getLocation(),
-                       StringToks.back().getLocation());
+  } else {
+    DiagnoseTooManyChars(StringToks);
   }
 }
 
+void StringLiteralParser::DiagnoseTooManyChars(ArrayRef<Token> StringToks) {
+  if (!Diags)
+    return;
+
+  // Complain if this string literal has too many characters.
+  unsigned MaxChars = Features.CPlusPlus? 65536 : Features.C99 ? 4095 : 509;
+
+  if (GetNumStringChars() > MaxChars)
+    Diags->Report(StringToks.front().getLocation(),
+                  diag::ext_string_too_long)
+      << GetNumStringChars() << MaxChars
+      << (Features.CPlusPlus ? 2 : Features.C99 ? 1 : 0)
+      << SourceRange(StringToks.front().getLocation(),
+                     StringToks.back().getLocation());
+}
+
+/// \returns true if \p S only holds ASCII characters. The characters are
+/// checked a word at a time, since string literals can be very large.
+static bool isAllASCII(StringRef S) {
+  const char *Ptr = S.begin(), *End = S.end();
+  uint64_t Bits = 0;
+  for (; End - Ptr >= 8; Ptr += 8) {
+    uint64_t Word;
+    memcpy(&Word, Ptr, sizeof(Word));
+    Bits |= Word;
+  }
+  for (; Ptr != End; ++Ptr)
+    Bits |= static_cast<unsigned char>(*Ptr);
+  return (Bits & 0x8080808080808080ULL) == 0;
+}
+
+/// \returns the contents of \p Tok, a string literal whose characters are
+/// bytes, in the source buffer, if it has no escapes, isn't a raw string
+/// nor has a ud-suffix and is valid UTF-8, i.e. if its contents are its
+/// value.
+Optional<StringRef>
+StringLiteralParser::getUnprocessedString(const Token &Tok) const {
+  if (Tok.needsCleaning() || Tok.hasUDSuffix())
+    return None;
+
+  // The spelling of a token which needs no cleaning is in the source buffer.
+  const char *Spelling = nullptr;
+  bool Invalid = false;
+  unsigned Length = Lexer::getSpelling(Tok, Spelling, SM, Features, &Invalid);
+  if (Invalid)
+    return None;
+
+  // Skip the encoding prefix and the quotes.
+  StringRef Contents(Spelling, Length);
+  size_t Quote = Contents.find('"');
+  if (Quote == StringRef::npos || (Quote && Contents[Quote - 1] == 'R') ||
+      Contents.size() < Quote + 2 || Contents.back() != '"')
+    return None;
+  Contents = Contents.slice(Quote + 1, Contents.size() - 1);
+
+  // A pascal string starts with an escape too.
+  if (Contents.find('\\') != StringRef::npos)
+    return None;
+
+  // The bad encodings are diagnosed while copying the string.
+  if (!isAllASCII(Contents)) {
+    const llvm::UTF8 *Begin =
+        reinterpret_cast<const llvm::UTF8 *>(Contents.begin());
+    if (!llvm::isLegalUTF8String(
+            &Begin, reinterpret_cast<const llvm::UTF8 *>(Contents.end())))
+      return None;
+  }
+  return Contents;
+}
+
 static const char *resyncUTF8(const char *Err, const char *End) {
   if (Err == End)
     return End;
@@ -1759,6 +1830,13 @@ static const char *resyncUTF8(const char *Err, const char *End) {
 bool StringLiteralParser::CopyStringFragment(const Token &Tok,
                                              const char *TokBegin,
                                              StringRef Fragment) {
+  // ASCII needs neither validating nor, for narrow strings, widening.
+  if (CharByteWidth == 1 && isAllASCII(Fragment)) {
+    memcpy(ResultPtr, Fragment.data(), Fragment.size());
+    ResultPtr += Fragment.size();
+    return false;
+  }
+
   const llvm::UTF8 *ErrorPtrTmp;
   if (ConvertUTF8toWide(CharByteWidth, Fragment, ResultPtr, ErrorPtrTmp))
     return false;
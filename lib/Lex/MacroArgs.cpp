@@ -51,6 +51,7 @@ MacroArgs *MacroArgs::create(const MacroInfo *MI,
     Result = new (
         llvm::safe_malloc(totalSizeToAlloc<Token>(UnexpArgTokens.size())))
         MacroArgs(UnexpArgTokens.size(), VarargsElided, MI->getNumParams());
+    ++PP.NumMacroArgsAllocated;
   } else {
     Result = *ResultEnt;
     // Unlink this node from the preprocessors singly linked list.
@@ -173,6 +174,8 @@ const std::vector<Token> &MacroArgs::getPreExpArgument(unsigned Arg,
 
   const Token *AT = getUnexpArgument(Arg);
   unsigned NumToks = getArgLength(AT)+1;  // Include the EOF.
+  // The expansion usually has at least as many tokens as the argument.
+  Result.reserve(NumToks);
 
   // Otherwise, we have to pre-expand this argument, populating Result.  To do
   // this, we set up a fake TokenLexer to lex from the unexpanded argument
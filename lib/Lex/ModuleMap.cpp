@@ -41,6 +41,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -417,11 +418,24 @@ ModuleMap::findHeaderInUmbrellaDirs(const FileEntry *File,
 
   // Keep walking up the directory hierarchy, looking for a directory with
   // an umbrella header.
+  size_t NumIntermediateDirs = IntermediateDirs.size();
   do {
     auto KnownDir = UmbrellaDirs.find(Dir);
     if (KnownDir != UmbrellaDirs.end())
       return KnownHeader(KnownDir->second, NormalHeader);
 
+    // If the header is in Frameworks/X.framework of a framework module whose
+    // subframeworks weren't inferred yet, infer them and search again.
+    auto Lazy = LazySubframeworks.find(Dir);
+    if (Lazy != LazySubframeworks.end() &&
+        IntermediateDirs.size() >= NumIntermediateDirs + 2 &&
+        llvm::sys::path::filename(IntermediateDirs.back()->getName()) ==
+            "Frameworks" &&
+        inferLazySubframeworks(Lazy->second.Framework)) {
+      IntermediateDirs.resize(NumIntermediateDirs);
+      return findHeaderInUmbrellaDirs(File, IntermediateDirs);
+    }
+
     IntermediateDirs.push_back(Dir);
 
     // Retrieve our parent path.
@@ -789,7 +803,13 @@ Module *ModuleMap::lookupModuleQualified(StringRef Name, Module *Context) const{
   if (!Context)
     return findModule(Name);
 
-  return Context->findSubmodule(Name);
+  if (Module *Sub = Context->findSubmodule(Name))
+    return Sub;
+
+  // The module could be a subframework which wasn't inferred yet.
+  if (Context->IsFramework && inferLazySubframeworks(Context))
+    return Context->findSubmodule(Name);
+  return nullptr;
 }
 
 std::pair<Module *, bool> ModuleMap::findOrCreateModule(StringRef Name,
@@ -1031,6 +1051,48 @@ Module *ModuleMap::inferFrameworkModule(const DirectoryEntry *FrameworkDir,
   Result->InferSubmodules = true;
   Result->InferExportWildcard = true;
 
+  // The subframeworks are inferred once one of them, or one of their
+  // headers, is looked up: most of the translation units naming a framework
+  // never use most of its (nested) subframeworks.
+  LazySubframeworks[FrameworkDir] = {Result, Attrs};
+
+  // If the module is a top-level framework, automatically link against the
+  // framework.
+  if (!Result->isSubFramework()) {
+    inferFrameworkLink(Result, FrameworkDir, FileMgr);
+  }
+
+  return Result;
+}
+
+bool ModuleMap::inferLazySubframeworks(const Module *Framework) const {
+  auto Known = LazySubframeworks.find(Framework->Directory);
+  if (Known == LazySubframeworks.end() || Known->second.Framework != Framework)
+    return false;
+
+  UninferredSubframeworks Subframeworks = Known->second;
+  LazySubframeworks.erase(Known);
+  // This operation is logically const; the subframeworks are part of their
+  // framework module whether or not they were inferred.
+  const_cast<ModuleMap *>(this)->inferSubframeworks(Subframeworks.Framework,
+                                                    Subframeworks.Attrs);
+  return true;
+}
+
+void ModuleMap::inferAllSubframeworks(Module *Mod) {
+  SmallVector<Module *, 8> Worklist(1, Mod);
+  while (!Worklist.empty()) {
+    Module *M = Worklist.pop_back_val();
+    if (M->IsFramework)
+      inferLazySubframeworks(M);
+    Worklist.append(M->submodule_begin(), M->submodule_end());
+  }
+}
+
+void ModuleMap::inferSubframeworks(Module *Framework, Attributes Attrs) {
+  const DirectoryEntry *FrameworkDir = Framework->Directory;
+  FileManager &FileMgr = SourceMgr.getFileManager();
+
   // Look for subframeworks.
   std::error_code EC;
   SmallString<128> SubframeworksDirName
@@ -1073,17 +1135,9 @@ Module *ModuleMap::inferFrameworkModule(const DirectoryEntry *FrameworkDir,
         continue;
 
       // FIXME: Do we want to warn about subframeworks without umbrella headers?
-      inferFrameworkModule(*SubframeworkDir, Attrs, Result);
+      inferFrameworkModule(*SubframeworkDir, Attrs, Framework);
     }
   }
-
-  // If the module is a top-level framework, automatically link against the
-  // framework.
-  if (!Result->isSubFramework()) {
-    inferFrameworkLink(Result, FrameworkDir, FileMgr);
-  }
-
-  return Result;
 }
 
 Module *ModuleMap::createShadowedModule(StringRef Name, bool IsFramework,
@@ -1378,7 +1432,23 @@ namespace clang {
   };
 
   class ModuleMapParser {
-    Lexer &L;
+    /// The lexer of the module map file, or null if its tokens come from the
+    /// module map cache.
+    Lexer *L;
+
+    /// The cached tokens which weren't consumed yet, the last one being the
+    /// end of the file, and the start of the file their offsets are relative
+    /// to.
+    ArrayRef<ModuleMapCache::Token> CachedTokens;
+    SourceLocation CachedTokensStart;
+
+    /// If not null, the tokens lexed are added to it, to be cached.
+    std::vector<ModuleMapCache::Token> *LexedTokens = nullptr;
+
+    /// Whether the lexed tokens can be cached: they can't be if lexing them
+    /// was diagnosed, or if the module map was terminated by a directive.
+    bool CanCacheLexedTokens = true;
+
     SourceManager &SourceMgr;
 
     /// Default target information, used only for string literal
@@ -1459,11 +1529,29 @@ namespace clang {
     bool parseOptionalAttributes(Attributes &Attrs);
 
   public:
+    /// Parse the tokens lexed by \p L, adding them to \p LexedTokens if it
+    /// isn't null.
     explicit ModuleMapParser(Lexer &L, SourceManager &SourceMgr,
+                             const TargetInfo *Target, DiagnosticsEngine &Diags,
+                             ModuleMap &Map, const FileEntry *ModuleMapFile,
+                             const DirectoryEntry *Directory, bool IsSystem,
+                             std::vector<ModuleMapCache::Token> *LexedTokens =
+                                 nullptr)
+        : L(&L), LexedTokens(LexedTokens), SourceMgr(SourceMgr),
+          Target(Target), Diags(Diags), Map(Map), ModuleMapFile(ModuleMapFile),
+          Directory(Directory), IsSystem(IsSystem) {
+      Tok.clear();
+      consumeToken();
+    }
+
+    /// Parse the \p CachedTokens of the file starting at \p Start.
+    explicit ModuleMapParser(ArrayRef<ModuleMapCache::Token> CachedTokens,
+                             SourceLocation Start, SourceManager &SourceMgr,
                              const TargetInfo *Target, DiagnosticsEngine &Diags,
                              ModuleMap &Map, const FileEntry *ModuleMapFile,
                              const DirectoryEntry *Directory, bool IsSystem)
-        : L(L), SourceMgr(SourceMgr), Target(Target), Diags(Diags), Map(Map),
+        : L(nullptr), CachedTokens(CachedTokens), CachedTokensStart(Start),
+          SourceMgr(SourceMgr), Target(Target), Diags(Diags), Map(Map),
           ModuleMapFile(ModuleMapFile), Directory(Directory),
           IsSystem(IsSystem) {
       Tok.clear();
@@ -1472,6 +1560,8 @@ namespace clang {
 
     bool parseModuleMapFile();
 
+    bool canCacheLexedTokens() const { return CanCacheLexedTokens; }
+
     bool terminatedByDirective() { return false; }
     SourceLocation getLocation() { return Tok.getLocation(); }
   };
@@ -1481,10 +1571,28 @@ namespace clang {
 SourceLocation ModuleMapParser::consumeToken() {
   SourceLocation Result = Tok.getLocation();
 
+  if (!L) {
+    const ModuleMapCache::Token &Cached = CachedTokens.front();
+    // Stay at the end of the file once it is reached.
+    if (CachedTokens.size() > 1)
+      CachedTokens = CachedTokens.drop_front();
+    Tok.clear();
+    Tok.Kind = static_cast<MMToken::TokenKind>(Cached.Kind);
+    Tok.Location =
+        CachedTokensStart.getLocWithOffset(Cached.Offset).getRawEncoding();
+    if (Tok.is(MMToken::IntegerLiteral)) {
+      Tok.IntegerValue = Cached.Integer;
+    } else {
+      Tok.StringData = Cached.String.data();
+      Tok.StringLength = Cached.String.size();
+    }
+    return Result;
+  }
+
 retry:
   Tok.clear();
   Token LToken;
-  L.LexFromRawLexer(LToken);
+  L->LexFromRawLexer(LToken);
   Tok.Location = LToken.getLocation().getRawEncoding();
   switch (LToken.getKind()) {
   case tok::raw_identifier: {
@@ -1552,14 +1660,17 @@ retry:
     if (LToken.hasUDSuffix()) {
       Diags.Report(LToken.getLocation(), diag::err_invalid_string_udl);
       HadError = true;
+      CanCacheLexedTokens = false;
       goto retry;
     }
 
     // Parse the string literal.
     LangOptions LangOpts;
     StringLiteralParser StringLiteral(LToken, SourceMgr, LangOpts, *Target);
-    if (StringLiteral.hadError)
+    if (StringLiteral.hadError) {
+      CanCacheLexedTokens = false;
       goto retry;
+    }
 
     // Copy the string literal into our string data allocator.
     unsigned Length = StringLiteral.GetStringLength();
@@ -1580,11 +1691,12 @@ retry:
     SpellingBuffer.resize(LToken.getLength() + 1);
     const char *Start = SpellingBuffer.data();
     unsigned Length =
-        Lexer::getSpelling(LToken, Start, SourceMgr, L.getLangOpts());
+        Lexer::getSpelling(LToken, Start, SourceMgr, L->getLangOpts());
     uint64_t Value;
     if (StringRef(Start, Length).getAsInteger(0, Value)) {
       Diags.Report(Tok.getLocation(), diag::err_mmap_unknown_token);
       HadError = true;
+      CanCacheLexedTokens = false;
       goto retry;
     }
 
@@ -1601,9 +1713,10 @@ retry:
     //   #pragma clang module contents
     // When building the module, we'll treat the rest of the file as the
     // contents of the module.
+    CanCacheLexedTokens = false;
     {
       auto NextIsIdent = [&](StringRef Str) -> bool {
-        L.LexFromRawLexer(LToken);
+        L->LexFromRawLexer(LToken);
         return !LToken.isAtStartOfLine() && LToken.is(tok::raw_identifier) &&
                LToken.getRawIdentifier() == Str;
       };
@@ -1618,9 +1731,20 @@ retry:
   default:
     Diags.Report(Tok.getLocation(), diag::err_mmap_unknown_token);
     HadError = true;
+    CanCacheLexedTokens = false;
     goto retry;
   }
 
+  if (LexedTokens) {
+    ModuleMapCache::Token Lexed;
+    Lexed.Kind = Tok.Kind;
+    Lexed.Offset = SourceMgr.getFileOffset(Tok.getLocation());
+    if (Tok.is(MMToken::IntegerLiteral))
+      Lexed.Integer = Tok.getInteger();
+    else
+      Lexed.String = Tok.getString();
+    LexedTokens->push_back(Lexed);
+  }
   return Result;
 }
 
@@ -2961,6 +3085,21 @@ bool ModuleMapParser::parseModuleMapFile() {
   } while (true);
 }
 
+ModuleMapCache *ModuleMap::getTokenCache() {
+  if (!TokenCacheLoaded) {
+    TokenCacheLoaded = true;
+    StringRef Path = HeaderInfo.getHeaderSearchOpts().ModuleMapCachePath;
+    if (!Path.empty())
+      TokenCache = ModuleMapCache::load(Path);
+  }
+  return TokenCache.get();
+}
+
+void ModuleMap::writeModuleMapCache() {
+  if (TokenCache)
+    TokenCache->write();
+}
+
 bool ModuleMap::parseModuleMapFile(const FileEntry *File, bool IsSystem,
                                    const DirectoryEntry *Dir, FileID ID,
                                    unsigned *Offset,
@@ -2970,6 +3109,12 @@ bool ModuleMap::parseModuleMapFile(const FileEntry *File, bool IsSystem,
     = ParsedModuleMap.find(File);
   if (Known != ParsedModuleMap.end())
     return Known->second;
+  llvm::TimeTraceScope TimeScope("Parse ModuleMap", File->getName());
+
+  // Only the whole files read from disk are cached.
+  ModuleMapCache *Cache = nullptr;
+  if (ID.isInvalid() && !Offset && !SourceMgr.isFileOverridden(File))
+    Cache = getTokenCache();
 
   // If the module map file wasn't already entered, do so now.
   if (ID.isInvalid()) {
@@ -2978,6 +3123,27 @@ bool ModuleMap::parseModuleMapFile(const FileEntry *File, bool IsSystem,
     ID = SourceMgr.createFileID(File, ExternModuleLoc, FileCharacter);
   }
 
+  // Parse the cached tokens if they are still those of the file, without
+  // reading it.
+  Optional<ArrayRef<ModuleMapCache::Token>> CachedTokens;
+  if (Cache)
+    CachedTokens = Cache->lookup(*File);
+  if (CachedTokens && !CachedTokens->empty() &&
+      CachedTokens->back().Kind == MMToken::EndOfFile &&
+      llvm::all_of(*CachedTokens, [](const ModuleMapCache::Token &T) {
+        return T.Kind <= MMToken::RSquare;
+      })) {
+    SourceLocation Start = SourceMgr.getLocForStartOfFile(ID);
+    ModuleMapParser Parser(*CachedTokens, Start, SourceMgr, Target, Diags,
+                           *this, File, Dir, IsSystem);
+    bool Result = Parser.parseModuleMapFile();
+    ParsedModuleMap[File] = Result;
+
+    for (const auto &Cb : Callbacks)
+      Cb->moduleMapFileRead(Start, *File, IsSystem);
+    return Result;
+  }
+
   assert(Target && "Missing target information");
   const llvm::MemoryBuffer *Buffer = SourceMgr.getBuffer(ID);
   if (!Buffer)
@@ -2991,10 +3157,13 @@ bool ModuleMap::parseModuleMapFile(const FileEntry *File, bool IsSystem,
           Buffer->getBufferStart() + (Offset ? *Offset : 0),
           Buffer->getBufferEnd());
   SourceLocation Start = L.getSourceLocation();
+  std::vector<ModuleMapCache::Token> LexedTokens;
   ModuleMapParser Parser(L, SourceMgr, Target, Diags, *this, File, Dir,
-                         IsSystem);
+                         IsSystem, Cache ? &LexedTokens : nullptr);
   bool Result = Parser.parseModuleMapFile();
   ParsedModuleMap[File] = Result;
+  if (Cache && Parser.canCacheLexedTokens())
+    Cache->add(*File, LexedTokens);
 
   if (Offset) {
     auto Loc = SourceMgr.getDecomposedLoc(Parser.getLocation());
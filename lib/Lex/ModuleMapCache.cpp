@@ -0,0 +1,169 @@
+//===- ModuleMapCache.cpp - Tokens of module map files --------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the ModuleMapCache.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/ModuleMapCache.h"
+#include "clang/Basic/FileManager.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+// The cache holds, for each file, its name, size and modification time and
+// its tokens. Strings are prefixed with their 32 bit size, and everything is
+// little-endian.
+static constexpr llvm::StringLiteral CacheMagic = "MODULEMAPCACHE1";
+
+namespace {
+/// Reads the fields of a cache.
+class CacheReader {
+public:
+  explicit CacheReader(StringRef Data) : Data(Data) {}
+
+  bool read(uint32_t &Value) {
+    if (Data.size() < sizeof(Value))
+      return false;
+    Value = llvm::support::endian::read32le(Data.data());
+    Data = Data.drop_front(sizeof(Value));
+    return true;
+  }
+
+  bool read(uint64_t &Value) {
+    if (Data.size() < sizeof(Value))
+      return false;
+    Value = llvm::support::endian::read64le(Data.data());
+    Data = Data.drop_front(sizeof(Value));
+    return true;
+  }
+
+  bool read(StringRef &Value) {
+    uint32_t Size;
+    if (!read(Size) || Data.size() < Size)
+      return false;
+    Value = Data.take_front(Size);
+    Data = Data.drop_front(Size);
+    return true;
+  }
+
+  size_t remaining() const { return Data.size(); }
+
+private:
+  StringRef Data;
+};
+} // namespace
+
+std::unique_ptr<ModuleMapCache> ModuleMapCache::load(StringRef Path) {
+  std::unique_ptr<ModuleMapCache> Cache(new ModuleMapCache(Path));
+  // The cache can be mapped, since it is replaced rather than overwritten.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (Buffer) {
+    Cache->Buffer = std::move(*Buffer);
+    if (!Cache->read())
+      Cache->Entries.clear();
+  }
+  return Cache;
+}
+
+bool ModuleMapCache::read() {
+  CacheReader Reader(Buffer->getBuffer());
+  StringRef Magic;
+  uint32_t NumFiles;
+  if (!Reader.read(Magic) || Magic != CacheMagic || !Reader.read(NumFiles))
+    return false;
+
+  for (uint32_t I = 0; I != NumFiles; ++I) {
+    StringRef Name;
+    Entry E;
+    uint32_t NumTokens;
+    if (!Reader.read(Name) || !Reader.read(E.Size) ||
+        !Reader.read(E.ModificationTime) || !Reader.read(NumTokens) ||
+        NumTokens > Reader.remaining() / (3 * sizeof(uint32_t)))
+      return false;
+    E.Tokens.resize(NumTokens);
+    for (Token &T : E.Tokens) {
+      uint32_t Kind, Offset;
+      if (!Reader.read(Kind) || !Reader.read(Offset) ||
+          !Reader.read(T.Integer) || !Reader.read(T.String))
+        return false;
+      T.Kind = Kind;
+      T.Offset = Offset;
+    }
+    Entries[Name] = std::move(E);
+  }
+  return Reader.remaining() == 0;
+}
+
+Optional<ArrayRef<ModuleMapCache::Token>>
+ModuleMapCache::lookup(const FileEntry &File) const {
+  auto It = Entries.find(File.getName());
+  if (It == Entries.end() || It->second.Size != uint64_t(File.getSize()) ||
+      It->second.ModificationTime != uint64_t(File.getModificationTime()))
+    return None;
+  return llvm::makeArrayRef(It->second.Tokens);
+}
+
+void ModuleMapCache::add(const FileEntry &File, ArrayRef<Token> Tokens) {
+  Entry &E = Entries[File.getName()];
+  E.Size = File.getSize();
+  E.ModificationTime = File.getModificationTime();
+  E.Tokens.assign(Tokens.begin(), Tokens.end());
+  for (Token &T : E.Tokens) {
+    char *String = Allocator.Allocate<char>(T.String.size());
+    std::copy(T.String.begin(), T.String.end(), String);
+    T.String = StringRef(String, T.String.size());
+  }
+  Modified = true;
+}
+
+void ModuleMapCache::write() {
+  if (!Modified)
+    return;
+  Modified = false;
+
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    llvm::support::endian::Writer W(OS, llvm::support::little);
+    auto WriteString = [&](StringRef S) {
+      W.write<uint32_t>(S.size());
+      OS << S;
+    };
+    WriteString(CacheMagic);
+    W.write<uint32_t>(Entries.size());
+    for (const auto &E : Entries) {
+      WriteString(E.getKey());
+      W.write<uint64_t>(E.second.Size);
+      W.write<uint64_t>(E.second.ModificationTime);
+      W.write<uint32_t>(E.second.Tokens.size());
+      for (const Token &T : E.second.Tokens) {
+        W.write<uint32_t>(T.Kind);
+        W.write<uint32_t>(T.Offset);
+        W.write<uint64_t>(T.Integer);
+        WriteString(T.String);
+      }
+    }
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
+}
@@ -25,6 +25,8 @@ using namespace clang;
 void Preprocessor::EnableBacktrackAtThisPos() {
   assert(LexLevel == 0 && "cannot use lookahead while lexing");
   BacktrackPositions.push_back(CachedLexPos);
+  if (BacktrackPositions.size() > MaxBacktrackDepth)
+    MaxBacktrackDepth = BacktrackPositions.size();
   EnterCachingLexMode();
 }
 
@@ -42,6 +44,7 @@ void Preprocessor::Backtrack() {
          && "EnableBacktrackAtThisPos was not called!");
   CachedLexPos = BacktrackPositions.back();
   BacktrackPositions.pop_back();
+  ++NumBacktracks;
   recomputeCurLexerKind();
 }
 
@@ -145,7 +148,7 @@ bool Preprocessor::IsPreviousCachedToken(const Token &Tok) const {
   if (LastCachedTok.getKind() != Tok.getKind())
     return false;
 
-  int RelOffset = 0;
+  SourceLocation::IntTy RelOffset = 0;
   if ((!getSourceManager().isInSameSLocAddrSpace(
           Tok.getLocation(), getLastCachedTokenLocation(), &RelOffset)) ||
       RelOffset)
@@ -92,7 +92,20 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
         CodeCompletionFileLoc.getLocWithOffset(CodeCompletionOffset);
   }
 
-  EnterSourceFileWithLexer(new Lexer(FID, InputFile, *this), CurDir);
+  Lexer *TheLexer = new Lexer(FID, InputFile, *this);
+
+  // Raw lex large files in parallel before reading them.
+  if (PPOpts->ParallelLexThreshold &&
+      InputFile->getBufferSize() >= PPOpts->ParallelLexThreshold &&
+      !isCodeCompletionEnabled()) {
+    std::unique_ptr<PreLexedBuffer> &Tokens =
+        PreLexedBuffers[InputFile->getBufferStart()];
+    if (!Tokens)
+      Tokens = PreLexedBuffer::lex(*InputFile, getLangOpts());
+    TheLexer->setPreLexedBuffer(Tokens.get());
+  }
+
+  EnterSourceFileWithLexer(TheLexer, CurDir);
   return false;
 }
 
@@ -129,6 +142,7 @@ void Preprocessor::EnterMacro(Token &Tok, SourceLocation ILEnd,
   std::unique_ptr<TokenLexer> TokLexer;
   if (NumCachedTokenLexers == 0) {
     TokLexer = std::make_unique<TokenLexer>(Tok, ILEnd, Macro, Args, *this);
+    ++NumTokenLexersAllocated;
   } else {
     TokLexer = std::move(TokenLexerCache[--NumCachedTokenLexers]);
     TokLexer->Init(Tok, ILEnd, Macro, Args);
@@ -182,6 +196,7 @@ void Preprocessor::EnterTokenStream(const Token *Toks, unsigned NumToks,
   if (NumCachedTokenLexers == 0) {
     TokLexer = std::make_unique<TokenLexer>(
         Toks, NumToks, DisableMacroExpansion, OwnsTokens, IsReinject, *this);
+    ++NumTokenLexersAllocated;
   } else {
     TokLexer = std::move(TokenLexerCache[--NumCachedTokenLexers]);
     TokLexer->Init(Toks, NumToks, DisableMacroExpansion, OwnsTokens,
@@ -333,6 +348,11 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
       // Okay, this has a controlling macro, remember in HeaderFileInfo.
       if (const FileEntry *FE = CurPPLexer->getFileEntry()) {
         HeaderInfo.SetFileControllingMacro(FE, ControllingMacro);
+        // Share it with the other preprocessors, unless it was found in
+        // contents that are not the ones on disk.
+        if (IncludeGuardCache *Guards = HeaderInfo.getIncludeGuardCache())
+          if (!SourceMgr.isFileOverridden(FE))
+            Guards->insert(*FE, ControllingMacro->getName());
         if (MacroInfo *MI =
               getMacroInfo(const_cast<IdentifierInfo*>(ControllingMacro)))
           MI->setUsedForHeaderGuard(true);
@@ -766,9 +766,10 @@ MacroArgs *Preprocessor::ReadMacroCallArgumentList(Token &MacroName,
   assert(Tok.is(tok::l_paren) && "Error computing l-paren-ness?");
 
   // ArgTokens - Build up a list of tokens that make up each argument.  Each
-  // argument is separated by an EOF token.  Use a SmallVector so we can avoid
-  // heap allocations in the common case.
-  SmallVector<Token, 64> ArgTokens;
+  // argument is separated by an EOF token.  Use a pooled buffer so we can
+  // avoid heap allocations in the common case.
+  PooledTokenBuffer ArgTokensBuffer(*this);
+  SmallVectorImpl<Token> &ArgTokens = *ArgTokensBuffer;
   bool ContainsCodeCompletionTok = false;
   bool FoundElidedComma = false;
 
@@ -0,0 +1,128 @@
+//===- PreLexedBuffer.cpp - Tokens of a buffer lexed in parallel ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the PreLexedBuffer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PreLexedBuffer.h"
+#include "clang/Basic/CharInfo.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <cstring>
+
+using namespace clang;
+
+/// Whether the Lexer would produce \p Tok, which starts at \p TokStart, in
+/// any state and without diagnosing it.
+static bool isReusable(const Token &Tok, const char *TokStart,
+                       const char *BufStart) {
+  if (Tok.needsCleaning())
+    return false;
+
+  StringRef Spelling(TokStart, Tok.getLength());
+  switch (Tok.getKind()) {
+  case tok::raw_identifier:
+    // '$' and extended characters may be diagnosed.
+    return llvm::all_of(Spelling, [](char C) { return isIdentifierBody(C); });
+  case tok::numeric_constant:
+    // Digit separators and extended characters may be diagnosed.
+    return llvm::all_of(Spelling, [](char C) {
+      return isPreprocessingNumberBody(C) || C == '+' || C == '-';
+    });
+  case tok::hash:
+  case tok::hashhash:
+  case tok::hashat:
+    // These start directives, or are diagnosed outside of them.
+    return false;
+  default:
+    break;
+  }
+
+  // Punctuators, spelled without digraphs.
+  const char *Punctuator = tok::getPunctuatorSpelling(Tok.getKind());
+  if (!Punctuator || Spelling != Punctuator)
+    return false;
+
+  // These can start or end a conflict marker at the start of a line, which
+  // depends on the state of the Lexer.
+  if (strchr("<>=|", Spelling[0]) &&
+      (TokStart == BufStart || isVerticalWhitespace(TokStart[-1])))
+    return false;
+
+  // '<::' and '<=>' may be diagnosed when they aren't a token.
+  if (Spelling[0] == '<' && (TokStart[Spelling.size()] == ':' ||
+                             TokStart[Spelling.size()] == '>'))
+    return false;
+  return true;
+}
+
+/// Raw lex the tokens that start between \p ChunkStart and \p ChunkEnd.
+static void lexChunk(const char *BufStart, const char *ChunkStart,
+                     const char *ChunkEnd, const char *BufEnd,
+                     const LangOptions &LangOpts,
+                     std::vector<PreLexedBuffer::Token> &Tokens) {
+  Lexer L(SourceLocation(), LangOpts, BufStart, ChunkStart, BufEnd);
+  Token Tok;
+  while (true) {
+    L.LexFromRawLexer(Tok);
+    if (Tok.is(tok::eof))
+      return;
+    const char *TokStart = L.getBufferLocation() - Tok.getLength();
+    if (TokStart >= ChunkEnd)
+      return;
+    Tokens.push_back({unsigned(TokStart - BufStart), Tok.getLength(),
+                      Tok.getKind(), isReusable(Tok, TokStart, BufStart)});
+  }
+}
+
+std::unique_ptr<PreLexedBuffer>
+PreLexedBuffer::lex(const llvm::MemoryBuffer &Buffer,
+                    const LangOptions &LangOpts, unsigned MinChunkSize) {
+  const char *BufStart = Buffer.getBufferStart();
+  const char *BufEnd = Buffer.getBufferEnd();
+  unsigned NumThreads = std::max(1u, llvm::hardware_concurrency());
+  size_t ChunkSize = std::max<size_t>(
+      MinChunkSize, (BufEnd - BufStart) / NumThreads + 1);
+
+  // Split the buffer after a newline every ChunkSize bytes.
+  SmallVector<const char *, 16> Bounds = {BufStart};
+  while (size_t(BufEnd - Bounds.back()) > ChunkSize) {
+    const char *Start = Bounds.back() + ChunkSize;
+    const void *Newline = memchr(Start, '\n', BufEnd - Start);
+    if (!Newline)
+      break;
+    Bounds.push_back(static_cast<const char *>(Newline) + 1);
+  }
+  Bounds.push_back(BufEnd);
+
+  std::vector<std::vector<Token>> Chunks(Bounds.size() - 1);
+  auto LexChunk = [&](unsigned I) {
+    lexChunk(BufStart, Bounds[I], Bounds[I + 1], BufEnd, LangOpts, Chunks[I]);
+  };
+  if (Chunks.size() == 1) {
+    LexChunk(0);
+  } else {
+    llvm::ThreadPool Pool(std::min<unsigned>(NumThreads, Chunks.size()));
+    for (unsigned I = 0, E = Chunks.size(); I != E; ++I)
+      Pool.async(LexChunk, I);
+    Pool.wait();
+  }
+
+  auto Result = std::make_unique<PreLexedBuffer>();
+  size_t NumTokens = 0;
+  for (const std::vector<Token> &Chunk : Chunks)
+    NumTokens += Chunk.size();
+  Result->Tokens.reserve(NumTokens);
+  for (const std::vector<Token> &Chunk : Chunks)
+    Result->Tokens.insert(Result->Tokens.end(), Chunk.begin(), Chunk.end());
+  return Result;
+}
@@ -74,19 +74,22 @@ PreprocessingRecord::getPreprocessedEntitiesInRange(SourceRange Range) {
                           iterator(this, Res.second));
 }
 
-static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
-                                           SourceManager &SM) {
+static bool isLocationInFileID(SourceLocation Loc, FileID FID,
+                               SourceManager &SM) {
   assert(FID.isValid());
-  if (!PPE)
-    return false;
-
-  SourceLocation Loc = PPE->getSourceRange().getBegin();
   if (Loc.isInvalid())
     return false;
 
   return SM.isInFileID(SM.getFileLoc(Loc), FID);
 }
 
+static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
+                                           SourceManager &SM) {
+  if (!PPE)
+    return false;
+  return isLocationInFileID(PPE->getSourceRange().getBegin(), FID, SM);
+}
+
 /// Returns true if the preprocessed entity that \arg PPEI iterator
 /// points to is coming from the file \arg FID.
 ///
@@ -123,12 +126,11 @@ bool PreprocessingRecord::isEntityInFileID(iterator PPEI, FileID FID) {
                                           FID, SourceMgr);
   }
 
-  if (unsigned(Pos) >= PreprocessedEntities.size()) {
+  if (unsigned(Pos) >= LocalEntityRanges.size()) {
     assert(0 && "Out-of bounds local preprocessed entity");
     return false;
   }
-  return isPreprocessedEntityIfInFileID(PreprocessedEntities[Pos],
-                                        FID, SourceMgr);
+  return isLocationInFileID(LocalEntityRanges[Pos].getBegin(), FID, SourceMgr);
 }
 
 /// Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -183,26 +185,21 @@ struct PPEntityComp {
 
   explicit PPEntityComp(const SourceManager &SM) : SM(SM) {}
 
-  bool operator()(PreprocessedEntity *L, PreprocessedEntity *R) const {
-    SourceLocation LHS = getLoc(L);
-    SourceLocation RHS = getLoc(R);
+  bool operator()(SourceRange L, SourceRange R) const {
+    SourceLocation LHS = (L.*getRangeLoc)();
+    SourceLocation RHS = (R.*getRangeLoc)();
     return SM.isBeforeInTranslationUnit(LHS, RHS);
   }
 
-  bool operator()(PreprocessedEntity *L, SourceLocation RHS) const {
-    SourceLocation LHS = getLoc(L);
+  bool operator()(SourceRange L, SourceLocation RHS) const {
+    SourceLocation LHS = (L.*getRangeLoc)();
     return SM.isBeforeInTranslationUnit(LHS, RHS);
   }
 
-  bool operator()(SourceLocation LHS, PreprocessedEntity *R) const {
-    SourceLocation RHS = getLoc(R);
+  bool operator()(SourceLocation LHS, SourceRange R) const {
+    SourceLocation RHS = (R.*getRangeLoc)();
     return SM.isBeforeInTranslationUnit(LHS, RHS);
   }
-
-  SourceLocation getLoc(PreprocessedEntity *PPE) const {
-    SourceRange Range = PPE->getSourceRange();
-    return (Range.*getRangeLoc)();
-  }
 };
 
 } // namespace
@@ -212,11 +209,10 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  size_t Count = PreprocessedEntities.size();
+  size_t Count = LocalEntityRanges.size();
   size_t Half;
-  std::vector<PreprocessedEntity *>::const_iterator
-    First = PreprocessedEntities.begin();
-  std::vector<PreprocessedEntity *>::const_iterator I;
+  std::vector<SourceRange>::const_iterator First = LocalEntityRanges.begin();
+  std::vector<SourceRange>::const_iterator I;
 
   // Do a binary search manually instead of using std::lower_bound because
   // The end locations of entities may be unordered (when a macro expansion
@@ -226,8 +222,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
     Half = Count/2;
     I = First;
     std::advance(I, Half);
-    if (SourceMgr.isBeforeInTranslationUnit((*I)->getSourceRange().getEnd(),
-                                            Loc)){
+    if (SourceMgr.isBeforeInTranslationUnit(I->getEnd(), Loc)) {
       First = I;
       ++First;
       Count = Count - Half - 1;
@@ -235,7 +230,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
       Count = Half;
   }
 
-  return First - PreprocessedEntities.begin();
+  return First - LocalEntityRanges.begin();
 }
 
 unsigned
@@ -243,32 +238,42 @@ PreprocessingRecord::findEndLocalPreprocessedEntity(SourceLocation Loc) const {
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  auto I = llvm::upper_bound(PreprocessedEntities, Loc,
+  auto I = llvm::upper_bound(LocalEntityRanges, Loc,
                              PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  return I - PreprocessedEntities.begin();
+  return I - LocalEntityRanges.begin();
 }
 
 PreprocessingRecord::PPEntityID
 PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   assert(Entity);
-  SourceLocation BeginLoc = Entity->getSourceRange().getBegin();
+  SourceRange Range = Entity->getSourceRange();
+  uint32_t Data = LocalEntityObjects.size() << 1;
+  LocalEntityObjects.push_back(Entity);
 
   if (isa<MacroDefinitionRecord>(Entity)) {
-    assert((PreprocessedEntities.empty() ||
+    assert((LocalEntityRanges.empty() ||
             !SourceMgr.isBeforeInTranslationUnit(
-                BeginLoc,
-                PreprocessedEntities.back()->getSourceRange().getBegin())) &&
+                Range.getBegin(), LocalEntityRanges.back().getBegin())) &&
            "a macro definition was encountered out-of-order");
-    PreprocessedEntities.push_back(Entity);
-    return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
+    LocalEntityRanges.push_back(Range);
+    LocalEntityData.push_back(Data);
+    return getPPEntityID(LocalEntityRanges.size()-1, /*isLoaded=*/false);
   }
 
+  return addLocalEntity(Range, Data);
+}
+
+PreprocessingRecord::PPEntityID
+PreprocessingRecord::addLocalEntity(SourceRange Range, uint32_t Data) {
+  SourceLocation BeginLoc = Range.getBegin();
+
   // Check normal case, this entity begin location is after the previous one.
-  if (PreprocessedEntities.empty() ||
-      !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) {
-    PreprocessedEntities.push_back(Entity);
-    return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
+  if (LocalEntityRanges.empty() ||
+      !SourceMgr.isBeforeInTranslationUnit(
+          BeginLoc, LocalEntityRanges.back().getBegin())) {
+    LocalEntityRanges.push_back(Range);
+    LocalEntityData.push_back(Data);
+    return getPPEntityID(LocalEntityRanges.size()-1, /*isLoaded=*/false);
   }
 
   // The entity's location is not after the previous one; this can happen with
@@ -283,31 +288,26 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   //  FM(M1, M2)
   // \endcode
 
-  using pp_iter = std::vector<PreprocessedEntity *>::iterator;
+  auto Insert = [&](size_t Index) {
+    LocalEntityRanges.insert(LocalEntityRanges.begin() + Index, Range);
+    LocalEntityData.insert(LocalEntityData.begin() + Index, Data);
+    return getPPEntityID(Index, /*isLoaded=*/false);
+  };
 
   // Usually there are few macro expansions when defining the filename, do a
   // linear search for a few entities.
   unsigned count = 0;
-  for (pp_iter RI    = PreprocessedEntities.end(),
-               Begin = PreprocessedEntities.begin();
-       RI != Begin && count < 4; --RI, ++count) {
-    pp_iter I = RI;
-    --I;
-    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                                           (*I)->getSourceRange().getBegin())) {
-      pp_iter insertI = PreprocessedEntities.insert(RI, Entity);
-      return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                           /*isLoaded=*/false);
-    }
+  for (size_t RI = LocalEntityRanges.size(); RI != 0 && count < 4;
+       --RI, ++count) {
+    if (!SourceMgr.isBeforeInTranslationUnit(
+            BeginLoc, LocalEntityRanges[RI - 1].getBegin()))
+      return Insert(RI);
   }
 
   // Linear search unsuccessful. Do a binary search.
-  pp_iter I =
-      llvm::upper_bound(PreprocessedEntities, BeginLoc,
-                        PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  pp_iter insertI = PreprocessedEntities.insert(I, Entity);
-  return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                       /*isLoaded=*/false);
+  auto I = llvm::upper_bound(LocalEntityRanges, BeginLoc,
+                             PPEntityComp<&SourceRange::getBegin>(SourceMgr));
+  return Insert(I - LocalEntityRanges.begin());
 }
 
 void PreprocessingRecord::SetExternalSource(
@@ -358,9 +358,31 @@ PreprocessedEntity *PreprocessingRecord::getPreprocessedEntity(PPEntityID PPID){
   if (PPID.ID == 0)
     return nullptr;
   unsigned Index = PPID.ID - 1;
-  assert(Index < PreprocessedEntities.size() &&
+  assert(Index < LocalEntityRanges.size() &&
          "Out-of bounds local preprocessed entity");
-  return PreprocessedEntities[Index];
+  return getLocalPreprocessedEntity(Index);
+}
+
+/// Retrieve the local preprocessed entity at the given index.
+PreprocessedEntity *
+PreprocessingRecord::getLocalPreprocessedEntity(unsigned Index) {
+  uint32_t &Data = LocalEntityData[Index];
+  if (!(Data & 1))
+    return LocalEntityObjects[Data >> 1];
+
+  // Create the macro expansion, and keep it so that the same object is
+  // returned from now on.
+  MacroExpansionTarget Target = MacroExpansionTargets[Data >> 1];
+  SourceRange Range = LocalEntityRanges[Index];
+  MacroExpansion *Expansion;
+  if (MacroDefinitionRecord *Def = Target.dyn_cast<MacroDefinitionRecord *>())
+    Expansion = new (*this) MacroExpansion(Def, Range);
+  else
+    Expansion = new (*this) MacroExpansion(Target.get<IdentifierInfo *>(),
+                                           Range);
+  Data = LocalEntityObjects.size() << 1;
+  LocalEntityObjects.push_back(Expansion);
+  return Expansion;
 }
 
 /// Retrieve the loaded preprocessed entity at the given index.
@@ -396,11 +418,21 @@ void PreprocessingRecord::addMacroExpansion(const Token &Id,
   if (Id.getLocation().isMacroID())
     return;
 
+  // Only the range and the target of the expansion are recorded; the
+  // MacroExpansion is created if a client asks for it.
+  MacroExpansionTarget Target;
   if (MI->isBuiltinMacro())
-    addPreprocessedEntity(new (*this)
-                              MacroExpansion(Id.getIdentifierInfo(), Range));
+    Target = Id.getIdentifierInfo();
   else if (MacroDefinitionRecord *Def = findMacroDefinition(MI))
-    addPreprocessedEntity(new (*this) MacroExpansion(Def, Range));
+    Target = Def;
+  else
+    return;
+
+  auto Known = MacroExpansionTargetIDs.try_emplace(
+      Target.getOpaqueValue(), MacroExpansionTargets.size());
+  if (Known.second)
+    MacroExpansionTargets.push_back(Target);
+  addLocalEntity(Range, (Known.first->second << 1) | 1);
 }
 
 void PreprocessingRecord::Ifdef(SourceLocation Loc, const Token &MacroNameTok,
@@ -510,7 +542,11 @@ void PreprocessingRecord::InclusionDirective(
 size_t PreprocessingRecord::getTotalMemory() const {
   return BumpAlloc.getTotalMemory()
     + llvm::capacity_in_bytes(MacroDefinitions)
-    + llvm::capacity_in_bytes(PreprocessedEntities)
+    + llvm::capacity_in_bytes(LocalEntityRanges)
+    + llvm::capacity_in_bytes(LocalEntityData)
+    + llvm::capacity_in_bytes(LocalEntityObjects)
+    + llvm::capacity_in_bytes(MacroExpansionTargets)
+    + llvm::capacity_in_bytes(MacroExpansionTargetIDs)
     + llvm::capacity_in_bytes(LoadedPreprocessedEntities)
     + llvm::capacity_in_bytes(SkippedRanges);
 }
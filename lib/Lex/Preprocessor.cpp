@@ -37,6 +37,7 @@
 #include "clang/Lex/CodeCompletionHandler.h"
 #include "clang/Lex/ExternalPreprocessorSource.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/LiteralSupport.h"
@@ -163,6 +164,14 @@ Preprocessor::Preprocessor(std::shared_ptr<PreprocessorOptions> PPOpts,
       this->PPOpts->ExcludedConditionalDirectiveSkipMappings;
   if (ExcludedConditionalDirectiveSkipMappings)
     ExcludedConditionalDirectiveSkipMappings->clear();
+
+  if (this->PPOpts->HeaderSearchDirectoryListingCache)
+    HeaderInfo.setDirectoryListingCache(
+        this->PPOpts->HeaderSearchDirectoryListingCache);
+  if (this->PPOpts->SharedIncludeGuards)
+    HeaderInfo.setIncludeGuardCache(this->PPOpts->SharedIncludeGuards);
+  if (HeaderInfo.getHeaderSearchOpts().ModulesHashObservedMacros)
+    HeaderInfo.setCommandLineMacros(this->PPOpts->getMacroDefinitions());
 }
 
 Preprocessor::~Preprocessor() {
@@ -284,6 +293,12 @@ void Preprocessor::PrintStats() {
   llvm::errs() << (NumFastTokenPaste+NumTokenPaste)
              << " token paste (##) operations performed, "
              << NumFastTokenPaste << " on the fast path.\n";
+  llvm::errs() << NumTokenLexersAllocated << "/" << NumMacroArgsAllocated
+               << "/" << NumTokenBuffersAllocated
+               << " token lexers/macro argument lists/token buffers allocated"
+                  " for macro expansion.\n";
+  llvm::errs() << NumBacktracks << " tentative parses backtracked, "
+               << MaxBacktrackDepth << " max nested tentative parses.\n";
 
   llvm::errs() << "\nPreprocessor Memory: " << getTotalMemory() << "B total";
 
@@ -291,6 +306,8 @@ void Preprocessor::PrintStats() {
   llvm::errs() << "\n  Macro Expanded Tokens: "
                << llvm::capacity_in_bytes(MacroExpandedTokens);
   llvm::errs() << "\n  Predefines Buffer: " << Predefines.capacity();
+  llvm::errs() << "\n  Cached Tokens: "
+               << llvm::capacity_in_bytes(CachedTokens);
   // FIXME: List information for all submodules.
   llvm::errs() << "\n  Macros: "
                << llvm::capacity_in_bytes(CurSubmoduleState->Macros);
@@ -326,7 +343,8 @@ size_t Preprocessor::getTotalMemory() const {
     + llvm::capacity_in_bytes(CurSubmoduleState->Macros)
     + llvm::capacity_in_bytes(PragmaPushMacroInfo)
     + llvm::capacity_in_bytes(PoisonReasons)
-    + llvm::capacity_in_bytes(CommentHandlers);
+    + llvm::capacity_in_bytes(CommentHandlers)
+    + llvm::capacity_in_bytes(CachedTokens);
 }
 
 Preprocessor::macro_iterator
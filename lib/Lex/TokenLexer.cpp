@@ -240,7 +240,8 @@ void TokenLexer::stringifyVAOPTContents(
 /// Expand the arguments of a function-like macro so that we can quickly
 /// return preexpanded tokens from Tokens.
 void TokenLexer::ExpandFunctionArguments() {
-  SmallVector<Token, 128> ResultToks;
+  Preprocessor::PooledTokenBuffer ResultToksBuffer(PP);
+  SmallVectorImpl<Token> &ResultToks = *ResultToksBuffer;
 
   // Loop through 'Tokens', expanding them into ResultToks.  Keep
   // track of whether we change anything.  If not, no need to keep them.  If so,
@@ -993,6 +994,7 @@ static void updateConsecutiveMacroArgTokens(SourceManager &SM,
 
   SourceLocation FirstLoc = begin_tokens->getLocation();
   SourceLocation CurLoc = FirstLoc;
+  unsigned CurLength = begin_tokens->getLength();
 
   // Compare the source location offset of tokens and group together tokens that
   // are close, even if their locations point to different FileIDs. e.g.
@@ -1010,24 +1012,27 @@ static void updateConsecutiveMacroArgTokens(SourceManager &SM,
     if (CurLoc.isFileID() != NextLoc.isFileID())
       break; // Token from different kind of FileID.
 
-    int RelOffs;
+    SourceLocation::IntTy RelOffs;
     if (!SM.isInSameSLocAddrSpace(CurLoc, NextLoc, &RelOffs))
       break; // Token from different local/loaded location.
     // Check that token is not before the previous token or more than 50
-    // "characters" away.
-    if (RelOffs < 0 || RelOffs > 50)
+    // "characters" past its end. The distance is measured from the end of the
+    // previous token so that long tokens, e.g. string literals, don't break
+    // the chunk: only the gap between the tokens wastes source locations.
+    if (RelOffs < 0 || RelOffs > SourceLocation::IntTy(CurLength) + 50)
       break;
 
     if (CurLoc.isMacroID() && !SM.isWrittenInSameFile(CurLoc, NextLoc))
       break; // Token from a different macro.
 
     CurLoc = NextLoc;
+    CurLength = NextTok->getLength();
   }
 
   // For the consecutive tokens, find the length of the SLocEntry to contain
   // all of them.
   Token &LastConsecutiveTok = *(NextTok-1);
-  int LastRelOffs = 0;
+  SourceLocation::IntTy LastRelOffs = 0;
   SM.isInSameSLocAddrSpace(FirstLoc, LastConsecutiveTok.getLocation(),
                            &LastRelOffs);
   unsigned FullLength = LastRelOffs + LastConsecutiveTok.getLength();
@@ -1040,7 +1045,7 @@ static void updateConsecutiveMacroArgTokens(SourceManager &SM,
   // expanded location.
   for (; begin_tokens < NextTok; ++begin_tokens) {
     Token &Tok = *begin_tokens;
-    int RelOffs = 0;
+    SourceLocation::IntTy RelOffs = 0;
     SM.isInSameSLocAddrSpace(FirstLoc, Tok.getLocation(), &RelOffs);
     Tok.setLocation(Expansion.getLocWithOffset(RelOffs));
   }
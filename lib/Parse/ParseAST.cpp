@@ -18,6 +18,7 @@
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Parse/Parser.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
+#include "clang/Sema/DeclReferenceCallback.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Sema/SemaConsumer.h"
 #include "clang/Sema/TemplateInstCallback.h"
@@ -111,7 +112,8 @@ void clang::ParseAST(Preprocessor &PP, ASTConsumer *Consumer,
   ParseAST(*S.get(), PrintStats, SkipFunctionBodies);
 }
 
-void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
+void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies,
+                     const std::atomic<bool> *CancellationFlag) {
   // Collect global stats on Decls/Stmts (until we have a module streamer).
   if (PrintStats) {
     Decl::EnableStatistics();
@@ -161,6 +163,8 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
       // skipping something.
       if (ADecl && !Consumer->HandleTopLevelDecl(ADecl.get()))
         return;
+      if (CancellationFlag && CancellationFlag->load(std::memory_order_relaxed))
+        return;
     }
   }
 
@@ -174,8 +178,11 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   // FIXME: This (and init.) should be done in the Sema class, but because
   // Sema does not have a reliable "Finalize" function (it has a
   // destructor, but it is not guaranteed to be called ("-disable-free")).
-  // So, do the initialization above and do the finalization here:
+  // So, do the initialization above and do the finalization here. The
+  // declaration reference callbacks are finalized the same way.
   finalize(S.TemplateInstCallbacks, S);
+  for (auto &Callback : S.DeclReferenceCallbacks)
+    Callback->finalize(S);
 
   std::swap(OldCollectStats, S.CollectStats);
   if (PrintStats) {
@@ -99,7 +99,7 @@ NamedDecl *Parser::ParseCXXInlineMethodDef(
   }
 
   if (SkipFunctionBodies && (!FnD || Actions.canSkipFunctionBody(FnD)) &&
-      trySkippingFunctionBody()) {
+      (tryDeferringFunctionBody(FnD) || trySkippingFunctionBody())) {
     Actions.ActOnSkippedFunctionBody(FnD);
     return FnD;
   }
@@ -2178,6 +2178,20 @@ bool Parser::trySkippingFunctionBody() {
   return true;
 }
 
+bool Parser::tryDeferringFunctionBody(Decl *D) {
+  assert(SkipFunctionBodies &&
+         "Should only be called when SkipFunctionBodies is enabled");
+  // In code-completion mode the body may contain the code-completion point.
+  if (!D || PP.isCodeCompletionEnabled() ||
+      !Actions.shouldDeferFunctionBody(D))
+    return false;
+
+  CachedTokens Toks;
+  LexTemplateFunctionForLateParsing(Toks);
+  Actions.MarkAsDeferredFunctionBody(D->getAsFunction(), D, Toks);
+  return true;
+}
+
 /// ParseCXXTryBlock - Parse a C++ try-block.
 ///
 ///       try-block:
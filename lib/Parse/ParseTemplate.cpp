@@ -1441,7 +1441,8 @@ void Parser::LateTemplateParserCallback(void *P, LateParsedTemplate &LPT) {
   ((Parser *)P)->ParseLateTemplatedFuncDef(LPT);
 }
 
-/// Late parse a C++ function template in Microsoft mode.
+/// Late parse a C++ function template in Microsoft mode, or a function body
+/// that was deferred while skipping function bodies.
 void Parser::ParseLateTemplatedFuncDef(LateParsedTemplate &LPT) {
   if (!LPT.D)
      return;
@@ -1843,29 +1843,44 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   // ambiguities mentioned in 6.8, the resolution is to consider any construct
   // that could possibly be a declaration a declaration.
 
-  RevertingTentativeParsingAction PA(*this);
+  // Within a tentative parse, the same declarator is disambiguated again each
+  // time the enclosing declarator is, so reuse the result.
+  bool IsNested = PP.isBacktrackEnabled();
+  std::pair<unsigned, unsigned> Key(Tok.getLocation().getRawEncoding(),
+                                    TentativelyDeclaredIdentifiers.size());
+  auto Known = IsNested ? FunctionDeclaratorResults.find(Key)
+                        : FunctionDeclaratorResults.end();
+  TPResult TPR;
+  if (Known != FunctionDeclaratorResults.end()) {
+    TPR = Known->second;
+  } else {
+    RevertingTentativeParsingAction PA(*this);
 
-  ConsumeParen();
-  bool InvalidAsDeclaration = false;
-  TPResult TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
-  if (TPR == TPResult::Ambiguous) {
-    if (Tok.isNot(tok::r_paren))
-      TPR = TPResult::False;
-    else {
-      const Token &Next = NextToken();
-      if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const, tok::kw_volatile,
-                       tok::kw_throw, tok::kw_noexcept, tok::l_square,
-                       tok::l_brace, tok::kw_try, tok::equal, tok::arrow) ||
-          isCXX11VirtSpecifier(Next))
-        // The next token cannot appear after a constructor-style initializer,
-        // and can appear next in a function definition. This must be a function
-        // declarator.
-        TPR = TPResult::True;
-      else if (InvalidAsDeclaration)
-        // Use the absence of 'typename' as a tie-breaker.
+    ConsumeParen();
+    bool InvalidAsDeclaration = false;
+    TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
+    if (TPR == TPResult::Ambiguous) {
+      if (Tok.isNot(tok::r_paren))
         TPR = TPResult::False;
+      else {
+        const Token &Next = NextToken();
+        if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const,
+                         tok::kw_volatile, tok::kw_throw, tok::kw_noexcept,
+                         tok::l_square, tok::l_brace, tok::kw_try, tok::equal,
+                         tok::arrow) ||
+            isCXX11VirtSpecifier(Next))
+          // The next token cannot appear after a constructor-style
+          // initializer, and can appear next in a function definition. This
+          // must be a function declarator.
+          TPR = TPResult::True;
+        else if (InvalidAsDeclaration)
+          // Use the absence of 'typename' as a tie-breaker.
+          TPR = TPResult::False;
+      }
     }
   }
+  if (IsNested)
+    FunctionDeclaratorResults[Key] = TPR;
 
   if (IsAmbiguous && TPR == TPResult::Ambiguous)
     *IsAmbiguous = true;
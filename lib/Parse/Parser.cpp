@@ -67,6 +67,10 @@ Parser::Parser(Preprocessor &pp, Sema &actions, bool skipFunctionBodies)
   PP.addCommentHandler(CommentSemaHandler.get());
 
   PP.setCodeCompletionHandler(*this);
+
+  // Skipped function bodies can be parsed when the AST consumer asks for them.
+  if (SkipFunctionBodies)
+    Actions.SetDeferredFunctionBodyParser(LateTemplateParserCallback, this);
 }
 
 DiagnosticBuilder Parser::Diag(SourceLocation Loc, unsigned DiagID) {
@@ -428,12 +432,15 @@ Parser::~Parser() {
 
   PP.clearCodeCompletionHandler();
 
-  if (getLangOpts().DelayedTemplateParsing &&
+  if (SkipFunctionBodies)
+    Actions.SetDeferredFunctionBodyParser(nullptr, nullptr);
+
+  if ((getLangOpts().DelayedTemplateParsing || SkipFunctionBodies) &&
       !PP.isIncrementalProcessingEnabled() && !TemplateIds.empty()) {
-    // If an ASTConsumer parsed delay-parsed templates in their
-    // HandleTranslationUnit() method, TemplateIds created there were not
-    // guarded by a DestroyTemplateIdAnnotationsRAIIObj object in
-    // ParseTopLevelDecl(). Destroy them here.
+    // If an ASTConsumer parsed delay-parsed templates or deferred function
+    // bodies in their HandleTranslationUnit() method, TemplateIds created
+    // there were not guarded by a DestroyTemplateIdAnnotationsRAIIObj object
+    // in ParseTopLevelDecl(). Destroy them here.
     DestroyTemplateIdAnnotationsRAIIObj CleanupRAII(TemplateIds);
   }
 
@@ -1195,7 +1202,7 @@ Decl *Parser::ParseFunctionDefinition(ParsingDeclarator &D,
     D.getMutableDeclSpec().abort();
 
     if (SkipFunctionBodies && (!DP || Actions.canSkipFunctionBody(DP)) &&
-        trySkippingFunctionBody()) {
+        (tryDeferringFunctionBody(DP) || trySkippingFunctionBody())) {
       BodyScope.Exit();
       return Actions.ActOnSkippedFunctionBody(DP);
     }
@@ -1295,7 +1302,7 @@ Decl *Parser::ParseFunctionDefinition(ParsingDeclarator &D,
   }
 
   if (SkipFunctionBodies && (!Res || Actions.canSkipFunctionBody(Res)) &&
-      trySkippingFunctionBody()) {
+      (tryDeferringFunctionBody(Res) || trySkippingFunctionBody())) {
     BodyScope.Exit();
     Actions.ActOnSkippedFunctionBody(Res);
     return Actions.ActOnFinishFunctionBody(Res, nullptr, false);
@@ -437,17 +437,41 @@ input.spoilerhider:checked + label + .spoiler{
   R.InsertTextAfter(EndLoc, "</body></html>\n");
 }
 
+void html::FileHighlights::add(unsigned B, unsigned E, StringRef StartTag,
+                               StringRef EndTag) {
+  // The saved strings are null terminated.
+  Ranges.push_back(
+      {B, E, Tags.save(StartTag).data(), Tags.save(EndTag).data()});
+}
+
+void html::FileHighlights::apply(Rewriter &R, FileID FID) const {
+  bool Invalid = false;
+  const char *BufferStart =
+      R.getSourceMgr().getBufferData(FID, &Invalid).data();
+  if (Invalid)
+    return;
+
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  for (const Range &Highlight : Ranges)
+    HighlightRange(RB, Highlight.B, Highlight.E, BufferStart,
+                   Highlight.StartTag, Highlight.EndTag);
+}
+
+void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
+  FileHighlights Highlights;
+  SyntaxHighlight(Highlights, FID, PP);
+  Highlights.apply(R, FID);
+}
+
 /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
 /// information about keywords, macro expansions etc.  This uses the macro
 /// table state from the end of the file, so it won't be perfectly perfect,
 /// but it will be reasonably close.
-void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
-  RewriteBuffer &RB = R.getEditBuffer(FID);
-
+void html::SyntaxHighlight(FileHighlights &Highlights, FileID FID,
+                           const Preprocessor &PP) {
   const SourceManager &SM = PP.getSourceManager();
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
   Lexer L(FID, FromFile, SM, PP.getLangOpts());
-  const char *BufferStart = L.getBuffer().data();
 
   // Inform the preprocessor that we want to retain comments as tokens, so we
   // can highlight them.
@@ -474,13 +498,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
       // If this is a pp-identifier, for a keyword, highlight it as such.
       if (Tok.isNot(tok::identifier))
-        HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                       "<span class='keyword'>", "</span>");
+        Highlights.add(TokOffs, TokOffs+TokLen, "<span class='keyword'>",
+                       "</span>");
       break;
     }
     case tok::comment:
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='comment'>", "</span>");
+      Highlights.add(TokOffs, TokOffs+TokLen, "<span class='comment'>",
+                     "</span>");
       break;
     case tok::utf8_string_literal:
       // Chop off the u part of u8 prefix
@@ -497,8 +521,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       LLVM_FALLTHROUGH;
     case tok::string_literal:
       // FIXME: Exclude the optional ud-suffix from the highlighted range.
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='string_literal'>", "</span>");
+      Highlights.add(TokOffs, TokOffs+TokLen, "<span class='string_literal'>",
+                     "</span>");
       break;
     case tok::hash: {
       // If this is a preprocessor directive, all tokens to end of line are too.
@@ -515,8 +539,7 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       }
 
       // Find end of line.  This is a hack.
-      HighlightRange(RB, TokOffs, TokEnd, BufferStart,
-                     "<span class='directive'>", "</span>");
+      Highlights.add(TokOffs, TokEnd, "<span class='directive'>", "</span>");
 
       // Don't skip the next token.
       continue;
@@ -532,6 +555,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 /// macro expansions.  This won't be perfectly perfect, but it will be
 /// reasonably close.
 void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
+  FileHighlights Highlights;
+  HighlightMacros(Highlights, FID, PP);
+  Highlights.apply(R, FID);
+}
+
+void html::HighlightMacros(FileHighlights &Highlights, FileID FID,
+                           const Preprocessor &PP) {
   // Re-lex the raw token stream into a token buffer.
   const SourceManager &SM = PP.getSourceManager();
   std::vector<Token> TokenStream;
@@ -658,8 +688,12 @@ void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
     // get highlighted.
     Expansion = "<span class='macro_popup'>" + Expansion + "</span></span>";
 
-    HighlightRange(R, LLoc.getBegin(), LLoc.getEnd(), "<span class='macro'>",
-                   Expansion.c_str(), LLoc.isTokenRange());
+    unsigned BOffset = SM.getFileOffset(SM.getExpansionLoc(LLoc.getBegin()));
+    unsigned EOffset = SM.getFileOffset(SM.getExpansionLoc(LLoc.getEnd()));
+    // Include the whole end token in the range.
+    if (LLoc.isTokenRange())
+      EOffset += Lexer::MeasureTokenLength(LLoc.getEnd(), SM, PP.getLangOpts());
+    Highlights.add(BOffset, EOffset, "<span class='macro'>", Expansion);
   }
 
   // Restore the preprocessor's old state.
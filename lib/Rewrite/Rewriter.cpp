@@ -20,6 +20,7 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/RewriteBuffer.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -31,6 +32,7 @@
 #include <memory>
 #include <system_error>
 #include <utility>
+#include <vector>
 
 using namespace clang;
 
@@ -43,6 +45,20 @@ raw_ostream &RewriteBuffer::write(raw_ostream &os) const {
   return os;
 }
 
+raw_ostream &RewriteBuffer::write(raw_ostream &os, unsigned Begin,
+                                  unsigned End) const {
+  assert(Begin <= End && End <= size() && "Invalid range");
+  unsigned Offset = 0;
+  for (RopePieceBTreeIterator I = begin(), E = end(); I != E && Offset < End;
+       I.MoveToNextPiece()) {
+    StringRef Piece = I.piece();
+    if (Offset + Piece.size() > Begin)
+      os << Piece.slice(Begin > Offset ? Begin - Offset : 0, End - Offset);
+    Offset += Piece.size();
+  }
+  return os;
+}
+
 /// Return true if this character is non-new-line whitespace:
 /// ' ', '\\t', '\\f', '\\v', '\\r'.
 static inline bool isWhitespaceExceptNL(unsigned char c) {
@@ -136,6 +152,40 @@ void RewriteBuffer::ReplaceText(unsigned OrigOffset, unsigned OrigLength,
     AddReplaceDelta(OrigOffset, NewStr.size() - OrigLength);
 }
 
+void RewriteBuffer::ApplyEdits(MutableArrayRef<Edit> Edits) {
+  // The edits at the same offset keep their order.
+  llvm::stable_sort(Edits, [](const Edit &LHS, const Edit &RHS) {
+    return LHS.OrigOffset < RHS.OrigOffset;
+  });
+
+  std::string Text;
+  llvm::raw_string_ostream OS(Text);
+  write(OS);
+  OS.flush();
+
+  // Build the new buffer from the current one; the deltas still map the
+  // original offsets of the edits into it.
+  std::string NewText;
+  unsigned Pos = 0;
+  for (const Edit &E : Edits) {
+    unsigned RealOffset = getMappedOffset(E.OrigOffset, true);
+    assert(RealOffset >= Pos && "Overlapping edits");
+    NewText.append(Text, Pos, RealOffset - Pos);
+    NewText.append(E.NewText.begin(), E.NewText.end());
+    Pos = RealOffset + E.OrigLength;
+  }
+  assert(Pos <= Text.size() && "Invalid location");
+  NewText.append(Text, Pos, std::string::npos);
+  Buffer.assign(NewText.data(), NewText.data() + NewText.size());
+
+  for (const Edit &E : Edits) {
+    if (!E.OrigLength)
+      AddInsertDelta(E.OrigOffset, E.NewText.size());
+    else if (E.OrigLength != E.NewText.size())
+      AddReplaceDelta(E.OrigOffset, E.NewText.size() - E.OrigLength);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Rewriter class
 //===----------------------------------------------------------------------===//
@@ -179,12 +229,21 @@ int Rewriter::getRangeSize(SourceRange Range, RewriteOptions opts) const {
 /// getRewrittenText - Return the rewritten form of the text in the specified
 /// range.  If the start or end of the range was unrewritable or if they are
 /// in different buffers, this returns an empty string.
-///
-/// Note that this method is not particularly efficient.
 std::string Rewriter::getRewrittenText(CharSourceRange Range) const {
+  std::string Text;
+  llvm::raw_string_ostream OS(Text);
+  writeRewrittenText(Range, OS);
+  return OS.str();
+}
+
+/// writeRewrittenText - Write the rewritten form of the text in the specified
+/// range to \p OS.  If the start or end of the range was unrewritable or if
+/// they are in different buffers, this returns true and writes nothing.
+bool Rewriter::writeRewrittenText(CharSourceRange Range,
+                                  raw_ostream &OS) const {
   if (!isRewritable(Range.getBegin()) ||
       !isRewritable(Range.getEnd()))
-    return {};
+    return true;
 
   FileID StartFileID, EndFileID;
   unsigned StartOff, EndOff;
@@ -192,7 +251,7 @@ std::string Rewriter::getRewrittenText(CharSourceRange Range) const {
   EndOff   = getLocationOffsetAndFileID(Range.getEnd(), EndFileID);
 
   if (StartFileID != EndFileID)
-    return {}; // Start and end in different buffers.
+    return true; // Start and end in different buffers.
 
   // If edits have been made to this buffer, the delta between the range may
   // have changed.
@@ -207,7 +266,8 @@ std::string Rewriter::getRewrittenText(CharSourceRange Range) const {
     if (Range.isTokenRange())
       EndOff +=
           Lexer::MeasureTokenLength(Range.getEnd(), *SourceMgr, *LangOpts);
-    return std::string(Ptr, Ptr+EndOff-StartOff);
+    OS << StringRef(Ptr, EndOff-StartOff);
+    return false;
   }
 
   const RewriteBuffer &RB = I->second;
@@ -219,13 +279,8 @@ std::string Rewriter::getRewrittenText(CharSourceRange Range) const {
   if (Range.isTokenRange())
     EndOff += Lexer::MeasureTokenLength(Range.getEnd(), *SourceMgr, *LangOpts);
 
-  // Advance the iterators to the right spot, yay for linear time algorithms.
-  RewriteBuffer::iterator Start = RB.begin();
-  std::advance(Start, StartOff);
-  RewriteBuffer::iterator End = Start;
-  std::advance(End, EndOff-StartOff);
-
-  return std::string(Start, End);
+  RB.write(OS, StartOff, EndOff);
+  return false;
 }
 
 unsigned Rewriter::getLocationOffsetAndFileID(SourceLocation Loc,
@@ -341,6 +396,34 @@ bool Rewriter::ReplaceText(SourceRange range, SourceRange replacementRange) {
   return ReplaceText(start, origLength, MB.substr(newOffs, newLength));
 }
 
+bool Rewriter::ApplyEdits(ArrayRef<Edit> Edits) {
+  bool Failed = false;
+  std::map<FileID, std::vector<RewriteBuffer::Edit>> FileEdits;
+  for (const Edit &E : Edits) {
+    if (!isRewritable(E.Range.getBegin()) || !isRewritable(E.Range.getEnd())) {
+      Failed = true;
+      continue;
+    }
+
+    FileID StartFileID, EndFileID;
+    unsigned StartOff =
+        getLocationOffsetAndFileID(E.Range.getBegin(), StartFileID);
+    unsigned EndOff = getLocationOffsetAndFileID(E.Range.getEnd(), EndFileID);
+    if (StartFileID != EndFileID) {
+      Failed = true;
+      continue;
+    }
+    if (E.Range.isTokenRange())
+      EndOff +=
+          Lexer::MeasureTokenLength(E.Range.getEnd(), *SourceMgr, *LangOpts);
+    FileEdits[StartFileID].push_back({StartOff, EndOff - StartOff, E.NewText});
+  }
+
+  for (auto &I : FileEdits)
+    getEditBuffer(I.first).ApplyEdits(I.second);
+  return Failed;
+}
+
 bool Rewriter::IncreaseIndentation(CharSourceRange range,
                                    SourceLocation parentIndent) {
   if (range.isInvalid()) return true;
@@ -23,6 +23,7 @@
 #include "clang/Sema/Sema.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Casting.h"
@@ -34,6 +35,7 @@
 #include <cassert>
 #include <cstdint>
 #include <string>
+#include <tuple>
 
 using namespace clang;
 
@@ -516,6 +518,93 @@ CodeCompleteConsumer::OverloadCandidate::getFunctionType() const {
 
 CodeCompleteConsumer::~CodeCompleteConsumer() = default;
 
+namespace {
+/// How the typed text of a result matches the result filter.
+enum class FilterMatch { None, Fuzzy, Prefix };
+} // namespace
+
+/// Matches \p Filter against \p Name, ignoring case. A fuzzy match starts
+/// with the first character of the name, and then finds the other characters
+/// of the filter in order.
+static FilterMatch matchResultFilter(StringRef Filter, StringRef Name) {
+  if (Name.startswith_lower(Filter))
+    return FilterMatch::Prefix;
+  if (Name.empty() || llvm::toLower(Filter[0]) != llvm::toLower(Name[0]))
+    return FilterMatch::None;
+  size_t Pos = 1;
+  for (char C : Filter.drop_front()) {
+    Pos = Name.find_lower(C, Pos);
+    if (Pos == StringRef::npos)
+      return FilterMatch::None;
+    ++Pos;
+  }
+  return FilterMatch::Fuzzy;
+}
+
+/// Retrieves the text typed for \p Result without creating its
+/// code-completion string.
+static StringRef getTypedName(const CodeCompletionResult &Result,
+                              std::string &Storage) {
+  switch (Result.Kind) {
+  case CodeCompletionResult::RK_Declaration: {
+    DeclarationName Name = Result.Declaration->getDeclName();
+    if (const IdentifierInfo *II = Name.getAsIdentifierInfo())
+      return II->getName();
+    if (Name.isObjCZeroArgSelector() || Name.isObjCOneArgSelector() ||
+        Name.isObjCMultiArgSelector())
+      return Name.getObjCSelector().getNameForSlot(0);
+    Storage = Name.getAsString();
+    return Storage;
+  }
+  case CodeCompletionResult::RK_Keyword:
+    return Result.Keyword;
+  case CodeCompletionResult::RK_Macro:
+    return Result.Macro->getName();
+  case CodeCompletionResult::RK_Pattern:
+    if (const char *TypedText = Result.Pattern->getTypedText())
+      return TypedText;
+    return StringRef();
+  }
+  llvm_unreachable("Unknown code completion result Kind.");
+}
+
+unsigned CodeCompleteConsumer::filterResults(CodeCompletionResult *Results,
+                                             unsigned NumResults) const {
+  StringRef Filter = getResultFilter();
+  unsigned Limit = getResultLimit();
+  if (Filter.empty() && (!Limit || NumResults <= Limit))
+    return NumResults;
+
+  // The rank of each matching result: whether it does not start with the
+  // filter, its priority, and its index.
+  using Rank = std::tuple<bool, unsigned, unsigned>;
+  SmallVector<Rank, 64> Ranks;
+  std::string Storage;
+  for (unsigned I = 0; I != NumResults; ++I) {
+    FilterMatch Match =
+        matchResultFilter(Filter, getTypedName(Results[I], Storage));
+    if (Match != FilterMatch::None)
+      Ranks.emplace_back(Match != FilterMatch::Prefix, Results[I].Priority, I);
+  }
+
+  if (Limit && Ranks.size() > Limit) {
+    std::nth_element(Ranks.begin(), Ranks.begin() + Limit, Ranks.end());
+    Ranks.resize(Limit);
+    llvm::sort(Ranks, [](const Rank &LHS, const Rank &RHS) {
+      return std::get<2>(LHS) < std::get<2>(RHS);
+    });
+  }
+
+  unsigned NumKept = 0;
+  for (const Rank &R : Ranks) {
+    unsigned I = std::get<2>(R);
+    if (I != NumKept)
+      Results[NumKept] = std::move(Results[I]);
+    ++NumKept;
+  }
+  return NumKept;
+}
+
 bool PrintingCodeCompleteConsumer::isResultFilteredOut(
     StringRef Filter, CodeCompletionResult Result) {
   switch (Result.Kind) {
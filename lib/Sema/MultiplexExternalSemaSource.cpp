@@ -143,6 +143,11 @@ void MultiplexExternalSemaSource::ReadComments() {
     Sources[i]->ReadComments();
 }
 
+void MultiplexExternalSemaSource::ReadCommentsInFile(FileID File) {
+  for(size_t i = 0; i < Sources.size(); ++i)
+    Sources[i]->ReadCommentsInFile(File);
+}
+
 void MultiplexExternalSemaSource::StartedDeserializing() {
   for(size_t i = 0; i < Sources.size(); ++i)
     Sources[i]->StartedDeserializing();
@@ -190,6 +195,14 @@ bool MultiplexExternalSemaSource::layoutRecordType(const RecordDecl *Record,
   return false;
 }
 
+const ASTRecordLayout *
+MultiplexExternalSemaSource::getRecordLayout(const RecordDecl *Record) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    if (const ASTRecordLayout *Layout = Sources[i]->getRecordLayout(Record))
+      return Layout;
+  return nullptr;
+}
+
 void MultiplexExternalSemaSource::
 getMemoryBufferSizes(MemoryBufferSizes &sizes) const {
   for(size_t i = 0; i < Sources.size(); ++i)
@@ -279,6 +292,12 @@ void MultiplexExternalSemaSource::ReadUnusedLocalTypedefNameCandidates(
     Sources[i]->ReadUnusedLocalTypedefNameCandidates(Decls);
 }
 
+void MultiplexExternalSemaSource::ReadConceptSatisfactions(
+    SmallVectorImpl<ExternalConceptSatisfaction> &Satisfactions) {
+  for(size_t i = 0; i < Sources.size(); ++i)
+    Sources[i]->ReadConceptSatisfactions(Satisfactions);
+}
+
 void MultiplexExternalSemaSource::ReadReferencedSelectors(
                   SmallVectorImpl<std::pair<Selector, SourceLocation> > &Sels) {
   for(size_t i = 0; i < Sources.size(); ++i)
@@ -311,6 +330,14 @@ void MultiplexExternalSemaSource::ReadLateParsedTemplates(
     Sources[i]->ReadLateParsedTemplates(LPTMap);
 }
 
+void MultiplexExternalSemaSource::ReadLateParsedTemplate(
+    const FunctionDecl *FD,
+    llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+        &LPTMap) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    Sources[i]->ReadLateParsedTemplate(FD, LPTMap);
+}
+
 TypoCorrection MultiplexExternalSemaSource::CorrectTypo(
                                      const DeclarationNameInfo &Typo,
                                      int LookupKind, Scope *S, CXXScopeSpec *SS,
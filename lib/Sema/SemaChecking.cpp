@@ -10966,6 +10966,21 @@ static void DiagnoseImpCast(Sema &S, Expr *E, QualType T,
   DiagnoseImpCast(S, E, E->getType(), T, CContext, diag, pruneControlFlow);
 }
 
+/// Determine whether all the diagnostics of the conversions between integer
+/// types at \p Loc are ignored.
+static bool areIntegerConversionWarningsIgnored(Sema &S, SourceLocation Loc) {
+  static const unsigned DiagIDs[] = {
+      diag::warn_impcast_integer_precision_constant,
+      diag::warn_impcast_integer_64_32,
+      diag::warn_impcast_integer_precision,
+      diag::warn_impcast_high_order_zero_bits,
+      diag::warn_impcast_nonnegative_result,
+      diag::warn_impcast_integer_sign,
+      diag::warn_impcast_different_enum_types};
+  return llvm::all_of(
+      DiagIDs, [&](unsigned DiagID) { return S.Diags.isIgnored(DiagID, Loc); });
+}
+
 static bool isObjCSignedCharBool(Sema &S, QualType Ty) {
   return Ty->isSpecificBuiltinType(BuiltinType::SChar) &&
       S.getLangOpts().ObjC && S.NSAPIObj->isObjCBOOLType(Ty);
@@ -11744,6 +11759,12 @@ static void CheckImplicitConversion(Sema &S, Expr *E, QualType T,
             << E->getType());
   }
 
+  // Computing the range of the source is the expensive part, skip it when
+  // none of the remaining diagnostics could be emitted, e.g. in system
+  // headers.
+  if (!ICContext && areIntegerConversionWarningsIgnored(S, E->getExprLoc()))
+    return;
+
   IntRange SourceRange = GetExprRange(S.Context, E, S.isConstantEvaluated());
   IntRange TargetRange = IntRange::forTargetOfCanonicalType(S.Context, Target);
 
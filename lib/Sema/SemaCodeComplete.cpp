@@ -3877,8 +3877,12 @@ static void HandleCodeCompleteResults(Sema *S,
                                       CodeCompletionContext Context,
                                       CodeCompletionResult *Results,
                                       unsigned NumResults) {
-  if (CodeCompleter)
-    CodeCompleter->ProcessCodeCompleteResults(*S, Context, Results, NumResults);
+  if (!CodeCompleter)
+    return;
+  // Drop the results the consumer does not want before it creates their
+  // code-completion strings.
+  NumResults = CodeCompleter->filterResults(Results, NumResults);
+  CodeCompleter->ProcessCodeCompleteResults(*S, Context, Results, NumResults);
 }
 
 static CodeCompletionContext
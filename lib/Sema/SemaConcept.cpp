@@ -122,4 +122,98 @@ Sema::CalculateConstraintSatisfaction(ConceptDecl *NamedConcept,
   IsSatisfied = EvalResult.Val.getInt().getBoolValue();
 
   return false;
-}
\ No newline at end of file
+}
+static void profileConceptSatisfaction(llvm::FoldingSetNodeID &ID,
+                                       const ASTContext &Context,
+                                       ConceptDecl *NamedConcept,
+                                       ArrayRef<TemplateArgument> CanonicalArgs) {
+  ID.AddPointer(NamedConcept->getCanonicalDecl());
+  ID.AddInteger(CanonicalArgs.size());
+  for (const TemplateArgument &Arg : CanonicalArgs)
+    Arg.Profile(ID, Context);
+}
+
+Sema::ConceptSatisfactionEntry *
+Sema::addConceptSatisfaction(const llvm::FoldingSetNodeID &ID,
+                             ConceptDecl *NamedConcept,
+                             ArrayRef<TemplateArgument> CanonicalArgs,
+                             bool IsSatisfied, bool FromASTFile) {
+  TemplateArgument *Args =
+      BumpAlloc.Allocate<TemplateArgument>(CanonicalArgs.size());
+  std::uninitialized_copy(CanonicalArgs.begin(), CanonicalArgs.end(), Args);
+  auto *Entry = new (BumpAlloc.Allocate<ConceptSatisfactionEntry>())
+      ConceptSatisfactionEntry(ID, NamedConcept,
+                               llvm::makeArrayRef(Args, CanonicalArgs.size()),
+                               IsSatisfied, FromASTFile);
+  ConceptSatisfactionCache.InsertNode(Entry);
+  ConceptSatisfactions.push_back(Entry);
+  return Entry;
+}
+
+/// Add the concept satisfaction results of the external source that weren't
+/// read yet to the cache.
+///
+/// \returns true if any results were added.
+bool Sema::loadExternalConceptSatisfactions() {
+  SmallVector<ExternalConceptSatisfaction, 16> Satisfactions;
+  ExternalSource->ReadConceptSatisfactions(Satisfactions);
+  bool Added = false;
+  for (const ExternalConceptSatisfaction &Satisfaction : Satisfactions) {
+    if (!Satisfaction.Concept)
+      continue;
+    llvm::FoldingSetNodeID ID;
+    profileConceptSatisfaction(ID, Context, Satisfaction.Concept,
+                               Satisfaction.TemplateArgs);
+    void *InsertPos;
+    if (ConceptSatisfactionCache.FindNodeOrInsertPos(ID, InsertPos))
+      continue;
+    addConceptSatisfaction(ID, Satisfaction.Concept, Satisfaction.TemplateArgs,
+                           Satisfaction.IsSatisfied, /*FromASTFile=*/true);
+    Added = true;
+  }
+  return Added;
+}
+
+bool Sema::CheckConceptSatisfaction(ConceptDecl *NamedConcept,
+                                    ArrayRef<TemplateArgument> TemplateArgs,
+                                    SourceLocation ConceptNameLoc,
+                                    SourceRange InstantiationRange,
+                                    bool &IsSatisfied) {
+  // C++2a [temp.constr.atomic]p3
+  //   If, at different points in the program, the satisfaction result is
+  //   different for identical atomic constraints and template arguments, the
+  //   program is ill-formed, no diagnostic required.
+  // So the result of a check can be reused for the same arguments.
+  SmallVector<TemplateArgument, 4> CanonicalArgs;
+  CanonicalArgs.reserve(TemplateArgs.size());
+  for (const TemplateArgument &Arg : TemplateArgs)
+    CanonicalArgs.push_back(Context.getCanonicalTemplateArgument(Arg));
+
+  llvm::FoldingSetNodeID ID;
+  profileConceptSatisfaction(ID, Context, NamedConcept, CanonicalArgs);
+  void *InsertPos;
+  ConceptSatisfactionEntry *Entry =
+      ConceptSatisfactionCache.FindNodeOrInsertPos(ID, InsertPos);
+  if (!Entry && ExternalSource && loadExternalConceptSatisfactions())
+    Entry = ConceptSatisfactionCache.FindNodeOrInsertPos(ID, InsertPos);
+  if (Entry) {
+    IsSatisfied = Entry->isSatisfied();
+    return false;
+  }
+
+  InstantiatingTemplate Inst(*this, ConceptNameLoc,
+                             InstantiatingTemplate::ConstraintsCheck{},
+                             NamedConcept, TemplateArgs, InstantiationRange);
+  MultiLevelTemplateArgumentList MLTAL;
+  MLTAL.addOuterTemplateArguments(TemplateArgs);
+  if (CalculateConstraintSatisfaction(NamedConcept, MLTAL,
+                                      NamedConcept->getConstraintExpr(),
+                                      IsSatisfied))
+    return true;
+
+  // Checking the constraints may have checked other concepts, so InsertPos
+  // can't be used here.
+  addConceptSatisfaction(ID, NamedConcept, CanonicalArgs, IsSatisfied,
+                         /*FromASTFile=*/false);
+  return false;
+}
@@ -1881,6 +1881,10 @@ static void CheckPoppedLabel(LabelDecl *L, Sema &S) {
 void Sema::ActOnPopScope(SourceLocation Loc, Scope *S) {
   S->mergeNRVOIntoParent();
 
+  // The scope may be reused without its using directives.
+  if (!llvm::empty(S->using_directives()))
+    ++UsingDirectiveGeneration;
+
   if (S->decl_empty()) return;
   assert((S->getFlags() & (Scope::DeclScope | Scope::TemplateParamScope)) &&
          "Scope shouldn't contain decls!");
@@ -13718,6 +13722,46 @@ bool Sema::canSkipFunctionBody(Decl *D) {
   return Consumer.shouldSkipFunctionBody(D);
 }
 
+bool Sema::shouldDeferFunctionBody(Decl *D) {
+  return D->getAsFunction() && Consumer.shouldDeferFunctionBody(D);
+}
+
+void Sema::MarkAsDeferredFunctionBody(FunctionDecl *FD, Decl *FnD,
+                                      CachedTokens &Toks) {
+  if (!FD)
+    return;
+
+  auto LPT = std::make_unique<LateParsedTemplate>();
+
+  // Take tokens to avoid allocations
+  LPT->Toks.swap(Toks);
+  LPT->D = FnD;
+  DeferredFunctionBodies[FD] = std::move(LPT);
+}
+
+bool Sema::ParseDeferredFunctionBody(FunctionDecl *FD) {
+  if (!DeferredFunctionBodyParser)
+    return false;
+
+  for (FunctionDecl *Redecl : FD->redecls()) {
+    auto It = DeferredFunctionBodies.find(Redecl);
+    if (It == DeferredFunctionBodies.end())
+      continue;
+
+    // Remove the body before parsing it, in case parsing it asks for it
+    // again.
+    std::unique_ptr<LateParsedTemplate> LPT = std::move(It->second);
+    DeferredFunctionBodies.erase(It);
+
+    // The redefinition checks were performed when the body was skipped.
+    Redecl->setHasSkippedBody(false);
+    Redecl->setWillHaveBody();
+    DeferredFunctionBodyParser(OpaqueDeferredFunctionBodyParser, *LPT);
+    return true;
+  }
+  return false;
+}
+
 Decl *Sema::ActOnSkippedFunctionBody(Decl *Decl) {
   if (!Decl)
     return nullptr;
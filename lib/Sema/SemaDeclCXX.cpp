@@ -9236,6 +9236,7 @@ Decl *Sema::ActOnStartNamespaceDef(
                                       /* Ancestor */ Parent);
       UD->setImplicit();
       Parent->addDecl(UD);
+      ++UsingDirectiveGeneration;
     }
   }
 
@@ -9716,6 +9717,8 @@ Decl *Sema::ActOnUsingDirective(Scope *S, SourceLocation UsingLoc,
 }
 
 void Sema::PushUsingDirective(Scope *S, UsingDirectiveDecl *UDir) {
+  ++UsingDirectiveGeneration;
+
   // If the scope has an associated entity and the using directive is at
   // namespace or translation unit scope, add the UsingDirectiveDecl into
   // its lookup structure so qualified name lookup can find it.
@@ -32,6 +32,7 @@
 #include "clang/Lex/LiteralSupport.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/AnalysisBasedWarnings.h"
+#include "clang/Sema/DeclReferenceCallback.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/DelayedDiagnostic.h"
 #include "clang/Sema/Designator.h"
@@ -214,6 +215,7 @@ bool Sema::DiagnoseUseOfDecl(NamedDecl *D, ArrayRef<SourceLocation> Locs,
                              bool AvoidPartialAvailabilityChecks,
                              ObjCInterfaceDecl *ClassReceiver) {
   SourceLocation Loc = Locs.front();
+  NotifyDeclReferenced(Loc, D);
   if (getLangOpts().CPlusPlus && isa<FunctionDecl>(D)) {
     // If there were any diagnostics suppressed by template argument deduction,
     // emit them now.
@@ -15397,6 +15399,7 @@ void Sema::MarkFunctionReferenced(SourceLocation Loc, FunctionDecl *Func,
   assert(Func && "No function?");
 
   Func->setReferenced();
+  NotifyDeclReferenced(Loc, Func);
 
   // Recursive functions aren't really used until they're used from some other
   // context.
@@ -16858,6 +16861,7 @@ static void DoMarkVarDeclReferenced(Sema &SemaRef, SourceLocation Loc,
 /// (C++ [basic.def.odr]p2, C99 6.9p3).  Note that this should not be
 /// used directly for normal expressions referring to VarDecl.
 void Sema::MarkVariableReferenced(SourceLocation Loc, VarDecl *Var) {
+  NotifyDeclReferenced(Loc, Var);
   DoMarkVarDeclReferenced(*this, Loc, Var, nullptr);
 }
 
@@ -16950,6 +16954,12 @@ void Sema::MarkAnyDeclReferenced(SourceLocation Loc, Decl *D,
     return;
   }
   D->setReferenced();
+  NotifyDeclReferenced(Loc, D);
+}
+
+void Sema::NotifyDeclReferenced(SourceLocation Loc, const Decl *D) {
+  for (auto &Callback : DeclReferenceCallbacks)
+    Callback->referenced(*this, Loc, D);
 }
 
 namespace {
@@ -140,6 +140,52 @@ static StringInitFailureKind IsStringInit(Expr *init, QualType declType,
   return IsStringInit(init, arrayType, Context);
 }
 
+/// Check whether \p Init, which initializes the array element \p Entity, is
+/// an integer literal, possibly negated, whose value the integer type of the
+/// element represents. The initialization then is at most an integral
+/// conversion, which convertIntegerLiteralInit() builds without an
+/// initialization sequence, so that tables of them are checked quickly.
+static bool isIntegerLiteralInit(ASTContext &Context,
+                                 const InitializedEntity &Entity, Expr *Init) {
+  if (Entity.getKind() != InitializedEntity::EK_ArrayElement)
+    return false;
+  QualType ElemType = Entity.getType();
+  const auto *BT = ElemType->getAs<BuiltinType>();
+  if (!BT || !BT->isInteger() || BT->getKind() == BuiltinType::Bool)
+    return false;
+
+  bool Negated = false;
+  if (auto *UO = dyn_cast<UnaryOperator>(Init)) {
+    if (UO->getOpcode() != UO_Minus)
+      return false;
+    Init = UO->getSubExpr();
+    Negated = true;
+  }
+  auto *Literal = dyn_cast<IntegerLiteral>(Init);
+  if (!Literal)
+    return false;
+
+  llvm::APSInt Value(Literal->getValue(),
+                     Literal->getType()->isUnsignedIntegerType());
+  if (Negated)
+    Value = -Value;
+  llvm::APSInt Converted = Value.extOrTrunc(Context.getIntWidth(ElemType));
+  Converted.setIsSigned(ElemType->isSignedIntegerType());
+  return llvm::APSInt::isSameValue(Converted, Value);
+}
+
+/// Convert the integer literal \p Init, for which isIntegerLiteralInit()
+/// holds, to the type of the array element \p Entity.
+static Expr *convertIntegerLiteralInit(ASTContext &Context,
+                                       const InitializedEntity &Entity,
+                                       Expr *Init) {
+  QualType ElemType = Entity.getType().getUnqualifiedType();
+  if (Context.hasSameType(Init->getType(), ElemType))
+    return Init;
+  return ImplicitCastExpr::Create(Context, ElemType, CK_IntegralCast, Init,
+                                  /*BasePath=*/nullptr, VK_RValue);
+}
+
 /// Update the type of a string literal, including any surrounding parentheses,
 /// to match the type of the object which it is initializing.
 static void updateStringLiteralType(Expr *E, QualType Ty) {
@@ -1335,6 +1381,17 @@ void InitListChecker::CheckSubElementType(const InitializedEntity &Entity,
     UpdateStructuredListElement(StructuredList, StructuredIndex, expr);
     ++Index;
     return;
+  } else if (SemaRef.getLangOpts().CPlusPlus &&
+             isIntegerLiteralInit(SemaRef.Context, Entity, expr)) {
+    if (!VerifyOnly)
+      UpdateStructuredListElement(
+          StructuredList, StructuredIndex,
+          convertIntegerLiteralInit(SemaRef.Context, Entity, expr));
+    else if (StructuredList)
+      UpdateStructuredListElement(StructuredList, StructuredIndex,
+                                  getDummyInit());
+    ++Index;
+    return;
   }
 
   if (SemaRef.getLangOpts().CPlusPlus || isa<InitListExpr>(expr)) {
@@ -1542,7 +1599,11 @@ void InitListChecker::CheckScalarType(const InitializedEntity &Entity,
   }
 
   ExprResult Result;
-  if (VerifyOnly) {
+  if (isIntegerLiteralInit(SemaRef.Context, Entity, expr)) {
+    Result = VerifyOnly ? getDummyInit()
+                        : convertIntegerLiteralInit(SemaRef.Context, Entity,
+                                                    expr);
+  } else if (VerifyOnly) {
     if (SemaRef.CanPerformCopyInitialization(Entity, expr))
       Result = getDummyInit();
     else
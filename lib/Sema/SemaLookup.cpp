@@ -21,6 +21,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/Basic/Builtins.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Lex/HeaderSearch.h"
@@ -40,6 +41,7 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/edit_distance.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include <algorithm>
 #include <iterator>
 #include <list>
@@ -190,6 +192,45 @@ namespace {
 
     void done() { llvm::sort(list, UnqualUsingEntry::Comparator()); }
 
+    /// Reuse the using directives of the previous lookup, if it collected
+    /// them from the same scopes, with the same entities, after visiting the
+    /// contexts enclosing \p OuterCtx, and no directive was added since.
+    ///
+    /// \returns true if the directives were reused, in which case they are
+    /// already sorted.
+    bool loadCached(Scope *Initial, DeclContext *OuterCtx) {
+      Sema::UnqualUsingDirectiveCache &Cache = SemaRef.UnqualUsingDirectives;
+      if (!isCacheCurrent(Cache, Initial, OuterCtx)) {
+        ++Cache.NumMisses;
+        return false;
+      }
+      ++Cache.NumHits;
+      for (const auto &D : Cache.Directives)
+        list.push_back(UnqualUsingEntry(D.first, D.second));
+      return true;
+    }
+
+    /// Cache the using directives collected for a lookup from \p Initial,
+    /// once they are sorted.
+    void storeCached(Scope *Initial, DeclContext *OuterCtx) {
+      // Under local visibility, a declaration is visible or not depending
+      // on the module being built.
+      if (SemaRef.getLangOpts().ModulesLocalVisibility)
+        return;
+      Sema::UnqualUsingDirectiveCache &Cache = SemaRef.UnqualUsingDirectives;
+      Cache.Scopes.clear();
+      for (Scope *S = Initial; S; S = S->getParent())
+        Cache.Scopes.push_back({S, S->getEntity()});
+      Cache.OuterContext = OuterCtx;
+      getGenerations(Cache.UsingDirectiveGeneration,
+                     Cache.VisibleModulesGeneration, Cache.ExternalGeneration);
+      Cache.Directives.clear();
+      for (const UnqualUsingEntry &E : list)
+        Cache.Directives.push_back(
+            {E.getNominatedNamespace(), E.getCommonAncestor()});
+      Cache.Valid = true;
+    }
+
     typedef ListTy::const_iterator const_iterator;
 
     const_iterator begin() const { return list.begin(); }
@@ -201,6 +242,35 @@ namespace {
                                                DC->getPrimaryContext(),
                                                UnqualUsingEntry::Comparator()));
     }
+
+  private:
+    void getGenerations(unsigned &UsingDirectives, unsigned &VisibleModules,
+                        uint32_t &External) const {
+      UsingDirectives = SemaRef.UsingDirectiveGeneration;
+      VisibleModules = SemaRef.getVisibleModulesGeneration();
+      ExternalASTSource *Source = SemaRef.Context.getExternalSource();
+      External = Source ? Source->getGeneration() : 0;
+    }
+
+    bool isCacheCurrent(const Sema::UnqualUsingDirectiveCache &Cache,
+                        Scope *Initial, DeclContext *OuterCtx) const {
+      if (!Cache.Valid || Cache.OuterContext != OuterCtx)
+        return false;
+      unsigned UsingDirectives, VisibleModules;
+      uint32_t External;
+      getGenerations(UsingDirectives, VisibleModules, External);
+      if (Cache.UsingDirectiveGeneration != UsingDirectives ||
+          Cache.VisibleModulesGeneration != VisibleModules ||
+          Cache.ExternalGeneration != External)
+        return false;
+      Scope *S = Initial;
+      for (const auto &CachedScope : Cache.Scopes) {
+        if (S != CachedScope.first || S->getEntity() != CachedScope.second)
+          return false;
+        S = S->getParent();
+      }
+      return !S;
+    }
   };
 } // end anonymous namespace
 
@@ -1362,7 +1432,7 @@ bool Sema::CppLookupName(LookupResult &R, Scope *S) {
         // lookup considering using directives.
         if (Ctx->isFileContext()) {
           // If we haven't handled using directives yet, do so now.
-          if (!VisitedUsingDirectives) {
+          if (!VisitedUsingDirectives && !UDirs.loadCached(Initial, Ctx)) {
             // Add using directives from this context up to the top level.
             for (DeclContext *UCtx = Ctx; UCtx; UCtx = UCtx->getParent()) {
               if (UCtx->isTransparentContext())
@@ -1380,9 +1450,9 @@ bool Sema::CppLookupName(LookupResult &R, Scope *S) {
             UDirs.visitScopeChain(Initial, InnermostFileScope);
 
             UDirs.done();
-
-            VisitedUsingDirectives = true;
+            UDirs.storeCached(Initial, Ctx);
           }
+          VisitedUsingDirectives = true;
 
           if (CppNamespaceLookup(*this, R, Context, Ctx, UDirs)) {
             R.resolveKind();
@@ -1413,13 +1483,12 @@ bool Sema::CppLookupName(LookupResult &R, Scope *S) {
     return false;
 
   // Collect UsingDirectiveDecls in all scopes, and recursively all
-  // nominated namespaces by those using-directives.
-  //
-  // FIXME: Cache this sorted list in Scope structure, and DeclContext, so we
-  // don't build it for each lookup!
-  if (!VisitedUsingDirectives) {
+  // nominated namespaces by those using-directives. The consecutive lookups
+  // from the same scopes, e.g. of the names of an expression, reuse them.
+  if (!VisitedUsingDirectives && !UDirs.loadCached(Initial, nullptr)) {
     UDirs.visitScopeChain(Initial, S);
     UDirs.done();
+    UDirs.storeCached(Initial, nullptr);
   }
 
   // If we're not performing redeclaration lookup, do not look for local
@@ -4210,6 +4279,55 @@ void TypoCorrectionConsumer::FoundName(StringRef Name) {
   addName(Name, nullptr);
 }
 
+/// \returns the set of the characters of \p Name, as a bit per character
+/// class. An edit changes at most two bits, so half the number of bits which
+/// differ between two names is a lower bound of their edit distance.
+static uint64_t getCharacterSet(StringRef Name) {
+  uint64_t Set = 0;
+  for (char C : Name) {
+    unsigned Bit = 63;
+    if (isLowercase(C))
+      Bit = C - 'a';
+    else if (isUppercase(C))
+      Bit = 26 + (C - 'A');
+    else if (isDigit(C))
+      Bit = 52 + (C - '0');
+    else if (C == '_')
+      Bit = 62;
+    Set |= uint64_t(1) << Bit;
+  }
+  return Set;
+}
+
+ExternalIdentifierIndex::ExternalIdentifierIndex(IdentifierInfoLookup &External,
+                                                 uint32_t Generation)
+    : Generation(Generation) {
+  std::unique_ptr<IdentifierIterator> Iter(External.getIdentifiers());
+  for (StringRef Spelling = Iter->Next(); !Spelling.empty();
+       Spelling = Iter->Next()) {
+    if (NamesByLength.size() <= Spelling.size())
+      NamesByLength.resize(Spelling.size() + 1);
+    NamesByLength[Spelling.size()].push_back(
+        {Spelling.copy(Alloc), getCharacterSet(Spelling)});
+  }
+}
+
+void ExternalIdentifierIndex::forEachCandidate(
+    StringRef Typo, llvm::function_ref<void(StringRef)> Callback) const {
+  // Mirrors the bounds of TypoCorrectionConsumer::addName().
+  size_t MaxLengthDifference = Typo.size() / 3;
+  unsigned UpperBound = (Typo.size() + 2) / 3;
+  uint64_t TypoCharacters = getCharacterSet(Typo);
+  size_t EndLength = std::min(Typo.size() + MaxLengthDifference + 1,
+                              NamesByLength.size());
+  for (size_t Length = Typo.size() - MaxLengthDifference; Length < EndLength;
+       ++Length)
+    for (const Name &N : NamesByLength[Length])
+      if (llvm::countPopulation(TypoCharacters ^ N.Characters) <=
+          2 * UpperBound)
+        Callback(N.Spelling);
+}
+
 void TypoCorrectionConsumer::addKeywordResult(StringRef Keyword) {
   // Compute the edit distance between the typo and this keyword,
   // and add the keyword to the list of results.
@@ -4228,6 +4346,7 @@ void TypoCorrectionConsumer::addName(StringRef Name, NamedDecl *ND,
   // Compute an upper bound on the allowable edit distance, so that the
   // edit-distance algorithm can short-circuit.
   unsigned UpperBound = (TypoStr.size() + 2) / 3;
+  ++SemaRef.TypoCorrectionWork;
   unsigned ED = TypoStr.edit_distance(Name, true, UpperBound);
   if (ED > UpperBound) return;
 
@@ -4425,6 +4544,7 @@ void TypoCorrectionConsumer::performQualifiedLookups() {
 
       Result.clear();
       Result.setLookupName(QR.getCorrectionAsIdentifierInfo());
+      ++SemaRef.TypoCorrectionWork;
       if (!SemaRef.LookupQualifiedName(Result, Ctx))
         continue;
 
@@ -4847,6 +4967,12 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
   unsigned Limit = getDiagnostics().getDiagnosticOptions().SpellCheckingLimit;
   if (Limit && TyposCorrected >= Limit)
     return nullptr;
+  // Also stop once the corrections compared or looked up too many names, as
+  // with large modules a single correction may do a lot of work.
+  unsigned WorkLimit =
+      getDiagnostics().getDiagnosticOptions().SpellCheckingWorkLimit;
+  if (WorkLimit && TypoCorrectionWork >= WorkLimit)
+    return nullptr;
   ++TyposCorrected;
 
   // If we're handling a missing symbol error, using modules, and the
@@ -4896,23 +5022,35 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
 
   if (IsUnqualifiedLookup || SearchNamespaces) {
     // For unqualified lookup, look through all of the names that we have
-    // seen in this translation unit.
+    // seen in this translation unit, and the builtins.
     // FIXME: Re-add the ability to skip very unlikely potential corrections.
+    Context.BuiltinInfo.materializeBuiltins(Context.Idents);
     for (const auto &I : Context.Idents)
       Consumer->FoundName(I.getKey());
 
-    // Walk through identifiers in external identifier sources.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
+    // Walk through identifiers in external identifier sources. Their names
+    // are indexed by length once per generation of the external AST source,
+    // since walking the identifier tables of every AST file is slow.
     if (IdentifierInfoLookup *External
                             = Context.Idents.getExternalIdentifierLookup()) {
-      std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
-      do {
-        StringRef Name = Iter->Next();
-        if (Name.empty())
-          break;
+      if (ExternalASTSource *Source = Context.getExternalSource()) {
+        if (!TypoCorrectionIndex ||
+            TypoCorrectionIndex->getGeneration() != Source->getGeneration())
+          TypoCorrectionIndex = std::make_unique<ExternalIdentifierIndex>(
+              *External, Source->getGeneration());
+        TypoCorrectionIndex->forEachCandidate(
+            Typo->getName(),
+            [&](StringRef Name) { Consumer->FoundName(Name); });
+      } else {
+        std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
+        do {
+          StringRef Name = Iter->Next();
+          if (Name.empty())
+            break;
 
-        Consumer->FoundName(Name);
-      } while (true);
+          Consumer->FoundName(Name);
+        } while (true);
+      }
     }
   }
 
@@ -5114,6 +5114,58 @@ TryListConversion(Sema &S, InitListExpr *From, QualType ToType,
   return Result;
 }
 
+/// Determine whether the conversions to or from \p T only depend on \p T
+/// itself, and not on declarations that may still be added, such as the
+/// constructors and conversion functions of a class.
+static bool isConversionCacheableType(QualType T) {
+  T = T.getNonReferenceType();
+  if (T->isDependentType() || T->isRecordType() || T->isFunctionType() ||
+      T->isPlaceholderType() || T->isObjCObjectOrInterfaceType() ||
+      T->isObjCObjectPointerType() || T->isBlockPointerType())
+    return false;
+
+  // Derived-to-base pointer conversions depend on the bases of the classes,
+  // which are only known once the classes are complete.
+  const Type *Pointee = nullptr;
+  if (const auto *Ptr = T->getAs<PointerType>())
+    Pointee = Ptr->getPointeeType().getTypePtr();
+  else if (const auto *MemPtr = T->getAs<MemberPointerType>())
+    Pointee = MemPtr->getClass();
+  if (Pointee) {
+    if (Pointee->isDependentType())
+      return false;
+    if (const CXXRecordDecl *RD = Pointee->getAsCXXRecordDecl())
+      return RD->hasDefinition() && !RD->isBeingDefined();
+  }
+  return true;
+}
+
+/// Determine whether the implicit conversion sequence that copy-initializes
+/// a \p ToType from \p From only depends on the types and the value kind of
+/// \p From, so that it can be reused for other arguments of the same type.
+static bool isConversionCacheable(Sema &S, Expr *From, QualType ToType) {
+  if (!S.getLangOpts().CPlusPlus || S.getLangOpts().ObjC)
+    return false;
+  if (isa<InitListExpr>(From) || From->isTypeDependent() ||
+      From->isValueDependent() || From->getObjectKind() != OK_Ordinary ||
+      From->getSourceBitField() || isa<StringLiteral>(From->IgnoreParens()))
+    return false;
+
+  QualType FromType = From->getType();
+  if (!isConversionCacheableType(FromType) ||
+      !isConversionCacheableType(ToType))
+    return false;
+
+  // Whether an integer is a null pointer constant depends on its value.
+  QualType To = ToType.getNonReferenceType();
+  if ((FromType->isIntegralOrEnumerationType() ||
+       FromType->isNullPtrType()) &&
+      (To->isAnyPointerType() || To->isMemberPointerType() ||
+       To->isBooleanType() || To->isNullPtrType()))
+    return false;
+  return true;
+}
+
 /// TryCopyInitialization - Try to copy-initialize a value of type
 /// ToType from the expression From. Return the implicit conversion
 /// sequence required to pass this argument, which may be a bad
@@ -5121,11 +5173,11 @@ TryListConversion(Sema &S, InitListExpr *From, QualType ToType,
 /// a parameter of this type). If @p SuppressUserConversions, then we
 /// do not permit any user-defined conversion sequences.
 static ImplicitConversionSequence
-TryCopyInitialization(Sema &S, Expr *From, QualType ToType,
-                      bool SuppressUserConversions,
-                      bool InOverloadResolution,
-                      bool AllowObjCWritebackConversion,
-                      bool AllowExplicit) {
+TryUncachedCopyInitialization(Sema &S, Expr *From, QualType ToType,
+                              bool SuppressUserConversions,
+                              bool InOverloadResolution,
+                              bool AllowObjCWritebackConversion,
+                              bool AllowExplicit) {
   if (InitListExpr *FromInitList = dyn_cast<InitListExpr>(From))
     return TryListConversion(S, FromInitList, ToType, SuppressUserConversions,
                              InOverloadResolution,AllowObjCWritebackConversion);
@@ -5144,6 +5196,49 @@ TryCopyInitialization(Sema &S, Expr *From, QualType ToType,
                                /*AllowObjCConversionOnExplicit=*/false);
 }
 
+/// TryCopyInitialization - As TryUncachedCopyInitialization, but reuse the
+/// standard conversion sequences of the arguments whose conversion only
+/// depends on their type during overload resolution.
+static ImplicitConversionSequence
+TryCopyInitialization(Sema &S, Expr *From, QualType ToType,
+                      bool SuppressUserConversions,
+                      bool InOverloadResolution,
+                      bool AllowObjCWritebackConversion,
+                      bool AllowExplicit) {
+  // Overload resolution converts the same argument types to the same
+  // parameter types over and over, e.g. for the candidates of a heavily
+  // overloaded operator. Reuse the standard conversion sequences that
+  // only depend on the types.
+  if (!InOverloadResolution || !isConversionCacheable(S, From, ToType))
+    return TryUncachedCopyInitialization(
+        S, From, ToType, SuppressUserConversions, InOverloadResolution,
+        AllowObjCWritebackConversion, AllowExplicit);
+
+  if (!S.OverloadConversionCache)
+    S.OverloadConversionCache = std::make_unique<StandardConversionCache>();
+  StandardConversionCache::KeyType Key(
+      {From->getType().getAsOpaquePtr(), ToType.getAsOpaquePtr()},
+      From->getValueKind() | SuppressUserConversions << 2 |
+          AllowObjCWritebackConversion << 3 | AllowExplicit << 4);
+  auto &Conversions = S.OverloadConversionCache->Conversions;
+  auto Known = Conversions.find(Key);
+  if (Known != Conversions.end()) {
+    ImplicitConversionSequence ICS;
+    ICS.setStandard();
+    ICS.Standard = Known->second;
+    return ICS;
+  }
+
+  ImplicitConversionSequence ICS = TryUncachedCopyInitialization(
+      S, From, ToType, SuppressUserConversions, InOverloadResolution,
+      AllowObjCWritebackConversion, AllowExplicit);
+  // Bad conversion sequences refer to the argument expression, for
+  // diagnostics.
+  if (ICS.isStandard())
+    Conversions.insert({Key, ICS.Standard});
+  return ICS;
+}
+
 static bool TryCopyInitialization(const CanQualType FromQTy,
                                   const CanQualType ToQTy,
                                   Sema &S,
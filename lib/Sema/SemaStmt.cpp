@@ -976,7 +976,12 @@ Sema::ActOnFinishSwitchStmt(SourceLocation SwitchLoc, Stmt *Switch,
     bool ShouldCheckConstantCond = HasConstantCond;
 
     // Sort all the scalar case values so we can easily detect duplicates.
-    llvm::stable_sort(CaseVals, CmpCaseVals);
+    // The switch case list is in reverse source order, so reversing it first
+    // leaves nothing to sort for the cases written in increasing order, as in
+    // generated state machines.
+    std::reverse(CaseVals.begin(), CaseVals.end());
+    if (!std::is_sorted(CaseVals.begin(), CaseVals.end(), CmpCaseVals))
+      llvm::stable_sort(CaseVals, CmpCaseVals);
 
     if (!CaseVals.empty()) {
       for (unsigned i = 0, e = CaseVals.size(); i != e; ++i) {
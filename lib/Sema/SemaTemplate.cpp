@@ -4243,16 +4243,12 @@ Sema::CheckConceptTemplateId(const CXXScopeSpec &SS,
     }
   }
   if (!AreArgsDependent) {
-    InstantiatingTemplate Inst(*this, ConceptNameLoc,
-        InstantiatingTemplate::ConstraintsCheck{}, NamedConcept, Converted,
-        SourceRange(SS.isSet() ? SS.getBeginLoc() : ConceptNameLoc,
-                    TemplateArgs->getRAngleLoc()));
-    MultiLevelTemplateArgumentList MLTAL;
-    MLTAL.addOuterTemplateArguments(Converted);
     bool Satisfied;
-    if (CalculateConstraintSatisfaction(NamedConcept, MLTAL,
-                                        NamedConcept->getConstraintExpr(),
-                                        Satisfied))
+    if (CheckConceptSatisfaction(
+            NamedConcept, Converted, ConceptNameLoc,
+            SourceRange(SS.isSet() ? SS.getBeginLoc() : ConceptNameLoc,
+                        TemplateArgs->getRAngleLoc()),
+            Satisfied))
       return ExprError();
     IsSatisfied = Satisfied;
   }
@@ -674,6 +674,9 @@ struct clang::DeducedPack {
   DeducedPack(unsigned Index) : Index(Index) {}
 };
 
+static bool hasTemplateArgumentForDeduction(ArrayRef<TemplateArgument> &Args,
+                                            unsigned &ArgIdx);
+
 namespace {
 
 /// A scope in which we're performing pack deduction.
@@ -834,6 +837,58 @@ public:
     return !FixedNumExpansions || *FixedNumExpansions > PackElements;
   }
 
+  /// Deduce all the remaining elements of the pack from the template
+  /// arguments \p Args, starting at \p ArgIdx, at once, if the pattern is
+  /// the type parameter pack itself, as in tuple<Ts...>. Each argument is then
+  /// the next element of the pack, and matching the pattern against each
+  /// argument in turn would only repeat the same steps.
+  ///
+  /// \returns false, without deducing anything, if some of the elements need
+  /// to be deduced one at a time.
+  bool deduceTypePackElements(TemplateArgument Pattern,
+                              ArrayRef<TemplateArgument> &Args,
+                              unsigned &ArgIdx) {
+    if (Packs.size() != 1 || FixedNumExpansions || IsPartiallyExpanded ||
+        PackElements || !Packs[0].New.empty() ||
+        S.getLangOpts().ObjCAutoRefCount ||
+        Pattern.getKind() != TemplateArgument::Type)
+      return false;
+    QualType Param = S.Context.getCanonicalType(Pattern.getAsType());
+    const auto *TTP = dyn_cast<TemplateTypeParmType>(Param);
+    if (!TTP || Param.hasLocalQualifiers() ||
+        TTP->getDepth() != Info.getDeducedDepth() ||
+        TTP->getIndex() != Packs[0].Index)
+      return false;
+
+    // Deduce each element as DeduceTemplateArgumentsByTypeMatch would: the
+    // canonical type of the argument, or of its pattern for a pack expansion.
+    // Arrays may need their qualifiers moved up, and placeholders aren't
+    // deduced, so leave those to the general case.
+    SmallVectorImpl<DeducedTemplateArgument> &New = Packs[0].New;
+    ArrayRef<TemplateArgument> RemainingArgs = Args;
+    unsigned Idx = ArgIdx;
+    for (; hasTemplateArgumentForDeduction(RemainingArgs, Idx); ++Idx) {
+      const TemplateArgument &Arg = RemainingArgs[Idx];
+      if (Arg.getKind() != TemplateArgument::Type) {
+        New.clear();
+        return false;
+      }
+      QualType ArgType = S.Context.getCanonicalType(Arg.getAsType());
+      if (const auto *Expansion = dyn_cast<PackExpansionType>(ArgType))
+        ArgType = Expansion->getPattern();
+      if (ArgType->isPlaceholderType() || isa<ArrayType>(ArgType)) {
+        New.clear();
+        return false;
+      }
+      New.push_back(DeducedTemplateArgument(ArgType));
+    }
+
+    PackElements = New.size();
+    Args = RemainingArgs;
+    ArgIdx = Idx;
+    return true;
+  }
+
   /// Move to deducing the next element in each pack that is being deduced.
   void nextPackElement() {
     // Capture the deduced template arguments for each parameter pack expanded
@@ -2332,16 +2387,18 @@ DeduceTemplateArguments(Sema &S, TemplateParameterList *TemplateParams,
     // Keep track of the deduced template arguments for each parameter pack
     // expanded by this pack expansion (the outer index) and for each
     // template argument (the inner SmallVectors).
-    for (; hasTemplateArgumentForDeduction(Args, ArgIdx) &&
-           PackScope.hasNextElement();
-         ++ArgIdx) {
-      // Deduce template arguments from the pattern.
-      if (Sema::TemplateDeductionResult Result
-            = DeduceTemplateArguments(S, TemplateParams, Pattern, Args[ArgIdx],
-                                      Info, Deduced))
-        return Result;
+    if (!PackScope.deduceTypePackElements(Pattern, Args, ArgIdx)) {
+      for (; hasTemplateArgumentForDeduction(Args, ArgIdx) &&
+             PackScope.hasNextElement();
+           ++ArgIdx) {
+        // Deduce template arguments from the pattern.
+        if (Sema::TemplateDeductionResult Result =
+                DeduceTemplateArguments(S, TemplateParams, Pattern,
+                                        Args[ArgIdx], Info, Deduced))
+          return Result;
 
-      PackScope.nextPackElement();
+        PackScope.nextPackElement();
+      }
     }
 
     // Build argument packs for each of the parameter packs expanded by this
@@ -918,6 +918,10 @@ namespace {
     /// instantiating it.
     Decl *TransformDefinition(SourceLocation Loc, Decl *D);
 
+    /// Transform the given statement, reusing the expression statements
+    /// which are the same in every instantiation.
+    StmtResult TransformStmt(Stmt *S, StmtDiscardKind SDK = SDK_Discarded);
+
     /// Transform the first qualifier within a scope by instantiating the
     /// declaration.
     NamedDecl *TransformFirstQualifierInScope(NamedDecl *D, SourceLocation Loc);
@@ -1032,6 +1036,75 @@ bool TemplateInstantiator::AlreadyTransformed(QualType T) {
   return true;
 }
 
+/// \returns true if the instantiations of the templated entity which \p D is
+/// referred to from all refer to \p D itself.
+static bool isSharedByInstantiations(const Decl *D) {
+  return !D->getDeclContext()->isDependentContext() &&
+         !D->getParentFunctionOrMethod();
+}
+
+/// \returns true if \p E is the same in every instantiation of the function
+/// body it belongs to: it depends on no template parameter, it only refers to
+/// declarations which the instantiations share, and it takes no part in the
+/// temporaries, captures or coroutine of the enclosing function.
+static bool isInstantiationInvariant(const Expr *E) {
+  if (E->isInstantiationDependent() || E->containsUnexpandedParameterPack())
+    return false;
+
+  switch (E->getStmtClass()) {
+  case Stmt::AddrLabelExprClass:
+  case Stmt::BlockExprClass:
+  case Stmt::CoawaitExprClass:
+  case Stmt::CoyieldExprClass:
+  case Stmt::CXXBindTemporaryExprClass:
+  case Stmt::CXXDefaultArgExprClass:
+  case Stmt::CXXDefaultInitExprClass:
+  case Stmt::CXXThisExprClass:
+  case Stmt::ExprWithCleanupsClass:
+  case Stmt::LambdaExprClass:
+  case Stmt::MaterializeTemporaryExprClass:
+  case Stmt::OpaqueValueExprClass:
+  case Stmt::PredefinedExprClass:
+  case Stmt::SourceLocExprClass:
+  case Stmt::StmtExprClass:
+    return false;
+  case Stmt::DeclRefExprClass:
+    if (!isSharedByInstantiations(cast<DeclRefExpr>(E)->getDecl()))
+      return false;
+    break;
+  case Stmt::MemberExprClass:
+    if (!isSharedByInstantiations(cast<MemberExpr>(E)->getMemberDecl()))
+      return false;
+    break;
+  default:
+    break;
+  }
+
+  for (const Stmt *Child : E->children()) {
+    if (!Child)
+      continue;
+    const auto *ChildExpr = dyn_cast<Expr>(Child);
+    if (!ChildExpr || !isInstantiationInvariant(ChildExpr))
+      return false;
+  }
+  return true;
+}
+
+StmtResult TemplateInstantiator::TransformStmt(Stmt *S, StmtDiscardKind SDK) {
+  // Rebuilding an expression statement which is the same in every
+  // instantiation would copy it for nothing: the implicit conversions in it,
+  // which the transformation drops and Sema recomputes, make every node
+  // above them change. Reuse it, marking what it refers to as referenced
+  // from this instantiation as rebuilding it would.
+  auto *E = dyn_cast_or_null<Expr>(S);
+  if (E && SDK != SDK_StmtExprResult && !AlwaysRebuild() &&
+      !getSema().getLangOpts().ObjC && isInstantiationInvariant(E)) {
+    getSema().MarkDeclarationsReferencedInExpr(E);
+    return getSema().ActOnExprStmt(E, SDK == SDK_Discarded);
+  }
+  return inherited::TransformStmt(S, SDK);
+}
+
 static TemplateArgument
 getPackSubstitutedTemplateArgument(Sema &S, TemplateArgument Arg) {
   assert(S.ArgumentPackSubstitutionIndex >= 0);
@@ -2720,6 +2720,7 @@ Decl *TemplateDeclInstantiator::VisitUsingDirectiveDecl(UsingDirectiveDecl *D) {
   // only if this is not a function or method.
   if (!Owner->isFunctionOrMethod())
     Owner->addDecl(Inst);
+  ++SemaRef.UsingDirectiveGeneration;
 
   return Inst;
 }
@@ -4270,15 +4271,21 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
   // a templated function definition.
   if (!Pattern && PatternDecl->isLateTemplateParsed() &&
       LateTemplateParser) {
-    // FIXME: Optimize to allow individual templates to be deserialized.
-    if (PatternDecl->isFromASTFile())
-      ExternalSource->ReadLateParsedTemplates(LateParsedTemplateMap);
+    if (PatternDecl->isFromASTFile() &&
+        !LateParsedTemplateMap.count(PatternDecl))
+      ExternalSource->ReadLateParsedTemplate(PatternDecl,
+                                             LateParsedTemplateMap);
 
     auto LPTIter = LateParsedTemplateMap.find(PatternDecl);
     assert(LPTIter != LateParsedTemplateMap.end() &&
            "missing LateParsedTemplate");
-    LateTemplateParser(OpaqueParser, *LPTIter->second);
+    LateParsedTemplate &LPT = *LPTIter->second;
+    LateTemplateParser(OpaqueParser, LPT);
     Pattern = PatternDecl->getBody(PatternDecl);
+
+    // The tokens aren't needed anymore once the body was parsed.
+    if (!PatternDecl->isLateTemplateParsed())
+      LPT.Toks = CachedTokens();
   }
 
   // Note, we should never try to instantiate a deleted function template.
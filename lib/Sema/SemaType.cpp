@@ -7848,6 +7848,7 @@ bool Sema::hasStructuralCompatLayout(Decl *D, Decl *Suggested) {
       StructuralEquivalenceKind::Default,
       false /*StrictTypeSpelling*/, true /*Complain*/,
       true /*ErrorOnTagTypeMismatch*/);
+  Ctx.EquivalentDecls = &StructurallyEquivalentDecls;
   return Ctx.IsEquivalent(D, Suggested);
 }
 
@@ -319,6 +319,40 @@ serialization::getDefinitiveDeclContext(const DeclContext *DC) {
   llvm_unreachable("Unhandled decl kind");
 }
 
+/// The number of bits of the identifier filter that each identifier sets.
+static const unsigned NumIdentifierFilterHashes = 3;
+
+/// Get the \p I'th bit that \p Name sets in an identifier filter of
+/// \p NumBits bits, by double hashing.
+static unsigned getIdentifierFilterBit(StringRef Name, unsigned I,
+                                       unsigned NumBits) {
+  uint32_t Hash = llvm::djbHash(Name);
+  uint32_t Step = llvm::djbHash(Name, 0x9e3779b9) | 1;
+  return (Hash + I * Step) % NumBits;
+}
+
+void serialization::addToIdentifierFilter(MutableArrayRef<uint64_t> Filter,
+                                          StringRef Name) {
+  unsigned NumBits = Filter.size() * 64;
+  for (unsigned I = 0; I != NumIdentifierFilterHashes; ++I) {
+    unsigned Bit = getIdentifierFilterBit(Name, I, NumBits);
+    Filter[Bit / 64] |= uint64_t(1) << (Bit % 64);
+  }
+}
+
+bool serialization::identifierFilterMayContain(ArrayRef<uint64_t> Filter,
+                                               StringRef Name) {
+  unsigned NumBits = Filter.size() * 64;
+  if (!NumBits)
+    return false;
+  for (unsigned I = 0; I != NumIdentifierFilterHashes; ++I) {
+    unsigned Bit = getIdentifierFilterBit(Name, I, NumBits);
+    if (!(Filter[Bit / 64] & (uint64_t(1) << (Bit % 64))))
+      return false;
+  }
+  return true;
+}
+
 bool serialization::isRedeclarableDeclKind(unsigned Kind) {
   switch (static_cast<Decl::Kind>(Kind)) {
   case Decl::TranslationUnit:
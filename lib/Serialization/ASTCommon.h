@@ -72,6 +72,14 @@ TypeID MakeTypeID(ASTContext &Context, QualType T, IdxForTypeTy IdxForType) {
 
 unsigned ComputeHash(Selector Sel);
 
+/// Add \p Name to the Bloom filter \p Filter of the identifiers known to the
+/// preprocessor that built a module, as written in the OBSERVED_MACROS
+/// record.
+void addToIdentifierFilter(MutableArrayRef<uint64_t> Filter, StringRef Name);
+
+/// \returns false if \p Name was definitely not added to \p Filter.
+bool identifierFilterMayContain(ArrayRef<uint64_t> Filter, StringRef Name);
+
 /// Retrieve the "definitive" declaration that provides all of the
 /// visible entries for the given declaration context, if there is one.
 ///
@@ -31,6 +31,7 @@
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/ODRHash.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/TemplateBase.h"
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
@@ -96,9 +97,11 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Bitstream/BitstreamReader.h"
@@ -113,6 +116,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1463,6 +1467,57 @@ bool ASTReader::ReadSLocEntry(int ID) {
     }
   };
 
+  // Local helper to read the line offsets of the file that may follow the
+  // entry record and its buffer blob. They are optional, so any problem
+  // reading them just means that they need to be computed by the source
+  // manager.
+  auto ReadLineOffsets = [this](BitstreamCursor &SLocEntryCursor, FileID FID,
+                                unsigned FileSize) {
+    RecordData Record;
+    StringRef Blob;
+    while (true) {
+      Expected<llvm::BitstreamEntry> MaybeEntry = SLocEntryCursor.advance();
+      if (!MaybeEntry) {
+        llvm::consumeError(MaybeEntry.takeError());
+        return;
+      }
+      if (MaybeEntry->Kind != llvm::BitstreamEntry::Record)
+        return;
+
+      Record.clear();
+      Expected<unsigned> MaybeRecCode =
+          SLocEntryCursor.readRecord(MaybeEntry->ID, Record, &Blob);
+      if (!MaybeRecCode) {
+        llvm::consumeError(MaybeRecCode.takeError());
+        return;
+      }
+      switch (MaybeRecCode.get()) {
+      case SM_SLOC_BUFFER_BLOB:
+      case SM_SLOC_BUFFER_BLOB_COMPRESSED:
+        // The contents of the file that were not needed; skip over them.
+        continue;
+      case SM_SLOC_LINE_OFFSETS:
+        break;
+      default:
+        return;
+      }
+
+      // Don't use the offsets if the file that was read doesn't match the one
+      // that was stored.
+      if (Record.empty() || Record[0] != FileSize)
+        return;
+      SmallVector<unsigned, 256> LineOffsets;
+      LineOffsets.reserve(Record.size());
+      LineOffsets.push_back(0);
+      for (unsigned I = 1, E = Record.size(); I != E; ++I)
+        LineOffsets.push_back(LineOffsets.back() + Record[I]);
+      if (LineOffsets.back() > FileSize)
+        return;
+      SourceMgr.setLineOffsets(FID, LineOffsets);
+      return;
+    }
+  };
+
   ModuleFile *F = GlobalSLocEntryMap.find(-ID)->second;
   if (llvm::Error Err = F->SLocEntryCursor.JumpToBit(
           F->SLocEntryOffsets[ID - F->SLocEntryBaseID])) {
@@ -1471,7 +1526,7 @@ bool ASTReader::ReadSLocEntry(int ID) {
   }
 
   BitstreamCursor &SLocEntryCursor = F->SLocEntryCursor;
-  unsigned BaseOffset = F->SLocEntryBaseOffset;
+  SourceLocation::UIntTy BaseOffset = F->SLocEntryBaseOffset;
 
   ++NumSLocEntriesRead;
   Expected<llvm::BitstreamEntry> MaybeEntry = SLocEntryCursor.advance();
@@ -1548,6 +1603,7 @@ bool ASTReader::ReadSLocEntry(int ID) {
       SourceMgr.overrideFileContents(File, std::move(Buffer));
     }
 
+    ReadLineOffsets(SLocEntryCursor, FID, ContentCache->getSize());
     break;
   }
 
@@ -2011,11 +2067,11 @@ namespace {
     IdentifierInfo *Found = nullptr;
 
   public:
-    IdentifierLookupVisitor(StringRef Name, unsigned PriorGeneration,
+    IdentifierLookupVisitor(StringRef Name, unsigned NameHash,
+                            unsigned PriorGeneration,
                             unsigned &NumIdentifierLookups,
                             unsigned &NumIdentifierLookupHits)
-      : Name(Name), NameHash(ASTIdentifierLookupTrait::ComputeHash(Name)),
-        PriorGeneration(PriorGeneration),
+      : Name(Name), NameHash(NameHash), PriorGeneration(PriorGeneration),
         NumIdentifierLookups(NumIdentifierLookups),
         NumIdentifierLookupHits(NumIdentifierLookupHits) {}
 
@@ -2053,39 +2109,54 @@ namespace {
 } // namespace
 
 void ASTReader::updateOutOfDateIdentifier(IdentifierInfo &II) {
+  DeserializationReasonRAII Reason(*this, DR_IdentifierLookup);
   // Note that we are loading an identifier.
   Deserializing AnIdentifier(this);
 
+  // The hash of the name is the same in the global index and in the tables
+  // of every module file, and is kept to look the identifier up again once
+  // more modules are loaded.
   unsigned PriorGeneration = 0;
-  if (getContext().getLangOpts().Modules)
-    PriorGeneration = IdentifierGeneration[&II];
+  Optional<unsigned> NameHash;
+  if (getContext().getLangOpts().Modules) {
+    const IdentifierLookupState &State = IdentifierLookups[&II];
+    PriorGeneration = State.Generation;
+    NameHash = State.NameHash;
+  }
+  if (!NameHash)
+    NameHash = ASTIdentifierLookupTrait::ComputeHash(II.getName());
 
   // If there is a global index, look there first to determine which modules
   // provably do not have any results for this identifier.
   GlobalModuleIndex::HitSet Hits;
   GlobalModuleIndex::HitSet *HitsPtr = nullptr;
   if (!loadGlobalIndex()) {
-    if (GlobalIndex->lookupIdentifier(II.getName(), Hits)) {
+    if (GlobalIndex->lookupIdentifier(II.getName(), *NameHash, Hits)) {
       HitsPtr = &Hits;
     }
   }
 
-  IdentifierLookupVisitor Visitor(II.getName(), PriorGeneration,
+  IdentifierLookupVisitor Visitor(II.getName(), *NameHash, PriorGeneration,
                                   NumIdentifierLookups,
                                   NumIdentifierLookupHits);
   ModuleMgr.visit(Visitor, HitsPtr);
-  markIdentifierUpToDate(&II);
+  markIdentifierUpToDate(&II, NameHash);
 }
 
-void ASTReader::markIdentifierUpToDate(IdentifierInfo *II) {
+void ASTReader::markIdentifierUpToDate(IdentifierInfo *II,
+                                       Optional<unsigned> NameHash) {
   if (!II)
     return;
 
   II->setOutOfDate(false);
 
   // Update the generation for this identifier.
-  if (getContext().getLangOpts().Modules)
-    IdentifierGeneration[II] = getGeneration();
+  if (getContext().getLangOpts().Modules) {
+    IdentifierLookupState &State = IdentifierLookups[II];
+    State.Generation = getGeneration();
+    if (NameHash)
+      State.NameHash = NameHash;
+  }
 }
 
 void ASTReader::resolvePendingMacro(IdentifierInfo *II,
@@ -2359,12 +2430,18 @@ InputFile ASTReader::getInputFile(ModuleFile &F, unsigned ID, bool Complain) {
   auto HasInputFileChanged = [&]() {
     if (StoredSize != File->getSize())
       return ModificationType::Size;
-    if (!DisableValidation && StoredTime &&
-        StoredTime != File->getModificationTime()) {
+    bool HasContentHash =
+        ValidateASTInputFilesContent &&
+        StoredContentHash != static_cast<uint64_t>(llvm::hash_code(-1));
+    // The files of an AST file written without timestamps are validated by
+    // their content, if it was hashed.
+    bool MayHaveChanged = StoredTime
+                              ? StoredTime != File->getModificationTime()
+                              : HasContentHash;
+    if (!DisableValidation && MayHaveChanged) {
       // In case the modification time changes but not the content,
       // accept the cached file as legit.
-      if (ValidateASTInputFilesContent &&
-          StoredContentHash != static_cast<uint64_t>(llvm::hash_code(-1))) {
+      if (HasContentHash) {
         auto MemBuffOrError = FileMgr.getBufferForFile(File);
         if (!MemBuffOrError) {
           if (!Complain)
@@ -2747,6 +2824,19 @@ ASTReader::ReadControlBlock(ModuleFile &F,
         Diags.UnrecoverableErrorOccurred = true;
       }
 
+      // The AST files written before the width was recorded have 32-bit
+      // source locations. The locations of a file of another width can't be
+      // read, even without validation.
+      unsigned SourceLocationBits = Record.size() > 8 ? Record[8] : 32;
+      constexpr unsigned OurSourceLocationBits =
+          8 * sizeof(SourceLocation::UIntTy);
+      if (SourceLocationBits != OurSourceLocationBits) {
+        if ((ClientLoadCapabilities & ARR_VersionMismatch) == 0)
+          Diag(diag::err_pch_source_location_width)
+              << SourceLocationBits << OurSourceLocationBits;
+        return VersionMismatch;
+      }
+
       F.RelocatablePCH = Record[4];
       // Relative paths in a relocatable PCH are relative to our sysroot.
       if (F.RelocatablePCH)
@@ -2915,10 +3005,65 @@ ASTReader::ReadControlBlock(ModuleFile &F,
       F.InputFilesLoaded.resize(NumInputs);
       F.NumUserInputFiles = NumUserInputs;
       break;
+
+    case OBSERVED_MACROS: {
+      unsigned Idx = 0;
+      for (unsigned I = 0, N = Record[Idx++]; I != N; ++I) {
+        std::string Name = ReadString(Record, Idx);
+        std::string Definition = ReadString(Record, Idx);
+        F.ObservedMacros.emplace_back(std::move(Name), std::move(Definition));
+      }
+      for (unsigned I = 0, N = Record[Idx++]; I != N; ++I)
+        F.UnobservedMacros.push_back(ReadString(Record, Idx));
+      ArrayRef<uint64_t> IdentifierFilter =
+          llvm::makeArrayRef(Record).slice(Idx);
+
+      if (ASTReadResult Result = checkObservedMacros(F, IdentifierFilter,
+                                                     ClientLoadCapabilities))
+        return Result;
+      break;
+    }
     }
   }
 }
 
+ASTReader::ASTReadResult
+ASTReader::checkObservedMacros(ModuleFile &F,
+                               ArrayRef<uint64_t> IdentifierFilter,
+                               unsigned ClientLoadCapabilities) {
+  // Only implicitly built modules are keyed by the macros they observed.
+  if (DisableValidation || F.Kind != MK_ImplicitModule ||
+      !PP.getHeaderSearchInfo().getHeaderSearchOpts().ModulesHashObservedMacros)
+    return Success;
+
+  const llvm::StringMap<std::string> &Definitions =
+      PP.getHeaderSearchInfo().getCommandLineMacros();
+  auto OutOfDateBecauseOf = [&](StringRef MacroName) {
+    if ((ClientLoadCapabilities & ARR_OutOfDate) == 0)
+      Diag(diag::err_module_observed_macro_changed) << F.FileName << MacroName;
+    return OutOfDate;
+  };
+
+  // The macros the module observed must be defined the same way here.
+  llvm::StringSet<> Known;
+  for (const auto &Macro : F.ObservedMacros) {
+    if (Definitions.lookup(Macro.first) != Macro.second)
+      return OutOfDateBecauseOf(Macro.first);
+    Known.insert(Macro.first);
+  }
+
+  // Any other macro defined here must not name an identifier the module
+  // used, unless the module was built with a definition of it that it did
+  // not observe.
+  Known.insert(F.UnobservedMacros.begin(), F.UnobservedMacros.end());
+  for (const auto &Definition : Definitions)
+    if (!Known.count(Definition.getKey()) &&
+        identifierFilterMayContain(IdentifierFilter, Definition.getKey()))
+      return OutOfDateBecauseOf(Definition.getKey());
+
+  return Success;
+}
+
 ASTReader::ASTReadResult
 ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
   BitstreamCursor &Stream = F.Stream;
@@ -3370,7 +3515,7 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
     case SOURCE_LOCATION_OFFSETS: {
       F.SLocEntryOffsets = (const uint32_t *)Blob.data();
       F.LocalNumSLocEntries = Record[0];
-      unsigned SLocSpaceSize = Record[1];
+      SourceLocation::UIntTy SLocSpaceSize = Record[1];
       std::tie(F.SLocEntryBaseID, F.SLocEntryBaseOffset) =
           SourceMgr.AllocateLoadedSLocEntries(F.LocalNumSLocEntries,
                                               SLocSpaceSize);
@@ -3387,17 +3532,19 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       F.FirstLoc = SourceLocation::getFromRawEncoding(F.SLocEntryBaseOffset);
 
       // SLocEntryBaseOffset is lower than MaxLoadedOffset and decreasing.
-      assert((F.SLocEntryBaseOffset & (1U << 31U)) == 0);
+      assert((F.SLocEntryBaseOffset & SourceLocation::MacroIDBit) == 0);
       GlobalSLocOffsetMap.insert(
           std::make_pair(SourceManager::MaxLoadedOffset - F.SLocEntryBaseOffset
                            - SLocSpaceSize,&F));
 
       // Initialize the remapping table.
       // Invalid stays invalid.
-      F.SLocRemap.insertOrReplace(std::make_pair(0U, 0));
+      F.SLocRemap.insertOrReplace(std::make_pair(
+          SourceLocation::UIntTy(0), SourceLocation::IntTy(0)));
       // This module. Base was 2 when being compiled.
-      F.SLocRemap.insertOrReplace(std::make_pair(2U,
-                                  static_cast<int>(F.SLocEntryBaseOffset - 2)));
+      F.SLocRemap.insertOrReplace(std::make_pair(
+          SourceLocation::UIntTy(2),
+          static_cast<SourceLocation::IntTy>(F.SLocEntryBaseOffset - 2)));
 
       TotalNumSLocEntries += F.LocalNumSLocEntries;
       break;
@@ -3662,6 +3809,19 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       }
       break;
 
+    case CONCEPT_SATISFACTIONS:
+      ConceptSatisfactions.emplace_back(&F, Record);
+      break;
+
+    case RECORD_LAYOUTS: {
+      unsigned RecordIndex = RecordLayouts.size();
+      for (unsigned I = 0, N = Record.size(); I + 1 < N; I += 2 + Record[I + 1])
+        RecordLayoutPositions[getGlobalDeclID(F, Record[I])] = {RecordIndex,
+                                                                I + 2};
+      RecordLayouts.emplace_back(&F, Record);
+      break;
+    }
+
     case IMPORTED_MODULES:
       if (!F.isModule()) {
         // If we aren't loading a module (which has its own exports), make
@@ -3704,7 +3864,7 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
     }
 
     case LATE_PARSED_TEMPLATE:
-      LateParsedTemplates.append(Record.begin(), Record.end());
+      LateParsedTemplates.emplace_back(&F, Record);
       break;
 
     case OPTIMIZE_PRAGMA_OPTIONS:
@@ -3782,13 +3942,18 @@ void ASTReader::ReadModuleOffsetMap(ModuleFile &F) const {
 
   // If we see this entry before SOURCE_LOCATION_OFFSETS, add placeholders.
   if (F.SLocRemap.find(0) == F.SLocRemap.end()) {
-    F.SLocRemap.insert(std::make_pair(0U, 0));
-    F.SLocRemap.insert(std::make_pair(2U, 1));
+    F.SLocRemap.insert(std::make_pair(SourceLocation::UIntTy(0),
+                                      SourceLocation::IntTy(0)));
+    F.SLocRemap.insert(std::make_pair(SourceLocation::UIntTy(2),
+                                      SourceLocation::IntTy(1)));
   }
 
   // Continuous range maps we may be updating in our module.
+  using SLocRemapBuilder =
+      ContinuousRangeMap<SourceLocation::UIntTy, SourceLocation::IntTy,
+                         2>::Builder;
   using RemapBuilder = ContinuousRangeMap<uint32_t, int, 2>::Builder;
-  RemapBuilder SLocRemap(F.SLocRemap);
+  SLocRemapBuilder SLocRemap(F.SLocRemap);
   RemapBuilder IdentifierRemap(F.IdentifierRemap);
   RemapBuilder MacroRemap(F.MacroRemap);
   RemapBuilder PreprocessedEntityRemap(F.PreprocessedEntityRemap);
@@ -3818,8 +3983,8 @@ void ASTReader::ReadModuleOffsetMap(ModuleFile &F) const {
       return;
     }
 
-    uint32_t SLocOffset =
-        endian::readNext<uint32_t, little, unaligned>(Data);
+    SourceLocation::UIntTy SLocOffset =
+        endian::readNext<SourceLocation::UIntTy, little, unaligned>(Data);
     uint32_t IdentifierIDOffset =
         endian::readNext<uint32_t, little, unaligned>(Data);
     uint32_t MacroIDOffset =
@@ -3843,7 +4008,10 @@ void ASTReader::ReadModuleOffsetMap(ModuleFile &F) const {
         Remap.insert(std::make_pair(Offset,
                                     static_cast<int>(BaseOffset - Offset)));
     };
-    mapOffset(SLocOffset, OM->SLocEntryBaseOffset, SLocRemap);
+    if (SLocOffset != std::numeric_limits<SourceLocation::UIntTy>::max())
+      SLocRemap.insert(std::make_pair(
+          SLocOffset, static_cast<SourceLocation::IntTy>(
+                          OM->SLocEntryBaseOffset - SLocOffset)));
     mapOffset(IdentifierIDOffset, OM->BaseIdentifierID, IdentifierRemap);
     mapOffset(MacroIDOffset, OM->BaseMacroID, MacroRemap);
     mapOffset(PreprocessedEntityIDOffset, OM->BasePreprocessedEntityID,
@@ -4164,6 +4332,7 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
                                             SmallVectorImpl<ImportedSubmodule> *Imported) {
   llvm::SaveAndRestore<SourceLocation>
     SetCurImportLocRAII(CurrentImportLoc, ImportLoc);
+  llvm::TimeTraceScope TimeScope("ReadAST", FileName);
 
   // Defer any pending actions until we get to the end of reading the AST file.
   Deserializing AnASTFile(this);
@@ -4246,24 +4415,27 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
     }
 
     // Preload all the pending interesting identifiers by marking them out of
-    // date.
-    for (auto Offset : F.PreloadIdentifierOffsets) {
-      const unsigned char *Data = reinterpret_cast<const unsigned char *>(
-          F.IdentifierTableData + Offset);
+    // date. If identifiers are loaded lazily, they're found by get() instead.
+    if (!loadsIdentifiersLazily()) {
+      for (auto Offset : F.PreloadIdentifierOffsets) {
+        const unsigned char *Data = reinterpret_cast<const unsigned char *>(
+            F.IdentifierTableData + Offset);
 
-      ASTIdentifierLookupTrait Trait(*this, F);
-      auto KeyDataLen = Trait.ReadKeyDataLength(Data);
-      auto Key = Trait.ReadKey(Data, KeyDataLen.first);
-      auto &II = PP.getIdentifierTable().getOwn(Key);
-      II.setOutOfDate(true);
+        ASTIdentifierLookupTrait Trait(*this, F);
+        auto KeyDataLen = Trait.ReadKeyDataLength(Data);
+        auto Key = Trait.ReadKey(Data, KeyDataLen.first);
+        auto &II = PP.getIdentifierTable().getOwn(Key);
+        II.setOutOfDate(true);
 
-      // Mark this identifier as being from an AST file so that we can track
-      // whether we need to serialize it.
-      markIdentifierFromAST(*this, II);
+        // Mark this identifier as being from an AST file so that we can track
+        // whether we need to serialize it.
+        markIdentifierFromAST(*this, II);
 
-      // Associate the ID with the identifier so that the writer can reuse it.
-      auto ID = Trait.ReadIdentifierID(Data + KeyDataLen.first);
-      SetIdentifierInfo(ID, &II);
+        // Associate the ID with the identifier so that the writer can reuse
+        // it.
+        auto ID = Trait.ReadIdentifierID(Data + KeyDataLen.first);
+        SetIdentifierInfo(ID, &II);
+      }
     }
   }
 
@@ -4286,7 +4458,7 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
       F.ImportLoc = TranslateSourceLocation(*M->ImportedBy, M->ImportLoc);
   }
 
-  if (!PP.getLangOpts().CPlusPlus ||
+  if (!PP.getLangOpts().CPlusPlus || loadsIdentifiersLazily() ||
       (Type != MK_ImplicitModule && Type != MK_ExplicitModule &&
        Type != MK_PrebuiltModule)) {
     // Mark all of the identifiers in the identifier table as being out of date,
@@ -4296,6 +4468,8 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
     // For C++ modules, we don't need information on many identifiers (just
     // those that provide macros or are poisoned), so we mark all of
     // the interesting ones via PreloadIdentifierOffsets.
+    //
+    // The same applies to C++ modules when identifiers are loaded lazily.
     for (IdentifierTable::iterator Id = PP.getIdentifierTable().begin(),
                                 IdEnd = PP.getIdentifierTable().end();
          Id != IdEnd; ++Id)
@@ -6332,6 +6506,7 @@ QualType ASTReader::readTypeRecord(unsigned Index) {
     Error(std::move(Err));
     return QualType();
   }
+  ModuleReadTimer Timer(*this, *Loc.F);
   RecordData Record;
   Expected<unsigned> MaybeCode = DeclsCursor.ReadCode();
   if (!MaybeCode) {
@@ -6345,6 +6520,8 @@ QualType ASTReader::readTypeRecord(unsigned Index) {
     Error(MaybeTypeCode.takeError());
     return QualType();
   }
+  ++Loc.F->NumTypesRead;
+  Loc.F->NumBitsRead += DeclsCursor.GetCurrentBitNo() - Loc.Offset;
   switch ((TypeCode)MaybeTypeCode.get()) {
   case TYPE_EXT_QUAL: {
     if (Record.size() != 2) {
@@ -7926,7 +8103,10 @@ Stmt *ASTReader::GetExternalDeclStmt(uint64_t Offset) {
   assert(NumCurrentElementsDeserializing == 0 &&
          "should not be called while already deserializing");
   Deserializing D(this);
-  return ReadStmtFromStream(*Loc.F);
+  ModuleReadTimer Timer(*this, *Loc.F);
+  Stmt *Body = ReadStmtFromStream(*Loc.F);
+  Loc.F->NumBitsRead += Loc.F->DeclsCursor.GetCurrentBitNo() - Loc.Offset;
+  return Body;
 }
 
 void ASTReader::FindExternalLexicalDecls(
@@ -8058,6 +8238,8 @@ ASTReader::FindExternalVisibleDeclsByName(const DeclContext *DC,
   if (It == Lookups.end())
     return false;
 
+  DeserializationReasonRAII Reason(*this, DR_DeclContextLookup);
+
   Deserializing LookupResults(this);
 
   // Load the list of declarations.
@@ -8081,6 +8263,7 @@ void ASTReader::completeVisibleDeclsMap(const DeclContext *DC) {
   assert(It != Lookups.end() &&
          "have external visible storage but no lookup tables");
 
+  DeserializationReasonRAII Reason(*this, DR_DeclContextLookup);
   DeclsMap Decls;
 
   for (DeclID ID : It->second.Table.findAll()) {
@@ -8187,6 +8370,8 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u macros read (%f%%)\n",
                  NumMacrosRead, TotalNumMacros,
                  ((float)NumMacrosRead/TotalNumMacros * 100));
+  if (NumRecordLayoutsRead)
+    std::fprintf(stderr, "  %u record layouts read\n", NumRecordLayoutsRead);
   if (TotalLexicalDeclContexts)
     std::fprintf(stderr, "  %u/%u lexical declcontexts read (%f%%)\n",
                  NumLexicalDeclContextsRead, TotalLexicalDeclContexts,
@@ -8211,12 +8396,17 @@ void ASTReader::PrintStats() {
                  NumMethodPoolTableHits, NumMethodPoolTableLookups,
                  ((float)NumMethodPoolTableHits/NumMethodPoolTableLookups
                   * 100.0));
+  if (NumMethodPoolLookups && NumMethodPoolTableLookups)
+    std::fprintf(stderr, "  %f method pool tables searched per lookup\n",
+                 (float)NumMethodPoolTableLookups / NumMethodPoolLookups);
   if (NumIdentifierLookupHits)
     std::fprintf(stderr,
                  "  %u / %u identifier table lookups succeeded (%f%%)\n",
                  NumIdentifierLookupHits, NumIdentifierLookups,
                  (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
 
+  printModuleFileStats();
+
   if (GlobalIndex) {
     std::fprintf(stderr, "\n");
     GlobalIndex->printStats();
@@ -8227,6 +8417,67 @@ void ASTReader::PrintStats() {
   std::fprintf(stderr, "\n");
 }
 
+void ASTReader::printModuleFileStats() {
+  std::vector<ModuleFile *> Files;
+  for (ModuleFile &F : ModuleMgr)
+    if (F.NumBitsRead)
+      Files.push_back(&F);
+  if (Files.empty())
+    return;
+
+  // The files which took the longest to read first, or the largest ones if
+  // the time wasn't measured.
+  llvm::stable_sort(Files, [](const ModuleFile *LHS, const ModuleFile *RHS) {
+    return std::make_pair(LHS->ReadTime, LHS->NumBitsRead) >
+           std::make_pair(RHS->ReadTime, RHS->NumBitsRead);
+  });
+
+  std::fprintf(stderr, "\n*** AST File Statistics per file:\n");
+  for (const ModuleFile *F : Files) {
+    unsigned NumDecls = 0;
+    for (unsigned N : F->NumDeclsRead)
+      NumDecls += N;
+    std::fprintf(
+        stderr, "  %s: %.1f KB read in %.3f ms\n",
+        F->ModuleName.empty() ? F->FileName.c_str() : F->ModuleName.c_str(),
+        F->NumBitsRead / 8 / 1024.0,
+        std::chrono::duration<double, std::milli>(F->ReadTime).count());
+    std::fprintf(stderr, "    %u declarations read", NumDecls);
+    if (NumDecls) {
+      const char *Separator = " (";
+      for (unsigned R = 0; R != NUM_DESERIALIZATION_REASONS; ++R) {
+        if (!F->NumDeclsRead[R])
+          continue;
+        std::fprintf(stderr, "%s%u %s", Separator, F->NumDeclsRead[R],
+                     getDeserializationReasonName(DeserializationReason(R)));
+        Separator = ", ";
+      }
+      std::fprintf(stderr, ")");
+    }
+    std::fprintf(stderr, "\n    %u types read\n    %u statements read\n",
+                 F->NumTypesRead, F->NumStatementsRead);
+  }
+}
+
+ASTReader::ModuleReadTimer::ModuleReadTimer(ASTReader &Reader, ModuleFile &F)
+    : Reader(Reader), F(F), Parent(Reader.CurrentModuleReadTimer),
+      Enabled(llvm::AreStatisticsEnabled()) {
+  if (!Enabled)
+    return;
+  Reader.CurrentModuleReadTimer = this;
+  Start = Clock::now();
+}
+
+ASTReader::ModuleReadTimer::~ModuleReadTimer() {
+  if (!Enabled)
+    return;
+  Clock::duration Elapsed = Clock::now() - Start;
+  F.ReadTime += Elapsed - NestedTime;
+  if (Parent)
+    Parent->NestedTime += Elapsed;
+  Reader.CurrentModuleReadTimer = Parent;
+}
+
 template<typename Key, typename ModuleFile, unsigned InitialCapacity>
 LLVM_DUMP_METHOD static void
 dumpModuleIDMap(StringRef Name,
@@ -8368,11 +8619,17 @@ void ASTReader::UpdateSema() {
   }
 }
 
+bool ASTReader::loadsIdentifiersLazily() const {
+  return PP.getHeaderSearchInfo().getHeaderSearchOpts().ModulesLazyIdentifiers;
+}
+
 IdentifierInfo *ASTReader::get(StringRef Name) {
+  DeserializationReasonRAII Reason(*this, DR_IdentifierLookup);
   // Note that we are loading an identifier.
   Deserializing AnIdentifier(this);
 
-  IdentifierLookupVisitor Visitor(Name, /*PriorGeneration=*/0,
+  unsigned NameHash = ASTIdentifierLookupTrait::ComputeHash(Name);
+  IdentifierLookupVisitor Visitor(Name, NameHash, /*PriorGeneration=*/0,
                                   NumIdentifierLookups,
                                   NumIdentifierLookupHits);
 
@@ -8380,7 +8637,9 @@ IdentifierInfo *ASTReader::get(StringRef Name) {
   // all interesting declarations, and don't need to use the scope for name
   // lookups). Perform the lookup in PCH files, though, since we don't build
   // a complete initial identifier table if we're carrying on from a PCH.
-  if (PP.getLangOpts().CPlusPlus) {
+  // When identifiers are loaded lazily, nothing is preloaded and all the
+  // modules are searched, as in C.
+  if (PP.getLangOpts().CPlusPlus && !loadsIdentifiersLazily()) {
     for (auto F : ModuleMgr.pch_modules())
       if (Visitor(*F))
         break;
@@ -8390,7 +8649,7 @@ IdentifierInfo *ASTReader::get(StringRef Name) {
     GlobalModuleIndex::HitSet Hits;
     GlobalModuleIndex::HitSet *HitsPtr = nullptr;
     if (!loadGlobalIndex()) {
-      if (GlobalIndex->lookupIdentifier(Name, Hits)) {
+      if (GlobalIndex->lookupIdentifier(Name, NameHash, Hits)) {
         HitsPtr = &Hits;
       }
     }
@@ -8399,7 +8658,7 @@ IdentifierInfo *ASTReader::get(StringRef Name) {
   }
 
   IdentifierInfo *II = Visitor.getIdentifierInfo();
-  markIdentifierUpToDate(II);
+  markIdentifierUpToDate(II, NameHash);
   return II;
 }
 
@@ -8599,8 +8858,19 @@ void ASTReader::ReadMethodPool(Selector Sel) {
 
   // Search for methods defined with this selector.
   ++NumMethodPoolLookups;
+
+  // If there is a global index, look there first to determine which modules
+  // provably do not have any methods for this selector.
+  GlobalModuleIndex::HitSet Hits;
+  GlobalModuleIndex::HitSet *HitsPtr = nullptr;
+  if (!loadGlobalIndex()) {
+    if (GlobalIndex->lookupSelector(Sel.getAsString(), Hits)) {
+      HitsPtr = &Hits;
+    }
+  }
+
   ReadMethodPoolVisitor Visitor(*this, Sel, PriorGeneration);
-  ModuleMgr.visit(Visitor);
+  ModuleMgr.visit(Visitor, HitsPtr);
 
   if (Visitor.getInstanceMethods().empty() &&
       Visitor.getFactoryMethods().empty())
@@ -8722,6 +8992,88 @@ void ASTReader::ReadUnusedLocalTypedefNameCandidates(
   UnusedLocalTypedefNameCandidates.clear();
 }
 
+void ASTReader::ReadConceptSatisfactions(
+    SmallVectorImpl<ExternalConceptSatisfaction> &Satisfactions) {
+  for (const auto &Entry : ConceptSatisfactions) {
+    ModuleFile &F = *Entry.first;
+    const RecordData &Record = Entry.second;
+    for (unsigned I = 0, N = Record.size(); I != N;) {
+      ExternalConceptSatisfaction Satisfaction;
+      Satisfaction.Concept = ReadDeclAs<ConceptDecl>(F, Record, I);
+      for (unsigned NumArgs = Record[I++]; NumArgs; --NumArgs)
+        Satisfaction.TemplateArgs.push_back(
+            ReadTemplateArgument(F, Record, I, /*Canonicalize=*/true));
+      Satisfaction.IsSatisfied = Record[I++];
+      Satisfactions.push_back(std::move(Satisfaction));
+    }
+  }
+  ConceptSatisfactions.clear();
+}
+
+const ASTRecordLayout *ASTReader::getRecordLayout(const RecordDecl *RD) {
+  if (!RD->isFromASTFile())
+    return nullptr;
+  auto Pos = RecordLayoutPositions.find(RD->getGlobalID());
+  if (Pos == RecordLayoutPositions.end())
+    return nullptr;
+  ModuleFile &F = *RecordLayouts[Pos->second.first].first;
+  const RecordData &Record = RecordLayouts[Pos->second.first].second;
+  unsigned I = Pos->second.second;
+  RecordLayoutPositions.erase(Pos);
+  ++NumRecordLayoutsRead;
+  ASTContext &Context = getContext();
+
+  auto ReadCharUnits = [&] {
+    return CharUnits::fromQuantity(static_cast<int64_t>(Record[I++]));
+  };
+  CharUnits Size = ReadCharUnits();
+  CharUnits DataSize = ReadCharUnits();
+  CharUnits Alignment = ReadCharUnits();
+  CharUnits UnadjustedAlignment = ReadCharUnits();
+  CharUnits RequiredAlignment = ReadCharUnits();
+  SmallVector<uint64_t, 16> FieldOffsets;
+  for (unsigned NumFields = Record[I++]; NumFields; --NumFields)
+    FieldOffsets.push_back(Record[I++]);
+
+  if (!Record[I++])
+    return new (Context)
+        ASTRecordLayout(Context, Size, Alignment, UnadjustedAlignment,
+                        RequiredAlignment, DataSize, FieldOffsets);
+
+  bool HasOwnVFPtr = Record[I++];
+  bool HasExtendableVFPtr = Record[I++];
+  CharUnits VBPtrOffset = ReadCharUnits();
+  CharUnits NonVirtualSize = ReadCharUnits();
+  CharUnits NonVirtualAlignment = ReadCharUnits();
+  CharUnits SizeOfLargestEmptySubobject = ReadCharUnits();
+  auto *PrimaryBase = ReadDeclAs<CXXRecordDecl>(F, Record, I);
+  bool IsPrimaryBaseVirtual = Record[I++];
+  auto *BaseSharingVBPtr = ReadDeclAs<CXXRecordDecl>(F, Record, I);
+  bool EndsWithZeroSizedObject = Record[I++];
+  bool LeadsWithZeroSizedBase = Record[I++];
+
+  ASTRecordLayout::BaseOffsetsMapTy BaseOffsets;
+  for (unsigned NumBases = Record[I++]; NumBases; --NumBases) {
+    auto *Base = ReadDeclAs<CXXRecordDecl>(F, Record, I);
+    BaseOffsets[Base] = ReadCharUnits();
+  }
+  ASTRecordLayout::VBaseOffsetsMapTy VBaseOffsets;
+  for (unsigned NumVBases = Record[I++]; NumVBases; --NumVBases) {
+    auto *VBase = ReadDeclAs<CXXRecordDecl>(F, Record, I);
+    CharUnits VBaseOffset = ReadCharUnits();
+    bool HasVtorDisp = Record[I++];
+    VBaseOffsets[VBase] = ASTRecordLayout::VBaseInfo(VBaseOffset, HasVtorDisp);
+  }
+
+  return new (Context) ASTRecordLayout(
+      Context, Size, Alignment, UnadjustedAlignment, RequiredAlignment,
+      HasOwnVFPtr, HasExtendableVFPtr, VBPtrOffset, DataSize, FieldOffsets,
+      NonVirtualSize, NonVirtualAlignment, SizeOfLargestEmptySubobject,
+      PrimaryBase, IsPrimaryBaseVirtual, BaseSharingVBPtr,
+      EndsWithZeroSizedObject, LeadsWithZeroSizedBase, BaseOffsets,
+      VBaseOffsets);
+}
+
 void ASTReader::ReadReferencedSelectors(
        SmallVectorImpl<std::pair<Selector, SourceLocation>> &Sels) {
   if (ReferencedSelectorsData.empty())
@@ -8784,28 +9136,75 @@ void ASTReader::ReadPendingInstantiations(
   PendingInstantiations.clear();
 }
 
-void ASTReader::ReadLateParsedTemplates(
+void ASTReader::indexLateParsedTemplates() {
+  // The record is indexed once the IDs of its module file can be mapped,
+  // rather than when it is read.
+  for (unsigned N = LateParsedTemplates.size();
+       NumIndexedLateParsedTemplates != N; ++NumIndexedLateParsedTemplates) {
+    ModuleFile &F = *LateParsedTemplates[NumIndexedLateParsedTemplates].first;
+    const RecordData &Record =
+        LateParsedTemplates[NumIndexedLateParsedTemplates].second;
+    // Each template is its function, its declaration, the number of values
+    // of its tokens and its tokens.
+    for (unsigned Idx = 0, E = Record.size(); Idx + 3 <= E;
+         Idx += 3 + Record[Idx + 2])
+      LateParsedTemplateOffsets.insert(
+          {getGlobalDeclID(F, Record[Idx]),
+           std::make_pair(NumIndexedLateParsedTemplates, Idx)});
+  }
+}
+
+void ASTReader::readLateParsedTemplate(
+    unsigned RecordIdx, unsigned Idx,
     llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
         &LPTMap) {
-  for (unsigned Idx = 0, N = LateParsedTemplates.size(); Idx < N;
-       /* In loop */) {
-    FunctionDecl *FD = cast<FunctionDecl>(GetDecl(LateParsedTemplates[Idx++]));
+  ModuleFile &F = *LateParsedTemplates[RecordIdx].first;
+  const RecordData &Record = LateParsedTemplates[RecordIdx].second;
+  FunctionDecl *FD = cast<FunctionDecl>(GetLocalDecl(F, Record[Idx++]));
 
-    auto LT = std::make_unique<LateParsedTemplate>();
-    LT->D = GetDecl(LateParsedTemplates[Idx++]);
+  auto LT = std::make_unique<LateParsedTemplate>();
+  LT->D = GetLocalDecl(F, Record[Idx++]);
 
-    ModuleFile *F = getOwningModuleFile(LT->D);
-    assert(F && "No module");
+  unsigned End = Idx + 1 + Record[Idx];
+  ++Idx;
+  while (Idx < End)
+    LT->Toks.push_back(ReadToken(F, Record, Idx));
 
-    unsigned TokN = LateParsedTemplates[Idx++];
-    LT->Toks.reserve(TokN);
-    for (unsigned T = 0; T < TokN; ++T)
-      LT->Toks.push_back(ReadToken(*F, LateParsedTemplates, Idx));
+  LPTMap.insert(std::make_pair(FD, std::move(LT)));
+}
 
-    LPTMap.insert(std::make_pair(FD, std::move(LT)));
+void ASTReader::ReadLateParsedTemplates(
+    llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+        &LPTMap) {
+  indexLateParsedTemplates();
+  // Read the templates in the order of the records, which is deterministic
+  // unlike the order of the index.
+  for (unsigned RecordIdx = 0, N = LateParsedTemplates.size(); RecordIdx != N;
+       ++RecordIdx) {
+    ModuleFile &F = *LateParsedTemplates[RecordIdx].first;
+    const RecordData &Record = LateParsedTemplates[RecordIdx].second;
+    for (unsigned Idx = 0, E = Record.size(); Idx + 3 <= E;
+         Idx += 3 + Record[Idx + 2])
+      if (LateParsedTemplateOffsets.erase(getGlobalDeclID(F, Record[Idx])))
+        readLateParsedTemplate(RecordIdx, Idx, LPTMap);
+  }
+}
+
+void ASTReader::ReadLateParsedTemplate(
+    const FunctionDecl *FD,
+    llvm::MapVector<const FunctionDecl *, std::unique_ptr<LateParsedTemplate>>
+        &LPTMap) {
+  indexLateParsedTemplates();
+  auto Known = LateParsedTemplateOffsets.find(FD->getGlobalID());
+  if (Known == LateParsedTemplateOffsets.end()) {
+    // The template could have been written for a redeclaration of FD.
+    ReadLateParsedTemplates(LPTMap);
+    return;
   }
 
-  LateParsedTemplates.clear();
+  std::pair<unsigned, unsigned> Offset = Known->second;
+  LateParsedTemplateOffsets.erase(Known);
+  readLateParsedTemplate(Offset.first, Offset.second, LPTMap);
 }
 
 void ASTReader::LoadSelector(Selector Sel) {
@@ -9751,6 +10150,7 @@ void ASTReader::ReadComments() {
     SavedStreamPosition SavedPosition(Cursor);
 
     RecordData Record;
+    StringRef Blob;
     while (true) {
       Expected<llvm::BitstreamEntry> MaybeEntry =
           Cursor.advanceSkippingSubblocks(
@@ -9775,7 +10175,8 @@ void ASTReader::ReadComments() {
 
       // Read a record.
       Record.clear();
-      Expected<unsigned> MaybeComment = Cursor.readRecord(Entry.ID, Record);
+      Expected<unsigned> MaybeComment =
+          Cursor.readRecord(Entry.ID, Record, &Blob);
       if (!MaybeComment) {
         Error(MaybeComment.takeError());
         return;
@@ -9792,11 +10193,16 @@ void ASTReader::ReadComments() {
             SR, Kind, IsTrailingComment, IsAlmostTrailingComment));
         break;
       }
+      case COMMENTS_FILE: {
+        // Only decoded once a comment is looked up in the file.
+        unsigned Idx = 0;
+        SourceLocation Start = ReadSourceLocation(F, Record, Idx);
+        PendingFileComments[Start.getRawEncoding()].push_back(Blob);
+        break;
+      }
       }
     }
   NextCursor:
-    llvm::DenseMap<FileID, std::map<unsigned, RawComment *>>
-        FileToOffsetToComment;
     for (RawComment *C : Comments) {
       SourceLocation CommentLoc = C->getBeginLoc();
       if (CommentLoc.isValid()) {
@@ -9809,6 +10215,35 @@ void ASTReader::ReadComments() {
   }
 }
 
+void ASTReader::ReadCommentsInFile(FileID File) {
+  if (PendingFileComments.empty() || !SourceMgr.isLoadedFileID(File))
+    return;
+  SourceLocation Start = SourceMgr.getLocForStartOfFile(File);
+  auto It = PendingFileComments.find(Start.getRawEncoding());
+  if (It == PendingFileComments.end())
+    return;
+
+  using namespace llvm::support;
+  ASTContext &Context = getContext();
+  std::map<unsigned, RawComment *> &FileComments =
+      Context.Comments.OrderedComments[File];
+  for (StringRef Blob : It->second) {
+    const unsigned char *Data = Blob.bytes_begin();
+    for (size_t I = 0, E = Blob.size() / 10; I != E; ++I) {
+      unsigned Offset = endian::readNext<uint32_t, little, unaligned>(Data);
+      unsigned Length = endian::readNext<uint32_t, little, unaligned>(Data);
+      auto Kind = (RawComment::CommentKind)*Data++;
+      unsigned Flags = *Data++;
+      SourceLocation Begin = Start.getLocWithOffset(Offset);
+      FileComments.emplace(
+          Offset, new (Context) RawComment(
+                      SourceRange(Begin, Begin.getLocWithOffset(Length)),
+                      Kind, Flags & 1, Flags & 2));
+    }
+  }
+  PendingFileComments.erase(It);
+}
+
 void ASTReader::visitInputFiles(serialization::ModuleFile &MF,
                                 bool IncludeSystem, bool Complain,
                     llvm::function_ref<void(const serialization::InputFile &IF,
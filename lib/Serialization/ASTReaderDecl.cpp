@@ -61,6 +61,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
@@ -746,7 +747,8 @@ void ASTDeclReader::VisitEnumDecl(EnumDecl *ED) {
   ED->setScopedUsingClassTag(Record.readInt());
   ED->setFixed(Record.readInt());
 
-  ED->setHasODRHash(true);
+  // Without a stored hash, the hash is computed if it's ever needed.
+  ED->setHasODRHash(Record.readInt());
   ED->ODRHash = Record.readInt();
 
   // If this is a definition subject to the ODR, and we already have a
@@ -881,8 +883,8 @@ void ASTDeclReader::VisitFunctionDecl(FunctionDecl *FD) {
   FD->setCachedLinkage(static_cast<Linkage>(Record.readInt()));
   FD->EndRangeLoc = ReadSourceLocation();
 
+  FD->setHasODRHash(Record.readInt());
   FD->ODRHash = Record.readInt();
-  FD->setHasODRHash(true);
 
   switch ((FunctionDecl::TemplatedKind)Record.readInt()) {
   case FunctionDecl::TK_NonTemplate:
@@ -1661,8 +1663,8 @@ void ASTDeclReader::ReadCXXDefinitionData(
   #include "clang/AST/CXXRecordDeclDefinitionBits.def"
 
   // Note: the caller has deserialized the IsLambda bit already.
+  Data.HasODRHash = Record.readInt();
   Data.ODRHash = Record.readInt();
-  Data.HasODRHash = true;
 
   if (Record.readInt())
     Reader.DefinitionSource[D] = Loc.F->Kind == ModuleKind::MK_MainFile;
@@ -1783,7 +1785,11 @@ void ASTDeclReader::MergeDefinitionData(
     // when they occur within the body of a function template specialization).
   }
 
-  if (D->getODRHash() != MergeDD.ODRHash) {
+  // Only hash the definition, which can be expensive for a definition that
+  // wasn't loaded with its hash, when the other checks found no violation.
+  // The AST files written without modules have no hashes to compare with.
+  if (!DetectedOdrViolation && MergeDD.HasODRHash &&
+      D->getODRHash() != MergeDD.ODRHash) {
     DetectedOdrViolation = true;
   }
 
@@ -3620,6 +3626,13 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
   // Note that we are loading a declaration record.
   Deserializing ADecl(this);
 
+  llvm::TimeTraceScope TimeScope("ReadDecl", [&] {
+    return (Loc.F->ModuleName.empty() ? Loc.F->FileName : Loc.F->ModuleName) +
+           " (" + getDeserializationReasonName(CurrentDeserializationReason) +
+           ")";
+  });
+  ModuleReadTimer Timer(*this, *Loc.F);
+
   auto Fail = [](const char *what, llvm::Error &&Err) {
     llvm::report_fatal_error(Twine("ASTReader::ReadDeclRecord failed ") + what +
                              ": " + toString(std::move(Err)));
@@ -3641,6 +3654,8 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
     llvm::report_fatal_error(
         "ASTReader::ReadDeclRecord failed reading decl code: " +
         toString(MaybeDeclCode.takeError()));
+  ++Loc.F->NumDeclsRead[CurrentDeserializationReason];
+  Loc.F->NumBitsRead += DeclsCursor.GetCurrentBitNo() - Loc.Offset;
   switch ((DeclCode)MaybeDeclCode.get()) {
   case DECL_CONTEXT_LEXICAL:
   case DECL_CONTEXT_VISIBLE:
@@ -3945,8 +3960,11 @@ void ASTReader::PassInterestingDeclsToConsumer() {
 
   // Ensure that we've loaded all potentially-interesting declarations
   // that need to be eagerly loaded.
-  for (auto ID : EagerlyDeserializedDecls)
-    GetDecl(ID);
+  {
+    DeserializationReasonRAII Reason(*this, DR_EagerDecl);
+    for (auto ID : EagerlyDeserializedDecls)
+      GetDecl(ID);
+  }
   EagerlyDeserializedDecls.clear();
 
   while (!PotentiallyInterestingDecls.empty()) {
@@ -3964,6 +3982,7 @@ void ASTReader::loadDeclUpdateRecords(PendingUpdateRecord &Record) {
   serialization::GlobalDeclID ID = Record.ID;
   Decl *D = Record.D;
   ProcessingUpdatesRAIIObj ProcessingUpdates(*this);
+  DeserializationReasonRAII Reason(*this, DR_UpdateRecord);
   DeclUpdateOffsetsMap::iterator UpdI = DeclUpdateOffsets.find(ID);
 
   SmallVector<serialization::DeclID, 8> PendingLazySpecializationIDs;
@@ -3983,6 +4002,7 @@ void ASTReader::loadDeclUpdateRecords(PendingUpdateRecord &Record) {
       uint64_t Offset = FileAndOffset.second;
       llvm::BitstreamCursor &Cursor = F->DeclsCursor;
       SavedStreamPosition SavedPosition(Cursor);
+      ModuleReadTimer Timer(*this, *F);
       if (llvm::Error JumpFailed = Cursor.JumpToBit(Offset))
         // FIXME don't do a fatal error.
         llvm::report_fatal_error(
@@ -4002,6 +4022,7 @@ void ASTReader::loadDeclUpdateRecords(PendingUpdateRecord &Record) {
         llvm::report_fatal_error(
             "ASTReader::loadDeclUpdateRecords failed reading rec code: " +
             toString(MaybeCode.takeError()));
+      F->NumBitsRead += Cursor.GetCurrentBitNo() - Offset;
 
       ASTDeclReader Reader(*this, Record, RecordLocation(F, Offset), ID,
                            SourceLocation());
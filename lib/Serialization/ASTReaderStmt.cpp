@@ -790,10 +790,16 @@ void ASTStmtReader::VisitMemberExpr(MemberExpr *E) {
   bool HasFoundDecl = Record.readInt();
   bool HasTemplateInfo = Record.readInt();
   unsigned NumTemplateArgs = Record.readInt();
+  bool HasMemberDNLoc = Record.readInt();
 
   E->Base = Record.readSubExpr();
   E->MemberDecl = Record.readDeclAs<ValueDecl>();
-  Record.readDeclarationNameLoc(E->MemberDNLoc, E->MemberDecl->getDeclName());
+  E->MemberExprBits.HasMemberDNLoc = HasMemberDNLoc;
+  if (HasMemberDNLoc) {
+    auto *DNLoc = new (E->getTrailingObjects<DeclarationNameLoc>())
+        DeclarationNameLoc(E->MemberDecl->getDeclName());
+    Record.readDeclarationNameLoc(*DNLoc, E->MemberDecl->getDeclName());
+  }
   E->MemberLoc = Record.readSourceLocation();
   E->MemberExprBits.IsArrow = Record.readInt();
   E->MemberExprBits.HasQualifierOrFoundDecl = HasQualifier || HasFoundDecl;
@@ -2680,7 +2686,8 @@ Stmt *ASTReader::ReadStmtFromStream(ModuleFile &F) {
       S = MemberExpr::CreateEmpty(Context, Record[ASTStmtReader::NumExprFields],
                                   Record[ASTStmtReader::NumExprFields + 1],
                                   Record[ASTStmtReader::NumExprFields + 2],
-                                  Record[ASTStmtReader::NumExprFields + 3]);
+                                  Record[ASTStmtReader::NumExprFields + 3],
+                                  Record[ASTStmtReader::NumExprFields + 4]);
       break;
 
     case EXPR_BINARY_OPERATOR:
@@ -3545,6 +3552,7 @@ Stmt *ASTReader::ReadStmtFromStream(ModuleFile &F) {
       break;
 
     ++NumStatementsRead;
+    ++F.NumStatementsRead;
 
     if (S && !IsStmtReference) {
       Reader.Visit(S);
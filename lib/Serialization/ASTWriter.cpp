@@ -30,6 +30,7 @@
 #include "clang/AST/LambdaCapture.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
@@ -94,8 +95,10 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SHA1.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VersionTuple.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -128,6 +131,16 @@ static StringRef bytes(const SmallVectorImpl<T> &v) {
                          sizeof(T) * v.size());
 }
 
+/// Sort identifiers by name. Names are unique, so the result is the same
+/// when they are sorted on several threads.
+static void sortByName(SmallVectorImpl<const IdentifierInfo *> &IIs,
+                       bool Parallel) {
+  if (Parallel)
+    llvm::parallelSort(IIs.begin(), IIs.end(), llvm::deref<std::less<>>());
+  else
+    llvm::sort(IIs, llvm::deref<std::less<>>());
+}
+
 //===----------------------------------------------------------------------===//
 // Type serialization
 //===----------------------------------------------------------------------===//
@@ -1084,6 +1097,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(METADATA);
   RECORD(MODULE_NAME);
   RECORD(MODULE_DIRECTORY);
+  RECORD(OBSERVED_MACROS);
   RECORD(MODULE_MAP_FILE);
   RECORD(IMPORTS);
   RECORD(ORIGINAL_FILE);
@@ -1154,6 +1168,9 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(POINTERS_TO_MEMBERS_PRAGMA_OPTIONS);
   RECORD(UNUSED_LOCAL_TYPEDEF_NAME_CANDIDATES);
   RECORD(DELETE_EXPRS_TO_ANALYZE);
+  RECORD(CONCEPT_SATISFACTIONS);
+  RECORD(RECORD_LAYOUTS);
+  RECORD(METHOD_POOL_SELECTORS);
   RECORD(CUDA_PRAGMA_FORCE_HOST_DEVICE_DEPTH);
   RECORD(PP_CONDITIONAL_STACK);
 
@@ -1164,6 +1181,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(SM_SLOC_BUFFER_BLOB);
   RECORD(SM_SLOC_BUFFER_BLOB_COMPRESSED);
   RECORD(SM_SLOC_EXPANSION_ENTRY);
+  RECORD(SM_SLOC_LINE_OFFSETS);
 
   // Preprocessor Block.
   BLOCK(PREPROCESSOR_BLOCK);
@@ -1197,6 +1215,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   // Comments Block.
   BLOCK(COMMENTS_BLOCK);
   RECORD(COMMENTS_RAW_COMMENT);
+  RECORD(COMMENTS_FILE);
 
   // Decls and Types block.
   BLOCK(DECLTYPES_BLOCK);
@@ -1347,6 +1366,29 @@ static bool cleanPathForOutput(FileManager &FileMgr,
   return Changed | llvm::sys::path::remove_dots(Path);
 }
 
+/// Replaces the prefix of \p Path by its replacement in \p PrefixMap, the
+/// last of the prefixes that match whole components of the path.
+///
+/// \return \c true if the path was changed.
+static bool
+remapPathPrefix(ArrayRef<std::pair<std::string, std::string>> PrefixMap,
+                SmallVectorImpl<char> &Path) {
+  StringRef P(Path.data(), Path.size());
+  for (const auto &Entry : llvm::reverse(PrefixMap)) {
+    StringRef Old = Entry.first;
+    if (Old.empty() || !P.startswith(Old))
+      continue;
+    if (P.size() != Old.size() &&
+        !llvm::sys::path::is_separator(P[Old.size()]) &&
+        !llvm::sys::path::is_separator(Old.back()))
+      continue;
+    std::string Remapped = (Twine(Entry.second) + P.substr(Old.size())).str();
+    Path.assign(Remapped.begin(), Remapped.end());
+    return true;
+  }
+  return false;
+}
+
 /// Adjusts the given filename to only write out the portion of the
 /// filename that is not part of the system root directory.
 ///
@@ -1457,6 +1499,24 @@ ASTFileSignature ASTWriter::writeUnhashedControlBlock(Preprocessor &PP,
   return Signature;
 }
 
+/// Whether the command-line definition of the macro \p Name was used, i.e.
+/// expanded or tested by \#ifdef, \#ifndef or defined().
+static bool isCommandLineMacroUsed(Preprocessor &PP, StringRef Name) {
+  IdentifierInfo *II = PP.getIdentifierInfo(Name);
+  SourceManager &SourceMgr = PP.getSourceManager();
+  for (auto *MD = PP.getLocalMacroDirectiveHistory(II); MD;
+       MD = MD->getPrevious()) {
+    // We only care about the predefines buffer.
+    FileID FID = SourceMgr.getFileID(MD->getLocation());
+    if (FID.isInvalid() || FID != PP.getPredefinesFileID())
+      continue;
+    if (auto *DMD = dyn_cast<DefMacroDirective>(MD))
+      return DMD->getMacroInfo()->isUsed();
+    break;
+  }
+  return false;
+}
+
 /// Write the control block.
 void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
                                   StringRef isysroot,
@@ -1477,6 +1537,7 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
   MetadataAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // Timestamps
   MetadataAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // PCHHasObjectFile
   MetadataAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // Errors
+  MetadataAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 8)); // SLoc bits
   MetadataAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // SVN branch/tag
   unsigned MetadataAbbrevCode = Stream.EmitAbbrev(std::move(MetadataAbbrev));
   assert((!WritingModule || isysroot.empty()) &&
@@ -1491,7 +1552,8 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
         !isysroot.empty(),
         IncludeTimestamps,
         Context.getLangOpts().BuildingPCHWithObjectFile,
-        ASTHasCompilerErrors};
+        ASTHasCompilerErrors,
+        8 * sizeof(SourceLocation::UIntTy)};
     Stream.EmitRecordWithBlob(MetadataAbbrevCode, Record,
                               getClangFullRepositoryVersion());
   }
@@ -1523,8 +1585,12 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
       Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // Directory
       unsigned AbbrevCode = Stream.EmitAbbrev(std::move(Abbrev));
 
+      SmallString<128> RemappedBaseDir(BaseDir);
+      remapPathPrefix(
+          PP.getHeaderSearchInfo().getHeaderSearchOpts().ModuleFilePrefixMap,
+          RemappedBaseDir);
       RecordData::value_type Record[] = {MODULE_DIRECTORY};
-      Stream.EmitRecordWithBlob(AbbrevCode, Record, BaseDir);
+      Stream.EmitRecordWithBlob(AbbrevCode, Record, RemappedBaseDir);
     }
 
     // Write out all other paths relative to the base directory if possible.
@@ -1584,6 +1650,55 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
     Stream.EmitRecord(IMPORTS, Record);
   }
 
+  // Command-line macros observed by the module.
+  if (WritingModule &&
+      PP.getHeaderSearchInfo().getHeaderSearchOpts().ModulesHashObservedMacros) {
+    llvm::StringMap<std::string> Definitions =
+        PP.getPreprocessorOpts().getMacroDefinitions();
+    llvm::StringMap<std::string> Observed;
+    for (const auto &Definition : Definitions)
+      if (isCommandLineMacroUsed(PP, Definition.getKey()))
+        Observed[Definition.getKey()] = Definition.getValue();
+
+    // The module also depends on the macros observed by its imports, which
+    // may not be defined here.
+    if (Chain)
+      for (ModuleFile &M : Chain->getModuleManager())
+        for (const auto &Macro : M.ObservedMacros)
+          Observed[Macro.first] = Definitions.lookup(Macro.first);
+
+    SmallVector<StringRef, 16> ObservedNames, UnobservedNames;
+    for (const auto &Macro : Observed)
+      ObservedNames.push_back(Macro.getKey());
+    for (const auto &Definition : Definitions)
+      if (!Observed.count(Definition.getKey()))
+        UnobservedNames.push_back(Definition.getKey());
+    llvm::sort(ObservedNames);
+    llvm::sort(UnobservedNames);
+
+    Record.clear();
+    Record.push_back(ObservedNames.size());
+    for (StringRef Name : ObservedNames) {
+      AddString(Name, Record);
+      AddString(Observed[Name], Record);
+    }
+    Record.push_back(UnobservedNames.size());
+    for (StringRef Name : UnobservedNames)
+      AddString(Name, Record);
+
+    // A macro that is only defined by an importer can still change the
+    // module if it names an identifier the module used. Every such identifier
+    // is in the identifier table, so summarize that in a filter with about a
+    // 1% false positive rate.
+    IdentifierTable &Identifiers = PP.getIdentifierTable();
+    SmallVector<uint64_t, 64> Filter(
+        std::max<size_t>(1, (Identifiers.size() * 10 + 63) / 64), 0);
+    for (const auto &ID : Identifiers)
+      addToIdentifierFilter(Filter, ID.getKey());
+    Record.append(Filter.begin(), Filter.end());
+    Stream.EmitRecord(OBSERVED_MACROS, Record);
+  }
+
   // Write the options block.
   Stream.EnterSubblock(OPTIONS_BLOCK_ID, 4);
 
@@ -1641,24 +1756,32 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
   }
   Stream.EmitRecord(TARGET_OPTIONS, Record);
 
+  // The paths of the options are remapped but not made absolute, since they
+  // are written as they were given.
+  const HeaderSearchOptions &HSOpts
+    = PP.getHeaderSearchInfo().getHeaderSearchOpts();
+  auto AddOptionPath = [&](StringRef Path) {
+    SmallString<128> RemappedPath(Path);
+    remapPathPrefix(HSOpts.ModuleFilePrefixMap, RemappedPath);
+    AddString(RemappedPath, Record);
+  };
+
   // File system options.
   Record.clear();
   const FileSystemOptions &FSOpts =
       Context.getSourceManager().getFileManager().getFileSystemOpts();
-  AddString(FSOpts.WorkingDir, Record);
+  AddOptionPath(FSOpts.WorkingDir);
   Stream.EmitRecord(FILE_SYSTEM_OPTIONS, Record);
 
   // Header search options.
   Record.clear();
-  const HeaderSearchOptions &HSOpts
-    = PP.getHeaderSearchInfo().getHeaderSearchOpts();
-  AddString(HSOpts.Sysroot, Record);
+  AddOptionPath(HSOpts.Sysroot);
 
   // Include entries.
   Record.push_back(HSOpts.UserEntries.size());
   for (unsigned I = 0, N = HSOpts.UserEntries.size(); I != N; ++I) {
     const HeaderSearchOptions::Entry &Entry = HSOpts.UserEntries[I];
-    AddString(Entry.Path, Record);
+    AddOptionPath(Entry.Path);
     Record.push_back(static_cast<unsigned>(Entry.Group));
     Record.push_back(Entry.IsFramework);
     Record.push_back(Entry.IgnoreSysRoot);
@@ -1671,7 +1794,7 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
     Record.push_back(HSOpts.SystemHeaderPrefixes[I].IsSystemHeader);
   }
 
-  AddString(HSOpts.ResourceDir, Record);
+  AddOptionPath(HSOpts.ResourceDir);
   AddString(HSOpts.ModuleCachePath, Record);
   AddString(HSOpts.ModuleUserBuildPath, Record);
   Record.push_back(HSOpts.DisableModuleHash);
@@ -1689,11 +1812,16 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
   Record.clear();
   const PreprocessorOptions &PPOpts = PP.getPreprocessorOpts();
 
-  // Macro definitions.
-  Record.push_back(PPOpts.Macros.size());
-  for (unsigned I = 0, N = PPOpts.Macros.size(); I != N; ++I) {
-    AddString(PPOpts.Macros[I].first, Record);
-    Record.push_back(PPOpts.Macros[I].second);
+  // Macro definitions. When modules are keyed by the macros they observe,
+  // the OBSERVED_MACROS record describes the ones that matter instead.
+  if (WritingModule && HSOpts.ModulesHashObservedMacros) {
+    Record.push_back(0);
+  } else {
+    Record.push_back(PPOpts.Macros.size());
+    for (unsigned I = 0, N = PPOpts.Macros.size(); I != N; ++I) {
+      AddString(PPOpts.Macros[I].first, Record);
+      Record.push_back(PPOpts.Macros[I].second);
+    }
   }
 
   // Includes
@@ -1745,10 +1873,13 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
     SmallString<128> OutputPath(OutputFile);
 
     SM.getFileManager().makeAbsolutePath(OutputPath);
-    StringRef origDir = llvm::sys::path::parent_path(OutputPath);
+    SmallString<128> OrigDir(llvm::sys::path::parent_path(OutputPath));
+    remapPathPrefix(
+        PP.getHeaderSearchInfo().getHeaderSearchOpts().ModuleFilePrefixMap,
+        OrigDir);
 
     RecordData::value_type Record[] = {ORIGINAL_PCH_DIR};
-    Stream.EmitRecordWithBlob(AbbrevCode, Record, origDir);
+    Stream.EmitRecordWithBlob(AbbrevCode, Record, OrigDir);
   }
 
   WriteInputFiles(Context.SourceMgr,
@@ -1766,6 +1897,7 @@ struct InputFileEntry {
   bool IsTransient;
   bool BufferOverridden;
   bool IsTopLevelModuleMap;
+  const llvm::MemoryBuffer *Contents;
   uint32_t ContentHash[2];
 };
 
@@ -1821,23 +1953,16 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
     Entry.IsTopLevelModuleMap = isModuleMap(File.getFileCharacteristic()) &&
                                 File.getIncludeLoc().isInvalid();
 
-    auto ContentHash = hash_code(-1);
+    Entry.Contents = nullptr;
     if (PP->getHeaderSearchInfo()
             .getHeaderSearchOpts()
             .ValidateASTInputFilesContent) {
-      auto *MemBuff = Cache->getRawBuffer();
-      if (MemBuff)
-        ContentHash = hash_value(MemBuff->getBuffer());
-      else
+      Entry.Contents = Cache->getRawBuffer();
+      if (!Entry.Contents)
         // FIXME: The path should be taken from the FileEntryRef.
         PP->Diag(SourceLocation(), diag::err_module_unable_to_hash_content)
             << Entry.File->getName();
     }
-    auto CH = llvm::APInt(64, ContentHash);
-    Entry.ContentHash[0] =
-        static_cast<uint32_t>(CH.getLoBits(32).getZExtValue());
-    Entry.ContentHash[1] =
-        static_cast<uint32_t>(CH.getHiBits(32).getZExtValue());
 
     if (Entry.IsSystemFile)
       SortedFiles.push_back(Entry);
@@ -1845,6 +1970,23 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
       SortedFiles.push_front(Entry);
   }
 
+  // Hash the contents of the files, which is independent for each of them.
+  auto HashContents = [](InputFileEntry &Entry) {
+    auto ContentHash = hash_code(-1);
+    if (Entry.Contents)
+      ContentHash = hash_value(Entry.Contents->getBuffer());
+    auto CH = llvm::APInt(64, ContentHash);
+    Entry.ContentHash[0] =
+        static_cast<uint32_t>(CH.getLoBits(32).getZExtValue());
+    Entry.ContentHash[1] =
+        static_cast<uint32_t>(CH.getHiBits(32).getZExtValue());
+  };
+  if (PP->getPreprocessorOpts().ParallelASTWriting)
+    llvm::parallelForEach(SortedFiles.begin(), SortedFiles.end(),
+                          HashContents);
+  else
+    llvm::for_each(SortedFiles, HashContents);
+
   unsigned UserFilesNum = 0;
   // Write out all of the input files.
   std::vector<uint64_t> InputFileOffsets;
@@ -1955,6 +2097,18 @@ static unsigned CreateSLocBufferBlobAbbrev(llvm::BitstreamWriter &Stream,
   return Stream.EmitAbbrev(std::move(Abbrev));
 }
 
+/// Create an abbreviation for the line offsets of a file.
+static unsigned CreateSLocLineOffsetsAbbrev(llvm::BitstreamWriter &Stream) {
+  using namespace llvm;
+
+  auto Abbrev = std::make_shared<BitCodeAbbrev>();
+  Abbrev->Add(BitCodeAbbrevOp(SM_SLOC_LINE_OFFSETS));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8)); // File size
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Line lengths
+  return Stream.EmitAbbrev(std::move(Abbrev));
+}
+
 /// Create an abbreviation for the SLocEntry that refers to a macro
 /// expansion.
 static unsigned CreateSLocExpansionAbbrev(llvm::BitstreamWriter &Stream) {
@@ -2239,24 +2393,35 @@ void ASTWriter::WriteHeaderSearch(const HeaderSearch &HS) {
     free(const_cast<char *>(SavedStrings[I]));
 }
 
+/// Compress the contents of a buffer if possible. We expect that almost all
+/// PCM consumers will not want its contents.
+///
+/// \returns false if the buffer can't be compressed.
+static bool compressBlob(StringRef Blob, SmallVectorImpl<char> &Compressed) {
+  if (!llvm::zlib::isAvailable())
+    return false;
+  llvm::Error E = llvm::zlib::compress(Blob.drop_back(1), Compressed);
+  if (!E)
+    return true;
+  llvm::consumeError(std::move(E));
+  Compressed.clear();
+  return false;
+}
+
+/// Emit the contents of a buffer, using \p CompressedBlob if the buffer was
+/// compressed.
 static void emitBlob(llvm::BitstreamWriter &Stream, StringRef Blob,
+                     Optional<StringRef> CompressedBlob,
                      unsigned SLocBufferBlobCompressedAbbrv,
                      unsigned SLocBufferBlobAbbrv) {
   using RecordDataType = ASTWriter::RecordData::value_type;
 
-  // Compress the buffer if possible. We expect that almost all PCM
-  // consumers will not want its contents.
-  SmallString<0> CompressedBuffer;
-  if (llvm::zlib::isAvailable()) {
-    llvm::Error E = llvm::zlib::compress(Blob.drop_back(1), CompressedBuffer);
-    if (!E) {
-      RecordDataType Record[] = {SM_SLOC_BUFFER_BLOB_COMPRESSED,
-                                 Blob.size() - 1};
-      Stream.EmitRecordWithBlob(SLocBufferBlobCompressedAbbrv, Record,
-                                CompressedBuffer);
-      return;
-    }
-    llvm::consumeError(std::move(E));
+  if (CompressedBlob) {
+    RecordDataType Record[] = {SM_SLOC_BUFFER_BLOB_COMPRESSED,
+                               Blob.size() - 1};
+    Stream.EmitRecordWithBlob(SLocBufferBlobCompressedAbbrv, Record,
+                              *CompressedBlob);
+    return;
   }
 
   RecordDataType Record[] = {SM_SLOC_BUFFER_BLOB};
@@ -2285,6 +2450,45 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
   unsigned SLocBufferBlobCompressedAbbrv =
       CreateSLocBufferBlobAbbrev(Stream, true);
   unsigned SLocExpansionAbbrv = CreateSLocExpansionAbbrev(Stream);
+  unsigned SLocLineOffsetsAbbrv = CreateSLocLineOffsetsAbbrev(Stream);
+
+  // The contents of the buffers that need to be written. Include the implicit
+  // terminating null character in the on-disk buffer in case it's written
+  // uncompressed.
+  auto getBlob = [&](const SrcMgr::ContentCache *Content) {
+    const llvm::MemoryBuffer *Buffer =
+        Content->getBuffer(PP.getDiagnostics(), PP.getFileManager());
+    return StringRef(Buffer->getBufferStart(), Buffer->getBufferSize() + 1);
+  };
+
+  // Compressing the buffers doesn't depend on anything else, so when writing
+  // in parallel, compress all of them up front.
+  struct CompressedBlob {
+    unsigned SLocEntryIndex;
+    StringRef Blob;
+    SmallString<0> Compressed;
+    bool Success = false;
+  };
+  std::vector<CompressedBlob> CompressedBlobs;
+  if (PP.getPreprocessorOpts().ParallelASTWriting) {
+    for (unsigned I = 1, N = SourceMgr.local_sloc_entry_size(); I != N; ++I) {
+      const SrcMgr::SLocEntry &SLoc = SourceMgr.getLocalSLocEntry(I);
+      if (!SLoc.isFile())
+        continue;
+      const SrcMgr::ContentCache *Content = SLoc.getFile().getContentCache();
+      if (Content->OrigEntry && !Content->BufferOverridden &&
+          !Content->IsTransient)
+        continue;
+      CompressedBlobs.emplace_back();
+      CompressedBlobs.back().SLocEntryIndex = I;
+      CompressedBlobs.back().Blob = getBlob(Content);
+    }
+    llvm::parallelForEachN(0, CompressedBlobs.size(), [&](size_t I) {
+      CompressedBlob &B = CompressedBlobs[I];
+      B.Success = compressBlob(B.Blob, B.Compressed);
+    });
+  }
+  auto NextCompressedBlob = CompressedBlobs.begin();
 
   // Write out the source location entry table. We skip the first
   // entry, which is always the same dummy entry.
@@ -2366,13 +2570,33 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
       }
 
       if (EmitBlob) {
-        // Include the implicit terminating null character in the on-disk buffer
-        // if we're writing it uncompressed.
-        const llvm::MemoryBuffer *Buffer =
-            Content->getBuffer(PP.getDiagnostics(), PP.getFileManager());
-        StringRef Blob(Buffer->getBufferStart(), Buffer->getBufferSize() + 1);
-        emitBlob(Stream, Blob, SLocBufferBlobCompressedAbbrv,
-                 SLocBufferBlobAbbrv);
+        Optional<StringRef> Compressed;
+        SmallString<0> CompressedBuffer;
+        if (NextCompressedBlob != CompressedBlobs.end() &&
+            NextCompressedBlob->SLocEntryIndex == I) {
+          if (NextCompressedBlob->Success)
+            Compressed = NextCompressedBlob->Compressed.str();
+          ++NextCompressedBlob;
+        } else if (compressBlob(getBlob(Content), CompressedBuffer)) {
+          Compressed = CompressedBuffer.str();
+        }
+        emitBlob(Stream, getBlob(Content), Compressed,
+                 SLocBufferBlobCompressedAbbrv, SLocBufferBlobAbbrv);
+      }
+
+      // Store the line offsets of the files that were read, so that the
+      // readers of the AST file don't need to scan them again to compute
+      // line numbers. They are stored as line lengths, which are small.
+      if (Content->OrigEntry && Content->getRawBuffer()) {
+        ArrayRef<unsigned> LineOffsets = SourceMgr.getLineOffsets(FID);
+        if (!LineOffsets.empty()) {
+          Record.clear();
+          Record.push_back(SM_SLOC_LINE_OFFSETS);
+          Record.push_back(Content->getSize());
+          for (unsigned L = 1, E = LineOffsets.size(); L != E; ++L)
+            Record.push_back(LineOffsets[L] - LineOffsets[L - 1]);
+          Stream.EmitRecordWithAbbrev(SLocLineOffsetsAbbrv, Record);
+        }
       }
     } else {
       // The source location entry is a macro expansion.
@@ -2386,7 +2610,7 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
       Record.push_back(Expansion.isExpansionTokenRange());
 
       // Compute the token length for this macro expansion.
-      unsigned NextOffset = SourceMgr.getNextLocalOffset();
+      SourceLocation::UIntTy NextOffset = SourceMgr.getNextLocalOffset();
       if (I + 1 != N)
         NextOffset = SourceMgr.getLocalSLocEntry(I + 1).getOffset();
       Record.push_back(NextOffset - SLoc->getOffset() - 1);
@@ -2546,7 +2770,7 @@ void ASTWriter::WritePreprocessor(const Preprocessor &PP, bool IsModule) {
       MacroIdentifiers.push_back(Id.second);
   // Sort the set of macro definitions that need to be serialized by the
   // name of the macro, to provide a stable ordering.
-  llvm::sort(MacroIdentifiers, llvm::deref<std::less<>>());
+  sortByName(MacroIdentifiers, PP.getPreprocessorOpts().ParallelASTWriting);
 
   // Emit the macro directives as a list and associate the offset with the
   // identifier they belong to.
@@ -3021,8 +3245,13 @@ void ASTWriter::WriteSubmodules(Module *WritingModule) {
     {
       auto TopHeaders = Mod->getTopHeaders(PP->getFileManager());
       RecordData::value_type Record[] = {SUBMODULE_TOPHEADER};
-      for (auto *H : TopHeaders)
-        Stream.EmitRecordWithBlob(TopHeaderAbbrev, Record, H->getName());
+      for (auto *H : TopHeaders) {
+        SmallString<128> Name(H->getName());
+        remapPathPrefix(
+            PP->getHeaderSearchInfo().getHeaderSearchOpts().ModuleFilePrefixMap,
+            Name);
+        Stream.EmitRecordWithBlob(TopHeaderAbbrev, Record, Name);
+      }
     }
 
     // Emit the imports.
@@ -3306,17 +3535,35 @@ void ASTWriter::WriteComments() {
   auto _ = llvm::make_scope_exit([this] { Stream.ExitBlock(); });
   if (!PP->getPreprocessorOpts().WriteCommentListToPCH)
     return;
+
+  // The comments of each file are stored in a blob, so that the readers only
+  // decode those of the files whose declarations they look the comments of.
+  auto Abbrev = std::make_shared<llvm::BitCodeAbbrev>();
+  Abbrev->Add(llvm::BitCodeAbbrevOp(COMMENTS_FILE));
+  Abbrev->Add(llvm::BitCodeAbbrevOp(llvm::BitCodeAbbrevOp::VBR, 6)); // Start
+  Abbrev->Add(llvm::BitCodeAbbrevOp(llvm::BitCodeAbbrevOp::Blob));
+  unsigned FileCommentsAbbrev = Stream.EmitAbbrev(std::move(Abbrev));
+
+  SourceManager &SourceMgr = Context->getSourceManager();
   RecordData Record;
+  SmallString<1024> Blob;
   for (const auto &FO : Context->Comments.OrderedComments) {
+    Blob.clear();
+    llvm::raw_svector_ostream OS(Blob);
+    llvm::support::endian::Writer W(OS, llvm::support::little);
     for (const auto &OC : FO.second) {
       const RawComment *I = OC.second;
-      Record.clear();
-      AddSourceRange(I->getSourceRange(), Record);
-      Record.push_back(I->getKind());
-      Record.push_back(I->isTrailingComment());
-      Record.push_back(I->isAlmostTrailingComment());
-      Stream.EmitRecord(COMMENTS_RAW_COMMENT, Record);
+      W.write<uint32_t>(OC.first);
+      W.write<uint32_t>(SourceMgr.getFileOffset(I->getEndLoc()) - OC.first);
+      W.write<uint8_t>(I->getKind());
+      W.write<uint8_t>(I->isTrailingComment() |
+                       I->isAlmostTrailingComment() << 1);
     }
+
+    Record.clear();
+    Record.push_back(COMMENTS_FILE);
+    AddSourceLocation(SourceMgr.getLocForStartOfFile(FO.first), Record);
+    Stream.EmitRecordWithBlob(FileCommentsAbbrev, Record, Blob);
   }
 }
 
@@ -3451,6 +3698,9 @@ void ASTWriter::WriteSelectors(Sema &SemaRef) {
   // Create and write out the blob that contains selectors and the method pool.
   {
     llvm::OnDiskChainedHashTableGenerator<ASTMethodPoolTrait> Generator;
+    // The names of the selectors in the table, which tell the global module
+    // index which module files to search for a selector.
+    std::string SelectorNames;
     ASTMethodPoolTrait Trait(*this);
 
     // Create the on-disk hash table representation. We walk through every
@@ -3491,6 +3741,8 @@ void ASTWriter::WriteSelectors(Sema &SemaRef) {
         ++NumTableEntries;
       }
       Generator.insert(S, Data, Trait);
+      SelectorNames += S.getAsString();
+      SelectorNames += '\0';
     }
 
     // Create the on-disk hash table in a buffer.
@@ -3521,6 +3773,16 @@ void ASTWriter::WriteSelectors(Sema &SemaRef) {
       Stream.EmitRecordWithBlob(MethodPoolAbbrev, Record, MethodPool);
     }
 
+    // Write the names of the selectors in the method pool.
+    Abbrev = std::make_shared<BitCodeAbbrev>();
+    Abbrev->Add(BitCodeAbbrevOp(METHOD_POOL_SELECTORS));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    unsigned SelectorNamesAbbrev = Stream.EmitAbbrev(std::move(Abbrev));
+    {
+      RecordData::value_type Record[] = {METHOD_POOL_SELECTORS};
+      Stream.EmitRecordWithBlob(SelectorNamesAbbrev, Record, SelectorNames);
+    }
+
     // Create a blob abbreviation for the selector table offsets.
     Abbrev = std::make_shared<BitCodeAbbrev>();
     Abbrev->Add(BitCodeAbbrevOp(SELECTOR_OFFSETS));
@@ -3788,7 +4050,7 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
       IIs.push_back(ID.second);
     // Sort the identifiers lexicographically before getting them references so
     // that their order is stable.
-    llvm::sort(IIs, llvm::deref<std::less<>>());
+    sortByName(IIs, PP.getPreprocessorOpts().ParallelASTWriting);
     for (const IdentifierInfo *II : IIs)
       if (Trait.isInterestingNonMacroIdentifier(II))
         getIdentifierRef(II);
@@ -4400,6 +4662,101 @@ void ASTWriter::WriteCUDAPragmas(Sema &SemaRef) {
   }
 }
 
+/// Write the layouts of the records that were laid out, so that the users of
+/// the AST file don't compute them again.
+///
+/// Each layout is preceded by the ID of the record and the size of the layout
+/// in the record, so that the reader only decodes the layouts it uses.
+void ASTWriter::WriteRecordLayouts(ASTContext &Context) {
+  // The declarations were all written, so the layouts of the records that
+  // refer to other declarations aren't written.
+  auto IsWritten = [&](const Decl *D) {
+    return !D || D->isFromASTFile() || DeclIDs.count(D);
+  };
+  SmallVector<std::pair<DeclID, const RecordDecl *>, 64> Records;
+  for (const auto &Entry : Context.ASTRecordLayouts) {
+    const RecordDecl *RD = Entry.first;
+    if (!Entry.second || RD->isFromASTFile() || !IsWritten(RD))
+      continue;
+    if (const auto *CXXRD = dyn_cast<CXXRecordDecl>(RD)) {
+      const ASTRecordLayout &Layout = *Entry.second;
+      if (!IsWritten(Layout.getPrimaryBase()) ||
+          !IsWritten(Layout.getBaseSharingVBPtr()) ||
+          llvm::any_of(CXXRD->bases(),
+                       [&](const CXXBaseSpecifier &Base) {
+                         return !IsWritten(Base.getType()->getAsCXXRecordDecl());
+                       }) ||
+          llvm::any_of(Layout.getVBaseOffsetsMap(), [&](const auto &VBase) {
+            return !IsWritten(VBase.first);
+          }))
+        continue;
+    }
+    Records.push_back({getDeclID(RD), RD});
+  }
+  if (Records.empty())
+    return;
+  // Sort by ID, since the order of the layouts in the ASTContext isn't
+  // deterministic.
+  llvm::sort(Records, llvm::less_first());
+
+  RecordData Record;
+  for (const auto &Entry : Records) {
+    const RecordDecl *RD = Entry.second;
+    const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
+    Record.push_back(Entry.first);
+    unsigned SizeIndex = Record.size();
+    Record.push_back(0);
+
+    Record.push_back(Layout.getSize().getQuantity());
+    Record.push_back(Layout.getDataSize().getQuantity());
+    Record.push_back(Layout.getAlignment().getQuantity());
+    Record.push_back(Layout.getUnadjustedAlignment().getQuantity());
+    Record.push_back(Layout.getRequiredAlignment().getQuantity());
+    Record.push_back(Layout.getFieldCount());
+    for (unsigned I = 0, N = Layout.getFieldCount(); I != N; ++I)
+      Record.push_back(Layout.getFieldOffset(I));
+
+    const auto *CXXRD = dyn_cast<CXXRecordDecl>(RD);
+    Record.push_back(CXXRD != nullptr);
+    if (CXXRD) {
+      Record.push_back(Layout.hasOwnVFPtr());
+      Record.push_back(Layout.hasExtendableVFPtr());
+      Record.push_back(Layout.getVBPtrOffset().getQuantity());
+      Record.push_back(Layout.getNonVirtualSize().getQuantity());
+      Record.push_back(Layout.getNonVirtualAlignment().getQuantity());
+      Record.push_back(Layout.getSizeOfLargestEmptySubobject().getQuantity());
+      AddDeclRef(Layout.getPrimaryBase(), Record);
+      Record.push_back(Layout.isPrimaryBaseVirtual());
+      AddDeclRef(Layout.getBaseSharingVBPtr(), Record);
+      Record.push_back(Layout.endsWithZeroSizedObject());
+      Record.push_back(Layout.leadsWithZeroSizedBase());
+
+      SmallVector<const CXXRecordDecl *, 4> Bases;
+      for (const CXXBaseSpecifier &Base : CXXRD->bases())
+        if (!Base.isVirtual())
+          Bases.push_back(Base.getType()->getAsCXXRecordDecl());
+      Record.push_back(Bases.size());
+      for (const CXXRecordDecl *Base : Bases) {
+        AddDeclRef(Base, Record);
+        Record.push_back(Layout.getBaseClassOffset(Base).getQuantity());
+      }
+
+      SmallVector<std::pair<DeclID, ASTRecordLayout::VBaseInfo>, 4> VBases;
+      for (const auto &VBase : Layout.getVBaseOffsetsMap())
+        VBases.push_back({getDeclID(VBase.first), VBase.second});
+      llvm::sort(VBases, llvm::less_first());
+      Record.push_back(VBases.size());
+      for (const auto &VBase : VBases) {
+        Record.push_back(VBase.first);
+        Record.push_back(VBase.second.VBaseOffset.getQuantity());
+        Record.push_back(VBase.second.hasVtorDisp());
+      }
+    }
+    Record[SizeIndex] = Record.size() - SizeIndex - 1;
+  }
+  Stream.EmitRecord(RECORD_LAYOUTS, Record);
+}
+
 void ASTWriter::WriteObjCCategories() {
   SmallVector<ObjCCategoriesInfo, 2> CategoriesMap;
   RecordData Categories;
@@ -4461,16 +4818,24 @@ void ASTWriter::WriteLateParsedTemplates(Sema &SemaRef) {
   RecordData Record;
   for (auto &LPTMapEntry : LPTMap) {
     const FunctionDecl *FD = LPTMapEntry.first;
+    // The templates whose bodies were parsed are written with their bodies.
+    if (!FD->isLateTemplateParsed())
+      continue;
+
     LateParsedTemplate &LPT = *LPTMapEntry.second;
     AddDeclRef(FD, Record);
     AddDeclRef(LPT.D, Record);
-    Record.push_back(LPT.Toks.size());
 
+    // The number of values of the tokens, which lets the reader skip them.
+    size_t NumValuesIdx = Record.size();
+    Record.push_back(0);
     for (const auto &Tok : LPT.Toks) {
       AddToken(Tok, Record);
     }
+    Record[NumValuesIdx] = Record.size() - NumValuesIdx - 1;
   }
-  Stream.EmitRecord(LATE_PARSED_TEMPLATE, Record);
+  if (!Record.empty())
+    Stream.EmitRecord(LATE_PARSED_TEMPLATE, Record);
 }
 
 /// Write the state of 'pragma clang optimize' at the end of the module.
@@ -4611,6 +4976,10 @@ bool ASTWriter::PreparePathForOutput(SmallVectorImpl<char> &Path) {
   if (PathPtr != PathBegin) {
     Path.erase(Path.begin(), Path.begin() + (PathPtr - PathBegin));
     Changed = true;
+  } else {
+    Changed |= remapPathPrefix(
+        PP->getHeaderSearchInfo().getHeaderSearchOpts().ModuleFilePrefixMap,
+        Path);
   }
 
   return Changed;
@@ -4695,6 +5064,7 @@ ASTFileSignature ASTWriter::WriteAST(Sema &SemaRef,
                                      Module *WritingModule, StringRef isysroot,
                                      bool hasErrors,
                                      bool ShouldCacheASTInMemory) {
+  llvm::TimeTraceScope TimeScope("WriteAST", StringRef(OutputFile));
   WritingAST = true;
 
   ASTHasCompilerErrors = hasErrors;
@@ -4736,6 +5106,21 @@ static void AddLazyVectorDecls(ASTWriter &Writer, Vector &Vec,
   }
 }
 
+/// Whether the template arguments of a concept satisfaction result can be
+/// written outside of a declaration or type record, i.e. whether they don't
+/// contain expressions.
+static bool
+isSerializableConceptArgumentList(ArrayRef<TemplateArgument> Args) {
+  for (const TemplateArgument &Arg : Args) {
+    if (Arg.getKind() == TemplateArgument::Expression)
+      return false;
+    if (Arg.getKind() == TemplateArgument::Pack &&
+        !isSerializableConceptArgumentList(Arg.pack_elements()))
+      return false;
+  }
+  return true;
+}
+
 ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
                                          const std::string &OutputFile,
                                          Module *WritingModule) {
@@ -4750,6 +5135,11 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   ASTContext &Context = SemaRef.Context;
   Preprocessor &PP = SemaRef.PP;
 
+  // The users of a PCH don't mark the identifiers they create as builtins,
+  // but take the identifiers of the builtins from the PCH instead.
+  if (!isModule)
+    PP.getBuiltinInfo().materializeBuiltins(PP.getIdentifierTable());
+
   // Set up predefined declaration IDs.
   auto RegisterPredefDecl = [&] (Decl *D, PredefinedDeclIDs ID) {
     if (D) {
@@ -4887,6 +5277,24 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
     }
   }
 
+  // Build a record containing the results of the concept satisfaction checks,
+  // so that the users of the AST file don't check the same constraints again.
+  RecordData ConceptSatisfactions;
+  {
+    ASTRecordWriter Record(*this, ConceptSatisfactions);
+    for (const Sema::ConceptSatisfactionEntry *Entry :
+         SemaRef.ConceptSatisfactions) {
+      if (Entry->isFromASTFile() ||
+          !isSerializableConceptArgumentList(Entry->getTemplateArgs()))
+        continue;
+      Record.AddDeclRef(Entry->getConcept());
+      Record.push_back(Entry->getTemplateArgs().size());
+      for (const TemplateArgument &Arg : Entry->getTemplateArgs())
+        Record.AddTemplateArgument(Arg);
+      Record.push_back(Entry->isSatisfied());
+    }
+  }
+
   // Write the control block
   WriteControlBlock(PP, Context, isysroot, OutputFile);
 
@@ -4971,7 +5379,7 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
         IIs.push_back(II);
     }
     // Sort the identifiers to visit based on their name.
-    llvm::sort(IIs, llvm::deref<std::less<>>());
+    sortByName(IIs, PP.getPreprocessorOpts().ParallelASTWriting);
     for (const IdentifierInfo *II : IIs) {
       for (IdentifierResolver::iterator D = SemaRef.IdResolver.begin(II),
                                      DEnd = SemaRef.IdResolver.end();
@@ -5058,7 +5466,11 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
 
         // These values should be unique within a chain, since they will be read
         // as keys into ContinuousRangeMaps.
-        writeBaseIDOrNone(M.SLocEntryBaseOffset, M.LocalNumSLocEntries);
+        // The source location offsets are as wide as the source locations.
+        LE.write<SourceLocation::UIntTy>(
+            M.LocalNumSLocEntries
+                ? M.SLocEntryBaseOffset
+                : std::numeric_limits<SourceLocation::UIntTy>::max());
         writeBaseIDOrNone(M.BaseIdentifierID, M.LocalNumIdentifiers);
         writeBaseIDOrNone(M.BaseMacroID, M.LocalNumMacros);
         writeBaseIDOrNone(M.BasePreprocessedEntityID,
@@ -5113,6 +5525,7 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   WriteOpenCLExtensions(SemaRef);
   WriteOpenCLExtensionTypes(SemaRef);
   WriteCUDAPragmas(SemaRef);
+  WriteRecordLayouts(Context);
 
   // If we're emitting a module, write out the submodule information.
   if (WritingModule)
@@ -5184,6 +5597,9 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   if (!DeleteExprsToAnalyze.empty())
     Stream.EmitRecord(DELETE_EXPRS_TO_ANALYZE, DeleteExprsToAnalyze);
 
+  if (!ConceptSatisfactions.empty())
+    Stream.EmitRecord(CONCEPT_SATISFACTIONS, ConceptSatisfactions);
+
   // Write the visible updates to DeclContexts.
   for (auto *DC : UpdatedDeclContexts)
     WriteDeclContextVisibleUpdate(DC);
@@ -5425,8 +5841,9 @@ void ASTWriter::WriteDeclUpdatesBlocks(RecordDataImpl &OffsetsRecord) {
 }
 
 void ASTWriter::AddSourceLocation(SourceLocation Loc, RecordDataImpl &Record) {
-  uint32_t Raw = Loc.getRawEncoding();
-  Record.push_back((Raw << 1) | (Raw >> 31));
+  constexpr unsigned Bits = 8 * sizeof(SourceLocation::UIntTy);
+  SourceLocation::UIntTy Raw = Loc.getRawEncoding();
+  Record.push_back((Raw << 1) | (Raw >> (Bits - 1)));
 }
 
 void ASTWriter::AddSourceRange(SourceRange Range, RecordDataImpl &Record) {
@@ -6191,7 +6608,10 @@ void ASTRecordWriter::AddCXXDefinitionData(const CXXRecordDecl *D) {
   #include "clang/AST/CXXRecordDeclDefinitionBits.def"
 
   // getODRHash will compute the ODRHash if it has not been previously computed.
-  Record->push_back(D->getODRHash());
+  // It is only compared when merging the definitions of modules.
+  bool HasODRHash = Writer->Context->getLangOpts().Modules;
+  Record->push_back(HasODRHash);
+  Record->push_back(HasODRHash ? D->getODRHash() : 0);
   bool ModulesDebugInfo = Writer->Context->getLangOpts().ModulesDebugInfo &&
                           Writer->WritingModule && !D->isDependentType();
   Record->push_back(ModulesDebugInfo);
@@ -699,6 +699,7 @@ void ASTStmtWriter::VisitMemberExpr(MemberExpr *E) {
        E->getFoundDecl().getAccess() != E->getMemberDecl()->getAccess());
   bool HasTemplateInfo = E->hasTemplateKWAndArgsInfo();
   unsigned NumTemplateArgs = E->getNumTemplateArgs();
+  bool HasMemberDNLoc = E->hasMemberDNLoc();
 
   // Write these first for easy access when deserializing, as they affect the
   // size of the MemberExpr.
@@ -706,11 +707,13 @@ void ASTStmtWriter::VisitMemberExpr(MemberExpr *E) {
   Record.push_back(HasFoundDecl);
   Record.push_back(HasTemplateInfo);
   Record.push_back(NumTemplateArgs);
+  Record.push_back(HasMemberDNLoc);
 
   Record.AddStmt(E->getBase());
   Record.AddDeclRef(E->getMemberDecl());
-  Record.AddDeclarationNameLoc(E->MemberDNLoc,
-                               E->getMemberDecl()->getDeclName());
+  if (HasMemberDNLoc)
+    Record.AddDeclarationNameLoc(*E->getTrailingObjects<DeclarationNameLoc>(),
+                                 E->getMemberDecl()->getDeclName());
   Record.AddSourceLocation(E->getMemberLoc());
   Record.push_back(E->isArrow());
   Record.push_back(E->hadMultipleCandidates());
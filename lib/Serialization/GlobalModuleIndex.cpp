@@ -52,7 +52,9 @@ namespace {
     /// Describes a module, including its file name and dependencies.
     MODULE,
     /// The index for identifiers.
-    IDENTIFIER_INDEX
+    IDENTIFIER_INDEX,
+    /// The index for the selectors of the Objective-C method pool.
+    SELECTOR_INDEX
   };
 }
 
@@ -60,7 +62,7 @@ namespace {
 static const char * const IndexFileName = "modules.idx";
 
 /// The global index file version.
-static const unsigned CurrentVersion = 1;
+static const unsigned CurrentVersion = 3;
 
 //----------------------------------------------------------------------------//
 // Global module index reader.
@@ -127,8 +129,9 @@ typedef llvm::OnDiskIterableChainedHashTable<IdentifierIndexReaderTrait>
 
 GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                                      llvm::BitstreamCursor Cursor)
-    : Buffer(std::move(Buffer)), IdentifierIndex(), NumIdentifierLookups(),
-      NumIdentifierLookupHits() {
+    : Buffer(std::move(Buffer)), IdentifierIndex(), SelectorIndex(),
+      NumIdentifierLookups(), NumIdentifierLookupHits(), NumSelectorLookups(),
+      NumSelectorLookupHits() {
   auto Fail = [&Buffer](llvm::Error &&Err) {
     report_fatal_error("Module index '" + Buffer->getBufferIdentifier() +
                        "' failed: " + toString(std::move(Err)));
@@ -218,6 +221,11 @@ GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                                       Record.begin() + Idx + NumDeps);
       Idx += NumDeps;
 
+      // Skip the signature of the module file and the size, modification
+      // time and signature its dependencies were imported with, which are
+      // only used when the index is rebuilt.
+      Idx += 5 + NumDeps * 7;
+
       // Make sure we're at the end of the record.
       assert(Idx == Record.size() && "More module info?");
 
@@ -240,12 +248,24 @@ GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
             (const unsigned char *)Blob.data(), IdentifierIndexReaderTrait());
       }
       break;
+
+    case SELECTOR_INDEX:
+      // Wire up the selector index, which maps the names of the selectors to
+      // module files the same way the identifier index does.
+      if (Record[0]) {
+        SelectorIndex = IdentifierIndexTable::Create(
+            (const unsigned char *)Blob.data() + Record[0],
+            (const unsigned char *)Blob.data() + sizeof(uint32_t),
+            (const unsigned char *)Blob.data(), IdentifierIndexReaderTrait());
+      }
+      break;
     }
   }
 }
 
 GlobalModuleIndex::~GlobalModuleIndex() {
   delete static_cast<IdentifierIndexTable *>(IdentifierIndex);
+  delete static_cast<IdentifierIndexTable *>(SelectorIndex);
 }
 
 std::pair<GlobalModuleIndex *, llvm::Error>
@@ -308,6 +328,12 @@ void GlobalModuleIndex::getModuleDependencies(
 }
 
 bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
+  return lookupIdentifier(Name, IdentifierIndexReaderTrait::ComputeHash(Name),
+                          Hits);
+}
+
+bool GlobalModuleIndex::lookupIdentifier(StringRef Name, unsigned NameHash,
+                                         HitSet &Hits) {
   Hits.clear();
 
   // If there's no identifier index, there is nothing we can do.
@@ -318,7 +344,7 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
   ++NumIdentifierLookups;
   IdentifierIndexTable &Table
     = *static_cast<IdentifierIndexTable *>(IdentifierIndex);
-  IdentifierIndexTable::iterator Known = Table.find(Name);
+  IdentifierIndexTable::iterator Known = Table.find_hashed(Name, NameHash);
   if (Known == Table.end()) {
     return true;
   }
@@ -333,6 +359,29 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
   return true;
 }
 
+bool GlobalModuleIndex::lookupSelector(StringRef Name, HitSet &Hits) {
+  Hits.clear();
+
+  // If there's no selector index, e.g. because some module file didn't
+  // record the names of its selectors, every module file has to be searched.
+  if (!SelectorIndex)
+    return false;
+
+  ++NumSelectorLookups;
+  IdentifierIndexTable &Table =
+      *static_cast<IdentifierIndexTable *>(SelectorIndex);
+  IdentifierIndexTable::iterator Known = Table.find(Name);
+  if (Known == Table.end())
+    return true;
+
+  for (unsigned ID : *Known)
+    if (ModuleFile *MF = Modules[ID].File)
+      Hits.insert(MF);
+
+  ++NumSelectorLookupHits;
+  return true;
+}
+
 bool GlobalModuleIndex::loadedModuleFile(ModuleFile *File) {
   // Look for the module in the global module index based on the module name.
   StringRef Name = File->ModuleName;
@@ -367,6 +416,11 @@ void GlobalModuleIndex::printStats() {
             NumIdentifierLookupHits, NumIdentifierLookups,
             (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumSelectorLookups) {
+    fprintf(stderr, "  %u / %u selector lookups succeeded (%f%%)\n",
+            NumSelectorLookupHits, NumSelectorLookups,
+            (double)NumSelectorLookupHits*100.0/NumSelectorLookups);
+  }
   std::fprintf(stderr, "\n");
 }
 
@@ -388,6 +442,14 @@ LLVM_DUMP_METHOD void GlobalModuleIndex::dump() {
 //----------------------------------------------------------------------------//
 
 namespace {
+  struct ImportedModuleFileInfo {
+    off_t StoredSize;
+    time_t StoredModTime;
+    ASTFileSignature StoredSignature;
+    ImportedModuleFileInfo(off_t Size, time_t ModTime, ASTFileSignature Sig)
+        : StoredSize(Size), StoredModTime(ModTime), StoredSignature(Sig) {}
+  };
+
   /// Provides information about a specific module file.
   struct ModuleFileInfo {
     /// The numberic ID for this module file.
@@ -396,15 +458,30 @@ namespace {
     /// The set of modules on which this module depends. Each entry is
     /// a module ID.
     SmallVector<unsigned, 4> Dependencies;
+
+    /// How each of the dependencies was imported, in the same order.
+    SmallVector<ImportedModuleFileInfo, 4> Imports;
+
     ASTFileSignature Signature;
   };
 
-  struct ImportedModuleFileInfo {
-    off_t StoredSize;
-    time_t StoredModTime;
-    ASTFileSignature StoredSignature;
-    ImportedModuleFileInfo(off_t Size, time_t ModTime, ASTFileSignature Sig)
-        : StoredSize(Size), StoredModTime(ModTime), StoredSignature(Sig) {}
+  /// The information about a module file that was recorded by a previous
+  /// build of the index.
+  struct IndexedModuleFileInfo {
+    off_t Size = 0;
+    time_t ModTime = 0;
+    std::string FileName;
+    ASTFileSignature Signature;
+
+    /// The dependencies of the module file, as IDs in the previous index.
+    SmallVector<unsigned, 4> Dependencies;
+    SmallVector<ImportedModuleFileInfo, 4> Imports;
+
+    /// The identifiers the module file considers interesting.
+    std::vector<StringRef> Identifiers;
+
+    /// The names of the selectors in the method pool of the module file.
+    std::vector<StringRef> Selectors;
   };
 
   /// Builder that generates the global module index file.
@@ -418,14 +495,6 @@ namespace {
     /// Information about each of the known module files.
     ModuleFilesMap ModuleFiles;
 
-    /// Mapping from the imported module file to the imported
-    /// information.
-    typedef std::multimap<const FileEntry *, ImportedModuleFileInfo>
-        ImportedModuleFilesMap;
-
-    /// Information about each importing of a module file.
-    ImportedModuleFilesMap ImportedModuleFiles;
-
     /// Mapping from identifiers to the list of module file IDs that
     /// consider this identifier to be interesting.
     typedef llvm::StringMap<SmallVector<unsigned, 2> > InterestingIdentifierMap;
@@ -434,6 +503,34 @@ namespace {
     /// files in which those identifiers are considered interesting.
     InterestingIdentifierMap InterestingIdentifiers;
 
+    /// A mapping from the names of the selectors in the method pools of the
+    /// module files to the IDs of those module files.
+    InterestingIdentifierMap InterestingSelectors;
+
+    /// Whether the names of the selectors of every module file with a method
+    /// pool are known, without which the selector index can't be written.
+    bool HasAllSelectors = true;
+
+    /// The previous version of the index, whose contents are reused for the
+    /// module files that did not change since it was built.
+    std::unique_ptr<llvm::MemoryBuffer> PreviousIndex;
+
+    /// The module files described by the previous index, by ID in that index.
+    std::vector<IndexedModuleFileInfo> IndexedModuleFiles;
+
+    /// The module files described by the previous index, by file name.
+    llvm::StringMap<unsigned> IndexedModuleFilesByName;
+
+    /// The identifiers of the previous index that no module file considers
+    /// interesting.
+    std::vector<StringRef> IndexedUninterestingIdentifiers;
+
+    /// Whether any module file was taken from the previous index.
+    bool ReusedIndexedModuleFile = false;
+
+    /// Whether the previous index has a selector index.
+    bool IndexedHasSelectors = false;
+
     /// Write the block-info block for the global module index file.
     void emitBlockInfoBlock(llvm::BitstreamWriter &Stream);
 
@@ -458,6 +555,17 @@ namespace {
     /// Load the contents of the given module file into the builder.
     llvm::Error loadModuleFile(const FileEntry *File);
 
+    /// Load the previous version of the index at \p IndexPath, so that the
+    /// module files that did not change can be taken from it by
+    /// \c reuseModuleFile() instead of being read again.
+    llvm::Error loadPreviousIndex(StringRef IndexPath);
+
+    /// Take the contents of the given module file from the previous index.
+    ///
+    /// \returns false if the module file is not in the previous index, or
+    /// changed since the previous index was built.
+    bool reuseModuleFile(const FileEntry *File);
+
     /// Write the index to the given bitstream.
     /// \returns true if an error occurred, false otherwise.
     bool writeIndex(llvm::BitstreamWriter &Stream);
@@ -500,6 +608,7 @@ GlobalModuleIndexBuilder::emitBlockInfoBlock(llvm::BitstreamWriter &Stream) {
   RECORD(INDEX_METADATA);
   RECORD(MODULE);
   RECORD(IDENTIFIER_INDEX);
+  RECORD(SELECTOR_INDEX);
 #undef RECORD
 #undef BLOCK
 
@@ -553,6 +662,7 @@ llvm::Error GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
 
   // Search for the blocks and records we care about.
   enum { Other, ControlBlock, ASTBlock, DiagnosticOptionsBlock } State = Other;
+  bool HasMethodPool = false, HasSelectors = false;
   bool Done = false;
   while (!Done) {
     Expected<llvm::BitstreamEntry> MaybeEntry = InStream.advance();
@@ -667,15 +777,13 @@ llvm::Error GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
                                          "imported file \"%s\" not found",
                                          ImportedFile.c_str());
 
-        // Save the information in ImportedModuleFileInfo so we can verify after
-        // loading all pcms.
-        ImportedModuleFiles.insert(std::make_pair(
-            *DependsOnFile, ImportedModuleFileInfo(StoredSize, StoredModTime,
-                                                   StoredSignature)));
-
-        // Record the dependency.
+        // Record the dependency, and save the information in
+        // ImportedModuleFileInfo so we can verify it after loading all pcms.
         unsigned DependsOnID = getModuleFileInfo(*DependsOnFile).ID;
-        getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+        ModuleFileInfo &Info = getModuleFileInfo(File);
+        Info.Dependencies.push_back(DependsOnID);
+        Info.Imports.push_back(
+            ImportedModuleFileInfo(StoredSize, StoredModTime, StoredSignature));
       }
 
       continue;
@@ -701,6 +809,17 @@ llvm::Error GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
       }
     }
 
+    // Handle the names of the selectors of the method pool.
+    if (State == ASTBlock && Code == METHOD_POOL)
+      HasMethodPool = true;
+    if (State == ASTBlock && Code == METHOD_POOL_SELECTORS) {
+      HasSelectors = true;
+      SmallVector<StringRef, 64> Names;
+      Blob.split(Names, '\0', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+      for (StringRef Name : Names)
+        InterestingSelectors[Name].push_back(ID);
+    }
+
     // Get Signature.
     if (State == DiagnosticOptionsBlock && Code == SIGNATURE)
       getModuleFileInfo(File).Signature = {
@@ -710,9 +829,261 @@ llvm::Error GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
     // We don't care about this record.
   }
 
+  // The module files written before the names of the selectors were, have
+  // to be searched for every selector.
+  if (HasMethodPool && !HasSelectors)
+    HasAllSelectors = false;
+
   return llvm::Error::success();
 }
 
+namespace {
+  /// Trait used to read all of the entries of the identifier index of a
+  /// previous build of the index.
+  class IndexedIdentifierTrait : public IdentifierIndexReaderTrait {
+  public:
+    /// The identifier and the IDs of the module files that consider it
+    /// interesting.
+    typedef std::pair<StringRef, SmallVector<unsigned, 2>> data_type;
+
+    static data_type ReadData(const internal_key_type &k,
+                              const unsigned char *d, unsigned DataLen) {
+      return std::make_pair(
+          k, IdentifierIndexReaderTrait::ReadData(k, d, DataLen));
+    }
+  };
+}
+
+llvm::Error GlobalModuleIndexBuilder::loadPreviousIndex(StringRef IndexPath) {
+  // Forget about anything read so far if the index turns out to be unusable,
+  // so that no module file is taken from it.
+  auto Fail = [this](llvm::Error &&Err) {
+    IndexedModuleFiles.clear();
+    IndexedModuleFilesByName.clear();
+    IndexedUninterestingIdentifiers.clear();
+    IndexedHasSelectors = false;
+    PreviousIndex.reset();
+    return std::move(Err);
+  };
+  auto Malformed = [] {
+    return llvm::createStringError(std::errc::illegal_byte_sequence,
+                                   "malformed global module index");
+  };
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
+      llvm::MemoryBuffer::getFile(IndexPath);
+  if (!BufferOrErr)
+    return llvm::errorCodeToError(BufferOrErr.getError());
+  PreviousIndex = std::move(BufferOrErr.get());
+
+  llvm::BitstreamCursor Cursor(*PreviousIndex);
+
+  // Sniff for the signature.
+  for (unsigned char C : {'B', 'C', 'G', 'I'}) {
+    if (Expected<llvm::SimpleBitstreamCursor::word_t> Res = Cursor.Read(8)) {
+      if (Res.get() != C)
+        return Fail(llvm::createStringError(std::errc::illegal_byte_sequence,
+                                            "expected signature BCGI"));
+    } else
+      return Fail(Res.takeError());
+  }
+
+  bool InGlobalIndexBlock = false;
+  bool Done = false;
+  while (!Done) {
+    Expected<llvm::BitstreamEntry> MaybeEntry = Cursor.advance();
+    if (!MaybeEntry)
+      return Fail(MaybeEntry.takeError());
+    llvm::BitstreamEntry Entry = MaybeEntry.get();
+
+    switch (Entry.Kind) {
+    case llvm::BitstreamEntry::Error:
+      return Fail(Malformed());
+
+    case llvm::BitstreamEntry::EndBlock:
+      if (!InGlobalIndexBlock)
+        return Fail(Malformed());
+      Done = true;
+      continue;
+
+    case llvm::BitstreamEntry::Record:
+      // Entries in the global index block are handled below.
+      if (!InGlobalIndexBlock)
+        return Fail(Malformed());
+      break;
+
+    case llvm::BitstreamEntry::SubBlock:
+      if (!InGlobalIndexBlock && Entry.ID == GLOBAL_INDEX_BLOCK_ID) {
+        if (llvm::Error Err = Cursor.EnterSubBlock(GLOBAL_INDEX_BLOCK_ID))
+          return Fail(std::move(Err));
+        InGlobalIndexBlock = true;
+      } else if (llvm::Error Err = Cursor.SkipBlock())
+        return Fail(std::move(Err));
+      continue;
+    }
+
+    SmallVector<uint64_t, 64> Record;
+    StringRef Blob;
+    Expected<unsigned> MaybeIndexRecord =
+        Cursor.readRecord(Entry.ID, Record, &Blob);
+    if (!MaybeIndexRecord)
+      return Fail(MaybeIndexRecord.takeError());
+    switch (MaybeIndexRecord.get()) {
+    case INDEX_METADATA:
+      if (Record.size() < 1 || Record[0] != CurrentVersion)
+        return Fail(llvm::createStringError(
+            std::errc::not_supported, "unsupported global module index"));
+      break;
+
+    case MODULE: {
+      // ID, size, modification time, file name, dependencies, signature and
+      // the size, modification time and signature of each dependency.
+      if (Record.size() < 4)
+        return Fail(Malformed());
+      unsigned NameLen = Record[3];
+      if (Record.size() < 5 + NameLen)
+        return Fail(Malformed());
+      unsigned NumDeps = Record[4 + NameLen];
+      if (Record.size() != 10 + NameLen + 8 * NumDeps)
+        return Fail(Malformed());
+
+      unsigned Idx = 0;
+      unsigned ID = Record[Idx++];
+      if (ID >= IndexedModuleFiles.size())
+        IndexedModuleFiles.resize(ID + 1);
+      IndexedModuleFileInfo &Info = IndexedModuleFiles[ID];
+      Info.Size = Record[Idx++];
+      Info.ModTime = Record[Idx++];
+      ++Idx;
+      Info.FileName.assign(Record.begin() + Idx, Record.begin() + Idx + NameLen);
+      Idx += NameLen + 1;
+      Info.Dependencies.append(Record.begin() + Idx,
+                               Record.begin() + Idx + NumDeps);
+      Idx += NumDeps;
+
+      auto ReadSignature = [&] {
+        ASTFileSignature Signature;
+        for (uint32_t &Word : Signature)
+          Word = Record[Idx++];
+        return Signature;
+      };
+      Info.Signature = ReadSignature();
+      for (unsigned I = 0; I != NumDeps; ++I) {
+        off_t StoredSize = (off_t)Record[Idx++];
+        time_t StoredModTime = (time_t)Record[Idx++];
+        ASTFileSignature StoredSignature = ReadSignature();
+        Info.Imports.push_back(ImportedModuleFileInfo(
+            StoredSize, StoredModTime, StoredSignature));
+      }
+
+      IndexedModuleFilesByName[Info.FileName] = ID;
+      break;
+    }
+
+    case IDENTIFIER_INDEX: {
+      // The identifier index follows all of the module records, so the
+      // identifiers can be attributed to the module files right away.
+      if (Record.empty())
+        return Fail(Malformed());
+      if (!Record[0])
+        break;
+      typedef llvm::OnDiskIterableChainedHashTable<IndexedIdentifierTrait>
+          IndexedIdentifierTable;
+      std::unique_ptr<IndexedIdentifierTable> Table(
+          IndexedIdentifierTable::Create(
+              (const unsigned char *)Blob.data() + Record[0],
+              (const unsigned char *)Blob.data() + sizeof(uint32_t),
+              (const unsigned char *)Blob.data()));
+      for (IndexedIdentifierTable::data_iterator D = Table->data_begin(),
+                                                 DEnd = Table->data_end();
+           D != DEnd; ++D) {
+        IndexedIdentifierTrait::data_type Ident = *D;
+        if (Ident.second.empty())
+          IndexedUninterestingIdentifiers.push_back(Ident.first);
+        for (unsigned ID : Ident.second)
+          if (ID < IndexedModuleFiles.size())
+            IndexedModuleFiles[ID].Identifiers.push_back(Ident.first);
+      }
+      break;
+    }
+
+    case SELECTOR_INDEX: {
+      if (Record.empty())
+        return Fail(Malformed());
+      IndexedHasSelectors = true;
+      if (!Record[0])
+        break;
+      typedef llvm::OnDiskIterableChainedHashTable<IndexedIdentifierTrait>
+          IndexedSelectorTable;
+      std::unique_ptr<IndexedSelectorTable> Table(IndexedSelectorTable::Create(
+          (const unsigned char *)Blob.data() + Record[0],
+          (const unsigned char *)Blob.data() + sizeof(uint32_t),
+          (const unsigned char *)Blob.data()));
+      for (IndexedSelectorTable::data_iterator D = Table->data_begin(),
+                                               DEnd = Table->data_end();
+           D != DEnd; ++D) {
+        IndexedIdentifierTrait::data_type Sel = *D;
+        for (unsigned ID : Sel.second)
+          if (ID < IndexedModuleFiles.size())
+            IndexedModuleFiles[ID].Selectors.push_back(Sel.first);
+      }
+      break;
+    }
+    }
+  }
+
+  return llvm::Error::success();
+}
+
+bool GlobalModuleIndexBuilder::reuseModuleFile(const FileEntry *File) {
+  llvm::StringMap<unsigned>::iterator Known =
+      IndexedModuleFilesByName.find(File->getName());
+  if (Known == IndexedModuleFilesByName.end())
+    return false;
+
+  // If the size or modification time changed, the module file has to be
+  // read again.
+  const IndexedModuleFileInfo &Indexed = IndexedModuleFiles[Known->second];
+  if (Indexed.Size != File->getSize() ||
+      Indexed.ModTime != File->getModificationTime())
+    return false;
+
+  // Find the dependencies before recording anything, so that the module file
+  // can still be read instead if one of them is gone.
+  SmallVector<const FileEntry *, 4> DependsOnFiles;
+  for (unsigned DependsOnIndexedID : Indexed.Dependencies) {
+    if (DependsOnIndexedID >= IndexedModuleFiles.size())
+      return false;
+    auto DependsOnFile =
+        FileMgr.getFile(IndexedModuleFiles[DependsOnIndexedID].FileName,
+                        /*OpenFile=*/false, /*CacheFailure=*/false);
+    if (!DependsOnFile)
+      return false;
+    DependsOnFiles.push_back(*DependsOnFile);
+  }
+
+  // Record this module file and its dependencies the same way
+  // loadModuleFile() would have.
+  unsigned ID = getModuleFileInfo(File).ID;
+  for (const FileEntry *DependsOnFile : DependsOnFiles) {
+    unsigned DependsOnID = getModuleFileInfo(DependsOnFile).ID;
+    getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+  }
+  ModuleFileInfo &Info = getModuleFileInfo(File);
+  Info.Imports = Indexed.Imports;
+  Info.Signature = Indexed.Signature;
+
+  for (StringRef Name : Indexed.Identifiers)
+    InterestingIdentifiers[Name].push_back(ID);
+  for (StringRef Name : Indexed.Selectors)
+    InterestingSelectors[Name].push_back(ID);
+  if (!IndexedHasSelectors)
+    HasAllSelectors = false;
+
+  ReusedIndexedModuleFile = true;
+  return true;
+}
+
 namespace {
 
 /// Trait used to generate the identifier index as an on-disk hash
@@ -756,19 +1127,31 @@ public:
 }
 
 bool GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
-  for (auto MapEntry : ImportedModuleFiles) {
-    auto *File = MapEntry.first;
-    ImportedModuleFileInfo &Info = MapEntry.second;
-    if (getModuleFileInfo(File).Signature) {
-      if (getModuleFileInfo(File).Signature != Info.StoredSignature)
-        // Verify Signature.
+  for (auto &MapEntry : ModuleFiles) {
+    ModuleFileInfo &Importer = MapEntry.second;
+    for (unsigned I = 0, N = Importer.Dependencies.size(); I != N; ++I) {
+      // Module IDs are assigned in insertion order.
+      auto &Imported = *(ModuleFiles.begin() + Importer.Dependencies[I]);
+      const FileEntry *File = Imported.first;
+      ImportedModuleFileInfo &Info = Importer.Imports[I];
+      if (Imported.second.Signature) {
+        if (Imported.second.Signature != Info.StoredSignature)
+          // Verify Signature.
+          return true;
+      } else if (Info.StoredSize != File->getSize() ||
+                 Info.StoredModTime != File->getModificationTime())
+        // Verify Size and ModTime.
         return true;
-    } else if (Info.StoredSize != File->getSize() ||
-               Info.StoredModTime != File->getModificationTime())
-      // Verify Size and ModTime.
-      return true;
+    }
   }
 
+  // The identifiers of the previous index that no module file considers
+  // interesting can't be attributed to a module file, so keep all of them
+  // whenever part of the previous index is kept.
+  if (ReusedIndexedModuleFile)
+    for (StringRef Name : IndexedUninterestingIdentifiers)
+      (void)InterestingIdentifiers[Name];
+
   using namespace llvm;
   llvm::TimeTraceScope TimeScope("Module WriteIndex", StringRef(""));
 
@@ -806,6 +1189,16 @@ bool GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
     // Dependencies
     Record.push_back(M->second.Dependencies.size());
     Record.append(M->second.Dependencies.begin(), M->second.Dependencies.end());
+
+    // Signature, and how the dependencies were imported, so that the next
+    // build of the index can reuse this record if the file doesn't change.
+    Record.append(M->second.Signature.begin(), M->second.Signature.end());
+    for (const ImportedModuleFileInfo &Import : M->second.Imports) {
+      Record.push_back(Import.StoredSize);
+      Record.push_back(Import.StoredModTime);
+      Record.append(Import.StoredSignature.begin(),
+                    Import.StoredSignature.end());
+    }
     Stream.EmitRecord(MODULE, Record);
   }
 
@@ -844,6 +1237,34 @@ bool GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
     Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable);
   }
 
+  // Write the selector -> module file mapping, if every module file told
+  // which selectors it has.
+  if (HasAllSelectors) {
+    llvm::OnDiskChainedHashTableGenerator<IdentifierIndexWriterTrait> Generator;
+    IdentifierIndexWriterTrait Trait;
+    for (auto &Sel : InterestingSelectors)
+      Generator.insert(Sel.first(), Sel.second, Trait);
+
+    SmallString<4096> SelectorTable;
+    uint32_t BucketOffset;
+    {
+      using namespace llvm::support;
+      llvm::raw_svector_ostream Out(SelectorTable);
+      // Make sure that no bucket is at offset 0
+      endian::write<uint32_t>(Out, 0, little);
+      BucketOffset = Generator.Emit(Out, Trait);
+    }
+
+    auto Abbrev = std::make_shared<BitCodeAbbrev>();
+    Abbrev->Add(BitCodeAbbrevOp(SELECTOR_INDEX));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    unsigned SelTableAbbrev = Stream.EmitAbbrev(std::move(Abbrev));
+
+    uint64_t Record[] = {SELECTOR_INDEX, BucketOffset};
+    Stream.EmitRecordWithBlob(SelTableAbbrev, Record, SelectorTable);
+  }
+
   Stream.ExitBlock();
   return false;
 }
@@ -877,6 +1298,11 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
   // The module index builder.
   GlobalModuleIndexBuilder Builder(FileMgr, PCHContainerRdr);
 
+  // Start from the previous index, if there is a usable one, so that only the
+  // module files that changed since it was built have to be read.
+  if (llvm::Error Err = Builder.loadPreviousIndex(IndexPath))
+    llvm::consumeError(std::move(Err));
+
   // Load each of the module files.
   std::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
@@ -899,7 +1325,10 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
     if (!ModuleFile)
       continue;
 
-    // Load this module file.
+    // Load this module file, unless it's unchanged since the previous index
+    // was built.
+    if (Builder.reuseModuleFile(*ModuleFile))
+      continue;
     if (llvm::Error Err = Builder.loadModuleFile(*ModuleFile))
       return Err;
   }
@@ -40,6 +40,20 @@ InMemoryModuleCache::addBuiltPCM(llvm::StringRef Filename,
   return *PCM.Buffer;
 }
 
+bool InMemoryModuleCache::replaceBuiltPCM(
+    llvm::StringRef Filename, std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  auto I = PCMs.find(Filename);
+  assert(I != PCMs.end() && "PCM to replace is unknown...");
+
+  auto &PCM = I->second;
+  assert(PCM.IsFinal && "Trying to replace a PCM that wasn't built?");
+  if (PCM.Buffer->getBuffer() != Buffer->getBuffer())
+    return false;
+
+  PCM.Buffer = std::move(Buffer);
+  return true;
+}
+
 llvm::MemoryBuffer *
 InMemoryModuleCache::lookupPCM(llvm::StringRef Filename) const {
   auto I = PCMs.find(Filename);
@@ -16,12 +16,32 @@
 #include "clang/Serialization/ContinuousRangeMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace serialization;
 using namespace reader;
 
+const char *
+serialization::getDeserializationReasonName(DeserializationReason Reason) {
+  switch (Reason) {
+  case DR_Other:
+    return "other";
+  case DR_IdentifierLookup:
+    return "identifier lookup";
+  case DR_DeclContextLookup:
+    return "DeclContext lookup";
+  case DR_UpdateRecord:
+    return "update record";
+  case DR_EagerDecl:
+    return "eager";
+  case NUM_DESERIALIZATION_REASONS:
+    break;
+  }
+  llvm_unreachable("unknown deserialization reason");
+}
+
 ModuleFile::~ModuleFile() {
   delete static_cast<ASTIdentifierLookupTable *>(IdentifierLookupTable);
   delete static_cast<HeaderFileInfoLookupTable *>(HeaderFileInfoTable);
@@ -31,6 +31,7 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <algorithm>
 #include <cassert>
@@ -108,6 +109,7 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
                          ASTFileSignatureReader ReadSignature,
                          ModuleFile *&Module,
                          std::string &ErrorStr) {
+  llvm::TimeTraceScope TimeScope("Module AddFile", FileName);
   Module = nullptr;
 
   // Look for the file entry. This only fails if the expected size or
@@ -184,8 +186,11 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
     if (FileName == "-") {
       Buf = llvm::MemoryBuffer::getSTDIN();
     } else {
-      // Get a buffer of the file and close the file descriptor when done.
-      Buf = FileMgr.getBufferForFile(NewModule->File, /*isVolatile=*/false);
+      // Get a buffer of the file and close the file descriptor when done. The
+      // bitstream reader doesn't need a null terminator, so that the file can
+      // be memory mapped and only the blocks that get read are paged in.
+      Buf = FileMgr.getBufferForFile(NewModule->File, /*isVolatile=*/false,
+                                     /*RequiresNullTerminator=*/false);
     }
 
     if (!Buf) {
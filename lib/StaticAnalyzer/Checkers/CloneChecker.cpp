@@ -8,18 +8,25 @@
 ///
 /// \file
 /// CloneChecker is a checker that reports clones in the current translation
-/// unit.
+/// unit. It can also write the fingerprints of the translation unit's code to
+/// a directory, in which utils/analyzer/MergeCloneFingerprints.py finds the
+/// clones between translation units.
 ///
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Checkers/BuiltinCheckerRegistration.h"
 #include "clang/Analysis/CloneDetection.h"
 #include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
@@ -32,6 +39,7 @@ public:
   int MinComplexity;
   bool ReportNormalClones;
   StringRef IgnoredFilesPattern;
+  StringRef FingerprintDirectory;
 
 private:
   mutable CloneDetector Detector;
@@ -53,6 +61,10 @@ public:
   void reportSuspiciousClones(
       BugReporter &BR, AnalysisManager &Mgr,
       std::vector<CloneDetector::CloneGroup> &CloneGroups) const;
+
+  /// Writes the hash and the location of every sequence that is complex
+  /// enough to a new file in FingerprintDirectory.
+  void writeFingerprints(AnalysisManager &Mgr) const;
 };
 } // end anonymous namespace
 
@@ -69,6 +81,9 @@ void CloneChecker::checkEndOfTranslationUnit(const TranslationUnitDecl *TU,
   // At this point, every statement in the translation unit has been analyzed by
   // the CloneDetector. The only thing left to do is to report the found clones.
 
+  if (!FingerprintDirectory.empty())
+    writeFingerprints(Mgr);
+
   // Let the CloneDetector create a list of clones from all the analyzed
   // statements. We don't filter for matching variable patterns at this point
   // because reportSuspiciousClones() wants to search them for errors.
@@ -96,6 +111,48 @@ void CloneChecker::checkEndOfTranslationUnit(const TranslationUnitDecl *TU,
   reportClones(BR, Mgr, AllCloneGroups);
 }
 
+void CloneChecker::writeFingerprints(AnalysisManager &Mgr) const {
+  // The clones in other translation units are not known yet, so a sequence
+  // does not need a clone here to be written.
+  std::vector<CloneDetector::CloneGroup> Groups;
+  Detector.findClones(Groups, FilenamePatternConstraint(IgnoredFilesPattern),
+                      RecursiveCloneTypeIIHashConstraint(),
+                      MinComplexityConstraint(MinComplexity));
+
+  int FD;
+  SmallString<128> Path;
+  SmallString<128> Model(FingerprintDirectory);
+  llvm::sys::path::append(Model, "clones-%%%%%%%%.txt");
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(Model, FD, Path)) {
+    llvm::errs() << "warning: could not create file '" << Model
+                 << "': " << EC.message() << '\n';
+    return;
+  }
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+
+  // One line per sequence: the hash, the file and the range of the sequence.
+  const SourceManager &SM = Mgr.getASTContext().getSourceManager();
+  for (const CloneDetector::CloneGroup &Group : Groups) {
+    if (Group.empty())
+      continue;
+    size_t Hash = RecursiveCloneTypeIIHashConstraint::getHash(Group.front());
+    for (const StmtSequence &S : Group) {
+      SourceLocation Begin = SM.getExpansionLoc(S.getBeginLoc());
+      SourceLocation End = SM.getExpansionLoc(S.getEndLoc());
+      const FileEntry *File = SM.getFileEntryForID(SM.getFileID(Begin));
+      if (!File)
+        continue;
+      StringRef Name = File->tryGetRealPathName();
+      OS << llvm::format_hex_no_prefix(Hash, 16) << '\t'
+         << (Name.empty() ? File->getName() : Name) << '\t'
+         << SM.getExpansionLineNumber(Begin) << '\t'
+         << SM.getExpansionColumnNumber(Begin) << '\t'
+         << SM.getExpansionLineNumber(End) << '\t'
+         << SM.getExpansionColumnNumber(End) << '\n';
+    }
+  }
+}
+
 static PathDiagnosticLocation makeLocation(const StmtSequence &S,
                                            AnalysisManager &Mgr) {
   ASTContext &ACtx = Mgr.getASTContext();
@@ -206,6 +263,9 @@ void ento::registerCloneChecker(CheckerManager &Mgr) {
 
   Checker->IgnoredFilesPattern = Mgr.getAnalyzerOptions()
     .getCheckerStringOption(Checker, "IgnoredFilesPattern");
+
+  Checker->FingerprintDirectory = Mgr.getAnalyzerOptions()
+    .getCheckerStringOption(Checker, "FingerprintDirectory");
 }
 
 bool ento::shouldRegisterCloneChecker(const LangOptions &LO) {
@@ -237,7 +237,8 @@ public:
   void checkASTDecl(const TranslationUnitDecl *TU, AnalysisManager& mgr,
                     BugReporter &BR) const {
     CallGraph CG;
-    CG.addToCallGraph(const_cast<TranslationUnitDecl*>(TU));
+    Decl *D = const_cast<TranslationUnitDecl *>(TU);
+    CG.addToCallGraph(D, mgr.getAnalyzerOptions().CallGraphThreads);
     CG.dump();
   }
 };
@@ -7,6 +7,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "clang/StaticAnalyzer/Core/BugReporter/BugReporterVisitors.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace clang;
 using namespace ento;
@@ -43,6 +45,17 @@ AnalysisManager::AnalysisManager(ASTContext &ASTCtx,
       CreateConstraintMgr(constraintmgr), CheckerMgr(checkerMgr),
       options(Options) {
   AnaCtxMgr.getCFGBuildOptions().setAllAlwaysAdd();
+
+  if (!Options.SuppressedIssueHashesFile.empty()) {
+    if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+            llvm::MemoryBuffer::getFile(Options.SuppressedIssueHashesFile)) {
+      SmallVector<StringRef, 32> Lines;
+      (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                   /*KeepEmpty=*/false);
+      for (StringRef Line : Lines)
+        SuppressedIssueHashes.insert(Line.trim());
+    }
+  }
 }
 
 AnalysisManager::~AnalysisManager() {
@@ -53,6 +66,12 @@ AnalysisManager::~AnalysisManager() {
   }
 }
 
+RefutationCache &AnalysisManager::getRefutationCache() {
+  if (!Refutations)
+    Refutations = std::make_unique<RefutationCache>();
+  return *Refutations;
+}
+
 void AnalysisManager::FlushDiagnostics() {
   PathDiagnosticConsumer::FilesMade filesMade;
   for (PathDiagnosticConsumers::iterator I = PathConsumers.begin(),
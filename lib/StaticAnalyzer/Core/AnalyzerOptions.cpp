@@ -76,6 +76,8 @@ AnalyzerOptions::getExplorationStrategy() const {
                 ExplorationStrategyKind::UnexploredFirstLocationQueue)
           .Case("bfs_block_dfs_contents",
                 ExplorationStrategyKind::BFSBlockDFSContents)
+          .Case("coverage_gain_queue",
+                ExplorationStrategyKind::CoverageGainQueue)
           .Default(None);
   assert(K.hasValue() && "User mode is invalid.");
   return K.getValue();
@@ -34,6 +34,7 @@
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
+#include "clang/StaticAnalyzer/Core/IssueHash.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/MemRegion.h"
@@ -80,6 +81,8 @@ STATISTIC(MaxBugClassSize,
 STATISTIC(MaxValidBugClassSize,
           "The maximum number of bug reports in the same equivalence class "
           "where at least one report is valid (not suppressed)");
+STATISTIC(NumSuppressedIssues,
+          "The # of reports dropped because their issue hash is suppressed");
 
 BugReporterVisitor::~BugReporterVisitor() = default;
 
@@ -2985,12 +2988,39 @@ BugReport *PathSensitiveBugReporter::findReportInEquivalenceClass(
   return exampleReport;
 }
 
+bool BugReporter::isSuppressedIssue(const BugReport &R) {
+  const llvm::StringSet<> *Suppressed = D.getSuppressedIssueHashes();
+  if (!Suppressed)
+    return false;
+
+  // This is the hash the plist and HTML outputs compute from the path
+  // diagnostic of the report.
+  const SourceManager &SM = getSourceManager();
+  PathDiagnosticLocation UniqueingLoc = R.getUniqueingLocation();
+  FullSourceLoc L(SM.getExpansionLoc(UniqueingLoc.isValid()
+                                         ? UniqueingLoc.asLocation()
+                                         : R.getLocation().asLocation()),
+                  SM);
+  const BugType &BT = R.getBugType();
+  return Suppressed->count(GetIssueHash(SM, L, BT.getCheckerName(),
+                                        BT.getDescription(),
+                                        R.getDeclWithIssue(),
+                                        getContext().getLangOpts()));
+}
+
 void BugReporter::FlushReport(BugReportEquivClass& EQ) {
   SmallVector<BugReport*, 10> bugReports;
   BugReport *report = findReportInEquivalenceClass(EQ, bugReports);
   if (!report)
     return;
 
+  // Don't run the visitors and construct the path of a report which would be
+  // dropped anyway.
+  if (isSuppressedIssue(*report)) {
+    NumSuppressedIssues++;
+    return;
+  }
+
   ArrayRef<PathDiagnosticConsumer*> Consumers = getPathDiagnosticConsumers();
   std::unique_ptr<DiagnosticForConsumerMapTy> Diagnostics =
       generateDiagnosticForConsumerMap(report, Consumers, bugReports);
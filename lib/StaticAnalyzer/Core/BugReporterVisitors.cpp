@@ -53,6 +53,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
@@ -2813,39 +2814,76 @@ UndefOrNullArgVisitor::VisitNode(const ExplodedNode *N, BugReporterContext &BRC,
 // Implementation of FalsePositiveRefutationBRVisitor.
 //===----------------------------------------------------------------------===//
 
-FalsePositiveRefutationBRVisitor::FalsePositiveRefutationBRVisitor()
-    : Constraints(ConstraintRangeTy::Factory().getEmptyMap()) {}
+#define DEBUG_TYPE "BugReporterVisitors"
+STATISTIC(NumRefutationQueries,
+          "The # of constraint sets checked to refute reports");
+STATISTIC(NumRefutationCacheHits,
+          "The # of constraint sets whose refutation was already known");
 
-void FalsePositiveRefutationBRVisitor::finalizeVisitor(
-    BugReporterContext &BRC, const ExplodedNode *EndPathNode,
-    PathSensitiveBugReport &BR) {
-  // Collect new constraints
-  VisitNode(EndPathNode, BRC, BR);
+RefutationCache::RefutationCache() : Solver(llvm::CreateZ3Solver()) {}
+
+RefutationCache::~RefutationCache() {}
 
-  // Create a refutation manager
-  llvm::SMTSolverRef RefutationSolver = llvm::CreateZ3Solver();
-  ASTContext &Ctx = BRC.getASTContext();
+Optional<bool>
+RefutationCache::isSatisfiable(const ConstraintRangeTy &Constraints,
+                               ASTContext &Ctx) {
+  ++NumRefutationQueries;
 
-  // Add constraints to the solver
+  // Build the expressions of the constraints, and their text to look up the
+  // result of the same constraints.
+  SmallVector<llvm::SMTExprRef, 16> Exprs;
+  std::string Key;
+  llvm::raw_string_ostream KeyOS(Key);
   for (const auto &I : Constraints) {
     const SymbolRef Sym = I.first;
     auto RangeIt = I.second.begin();
 
-    llvm::SMTExprRef Constraints = SMTConv::getRangeExpr(
-        RefutationSolver, Ctx, Sym, RangeIt->From(), RangeIt->To(),
-        /*InRange=*/true);
+    llvm::SMTExprRef Expr = SMTConv::getRangeExpr(
+        Solver, Ctx, Sym, RangeIt->From(), RangeIt->To(), /*InRange=*/true);
     while ((++RangeIt) != I.second.end()) {
-      Constraints = RefutationSolver->mkOr(
-          Constraints, SMTConv::getRangeExpr(RefutationSolver, Ctx, Sym,
-                                             RangeIt->From(), RangeIt->To(),
-                                             /*InRange=*/true));
+      Expr = Solver->mkOr(Expr, SMTConv::getRangeExpr(Solver, Ctx, Sym,
+                                                      RangeIt->From(),
+                                                      RangeIt->To(),
+                                                      /*InRange=*/true));
     }
 
-    RefutationSolver->addConstraint(Constraints);
+    Expr->print(KeyOS);
+    KeyOS << '\n';
+    Exprs.push_back(Expr);
   }
+  KeyOS.flush();
+
+  auto Cached = Results.find(Key);
+  if (Cached != Results.end()) {
+    ++NumRefutationCacheHits;
+    return Cached->second;
+  }
+
+  Solver->push();
+  for (const llvm::SMTExprRef &Expr : Exprs)
+    Solver->addConstraint(Expr);
+  Optional<bool> IsSat = Solver->check();
+  Solver->pop();
+
+  Results[Key] = IsSat;
+  return IsSat;
+}
+
+FalsePositiveRefutationBRVisitor::FalsePositiveRefutationBRVisitor()
+    : Constraints(ConstraintRangeTy::Factory().getEmptyMap()) {}
+
+void FalsePositiveRefutationBRVisitor::finalizeVisitor(
+    BugReporterContext &BRC, const ExplodedNode *EndPathNode,
+    PathSensitiveBugReport &BR) {
+  // Collect new constraints
+  VisitNode(EndPathNode, BRC, BR);
 
-  // And check for satisfiability
-  Optional<bool> isSat = RefutationSolver->check();
+  // And check for satisfiability, with the solver and the results of the
+  // translation unit.
+  Optional<bool> isSat = EndPathNode->getState()
+                             ->getAnalysisManager()
+                             .getRefutationCache()
+                             .isSatisfiable(Constraints, BRC.getASTContext());
   if (!isSat.hasValue())
     return;
 
@@ -24,8 +24,11 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
 #include <cassert>
 #include <vector>
 
@@ -58,6 +61,70 @@ void CheckerManager::finishedCheckerRegistration() {
     assert(Event.second.HasDispatcher &&
            "No dispatcher registered for an event");
 #endif
+
+  if (AOptions.AnalyzerCheckerTiming)
+    CheckerTimerGroup = std::make_unique<llvm::TimerGroup>(
+        "checkers", "Analyzer checker timers");
+  ShouldProfileCheckers = !AOptions.CheckerProfileFile.empty();
+}
+
+llvm::Timer *CheckerManager::getCheckerTimer(const CheckerBase *Checker) {
+  if (!CheckerTimerGroup)
+    return nullptr;
+  std::unique_ptr<llvm::Timer> &Timer = CheckerTimers[Checker];
+  if (!Timer) {
+    StringRef Name = Checker->getCheckerName().getName();
+    Timer = std::make_unique<llvm::Timer>(Name, Name, *CheckerTimerGroup);
+  }
+  return Timer.get();
+}
+
+CheckerManager::CheckerProfile *
+CheckerManager::getCheckerProfile(const CheckerBase *Checker) {
+  if (!ShouldProfileCheckers)
+    return nullptr;
+  std::unique_ptr<CheckerProfile> &Profile = CheckerProfiles[Checker];
+  if (!Profile)
+    Profile = std::make_unique<CheckerProfile>();
+  return Profile.get();
+}
+
+void CheckerManager::writeCheckerProfile(raw_ostream &OS) const {
+  using namespace std::chrono;
+
+  // Several checkers may be implemented by the same checker object.
+  llvm::StringMap<CheckerProfile> ByName;
+  for (const auto &I : CheckerProfiles) {
+    CheckerProfile &Entry = ByName[I.first->getCheckerName().getName()];
+    Entry.NumCallbacks += I.second->NumCallbacks;
+    Entry.Time += I.second->Time;
+    Entry.NumNodes += I.second->NumNodes;
+    Entry.NumStates += I.second->NumStates;
+  }
+
+  std::vector<const llvm::StringMapEntry<CheckerProfile> *> Sorted;
+  for (const auto &Entry : ByName)
+    Sorted.push_back(&Entry);
+  llvm::sort(Sorted, [](const auto *LHS, const auto *RHS) {
+    return LHS->getValue().Time > RHS->getValue().Time;
+  });
+
+  llvm::json::Array Checkers;
+  for (const auto *Entry : Sorted) {
+    const CheckerProfile &Profile = Entry->getValue();
+    Checkers.push_back(llvm::json::Object{
+        {"name", Entry->getKey()},
+        {"callbacks", int64_t(Profile.NumCallbacks)},
+        {"time_us", int64_t(duration_cast<microseconds>(Profile.Time).count())},
+        {"nodes", int64_t(Profile.NumNodes)},
+        {"states", int64_t(Profile.NumStates)},
+    });
+  }
+
+  OS << llvm::formatv("{0:2}\n", llvm::json::Value(llvm::json::Object{
+                                     {"version", 1},
+                                     {"checkers", std::move(Checkers)},
+                                 }));
 }
 
 void CheckerManager::reportInvalidCheckerOptionValue(
@@ -107,11 +174,51 @@ void CheckerManager::runCheckersOnASTBody(const Decl *D, AnalysisManager& mgr,
 // Functions for running checkers for path-sensitive checking.
 //===----------------------------------------------------------------------===//
 
+namespace {
+
+/// Attributes the time spent, and the exploded nodes and program states
+/// created, during its lifetime to a checker.
+class CheckerProfileRegion {
+  CheckerManager::CheckerProfile *Profile;
+  ExprEngine &Eng;
+  std::chrono::steady_clock::time_point StartTime;
+  unsigned StartNodes;
+  uint64_t StartStates;
+
+public:
+  CheckerProfileRegion(CheckerManager::CheckerProfile *P, ExprEngine &Eng,
+                       size_t NumCallbacks)
+      : Profile(P && !P->Active ? P : nullptr), Eng(Eng) {
+    if (!Profile)
+      return;
+    Profile->Active = true;
+    Profile->NumCallbacks += NumCallbacks;
+    StartTime = std::chrono::steady_clock::now();
+    StartNodes = Eng.getGraph().size();
+    StartStates = Eng.getStateManager().getNumCreatedStates();
+  }
+
+  ~CheckerProfileRegion() {
+    if (!Profile)
+      return;
+    Profile->Active = false;
+    Profile->Time += std::chrono::steady_clock::now() - StartTime;
+    unsigned EndNodes = Eng.getGraph().size();
+    if (EndNodes > StartNodes)
+      Profile->NumNodes += EndNodes - StartNodes;
+    Profile->NumStates +=
+        Eng.getStateManager().getNumCreatedStates() - StartStates;
+  }
+};
+
+} // namespace
+
 template <typename CHECK_CTX>
 static void expandGraphWithCheckers(CHECK_CTX checkCtx,
                                     ExplodedNodeSet &Dst,
                                     const ExplodedNodeSet &Src) {
   const NodeBuilderContext &BldrCtx = checkCtx.Eng.getBuilderContext();
+  CheckerManager &Mgr = checkCtx.Eng.getCheckerManager();
   if (Src.empty())
     return;
 
@@ -134,6 +241,15 @@ static void expandGraphWithCheckers(CHECK_CTX checkCtx,
       CurrSet->clear();
     }
 
+    // A callback may run the callbacks of other checkers, but the time of a
+    // checker is only counted once.
+    llvm::Timer *CheckerTimer = Mgr.getCheckerTimer(I->Checker);
+    if (CheckerTimer && CheckerTimer->isRunning())
+      CheckerTimer = nullptr;
+    llvm::TimeRegion CheckerTimeRegion(CheckerTimer);
+    CheckerProfileRegion ProfileRegion(Mgr.getCheckerProfile(I->Checker),
+                                       checkCtx.Eng, PrevSet->size());
+
     NodeBuilder B(*PrevSet, *CurrSet, BldrCtx);
     for (const auto &NI : *PrevSet)
       checkCtx.runChecker(*I, B, NI);
@@ -890,17 +1006,20 @@ const CheckerManager::CachedStmtCheckers &
 CheckerManager::getCachedStmtCheckersFor(const Stmt *S, bool isPreVisit) {
   assert(S);
 
+  if (CachedStmtCheckersTable.empty())
+    CachedStmtCheckersTable.resize((Stmt::lastStmtConstant + 1) << 1);
+
   unsigned Key = (S->getStmtClass() << 1) | unsigned(isPreVisit);
-  CachedStmtCheckersMapTy::iterator CCI = CachedStmtCheckersMap.find(Key);
-  if (CCI != CachedStmtCheckersMap.end())
-    return CCI->second;
+  Optional<CachedStmtCheckers> &Checkers = CachedStmtCheckersTable[Key];
+  if (Checkers)
+    return *Checkers;
 
   // Find the checkers that should run for this Stmt and cache them.
-  CachedStmtCheckers &Checkers = CachedStmtCheckersMap[Key];
+  Checkers.emplace();
   for (const auto &Info : StmtCheckers)
     if (Info.IsPreVisit == isPreVisit && Info.IsForStmtFn(S))
-      Checkers.push_back(Info.CheckFn);
-  return Checkers;
+      Checkers->push_back(Info.CheckFn);
+  return *Checkers;
 }
 
 CheckerManager::~CheckerManager() {
@@ -45,6 +45,10 @@ STATISTIC(NumSteps,
             "The # of steps executed.");
 STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
+STATISTIC(NumReachedMaxGraphMemory,
+            "The # of times we reached the max graph memory.");
+STATISTIC(NumReachedMaxAnalysisTime,
+            "The # of times we reached the max analysis time.");
 STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
 
@@ -67,6 +71,8 @@ static std::unique_ptr<WorkList> generateWorkList(AnalyzerOptions &Opts,
       return WorkList::makeUnexploredFirstPriorityQueue();
     case ExplorationStrategyKind::UnexploredFirstLocationQueue:
       return WorkList::makeUnexploredFirstPriorityLocationQueue();
+    case ExplorationStrategyKind::CoverageGainQueue:
+      return WorkList::makeCoverageGainPriorityQueue();
   }
   llvm_unreachable("Unknown AnalyzerOptions::ExplorationStrategyKind");
 }
@@ -74,7 +80,9 @@ static std::unique_ptr<WorkList> generateWorkList(AnalyzerOptions &Opts,
 CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
                        AnalyzerOptions &Opts)
     : SubEng(subengine), WList(generateWorkList(Opts, subengine)),
-      BCounterFactory(G.getAllocator()), FunctionSummaries(FS) {}
+      BCounterFactory(G.getAllocator()), FunctionSummaries(FS),
+      MaxGraphBytes(uint64_t(Opts.MaxGraphMemory) * 1024 * 1024),
+      MaxTime(Opts.MaxAnalysisTime) {}
 
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
@@ -126,6 +134,10 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
   if(!UnlimitedSteps)
     G.reserve(std::min(Steps,PreReservationCap));
 
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point Deadline = Clock::now() + MaxTime;
+  unsigned StepsUntilTimeCheck = 0;
+
   while (WList->hasWork()) {
     if (!UnlimitedSteps) {
       if (Steps == 0) {
@@ -135,6 +147,25 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
       --Steps;
     }
 
+    // The program states and the store are allocated with the graph, so this
+    // is most of the memory used by the analysis.
+    if (MaxGraphBytes && G.getAllocator().getBytesAllocated() > MaxGraphBytes) {
+      NumReachedMaxGraphMemory++;
+      ExhaustedBudget = BudgetKind::Memory;
+      break;
+    }
+
+    // Reading the clock at every step would be noticeable, and a few hundred
+    // steps take well under a millisecond.
+    if (MaxTime.count() && StepsUntilTimeCheck-- == 0) {
+      if (Clock::now() > Deadline) {
+        NumReachedMaxAnalysisTime++;
+        ExhaustedBudget = BudgetKind::Time;
+        break;
+      }
+      StepsUntilTimeCheck = 256;
+    }
+
     NumSteps++;
 
     const WorkListUnit& WU = WList->dequeue();
@@ -28,6 +28,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
 #include <cassert>
 #include <memory>
@@ -35,6 +36,10 @@
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "ExplodedGraph"
+
+STATISTIC(NumReclaimedNodes, "The # of nodes reclaimed from the graph.");
+
 //===----------------------------------------------------------------------===//
 // Cleanup.
 //===----------------------------------------------------------------------===//
@@ -165,11 +170,12 @@ void ExplodedGraph::collectNode(ExplodedNode *node) {
   FreeNodes.push_back(node);
   Nodes.RemoveNode(node);
   --NumNodes;
+  ++NumReclaimedNodes;
   node->~ExplodedNode();
 }
 
 void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
-  if (ChangedNodes.empty())
+  if (ChangedNodes.empty() && FrontierNodes.empty())
     return;
 
   // Only periodically reclaim nodes so that we can build up a set of
@@ -180,9 +186,20 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
     return;
   ReclaimCounter = ReclaimNodeInterval;
 
-  for (const auto node : ChangedNodes)
+  // The nodes created last are usually still waiting on the worklist, with no
+  // successor to be merged with. Give them another chance next time instead of
+  // keeping them forever.
+  for (const auto node : FrontierNodes)
+    if (shouldCollect(node))
+      collectNode(node);
+  FrontierNodes.clear();
+
+  for (const auto node : ChangedNodes) {
     if (shouldCollect(node))
       collectNode(node);
+    else if (node->succ_empty() && !node->isSink())
+      FrontierNodes.push_back(node);
+  }
   ChangedNodes.clear();
 }
 
@@ -672,6 +672,14 @@ static bool shouldRemoveDeadBindings(AnalysisManager &AMgr,
   if (Pred->getLocation().getAs<BlockEntrance>())
     return true;
 
+  // Are we only purging at the beginning of the basic blocks, either always
+  // or in this large function?
+  if (AMgr.options.AnalysisPurgeOpt == PurgeBlock)
+    return false;
+  if (unsigned MinSize = AMgr.options.MinCFGSizePurgeAtBlocksOnly)
+    if (LC->getAnalysisDeclContext()->getCFG()->size() >= MinSize)
+      return false;
+
   // Is this on a non-expression?
   if (!isa<Expr>(S))
     return true;
@@ -941,8 +941,12 @@ bool ExprEngine::shouldInlineCall(const CallEvent &Call, const Decl *D,
 
   } else {
     // We haven't actually checked the static properties of this function yet.
-    // Do that now, and record our decision in the function summaries.
-    if (mayInlineDecl(CalleeADC)) {
+    // Do that now, and record our decision in the function summaries. The
+    // functions which exhausted the block count when they were inlined by the
+    // analysis of another translation unit would make us replay the call
+    // without inlining anyway.
+    if (mayInlineDecl(CalleeADC) &&
+        !Engine.FunctionSummaries->isKnownToReachMaxBlockCount(D)) {
       Engine.FunctionSummaries->markMayInline(D);
     } else {
       Engine.FunctionSummaries->markShouldNotInline(D);
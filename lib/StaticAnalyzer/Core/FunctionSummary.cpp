@@ -11,10 +11,69 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/FunctionSummary.h"
+#include "clang/CrossTU/CrossTranslationUnit.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
 
+static Optional<std::string> getExhaustedFunctionName(const Decl *D) {
+  if (const auto *ND = dyn_cast<NamedDecl>(D))
+    return cross_tu::CrossTranslationUnitContext::getLookupName(ND);
+  return None;
+}
+
+bool FunctionSummariesTy::isKnownToReachMaxBlockCount(const Decl *D) const {
+  if (ExhaustedFunctions.empty())
+    return false;
+  Optional<std::string> Name = getExhaustedFunctionName(D);
+  return Name && ExhaustedFunctions.count(*Name);
+}
+
+void FunctionSummariesTy::readExhaustedFunctions(StringRef File) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(File);
+  if (!Buffer)
+    return;
+  SmallVector<StringRef, 32> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  for (StringRef Line : Lines)
+    ExhaustedFunctions.insert(Line);
+}
+
+void FunctionSummariesTy::writeExhaustedFunctions(StringRef File) {
+  // Pick up the additions of the analyses that finished in the meantime.
+  readExhaustedFunctions(File);
+  unsigned NumKnown = ExhaustedFunctions.size();
+  for (const auto &I : Map)
+    if (I.second.ReachedMaxBlockCount)
+      if (Optional<std::string> Name = getExhaustedFunctionName(I.first))
+        ExhaustedFunctions.insert(*Name);
+  if (ExhaustedFunctions.size() == NumKnown)
+    return;
+
+  std::vector<StringRef> Names;
+  for (const auto &Name : ExhaustedFunctions)
+    Names.push_back(Name.getKey());
+  llvm::sort(Names);
+
+  SmallString<128> TempPath(File);
+  TempPath += "-%%%%%%%%.tmp";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    for (StringRef Name : Names)
+      OS << Name << '\n';
+  }
+  if (llvm::sys::fs::rename(TempPath, File))
+    llvm::sys::fs::remove(TempPath);
+}
+
 unsigned FunctionSummariesTy::getTotalNumBasicBlocks() {
   unsigned Total = 0;
   for (const auto &I : Map)
@@ -27,6 +27,7 @@
 #include "clang/StaticAnalyzer/Core/IssueHash.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
@@ -65,6 +66,10 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   AnalyzerOptions &AnalyzerOpts;
   const bool SupportsCrossFileDiagnostics;
 
+  /// The syntax and macro highlights of the files, which are the same in
+  /// every report through a file, so that each file is relexed once.
+  llvm::DenseMap<FileID, std::unique_ptr<html::FileHighlights>> Highlights;
+
 public:
   HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts,
                   const std::string& prefix,
@@ -315,9 +320,7 @@ std::string HTMLDiagnostics::GenerateHTML(const PathDiagnostic& D, Rewriter &R,
       std::string s;
       llvm::raw_string_ostream os(s);
 
-      const RewriteBuffer *Buf = R.getRewriteBufferFor(I);
-      for (auto BI : *Buf)
-        os << BI;
+      R.getRewriteBufferFor(I)->write(os);
 
       R.InsertTextAfter(SMgr.getLocForEndOfFile(FileIDs[0]), os.str());
     }
@@ -335,8 +338,7 @@ std::string HTMLDiagnostics::GenerateHTML(const PathDiagnostic& D, Rewriter &R,
 
   std::string file;
   llvm::raw_string_ostream os(file);
-  for (auto BI : *Buf)
-    os << BI;
+  Buf->write(os);
 
   return os.str();
 }
@@ -728,8 +730,13 @@ void HTMLDiagnostics::RewriteFile(Rewriter &R,
   // If we have a preprocessor, relex the file and syntax highlight.
   // We might not have a preprocessor if we come from a deserialized AST file,
   // for example.
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
+  std::unique_ptr<html::FileHighlights> &FileHighlights = Highlights[FID];
+  if (!FileHighlights) {
+    FileHighlights = std::make_unique<html::FileHighlights>();
+    html::SyntaxHighlight(*FileHighlights, FID, PP);
+    html::HighlightMacros(*FileHighlights, FID, PP);
+  }
+  FileHighlights->apply(R, FID);
 }
 
 void HTMLDiagnostics::HandlePiece(Rewriter &R, FileID BugFileID,
@@ -18,11 +18,22 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/DynamicType.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "ProgramState"
+
+STATISTIC(NumPersistentStateLookups,
+          "The # of states looked up to be made persistent");
+STATISTIC(NumPersistentStateHits,
+          "The # of states looked up which were already persistent");
+STATISTIC(NumUnchangedStates,
+          "The # of transitions which didn't change the state, and which "
+          "didn't need a lookup");
+
 namespace clang { namespace  ento {
 /// Increments the number of times this state is referenced.
 
@@ -112,7 +123,14 @@ ProgramStateManager::removeDeadBindings(ProgramStateRef state,
   NewState.setStore(newStore);
   SymReaper.setReapedStore(newStore);
 
-  ProgramStateRef Result = getPersistentState(NewState);
+  ProgramStateRef Result;
+  if (NewState.Env.hasSameBindings(state->Env) &&
+      NewState.store == state->store) {
+    ++NumUnchangedStates;
+    Result = state;
+  } else {
+    Result = getPersistentState(NewState);
+  }
   return ConstraintMgr->removeDeadBindings(Result, SymReaper);
 }
 
@@ -395,6 +413,11 @@ ProgramStateRef ProgramStateManager::getInitialState(const LocationContext *Init
 ProgramStateRef ProgramStateManager::getPersistentStateWithGDM(
                                                      ProgramStateRef FromState,
                                                      ProgramStateRef GDMState) {
+  if (FromState->GDM.getRootWithoutRetain() ==
+      GDMState->GDM.getRootWithoutRetain()) {
+    ++NumUnchangedStates;
+    return FromState;
+  }
   ProgramState NewState(*FromState);
   NewState.GDM = GDMState->GDM;
   return getPersistentState(NewState);
@@ -406,8 +429,11 @@ ProgramStateRef ProgramStateManager::getPersistentState(ProgramState &State) {
   State.Profile(ID);
   void *InsertPos;
 
-  if (ProgramState *I = StateSet.FindNodeOrInsertPos(ID, InsertPos))
+  ++NumPersistentStateLookups;
+  if (ProgramState *I = StateSet.FindNodeOrInsertPos(ID, InsertPos)) {
+    ++NumPersistentStateHits;
     return I;
+  }
 
   ProgramState *newState = nullptr;
   if (!freeStates.empty()) {
@@ -418,11 +444,17 @@ ProgramStateRef ProgramStateManager::getPersistentState(ProgramState &State) {
     newState = (ProgramState*) Alloc.Allocate<ProgramState>();
   }
   new (newState) ProgramState(State);
+  newState->ProfileHash = ID.ComputeHash();
   StateSet.InsertNode(newState, InsertPos);
+  ++NumCreatedStates;
   return newState;
 }
 
 ProgramStateRef ProgramState::makeWithStore(const StoreRef &store) const {
+  if (store.getStore() == getStore()) {
+    ++NumUnchangedStates;
+    return this;
+  }
   ProgramState NewSt(*this);
   NewSt.setStore(store);
   return getStateManager().getPersistentState(NewSt);
@@ -18,11 +18,19 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/RangedConstraintManager.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "RangeConstraintManager"
+
+STATISTIC(NumReusedRangeSets,
+          "The # of intersections that left the range set unchanged");
+STATISTIC(NumUnchangedConstraints,
+          "The # of assumptions that did not change the constraints");
+
 void RangeSet::IntersectInRange(BasicValueFactory &BV, Factory &F,
                       const llvm::APSInt &Lower, const llvm::APSInt &Upper,
                       PrimRangeSet &newRanges, PrimRangeSet::iterator &i,
@@ -146,6 +154,22 @@ bool RangeSet::pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
   return true;
 }
 
+/// Returns true if all the values of the set are in the modular range
+/// [Lower, Upper], which must have been pinned to the type of the set.
+bool RangeSet::isWithinRange(const llvm::APSInt &Lower,
+                             const llvm::APSInt &Upper) const {
+  for (iterator i = begin(), e = end(); i != e; ++i) {
+    if (Lower <= Upper) {
+      if (i->From() < Lower || i->To() > Upper)
+        return false;
+    } else if (i->To() > Upper && i->From() < Lower) {
+      // The range overlaps the values between Upper and Lower.
+      return false;
+    }
+  }
+  return true;
+}
+
 // Returns a set containing the values in the receiving set, intersected with
 // the closed range [Lower, Upper]. Unlike the Range type, this range uses
 // modular arithmetic, corresponding to the common treatment of C integer
@@ -158,6 +182,13 @@ RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
   if (!pin(Lower, Upper))
     return F.getEmptySet();
 
+  // Most assumptions don't exclude any value that the set contains. Keep the
+  // set instead of building an identical one.
+  if (isWithinRange(Lower, Upper)) {
+    ++NumReusedRangeSets;
+    return *this;
+  }
+
   PrimRangeSet newRanges = F.getEmptySet();
 
   PrimRangeSet::iterator i = begin(), e = end();
@@ -178,6 +209,9 @@ RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
 // the range set passed as parameter.
 RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
                              const RangeSet &Other) const {
+  if (Other.ranges.isSingleton())
+    return Intersect(BV, F, Other.begin()->From(), Other.begin()->To());
+
   PrimRangeSet newRanges = F.getEmptySet();
 
   for (iterator i = Other.begin(), e = Other.end(); i != e; ++i) {
@@ -305,6 +339,8 @@ private:
   RangeSet::Factory F;
 
   RangeSet getRange(ProgramStateRef State, SymbolRef Sym);
+  ProgramStateRef setRange(ProgramStateRef State, SymbolRef Sym,
+                           const RangeSet &New);
   const RangeSet* getRangeForMinusSymbol(ProgramStateRef State,
                                          SymbolRef Sym);
 
@@ -512,6 +548,21 @@ RangeSet RangeConstraintManager::getRange(ProgramStateRef State,
   return Result;
 }
 
+/// Constrain \p Sym to the values of \p New, returning null if there are
+/// none. The state is returned as is if the constraint doesn't change.
+ProgramStateRef RangeConstraintManager::setRange(ProgramStateRef State,
+                                                 SymbolRef Sym,
+                                                 const RangeSet &New) {
+  if (New.isEmpty())
+    return nullptr;
+  const RangeSet *Old = State->get<ConstraintRange>(Sym);
+  if (Old && *Old == New) {
+    ++NumUnchangedConstraints;
+    return State;
+  }
+  return State->set<ConstraintRange>(Sym, New);
+}
+
 // FIXME: Once SValBuilder supports unary minus, we should use SValBuilder to
 //        obtain the negated symbolic expression instead of constructing the
 //        symbol manually. This will allow us to support finding ranges of not
@@ -567,7 +618,7 @@ RangeConstraintManager::assumeSymNE(ProgramStateRef St, SymbolRef Sym,
   // [Int-Adjustment+1, Int-Adjustment-1]
   // Notice that the lower bound is greater than the upper bound.
   RangeSet New = getRange(St, Sym).Intersect(getBasicVals(), F, Upper, Lower);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 ProgramStateRef
@@ -582,7 +633,7 @@ RangeConstraintManager::assumeSymEQ(ProgramStateRef St, SymbolRef Sym,
   // [Int-Adjustment, Int-Adjustment]
   llvm::APSInt AdjInt = AdjustmentType.convert(Int) - Adjustment;
   RangeSet New = getRange(St, Sym).Intersect(getBasicVals(), F, AdjInt, AdjInt);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet RangeConstraintManager::getSymLTRange(ProgramStateRef St,
@@ -618,7 +669,7 @@ RangeConstraintManager::assumeSymLT(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymLTRange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet RangeConstraintManager::getSymGTRange(ProgramStateRef St,
@@ -654,7 +705,7 @@ RangeConstraintManager::assumeSymGT(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymGTRange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet RangeConstraintManager::getSymGERange(ProgramStateRef St,
@@ -690,7 +741,7 @@ RangeConstraintManager::assumeSymGE(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymGERange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet RangeConstraintManager::getSymLERange(
@@ -733,7 +784,7 @@ RangeConstraintManager::assumeSymLE(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymLERange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 ProgramStateRef RangeConstraintManager::assumeSymWithinInclusiveRange(
@@ -743,7 +794,7 @@ ProgramStateRef RangeConstraintManager::assumeSymWithinInclusiveRange(
   if (New.isEmpty())
     return nullptr;
   RangeSet Out = getSymLERange([&] { return New; }, To, Adjustment);
-  return Out.isEmpty() ? nullptr : State->set<ConstraintRange>(Sym, Out);
+  return setRange(State, Sym, Out);
 }
 
 ProgramStateRef RangeConstraintManager::assumeSymOutsideInclusiveRange(
@@ -752,7 +803,7 @@ ProgramStateRef RangeConstraintManager::assumeSymOutsideInclusiveRange(
   RangeSet RangeLT = getSymLTRange(State, Sym, From, Adjustment);
   RangeSet RangeGT = getSymGTRange(State, Sym, To, Adjustment);
   RangeSet New(RangeLT.addRange(F, RangeGT));
-  return New.isEmpty() ? nullptr : State->set<ConstraintRange>(Sym, New);
+  return setRange(State, Sym, New);
 }
 
 //===----------------------------------------------------------------------===//
@@ -29,12 +29,20 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
 #include "llvm/ADT/ImmutableMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include <utility>
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "RegionStore"
+
+STATISTIC(NumRedundantBindings,
+          "The # of bindings of a value that was already bound to the key");
+STATISTIC(NumRedundantBindingRemovals,
+          "The # of removals of a binding that didn't exist");
+
 //===----------------------------------------------------------------------===//
 // Representation of binding keys.
 //===----------------------------------------------------------------------===//
@@ -274,6 +282,17 @@ RegionBindingsRef RegionBindingsRef::addBinding(BindingKey K, SVal V) const {
   const MemRegion *Base = K.getBaseRegion();
 
   const ClusterBindings *ExistingCluster = lookup(Base);
+
+  // Adding a binding that is already there would copy the paths to it in both
+  // maps, only for the copies to be folded into the existing maps again.
+  if (ExistingCluster) {
+    const SVal *Existing = ExistingCluster->lookup(K);
+    if (Existing && *Existing == V) {
+      ++NumRedundantBindings;
+      return *this;
+    }
+  }
+
   ClusterBindings Cluster =
       (ExistingCluster ? *ExistingCluster : CBFactory->getEmptyMap());
 
@@ -306,6 +325,13 @@ RegionBindingsRef RegionBindingsRef::removeBinding(BindingKey K) {
   if (!Cluster)
     return *this;
 
+  // Likewise, removing a key that isn't in the map would copy the path to
+  // where it would be.
+  if (!Cluster->lookup(K)) {
+    ++NumRedundantBindingRemovals;
+    return *this;
+  }
+
   ClusterBindings NewCluster = CBFactory->remove(*Cluster, K);
   if (NewCluster.isEmpty())
     return remove(Base);
@@ -15,6 +15,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/JSON.h"
@@ -117,30 +118,37 @@ static json::Object createArtifact(const FileEntry &FE) {
                       {"mimeType", "text/plain"}};
 }
 
-static json::Object createArtifactLocation(const FileEntry &FE,
-                                           json::Array &Artifacts) {
-  std::string FileURI = fileNameToURI(getFileName(FE));
-
-  // See if the Artifacts array contains this URI already. If it does not,
-  // create a new artifact object to add to the array.
-  auto I = llvm::find_if(Artifacts, [&](const json::Value &File) {
-    if (const json::Object *Obj = File.getAsObject()) {
-      if (const json::Object *FileLoc = Obj->getObject("location")) {
-        Optional<StringRef> URI = FileLoc->getString("uri");
-        return URI && URI->equals(FileURI);
-      }
+namespace {
+/// The artifacts of a run, which the locations of the results refer to by
+/// their index.
+class ArtifactTable {
+public:
+  /// \returns the location of the artifact of \p FE, which is added to the
+  /// table if it isn't there yet.
+  json::Object getLocation(const FileEntry &FE) {
+    auto It = URIs.find(&FE);
+    if (It == URIs.end()) {
+      auto Inserted = Indices.try_emplace(fileNameToURI(getFileName(FE)),
+                                          Artifacts.size());
+      // Different entries, e.g. hard links, can have the same URI.
+      if (Inserted.second)
+        Artifacts.push_back(createArtifact(FE));
+      It = URIs.try_emplace(&FE, &*Inserted.first).first;
     }
-    return false;
-  });
+    return json::Object{{"uri", It->second->getKey()},
+                        {"index", It->second->getValue()}};
+  }
 
-  // Calculate the index within the artifact array so it can be stored in
-  // the JSON object.
-  auto Index = static_cast<unsigned>(std::distance(Artifacts.begin(), I));
-  if (I == Artifacts.end())
-    Artifacts.push_back(createArtifact(FE));
+  /// \returns the artifacts, after which getLocation() only finds the
+  /// artifacts that were added before.
+  json::Array take() { return std::move(Artifacts); }
 
-  return json::Object{{"uri", FileURI}, {"index", Index}};
-}
+private:
+  json::Array Artifacts;
+  StringMap<unsigned> Indices;
+  llvm::DenseMap<const FileEntry *, StringMapEntry<unsigned> *> URIs;
+};
+} // end anonymous namespace
 
 static json::Object createTextRegion(SourceRange R, const SourceManager &SM) {
   json::Object Region{
@@ -158,9 +166,9 @@ static json::Object createTextRegion(SourceRange R, const SourceManager &SM) {
 
 static json::Object createPhysicalLocation(SourceRange R, const FileEntry &FE,
                                            const SourceManager &SMgr,
-                                           json::Array &Artifacts) {
+                                           ArtifactTable &Artifacts) {
   return json::Object{
-      {{"artifactLocation", createArtifactLocation(FE, Artifacts)},
+      {{"artifactLocation", Artifacts.getLocation(FE)},
        {"region", createTextRegion(R, SMgr)}}};
 }
 
@@ -214,7 +222,7 @@ static Importance calculateImportance(const PathDiagnosticPiece &Piece) {
 }
 
 static json::Object createThreadFlow(const PathPieces &Pieces,
-                                     json::Array &Artifacts) {
+                                     ArtifactTable &Artifacts) {
   const SourceManager &SMgr = Pieces.front()->getLocation().getManager();
   json::Array Locations;
   for (const auto &Piece : Pieces) {
@@ -231,13 +239,23 @@ static json::Object createThreadFlow(const PathPieces &Pieces,
 }
 
 static json::Object createCodeFlow(const PathPieces &Pieces,
-                                   json::Array &Artifacts) {
+                                   ArtifactTable &Artifacts) {
   return json::Object{
       {"threadFlows", json::Array{createThreadFlow(Pieces, Artifacts)}}};
 }
 
+/// Add the artifacts of \p Diag to \p Artifacts, in the order in which
+/// createResult() refers to them.
+static void addArtifacts(const PathDiagnostic &Diag, ArtifactTable &Artifacts) {
+  for (const auto &Piece : Diag.path.flatten(false))
+    Artifacts.getLocation(
+        *Piece->getLocation().asLocation().getExpansionLoc().getFileEntry());
+  Artifacts.getLocation(
+      *Diag.getLocation().asLocation().getExpansionLoc().getFileEntry());
+}
+
 static json::Object createResult(const PathDiagnostic &Diag,
-                                 json::Array &Artifacts,
+                                 ArtifactTable &Artifacts,
                                  const StringMap<unsigned> &RuleMapping) {
   const PathPieces &Path = Diag.path.flatten(false);
   const SourceManager &SMgr = Path.front()->getLocation().getManager();
@@ -320,18 +338,27 @@ static json::Object createTool(std::vector<const PathDiagnostic *> &Diags,
                               {"rules", createRules(Diags, RuleMapping)}}}};
 }
 
-static json::Object createRun(std::vector<const PathDiagnostic *> &Diags) {
-  json::Array Results, Artifacts;
+/// Write the run of \p Diags to \p J. The results are written as they are
+/// created, rather than kept until the whole log is.
+static void writeRun(json::OStream &J,
+                     std::vector<const PathDiagnostic *> &Diags) {
   StringMap<unsigned> RuleMapping;
   json::Object Tool = createTool(Diags, RuleMapping);
-  
-  llvm::for_each(Diags, [&](const PathDiagnostic *D) {
-    Results.push_back(createResult(*D, Artifacts, RuleMapping));
-  });
 
-  return json::Object{{"tool", std::move(Tool)},
-                      {"results", std::move(Results)},
-                      {"artifacts", std::move(Artifacts)}};
+  // The artifacts precede the results in the log, so collect them first.
+  ArtifactTable Artifacts;
+  for (const PathDiagnostic *D : Diags)
+    addArtifacts(*D, Artifacts);
+
+  // The attributes are in the order in which json::Object keeps them.
+  J.object([&] {
+    J.attribute("artifacts", Artifacts.take());
+    J.attributeArray("results", [&] {
+      for (const PathDiagnostic *D : Diags)
+        J.value(createResult(*D, Artifacts, RuleMapping));
+    });
+    J.attribute("tool", std::move(Tool));
+  });
 }
 
 void SarifDiagnostics::FlushDiagnosticsImpl(
@@ -347,10 +374,13 @@ void SarifDiagnostics::FlushDiagnosticsImpl(
     llvm::errs() << "warning: could not create file: " << EC.message() << '\n';
     return;
   }
-  json::Object Sarif{
-      {"$schema",
-       "https://raw.githubusercontent.com/oasis-tcs/sarif-spec/master/Schemata/sarif-schema-2.1.0.json"},
-      {"version", "2.1.0"},
-      {"runs", json::Array{createRun(Diags)}}};
-  OS << llvm::formatv("{0:2}\n", json::Value(std::move(Sarif)));
+  json::OStream J(OS, /*IndentSize=*/2);
+  J.object([&] {
+    J.attribute(
+        "$schema",
+        "https://raw.githubusercontent.com/oasis-tcs/sarif-spec/master/Schemata/sarif-schema-2.1.0.json");
+    J.attributeArray("runs", [&] { writeRun(J, Diags); });
+    J.attribute("version", "2.1.0");
+  });
+  OS << '\n';
 }
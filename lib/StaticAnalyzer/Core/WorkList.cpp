@@ -11,12 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/WorkList.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/PriorityQueue.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Statistic.h"
 #include <deque>
+#include <limits>
+#include <tuple>
 #include <vector>
 
 using namespace clang;
@@ -26,6 +29,8 @@ using namespace ento;
 
 STATISTIC(MaxQueueSize, "Maximum size of the worklist");
 STATISTIC(MaxReachableSize, "Maximum size of auxiliary worklist set");
+STATISTIC(NumRequeuedForCoverageGain,
+          "The # of nodes requeued because their coverage gain decreased");
 
 //===----------------------------------------------------------------------===//
 // Worklist classes for exploration of reachable states.
@@ -311,3 +316,126 @@ public:
 std::unique_ptr<WorkList> WorkList::makeUnexploredFirstPriorityLocationQueue() {
   return std::make_unique<UnexploredFirstPriorityLocationQueue>();
 }
+
+namespace {
+class CoverageGainPriorityQueue : public WorkList {
+  using BlockID = unsigned;
+  using LocIdentifier = std::pair<BlockID, const StackFrameContext *>;
+
+  // Compare by the number of the blocks not visited yet which are reachable
+  // from the location first (prefer the nodes which may add the most
+  // coverage), then by number of times the location was visited (negated to
+  // prefer less often visited locations), then by insertion time (prefer
+  // expanding nodes inserted sooner first).
+  using QueuePriority = std::tuple<unsigned, int, unsigned long>;
+  using QueueItem = std::pair<WorkListUnit, QueuePriority>;
+
+  struct ExplorationComparator {
+    bool operator() (const QueueItem &LHS, const QueueItem &RHS) {
+      return LHS.second < RHS.second;
+    }
+  };
+
+  // Number of inserted nodes, used to emulate DFS ordering in the priority
+  // queue when insertions are equal.
+  unsigned long Counter = 0;
+
+  // Number of times a current location was reached.
+  llvm::DenseMap<LocIdentifier, int> NumReached;
+
+  // The blocks reachable from each block, by block ID.
+  llvm::DenseMap<const CFGBlock *, llvm::BitVector> ReachableBlocks;
+
+  // The blocks which were dequeued in each stack frame, by block ID.
+  llvm::DenseMap<const StackFrameContext *, llvm::BitVector> VisitedBlocks;
+
+  // The top item is the largest one.
+  llvm::PriorityQueue<QueueItem, std::vector<QueueItem>, ExplorationComparator>
+      queue;
+
+  const llvm::BitVector &getReachableBlocks(const CFGBlock *B) {
+    llvm::BitVector &Reachable = ReachableBlocks[B];
+    if (!Reachable.empty())
+      return Reachable;
+    Reachable.resize(B->getParent()->getNumBlockIDs());
+    SmallVector<const CFGBlock *, 32> Worklist;
+    Reachable.set(B->getBlockID());
+    Worklist.push_back(B);
+    while (!Worklist.empty()) {
+      const CFGBlock *Block = Worklist.pop_back_val();
+      for (const CFGBlock *Succ : Block->succs()) {
+        if (!Succ || Reachable.test(Succ->getBlockID()))
+          continue;
+        Reachable.set(Succ->getBlockID());
+        Worklist.push_back(Succ);
+      }
+    }
+    return Reachable;
+  }
+
+  llvm::BitVector &getVisitedBlocks(const CFGBlock *B,
+                                    const StackFrameContext *SFC) {
+    llvm::BitVector &Visited = VisitedBlocks[SFC];
+    if (Visited.empty())
+      Visited.resize(B->getParent()->getNumBlockIDs());
+    return Visited;
+  }
+
+  unsigned getCoverageGain(const CFGBlock *B, const StackFrameContext *SFC) {
+    llvm::BitVector Gain = getReachableBlocks(B);
+    Gain.reset(getVisitedBlocks(B, SFC));
+    return Gain.count();
+  }
+
+public:
+  bool hasWork() const override {
+    return !queue.empty();
+  }
+
+  void enqueue(const WorkListUnit &U) override {
+    const ExplodedNode *N = U.getNode();
+    // Keep going through the block which is being processed.
+    unsigned Gain = std::numeric_limits<unsigned>::max();
+    unsigned NumVisited = 0;
+    if (auto BE = N->getLocation().getAs<BlockEntrance>()) {
+      const StackFrameContext *SFC = N->getLocationContext()->getStackFrame();
+      Gain = getCoverageGain(BE->getBlock(), SFC);
+      NumVisited = NumReached[{BE->getBlock()->getBlockID(), SFC}]++;
+    }
+
+    queue.push(
+        std::make_pair(U, QueuePriority(Gain, -int(NumVisited), ++Counter)));
+    MaxQueueSize.updateMax(queue.size());
+  }
+
+  WorkListUnit dequeue() override {
+    while (true) {
+      QueueItem U = queue.top();
+      queue.pop();
+      const ExplodedNode *N = U.first.getNode();
+      auto BE = N->getLocation().getAs<BlockEntrance>();
+      if (!BE)
+        return U.first;
+
+      // The gain computed when the node was enqueued doesn't account for the
+      // blocks visited since. Put the node back if another one may have a
+      // higher gain now.
+      const StackFrameContext *SFC = N->getLocationContext()->getStackFrame();
+      unsigned Gain = getCoverageGain(BE->getBlock(), SFC);
+      if (Gain < std::get<0>(U.second) && !queue.empty()) {
+        std::get<0>(U.second) = Gain;
+        queue.push(U);
+        NumRequeuedForCoverageGain++;
+        continue;
+      }
+
+      getVisitedBlocks(BE->getBlock(), SFC).set(BE->getBlock()->getBlockID());
+      return U.first;
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<WorkList> WorkList::makeCoverageGainPriorityQueue() {
+  return std::make_unique<CoverageGainPriorityQueue>();
+}
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
+#include "FunctionFingerprints.h"
 #include "ModelInjector.h"
 #include "clang/Analysis/PathDiagnostic.h"
 #include "clang/AST/Decl.h"
@@ -24,6 +25,8 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/MemoryReport.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/StaticAnalyzer/Checkers/LocalCheckers.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
@@ -59,6 +62,9 @@ STATISTIC(NumVisitedBlocksInAnalyzedFunctions,
           "The # of visited basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(NumFunctionsUnchanged,
+          "The # of functions not analyzed because they didn't change since "
+          "an analysis found no bugs in them.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -225,12 +231,23 @@ public:
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// The fingerprints of the functions found clean, if the analysis is
+  /// incremental.
+  std::unique_ptr<FunctionFingerprints> Fingerprints;
+
+  /// The number of reports of the path-sensitive analyses so far.
+  unsigned NumPathSensitiveReports = 0;
+
+  /// The memory report of -fmemory-report, if any.
+  MemoryReport *MemReport;
+
   AnalysisConsumer(CompilerInstance &CI, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
                    CodeInjector *injector)
       : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr),
         PP(CI.getPreprocessor()), OutDir(outdir), Opts(std::move(opts)),
-        Plugins(plugins), Injector(injector), CTU(CI) {
+        Plugins(plugins), Injector(injector), CTU(CI),
+        MemReport(CI.getMemoryReport()) {
     DigestAnalyzerOptions();
     if (Opts->PrintStats || Opts->ShouldSerializeStats) {
       AnalyzerTimers = std::make_unique<llvm::TimerGroup>(
@@ -347,6 +364,9 @@ public:
 
   void HandleTranslationUnit(ASTContext &C) override;
 
+  /// Write the profiles of the checkers to \p File.
+  void writeCheckerProfile(StringRef File);
+
   /// Determine which inlining mode should be used when this function is
   /// analyzed. This allows to redefine the default inlining policies when
   /// analyzing a given function.
@@ -367,7 +387,9 @@ public:
                   ExprEngine::InliningModes IMode = ExprEngine::Inline_Minimal,
                   SetOfConstDecls *VisitedCallees = nullptr);
 
-  void RunPathSensitiveChecks(Decl *D,
+  /// \returns true if the analysis of \p D exhausted its budget and should
+  /// be run again without inlining.
+  bool RunPathSensitiveChecks(Decl *D,
                               ExprEngine::InliningModes IMode,
                               SetOfConstDecls *VisitedCallees);
 
@@ -545,9 +567,9 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // (though HandleInterestingDecl); triggering additions to LocalTUDecls.
   // We rely on random access to add the initially processed Decls to CG.
   CallGraph CG;
-  for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-    CG.addToCallGraph(LocalTUDecls[i]);
-  }
+  std::vector<Decl *> Decls(LocalTUDecls.begin(),
+                            LocalTUDecls.begin() + LocalTUDeclsSize);
+  CG.addToCallGraph(Decls, Opts->CallGraphThreads);
 
   // Walk over all of the call graph nodes in topological order, so that we
   // analyze parents before the children. Skip the functions inlined into
@@ -558,6 +580,24 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+
+  // When the analysis is split into partitions, each of them gets a contiguous
+  // range of the traversal, so that callers are still analyzed before their
+  // callees within a partition.
+  unsigned NumFunctions = llvm::count_if(
+      RPOT, [](const CallGraphNode *N) { return N->getDecl() != nullptr; });
+  unsigned Position = 0;
+
+  // The inlined functions of the analyses that are skipped are found by their
+  // lookup names.
+  llvm::StringMap<const Decl *> DeclsByName;
+  if (Fingerprints)
+    for (const auto &I : CG)
+      if (const auto *ND = dyn_cast_or_null<NamedDecl>(I.first))
+        if (Optional<std::string> Name =
+                cross_tu::CrossTranslationUnitContext::getLookupName(ND))
+          DeclsByName[*Name] = ND;
+
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -569,17 +609,50 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Skip the functions of the other partitions.
+    if (uint64_t(Position++) * Opts->PartitionCount / NumFunctions !=
+        Opts->PartitionIndex)
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
       continue;
 
+    // Skip the functions which didn't change since an analysis found no bugs
+    // in them, along with the functions that analysis inlined.
+    std::string Fingerprint;
+    if (Fingerprints) {
+      Fingerprint = Fingerprints->getFingerprint(N);
+      std::vector<std::string> Callees;
+      if (!Fingerprint.empty() &&
+          Fingerprints->isKnownClean(Fingerprint, Callees)) {
+        NumFunctionsUnchanged++;
+        for (const std::string &Callee : Callees)
+          if (const Decl *CalleeDecl = DeclsByName.lookup(Callee))
+            Visited.insert(CalleeDecl);
+        VisitedAsTopLevel.insert(D);
+        continue;
+      }
+    }
+
     // Analyze the function.
     SetOfConstDecls VisitedCallees;
+    unsigned NumReportsBefore = NumPathSensitiveReports;
 
     HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
                (Mgr->options.InliningMode == All ? nullptr : &VisitedCallees));
 
+    if (!Fingerprint.empty() && NumPathSensitiveReports == NumReportsBefore) {
+      std::vector<std::string> Callees;
+      for (const Decl *Callee : VisitedCallees)
+        if (const auto *ND = dyn_cast<NamedDecl>(Callee))
+          if (Optional<std::string> Name =
+                  cross_tu::CrossTranslationUnitContext::getLookupName(ND))
+            Callees.push_back(std::move(*Name));
+      Fingerprints->addClean(Fingerprint, std::move(Callees));
+    }
+
     // Add the visited callees to the global visited set.
     for (const Decl *Callee : VisitedCallees)
       // Decls from CallGraph are already canonical. But Decls coming from
@@ -602,17 +675,24 @@ static bool isBisonFile(ASTContext &C) {
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->stopTimer();
+
+  // Only the first partition of a partitioned analysis runs the checks that
+  // aren't done per top-level function of the call graph.
+  bool IsFirstPartition = Opts->PartitionIndex == 0;
+
+  if (IsFirstPartition) {
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->startTimer();
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->stopTimer();
+  }
 
   // Run the AST-only checks using the order in which functions are defined.
   // If inlining is not turned on, use the simplest function order for path
   // sensitive analyzes as well.
-  RecVisitorMode = AM_Syntax;
-  if (!Mgr->shouldInlineCall())
+  RecVisitorMode = IsFirstPartition ? AM_Syntax : AM_None;
+  if (!Mgr->shouldInlineCall() && IsFirstPartition)
     RecVisitorMode |= AM_Path;
   RecVisitorBR = &BR;
 
@@ -631,12 +711,24 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
   // After all decls handled, run checkers on the entire TranslationUnit.
-  checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+  if (IsFirstPartition)
+    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
   BR.FlushReports();
   RecVisitorBR = nullptr;
 }
 
+void AnalysisConsumer::writeCheckerProfile(StringRef File) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(File, EC, llvm::sys::fs::OF_Text);
+  if (EC) {
+    PP.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << File << EC.message();
+    return;
+  }
+  checkerMgr->writeCheckerProfile(OS);
+}
+
 void AnalysisConsumer::reportAnalyzerProgress(StringRef S) {
   if (Opts->AnalyzerDisplayProgress)
     llvm::errs() << S;
@@ -658,7 +750,21 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     reportAnalyzerProgress("All checks are disabled using a supplied option\n");
   } else {
     // Otherwise, just run the analysis.
+    StringRef ExhaustedFunctionsFile = Opts->ExhaustedFunctionsFile;
+    if (!ExhaustedFunctionsFile.empty())
+      FunctionSummaries.readExhaustedFunctions(ExhaustedFunctionsFile);
+    StringRef FingerprintsFile = Opts->FunctionFingerprintsFile;
+    if (!FingerprintsFile.empty()) {
+      Fingerprints = std::make_unique<FunctionFingerprints>(*Opts);
+      Fingerprints->read(FingerprintsFile);
+    }
     runAnalysisOnTranslationUnit(C);
+    if (!ExhaustedFunctionsFile.empty())
+      FunctionSummaries.writeExhaustedFunctions(ExhaustedFunctionsFile);
+    if (Fingerprints)
+      Fingerprints->write(FingerprintsFile);
+    if (!Opts->CheckerProfileFile.empty())
+      writeCheckerProfile(Opts->CheckerProfileFile);
   }
 
   // Count how many basic blocks we have not covered.
@@ -795,7 +901,8 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
   BR.FlushReports();
 
   if ((Mode & AM_Path) && checkerMgr->hasPathSensitiveCheckers()) {
-    RunPathSensitiveChecks(D, IMode, VisitedCallees);
+    if (RunPathSensitiveChecks(D, IMode, VisitedCallees))
+      RunPathSensitiveChecks(D, ExprEngine::Inline_Minimal, VisitedCallees);
     if (IMode != ExprEngine::Inline_Minimal)
       NumFunctionsAnalyzed++;
   }
@@ -805,17 +912,17 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
 // Path-sensitive checking.
 //===----------------------------------------------------------------------===//
 
-void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
+bool AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
                                               ExprEngine::InliningModes IMode,
                                               SetOfConstDecls *VisitedCallees) {
   // Construct the analysis engine.  First check if the CFG is valid.
   // FIXME: Inter-procedural analysis will need to handle invalid CFGs.
   if (!Mgr->getCFG(D))
-    return;
+    return false;
 
   // See if the LiveVariables analysis scales.
   if (!Mgr->getAnalysisDeclContext(D)->getAnalysis<RelaxedLiveVariables>())
-    return;
+    return false;
 
   ExprEngine Eng(CTU, *Mgr, VisitedCallees, &FunctionSummaries, IMode);
 
@@ -827,6 +934,15 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
   if (ExprEngineTimer)
     ExprEngineTimer->stopTimer();
 
+  // The states are allocated with the nodes of the graph, which are released
+  // once the function is analyzed.
+  if (MemReport) {
+    ExplodedGraph &G = Eng.getGraph();
+    MemReport->notePeak("analyzer", "exploded_graph_bytes",
+                        G.getAllocator().getTotalMemory());
+    MemReport->notePeak("analyzer", "exploded_graph_nodes", G.size());
+  }
+
   if (!Mgr->options.DumpExplodedGraphTo.empty())
     Eng.DumpGraph(Mgr->options.TrimGraph, Mgr->options.DumpExplodedGraphTo);
 
@@ -835,11 +951,26 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
     Eng.ViewGraph(Mgr->options.TrimGraph);
 
   // Display warnings.
+  NumPathSensitiveReports +=
+      std::distance(Eng.getBugReporter().EQClasses_begin(),
+                    Eng.getBugReporter().EQClasses_end());
   if (BugReporterTimer)
     BugReporterTimer->startTimer();
   Eng.getBugReporter().FlushReports();
   if (BugReporterTimer)
     BugReporterTimer->stopTimer();
+
+  // The reports found before the budget was exhausted are kept.
+  CoreEngine::BudgetKind Budget = Eng.getCoreEngine().getExhaustedBudget();
+  if (Budget == CoreEngine::BudgetKind::None)
+    return false;
+  bool Reanalyze = Opts->ShouldReanalyzeWithoutInliningOnBudget &&
+                   IMode != ExprEngine::Inline_Minimal;
+  PP.getDiagnostics().Report(D->getLocation(),
+                             diag::remark_analyzer_budget_exhausted)
+      << getFunctionName(D) << (Budget == CoreEngine::BudgetKind::Memory)
+      << Reanalyze;
+  return Reanalyze;
 }
 
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,163 @@
+//===-- FunctionFingerprints.cpp --------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "FunctionFingerprints.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/ODRHash.h"
+#include "clang/Analysis/CallGraph.h"
+#include "clang/Basic/Version.h"
+#include "clang/CrossTU/CrossTranslationUnit.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace ento;
+
+FunctionFingerprints::FunctionFingerprints(const AnalyzerOptions &Opts) {
+  llvm::MD5 Hash;
+  Hash.update(getClangFullVersion());
+  for (const auto &Checker : Opts.CheckersAndPackages) {
+    Hash.update(Checker.first);
+    Hash.update(Checker.second ? "+" : "-");
+  }
+  std::vector<std::pair<StringRef, StringRef>> Config;
+  for (const auto &Entry : Opts.Config)
+    if (Entry.getKey() != "function-fingerprints-file")
+      Config.push_back({Entry.getKey(), Entry.getValue()});
+  llvm::sort(Config);
+  for (const auto &Entry : Config) {
+    Hash.update(Entry.first);
+    Hash.update("=");
+    Hash.update(Entry.second);
+  }
+  Hash.update(llvm::utostr(Opts.maxBlockVisitOnPath));
+  Hash.update(llvm::utostr(unsigned(Opts.AnalysisConstraintsOpt)));
+  Hash.update(llvm::utostr(unsigned(Opts.AnalysisStoreOpt)));
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  OptionsDigest = Result.digest().str();
+}
+
+void FunctionFingerprints::read(StringRef File) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(File);
+  if (!Buffer)
+    return;
+  // Each line holds a fingerprint followed by the lookup names of the inlined
+  // functions, separated by tabs.
+  SmallVector<StringRef, 32> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    SmallVector<StringRef, 8> Fields;
+    Line.split(Fields, '\t');
+    std::vector<std::string> &Callees = Known[Fields.front()];
+    for (StringRef Callee : makeArrayRef(Fields).drop_front())
+      Callees.push_back(Callee);
+  }
+}
+
+void FunctionFingerprints::write(StringRef File) const {
+  std::vector<StringRef> Fingerprints;
+  for (const auto &Entry : Clean)
+    Fingerprints.push_back(Entry.getKey());
+  llvm::sort(Fingerprints);
+
+  SmallString<128> TempPath(File);
+  TempPath += "-%%%%%%%%.tmp";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    for (StringRef Fingerprint : Fingerprints) {
+      OS << Fingerprint;
+      for (StringRef Callee : Clean.find(Fingerprint)->second)
+        OS << '\t' << Callee;
+      OS << '\n';
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, File))
+    llvm::sys::fs::remove(TempPath);
+}
+
+const std::pair<std::string, unsigned> &
+FunctionFingerprints::getBodyHash(const Decl *D) {
+  auto I = BodyHashes.find(D);
+  if (I != BodyHashes.end())
+    return I->second;
+
+  std::pair<std::string, unsigned> &Entry = BodyHashes[D];
+  if (const auto *ND = dyn_cast<NamedDecl>(D))
+    if (Optional<std::string> Name =
+            cross_tu::CrossTranslationUnitContext::getLookupName(ND))
+      Entry.first = std::move(*Name);
+  if (const Stmt *Body = D->getBody()) {
+    ODRHash Hash;
+    Hash.AddStmt(Body);
+    Entry.second = Hash.CalculateHash();
+  }
+  return Entry;
+}
+
+std::string FunctionFingerprints::getFingerprint(const CallGraphNode *N) {
+  if (getBodyHash(N->getDecl()).first.empty())
+    return std::string();
+
+  // The functions which the analysis of this one may inline.
+  std::vector<const std::pair<std::string, unsigned> *> Bodies;
+  llvm::SmallPtrSet<const CallGraphNode *, 16> Seen;
+  SmallVector<const CallGraphNode *, 16> Worklist;
+  Seen.insert(N);
+  Worklist.push_back(N);
+  while (!Worklist.empty()) {
+    const CallGraphNode *Node = Worklist.pop_back_val();
+    Bodies.push_back(&getBodyHash(Node->getDecl()));
+    for (const CallGraphNode *Callee : *Node)
+      if (Callee->getDecl() && Seen.insert(Callee).second)
+        Worklist.push_back(Callee);
+  }
+  std::sort(Bodies.begin() + 1, Bodies.end(),
+            [](const std::pair<std::string, unsigned> *LHS,
+               const std::pair<std::string, unsigned> *RHS) {
+              return *LHS < *RHS;
+            });
+
+  llvm::MD5 Hash;
+  Hash.update(OptionsDigest);
+  for (const auto *Body : Bodies) {
+    Hash.update(Body->first);
+    Hash.update(";");
+    Hash.update(llvm::utostr(Body->second));
+    Hash.update(";");
+  }
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return Result.digest().str();
+}
+
+bool FunctionFingerprints::isKnownClean(StringRef Fingerprint,
+                                        std::vector<std::string> &Callees) {
+  auto I = Known.find(Fingerprint);
+  if (I == Known.end())
+    return false;
+  Callees = I->second;
+  Clean[Fingerprint] = I->second;
+  return true;
+}
+
+void FunctionFingerprints::addClean(StringRef Fingerprint,
+                                    std::vector<std::string> Callees) {
+  llvm::sort(Callees);
+  Clean[Fingerprint] = std::move(Callees);
+}
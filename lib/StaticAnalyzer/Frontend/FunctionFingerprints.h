@@ -0,0 +1,81 @@
+//===-- FunctionFingerprints.h ----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file defines the clang::ento::FunctionFingerprints class, which lets
+/// the analyzer skip the path-sensitive analysis of the top-level functions
+/// that didn't change since a previous analysis found no bugs in them.
+///
+/// The fingerprint of a function covers its body and the bodies of all the
+/// functions of the translation unit it may call, as well as the options and
+/// the version of the analyzer. The functions are identified by their cross
+/// translation unit lookup names, and the bodies are hashed with ODRHash, so
+/// that the fingerprints don't depend on anything but the source.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_FUNCTIONFINGERPRINTS_H
+#define LLVM_CLANG_SA_FRONTEND_FUNCTIONFINGERPRINTS_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class AnalyzerOptions;
+class CallGraphNode;
+class Decl;
+
+namespace ento {
+
+class FunctionFingerprints {
+public:
+  FunctionFingerprints(const AnalyzerOptions &Opts);
+
+  /// Read the fingerprints recorded by a previous analysis.
+  void read(StringRef File);
+
+  /// Replace \p File with the fingerprints of the functions which were found
+  /// clean in this analysis or in the previous one.
+  void write(StringRef File) const;
+
+  /// Returns the fingerprint of the function of \p N, or an empty string if
+  /// the function can't be identified across analyses.
+  std::string getFingerprint(const CallGraphNode *N);
+
+  /// If the function with fingerprint \p Fingerprint was found clean by the
+  /// previous analysis, set \p Callees to the lookup names of the functions
+  /// its analysis inlined, and mark it clean in this analysis too.
+  bool isKnownClean(StringRef Fingerprint, std::vector<std::string> &Callees);
+
+  /// Record that the analysis of the function with fingerprint
+  /// \p Fingerprint, which inlined \p Callees, emitted no reports.
+  void addClean(StringRef Fingerprint, std::vector<std::string> Callees);
+
+private:
+  /// The hash of what, besides the source, determines the analysis results.
+  std::string OptionsDigest;
+
+  /// The lookup name and the ODRHash of the body of each function.
+  llvm::DenseMap<const Decl *, std::pair<std::string, unsigned>> BodyHashes;
+
+  /// The clean functions of the previous analysis and of this one, with the
+  /// functions that their analysis inlined.
+  llvm::StringMap<std::vector<std::string>> Known;
+  llvm::StringMap<std::vector<std::string>> Clean;
+
+  const std::pair<std::string, unsigned> &getBodyHash(const Decl *D);
+};
+
+} // namespace ento
+} // namespace clang
+
+#endif
@@ -14,10 +14,13 @@
 
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PriorityQueue.h"
 
 #include <limits>
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
 
 using namespace llvm;
@@ -134,6 +137,9 @@ public:
   // Maps preorder indices to postorder ones.
   std::vector<int> PostorderIds;
   std::vector<NodeId> NodesBfs;
+  // Hashes of the types and values of the nodes of each subtree, which are
+  // equal for identical subtrees.
+  std::vector<size_t> SubtreeHashes;
 
   int getSize() const { return Nodes.size(); }
   NodeId getRootId() const { return 0; }
@@ -305,10 +311,18 @@ void SyntaxTree::Impl::initTree() {
   setLeftMostDescendants();
   int PostorderId = 0;
   PostorderIds.resize(getSize());
+  SubtreeHashes.resize(getSize());
   std::function<void(NodeId)> PostorderTraverse = [&](NodeId Id) {
-    for (NodeId Child : getNode(Id).Children)
+    const Node &N = getNode(Id);
+    llvm::hash_code Hash = llvm::hash_combine(N.getTypeLabel(),
+                                              N.Children.size(),
+                                              getNodeValue(N));
+    for (NodeId Child : N.Children) {
       PostorderTraverse(Child);
+      Hash = llvm::hash_combine(Hash, SubtreeHashes[Child]);
+    }
     PostorderIds[Id] = PostorderId;
+    SubtreeHashes[Id] = Hash;
     ++PostorderId;
   };
   PostorderTraverse(getRootId());
@@ -758,7 +772,8 @@ public:
 bool ASTDiff::Impl::identical(NodeId Id1, NodeId Id2) const {
   const Node &N1 = T1.getNode(Id1);
   const Node &N2 = T2.getNode(Id2);
-  if (N1.Children.size() != N2.Children.size() ||
+  if (T1.SubtreeHashes[Id1] != T2.SubtreeHashes[Id2] ||
+      N1.Children.size() != N2.Children.size() ||
       !isMatchingPossible(Id1, Id2) ||
       T1.getNodeValue(Id1) != T2.getNodeValue(Id2))
     return false;
@@ -815,9 +830,26 @@ double ASTDiff::Impl::getJaccardSimilarity(const Mapping &M, NodeId Id1,
 }
 
 NodeId ASTDiff::Impl::findCandidate(const Mapping &M, NodeId Id1) const {
+  // Only the ancestors of the nodes mapped to the descendants of Id1 have
+  // common descendants with it, the similarity of the other nodes is 0.
+  std::vector<NodeId> Candidates;
+  llvm::DenseSet<int> Visited;
+  const Node &N1 = T1.getNode(Id1);
+  for (NodeId Src = Id1 + 1; Src <= N1.RightMostDescendant; ++Src) {
+    NodeId Dst = M.getDst(Src);
+    if (Dst.isInvalid())
+      continue;
+    for (NodeId Id2 = T2.getNode(Dst).Parent;
+         Id2.isValid() && Visited.insert(Id2).second;
+         Id2 = T2.getNode(Id2).Parent)
+      Candidates.push_back(Id2);
+  }
+  // Keep the first of the most similar nodes in preorder.
+  llvm::sort(Candidates);
+
   NodeId Candidate;
   double HighestSimilarity = 0.0;
-  for (NodeId Id2 : T2) {
+  for (NodeId Id2 : Candidates) {
     if (!isMatchingPossible(Id1, Id2))
       continue;
     if (M.hasDst(Id2))
@@ -881,8 +913,15 @@ Mapping ASTDiff::Impl::matchTopDown() const {
     std::vector<NodeId> H1, H2;
     H1 = L1.pop();
     H2 = L2.pop();
+    // Only the subtrees with the same hash can be identical.
+    std::unordered_map<size_t, SmallVector<NodeId, 2>> H2ByHash;
+    for (NodeId Id2 : H2)
+      H2ByHash[T2.SubtreeHashes[Id2]].push_back(Id2);
     for (NodeId Id1 : H1) {
-      for (NodeId Id2 : H2) {
+      auto Same = H2ByHash.find(T1.SubtreeHashes[Id1]);
+      if (Same == H2ByHash.end())
+        continue;
+      for (NodeId Id2 : Same->second) {
         if (identical(Id1, Id2) && !M.hasSrc(Id1) && !M.hasDst(Id2)) {
           for (int I = 0, E = T1.getNumberOfDescendants(Id1); I < E; ++I)
             M.link(Id1 + I, Id2 + I);
@@ -7,10 +7,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/AllTUsExecution.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Frontend/CompilerInvocationCache.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Tooling/ToolExecutorPluginRegistry.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <limits>
 
 namespace clang {
 namespace tooling {
@@ -52,6 +61,117 @@ private:
   std::mutex Mutex;
 };
 
+/// Tool results which are appended to a file as they are reported, instead of
+/// being kept in memory. Each result is written as
+/// "<key size> <value size>\n<key><value>\n", and flushed, so that the
+/// results of the finished translation units survive a crash.
+class StreamedToolResults : public ToolResults {
+public:
+  StreamedToolResults(StringRef Path, std::error_code &EC)
+      : Path(Path), OS(Path, EC, llvm::sys::fs::OF_Append) {}
+
+  void addResult(StringRef Key, StringRef Value) override {
+    std::unique_lock<std::mutex> LockGuard(Mutex);
+    OS << Key.size() << ' ' << Value.size() << '\n' << Key << Value << '\n';
+    OS.flush();
+  }
+
+  std::vector<std::pair<llvm::StringRef, llvm::StringRef>>
+  AllKVResults() override {
+    std::vector<std::pair<llvm::StringRef, llvm::StringRef>> KVResults;
+    forEachResult([&](StringRef Key, StringRef Value) {
+      KVResults.push_back({Key, Value});
+    });
+    return KVResults;
+  }
+
+  /// Reads the results back from the file, including the results of the
+  /// earlier executions which wrote to it.
+  void forEachResult(llvm::function_ref<void(StringRef Key, StringRef Value)>
+                         Callback) override {
+    std::unique_lock<std::mutex> LockGuard(Mutex);
+    auto Buffer = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                              /*RequiresNullTerminator=*/false);
+    if (!Buffer)
+      return;
+    StringRef Data = (*Buffer)->getBuffer();
+    // A result which was being written during a crash is incomplete.
+    while (!Data.empty()) {
+      size_t KeySize, ValueSize;
+      StringRef Sizes;
+      std::tie(Sizes, Data) = Data.split('\n');
+      StringRef KeySizeStr, ValueSizeStr;
+      std::tie(KeySizeStr, ValueSizeStr) = Sizes.split(' ');
+      if (KeySizeStr.getAsInteger(10, KeySize) ||
+          ValueSizeStr.getAsInteger(10, ValueSize) ||
+          Data.size() <= KeySize + ValueSize)
+        break;
+      Callback(Data.substr(0, KeySize), Data.substr(KeySize, ValueSize));
+      Data = Data.drop_front(KeySize + ValueSize + 1);
+    }
+    // The results refer to the buffer.
+    Buffers.push_back(std::move(*Buffer));
+  }
+
+private:
+  std::string Path;
+  llvm::raw_fd_ostream OS;
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> Buffers;
+  std::mutex Mutex;
+};
+
+/// Parses a --shard value "i/N".
+bool parseShard(StringRef Value, unsigned &Index, unsigned &Count) {
+  StringRef IndexStr, CountStr;
+  std::tie(IndexStr, CountStr) = Value.split('/');
+  return !IndexStr.getAsInteger(10, Index) &&
+         !CountStr.getAsInteger(10, Count) && Index < Count;
+}
+
+/// Reads a --timings-file, whose lines are "<milliseconds> <file>".
+llvm::StringMap<uint64_t> readTimings(StringRef Path) {
+  llvm::StringMap<uint64_t> Timings;
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return Timings;
+  SmallVector<StringRef, 64> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    StringRef Milliseconds, File;
+    std::tie(Milliseconds, File) = Line.split(' ');
+    uint64_t Value;
+    if (!Milliseconds.getAsInteger(10, Value) && !File.empty())
+      Timings[File] = Value;
+  }
+  return Timings;
+}
+
+/// Replaces the --timings-file with \p Timings, so that the executions
+/// running concurrently never read a partial file.
+bool writeTimings(StringRef Path, const llvm::StringMap<uint64_t> &Timings) {
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return false;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    for (const auto &Timing : Timings)
+      OS << Timing.second << ' ' << Timing.first() << '\n';
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
 } // namespace
 
 llvm::cl::opt<std::string>
@@ -60,10 +180,69 @@ llvm::cl::opt<std::string>
                           "This flag only applies to all-TUs."),
            llvm::cl::init(".*"));
 
+static llvm::cl::opt<bool> SharedStatCache(
+    "shared-stat-cache",
+    llvm::cl::desc("Share the results of the file system lookups between the "
+                   "translation units, assuming that the files don't change "
+                   "during the execution. This flag only applies to all-TUs."),
+    llvm::cl::init(true));
+
+static llvm::cl::opt<bool> SharedIncludeGuards(
+    "shared-include-guards",
+    llvm::cl::desc("Share the include guards of the headers between the "
+                   "translation units, so that a guarded header is skipped "
+                   "without being read. This flag only applies to all-TUs."),
+    llvm::cl::init(true));
+
+static llvm::cl::opt<bool> SharedInvocations(
+    "shared-invocations",
+    llvm::cl::desc("Parse the compile commands which only differ by their "
+                   "input, output and macros once. This flag only applies to "
+                   "all-TUs."),
+    llvm::cl::init(true));
+
+llvm::cl::opt<std::string>
+    Shard("shard",
+          llvm::cl::desc("Only process the i-th of N shards of the files, "
+                         "given as i/N, so that an execution can be split "
+                         "between N processes or machines. This flag only "
+                         "applies to all-TUs."));
+
+llvm::cl::opt<std::string> CheckpointFile(
+    "checkpoint-file",
+    llvm::cl::desc("Append the files which were processed successfully to "
+                   "this file, and skip the files it already lists, so that "
+                   "an interrupted execution can be resumed. This flag only "
+                   "applies to all-TUs."));
+
+llvm::cl::opt<std::string> ResultsFile(
+    "results-file",
+    llvm::cl::desc("Append the tool results to this file as they are "
+                   "reported, instead of keeping them in memory. This flag "
+                   "only applies to all-TUs."));
+
+llvm::cl::opt<std::string> TimingsFile(
+    "timings-file",
+    llvm::cl::desc("Process the files which took the longest in the earlier "
+                   "executions first, according to this file, then record "
+                   "how long each file took in it. This flag only applies to "
+                   "all-TUs."));
+
+static std::unique_ptr<ToolResults> createToolResults(std::string &Error) {
+  if (!ResultsFile.empty()) {
+    std::error_code EC;
+    auto Results = std::make_unique<StreamedToolResults>(ResultsFile, EC);
+    if (!EC)
+      return std::move(Results);
+    Error = "Failed to open " + ResultsFile + ": " + EC.message() + "\n";
+  }
+  return std::make_unique<ThreadSafeToolResults>();
+}
+
 AllTUsToolExecutor::AllTUsToolExecutor(
     const CompilationDatabase &Compilations, unsigned ThreadCount,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps)
-    : Compilations(Compilations), Results(new ThreadSafeToolResults),
+    : Compilations(Compilations), Results(createToolResults(ResultsError)),
       Context(Results.get()), ThreadCount(ThreadCount) {}
 
 AllTUsToolExecutor::AllTUsToolExecutor(
@@ -71,7 +250,7 @@ AllTUsToolExecutor::AllTUsToolExecutor(
     std::shared_ptr<PCHContainerOperations> PCHContainerOps)
     : OptionsParser(std::move(Options)),
       Compilations(OptionsParser->getCompilations()),
-      Results(new ThreadSafeToolResults), Context(Results.get()),
+      Results(createToolResults(ResultsError)), Context(Results.get()),
       ThreadCount(ThreadCount) {}
 
 llvm::Error AllTUsToolExecutor::execute(
@@ -85,6 +264,14 @@ llvm::Error AllTUsToolExecutor::execute(
     return make_string_error(
         "Only support executing exactly 1 action at this point.");
 
+  if (!ResultsError.empty())
+    return make_string_error(ResultsError);
+
+  unsigned ShardIndex = 0, ShardCount = 1;
+  if (!Shard.empty() && !parseShard(Shard, ShardIndex, ShardCount))
+    return make_string_error("Invalid shard '" + Shard +
+                             "', expected i/N with i < N.");
+
   std::string ErrorMsg;
   std::mutex TUMutex;
   auto AppendError = [&](llvm::Twine Err) {
@@ -97,12 +284,80 @@ llvm::Error AllTUsToolExecutor::execute(
     llvm::errs() << Msg.str() << "\n";
   };
 
+  // The files which were processed by an earlier execution.
+  llvm::StringSet<> Processed;
+  std::unique_ptr<llvm::raw_fd_ostream> Checkpoint;
+  if (!CheckpointFile.empty()) {
+    if (auto Buffer = llvm::MemoryBuffer::getFile(CheckpointFile)) {
+      SmallVector<StringRef, 64> Lines;
+      (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                   /*KeepEmpty=*/false);
+      for (StringRef Line : Lines)
+        Processed.insert(Line);
+    }
+    std::error_code EC;
+    Checkpoint = std::make_unique<llvm::raw_fd_ostream>(
+        CheckpointFile, EC, llvm::sys::fs::OF_Append);
+    if (EC)
+      return make_string_error("Failed to open " + CheckpointFile + ": " +
+                               EC.message());
+  }
+  auto MarkProcessed = [&](StringRef Path) {
+    if (!Checkpoint)
+      return;
+    std::unique_lock<std::mutex> LockGuard(TUMutex);
+    *Checkpoint << Path << '\n';
+    Checkpoint->flush();
+  };
+
   std::vector<std::string> Files;
   llvm::Regex RegexFilter(Filter);
   for (const auto& File : Compilations.getAllFiles()) {
     if (RegexFilter.match(File))
       Files.push_back(File);
   }
+  if (ShardCount > 1) {
+    // Every shard must see the files in the same order.
+    llvm::sort(Files);
+    std::vector<std::string> ShardFiles;
+    for (size_t I = ShardIndex; I < Files.size(); I += ShardCount)
+      ShardFiles.push_back(std::move(Files[I]));
+    Files = std::move(ShardFiles);
+  }
+  if (!Processed.empty()) {
+    size_t NumFiles = Files.size();
+    Files.erase(llvm::remove_if(Files,
+                                [&](const std::string &File) {
+                                  return Processed.count(File);
+                                }),
+                Files.end());
+    Log("Skipping " + std::to_string(NumFiles - Files.size()) +
+        " files which were already processed.");
+  }
+  llvm::StringMap<uint64_t> Timings;
+  if (!TimingsFile.empty()) {
+    Timings = readTimings(TimingsFile);
+    // The pool runs the files in order, so starting with the longest ones
+    // keeps a long file from running alone at the end. The files which have
+    // no timing yet might be long ones.
+    auto getTiming = [&](const std::string &File) {
+      auto It = Timings.find(File);
+      return It == Timings.end() ? std::numeric_limits<uint64_t>::max()
+                                 : It->second;
+    };
+    llvm::stable_sort(Files, [&](const std::string &A, const std::string &B) {
+      return getTiming(A) > getTiming(B);
+    });
+  }
+  auto RecordTiming = [&](StringRef Path,
+                          std::chrono::steady_clock::duration Duration) {
+    if (TimingsFile.empty())
+      return;
+    std::unique_lock<std::mutex> LockGuard(TUMutex);
+    Timings[Path] =
+        std::chrono::duration_cast<std::chrono::milliseconds>(Duration)
+            .count();
+  };
   // Add a counter to track the progress.
   const std::string TotalNumStr = std::to_string(Files.size());
   unsigned Counter = 0;
@@ -113,6 +368,12 @@ llvm::Error AllTUsToolExecutor::execute(
 
   auto &Action = Actions.front();
 
+  // The workers mostly look up the same (system) headers, so they share the
+  // results of their stats.
+  SharedFileSystemStatCache StatCache;
+  IncludeGuardCache IncludeGuards;
+  CompilerInvocationCache Invocations;
+
   {
     llvm::ThreadPool Pool(ThreadCount == 0 ? llvm::hardware_concurrency()
                                            : ThreadCount);
@@ -121,6 +382,7 @@ llvm::Error AllTUsToolExecutor::execute(
           [&](std::string Path) {
             Log("[" + std::to_string(Count()) + "/" + TotalNumStr +
                 "] Processing file " + Path);
+            auto Start = std::chrono::steady_clock::now();
             // Each thread gets an indepent copy of a VFS to allow different
             // concurrent working directories.
             IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS =
@@ -129,12 +391,21 @@ llvm::Error AllTUsToolExecutor::execute(
                            std::make_shared<PCHContainerOperations>(), FS);
             Tool.appendArgumentsAdjuster(Action.second);
             Tool.appendArgumentsAdjuster(getDefaultArgumentsAdjusters());
+            if (SharedStatCache)
+              Tool.setSharedStatCache(&StatCache);
+            if (SharedIncludeGuards)
+              Tool.setIncludeGuardCache(&IncludeGuards);
+            if (SharedInvocations)
+              Tool.setInvocationCache(&Invocations);
             for (const auto &FileAndContent : OverlayFiles)
               Tool.mapVirtualFile(FileAndContent.first(),
                                   FileAndContent.second);
             if (Tool.run(Action.first.get()))
               AppendError(llvm::Twine("Failed to run action on ") + Path +
                           "\n");
+            else
+              MarkProcessed(Path);
+            RecordTiming(Path, std::chrono::steady_clock::now() - Start);
           },
           File);
     }
@@ -142,6 +413,9 @@ llvm::Error AllTUsToolExecutor::execute(
     Pool.wait();
   }
 
+  if (!TimingsFile.empty() && !writeTimings(TimingsFile, Timings))
+    ErrorMsg += "Failed to write " + TimingsFile + "\n";
+
   if (!ErrorMsg.empty())
     return make_string_error(ErrorMsg);
 
@@ -170,7 +444,7 @@ public:
 
 static ToolExecutorPluginRegistry::Add<AllTUsToolExecutorPlugin>
     X("all-TUs", "Runs FrontendActions on all TUs in the compilation database. "
-                 "Tool results are stored in memory.");
+                 "Tool results are stored in memory, or in --results-file.");
 
 // This anchor is used to force the linker to link in the generated object file
 // and thus register the plugin.
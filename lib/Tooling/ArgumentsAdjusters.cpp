@@ -30,7 +30,7 @@ ArgumentsAdjuster getClangSyntaxOnlyAdjuster() {
       if (!Arg.startswith("-fcolor-diagnostics") &&
           !Arg.startswith("-fdiagnostics-color"))
         AdjustedArgs.push_back(Args[i]);
-      if (Arg == "-fsyntax-only")
+      if (Arg == "-fsyntax-only" || Arg == "--analyze")
         HasSyntaxOnly = true;
     }
     if (!HasSyntaxOnly)
@@ -11,23 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/Core/Replacement.h"
-#include "clang/Basic/Diagnostic.h"
-#include "clang/Basic/DiagnosticIDs.h"
-#include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
-#include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/Lexer.h"
-#include "clang/Rewrite/Core/RewriteBuffer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
-#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
-#include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -254,6 +246,17 @@ llvm::Error Replacements::add(const Replacement &R) {
     return llvm::Error::success();
   }
 
+  // Replacements are usually added in the order of their offsets, and then
+  // start after the end of the last replacement.
+  if (!Replaces.empty()) {
+    const Replacement &Last = *Replaces.rbegin();
+    if (Last.getOffset() != std::numeric_limits<unsigned>::max() &&
+        R.getOffset() > Last.getOffset() + Last.getLength()) {
+      Replaces.insert(Replaces.end(), R);
+      return llvm::Error::success();
+    }
+  }
+
   // This replacement cannot conflict with replacements that end before
   // this replacement starts or start after this replacement ends.
   // We also know that there currently are no overlapping replacements.
@@ -576,34 +579,32 @@ bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
   return Result;
 }
 
+llvm::Error applyAllReplacements(StringRef Code, const Replacements &Replaces,
+                                 llvm::raw_ostream &OS) {
+  // The replacements are sorted and don't overlap, so the code between them is
+  // copied as is.
+  unsigned Pos = 0;
+  for (const Replacement &R : Replaces) {
+    if (R.getOffset() < Pos || R.getOffset() > Code.size() ||
+        R.getLength() > Code.size() - R.getOffset())
+      return llvm::make_error<ReplacementError>(
+          replacement_error::fail_to_apply, R);
+    OS << Code.slice(Pos, R.getOffset()) << R.getReplacementText();
+    Pos = R.getOffset() + R.getLength();
+  }
+  OS << Code.drop_front(Pos);
+  return llvm::Error::success();
+}
+
 llvm::Expected<std::string> applyAllReplacements(StringRef Code,
                                                 const Replacements &Replaces) {
   if (Replaces.empty())
     return Code.str();
 
-  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFileSystem(
-      new llvm::vfs::InMemoryFileSystem);
-  FileManager Files(FileSystemOptions(), InMemoryFileSystem);
-  DiagnosticsEngine Diagnostics(
-      IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
-      new DiagnosticOptions);
-  SourceManager SourceMgr(Diagnostics, Files);
-  Rewriter Rewrite(SourceMgr, LangOptions());
-  InMemoryFileSystem->addFile(
-      "<stdin>", 0, llvm::MemoryBuffer::getMemBuffer(Code, "<stdin>"));
-  FileID ID = SourceMgr.createFileID(*Files.getFile("<stdin>"),
-                                     SourceLocation(),
-                                     clang::SrcMgr::C_User);
-  for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
-      return llvm::make_error<ReplacementError>(
-          replacement_error::fail_to_apply, Replace);
-  }
   std::string Result;
   llvm::raw_string_ostream OS(Result);
-  Rewrite.getEditBuffer(ID).write(OS);
+  if (llvm::Error Err = applyAllReplacements(Code, Replaces, OS))
+    return std::move(Err);
   OS.flush();
   return Result;
 }
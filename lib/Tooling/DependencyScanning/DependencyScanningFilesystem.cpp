@@ -8,15 +8,135 @@
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace tooling;
 using namespace dependencies;
 
+/// The on-disk cache of minimized sources stores one file per minimized
+/// source, named after the MD5 of the source's identity (see
+/// getOnDiskCacheFile). The layout of a cache file is (little endian):
+///
+///   char[8]   Magic, which also encodes the format version.
+///   uint32    The number of skipped PP ranges.
+///   uint32[2] The offset and length of each skipped PP range.
+///   char[]    The minimized contents, up to the end of the file.
+///
+/// The minimized contents come last so that they can be used in place, with
+/// the null terminator supplied by MemoryBuffer.
+static const char OnDiskCacheMagic[] = {'C', 'S', 'D', 'M', 'I', 'N', '0', '1'};
+
+/// Compute the path of the on-disk cache file for the given source file. The
+/// key covers everything that identifies a particular version of the file
+/// without reading it: its name, size, modification time and unique ID.
+static std::string getOnDiskCacheFile(StringRef CacheDir,
+                                      const llvm::vfs::Status &Stat) {
+  llvm::MD5 Hash;
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << Stat.getName() << '\0' << Stat.getSize() << '\0'
+     << Stat.getLastModificationTime().time_since_epoch().count() << '\0'
+     << Stat.getUniqueID().getDevice() << ':' << Stat.getUniqueID().getFile();
+  Hash.update(OS.str());
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+
+  SmallString<256> Path(CacheDir);
+  llvm::sys::path::append(Path, Result.digest().str() + ".min");
+  return Path.str();
+}
+
+/// Load the minimized contents of a file from the on-disk cache.
+///
+/// \returns True on success.
+static bool
+loadFromOnDiskCache(StringRef CacheFile,
+                    std::unique_ptr<llvm::MemoryBuffer> &Buffer,
+                    StringRef &Contents,
+                    PreprocessorSkippedRangeMapping &Mapping) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> MaybeBuffer =
+      llvm::MemoryBuffer::getFile(CacheFile, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/true);
+  if (!MaybeBuffer)
+    return false;
+
+  StringRef Data = (*MaybeBuffer)->getBuffer();
+  const size_t HeaderSize = sizeof(OnDiskCacheMagic) + sizeof(uint32_t);
+  if (Data.size() < HeaderSize ||
+      !Data.startswith(StringRef(OnDiskCacheMagic, sizeof(OnDiskCacheMagic))))
+    return false;
+
+  using namespace llvm::support;
+  const char *Ptr = Data.data() + sizeof(OnDiskCacheMagic);
+  uint32_t NumRanges = endian::read32le(Ptr);
+  Ptr += sizeof(uint32_t);
+  if ((Data.size() - HeaderSize) / (2 * sizeof(uint32_t)) < NumRanges)
+    return false;
+
+  PreprocessorSkippedRangeMapping Result;
+  for (uint32_t I = 0; I != NumRanges; ++I) {
+    uint32_t Offset = endian::read32le(Ptr);
+    uint32_t Length = endian::read32le(Ptr + sizeof(uint32_t));
+    Ptr += 2 * sizeof(uint32_t);
+    Result[Offset] = Length;
+  }
+
+  Contents = StringRef(Ptr, Data.end() - Ptr);
+  Mapping = std::move(Result);
+  Buffer = std::move(*MaybeBuffer);
+  return true;
+}
+
+/// Store the minimized contents of a file to the on-disk cache.
+///
+/// The cache file is written to a temporary file first and then renamed into
+/// place, so that concurrent readers never observe a partially written entry.
+/// Failures are ignored, as the cache is only an optimization.
+static void storeToOnDiskCache(StringRef CacheFile, StringRef Contents,
+                               const PreprocessorSkippedRangeMapping &Mapping) {
+  int FD;
+  SmallString<256> TempPath;
+  if (llvm::sys::fs::createUniqueFile(CacheFile + "-%%%%%%%%", FD, TempPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    using namespace llvm::support;
+    endian::Writer W(OS, little);
+    OS.write(OnDiskCacheMagic, sizeof(OnDiskCacheMagic));
+    W.write<uint32_t>(Mapping.size());
+    // Write the ranges sorted by offset to keep the output deterministic.
+    std::vector<std::pair<unsigned, unsigned>> Ranges(Mapping.begin(),
+                                                      Mapping.end());
+    llvm::sort(Ranges);
+    for (const auto &Range : Ranges) {
+      W.write<uint32_t>(Range.first);
+      W.write<uint32_t>(Range.second);
+    }
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, CacheFile))
+    llvm::sys::fs::remove(TempPath);
+}
+
 CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
-    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize) {
+    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize,
+    StringRef OnDiskCachePath) {
   // Load the file and its content from the file system.
   llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> MaybeFile =
       FS.openFileForRead(Filename);
@@ -26,6 +146,21 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
   if (!Stat)
     return Stat.getError();
 
+  std::string CacheFile;
+  if (Minimize && !OnDiskCachePath.empty()) {
+    CacheFile = getOnDiskCacheFile(OnDiskCachePath, *Stat);
+    CachedFileSystemEntry Result;
+    if (loadFromOnDiskCache(CacheFile, Result.OnDiskContents,
+                            Result.OnDiskContentsRef,
+                            Result.PPSkippedRangeMapping)) {
+      Result.MaybeStat = llvm::vfs::Status(
+          Stat->getName(), Stat->getUniqueID(), Stat->getLastModificationTime(),
+          Stat->getUser(), Stat->getGroup(), Result.OnDiskContentsRef.size(),
+          Stat->getType(), Stat->getPermissions());
+      return Result;
+    }
+  }
+
   llvm::vfs::File &F = **MaybeFile;
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> MaybeBuffer =
       F.getBuffer(Stat->getName());
@@ -88,6 +223,10 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
   }
   Result.PPSkippedRangeMapping = std::move(Mapping);
 
+  if (!CacheFile.empty())
+    storeToOnDiskCache(CacheFile, Result.Contents,
+                       Result.PPSkippedRangeMapping);
+
   return Result;
 }
 
@@ -122,6 +261,43 @@ DependencyScanningFilesystemSharedCache::get(StringRef Key) {
   return It.first->getValue();
 }
 
+void DependencyScanningFilesystemSharedCache::invalidate(StringRef Key) {
+  CacheShard &Shard = CacheShards[llvm::hash_value(Key) % NumShards];
+  std::unique_lock<std::mutex> LockGuard(Shard.CacheLock);
+  auto It = Shard.Cache.find(Key);
+  if (It == Shard.Cache.end())
+    return;
+  std::unique_lock<std::mutex> ValueLockGuard(It->getValue().ValueLock);
+  It->getValue().Value = CachedFileSystemEntry();
+  ++Generation;
+}
+
+void DependencyScanningFilesystemSharedCache::invalidateAll() {
+  for (unsigned I = 0; I < NumShards; ++I) {
+    CacheShard &Shard = CacheShards[I];
+    std::unique_lock<std::mutex> LockGuard(Shard.CacheLock);
+    for (auto &Entry : Shard.Cache) {
+      std::unique_lock<std::mutex> ValueLockGuard(Entry.getValue().ValueLock);
+      Entry.getValue().Value = CachedFileSystemEntry();
+    }
+  }
+  ++Generation;
+}
+
+void DependencyScanningFilesystemSharedCache::forEachValidEntry(
+    llvm::function_ref<void(StringRef Key, const CachedFileSystemEntry &)>
+        Fn) {
+  for (unsigned I = 0; I < NumShards; ++I) {
+    CacheShard &Shard = CacheShards[I];
+    std::unique_lock<std::mutex> LockGuard(Shard.CacheLock);
+    for (auto &Entry : Shard.Cache) {
+      std::unique_lock<std::mutex> ValueLockGuard(Entry.getValue().ValueLock);
+      if (Entry.getValue().Value.isValid())
+        Fn(Entry.getKey(), Entry.getValue().Value);
+    }
+  }
+}
+
 llvm::ErrorOr<const CachedFileSystemEntry *>
 DependencyScanningWorkerFilesystem::getOrCreateFileSystemEntry(
     const StringRef Filename) {
@@ -150,7 +326,8 @@ DependencyScanningWorkerFilesystem::getOrCreateFileSystemEntry(
             std::move(*MaybeStatus));
       else
         CacheEntry = CachedFileSystemEntry::createFileEntry(
-            Filename, FS, !KeepOriginalSource);
+            Filename, FS, !KeepOriginalSource,
+            SharedCache.getOnDiskCachePath());
     }
 
     Result = &CacheEntry;
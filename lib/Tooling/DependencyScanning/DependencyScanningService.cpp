@@ -7,13 +7,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
+#include "llvm/Support/FileSystem.h"
 
 using namespace clang;
 using namespace tooling;
 using namespace dependencies;
 
-DependencyScanningService::DependencyScanningService(ScanningMode Mode,
-                                                     bool ReuseFileManager,
-                                                     bool SkipExcludedPPRanges)
-    : Mode(Mode), ReuseFileManager(ReuseFileManager),
-      SkipExcludedPPRanges(SkipExcludedPPRanges) {}
+DependencyScanningService::DependencyScanningService(
+    ScanningMode Mode, ScanningOutputFormat Format, bool ReuseFileManager,
+    bool SkipExcludedPPRanges, StringRef MinimizedSourceCacheDir)
+    : Mode(Mode), Format(Format), ReuseFileManager(ReuseFileManager),
+      SkipExcludedPPRanges(SkipExcludedPPRanges) {
+  if (!MinimizedSourceCacheDir.empty() &&
+      !llvm::sys::fs::create_directories(MinimizedSourceCacheDir))
+    SharedCache.setOnDiskCachePath(MinimizedSourceCacheDir);
+}
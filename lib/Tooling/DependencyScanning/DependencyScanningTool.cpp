@@ -28,6 +28,10 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(const std:
       Dependencies.push_back(File);
     }
 
+    void handleModuleDependency(ModuleDeps MD) override {}
+
+    void handleContextHash(std::string Hash) override {}
+
     void printDependencies(std::string &S) {
       if (!Opts)
         return;
@@ -66,6 +70,38 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(const std:
   return Output;
 }
 
+llvm::Expected<FullDependencies>
+DependencyScanningTool::getFullDependencies(const std::string &Input,
+                                            StringRef CWD) {
+  /// Gathers the dependencies reported by the module dependency collector.
+  class FullDependencyConsumer : public DependencyConsumer {
+  public:
+    void handleFileDependency(const DependencyOutputOptions &Opts,
+                              StringRef File) override {
+      Deps.FileDeps.push_back(File);
+    }
+
+    void handleModuleDependency(ModuleDeps MD) override {
+      if (MD.ImportedByMainFile)
+        Deps.ClangModuleDeps.push_back(MD.ModuleName);
+      Deps.DiscoveredModules.push_back(std::move(MD));
+    }
+
+    void handleContextHash(std::string Hash) override {
+      Deps.ContextHash = std::move(Hash);
+    }
+
+    FullDependencies Deps;
+  };
+
+  FullDependencyConsumer Consumer;
+  auto Result =
+      Worker.computeDependencies(Input, CWD, Compilations, Consumer);
+  if (Result)
+    return std::move(Result);
+  return std::move(Consumer.Deps);
+}
+
 } // end namespace dependencies
 } // end namespace tooling
 } // end namespace clang
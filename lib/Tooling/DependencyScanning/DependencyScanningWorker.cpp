@@ -14,6 +14,7 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
 #include "clang/Tooling/Tooling.h"
 
 using namespace clang;
@@ -72,9 +73,13 @@ public:
   DependencyScanningAction(
       StringRef WorkingDirectory, DependencyConsumer &Consumer,
       llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS,
-      ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings)
+      ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings,
+      DirectoryListingCache &DirListingCache, IncludeGuardCache &IncludeGuards,
+      ScanningOutputFormat Format)
       : WorkingDirectory(WorkingDirectory), Consumer(Consumer),
-        DepFS(std::move(DepFS)), PPSkipMappings(PPSkipMappings) {}
+        DepFS(std::move(DepFS)), PPSkipMappings(PPSkipMappings),
+        DirListingCache(DirListingCache), IncludeGuards(IncludeGuards),
+        Format(Format) {}
 
   bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
                      FileManager *FileMgr,
@@ -115,6 +120,12 @@ public:
             .ExcludedConditionalDirectiveSkipMappings = PPSkipMappings;
     }
 
+    // Answer the include lookups that miss from the shared listings of the
+    // search directories.
+    Compiler.getPreprocessorOpts().HeaderSearchDirectoryListingCache =
+        &DirListingCache;
+    Compiler.getPreprocessorOpts().SharedIncludeGuards = &IncludeGuards;
+
     FileMgr->getFileSystemOpts().WorkingDir = WorkingDirectory;
     Compiler.setFileManager(FileMgr);
     Compiler.createSourceManager(*FileMgr);
@@ -131,9 +142,22 @@ public:
     // We need at least one -MT equivalent for the generator to work.
     if (Opts->Targets.empty())
       Opts->Targets = {"clang-scan-deps dependency"};
-    Compiler.addDependencyCollector(
-        std::make_shared<DependencyConsumerForwarder>(std::move(Opts),
-                                                      Consumer));
+
+    switch (Format) {
+    case ScanningOutputFormat::Make:
+      Compiler.addDependencyCollector(
+          std::make_shared<DependencyConsumerForwarder>(std::move(Opts),
+                                                        Consumer));
+      break;
+    case ScanningOutputFormat::Full:
+      Compiler.addDependencyCollector(
+          std::make_shared<ModuleDepCollector>(Compiler, Consumer));
+      // Consider different header search and diagnostic options to create
+      // different modules. This avoids the unsound aliasing of module PCMs
+      // that get built explicitly from the reported command lines.
+      Compiler.getHeaderSearchOpts().ModulesStrictContextHash = true;
+      break;
+    }
 
     auto Action = std::make_unique<PreprocessOnlyAction>();
     const bool Result = Compiler.ExecuteAction(*Action);
@@ -147,12 +171,18 @@ private:
   DependencyConsumer &Consumer;
   llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS;
   ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings;
+  DirectoryListingCache &DirListingCache;
+  IncludeGuardCache &IncludeGuards;
+  ScanningOutputFormat Format;
 };
 
 } // end anonymous namespace
 
 DependencyScanningWorker::DependencyScanningWorker(
-    DependencyScanningService &Service) {
+    DependencyScanningService &Service)
+    : Service(Service),
+      CacheGeneration(Service.getSharedCache().getGeneration()),
+      Format(Service.getFormat()) {
   DiagOpts = new DiagnosticOptions();
   PCHContainerOps = std::make_shared<PCHContainerOperations>();
   RealFS = new ProxyFileSystemWithoutChdir(llvm::vfs::getRealFileSystem());
@@ -166,6 +196,17 @@ DependencyScanningWorker::DependencyScanningWorker(
     Files = new FileManager(FileSystemOptions(), RealFS);
 }
 
+void DependencyScanningWorker::resetAfterInvalidation() {
+  if (DepFS)
+    DepFS->clearLocalCache();
+  // The skip mappings are keyed by buffers that referred to the old entries.
+  if (PPSkipMappings)
+    PPSkipMappings->clear();
+  // The file manager caches the stat results of the invalidated files too.
+  if (Files)
+    Files = new FileManager(FileSystemOptions(), RealFS);
+}
+
 static llvm::Error runWithDiags(
     DiagnosticOptions *DiagOpts,
     llvm::function_ref<bool(DiagnosticConsumer &DC)> BodyShouldSucceed) {
@@ -184,6 +225,12 @@ static llvm::Error runWithDiags(
 llvm::Error DependencyScanningWorker::computeDependencies(
     const std::string &Input, StringRef WorkingDirectory,
     const CompilationDatabase &CDB, DependencyConsumer &Consumer) {
+  unsigned Generation = Service.getSharedCache().getGeneration();
+  if (Generation != CacheGeneration) {
+    resetAfterInvalidation();
+    CacheGeneration = Generation;
+  }
+
   RealFS->setCurrentWorkingDirectory(WorkingDirectory);
   return runWithDiags(DiagOpts.get(), [&](DiagnosticConsumer &DC) {
     /// Create the tool that uses the underlying file system to ensure that any
@@ -194,8 +241,11 @@ llvm::Error DependencyScanningWorker::computeDependencies(
     Tool.setRestoreWorkingDir(false);
     Tool.setPrintErrorMessage(false);
     Tool.setDiagnosticConsumer(&DC);
+    Tool.setInvocationCache(&Service.getInvocationCache());
     DependencyScanningAction Action(WorkingDirectory, Consumer, DepFS,
-                                    PPSkipMappings.get());
+                                    PPSkipMappings.get(),
+                                    Service.getDirectoryListingCache(),
+                                    Service.getIncludeGuardCache(), Format);
     return !Tool.run(&Action);
   });
 }
@@ -0,0 +1,219 @@
+//===- ModuleDepCollector.cpp - Callbacks to collect deps -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
+
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Serialization/ASTReader.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace dependencies;
+
+std::vector<std::string> ModuleDeps::getModuleBuildArguments(
+    llvm::function_ref<const ModuleDeps &(StringRef ModuleName)>
+        LookupModuleDeps) const {
+  std::vector<std::string> Args = {"-fno-implicit-modules",
+                                   "-fmodule-name=" + ModuleName};
+
+  // Load the PCMs of the imported modules explicitly, and make their module
+  // maps known so that their headers are still treated as modular.
+  std::vector<StringRef> Imports;
+  for (const auto &Dep : ClangModuleDeps)
+    Imports.push_back(Dep.getKey());
+  llvm::sort(Imports);
+  for (StringRef Import : Imports) {
+    const ModuleDeps &Dep = LookupModuleDeps(Import);
+    if (!Dep.ClangModuleMapFile.empty())
+      Args.push_back("-fmodule-map-file=" + Dep.ClangModuleMapFile);
+    Args.push_back("-fmodule-file=" + Dep.ModulePCMPath);
+  }
+
+  if (!ClangModuleMapFile.empty()) {
+    Args.push_back("-emit-module");
+    Args.push_back("-o");
+    Args.push_back(ModulePCMPath);
+    Args.push_back(ClangModuleMapFile);
+  } else {
+    Args.push_back("-emit-module-interface");
+    Args.push_back("-o");
+    Args.push_back(ModulePCMPath);
+    Args.push_back(ModuleInterfaceFile);
+  }
+  return Args;
+}
+
+void ModuleDepCollectorPP::FileChanged(SourceLocation Loc,
+                                       FileChangeReason Reason,
+                                       SrcMgr::CharacteristicKind FileType,
+                                       FileID PrevFID) {
+  if (Reason != PPCallbacks::EnterFile)
+    return;
+
+  SourceManager &SM = Instance.getSourceManager();
+
+  // Dependency generation really does want to go all the way to the file entry
+  // for a source location to find out what is depended on. We do not want
+  // #line markers to affect dependency generation!
+  const FileEntry *File =
+      SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
+  if (!File)
+    return;
+
+  StringRef FileName =
+      llvm::sys::path::remove_leading_dotslash(File->getName());
+
+  MDC.MainDeps.push_back(FileName);
+}
+
+void ModuleDepCollectorPP::FileSkipped(const FileEntryRef &SkippedFile,
+                                       const Token &FilenameTok,
+                                       SrcMgr::CharacteristicKind FileType) {
+  // A header can be skipped the first time it is included, when its include
+  // guard is already known to be defined. Otherwise it was reported when it
+  // was entered.
+  if (Instance.getPreprocessor()
+          .getHeaderSearchInfo()
+          .getFileInfo(&SkippedFile.getFileEntry())
+          .NumIncludes)
+    return;
+  MDC.MainDeps.push_back(
+      llvm::sys::path::remove_leading_dotslash(SkippedFile.getName()));
+}
+
+void ModuleDepCollectorPP::InclusionDirective(
+    SourceLocation HashLoc, const Token &IncludeTok, StringRef FileName,
+    bool IsAngled, CharSourceRange FilenameRange, const FileEntry *File,
+    StringRef SearchPath, StringRef RelativePath, const Module *Imported,
+    SrcMgr::CharacteristicKind FileType) {
+  if (!File && !Imported) {
+    // This is a non-modular include that HeaderSearch failed to find. Add it
+    // here as `FileChanged` will never see it.
+    MDC.MainDeps.push_back(FileName);
+  }
+  handleImport(Imported);
+}
+
+void ModuleDepCollectorPP::moduleImport(SourceLocation ImportLoc,
+                                        ModuleIdPath Path,
+                                        const Module *Imported) {
+  handleImport(Imported);
+}
+
+void ModuleDepCollectorPP::handleImport(const Module *Imported) {
+  if (!Imported)
+    return;
+
+  const Module *TopLevel = Imported->getTopLevelModule();
+  MDC.Deps[MDC.ContextHash + TopLevel->getFullModuleName()]
+      .ImportedByMainFile = true;
+  DirectDeps.insert(TopLevel);
+}
+
+void ModuleDepCollectorPP::EndOfMainFile() {
+  FileID MainFileID = Instance.getSourceManager().getMainFileID();
+  if (const FileEntry *MainFile =
+          Instance.getSourceManager().getFileEntryForID(MainFileID))
+    MDC.MainFile = MainFile->getName();
+
+  for (const Module *M : DirectDeps)
+    handleTopLevelModule(M);
+
+  MDC.Consumer.handleContextHash(MDC.ContextHash);
+
+  for (auto &&I : MDC.Deps)
+    if (!I.second.ModuleName.empty())
+      MDC.Consumer.handleModuleDependency(I.second);
+
+  DependencyOutputOptions Opts;
+  for (auto &&I : MDC.MainDeps)
+    MDC.Consumer.handleFileDependency(Opts, I);
+}
+
+void ModuleDepCollectorPP::handleTopLevelModule(const Module *M) {
+  assert(M == M->getTopLevelModule() && "Expected top level module!");
+
+  auto ModI = MDC.Deps.insert(
+      std::make_pair(MDC.ContextHash + M->getFullModuleName(), ModuleDeps{}));
+
+  if (!ModI.first->second.ModuleName.empty())
+    return;
+
+  // Modules that are part of the translation unit itself (e.g. the module
+  // named by -fmodule-name) have no PCM and are not dependencies.
+  if (!M->getASTFile())
+    return;
+
+  ModuleDeps &MD = ModI.first->second;
+
+  const FileEntry *ModuleMap = Instance.getPreprocessor()
+                                   .getHeaderSearchInfo()
+                                   .getModuleMap()
+                                   .getContainingModuleMapFile(M);
+
+  MD.ClangModuleMapFile = ModuleMap ? ModuleMap->getName() : "";
+  MD.ModuleName = M->getFullModuleName();
+  MD.ModulePCMPath = M->getASTFile()->getName();
+  MD.ContextHash = MDC.ContextHash;
+  serialization::ModuleFile *MF =
+      MDC.Instance.getModuleManager()->getModuleManager().lookup(
+          M->getASTFile());
+  if (!MF)
+    return;
+  if (!ModuleMap)
+    MD.ModuleInterfaceFile = MF->OriginalSourceFileName;
+  MDC.Instance.getModuleManager()->visitInputFiles(
+      *MF, true, true, [&](const serialization::InputFile &IF, bool isSystem) {
+        if (!IF.getFile())
+          return;
+        // __inferred_module.map is the result of the way in which an implicit
+        // module build handles inferred modules. It adds an overlay VFS with
+        // this file in the proper directory and relies on the rest of Clang to
+        // handle it like normal. With explicitly built modules we don't need
+        // to play VFS tricks, so replace it with the correct module map.
+        if (IF.getFile()->getName().endswith("__inferred_module.map")) {
+          if (ModuleMap)
+            MD.FileDeps.insert(ModuleMap->getName());
+          return;
+        }
+        MD.FileDeps.insert(IF.getFile()->getName());
+      });
+
+  addAllSubmoduleDeps(M, MD);
+}
+
+void ModuleDepCollectorPP::addAllSubmoduleDeps(const Module *M,
+                                               ModuleDeps &MD) {
+  addModuleDep(M, MD);
+
+  for (const Module *SubM : M->submodules())
+    addAllSubmoduleDeps(SubM, MD);
+}
+
+void ModuleDepCollectorPP::addModuleDep(const Module *M, ModuleDeps &MD) {
+  for (const Module *Import : M->Imports) {
+    if (Import->getTopLevelModule() != M->getTopLevelModule()) {
+      MD.ClangModuleDeps.insert(Import->getTopLevelModuleName());
+      handleTopLevelModule(Import->getTopLevelModule());
+    }
+  }
+}
+
+ModuleDepCollector::ModuleDepCollector(CompilerInstance &I,
+                                       DependencyConsumer &C)
+    : Instance(I), Consumer(C), ContextHash(I.getInvocation().getModuleHash()) {
+}
+
+void ModuleDepCollector::attachToPreprocessor(Preprocessor &PP) {
+  PP.addPPCallbacks(std::make_unique<ModuleDepCollectorPP>(Instance, *this));
+}
+
+void ModuleDepCollector::attachToASTReader(ASTReader &R) {}
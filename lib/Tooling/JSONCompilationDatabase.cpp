@@ -24,10 +24,15 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ConvertUTF.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
@@ -35,7 +40,6 @@
 #include <memory>
 #include <string>
 #include <system_error>
-#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -158,6 +162,136 @@ std::vector<std::string> unescapeCommandLine(JSONCommandLineSyntax Syntax,
   return parser.parse();
 }
 
+/// Scans the values of a plain JSON database, without building them.
+class JSONScanner {
+public:
+  explicit JSONScanner(StringRef Input) : Input(Input) {}
+
+  /// Consumes \p C, after whitespace.
+  bool consume(char C) {
+    Input = Input.ltrim(" \t\r\n");
+    if (Input.empty() || Input.front() != C)
+      return false;
+    Input = Input.drop_front();
+    return true;
+  }
+
+  /// Scans a string, setting \p Raw to its contents between the quotes.
+  bool scanString(StringRef &Raw, bool &HasEscapes) {
+    if (!consume('"'))
+      return false;
+    HasEscapes = false;
+    for (size_t I = Input.find_first_of("\"\\"); I < Input.size();
+         I = Input.find_first_of("\"\\", I + 2)) {
+      if (Input[I] == '"') {
+        Raw = Input.take_front(I);
+        Input = Input.drop_front(I + 1);
+        return true;
+      }
+      HasEscapes = true;
+    }
+    return false;
+  }
+
+  /// Scans an array of strings, setting \p Raw to its contents between the
+  /// brackets.
+  bool scanStringArray(StringRef &Raw) {
+    if (!consume('['))
+      return false;
+    const char *Begin = Input.data();
+    if (!consume(']')) {
+      StringRef Value;
+      bool HasEscapes;
+      do {
+        if (!scanString(Value, HasEscapes))
+          return false;
+      } while (consume(','));
+      if (!consume(']'))
+        return false;
+    }
+    Raw = StringRef(Begin, Input.data() - 1 - Begin);
+    return true;
+  }
+
+  bool atEnd() {
+    Input = Input.ltrim(" \t\r\n");
+    return Input.empty();
+  }
+
+private:
+  StringRef Input;
+};
+
+/// Unescapes \p Raw, the contents of a JSON string.
+std::string unescapeJSONString(StringRef Raw) {
+  std::string Result;
+  Result.reserve(Raw.size());
+  for (size_t I = 0, E = Raw.size(); I < E; ++I) {
+    char C = Raw[I];
+    if (C != '\\' || I + 1 == E) {
+      Result += C;
+      continue;
+    }
+    switch (C = Raw[++I]) {
+    case 'b':
+      Result += '\b';
+      break;
+    case 'f':
+      Result += '\f';
+      break;
+    case 'n':
+      Result += '\n';
+      break;
+    case 'r':
+      Result += '\r';
+      break;
+    case 't':
+      Result += '\t';
+      break;
+    case 'u': {
+      auto ReadCodeUnit = [&](size_t At, unsigned &CodeUnit) {
+        return At + 4 <= E && !Raw.substr(At, 4).getAsInteger(16, CodeUnit);
+      };
+      unsigned CodePoint, Low;
+      if (!ReadCodeUnit(I + 1, CodePoint)) {
+        Result += C;
+        break;
+      }
+      I += 4;
+      // Combine the surrogate pairs.
+      if (CodePoint >= 0xD800 && CodePoint < 0xDC00 && I + 2 < E &&
+          Raw[I + 1] == '\\' && Raw[I + 2] == 'u' &&
+          ReadCodeUnit(I + 3, Low) && Low >= 0xDC00 && Low < 0xE000) {
+        CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+        I += 6;
+      }
+      char Buffer[UNI_MAX_UTF8_BYTES_PER_CODE_POINT];
+      char *End = Buffer;
+      if (llvm::ConvertCodePointToUTF8(CodePoint, End))
+        Result.append(Buffer, End);
+      break;
+    }
+    default:
+      // '"', '\\' and '/'.
+      Result += C;
+      break;
+    }
+  }
+  return Result;
+}
+
+/// Escapes \p Value to the contents of a JSON string.
+std::string escapeJSONString(StringRef Value) {
+  std::string Result;
+  Result.reserve(Value.size());
+  for (char C : Value) {
+    if (C == '"' || C == '\\')
+      Result += '\\';
+    Result += C;
+  }
+  return Result;
+}
+
 // This plugin locates a nearby compile_command.json file, and also infers
 // compile commands for files not present in the database.
 class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
@@ -165,8 +299,9 @@ class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
   loadFromDirectory(StringRef Directory, std::string &ErrorMessage) override {
     SmallString<1024> JSONDatabasePath(Directory);
     llvm::sys::path::append(JSONDatabasePath, "compile_commands.json");
-    auto Base = JSONCompilationDatabase::loadFromFile(
-        JSONDatabasePath, ErrorMessage, JSONCommandLineSyntax::AutoDetect);
+    auto Base = JSONCompilationDatabase::loadFromFileWithCache(
+        JSONDatabasePath, (JSONDatabasePath + ".cache").str(), ErrorMessage,
+        JSONCommandLineSyntax::AutoDetect);
     return Base ? inferTargetAndDriverMode(
                       inferMissingCompileCommands(std::move(Base)))
                 : nullptr;
@@ -210,6 +345,157 @@ JSONCompilationDatabase::loadFromFile(StringRef FilePath,
   return Database;
 }
 
+// The cache of a database holds the size and the modification time of the JSON
+// file, and the fields of each command, with the strings prefixed by their 32
+// bit size, all of it in little-endian.
+static constexpr llvm::StringLiteral CacheMagic = "CDBCACHE2";
+
+namespace {
+/// Reads the fields of the cache of a database.
+class CacheReader {
+public:
+  explicit CacheReader(StringRef Data) : Data(Data) {}
+
+  bool read(uint32_t &Value) {
+    if (Data.size() < sizeof(Value))
+      return false;
+    Value = llvm::support::endian::read32le(Data.data());
+    Data = Data.drop_front(sizeof(Value));
+    return true;
+  }
+
+  bool read(uint64_t &Value) {
+    if (Data.size() < sizeof(Value))
+      return false;
+    Value = llvm::support::endian::read64le(Data.data());
+    Data = Data.drop_front(sizeof(Value));
+    return true;
+  }
+
+  bool read(StringRef &Value) {
+    uint32_t Size;
+    if (!read(Size) || Data.size() < Size)
+      return false;
+    Value = Data.take_front(Size);
+    Data = Data.drop_front(Size);
+    return true;
+  }
+
+  size_t remaining() const { return Data.size(); }
+
+private:
+  StringRef Data;
+};
+} // namespace
+
+static bool getSizeAndModificationTime(StringRef FilePath, uint64_t &Size,
+                                       uint64_t &ModificationTime) {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(FilePath, Status))
+    return false;
+  Size = Status.getSize();
+  ModificationTime =
+      Status.getLastModificationTime().time_since_epoch().count();
+  return true;
+}
+
+std::unique_ptr<JSONCompilationDatabase>
+JSONCompilationDatabase::loadFromFileWithCache(StringRef FilePath,
+                                               StringRef CachePath,
+                                               std::string &ErrorMessage,
+                                               JSONCommandLineSyntax Syntax) {
+  uint64_t Size, ModificationTime;
+  bool HasStatus = getSizeAndModificationTime(FilePath, Size, ModificationTime);
+  if (HasStatus) {
+    // The cache can be mapped, since it is replaced rather than overwritten.
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> CacheBuffer =
+        llvm::MemoryBuffer::getFile(CachePath, /*FileSize=*/-1,
+                                    /*RequiresNullTerminator=*/false);
+    if (CacheBuffer) {
+      std::unique_ptr<JSONCompilationDatabase> Database(
+          new JSONCompilationDatabase(std::move(*CacheBuffer), Syntax));
+      if (Database->readCache(Size, ModificationTime))
+        return Database;
+    }
+  }
+
+  std::unique_ptr<JSONCompilationDatabase> Database =
+      loadFromFile(FilePath, ErrorMessage, Syntax);
+  if (!Database)
+    return nullptr;
+  // Don't cache the database if the file changed while it was read.
+  uint64_t NewSize, NewModificationTime;
+  if (HasStatus &&
+      getSizeAndModificationTime(FilePath, NewSize, NewModificationTime) &&
+      NewSize == Size && NewModificationTime == ModificationTime)
+    Database->writeCache(CachePath, Size, ModificationTime);
+  return Database;
+}
+
+bool JSONCompilationDatabase::readCache(uint64_t Size,
+                                        uint64_t ModificationTime) {
+  CacheReader Reader(Database->getBuffer());
+  StringRef Magic;
+  uint64_t CachedSize, CachedModificationTime;
+  uint32_t NumCommands;
+  if (!Reader.read(Magic) || Magic != CacheMagic ||
+      !Reader.read(CachedSize) || CachedSize != Size ||
+      !Reader.read(CachedModificationTime) ||
+      CachedModificationTime != ModificationTime || !Reader.read(NumCommands))
+    return false;
+
+  for (uint32_t I = 0; I != NumCommands; ++I) {
+    CompileCommandRef Command;
+    StringRef NativeFilePath;
+    uint32_t HasArguments;
+    if (!Reader.read(Command.Directory) || !Reader.read(Command.Filename) ||
+        !Reader.read(Command.Output) || !Reader.read(NativeFilePath) ||
+        !Reader.read(HasArguments) || !Reader.read(Command.CommandLine))
+      return false;
+    Command.HasArguments = HasArguments;
+    addCommand(NativeFilePath, std::move(Command));
+  }
+  return Reader.remaining() == 0;
+}
+
+void JSONCompilationDatabase::writeCache(StringRef CachePath, uint64_t Size,
+                                         uint64_t ModificationTime) const {
+  // Write a temporary file and rename it, so that the tools which start
+  // concurrently never read a partial cache.
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(CachePath + "-%%%%%%%%", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    llvm::support::endian::Writer W(OS, llvm::support::little);
+    auto WriteString = [&](StringRef S) {
+      W.write<uint32_t>(S.size());
+      OS << S;
+    };
+    WriteString(CacheMagic);
+    W.write<uint64_t>(Size);
+    W.write<uint64_t>(ModificationTime);
+    W.write<uint32_t>(AllCommands.size());
+    for (const CompileCommandRef &Command : AllCommands) {
+      WriteString(Command.Directory);
+      WriteString(Command.Filename);
+      WriteString(Command.Output);
+      WriteString(Command.NativeFilePath);
+      W.write<uint32_t>(Command.HasArguments);
+      WriteString(Command.CommandLine);
+    }
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, CachePath))
+    llvm::sys::fs::remove(TempPath);
+}
+
 std::unique_ptr<JSONCompilationDatabase>
 JSONCompilationDatabase::loadFromBuffer(StringRef DatabaseString,
                                         std::string &ErrorMessage,
@@ -237,13 +523,16 @@ JSONCompilationDatabase::getCompileCommands(StringRef FilePath) const {
   if (CommandsRefI == IndexByFile.end())
     return {};
   std::vector<CompileCommand> Commands;
-  getCommands(CommandsRefI->getValue(), Commands);
+  for (unsigned Position : CommandsRefI->getValue())
+    Commands.push_back(getCommand(AllCommands[Position]));
   return Commands;
 }
 
 std::vector<std::string>
 JSONCompilationDatabase::getAllFiles() const {
+  // The files are the keys of the index, so none of the commands are built.
   std::vector<std::string> Result;
+  Result.reserve(IndexByFile.size());
   for (const auto &CommandRef : IndexByFile)
     Result.push_back(CommandRef.first().str());
   return Result;
@@ -252,7 +541,9 @@ JSONCompilationDatabase::getAllFiles() const {
 std::vector<CompileCommand>
 JSONCompilationDatabase::getAllCompileCommands() const {
   std::vector<CompileCommand> Commands;
-  getCommands(AllCommands, Commands);
+  Commands.reserve(AllCommands.size());
+  for (const CompileCommandRef &CommandRef : AllCommands)
+    Commands.push_back(getCommand(CommandRef));
   return Commands;
 }
 
@@ -295,38 +586,152 @@ static bool unwrapCommand(std::vector<std::string> &Args) {
 }
 
 static std::vector<std::string>
-nodeToCommandLine(JSONCommandLineSyntax Syntax,
-                  const std::vector<llvm::yaml::ScalarNode *> &Nodes) {
-  SmallString<1024> Storage;
+toCommandLine(JSONCommandLineSyntax Syntax, StringRef CommandLine,
+              bool HasArguments) {
+  std::vector<std::string> Values;
+  if (HasArguments) {
+    // The arguments were checked when the database was scanned.
+    JSONScanner Scanner(CommandLine);
+    StringRef Value;
+    bool HasEscapes;
+    if (!Scanner.atEnd()) {
+      do {
+        Scanner.scanString(Value, HasEscapes);
+        Values.push_back(unescapeJSONString(Value));
+      } while (Scanner.consume(','));
+    }
+  } else {
+    Values.push_back(unescapeJSONString(CommandLine));
+  }
+
   std::vector<std::string> Arguments;
-  if (Nodes.size() == 1)
-    Arguments = unescapeCommandLine(Syntax, Nodes[0]->getValue(Storage));
+  if (Values.size() == 1)
+    Arguments = unescapeCommandLine(Syntax, Values[0]);
   else
-    for (const auto *Node : Nodes)
-      Arguments.push_back(Node->getValue(Storage));
+    Arguments = std::move(Values);
   // There may be multiple wrappers: using distcc and ccache together is common.
   while (unwrapCommand(Arguments))
     ;
   return Arguments;
 }
 
-void JSONCompilationDatabase::getCommands(
-    ArrayRef<CompileCommandRef> CommandsRef,
-    std::vector<CompileCommand> &Commands) const {
-  for (const auto &CommandRef : CommandsRef) {
-    SmallString<8> DirectoryStorage;
-    SmallString<32> FilenameStorage;
-    SmallString<32> OutputStorage;
-    auto Output = std::get<3>(CommandRef);
-    Commands.emplace_back(
-        std::get<0>(CommandRef)->getValue(DirectoryStorage),
-        std::get<1>(CommandRef)->getValue(FilenameStorage),
-        nodeToCommandLine(Syntax, std::get<2>(CommandRef)),
-        Output ? Output->getValue(OutputStorage) : "");
+CompileCommand
+JSONCompilationDatabase::getCommand(const CompileCommandRef &CommandRef) const {
+  return CompileCommand(
+      CommandRef.Directory, CommandRef.Filename,
+      toCommandLine(Syntax, CommandRef.CommandLine, CommandRef.HasArguments),
+      CommandRef.Output);
+}
+
+StringRef JSONCompilationDatabase::getValue(llvm::yaml::ScalarNode *Node) {
+  SmallString<128> Storage;
+  StringRef Value = Node->getValue(Storage);
+  if (Value.data() == Storage.data())
+    return Strings.save(Value);
+  return Value;
+}
+
+void JSONCompilationDatabase::addCommand(StringRef NativeFilePath,
+                                         CompileCommandRef Command) {
+  auto &Entry = *IndexByFile.try_emplace(NativeFilePath).first;
+  // The key of the index outlives the commands.
+  Command.NativeFilePath = Entry.first();
+  Entry.second.push_back(AllCommands.size());
+  AllCommands.push_back(std::move(Command));
+  MatchTrie.insert(NativeFilePath);
+}
+
+static void getNativeFilePath(StringRef Directory, StringRef FileName,
+                              SmallVectorImpl<char> &NativeFilePath) {
+  if (llvm::sys::path::is_relative(FileName)) {
+    SmallString<128> AbsolutePath(Directory);
+    llvm::sys::path::append(AbsolutePath, FileName);
+    llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/ true);
+    llvm::sys::path::native(AbsolutePath, NativeFilePath);
+  } else {
+    llvm::sys::path::native(FileName, NativeFilePath);
   }
 }
 
 bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
+  // Only the databases which aren't plain JSON, and the invalid ones, need a
+  // tree of their values.
+  return scan() || parseYAML(ErrorMessage);
+}
+
+bool JSONCompilationDatabase::scan() {
+  JSONScanner Scanner(Database->getBuffer());
+  // The values with escapes are unescaped in Strings, even if the scan fails.
+  auto GetValue = [this](StringRef Raw, bool HasEscapes) {
+    return HasEscapes ? Strings.save(unescapeJSONString(Raw)) : Raw;
+  };
+  std::vector<CompileCommandRef> Commands;
+  if (!Scanner.consume('['))
+    return false;
+  if (!Scanner.consume(']')) {
+    do {
+      if (!Scanner.consume('{'))
+        return false;
+      CompileCommandRef Cmd;
+      bool HasDirectory = false, HasFile = false, HasCommandLine = false;
+      if (!Scanner.consume('}')) {
+        do {
+          StringRef Key, Value;
+          bool HasEscapes;
+          if (!Scanner.scanString(Key, HasEscapes) || HasEscapes ||
+              !Scanner.consume(':'))
+            return false;
+          if (Key == "arguments") {
+            if (!Scanner.scanStringArray(Cmd.CommandLine))
+              return false;
+            Cmd.HasArguments = true;
+            HasCommandLine = true;
+            continue;
+          }
+          if (!Scanner.scanString(Value, HasEscapes))
+            return false;
+          if (Key == "directory") {
+            Cmd.Directory = GetValue(Value, HasEscapes);
+            HasDirectory = true;
+          } else if (Key == "command") {
+            if (!Cmd.HasArguments)
+              Cmd.CommandLine = Value;
+            HasCommandLine = true;
+          } else if (Key == "file") {
+            Cmd.Filename = GetValue(Value, HasEscapes);
+            HasFile = true;
+          } else if (Key == "output") {
+            Cmd.Output = GetValue(Value, HasEscapes);
+          } else {
+            return false;
+          }
+        } while (Scanner.consume(','));
+        if (!Scanner.consume('}'))
+          return false;
+      }
+      if (!HasDirectory || !HasFile || !HasCommandLine)
+        return false;
+      Commands.push_back(std::move(Cmd));
+    } while (Scanner.consume(','));
+    if (!Scanner.consume(']'))
+      return false;
+  }
+  if (!Scanner.atEnd())
+    return false;
+
+  SmallString<128> NativeFilePath;
+  for (CompileCommandRef &Cmd : Commands) {
+    NativeFilePath.clear();
+    getNativeFilePath(Cmd.Directory, Cmd.Filename, NativeFilePath);
+    addCommand(NativeFilePath, std::move(Cmd));
+  }
+  return true;
+}
+
+bool JSONCompilationDatabase::parseYAML(std::string &ErrorMessage) {
+  // The values of the nodes are kept, but not the nodes.
+  llvm::SourceMgr SM;
+  llvm::yaml::Stream YAMLStream(Database->getBuffer(), SM);
   llvm::yaml::document_iterator I = YAMLStream.begin();
   if (I == YAMLStream.end()) {
     ErrorMessage = "Error while parsing YAML.";
@@ -350,6 +755,7 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
     }
     llvm::yaml::ScalarNode *Directory = nullptr;
     llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
+    bool IsCommand = false;
     llvm::yaml::ScalarNode *File = nullptr;
     llvm::yaml::ScalarNode *Output = nullptr;
     for (auto& NextKeyValue : *Object) {
@@ -378,6 +784,7 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
         Directory = ValueString;
       } else if (KeyValue == "arguments") {
         Command = std::vector<llvm::yaml::ScalarNode *>();
+        IsCommand = false;
         for (auto &Argument : *SequenceString) {
           auto *Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
           if (!Scalar) {
@@ -387,8 +794,10 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
           Command->push_back(Scalar);
         }
       } else if (KeyValue == "command") {
-        if (!Command)
+        if (!Command) {
           Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
+          IsCommand = true;
+        }
       } else if (KeyValue == "file") {
         File = ValueString;
       } else if (KeyValue == "output") {
@@ -411,23 +820,31 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
       ErrorMessage = "Missing key: \"directory\".";
       return false;
     }
-    SmallString<8> FileStorage;
-    StringRef FileName = File->getValue(FileStorage);
-    SmallString<128> NativeFilePath;
-    if (llvm::sys::path::is_relative(FileName)) {
-      SmallString<8> DirectoryStorage;
-      SmallString<128> AbsolutePath(
-          Directory->getValue(DirectoryStorage));
-      llvm::sys::path::append(AbsolutePath, FileName);
-      llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/ true);
-      llvm::sys::path::native(AbsolutePath, NativeFilePath);
+    CompileCommandRef Cmd;
+    Cmd.Directory = getValue(Directory);
+    Cmd.Filename = getValue(File);
+    if (Output)
+      Cmd.Output = getValue(Output);
+    // Keep the command line in JSON, like the scanned databases.
+    Cmd.HasArguments = !IsCommand;
+    if (IsCommand) {
+      Cmd.CommandLine =
+          Strings.save(escapeJSONString(getValue(Command->front())));
     } else {
-      llvm::sys::path::native(FileName, NativeFilePath);
+      std::string CommandLine;
+      for (llvm::yaml::ScalarNode *Node : *Command) {
+        if (!CommandLine.empty())
+          CommandLine += ',';
+        CommandLine += '"';
+        CommandLine += escapeJSONString(getValue(Node));
+        CommandLine += '"';
+      }
+      Cmd.CommandLine = Strings.save(CommandLine);
     }
-    auto Cmd = CompileCommandRef(Directory, File, *Command, Output);
-    IndexByFile[NativeFilePath].push_back(Cmd);
-    AllCommands.push_back(Cmd);
-    MatchTrie.insert(NativeFilePath);
+
+    SmallString<128> NativeFilePath;
+    getNativeFilePath(Cmd.Directory, Cmd.Filename, NativeFilePath);
+    addCommand(NativeFilePath, std::move(Cmd));
   }
   return true;
 }
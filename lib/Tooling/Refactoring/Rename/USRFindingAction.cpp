@@ -21,12 +21,16 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Index/IndexRecord.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/Refactoring/Rename/USRFinder.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
 
 #include <algorithm>
 #include <set>
@@ -183,6 +187,99 @@ std::vector<std::string> getUSRsForDeclaration(const NamedDecl *ND,
   return Finder.Find();
 }
 
+namespace {
+/// Finds the files which may have occurrences of some USRs in an index. The
+/// records and the modification times of the files are shared between the
+/// units, since the units of a project mostly index the same headers.
+class IndexedOccurrenceFinder {
+public:
+  IndexedOccurrenceFinder(StringRef RecordDir,
+                          ArrayRef<std::vector<std::string>> USRList)
+      : RecordDir(RecordDir), USRList(USRList) {}
+
+  bool mayHaveOccurrences(StringRef File) {
+    SmallString<256> RealPath;
+    if (sys::fs::real_path(File, RealPath))
+      return true;
+    std::string UnitPath = index::IndexUnit::getPath(RecordDir, RealPath);
+    sys::fs::file_status Status;
+    if (sys::fs::status(UnitPath, Status))
+      return true;
+    sys::TimePoint<> UnitTime = Status.getLastModificationTime();
+    Expected<index::IndexUnit> Unit = index::IndexUnit::read(UnitPath);
+    if (!Unit) {
+      consumeError(Unit.takeError());
+      return true;
+    }
+
+    if (isModifiedAfter(RealPath, UnitTime))
+      return true;
+    for (const std::string &RecordPath : Unit->RecordPaths) {
+      const RecordInfo &Info = getRecordInfo(RecordPath);
+      if (!Info.Valid || Info.HasOccurrences ||
+          isModifiedAfter(Info.FilePath, UnitTime))
+        return true;
+    }
+    return false;
+  }
+
+private:
+  struct RecordInfo {
+    bool Valid = false;
+    bool HasOccurrences = false;
+    /// The path of the indexed file.
+    std::string FilePath;
+  };
+
+  const RecordInfo &getRecordInfo(StringRef RecordPath) {
+    auto Inserted = Records.try_emplace(RecordPath);
+    RecordInfo &Info = Inserted.first->second;
+    if (!Inserted.second)
+      return Info;
+    auto Reader = index::IndexRecordReader::create(RecordPath);
+    if (!Reader) {
+      consumeError(Reader.takeError());
+      return Info;
+    }
+    Info.Valid = true;
+    Info.FilePath = std::string((*Reader)->getFilePath());
+    for (const std::vector<std::string> &USRs : USRList)
+      for (const std::string &USR : USRs)
+        if ((*Reader)->findSymbol(USR))
+          Info.HasOccurrences = true;
+    return Info;
+  }
+
+  bool isModifiedAfter(StringRef Path, sys::TimePoint<> Time) {
+    auto Inserted = ModificationTimes.try_emplace(Path);
+    Optional<sys::TimePoint<>> &ModificationTime = Inserted.first->second;
+    if (Inserted.second) {
+      sys::fs::file_status Status;
+      if (!sys::fs::status(Path, Status))
+        ModificationTime = Status.getLastModificationTime();
+    }
+    // The files which can't be found were removed or moved.
+    return !ModificationTime || *ModificationTime > Time;
+  }
+
+  std::string RecordDir;
+  ArrayRef<std::vector<std::string>> USRList;
+  StringMap<RecordInfo> Records;
+  StringMap<Optional<sys::TimePoint<>>> ModificationTimes;
+};
+} // end anonymous namespace
+
+std::vector<std::string>
+getFilesWithUSROccurrences(ArrayRef<std::string> Files, StringRef RecordDir,
+                           ArrayRef<std::vector<std::string>> USRList) {
+  IndexedOccurrenceFinder Finder(RecordDir, USRList);
+  std::vector<std::string> Result;
+  for (const std::string &File : Files)
+    if (Finder.mayHaveOccurrences(File))
+      Result.push_back(File);
+  return Result;
+}
+
 class NamedDeclFindingConsumer : public ASTConsumer {
 public:
   NamedDeclFindingConsumer(ArrayRef<unsigned> SymbolOffsets,
@@ -21,9 +21,12 @@
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -274,6 +277,54 @@ std::vector<syntax::Token> syntax::tokenize(FileID FID, const SourceManager &SM,
   return Tokens;
 }
 
+std::vector<syntax::Token>
+syntax::SpelledTokenCache::tokenize(FileID FID, const SourceManager &SM,
+                                    const LangOptions &LO) {
+  // The keywords and the lexing of some tokens depend on the language options.
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+#define LANGOPT(Name, Bits, Default, Description) OS << LO.Name << ' ';
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description)                   \
+  OS << unsigned(LO.get##Name()) << ' ';
+#include "clang/Basic/LangOptions.def"
+  llvm::StringRef Contents = SM.getBufferData(FID);
+  auto Hash = llvm::SHA1::hash(llvm::arrayRefFromStringRef(Contents));
+  OS << Contents.size() << ' ';
+  OS.write(reinterpret_cast<const char *>(Hash.data()), Hash.size());
+  OS.flush();
+
+  std::shared_ptr<const CachedTokens> Cached;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Files.find(Key);
+    if (It != Files.end())
+      Cached = It->second;
+  }
+
+  SourceLocation Start = SM.getLocForStartOfFile(FID);
+  if (!Cached) {
+    std::vector<syntax::Token> Tokens = syntax::tokenize(FID, SM, LO);
+    auto NewTokens = std::make_shared<CachedTokens>();
+    NewTokens->reserve(Tokens.size());
+    // The tokens are at their offsets from the start of the file. This doesn't
+    // use SourceManager::getFileOffset(), which isn't thread-safe.
+    for (const syntax::Token &T : Tokens)
+      NewTokens->push_back(
+          {T.location().getRawEncoding() - Start.getRawEncoding(), T.length(),
+           T.kind()});
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Files.try_emplace(Key, std::move(NewTokens));
+    return Tokens;
+  }
+
+  std::vector<syntax::Token> Tokens;
+  Tokens.reserve(Cached->size());
+  for (const CachedToken &T : *Cached)
+    Tokens.push_back(
+        syntax::Token(Start.getLocWithOffset(T.Offset), T.Length, T.Kind));
+  return Tokens;
+}
+
 /// Records information reqired to construct mappings for the token buffer that
 /// we are collecting.
 class TokenCollector::CollectPPExpansions : public PPCallbacks {
@@ -320,7 +371,9 @@ private:
 ///          - skipped pp regions,
 ///          - ...
 
-TokenCollector::TokenCollector(Preprocessor &PP) : PP(PP) {
+TokenCollector::TokenCollector(Preprocessor &PP,
+                               SpelledTokenCache *SharedTokens)
+    : PP(PP), SharedTokens(SharedTokens) {
   // Collect the expanded token stream during preprocessing.
   PP.setTokenWatcher([this](const clang::Token &T) {
     if (T.isAnnotation())
@@ -346,9 +399,10 @@ TokenCollector::TokenCollector(Preprocessor &PP) : PP(PP) {
 class TokenCollector::Builder {
 public:
   Builder(std::vector<syntax::Token> Expanded, PPExpansions CollectedExpansions,
-          const SourceManager &SM, const LangOptions &LangOpts)
+          const SourceManager &SM, const LangOptions &LangOpts,
+          SpelledTokenCache *SharedTokens)
       : Result(SM), CollectedExpansions(std::move(CollectedExpansions)), SM(SM),
-        LangOpts(LangOpts) {
+        LangOpts(LangOpts), SharedTokens(SharedTokens) {
     Result.ExpandedTokens = std::move(Expanded);
   }
 
@@ -436,6 +490,7 @@ private:
   /// Initializes TokenBuffer::Files and fills spelled tokens and expanded
   /// ranges for each of the files.
   void buildSpelledTokens() {
+    std::vector<FileID> NewFiles;
     for (unsigned I = 0; I < Result.ExpandedTokens.size(); ++I) {
       auto FID =
           SM.getFileID(SM.getExpansionLoc(Result.ExpandedTokens[I].location()));
@@ -448,8 +503,22 @@ private:
 
       // This is the first time we see this file.
       File.BeginExpanded = I;
-      File.SpelledTokens = tokenize(FID, SM, LangOpts);
+      NewFiles.push_back(FID);
+      // Load the buffer here, the SourceManager can't do it concurrently.
+      SM.getBuffer(FID);
     }
+
+    // The files are lexed independently, in parallel. The main file is
+    // usually not included by other translation units, so it isn't cached.
+    std::vector<std::vector<syntax::Token>> SpelledTokens(NewFiles.size());
+    llvm::parallelForEachN(0, NewFiles.size(), [&](size_t I) {
+      FileID FID = NewFiles[I];
+      SpelledTokens[I] = SharedTokens && FID != SM.getMainFileID()
+                             ? SharedTokens->tokenize(FID, SM, LangOpts)
+                             : tokenize(FID, SM, LangOpts);
+    });
+    for (size_t I = 0; I < NewFiles.size(); ++I)
+      Result.Files[NewFiles[I]].SpelledTokens = std::move(SpelledTokens[I]);
   }
 
   void consumeEmptyMapping(TokenBuffer::MarkedFile &File, unsigned EndOffset,
@@ -547,13 +616,14 @@ private:
   PPExpansions CollectedExpansions;
   const SourceManager &SM;
   const LangOptions &LangOpts;
+  SpelledTokenCache *SharedTokens;
 };
 
 TokenBuffer TokenCollector::consume() && {
   PP.setTokenWatcher(nullptr);
   Collector->disable();
   return Builder(std::move(Expanded), std::move(Expansions),
-                 PP.getSourceManager(), PP.getLangOpts())
+                 PP.getSourceManager(), PP.getLangOpts(), SharedTokens)
       .build();
 }
 
@@ -16,6 +16,7 @@
 #include "clang/Basic/DiagnosticIDs.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/Driver/Compilation.h"
@@ -27,6 +28,7 @@
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/CompilerInvocationCache.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendOptions.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
@@ -141,11 +143,17 @@ namespace clang {
 namespace tooling {
 
 /// Returns a clang build invocation initialized from the CC1 flags.
-CompilerInvocation *newInvocation(
-    DiagnosticsEngine *Diagnostics, const llvm::opt::ArgStringList &CC1Args) {
+CompilerInvocation *newInvocation(DiagnosticsEngine *Diagnostics,
+                                  const llvm::opt::ArgStringList &CC1Args,
+                                  CompilerInvocationCache *Cache) {
   assert(!CC1Args.empty() && "Must at least contain the program name!");
-  CompilerInvocation *Invocation = new CompilerInvocation;
-  CompilerInvocation::CreateFromArgs(*Invocation, CC1Args, *Diagnostics);
+  CompilerInvocation *Invocation;
+  if (Cache) {
+    Invocation = Cache->createInvocation(CC1Args, *Diagnostics).release();
+  } else {
+    Invocation = new CompilerInvocation;
+    CompilerInvocation::CreateFromArgs(*Invocation, CC1Args, *Diagnostics);
+  }
   Invocation->getFrontendOpts().DisableFree = false;
   Invocation->getCodeGenOpts().DisableFree = false;
   return Invocation;
@@ -345,7 +353,7 @@ bool ToolInvocation::run() {
   if (!CC1Args)
     return false;
   std::unique_ptr<CompilerInvocation> Invocation(
-      newInvocation(&Diagnostics, *CC1Args));
+      newInvocation(&Diagnostics, *CC1Args, Invocations));
   // FIXME: remove this when all users have migrated!
   for (const auto &It : MappedFileContents) {
     // Inject the code as the given file name into the preprocessor options.
@@ -354,6 +362,8 @@ bool ToolInvocation::run() {
     Invocation->getPreprocessorOpts().addRemappedFile(It.getKey(),
                                                       Input.release());
   }
+  if (IncludeGuards)
+    Invocation->getPreprocessorOpts().SharedIncludeGuards = IncludeGuards;
   return runInvocation(BinaryName, Compilation.get(), std::move(Invocation),
                        std::move(PCHContainerOps));
 }
@@ -543,9 +553,14 @@ int ClangTool::run(ToolAction *Action) {
       // FIXME: We need a callback mechanism for the tool writer to output a
       // customized message for each file.
       LLVM_DEBUG({ llvm::dbgs() << "Processing: " << File << ".\n"; });
+      // The stat cache of the file manager is cleared after each invocation.
+      if (SharedStatCache)
+        Files->setStatCache(SharedStatCache->createStatCache());
       ToolInvocation Invocation(std::move(CommandLine), Action, Files.get(),
                                 PCHContainerOps);
       Invocation.setDiagnosticConsumer(DiagConsumer);
+      Invocation.setIncludeGuardCache(IncludeGuards);
+      Invocation.setInvocationCache(Invocations);
 
       if (!Invocation.run()) {
         // FIXME: Diagnostics should be used instead.
@@ -606,6 +621,18 @@ void ClangTool::setPrintErrorMessage(bool PrintErrorMessage) {
   this->PrintErrorMessage = PrintErrorMessage;
 }
 
+void ClangTool::setSharedStatCache(SharedFileSystemStatCache *Cache) {
+  SharedStatCache = Cache;
+}
+
+void ClangTool::setIncludeGuardCache(IncludeGuardCache *Cache) {
+  IncludeGuards = Cache;
+}
+
+void ClangTool::setInvocationCache(CompilerInvocationCache *Cache) {
+  Invocations = Cache;
+}
+
 namespace clang {
 namespace tooling {
 
@@ -11,7 +11,10 @@
 #include "clang/ASTMatchers/ASTMatchersInternal.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Tooling/Refactoring/AtomicChange.h"
+#include "clang/Tooling/Transformer/SourceCode.h"
 #include "llvm/Support/Error.h"
+#include <algorithm>
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -19,6 +22,47 @@ using namespace clang;
 using namespace tooling;
 
 using ast_matchers::MatchFinder;
+using ast_matchers::internal::DynTypedMatcher;
+
+// Passes the change of the transformations of a match of \p Case to
+// \p Consumer.
+static void
+consumeChange(const MatchFinder::MatchResult &Result,
+              const transformer::RewriteRule::Case &Case,
+              ArrayRef<transformer::detail::Transformation> Transformations,
+              const Transformer::ChangeConsumer &Consumer) {
+  // Record the results in the AtomicChange, anchored at the location of the
+  // first change.
+  AtomicChange AC(*Result.SourceManager, Transformations[0].Range.getBegin());
+  for (const auto &T : Transformations) {
+    if (auto Err = AC.replace(*Result.SourceManager, T.Range, T.Replacement)) {
+      Consumer(std::move(Err));
+      return;
+    }
+  }
+
+  for (const auto &I : Case.AddedIncludes) {
+    auto &Header = I.first;
+    switch (I.second) {
+    case transformer::IncludeFormat::Quoted:
+      AC.addHeader(Header);
+      break;
+    case transformer::IncludeFormat::Angled:
+      AC.addHeader((llvm::Twine("<") + Header + ">").str());
+      break;
+    }
+  }
+
+  Consumer(std::move(AC));
+}
+
+static void noteSkippedMatch(const MatchFinder::MatchResult &Result,
+                             StringRef Reason) {
+  transformer::detail::getRuleMatchLoc(Result).print(
+      llvm::errs() << "note: skipping " << Reason << "match at loc ",
+      *Result.SourceManager);
+  llvm::errs() << "\n";
+}
 
 void Transformer::registerMatchers(MatchFinder *MatchFinder) {
   for (auto &Matcher : transformer::detail::buildMatchers(Rule))
@@ -39,34 +83,104 @@ void Transformer::run(const MatchFinder::MatchResult &Result) {
 
   if (Transformations->empty()) {
     // No rewrite applied (but no error encountered either).
-    transformer::detail::getRuleMatchLoc(Result).print(
-        llvm::errs() << "note: skipping match at loc ", *Result.SourceManager);
-    llvm::errs() << "\n";
+    noteSkippedMatch(Result, "");
     return;
   }
 
-  // Record the results in the AtomicChange, anchored at the location of the
-  // first change.
-  AtomicChange AC(*Result.SourceManager,
-                  (*Transformations)[0].Range.getBegin());
-  for (const auto &T : *Transformations) {
-    if (auto Err = AC.replace(*Result.SourceManager, T.Range, T.Replacement)) {
-      Consumer(std::move(Err));
-      return;
+  consumeChange(Result, Case, *Transformations, Consumer);
+}
+
+// The prefix of the ids which identify the rule of a match of a
+// RuleSetTransformer.
+static constexpr llvm::StringLiteral RuleIDPrefix = "___rule___";
+
+void RuleSetTransformer::registerMatchers(MatchFinder *MatchFinder) {
+  for (size_t I = 0, N = Rules.size(); I < N; ++I) {
+    std::string RuleID = (RuleIDPrefix + Twine(I)).str();
+    for (DynTypedMatcher &Matcher :
+         transformer::detail::buildMatchers(Rules[I])) {
+      Matcher.setAllowBind(true);
+      // `tryBind` is guaranteed to succeed, because `AllowBind` was set.
+      MatchFinder->addDynamicMatcher(*Matcher.tryBind(RuleID), this);
     }
   }
+}
 
-  for (const auto &I : Case.AddedIncludes) {
-    auto &Header = I.first;
-    switch (I.second) {
-    case transformer::IncludeFormat::Quoted:
-      AC.addHeader(Header);
-      break;
-    case transformer::IncludeFormat::Angled:
-      AC.addHeader((llvm::Twine("<") + Header + ">").str());
+void RuleSetTransformer::onStartOfTranslationUnit() { EditedRanges.clear(); }
+
+bool RuleSetTransformer::conflicts(const SourceManager &SM,
+                                   CharSourceRange Range) const {
+  std::pair<FileID, unsigned> Begin = SM.getDecomposedLoc(Range.getBegin());
+  unsigned End = SM.getDecomposedLoc(Range.getEnd()).second;
+  // Insertions at the same offset conflict too, since their order would be
+  // unspecified.
+  auto Next = EditedRanges.lower_bound(Begin);
+  if (Next != EditedRanges.end() && Next->first.first == Begin.first &&
+      (Next->first.second < End || Next->first.second == Begin.second))
+    return true;
+  if (Next == EditedRanges.begin())
+    return false;
+  auto Prev = std::prev(Next);
+  return Prev->first.first == Begin.first && Prev->second > Begin.second;
+}
+
+void RuleSetTransformer::run(const MatchFinder::MatchResult &Result) {
+  if (Result.Context->getDiagnostics().hasErrorOccurred())
+    return;
+
+  const transformer::RewriteRule *Rule = nullptr;
+  for (const auto &Node : Result.Nodes.getMap()) {
+    StringRef ID = Node.first;
+    size_t Index;
+    if (ID.consume_front(RuleIDPrefix) && !ID.getAsInteger(10, Index)) {
+      Rule = &Rules[Index];
       break;
     }
   }
+  assert(Rule && "Match of a RuleSetTransformer without a rule.");
+  const transformer::RewriteRule::Case &Case =
+      transformer::detail::findSelectedCase(Result, *Rule);
 
-  Consumer(std::move(AC));
+  // Select the ranges of all of the edits before generating any of the
+  // replacements, which are only needed if the match is kept.
+  const SourceManager &SM = *Result.SourceManager;
+  SmallVector<transformer::detail::Transformation, 1> Transformations;
+  for (const transformer::ASTEdit &Edit : Case.Edits) {
+    Expected<CharSourceRange> Range = Edit.TargetRange(Result);
+    if (!Range) {
+      Consumer(Range.takeError());
+      return;
+    }
+    llvm::Optional<CharSourceRange> EditRange =
+        tooling::getRangeForEdit(*Range, *Result.Context);
+    if (!EditRange) {
+      noteSkippedMatch(Result, "");
+      return;
+    }
+    if (conflicts(SM, *EditRange)) {
+      noteSkippedMatch(Result, "conflicting ");
+      return;
+    }
+    transformer::detail::Transformation T;
+    T.Range = *EditRange;
+    Transformations.push_back(std::move(T));
+  }
+  if (Transformations.empty())
+    return;
+
+  for (size_t I = 0, N = Transformations.size(); I < N; ++I) {
+    auto Replacement = Case.Edits[I].Replacement(Result);
+    if (!Replacement) {
+      Consumer(Replacement.takeError());
+      return;
+    }
+    Transformations[I].Replacement = std::move(*Replacement);
+  }
+
+  for (const auto &T : Transformations) {
+    std::pair<FileID, unsigned> Begin = SM.getDecomposedLoc(T.Range.getBegin());
+    unsigned &End = EditedRanges[Begin];
+    End = std::max(End, SM.getDecomposedLoc(T.Range.getEnd()).second);
+  }
+  consumeChange(Result, Case, Transformations, Consumer);
 }
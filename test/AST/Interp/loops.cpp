@@ -0,0 +1,90 @@
+// RUN: %clang_cc1 -std=c++17 -fsyntax-only -fforce-experimental-new-constant-interpreter %s -verify
+// RUN: %clang_cc1 -std=c++17 -fsyntax-only %s -verify
+// expected-no-diagnostics
+
+constexpr int sum_while(int n) {
+  int i = 0;
+  int sum = 0;
+  while (i < n) {
+    sum += i;
+    ++i;
+  }
+  return sum;
+}
+static_assert(sum_while(10) == 45, "");
+static_assert(sum_while(0) == 0, "");
+
+constexpr int sum_for(int n) {
+  int sum = 0;
+  for (int i = 0; i < n; i++)
+    sum = sum + i;
+  return sum;
+}
+static_assert(sum_for(10) == 45, "");
+
+constexpr int sum_do(int n) {
+  int sum = 0;
+  do {
+    sum += n;
+    n -= 1;
+  } while (n > 0);
+  return sum;
+}
+static_assert(sum_do(4) == 10, "");
+static_assert(sum_do(0) == 0, "");
+
+constexpr int break_continue(int n) {
+  int sum = 0;
+  for (int i = 0;; ++i) {
+    if (i == n)
+      break;
+    if (i == 2)
+      continue;
+    sum += i;
+  }
+  return sum;
+}
+static_assert(break_continue(5) == 8, "");
+
+constexpr int nested(int n) {
+  int count = 0;
+  for (int i = 0; i < n; ++i) {
+    int j = 0;
+    for (;;) {
+      if (j == i)
+        break;
+      ++j;
+      count *= 1;
+      count += 1;
+    }
+  }
+  return count;
+}
+static_assert(nested(4) == 6, "");
+
+constexpr int fib(int n) {
+  if (n < 2)
+    return n;
+  return fib(n - 1) + fib(n - 2);
+}
+static_assert(fib(10) == 55, "");
+
+constexpr int fib_iter(int n) {
+  int a = 0;
+  int b = 1;
+  for (int i = 0; i < n; ++i) {
+    int t = a + b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+static_assert(fib_iter(10) == fib(10), "");
+
+constexpr int sum_fibs(int n) {
+  int sum = 0;
+  for (int i = 0; i <= n; --n)
+    sum += fib_iter(n);
+  return sum;
+}
+static_assert(sum_fibs(5) == 12, "");
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -ast-dump=json-compact %s \
+// RUN: | FileCheck --check-prefix=COMPACT %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -ast-dump=json \
+// RUN:   -ast-dump-json-no-locations -ast-dump-json-no-implicit %s \
+// RUN: | FileCheck --check-prefix=FILTERED %s
+
+int Test(int x) { return x; }
+
+// COMPACT: {"id":"0x{{[0-9a-f]+}}","kind":"TranslationUnitDecl","loc":{},"range":{"begin":{},"end":{}},"inner":[
+// COMPACT-SAME: "isImplicit":true,"name":"__int128_t"
+// COMPACT-SAME: "kind":"FunctionDecl","loc":{
+// COMPACT-SAME: "name":"Test"
+
+// FILTERED: "kind": "TranslationUnitDecl",
+// FILTERED-NEXT: "inner": [
+// FILTERED-NEXT: {
+// FILTERED-NEXT: "id": "0x{{[0-9a-f]+}}",
+// FILTERED-NEXT: "kind": "FunctionDecl",
+// FILTERED: "name": "Test",
+// FILTERED-NOT: "loc"
+// FILTERED-NOT: "range"
+// FILTERED-NOT: "isImplicit"
@@ -0,0 +1,60 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -Ranalyzer-budget \
+// RUN:   -analyzer-config max-graph-memory=1 -verify %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -Ranalyzer-budget \
+// RUN:   -analyzer-config max-graph-memory=1 \
+// RUN:   -analyzer-config reanalyze-without-inlining-on-budget=true \
+// RUN:   -verify=reanalyze %s
+
+// The paths of the inlined callee exhaust the memory budget of 'top'. Without
+// inlining, 'explode' is evaluated conservatively and 'top' fits its budget.
+
+static int explode(int *v) {
+  int x = 0;
+  if (v[0])
+    ++x;
+  if (v[1])
+    ++x;
+  if (v[2])
+    ++x;
+  if (v[3])
+    ++x;
+  if (v[4])
+    ++x;
+  if (v[5])
+    ++x;
+  if (v[6])
+    ++x;
+  if (v[7])
+    ++x;
+  if (v[8])
+    ++x;
+  if (v[9])
+    ++x;
+  if (v[10])
+    ++x;
+  if (v[11])
+    ++x;
+  if (v[12])
+    ++x;
+  if (v[13])
+    ++x;
+  if (v[14])
+    ++x;
+  if (v[15])
+    ++x;
+  if (v[16])
+    ++x;
+  if (v[17])
+    ++x;
+  if (v[18])
+    ++x;
+  if (v[19])
+    ++x;
+  return x;
+}
+
+int top(int *v) {
+  // expected-remark@-1 {{the analysis of 'top' exhausted its memory budget and only covered some of its paths}}
+  // reanalyze-remark@-2 {{the analysis of 'top' exhausted its memory budget and only covered some of its paths; analyzing it again without inlining}}
+  return explode(v);
+}
@@ -0,0 +1,10 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -analyzer-checker-timing \
+// RUN:   %s 2>&1 | FileCheck %s
+
+// CHECK: Analyzer checker timers
+// CHECK-DAG: core.DivideZero
+// CHECK-DAG: core.NullDereference
+
+int divide(int *p, int d) {
+  return *p / d;
+}
@@ -0,0 +1,40 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores \
+// RUN:   -analyzer-config partition-count=2,partition-index=0 %s 2> %t.0
+// RUN: FileCheck --check-prefixes=PART,FIRST --input-file=%t.0 %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode.DeadStores \
+// RUN:   -analyzer-config partition-count=2,partition-index=1 %s 2> %t.1
+// RUN: FileCheck --check-prefixes=PART,SECOND --input-file=%t.1 %s
+// RUN: cat %t.0 %t.1 | FileCheck --check-prefix=ALL %s
+
+// RUN: not %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config partition-count=2,partition-index=2 %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=INVALID-INDEX %s
+// RUN: not %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config partition-count=0 %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=INVALID-COUNT %s
+
+// Each of the two top-level functions is analyzed by one partition, and the
+// AST-based checks only run in the first one.
+
+// FIRST-DAG: warning: Value stored to 'x' is never read
+// SECOND-NOT: Value stored to
+// PART-DAG: warning: {{Dereference of null pointer|Division by zero}}
+// PART-NOT: warning: {{Dereference of null pointer|Division by zero}}
+
+// ALL-DAG: warning: Dereference of null pointer
+// ALL-DAG: warning: Division by zero
+
+// INVALID-INDEX: invalid input for analyzer-config option 'partition-index'
+// INVALID-COUNT: invalid input for analyzer-config option 'partition-count'
+
+int deref(void) {
+  int *p = 0;
+  int x = 1;
+  x = 2;
+  return *p;
+}
+
+int divide(int y) {
+  int z = 0;
+  return y / z;
+}
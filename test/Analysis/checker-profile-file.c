@@ -0,0 +1,13 @@
+// RUN: rm -f %t.json
+// RUN: %clang_analyze_cc1 -analyzer-checker=core %s \
+// RUN:   -analyzer-config checker-profile-file=%t.json
+// RUN: FileCheck --input-file=%t.json %s
+
+// CHECK: "checkers": [
+// CHECK-DAG: "name": "core.DivideZero",
+// CHECK-DAG: "name": "core.NullDereference",
+// CHECK: "version": 1
+
+int divide(int *p, int d) {
+  return *p / d;
+}
@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -std=c++11 -analyzer-checker=alpha.clone.CloneChecker -analyzer-config alpha.clone.CloneChecker:MinimumCloneComplexity=10 -analyzer-config alpha.clone.CloneChecker:FingerprintDirectory=%t -verify %s
+// RUN: %clang_analyze_cc1 -std=c++11 -analyzer-checker=alpha.clone.CloneChecker -analyzer-config alpha.clone.CloneChecker:MinimumCloneComplexity=10 -analyzer-config alpha.clone.CloneChecker:FingerprintDirectory=%t -verify -DOTHER_TU %s
+// RUN: ls %t | count 2
+// RUN: cat %t/clones-* | sort | FileCheck %s
+
+// This tests that the code of each translation unit is fingerprinted, so that
+// the clones between translation units can be found.
+
+// expected-no-diagnostics
+
+void log();
+
+#ifndef OTHER_TU
+int max(int a, int b) {
+  log();
+  if (a > b)
+    return a;
+  return b;
+}
+#else
+int maxInOtherTU(int x, int y) {
+  log();
+  if (x > y)
+    return x;
+  return y;
+}
+#endif
+
+// The same function in both translation units has the same hash, whatever
+// the names of its variables. The lines are sorted by hash, then location.
+// CHECK: [[HASH:[0-9a-f]{16}]]	{{.*}}fingerprints.cpp	15	23	20	1
+// CHECK: [[HASH]]	{{.*}}fingerprints.cpp	22	32	27	1
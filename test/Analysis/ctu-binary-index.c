@@ -0,0 +1,42 @@
+// RUN: rm -rf %t && mkdir -p %t/ctudir
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu \
+// RUN:   -emit-pch -o %t/ctudir/ctu-other.c.ast %S/Inputs/ctu-other.c
+// RUN: %clang_extdef_map -binary-index=%t/ctudir/externalDefMap.bin \
+// RUN:   -merge-index=%S/Inputs/ctu-other.c.externalDefMap.txt
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -fsyntax-only -std=c89 -analyze \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=%t/ctudir \
+// RUN:   -analyzer-config ctu-index-name=externalDefMap.bin \
+// RUN:   -verify %s
+// RUN: head -c 16 %t/ctudir/externalDefMap.bin > %t/ctudir/truncated.bin
+// RUN: not %clang_cc1 -triple x86_64-pc-linux-gnu -fsyntax-only -std=c89 \
+// RUN:   -analyze -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=%t/ctudir \
+// RUN:   -analyzer-config ctu-index-name=truncated.bin \
+// RUN:   %s 2>&1 | FileCheck %s
+
+// CHECK: error parsing binary index file: '{{.*}}truncated.bin'
+
+void clang_analyzer_eval(int);
+
+typedef struct {
+  int a;
+  int b;
+} FooBar;
+extern FooBar fb;
+int f(int);
+void testGlobalVariable() {
+  clang_analyzer_eval(f(5) == 1); // expected-warning{{TRUE}}
+}
+
+int enumCheck(void);
+void testEnum() {
+  clang_analyzer_eval(enumCheck() == 42); // expected-warning{{TRUE}}
+}
+
+int identImplicit(int);
+void testIdentImplicit() {
+  clang_analyzer_eval(identImplicit(3) == 3); // expected-warning{{TRUE}}
+}
@@ -0,0 +1,48 @@
+// UNSUPPORTED: system-windows
+//
+// RUN: rm -rf %t && mkdir -p %t/ctudir
+// RUN: cp %S/Inputs/ctu-other.c %t/ctudir/ctu-other.c
+// RUN: sed 's/ctu-other\.c\.ast/ctu-other.c/' \
+// RUN:   %S/Inputs/ctu-other.c.externalDefMap.txt > %t/ctudir/externalDefMap.txt
+// RUN: echo '[{"directory": "%t/ctudir", "file": "ctu-other.c",' \
+// RUN:   '"command": "clang -c -target x86_64-pc-linux-gnu ctu-other.c"}]' \
+// RUN:   > %t/ctudir/compile_commands.json
+// RUN: %clang_analyze_cc1 -triple x86_64-pc-linux-gnu -std=c89 \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=%t/ctudir \
+// RUN:   -analyzer-config ctu-compilation-database=%t/ctudir/compile_commands.json \
+// RUN:   -verify %s
+// RUN: %clang_analyze_cc1 -triple x86_64-pc-linux-gnu -std=c89 \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=%t/ctudir \
+// RUN:   -analyzer-config ctu-compilation-database=%t/ctudir/compile_commands.json \
+// RUN:   -analyzer-config ctu-max-memory=1 \
+// RUN:   -analyzer-config display-ctu-progress=true 2>&1 %s | FileCheck %s
+// RUN: not %clang_analyze_cc1 -triple x86_64-pc-linux-gnu -std=c89 \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=%t/ctudir \
+// RUN:   -analyzer-config ctu-compilation-database=%t/missing.json \
+// RUN:   %s 2>&1 | FileCheck --check-prefix=MISSING %s
+
+// CHECK: CTU loaded AST file: {{.*}}ctu-other.c
+// MISSING: error opening '{{.*}}missing.json': required by the CrossTU functionality
+
+void clang_analyzer_eval(int);
+
+typedef struct {
+  int a;
+  int b;
+} FooBar;
+extern FooBar fb;
+int f(int);
+void testGlobalVariable() {
+  clang_analyzer_eval(f(5) == 1); // expected-warning{{TRUE}}
+}
+
+int enumCheck(void);
+void testEnum() {
+  clang_analyzer_eval(enumCheck() == 42); // expected-warning{{TRUE}}
+}
@@ -1,4 +1,6 @@
 // RUN: %clang_analyze_cc1 -analyzer-checker=debug.DumpCallGraph %s -fblocks -std=c++14 2>&1 | FileCheck %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=debug.DumpCallGraph %s -fblocks -std=c++14 \
+// RUN:   -analyzer-config call-graph-threads=4 2>&1 | FileCheck %s
 
 int get5() {
   return 5;
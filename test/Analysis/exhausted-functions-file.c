@@ -0,0 +1,35 @@
+// RUN: rm -f %t.first %t.listed
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-max-loop 2 -verify=default %s \
+// RUN:   -analyzer-config exhausted-functions-file=%t.first
+// RUN: FileCheck --input-file=%t.first %s
+
+// RUN: echo 'c:@F@small' > %t.listed
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-max-loop 2 -verify=listed %s \
+// RUN:   -analyzer-config exhausted-functions-file=%t.listed
+// RUN: FileCheck --check-prefix=LISTED --input-file=%t.listed %s
+
+// CHECK-NOT: small
+// CHECK: c:@F@loop
+// CHECK-NOT: small
+
+// LISTED: c:@F@loop
+// LISTED-NEXT: c:@F@small
+
+void clang_analyzer_eval(int);
+
+int loop(int n) {
+  int s = 0;
+  for (int i = 0; i < n; ++i)
+    s += i;
+  return s;
+}
+
+int small(void) { return 1; }
+
+int test(int n) {
+  // The functions listed in the file are not inlined.
+  clang_analyzer_eval(small() == 1); // default-warning{{TRUE}} listed-warning{{UNKNOWN}}
+  return loop(n);
+}
@@ -0,0 +1,26 @@
+// UNSUPPORTED: system-windows
+//
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{"directory": "%t", "command": "clang++ -c %s", "file": "%s"},' \
+// RUN:   '{"directory": "%t", "command": "clang++ -c -DSECOND %s",' \
+// RUN:   '"file": "%s"},' \
+// RUN:   '{"directory": "%t", "command": "clang++ -c %S/Inputs/ctu-chain.cpp",' \
+// RUN:   '"file": "%S/Inputs/ctu-chain.cpp"}]' > %t/compile_commands.json
+// RUN: %clang_extdef_map --executor=all-TUs --execute-concurrency=2 \
+// RUN:   %t/compile_commands.json > %t/externalDefMap.txt
+// RUN: FileCheck %s < %t/externalDefMap.txt
+// RUN: grep 'c:@F@f#I#' %t/externalDefMap.txt | count 1
+
+int f(int) {
+  return 0;
+}
+// CHECK-DAG: c:@F@f#I# {{.*}}func-mapping-all-tus.cpp
+
+#ifdef SECOND
+int g(int) {
+  return 1;
+}
+#endif
+// CHECK-DAG: c:@F@g#I# {{.*}}func-mapping-all-tus.cpp
+
+// CHECK-DAG: c:@F@h_chain#I# {{.*}}ctu-chain.cpp
@@ -0,0 +1,35 @@
+// UNSUPPORTED: system-windows
+//
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{"directory": "%t", "command": "clang++ -c %s", "file": "%s"},' \
+// RUN:   '{"directory": "%t", "command": "clang++ -c -DSECOND %s",' \
+// RUN:   '"file": "%s"}]' > %t/compile_commands.json
+// RUN: %clang_extdef_map --executor=all-TUs --execute-concurrency=2 \
+// RUN:   -call-graph=%t/call-graph.json %t/compile_commands.json \
+// RUN:   > %t/externalDefMap.txt
+// RUN: FileCheck %s < %t/call-graph.json
+
+int leaf(int);
+
+int caller(int x) {
+  return leaf(x) + 1;
+}
+
+#ifdef SECOND
+int leaf(int x) {
+  return x;
+}
+
+int second(int x) {
+  return caller(x) + leaf(x);
+}
+#endif
+
+// CHECK:      "c:@F@caller#I#": [
+// CHECK-NEXT:   "c:@F@leaf#I#"
+// CHECK-NEXT: ],
+// CHECK-NEXT: "c:@F@leaf#I#": [],
+// CHECK-NEXT: "c:@F@second#I#": [
+// CHECK-NEXT:   "c:@F@caller#I#",
+// CHECK-NEXT:   "c:@F@leaf#I#"
+// CHECK-NEXT: ]
@@ -0,0 +1,43 @@
+// RUN: rm -f %t
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify %s \
+// RUN:   -analyzer-config function-fingerprints-file=%t \
+// RUN:   -analyzer-display-progress 2>&1 | FileCheck --check-prefix=FIRST %s
+// RUN: FileCheck --check-prefix=FILE --input-file=%t %s
+
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify %s \
+// RUN:   -analyzer-config function-fingerprints-file=%t \
+// RUN:   -analyzer-display-progress 2>&1 | FileCheck --check-prefix=SECOND %s
+// RUN: FileCheck --check-prefix=FILE --input-file=%t %s
+
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify %s -DCHANGED \
+// RUN:   -analyzer-config function-fingerprints-file=%t \
+// RUN:   -analyzer-display-progress 2>&1 | FileCheck --check-prefix=FIRST %s
+
+// FIRST-DAG: (Path, {{.*}} clean
+// FIRST-DAG: (Path, {{.*}} buggy
+
+// The functions in which no bugs were found aren't analyzed again, and
+// neither are the functions their analysis inlined.
+// SECOND-NOT: (Path, {{.*}} c{{lean|allee}}
+// SECOND: (Path, {{.*}} buggy
+// SECOND-NOT: (Path, {{.*}} c{{lean|allee}}
+
+// FILE: {{^[0-9a-f]+}} c:@F@callee{{$}}
+// FILE-NOT: {{.}}
+
+int callee(int x) {
+#ifdef CHANGED
+  return x + 1;
+#else
+  return x;
+#endif
+}
+
+int clean(int x) {
+  return callee(x);
+}
+
+void buggy() {
+  int *p = 0;
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
@@ -0,0 +1,26 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,unix.Malloc -verify %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,unix.Malloc -verify %s \
+// RUN:   -analyzer-purge=block
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,unix.Malloc -verify %s \
+// RUN:   -analyzer-config min-cfg-size-purge-at-blocks-only=1
+
+// Removing the dead symbols only at the beginning of the basic blocks still
+// finds the issues found when they die.
+
+#include "Inputs/system-header-simulator.h"
+
+void *malloc(size_t);
+void free(void *);
+
+void leak() {
+  char *p = malloc(1);
+  return; // expected-warning{{Potential leak of memory pointed to by 'p'}}
+}
+
+void noLeak(int n) {
+  char *p = malloc(1);
+  if (n)
+    free(p);
+  else
+    free(p);
+}
@@ -0,0 +1,18 @@
+// RUN: rm -f %t.plist
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=all %s \
+// RUN:   -analyzer-output=plist -o %t.plist
+// RUN: grep issue_hash_content_of_line_in_context %t.plist | head -n 1 \
+// RUN:   | sed -e 's/.*<string>//' -e 's/<\/string>.*//' > %t.hashes
+
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -verify=remaining %s \
+// RUN:   -analyzer-config suppressed-issue-hashes-file=%t.hashes
+
+void first() {
+  int *p = 0;
+  *p = 1; // all-warning{{Dereference of null pointer}}
+}
+
+void second() {
+  int *q = 0;
+  *q = 2; // all-warning{{Dereference of null pointer}} remaining-warning{{Dereference of null pointer}}
+}
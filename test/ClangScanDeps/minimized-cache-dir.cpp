@@ -0,0 +1,37 @@
+// RUN: rm -rf %t.dir %t.cache
+// RUN: rm -rf %t.cdb
+// RUN: mkdir -p %t.dir
+// RUN: cp %s %t.dir/regular_cdb_input.cpp
+// RUN: cp %s %t.dir/regular_cdb_input2.cpp
+// RUN: mkdir %t.dir/Inputs
+// RUN: cp %S/Inputs/header.h %t.dir/Inputs/header.h
+// RUN: cp %S/Inputs/header2.h %t.dir/Inputs/header2.h
+// RUN: sed -e "s|DIR|%/t.dir|g" %S/Inputs/regular_cdb.json > %t.cdb
+//
+// The first run populates the cache, the second one is served from it.
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 \
+// RUN:   -minimized-cache-dir %t.cache | FileCheck %s
+// RUN: ls %t.cache | FileCheck --check-prefix=CACHE %s
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 \
+// RUN:   -minimized-cache-dir %t.cache | FileCheck %s
+//
+// Changing a header invalidates its cache entry.
+// RUN: echo '#include "header2.h"' > %t.dir/Inputs/header.h
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 \
+// RUN:   -minimized-cache-dir %t.cache | FileCheck --check-prefix=CHANGED %s
+
+#include "header.h"
+
+// CHECK: regular_cdb_input2.cpp
+// CHECK-NEXT: regular_cdb_input2.cpp
+// CHECK-NEXT: Inputs{{/|\\}}header.h
+// CHECK-NEXT: Inputs{{/|\\}}header2.h
+// CHECK: regular_cdb_input.cpp
+// CHECK-NEXT: Inputs{{/|\\}}header.h
+// CHECK-NOT: header2
+
+// CACHE: {{[0-9a-f]+}}.min
+
+// CHANGED: regular_cdb_input.cpp
+// CHANGED-NEXT: Inputs{{/|\\}}header.h
+// CHANGED-NEXT: Inputs{{/|\\}}header2.h
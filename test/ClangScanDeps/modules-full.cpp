@@ -0,0 +1,71 @@
+// RUN: rm -rf %t.dir
+// RUN: rm -rf %t.cdb
+// RUN: rm -rf %t.module-cache
+// RUN: mkdir -p %t.dir
+// RUN: cp %s %t.dir/modules_cdb_input.cpp
+// RUN: cp %s %t.dir/modules_cdb_input2.cpp
+// RUN: mkdir %t.dir/Inputs
+// RUN: cp %S/Inputs/header.h %t.dir/Inputs/header.h
+// RUN: cp %S/Inputs/header2.h %t.dir/Inputs/header2.h
+// RUN: cp %S/Inputs/module.modulemap %t.dir/Inputs/module.modulemap
+// RUN: sed -e "s|DIR|%/t.dir|g" %S/Inputs/modules_cdb.json > %t.cdb
+//
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 -format experimental-full \
+// RUN:   -mode preprocess-minimized-sources | FileCheck %s
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 4 -format experimental-full \
+// RUN:   -mode preprocess-minimized-sources | FileCheck %s
+
+#include "header.h"
+
+// The modules of the two translation units have different context hashes
+// because of the -D option. Only the header1 module of the second one
+// imports header2.
+
+// CHECK:      {
+// CHECK-NEXT:   "modules": [
+// CHECK:            "clang-module-deps": [{{$}}
+// CHECK-NEXT:         "header2"
+// CHECK-NEXT:       ],
+// CHECK-NEXT:       "clang-modulemap-file": "{{.*}}Inputs{{/|\\}}module.modulemap",
+// CHECK-NEXT:       "command-line": [
+// CHECK-NEXT:         "-fno-implicit-modules",
+// CHECK-NEXT:         "-fmodule-name=header1",
+// CHECK-NEXT:         "-fmodule-map-file={{.*}}Inputs{{/|\\}}module.modulemap",
+// CHECK-NEXT:         "-fmodule-file={{.*}}header2-{{.*}}.pcm",
+// CHECK-NEXT:         "-emit-module",
+// CHECK-NEXT:         "-o",
+// CHECK-NEXT:         "{{.*}}header1-{{.*}}.pcm",
+// CHECK-NEXT:         "{{.*}}Inputs{{/|\\}}module.modulemap"
+// CHECK-NEXT:       ],
+// CHECK-NEXT:       "context-hash": "{{[A-Z0-9]+}}",
+// CHECK-NEXT:       "file-deps": [
+// CHECK-NEXT:         "{{.*}}Inputs{{/|\\}}header.h",
+// CHECK-NEXT:         "{{.*}}Inputs{{/|\\}}module.modulemap"
+// CHECK-NEXT:       ],
+// CHECK-NEXT:       "name": "header1",
+// CHECK-NEXT:       "pcm-path": "{{.*}}header1-{{.*}}.pcm"
+// CHECK-NEXT:     },
+//
+// CHECK:          "translation-units": [
+// CHECK-NEXT:     {
+// CHECK-NEXT:       "clang-context-hash": "{{[A-Z0-9]+}}",
+// CHECK-NEXT:       "clang-module-deps": [
+// CHECK-NEXT:         "header1"
+// CHECK-NEXT:       ],
+// CHECK-NEXT:       "file-deps": [
+// CHECK-NEXT:         "{{.*}}modules_cdb_input2.cpp"
+// CHECK-NEXT:       ],
+// CHECK-NEXT:       "input-file": "{{.*}}modules_cdb_input2.cpp"
+// CHECK-NEXT:     },
+// CHECK-NEXT:     {
+// CHECK-NEXT:       "clang-context-hash": "{{[A-Z0-9]+}}",
+// CHECK-NEXT:       "clang-module-deps": [
+// CHECK-NEXT:         "header1"
+// CHECK-NEXT:       ],
+// CHECK-NEXT:       "file-deps": [
+// CHECK-NEXT:         "{{.*}}modules_cdb_input.cpp"
+// CHECK-NEXT:       ],
+// CHECK-NEXT:       "input-file": "{{.*}}modules_cdb_input.cpp"
+// CHECK-NEXT:     }
+// CHECK-NEXT:   ]
+// CHECK-NEXT: }
@@ -0,0 +1,42 @@
+// RUN: rm -rf %t.dir
+// RUN: rm -rf %t.cdb %t.timings
+// RUN: mkdir -p %t.dir
+// RUN: cp %s %t.dir/regular_cdb_input.cpp
+// RUN: cp %s %t.dir/regular_cdb_input2.cpp
+// RUN: mkdir %t.dir/Inputs
+// RUN: cp %S/Inputs/header.h %t.dir/Inputs/header.h
+// RUN: cp %S/Inputs/header2.h %t.dir/Inputs/header2.h
+// RUN: sed -e "s|DIR|%/t.dir|g" %S/Inputs/regular_cdb.json > %t.cdb
+//
+// Without timings, the larger input is scanned first.
+// RUN: echo '// padding' >> %t.dir/regular_cdb_input.cpp
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 \
+// RUN:   -schedule longest-first -timings-file %t.timings -print-timings \
+// RUN:   2>%t.err | FileCheck --check-prefix=SIZE %s
+// RUN: FileCheck --check-prefix=TIMINGS %s < %t.err
+// RUN: FileCheck --check-prefix=FILE %s < %t.timings
+//
+// A previous run's timings take precedence over the input sizes.
+// RUN: echo '{"%/t.dir/regular_cdb_input.cpp": 1, "%/t.dir/regular_cdb_input2.cpp": 2}' > %t.timings
+// RUN: clang-scan-deps -compilation-database %t.cdb -j 1 \
+// RUN:   -schedule longest-first -timings-file %t.timings \
+// RUN:   | FileCheck --check-prefix=PREVIOUS %s
+
+#include "header.h"
+
+// SIZE: regular_cdb_input.cpp
+// SIZE-NEXT: Inputs{{/|\\}}header.h
+// SIZE-NEXT: regular_cdb_input2.cpp
+// SIZE-NEXT: regular_cdb_input2.cpp
+
+// TIMINGS-DAG: {{[0-9]+\.[0-9]+}}s {{.*}}regular_cdb_input.cpp
+// TIMINGS-DAG: {{[0-9]+\.[0-9]+}}s {{.*}}regular_cdb_input2.cpp
+
+// FILE-DAG: regular_cdb_input.cpp": {{[0-9]}}
+// FILE-DAG: regular_cdb_input2.cpp": {{[0-9]}}
+
+// PREVIOUS: regular_cdb_input2.cpp
+// PREVIOUS-NEXT: regular_cdb_input2.cpp
+// PREVIOUS-NEXT: Inputs{{/|\\}}header.h
+// PREVIOUS-NEXT: Inputs{{/|\\}}header2.h
+// PREVIOUS-NEXT: regular_cdb_input.cpp
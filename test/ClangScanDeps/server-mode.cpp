@@ -0,0 +1,39 @@
+// RUN: rm -rf %t.dir
+// RUN: rm -rf %t.cdb
+// RUN: mkdir -p %t.dir
+// RUN: cp %s %t.dir/regular_cdb_input.cpp
+// RUN: cp %s %t.dir/regular_cdb_input2.cpp
+// RUN: mkdir %t.dir/Inputs
+// RUN: cp %S/Inputs/header.h %t.dir/Inputs/header.h
+// RUN: cp %S/Inputs/header2.h %t.dir/Inputs/header2.h
+// RUN: sed -e "s|DIR|%/t.dir|g" %S/Inputs/regular_cdb.json > %t.cdb
+//
+// RUN: printf '%/t.dir/regular_cdb_input.cpp\n%/t.dir/unknown.cpp\n%/t.dir/regular_cdb_input2.cpp\n%/t.dir/regular_cdb_input.cpp\n' \
+// RUN:   | not clang-scan-deps -compilation-database %t.cdb -server 2>%t.err \
+// RUN:   | FileCheck %s
+// RUN: FileCheck --check-prefix=ERR %s < %t.err
+// RUN: printf '%/t.dir/regular_cdb_input.cpp\n' \
+// RUN:   | clang-scan-deps -compilation-database %t.cdb -server \
+// RUN:   -mode preprocess | FileCheck --check-prefix=CANONICAL %s
+
+#include "header.h"
+
+// CHECK: regular_cdb_input.cpp
+// CHECK-NEXT: Inputs{{/|\\}}header.h
+// CHECK-NEXT: -- {{.*}}regular_cdb_input.cpp: ok
+// CHECK-NEXT: -- {{.*}}unknown.cpp: error
+// CHECK-NEXT: regular_cdb_input2.cpp
+// CHECK-NEXT: regular_cdb_input2.cpp
+// CHECK-NEXT: Inputs{{/|\\}}header.h
+// CHECK-NEXT: Inputs{{/|\\}}header2.h
+// CHECK-NEXT: -- {{.*}}regular_cdb_input2.cpp: ok
+// CHECK-NEXT: regular_cdb_input.cpp
+// CHECK-NEXT: Inputs{{/|\\}}header.h
+// CHECK-NEXT: -- {{.*}}regular_cdb_input.cpp: ok
+
+// ERR: Error while scanning dependencies for {{.*}}unknown.cpp:
+// ERR-NEXT: file is not in the compilation database
+
+// CANONICAL: regular_cdb_input.cpp
+// CANONICAL-NEXT: Inputs{{/|\\}}header.h
+// CANONICAL-NEXT: -- {{.*}}regular_cdb_input.cpp: ok
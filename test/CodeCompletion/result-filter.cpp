@@ -0,0 +1,26 @@
+namespace ns {
+  int value;
+  int variable;
+  int other;
+  void validate();
+}
+
+void test() {
+  ns::
+// RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:9:7 -code-completion-filter va %s -o - | FileCheck %s --check-prefix=CHECK-FILTER
+// CHECK-FILTER-NOT: other
+// CHECK-FILTER: COMPLETION: validate : [#void#]validate()
+// CHECK-FILTER: COMPLETION: value : [#int#]value
+// CHECK-FILTER: COMPLETION: variable : [#int#]variable
+// CHECK-FILTER-NOT: other
+
+// RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:9:7 -code-completion-filter VD %s -o - | FileCheck %s --check-prefix=CHECK-FUZZY
+// CHECK-FUZZY-NOT: value
+// CHECK-FUZZY: COMPLETION: validate : [#void#]validate()
+// CHECK-FUZZY-NOT: va
+
+// RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:9:7 -code-completion-filter val -code-completion-limit 2 %s -o - | FileCheck %s --check-prefix=CHECK-LIMIT
+// CHECK-LIMIT: COMPLETION: validate : [#void#]validate()
+// CHECK-LIMIT-NEXT: COMPLETION: value : [#int#]value
+// CHECK-LIMIT-NOT: variable
+}
@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o /dev/null -O0 \
+// RUN:   -mllvm -debug-pass=Structure %s 2>&1 | FileCheck %s -check-prefix=NONE
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o /dev/null -O0 \
+// RUN:   -fexperimental-new-pass-manager -fdebug-pass-manager %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=NONE
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o /dev/null -O0 \
+// RUN:   -mllvm -debug-pass=Structure -DALWAYS_INLINE %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=LEGACY
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o /dev/null -O0 \
+// RUN:   -fexperimental-new-pass-manager -fdebug-pass-manager -DALWAYS_INLINE \
+// RUN:   %s 2>&1 | FileCheck %s -check-prefix=NEWPM
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o /dev/null -O0 \
+// RUN:   -mllvm -debug-pass=Structure -DFLATTEN %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=LEGACY
+
+// At -O0, the always inliner only runs if there is something to inline.
+
+// NONE-NOT: Inliner for always_inline functions
+// NONE-NOT: AlwaysInlinerPass
+// LEGACY: Inliner for always_inline functions
+// NEWPM: Running pass: AlwaysInlinerPass
+
+#ifdef ALWAYS_INLINE
+static inline __attribute__((always_inline)) int inlined(int x) { return x; }
+#else
+int inlined(int x) { return x; }
+#endif
+
+#ifdef FLATTEN
+__attribute__((flatten))
+#endif
+int f(int x) { return inlined(x); }
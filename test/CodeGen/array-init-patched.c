@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o - %s | FileCheck %s
+
+void use(int *);
+
+// CHECK: @constinit = private global [16 x i32] [i32 1, i32 2, i32 3, i32 0, i32 5
+
+// CHECK-LABEL: define {{.*}}void @patched(
+// CHECK: %[[BEGIN:.*]] = getelementptr inbounds [16 x i32], [16 x i32]* %a, i64 0, i64 0
+// CHECK: call void @llvm.memcpy.p0i8.p0i8.i64({{.*}}bitcast ([16 x i32]* @constinit to i8*), i64 64, i1 false)
+// CHECK: %[[ELT:.*]] = getelementptr inbounds i32, i32* %[[BEGIN]], i64 3
+// CHECK: %[[X:.*]] = load i32, i32* %x.addr
+// CHECK: store i32 %[[X]], i32* %[[ELT]]
+// CHECK-NOT: store
+// CHECK: call void @use(
+void patched(int x) {
+  int a[16] = {1, 2, 3, x, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  use(a);
+}
+
+// Too many of the elements aren't constant, so all of them are stored.
+// CHECK-LABEL: define {{.*}}void @notPatched(
+// CHECK-NOT: @llvm.memcpy
+// CHECK: store i32 1, i32*
+// CHECK: call void @use(
+void notPatched(int x) {
+  int a[16] = {1, x, 3, x, 5, x, 7, x, 9, x, 11, x, 13, x, 15, x};
+  use(a);
+}
@@ -0,0 +1,22 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -clear-ast-before-backend -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -clear-ast-before-backend -emit-obj -o /dev/null %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -clear-ast-before-backend -emit-obj -o /dev/null -print-stats %s 2>&1 | FileCheck --check-prefix=STATS %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -clear-ast-before-backend -mllvm -warn-stack-size=0 -emit-codegen-only %s 2>&1 | FileCheck --check-prefix=STACK %s
+
+// The AST is released once the IR has been generated; the output and the
+// diagnostics of the backend don't depend on it.
+
+struct S { int a, b; };
+
+static int sum(struct S s) { return s.a + s.b; }
+
+// CHECK: define i32 @f(
+// STACK: warning: stack size limit exceeded ({{[0-9]+}}) in f
+int f(int x) {
+  volatile struct S s = {x, 2};
+  return sum(s);
+}
+
+// STATS: STATISTICS:
+// STATS: types total.
@@ -0,0 +1,44 @@
+// RUN: %clang_cc1 %s -triple x86_64-unknown-linux-gnu -emit-llvm -o - | FileCheck %s
+
+// Arrays of integers and floating-point values are emitted from the raw data
+// of their elements.
+
+// CHECK: @i32s = global [4 x i32] [i32 1, i32 -2, i32 3, i32 -4]
+int i32s[4] = {1, -2, 3, -4};
+
+// CHECK: @i16s = global [3 x i16] [i16 -1, i16 2, i16 0]
+short i16s[3] = {-1, 2};
+
+// CHECK: @i64s = global [2 x i64] [i64 -9223372036854775808, i64 1]
+long long i64s[2] = {-9223372036854775807LL - 1, 1};
+
+// CHECK: @chars = global [4 x i8] c"\01\FF\00\00"
+char chars[4] = {1, -1};
+
+// CHECK: @bools = global [4 x i8] c"\01\00\01\01"
+_Bool bools[4] = {1, 0, 1, 1};
+
+enum E { A = 1, B = 7 };
+// CHECK: @enums = global [2 x i32] [i32 7, i32 1]
+enum E enums[2] = {B, A};
+
+// CHECK: @floats = global [3 x float] [float 1.500000e+00, float -0.000000e+00, float 0.000000e+00]
+float floats[3] = {1.5f, -0.0f};
+
+// CHECK: @doubles = global [2 x double] [double 2.500000e-01, double 0x7FF0000000000000]
+double doubles[2] = {0.25, __builtin_inf()};
+
+// CHECK: @zeros = global [16 x i32] zeroinitializer
+int zeros[16] = {0, 0, 0};
+
+// CHECK: @tail = global <{ [8 x i32], [24 x i32] }> <{ [8 x i32] [i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7, i32 8], [24 x i32] zeroinitializer }>
+int tail[32] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+// CHECK: @short_tail = global <{ i32, i32, [14 x i32] }> <{ i32 1, i32 2, [14 x i32] zeroinitializer }>
+int short_tail[16] = {1, 2};
+
+// CHECK: @nested = global [2 x [3 x i32]] {{\[}}[3 x i32] [i32 1, i32 2, i32 3], [3 x i32] [i32 4, i32 0, i32 0]]
+int nested[2][3] = {{1, 2, 3}, {4}};
+
+// CHECK: @long_doubles = global [2 x x86_fp80] [x86_fp80 0xK3FFF8000000000000000, x86_fp80 0xK00000000000000000000]
+long double long_doubles[2] = {1.0L};
@@ -56,4 +56,5 @@
 // CHECK-THIN-OPTIMIZED: Running pass: NameAnonGlobalPass
 // CHECK-THIN-OPTIMIZED: Running pass: ThinLTOBitcodeWriterPass
 
-void Foo() {}
+static inline __attribute__((always_inline)) void Bar() {}
+void Foo() { Bar(); }
@@ -0,0 +1,14 @@
+// REQUIRES: x86-registered-target
+// RUN: rm -f %t.o %t.o.part1.o
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-obj -fparallel-codegen=2 \
+// RUN:   -o %t.o %s
+// RUN: llvm-nm %t.o %t.o.part1.o | FileCheck %s
+
+// Each function is defined in exactly one of the partitions.
+// CHECK-DAG: T first
+// CHECK-DAG: T second
+// CHECK-DAG: D counter
+
+int counter = 1;
+int first(void) { return ++counter; }
+int second(void) { return counter * 2; }
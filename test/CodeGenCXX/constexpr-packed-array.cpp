@@ -0,0 +1,42 @@
+// RUN: %clang_cc1 -std=c++14 %s -triple x86_64-unknown-linux-gnu -emit-llvm -o - | FileCheck %s
+
+// The values of constexpr variables pack their large integer arrays. Their
+// elements can still be read in constant expressions, and the arrays are
+// emitted from the packed data.
+
+constexpr int squares[20] = {0,   1,   4,   9,   16,  25,  36,  49,  64,  81,
+                             100, 121, 144, 169, 196, 225, 256, 289, 324, -1};
+static_assert(squares[12] == 144, "");
+static_assert(squares[19] == -1, "");
+
+// CHECK: @_ZL7squares = internal constant [20 x i32] [i32 0, i32 1, i32 4, {{.*}}, i32 324, i32 -1]
+const int *getSquares() { return squares; }
+
+// The filler follows the packed elements.
+constexpr unsigned char bytes[32] = {1, 2,  3,  4,  5,  6,  7,  8,
+                                     9, 10, 11, 12, 13, 14, 15, 255};
+static_assert(bytes[15] == 255 && bytes[16] == 0 && bytes[31] == 0, "");
+
+// CHECK: @_ZL5bytes = internal constant <{ [16 x i8], [16 x i8] }> <{ [16 x i8] c"\01\02\03\04\05\06\07\08\09\0A\0B\0C\0D\0E\0F\FF", [16 x i8] zeroinitializer }>
+const unsigned char *getBytes() { return bytes; }
+
+struct Table {
+  int Size;
+  short Values[16];
+};
+constexpr Table table = {16, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                              15, -16}};
+static_assert(table.Values[15] == -16, "");
+
+// Copies of the value, and the values computed from it, read it as it is.
+constexpr Table copy = table;
+constexpr int sum(const Table &T) {
+  int Sum = 0;
+  for (int I = 0; I != T.Size; ++I)
+    Sum += T.Values[I];
+  return Sum;
+}
+static_assert(sum(copy) == 104, "");
+
+// CHECK: @_ZL5table = internal constant { i32, [16 x i16] } { i32 16, [16 x i16] [i16 1, i16 2, {{.*}}, i16 15, i16 -16] }
+const Table *getTable() { return &table; }
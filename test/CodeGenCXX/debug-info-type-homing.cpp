@@ -0,0 +1,43 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-llvm -debug-info-kind=limited \
+// RUN:   -fdebug-type-homing %s -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-llvm -debug-info-kind=limited \
+// RUN:   %s -o - | FileCheck -check-prefix=NOHOMING %s
+
+// The constructor is emitted by another translation unit.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Elsewhere",{{.*}} flags: DIFlagFwdDecl
+// NOHOMING-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Elsewhere",{{.*}} elements:
+struct Elsewhere {
+  Elsewhere();
+  int I;
+};
+int useElsewhere(Elsewhere &E) { return E.I; }
+
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Here",{{.*}} elements:
+struct Here {
+  Here();
+  int I;
+};
+Here::Here() : I(0) {}
+
+// The definition of a class which is never used is emitted with the
+// constructor.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Unused",{{.*}} elements:
+struct Unused {
+  Unused();
+};
+Unused::Unused() {}
+
+// Aggregates and classes with constexpr constructors can be created without
+// calling a constructor.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Aggregate",{{.*}} elements:
+struct Aggregate {
+  int I;
+};
+int useAggregate(Aggregate &A) { return A.I; }
+
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Literal",{{.*}} elements:
+struct Literal {
+  constexpr Literal(int I) : I(I) {}
+  int I;
+};
+int useLiteral(Literal &L) { return L.I; }
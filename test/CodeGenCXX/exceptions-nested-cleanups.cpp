@@ -0,0 +1,52 @@
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o - -fcxx-exceptions -fexceptions | FileCheck %s
+
+// The landing pads of nested cleanups take the clauses of the landing pad of
+// their enclosing scope.
+
+struct A { A(); ~A(); };
+
+// CHECK-LABEL: define {{.*}}void @_Z7inTryv()
+// CHECK: landingpad { i8*, i32 }
+// CHECK-NEXT: catch i8* bitcast (i8** @_ZTIi to i8*)
+// CHECK: landingpad { i8*, i32 }
+// CHECK-NEXT: cleanup
+// CHECK-NEXT: catch i8* bitcast (i8** @_ZTIi to i8*)
+// CHECK: landingpad { i8*, i32 }
+// CHECK-NEXT: cleanup
+// CHECK-NEXT: catch i8* bitcast (i8** @_ZTIi to i8*)
+void inTry() {
+  try {
+    A a;
+    A b;
+    A c;
+  } catch (int) {
+  }
+}
+
+// CHECK-LABEL: define {{.*}}void @_Z10inNoexceptv()
+// CHECK: landingpad { i8*, i32 }
+// CHECK-NEXT: catch i8* null
+// CHECK-NOT: {{^ +cleanup$}}
+// CHECK: ret void
+void inNoexcept() noexcept {
+  A a;
+  A b;
+  A c;
+}
+
+// Gotos to labels which aren't emitted yet are threaded through the cleanups.
+// CHECK-LABEL: define {{.*}}void @_Z5gotosi(
+// CHECK: store i32 [[DEST:[0-9]+]], i32* %cleanup.dest.slot
+// CHECK: switch i32 %{{.*}}, label %{{.*}} [
+// CHECK: i32 [[DEST]], label %later
+// CHECK: later:
+void gotos(int x) {
+  {
+    A a;
+    if (x)
+      goto later;
+    A b;
+  }
+later:
+  A c;
+}
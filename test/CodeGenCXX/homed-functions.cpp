@@ -0,0 +1,43 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s \
+// RUN:   -fhomed-functions-file=%S/Inputs/homed-functions.txt \
+// RUN:   | FileCheck %s --check-prefix=O0
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s -O1 \
+// RUN:   -disable-llvm-passes \
+// RUN:   -fhomed-functions-file=%S/Inputs/homed-functions.txt \
+// RUN:   | FileCheck %s --check-prefix=O1
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s \
+// RUN:   -fhomed-functions-file=%S/Inputs/homed-functions.txt \
+// RUN:   -fhomed-functions-home | FileCheck %s --check-prefix=HOME
+// RUN: not %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s \
+// RUN:   -fhomed-functions-file=%t.missing 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=MISSING
+
+// MISSING: cannot open file '{{.*}}.missing'
+
+inline int homed() { return 1; }
+inline int homed_unused() { return 2; }
+inline int not_homed() { return 3; }
+template <typename T> T tmpl(T v) { return v; }
+struct S {
+  S() {}
+};
+
+int use() {
+  S s;
+  return homed() + not_homed() + tmpl(4);
+}
+
+// O0-DAG: declare void @_ZN1SC1Ev(
+// O0-DAG: declare i32 @_Z5homedv()
+// O0-DAG: define linkonce_odr i32 @_Z9not_homedv() {{.*}}comdat
+// O0-DAG: declare i32 @_Z4tmplIiET_S0_(
+// O1-DAG: define available_externally void @_ZN1SC1Ev(
+// O1-DAG: define available_externally i32 @_Z5homedv() #
+// O1-DAG: define linkonce_odr i32 @_Z9not_homedv() {{.*}}comdat
+// O1-DAG: define available_externally i32 @_Z4tmplIiET_S0_(i32 %v) #
+
+// HOME-DAG: define weak_odr void @_ZN1SC1Ev({{.*}} comdat
+// HOME-DAG: define weak_odr i32 @_Z5homedv() {{.*}}comdat
+// HOME-DAG: define weak_odr i32 @_Z12homed_unusedv() {{.*}}comdat
+// HOME-DAG: define linkonce_odr i32 @_Z9not_homedv() {{.*}}comdat
+// HOME-DAG: define weak_odr i32 @_Z4tmplIiET_S0_(i32 %v) {{.*}}comdat
@@ -232,3 +232,19 @@ void pr30440_test () {
 }
 
 }
+
+namespace N20 {
+  struct __attribute__((abi_tag("T"))) Tagged {};
+  template<typename T> struct W {};
+
+  // The functions sharing a return type derive the same tags from it,
+  // whether or not it was mangled before.
+  W<Tagged> f();
+  W<Tagged> g(Tagged);
+  W<Tagged> v;
+
+  void test() { f(); g(Tagged()); }
+}
+// CHECK-DAG: declare {{.*}} @_ZN3N201fB1TEv(
+// CHECK-DAG: declare {{.*}} @_ZN3N201gENS_6TaggedB1TE(
+// CHECK-DAG: @_ZN3N201vB1TE =
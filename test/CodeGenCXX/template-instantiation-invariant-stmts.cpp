@@ -0,0 +1,43 @@
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-unknown-linux-gnu -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-unknown-linux-gnu -emit-llvm -o - %s | FileCheck --check-prefix=DEFS %s
+
+// The expression statements which are the same in every instantiation are
+// reused, and still use what they refer to from each instantiation.
+
+template<typename T> void helper() {}
+inline int used() { return 1; }
+struct S {
+  int member() { return 2; }
+};
+int g;
+S s;
+
+template<typename T> void f(T t) {
+  helper<int>();
+  g = used() + s.member();
+  int local = 3;
+  g += local;
+}
+
+void test() {
+  f(0);
+  f(1.0);
+}
+
+// CHECK-LABEL: define {{.*}} @_Z1fIiEvT_(
+// CHECK: call void @_Z6helperIiEvv()
+// CHECK: call i32 @_Z4usedv()
+// CHECK: call i32 @_ZN1S6memberEv(
+// CHECK: store i32 3, i32* %local
+// CHECK: ret void
+
+// CHECK-LABEL: define {{.*}} @_Z1fIdEvT_(
+// CHECK: call void @_Z6helperIiEvv()
+// CHECK: call i32 @_Z4usedv()
+// CHECK: call i32 @_ZN1S6memberEv(
+// CHECK: store i32 3, i32* %local
+// CHECK: ret void
+
+// DEFS-DAG: define linkonce_odr void @_Z6helperIiEvv()
+// DEFS-DAG: define linkonce_odr i32 @_Z4usedv()
+// DEFS-DAG: define linkonce_odr i32 @_ZN1S6memberEv(
@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 %s -triple=x86_64-unknown-linux -emit-llvm -o %t.ll \
+// RUN:   -fdump-vtable-layouts > %t
+// RUN: FileCheck %s < %t
+// RUN: FileCheck -check-prefix=CHECK-IR %s < %t.ll
+
+// The vtable layout of a class whose vtable is emitted in another translation
+// unit is only computed if one of its methods needs thunks.
+
+// CHECK-NOT: Vtable for 'A'
+struct A {
+  virtual void key();
+  virtual void f();
+  int I;
+};
+void A::f() {}
+
+// CHECK-NOT: Vtable for 'B'
+struct B : A {
+  void key() override;
+  void f() override;
+};
+void B::f() {}
+
+struct C {
+  virtual void g();
+};
+
+// CHECK: Vtable for 'D'
+// CHECK-NOT: Vtable for 'B'
+struct D : A, C {
+  void key() override;
+  void g() override;
+};
+void D::g() {}
+
+// CHECK-IR: define {{.*}}void @_ZN1A1fEv(
+// CHECK-IR: define {{.*}}void @_ZN1B1fEv(
+// CHECK-IR: define {{.*}}void @_ZN1D1gEv(
+// CHECK-IR: define {{.*}}void @_ZThn16_N1D1gEv(
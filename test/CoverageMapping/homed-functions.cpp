@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -fprofile-instrument=clang -fcoverage-mapping -dump-coverage-mapping -emit-llvm-only -main-file-name homed-functions.cpp -fhomed-functions-file=%S/Inputs/homed-functions.txt %s | FileCheck -implicit-check-not=_Z5homedv: -implicit-check-not=_Z12homed_unusedv: %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -fprofile-instrument=clang -fcoverage-mapping -dump-coverage-mapping -emit-llvm-only -main-file-name homed-functions.cpp -fhomed-functions-file=%S/Inputs/homed-functions.txt -O1 -disable-llvm-passes %s | FileCheck -implicit-check-not=_Z5homedv: -implicit-check-not=_Z12homed_unusedv: %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -fprofile-instrument=clang -fcoverage-mapping -dump-coverage-mapping -emit-llvm-only -main-file-name homed-functions.cpp -fhomed-functions-file=%S/Inputs/homed-functions.txt -fhomed-functions-home %s | FileCheck -check-prefix=HOME %s
+
+// Only the home object file maps the functions it provides.
+
+// HOME-DAG: _Z5homedv:
+// HOME-DAG: _Z12homed_unusedv:
+inline int homed() { return 1; }
+inline int homed_unused() { return 2; }
+
+// CHECK-DAG: _Z9not_homedv:
+// CHECK-DAG: _Z3usev:
+// HOME-DAG: _Z9not_homedv:
+// HOME-DAG: _Z3usev:
+inline int not_homed() { return 3; }
+
+int use() { return homed() + not_homed(); }
@@ -0,0 +1,5 @@
+// RUN: %clang -### -c -fauto-pch-path=%t/pch %s 2>&1 | FileCheck %s
+// RUN: %clang_cl -### -c -fauto-pch-path=%t/pch -- %s 2>&1 | FileCheck %s
+
+// CHECK: "-cc1"
+// CHECK-SAME: "-fauto-pch-path={{.*}}pch"
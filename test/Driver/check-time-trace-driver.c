@@ -0,0 +1,13 @@
+// RUN: %clang -S -ftime-trace -ftime-trace-granularity=0 \
+// RUN:   -target x86_64-unknown-linux-gnu -o %T/check-time-trace-driver %s
+// RUN: cat %T/check-time-trace-driver.driver.json \
+// RUN:   | %python -c 'import json, sys; json.dump(json.loads(sys.stdin.read()), sys.stdout, sort_keys=True, indent=2)' \
+// RUN:   | FileCheck %s
+
+// CHECK-DAG: "name": "BuildCompilation"
+// CHECK-DAG: "name": "Create ToolChain"
+// CHECK-DAG: "detail": "x86_64-unknown-linux-gnu"
+// CHECK-DAG: "name": "Detect GCCInstallation"
+// CHECK-DAG: "name": "Detect CudaInstallation"
+
+void foo(void) {}
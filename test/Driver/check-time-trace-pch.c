@@ -0,0 +1,24 @@
+// RUN: %clang -x c-header -ftime-trace -ftime-trace-granularity=0 \
+// RUN:   -o %T/check-time-trace-pch.pch %s
+// RUN: cat %T/check-time-trace-pch.json \
+// RUN:   | %python -c 'import json, sys; json.dump(json.loads(sys.stdin.read()), sys.stdout, sort_keys=True, indent=2)' \
+// RUN:   | FileCheck -check-prefix=WRITE %s
+// RUN: %clang -S -ftime-trace -ftime-trace-granularity=0 \
+// RUN:   -include-pch %T/check-time-trace-pch.pch \
+// RUN:   -o %T/check-time-trace-pch-use %s
+// RUN: cat %T/check-time-trace-pch-use.json \
+// RUN:   | %python -c 'import json, sys; json.dump(json.loads(sys.stdin.read()), sys.stdout, sort_keys=True, indent=2)' \
+// RUN:   | FileCheck -check-prefix=READ %s
+
+// WRITE-DAG: "name": "WriteAST"
+// WRITE-DAG: "detail": "{{.*}}check-time-trace-pch.pch"
+
+// READ-DAG: "name": "ReadAST"
+// READ-DAG: "name": "Module AddFile"
+
+#ifndef HEADER
+#define HEADER
+int header_value(void);
+#else
+int use(void) { return header_value(); }
+#endif
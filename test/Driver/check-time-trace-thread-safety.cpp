@@ -0,0 +1,25 @@
+// RUN: %clangxx -S -ftime-trace -ftime-trace-granularity=0 -Wthread-safety -o %T/check-time-trace-thread-safety %s
+// RUN: cat %T/check-time-trace-thread-safety.json \
+// RUN:   | %python -c 'import json, sys; json.dump(json.loads(sys.stdin.read()), sys.stdout, sort_keys=True, indent=2)' \
+// RUN:   | FileCheck %s
+
+// CHECK-DAG: "name": "ThreadSafetyLocalVarMap"
+// CHECK-DAG: "name": "ThreadSafetyBlocks"
+// CHECK-DAG: "detail": "Counter::increment"
+// CHECK-DAG: "name": "ThreadSafetyAnalysis"
+
+struct __attribute__((capability("mutex"))) Mutex {
+  void lock() __attribute__((acquire_capability()));
+  void unlock() __attribute__((release_capability()));
+};
+
+struct Counter {
+  Mutex Mu;
+  int Value __attribute__((guarded_by(Mu)));
+
+  void increment() {
+    Mu.lock();
+    ++Value;
+    Mu.unlock();
+  }
+};
@@ -571,3 +571,8 @@
 // CHECK-TRIVIAL-PATTERN-NOT: hasn't been enabled
 // CHECK-TRIVIAL-ZERO-GOOD-NOT: hasn't been enabled
 // CHECK-TRIVIAL-ZERO-BAD: hasn't been enabled
+
+// RUN: %clang -### -S -fprofile-cold-optnone %s 2>&1 | FileCheck -check-prefix=CHECK-PROFILE-COLD-OPTNONE %s
+// RUN: %clang -### -S -fprofile-cold-optnone -fno-profile-cold-optnone %s 2>&1 | FileCheck -check-prefix=CHECK-NO-PROFILE-COLD-OPTNONE %s
+// CHECK-PROFILE-COLD-OPTNONE: "-fprofile-cold-optnone"
+// CHECK-NO-PROFILE-COLD-OPTNONE-NOT: "-fprofile-cold-optnone"
@@ -0,0 +1,6 @@
+// RUN: %clang -### -c -fcompile-cache-path=%t/cache %s 2>&1 | FileCheck %s
+// RUN: %clang_cl -### -c -fcompile-cache-path=%t/cache -- %s 2>&1 \
+// RUN:   | FileCheck %s
+
+// CHECK: "-cc1"
+// CHECK-SAME: "-fcompile-cache-path={{.*}}cache"
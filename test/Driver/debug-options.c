@@ -355,3 +355,16 @@
 // GEMBED_2:  error: invalid argument '-gembed-source' only allowed with '-gdwarf-5'
 // NOGEMBED_5-NOT:  "-gembed-source"
 // NOGEMBED_2-NOT:  error: invalid argument '-gembed-source' only allowed with '-gdwarf-5'
+//
+// RUN: %clang -### -target x86_64-linux-gnu -g -fdebug-type-homing %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=HOMING %s
+// RUN: %clang -### -target x86_64-linux-gnu -g -fdebug-type-homing \
+// RUN:   -fno-debug-type-homing %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=NOHOMING %s
+// RUN: %clang -### -target x86_64-linux-gnu -g -fstandalone-debug \
+// RUN:   -fdebug-type-homing %s 2>&1 | FileCheck -check-prefix=NOHOMING %s
+// RUN: %clang -### -target x86_64-linux-gnu -gline-tables-only \
+// RUN:   -fdebug-type-homing %s 2>&1 | FileCheck -check-prefix=NOHOMING %s
+//
+// HOMING: "-fdebug-type-homing"
+// NOHOMING-NOT: "-fdebug-type-homing"
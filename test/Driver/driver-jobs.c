@@ -0,0 +1,22 @@
+// RUN: %clang -fsyntax-only -fdriver-jobs=4 %s %S/Inputs/driver-jobs-second.c \
+// RUN:     2>&1 | FileCheck %s
+// RUN: %clang -fsyntax-only -fdriver-jobs=4 -fintegrated-cc1 -### %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=SINGLE
+// RUN: %clang -fdriver-jobs=4 -fintegrated-cc1 -### %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=SPAWN
+// RUN: not %clang -fsyntax-only -fdriver-jobs=0 %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=INVALID
+
+// The diagnostics of the jobs are printed in the order of the inputs.
+// CHECK: warning: first
+// CHECK: warning: second
+
+// A single job can still be executed in-process.
+// SINGLE: (in-process)
+
+// The jobs are executed in new processes when they may run concurrently.
+// SPAWN-NOT: (in-process)
+
+// INVALID: error: invalid integral value '0' in '-fdriver-jobs=0'
+
+#warning first
@@ -61,6 +61,9 @@
 // CHECK-BUILTIN-MODULE-MAP: "-fmodules"
 // CHECK-BUILTIN-MODULE-MAP: "-fmodule-map-file={{.*}}include{{/|\\\\}}module.modulemap"
 
+// RUN: %clang -fmodules -fmodule-map-cache=maps.cache -### %s 2>&1 | FileCheck -check-prefix=CHECK-MODULE-MAP-CACHE %s
+// CHECK-MODULE-MAP-CACHE: "-fmodule-map-cache=maps.cache"
+
 // RUN: %clang -fmodules -fmodule-file=foo.pcm -fmodule-file=bar.pcm -### %s 2>&1 | FileCheck -check-prefix=CHECK-MODULE-FILES %s
 // CHECK-MODULE-FILES: "-fmodules"
 // CHECK-MODULE-FILES: "-fmodule-file=foo.pcm"
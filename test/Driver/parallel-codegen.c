@@ -0,0 +1,19 @@
+// RUN: %clang -target x86_64-unknown-linux -### %s -fparallel-codegen=3 \
+// RUN:   -o %t 2>&1 | FileCheck %s
+//
+// CHECK: "-cc1" {{.*}}"-fparallel-codegen=3" {{.*}}"-o" "[[OBJ:[^"]+\.o]]"
+// CHECK: ld{{.*}}" {{.*}}"[[OBJ]]" "[[OBJ]].part1.o" "[[OBJ]].part2.o"
+
+// RUN: %clang -target x86_64-unknown-linux -### %s -fparallel-codegen=3 \
+// RUN:   -gsplit-dwarf -o %t 2>&1 | FileCheck -check-prefix=SERIAL %s
+// RUN: %clang -target x86_64-unknown-linux -### %s -fparallel-codegen=3 \
+// RUN:   -fno-integrated-as -o %t 2>&1 | FileCheck -check-prefix=SERIAL %s
+// RUN: %clang -target x86_64-unknown-linux -### %s -fparallel-codegen=1 \
+// RUN:   -o %t 2>&1 | FileCheck -check-prefix=SERIAL %s
+//
+// SERIAL-NOT: .part1.o
+
+// RUN: %clang -target x86_64-unknown-linux -### %s -c -o %t.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=NONE %s
+//
+// NONE-NOT: "-fparallel-codegen
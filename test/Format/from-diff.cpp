@@ -0,0 +1,28 @@
+// RUN: rm -rf %t && mkdir -p %t/src
+// RUN: printf 'int  a;\nint  b;\nint  c;\n' > %t/src/f.cpp
+// RUN: printf 'int  d;\nint  e;\n' > %t/src/g.h
+// RUN: printf -- '--- a/src/f.cpp\n+++ b/src/f.cpp\n@@ -2,0 +2 @@\n+int  b;\n' > %t/diff
+// RUN: printf -- '--- a/README\n+++ b/README\n@@ -0,0 +1 @@\n+text\n' >> %t/diff
+// RUN: printf -- '--- /dev/null\n+++ b/src/g.h\n@@ -0,0 +1,2 @@\n+int  d;\n+int  e;\n' >> %t/diff
+// RUN: cd %t && clang-format -style=LLVM -from-diff -j 2 < %t/diff \
+// RUN:   | FileCheck -strict-whitespace %s
+// RUN: not clang-format -from-diff %s 2>&1 | FileCheck -check-prefix=OPTIONS %s
+
+// Only the changed line of f.cpp is formatted, and README is skipped.
+// CHECK:      {{^--- a/src/f.cpp$}}
+// CHECK-NEXT: {{^\+\+\+ b/src/f.cpp$}}
+// CHECK-NEXT: {{^@@ -1,3 \+1,3 @@$}}
+// CHECK-NEXT: {{^ int  a;$}}
+// CHECK-NEXT: {{^-int  b;$}}
+// CHECK-NEXT: {{^\+int b;$}}
+// CHECK-NEXT: {{^ int  c;$}}
+// CHECK-NEXT: {{^--- a/src/g.h$}}
+// CHECK-NEXT: {{^\+\+\+ b/src/g.h$}}
+// CHECK-NEXT: {{^@@ -1,2 \+1,2 @@$}}
+// CHECK-NEXT: {{^-int  d;$}}
+// CHECK-NEXT: {{^\+int d;$}}
+// CHECK-NEXT: {{^-int  e;$}}
+// CHECK-NEXT: {{^\+int e;$}}
+// CHECK-NOT:  {{.}}
+
+// OPTIONS: error: -from-diff cannot be used with
@@ -0,0 +1,28 @@
+// RUN: rm -rf %t && mkdir -p %t/a %t/b
+// RUN: printf "BasedOnStyle: LLVM\nIndentWidth: 5\n" > %t/a/.clang-format
+// RUN: printf "BasedOnStyle: LLVM\nIndentWidth: 3\n" > %t/b/.clang-format
+// RUN: cp %s %t/a/1.cpp
+// RUN: cp %s %t/b/2.cpp
+// RUN: cp %s %t/a/3.cpp
+// RUN: cp %s %t/b/4.cpp
+// RUN: clang-format -style=file -j 4 %t/a/1.cpp %t/b/2.cpp %t/a/3.cpp \
+// RUN:   %t/b/4.cpp | FileCheck -strict-whitespace %s
+// RUN: clang-format -style=file -j 0 -i %t/a/1.cpp %t/b/2.cpp
+// RUN: FileCheck -strict-whitespace -check-prefix=CHECK5 -input-file=%t/a/1.cpp %s
+// RUN: FileCheck -strict-whitespace -check-prefix=CHECK3 -input-file=%t/b/2.cpp %s
+
+// The files are printed in order, each with the style of its directory.
+// CHECK:      {{^void f\(\) {$}}
+// CHECK-NEXT: {{^     int \*i;$}}
+// CHECK:      {{^void f\(\) {$}}
+// CHECK-NEXT: {{^   int \*i;$}}
+// CHECK:      {{^void f\(\) {$}}
+// CHECK-NEXT: {{^     int \*i;$}}
+// CHECK:      {{^void f\(\) {$}}
+// CHECK-NEXT: {{^   int \*i;$}}
+
+// CHECK5: {{^     int \*i;$}}
+// CHECK3: {{^   int \*i;$}}
+void f() {
+ int   *  i  ;
+}
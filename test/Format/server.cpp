@@ -0,0 +1,29 @@
+// RUN: printf '12 0 a.cpp\nint  a = 1;\n16 1 8 8 b c.cpp\nint  a;\nint  b;\n1 1 0 5 d.cpp\n\nfoo\n12 0 e.cpp\n' \
+// RUN:   | not clang-format -server -style=LLVM \
+// RUN:   | FileCheck -strict-whitespace %s
+// RUN: not clang-format -server -i 2>&1 | FileCheck -check-prefix=OPTIONS %s
+
+// CHECK:      {{^151$}}
+// CHECK-NEXT: {{^<\?xml version='1.0'\?>$}}
+// CHECK-NEXT: {{^<replacements xml:space='preserve' incomplete_format='false'>$}}
+// CHECK-NEXT: {{^<replacement offset='3' length='2'> </replacement>$}}
+// CHECK-NEXT: {{^</replacements>$}}
+
+// Only the range of the second line is formatted.
+// CHECK-NEXT: {{^152$}}
+// CHECK-NEXT: {{^<\?xml version='1.0'\?>$}}
+// CHECK-NEXT: {{^<replacements xml:space='preserve' incomplete_format='false'>$}}
+// CHECK-NEXT: {{^<replacement offset='11' length='2'> </replacement>$}}
+// CHECK-NEXT: {{^</replacements>$}}
+
+// CHECK-NEXT: {{^77$}}
+// CHECK-NEXT: {{^<\?xml version='1.0'\?>$}}
+// CHECK-NEXT: {{^<error>error: range 0:5 is outside the buffer.</error>$}}
+
+// The server stops at a request it cannot read.
+// CHECK-NEXT: {{^66$}}
+// CHECK-NEXT: {{^<\?xml version='1.0'\?>$}}
+// CHECK-NEXT: {{^<error>error: invalid request "foo"</error>$}}
+// CHECK-NOT:  {{.}}
+
+// OPTIONS: error: -server cannot be used with
@@ -0,0 +1 @@
+provided_t consume(void);
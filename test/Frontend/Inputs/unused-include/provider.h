@@ -0,0 +1 @@
+typedef int provided_t;
@@ -0,0 +1 @@
+int inner_function(void);
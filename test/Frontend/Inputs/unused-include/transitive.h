@@ -0,0 +1 @@
+#include "transitive-inner.h"
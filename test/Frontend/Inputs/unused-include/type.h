@@ -0,0 +1,3 @@
+struct Point {
+  int X, Y;
+};
@@ -0,0 +1 @@
+int unused_function(int X);
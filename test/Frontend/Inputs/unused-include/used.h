@@ -0,0 +1 @@
+int used_function(int X);
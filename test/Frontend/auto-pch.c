@@ -0,0 +1,65 @@
+// RUN: rm -rf %t && mkdir -p %t/early %t/include
+// RUN: echo 'int header_value(void);' > %t/include/value.h
+// RUN: echo '#warning "in the preamble"' > %t/include/warning.h
+// RUN: %clang_cc1 -fsyntax-only -I %t/early -I %t/include \
+// RUN:   -fauto-pch-path=%t/pch -Rauto-pch %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=BUILD --implicit-check-not=remark: %s
+// RUN: ls %t/pch | FileCheck -check-prefix=FILES %s
+
+// The next compilations load the preamble.
+// RUN: %clang_cc1 -fsyntax-only -I %t/early -I %t/include \
+// RUN:   -fauto-pch-path=%t/pch -Rauto-pch -Werror %s 2>&1 \
+// RUN:   | FileCheck -allow-empty -check-prefix=USE %s
+// RUN: %clang_cc1 -emit-llvm -I %t/early -I %t/include \
+// RUN:   -fauto-pch-path=%t/pch -Rauto-pch %s -o - 2>&1 \
+// RUN:   | FileCheck -check-prefix=CODEGEN %s
+
+// A change of a header rebuilds it.
+// RUN: echo 'int header_value(void); int other_value(void);' \
+// RUN:   > %t/include/value.h
+// RUN: %clang_cc1 -fsyntax-only -I %t/early -I %t/include \
+// RUN:   -fauto-pch-path=%t/pch -Rauto-pch %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=BUILD --implicit-check-not=remark: %s
+
+// So does a header which appears earlier in the search path.
+// RUN: touch %t/early/unrelated.h
+// RUN: %clang_cc1 -fsyntax-only -I %t/early -I %t/include \
+// RUN:   -fauto-pch-path=%t/pch -Rauto-pch %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=BUILD --implicit-check-not=remark: %s
+
+// The preambles with diagnostics aren't used, and the compilations print the
+// diagnostics themselves.
+// RUN: %clang_cc1 -fsyntax-only -I %t/early -I %t/include -DWARN \
+// RUN:   -fauto-pch-path=%t/pch -Rauto-pch %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=WARN %s
+// RUN: %clang_cc1 -fsyntax-only -I %t/early -I %t/include -DWARN \
+// RUN:   -fauto-pch-path=%t/pch -Rauto-pch %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=WARN-AGAIN %s
+
+// BUILD: remark: building the precompiled preamble of '{{.*}}auto-pch.c' into '{{.*}}pch{{/|\\}}{{[0-9a-f]+}}.pch'
+
+// FILES: {{[0-9a-f]+}}.deps
+// FILES: {{[0-9a-f]+}}.pch
+
+// USE-NOT: remark:
+// USE-NOT: warning:
+
+// CODEGEN-NOT: remark:
+// CODEGEN: define {{.*}}i32 @main_value()
+// CODEGEN: call {{.*}}i32 @header_value()
+
+// WARN: remark: building the precompiled preamble
+// WARN-NEXT: remark: the preamble of '{{.*}}auto-pch.c' can't be precompiled
+// WARN-NEXT: warning: "in the preamble"
+// WARN-NOT: warning:
+
+// WARN-AGAIN-NOT: remark: building
+// WARN-AGAIN: remark: the preamble of '{{.*}}auto-pch.c' can't be precompiled
+// WARN-AGAIN-NEXT: warning: "in the preamble"
+
+#include "value.h"
+#ifdef WARN
+#include "warning.h"
+#endif
+
+int main_value(void) { return header_value(); }
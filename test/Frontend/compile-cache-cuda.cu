@@ -0,0 +1,41 @@
+// REQUIRES: nvptx-registered-target
+// REQUIRES: x86-registered-target
+// RUN: rm -rf %t && mkdir -p %t
+
+// The device compilations are cached.
+// RUN: %clang_cc1 -triple nvptx64-nvidia-cuda -fcuda-is-device \
+// RUN:   -target-cpu sm_35 -S -fcompile-cache-path=%t/cache -Rcompile-cache \
+// RUN:   %s -o %t/first.s 2>&1 \
+// RUN:   | FileCheck -allow-empty -check-prefix=MISS %s
+// RUN: %clang_cc1 -triple nvptx64-nvidia-cuda -fcuda-is-device \
+// RUN:   -target-cpu sm_35 -S -fcompile-cache-path=%t/cache -Rcompile-cache \
+// RUN:   %s -o %t/second.s 2>&1 | FileCheck -check-prefix=HIT %s
+// RUN: cmp %t/first.s %t/second.s
+
+// Each GPU architecture has its own result.
+// RUN: %clang_cc1 -triple nvptx64-nvidia-cuda -fcuda-is-device \
+// RUN:   -target-cpu sm_60 -S -fcompile-cache-path=%t/cache -Rcompile-cache \
+// RUN:   %s -o %t/third.s 2>&1 \
+// RUN:   | FileCheck -allow-empty -check-prefix=MISS %s
+
+// The host compilations depend on the GPU binary they include.
+// RUN: echo 'first' > %t/gpu.bin
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:   -fcuda-include-gpubinary %t/gpu.bin -fcompile-cache-path=%t/cache \
+// RUN:   -Rcompile-cache %s -o %t/host.o 2>&1 \
+// RUN:   | FileCheck -allow-empty -check-prefix=MISS %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:   -fcuda-include-gpubinary %t/gpu.bin -fcompile-cache-path=%t/cache \
+// RUN:   -Rcompile-cache %s -o %t/host.o 2>&1 | FileCheck -check-prefix=HIT %s
+// RUN: echo 'second' > %t/gpu.bin
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:   -fcuda-include-gpubinary %t/gpu.bin -fcompile-cache-path=%t/cache \
+// RUN:   -Rcompile-cache %s -o %t/host.o 2>&1 \
+// RUN:   | FileCheck -allow-empty -check-prefix=MISS %s
+
+// MISS-NOT: remark:
+// HIT: remark: restored the result of the compilation of '{{.*}}compile-cache-cuda.cu' from the cache
+
+#define __global__ __attribute__((global))
+
+__global__ void kernel(int *p) { *p = 1; }
@@ -0,0 +1,59 @@
+// REQUIRES: x86-registered-target
+// RUN: rm -rf %t && mkdir -p %t/early %t/include
+// RUN: echo '#define VALUE 1' > %t/include/value.h
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -I %t/early \
+// RUN:   -I %t/include -fcompile-cache-path=%t/cache -Rcompile-cache %s \
+// RUN:   -o %t/first.o -dependency-file %t/first.d -MT cache.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=MISS --implicit-check-not=remark: %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -I %t/early \
+// RUN:   -I %t/include -fcompile-cache-path=%t/cache -Rcompile-cache %s \
+// RUN:   -o %t/second.o -dependency-file %t/second.d -MT cache.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=HIT %s
+// RUN: cmp %t/first.o %t/second.o
+// RUN: diff %t/first.d %t/second.d
+
+// A change of an included file isn't a hit.
+// RUN: echo '#define VALUE 2' > %t/include/value.h
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -I %t/early \
+// RUN:   -I %t/include -fcompile-cache-path=%t/cache -Rcompile-cache %s \
+// RUN:   -o %t/third.o -dependency-file %t/third.d -MT cache.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=MISS --implicit-check-not=remark: %s
+// RUN: not cmp %t/first.o %t/third.o
+
+// Neither is a header which appears earlier in the search path.
+// RUN: echo '#define VALUE 3' > %t/early/value.h
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -I %t/early \
+// RUN:   -I %t/include -fcompile-cache-path=%t/cache -Rcompile-cache %s \
+// RUN:   -o %t/fourth.o -dependency-file %t/fourth.d -MT cache.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=MISS --implicit-check-not=remark: %s
+
+// The earlier results are still reused.
+// RUN: rm %t/early/value.h
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -I %t/early \
+// RUN:   -I %t/include -fcompile-cache-path=%t/cache -Rcompile-cache %s \
+// RUN:   -o %t/fifth.o -dependency-file %t/fifth.d -MT cache.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=HIT %s
+// RUN: cmp %t/third.o %t/fifth.o
+
+// The compilations which expand __DATE__ aren't cached.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -I %t/include \
+// RUN:   -DUSE_DATE -fcompile-cache-path=%t/cache -Rcompile-cache %s \
+// RUN:   -o %t/date.o
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj -I %t/include \
+// RUN:   -DUSE_DATE -fcompile-cache-path=%t/cache -Rcompile-cache %s \
+// RUN:   -o %t/date.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=MISS --implicit-check-not=remark: %s
+
+#include "value.h"
+
+#warning "value"
+// MISS: warning: "value"
+// HIT: remark: restored the result of the compilation of '{{.*}}compile-cache.c' from the cache
+// HIT: warning: "value"
+// HIT: 1 warning generated.
+
+int value = VALUE;
+
+#ifdef USE_DATE
+const char *date = __DATE__;
+#endif
@@ -0,0 +1,39 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '#include "inner.h"' > %t/outer.h
+// RUN: echo 'struct Inner { int X; };' > %t/inner.h
+// RUN: %clang_cc1 -fsyntax-only -I %t -fheader-cost-report=%t/report.json %s
+// RUN: FileCheck --check-prefix=REPORT %s < %t/report.json
+// RUN: %python -c 'import json, os, sys; [print(os.path.basename(h["path"]), h["count"], h["translation_units"]) for h in sorted(json.load(sys.stdin)["headers"], key=lambda h: h["path"])]' \
+// RUN:   < %t/report.json | FileCheck --check-prefix=COUNTS %s
+// RUN: %python %S/../../utils/merge-header-cost-reports.py %t/report.json \
+// RUN:   %t/report.json > %t/merged.json
+// RUN: %python -c 'import json, os, sys; [print(os.path.basename(h["path"]), h["count"], h["translation_units"]) for h in sorted(json.load(sys.stdin)["headers"], key=lambda h: h["path"])]' \
+// RUN:   < %t/merged.json | FileCheck --check-prefix=MERGED %s
+// RUN: %clang -### -c %s -fheader-cost-report=%t/report.json 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+
+// DRIVER: "-fheader-cost-report={{.*}}report.json"
+
+// REPORT:      "headers": [
+// REPORT-NEXT:   {
+// REPORT-NEXT:     "count": {{[0-9]+}},
+// REPORT-NEXT:     "exclusive_bytes": {{[0-9]+}},
+// REPORT-NEXT:     "exclusive_us": {{[0-9]+}},
+// REPORT-NEXT:     "inclusive_bytes": {{[0-9]+}},
+// REPORT-NEXT:     "inclusive_us": {{[0-9]+}},
+// REPORT-NEXT:     "path": "{{.*}}.h",
+// REPORT-NEXT:     "translation_units": 1
+// REPORT-NEXT:   },
+// REPORT:      "version": 1
+
+// The headers without include guards are counted once per inclusion.
+// COUNTS: inner.h 2 1
+// COUNTS-NEXT: outer.h 1 1
+
+// MERGED: inner.h 4 2
+// MERGED-NEXT: outer.h 2 2
+
+#include "outer.h"
+#define Inner Inner2
+#include "inner.h"
+#undef Inner
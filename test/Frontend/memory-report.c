@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -fsyntax-only -fmemory-report=%t/report.json %s
+// RUN: %python -c 'import json, sys; [print(s["phase"], *sorted(s["domains"])) for s in json.load(sys.stdin)["snapshots"]]' \
+// RUN:   < %t/report.json | FileCheck --check-prefix=PHASES %s
+// RUN: %python -c 'import json, sys; d = json.load(sys.stdin)["snapshots"][-1]["domains"]["ast"]; print(*sorted(d)); print(d["decls"]["Function"]["count"], d["stmts"]["ReturnStmt"]["count"])' \
+// RUN:   < %t/report.json | FileCheck --check-prefix=AST %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -fmemory-report=%t/analyzer.json %s
+// RUN: %python -c 'import json, sys; [print(s["phase"], *sorted(s["domains"].get("analyzer", {}))) for s in json.load(sys.stdin)["snapshots"]]' \
+// RUN:   < %t/analyzer.json | FileCheck --check-prefix=ANALYZER %s
+// RUN: %clang -### -c %s -fmemory-report=%t/report.json 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+
+// PHASES:      begin-source-file ast preprocessor process source_manager
+// PHASES-NEXT: end-of-main-file ast preprocessor process source_manager
+// PHASES-NEXT: execute ast preprocessor process source_manager
+
+// AST:      decls side_table_bytes stmts total_bytes types
+// AST-NEXT: 2 2
+
+// The exploded graphs of the functions are released before the end of the
+// execution, whose snapshot holds their peak.
+// ANALYZER:      begin-source-file
+// ANALYZER-NEXT: end-of-main-file
+// ANALYZER-NEXT: execute exploded_graph_bytes exploded_graph_nodes
+
+// DRIVER: "-fmemory-report={{.*}}report.json"
+
+int square(int X) { return X * X; }
+int cube(int X) { return square(X) * X; }
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm %s \
+// RUN:   -o %t/main.ll -ast-output %t/main.ast -index-record-path %t/index \
+// RUN:   -interface-stubs-output %t/main.ifs
+// RUN: FileCheck -check-prefix=IR %s < %t/main.ll
+// RUN: FileCheck -check-prefix=IFS %s < %t/main.ifs
+// RUN: cat %t/index/*.unit | FileCheck -check-prefix=INDEX %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -ast-print %t/main.ast \
+// RUN:   | FileCheck -check-prefix=AST %s
+
+// The secondary outputs also work with the actions which only parse.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fsyntax-only %s \
+// RUN:   -index-record-path %t/syntax-index
+// RUN: cat %t/syntax-index/*.unit | FileCheck -check-prefix=INDEX %s
+
+// RUN: not %clang_cc1 -E %s -o - -ast-output %t/pp.ast 2>&1 \
+// RUN:   | FileCheck -check-prefix=PP %s
+// PP: error: '-ast-output' requires an action which parses the translation unit
+
+int secondary(int X) { return X + 1; }
+// IR: define {{.*}}i32 @secondary(
+// IFS: "secondary" : { Type: Func }
+// INDEX: secondary-outputs.c
+// AST: int secondary(int X) {
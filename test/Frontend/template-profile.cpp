@@ -0,0 +1,48 @@
+// RUN: rm -f %t.json
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -ftemplate-profile=%t.json %s
+// RUN: FileCheck --check-prefix=CLASS %s < %t.json
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -ftemplate-profile=%t.json %s \
+// RUN:   -DFUNCTION
+// RUN: FileCheck --check-prefix=FUNCTION %s < %t.json
+// RUN: %clang -### -c %s -ftemplate-profile=%t.json 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+
+// DRIVER: "-ftemplate-profile={{.*}}.json"
+
+#ifndef FUNCTION
+// The recursive instantiations of Fib are all attributed to Fib.
+template <int N> struct Fib {
+  static const int Value = Fib<N - 1>::Value + Fib<N - 2>::Value;
+};
+template <> struct Fib<0> { static const int Value = 0; };
+template <> struct Fib<1> { static const int Value = 1; };
+
+static_assert(Fib<10>::Value == 55, "");
+
+// CLASS:      "templates": [
+// CLASS-NEXT:   {
+// CLASS-NEXT:     "count": 9,
+// CLASS-NEXT:     "exclusive_bytes": {{[0-9]+}},
+// CLASS-NEXT:     "exclusive_us": {{[0-9]+}},
+// CLASS-NEXT:     "inclusive_bytes": {{[0-9]+}},
+// CLASS-NEXT:     "inclusive_us": {{[0-9]+}},
+// CLASS-NEXT:     "location": "{{.*}}template-profile.cpp:{{[0-9]+}}:25",
+// CLASS-NEXT:     "name": "Fib"
+// CLASS-NEXT:   }
+// CLASS-NEXT: ],
+// CLASS-NEXT: "version": 1
+#else
+// Both specializations are attributed to the primary template, once for
+// their declarations and once for their definitions.
+template <typename T> T twice(T X) { return X + X; }
+
+int I = twice(1);
+double D = twice(1.0);
+
+// FUNCTION:      "templates": [
+// FUNCTION-NEXT:   {
+// FUNCTION-NEXT:     "count": 4,
+// FUNCTION:          "name": "twice"
+// FUNCTION-NEXT:   }
+// FUNCTION-NEXT: ],
+#endif
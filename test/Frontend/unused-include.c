@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -fsyntax-only -Wunused-include -I %S/Inputs/unused-include \
+// RUN:   -verify %s
+// RUN: %clang_cc1 -fsyntax-only -Wunused-include -I %S/Inputs/unused-include \
+// RUN:   -fdiagnostics-parseable-fixits %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs/unused-include \
+// RUN:   -Werror %s
+
+#include "used.h"
+#include "unused.h" // expected-warning-re {{included header 'unused.h' is not used; including it took {{[0-9]+\.[0-9]}} ms}}
+#include "macro.h"
+#include "type.h"
+#include "transitive.h"
+// The header which provides the declarations of another header is used.
+#include "provider.h"
+#include "consumer.h" // expected-warning-re {{included header 'consumer.h' is not used}}
+#include <stddef.h> // expected-warning-re {{included header 'stddef.h' is not used}}
+
+// CHECK-DAG: fix-it:"{{.*}}unused-include.c":{9:1-10:1}:""
+// CHECK-DAG: fix-it:"{{.*}}unused-include.c":{15:1-16:1}:""
+// CHECK-DAG: fix-it:"{{.*}}unused-include.c":{16:1-17:1}:""
+
+int f(struct Point *P) {
+  return used_function(P->X) + inner_function() + USED_MACRO;
+}
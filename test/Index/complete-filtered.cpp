@@ -0,0 +1,27 @@
+// Note: the run lines follow their respective tests, since line/column
+// matter in this test.
+
+namespace ns {
+  int value;
+  int variable;
+  int other;
+}
+using ns::value;
+using ns::variable;
+using ns::other;
+
+void test() {
+
+}
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER=va c-index-test -code-completion-at=%s:14:1 %s | FileCheck -check-prefix=CHECK-FILTER %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_FILTER=va c-index-test -code-completion-at=%s:14:1 %s | FileCheck -check-prefix=CHECK-FILTER %s
+// CHECK-FILTER-NOT: other
+// CHECK-FILTER: VarDecl:{ResultType int}{TypedText value}
+// CHECK-FILTER-NOT: other
+// CHECK-FILTER: VarDecl:{ResultType int}{TypedText variable}
+// CHECK-FILTER-NOT: other
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_FILTER=val CINDEXTEST_COMPLETION_LIMIT=1 c-index-test -code-completion-at=%s:14:1 %s | FileCheck -check-prefix=CHECK-LIMIT %s
+// CHECK-LIMIT: VarDecl:{ResultType int}{TypedText value}
+// CHECK-LIMIT-NOT: variable
@@ -0,0 +1,32 @@
+// REQUIRES: x86-registered-target
+
+// RUN: %clang -target x86_64-unknown-linux-gnu -write-interface-stubs -c %s \
+// RUN:   -o %t.o -### 2>&1 | FileCheck -check-prefix=DRIVER %s
+// DRIVER: "-cc1"
+// DRIVER-SAME: "-o" "{{.*}}.o" "-interface-stubs-output" "{{.*}}.ifs"
+
+// RUN: %clang -target x86_64-unknown-linux-gnu -write-interface-stubs -S %s \
+// RUN:   -o %t.s -### 2>&1 | FileCheck -check-prefix=NO-OBJECT %s
+// NO-OBJECT-NOT: "-interface-stubs-output"
+
+// The symbols are sorted by name.
+// RUN: rm -f %t.ifs
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj %s -o %t.o \
+// RUN:   -interface-stubs-output %t.ifs
+// RUN: FileCheck %s < %t.ifs
+// CHECK:      Symbols:
+// CHECK-NEXT:   "alpha" : { Type: Func }
+// CHECK-NEXT:   "beta" : { Type: Object, Size: 4 }
+// CHECK-NEXT:   "gamma" : { Type: Func }
+// CHECK-NEXT: ...
+
+// Stubs which didn't change aren't written again.
+// RUN: touch -t 200001010000 %t.ifs
+// RUN: touch %t.stamp
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj %s -o %t.o \
+// RUN:   -interface-stubs-output %t.ifs
+// RUN: find %t.ifs -newer %t.stamp | count 0
+
+int gamma(void) { return 0; }
+int beta = 1;
+int alpha(void) { return beta; }
@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+// The string literals which need no processing are referenced in the source
+// buffer. Check that they have the same value as those which are copied.
+
+static_assert(sizeof("") == 1, "");
+static_assert(sizeof("abc") == 4 && "abc"[2] == 'c', "");
+static_assert(sizeof(u8"abc") == 4 && u8"abc"[0] == 'a', "");
+static_assert(sizeof("é") == 3 && "é"[0] == "\xC3" [0], "");
+static_assert(sizeof(u8"é") == 3 && u8"é"[1] == "\xA9" [0], "");
+static_assert(sizeof("a\tb") == 4 && "a\tb"[1] == '\t', "");
+static_assert(sizeof("ab" "cd") == 5 && ("ab" "cd")[2] == 'c', "");
+static_assert(sizeof(R"(a\b)") == 5 && R"(a\b)"[1] == '\\', "");
+static_assert(sizeof(L"abc") == 4 * sizeof(wchar_t), "");
+
+// A line splice needs cleaning.
+static_assert(sizeof("ab\
+c") == 4 && "ab\
+c"[2] == 'c', "");
+
+// A long string, whose characters are checked a word at a time.
+static_assert(sizeof("0123456789abcdef0123456789abcdef") == 33 &&
+              "0123456789abcdef0123456789abcdef"[31] == 'f', "");
@@ -0,0 +1,30 @@
+void foo() {
+  int voodoo;
+  int unused;
+  voodoo = voodoo + 1;
+}
+
+// RUN: %clang -Wall -fsyntax-only %s --serialize-diagnostics %t
+// RUN: c-index-test -read-diagnostics-filtered all %t 2>&1 | FileCheck -check-prefix=ALL %s
+// RUN: c-index-test -read-diagnostics-filtered uninitialized %t 2>&1 | FileCheck -check-prefix=UNINIT %s
+// RUN: c-index-test -read-diagnostics-filtered unused-variable %t 2>&1 | FileCheck -check-prefix=UNUSED %s
+// RUN: c-index-test -read-diagnostics-filtered format %t 2>&1 | FileCheck -check-prefix=NONE %s
+// RUN: rm -f %t
+
+// ALL-DAG: {{.*}}serialized-diags-filtered.c:3:7: warning: unused variable 'unused' [-Wunused-variable] [Semantic Issue]
+// ALL-DAG: {{.*}}serialized-diags-filtered.c:4:12: warning: variable 'voodoo' is uninitialized when used here [-Wuninitialized] [Semantic Issue]
+// ALL: Number of diagnostics: 2
+
+// UNINIT-NOT: unused variable
+// UNINIT: {{.*}}serialized-diags-filtered.c:4:12: warning: variable 'voodoo' is uninitialized when used here [-Wuninitialized] [Semantic Issue]
+// UNINIT: Range: {{.*}}serialized-diags-filtered.c:4:12 {{.*}}serialized-diags-filtered.c:4:18
+// UNINIT: +-{{.*}}serialized-diags-filtered.c:2:13: note: initialize the variable 'voodoo' to silence this warning []
+// UNINIT: +-FIXIT: ({{.*}}serialized-diags-filtered.c:2:13 - {{.*}}serialized-diags-filtered.c:2:13): " = 0"
+// UNINIT: Number of diagnostics: 1
+
+// UNUSED-NOT: uninitialized
+// UNUSED: {{.*}}serialized-diags-filtered.c:3:7: warning: unused variable 'unused' [-Wunused-variable] [Semantic Issue]
+// UNUSED-NOT: uninitialized
+// UNUSED: Number of diagnostics: 1
+
+// NONE: Number of diagnostics: 0
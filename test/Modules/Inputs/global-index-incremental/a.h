@@ -0,0 +1,2 @@
+#define A_MACRO 1
+int a_function(void);
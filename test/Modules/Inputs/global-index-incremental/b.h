@@ -0,0 +1,2 @@
+#define B_MACRO 2
+int b_function(int);
@@ -0,0 +1,2 @@
+#define LAZY_MACRO 42
+int lazy_function(int);
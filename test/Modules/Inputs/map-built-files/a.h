@@ -0,0 +1,2 @@
+struct MapA { int Value; };
+int map_a(struct MapA *);
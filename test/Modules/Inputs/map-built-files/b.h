@@ -0,0 +1,2 @@
+#include "a.h"
+int map_b(struct MapA *);
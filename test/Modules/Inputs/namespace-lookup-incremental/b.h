@@ -0,0 +1,5 @@
+namespace N {
+  int b();
+  extern "C++" { int eb(); }
+  int a(int);
+}
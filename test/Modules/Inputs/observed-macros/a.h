@@ -0,0 +1,5 @@
+#ifdef USE_SHORT
+typedef short a_t;
+#else
+typedef char a_t;
+#endif
@@ -0,0 +1,48 @@
+// REQUIRES: shell
+//
+// RUN: %clang -fmodules -fsyntax-only -fmodules-deterministic-output \
+// RUN:   -fmodule-file-prefix-map=/old=/new %s -### 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-CC1 %s
+// CHECK-CC1: "-fno-pch-timestamp" "-fmodules-hash-content"
+// CHECK-CC1-SAME: "-fvalidate-ast-input-files-content"
+// CHECK-CC1-SAME: "-fmodule-file-prefix-map=/old=/new"
+//
+// RUN: not %clang -fmodules -fsyntax-only -fmodule-file-prefix-map=old %s \
+// RUN:   -### 2>&1 | FileCheck --check-prefix=CHECK-INVALID %s
+// CHECK-INVALID: error: invalid argument 'old' to -fmodule-file-prefix-map
+//
+// The same module built in two directories, from headers with different
+// modification times, is written the same way.
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a %t/b
+// RUN: echo 'int f(void);' > %t/a/m.h
+// RUN: echo 'module m { header "m.h" }' > %t/a/module.modulemap
+// RUN: cp %t/a/m.h %t/a/module.modulemap %t/b
+// RUN: touch -m -a -t 202001010000 %t/a/m.h
+// RUN: touch -m -a -t 202101010000 %t/b/m.h
+// RUN: %clang_cc1 -fmodules -fno-pch-timestamp -fmodules-hash-content \
+// RUN:   -fvalidate-ast-input-files-content -fmodule-file-prefix-map=%t/a=/src \
+// RUN:   -fmodule-name=m -emit-module -x objective-c %t/a/module.modulemap \
+// RUN:   -o %t/a.pcm
+// RUN: %clang_cc1 -fmodules -fno-pch-timestamp -fmodules-hash-content \
+// RUN:   -fvalidate-ast-input-files-content -fmodule-file-prefix-map=%t/b=/src \
+// RUN:   -fmodule-name=m -emit-module -x objective-c %t/b/module.modulemap \
+// RUN:   -o %t/b.pcm
+// RUN: cmp %t/a.pcm %t/b.pcm
+//
+// Without timestamps, the input files are validated by their content.
+// RUN: %clang_cc1 -fmodules -fno-pch-timestamp -fmodules-hash-content \
+// RUN:   -fvalidate-ast-input-files-content -fmodule-name=m -emit-module \
+// RUN:   -x objective-c %t/a/module.modulemap -o %t/m.pcm
+// RUN: touch -m -a -t 202201010000 %t/a/m.h
+// RUN: %clang_cc1 -fmodules -fvalidate-ast-input-files-content \
+// RUN:   -fmodule-map-file=%t/a/module.modulemap -fmodule-file=%t/m.pcm \
+// RUN:   -fsyntax-only %s -verify
+// RUN: echo 'int g(void);' > %t/a/m.h
+// RUN: not %clang_cc1 -fmodules -fvalidate-ast-input-files-content \
+// RUN:   -fmodule-map-file=%t/a/module.modulemap -fmodule-file=%t/m.pcm \
+// RUN:   -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CHECK-CHANGED %s
+// CHECK-CHANGED: m.h' has been modified since the module file '{{.*}}m.pcm' was built: content changed
+
+// expected-no-diagnostics
+@import m;
@@ -0,0 +1,26 @@
+// RUN: rm -rf %t
+// The index written after building A is updated, rather than rebuilt, when B
+// is built; A's entry is taken from the previous index.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fdisable-module-hash -fmodules-cache-path=%t -I %S/Inputs/global-index-incremental -DIMPORT_A %s -verify
+// RUN: ls %t | grep modules.idx
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fdisable-module-hash -fmodules-cache-path=%t -I %S/Inputs/global-index-incremental -DIMPORT_B %s -verify
+// RUN: llvm-bcanalyzer -dump %t/modules.idx | FileCheck %s --check-prefix=INDEX
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fdisable-module-hash -fmodules-cache-path=%t -I %S/Inputs/global-index-incremental -DIMPORT_A -DIMPORT_B %s -verify -print-stats 2>&1 | FileCheck %s
+
+// expected-no-diagnostics
+
+#ifdef IMPORT_A
+#include "a.h"
+int a = A_MACRO + a_function();
+#endif
+
+#ifdef IMPORT_B
+#include "b.h"
+int b = B_MACRO + b_function(0);
+#endif
+
+// INDEX-COUNT-2: <MODULE
+// INDEX: <IDENTIFIER_INDEX
+
+// CHECK: *** Global Module Index Statistics:
+// CHECK: identifier lookups succeeded
@@ -13,7 +13,12 @@
 @import Module;
 
 // CHECK: *** Global Module Index Statistics:
+// CHECK: 1 / 1 selector lookups succeeded
 
 int *get_sub() {
   return Module_Sub;
 }
+
+SEL get_version() {
+  return @selector(version);
+}
@@ -0,0 +1,12 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -fmodules-lazy-identifiers -I %S/Inputs/lazy-identifiers \
+// RUN:   -fsyntax-only -verify %s
+
+int lazy_function(int); // Seen before the module is loaded.
+
+#include "a.h"
+
+static_assert(LAZY_MACRO == 42, "");
+int x = lazy_function(LAZY_MACRO);
+int y = lazy_unknown; // expected-error {{use of undeclared identifier 'lazy_unknown'}}
@@ -0,0 +1,25 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/Top.framework/Headers
+// RUN: mkdir -p %t/Top.framework/Frameworks/Sub-1.framework/Headers
+// RUN: mkdir -p %t/Top.framework/Frameworks/Sub-1.framework/Frameworks/Nested.framework/Headers
+// RUN: echo 'int top;' > %t/Top.framework/Headers/Top.h
+// RUN: echo 'int sub;' > %t/Top.framework/Frameworks/Sub-1.framework/Headers/Sub_1.h
+// RUN: echo 'int nested;' > %t/Top.framework/Frameworks/Sub-1.framework/Frameworks/Nested.framework/Headers/Nested.h
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -F %t %s -verify
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -F %t -F %t/Top.framework/Frameworks/Sub-1.framework/Frameworks -Wauto-import -DHEADER %s -verify
+
+// The subframeworks of an inferred framework module are inferred when they
+// are imported, or when one of their headers is included, and all of them are
+// part of the built module.
+
+#ifdef HEADER
+#include <Nested/Nested.h> // expected-warning {{treating #include as an import of module 'Top.Sub_1.Nested'}}
+#else
+@import Top.Sub_1.Nested;
+#endif
+
+int *p = &nested;
+
+@import Top.Sub_1;
+
+int *q = &sub;
@@ -0,0 +1,12 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -fmodules-map-built-files -I %S/Inputs/map-built-files \
+// RUN:   -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -fmodules-map-built-files -I %S/Inputs/map-built-files \
+// RUN:   -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+#include "b.h"
+
+int f(struct MapA *A) { return map_a(A) + map_b(A) + A->Value; }
@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir -p %t/include
+// RUN: echo 'module A { header "a.h" export * }' > %t/include/module.modulemap
+// RUN: echo 'int a(void);' > %t/include/a.h
+// RUN: echo 'int b(void);' > %t/include/b.h
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -fmodule-map-cache=%t/maps -I %t/include -fsyntax-only -verify %s
+// RUN: ls %t/maps
+
+// The second compilation parses the cached tokens.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -fmodule-map-cache=%t/maps -I %t/include -fsyntax-only -verify %s
+
+// A module map whose size changed is lexed again.
+// RUN: echo 'module B { header "b.h" }' >> %t/include/module.modulemap
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -fmodule-map-cache=%t/maps -I %t/include -fsyntax-only -verify -DB %s
+
+// A cache which isn't valid is ignored.
+// RUN: echo 'garbage' > %t/maps
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -fmodule-map-cache=%t/maps -I %t/include -fsyntax-only -verify -DB %s
+
+// expected-no-diagnostics
+
+@import A;
+int x(void) { return a(); }
+
+#ifdef B
+@import B;
+int y(void) { return b(); }
+#endif
@@ -0,0 +1,31 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -I %S/Inputs/namespace-lookup-incremental -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+// The lookup table of N is built before the modules are imported and is
+// updated as more declarations of N are added, both locally and from modules.
+
+namespace N {
+  int x1();
+  extern "C++" { int ex1(); }
+}
+int u1 = N::x1() + N::ex1();
+
+#include "a.h"
+
+int u2 = N::a() + N::ia() + N::x1() + N::ex1();
+
+namespace N {
+  int x2();
+  inline namespace I { int ix2(); }
+}
+int u3 = N::x2() + N::ix2() + N::a() + N::x1();
+
+#include "b.h"
+
+namespace N {
+  extern "C++" { int ex3(); }
+}
+int u4 = N::b() + N::eb() + N::a(0) + N::a() + N::ia() + N::x1() + N::x2() +
+         N::ix2() + N::ex1() + N::ex3();
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodules-hash-observed-macros -I %S/Inputs/observed-macros -fsyntax-only -Rmodule-build -DUNUSED=1 %s 2>&1 | FileCheck %s --check-prefix=BUILD
+//
+// A macro the module doesn't observe doesn't affect which module file is used.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodules-hash-observed-macros -I %S/Inputs/observed-macros -fsyntax-only -Rmodule-build -DUNUSED=2 %s 2>&1 | count 0
+//
+// A macro the module tests does, even though the module was built without it.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodules-hash-observed-macros -I %S/Inputs/observed-macros -fsyntax-only -Rmodule-build -DUSE_SHORT %s 2>&1 | FileCheck %s --check-prefix=BUILD
+//
+// Once both configurations are known, each has its own module file.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodules-hash-observed-macros -I %S/Inputs/observed-macros -fsyntax-only -DUSE_SHORT %s
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodules-hash-observed-macros -I %S/Inputs/observed-macros -fsyntax-only -DUNUSED=3 %s
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodules-hash-observed-macros -I %S/Inputs/observed-macros -fsyntax-only -Rmodule-build -DUSE_SHORT %s 2>&1 | count 0
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodules-hash-observed-macros -I %S/Inputs/observed-macros -fsyntax-only -Rmodule-build -DUNUSED=3 %s 2>&1 | count 0
+
+// BUILD: remark: building module 'A'
+
+#include "a.h"
+
+#ifdef USE_SHORT
+_Static_assert(sizeof(a_t) == sizeof(short), "");
+#else
+_Static_assert(sizeof(a_t) == sizeof(char), "");
+#endif
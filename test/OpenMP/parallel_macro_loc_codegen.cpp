@@ -0,0 +1,15 @@
+// RUN: %clang_cc1 -verify -fopenmp -x c++ -triple x86_64-unknown-unknown -emit-llvm -debug-info-kind=limited %s -o - | FileCheck %s
+// expected-no-diagnostics
+
+// The directives expanded from one macro share the string of their location.
+
+#define TWICE(x) _Pragma("omp parallel") x; _Pragma("omp parallel") x;
+
+void foo();
+
+void bar() { TWICE(foo()) }
+
+// CHECK: c";{{[^;]*}}parallel_macro_loc_codegen.cpp;bar;[[LINE:[0-9]+]];[[COL:[0-9]+]];;\00"
+// CHECK-NOT: c";{{[^;]*}}parallel_macro_loc_codegen.cpp;bar;[[LINE]];[[COL]];;\00"
+// CHECK: define {{.*}}void @{{.*}}bar
+// CHECK-COUNT-2: call void {{.*}}@__kmpc_fork_call(
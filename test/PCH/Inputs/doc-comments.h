@@ -0,0 +1,6 @@
+/// A documented function.
+void documented_function(int);
+
+int plain;
+
+int documented_trailing; ///< A trailing comment.
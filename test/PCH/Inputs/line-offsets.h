@@ -0,0 +1,8 @@
+// Header for PCH test line-offsets.c
+
+// Lines ending in \r\n and in \n must both be counted.
+int a;
+
+int f(void);
+int crlf;
+int g(void);
@@ -0,0 +1,28 @@
+// Test this without pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include %s -fsyntax-only -verify %s
+
+// Test with pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t -fsyntax-only -verify %s
+
+// The builtins are known to the users of a PCH which doesn't mention them.
+
+#ifndef HEADER
+#define HEADER
+
+int header_function(void);
+
+#else
+
+#if !__has_builtin(__builtin_ia32_pause) || !__has_builtin(__builtin_memcpy)
+#error no builtins
+#endif
+
+void f(char *p, const char *q) {
+  __builtin_memcpy(p, q, 1);
+  __builtin_ia32_pause();
+  __builtin_memcyp(p, q, 1); // expected-error{{use of unknown builtin '__builtin_memcyp'}} \
+                             // expected-note{{did you mean '__builtin_memcpy'?}}
+}
+
+#endif
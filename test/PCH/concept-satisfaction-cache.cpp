@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -std=c++2a -emit-pch %s -o %t
+// RUN: %clang_cc1 -std=c++2a -include-pch %t -verify %s
+
+// expected-no-diagnostics
+
+#ifndef HEADER
+#define HEADER
+
+template<typename T>
+concept Complete = sizeof(T) > 0;
+
+struct S;
+static_assert(!Complete<S>);
+static_assert(Complete<int>);
+
+#else /*included pch*/
+
+struct S {};
+
+// The results of the satisfaction checks in the PCH are reused.
+static_assert(!Complete<S>);
+static_assert(Complete<int>);
+
+struct U {};
+static_assert(Complete<U>);
+
+#endif // HEADER
@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -std=c++11 -emit-pch %s -o %t
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -fsyntax-only -print-stats %s \
+// RUN:   2>&1 | FileCheck %s
+
+// CHECK: *** AST File Statistics per file:
+// CHECK-NEXT: {{.*}}: {{[0-9.]+}} KB read in {{[0-9.]+}} ms
+// CHECK-NEXT: {{[1-9][0-9]*}} declarations read ({{.*}}identifier lookup{{.*}}DeclContext lookup{{.*}}eager{{.*}})
+// CHECK-NEXT: {{[1-9][0-9]*}} types read
+// CHECK-NEXT: {{[0-9]+}} statements read
+
+#ifndef HEADER
+#define HEADER
+
+// Passed to the consumer eagerly.
+int Initialized = 42;
+
+int lookedUpByIdentifier(int);
+
+namespace N {
+struct LookedUpInNamespace {
+  int Member;
+};
+} // namespace N
+
+#else
+
+int Use = lookedUpByIdentifier(Initialized);
+N::LookedUpInNamespace Value;
+
+#endif
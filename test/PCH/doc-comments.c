@@ -0,0 +1,12 @@
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t %S/Inputs/doc-comments.h
+// RUN: %clang_cc1 -include-pch %t -ast-dump-all -ast-dump-filter documented %s | FileCheck %s
+
+// The comments of the files included by the PCH are loaded once a comment is
+// looked up in them.
+
+// CHECK: FunctionDecl {{.*}} documented_function
+// CHECK: FullComment
+// CHECK: TextComment {{.*}} Text=" A documented function."
+// CHECK: VarDecl {{.*}} documented_trailing
+// CHECK: FullComment
+// CHECK: TextComment {{.*}} Text=" A trailing comment."
@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -fdelayed-template-parsing -std=c++14 -emit-pch -o %t.1.pch -DFIRST %s
+// RUN: %clang_cc1 -fdelayed-template-parsing -std=c++14 -emit-pch -o %t.2.pch -include-pch %t.1.pch -DSECOND %s
+// RUN: %clang_cc1 -fdelayed-template-parsing -std=c++14 -include-pch %t.2.pch -fsyntax-only -verify %s
+
+// The late parsed templates of a PCH are read one at a time, from the PCH
+// which has them.
+
+#if defined(FIRST)
+
+template <typename T> T first(T t) { return t + 1; }
+template <typename T> T unused(T t) { return t.missing(); }
+
+#elif defined(SECOND)
+
+template <typename T> T second(T t) { return first(t) * 2; }
+int parsed = first(1);
+
+#else
+
+int x = second(1);
+int y = first(2);
+int z = unused(3); // expected-error@11 {{member reference base type 'int' is not a structure or union}} expected-note {{in instantiation of function template specialization 'unused<int>' requested here}}
+
+#endif
@@ -0,0 +1,15 @@
+// The line offsets of the headers are stored in the PCH, and used to compute
+// the line numbers of the diagnostics without scanning the headers again.
+
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t %S/Inputs/line-offsets.h
+// RUN: not %clang_cc1 -include-pch %t -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck %s
+
+float f(void);
+float g(void);
+
+// CHECK: line-offsets.c:8:7: error: conflicting types for 'f'
+// CHECK: line-offsets.h:6:5: note: previous declaration is here
+// CHECK: line-offsets.c:9:7: error: conflicting types for 'g'
+// CHECK: line-offsets.h:8:5: note: previous declaration is here
+// CHECK: files with line #'s computed ({{[1-9][0-9]*}} provided)
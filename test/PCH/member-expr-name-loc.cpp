@@ -0,0 +1,31 @@
+// Test this without pch.
+// RUN: %clang_cc1 -include %s -ast-dump -o - %s | FileCheck %s
+
+// Test with pch.
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -include-pch %t -ast-dump-all -o - %s | FileCheck %s
+
+#ifndef HEADER
+#define HEADER
+
+struct S {
+  int m;
+  operator int() const;
+  int operator+(int) const;
+};
+
+inline int f(const S &s) {
+  return s.m + s.operator int() + s.operator+(1);
+}
+
+template <typename T> void destroy(T *p) { p->~T(); }
+template void destroy<S>(S *);
+
+#else
+
+// CHECK: MemberExpr {{.*}} <col:10, col:12> 'const int' lvalue .m
+// CHECK: MemberExpr {{.*}} <col:16, col:29> '<bound member function type>' .operator int
+// CHECK: MemberExpr {{.*}} <col:35, col:45> '<bound member function type>' .operator+
+// CHECK: MemberExpr {{.*}} <col:44, col:48> '<bound member function type>' ->~S
+
+#endif
@@ -0,0 +1,22 @@
+// The PCH is the same when it's written in parallel.
+// RUN: %clang_cc1 -fno-pch-timestamp -emit-pch -o %t.pch %s
+// RUN: cp %t.pch %t.serial.pch
+// RUN: %clang_cc1 -fno-pch-timestamp -parallel-ast-writing -emit-pch -o %t.pch %s
+// RUN: cmp %t.serial.pch %t.pch
+// RUN: %clang_cc1 -include-pch %t.pch -fsyntax-only -verify %s
+
+#ifndef HEADER
+#define HEADER
+
+#define ANSWER 42
+struct S { int x; };
+int f(struct S s);
+
+#else
+
+int g(void) {
+  struct S s = {ANSWER};
+  return f(s) + undeclared; // expected-error {{use of undeclared identifier 'undeclared'}}
+}
+
+#endif
@@ -0,0 +1,54 @@
+// Check that the templates used by a PCH are instantiated while building it
+// with -fpch-instantiate-templates, and that the translation units including
+// the PCH use those instantiations.
+
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-pch -o %t.pch %s \
+// RUN:   -fpch-instantiate-templates
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -include-pch %t.pch %s \
+// RUN:   -emit-llvm -o - | FileCheck %s
+
+// Without the flag, the instantiations are left to the translation units.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-pch -o %t.noinst.pch %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -include-pch %t.noinst.pch %s \
+// RUN:   -emit-llvm -o - | FileCheck %s
+
+// Errors in the instantiations are reported while building the PCH.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-pch -o %t.err.pch %s \
+// RUN:   -fpch-instantiate-templates -DERRORS -verify
+
+// RUN: %clang -### -c %s -fpch-instantiate-templates 2>&1 \
+// RUN:   | FileCheck --check-prefix=DRIVER %s
+// RUN: %clang -### -c %s -fpch-instantiate-templates \
+// RUN:   -fno-pch-instantiate-templates 2>&1 \
+// RUN:   | FileCheck --check-prefix=NODRIVER %s
+
+// DRIVER: "-fpch-instantiate-templates"
+// NODRIVER-NOT: "-fpch-instantiate-templates"
+
+#ifndef HEADER
+#define HEADER
+
+template <typename T> struct A {
+  T get() const { return Value; }
+  T Value;
+};
+
+inline int useA(A<int> *a) { return a->get(); }
+
+#ifdef ERRORS
+template <typename T> struct B {
+  T get() const { return "text"; } // expected-error {{cannot initialize return object of type 'double' with an lvalue of type 'const char [5]'}}
+};
+
+// expected-note@+1 {{in instantiation of member function 'B<double>::get' requested here}}
+inline double useB(B<double> *b) { return b->get(); }
+#endif
+
+#else
+
+int f(A<int> *a) { return useA(a); }
+
+// CHECK-DAG: define linkonce_odr i32 @_ZNK1AIiE3getEv(
+// CHECK-DAG: define {{.*}}i32 @_Z1fP1AIiE(
+
+#endif
@@ -0,0 +1,48 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-pch %s -o %t
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -include-pch %t -verify %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -include-pch %t -fsyntax-only \
+// RUN:   -print-stats %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-pc-win32 -emit-pch %s -o %t.ms
+// RUN: %clang_cc1 -triple x86_64-pc-win32 -include-pch %t.ms -verify %s
+
+// expected-no-diagnostics
+
+// The layouts computed when building the PCH are reused.
+// CHECK: {{[1-9][0-9]*}} record layouts read
+
+#ifndef HEADER
+#define HEADER
+
+struct Empty {};
+struct Base {
+  virtual ~Base();
+  char C;
+};
+struct VBase {
+  int I;
+};
+struct Derived : Empty, Base, virtual VBase {
+  short S;
+  int Bits : 3;
+};
+
+static_assert(sizeof(Derived) > 0, "");
+struct NotLaidOut {
+  int I;
+};
+
+#else /*included pch*/
+
+#ifndef _WIN32
+static_assert(sizeof(Base) == 16, "");
+static_assert(alignof(Base) == 8, "");
+static_assert(sizeof(VBase) == 4, "");
+static_assert(sizeof(Derived) == 24, "");
+static_assert(alignof(Derived) == 8, "");
+#endif
+static_assert(sizeof(NotLaidOut) == 4, "");
+
+const VBase &toVBase(const Derived &D) { return D; }
+int getI(Derived &D) { return D.I; }
+
+#endif
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// The disambiguation of the nested declarators reuses the results of the
+// disambiguations done during the same tentative parse.
+
+// expected-no-diagnostics
+
+struct T { T(int); };
+int v;
+
+void f() {
+  T a(T(T(T(T(int)))));
+  T b(T(T(T(T(v)))));
+  int (*c(int (*(int (*)(int)))))(int);
+  for (T d(T(T(int))); false;)
+    ;
+}
+
+// CHECK: {{[0-9]+}} tentative parses backtracked, {{[0-9]+}} max nested tentative parses.
@@ -0,0 +1,15 @@
+// RUN: %clang_cc1 -E -print-stats %s -o /dev/null 2>&1 | FileCheck %s
+
+// The token lexers, argument lists and token buffers used by an expansion are
+// reused by the next ones, so their number doesn't grow with the number of
+// expansions.
+
+#define ID(x) x
+#define CAT(a, b) a ## b
+#define F(x, y) ID(CAT(x, y)) ID(x) ID(y)
+#define F4(x) F(x, 1) F(x, 2) F(x, 3) F(x, 4)
+#define F16(x) F4(x) F4(x) F4(x) F4(x)
+
+F16(a) F16(b) F16(c) F16(d)
+
+// CHECK: {{^[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9]?}} token lexers/macro argument lists/token buffers allocated for macro expansion.
@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -E -preprocessed-output-copy-spans %s | FileCheck -strict-whitespace %s
+// RUN: %clang_cc1 -E %s | FileCheck -check-prefix=NOSPANS -strict-whitespace %s
+
+#define PLUS +
+#define EMPTY
+#define CALL(x) f(x)
+
+int a =	1 +   2;
+// CHECK: int a =	1 +   2;
+// NOSPANS: int a = 1 + 2;
+
+int b = +PLUS+ 1;
+// CHECK: int b = + + + 1;
+
+int c = CALL(a)   EMPTY   * 3;
+// CHECK: int c = f(a) * 3;
+
+int d = a /* comment */ - - b;
+// CHECK: int d = a - - b;
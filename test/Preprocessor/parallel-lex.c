@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -E -parallel-lex-threshold=1 %s | FileCheck -strict-whitespace %s
+// RUN: %clang_cc1 -fsyntax-only -pedantic -verify -parallel-lex-threshold=1 %s
+
+#define ADD(x, y) ((x) + (y))
+#define ZERO 0
+
+int a = ADD(1, ZERO);
+// CHECK: int a = ((1) + (0));
+
+/* A comment
+int not_a_token = 1;
+*/ int b = 2.5e+3 + 0x1f;
+// CHECK: int b = 2.5e+3 + 0x1f;
+
+#if ZERO
+int excluded;
+#else
+int c = a<<b >>= a;
+// CHECK: int c = a<<b >>= a;
+#endif
+// CHECK-NOT: excluded
+
+const char *d = "int e = 1;";
+// CHECK: const char *d = "int e = 1;";
+
+int f$g; // expected-warning {{'$' in identifier}}
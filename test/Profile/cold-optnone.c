@@ -0,0 +1,25 @@
+// Test that the functions which were never executed aren't optimized with
+// -fprofile-cold-optnone.
+
+// RUN: llvm-profdata merge %S/Inputs/cold-optnone.proftext -o %t.profdata
+// RUN: %clang_cc1 %s -o - -disable-llvm-passes -emit-llvm -O2 -fprofile-instrument-use-path=%t.profdata -fprofile-cold-optnone | FileCheck %s
+// RUN: %clang_cc1 %s -o - -disable-llvm-passes -emit-llvm -O2 -fprofile-instrument-use-path=%t.profdata | FileCheck -check-prefix=DEFAULT %s
+
+// CHECK: define {{.*}}@hot() [[HOT:#[0-9]+]]
+// DEFAULT: define {{.*}}@hot() [[DEFAULT_HOT:#[0-9]+]]
+void hot() { return; }
+
+// CHECK: define {{.*}}@cold() [[COLD:#[0-9]+]]
+// DEFAULT: define {{.*}}@cold() [[DEFAULT_HOT]]
+void cold() { return; }
+
+// CHECK: define {{.*}}@main() [[HOT]]
+int main() {
+  hot();
+  return 0;
+}
+
+// CHECK: attributes [[HOT]] = {
+// CHECK-NOT: optnone
+// CHECK: attributes [[COLD]] = { {{.*}}noinline{{.*}}optnone
+// DEFAULT-NOT: optnone
@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fsyntax-only -verify -Wconversion -Wsign-conversion %s
+
+// The conversions in regions where all the conversion warnings are ignored
+// aren't diagnosed, the ones after them are.
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wconversion"
+#pragma clang diagnostic ignored "-Wconstant-conversion"
+#pragma clang diagnostic ignored "-Wenum-conversion"
+char ignored(int i, long l) {
+  short s = l;
+  unsigned u = i;
+  char c = 1000;
+  return i;
+}
+#pragma clang diagnostic pop
+
+char diagnosed(int i, long l) {
+  short s = l; // expected-warning {{implicit conversion loses integer precision: 'long' to 'short'}}
+  unsigned u = i; // expected-warning {{implicit conversion changes signedness: 'int' to 'unsigned int'}}
+  char c = 1000; // expected-warning {{implicit conversion from 'int' to 'char' changes value from 1000 to -24}}
+  return i; // expected-warning {{implicit conversion loses integer precision: 'int' to 'char'}}
+}
@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -fspell-checking-work-limit 1 %s
+
+// The typo which uses up the budget is still corrected, but the following
+// ones aren't.
+
+int counter; // expected-note {{'counter' declared here}}
+
+void f() {
+  countr = 1; // expected-error {{use of undeclared identifier 'countr'; did you mean 'counter'?}}
+  conter = 2; // expected-error {{use of undeclared identifier 'conter'}}
+}
@@ -0,0 +1,46 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -fconstexpr-call-cache-size 64
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify=nocache %s
+// RUN: %clang -std=c++14 -fsyntax-only -Xclang -verify %s -fconstexpr-call-cache-size=64
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only %s -fconstexpr-call-cache-size 64 \
+// RUN:   -print-stats 2>&1 | FileCheck %s
+
+// CHECK: {{[1-9][0-9]*}} constexpr call results memoized ({{[0-9]+}} bytes)
+// CHECK: {{[1-9][0-9]*}} constexpr calls reused a memoized result
+// CHECK: 0 constexpr call results not memoized, cache full
+
+// expected-no-diagnostics
+
+// Without memoization, this evaluates about 2.7 million calls, which exceeds
+// the default step limit.
+constexpr int fib(int n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); } // nocache-note {{step limit}} nocache-note 0+ {{in call to}} nocache-note 0+ {{skipping}}
+static_assert(fib(30) == 832040, ""); // nocache-error {{not an integral constant expression}} nocache-note {{in call to}}
+static_assert(fib(20) == 6765, "");
+
+constexpr double halve(double x) { return x / 2; }
+static_assert(halve(3.0) == 1.5, "");
+static_assert(halve(halve(3.0)) == 0.75, "");
+
+template <typename T> constexpr T decrement(T v) { return v - 1; }
+static_assert(decrement(0) == -1, "");
+static_assert(decrement(0u) == ~0u, "");
+
+// Calls which are passed references can modify the objects of their caller,
+// and are evaluated every time.
+constexpr int increment(int &n) { return ++n; }
+constexpr int count(int calls) {
+  int n = 0;
+  for (int i = 0; i < calls; ++i)
+    increment(n);
+  return n;
+}
+static_assert(count(3) == 3, "");
+static_assert(count(3) + count(2) == 5, "");
+
+constexpr int capture(int n) {
+  auto get = [&n] { return n; };
+  int a = get();
+  n = 5;
+  return a + get();
+}
+static_assert(capture(1) == 6, "");
+static_assert(capture(2) == 7, "");
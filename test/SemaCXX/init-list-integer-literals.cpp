@@ -0,0 +1,29 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify -DERRORS %s
+// RUN: %clang_cc1 -std=c++11 -ast-dump %s | FileCheck %s
+
+// The array elements initialized with integer literals their type can
+// represent are converted without an initialization sequence.
+
+constexpr unsigned char bytes[] = {0, 1, 255, 0x7f};
+static_assert(bytes[2] == 255 && bytes[3] == 127, "");
+
+constexpr signed char chars[] = {-128, 127, -1};
+static_assert(chars[0] == -128 && chars[2] == -1, "");
+
+constexpr unsigned long long wide[] = {1, -1ull, 18446744073709551615u};
+static_assert(wide[1] == wide[2], "");
+
+constexpr short nested[][2] = {{1, -2}, {3}};
+static_assert(nested[0][1] == -2 && nested[1][1] == 0, "");
+
+// CHECK-LABEL: VarDecl {{.*}} typed 'const int [2]'
+// CHECK: InitListExpr {{.*}} 'const int [2]'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 1
+// CHECK-NEXT: UnaryOperator {{.*}} 'int' prefix '-'
+constexpr int typed[] = {1, -2};
+
+#ifdef ERRORS
+// The other literals are still checked for narrowing.
+unsigned char narrowed[] = {256}; // expected-error {{constant expression evaluates to 256 which cannot be narrowed to type 'unsigned char'}} expected-note {{insert an explicit cast}}
+unsigned negative[] = {-1}; // expected-error {{cannot be narrowed}} expected-note {{insert an explicit cast}}
+#endif
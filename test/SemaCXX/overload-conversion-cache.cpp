@@ -0,0 +1,59 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -std=c++11 %s
+
+// Overload resolution reuses the conversion sequences that only depend on the
+// types involved. Check that the conversions that also depend on the argument
+// expression, or on declarations that come later, are not reused.
+
+namespace null_pointer_constant {
+char f(long); // expected-note {{candidate function}}
+int f(void *); // expected-note {{candidate function}}
+
+void test(int i) {
+  static_assert(sizeof(f(i)) == 1, "");
+  static_assert(sizeof(f(i)) == 1, "");
+  f(0); // expected-error {{call to 'f' is ambiguous}}
+}
+}
+
+namespace bit_field {
+char g(int);
+int g(unsigned);
+
+struct S {
+  unsigned x : 3;
+};
+
+void test(S s, unsigned u) {
+  static_assert(sizeof(g(u)) == sizeof(int), "");
+  static_assert(sizeof(g(s.x)) == 1, "");
+  static_assert(sizeof(g(u)) == sizeof(int), "");
+}
+}
+
+namespace incomplete_class {
+struct B {};
+struct D;
+
+char h(B *);
+int h(void *);
+
+void test1(D *d) { static_assert(sizeof(h(d)) == sizeof(int), ""); }
+
+struct D : B {};
+
+void test2(D *d) {
+  static_assert(sizeof(h(d)) == 1, "");
+  static_assert(sizeof(h(d)) == 1, "");
+}
+}
+
+namespace value_kind {
+char k(int &);
+int k(const int &&);
+
+void test(int i) {
+  static_assert(sizeof(k(i)) == 1, "");
+  static_assert(sizeof(k(static_cast<int &&>(i))) == sizeof(int), "");
+  static_assert(sizeof(k(i)) == 1, "");
+}
+}
@@ -0,0 +1,47 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -DNO_ERRORS %s -print-stats 2>&1 \
+// RUN:   | FileCheck %s
+
+// CHECK: {{[1-9][0-9]*}} of {{[0-9]+}} unqualified lookups reused the using directives of the previous lookup.
+
+namespace A { int a; int x; }
+namespace B { int b; int x; }
+namespace C { using namespace A; int c; }
+
+using namespace C;
+
+int sum() { return a + c + a + c; }
+
+void blocks() {
+  {
+    using namespace B;
+    (void)(a + b + c);
+  }
+#ifndef NO_ERRORS
+  // The scope of the previous block may be reused for this one, without its
+  // using directive.
+  {
+    (void)b; // expected-error {{use of undeclared identifier 'b'}}
+  }
+#endif
+  {
+    using namespace B;
+#ifndef NO_ERRORS
+    (void)x; // expected-error {{reference to 'x' is ambiguous}}
+             // expected-note@7 {{candidate found by name lookup}}
+             // expected-note@8 {{candidate found by name lookup}}
+#endif
+  }
+}
+
+namespace D { int d; }
+int afterD() { return a + c; }
+using namespace D;
+// The directive added since the previous lookup is found.
+int useD() { return d + a; }
+
+namespace N {
+void f();
+}
+using namespace B;
+void N::f() { (void)(a + b + c + a + b); }
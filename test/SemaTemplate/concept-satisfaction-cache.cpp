@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -std=c++2a -verify %s
+
+// expected-no-diagnostics
+
+template<typename T>
+concept Complete = sizeof(T) > 0;
+
+template<typename T>
+concept Large = Complete<T> && sizeof(T) > 4;
+
+struct S;
+static_assert(!Complete<S>);
+static_assert(!Large<S>);
+
+struct S { char Data[8]; };
+
+// The satisfaction of a concept is checked once for each list of canonical
+// template arguments. Checking it again after S was completed would give a
+// different result, which makes the program ill-formed, no diagnostic
+// required ([temp.constr.atomic]p3).
+static_assert(!Complete<S>);
+static_assert(!Large<S>);
+
+using Alias = S;
+static_assert(!Complete<Alias>);
+
+struct U { char Data[8]; };
+static_assert(Complete<U>);
+static_assert(Large<U>);
+static_assert(Complete<int>);
+static_assert(!Large<char>);
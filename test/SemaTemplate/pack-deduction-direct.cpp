@@ -0,0 +1,46 @@
+// RUN: %clang_cc1 -std=c++17 -fsyntax-only -verify %s
+
+// The arguments that a bare type parameter pack, as in List<Ts...>, is
+// matched against are deduced as the elements of the pack all at once. Check
+// that this deduces the same as matching each argument in turn.
+
+template <typename... Ts> struct List {};
+template <typename T, typename U> constexpr bool is_same = false;
+template <typename T> constexpr bool is_same<T, T> = true;
+
+template <typename... Ts> List<Ts...> elements(List<Ts...>);
+
+typedef int Int;
+static_assert(is_same<decltype(elements(List<Int, const int, int *>())),
+                      List<int, const int, int *>>);
+static_assert(is_same<decltype(elements(List<>())), List<>>);
+
+// Arrays are left to the general case.
+static_assert(is_same<decltype(elements(List<const int[2], char>())),
+                      List<const int[2], char>>);
+
+// A pack deduced from several places must be deduced consistently.
+template <typename... Ts> void both(List<Ts...>, List<Ts...>); // expected-note {{candidate template ignored: deduced conflicting types for parameter 'Ts'}}
+void testBoth() {
+  both(List<int, char>(), List<int, char>());
+  both(List<int, char>(), List<int, long>()); // expected-error {{no matching function}}
+}
+
+// Qualified patterns are matched against each argument.
+template <typename... Ts> void qualified(List<const Ts...>); // expected-note {{candidate template ignored}}
+void testQualified() {
+  qualified(List<const int, const char>());
+  qualified(List<int>()); // expected-error {{no matching function}}
+}
+
+// Partial ordering deduces from pack expansions.
+template <typename T> struct Tail { static constexpr int Which = 0; };
+template <typename T, typename... Ts> struct Tail<List<T, Ts...>> {
+  static constexpr int Which = 1;
+};
+template <typename... Ts> struct Tail<List<int, Ts...>> {
+  static constexpr int Which = 2;
+};
+static_assert(Tail<List<char, int>>::Which == 1);
+static_assert(Tail<List<int, char>>::Which == 2);
+static_assert(Tail<List<>>::Which == 0);
@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only %s -print-stats 2>&1 \
+// RUN:   | FileCheck %s
+
+// CHECK: {{[1-9][0-9]*}} template specialization types compared while uniquing, {{[0-9]+}} with the same hash but a different profile
+
+// expected-no-diagnostics
+
+template <typename T, typename U> struct is_same { static const bool value = false; };
+template <typename T> struct is_same<T, T> { static const bool value = true; };
+
+template <typename... Ts> struct list {};
+template <int N> struct int_ {};
+
+template <typename T> struct wrap {
+  typedef list<T, list<T, int_<sizeof(T)>>> type;
+  template <typename U> struct inner {
+    typedef list<typename U::template apply<T>::type, T> type;
+  };
+};
+
+struct identity {
+  template <typename T> struct apply { typedef T type; };
+};
+
+typedef list<int, list<int, int_<sizeof(int)>>> expected;
+static_assert(is_same<wrap<int>::type, expected>::value, "");
+static_assert(is_same<wrap<int>::type, wrap<int>::type>::value, "");
+static_assert(!is_same<wrap<int>::type, wrap<long>::type>::value, "");
+static_assert(is_same<wrap<char>::inner<identity>::type,
+                      list<char, char>>::value, "");
@@ -0,0 +1,21 @@
+// UNSUPPORTED: system-windows
+//
+// RUN: rm -rf %t && mkdir -p %t/reports
+// RUN: echo '[{"directory": "%t", "command": "clang++ -c %s -o %t/a.o",' \
+// RUN:   '"file": "%s"}]' > %t/compile_commands.json
+// RUN: clang-check -analyze -executor=all-TUs -execute-concurrency=2 \
+// RUN:   -timings-file=%t/timings -analyzer-output-dir=%t/reports \
+// RUN:   %t/compile_commands.json 2>&1 | FileCheck %s
+// RUN: ls %t/reports | FileCheck -check-prefix=PLIST %s
+// RUN: FileCheck -check-prefix=TIMINGS %s < %t/timings
+// RUN: clang-check -analyze -executor=all-TUs -analyzer-output=sarif \
+// RUN:   -timings-file=%t/timings -analyzer-output-dir=%t/reports \
+// RUN:   %t/compile_commands.json 2> /dev/null
+// RUN: ls %t/reports | FileCheck -check-prefix=SARIF %s
+// RUN: not ls %t/a.o
+
+// CHECK: Dereference of null pointer
+// PLIST: clang-check-analyzer-all-tus.cpp-{{[0-9A-F]+}}.plist
+// SARIF: clang-check-analyzer-all-tus.cpp-{{[0-9A-F]+}}.sarif
+// TIMINGS: {{^[0-9]+ .*}}clang-check-analyzer-all-tus.cpp{{$}}
+void a(int *x) { if(x){} *x = 47; }
@@ -181,6 +181,10 @@ static void describeLibclangFailure(enum CXErrorCode Err) {
   case CXError_ASTReadError:
     fprintf(stderr, "Failure: AST deserialization error occurred\n");
     return;
+
+  case CXError_Cancelled:
+    fprintf(stderr, "Failure: the operation was cancelled\n");
+    return;
   }
 }
 
@@ -2641,6 +2645,9 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   unsigned I, Repeats = 1;
   unsigned completionOptions = clang_defaultCodeCompleteOptions();
   const char *InvocationPath;
+  const char *CompletionFilter = getenv("CINDEXTEST_COMPLETION_FILTER");
+  const char *CompletionLimit = getenv("CINDEXTEST_COMPLETION_LIMIT");
+  unsigned MaxResults = CompletionLimit ? atoi(CompletionLimit) : 0;
 
   if (getenv("CINDEXTEST_CODE_COMPLETE_PATTERNS"))
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
@@ -2692,9 +2699,15 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   }
 
   for (I = 0; I != Repeats; ++I) {
-    results = clang_codeCompleteAt(TU, filename, line, column,
-                                   unsaved_files, num_unsaved_files,
-                                   completionOptions);
+    if (CompletionFilter || MaxResults)
+      results = clang_codeCompleteAtFiltered(TU, filename, line, column,
+                                             unsaved_files, num_unsaved_files,
+                                             completionOptions,
+                                             CompletionFilter, MaxResults);
+    else
+      results = clang_codeCompleteAt(TU, filename, line, column,
+                                     unsaved_files, num_unsaved_files,
+                                     completionOptions);
     if (!results) {
       fprintf(stderr, "Unable to perform code completion!\n");
       return 1;
@@ -4102,6 +4115,92 @@ static int index_compile_db(int argc, const char **argv) {
   return errorCode;
 }
 
+static int index_compile_db_parallel(int argc, const char **argv) {
+  const char *check_prefix;
+  unsigned num_threads;
+  CXIndex Idx;
+  CXIndexAction idxAction;
+  CXCompilationDatabase db;
+  CXCompilationDatabase_Error ec;
+  IndexData index_data;
+  char *tmp;
+  char *buildDir;
+  size_t len;
+  int result;
+
+  check_prefix = 0;
+  if (argc > 0) {
+    if (strstr(argv[0], "-check-prefix=") == argv[0]) {
+      check_prefix = argv[0] + strlen("-check-prefix=");
+      ++argv;
+      --argc;
+    }
+  }
+
+  if (argc < 2) {
+    fprintf(stderr, "expected a thread count and a compilation database\n");
+    return -1;
+  }
+  num_threads = (unsigned)atoi(argv[0]);
+
+  len = strlen(argv[1]);
+  tmp = (char *) malloc(len+1);
+  assert(tmp);
+  memcpy(tmp, argv[1], len+1);
+  buildDir = dirname(tmp);
+
+  db = clang_CompilationDatabase_fromDirectory(buildDir, &ec);
+  if (!db || ec != CXCompilationDatabase_NoError) {
+    printf("database loading failed with error code %d.\n", ec);
+    clang_CompilationDatabase_dispose(db);
+    free(tmp);
+    return -1;
+  }
+  if (chdir(buildDir) != 0) {
+    printf("Could not chdir to %s\n", buildDir);
+    clang_CompilationDatabase_dispose(db);
+    free(tmp);
+    return -1;
+  }
+
+  if (!(Idx = clang_createIndex(/* excludeDeclsFromPCH */ 1,
+                                /* displayDiagnostics=*/1))) {
+    fprintf(stderr, "Could not create Index\n");
+    clang_CompilationDatabase_dispose(db);
+    free(tmp);
+    return 1;
+  }
+  idxAction = clang_IndexAction_create(Idx);
+
+  index_data.check_prefix = check_prefix;
+  index_data.first_check_printed = 0;
+  index_data.fail_for_error = 0;
+  index_data.abort = 0;
+  index_data.main_filename = createCXString("");
+  index_data.importedASTs = 0;
+  index_data.strings = NULL;
+  index_data.TU = NULL;
+
+  result = clang_indexCompilationDatabase(idxAction, &index_data,
+                                          &IndexCB, sizeof(IndexCB),
+                                          getIndexOptions(), db,
+                                          getDefaultParsingOptions(),
+                                          num_threads);
+  if (result != CXError_Success)
+    describeLibclangFailure(result);
+
+  if (index_data.fail_for_error)
+    result = -1;
+
+  clang_disposeString(index_data.main_filename);
+  free_client_data(&index_data);
+  clang_IndexAction_dispose(idxAction);
+  clang_disposeIndex(Idx);
+  clang_CompilationDatabase_dispose(db);
+  free(tmp);
+  return result;
+}
+
 int perform_token_annotation(int argc, const char **argv) {
   const char *input = argv[1];
   char *filename = 0;
@@ -4739,6 +4838,38 @@ static int read_diagnostics(const char *filename) {
   return 0;
 }
 
+static int filter_diagnostic_by_option(enum CXDiagnosticSeverity severity,
+                                       unsigned category,
+                                       const char *category_text,
+                                       const char *option,
+                                       CXClientData client_data) {
+  return strcmp(option, (const char *)client_data) == 0;
+}
+
+static int read_diagnostics_filtered(const char *option,
+                                     const char *filename) {
+  enum CXLoadDiag_Error error;
+  CXString errorString;
+  CXDiagnosticSet Diags = 0;
+
+  Diags = clang_loadDiagnosticsFiltered(
+      filename, strcmp(option, "all") ? filter_diagnostic_by_option : NULL,
+      (CXClientData)option, &error, &errorString);
+  if (!Diags) {
+    fprintf(stderr, "Trouble deserializing file (%s): %s\n",
+            getDiagnosticCodeStr(error),
+            clang_getCString(errorString));
+    clang_disposeString(errorString);
+    return 1;
+  }
+
+  printDiagnosticSet(Diags, 0);
+  fprintf(stderr, "Number of diagnostics: %d\n",
+          clang_getNumDiagnosticsInSet(Diags));
+  clang_disposeDiagnosticSet(Diags);
+  return 0;
+}
+
 static int perform_print_build_session_timestamp(void) {
   printf("%lld\n", clang_getBuildSessionTimestamp());
   return 0;
@@ -4772,6 +4903,7 @@ static void print_usage(void) {
     "       c-index-test -index-file-full [-check-prefix=<FileCheck prefix>] <compiler arguments>\n"
     "       c-index-test -index-tu [-check-prefix=<FileCheck prefix>] <AST file>\n"
     "       c-index-test -index-compile-db [-check-prefix=<FileCheck prefix>] <compilation database>\n"
+    "       c-index-test -index-compile-db-parallel [-check-prefix=<FileCheck prefix>] <threads> <compilation database>\n"
     "       c-index-test -test-file-scan <AST file> <source file> "
           "[FileCheck prefix]\n");
   fprintf(stderr,
@@ -4807,7 +4939,9 @@ static void print_usage(void) {
   fprintf(stderr,
     "       c-index-test -print-build-session-timestamp\n");
   fprintf(stderr,
-    "       c-index-test -read-diagnostics <file>\n\n");
+    "       c-index-test -read-diagnostics <file>\n"
+    "       c-index-test -read-diagnostics-filtered <warning option> "
+    "<file>\n\n");
   fprintf(stderr,
     " <symbol filter> values:\n%s",
     "   all - load all symbols, including those from PCH\n"
@@ -4826,6 +4960,8 @@ int cindextest_main(int argc, const char **argv) {
   clang_enableStackTraces();
   if (argc > 2 && strcmp(argv[1], "-read-diagnostics") == 0)
       return read_diagnostics(argv[2]);
+  if (argc > 3 && strcmp(argv[1], "-read-diagnostics-filtered") == 0)
+      return read_diagnostics_filtered(argv[2], argv[3]);
   if (argc > 2 && strstr(argv[1], "-code-completion-at=") == argv[1])
     return perform_code_completion(argc, argv, 0);
   if (argc > 2 && strstr(argv[1], "-code-completion-timing=") == argv[1])
@@ -4850,6 +4986,8 @@ int cindextest_main(int argc, const char **argv) {
     return index_tu(argc - 2, argv + 2);
   if (argc > 2 && strcmp(argv[1], "-index-compile-db") == 0)
     return index_compile_db(argc - 2, argv + 2);
+  if (argc > 2 && strcmp(argv[1], "-index-compile-db-parallel") == 0)
+    return index_compile_db_parallel(argc - 2, argv + 2);
   else if (argc >= 4 && strncmp(argv[1], "-test-load-tu", 13) == 0) {
     CXCursorVisitor I = GetVisitor(argv[1] + 13);
     if (I)
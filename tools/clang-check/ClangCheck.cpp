@@ -16,20 +16,26 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/AST/ASTConsumer.h"
+#include "clang/Basic/TargetInfo.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Driver/Options.h"
 #include "clang/Frontend/ASTConsumers.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Rewrite/Frontend/FixItRewriter.h"
 #include "clang/Rewrite/Frontend/FrontendActions.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Execution.h"
+#include "clang/Tooling/ToolExecutorPluginRegistry.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace clang::driver;
 using namespace clang::tooling;
@@ -49,6 +55,11 @@ static cl::extrahelp MoreHelp(
     "\tNote, that path/in/subtree and current directory should follow the\n"
     "\trules described above.\n"
     "\n"
+    "\tTo analyze all the files of a compilation database in parallel, use:\n"
+    "\n"
+    "\t  clang-check -analyze -executor=all-TUs -p build/path \\\n"
+    "\t    -analyzer-output-dir=reports build/path\n"
+    "\n"
 );
 
 static cl::OptionCategory ClangCheckCategory("clang-check options");
@@ -73,6 +84,16 @@ static cl::opt<bool>
     Analyze("analyze",
             cl::desc(Options.getOptionHelpText(options::OPT_analyze)),
             cl::cat(ClangCheckCategory));
+static cl::opt<std::string> AnalyzerOutput(
+    "analyzer-output",
+    cl::desc(Options.getOptionHelpText(options::OPT__analyzer_output)),
+    cl::cat(ClangCheckCategory));
+static cl::opt<std::string> AnalyzerOutputDir(
+    "analyzer-output-dir",
+    cl::desc("With -analyze, write the report of each file to this "
+             "directory, named after the file, instead of to the working "
+             "directory of its compile command."),
+    cl::cat(ClangCheckCategory));
 
 static cl::opt<bool>
     Fixit("fixit", cl::desc(Options.getOptionHelpText(options::OPT_fixit)),
@@ -131,6 +152,51 @@ public:
   }
 };
 
+/// Runs the analyzer, writing the reports to -analyzer-output-dir if given.
+class ClangCheckAnalysisActionFactory : public FrontendActionFactory {
+public:
+  std::unique_ptr<clang::FrontendAction> create() override {
+    return std::make_unique<clang::ento::AnalysisAction>();
+  }
+
+  bool runInvocation(std::shared_ptr<clang::CompilerInvocation> Invocation,
+                     clang::FileManager *Files,
+                     std::shared_ptr<clang::PCHContainerOperations> PCHOps,
+                     clang::DiagnosticConsumer *DiagConsumer) override {
+    clang::FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
+    if (!AnalyzerOutputDir.empty() && FrontendOpts.Inputs.size() == 1)
+      FrontendOpts.OutputFile = getReportPath(
+          FrontendOpts.Inputs[0].getFile(),
+          Invocation->getAnalyzerOpts()->AnalysisDiagOpt);
+    return FrontendActionFactory::runInvocation(
+        std::move(Invocation), Files, std::move(PCHOps), DiagConsumer);
+  }
+
+private:
+  /// The files of different directories can have the same name, so the name
+  /// of their report also has the hash of their path.
+  static std::string getReportPath(StringRef File,
+                                   clang::AnalysisDiagClients Format) {
+    SmallString<256> Path(AnalyzerOutputDir);
+    llvm::sys::path::append(Path, llvm::sys::path::filename(File) + "-" +
+                                      llvm::utohexstr(llvm::xxHash64(File)));
+    switch (Format) {
+    case clang::PD_PLIST:
+    case clang::PD_PLIST_MULTI_FILE:
+    case clang::PD_PLIST_HTML:
+      Path += ".plist";
+      break;
+    case clang::PD_SARIF:
+      Path += ".sarif";
+      break;
+    default:
+      // The HTML reports are written into the directory at the path.
+      break;
+    }
+    return Path.str();
+  }
+};
+
 class ClangCheckActionFactory {
 public:
   std::unique_ptr<clang::ASTConsumer> newASTConsumer() {
@@ -150,39 +216,78 @@ public:
 
 } // namespace
 
+/// Create the executor selected with -executor.
+static llvm::Expected<std::unique_ptr<ToolExecutor>>
+createExecutor(CommonOptionsParser &OptionsParser) {
+  for (const auto &Plugin : ToolExecutorPluginRegistry::entries())
+    if (Plugin.getName() == ExecutorName)
+      return Plugin.instantiate()->create(OptionsParser);
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "executor '%s' is not registered",
+                                 ExecutorName.c_str());
+}
+
 int main(int argc, const char **argv) {
   llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
 
-  // Initialize targets for clang module support.
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmPrinters();
-  llvm::InitializeAllAsmParsers();
+  // Initialize targets for clang module support, once something is compiled.
+  clang::TargetInfo::setLazyTargetRegistration([] {
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmPrinters();
+    llvm::InitializeAllAsmParsers();
+  });
 
   CommonOptionsParser OptionsParser(argc, argv, ClangCheckCategory);
-  ClangTool Tool(OptionsParser.getCompilations(),
-                 OptionsParser.getSourcePathList());
-
-  // Clear adjusters because -fsyntax-only is inserted by the default chain.
-  Tool.clearArgumentsAdjusters();
-  Tool.appendArgumentsAdjuster(getClangStripOutputAdjuster());
-  Tool.appendArgumentsAdjuster(getClangStripDependencyFileAdjuster());
 
   // Running the analyzer requires --analyze. Other modes can work with the
   // -fsyntax-only option.
-  Tool.appendArgumentsAdjuster(getInsertArgumentAdjuster(
-      Analyze ? "--analyze" : "-fsyntax-only", ArgumentInsertPosition::BEGIN));
+  ArgumentsAdjuster ModeAdjuster = getInsertArgumentAdjuster(
+      Analyze ? "--analyze" : "-fsyntax-only", ArgumentInsertPosition::BEGIN);
+  if (Analyze && !AnalyzerOutput.empty())
+    ModeAdjuster = combineAdjusters(
+        ModeAdjuster,
+        getInsertArgumentAdjuster(CommandLineArguments{"--analyzer-output",
+                                                       AnalyzerOutput},
+                                  ArgumentInsertPosition::BEGIN));
 
   ClangCheckActionFactory CheckFactory;
   std::unique_ptr<FrontendActionFactory> FrontendFactory;
 
   // Choose the correct factory based on the selected mode.
   if (Analyze)
-    FrontendFactory = newFrontendActionFactory<clang::ento::AnalysisAction>();
+    FrontendFactory = std::make_unique<ClangCheckAnalysisActionFactory>();
   else if (Fixit)
     FrontendFactory = newFrontendActionFactory<ClangCheckFixItAction>();
   else
     FrontendFactory = newFrontendActionFactory(&CheckFactory);
 
+  // An executor, e.g. all-TUs, runs the tool on many files in parallel. Its
+  // default adjusters strip the output and dependency file options too.
+  if (ExecutorName.getNumOccurrences()) {
+    llvm::Expected<std::unique_ptr<ToolExecutor>> Executor =
+        createExecutor(OptionsParser);
+    if (!Executor) {
+      llvm::errs() << "error: " << llvm::toString(Executor.takeError())
+                   << "\n";
+      return 1;
+    }
+    if (llvm::Error Err =
+            (*Executor)->execute(std::move(FrontendFactory), ModeAdjuster)) {
+      llvm::errs() << llvm::toString(std::move(Err));
+      return 1;
+    }
+    return 0;
+  }
+
+  ClangTool Tool(OptionsParser.getCompilations(),
+                 OptionsParser.getSourcePathList());
+
+  // Clear adjusters because -fsyntax-only is inserted by the default chain.
+  Tool.clearArgumentsAdjusters();
+  Tool.appendArgumentsAdjuster(getClangStripOutputAdjuster());
+  Tool.appendArgumentsAdjuster(getClangStripDependencyFileAdjuster());
+  Tool.appendArgumentsAdjuster(ModeAdjuster);
+
   return Tool.run(FrontendFactory.get());
 }
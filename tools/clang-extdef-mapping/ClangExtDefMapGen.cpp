@@ -13,13 +13,17 @@
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/Analysis/CallGraph.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Execution.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Signals.h"
 #include <sstream>
 #include <string>
@@ -31,28 +35,55 @@ using namespace clang::tooling;
 
 static cl::OptionCategory ClangExtDefMapGenCategory("clang-extdefmapgen options");
 
+static cl::opt<std::string> BinaryIndexFile(
+    "binary-index",
+    cl::desc("Write the definitions of the source files, and of the indexes "
+             "given with -merge-index, to this file in the binary index "
+             "format instead of printing them"),
+    cl::value_desc("filename"), cl::cat(ClangExtDefMapGenCategory));
+
+static cl::list<std::string> MergedIndexFiles(
+    "merge-index",
+    cl::desc("Add the definitions of this textual index to the binary index"),
+    cl::value_desc("filename"), cl::cat(ClangExtDefMapGenCategory));
+
+static cl::opt<std::string> CallGraphFile(
+    "call-graph",
+    cl::desc("Also write the call graphs of the source files, merged and "
+             "keyed by lookup name, to this file as JSON"),
+    cl::value_desc("filename"), cl::cat(ClangExtDefMapGenCategory));
+
+/// The prefix of the keys of the call graphs in the results of the executor.
+static constexpr llvm::StringLiteral CallGraphKeyPrefix = "call-graph:";
+
 class MapExtDefNamesConsumer : public ASTConsumer {
 public:
-  MapExtDefNamesConsumer(ASTContext &Context)
-      : Ctx(Context), SM(Context.getSourceManager()) {}
+  MapExtDefNamesConsumer(ASTContext &Context, ExecutionContext &ExecCtx)
+      : Ctx(Context), SM(Context.getSourceManager()), ExecCtx(ExecCtx) {}
 
   ~MapExtDefNamesConsumer() {
-    // Flush results to standard output.
-    llvm::outs() << createCrossTUIndexString(Index);
+    // Report the index of the translation unit as a whole, so that the
+    // threads of the executor synchronize once per translation unit.
+    if (!Index.empty())
+      ExecCtx.reportResult(CurrentFileName, createCrossTUIndexString(Index));
   }
 
   void HandleTranslationUnit(ASTContext &Context) override {
     handleDecl(Context.getTranslationUnitDecl());
+    if (!CallGraphFile.empty())
+      reportCallGraph(Context.getTranslationUnitDecl());
   }
 
 private:
   void handleDecl(const Decl *D);
+  void reportCallGraph(TranslationUnitDecl *TU);
   void addIfInMain(const DeclaratorDecl *DD, SourceLocation defStart);
 
   ASTContext &Ctx;
   SourceManager &SM;
   llvm::StringMap<std::string> Index;
   std::string CurrentFileName;
+  ExecutionContext &ExecCtx;
 };
 
 void MapExtDefNamesConsumer::handleDecl(const Decl *D) {
@@ -101,14 +132,146 @@ void MapExtDefNamesConsumer::addIfInMain(const DeclaratorDecl *DD,
   }
 }
 
+void MapExtDefNamesConsumer::reportCallGraph(TranslationUnitDecl *TU) {
+  CallGraph CG;
+  CG.addToCallGraph(TU);
+  CallGraph::EdgesByName Edges;
+  CG.getEdgesByName(
+      [](const Decl *D) -> llvm::Optional<std::string> {
+        if (const auto *ND = dyn_cast_or_null<NamedDecl>(D))
+          return CrossTranslationUnitContext::getLookupName(ND);
+        return None;
+      },
+      Edges);
+  if (Edges.empty())
+    return;
+
+  std::string JSON;
+  llvm::raw_string_ostream OS(JSON);
+  CallGraph::writeEdges(Edges, OS);
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  ExecCtx.reportResult(
+      (CallGraphKeyPrefix + (MainFile ? MainFile->tryGetRealPathName() : ""))
+          .str(),
+      OS.str());
+}
+
 class MapExtDefNamesAction : public ASTFrontendAction {
+public:
+  MapExtDefNamesAction(ExecutionContext &ExecCtx) : ExecCtx(ExecCtx) {}
+
 protected:
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  llvm::StringRef) {
-    return std::make_unique<MapExtDefNamesConsumer>(CI.getASTContext());
+    return std::make_unique<MapExtDefNamesConsumer>(CI.getASTContext(),
+                                                    ExecCtx);
   }
+
+private:
+  ExecutionContext &ExecCtx;
+};
+
+class MapExtDefNamesActionFactory : public FrontendActionFactory {
+public:
+  MapExtDefNamesActionFactory(ExecutionContext &ExecCtx) : ExecCtx(ExecCtx) {}
+
+  std::unique_ptr<FrontendAction> create() override {
+    return std::make_unique<MapExtDefNamesAction>(ExecCtx);
+  }
+
+private:
+  ExecutionContext &ExecCtx;
 };
 
+/// Create the executor selected with --executor, e.g. all-TUs to process all
+/// the files of a compilation database in parallel.
+static llvm::Expected<std::unique_ptr<ToolExecutor>>
+createExecutor(CommonOptionsParser &OptionsParser) {
+  for (const auto &Plugin : ToolExecutorPluginRegistry::entries())
+    if (Plugin.getName() == ExecutorName)
+      return Plugin.instantiate()->create(OptionsParser);
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "executor '%s' is not registered",
+                                 ExecutorName.c_str());
+}
+
+/// Merge the indexes of the translation units, in the order of their files
+/// so that the output does not depend on the scheduling of the executor. The
+/// first definition of a lookup name is kept, like in the index parser of the
+/// analyzer.
+static void
+mergeResults(std::vector<std::pair<StringRef, StringRef>> Results,
+             llvm::function_ref<void(StringRef Line, StringRef LookupName,
+                                     StringRef FileName)>
+                 AddEntry) {
+  llvm::sort(Results);
+  llvm::StringSet<> LookupNames;
+  for (const auto &Result : Results) {
+    if (Result.first.startswith(CallGraphKeyPrefix))
+      continue;
+    SmallVector<StringRef, 64> Lines;
+    Result.second.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    for (StringRef Line : Lines) {
+      std::pair<StringRef, StringRef> Entry = Line.split(' ');
+      if (LookupNames.insert(Entry.first).second)
+        AddEntry(Line, Entry.first, Entry.second);
+    }
+  }
+}
+
+/// Write the definitions of the source files and of the merged indexes as a
+/// binary index.
+static bool writeBinaryIndex(llvm::StringMap<std::string> &Index) {
+  for (const std::string &MergedIndexFile : MergedIndexFiles) {
+    llvm::Expected<llvm::StringMap<std::string>> MergedIndex =
+        parseCrossTUIndex(MergedIndexFile, "");
+    if (!MergedIndex) {
+      llvm::errs() << "error: " << MergedIndexFile << ": "
+                   << llvm::toString(MergedIndex.takeError());
+      return false;
+    }
+    for (const auto &E : *MergedIndex)
+      Index.try_emplace(E.getKey(), E.getValue());
+  }
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(BinaryIndexFile, EC, llvm::sys::fs::OF_None);
+  if (EC) {
+    llvm::errs() << "error: " << BinaryIndexFile << ": " << EC.message()
+                 << "\n";
+    return false;
+  }
+  CrossTUBinaryIndex::write(Index, OS);
+  return true;
+}
+
+/// Merge the call graphs of the translation units and write them to the
+/// -call-graph file. The edges are sets, so the output does not depend on the
+/// scheduling of the executor.
+static bool
+writeCallGraph(const std::vector<std::pair<StringRef, StringRef>> &Results) {
+  CallGraph::EdgesByName Edges;
+  for (const auto &Result : Results) {
+    if (!Result.first.startswith(CallGraphKeyPrefix))
+      continue;
+    if (llvm::Error Err = CallGraph::readEdges(Result.second, Edges)) {
+      llvm::errs() << "error: " << Result.first << ": "
+                   << llvm::toString(std::move(Err)) << "\n";
+      return false;
+    }
+  }
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(CallGraphFile, EC, llvm::sys::fs::OF_Text);
+  if (EC) {
+    llvm::errs() << "error: " << CallGraphFile << ": " << EC.message()
+                 << "\n";
+    return false;
+  }
+  CallGraph::writeEdges(Edges, OS);
+  return true;
+}
+
 static cl::extrahelp CommonHelp(CommonOptionsParser::HelpMessage);
 
 int main(int argc, const char **argv) {
@@ -118,12 +281,46 @@ int main(int argc, const char **argv) {
 
   const char *Overview = "\nThis tool collects the USR name and location "
                          "of external definitions in the source files "
-                         "(excluding headers).\n";
+                         "(excluding headers).\n"
+                         "With --executor=all-TUs, the files of the given "
+                         "compilation database are processed in parallel.\n";
   CommonOptionsParser OptionsParser(argc, argv, ClangExtDefMapGenCategory,
                                     cl::ZeroOrMore, Overview);
 
-  ClangTool Tool(OptionsParser.getCompilations(),
-                 OptionsParser.getSourcePathList());
+  llvm::StringMap<std::string> CollectedIndex;
+  const bool WriteBinaryIndex = !BinaryIndexFile.empty();
+  int Result = 0;
+  // The indexes to merge may be the only inputs.
+  if (!OptionsParser.getSourcePathList().empty()) {
+    llvm::Expected<std::unique_ptr<ToolExecutor>> Executor =
+        createExecutor(OptionsParser);
+    if (!Executor) {
+      llvm::errs() << "error: " << llvm::toString(Executor.takeError())
+                   << "\n";
+      return 1;
+    }
+    if (llvm::Error Err = (*Executor)->execute(
+            std::make_unique<MapExtDefNamesActionFactory>(
+                *(*Executor)->getExecutionContext()))) {
+      // The definitions of the other files are still written.
+      llvm::errs() << llvm::toString(std::move(Err));
+      Result = 1;
+    }
+
+    std::vector<std::pair<StringRef, StringRef>> Results =
+        (*Executor)->getToolResults()->AllKVResults();
+    if (!CallGraphFile.empty() && !writeCallGraph(Results))
+      Result = 1;
+    mergeResults(std::move(Results),
+                 [&](StringRef Line, StringRef LookupName, StringRef FileName) {
+                   if (WriteBinaryIndex)
+                     CollectedIndex.try_emplace(LookupName, FileName);
+                   else
+                     llvm::outs() << Line << '\n';
+                 });
+  }
 
-  return Tool.run(newFrontendActionFactory<MapExtDefNamesAction>().get());
+  if (WriteBinaryIndex && !writeBinaryIndex(CollectedIndex))
+    return 1;
+  return Result;
 }
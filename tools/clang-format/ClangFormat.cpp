@@ -24,6 +24,11 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <cstdio>
 
 using namespace llvm;
 using clang::tooling::Replacements;
@@ -157,6 +162,37 @@ static cl::opt<bool>
                           "whether or not to print diagnostics in color"),
                  cl::init(false), cl::cat(ClangFormatCategory), cl::Hidden);
 
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("The number of files to format in parallel.\n"
+                        "0 uses one thread per core. The output and the\n"
+                        "errors are printed in the order of the files."),
+               cl::init(1), cl::cat(ClangFormatCategory));
+
+static cl::opt<bool>
+    Server("server",
+           cl::desc("Keep running and format the buffers of the requests\n"
+                    "read from stdin. A request is a line\n"
+                    "\"<size> <n> [<offset> <length>]... <file name>\"\n"
+                    "with <n> ranges, followed by the <size> bytes of the\n"
+                    "buffer. Each response is a line \"<size>\" followed\n"
+                    "by the <size> bytes of the replacements as XML."),
+           cl::cat(ClangFormatCategory));
+
+static cl::opt<bool> FromDiff(
+    "from-diff",
+    cl::desc("Read a unified diff from stdin, format the changed lines of\n"
+             "the C, C++, Objective-C, Java, JavaScript, Proto and C# files\n"
+             "it names, and write the changes as a patch which applies\n"
+             "with -p1. Can be used with -j."),
+    cl::cat(ClangFormatCategory));
+
+static cl::opt<unsigned>
+    DiffStrip("diff-strip",
+              cl::desc("The number of leading path components to strip from\n"
+                       "the file names of the diff read with -from-diff."),
+              cl::init(1), cl::cat(ClangFormatCategory));
+
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
 
@@ -219,25 +255,27 @@ static bool fillRanges(MemoryBuffer *Code,
     return false;
   }
 
-  if (Offsets.empty())
-    Offsets.push_back(0);
-  if (Offsets.size() != Lengths.size() &&
-      !(Offsets.size() == 1 && Lengths.empty())) {
+  // Files may be formatted concurrently, so the options are not modified.
+  std::vector<unsigned> Starts(Offsets.begin(), Offsets.end());
+  if (Starts.empty())
+    Starts.push_back(0);
+  if (Starts.size() != Lengths.size() &&
+      !(Starts.size() == 1 && Lengths.empty())) {
     errs() << "error: number of -offset and -length arguments must match.\n";
     return true;
   }
-  for (unsigned i = 0, e = Offsets.size(); i != e; ++i) {
-    if (Offsets[i] >= Code->getBufferSize()) {
-      errs() << "error: offset " << Offsets[i] << " is outside the file\n";
+  for (unsigned i = 0, e = Starts.size(); i != e; ++i) {
+    if (Starts[i] >= Code->getBufferSize()) {
+      errs() << "error: offset " << Starts[i] << " is outside the file\n";
       return true;
     }
     SourceLocation Start =
-        Sources.getLocForStartOfFile(ID).getLocWithOffset(Offsets[i]);
+        Sources.getLocForStartOfFile(ID).getLocWithOffset(Starts[i]);
     SourceLocation End;
     if (i < Lengths.size()) {
-      if (Offsets[i] + Lengths[i] > Code->getBufferSize()) {
+      if (Starts[i] + Lengths[i] > Code->getBufferSize()) {
         errs() << "error: invalid length " << Lengths[i]
-               << ", offset + length (" << Offsets[i] + Lengths[i]
+               << ", offset + length (" << Starts[i] + Lengths[i]
                << ") is outside the file.\n";
         return true;
       }
@@ -252,41 +290,42 @@ static bool fillRanges(MemoryBuffer *Code,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(StringRef Text, raw_ostream &OS) {
   // FIXME: When we sort includes, we need to make sure the stream is correct
   // utf-8.
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r<&", From)) != StringRef::npos) {
-    outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      outs() << "&#13;";
+      OS << "&#13;";
       break;
     case '<':
-      outs() << "&lt;";
+      OS << "&lt;";
       break;
     case '&':
-      outs() << "&amp;";
+      OS << "&amp;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
-static void outputReplacementsXML(const Replacements &Replaces) {
+static void outputReplacementsXML(const Replacements &Replaces,
+                                  raw_ostream &OS) {
   for (const auto &R : Replaces) {
-    outs() << "<replacement "
-           << "offset='" << R.getOffset() << "' "
-           << "length='" << R.getLength() << "'>";
-    outputReplacementXML(R.getReplacementText());
-    outs() << "</replacement>\n";
+    OS << "<replacement "
+       << "offset='" << R.getOffset() << "' "
+       << "length='" << R.getLength() << "'>";
+    outputReplacementXML(R.getReplacementText(), OS);
+    OS << "</replacement>\n";
   }
 }
 
@@ -317,7 +356,8 @@ static const char *getInValidBOM(StringRef BufStr) {
 
 static bool
 emitReplacementWarnings(const Replacements &Replaces, StringRef AssumedFileName,
-                        const std::unique_ptr<llvm::MemoryBuffer> &Code) {
+                        const std::unique_ptr<llvm::MemoryBuffer> &Code,
+                        raw_ostream &ErrOS) {
   if (Replaces.empty()) {
     return false;
   }
@@ -326,7 +366,7 @@ emitReplacementWarnings(const Replacements &Replaces, StringRef AssumedFileName,
   DiagOpts->ShowColors = (ShowColors && !NoShowColors);
 
   TextDiagnosticPrinter *DiagsBuffer =
-      new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts, false);
+      new TextDiagnosticPrinter(ErrOS, &*DiagOpts, false);
 
   IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
   IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
@@ -364,25 +404,61 @@ static void outputXML(const Replacements &Replaces,
                       const Replacements &FormatChanges,
                       const FormattingAttemptStatus &Status,
                       const cl::opt<unsigned> &Cursor,
-                      unsigned CursorPosition) {
-  outs() << "<?xml version='1.0'?>\n<replacements "
-            "xml:space='preserve' incomplete_format='"
-         << (Status.FormatComplete ? "false" : "true") << "'";
+                      unsigned CursorPosition, raw_ostream &OS) {
+  OS << "<?xml version='1.0'?>\n<replacements "
+        "xml:space='preserve' incomplete_format='"
+     << (Status.FormatComplete ? "false" : "true") << "'";
   if (!Status.FormatComplete)
-    outs() << " line='" << Status.Line << "'";
-  outs() << ">\n";
+    OS << " line='" << Status.Line << "'";
+  OS << ">\n";
   if (Cursor.getNumOccurrences() != 0)
-    outs() << "<cursor>" << FormatChanges.getShiftedCodePosition(CursorPosition)
-           << "</cursor>\n";
+    OS << "<cursor>" << FormatChanges.getShiftedCodePosition(CursorPosition)
+       << "</cursor>\n";
 
-  outputReplacementsXML(Replaces);
-  outs() << "</replacements>\n";
+  outputReplacementsXML(Replaces, OS);
+  OS << "</replacements>\n";
 }
 
-// Returns true on error.
-static bool format(StringRef FileName) {
+// Sorts the includes of Code and formats its Ranges. Replaces is set to all
+// the changes, and FormatChanges to those of the formatting. Returns true on
+// error.
+static bool formatCode(StringRef Code, ArrayRef<tooling::Range> CodeRanges,
+                       StringRef AssumedFileName, FormatStyleCache &StyleCache,
+                       unsigned &CursorPosition, Replacements &Replaces,
+                       Replacements &FormatChanges,
+                       FormattingAttemptStatus &Status, raw_ostream &ErrOS) {
+  llvm::Expected<FormatStyle> FormatStyle =
+      getStyle(Style, AssumedFileName, FallbackStyle, Code,
+               /*FS=*/nullptr, &StyleCache);
+  if (!FormatStyle) {
+    ErrOS << llvm::toString(FormatStyle.takeError()) << "\n";
+    return true;
+  }
+
+  if (SortIncludes.getNumOccurrences() != 0)
+    FormatStyle->SortIncludes = SortIncludes;
+  Replaces = sortIncludes(*FormatStyle, Code, CodeRanges, AssumedFileName,
+                          &CursorPosition);
+  auto ChangedCode = tooling::applyAllReplacements(Code, Replaces);
+  if (!ChangedCode) {
+    ErrOS << llvm::toString(ChangedCode.takeError()) << "\n";
+    return true;
+  }
+  // Get new affected ranges after sorting `#includes`.
+  std::vector<tooling::Range> Ranges =
+      tooling::calculateRangesAfterReplacements(Replaces, CodeRanges);
+  FormatChanges =
+      reformat(*FormatStyle, *ChangedCode, Ranges, AssumedFileName, &Status);
+  Replaces = Replaces.merge(FormatChanges);
+  return false;
+}
+
+// Returns true on error. The output and the errors are written to OS and
+// ErrOS, so that several files can be formatted at once.
+static bool format(StringRef FileName, FormatStyleCache &StyleCache,
+                   raw_ostream &OS, raw_ostream &ErrOS) {
   if (!OutputXML && Inplace && FileName == "-") {
-    errs() << "error: cannot use -i when reading from stdin.\n";
+    ErrOS << "error: cannot use -i when reading from stdin.\n";
     return false;
   }
   // On Windows, overwriting a file with an open file mapping doesn't work,
@@ -391,7 +467,7 @@ static bool format(StringRef FileName) {
       !OutputXML && Inplace ? MemoryBuffer::getFileAsStream(FileName)
                             : MemoryBuffer::getFileOrSTDIN(FileName);
   if (std::error_code EC = CodeOrErr.getError()) {
-    errs() << EC.message() << "\n";
+    ErrOS << EC.message() << "\n";
     return true;
   }
   std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
@@ -403,11 +479,11 @@ static bool format(StringRef FileName) {
   const char *InvalidBOM = getInValidBOM(BufStr);
 
   if (InvalidBOM) {
-    errs() << "error: encoding with unsupported byte order mark \""
-           << InvalidBOM << "\" detected";
+    ErrOS << "error: encoding with unsupported byte order mark \""
+          << InvalidBOM << "\" detected";
     if (FileName != "-")
-      errs() << " in file '" << FileName << "'";
-    errs() << ".\n";
+      ErrOS << " in file '" << FileName << "'";
+    ErrOS << ".\n";
     return true;
   }
 
@@ -416,34 +492,17 @@ static bool format(StringRef FileName) {
     return true;
   StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
 
-  llvm::Expected<FormatStyle> FormatStyle =
-      getStyle(Style, AssumedFileName, FallbackStyle, Code->getBuffer());
-  if (!FormatStyle) {
-    llvm::errs() << llvm::toString(FormatStyle.takeError()) << "\n";
-    return true;
-  }
-
-  if (SortIncludes.getNumOccurrences() != 0)
-    FormatStyle->SortIncludes = SortIncludes;
   unsigned CursorPosition = Cursor;
-  Replacements Replaces = sortIncludes(*FormatStyle, Code->getBuffer(), Ranges,
-                                       AssumedFileName, &CursorPosition);
-  auto ChangedCode = tooling::applyAllReplacements(Code->getBuffer(), Replaces);
-  if (!ChangedCode) {
-    llvm::errs() << llvm::toString(ChangedCode.takeError()) << "\n";
-    return true;
-  }
-  // Get new affected ranges after sorting `#includes`.
-  Ranges = tooling::calculateRangesAfterReplacements(Replaces, Ranges);
+  Replacements Replaces, FormatChanges;
   FormattingAttemptStatus Status;
-  Replacements FormatChanges =
-      reformat(*FormatStyle, *ChangedCode, Ranges, AssumedFileName, &Status);
-  Replaces = Replaces.merge(FormatChanges);
+  if (formatCode(Code->getBuffer(), Ranges, AssumedFileName, StyleCache,
+                 CursorPosition, Replaces, FormatChanges, Status, ErrOS))
+    return true;
   if (OutputXML || DryRun) {
     if (DryRun) {
-      return emitReplacementWarnings(Replaces, AssumedFileName, Code);
+      return emitReplacementWarnings(Replaces, AssumedFileName, Code, ErrOS);
     } else {
-      outputXML(Replaces, FormatChanges, Status, Cursor, CursorPosition);
+      outputXML(Replaces, FormatChanges, Status, Cursor, CursorPosition, OS);
     }
   } else {
     IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFileSystem(
@@ -462,17 +521,369 @@ static bool format(StringRef FileName) {
         return true;
     } else {
       if (Cursor.getNumOccurrences() != 0) {
-        outs() << "{ \"Cursor\": "
-               << FormatChanges.getShiftedCodePosition(CursorPosition)
-               << ", \"IncompleteFormat\": "
-               << (Status.FormatComplete ? "false" : "true");
+        OS << "{ \"Cursor\": "
+           << FormatChanges.getShiftedCodePosition(CursorPosition)
+           << ", \"IncompleteFormat\": "
+           << (Status.FormatComplete ? "false" : "true");
         if (!Status.FormatComplete)
-          outs() << ", \"Line\": " << Status.Line;
-        outs() << " }\n";
+          OS << ", \"Line\": " << Status.Line;
+        OS << " }\n";
       }
-      Rewrite.getEditBuffer(ID).write(outs());
+      Rewrite.getEditBuffer(ID).write(OS);
+    }
+  }
+  return false;
+}
+
+// Reads a line of Input into Line, without the line break. Returns false at
+// the end of the input.
+static bool readLine(std::FILE *Input, std::string &Line) {
+  Line.clear();
+  int C;
+  while ((C = std::getc(Input)) != EOF && C != '\n')
+    Line.push_back(C);
+  if (!Line.empty() && Line.back() == '\r')
+    Line.pop_back();
+  return C != EOF || !Line.empty();
+}
+
+// Parses the header line of a -server request. Returns false on error.
+static bool parseRequestHeader(StringRef Header, size_t &Size,
+                               std::vector<tooling::Range> &Ranges,
+                               StringRef &FileName) {
+  std::pair<StringRef, StringRef> Field(StringRef(), Header);
+  auto ParseNext = [&Field](auto &Value) {
+    Field = Field.second.split(' ');
+    return !Field.first.getAsInteger(10, Value);
+  };
+  unsigned NumRanges;
+  if (!ParseNext(Size) || !ParseNext(NumRanges))
+    return false;
+  for (unsigned I = 0; I != NumRanges; ++I) {
+    unsigned Offset, Length;
+    if (!ParseNext(Offset) || !ParseNext(Length))
+      return false;
+    Ranges.push_back(tooling::Range(Offset, Length));
+  }
+  FileName = Field.second;
+  return !FileName.empty();
+}
+
+static void writeResponse(StringRef XML) {
+  outs() << XML.size() << '\n' << XML;
+  outs().flush();
+}
+
+static void writeErrorResponse(StringRef Message) {
+  std::string XML;
+  raw_string_ostream OS(XML);
+  OS << "<?xml version='1.0'?>\n<error>";
+  outputReplacementXML(Message.rtrim(), OS);
+  OS << "</error>\n";
+  writeResponse(OS.str());
+}
+
+// Formats the Code of a -server request, and writes the replacements to OS.
+// Returns true on error.
+static bool formatRequest(StringRef Code, std::vector<tooling::Range> Ranges,
+                          StringRef FileName, FormatStyleCache &StyleCache,
+                          raw_ostream &OS, raw_ostream &ErrOS) {
+  if (const char *InvalidBOM = getInValidBOM(Code)) {
+    ErrOS << "error: encoding with unsupported byte order mark \""
+          << InvalidBOM << "\" detected.\n";
+    return true;
+  }
+  for (const tooling::Range &R : Ranges) {
+    if (R.getOffset() > Code.size() ||
+        R.getLength() > Code.size() - R.getOffset()) {
+      ErrOS << "error: range " << R.getOffset() << ":" << R.getLength()
+            << " is outside the buffer.\n";
+      return true;
     }
   }
+  if (Ranges.empty())
+    Ranges.push_back(tooling::Range(0, Code.size()));
+
+  unsigned CursorPosition = 0;
+  Replacements Replaces, FormatChanges;
+  FormattingAttemptStatus Status;
+  if (formatCode(Code, Ranges, FileName, StyleCache, CursorPosition, Replaces,
+                 FormatChanges, Status, ErrOS))
+    return true;
+  outputXML(Replaces, FormatChanges, Status, Cursor, CursorPosition, OS);
+  return false;
+}
+
+// Serves the -server requests until the end of stdin. The styles are kept in
+// StyleCache across the requests. Returns true if a request cannot be read.
+static bool serve(FormatStyleCache &StyleCache) {
+  llvm::sys::ChangeStdinToBinary();
+  llvm::sys::ChangeStdoutToBinary();
+  std::string Header;
+  while (readLine(stdin, Header)) {
+    size_t Size;
+    std::vector<tooling::Range> Ranges;
+    StringRef FileName;
+    if (!parseRequestHeader(Header, Size, Ranges, FileName)) {
+      writeErrorResponse("error: invalid request \"" + Header + "\"");
+      return true;
+    }
+    std::string Code(Size, '\0');
+    if (std::fread(&Code[0], 1, Size, stdin) != Size) {
+      writeErrorResponse("error: unexpected end of the buffer of '" +
+                         FileName.str() + "'");
+      return true;
+    }
+
+    std::string XML, Errors;
+    raw_string_ostream OS(XML), ErrOS(Errors);
+    if (formatRequest(Code, std::move(Ranges), FileName, StyleCache, OS,
+                      ErrOS))
+      writeErrorResponse(ErrOS.str());
+    else
+      writeResponse(OS.str());
+  }
+  return false;
+}
+
+// The changed lines of a file of a unified diff.
+struct DiffFile {
+  std::string Name;
+  // The first and the last line of each change, 1-based.
+  std::vector<std::pair<unsigned, unsigned>> LineRanges;
+};
+
+// Splits Text into its lines, each with its line break.
+static void splitLines(StringRef Text, SmallVectorImpl<StringRef> &Lines) {
+  while (!Text.empty()) {
+    size_t End = Text.find('\n');
+    End = End == StringRef::npos ? Text.size() : End + 1;
+    Lines.push_back(Text.take_front(End));
+    Text = Text.drop_front(End);
+  }
+}
+
+// Parses the changed lines of the files of Diff for -from-diff, in the order
+// of the files. The files which are not in a language clang-format supports
+// are skipped, as are the deleted ones.
+static std::vector<DiffFile> parseDiff(StringRef Diff) {
+  llvm::Regex Supported(
+      "\\.(cpp|cc|c\\+\\+|cxx|c|cl|h|hh|hpp|m|mm|inc|js|ts|proto|protodevel|"
+      "java|cs)$",
+      llvm::Regex::IgnoreCase);
+  std::vector<DiffFile> Files;
+  llvm::StringMap<size_t> FileIndices;
+  DiffFile *File = nullptr;
+  // The lines left in the current hunk, which are never headers.
+  unsigned OldLeft = 0, NewLeft = 0;
+  SmallVector<StringRef, 0> Lines;
+  splitLines(Diff, Lines);
+  for (StringRef Line : Lines) {
+    Line = Line.rtrim("\r\n");
+    if (OldLeft || NewLeft) {
+      if (Line.startswith(" ") || Line.empty()) {
+        OldLeft -= OldLeft != 0;
+        NewLeft -= NewLeft != 0;
+      } else if (Line.startswith("-")) {
+        OldLeft -= OldLeft != 0;
+      } else if (Line.startswith("+")) {
+        NewLeft -= NewLeft != 0;
+      }
+      continue;
+    }
+    if (Line.consume_front("+++ ")) {
+      StringRef Path = Line.take_until([](char C) { return C == '\t'; });
+      Path = Path.rtrim();
+      File = nullptr;
+      if (Path == "/dev/null")
+        continue;
+      for (unsigned I = 0; I != DiffStrip && !Path.empty(); ++I)
+        Path = Path.split('/').second;
+      if (Path.empty() || !Supported.match(Path))
+        continue;
+      auto Inserted = FileIndices.try_emplace(Path, Files.size());
+      if (Inserted.second)
+        Files.push_back({Path.str(), {}});
+      File = &Files[Inserted.first->second];
+      continue;
+    }
+    // @@ -<old start>[,<old count>] +<new start>[,<new count>] @@
+    if (!Line.consume_front("@@ -"))
+      continue;
+    auto ParseRange = [&Line](unsigned &Start, unsigned &Count) {
+      Count = 1;
+      StringRef Range = Line.take_until([](char C) { return C == ' '; });
+      Line = Line.drop_front(Range.size()).ltrim();
+      std::pair<StringRef, StringRef> Fields = Range.split(',');
+      return !Fields.first.getAsInteger(10, Start) &&
+             (Fields.second.empty() || !Fields.second.getAsInteger(10, Count));
+    };
+    unsigned OldStart, NewStart;
+    if (!ParseRange(OldStart, OldLeft) || !Line.consume_front("+") ||
+        !ParseRange(NewStart, NewLeft)) {
+      OldLeft = NewLeft = 0;
+      continue;
+    }
+    if (File && NewLeft != 0)
+      File->LineRanges.push_back({NewStart, NewStart + NewLeft - 1});
+  }
+  return Files;
+}
+
+// Writes a line of a hunk, with the marker of a missing line break at the end
+// of the file.
+static void writePatchLine(char Kind, StringRef Line, raw_ostream &OS) {
+  OS << Kind << Line;
+  if (!Line.endswith("\n"))
+    OS << "\n\\ No newline at end of file\n";
+}
+
+// Writes the changes of Replaces to Code as a unified diff of FileName, with
+// three lines of context.
+static void writePatch(StringRef FileName, StringRef Code,
+                       const Replacements &Replaces, raw_ostream &OS) {
+  const unsigned Context = 3;
+  SmallVector<StringRef, 0> OldLines;
+  splitLines(Code, OldLines);
+  if (OldLines.empty())
+    return;
+  auto LineOf = [&](unsigned Offset) -> unsigned {
+    auto I = llvm::upper_bound(OldLines, Offset, [&](unsigned O, StringRef L) {
+      return O < unsigned(L.data() - Code.data());
+    });
+    return I - OldLines.begin() - 1;
+  };
+
+  // The replacements which touch the same lines are grouped into a change of
+  // these lines.
+  struct Change {
+    unsigned FirstLine, LastLine;
+    std::string NewText;
+  };
+  std::vector<Change> Changes;
+  std::vector<const tooling::Replacement *> Group;
+  auto FinishGroup = [&] {
+    Change &C = Changes.back();
+    size_t Begin = OldLines[C.FirstLine].data() - Code.data();
+    size_t End = OldLines[C.LastLine].end() - Code.data();
+    size_t Pos = Begin;
+    for (const tooling::Replacement *R : Group) {
+      C.NewText += Code.slice(Pos, R->getOffset());
+      C.NewText += R->getReplacementText();
+      Pos = R->getOffset() + R->getLength();
+    }
+    C.NewText += Code.slice(Pos, End);
+    if (C.NewText == Code.slice(Begin, End))
+      Changes.pop_back();
+    Group.clear();
+  };
+  for (const tooling::Replacement &R : Replaces) {
+    unsigned First = LineOf(R.getOffset());
+    unsigned Last = R.getLength()
+                        ? LineOf(R.getOffset() + R.getLength() - 1)
+                        : First;
+    if (!Group.empty() && First <= Changes.back().LastLine) {
+      Changes.back().LastLine = std::max(Changes.back().LastLine, Last);
+    } else {
+      if (!Group.empty())
+        FinishGroup();
+      Changes.push_back({First, Last, std::string()});
+    }
+    Group.push_back(&R);
+  }
+  if (!Group.empty())
+    FinishGroup();
+  if (Changes.empty())
+    return;
+
+  OS << "--- a/" << FileName << "\n+++ b/" << FileName << "\n";
+  auto WriteRange = [&OS](unsigned Begin, unsigned Count) {
+    OS << (Count ? Begin + 1 : Begin) << "," << Count;
+  };
+  // The number of lines the previous hunks add.
+  int Delta = 0;
+  for (size_t I = 0, E = Changes.size(); I != E;) {
+    // The changes which are close enough share a hunk.
+    size_t J = I + 1;
+    while (J != E &&
+           Changes[J].FirstLine - Changes[J - 1].LastLine - 1 <= 2 * Context)
+      ++J;
+    unsigned OldBegin =
+        Changes[I].FirstLine > Context ? Changes[I].FirstLine - Context : 0;
+    unsigned OldEnd = std::min<unsigned>(Changes[J - 1].LastLine + 1 + Context,
+                                         OldLines.size());
+    std::string Hunk;
+    raw_string_ostream HunkOS(Hunk);
+    unsigned NewCount = 0;
+    unsigned Line = OldBegin;
+    for (size_t K = I; K != J; ++K) {
+      for (; Line < Changes[K].FirstLine; ++Line, ++NewCount)
+        writePatchLine(' ', OldLines[Line], HunkOS);
+      for (; Line <= Changes[K].LastLine; ++Line)
+        writePatchLine('-', OldLines[Line], HunkOS);
+      SmallVector<StringRef, 8> NewLines;
+      splitLines(Changes[K].NewText, NewLines);
+      for (StringRef NewLine : NewLines)
+        writePatchLine('+', NewLine, HunkOS);
+      NewCount += NewLines.size();
+    }
+    for (; Line < OldEnd; ++Line, ++NewCount)
+      writePatchLine(' ', OldLines[Line], HunkOS);
+
+    unsigned OldCount = OldEnd - OldBegin;
+    OS << "@@ -";
+    WriteRange(OldBegin, OldCount);
+    OS << " +";
+    WriteRange(unsigned(int(OldBegin) + Delta), NewCount);
+    OS << " @@\n" << HunkOS.str();
+    Delta += int(NewCount) - int(OldCount);
+    I = J;
+  }
+}
+
+// Formats the changed lines of File for -from-diff, and writes the changes as
+// a patch to OS. Returns true on error.
+static bool formatDiffFile(const DiffFile &File, FormatStyleCache &StyleCache,
+                           raw_ostream &OS, raw_ostream &ErrOS) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
+      MemoryBuffer::getFile(File.Name);
+  if (std::error_code EC = CodeOrErr.getError()) {
+    ErrOS << File.Name << ": " << EC.message() << "\n";
+    return true;
+  }
+  StringRef Code = (*CodeOrErr)->getBuffer();
+  if (Code.empty())
+    return false;
+  if (const char *InvalidBOM = getInValidBOM(Code)) {
+    ErrOS << "error: encoding with unsupported byte order mark \""
+          << InvalidBOM << "\" detected in file '" << File.Name << "'.\n";
+    return true;
+  }
+
+  SmallVector<StringRef, 0> Lines;
+  splitLines(Code, Lines);
+  std::vector<tooling::Range> Ranges;
+  for (const auto &LineRange : File.LineRanges) {
+    // A diff which is not of the current files may name lines past the end.
+    if (LineRange.first == 0 || LineRange.first > Lines.size())
+      continue;
+    unsigned Offset = Lines[LineRange.first - 1].data() - Code.data();
+    unsigned End = Lines[std::min<size_t>(LineRange.second, Lines.size()) - 1]
+                       .rtrim("\r\n")
+                       .end() -
+                   Code.data();
+    Ranges.push_back(tooling::Range(Offset, End - Offset));
+  }
+  if (Ranges.empty())
+    return false;
+
+  unsigned CursorPosition = 0;
+  Replacements Replaces, FormatChanges;
+  FormattingAttemptStatus Status;
+  if (formatCode(Code, Ranges, File.Name, StyleCache, CursorPosition, Replaces,
+                 FormatChanges, Status, ErrOS))
+    return true;
+  writePatch(File.Name, Code, Replaces, OS);
   return false;
 }
 
@@ -515,6 +926,61 @@ static int dumpConfig() {
   return 0;
 }
 
+// The options of the formatting of files, which the -server and -from-diff
+// modes do not support.
+static const char FileOptions[] = "<file>s, -i, -output-replacements-xml, "
+                                  "-dry-run, -cursor, -offset, -length or "
+                                  "-lines";
+
+static bool hasFileOptions() {
+  return !FileNames.empty() || Inplace || OutputXML || DryRun ||
+         Cursor.getNumOccurrences() != 0 || !Offsets.empty() ||
+         !Lengths.empty() || !LineRanges.empty();
+}
+
+// Runs Format on each of the inputs, with up to Threads threads, and prints
+// their output and errors in the order of the inputs. Returns true on error.
+static bool
+formatAll(ArrayRef<std::string> Names, unsigned Threads,
+          function_ref<bool(size_t, raw_ostream &, raw_ostream &)> Format) {
+  bool Error = false;
+  if (Threads <= 1 || Names.size() == 1) {
+    for (size_t I = 0, E = Names.size(); I != E; ++I) {
+      if (Verbose)
+        errs() << "Formatting " << Names[I] << "\n";
+      Error |= Format(I, outs(), errs());
+    }
+    return Error;
+  }
+
+  // Format the inputs concurrently, and print the output of each once it is
+  // formatted, in the order of the inputs.
+  struct Result {
+    std::string Output;
+    std::string Errors;
+    bool Error = false;
+  };
+  std::vector<Result> Results(Names.size());
+  std::vector<std::shared_future<void>> Done;
+  llvm::ThreadPool Pool(std::min<size_t>(Threads, Names.size()));
+  for (size_t I = 0, E = Names.size(); I != E; ++I)
+    Done.push_back(Pool.async([&Format, &Results, I] {
+      Result &R = Results[I];
+      raw_string_ostream OS(R.Output);
+      raw_string_ostream ErrOS(R.Errors);
+      R.Error = Format(I, OS, ErrOS);
+    }));
+  for (size_t I = 0, E = Names.size(); I != E; ++I) {
+    if (Verbose)
+      errs() << "Formatting " << Names[I] << "\n";
+    Done[I].wait();
+    outs() << Results[I].Output;
+    errs() << Results[I].Errors;
+    Error |= Results[I].Error;
+  }
+  return Error;
+}
+
 int main(int argc, const char **argv) {
   llvm::InitLLVM X(argc, argv);
 
@@ -539,9 +1005,43 @@ int main(int argc, const char **argv) {
     return dumpConfig();
   }
 
+  // The configuration files are parsed once for all the files.
+  clang::format::FormatStyleCache StyleCache;
+  if (Server) {
+    if (hasFileOptions()) {
+      errs() << "error: -server cannot be used with " << FileOptions
+             << ".\n";
+      return 1;
+    }
+    return clang::format::serve(StyleCache) ? 1 : 0;
+  }
+  unsigned Threads = NumThreads ? NumThreads : llvm::hardware_concurrency();
+  if (FromDiff) {
+    if (hasFileOptions()) {
+      errs() << "error: -from-diff cannot be used with " << FileOptions
+             << ".\n";
+      return 1;
+    }
+    ErrorOr<std::unique_ptr<MemoryBuffer>> DiffOrErr = MemoryBuffer::getSTDIN();
+    if (std::error_code EC = DiffOrErr.getError()) {
+      errs() << EC.message() << "\n";
+      return 1;
+    }
+    std::vector<clang::format::DiffFile> Files =
+        clang::format::parseDiff((*DiffOrErr)->getBuffer());
+    std::vector<std::string> Names;
+    for (const auto &File : Files)
+      Names.push_back(File.Name);
+    bool Error = formatAll(
+        Names, Threads, [&](size_t I, raw_ostream &OS, raw_ostream &ErrOS) {
+          return clang::format::formatDiffFile(Files[I], StyleCache, OS,
+                                               ErrOS);
+        });
+    return Error ? 1 : 0;
+  }
   bool Error = false;
   if (FileNames.empty()) {
-    Error = clang::format::format("-");
+    Error = clang::format::format("-", StyleCache, outs(), errs());
     return Error ? 1 : 0;
   }
   if (FileNames.size() != 1 &&
@@ -550,10 +1050,10 @@ int main(int argc, const char **argv) {
               "single file.\n";
     return 1;
   }
-  for (const auto &FileName : FileNames) {
-    if (Verbose)
-      errs() << "Formatting " << FileName << "\n";
-    Error |= clang::format::format(FileName);
-  }
+  Error = formatAll(FileNames, Threads,
+                    [&](size_t I, raw_ostream &OS, raw_ostream &ErrOS) {
+                      return clang::format::format(FileNames[I], StyleCache,
+                                                   OS, ErrOS);
+                    });
   return Error ? 1 : 0;
 }
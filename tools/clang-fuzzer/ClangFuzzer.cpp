@@ -13,13 +13,35 @@
 //===----------------------------------------------------------------------===//
 
 #include "handle-cxx/handle_cxx.h"
+#include <cstring>
 
 using namespace clang_fuzzer;
 
-extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv) { return 0; }
+static std::vector<const char *> CLArgs = {"-O2"};
+static std::string PCHHeader;
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv) {
+  // The arguments after -ignore_remaining_args=1 are passed to clang, except
+  // for -pch-header=<header>, which precompiles <header> once and includes
+  // it before every input.
+  for (int I = 1; I < *argc; I++) {
+    if (strcmp((*argv)[I], "-ignore_remaining_args=1") == 0) {
+      for (I++; I < *argc; I++) {
+        if (strncmp((*argv)[I], "-pch-header=", 12) == 0)
+          PCHHeader = (*argv)[I] + 12;
+        else
+          CLArgs.push_back((*argv)[I]);
+      }
+      break;
+    }
+  }
+  return 0;
+}
 
 extern "C" int LLVMFuzzerTestOneInput(uint8_t *data, size_t size) {
+  // The handler is created on the first input, and reused for the others.
+  static CXXHandler Handler("./test.cc", CLArgs, PCHHeader);
   std::string s((const char *)data, size);
-  HandleCXX(s, "./test.cc", {"-O2"});
+  Handler.handle(s);
   return 0;
 }
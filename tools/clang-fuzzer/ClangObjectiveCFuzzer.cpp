@@ -17,8 +17,9 @@
 using namespace clang_fuzzer;
 
 extern "C" int LLVMFuzzerTestOneInput(uint8_t *data, size_t size) {
+  static CXXHandler Handler("./test.m", {"-O2"});
   std::string s(reinterpret_cast<const char *>(data), size);
-  HandleCXX(s, "./test.m", {"-O2"});
+  Handler.handle(s);
   return 0;
 }
 
@@ -6,7 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// Implements HandleCXX for use by the Clang fuzzers.
+// Implements HandleCXX and CXXHandler for use by the Clang fuzzers.
 //
 //===----------------------------------------------------------------------===//
 
@@ -14,9 +14,12 @@
 
 #include "clang/CodeGen/CodeGenAction.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Option/Option.h"
+#include "llvm/Support/FileSystem.h"
 
 using namespace clang;
 
@@ -50,3 +53,64 @@ void clang_fuzzer::HandleCXX(const std::string &S,
                         &Diags);
 }
 
+
+clang_fuzzer::CXXHandler::CXXHandler(const char *FileName,
+                                     const std::vector<const char *> &ExtraArgs,
+                                     const std::string &PCHHeader)
+    : FileName(FileName), Diags(new IgnoringDiagConsumer()),
+      DiagOpts(new DiagnosticOptions()),
+      Diagnostics(new DiagnosticsEngine(
+          IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs()), &*DiagOpts,
+          Diags.get(), false)),
+      Files(new FileManager(FileSystemOptions())),
+      PCHContainerOps(std::make_shared<PCHContainerOperations>()) {
+  llvm::opt::ArgStringList CC1Args;
+  CC1Args.push_back("-cc1");
+  for (auto &A : ExtraArgs)
+    CC1Args.push_back(A);
+  CC1Args.push_back(FileName);
+  Invocation.reset(tooling::newInvocation(Diagnostics.get(), CC1Args));
+  if (!Invocation || PCHHeader.empty())
+    return;
+
+  // Precompile the header as the inputs are compiled, e.g. for the same
+  // language and target.
+  SmallString<128> Path;
+  if (llvm::sys::fs::createTemporaryFile("handle-cxx", "pch", Path))
+    return;
+  auto PCHInvocation = std::make_shared<CompilerInvocation>(*Invocation);
+  FrontendOptions &FrontendOpts = PCHInvocation->getFrontendOpts();
+  FrontendOpts.Inputs = {FrontendInputFile(
+      PCHHeader, FrontendOpts.Inputs[0].getKind().getHeader())};
+  FrontendOpts.OutputFile = std::string(Path.str());
+  FrontendOpts.ProgramAction = frontend::GeneratePCH;
+  std::unique_ptr<tooling::ToolAction> Action(
+      tooling::newFrontendActionFactory<GeneratePCHAction>());
+  if (!Action->runInvocation(std::move(PCHInvocation), Files.get(),
+                             PCHContainerOps, Diags.get())) {
+    llvm::sys::fs::remove(Path);
+    return;
+  }
+  PCHPath = std::string(Path.str());
+  Invocation->getPreprocessorOpts().ImplicitPCHInclude = PCHPath;
+}
+
+clang_fuzzer::CXXHandler::~CXXHandler() {
+  if (!PCHPath.empty())
+    llvm::sys::fs::remove(PCHPath);
+}
+
+void clang_fuzzer::CXXHandler::handle(const std::string &S) {
+  if (!Invocation)
+    return;
+
+  // Only the per-TU state is created again: the copy of the invocation, the
+  // CompilerInstance and what it owns.
+  auto InputInvocation = std::make_shared<CompilerInvocation>(*Invocation);
+  InputInvocation->getPreprocessorOpts().addRemappedFile(
+      FileName, llvm::MemoryBuffer::getMemBuffer(S).release());
+  std::unique_ptr<tooling::ToolAction> Action(
+      tooling::newFrontendActionFactory<clang::EmitObjAction>());
+  Action->runInvocation(std::move(InputInvocation), Files.get(),
+                        PCHContainerOps, Diags.get());
+}
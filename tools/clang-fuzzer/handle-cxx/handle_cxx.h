@@ -6,20 +6,63 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// Defines HandleCXX for use by the Clang fuzzers.
+// Defines HandleCXX and CXXHandler for use by the Clang fuzzers.
 //
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_CLANG_TOOLS_CLANG_FUZZER_HANDLE_CXX_HANDLECXX_H
 #define LLVM_CLANG_TOOLS_CLANG_FUZZER_HANDLE_CXX_HANDLECXX_H
 
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include <memory>
 #include <string>
 #include <vector>
 
+namespace clang {
+class CompilerInvocation;
+class DiagnosticConsumer;
+class DiagnosticOptions;
+class DiagnosticsEngine;
+class FileManager;
+class PCHContainerOperations;
+} // namespace clang
+
 namespace clang_fuzzer {
 void HandleCXX(const std::string &S,
                const char *FileName,
                const std::vector<const char *> &ExtraArgs);
+
+/// Compiles many inputs with the same arguments, e.g. once per execution of a
+/// fuzzer, reusing what doesn't depend on the input: the parsed invocation,
+/// the FileManager and its cached lookups of the headers, and optionally a
+/// PCH of common headers which every input includes.
+class CXXHandler {
+public:
+  /// \param PCHHeader if not empty, the header which is precompiled once and
+  /// then included before every input.
+  CXXHandler(const char *FileName, const std::vector<const char *> &ExtraArgs,
+             const std::string &PCHHeader = "");
+  ~CXXHandler();
+
+  /// Compile \p S, as the contents of the file the handler was created for.
+  void handle(const std::string &S);
+
+private:
+  std::string FileName;
+  std::unique_ptr<clang::DiagnosticConsumer> Diags;
+  llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> DiagOpts;
+  std::unique_ptr<clang::DiagnosticsEngine> Diagnostics;
+  llvm::IntrusiveRefCntPtr<clang::FileManager> Files;
+  std::shared_ptr<clang::PCHContainerOperations> PCHContainerOps;
+
+  /// The invocation which each input gets a copy of, or null if the
+  /// arguments are invalid.
+  std::unique_ptr<clang::CompilerInvocation> Invocation;
+
+  /// The path of the precompiled PCHHeader, which is removed with the
+  /// handler.
+  std::string PCHPath;
+};
 } // namespace clang_fuzzer
 
 #endif
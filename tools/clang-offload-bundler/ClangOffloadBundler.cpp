@@ -671,8 +671,12 @@ static bool BundleFiles() {
   SmallVector<std::unique_ptr<MemoryBuffer>, 8u> InputBuffers;
   InputBuffers.reserve(InputFileNames.size());
   for (auto &I : InputFileNames) {
+    // The inputs can be hundreds of megabytes of device code, which are mapped
+    // rather than read since the handlers only copy them, and don't need them
+    // to be null terminated.
     ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-        MemoryBuffer::getFileOrSTDIN(I);
+        MemoryBuffer::getFileOrSTDIN(I, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
     if (std::error_code EC = CodeOrErr.getError()) {
       errs() << "error: Can't open file " << I << ": " << EC.message() << "\n";
       return true;
@@ -707,9 +711,11 @@ static bool BundleFiles() {
 
 // Unbundle the files. Return true if an error was found.
 static bool UnbundleFiles() {
-  // Open Input file.
+  // Open Input file. It is mapped, so that only the pages of the header and
+  // of the bundles which are extracted are read.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(InputFileNames.front());
+      MemoryBuffer::getFileOrSTDIN(InputFileNames.front(), /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = CodeOrErr.getError()) {
     errs() << "error: Can't open file " << InputFileNames.front() << ": "
            << EC.message() << "\n";
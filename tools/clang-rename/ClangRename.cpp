@@ -96,6 +96,12 @@ static cl::opt<std::string>
 static cl::opt<bool> Force("force",
                            cl::desc("Ignore nonexistent qualified names."),
                            cl::cat(ClangRenameOptions));
+static cl::opt<std::string> IndexRecordDir(
+    "index-record-dir",
+    cl::desc("Directory of the index units and records of the <source>s. The "
+             "symbols are found in the first <source>, and only the <source>s "
+             "which the index doesn't rule out are parsed for renaming."),
+    cl::value_desc("directory"), cl::cat(ClangRenameOptions));
 
 int main(int argc, const char **argv) {
   tooling::CommonOptionsParser OP(argc, argv, ClangRenameOptions);
@@ -157,9 +163,19 @@ int main(int argc, const char **argv) {
   }
 
   auto Files = OP.getSourcePathList();
-  tooling::RefactoringTool Tool(OP.getCompilations(), Files);
   tooling::USRFindingAction FindingAction(SymbolOffsets, QualifiedNames, Force);
-  Tool.run(tooling::newFrontendActionFactory(&FindingAction).get());
+  if (!IndexRecordDir.empty()) {
+    // Only the symbols of the first translation unit are renamed anyway, so
+    // there is no need to parse the others to find them.
+    tooling::ClangTool FindingTool(OP.getCompilations(), Files.front());
+    FindingTool.run(tooling::newFrontendActionFactory(&FindingAction).get());
+    if (!FindingAction.errorOccurred())
+      Files = tooling::getFilesWithUSROccurrences(Files, IndexRecordDir,
+                                                  FindingAction.getUSRList());
+  }
+  tooling::RefactoringTool Tool(OP.getCompilations(), Files);
+  if (IndexRecordDir.empty())
+    Tool.run(tooling::newFrontendActionFactory(&FindingAction).get());
   const std::vector<std::vector<std::string>> &USRList =
       FindingAction.getUSRList();
   const std::vector<std::string> &PrevNames = FindingAction.getUSRSpellings();
@@ -6,17 +6,28 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/DirectoryWatcher/DirectoryWatcher.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningTool.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Options.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Threading.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
 #include <mutex>
 #include <thread>
 
@@ -59,6 +70,17 @@ static llvm::cl::opt<ScanningMode> ScanMode(
     llvm::cl::init(ScanningMode::MinimizedSourcePreprocessing),
     llvm::cl::cat(DependencyScannerCategory));
 
+static llvm::cl::opt<ScanningOutputFormat> Format(
+    "format", llvm::cl::desc("The output format for the dependencies"),
+    llvm::cl::values(clEnumValN(ScanningOutputFormat::Make, "make",
+                                "Makefile compatible dep file"),
+                     clEnumValN(ScanningOutputFormat::Full, "experimental-full",
+                                "Full dependency graph suitable"
+                                " for explicitly building modules. This format "
+                                "is experimental and will change.")),
+    llvm::cl::init(ScanningOutputFormat::Make),
+    llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<unsigned>
     NumThreads("j", llvm::cl::Optional,
                llvm::cl::desc("Number of worker threads to use (default: use "
@@ -83,6 +105,52 @@ llvm::cl::opt<bool> SkipExcludedPPRanges(
         "until reaching the end directive."),
     llvm::cl::init(true), llvm::cl::cat(DependencyScannerCategory));
 
+llvm::cl::opt<std::string> MinimizedSourceCacheDir(
+    "minimized-cache-dir",
+    llvm::cl::desc("Persist the minimized sources in the given directory and "
+                   "reuse them in later runs, as long as the original files "
+                   "are unchanged."),
+    llvm::cl::init(""), llvm::cl::cat(DependencyScannerCategory));
+
+llvm::cl::opt<bool> ServerMode(
+    "server",
+    llvm::cl::desc(
+        "Keep running and read requests from standard input, one file from "
+        "the compilation database per line. The dependencies of each request "
+        "are followed by a line '-- <file>: ok' or '-- <file>: error'. The "
+        "caches are kept across requests and only the entries of files that "
+        "changed are invalidated."),
+    llvm::cl::init(false), llvm::cl::cat(DependencyScannerCategory));
+
+enum class SchedulingOrder { InOrder, LongestFirst };
+
+static llvm::cl::opt<SchedulingOrder> Schedule(
+    "schedule",
+    llvm::cl::desc("The order in which the workers pick the translation units"),
+    llvm::cl::values(
+        clEnumValN(SchedulingOrder::InOrder, "in-order",
+                   "Scan the translation units in the order of the "
+                   "compilation database"),
+        clEnumValN(SchedulingOrder::LongestFirst, "longest-first",
+                   "Scan the translation units that are expected to take the "
+                   "longest first, based on the timings file if there is one "
+                   "and on the size of the input files otherwise")),
+    llvm::cl::init(SchedulingOrder::InOrder),
+    llvm::cl::cat(DependencyScannerCategory));
+
+llvm::cl::opt<std::string> TimingsFile(
+    "timings-file",
+    llvm::cl::desc("Read the scanning time of each translation unit from this "
+                   "file to schedule them, and update it with the timings of "
+                   "this run."),
+    llvm::cl::init(""), llvm::cl::cat(DependencyScannerCategory));
+
+llvm::cl::opt<bool> PrintTimings(
+    "print-timings",
+    llvm::cl::desc("Print the time it took to scan each translation unit, "
+                   "slowest first, to the standard error."),
+    llvm::cl::init(false), llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<bool> Verbose("v", llvm::cl::Optional,
                             llvm::cl::desc("Use verbose output."),
                             llvm::cl::init(false),
@@ -118,6 +186,438 @@ static bool handleDependencyToolResult(const std::string &Input,
   return false;
 }
 
+/// Collects the full dependencies of the translation units, merging the
+/// modules they have in common, and prints them as a single JSON document.
+class FullDeps {
+public:
+  void mergeDeps(StringRef Input, FullDependencies FD, size_t InputIndex) {
+    std::unique_lock<std::mutex> LockGuard(Lock);
+    for (ModuleDeps &MD : FD.DiscoveredModules) {
+      auto Key = std::make_pair(MD.ContextHash, MD.ModuleName);
+      auto It = Modules.find(Key);
+      if (It == Modules.end()) {
+        Modules.emplace(std::move(Key), std::move(MD));
+        continue;
+      }
+      // A module that is directly imported by any translation unit stays
+      // marked as such.
+      It->second.ImportedByMainFile |= MD.ImportedByMainFile;
+    }
+
+    InputDeps ID;
+    ID.FileName = Input;
+    ID.ContextHash = std::move(FD.ContextHash);
+    ID.FileDeps = std::move(FD.FileDeps);
+    ID.ModuleDeps = std::move(FD.ClangModuleDeps);
+    ID.InputIndex = InputIndex;
+    Inputs.push_back(std::move(ID));
+  }
+
+  void printFullOutput(raw_ostream &OS) {
+    std::unique_lock<std::mutex> LockGuard(Lock);
+    // Sort the translation units so the output is deterministic no matter in
+    // which order the workers finished.
+    llvm::sort(Inputs, [](const InputDeps &A, const InputDeps &B) {
+      return A.InputIndex < B.InputIndex;
+    });
+
+    llvm::json::Array OutModules;
+    for (const auto &Entry : Modules) {
+      const ModuleDeps &MD = Entry.second;
+      auto LookupModuleDeps = [&](StringRef Name) -> const ModuleDeps & {
+        auto It = Modules.find(std::make_pair(MD.ContextHash, Name.str()));
+        assert(It != Modules.end() && "missing module dependency");
+        return It->second;
+      };
+      llvm::json::Object O{
+          {"name", MD.ModuleName},
+          {"context-hash", MD.ContextHash},
+          {"clang-modulemap-file", MD.ClangModuleMapFile},
+          {"pcm-path", MD.ModulePCMPath},
+          {"file-deps", toJSONSorted(MD.FileDeps)},
+          {"clang-module-deps", toJSONSorted(MD.ClangModuleDeps)},
+          {"command-line", MD.getModuleBuildArguments(LookupModuleDeps)},
+      };
+      if (!MD.ModuleInterfaceFile.empty())
+        O.try_emplace("module-interface-file", MD.ModuleInterfaceFile);
+      OutModules.push_back(std::move(O));
+    }
+
+    llvm::json::Array TUs;
+    for (InputDeps &I : Inputs) {
+      llvm::sort(I.ModuleDeps);
+      llvm::json::Object O{
+          {"input-file", I.FileName},
+          {"clang-context-hash", I.ContextHash},
+          {"file-deps", I.FileDeps},
+          {"clang-module-deps", I.ModuleDeps},
+      };
+      TUs.push_back(std::move(O));
+    }
+
+    llvm::json::Object Output{
+        {"modules", std::move(OutModules)},
+        {"translation-units", std::move(TUs)},
+    };
+
+    OS << llvm::formatv("{0:2}\n", llvm::json::Value(std::move(Output)));
+  }
+
+private:
+  struct InputDeps {
+    std::string FileName;
+    std::string ContextHash;
+    std::vector<std::string> FileDeps;
+    std::vector<std::string> ModuleDeps;
+    size_t InputIndex;
+  };
+
+  static llvm::json::Array toJSONSorted(const llvm::StringSet<> &Set) {
+    std::vector<std::string> Strings;
+    for (const auto &Entry : Set)
+      Strings.push_back(Entry.getKey());
+    llvm::sort(Strings);
+    return llvm::json::Array(Strings);
+  }
+
+  std::mutex Lock;
+  /// The modules, keyed by context hash and module name.
+  std::map<std::pair<std::string, std::string>, ModuleDeps> Modules;
+  std::vector<InputDeps> Inputs;
+};
+
+static bool handleFullDependencyToolResult(
+    const std::string &Input,
+    llvm::Expected<FullDependencies> &MaybeFullDeps, FullDeps &FD,
+    size_t InputIndex, SharedStream &Errs) {
+  if (!MaybeFullDeps) {
+    llvm::handleAllErrors(
+        MaybeFullDeps.takeError(), [&Input, &Errs](llvm::StringError &Err) {
+          Errs.applyLocked([&](raw_ostream &OS) {
+            OS << "Error while scanning dependencies for " << Input << ":\n";
+            OS << Err.getMessage();
+          });
+        });
+    return true;
+  }
+  FD.mergeDeps(Input, std::move(*MaybeFullDeps), InputIndex);
+  return false;
+}
+
+/// Reads the timings file written by a previous run into \p Timings.
+static void readTimings(StringRef Path, llvm::StringMap<double> &Timings) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+  llvm::Expected<llvm::json::Value> Parsed =
+      llvm::json::parse((*Buffer)->getBuffer());
+  if (!Parsed) {
+    llvm::errs() << "warning: ignoring invalid timings file '" << Path
+                 << "': " << llvm::toString(Parsed.takeError()) << "\n";
+    return;
+  }
+  const llvm::json::Object *O = Parsed->getAsObject();
+  if (!O)
+    return;
+  for (const auto &Entry : *O)
+    if (llvm::Optional<double> Seconds = Entry.second.getAsNumber())
+      Timings[Entry.first.str()] = *Seconds;
+}
+
+/// Writes the timings of this run, merged with the timings of the
+/// translation units it did not scan, to \p Path.
+static void writeTimings(StringRef Path, llvm::StringMap<double> &Timings) {
+  llvm::json::Object O;
+  for (const auto &Entry : Timings)
+    O[Entry.getKey()] = Entry.getValue();
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_Text);
+  if (EC) {
+    llvm::errs() << "warning: cannot write timings file '" << Path
+                 << "': " << EC.message() << "\n";
+    return;
+  }
+  OS << llvm::formatv("{0:2}\n", llvm::json::Value(std::move(O)));
+}
+
+/// Computes the order in which the workers pick the inputs, so that the most
+/// expensive translation units don't end up at the tail of the run where they
+/// would keep a single worker busy while the others are idle.
+///
+/// The cost of an input is its timing from a previous run. Inputs without one
+/// are estimated from their size, using the average time per byte of the
+/// inputs with a timing, or just sorted by size if there are none.
+static std::vector<size_t> scheduleLongestFirst(
+    const std::vector<std::pair<std::string, std::string>> &Inputs,
+    const llvm::StringMap<double> &PreviousTimings) {
+  std::vector<double> Sizes(Inputs.size());
+  std::vector<double> Costs(Inputs.size(), -1.0);
+  double KnownSeconds = 0, KnownBytes = 0;
+  for (size_t I = 0, E = Inputs.size(); I != E; ++I) {
+    SmallString<256> Path(Inputs[I].first);
+    llvm::sys::fs::make_absolute(Inputs[I].second, Path);
+    uint64_t Size = 0;
+    if (!llvm::sys::fs::file_size(Path, Size))
+      Sizes[I] = Size;
+    auto It = PreviousTimings.find(Inputs[I].first);
+    if (It != PreviousTimings.end()) {
+      Costs[I] = It->getValue();
+      KnownSeconds += Costs[I];
+      KnownBytes += Sizes[I];
+    }
+  }
+  double SecondsPerByte = KnownBytes > 0 ? KnownSeconds / KnownBytes : 1.0;
+  for (size_t I = 0, E = Inputs.size(); I != E; ++I)
+    if (Costs[I] < 0)
+      Costs[I] = Sizes[I] * SecondsPerByte;
+
+  std::vector<size_t> Order(Inputs.size());
+  for (size_t I = 0, E = Order.size(); I != E; ++I)
+    Order[I] = I;
+  std::stable_sort(Order.begin(), Order.end(), [&](size_t A, size_t B) {
+    return Costs[A] > Costs[B];
+  });
+  return Order;
+}
+
+namespace {
+
+/// Watches the directories of the files in the shared file system cache of a
+/// long-lived scanning service, and invalidates the entries of the files that
+/// change between requests.
+///
+/// DirectoryWatcher events arrive on the watcher threads. They are only queued
+/// there, and applied by \c applyPendingInvalidations between two requests,
+/// while no worker holds on to any cache entry.
+class CacheInvalidator {
+public:
+  CacheInvalidator(DependencyScanningFilesystemSharedCache &Cache)
+      : Cache(Cache) {}
+
+  /// Start watching the directories of the entries cached since last call.
+  void watchNewEntries();
+
+  /// Invalidate the entries of the files that changed since the last call.
+  void applyPendingInvalidations();
+
+private:
+  struct WatchedDirectory {
+    /// The watcher, or null if the directory could not be watched.
+    std::unique_ptr<DirectoryWatcher> Watcher;
+    /// The cache keys of the entries in this directory, by file name.
+    llvm::StringMap<llvm::StringSet<>> KeysByName;
+  };
+
+  void addKey(StringRef Key, llvm::sys::TimePoint<> CachedModTime,
+              bool CachedExists);
+
+  DependencyScanningFilesystemSharedCache &Cache;
+  llvm::StringMap<WatchedDirectory> Directories;
+  llvm::StringSet<> WatchedKeys;
+
+  std::mutex PendingLock;
+  std::vector<std::pair<std::string, DirectoryWatcher::Event>> PendingEvents;
+  bool InvalidateEverything = false;
+};
+
+void CacheInvalidator::watchNewEntries() {
+  struct NewKey {
+    std::string Key;
+    llvm::sys::TimePoint<> ModTime;
+    bool Exists;
+  };
+  std::vector<NewKey> NewKeys;
+  Cache.forEachValidEntry(
+      [&](StringRef Key, const CachedFileSystemEntry &Entry) {
+        if (WatchedKeys.count(Key))
+          return;
+        llvm::ErrorOr<llvm::vfs::Status> Stat = Entry.getStatus();
+        NewKeys.push_back({Key, Stat ? Stat->getLastModificationTime()
+                                     : llvm::sys::TimePoint<>(),
+                           bool(Stat)});
+      });
+  for (const NewKey &K : NewKeys)
+    addKey(K.Key, K.ModTime, K.Exists);
+}
+
+void CacheInvalidator::addKey(StringRef Key,
+                              llvm::sys::TimePoint<> CachedModTime,
+                              bool CachedExists) {
+  WatchedKeys.insert(Key);
+
+  // Watch the nearest existing ancestor, so that a missing file or directory
+  // gets invalidated when the first missing path component is created.
+  StringRef Name = llvm::sys::path::filename(Key);
+  StringRef Dir = llvm::sys::path::parent_path(Key);
+  while (!Dir.empty() && !llvm::sys::fs::is_directory(Dir)) {
+    Name = llvm::sys::path::filename(Dir);
+    Dir = llvm::sys::path::parent_path(Dir);
+  }
+  if (Dir.empty())
+    return;
+
+  auto Inserted = Directories.try_emplace(Dir);
+  WatchedDirectory &Watched = Inserted.first->getValue();
+  if (Inserted.second) {
+    std::string DirPath = Dir;
+    auto MaybeWatcher = DirectoryWatcher::create(
+        DirPath,
+        [this, DirPath](llvm::ArrayRef<DirectoryWatcher::Event> Events,
+                        bool IsInitial) {
+          if (IsInitial)
+            return;
+          std::unique_lock<std::mutex> LockGuard(PendingLock);
+          for (const DirectoryWatcher::Event &E : Events)
+            PendingEvents.emplace_back(DirPath, E);
+        },
+        /*WaitForInitialSync=*/true);
+    if (MaybeWatcher) {
+      Watched.Watcher = std::move(*MaybeWatcher);
+    } else {
+      llvm::consumeError(MaybeWatcher.takeError());
+      if (Verbose)
+        llvm::errs() << "warning: cannot watch '" << Dir
+                     << "', its entries are invalidated on every request\n";
+    }
+  }
+  Watched.KeysByName[Name].insert(Key);
+
+  // The file might have changed between the time it was cached and the time
+  // the watcher started, so check it once now.
+  llvm::sys::fs::file_status Status;
+  bool Exists = !llvm::sys::fs::status(Key, Status);
+  if (Exists != CachedExists ||
+      (Exists && Status.getLastModificationTime() != CachedModTime)) {
+    Cache.invalidate(Key);
+    WatchedKeys.erase(Key);
+  }
+}
+
+void CacheInvalidator::applyPendingInvalidations() {
+  std::vector<std::pair<std::string, DirectoryWatcher::Event>> Events;
+  {
+    std::unique_lock<std::mutex> LockGuard(PendingLock);
+    std::swap(Events, PendingEvents);
+  }
+
+  auto InvalidateKeys = [&](const llvm::StringSet<> &Keys) {
+    for (const auto &Key : Keys) {
+      Cache.invalidate(Key.getKey());
+      WatchedKeys.erase(Key.getKey());
+    }
+  };
+
+  for (const auto &DirAndEvent : Events) {
+    auto It = Directories.find(DirAndEvent.first);
+    if (It == Directories.end())
+      continue;
+    const DirectoryWatcher::Event &E = DirAndEvent.second;
+    switch (E.Kind) {
+    case DirectoryWatcher::Event::EventKind::Removed:
+    case DirectoryWatcher::Event::EventKind::Modified: {
+      auto Keys = It->getValue().KeysByName.find(E.Filename);
+      if (Keys != It->getValue().KeysByName.end()) {
+        InvalidateKeys(Keys->getValue());
+        It->getValue().KeysByName.erase(Keys);
+      }
+      break;
+    }
+    case DirectoryWatcher::Event::EventKind::WatchedDirRemoved:
+    case DirectoryWatcher::Event::EventKind::WatcherGotInvalidated:
+      // Events might have been lost, so forget everything about this
+      // directory. It gets watched again after the next request.
+      for (const auto &Keys : It->getValue().KeysByName)
+        InvalidateKeys(Keys.getValue());
+      Directories.erase(It);
+      break;
+    }
+  }
+
+  // Directories that could not be watched are invalidated conservatively.
+  for (auto It = Directories.begin(), End = Directories.end(); It != End;) {
+    auto Current = It++;
+    if (Current->getValue().Watcher)
+      continue;
+    for (const auto &Keys : Current->getValue().KeysByName)
+      InvalidateKeys(Keys.getValue());
+    Directories.erase(Current);
+  }
+}
+
+/// Read a line from standard input, without the trailing newline.
+///
+/// \returns False at the end of the input.
+static bool readLineFromStdin(std::string &Line) {
+  Line.clear();
+  char Buffer[4096];
+  while (fgets(Buffer, sizeof(Buffer), stdin)) {
+    Line += Buffer;
+    if (StringRef(Line).endswith("\n")) {
+      Line.pop_back();
+      return true;
+    }
+  }
+  return !Line.empty();
+}
+
+/// Serve dependency scanning requests read from standard input until it is
+/// closed, reusing the service's caches across requests.
+static int runServer(
+    DependencyScanningService &Service, DependencyScanningTool &Tool,
+    const std::vector<std::pair<std::string, std::string>> &Inputs,
+    SharedStream &DependencyOS, SharedStream &Errs) {
+  llvm::StringMap<std::string> WorkingDirectories;
+  for (const auto &Input : Inputs)
+    WorkingDirectories.try_emplace(Input.first, Input.second);
+
+  CacheInvalidator Invalidator(Service.getSharedCache());
+  bool HadErrors = false;
+  std::string Line;
+  while (readLineFromStdin(Line)) {
+    std::string Input = StringRef(Line).trim();
+    if (Input.empty())
+      continue;
+
+    // Without the minimized sources cache there is nothing to invalidate
+    // precisely, so start every request from a cold file system state.
+    if (Service.getMode() == ScanningMode::CanonicalPreprocessing)
+      Service.getSharedCache().invalidateAll();
+    else
+      Invalidator.applyPendingInvalidations();
+
+    bool Failed = true;
+    auto CWD = WorkingDirectories.find(Input);
+    if (CWD == WorkingDirectories.end()) {
+      Errs.applyLocked([&](raw_ostream &OS) {
+        OS << "Error while scanning dependencies for " << Input
+           << ":\nfile is not in the compilation database\n";
+      });
+    } else if (Service.getFormat() == ScanningOutputFormat::Full) {
+      FullDeps FD;
+      auto MaybeFullDeps = Tool.getFullDependencies(Input, CWD->getValue());
+      Failed = handleFullDependencyToolResult(Input, MaybeFullDeps, FD,
+                                              /*InputIndex=*/0, Errs);
+      if (!Failed)
+        DependencyOS.applyLocked(
+            [&](raw_ostream &OS) { FD.printFullOutput(OS); });
+    } else {
+      auto MaybeFile = Tool.getDependencyFile(Input, CWD->getValue());
+      Failed = handleDependencyToolResult(Input, MaybeFile, DependencyOS, Errs);
+    }
+    HadErrors |= Failed;
+    DependencyOS.applyLocked([&](raw_ostream &OS) {
+      OS << "-- " << Input << (Failed ? ": error" : ": ok") << "\n";
+    });
+
+    if (Service.getMode() == ScanningMode::MinimizedSourcePreprocessing)
+      Invalidator.watchNewEntries();
+  }
+  return HadErrors;
+}
+
+} // end anonymous namespace
+
 int main(int argc, const char **argv) {
   llvm::InitLLVM X(argc, argv);
   llvm::cl::HideUnrelatedOptions(DependencyScannerCategory);
@@ -200,14 +700,23 @@ int main(int argc, const char **argv) {
   // Print out the dependency results to STDOUT by default.
   SharedStream DependencyOS(llvm::outs());
 
-  DependencyScanningService Service(ScanMode, ReuseFileManager,
-                                    SkipExcludedPPRanges);
+  DependencyScanningService Service(ScanMode, Format, ReuseFileManager,
+                                    SkipExcludedPPRanges,
+                                    MinimizedSourceCacheDir);
+  if (ServerMode) {
+    DependencyScanningTool Tool(Service, *AdjustingCompilations);
+    return runServer(Service, Tool, Inputs, DependencyOS, Errs);
+  }
+
 #if LLVM_ENABLE_THREADS
   unsigned NumWorkers =
       NumThreads == 0 ? llvm::hardware_concurrency() : NumThreads;
 #else
   unsigned NumWorkers = 1;
 #endif
+  // There is no point in having workers without inputs to scan.
+  NumWorkers =
+      std::max<size_t>(1, std::min<size_t>(NumWorkers, Inputs.size()));
   std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
   for (unsigned I = 0; I < NumWorkers; ++I)
     WorkerTools.push_back(std::make_unique<DependencyScanningTool>(
@@ -215,32 +724,61 @@ int main(int argc, const char **argv) {
 
   std::vector<std::thread> WorkerThreads;
   std::atomic<bool> HadErrors(false);
+  FullDeps FD;
   std::mutex Lock;
   size_t Index = 0;
 
+  llvm::StringMap<double> Timings;
+  if (!TimingsFile.empty())
+    readTimings(TimingsFile, Timings);
+  std::vector<size_t> Order;
+  if (Schedule == SchedulingOrder::LongestFirst) {
+    Order = scheduleLongestFirst(Inputs, Timings);
+  } else {
+    Order.resize(Inputs.size());
+    for (size_t I = 0, E = Order.size(); I != E; ++I)
+      Order[I] = I;
+  }
+  // Each worker only writes the entries of the inputs it scanned.
+  std::vector<double> InputTimings(Inputs.size());
+
   if (Verbose) {
     llvm::outs() << "Running clang-scan-deps on " << Inputs.size()
                  << " files using " << NumWorkers << " workers\n";
   }
   for (unsigned I = 0; I < NumWorkers; ++I) {
-    auto Worker = [I, &Lock, &Index, &Inputs, &HadErrors, &WorkerTools,
-                   &DependencyOS, &Errs]() {
+    auto Worker = [I, &Lock, &Index, &Order, &Inputs, &InputTimings,
+                   &HadErrors, &FD, &WorkerTools, &DependencyOS, &Errs]() {
       while (true) {
         std::string Input;
         StringRef CWD;
+        size_t LocalIndex;
         // Take the next input.
         {
           std::unique_lock<std::mutex> LockGuard(Lock);
           if (Index >= Inputs.size())
             return;
-          const auto &Compilation = Inputs[Index++];
+          LocalIndex = Order[Index++];
+          const auto &Compilation = Inputs[LocalIndex];
           Input = Compilation.first;
           CWD = Compilation.second;
         }
         // Run the tool on it.
-        auto MaybeFile = WorkerTools[I]->getDependencyFile(Input, CWD);
-        if (handleDependencyToolResult(Input, MaybeFile, DependencyOS, Errs))
-          HadErrors = true;
+        auto Start = std::chrono::steady_clock::now();
+        if (Format == ScanningOutputFormat::Make) {
+          auto MaybeFile = WorkerTools[I]->getDependencyFile(Input, CWD);
+          if (handleDependencyToolResult(Input, MaybeFile, DependencyOS, Errs))
+            HadErrors = true;
+        } else {
+          auto MaybeFullDeps = WorkerTools[I]->getFullDependencies(Input, CWD);
+          if (handleFullDependencyToolResult(Input, MaybeFullDeps, FD,
+                                             LocalIndex, Errs))
+            HadErrors = true;
+        }
+        InputTimings[LocalIndex] =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                          Start)
+                .count();
       }
     };
 #if LLVM_ENABLE_THREADS
@@ -253,5 +791,26 @@ int main(int argc, const char **argv) {
   for (auto &W : WorkerThreads)
     W.join();
 
+  if (Format == ScanningOutputFormat::Full)
+    FD.printFullOutput(llvm::outs());
+
+  if (PrintTimings) {
+    std::vector<size_t> Slowest(Inputs.size());
+    for (size_t I = 0, E = Slowest.size(); I != E; ++I)
+      Slowest[I] = I;
+    std::stable_sort(Slowest.begin(), Slowest.end(), [&](size_t A, size_t B) {
+      return InputTimings[A] > InputTimings[B];
+    });
+    for (size_t I : Slowest)
+      llvm::errs() << llvm::formatv("{0,10:f3}s  {1}\n", InputTimings[I],
+                                    Inputs[I].first);
+  }
+
+  if (!TimingsFile.empty()) {
+    for (size_t I = 0, E = Inputs.size(); I != E; ++I)
+      Timings[Inputs[I].first] = InputTimings[I];
+    writeTimings(TimingsFile, Timings);
+  }
+
   return HadErrors;
 }
@@ -18,6 +18,7 @@
 #include "clang/Config/config.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
+#include "clang/Frontend/CompileCache.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
@@ -244,10 +245,18 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Success)
     return 1;
 
-  // Execute the frontend actions.
-  {
+  // Execute the frontend actions, unless their results are restored from the
+  // compilation cache.
+  std::unique_ptr<CompileCache> Cache = CompileCache::create(*Clang, Argv);
+  if (Cache && Cache->replay()) {
+    Success = true;
+  } else {
     llvm::TimeTraceScope TimeScope("ExecuteCompiler", StringRef(""));
+    if (Cache)
+      Cache->attach();
     Success = ExecuteCompilerInvocation(Clang.get());
+    if (Success && Cache)
+      Cache->store();
   }
 
   // If any timers were active but haven't been destroyed yet, print their
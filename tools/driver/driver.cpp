@@ -14,6 +14,7 @@
 #include "clang/Driver/Driver.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/Stack.h"
+#include "clang/Config/config.h"
 #include "clang/Driver/Compilation.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
@@ -26,10 +27,12 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -41,6 +44,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
@@ -303,18 +307,50 @@ static void SetInstallDir(SmallVectorImpl<const char *> &argv,
     TheDriver.setInstalledDir(InstalledPathParent);
 }
 
-static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
+/// Writes the profile of the construction of the compilation \p C, which is
+/// recorded with -ftime-trace, next to its output, as cc1 does.
+static void WriteDriverTimeTrace(const Compilation &C) {
+  const llvm::opt::ArgList &Args = C.getArgs();
+  SmallString<128> Path;
+  if (const llvm::opt::Arg *A = Args.getLastArg(options::OPT_o))
+    Path = A->getValue();
+  else if (const llvm::opt::Arg *A = Args.getLastArg(options::OPT_INPUT))
+    Path = llvm::sys::path::filename(A->getValue());
+  if (!Path.empty() && Path != "-") {
+    llvm::sys::path::replace_extension(Path, "driver.json");
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_Text);
+    if (!EC)
+      llvm::timeTraceProfilerWrite(OS);
+  }
+  llvm::timeTraceProfilerCleanup();
+}
+
+static int ExecuteCC1Tool(SmallVectorImpl<const char *> &ArgV) {
+  // If we call the cc1 tool from the clangDriver library (through
+  // Driver::CC1Main), we need to clean up the options usage count. The options
+  // are currently global, and they might have been used previously by the
+  // driver.
+  llvm::cl::ResetAllOptionOccurrences();
+
+  llvm::BumpPtrAllocator A;
+  llvm::StringSaver Saver(A);
+  llvm::cl::ExpandResponseFiles(Saver, &llvm::cl::TokenizeGNUCommandLine, ArgV,
+                                /*MarkEOLs=*/false);
+  StringRef Tool = ArgV[1];
   void *GetExecutablePathVP = (void *)(intptr_t) GetExecutablePath;
-  if (Tool == "")
-    return cc1_main(argv.slice(2), argv[0], GetExecutablePathVP);
-  if (Tool == "as")
-    return cc1as_main(argv.slice(2), argv[0], GetExecutablePathVP);
-  if (Tool == "gen-reproducer")
-    return cc1gen_reproducer_main(argv.slice(2), argv[0], GetExecutablePathVP);
+  if (Tool == "-cc1")
+    return cc1_main(makeArrayRef(ArgV).slice(2), ArgV[0], GetExecutablePathVP);
+  if (Tool == "-cc1as")
+    return cc1as_main(makeArrayRef(ArgV).slice(2), ArgV[0],
+                      GetExecutablePathVP);
+  if (Tool == "-cc1gen-reproducer")
+    return cc1gen_reproducer_main(makeArrayRef(ArgV).slice(2), ArgV[0],
+                                  GetExecutablePathVP);
 
   // Reject unknown tools.
-  llvm::errs() << "error: unknown integrated tool '" << Tool << "'. "
-               << "Valid tools include '-cc1' and '-cc1as'.\n";
+  llvm::errs() << "error: unknown integrated tool '" << Tool.drop_front(4)
+               << "'. Valid tools include '-cc1' and '-cc1as'.\n";
   return 1;
 }
 
@@ -379,7 +415,35 @@ int main(int argc_, const char **argv_) {
       auto newEnd = std::remove(argv.begin(), argv.end(), nullptr);
       argv.resize(newEnd - argv.begin());
     }
-    return ExecuteCC1Tool(argv, argv[1] + 4);
+    return ExecuteCC1Tool(argv);
+  }
+
+  // Whether the cc1 tool should be called inside the current process, or if
+  // we should spawn a new clang subprocess (the default unless clang was
+  // configured with CLANG_SPAWN_CC1=OFF). Running in-process saves a process
+  // startup, dynamic relocation and option re-parse per compile.
+  bool UseNewCC1Process = CLANG_SPAWN_CC1;
+  for (const char *Arg : argv) {
+    // Skip end-of-line response file markers
+    if (Arg == nullptr)
+      continue;
+    UseNewCC1Process = llvm::StringSwitch<bool>(Arg)
+                           .Case("-fno-integrated-cc1", true)
+                           .Case("-fintegrated-cc1", false)
+                           .Default(UseNewCC1Process);
+  }
+
+  // -ftime-trace also profiles the driver, e.g. its toolchain discovery.
+  bool TimeTrace = false;
+  unsigned TimeTraceGranularity = 500;
+  for (const char *Arg : argv) {
+    if (Arg == nullptr)
+      continue;
+    StringRef A(Arg);
+    if (A == "-ftime-trace")
+      TimeTrace = true;
+    else if (A.consume_front("-ftime-trace-granularity="))
+      A.getAsInteger(10, TimeTraceGranularity);
   }
 
   bool CanonicalPrefixes = true;
@@ -455,7 +519,23 @@ int main(int argc_, const char **argv_) {
 
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
 
+  if (!UseNewCC1Process) {
+    TheDriver.CC1Main = &ExecuteCC1Tool;
+    // Ensure the CC1Command actually catches cc1 crashes
+    llvm::CrashRecoveryContext::Enable();
+  }
+
+  if (TimeTrace)
+    llvm::timeTraceProfilerInitialize(TimeTraceGranularity);
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
+  // The profile is written before the jobs run, since the cc1 jobs which run
+  // in this process record their own.
+  if (TimeTrace) {
+    if (C)
+      WriteDriverTimeTrace(*C);
+    else
+      llvm::timeTraceProfilerCleanup();
+  }
   int Res = 1;
   if (C && !C->containsError()) {
     SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
@@ -32,6 +32,7 @@
 #include "clang/Basic/Version.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/PreambleCache.h"
 #include "clang/Index/CommentToXML.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Lexer.h"
@@ -53,6 +54,7 @@
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <limits>
 #include <mutex>
 
 #if LLVM_ENABLE_THREADS != 0 && defined(__APPLE__)
@@ -97,42 +99,120 @@ bool cxtu::isASTReadError(ASTUnit *AU) {
   return false;
 }
 
+cxtu::CancellationScope::CancellationScope(ASTUnit &AU,
+                                           CXCancellationToken Token)
+    : AU(AU) {
+  AU.setCancellationFlag(Token ? &Token->Cancelled : nullptr);
+}
+
+cxtu::CancellationScope::~CancellationScope() {
+  AU.setCancellationFlag(nullptr);
+}
+
 cxtu::CXTUOwner::~CXTUOwner() {
   if (TU)
     clang_disposeTranslationUnit(TU);
 }
 
+Optional<unsigned> FileLocationOrder::getOffsetInFile(FileID FID) const {
+  auto Inserted = OffsetsInFile.try_emplace(FID);
+  Optional<unsigned> &Offset = Inserted.first->second;
+  if (!Inserted.second)
+    return Offset;
+
+  std::pair<FileID, unsigned> Loc = SM.getDecomposedIncludedLoc(FID);
+  while (Loc.first.isValid() && Loc.first != File)
+    Loc = SM.getDecomposedIncludedLoc(Loc.first);
+  if (Loc.first.isValid())
+    Offset = Loc.second;
+  return Offset;
+}
+
+bool FileLocationOrder::isBefore(SourceLocation L, SourceLocation R) const {
+  if (L == R || File.isInvalid())
+    return SM.isBeforeInTranslationUnit(L, R);
+
+  std::pair<FileID, unsigned> LOffs = SM.getDecomposedLoc(L);
+  std::pair<FileID, unsigned> ROffs = SM.getDecomposedLoc(R);
+  if (LOffs.first.isInvalid() || ROffs.first.isInvalid())
+    return SM.isBeforeInTranslationUnit(L, R);
+  if (LOffs.first == ROffs.first)
+    return LOffs.second < ROffs.second;
+
+  // File is the nearest common ancestor of the FileIDs when one of them is
+  // File and the other is in File. Like the SourceManager, order the
+  // locations by their offsets in File, and the expansions or inclusions at
+  // the same offset by their FileIDs.
+  if (LOffs.first == File) {
+    if (Optional<unsigned> ROffset = getOffsetInFile(ROffs.first))
+      return LOffs.second == *ROffset ? File < ROffs.first
+                                      : LOffs.second < *ROffset;
+  } else if (ROffs.first == File) {
+    if (Optional<unsigned> LOffset = getOffsetInFile(LOffs.first))
+      return *LOffset == ROffs.second ? LOffs.first < File
+                                      : *LOffset < ROffs.second;
+  }
+  return SM.isBeforeInTranslationUnit(L, R);
+}
+
 /// Compare two source ranges to determine their relative position in
-/// the translation unit.
-static RangeComparisonResult RangeCompare(SourceManager &SM,
-                                          SourceRange R1,
-                                          SourceRange R2) {
+/// the translation unit, where \p IsBefore orders the source locations.
+template <typename LocationOrder>
+static RangeComparisonResult RangeCompare(const LocationOrder &IsBefore,
+                                          SourceRange R1, SourceRange R2) {
   assert(R1.isValid() && "First range is invalid?");
   assert(R2.isValid() && "Second range is invalid?");
-  if (R1.getEnd() != R2.getBegin() &&
-      SM.isBeforeInTranslationUnit(R1.getEnd(), R2.getBegin()))
+  if (R1.getEnd() != R2.getBegin() && IsBefore(R1.getEnd(), R2.getBegin()))
     return RangeBefore;
-  if (R2.getEnd() != R1.getBegin() &&
-      SM.isBeforeInTranslationUnit(R2.getEnd(), R1.getBegin()))
+  if (R2.getEnd() != R1.getBegin() && IsBefore(R2.getEnd(), R1.getBegin()))
     return RangeAfter;
   return RangeOverlap;
 }
 
+static RangeComparisonResult RangeCompare(SourceManager &SM,
+                                          SourceRange R1,
+                                          SourceRange R2) {
+  return RangeCompare(
+      [&SM](SourceLocation LHS, SourceLocation RHS) {
+        return SM.isBeforeInTranslationUnit(LHS, RHS);
+      },
+      R1, R2);
+}
+
+static RangeComparisonResult RangeCompare(const FileLocationOrder &Order,
+                                          SourceRange R1, SourceRange R2) {
+  return RangeCompare(
+      [&Order](SourceLocation LHS, SourceLocation RHS) {
+        return Order.isBefore(LHS, RHS);
+      },
+      R1, R2);
+}
+
 /// Determine if a source location falls within, before, or after a
-///   a given source range.
-static RangeComparisonResult LocationCompare(SourceManager &SM,
+///   a given source range, where \p IsBefore orders the source locations.
+template <typename LocationOrder>
+static RangeComparisonResult LocationCompare(const LocationOrder &IsBefore,
                                              SourceLocation L, SourceRange R) {
   assert(R.isValid() && "First range is invalid?");
   assert(L.isValid() && "Second range is invalid?");
   if (L == R.getBegin() || L == R.getEnd())
     return RangeOverlap;
-  if (SM.isBeforeInTranslationUnit(L, R.getBegin()))
+  if (IsBefore(L, R.getBegin()))
     return RangeBefore;
-  if (SM.isBeforeInTranslationUnit(R.getEnd(), L))
+  if (IsBefore(R.getEnd(), L))
     return RangeAfter;
   return RangeOverlap;
 }
 
+static RangeComparisonResult LocationCompare(const FileLocationOrder &Order,
+                                             SourceLocation L, SourceRange R) {
+  return LocationCompare(
+      [&Order](SourceLocation LHS, SourceLocation RHS) {
+        return Order.isBefore(LHS, RHS);
+      },
+      L, R);
+}
+
 /// Translate a Clang source range into a CIndex source range.
 ///
 /// Clang internally represents ranges where the end location points to the
@@ -173,7 +253,11 @@ static SourceRange getRawCursorExtent(CXCursor C);
 static SourceRange getFullCursorExtent(CXCursor C, SourceManager &SrcMgr);
 
 RangeComparisonResult CursorVisitor::CompareRegionOfInterest(SourceRange R) {
-  return RangeCompare(AU->getSourceManager(), R, RegionOfInterest);
+  if (!RegionOrder) {
+    SourceManager &SM = AU->getSourceManager();
+    RegionOrder.emplace(SM, SM.getFileID(RegionOfInterest.getBegin()));
+  }
+  return RangeCompare(*RegionOrder, R, RegionOfInterest);
 }
 
 /// Visit the given cursor and, if requested by the visitor,
@@ -3286,11 +3370,14 @@ CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
   // registered once.
   (void)*RegisterFatalErrorHandlerOnce;
 
-  // Initialize targets for clang module support.
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmPrinters();
-  llvm::InitializeAllAsmParsers();
+  // Initialize targets for clang module support, once a translation unit is
+  // parsed.
+  TargetInfo::setLazyTargetRegistration([] {
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmPrinters();
+    llvm::InitializeAllAsmParsers();
+  });
 
   CIndexer *CIdxr = new CIndexer();
 
@@ -3306,6 +3393,9 @@ CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
     CIdxr->setCXGlobalOptFlags(CIdxr->getCXGlobalOptFlags() |
                                CXGlobalOpt_ThreadBackgroundPriorityForEditing);
 
+  if (!getenv("LIBCLANG_DISABLE_SHARED_PREAMBLES"))
+    CIdxr->setPreambleCache(std::make_shared<PreambleCache>());
+
   return CIdxr;
 }
 
@@ -3403,7 +3493,8 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
                                 const char *const *command_line_args,
                                 int num_command_line_args,
                                 ArrayRef<CXUnsavedFile> unsaved_files,
-                                unsigned options, CXTranslationUnit *out_TU) {
+                                unsigned options, CXCancellationToken Token,
+                                CXTranslationUnit *out_TU) {
   // Set up the initial return values.
   if (out_TU)
     *out_TU = nullptr;
@@ -3534,7 +3625,11 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies, SingleFileParse,
       /*UserFilesAreVolatile=*/true, ForSerialization, RetainExcludedCB,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      &ErrUnit, /*VFS=*/nullptr, Token ? &Token->Cancelled : nullptr,
+      CXXIdx->getPreambleCache()));
+
+  if (!Unit && Token && Token->Cancelled)
+    return CXError_Cancelled;
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
@@ -3596,6 +3691,29 @@ enum CXErrorCode clang_parseTranslationUnit2FullArgv(
     const char *const *command_line_args, int num_command_line_args,
     struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
     unsigned options, CXTranslationUnit *out_TU) {
+  return clang_parseTranslationUnitCancellable(
+      CIdx, source_filename, command_line_args, num_command_line_args,
+      unsaved_files, num_unsaved_files, options, /*Token=*/nullptr, out_TU);
+}
+
+CXCancellationToken clang_createCancellationToken(void) {
+  return new CXCancellationTokenImpl();
+}
+
+void clang_cancel(CXCancellationToken Token) {
+  if (Token)
+    Token->Cancelled = true;
+}
+
+void clang_disposeCancellationToken(CXCancellationToken Token) {
+  delete Token;
+}
+
+enum CXErrorCode clang_parseTranslationUnitCancellable(
+    CXIndex CIdx, const char *source_filename,
+    const char *const *command_line_args, int num_command_line_args,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, CXCancellationToken Token, CXTranslationUnit *out_TU) {
   LOG_FUNC_SECTION {
     *Log << source_filename << ": ";
     for (int i = 0; i != num_command_line_args; ++i)
@@ -3609,7 +3727,8 @@ enum CXErrorCode clang_parseTranslationUnit2FullArgv(
   auto ParseTranslationUnitImpl = [=, &result] {
     result = clang_parseTranslationUnit_Impl(
         CIdx, source_filename, command_line_args, num_command_line_args,
-        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options, out_TU);
+        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options, Token,
+        out_TU);
   };
 
   llvm::CrashRecoveryContext CRC;
@@ -4088,7 +4207,7 @@ unsigned clang_defaultReparseOptions(CXTranslationUnit TU) {
 static CXErrorCode
 clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
                                   ArrayRef<CXUnsavedFile> unsaved_files,
-                                  unsigned options) {
+                                  unsigned options, CXCancellationToken Token) {
   // Check arguments.
   if (isNotUsableTU(TU)) {
     LOG_BAD_TU(TU);
@@ -4105,6 +4224,7 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
 
   ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
   ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+  CancellationScope Cancellation(*CXXUnit, Token);
 
   std::unique_ptr<std::vector<ASTUnit::RemappedFile>> RemappedFiles(
       new std::vector<ASTUnit::RemappedFile>());
@@ -4122,6 +4242,8 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
   if (!CXXUnit->Reparse(CXXIdx->getPCHContainerOperations(),
                         *RemappedFiles.get()))
     return CXError_Success;
+  if (Token && Token->Cancelled)
+    return CXError_Cancelled;
   if (isASTReadError(CXXUnit))
     return CXError_ASTReadError;
   return CXError_Failure;
@@ -4131,6 +4253,15 @@ int clang_reparseTranslationUnit(CXTranslationUnit TU,
                                  unsigned num_unsaved_files,
                                  struct CXUnsavedFile *unsaved_files,
                                  unsigned options) {
+  return clang_reparseTranslationUnitCancellable(
+      TU, num_unsaved_files, unsaved_files, options, /*Token=*/nullptr);
+}
+
+int clang_reparseTranslationUnitCancellable(CXTranslationUnit TU,
+                                            unsigned num_unsaved_files,
+                                            struct CXUnsavedFile *unsaved_files,
+                                            unsigned options,
+                                            CXCancellationToken Token) {
   LOG_FUNC_SECTION {
     *Log << TU;
   }
@@ -4141,7 +4272,8 @@ int clang_reparseTranslationUnit(CXTranslationUnit TU,
   CXErrorCode result;
   auto ReparseTranslationUnitImpl = [=, &result]() {
     result = clang_reparseTranslationUnit_Impl(
-        TU, llvm::makeArrayRef(unsaved_files, num_unsaved_files), options);
+        TU, llvm::makeArrayRef(unsaved_files, num_unsaved_files), options,
+        Token);
   };
 
   llvm::CrashRecoveryContext CRC;
@@ -4447,6 +4579,48 @@ unsigned clang_visitChildrenWithBlock(CXCursor parent,
   return clang_visitChildren(parent, visitWithBlock, block);
 }
 
+namespace {
+struct CursorSubtreeRecorder {
+  CXCursorRecord *Records;
+  unsigned NumRecords;
+  unsigned NumCursors = 0;
+  /// The cursors from the root to the cursor being visited, with the indices
+  /// of their records. The root itself is not on the stack.
+  SmallVector<std::pair<CXCursor, unsigned>, 16> Ancestors;
+};
+} // namespace
+
+static enum CXChildVisitResult recordCursor(CXCursor C, CXCursor Parent,
+                                            CXClientData Data) {
+  auto &Recorder = *static_cast<CursorSubtreeRecorder *>(Data);
+  // Leave the subtrees which have been visited.
+  while (!Recorder.Ancestors.empty() &&
+         !clang_equalCursors(Recorder.Ancestors.back().first, Parent))
+    Recorder.Ancestors.pop_back();
+
+  unsigned Index = Recorder.NumCursors++;
+  if (Index < Recorder.NumRecords) {
+    CXCursorRecord &Record = Recorder.Records[Index];
+    Record.kind = C.kind;
+    Record.parent = Recorder.Ancestors.empty()
+                        ? std::numeric_limits<unsigned>::max()
+                        : Recorder.Ancestors.back().second;
+    Record.extent = clang_getCursorExtent(C);
+    Record.cursor = C;
+  }
+  Recorder.Ancestors.push_back(std::make_pair(C, Index));
+  return CXChildVisit_Recurse;
+}
+
+unsigned clang_getCursorSubtree(CXCursor root, CXCursorRecord *records,
+                                unsigned num_records) {
+  if (!records)
+    num_records = 0;
+  CursorSubtreeRecorder Recorder{records, num_records};
+  clang_visitChildren(root, recordCursor, &Recorder);
+  return Recorder.NumCursors;
+}
+
 static CXString getDeclSpelling(const Decl *D) {
   if (!D)
     return cxstring::createEmpty();
@@ -6866,6 +7040,9 @@ class AnnotateTokensWorker {
   unsigned PreprocessingTokIdx;
   CursorVisitor AnnotateVis;
   SourceManager &SrcMgr;
+  /// The order of the locations, which is fast for the locations of the
+  /// tokens.
+  FileLocationOrder LocOrder;
   bool HasContextSensitiveKeywords;
 
   struct PostChildrenAction {
@@ -6921,6 +7098,7 @@ public:
                   /*VisitDeclsOnly=*/false,
                   AnnotateTokensPostChildrenVisitor),
       SrcMgr(cxtu::getASTUnit(TU)->getSourceManager()),
+      LocOrder(SrcMgr, SrcMgr.getFileID(RegionOfInterest.getBegin())),
       HasContextSensitiveKeywords(false) { }
 
   void VisitChildren(CXCursor C) { AnnotateVis.VisitChildren(C); }
@@ -7036,7 +7214,7 @@ void AnnotateTokensWorker::annotateAndAdvanceTokens(CXCursor updateC,
         return;
 
     SourceLocation TokLoc = GetTokenLoc(I);
-    if (LocationCompare(SrcMgr, TokLoc, range) == compResult) {
+    if (LocationCompare(LocOrder, TokLoc, range) == compResult) {
       updateCursorAnnotation(Cursors[I], updateC);
       AdvanceToken();
       continue;
@@ -7070,7 +7248,7 @@ bool AnnotateTokensWorker::annotateAndAdvanceFunctionMacroTokens(
     SourceLocation TokLoc = getFunctionMacroTokenLoc(I);
     if (TokLoc.isFileID())
       continue; // not macro arg token, it's parens or comma.
-    if (LocationCompare(SrcMgr, TokLoc, range) == compResult) {
+    if (LocationCompare(LocOrder, TokLoc, range) == compResult) {
       if (clang_isInvalid(clang_getCursorKind(Cursors[I])))
         Cursors[I] = updateC;
     } else
@@ -7152,7 +7330,7 @@ AnnotateTokensWorker::Visit(CXCursor cursor, CXCursor parent) {
     while (MoreTokens()) {
       const unsigned I = NextToken();
       SourceLocation TokLoc = GetTokenLoc(I);
-      switch (LocationCompare(SrcMgr, TokLoc, cursorRange)) {
+      switch (LocationCompare(LocOrder, TokLoc, cursorRange)) {
       case RangeBefore:
         AdvanceToken();
         continue;
@@ -7167,7 +7345,7 @@ AnnotateTokensWorker::Visit(CXCursor cursor, CXCursor parent) {
     while (MoreTokens()) {
       const unsigned I = NextToken();
       SourceLocation TokLoc = GetTokenLoc(I);
-      switch (LocationCompare(SrcMgr, TokLoc, cursorRange)) {
+      switch (LocationCompare(LocOrder, TokLoc, cursorRange)) {
       case RangeBefore:
         llvm_unreachable("Infeasible");
       case RangeAfter:
@@ -7317,7 +7495,7 @@ void AnnotateTokensWorker::HandlePostPonedChildCursor(
       RefNameRange = SourceRange(RefNameRange.getBegin(), fixedEnd);
 
       const RangeComparisonResult ComparisonResult =
-          LocationCompare(SrcMgr, TokenLocation, RefNameRange);
+          LocationCompare(LocOrder, TokenLocation, RefNameRange);
 
       if (ComparisonResult == RangeOverlap) {
         Cursors[I++] = Cursor;
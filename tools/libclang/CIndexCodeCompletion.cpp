@@ -692,7 +692,8 @@ static CXCodeCompleteResults *
 clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                           unsigned complete_line, unsigned complete_column,
                           ArrayRef<CXUnsavedFile> unsaved_files,
-                          unsigned options) {
+                          unsigned options, CXCancellationToken Token,
+                          StringRef Filter, unsigned MaxResults) {
   bool IncludeBriefComments = options & CXCodeComplete_IncludeBriefComments;
   bool SkipPreamble = options & CXCodeComplete_SkipPreamble;
   bool IncludeFixIts = options & CXCodeComplete_IncludeCompletionsWithFixIts;
@@ -718,6 +719,7 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
     setThreadBackgroundPriority();
 
   ASTUnit::ConcurrencyCheck Check(*AST);
+  cxtu::CancellationScope Cancellation(*AST, Token);
 
   // Perform the remapping of source files.
   SmallVector<ASTUnit::RemappedFile, 4> RemappedFiles;
@@ -743,6 +745,8 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
   Opts.IncludeBriefComments = IncludeBriefComments;
   Opts.LoadExternal = !SkipPreamble;
   Opts.IncludeFixIts = IncludeFixIts;
+  Opts.ResultFilter = std::string(Filter);
+  Opts.ResultLimit = MaxResults;
   CaptureCompletionResults Capture(Opts, *Results, &TU);
 
   // Perform completion.
@@ -764,6 +768,12 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                     Results->LangOpts, *Results->SourceMgr, *Results->FileMgr,
                     Results->Diagnostics, Results->TemporaryBuffers);
 
+  if (Token && Token->Cancelled) {
+    // The parse may have stopped before the completion point.
+    clang_disposeCodeCompleteResults(Results);
+    return nullptr;
+  }
+
   Results->DiagnosticsWrappers.resize(Results->Diagnostics.size());
 
   // Keep a reference to the allocator used for cached global completions, so
@@ -856,6 +866,19 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             struct CXUnsavedFile *unsaved_files,
                                             unsigned num_unsaved_files,
                                             unsigned options) {
+  return clang_codeCompleteAtCancellable(TU, complete_filename, complete_line,
+                                         complete_column, unsaved_files,
+                                         num_unsaved_files, options,
+                                         /*Token=*/nullptr);
+}
+
+static CXCodeCompleteResults *
+codeCompleteAtSafely(CXTranslationUnit TU, const char *complete_filename,
+                     unsigned complete_line, unsigned complete_column,
+                     struct CXUnsavedFile *unsaved_files,
+                     unsigned num_unsaved_files, unsigned options,
+                     CXCancellationToken Token, const char *filter,
+                     unsigned max_results) {
   LOG_FUNC_SECTION {
     *Log << TU << ' '
          << complete_filename << ':' << complete_line << ':' << complete_column;
@@ -868,7 +891,8 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
   auto CodeCompleteAtImpl = [=, &result]() {
     result = clang_codeCompleteAt_Impl(
         TU, complete_filename, complete_line, complete_column,
-        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options);
+        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options,
+        Token, filter ? filter : "", max_results);
   };
 
   llvm::CrashRecoveryContext CRC;
@@ -883,6 +907,28 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
   return result;
 }
 
+CXCodeCompleteResults *clang_codeCompleteAtCancellable(
+    CXTranslationUnit TU, const char *complete_filename,
+    unsigned complete_line, unsigned complete_column,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, CXCancellationToken Token) {
+  return codeCompleteAtSafely(TU, complete_filename, complete_line,
+                              complete_column, unsaved_files,
+                              num_unsaved_files, options, Token,
+                              /*filter=*/nullptr, /*max_results=*/0);
+}
+
+CXCodeCompleteResults *clang_codeCompleteAtFiltered(
+    CXTranslationUnit TU, const char *complete_filename,
+    unsigned complete_line, unsigned complete_column,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    unsigned options, const char *filter, unsigned max_results) {
+  return codeCompleteAtSafely(TU, complete_filename, complete_line,
+                              complete_column, unsaved_files,
+                              num_unsaved_files, options, /*Token=*/nullptr,
+                              filter, max_results);
+}
+
 unsigned clang_defaultCodeCompleteOptions(void) {
   return CXCodeComplete_IncludeMacros;
 }
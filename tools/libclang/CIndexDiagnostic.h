@@ -33,11 +33,13 @@ public:
 
   virtual ~CXDiagnosticSetImpl();
 
-  size_t getNumDiagnostics() const {
+  virtual size_t getNumDiagnostics() const {
     return Diagnostics.size();
   }
-  
-  CXDiagnosticImpl *getDiagnostic(unsigned i) const {
+
+  /// Return the diagnostic \p i, or null if it is decoded lazily and can't
+  /// be decoded.
+  virtual CXDiagnosticImpl *getDiagnostic(unsigned i) const {
     assert(i < getNumDiagnostics());
     return Diagnostics[i].get();
   }
@@ -45,7 +47,7 @@ public:
   void appendDiagnostic(std::unique_ptr<CXDiagnosticImpl> D);
 
   bool empty() const {
-    return Diagnostics.empty();
+    return getNumDiagnostics() == 0;
   }
   
   bool isExternallyManaged() const { return IsExternallyManaged; }
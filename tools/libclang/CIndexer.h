@@ -27,6 +27,7 @@ namespace clang {
 class ASTUnit;
 class MacroInfo;
 class MacroDefinitionRecord;
+class PreambleCache;
 class SourceLocation;
 class Token;
 class IdentifierInfo;
@@ -43,6 +44,9 @@ class CIndexer {
 
   std::string InvocationEmissionPath;
 
+  /// The preambles shared by the translation units of this index, if any.
+  std::shared_ptr<PreambleCache> Preambles;
+
 public:
   CIndexer(std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                std::make_shared<PCHContainerOperations>())
@@ -82,6 +86,11 @@ public:
   }
 
   StringRef getInvocationEmissionPath() const { return InvocationEmissionPath; }
+
+  std::shared_ptr<PreambleCache> getPreambleCache() const { return Preambles; }
+  void setPreambleCache(std::shared_ptr<PreambleCache> Cache) {
+    Preambles = std::move(Cache);
+  }
 };
 
 /// Logs information about a particular libclang operation like parsing to
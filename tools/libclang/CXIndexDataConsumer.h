@@ -12,6 +12,7 @@
 #include "CXCursor.h"
 #include "Index_Internal.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/AST/DeclObjC.h"
 #include "llvm/ADT/DenseSet.h"
@@ -291,6 +292,10 @@ class CXIndexDataConsumer : public index::IndexDataConsumer {
   typedef std::pair<const FileEntry *, const Decl *> RefFileOccurrence;
   llvm::DenseSet<RefFileOccurrence> RefFileOccurrences;
 
+  /// The USRs of the entities, which are reported for each of their
+  /// occurrences.
+  index::USRCache USRs;
+
   llvm::BumpPtrAllocator StrScratch;
   unsigned StrAdapterCount;
   friend class ScratchAlloc;
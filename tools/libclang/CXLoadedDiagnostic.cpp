@@ -22,6 +22,7 @@
 #include "llvm/ADT/Twine.h"
 #include "llvm/Bitstream/BitstreamReader.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace clang;
 
@@ -32,10 +33,15 @@ using namespace clang;
 typedef llvm::DenseMap<unsigned, const char *> Strings;
 
 namespace {
+class DiagLoader;
+
 class CXLoadedDiagnosticSetImpl : public CXDiagnosticSetImpl {
 public:
-  CXLoadedDiagnosticSetImpl() : CXDiagnosticSetImpl(true), FakeFiles(FO) {}
-  ~CXLoadedDiagnosticSetImpl() override {}
+  CXLoadedDiagnosticSetImpl();
+  ~CXLoadedDiagnosticSetImpl() override;
+
+  size_t getNumDiagnostics() const override;
+  CXDiagnosticImpl *getDiagnostic(unsigned i) const override;
 
   llvm::BumpPtrAllocator Alloc;
   Strings Categories;
@@ -53,6 +59,14 @@ public:
     mem[Blob.size()] = '\0';
     return mem;
   }
+
+  /// If non-null, the loader which decodes the top-level diagnostics from
+  /// Buffer when they are first accessed.
+  std::unique_ptr<DiagLoader> LazyLoader;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  /// The offsets in Buffer of the top-level diagnostics.
+  std::vector<uint64_t> DiagnosticOffsets;
+  mutable std::vector<std::unique_ptr<CXLoadedDiagnostic>> DecodedDiagnostics;
 };
 } // end anonymous namespace
 
@@ -66,7 +80,7 @@ CXLoadedDiagnostic::~CXLoadedDiagnostic() {}
 // Public CXLoadedDiagnostic methods.
 //===----------------------------------------------------------------------===//
 
-CXDiagnosticSeverity CXLoadedDiagnostic::getSeverity() const {
+static CXDiagnosticSeverity getSeverityForLevel(unsigned severity) {
   // FIXME: Fail more softly if the diagnostic level is unknown?
   auto severityAsLevel = static_cast<serialized_diags::Level>(severity);
   assert(severity == static_cast<unsigned>(severityAsLevel) &&
@@ -87,6 +101,10 @@ CXDiagnosticSeverity CXLoadedDiagnostic::getSeverity() const {
   llvm_unreachable("Invalid diagnostic level");
 }
 
+CXDiagnosticSeverity CXLoadedDiagnostic::getSeverity() const {
+  return getSeverityForLevel(severity);
+}
+
 static CXSourceLocation makeLocation(const CXLoadedDiagnostic::Location *DLoc) {
   // The lowest bit of ptr_data[0] is always set to 1 to indicate this
   // is a persistent diagnostic.
@@ -187,8 +205,12 @@ namespace {
 class DiagLoader : serialized_diags::SerializedDiagnosticReader {
   enum CXLoadDiag_Error *error;
   CXString *errorString;
-  std::unique_ptr<CXLoadedDiagnosticSetImpl> TopDiags;
+  CXLoadedDiagnosticSetImpl *TopDiags = nullptr;
   SmallVector<std::unique_ptr<CXLoadedDiagnostic>, 8> CurrentDiags;
+  /// The top-level diagnostic which is decoded lazily, if any.
+  std::unique_ptr<CXLoadedDiagnostic> *DecodedDiag = nullptr;
+  CXLoadedDiagnosticFilter Filter = nullptr;
+  CXClientData FilterData = nullptr;
 
   std::error_code reportBad(enum CXLoadDiag_Error code, llvm::StringRef err) {
     if (error)
@@ -202,6 +224,8 @@ class DiagLoader : serialized_diags::SerializedDiagnosticReader {
     return reportBad(CXLoadDiag_InvalidFile, err);
   }
 
+  void reportError(std::error_code EC);
+
   std::error_code readRange(const serialized_diags::Location &SDStart,
                             const serialized_diags::Location &SDEnd,
                             CXSourceRange &SR);
@@ -233,6 +257,11 @@ protected:
   visitSourceRangeRecord(const serialized_diags::Location &Start,
                          const serialized_diags::Location &End) override;
 
+  std::error_code visitIndexedDiagnostic(
+      uint64_t BitOffset, unsigned Severity,
+      const serialized_diags::Location &Location, unsigned Category,
+      unsigned Flag, StringRef Message) override;
+
 public:
   DiagLoader(enum CXLoadDiag_Error *e, CXString *es)
       : SerializedDiagnosticReader(), error(e), errorString(es) {
@@ -243,29 +272,101 @@ public:
   }
 
   CXDiagnosticSet load(const char *file);
+
+  /// Index the top-level diagnostics of \p file which \p filter selects,
+  /// which are decoded when they are accessed.
+  CXDiagnosticSet index(const char *file, CXLoadedDiagnosticFilter filter,
+                        CXClientData client_data);
+
+  /// Decode the top-level diagnostic at \p BitOffset into \p D.
+  void decode(uint64_t BitOffset, std::unique_ptr<CXLoadedDiagnostic> &D);
 };
 } // end anonymous namespace
 
+void DiagLoader::reportError(std::error_code EC) {
+  switch (EC.value()) {
+  case static_cast<int>(serialized_diags::SDError::HandlerFailed):
+    // We've already reported the problem.
+    break;
+  case static_cast<int>(serialized_diags::SDError::CouldNotLoad):
+    reportBad(CXLoadDiag_CannotLoad, EC.message());
+    break;
+  default:
+    reportInvalidFile(EC.message());
+    break;
+  }
+}
+
 CXDiagnosticSet DiagLoader::load(const char *file) {
-  TopDiags = std::make_unique<CXLoadedDiagnosticSetImpl>();
-
-  std::error_code EC = readDiagnostics(file);
-  if (EC) {
-    switch (EC.value()) {
-    case static_cast<int>(serialized_diags::SDError::HandlerFailed):
-      // We've already reported the problem.
-      break;
-    case static_cast<int>(serialized_diags::SDError::CouldNotLoad):
-      reportBad(CXLoadDiag_CannotLoad, EC.message());
-      break;
-    default:
-      reportInvalidFile(EC.message());
-      break;
-    }
+  auto Diags = std::make_unique<CXLoadedDiagnosticSetImpl>();
+  TopDiags = Diags.get();
+
+  if (std::error_code EC = readDiagnostics(file)) {
+    reportError(EC);
+    return nullptr;
+  }
+
+  return (CXDiagnosticSet)Diags.release();
+}
+
+CXDiagnosticSet DiagLoader::index(const char *file,
+                                  CXLoadedDiagnosticFilter filter,
+                                  CXClientData client_data) {
+  auto Diags = std::make_unique<CXLoadedDiagnosticSetImpl>();
+  TopDiags = Diags.get();
+  Filter = filter;
+  FilterData = client_data;
+
+  // The file is memory mapped if it is large enough, and the diagnostics are
+  // decoded from it.
+  auto Buffer = llvm::MemoryBuffer::getFile(file, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer) {
+    reportError(serialized_diags::SDError::CouldNotLoad);
     return nullptr;
   }
+  if (std::error_code EC = indexDiagnostics(**Buffer)) {
+    reportError(EC);
+    return nullptr;
+  }
+
+  Diags->Buffer = std::move(*Buffer);
+  Diags->DecodedDiagnostics.resize(Diags->DiagnosticOffsets.size());
+  // The loader outlives this call, and can't report the errors of the
+  // diagnostics which are decoded later.
+  error = nullptr;
+  errorString = nullptr;
+  return (CXDiagnosticSet)Diags.release();
+}
+
+void DiagLoader::decode(uint64_t BitOffset,
+                        std::unique_ptr<CXLoadedDiagnostic> &D) {
+  CurrentDiags.clear();
+  DecodedDiag = &D;
+  if (readDiagnosticAt(*TopDiags->Buffer, BitOffset))
+    D.reset();
+  DecodedDiag = nullptr;
+}
+
+CXLoadedDiagnosticSetImpl::CXLoadedDiagnosticSetImpl()
+    : CXDiagnosticSetImpl(true), FakeFiles(FO) {}
+
+CXLoadedDiagnosticSetImpl::~CXLoadedDiagnosticSetImpl() {}
+
+size_t CXLoadedDiagnosticSetImpl::getNumDiagnostics() const {
+  if (!LazyLoader)
+    return CXDiagnosticSetImpl::getNumDiagnostics();
+  return DiagnosticOffsets.size();
+}
 
-  return (CXDiagnosticSet)TopDiags.release();
+CXDiagnosticImpl *CXLoadedDiagnosticSetImpl::getDiagnostic(unsigned i) const {
+  if (!LazyLoader)
+    return CXDiagnosticSetImpl::getDiagnostic(i);
+  assert(i < DiagnosticOffsets.size());
+  std::unique_ptr<CXLoadedDiagnostic> &D = DecodedDiagnostics[i];
+  if (!D)
+    LazyLoader->decode(DiagnosticOffsets[i], D);
+  return D.get();
 }
 
 std::error_code
@@ -312,10 +413,12 @@ std::error_code DiagLoader::visitStartOfDiagnostic() {
 
 std::error_code DiagLoader::visitEndOfDiagnostic() {
   auto D = CurrentDiags.pop_back_val();
-  if (CurrentDiags.empty())
-    TopDiags->appendDiagnostic(std::move(D));
-  else
+  if (!CurrentDiags.empty())
     CurrentDiags.back()->getChildDiagnostics().appendDiagnostic(std::move(D));
+  else if (DecodedDiag)
+    *DecodedDiag = std::move(D);
+  else
+    TopDiags->appendDiagnostic(std::move(D));
   return std::error_code();
 }
 
@@ -323,6 +426,9 @@ std::error_code DiagLoader::visitCategoryRecord(unsigned ID, StringRef Name) {
   // FIXME: Why do we care about long strings?
   if (Name.size() > 65536)
     return reportInvalidFile("Out-of-bounds string in category");
+  // A lazily decoded diagnostic sees the records which were indexed again.
+  if (DecodedDiag && TopDiags->Categories.count(ID))
+    return std::error_code();
   TopDiags->Categories[ID] = TopDiags->copyString(Name);
   return std::error_code();
 }
@@ -331,6 +437,8 @@ std::error_code DiagLoader::visitDiagFlagRecord(unsigned ID, StringRef Name) {
   // FIXME: Why do we care about long strings?
   if (Name.size() > 65536)
     return reportInvalidFile("Out-of-bounds string in warning flag");
+  if (DecodedDiag && TopDiags->WarningFlags.count(ID))
+    return std::error_code();
   TopDiags->WarningFlags[ID] = TopDiags->copyString(Name);
   return std::error_code();
 }
@@ -341,6 +449,8 @@ std::error_code DiagLoader::visitFilenameRecord(unsigned ID, unsigned Size,
   // FIXME: Why do we care about long strings?
   if (Name.size() > 65536)
     return reportInvalidFile("Out-of-bounds string in filename");
+  if (DecodedDiag && TopDiags->FileNames.count(ID))
+    return std::error_code();
   TopDiags->FileNames[ID] = TopDiags->copyString(Name);
   TopDiags->Files[ID] =
       TopDiags->FakeFiles.getVirtualFile(Name, Size, Timestamp);
@@ -386,9 +496,40 @@ std::error_code DiagLoader::visitDiagnosticRecord(
   return std::error_code();
 }
 
+std::error_code DiagLoader::visitIndexedDiagnostic(
+    uint64_t BitOffset, unsigned Severity,
+    const serialized_diags::Location &Location, unsigned Category,
+    unsigned Flag, StringRef Message) {
+  if (Filter) {
+    const char *CategoryText =
+        Category ? TopDiags->Categories.lookup(Category) : nullptr;
+    const char *Option = Flag ? TopDiags->WarningFlags.lookup(Flag) : nullptr;
+    if (!Filter(getSeverityForLevel(Severity), Category,
+                CategoryText ? CategoryText : "", Option ? Option : "",
+                FilterData))
+      return std::error_code();
+  }
+  TopDiags->DiagnosticOffsets.push_back(BitOffset);
+  return std::error_code();
+}
+
 CXDiagnosticSet clang_loadDiagnostics(const char *file,
                                       enum CXLoadDiag_Error *error,
                                       CXString *errorString) {
   DiagLoader L(error, errorString);
   return L.load(file);
 }
+
+CXDiagnosticSet clang_loadDiagnosticsFiltered(const char *file,
+                                              CXLoadedDiagnosticFilter filter,
+                                              CXClientData client_data,
+                                              enum CXLoadDiag_Error *error,
+                                              CXString *errorString) {
+  auto L = std::make_unique<DiagLoader>(error, errorString);
+  auto *Diags =
+      static_cast<CXLoadedDiagnosticSetImpl *>(L->index(file, filter,
+                                                        client_data));
+  if (Diags)
+    Diags->LazyLoader = std::move(L);
+  return Diags;
+}
@@ -16,6 +16,7 @@
 #include "CLog.h"
 #include "CXString.h"
 #include "clang-c/Index.h"
+#include <atomic>
 
 namespace clang {
   class ASTUnit;
@@ -40,6 +41,10 @@ struct CXTargetInfoImpl {
   CXTranslationUnit TranslationUnit;
 };
 
+struct CXCancellationTokenImpl {
+  std::atomic<bool> Cancelled{false};
+};
+
 namespace clang {
 namespace cxtu {
 
@@ -60,6 +65,16 @@ static inline bool isNotUsableTU(CXTranslationUnit TU) {
   return !TU;
 }
 
+/// Makes the reparses and code completions of an ASTUnit stop once a
+/// cancellation token is cancelled, for the lifetime of this object.
+class CancellationScope {
+  ASTUnit &AU;
+
+public:
+  CancellationScope(ASTUnit &AU, CXCancellationToken Token);
+  ~CancellationScope();
+};
+
 #define LOG_BAD_TU(TU)                                  \
     do {                                                \
       LOG_FUNC_SECTION {                                \
@@ -14,6 +14,8 @@
 #include "Index_Internal.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/TypeLocVisitor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 
 namespace clang {
   class PreprocessingRecord;
@@ -21,6 +23,29 @@ namespace clang {
 
 namespace cxcursor {
 
+/// Orders source locations like SourceManager::isBeforeInTranslationUnit,
+/// but answers the comparisons with the locations of one file from the
+/// offsets in that file of the macro expansions and of the files it
+/// includes. The SourceManager caches the common ancestors of pairs of
+/// FileIDs, which thrashes when the other locations are in many different
+/// macro expansions, e.g. while annotating the tokens of a large file.
+class FileLocationOrder {
+  const SourceManager &SM;
+  FileID File;
+  /// The offset in File of each FileID which File includes or expands,
+  /// directly or not, or None for the FileIDs which are not in File.
+  mutable llvm::DenseMap<FileID, Optional<unsigned>> OffsetsInFile;
+
+  Optional<unsigned> getOffsetInFile(FileID FID) const;
+
+public:
+  FileLocationOrder(const SourceManager &SM, FileID File)
+      : SM(SM), File(File) {}
+
+  /// Determines whether \p L is before \p R in the translation unit.
+  bool isBefore(SourceLocation L, SourceLocation R) const;
+};
+
 class VisitorJob {
 public:
   enum Kind { DeclVisitKind, StmtVisitKind, MemberExprPartsKind,
@@ -91,6 +116,11 @@ private:
   /// its search.
   SourceRange RegionOfInterest;
 
+  /// The order of the locations, which is fast for the locations of the
+  /// file of the RegionOfInterest. Created by the first comparison with the
+  /// RegionOfInterest.
+  Optional<FileLocationOrder> RegionOrder;
+
   /// Whether we should only visit declarations and not preprocessing
   /// record entries.
   bool VisitDeclsOnly;
@@ -27,8 +27,15 @@
 #include "clang/Lex/PPConditionalDirectiveRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <atomic>
 #include <cstdio>
 #include <mutex>
 #include <utility>
@@ -444,7 +451,7 @@ static CXErrorCode clang_indexSourceFile_Impl(
     unsigned index_options, const char *source_filename,
     const char *const *command_line_args, int num_command_line_args,
     ArrayRef<CXUnsavedFile> unsaved_files, CXTranslationUnit *out_TU,
-    unsigned TU_options) {
+    unsigned TU_options, StringRef working_directory) {
   if (out_TU)
     *out_TU = nullptr;
   bool requestedToGetTU = (out_TU != nullptr);
@@ -507,12 +514,24 @@ static CXErrorCode clang_indexSourceFile_Impl(
   if (source_filename)
     Args->push_back(source_filename);
 
+  // The relative paths are resolved against the working directory without
+  // changing the one of the process, which other threads may be using.
+  IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS;
+  if (!working_directory.empty()) {
+    VFS = llvm::vfs::createPhysicalFileSystem().release();
+    if (VFS->setCurrentWorkingDirectory(working_directory))
+      return CXError_InvalidArguments;
+  }
+
   std::shared_ptr<CompilerInvocation> CInvok =
-      createInvocationFromCommandLine(*Args, Diags);
+      createInvocationFromCommandLine(*Args, Diags, VFS);
 
   if (!CInvok)
     return CXError_Failure;
 
+  if (!working_directory.empty())
+    CInvok->getFileSystemOpts().WorkingDir = working_directory;
+
   // Recover resources if we crash before exiting this function.
   llvm::CrashRecoveryContextCleanupRegistrar<
       std::shared_ptr<CompilerInvocation>,
@@ -880,13 +899,14 @@ int clang_indexSourceFile(CXIndexAction idxAction,
       num_unsaved_files, out_TU, TU_options);
 }
 
-int clang_indexSourceFileFullArgv(
+static int indexSourceFileFullArgv(
     CXIndexAction idxAction, CXClientData client_data,
     IndexerCallbacks *index_callbacks, unsigned index_callbacks_size,
     unsigned index_options, const char *source_filename,
     const char *const *command_line_args, int num_command_line_args,
     struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
-    CXTranslationUnit *out_TU, unsigned TU_options) {
+    CXTranslationUnit *out_TU, unsigned TU_options,
+    StringRef working_directory) {
   LOG_FUNC_SECTION {
     *Log << source_filename << ": ";
     for (int i = 0; i != num_command_line_args; ++i)
@@ -903,7 +923,7 @@ int clang_indexSourceFileFullArgv(
         index_options, source_filename, command_line_args,
         num_command_line_args,
         llvm::makeArrayRef(unsaved_files, num_unsaved_files), out_TU,
-        TU_options);
+        TU_options, working_directory);
   };
 
   llvm::CrashRecoveryContext CRC;
@@ -938,6 +958,198 @@ int clang_indexSourceFileFullArgv(
   return result;
 }
 
+int clang_indexSourceFileFullArgv(
+    CXIndexAction idxAction, CXClientData client_data,
+    IndexerCallbacks *index_callbacks, unsigned index_callbacks_size,
+    unsigned index_options, const char *source_filename,
+    const char *const *command_line_args, int num_command_line_args,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    CXTranslationUnit *out_TU, unsigned TU_options) {
+  return indexSourceFileFullArgv(
+      idxAction, client_data, index_callbacks, index_callbacks_size,
+      index_options, source_filename, command_line_args, num_command_line_args,
+      unsaved_files, num_unsaved_files, out_TU, TU_options,
+      /*working_directory=*/StringRef());
+}
+
+namespace {
+
+/// The state of clang_indexCompilationDatabase which the worker threads share.
+/// The callbacks of the translation units pass the records on to the client,
+/// one at a time, and drop the declarations and references it was already
+/// given by another translation unit.
+struct ProjectIndexingData {
+  std::mutex Mutex;
+  IndexerCallbacks ClientCB;
+  CXClientData ClientData;
+  llvm::StringSet<> ReportedRecords;
+
+  /// Returns false if the record of \p Kind at \p Loc for \p Entity was
+  /// already reported. Is called with \c Mutex held.
+  bool isNewRecord(char Kind, CXIdxLoc Loc, const CXIdxEntityInfo *Entity,
+                   bool IsDefinition) {
+    CXFile File;
+    unsigned Offset;
+    CXFileUniqueID ID;
+    clang_indexLoc_getFileLocation(Loc, /*indexFile=*/nullptr, &File,
+                                   /*line=*/nullptr, /*column=*/nullptr,
+                                   &Offset);
+    if (!File || clang_getFileUniqueID(File, &ID) != 0)
+      return true;
+    SmallString<128> Key;
+    llvm::raw_svector_ostream OS(Key);
+    OS << Kind << IsDefinition << ':' << ID.data[0] << ':' << ID.data[1]
+       << ':' << ID.data[2] << ':' << Offset << ':'
+       << (Entity && Entity->USR ? Entity->USR : "");
+    return ReportedRecords.insert(OS.str()).second;
+  }
+};
+
+} // anonymous namespace
+
+static ProjectIndexingData &getProjectData(CXClientData client_data) {
+  return *static_cast<ProjectIndexingData *>(client_data);
+}
+
+static int projectAbortQuery(CXClientData client_data, void *reserved) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  return Data.ClientCB.abortQuery(Data.ClientData, reserved);
+}
+
+static void projectDiagnostic(CXClientData client_data,
+                              CXDiagnosticSet Diagnostics, void *reserved) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  Data.ClientCB.diagnostic(Data.ClientData, Diagnostics, reserved);
+}
+
+static CXIdxClientFile projectEnteredMainFile(CXClientData client_data,
+                                              CXFile MainFile,
+                                              void *reserved) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  return Data.ClientCB.enteredMainFile(Data.ClientData, MainFile, reserved);
+}
+
+static CXIdxClientFile
+projectPPIncludedFile(CXClientData client_data,
+                      const CXIdxIncludedFileInfo *Info) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  return Data.ClientCB.ppIncludedFile(Data.ClientData, Info);
+}
+
+static CXIdxClientASTFile
+projectImportedASTFile(CXClientData client_data,
+                       const CXIdxImportedASTFileInfo *Info) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  return Data.ClientCB.importedASTFile(Data.ClientData, Info);
+}
+
+static CXIdxClientContainer projectStartedTranslationUnit(
+    CXClientData client_data, void *reserved) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  return Data.ClientCB.startedTranslationUnit(Data.ClientData, reserved);
+}
+
+static void projectIndexDeclaration(CXClientData client_data,
+                                    const CXIdxDeclInfo *Info) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  if (Data.isNewRecord('D', Info->loc, Info->entityInfo, Info->isDefinition))
+    Data.ClientCB.indexDeclaration(Data.ClientData, Info);
+}
+
+static void projectIndexEntityReference(CXClientData client_data,
+                                        const CXIdxEntityRefInfo *Info) {
+  ProjectIndexingData &Data = getProjectData(client_data);
+  std::lock_guard<std::mutex> Lock(Data.Mutex);
+  if (Data.isNewRecord('R', Info->loc, Info->referencedEntity,
+                       /*IsDefinition=*/false))
+    Data.ClientCB.indexEntityReference(Data.ClientData, Info);
+}
+
+int clang_indexCompilationDatabase(CXIndexAction idxAction,
+                                   CXClientData client_data,
+                                   IndexerCallbacks *index_callbacks,
+                                   unsigned index_callbacks_size,
+                                   unsigned index_options,
+                                   CXCompilationDatabase database,
+                                   unsigned TU_options, unsigned num_threads) {
+  if (!idxAction || !database)
+    return CXError_InvalidArguments;
+  if (!index_callbacks || index_callbacks_size == 0)
+    return CXError_InvalidArguments;
+
+  ProjectIndexingData Data;
+  memset(&Data.ClientCB, 0, sizeof(Data.ClientCB));
+  memcpy(&Data.ClientCB, index_callbacks,
+         std::min<size_t>(index_callbacks_size, sizeof(Data.ClientCB)));
+  Data.ClientData = client_data;
+
+  // Only the callbacks of the client are set, as the indexer does less work
+  // for the ones which are not.
+  IndexerCallbacks CB;
+  memset(&CB, 0, sizeof(CB));
+  const IndexerCallbacks &ClientCB = Data.ClientCB;
+  if (ClientCB.abortQuery)
+    CB.abortQuery = projectAbortQuery;
+  if (ClientCB.diagnostic)
+    CB.diagnostic = projectDiagnostic;
+  if (ClientCB.enteredMainFile)
+    CB.enteredMainFile = projectEnteredMainFile;
+  if (ClientCB.ppIncludedFile)
+    CB.ppIncludedFile = projectPPIncludedFile;
+  if (ClientCB.importedASTFile)
+    CB.importedASTFile = projectImportedASTFile;
+  if (ClientCB.startedTranslationUnit)
+    CB.startedTranslationUnit = projectStartedTranslationUnit;
+  if (ClientCB.indexDeclaration)
+    CB.indexDeclaration = projectIndexDeclaration;
+  if (ClientCB.indexEntityReference)
+    CB.indexEntityReference = projectIndexEntityReference;
+
+  std::vector<tooling::CompileCommand> Commands =
+      static_cast<tooling::CompilationDatabase *>(database)
+          ->getAllCompileCommands();
+  if (Commands.empty())
+    return CXError_Success;
+
+  std::atomic<bool> Failed(false);
+  auto IndexCommand = [&](const tooling::CompileCommand &Command) {
+    SmallString<128> Directory(Command.Directory);
+    llvm::sys::fs::make_absolute(Directory);
+    std::vector<const char *> Args;
+    for (const std::string &Arg : Command.CommandLine)
+      Args.push_back(Arg.c_str());
+    int Result = indexSourceFileFullArgv(
+        idxAction, &Data, &CB, sizeof(CB),
+        index_options | CXIndexOpt_SkipParsedBodiesInSession,
+        /*source_filename=*/nullptr, Args.data(), Args.size(),
+        /*unsaved_files=*/nullptr, /*num_unsaved_files=*/0,
+        /*out_TU=*/nullptr, TU_options, Directory);
+    if (Result != CXError_Success)
+      Failed = true;
+  };
+
+  unsigned Threads =
+      num_threads ? num_threads : llvm::heavyweight_hardware_concurrency();
+  Threads = std::min<size_t>(Threads, Commands.size());
+  if (Threads <= 1) {
+    for (const tooling::CompileCommand &Command : Commands)
+      IndexCommand(Command);
+  } else {
+    llvm::ThreadPool Pool(Threads);
+    for (const tooling::CompileCommand &Command : Commands)
+      Pool.async([&IndexCommand, &Command] { IndexCommand(Command); });
+    Pool.wait();
+  }
+  return Failed ? CXError_Failure : CXError_Success;
+}
+
 int clang_indexTranslationUnit(CXIndexAction idxAction,
                                CXClientData client_data,
                                IndexerCallbacks *index_callbacks,
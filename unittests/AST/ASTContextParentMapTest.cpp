@@ -105,6 +105,27 @@ TEST(GetParents, RespectsTraversalScope) {
   EXPECT_THAT(Ctx.getParents(Foo), ElementsAre(DynTypedNode::create(TU)));
 }
 
+TEST(GetParents, SharesTypeLocParentBetweenChildren) {
+  auto AST = tooling::buildASTFromCode("void f(int a, int b);");
+  auto &Ctx = AST->getASTContext();
+  auto Params = match(parmVarDecl().bind("p"), Ctx);
+  ASSERT_EQ(2u, Params.size());
+  const auto *A = Params[0].getNodeAs<ParmVarDecl>("p");
+  const auto *B = Params[1].getNodeAs<ParmVarDecl>("p");
+
+  auto ParentsOfA = Ctx.getParents(*A);
+  auto ParentsOfB = Ctx.getParents(*B);
+  ASSERT_EQ(1u, ParentsOfA.size());
+  ASSERT_EQ(1u, ParentsOfB.size());
+  const auto *Loc = ParentsOfA[0].get<TypeLoc>();
+  ASSERT_TRUE(Loc);
+  EXPECT_FALSE(Loc->getAs<FunctionProtoTypeLoc>().isNull());
+  EXPECT_EQ(ParentsOfA[0], ParentsOfB[0]);
+  const auto *F = cast<FunctionDecl>(A->getDeclContext());
+  EXPECT_THAT(Ctx.getParents(ParentsOfA[0]),
+              ElementsAre(ast_type_traits::DynTypedNode::create(*F)));
+}
+
 TEST(GetParents, ImplicitLambdaNodes) {
   MatchVerifier<Decl> LambdaVerifier;
   EXPECT_TRUE(LambdaVerifier.match(
@@ -1654,6 +1654,27 @@ TEST_P(ASTImporterOptionSpecificTestBase,
   }
 }
 
+TEST_P(ASTImporterOptionSpecificTestBase,
+       EquivalentDeclsAreSharedBetweenImporters) {
+  Decl *ToTU = getToTuDecl("struct A { int i; }; struct B { A *a; };",
+                           Lang_CXX);
+  Decl *FromTU = getTuDecl("struct A { int i; }; struct B { A *a; };",
+                           Lang_CXX, "input0.cc");
+  auto *FromB = FirstDeclMatcher<CXXRecordDecl>().match(
+      FromTU, cxxRecordDecl(hasName("B")));
+  auto *ToB = FirstDeclMatcher<CXXRecordDecl>().match(
+      ToTU, cxxRecordDecl(hasName("B")));
+  EXPECT_EQ(ToB, Import(FromB, Lang_CXX));
+
+  auto *FromA = FirstDeclMatcher<CXXRecordDecl>().match(
+      FromTU, cxxRecordDecl(hasName("A")));
+  auto *ToA = FirstDeclMatcher<CXXRecordDecl>().match(
+      ToTU, cxxRecordDecl(hasName("A")));
+  const auto &EquivalentDecls = SharedStatePtr->getEquivalentDecls();
+  EXPECT_TRUE(EquivalentDecls.count({FromB, ToB}));
+  EXPECT_TRUE(EquivalentDecls.count({FromA, ToA}));
+}
+
 TEST_P(ASTImporterOptionSpecificTestBase,
        ImportDefinitionOfClassTemplateIfThereIsAnExistingFwdDeclAndDefinition) {
   Decl *ToTU = getToTuDecl(
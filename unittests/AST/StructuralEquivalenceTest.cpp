@@ -1275,6 +1275,7 @@ TEST_F(
 }
 struct StructuralEquivalenceCacheTest : public StructuralEquivalenceTest {
   llvm::DenseSet<std::pair<Decl *, Decl *>> NonEquivalentDecls;
+  llvm::DenseSet<std::pair<Decl *, Decl *>> EquivalentDecls;
 
   template <typename NodeType, typename MatcherType>
   std::pair<NodeType *, NodeType *>
@@ -1289,6 +1290,11 @@ struct StructuralEquivalenceCacheTest : public StructuralEquivalenceTest {
   bool isInNonEqCache(std::pair<NodeType *, NodeType *> D) {
     return NonEquivalentDecls.count(D) > 0;
   }
+
+  template <typename NodeType>
+  bool isInEqCache(std::pair<NodeType *, NodeType *> D) {
+    return EquivalentDecls.count(D) > 0;
+  }
 };
 
 TEST_F(StructuralEquivalenceCacheTest, SimpleNonEq) {
@@ -1396,5 +1402,42 @@ TEST_F(StructuralEquivalenceCacheTest, Cycle) {
       findDeclPair<FunctionDecl>(TU, functionDecl(hasName("x")))));
 }
 
+TEST_F(StructuralEquivalenceCacheTest, Eq) {
+  auto TU = makeTuDecls(
+      R"(
+      class A { int i; };
+      class B;
+      void x(A *, B *);
+      void y(A *);
+      )",
+      R"(
+      class A { int i; };
+      class B;
+      void x(A *, B *);
+      void y(A *);
+      )",
+      Lang_CXX);
+
+  auto X = findDeclPair<FunctionDecl>(TU, functionDecl(hasName("x")));
+  auto Y = findDeclPair<FunctionDecl>(TU, functionDecl(hasName("y")));
+  auto A = findDeclPair<CXXRecordDecl>(
+      TU, cxxRecordDecl(hasName("A"), unless(isImplicit())));
+  for (auto P : {X, Y}) {
+    StructuralEquivalenceContext Ctx(
+        get<0>(TU)->getASTContext(), get<1>(TU)->getASTContext(),
+        NonEquivalentDecls, StructuralEquivalenceKind::Default, false, false);
+    Ctx.EquivalentDecls = &EquivalentDecls;
+    EXPECT_TRUE(Ctx.IsEquivalent(P.first, P.second));
+  }
+
+  // B isn't defined, so x may not be equivalent anymore once it is.
+  EXPECT_FALSE(isInEqCache(X));
+  EXPECT_FALSE(isInEqCache(findDeclPair<CXXRecordDecl>(
+      TU, cxxRecordDecl(hasName("B"), unless(isImplicit())))));
+  EXPECT_TRUE(isInEqCache(Y));
+  EXPECT_TRUE(isInEqCache(A));
+  EXPECT_TRUE(NonEquivalentDecls.empty());
+}
+
 } // end namespace ast_matchers
 } // end namespace clang
@@ -163,6 +163,62 @@ TEST(MatchFinder, InterceptsEndOfTranslationUnit) {
   EXPECT_TRUE(VerifyCallback.Called);
 }
 
+class RecordMatchOrder : public MatchFinder::MatchCallback {
+public:
+  RecordMatchOrder(std::vector<std::string> &Matches, StringRef ID)
+      : Matches(Matches), ID(ID) {}
+  void run(const MatchFinder::MatchResult &Result) override {
+    const auto *ND = Result.Nodes.getNodeAs<NamedDecl>("d");
+    Matches.push_back(ID + ":" + ND->getNameAsString());
+  }
+  std::vector<std::string> &Matches;
+  std::string ID;
+};
+
+TEST(MatchFinder, FiltersMatchersByRequiredName) {
+  std::vector<std::string> Matches;
+  RecordMatchOrder ByName(Matches, "name"), AnyName(Matches, "any"),
+      Any(Matches, "all"), Qualified(Matches, "qualified"),
+      Ctor(Matches, "ctor");
+  MatchFinder Finder;
+  Finder.addMatcher(functionDecl(hasName("f")).bind("d"), &ByName);
+  Finder.addMatcher(
+      functionDecl(anyOf(hasName("g"), hasName("n::f"))).bind("d"), &AnyName);
+  Finder.addMatcher(functionDecl(unless(hasName("g"))).bind("d"), &Any);
+  Finder.addMatcher(functionDecl(hasName("::n::f")).bind("d"), &Qualified);
+  Finder.addMatcher(cxxConstructorDecl(hasName("S")).bind("d"), &Ctor);
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(
+      "void f(); void g(); namespace n { void f(); }"
+      "struct S { S(); };"));
+  ASSERT_TRUE(AST.get());
+  Finder.matchAST(AST->getASTContext());
+  EXPECT_EQ((std::vector<std::string>{"name:f", "all:f", "any:g", "name:f",
+                                      "any:f", "all:f", "qualified:f",
+                                      "all:S", "ctor:S"}),
+            Matches);
+}
+
+TEST(MatchFinder, AddsMatchersOfOtherFinders) {
+  std::vector<std::string> Matches;
+  RecordMatchOrder FirstFunctions(Matches, "first"),
+      SecondFunctions(Matches, "second"), SecondVars(Matches, "var");
+  MatchFinder First, Second;
+  First.addMatcher(functionDecl().bind("d"), &FirstFunctions);
+  Second.addMatcher(functionDecl(hasName("g")).bind("d"), &SecondFunctions);
+  Second.addMatcher(varDecl().bind("d"), &SecondVars);
+
+  MatchFinder Finder;
+  Finder.addMatchers(First);
+  Finder.addMatchers(Second);
+  std::unique_ptr<ASTUnit> AST(
+      tooling::buildASTFromCode("void f(); int x; void g();"));
+  ASSERT_TRUE(AST.get());
+  Finder.matchAST(AST->getASTContext());
+  EXPECT_EQ((std::vector<std::string>{"first:f", "var:x", "first:g",
+                                      "second:g"}),
+            Matches);
+}
+
 TEST(Matcher, matchOverEntireASTContext) {
   std::unique_ptr<ASTUnit> AST =
       clang::tooling::buildASTFromCode("struct { int *foo; };");
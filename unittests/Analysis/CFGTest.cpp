@@ -200,6 +200,35 @@ TEST(CFG, ElementRefIterator) {
   EXPECT_EQ(++(CMainBlock->rref_begin()), CMainBlock->rref_begin() + 1);
 }
 
+// A switch has a successor for each of its cases, and the default one last.
+TEST(CFG, SwitchWithManyCases) {
+  constexpr unsigned NumCases = 1000;
+  std::string Code = "int f(int x) {\n  switch (x) {\n";
+  for (unsigned I = 0; I != NumCases; ++I)
+    Code += "  case " + std::to_string(I) + ": return " +
+            std::to_string(I) + ";\n";
+  Code += "  }\n  return -1;\n}\n";
+
+  BuildResult B = BuildCFG(Code.c_str());
+  EXPECT_EQ(BuildResult::BuiltCFG, B.getStatus());
+
+  const CFGBlock *SwitchBlock = nullptr;
+  for (const CFGBlock *Block : *B.getCFG())
+    if (Block->getTerminatorStmt() &&
+        isa<SwitchStmt>(Block->getTerminatorStmt()))
+      SwitchBlock = Block;
+  ASSERT_TRUE(SwitchBlock);
+  ASSERT_EQ(NumCases + 1, SwitchBlock->succ_size());
+
+  for (unsigned I = 0; I != NumCases; ++I) {
+    const CFGBlock *CaseBlock = *(SwitchBlock->succ_begin() + I);
+    ASSERT_TRUE(CaseBlock);
+    EXPECT_TRUE(isa_and_nonnull<CaseStmt>(CaseBlock->getLabel()));
+  }
+  EXPECT_FALSE(isa_and_nonnull<CaseStmt>(
+      (*(SwitchBlock->succ_end() - 1))->getLabel()));
+}
+
 } // namespace
 } // namespace analysis
 } // namespace clang
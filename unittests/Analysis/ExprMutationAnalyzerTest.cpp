@@ -1258,4 +1258,38 @@ TEST(ExprMutationAnalyzerTest, ReproduceFailureMinimal) {
       match(withEnclosingCompound(declRefTo("x")), AST11->getASTContext());
   EXPECT_FALSE(isMutated(Results11, AST11.get()));
 }
+
+TEST(ExprMutationAnalyzerTest, ManyDeclsOfOneStmt) {
+  const auto AST = buildASTFromCode(
+      "struct A { int m; void mf(); void cmf() const; };"
+      "void g(int &); void h(const int &);"
+      "void f() {"
+      "  int a = 0, b = 0, c = 0, d = 0, e = 0; A s, t;"
+      "  a = 1; h(b); g(c); int &r = d; r++; (void)sizeof(e = 1);"
+      "  s.mf(); t.cmf(); int x = b + e;"
+      "}");
+  const auto Results =
+      match(functionDecl(hasName("f"), hasBody(stmt().bind("body"))),
+            AST->getASTContext());
+  const auto *Body = selectFirst<Stmt>("body", Results);
+  // One analyzer answers all the queries about the body.
+  ExprMutationAnalyzer Analyzer(*Body, AST->getASTContext());
+  const auto isDeclMutated = [&](StringRef Name) {
+    const auto *D = selectFirst<VarDecl>(
+        "decl", match(varDecl(hasName(Name)).bind("decl"),
+                      AST->getASTContext()));
+    return Analyzer.isMutated(D);
+  };
+  EXPECT_TRUE(isDeclMutated("a"));
+  EXPECT_FALSE(isDeclMutated("b"));
+  EXPECT_TRUE(isDeclMutated("c"));
+  EXPECT_TRUE(isDeclMutated("d"));
+  EXPECT_FALSE(isDeclMutated("e"));
+  EXPECT_TRUE(isDeclMutated("s"));
+  EXPECT_FALSE(isDeclMutated("t"));
+  EXPECT_FALSE(isDeclMutated("x"));
+  // The answers do not change when asked again.
+  EXPECT_TRUE(isDeclMutated("a"));
+  EXPECT_FALSE(isDeclMutated("b"));
+}
 } // namespace clang
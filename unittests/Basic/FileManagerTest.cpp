@@ -10,6 +10,7 @@
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/FileSystemStatCache.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "gtest/gtest.h"
@@ -447,4 +448,35 @@ TEST_F(FileManagerTest, getBypassFile) {
   EXPECT_EQ(*expectedToOptional(Manager.getFileRef("/tmp/test")), Ref);
 }
 
+TEST_F(FileManagerTest, sharedStatCacheIsUsedByAllManagers) {
+  auto FS = IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>(
+      new llvm::vfs::InMemoryFileSystem);
+  FS->addFile("/tmp/a.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+
+  SharedFileSystemStatCache SharedCache;
+  FileSystemOptions Opts;
+  FileManager First(Opts, FS);
+  First.setStatCache(SharedCache.createStatCache());
+  ASSERT_TRUE(First.getFile("/tmp/a.h"));
+  ASSERT_FALSE(First.getFile("/tmp/b.h"));
+
+  ASSERT_TRUE(SharedCache.lookup("/tmp/a.h"));
+  EXPECT_TRUE(*SharedCache.lookup("/tmp/a.h"));
+  ASSERT_TRUE(SharedCache.lookup("/tmp/b.h"));
+  EXPECT_FALSE(*SharedCache.lookup("/tmp/b.h"));
+
+  // The file system is assumed not to change, so a second manager sees the
+  // cached results rather than the new file.
+  FS->addFile("/tmp/b.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  FileManager Second(Opts, FS);
+  Second.setStatCache(SharedCache.createStatCache());
+  EXPECT_TRUE(Second.getFile("/tmp/a.h"));
+  EXPECT_FALSE(Second.getFile("/tmp/b.h"));
+
+  SharedCache.clear();
+  FileManager Third(Opts, FS);
+  Third.setStatCache(SharedCache.createStatCache());
+  EXPECT_TRUE(Third.getFile("/tmp/b.h"));
+}
+
 } // anonymous namespace
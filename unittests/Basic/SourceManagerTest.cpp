@@ -152,6 +152,38 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getFileIDWithManyEntries) {
+  // Interleave files and macro expansions, and query them out of order, so
+  // that the lookups go through the cache of recent files and through the
+  // binary search.
+  std::vector<FileID> Files;
+  std::vector<SourceLocation> Expansions;
+  for (unsigned I = 0; I != 200; ++I) {
+    std::unique_ptr<llvm::MemoryBuffer> Buf =
+        llvm::MemoryBuffer::getMemBufferCopy(std::string(I % 7 + 1, 'x'));
+    FileID FID = SourceMgr.createFileID(std::move(Buf));
+    Files.push_back(FID);
+    SourceLocation Start = SourceMgr.getLocForStartOfFile(FID);
+    Expansions.push_back(SourceMgr.createExpansionLoc(
+        Start, Start, Start.getLocWithOffset(1), 1));
+  }
+
+  for (unsigned Round = 0; Round != 3; ++Round) {
+    for (unsigned I = 0, E = Files.size(); I != E; ++I) {
+      unsigned Index = (I * 37 + Round * (I % 3)) % E;
+      FileID FID = Files[Index];
+      SourceLocation Start = SourceMgr.getLocForStartOfFile(FID);
+      SourceLocation End = SourceMgr.getLocForEndOfFile(FID);
+      for (SourceLocation Loc = Start; Loc != End.getLocWithOffset(1);
+           Loc = Loc.getLocWithOffset(1))
+        EXPECT_EQ(FID, SourceMgr.getFileID(Loc));
+      EXPECT_EQ(Start, SourceMgr.getImmediateSpellingLoc(Expansions[Index]));
+      EXPECT_EQ(FID, SourceMgr.getFileID(SourceMgr.getImmediateSpellingLoc(
+                         Expansions[Index].getLocWithOffset(1))));
+    }
+  }
+}
+
 TEST_F(SourceManagerTest, locationPrintTest) {
   const char *header = "#define IDENTITY(x) x\n";
 
@@ -200,6 +232,50 @@ TEST_F(SourceManagerTest, locationPrintTest) {
             "</mainFile.cpp:1:1, /test-header.h:1:1>");
 }
 
+TEST_F(SourceManagerTest, evictFileBuffers) {
+  std::string Large = std::string(64, ' ') + "int large;\n";
+  std::string Small = "int small;\n";
+  std::string Overridden = std::string(64, ' ') + "int overridden;\n";
+
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> FS(
+      new llvm::vfs::InMemoryFileSystem);
+  FS->addFile("/large.h", 0, llvm::MemoryBuffer::getMemBuffer(Large));
+  FS->addFile("/small.h", 0, llvm::MemoryBuffer::getMemBuffer(Small));
+  FileManager FM(FileMgrOpts, FS);
+  SourceManager SM(Diags, FM);
+
+  const FileEntry *LargeFile = *FM.getFile("/large.h");
+  const FileEntry *SmallFile = *FM.getFile("/small.h");
+  const FileEntry *OverriddenFile =
+      FM.getVirtualFile("/overridden.h", Overridden.size(), 0);
+  SM.overrideFileContents(OverriddenFile,
+                          llvm::MemoryBuffer::getMemBuffer(Overridden));
+
+  FileID LargeID = SM.getOrCreateFileID(LargeFile, SrcMgr::C_User);
+  FileID SmallID = SM.getOrCreateFileID(SmallFile, SrcMgr::C_User);
+  FileID OverriddenID = SM.getOrCreateFileID(OverriddenFile, SrcMgr::C_User);
+  EXPECT_EQ(Large, SM.getBufferData(LargeID));
+  EXPECT_EQ(Small, SM.getBufferData(SmallID));
+  EXPECT_EQ(Overridden, SM.getBufferData(OverriddenID));
+
+  // Nothing is freed without a budget.
+  EXPECT_EQ(0u, SM.evictFileBuffers());
+
+  // The overridden buffer can't be read again, so only the largest file is
+  // freed.
+  SM.setFileBufferBudget(Overridden.size() + Small.size());
+  EXPECT_EQ(1u, SM.evictFileBuffers());
+  EXPECT_EQ(nullptr, SM.getSLocEntry(LargeID).getFile().getContentCache()
+                         ->getRawBuffer());
+  EXPECT_EQ(0u, SM.evictFileBuffers());
+
+  // The freed buffer is read again when it is needed.
+  bool Invalid = false;
+  EXPECT_EQ(Large, SM.getBufferData(LargeID, &Invalid));
+  EXPECT_FALSE(Invalid);
+  EXPECT_EQ(2u, SM.getLineNumber(LargeID, Large.size()));
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
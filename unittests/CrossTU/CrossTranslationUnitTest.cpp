@@ -12,6 +12,7 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "gtest/gtest.h"
@@ -193,5 +194,78 @@ TEST(CrossTranslationUnit, CTUDirIsHandledCorrectly) {
   EXPECT_EQ(ParsedIndex["a"], "/ctudir/b/c/d");
 }
 
+TEST(CrossTranslationUnit, BinaryIndexCanBeLookedUp) {
+  llvm::StringMap<std::string> Index;
+  Index["a"] = "b/f1";
+  Index["c"] = "d/f2";
+  Index["e"] = "b/f1";
+
+  int IndexFD;
+  llvm::SmallString<256> IndexFileName;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("index", "bin", IndexFD,
+                                                  IndexFileName));
+  llvm::ToolOutputFile IndexFile(IndexFileName, IndexFD);
+  CrossTUBinaryIndex::write(Index, IndexFile.os());
+  IndexFile.os().close();
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(IndexFileName, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  ASSERT_TRUE((bool)Buffer);
+  EXPECT_TRUE(CrossTUBinaryIndex::isBinaryIndex((*Buffer)->getBuffer()));
+  llvm::Expected<std::unique_ptr<CrossTUBinaryIndex>> IndexOrErr =
+      CrossTUBinaryIndex::create(std::move(*Buffer), "/ctudir");
+  ASSERT_TRUE((bool)IndexOrErr);
+  const CrossTUBinaryIndex &BinaryIndex = **IndexOrErr;
+  for (const auto &E : Index) {
+    llvm::Optional<StringRef> File = BinaryIndex.lookup(E.getKey());
+    ASSERT_TRUE(File.hasValue());
+    EXPECT_EQ(*File, "/ctudir/" + E.getValue());
+  }
+  EXPECT_FALSE(BinaryIndex.lookup("f").hasValue());
+}
+
+TEST(CrossTranslationUnit, CompilationDatabaseCanBeParsed) {
+  int DatabaseFD;
+  llvm::SmallString<256> DatabaseFileName;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("compile_commands", "json",
+                                                  DatabaseFD, DatabaseFileName));
+  llvm::ToolOutputFile DatabaseFile(DatabaseFileName, DatabaseFD);
+  DatabaseFile.os() << R"([{"directory": "/b", "file": "c/f1.c",)"
+                    << R"(  "arguments": ["cc", "-c", "c/f1.c"]},)"
+                    << R"( {"directory": "/d", "file": "/e/f2.c",)"
+                    << R"(  "command": "cc -DX='a b' /e/f2.c"},)"
+                    << R"( {"directory": "/g", "file": "/e/f2.c",)"
+                    << R"(  "command": "cc -c /e/f2.c"}])";
+  DatabaseFile.os().flush();
+  llvm::Expected<llvm::StringMap<std::vector<std::string>>> DatabaseOrErr =
+      parseCrossTUCompilationDatabase(DatabaseFileName);
+  ASSERT_TRUE((bool)DatabaseOrErr);
+  llvm::StringMap<std::vector<std::string>> Commands = DatabaseOrErr.get();
+  EXPECT_EQ(Commands.size(), 2u);
+  EXPECT_EQ(Commands["/b/c/f1.c"],
+            (std::vector<std::string>{"cc", "-working-directory=/b", "-c",
+                                      "c/f1.c"}));
+  EXPECT_EQ(Commands["/e/f2.c"],
+            (std::vector<std::string>{"cc", "-working-directory=/d", "-DX=a b",
+                                      "/e/f2.c"}));
+}
+
+TEST(CrossTranslationUnit, InvalidCompilationDatabaseIsDiagnosed) {
+  int DatabaseFD;
+  llvm::SmallString<256> DatabaseFileName;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("compile_commands", "json",
+                                                  DatabaseFD, DatabaseFileName));
+  llvm::ToolOutputFile DatabaseFile(DatabaseFileName, DatabaseFD);
+  DatabaseFile.os() << R"({"directory": "/b", "file": "f1.c"})";
+  DatabaseFile.os().flush();
+  llvm::Expected<llvm::StringMap<std::vector<std::string>>> DatabaseOrErr =
+      parseCrossTUCompilationDatabase(DatabaseFileName);
+  ASSERT_FALSE((bool)DatabaseOrErr);
+  llvm::handleAllErrors(DatabaseOrErr.takeError(), [](const IndexError &IE) {
+    EXPECT_EQ(IE.getCode(), index_error_code::invalid_compilation_database);
+  });
+}
+
 } // end namespace cross_tu
 } // end namespace clang
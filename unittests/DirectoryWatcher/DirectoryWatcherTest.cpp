@@ -76,6 +76,12 @@ struct DirectoryWatcherTestFixture {
     }
   }
 
+  void addDirectory(const std::string &testDir) {
+    std::error_code EC =
+        create_directory(getPathInWatched(testDir), /*IgnoreExisting=*/false);
+    ASSERT_FALSE(EC);
+  }
+
   void deleteFile(const std::string &testFile) {
     std::error_code EC =
         remove(getPathInWatched(testFile), /*IgnoreNonExisting=*/false);
@@ -449,3 +455,101 @@ TEST(DirectoryWatcherTest, InvalidatedWatcher) {
 
   checkEventualResultWithTimeout(TestConsumer);
 }
+
+TEST(DirectoryWatcherTest, RecursiveInitialScan) {
+  DirectoryWatcherTestFixture fixture;
+
+  fixture.addFile("a");
+  fixture.addDirectory("sub");
+  fixture.addFile("sub/b");
+  fixture.addDirectory("sub/subsub");
+  fixture.addFile("sub/subsub/c");
+
+  VerifyingConsumer TestConsumer{
+      {{EventKind::Modified, "a"},
+       {EventKind::Modified, "sub/b"},
+       {EventKind::Modified, "sub/subsub/c"}},
+      {},
+      {{EventKind::Modified, "a"},
+       {EventKind::Modified, "sub/b"},
+       {EventKind::Modified, "sub/subsub/c"}}};
+
+  llvm::Expected<std::unique_ptr<DirectoryWatcher>> DW =
+      DirectoryWatcher::create(
+          fixture.TestWatchedDir,
+          [&TestConsumer](llvm::ArrayRef<DirectoryWatcher::Event> Events,
+                          bool IsInitial) {
+            TestConsumer.consume(Events, IsInitial);
+          },
+          /*waitForInitialSync=*/true, /*Recursive=*/true);
+  ASSERT_THAT_ERROR(DW.takeError(), Succeeded());
+
+  checkEventualResultWithTimeout(TestConsumer);
+}
+
+TEST(DirectoryWatcherTest, RecursiveAddFiles) {
+  DirectoryWatcherTestFixture fixture;
+
+  fixture.addDirectory("sub");
+
+  VerifyingConsumer TestConsumer{
+      {},
+      {{EventKind::Modified, "sub/a"},
+       {EventKind::Modified, "new/b"},
+       {EventKind::Modified, "new/newsub/c"}},
+      // The files of a new directory can be found both by the scan of the
+      // directory and by its watch.
+      {{EventKind::Modified, "new/b"},
+       {EventKind::Modified, "new/newsub/c"}}};
+
+  llvm::Expected<std::unique_ptr<DirectoryWatcher>> DW =
+      DirectoryWatcher::create(
+          fixture.TestWatchedDir,
+          [&TestConsumer](llvm::ArrayRef<DirectoryWatcher::Event> Events,
+                          bool IsInitial) {
+            TestConsumer.consume(Events, IsInitial);
+          },
+          /*waitForInitialSync=*/true, /*Recursive=*/true);
+  ASSERT_THAT_ERROR(DW.takeError(), Succeeded());
+
+  fixture.addFile("sub/a");
+  fixture.addDirectory("new");
+  fixture.addFile("new/b");
+  fixture.addDirectory("new/newsub");
+  fixture.addFile("new/newsub/c");
+
+  checkEventualResultWithTimeout(TestConsumer);
+}
+
+TEST(DirectoryWatcherTest, RecursiveMoveDirectoryOut) {
+  DirectoryWatcherTestFixture fixture;
+
+  fixture.addDirectory("sub");
+  fixture.addFile("sub/a");
+
+  VerifyingConsumer TestConsumer{
+      {{EventKind::Modified, "sub/a"}},
+      {{EventKind::Removed, "sub"}},
+      {{EventKind::Modified, "sub/a"}}};
+
+  llvm::Expected<std::unique_ptr<DirectoryWatcher>> DW =
+      DirectoryWatcher::create(
+          fixture.TestWatchedDir,
+          [&TestConsumer](llvm::ArrayRef<DirectoryWatcher::Event> Events,
+                          bool IsInitial) {
+            TestConsumer.consume(Events, IsInitial);
+          },
+          /*waitForInitialSync=*/true, /*Recursive=*/true);
+  ASSERT_THAT_ERROR(DW.takeError(), Succeeded());
+
+  SmallString<128> MovedPath(fixture.TestRootDir);
+  path::append(MovedPath, "moved");
+  ASSERT_FALSE(rename(fixture.getPathInWatched("sub"), MovedPath));
+
+  // The moved directory isn't watched anymore.
+  SmallString<128> MovedFile(MovedPath);
+  path::append(MovedFile, "a");
+  ASSERT_FALSE(remove(MovedFile));
+
+  checkEventualResultWithTimeout(TestConsumer);
+}
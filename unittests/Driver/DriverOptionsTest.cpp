@@ -0,0 +1,70 @@
+//===- unittests/Driver/DriverOptionsTest.cpp -----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Unit tests for the parsing of the driver options.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Driver/Options.h"
+#include "llvm/Option/Arg.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Option/OptTable.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+using namespace clang;
+using namespace clang::driver;
+using namespace llvm::opt;
+
+namespace {
+
+std::string describeArgs(const InputArgList &Args, unsigned MissingArgIndex,
+                         unsigned MissingArgCount) {
+  std::string Result = std::to_string(MissingArgIndex) + " " +
+                       std::to_string(MissingArgCount) + "\n";
+  for (const Arg *A : Args) {
+    Result += std::to_string(A->getOption().getID()) + " " +
+              A->getSpelling().str() + " " + std::to_string(A->getIndex());
+    for (const char *Value : A->getValues())
+      Result += std::string(" ") + Value;
+    Result += "\n";
+  }
+  return Result;
+}
+
+TEST(DriverOptionsTest, ParsesLikeOptTable) {
+  std::vector<std::vector<const char *>> Cases = {
+      {"-Ifoo", "-I", "bar", "-I-", "-I-x", "-DX=1", "-D", "Y", "-UZ", "-U",
+       "W", "-c", "a.c"},
+      {"-Iinclude", "-isystem", "/usr", "-Dfoo", "-D"},
+      {"-D", "", "-I", "-fsyntax-only"},
+      {"/DFOO", "-DBAR", "/Ifoo", "-Ibar", "-U", "x"},
+  };
+  // The masks of the driver, of cc1 and of the cl driver.
+  std::pair<unsigned, unsigned> Masks[] = {
+      {0, options::NoDriverOption | options::CLOption},
+      {options::CC1Option, 0},
+      {options::CLOption | options::CoreOption, options::NoDriverOption}};
+
+  for (const auto &Case : Cases) {
+    for (const auto &Mask : Masks) {
+      unsigned MissingArgIndex, MissingArgCount;
+      InputArgList Expected = getDriverOptTable().ParseArgs(
+          Case, MissingArgIndex, MissingArgCount, Mask.first, Mask.second);
+      std::string ExpectedArgs =
+          describeArgs(Expected, MissingArgIndex, MissingArgCount);
+      InputArgList Args = parseDriverArgs(Case, MissingArgIndex,
+                                          MissingArgCount, Mask.first,
+                                          Mask.second);
+      EXPECT_EQ(ExpectedArgs,
+                describeArgs(Args, MissingArgIndex, MissingArgCount));
+    }
+  }
+}
+
+} // end anonymous namespace.
@@ -0,0 +1,82 @@
+//===- unittests/Driver/ToolChainCacheTest.cpp ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Unit tests for the cache of the toolchain discovery.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Driver/ToolChainCache.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "gtest/gtest.h"
+using namespace clang;
+using namespace clang::driver;
+
+namespace {
+
+class ToolChainCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("toolchain-cache", "json",
+                                                    CachePath));
+    llvm::sys::fs::remove(CachePath);
+    FS = new llvm::vfs::InMemoryFileSystem;
+    FS->addFile("/usr/lib/gcc/x86_64-linux-gnu/9/crtbegin.o", 0,
+                llvm::MemoryBuffer::getMemBuffer("\n"));
+  }
+
+  void TearDown() override { llvm::sys::fs::remove(CachePath); }
+
+  /// Writes an entry found by probing the GCC installations in /usr/lib.
+  void writeEntry() {
+    ToolChainCache Cache(CachePath, *FS);
+    ToolChainCache::Roots Roots(*FS);
+    Roots.add("/usr");
+    Roots.add("/opt/gcc");
+    Roots.addProbe("/usr/lib", "/usr/lib/gcc-cross/x86_64-linux-gnu");
+    Roots.addProbe("/usr/lib", "/usr/lib/gcc/x86_64-linux-gnu");
+    Cache.insert("gcc", llvm::json::Object{{"path", "9"}}, std::move(Roots));
+  }
+
+  SmallString<128> CachePath;
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> FS;
+};
+
+TEST_F(ToolChainCacheTest, ReusesUnchangedEntries) {
+  writeEntry();
+  ToolChainCache Cache(CachePath, *FS);
+  EXPECT_EQ(nullptr, Cache.lookup("cuda"));
+  const llvm::json::Object *Values = Cache.lookup("gcc");
+  ASSERT_NE(nullptr, Values);
+  EXPECT_EQ(StringRef("9"), Values->getString("path"));
+}
+
+TEST_F(ToolChainCacheTest, DropsEntriesWhenAMissingRootAppears) {
+  writeEntry();
+  FS->addFile("/opt/gcc/lib/gcc/x86_64-linux-gnu/10/crtbegin.o", 0,
+              llvm::MemoryBuffer::getMemBuffer("\n"));
+  ToolChainCache Cache(CachePath, *FS);
+  EXPECT_EQ(nullptr, Cache.lookup("gcc"));
+}
+
+TEST_F(ToolChainCacheTest, DropsEntriesWhenAProbedDirectoryChanges) {
+  writeEntry();
+  // The in-memory file system doesn't update the modification times of the
+  // directories, so /usr/lib is created with the time of gcc-cross, which was
+  // missing when it was probed.
+  auto InMemoryFS = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+  InMemoryFS->addFile("/usr/lib/gcc-cross/x86_64-linux-gnu/9/crtbegin.o", 1,
+                      llvm::MemoryBuffer::getMemBuffer("\n"));
+  InMemoryFS->addFile("/usr/lib/gcc/x86_64-linux-gnu/9/crtbegin.o", 0,
+                      llvm::MemoryBuffer::getMemBuffer("\n"));
+  ToolChainCache Cache(CachePath, *InMemoryFS);
+  EXPECT_EQ(nullptr, Cache.lookup("gcc"));
+}
+
+} // end anonymous namespace.
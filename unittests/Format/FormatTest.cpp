@@ -4826,6 +4826,40 @@ TEST_F(FormatTest, MemoizationTests) {
   input += "           a) {}";
   verifyFormat(input, OnePerLine);
 }
+
+TEST_F(FormatTest, LongLinesWithManyStates) {
+  // Lines with hundreds of tokens and many ways to break them. These take
+  // long when the states already examined are not found quickly.
+  std::string InitList = "int aaaaaaaaaaa[] = {";
+  for (unsigned i = 0; i != 300; ++i)
+    InitList += (i ? ", " : "") + std::to_string(i * 7919 % 100000);
+  InitList += "};";
+  std::string NestedInitList = "S s = {";
+  for (unsigned i = 0; i != 60; ++i)
+    NestedInitList += std::string(i ? ", " : "") + "{a" + std::to_string(i) +
+                      ", {b, c}, \"d\"}";
+  NestedInitList += "};";
+  std::string Builder = "auto x = Builder()";
+  for (unsigned i = 0; i != 100; ++i)
+    Builder += ".setField" + std::to_string(i) + "(aaaaa, bbbbb(" +
+               std::to_string(i) + "))";
+  Builder += ".build();";
+  std::string Arithmetic = "int x = ";
+  for (unsigned i = 0; i != 150; ++i)
+    Arithmetic += std::string(i ? " + " : "") + "aaaa(b" + std::to_string(i) +
+                  ") * ccc";
+  Arithmetic += ";";
+
+  for (const std::string &Code :
+       {InitList, NestedInitList, Builder, Arithmetic}) {
+    std::string Formatted = format(Code);
+    EXPECT_EQ(Formatted, format(Formatted));
+    SmallVector<StringRef, 32> Lines;
+    StringRef(Formatted).split(Lines, '\n');
+    for (StringRef Line : Lines)
+      EXPECT_LE(Line.size(), 80u) << Line;
+  }
+}
 #endif
 
 TEST_F(FormatTest, BreaksAsHighAsPossible) {
@@ -14352,6 +14386,39 @@ TEST(FormatStyle, GetStyleOfFile) {
   ASSERT_EQ(*StyleTd, getLLVMStyle(FormatStyle::LK_TableGen));
 }
 
+TEST(FormatStyle, GetStyleOfFileWithCache) {
+  llvm::vfs::InMemoryFileSystem FS;
+  FormatStyleCache Cache;
+  ASSERT_TRUE(FS.addFile("/a/.clang-format", 0,
+                         llvm::MemoryBuffer::getMemBuffer(
+                             "Language: Cpp\nBasedOnStyle: Google")));
+  ASSERT_TRUE(FS.addFile("/a/sub/test.cpp", 0,
+                         llvm::MemoryBuffer::getMemBuffer("int i;")));
+  auto Style1 = getStyle("file", "/a/sub/test.cpp", "LLVM", "", &FS, &Cache);
+  ASSERT_TRUE((bool)Style1);
+  ASSERT_EQ(*Style1, getGoogleStyle());
+
+  // The directories and the configuration files are read from the cache, so
+  // a configuration file added later is not found.
+  ASSERT_TRUE(
+      FS.addFile("/a/sub/.clang-format", 0,
+                 llvm::MemoryBuffer::getMemBuffer("BasedOnStyle: LLVM")));
+  auto Style2 = getStyle("file", "/a/sub/test.cpp", "LLVM", "", &FS, &Cache);
+  ASSERT_TRUE((bool)Style2);
+  ASSERT_EQ(*Style2, getGoogleStyle());
+  auto Style3 = getStyle("file", "/a/sub/test.cpp", "LLVM", "", &FS);
+  ASSERT_TRUE((bool)Style3);
+  ASSERT_EQ(*Style3, getLLVMStyle());
+
+  // The configurations are cached by language.
+  auto Style4 = getStyle("file", "/a/test.js", "LLVM", "", &FS, &Cache);
+  ASSERT_FALSE((bool)Style4);
+  llvm::consumeError(Style4.takeError());
+  auto Style5 = getStyle("file", "/a/test.cpp", "LLVM", "", &FS, &Cache);
+  ASSERT_TRUE((bool)Style5);
+  ASSERT_EQ(*Style5, getGoogleStyle());
+}
+
 TEST_F(ReplacementTest, FormatCodeAfterReplacements) {
   // Column limit is 20.
   std::string Code = "Type *a =\n"
@@ -33,6 +33,20 @@ protected:
     return *Result;
   }
 
+  // Formats \p Ranges of \p Code in \p Session and checks that the result is
+  // the one of reformat().
+  std::string formatInSession(FormattingSession &Session, llvm::StringRef Code,
+                              std::vector<tooling::Range> Ranges) {
+    tooling::Replacements Expected = reformat(Style, Code, Ranges);
+    tooling::Replacements Replaces = Session.reformat(Code, Ranges);
+    auto Result = applyAllReplacements(Code, Replaces);
+    EXPECT_TRUE(static_cast<bool>(Result));
+    auto ExpectedResult = applyAllReplacements(Code, Expected);
+    EXPECT_TRUE(static_cast<bool>(ExpectedResult));
+    EXPECT_EQ(*ExpectedResult, *Result) << Code << "\n\n";
+    return *Result;
+  }
+
   FormatStyle Style = getLLVMStyle();
 };
 
@@ -603,6 +617,62 @@ TEST_F(FormatTestSelective, KeepsIndentAfterCommentSectionImport) {
   EXPECT_EQ(Code, format(Code, 47, 1));
 }
 
+TEST_F(FormatTestSelective, FormattingSession) {
+  FormattingSession Session(Style);
+  auto rangeOf = [](llvm::StringRef Code, llvm::StringRef Text) {
+    return tooling::Range(Code.find(Text), Text.size());
+  };
+  auto replace = [](std::string Code, llvm::StringRef From,
+                    llvm::StringRef To) {
+    return Code.replace(Code.find(From), From.size(), To.str());
+  };
+
+  std::string Code = "namespace n {\n"
+                     "int a;\n"
+                     "\n"
+                     "int f() {\n"
+                     "  return  0 ;\n"
+                     "}\n"
+                     "\n"
+                     "int   g();\n"
+                     "\n"
+                     "struct S {\n"
+                     "  int a;\n"
+                     "};\n"
+                     "\n"
+                     "int h();\n"
+                     "\n"
+                     "} // namespace n\n";
+  // Leaves the body of f() alone.
+  Code = formatInSession(Session, Code, {rangeOf(Code, "int   g();")});
+  EXPECT_EQ(std::string::npos, Code.find("int   g"));
+
+  // Edits a fragment and formats two.
+  Code = replace(Code, "  int a;", "  int  b;");
+  Code = formatInSession(
+      Session, Code, {rangeOf(Code, "return  0 ;"), rangeOf(Code, "int  b;")});
+  EXPECT_NE(std::string::npos, Code.find("  return 0;\n"));
+  Code = replace(Code, "int g();", "int g(int  x);");
+  Code = formatInSession(Session, Code, {rangeOf(Code, "int  x")});
+  EXPECT_NE(std::string::npos, Code.find("int g(int x);"));
+
+  // Edits which change the code that follows.
+  Code = replace(Code, "int g(int x);", "int g(int x) {");
+  Code = formatInSession(Session, Code, {rangeOf(Code, "int g(int x) {")});
+  Code = replace(Code, "int g(int x) {", "int g(int x) {}");
+  Code = formatInSession(Session, Code, {rangeOf(Code, "int g(int x) {}")});
+  Code = replace(Code, "int f() {", "int f() { /*");
+  Code = formatInSession(Session, Code, {rangeOf(Code, "/*")});
+  Code = replace(Code, "/*", "");
+  Code = formatInSession(Session, Code, {rangeOf(Code, "int f() {")});
+  Code = replace(Code, "struct S {", "#if 0\nstruct S {");
+  Code = formatInSession(Session, Code, {rangeOf(Code, "struct S {")});
+
+  // An edit without ranges.
+  Code = replace(Code, "return 0;", "return   1;");
+  EXPECT_EQ(Code, formatInSession(Session, Code, {}));
+}
+
 } // end namespace
 } // end namespace format
 } // end namespace clang
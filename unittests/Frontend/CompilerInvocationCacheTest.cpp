@@ -0,0 +1,91 @@
+//===- unittests/Frontend/CompilerInvocationCacheTest.cpp -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompilerInvocationCache.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class CompilerInvocationCacheTest : public ::testing::Test {
+protected:
+  CompilerInvocationCacheTest()
+      : Diags(new DiagnosticIDs, new DiagnosticOptions,
+              new IgnoringDiagConsumer) {}
+
+  std::unique_ptr<CompilerInvocation> create(StringRef Input, StringRef Macro) {
+    std::string Output = (Input + ".o").str();
+    std::string Define = ("-D" + Macro).str();
+    std::string InputStr = Input.str();
+    const char *Args[] = {"-triple",         "x86_64-unknown-linux-gnu",
+                          "-emit-obj",       "-fcf-protection=full",
+                          "-main-file-name", InputStr.c_str(),
+                          "-o",              Output.c_str(),
+                          Define.c_str(),    InputStr.c_str()};
+    return Cache.createInvocation(Args, Diags);
+  }
+
+  DiagnosticsEngine Diags;
+  CompilerInvocationCache Cache;
+};
+
+TEST_F(CompilerInvocationCacheTest, PerInputArgs) {
+  std::unique_ptr<CompilerInvocation> First = create("a.cpp", "A=1");
+  std::unique_ptr<CompilerInvocation> Second = create("b.cpp", "B");
+  ASSERT_FALSE(Diags.hasErrorOccurred());
+
+  for (auto *Invocation : {First.get(), Second.get()}) {
+    ASSERT_EQ(1u, Invocation->getFrontendOpts().Inputs.size());
+    EXPECT_EQ(Language::CXX,
+              Invocation->getFrontendOpts().Inputs[0].getKind().getLanguage());
+    EXPECT_TRUE(Invocation->getLangOpts()->CPlusPlus);
+  }
+
+  EXPECT_EQ("a.cpp", First->getFrontendOpts().Inputs[0].getFile());
+  EXPECT_EQ("a.cpp.o", First->getFrontendOpts().OutputFile);
+  EXPECT_EQ("a.cpp", First->getCodeGenOpts().MainFileName);
+  EXPECT_EQ("b.cpp", Second->getFrontendOpts().Inputs[0].getFile());
+  EXPECT_EQ("b.cpp.o", Second->getFrontendOpts().OutputFile);
+  EXPECT_EQ("b.cpp", Second->getCodeGenOpts().MainFileName);
+
+  // The macros implied by the other arguments come first.
+  using Macros = std::vector<std::pair<std::string, bool>>;
+  EXPECT_EQ((Macros{{"__CET__=3", false}, {"A=1", false}}),
+            First->getPreprocessorOpts().Macros);
+  EXPECT_EQ((Macros{{"__CET__=3", false}, {"B", false}}),
+            Second->getPreprocessorOpts().Macros);
+
+  // The copies don't share their options.
+  EXPECT_NE(First->getAnalyzerOpts(), Second->getAnalyzerOpts());
+  EXPECT_NE(First->getLangOpts(), Second->getLangOpts());
+}
+
+TEST_F(CompilerInvocationCacheTest, KindFromExtension) {
+  create("a.cpp", "A");
+  std::unique_ptr<CompilerInvocation> C = create("a.c", "A");
+  EXPECT_EQ(Language::C,
+            C->getFrontendOpts().Inputs[0].getKind().getLanguage());
+  EXPECT_FALSE(C->getLangOpts()->CPlusPlus);
+}
+
+TEST_F(CompilerInvocationCacheTest, DiagnosedArgsAreNotCached) {
+  const char *Args[] = {"-emit-obj", "-fno-such-flag", "a.c"};
+  for (unsigned I = 0; I != 2; ++I) {
+    DiagnosticErrorTrap Trap(Diags);
+    Cache.createInvocation(Args, Diags);
+    EXPECT_TRUE(Trap.hasErrorOccurred());
+  }
+}
+
+} // anonymous namespace
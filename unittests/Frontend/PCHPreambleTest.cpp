@@ -11,6 +11,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendOptions.h"
+#include "clang/Frontend/PreambleCache.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
@@ -66,17 +67,21 @@ public:
     VFS->setCurrentWorkingDirectory("//./");
   }
 
-  void AddFile(const std::string &Filename, const std::string &Contents) {
-    ::time_t now;
-    ::time(&now);
-    VFS->addFile(Filename, now, MemoryBuffer::getMemBufferCopy(Contents, Filename));
+  void AddFile(const std::string &Filename, const std::string &Contents,
+               ::time_t ModTime = 0) {
+    if (!ModTime)
+      ::time(&ModTime);
+    VFS->addFile(Filename, ModTime,
+                 MemoryBuffer::getMemBufferCopy(Contents, Filename));
   }
 
   void RemapFile(const std::string &Filename, const std::string &Contents) {
     RemappedFiles[Filename] = Contents;
   }
 
-  std::unique_ptr<ASTUnit> ParseAST(const std::string &EntryFile) {
+  std::unique_ptr<ASTUnit>
+  ParseAST(const std::string &EntryFile,
+           std::shared_ptr<PreambleCache> SharedPreambles = nullptr) {
     PCHContainerOpts = std::make_shared<PCHContainerOperations>();
     std::shared_ptr<CompilerInvocation> CI(new CompilerInvocation);
     CI->getFrontendOpts().Inputs.push_back(
@@ -97,7 +102,10 @@ public:
 
     std::unique_ptr<ASTUnit> AST = ASTUnit::LoadFromCompilerInvocation(
         CI, PCHContainerOpts, Diags, FileMgr, false, CaptureDiagsKind::None,
-        /*PrecompilePreambleAfterNParses=*/1);
+        /*PrecompilePreambleAfterNParses=*/1, TU_Complete,
+        /*CacheCodeCompletionResults=*/false,
+        /*IncludeBriefCommentsInCodeCompletion=*/false,
+        /*UserFilesAreVolatile=*/false, std::move(SharedPreambles));
     return AST;
   }
 
@@ -189,6 +197,52 @@ int main() { return ZERO; }
   ASSERT_EQ(AST->getPreambleCounterForTests(), 1U);
 }
 
+TEST_F(PCHPreambleTest, ReparseReusesPreambleAfterHeaderWasTouched) {
+  std::string Header1 = "//./header1.h";
+  std::string MainName = "//./main.cpp";
+  std::string MainFileContent = R"cpp(
+#include "//./header1.h"
+int main() { return ZERO; }
+)cpp";
+  AddFile(MainName, MainFileContent);
+  AddFile(Header1, "#define ZERO 0\n", 1000);
+
+  std::unique_ptr<ASTUnit> AST(ParseAST(MainName));
+  ASSERT_TRUE(AST.get());
+  ASSERT_FALSE(AST->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST->getPreambleCounterForTests(), 1U);
+
+  // Only the modification time of the header changes.
+  ResetVFS();
+  AddFile(MainName, MainFileContent);
+  AddFile(Header1, "#define ZERO 0\n", 2000);
+  ASSERT_TRUE(ReparseAST(AST));
+  ASSERT_EQ(AST->getPreambleCounterForTests(), 1U);
+}
+
+TEST_F(PCHPreambleTest, ReparseRebuildsPreambleAfterHeaderContentsChanged) {
+  std::string Header1 = "//./header1.h";
+  std::string MainName = "//./main.cpp";
+  std::string MainFileContent = R"cpp(
+#include "//./header1.h"
+int main() { return ZERO; }
+)cpp";
+  AddFile(MainName, MainFileContent);
+  AddFile(Header1, "#define ZERO 0\n", 1000);
+
+  std::unique_ptr<ASTUnit> AST(ParseAST(MainName));
+  ASSERT_TRUE(AST.get());
+  ASSERT_FALSE(AST->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST->getPreambleCounterForTests(), 1U);
+
+  // The size of the header is the same, but not its contents.
+  ResetVFS();
+  AddFile(MainName, MainFileContent);
+  AddFile(Header1, "#define ZERO 1\n", 2000);
+  ASSERT_TRUE(ReparseAST(AST));
+  ASSERT_EQ(AST->getPreambleCounterForTests(), 2U);
+}
+
 TEST_F(PCHPreambleTest, ReparseWithOverriddenFileDoesNotInvalidatePreamble) {
   std::string Header1 = "//./header1.h";
   std::string Header2 = "//./header2.h";
@@ -218,6 +272,45 @@ TEST_F(PCHPreambleTest, ReparseWithOverriddenFileDoesNotInvalidatePreamble) {
   ASSERT_EQ(initialCounts[2], GetFileReadCount(Header2));
 }
 
+TEST_F(PCHPreambleTest, SharedPreambleIsReusedByOtherFiles) {
+  std::string Header1 = "//./header1.h";
+  std::string Main1 = "//./main1.cpp";
+  std::string Main2 = "//./main2.cpp";
+  std::string Main3 = "//./main3.cpp";
+  AddFile(Header1, "#define ZERO 0\n");
+  AddFile(Main1, "#include \"//./header1.h\"\nint main() { return ZERO; }");
+  AddFile(Main2, "#include \"//./header1.h\"\nint f() { return ZERO; }");
+  AddFile(Main3, "#include \"//./header2.h\"\nint g() { return ONE; }");
+  AddFile("//./header2.h", "#define ONE 1\n");
+
+  auto SharedPreambles = std::make_shared<PreambleCache>();
+  std::unique_ptr<ASTUnit> AST1(ParseAST(Main1, SharedPreambles));
+  ASSERT_TRUE(AST1.get());
+  ASSERT_FALSE(AST1->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST1->getPreambleCounterForTests(), 1U);
+  unsigned HeaderReadCount = GetFileReadCount(Header1);
+
+  // The second file starts with the same include, and uses the preamble of
+  // the first one.
+  std::unique_ptr<ASTUnit> AST2(ParseAST(Main2, SharedPreambles));
+  ASSERT_TRUE(AST2.get());
+  ASSERT_FALSE(AST2->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST2->getPreambleCounterForTests(), 0U);
+  ASSERT_EQ(HeaderReadCount, GetFileReadCount(Header1));
+
+  // The third one starts with another include.
+  std::unique_ptr<ASTUnit> AST3(ParseAST(Main3, SharedPreambles));
+  ASSERT_TRUE(AST3.get());
+  ASSERT_FALSE(AST3->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST3->getPreambleCounterForTests(), 1U);
+
+  // The shared preamble outlives the unit which built it.
+  AST1.reset();
+  ASSERT_TRUE(ReparseAST(AST2));
+  ASSERT_FALSE(AST2->getDiagnostics().hasErrorOccurred());
+  ASSERT_EQ(AST2->getPreambleCounterForTests(), 0U);
+}
+
 TEST_F(PCHPreambleTest, ParseWithBom) {
   std::string Header = "//./header.h";
   std::string Main = "//./main.cpp";
@@ -11,14 +11,18 @@
 #include "clang/AST/Decl.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexRecord.h"
 #include "clang/Index/IndexSymbol.h"
 #include "clang/Index/IndexingAction.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -144,6 +148,7 @@ private:
 
 using testing::AllOf;
 using testing::Contains;
+using testing::EndsWith;
 using testing::Not;
 using testing::UnorderedElementsAre;
 
@@ -293,6 +298,106 @@ TEST(IndexTest, Constructors) {
                 WrittenAt(Position(4, 8)))));
 }
 
+class DeclCollector : public IndexDataConsumer {
+public:
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet,
+                           ArrayRef<SymbolRelation>, SourceLocation,
+                           ASTNodeInfo) override {
+    Decls.push_back(D);
+    return true;
+  }
+
+  std::vector<const Decl *> Decls;
+};
+
+TEST(IndexTest, USRCache) {
+  std::string Code = R"cpp(
+    namespace ns {
+    template <typename T> struct S {
+      template <typename U> void f(T, U, T *);
+      struct Inner { int x; void g(S<T> *, Inner *); };
+    };
+    template <> struct S<int> { struct Inner { void g(S<int> *); }; };
+    namespace { static int hidden; struct Anon { void h(Anon *); }; }
+    void local(int p) { struct L { void m(L *); }; int v = p; (void)v; }
+    }
+    extern "C" { void c(); }
+  )cpp";
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCode(Code);
+  DeclCollector Collector;
+  IndexingOptions Opts;
+  Opts.IndexFunctionLocals = true;
+  Opts.IndexParametersInDeclarations = true;
+  indexASTUnit(*AST, Collector, Opts);
+  ASSERT_FALSE(Collector.Decls.empty());
+
+  // The cached USRs, including those built on the cached USRs of their
+  // contexts, are the ones generated from scratch.
+  USRCache Cache;
+  for (int Pass = 0; Pass != 2; ++Pass) {
+    for (const Decl *D : Collector.Decls) {
+      SmallString<128> Expected, Cached;
+      bool ExpectedIgnore = generateUSRForDecl(D, Expected);
+      EXPECT_EQ(Cache.generateUSRForDecl(D, Cached), ExpectedIgnore);
+      if (!ExpectedIgnore)
+        EXPECT_EQ(Cached.str(), Expected.str());
+    }
+  }
+}
+
+TEST(IndexTest, RecordWriter) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("index-records", Dir));
+  std::string Code = "void f();\nvoid g() { f(); }\n";
+  auto Writer = std::make_shared<IndexRecordWriter>(Dir);
+  tooling::runToolOnCode(createIndexingAction(Writer, IndexingOptions()),
+                         Code);
+  ASSERT_EQ(Writer->getRecordPaths().size(), 1u);
+
+  auto Reader = IndexRecordReader::create(Writer->getRecordPaths()[0]);
+  ASSERT_TRUE(bool(Reader)) << llvm::toString(Reader.takeError());
+  EXPECT_THAT((*Reader)->getFilePath().str(), EndsWith("input.cc"));
+  EXPECT_EQ((*Reader)->getSymbols().size(), 2u);
+
+  const record::Symbol *F = (*Reader)->findSymbol("c:@F@f#");
+  ASSERT_NE(F, nullptr);
+  EXPECT_EQ((*Reader)->getName(*F), "f");
+  EXPECT_EQ((*Reader)->getSymbolInfo(*F).Kind, SymbolKind::Function);
+  ArrayRef<record::Occurrence> Occurrences = (*Reader)->getOccurrences(*F);
+  ASSERT_EQ(Occurrences.size(), 2u);
+  EXPECT_EQ(Occurrences[0].Line, 1u);
+  EXPECT_EQ(Occurrences[0].Column, 6u);
+  EXPECT_TRUE(Occurrences[0].Roles &
+              static_cast<unsigned>(SymbolRole::Declaration));
+  EXPECT_EQ(Occurrences[1].Line, 2u);
+  EXPECT_EQ(Occurrences[1].Column, 12u);
+  EXPECT_TRUE(Occurrences[1].Roles & static_cast<unsigned>(SymbolRole::Call));
+  EXPECT_EQ((*Reader)->findOccurrenceAt(Occurrences[1].Offset),
+            &Occurrences[1]);
+  EXPECT_EQ((*Reader)->findSymbol("c:@F@h#"), nullptr);
+
+  std::vector<unsigned> Lines;
+  (*Reader)->forEachOccurrence([&](const record::Occurrence &O) {
+    Lines.push_back(O.Line);
+    return true;
+  });
+  EXPECT_THAT(Lines, testing::ElementsAre(1u, 2u, 2u));
+
+  // Indexing the same code again finds its record.
+  auto SecondWriter = std::make_shared<IndexRecordWriter>(Dir);
+  tooling::runToolOnCode(createIndexingAction(SecondWriter, IndexingOptions()),
+                         Code);
+  EXPECT_EQ(SecondWriter->getRecordPaths(), Writer->getRecordPaths());
+  std::error_code EC;
+  unsigned NumFiles = 0;
+  for (llvm::sys::fs::directory_iterator I(Dir, EC), E; I != E && !EC;
+       I.increment(EC))
+    ++NumFiles;
+  EXPECT_EQ(NumFiles, 1u);
+
+  llvm::sys::fs::remove_directories(Dir);
+}
+
 } // namespace
 } // namespace index
 } // namespace clang
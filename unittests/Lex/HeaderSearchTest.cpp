@@ -14,6 +14,7 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/DirectoryListingCache.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
@@ -136,5 +137,59 @@ TEST_F(HeaderSearchTest, IncludeFromSameDirectory) {
             "y/z/t.h");
 }
 
+TEST_F(HeaderSearchTest, DirectoryListingCache) {
+  VFS->addFile("/x/a.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  VFS->addFile("/x/sys/b.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+
+  DirectoryListingCache Cache;
+  auto Listing = Cache.getListing("/x", *VFS);
+  ASSERT_TRUE(Listing);
+  EXPECT_TRUE(Listing->mayContain("a.h"));
+  EXPECT_TRUE(Listing->mayContain("A.h"));
+  EXPECT_TRUE(Listing->mayContain("sys"));
+  EXPECT_FALSE(Listing->mayContain("b.h"));
+  EXPECT_EQ(Cache.getListing("/x", *VFS), Listing);
+  EXPECT_FALSE(Cache.getListing("/y", *VFS));
+
+  // A directory with a different modification time is read again.
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> OtherVFS(
+      new llvm::vfs::InMemoryFileSystem);
+  OtherVFS->addFile("/x/b.h", 1, llvm::MemoryBuffer::getMemBuffer(""));
+  auto NewListing = Cache.getListing("/x", *OtherVFS);
+  ASSERT_TRUE(NewListing);
+  EXPECT_NE(NewListing, Listing);
+  EXPECT_TRUE(NewListing->mayContain("b.h"));
+  EXPECT_FALSE(NewListing->mayContain("a.h"));
+}
+
+TEST_F(HeaderSearchTest, LookupFileWithDirectoryListingCache) {
+  addSearchDir("/a");
+  addSearchDir("/b");
+  VFS->addFile("/b/x.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  VFS->addFile("/b/sub/y.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  FileMgr.getVirtualFile("/a/v.h", /*Size=*/0, /*ModificationTime=*/0);
+
+  DirectoryListingCache Cache;
+  Search.setDirectoryListingCache(&Cache);
+
+  auto Lookup = [&](StringRef Filename) {
+    const DirectoryLookup *CurDir = nullptr;
+    return Search.LookupFile(Filename, SourceLocation(), /*isAngled=*/false,
+                             /*FromDir=*/nullptr, CurDir, /*Includers=*/None,
+                             /*SearchPath=*/nullptr, /*RelativePath=*/nullptr,
+                             /*RequestingModule=*/nullptr,
+                             /*SuggestedModule=*/nullptr, /*IsMapped=*/nullptr,
+                             /*IsFrameworkFound=*/nullptr);
+  };
+  auto X = Lookup("x.h");
+  ASSERT_TRUE(X);
+  EXPECT_EQ(X->getName(), "/b/x.h");
+  EXPECT_TRUE(Lookup("sub/y.h"));
+  EXPECT_FALSE(Lookup("z.h"));
+  EXPECT_FALSE(Lookup("sub/z.h"));
+  // Virtual files are not in the listings, but are still found.
+  EXPECT_TRUE(Lookup("v.h"));
+}
+
 } // namespace
 } // namespace clang
@@ -374,6 +374,21 @@ TEST_F(LexerTest, DontMergeMacroArgsFromDifferentMacroFiles) {
   EXPECT_EQ(SourceMgr.getFileIDSize(SourceMgr.getFileID(helper1ArgLoc)), 8U);
 }
 
+TEST_F(LexerTest, MergeMacroArgTokensAfterLongTokens) {
+  std::vector<Token> toks =
+      Lex("#define ID(x) x\n"
+          "ID(\"a string literal that is longer than fifty characters\" + 1)");
+  ASSERT_EQ(toks.size(), 3U);
+
+  // The tokens of the argument share a single macro argument expansion entry
+  // even though the string literal is long.
+  FileID StringFID = SourceMgr.getFileID(toks[0].getLocation());
+  EXPECT_EQ(SourceMgr.getFileID(toks[1].getLocation()), StringFID);
+  EXPECT_EQ(SourceMgr.getFileID(toks[2].getLocation()), StringFID);
+  EXPECT_EQ(getSourceText(toks[0], toks[2]),
+            "\"a string literal that is longer than fifty characters\" + 1");
+}
+
 TEST_F(LexerTest, DontOverallocateStringifyArgs) {
   TrivialModuleLoader ModLoader;
   auto PP = CreatePP("\"StrArg\", 5, 'C'", ModLoader);
@@ -556,4 +571,35 @@ TEST_F(LexerTest, FindNextToken) {
   EXPECT_THAT(GeneratedByNextToken, ElementsAre("abcd", "=", "0", ";", "int",
                                                 "xyz", "=", "abcd", ";"));
 }
+
+TEST_F(LexerTest, LongIdentifiersAndWhitespaceRuns) {
+  // Exercise the vectorized scanning paths with runs that straddle 16-byte
+  // blocks and end on every possible offset within a block.
+  for (unsigned Len = 1; Len != 40; ++Len) {
+    std::string Ident = "_" + std::string(Len, 'a') + "Z9";
+    std::string Spaces(Len, ' ');
+    Spaces[Len / 2] = '\t';
+    std::string Source = "int" + Spaces + Ident + Spaces + "=" + Spaces + "$x";
+    std::vector<Token> toks = Lex(Source);
+    ASSERT_EQ(4u, toks.size());
+    EXPECT_EQ(tok::kw_int, toks[0].getKind());
+    EXPECT_EQ(tok::identifier, toks[1].getKind());
+    EXPECT_EQ(Ident, getSourceText(toks[1], toks[1]));
+    EXPECT_TRUE(toks[1].hasLeadingSpace());
+    EXPECT_EQ(tok::equal, toks[2].getKind());
+    // '$' is an identifier character in this language mode, and must not be
+    // swallowed or skipped by the block scanners.
+    EXPECT_EQ(tok::identifier, toks[3].getKind());
+    EXPECT_EQ("$x", getSourceText(toks[3], toks[3]));
+  }
+}
+
+TEST_F(LexerTest, LongCommentsEndCorrectly) {
+  std::string Body(70, 'x');
+  CheckLex("// " + Body + "\nint a; /* " + Body + " */ int b;\n// " + Body +
+               "\\\nint hidden;\nint c; // " + Body + "\r\nint d;",
+           {tok::kw_int, tok::identifier, tok::semi, tok::kw_int,
+            tok::identifier, tok::semi, tok::kw_int, tok::identifier, tok::semi,
+            tok::kw_int, tok::identifier, tok::semi});
+}
 } // anonymous namespace
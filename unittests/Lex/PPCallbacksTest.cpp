@@ -18,6 +18,7 @@
 #include "clang/Basic/TargetOptions.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/ModuleLoader.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Parse/Parser.h"
@@ -112,6 +113,28 @@ public:
   unsigned State;
 };
 
+// Stub to collect the headers that are entered and skipped.
+class FileEnterSkipCallbacks : public PPCallbacks {
+public:
+  FileEnterSkipCallbacks(SourceManager &SM) : SM(SM) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile && SM.getFileEntryForID(SM.getFileID(Loc)))
+      ++NumEntered;
+  }
+
+  void FileSkipped(const FileEntryRef &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override {
+    ++NumSkipped;
+  }
+
+  SourceManager &SM;
+  unsigned NumEntered = 0;
+  unsigned NumSkipped = 0;
+};
+
 // PPCallbacks test fixture.
 class PPCallbacksTest : public ::testing::Test {
 protected:
@@ -256,6 +279,42 @@ protected:
     return Callbacks->Results;
   }
 
+  // Preprocess SourceText, which includes "/guarded/guarded.h", in a new
+  // source manager and collect the headers entered and skipped.
+  std::pair<unsigned, unsigned>
+  EnteredAndSkippedFiles(StringRef SourceText, IncludeGuardCache &Guards) {
+    SourceManager SM(Diags, FileMgr);
+    SM.setMainFileID(
+        SM.createFileID(llvm::MemoryBuffer::getMemBuffer(SourceText)));
+
+    TrivialModuleLoader ModLoader;
+    HeaderSearch HeaderInfo(std::make_shared<HeaderSearchOptions>(), SM,
+                            Diags, LangOpts, Target.get());
+    auto DE = FileMgr.getOptionalDirectoryRef("/guarded");
+    HeaderInfo.AddSearchPath(DirectoryLookup(*DE, SrcMgr::C_User, false),
+                             /*isAngled=*/false);
+
+    auto PPOpts = std::make_shared<PreprocessorOptions>();
+    PPOpts->SharedIncludeGuards = &Guards;
+    Preprocessor PP(PPOpts, Diags, LangOpts, SM, HeaderInfo, ModLoader,
+                    /*IILookup =*/nullptr,
+                    /*OwnsHeaderSearch =*/false);
+    PP.Initialize(*Target);
+    auto *Callbacks = new FileEnterSkipCallbacks(SM);
+    PP.addPPCallbacks(std::unique_ptr<PPCallbacks>(Callbacks));
+
+    // Lex source text.
+    PP.EnterMainSourceFile();
+    while (true) {
+      Token Tok;
+      PP.Lex(Tok);
+      if (Tok.is(tok::eof))
+        break;
+    }
+
+    return {Callbacks->NumEntered, Callbacks->NumSkipped};
+  }
+
   PragmaOpenCLExtensionCallbacks::CallbackParameters
   PragmaOpenCLExtensionCall(const char *SourceText) {
     LangOptions OpenCLLangOpts;
@@ -490,4 +549,28 @@ TEST_F(PPCallbacksTest, DirectiveExprRanges) {
       "__FILE__ > FLOOFY");
 }
 
+TEST_F(PPCallbacksTest, SharedIncludeGuards) {
+  InMemoryFileSystem->addFile("/guarded/guarded.h", 0,
+                              llvm::MemoryBuffer::getMemBuffer(
+                                  "#ifndef GUARD\n#define GUARD\n#endif\n"));
+  IncludeGuardCache Guards;
+
+  EXPECT_EQ(EnteredAndSkippedFiles("#include \"guarded.h\"\n", Guards),
+            std::make_pair(1u, 0u));
+  auto FE = FileMgr.getFile("/guarded/guarded.h");
+  ASSERT_TRUE(FE);
+  EXPECT_EQ(Guards.lookup(**FE), "GUARD");
+
+  // Another translation unit that defines the guard before the first include
+  // doesn't need to read the header.
+  EXPECT_EQ(EnteredAndSkippedFiles(
+                "#define GUARD\n#include \"guarded.h\"\n", Guards),
+            std::make_pair(0u, 1u));
+
+  IncludeGuardCache NoGuards;
+  EXPECT_EQ(EnteredAndSkippedFiles(
+                "#define GUARD\n#include \"guarded.h\"\n", NoGuards),
+            std::make_pair(1u, 0u));
+}
+
 } // namespace
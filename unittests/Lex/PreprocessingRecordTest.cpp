@@ -0,0 +1,114 @@
+//===- unittests/Lex/PreprocessingRecordTest.cpp - PP record tests --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+// The test fixture.
+class PreprocessingRecordTest : public ::testing::Test {
+protected:
+  PreprocessingRecordTest()
+      : FileMgr(FileMgrOpts), DiagID(new DiagnosticIDs()),
+        Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+        SourceMgr(Diags, FileMgr), TargetOpts(new TargetOptions) {
+    TargetOpts->Triple = "x86_64-apple-darwin11.1.0";
+    Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+};
+
+TEST_F(PreprocessingRecordTest, MacroExpansions) {
+  const char *Source = "#define M1 1\n"
+                       "#define M2 2\n"
+                       "#define FM(x, y) y x\n"
+                       "int a = FM(M1, M2);\n"
+                       "int b = M1 + __LINE__;\n";
+
+  SourceMgr.setMainFileID(
+      SourceMgr.createFileID(llvm::MemoryBuffer::getMemBuffer(Source)));
+  TrivialModuleLoader ModLoader;
+  HeaderSearch HeaderInfo(std::make_shared<HeaderSearchOptions>(), SourceMgr,
+                          Diags, LangOpts, Target.get());
+  Preprocessor PP(std::make_shared<PreprocessorOptions>(), Diags, LangOpts,
+                  SourceMgr, HeaderInfo, ModLoader,
+                  /*IILookup =*/nullptr,
+                  /*OwnsHeaderSearch =*/false);
+  PP.Initialize(*Target);
+  PP.createPreprocessingRecord();
+  PP.EnterMainSourceFile();
+
+  std::vector<Token> Toks;
+  while (true) {
+    Token Tok;
+    PP.Lex(Tok);
+    if (Tok.is(tok::eof))
+      break;
+    Toks.push_back(Tok);
+  }
+
+  PreprocessingRecord &PPRec = *PP.getPreprocessingRecord();
+  std::vector<PreprocessedEntity *> Entities(PPRec.begin(), PPRec.end());
+  ASSERT_EQ(8U, Entities.size());
+
+  // The expansion of M1 in the arguments of FM comes after the one of M2, but
+  // is recorded in source order.
+  const char *Names[] = {"M1", "M2", "FM", "FM", "M1", "M2", "M1", "__LINE__"};
+  const int Definitions[] = {-1, -1, -1, 2, 0, 1, 0, -1};
+  for (unsigned I = 0; I != 8; ++I) {
+    SCOPED_TRACE(I);
+    if (I < 3) {
+      auto *Def = dyn_cast<MacroDefinitionRecord>(Entities[I]);
+      ASSERT_TRUE(Def);
+      EXPECT_EQ(Names[I], Def->getName()->getName());
+      continue;
+    }
+    auto *Expansion = dyn_cast<MacroExpansion>(Entities[I]);
+    ASSERT_TRUE(Expansion);
+    EXPECT_EQ(Names[I], Expansion->getName()->getName());
+    EXPECT_EQ(I == 7, Expansion->isBuiltinMacro());
+    if (Definitions[I] >= 0)
+      EXPECT_EQ(Entities[Definitions[I]], Expansion->getDefinition());
+  }
+
+  // The same entities are returned every time.
+  EXPECT_EQ(Entities, std::vector<PreprocessedEntity *>(PPRec.begin(),
+                                                        PPRec.end()));
+
+  // The entities of the declaration of b.
+  auto InB = PPRec.getPreprocessedEntitiesInRange(
+      SourceRange(Toks[7].getLocation(), Toks.back().getLocation()));
+  ASSERT_EQ(2, std::distance(InB.begin(), InB.end()));
+  EXPECT_EQ(Entities[6], *InB.begin());
+  EXPECT_TRUE(PPRec.isEntityInFileID(InB.begin(), SourceMgr.getMainFileID()));
+}
+
+} // anonymous namespace
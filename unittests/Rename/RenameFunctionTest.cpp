@@ -7,6 +7,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "ClangRenameTest.h"
+#include "clang/Index/IndexRecord.h"
+#include "clang/Index/IndexingAction.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Refactoring/Rename/USRFindingAction.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 
 namespace clang {
 namespace clang_rename {
@@ -567,6 +573,59 @@ TEST_F(ClangRenameTest, DISABLED_ReferencesInLambdaFunctionParameters) {
   CompareSnippets(Expected, After);
 }
 
+class IndexRecordActionFactory : public tooling::FrontendActionFactory {
+public:
+  explicit IndexRecordActionFactory(StringRef RecordDir)
+      : Writer(std::make_shared<index::IndexRecordWriter>(
+            RecordDir, /*WriteUnit=*/true)) {}
+
+  std::unique_ptr<FrontendAction> create() override {
+    return index::createIndexingAction(Writer, index::IndexingOptions());
+  }
+
+private:
+  std::shared_ptr<index::IndexRecordWriter> Writer;
+};
+
+TEST(RenameFunctionIndexTest, FindsFilesWithUSROccurrences) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("rename-index", Dir));
+  auto WriteFile = [&Dir](StringRef Name, StringRef Code) {
+    SmallString<128> Path(Dir);
+    llvm::sys::path::append(Path, Name);
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Path, EC);
+    EXPECT_FALSE(EC);
+    OS << Code;
+    return std::string(Path.str());
+  };
+  WriteFile("foo.h", "void foo();\n");
+  std::string Caller =
+      WriteFile("caller.cc", "#include \"foo.h\"\nvoid bar() { foo(); }\n");
+  std::string Other = WriteFile("other.cc", "void baz();\n");
+  std::string Unindexed = WriteFile("unindexed.cc", "void qux();\n");
+
+  SmallString<128> RecordDir(Dir);
+  llvm::sys::path::append(RecordDir, "records");
+  tooling::FixedCompilationDatabase Compilations(Dir,
+                                                 std::vector<std::string>());
+  tooling::ClangTool Tool(Compilations, {Caller, Other});
+  IndexRecordActionFactory Factory(RecordDir);
+  ASSERT_EQ(Tool.run(&Factory), 0);
+
+  // The files without a unit are always kept.
+  std::vector<std::vector<std::string>> FooUSRs = {{"c:@F@foo#"}};
+  EXPECT_EQ(tooling::getFilesWithUSROccurrences({Caller, Other, Unindexed},
+                                                RecordDir, FooUSRs),
+            std::vector<std::string>({Caller, Unindexed}));
+  std::vector<std::vector<std::string>> QuxUSRs = {{"c:@F@qux#"}};
+  EXPECT_EQ(
+      tooling::getFilesWithUSROccurrences({Caller, Other}, RecordDir, QuxUSRs),
+      std::vector<std::string>());
+
+  llvm::sys::fs::remove_directories(Dir);
+}
+
 } // anonymous namespace
 } // namespace test
 } // namespace clang_rename
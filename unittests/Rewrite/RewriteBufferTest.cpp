@@ -53,6 +53,49 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_OUTPUT(Buf, Output);
 }
 
+TEST(RewriteBuffer, WriteRange) {
+  RewriteBuffer Buf;
+  Buf.Initialize("hello world");
+  Buf.InsertTextAfter(5, ",");
+
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS, 3, 9);
+  EXPECT_EQ("lo, wo", OS.str());
+}
+
+TEST(RewriteBuffer, ApplyEdits) {
+  StringRef Input = "int x = 0;\n"
+                    "int y = 1;\n";
+  const char *Output = "static int a = 0;\n"
+                       "// y\n"
+                       "const int y = 2;\n";
+
+  RewriteBuffer Buf, Expected;
+  Buf.Initialize(Input);
+  Expected.Initialize(Input);
+  Buf.InsertTextAfter(0, "static ");
+  Expected.InsertTextAfter(0, "static ");
+
+  RewriteBuffer::Edit Edits[] = {
+      {19, 1, "2"}, {4, 1, "a"}, {11, 0, "// y\n"}, {11, 0, "const "}};
+  Buf.ApplyEdits(Edits);
+  for (const RewriteBuffer::Edit &E : Edits) {
+    if (E.OrigLength)
+      Expected.ReplaceText(E.OrigOffset, E.OrigLength, E.NewText);
+    else
+      Expected.InsertTextAfter(E.OrigOffset, E.NewText);
+  }
+  EXPECT_OUTPUT(Buf, Output);
+  EXPECT_OUTPUT(Expected, Output);
+
+  // The later edits are mapped through the applied ones.
+  Buf.InsertTextBefore(19, "-");
+  EXPECT_OUTPUT(Buf, "static int a = 0;\n"
+                     "// y\n"
+                     "const int y = -2;\n");
+}
+
 TEST(RewriteBuffer, DISABLED_RemoveLineIfEmpty_XFAIL) {
   StringRef Input = "def\n"
                     "ghi\n"
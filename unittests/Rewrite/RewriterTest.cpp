@@ -58,6 +58,30 @@ TEST(Rewriter, GetRewrittenTextRangeTypes) {
   EXPECT_EQ(T.Rewrite.getRewrittenText(T.SRange), "xreturn");
 }
 
+TEST(Rewriter, WriteRewrittenText) {
+  StringRef Code = "int main() { return 0; }";
+  RangeTypeTest T(Code, 13, 16);
+  T.Rewrite.InsertText(T.makeLoc(13), "x");
+  std::string Text;
+  llvm::raw_string_ostream OS(Text);
+  EXPECT_FALSE(T.Rewrite.writeRewrittenText(T.TRange, OS));
+  EXPECT_EQ(OS.str(), "xreturn");
+}
+
+TEST(Rewriter, ApplyEdits) {
+  // Check that the edits are applied regardless of their order, and that
+  // token ranges are extended to the whole token.
+  StringRef Code = "int main() { return 0; }";
+  RangeTypeTest T(Code, 0, 0);
+  Rewriter::Edit Edits[] = {
+      {T.makeCharRange(20, 21), "1"},
+      {T.makeCharRange(11, 11), " "},
+      {CharSourceRange::getTokenRange(T.makeLoc(0), T.makeLoc(0)), "long"}};
+  EXPECT_FALSE(T.Rewrite.ApplyEdits(Edits));
+  EXPECT_EQ(T.Rewrite.getRewrittenText(T.makeCharRange(0, 24)),
+            "long main()  { return 1; }");
+}
+
 TEST(Rewriter, ReplaceTextRangeTypes) {
   // Check that correct text is replaced for each range type.  Ranges remain in
   // terms of the original text but include the new text.
@@ -0,0 +1,118 @@
+//=== unittests/Sema/DeferredFunctionBodyTest.cpp - Deferred bodies tests ===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/Decl.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Sema/Sema.h"
+#include "clang/Sema/SemaConsumer.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringSet.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <string>
+
+namespace {
+
+using namespace clang;
+
+/// Defers all the function bodies, and parses the bodies of the functions
+/// named in \c ToParse at the end of the translation unit.
+class DeferringConsumer : public SemaConsumer {
+public:
+  DeferringConsumer(const llvm::StringSet<> &ToParse,
+                    std::map<std::string, bool> &HasBody)
+      : ToParse(ToParse), HasBody(HasBody) {}
+
+  void InitializeSema(Sema &S) override { TheSema = &S; }
+  void ForgetSema() override { TheSema = nullptr; }
+
+  bool shouldDeferFunctionBody(Decl *D) override {
+    Deferred.push_back(D->getAsFunction());
+    return true;
+  }
+
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    for (FunctionDecl *FD : Deferred) {
+      std::string Name = FD->getQualifiedNameAsString();
+      if (ToParse.count(Name))
+        EXPECT_TRUE(TheSema->ParseDeferredFunctionBody(FD)) << Name;
+      HasBody[Name] = FD->getBody() != nullptr;
+      EXPECT_EQ(FD->hasSkippedBody(), !HasBody[Name]) << Name;
+    }
+  }
+
+private:
+  const llvm::StringSet<> &ToParse;
+  std::map<std::string, bool> &HasBody;
+  std::vector<FunctionDecl *> Deferred;
+  Sema *TheSema = nullptr;
+};
+
+class DeferringAction : public ASTFrontendAction {
+public:
+  DeferringAction(const llvm::StringSet<> &ToParse,
+                  std::map<std::string, bool> &HasBody)
+      : ToParse(ToParse), HasBody(HasBody) {}
+
+  bool BeginInvocation(CompilerInstance &CI) override {
+    CI.getFrontendOpts().SkipFunctionBodies = true;
+    return true;
+  }
+
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                 StringRef) override {
+    return std::make_unique<DeferringConsumer>(ToParse, HasBody);
+  }
+
+private:
+  const llvm::StringSet<> &ToParse;
+  std::map<std::string, bool> &HasBody;
+};
+
+bool runDeferring(StringRef Code, const llvm::StringSet<> &ToParse,
+                  std::map<std::string, bool> &HasBody) {
+  return tooling::runToolOnCodeWithArgs(
+      std::make_unique<DeferringAction>(ToParse, HasBody), Code,
+      {"-std=c++14"});
+}
+
+const char Code[] = R"cpp(
+  int unused() { return undeclared; }
+  int f() { return 1; }
+  namespace ns {
+  int g(int x) { return x + f(); }
+  }
+  struct S {
+    S() : n(0) {}
+    int m() { return n + other(); }
+    int other() { return n; }
+    int n;
+  };
+  template <typename T> T t(T x) { return x; }
+)cpp";
+
+TEST(DeferredFunctionBodyTest, ParsesRequestedBodies) {
+  std::map<std::string, bool> HasBody;
+  EXPECT_TRUE(runDeferring(Code, {"f", "ns::g", "S::S", "S::m", "t"},
+                           HasBody));
+  EXPECT_FALSE(HasBody["unused"]);
+  EXPECT_TRUE(HasBody["f"]);
+  EXPECT_TRUE(HasBody["ns::g"]);
+  EXPECT_TRUE(HasBody["S::S"]);
+  EXPECT_TRUE(HasBody["S::m"]);
+  EXPECT_FALSE(HasBody["S::other"]);
+  EXPECT_TRUE(HasBody["t"]);
+}
+
+TEST(DeferredFunctionBodyTest, DiagnosesParsedBodies) {
+  std::map<std::string, bool> HasBody;
+  EXPECT_FALSE(runDeferring(Code, {"unused"}, HasBody));
+}
+
+} // namespace
@@ -0,0 +1,69 @@
+//=== unittests/Sema/PackDeductionTest.cpp - Large pack deduction tests ======//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <string>
+
+namespace {
+
+using namespace clang;
+using namespace clang::tooling;
+
+/// Build a translation unit that deduces packs of \p PackSize elements
+/// \p NumDeductions times, both for a function template and for a class
+/// template partial specialization.
+std::string makePackDeductionCode(unsigned PackSize, unsigned NumDeductions) {
+  std::string Code;
+  llvm::raw_string_ostream OS(Code);
+  OS << "template <typename... Ts> struct List {};\n"
+        "template <typename... Ts> constexpr unsigned size(List<Ts...>) {\n"
+        "  return sizeof...(Ts);\n"
+        "}\n"
+        "template <typename T> struct Tail;\n"
+        "template <typename T, typename... Ts> struct Tail<List<T, Ts...>> {\n"
+        "  using Type = List<Ts...>;\n"
+        "};\n";
+  for (unsigned I = 0; I != PackSize; ++I)
+    OS << "struct E" << I << ";\n";
+  OS << "using Big = List<";
+  for (unsigned I = 0; I != PackSize; ++I)
+    OS << (I ? ", E" : "E") << I;
+  OS << ">;\n";
+  for (unsigned I = 0; I != NumDeductions; ++I)
+    OS << "static_assert(size(Big()) == " << PackSize << ", \"\");\n";
+  OS << "static_assert(size(Tail<Big>::Type()) == " << PackSize - 1
+     << ", \"\");\n";
+  return OS.str();
+}
+
+TEST(PackDeductionTest, LargePacks) {
+  EXPECT_TRUE(runToolOnCodeWithArgs(std::make_unique<SyntaxOnlyAction>(),
+                                    makePackDeductionCode(1000, 10),
+                                    {"-std=c++14"}));
+}
+
+// A benchmark of the deduction time against the size of the packs. It doesn't
+// run by default; use --gtest_also_run_disabled_tests to run it.
+TEST(PackDeductionTest, DISABLED_DeductionTimeByPackSize) {
+  for (unsigned PackSize : {125, 250, 500, 1000, 2000}) {
+    std::string Code = makePackDeductionCode(PackSize, 200);
+    auto Start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(runToolOnCodeWithArgs(std::make_unique<SyntaxOnlyAction>(),
+                                      Code, {"-std=c++14"}));
+    auto Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - Start);
+    llvm::outs() << "pack size " << PackSize << ": " << Elapsed.count()
+                 << " ms\n";
+  }
+}
+
+} // namespace
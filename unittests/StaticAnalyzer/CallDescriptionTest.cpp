@@ -155,6 +155,18 @@ TEST(CallEvent, CallDescription) {
       "  __builtin___memset_chk(&x, 0, sizeof(x),"
       "                         __builtin_object_size(&x, 0));"
       "}"));
+
+  // The first matching description wins, even if it only may be a builtin.
+  EXPECT_TRUE(tooling::runToolOnCode(
+      std::unique_ptr<CallDescriptionAction>(new CallDescriptionAction({
+          {{CDF_MaybeBuiltin, "memset", 3}, true},
+          {{"memset", 3}, false}
+      })),
+      "void *memset(void *, int, __typeof(sizeof(int)));"
+      "void foo() {"
+      "  int x;"
+      "  memset(&x, 0, sizeof(x));"
+      "}"));
 }
 
 } // namespace
@@ -13,6 +13,7 @@
 #include "clang/Tooling/FileMatchTrie.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetSelect.h"
 #include "gmock/gmock.h"
@@ -205,6 +206,87 @@ TEST(JSONCompilationDatabase, ArgumentsPreferredOverCommand) {
    EXPECT_EQ(Arguments, FoundCommand.CommandLine[0]) << ErrorMessage;
 }
 
+TEST(JSONCompilationDatabase, UnescapesScannedValues) {
+  std::string ErrorMessage;
+  CompileCommand FoundCommand = findCompileArgsInJsonDatabase(
+      "//net/dir/f\u00e9.cc",
+      "[{\"directory\":\"//net/dir\",\"file\":\"f\\u00e9.cc\","
+      "\"arguments\":[\"clang\",\"-DA=\\\"\\ud83d\\ude00\\\"\",\"a\\\\b\\/c\"],"
+      "\"output\":\"f\\t.o\"}]",
+      ErrorMessage);
+  EXPECT_EQ("//net/dir", FoundCommand.Directory) << ErrorMessage;
+  EXPECT_EQ("f\u00e9.cc", FoundCommand.Filename) << ErrorMessage;
+  EXPECT_THAT(FoundCommand.CommandLine,
+              ElementsAre("clang", "-DA=\"\U0001F600\"", "a\\b/c"));
+  EXPECT_EQ("f\t.o", FoundCommand.Output);
+
+  // The databases which aren't plain JSON are parsed as YAML.
+  FoundCommand = findCompileArgsInJsonDatabase(
+      "//net/dir/file.cc",
+      "[{directory: '//net/dir', command: 'clang -c file.cc', "
+      "file: file.cc}]",
+      ErrorMessage);
+  EXPECT_EQ("//net/dir", FoundCommand.Directory) << ErrorMessage;
+  EXPECT_THAT(FoundCommand.CommandLine, ElementsAre("clang", "-c", "file.cc"));
+}
+
+TEST(JSONCompilationDatabase, LoadsFromCache) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("cdb-cache", Dir));
+  SmallString<128> JSONPath(Dir), CachePath(Dir);
+  llvm::sys::path::append(JSONPath, "compile_commands.json");
+  llvm::sys::path::append(CachePath, "compile_commands.json.cache");
+  auto WriteDatabase = [&](StringRef Command) {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(JSONPath, EC);
+    ASSERT_FALSE(EC);
+    OS << "[{\"directory\":\"//net/dir\",\"command\":\"" << Command
+       << "\",\"file\":\"file.cc\"},"
+          "{\"directory\":\"//net/dir\",\"arguments\":[\"a\\\\b\",\"c\"],"
+          "\"file\":\"other.cc\",\"output\":\"other.o\"}]";
+  };
+  auto Load = [&]() {
+    std::string ErrorMessage;
+    auto Database = JSONCompilationDatabase::loadFromFileWithCache(
+        JSONPath, CachePath, ErrorMessage, JSONCommandLineSyntax::Gnu);
+    EXPECT_TRUE(Database) << ErrorMessage;
+    return Database;
+  };
+
+  WriteDatabase("clang -DA file.cc");
+  auto Parsed = Load();
+  ASSERT_TRUE(Parsed);
+  llvm::sys::fs::UniqueID CacheID;
+  ASSERT_FALSE(llvm::sys::fs::getUniqueID(CachePath, CacheID));
+
+  // The cache is read rather than written again.
+  auto Cached = Load();
+  ASSERT_TRUE(Cached);
+  llvm::sys::fs::UniqueID ReadCacheID;
+  ASSERT_FALSE(llvm::sys::fs::getUniqueID(CachePath, ReadCacheID));
+  EXPECT_EQ(ReadCacheID, CacheID);
+  EXPECT_EQ(Cached->getAllFiles(), Parsed->getAllFiles());
+  std::vector<CompileCommand> Commands = Cached->getAllCompileCommands();
+  ASSERT_EQ(Commands.size(), 2u);
+  EXPECT_THAT(Commands[0].CommandLine, ElementsAre("clang", "-DA", "file.cc"));
+  EXPECT_THAT(Commands[1].CommandLine, ElementsAre("a\\b", "c"));
+  EXPECT_EQ(Commands[1].Output, "other.o");
+  Commands = Cached->getCompileCommands("//net/dir/other.cc");
+  ASSERT_EQ(Commands.size(), 1u);
+  EXPECT_EQ(Commands[0].Filename, "other.cc");
+
+  // A modified file is parsed again.
+  WriteDatabase("clang -DLONGER file.cc");
+  auto Reparsed = Load();
+  ASSERT_TRUE(Reparsed);
+  Commands = Reparsed->getCompileCommands("//net/dir/file.cc");
+  ASSERT_EQ(Commands.size(), 1u);
+  EXPECT_THAT(Commands[0].CommandLine,
+              ElementsAre("clang", "-DLONGER", "file.cc"));
+
+  llvm::sys::fs::remove_directories(Dir);
+}
+
 struct FakeComparator : public PathComparator {
   ~FakeComparator() override {}
   bool equivalent(StringRef FileA, StringRef FileB) const override {
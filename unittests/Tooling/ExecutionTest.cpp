@@ -10,6 +10,8 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
@@ -18,6 +20,11 @@
 #include "clang/Tooling/StandaloneExecution.h"
 #include "clang/Tooling/ToolExecutorPluginRegistry.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include <algorithm>
@@ -265,6 +272,121 @@ TEST(AllTUsToolTest, AFewFiles) {
   Filter.setValue(".*"); // reset to default value.
 }
 
+class ReportFunctionName : public ast_matchers::MatchFinder::MatchCallback {
+public:
+  explicit ReportFunctionName(ExecutionContext *Context) : Context(Context) {}
+  void run(const ast_matchers::MatchFinder::MatchResult &Result) override {
+    const auto *D = Result.Nodes.getNodeAs<FunctionDecl>("f");
+    Context->reportResult(D->getNameAsString(), "1");
+  }
+
+private:
+  ExecutionContext *const Context;
+};
+
+TEST(AllTUsToolTest, SharesMatchFinder) {
+  FixedCompilationDatabaseWithFiles Compilations(
+      ".", {"a.cc", "b.cc", "c.cc"}, std::vector<std::string>());
+  AllTUsToolExecutor Executor(Compilations, /*ThreadCount=*/0);
+  Executor.mapVirtualFile("a.cc", "void x() {} int i;");
+  Executor.mapVirtualFile("b.cc", "void y() {}");
+  Executor.mapVirtualFile("c.cc", "void z();");
+
+  // The matchers are set up once, and used by all of the translation units.
+  ReportFunctionName Callback(Executor.getExecutionContext());
+  ast_matchers::MatchFinder Finder;
+  Finder.addMatcher(
+      ast_matchers::functionDecl(ast_matchers::isDefinition()).bind("f"),
+      &Callback);
+  auto Err = Executor.execute(newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(!Err);
+  EXPECT_THAT(Executor.getToolResults()->AllKVResults(),
+              ::testing::UnorderedElementsAre(Named("x"), Named("y")));
+}
+
+TEST(AllTUsToolTest, ShardsAndResumesFromCheckpoint) {
+  llvm::SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("alltus", Dir));
+  llvm::SmallString<128> Checkpoint(Dir);
+  llvm::sys::path::append(Checkpoint, "checkpoint");
+  llvm::SmallString<128> ResultsPath(Dir);
+  llvm::sys::path::append(ResultsPath, "results");
+
+  FixedCompilationDatabaseWithFiles Compilations(
+      ".", {"d.cc", "c.cc", "b.cc", "a.cc"}, std::vector<std::string>());
+  auto Run = [&](StringRef ShardValue) {
+    Shard.setValue(ShardValue);
+    CheckpointFile.setValue(Checkpoint.str());
+    ResultsFile.setValue(ResultsPath.str());
+    AllTUsToolExecutor Executor(Compilations, /*ThreadCount=*/0);
+    Executor.mapVirtualFile("a.cc", "void a() {}");
+    Executor.mapVirtualFile("b.cc", "void b() {}");
+    Executor.mapVirtualFile("c.cc", "void c() {}");
+    Executor.mapVirtualFile("d.cc", "void d() {}");
+    auto Err = Executor.execute(std::unique_ptr<FrontendActionFactory>(
+        new ReportResultActionFactory(Executor.getExecutionContext())));
+    EXPECT_TRUE(!Err);
+    std::vector<std::string> Keys;
+    Executor.getToolResults()->forEachResult(
+        [&](StringRef Key, StringRef) { Keys.push_back(Key); });
+    return Keys;
+  };
+
+  // The first shard of the sorted files is a.cc and c.cc.
+  EXPECT_THAT(Run("0/2"), ::testing::UnorderedElementsAre("a", "c"));
+  // The processed files are skipped, and the results of the earlier
+  // execution are kept.
+  EXPECT_THAT(Run("0/1"),
+              ::testing::UnorderedElementsAre("a", "b", "c", "d"));
+  auto Buffer = llvm::MemoryBuffer::getFile(Checkpoint);
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ(4u, (*Buffer)->getBuffer().count('\n'));
+
+  Shard.setValue("");
+  CheckpointFile.setValue("");
+  ResultsFile.setValue("");
+  llvm::sys::fs::remove_directories(Dir);
+}
+
+TEST(AllTUsToolTest, LongestFilesFirst) {
+  llvm::SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("alltus", Dir));
+  llvm::SmallString<128> Timings(Dir);
+  llvm::sys::path::append(Timings, "timings");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Timings, EC);
+    ASSERT_FALSE(EC);
+    OS << "1 a.cc\n300 b.cc\n20 c.cc\n";
+  }
+
+  FixedCompilationDatabaseWithFiles Compilations(
+      ".", {"a.cc", "b.cc", "c.cc", "d.cc"}, std::vector<std::string>());
+  TimingsFile.setValue(Timings.str());
+  AllTUsToolExecutor Executor(Compilations, /*ThreadCount=*/1);
+  Executor.mapVirtualFile("a.cc", "void a() {}");
+  Executor.mapVirtualFile("b.cc", "void b() {}");
+  Executor.mapVirtualFile("c.cc", "void c() {}");
+  Executor.mapVirtualFile("d.cc", "void d() {}");
+  auto Err = Executor.execute(std::unique_ptr<FrontendActionFactory>(
+      new ReportResultActionFactory(Executor.getExecutionContext())));
+  EXPECT_TRUE(!Err);
+
+  // The file without a timing comes first.
+  std::vector<std::string> Keys;
+  Executor.getToolResults()->forEachResult(
+      [&](StringRef Key, StringRef) { Keys.push_back(Key); });
+  EXPECT_THAT(Keys, ::testing::ElementsAre("d", "b", "c", "a"));
+
+  // All the files are timed again.
+  auto Buffer = llvm::MemoryBuffer::getFile(Timings);
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ(4u, (*Buffer)->getBuffer().count('\n'));
+
+  TimingsFile.setValue("");
+  llvm::sys::fs::remove_directories(Dir);
+}
+
 TEST(AllTUsToolTest, ManyFiles) {
   unsigned NumFiles = 100;
   std::vector<std::string> Files;
@@ -508,6 +508,26 @@ TEST_F(ReplacementTest, InvalidSourceLocationFailsApplyAll) {
   EXPECT_FALSE(applyAllReplacements(Replaces, Context.Rewrite));
 }
 
+TEST(ApplyAllReplacementsTest, StreamsCodeWithReplacements) {
+  Replacements Replaces;
+  // Added in order, then before the others.
+  EXPECT_TRUE(!Replaces.add(Replacement("x.cc", 4, 3, "y")));
+  EXPECT_TRUE(!Replaces.add(Replacement("x.cc", 9, 0, "long ")));
+  EXPECT_TRUE(!Replaces.add(Replacement("x.cc", 0, 3, "char")));
+  EXPECT_TRUE(!Replaces.add(Replacement("x.cc", 9, 3, "int")));
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  EXPECT_TRUE(!applyAllReplacements("int xxx; int z;", Replaces, OS));
+  EXPECT_EQ("char y; long int z;", OS.str());
+
+  std::string Ignored;
+  llvm::raw_string_ostream IgnoredOS(Ignored);
+  llvm::Error Err = applyAllReplacements(
+      "int", toReplacements({Replacement("x.cc", 2, 2, "")}), IgnoredOS);
+  EXPECT_TRUE(bool(Err));
+  llvm::consumeError(std::move(Err));
+}
+
 TEST_F(ReplacementTest, MultipleFilesReplaceAndFormat) {
   // Column limit is 20.
   std::string Code1 = "Long *a =\n"
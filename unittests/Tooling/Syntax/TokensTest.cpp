@@ -92,11 +92,12 @@ public:
   void recordTokens(llvm::StringRef Code) {
     class RecordTokens : public ASTFrontendAction {
     public:
-      explicit RecordTokens(TokenBuffer &Result) : Result(Result) {}
+      RecordTokens(TokenBuffer &Result, SpelledTokenCache *SharedTokens)
+          : Result(Result), SharedTokens(SharedTokens) {}
 
       bool BeginSourceFileAction(CompilerInstance &CI) override {
         assert(!Collector && "expected only a single call to BeginSourceFile");
-        Collector.emplace(CI.getPreprocessor());
+        Collector.emplace(CI.getPreprocessor(), SharedTokens);
         return true;
       }
       void EndSourceFileAction() override {
@@ -111,6 +112,7 @@ public:
 
     private:
       TokenBuffer &Result;
+      SpelledTokenCache *SharedTokens;
       llvm::Optional<TokenCollector> Collector;
     };
 
@@ -133,7 +135,7 @@ public:
     Compiler.setSourceManager(SourceMgr.get());
 
     this->Buffer = TokenBuffer(*SourceMgr);
-    RecordTokens Recorder(this->Buffer);
+    RecordTokens Recorder(this->Buffer, SharedTokens);
     ASSERT_TRUE(Compiler.ExecuteAction(Recorder))
         << "failed to run the frontend";
   }
@@ -244,6 +246,8 @@ public:
       new SourceManager(*Diags, *FileMgr);
   /// Contains last result of calling recordTokens().
   TokenBuffer Buffer = TokenBuffer(*SourceMgr);
+  /// The cache passed to the TokenCollector by recordTokens(), if any.
+  SpelledTokenCache *SharedTokens = nullptr;
 };
 
 TEST_F(TokenCollectorTest, RawMode) {
@@ -574,6 +578,25 @@ file './bar.h'
       << "input: " << Code << "\nresults: " << collectAndDump(Code);
 }
 
+TEST_F(TokenCollectorTest, SharedSpelledTokens) {
+  addFile("./foo.h", R"cpp(
+    #define ADD(X, Y) X+Y
+    int a = ADD(1, 2);
+  )cpp");
+  llvm::StringLiteral Code = R"cpp(
+    #include "foo.h"
+    int c = ADD(a, 3);
+  )cpp";
+  std::string Expected = collectAndDump(Code);
+
+  SpelledTokenCache Cache;
+  SharedTokens = &Cache;
+  // The tokens of foo.h are added to the cache, and then reused.
+  EXPECT_EQ(Expected, collectAndDump(Code));
+  EXPECT_EQ(Expected, collectAndDump(Code));
+  SharedTokens = nullptr;
+}
+
 class TokenBufferTest : public TokenCollectorTest {};
 
 TEST_F(TokenBufferTest, SpelledByExpanded) {
@@ -429,6 +429,29 @@ TEST(ClangToolTest, NoDoubleSyntaxOnly) {
   EXPECT_EQ(SyntaxOnlyCount, 1U);
 }
 
+TEST(ClangToolTest, NoSyntaxOnlyWhenAnalyzing) {
+  FixedCompilationDatabase Compilations("/", {"--analyze"});
+
+  ClangTool Tool(Compilations, std::vector<std::string>(1, "/a.cc"));
+  Tool.mapVirtualFile("/a.cc", "void a() {}");
+
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+
+  CommandLineArguments FinalArgs;
+  ArgumentsAdjuster CheckFlagsAdjuster =
+      [&FinalArgs](const CommandLineArguments &Args, StringRef /*unused*/) {
+        FinalArgs = Args;
+        return Args;
+      };
+  Tool.clearArgumentsAdjusters();
+  Tool.appendArgumentsAdjuster(getClangSyntaxOnlyAdjuster());
+  Tool.appendArgumentsAdjuster(CheckFlagsAdjuster);
+  Tool.run(Action.get());
+  EXPECT_EQ(llvm::find(FinalArgs, "-fsyntax-only"), FinalArgs.end());
+  EXPECT_NE(llvm::find(FinalArgs, "--analyze"), FinalArgs.end());
+}
+
 TEST(ClangToolTest, BaseVirtualFileSystemUsage) {
   FixedCompilationDatabase Compilations("/", std::vector<std::string>());
   llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> OverlayFileSystem(
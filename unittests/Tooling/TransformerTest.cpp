@@ -614,6 +614,47 @@ TEST_F(TransformerTest, OverlappingEditsMultipleMatches) {
   EXPECT_EQ(ErrorCount, 0);
 }
 
+TEST_F(TransformerTest, RuleSetAppliesIndependentRules) {
+  std::string Input = R"cc(
+    int f(string s) { return strlen(s.c_str()); }
+    int g(int x) { return x; }
+  )cc";
+  std::string Expected = R"cc(
+    int f(string s) { return REPLACED; }
+    int h(int x) { return x; }
+  )cc";
+  std::vector<RewriteRule> Rules;
+  Rules.push_back(ruleStrlenSize());
+  Rules.push_back(makeRule(functionDecl(hasName("g")).bind("fun"),
+                           change(name("fun"), text("h"))));
+  RuleSetTransformer T(std::move(Rules), consumer());
+  T.registerMatchers(&MatchFinder);
+  compareSnippets(Expected, rewrite(Input));
+}
+
+// Tests that the set drops the matches whose edits conflict with the edits of
+// earlier matches, without generating their replacements.
+TEST_F(TransformerTest, RuleSetDropsConflictingMatches) {
+  std::string Input = "int conflictOneRule() { return -7; }";
+  std::string Expected = "int conflictOneRule() { return DELETE_EXPR; }";
+  StringRef E = "E", L = "L";
+  int Generated = 0;
+  auto Count = [&Generated](const ast_matchers::MatchFinder::MatchResult &)
+      -> llvm::Expected<std::string> {
+    ++Generated;
+    return "DELETE_LITERAL";
+  };
+  std::vector<RewriteRule> Rules;
+  Rules.push_back(makeRule(unaryOperator().bind(E),
+                           change(node(E), text("DELETE_EXPR"))));
+  Rules.push_back(makeRule(integerLiteral().bind(L), change(node(L), Count)));
+  RuleSetTransformer T(std::move(Rules), consumer());
+  T.registerMatchers(&MatchFinder);
+  compareSnippets(Expected, rewrite(Input));
+  EXPECT_EQ(Changes.size(), 1u);
+  EXPECT_EQ(Generated, 0);
+}
+
 TEST_F(TransformerTest, ErrorOccurredMatchSkipped) {
   // Syntax error in the function body:
   std::string Input = "void errorOccurred() { 3 }";
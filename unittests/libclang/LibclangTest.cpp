@@ -562,6 +562,33 @@ TEST_F(LibclangReparseTest, clang_parseTranslationUnit2FullArgv) {
   DisplayDiagnostics();
 }
 
+TEST_F(LibclangReparseTest, Cancellation) {
+  std::string CppName = "main.cpp";
+  WriteFile(CppName, "int a;\nint b;\nint c;\n");
+  CXCancellationToken Token = clang_createCancellationToken();
+
+  EXPECT_EQ(CXError_Success, clang_parseTranslationUnitCancellable(
+                                 Index, CppName.c_str(), nullptr, 0, nullptr,
+                                 0, TUFlags, Token, &ClangTU));
+  ASSERT_TRUE(ClangTU != nullptr);
+
+  // The parse stops after the first declaration.
+  clang_cancel(Token);
+  CXTranslationUnit CancelledTU;
+  EXPECT_EQ(CXError_Cancelled, clang_parseTranslationUnitCancellable(
+                                   Index, CppName.c_str(), nullptr, 0,
+                                   nullptr, 0, TUFlags, Token, &CancelledTU));
+  EXPECT_EQ(nullptr, CancelledTU);
+  EXPECT_EQ(nullptr, clang_codeCompleteAtCancellable(
+                         ClangTU, CppName.c_str(), 3, 1, nullptr, 0,
+                         clang_defaultCodeCompleteOptions(), Token));
+  EXPECT_EQ(CXError_Cancelled,
+            clang_reparseTranslationUnitCancellable(
+                ClangTU, 0, nullptr, clang_defaultReparseOptions(ClangTU),
+                Token));
+  clang_disposeCancellationToken(Token);
+}
+
 class LibclangPrintingPolicyTest : public LibclangParseTest {
 public:
   CXPrintingPolicy Policy = nullptr;
@@ -0,0 +1,145 @@
+#!/usr/bin/env python
+
+"""
+Script to find the clones between translation units from the fingerprints
+that alpha.clone.CloneChecker writes.
+
+The fingerprints are written when the checker is given a directory:
+
+  clang --analyze -Xanalyzer -analyzer-checker=alpha.clone.CloneChecker \\
+    -Xanalyzer -analyzer-config \\
+    -Xanalyzer alpha.clone.CloneChecker:FingerprintDirectory=<dir> ...
+
+Each translation unit writes a file of its own, so the translation units can
+be analyzed in parallel. This script then reads the files of the directory in
+parallel, and prints the groups of code with the same fingerprint, excluding
+the groups that are fully contained in larger groups.
+
+Usage:
+
+  MergeCloneFingerprints.py [-j <jobs>] [--cross-tu-only] <dir>
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import multiprocessing
+import os
+import sys
+from collections import defaultdict
+
+
+def loadFingerprints(Path):
+    """Returns the (hash, location) pairs of a fingerprint file, where a
+    location is a (file, begin line, begin column, end line, end column)
+    tuple."""
+    Result = []
+    with open(Path, 'r') as F:
+        for Line in F:
+            Fields = Line.rstrip('\n').split('\t')
+            if len(Fields) != 6:
+                continue
+            Result.append((Fields[0], (Fields[1], int(Fields[2]),
+                                       int(Fields[3]), int(Fields[4]),
+                                       int(Fields[5]))))
+    return Path, Result
+
+
+def contains(Outer, Inner):
+    """Returns whether the location Outer contains the location Inner."""
+    return (Outer[0] == Inner[0] and
+            (Outer[1], Outer[2]) <= (Inner[1], Inner[2]) and
+            (Outer[3], Outer[4]) >= (Inner[3], Inner[4]))
+
+
+def containsGroup(Group, OtherGroup):
+    """Returns whether every location in Group contains a location in
+    OtherGroup, like OnlyLargestCloneConstraint does."""
+    if len(Group) < len(OtherGroup):
+        return False
+    return all(any(contains(Loc, Other) for Other in OtherGroup)
+               for Loc in Group)
+
+
+# The groups and the index of the groups by file, set in each worker.
+Groups = []
+GroupsByFile = {}
+
+
+def initWorker(AllGroups, AllGroupsByFile):
+    global Groups, GroupsByFile
+    Groups = AllGroups
+    GroupsByFile = AllGroupsByFile
+
+
+def isContainedInOtherGroup(Index):
+    Group = Groups[Index]
+    for Other in GroupsByFile[Group[0][0]]:
+        if Other != Index and containsGroup(Groups[Other], Group):
+            return True
+    return False
+
+
+def formatLocation(Loc):
+    return '%s:%d:%d-%d:%d' % Loc
+
+
+def main():
+    Parser = argparse.ArgumentParser(
+        description='Find the clones between translation units from the '
+                    'fingerprints written by alpha.clone.CloneChecker.')
+    Parser.add_argument('directory',
+                        help='the FingerprintDirectory of the checker')
+    Parser.add_argument('-j', '--jobs', type=int,
+                        default=multiprocessing.cpu_count(),
+                        help='the number of files read in parallel')
+    Parser.add_argument('--cross-tu-only', action='store_true',
+                        help='only print the groups with clones written by '
+                             'several translation units')
+    Args = Parser.parse_args()
+
+    Paths = [os.path.join(Args.directory, Name)
+             for Name in sorted(os.listdir(Args.directory))
+             if Name.startswith('clones-') and Name.endswith('.txt')]
+
+    # The same code can be written by several translation units, e.g. when it
+    # is in a header, so the locations of a hash are a set.
+    LocationsByHash = defaultdict(set)
+    PathsByHash = defaultdict(set)
+    Pool = multiprocessing.Pool(max(Args.jobs, 1))
+    for Path, Fingerprints in Pool.imap_unordered(loadFingerprints, Paths):
+        for Hash, Loc in Fingerprints:
+            LocationsByHash[Hash].add(Loc)
+            PathsByHash[Hash].add(Path)
+    Pool.close()
+    Pool.join()
+
+    for Hash in sorted(LocationsByHash):
+        Locations = LocationsByHash[Hash]
+        if len(Locations) < 2:
+            continue
+        if Args.cross_tu_only and len(PathsByHash[Hash]) < 2:
+            continue
+        Groups.append(sorted(Locations))
+    ByFile = defaultdict(set)
+    for Index, Group in enumerate(Groups):
+        for Loc in Group:
+            ByFile[Loc[0]].add(Index)
+
+    Pool = multiprocessing.Pool(max(Args.jobs, 1), initWorker,
+                                (Groups, dict(ByFile)))
+    Contained = Pool.map(isContainedInOtherGroup, range(len(Groups)),
+                         chunksize=64)
+    Pool.close()
+    Pool.join()
+
+    Result = [Group for Group, IsContained in zip(Groups, Contained)
+              if not IsContained]
+    for Group in Result:
+        print('Clone group (%d clones):' % len(Group))
+        for Loc in Group:
+            print('  ' + formatLocation(Loc))
+    print('%d clone groups found.' % len(Result), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,52 @@
+#!/usr/bin/env python
+"""Merge the -fheader-cost-report reports of several translation units.
+
+The entries of the reports are keyed by header path, and the costs of the
+entries with the same path are added up, so that translation_units counts the
+translation units which include each header. The merged report is written to
+stdout in the same format, most expensive headers first.
+
+Usage: merge-header-cost-reports.py [--sort=FIELD] REPORT...
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+FIELDS = ['translation_units', 'count', 'inclusive_us', 'exclusive_us',
+          'inclusive_bytes', 'exclusive_bytes']
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--sort', choices=FIELDS, default='exclusive_us',
+                        help='the field to sort the merged entries by')
+    parser.add_argument('reports', nargs='+', metavar='REPORT')
+    args = parser.parse_args()
+
+    merged = {}
+    for path in args.reports:
+        with open(path) as f:
+            report = json.load(f)
+        if report.get('version') != 1:
+            print('%s: unsupported report version' % path, file=sys.stderr)
+            return 1
+        for entry in report['headers']:
+            total = merged.setdefault(
+                entry['path'],
+                dict(path=entry['path'], **{field: 0 for field in FIELDS}))
+            for field in FIELDS:
+                total[field] += entry[field]
+
+    headers = sorted(merged.values(), key=lambda e: e[args.sort],
+                     reverse=True)
+    json.dump({'version': 1, 'headers': headers}, sys.stdout, indent=2,
+              sort_keys=True)
+    print()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,52 @@
+#!/usr/bin/env python
+"""Merge the -ftemplate-profile reports of several translation units.
+
+The entries of the reports are keyed by template name and location, and the
+costs of the entries with the same key are added up. The merged report is
+written to stdout in the same format, most expensive templates first.
+
+Usage: merge-template-profiles.py [--sort=FIELD] REPORT...
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+FIELDS = ['count', 'inclusive_us', 'exclusive_us', 'inclusive_bytes',
+          'exclusive_bytes']
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--sort', choices=FIELDS, default='exclusive_us',
+                        help='the field to sort the merged entries by')
+    parser.add_argument('reports', nargs='+', metavar='REPORT')
+    args = parser.parse_args()
+
+    merged = {}
+    for path in args.reports:
+        with open(path) as f:
+            report = json.load(f)
+        if report.get('version') != 1:
+            print('%s: unsupported report version' % path, file=sys.stderr)
+            return 1
+        for entry in report['templates']:
+            key = (entry['name'], entry['location'])
+            total = merged.setdefault(
+                key, dict(name=key[0], location=key[1],
+                          **{field: 0 for field in FIELDS}))
+            for field in FIELDS:
+                total[field] += entry[field]
+
+    templates = sorted(merged.values(), key=lambda e: e[args.sort],
+                       reverse=True)
+    json.dump({'version': 1, 'templates': templates}, sys.stdout, indent=2,
+              sort_keys=True)
+    print()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,366 @@
+#!/usr/bin/env python
+#===- clang-perf.py - Clang compile-time benchmarks ----------*- python -*--===#
+#
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+#
+#===------------------------------------------------------------------------===#
+
+"""Measure the compile time of clang on stress inputs and real-world TUs.
+
+The 'generate' command writes the synthetic inputs, 'run' compiles them and
+writes the measurements as JSON, and 'compare' reports the measurements which
+regressed with respect to a baseline. See README.txt.
+"""
+
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import json
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+#===------------------------------------------------------------------------===#
+# Synthetic inputs
+#===------------------------------------------------------------------------===#
+
+def genTemplateRecursion(scale):
+  # Each chain stays below the default -ftemplate-depth.
+  chains = ''.join(
+      'int chain%d(const Chain<%d, 500> &C) { return C.get(); }\n' % (i, i)
+      for i in range(scale))
+  return """\
+template <unsigned N> struct Fib {
+  static constexpr unsigned long long value =
+      Fib<N - 1>::value + Fib<N - 2>::value;
+};
+template <> struct Fib<1> { static constexpr unsigned long long value = 1; };
+template <> struct Fib<0> { static constexpr unsigned long long value = 0; };
+
+template <unsigned K, unsigned N> struct Chain : Chain<K, N - 1> {
+  int member[(N + K) % 7 + 1];
+  int get() const { return member[0] + Chain<K, N - 1>::get(); }
+};
+template <unsigned K> struct Chain<K, 0> {
+  int get() const { return 0; }
+};
+
+unsigned long long fib() { return Fib<90>::value; }
+""" + chains
+
+def genEnumSwitch(scale):
+  count = 5000 * scale
+  lines = ['enum Big {']
+  lines.extend('  E%d,' % i for i in range(count))
+  lines.append('};')
+  lines.append('int lookup(Big B) {')
+  lines.append('  switch (B) {')
+  lines.extend('  case E%d: return %d;' % (i, i * 3) for i in range(count))
+  lines.append('  }')
+  lines.append('  return -1;')
+  lines.append('}')
+  return '\n'.join(lines) + '\n'
+
+def genStateMachine(scale):
+  # A generated interpreter: a switch with a case per state, some of which
+  # fall through to the next one.
+  count = 50000 * scale
+  lines = ['int step(unsigned State, int *Regs) {', '  switch (State) {']
+  for i in range(count):
+    lines.append('  case %d:' % i)
+    if i % 4 != 3:
+      lines.append('    Regs[%d] += %d;' % (i % 16, i))
+      lines.append('    return %d;' % ((i * 7 + 1) % count))
+  lines.append('  default:')
+  lines.append('    return -1;')
+  lines.append('  }')
+  lines.append('}')
+  return '\n'.join(lines) + '\n'
+
+def genMacroHeader(scale):
+  count = 2000 * scale
+  lines = ['#define CAT_(A, B) A##B', '#define CAT(A, B) CAT_(A, B)',
+           '#define ID(X) X', '#define TWICE(X) ID(X) + ID(X)',
+           '#define FOUR(X) TWICE(X) + TWICE(X)']
+  for i in range(count):
+    lines.append('#define M%d(X) (FOUR(X) + %d)' % (i, i))
+  for i in range(count):
+    lines.append('static const int CAT(v, %d) = M%d(1);' % (i, i))
+  return '\n'.join(lines) + '\n'
+
+def genInitializerList(scale):
+  count = 100000 * scale
+  values = ','.join(str(i % 251) for i in range(count))
+  return ('struct Pair { int A; double B; };\n'
+          'extern const int Table[] = {%s};\n'
+          'extern const Pair Pairs[] = {%s};\n' %
+          (values, ','.join('{%d, %d.5}' % (i, i)
+                            for i in range(count // 10))))
+
+def genModules(dir, scale):
+  count = 100 * scale
+  modmap = []
+  for i in range(count):
+    with open(os.path.join(dir, 'mod%d.h' % i), 'w') as f:
+      f.write('#pragma once\n')
+      if i:
+        f.write('#include "mod%d.h"\n' % (i - 1))
+      f.write('struct S%d { int X[%d]; };\n' % (i, i + 1))
+      f.write('inline int f%d() { return sizeof(S%d); }\n' % (i, i))
+    modmap.append('module mod%d { header "mod%d.h" export * }' % (i, i))
+  with open(os.path.join(dir, 'module.modulemap'), 'w') as f:
+    f.write('\n'.join(modmap) + '\n')
+  return ''.join('@import mod%d;\n' % i for i in range(count)) + \
+      'int sum() { return %s; }\n' % ' + '.join(
+          'f%d()' % i for i in range(0, count, 10))
+
+# The name, file name and extra flags of each synthetic benchmark.
+syntheticBenchmarks = [
+  ('template-recursion', 'template-recursion.cpp', genTemplateRecursion, []),
+  ('enum-switch', 'enum-switch.cpp', genEnumSwitch, []),
+  ('state-machine', 'state-machine.c', genStateMachine, []),
+  ('macro-header', 'macro-header.c', genMacroHeader, []),
+  ('initializer-list', 'initializer-list.cpp', genInitializerList, []),
+  ('module-imports', 'module-imports.m', None,
+   ['-fmodules', '-fmodules-cache-path=%(tmp)s/modules', '-I%(dir)s']),
+]
+
+def generate(args):
+  parser = argparse.ArgumentParser(prog='clang-perf generate',
+    description='Write the synthetic benchmark inputs')
+  parser.add_argument('--scale', type=int, default=1,
+    help='Multiplier of the size of the inputs (default 1)')
+  parser.add_argument('dir', help='Output directory')
+  opts = parser.parse_args(args)
+
+  if not os.path.isdir(opts.dir):
+    os.makedirs(opts.dir)
+  for name, filename, gen, _ in syntheticBenchmarks:
+    if gen:
+      text = gen(opts.scale)
+    else:
+      moddir = os.path.join(opts.dir, 'modules')
+      if not os.path.isdir(moddir):
+        os.makedirs(moddir)
+      text = genModules(moddir, opts.scale)
+    with open(os.path.join(opts.dir, filename), 'w') as f:
+      f.write(text)
+  return 0
+
+#===------------------------------------------------------------------------===#
+# Measurements
+#===------------------------------------------------------------------------===#
+
+def parseTimeTrace(path):
+  """Returns the duration in ms of each 'Total' event of a -ftime-trace file,
+  keyed by the name of the phase."""
+  phases = {}
+  with open(path) as f:
+    trace = json.load(f)
+  for event in trace.get('traceEvents', []):
+    name = event.get('name', '')
+    if name.startswith('Total '):
+      phases[name[len('Total '):]] = event.get('dur', 0) / 1000.0
+  return phases
+
+def parseStats(text):
+  """Returns the counters of the -print-stats output, keyed by their
+  section and description."""
+  stats = {}
+  section = ''
+  for line in text.splitlines():
+    if line.startswith('***'):
+      section = line.strip('* :')
+      continue
+    m = re.match(r'^\s*(\d+) ([^0-9].*?)\.?$', line)
+    if m and section:
+      stats['%s: %s' % (section, m.group(2))] = int(m.group(1))
+  return stats
+
+def runMeasured(cmd, perf):
+  """Runs cmd and returns its wall time in ms, peak RSS in KB, instruction
+  count (or None) and stderr."""
+  if perf:
+    cmd = [perf, 'stat', '-x,', '-e', 'instructions:u', '--'] + cmd
+  start = time.time()
+  proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL,
+                          stderr=subprocess.PIPE, universal_newlines=True)
+  stderr = proc.stderr.read()
+  _, status, rusage = os.wait4(proc.pid, 0)
+  proc.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else 1
+  wall = (time.time() - start) * 1000.0
+  if proc.returncode:
+    raise RuntimeError('command failed: %s\n%s' % (' '.join(cmd), stderr))
+
+  instructions = None
+  if perf:
+    for line in stderr.splitlines():
+      fields = line.split(',')
+      if len(fields) > 2 and fields[2].startswith('instructions'):
+        try:
+          instructions = int(fields[0])
+        except ValueError:
+          pass
+  # ru_maxrss is in KB on Linux, and in bytes on Darwin.
+  rss = rusage.ru_maxrss
+  if sys.platform == 'darwin':
+    rss //= 1024
+  return wall, rss, instructions, stderr
+
+def measure(clang, name, input, flags, repeat, perf, tmp):
+  """Compiles input repeat times and keeps the fastest run."""
+  output = os.path.join(tmp, name + '.o')
+  cmd = [clang, '-c', input, '-o', output, '-ftime-trace',
+         '-Xclang', '-print-stats'] + flags
+  best = None
+  for _ in range(repeat):
+    wall, rss, instructions, stderr = runMeasured(cmd, perf)
+    if best and wall >= best['wall_ms']:
+      continue
+    best = {'wall_ms': wall, 'peak_rss_kb': rss,
+            'phases_ms': parseTimeTrace(os.path.splitext(output)[0] +
+                                        '.json'),
+            'stats': parseStats(stderr)}
+    if instructions is not None:
+      best['instructions'] = instructions
+  return best
+
+def realWorldBenchmarks(path):
+  """Returns the name, file and flags of the TUs of a compilation database."""
+  with open(path) as f:
+    commands = json.load(f)
+  benchmarks = []
+  for entry in commands:
+    args = entry.get('arguments') or shlex.split(entry['command'])
+    file = os.path.join(entry['directory'], entry['file'])
+    # Drop the compiler, the inputs and the outputs.
+    flags, skip = [], False
+    for arg in args[1:]:
+      if skip:
+        skip = False
+      elif arg == '-o':
+        skip = True
+      elif arg != '-c' and arg != entry['file'] and arg != file:
+        flags.append(arg)
+    flags.append('-working-directory=' + entry['directory'])
+    name = os.path.relpath(file, os.path.dirname(os.path.abspath(path)))
+    benchmarks.append((name.replace(os.sep, '_'), file, flags))
+  return benchmarks
+
+def run(args):
+  parser = argparse.ArgumentParser(prog='clang-perf run',
+    description='Compile the benchmarks and write the measurements')
+  parser.add_argument('--clang', required=True, help='The clang to measure')
+  parser.add_argument('--inputs', required=True,
+    help='Directory of the synthetic inputs, see the generate command')
+  parser.add_argument('--compile-commands', action='append', default=[],
+    help='Also measure the TUs of this compilation database')
+  parser.add_argument('--repeat', type=int, default=3,
+    help='Number of runs of each benchmark, of which the fastest is kept')
+  parser.add_argument('--perf', default=shutil.which('perf'),
+    help='perf binary to count instructions with (default: from PATH)')
+  parser.add_argument('--filter', default='',
+    help='Only run the benchmarks whose name matches this regex')
+  parser.add_argument('--output', required=True, help='Output JSON file')
+  opts = parser.parse_args(args)
+
+  benchmarks = []
+  for name, filename, _, flags in syntheticBenchmarks:
+    benchmarks.append((name, os.path.join(opts.inputs, filename), flags))
+  for path in opts.compile_commands:
+    benchmarks.extend(realWorldBenchmarks(path))
+
+  tmp = tempfile.mkdtemp(prefix='clang-perf-')
+  results = {}
+  try:
+    for name, input, flags in benchmarks:
+      if not re.search(opts.filter, name):
+        continue
+      flags = [flag % {'tmp': tmp,
+                       'dir': os.path.join(opts.inputs, 'modules')}
+               for flag in flags]
+      print('Running %s' % name)
+      results[name] = measure(opts.clang, name, input, flags, opts.repeat,
+                              opts.perf, tmp)
+  finally:
+    shutil.rmtree(tmp)
+
+  with open(opts.output, 'w') as f:
+    json.dump({'benchmarks': results}, f, indent=2, sort_keys=True)
+  return 0
+
+#===------------------------------------------------------------------------===#
+# Comparisons
+#===------------------------------------------------------------------------===#
+
+def compare(args):
+  parser = argparse.ArgumentParser(prog='clang-perf compare',
+    description='Report the measurements which regressed from a baseline')
+  parser.add_argument('--time-threshold', type=float, default=10,
+    help='Allowed increase of the times in percent (default 10)')
+  parser.add_argument('--threshold', type=float, default=2,
+    help='Allowed increase of the instructions and peak RSS in percent '
+         '(default 2)')
+  parser.add_argument('--min-phase-ms', type=float, default=50,
+    help='Ignore the phases which took less than this in the baseline')
+  parser.add_argument('baseline', help='Baseline JSON file')
+  parser.add_argument('results', help='Results JSON file')
+  opts = parser.parse_args(args)
+
+  with open(opts.baseline) as f:
+    baseline = json.load(f)['benchmarks']
+  with open(opts.results) as f:
+    results = json.load(f)['benchmarks']
+
+  regressions = 0
+  def check(name, metric, old, new, threshold):
+    if old is None or new is None or old <= 0:
+      return 0
+    change = (new - old) * 100.0 / old
+    if change <= threshold:
+      return 0
+    print('%s: %s regressed by %.1f%% (%.6g -> %.6g)' %
+          (name, metric, change, old, new))
+    return 1
+
+  for name in sorted(results):
+    if name not in baseline:
+      print('%s: no baseline' % name)
+      continue
+    old, new = baseline[name], results[name]
+    regressions += check(name, 'wall time', old.get('wall_ms'),
+                         new.get('wall_ms'), opts.time_threshold)
+    regressions += check(name, 'instructions', old.get('instructions'),
+                         new.get('instructions'), opts.threshold)
+    regressions += check(name, 'peak RSS', old.get('peak_rss_kb'),
+                         new.get('peak_rss_kb'), opts.threshold)
+    for phase, ms in sorted(old.get('phases_ms', {}).items()):
+      if ms >= opts.min_phase_ms:
+        regressions += check(name, 'phase "%s"' % phase, ms,
+                             new.get('phases_ms', {}).get(phase),
+                             opts.time_threshold)
+
+  print('%d regression(s)' % regressions)
+  return 1 if regressions else 0
+
+commands = {
+  'generate' : generate,
+  'run' : run,
+  'compare' : compare,
+}
+
+def main():
+  if len(sys.argv) < 2 or sys.argv[1] not in commands:
+    print('Usage: %s <%s> ...' % (sys.argv[0], '|'.join(sorted(commands))))
+    return 1
+  return commands[sys.argv[1]](sys.argv[2:])
+
+if __name__ == '__main__':
+  sys.exit(main())